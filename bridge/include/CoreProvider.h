@@ -132,6 +132,17 @@ public:
 	void			(*UpdateAdminCmdFlags)(const char *cmd, OverrideType type, FlagBits bits, bool remove);
 	bool			(*LookForCommandAdminFlags)(const char *cmd, FlagBits *pFlags);
 	int             (*GetGlobalTarget)();
+	void			(*RecordStartupStep)(const char *name, double ms);
+	size_t			(*GetTimerCount)();
+
+	// Hot entry points, resolved once by core. They skip the virtual
+	// dispatch above, and the chain of IGamePlayer calls natives would
+	// otherwise make. |maxClients| is updated in place by core.
+	const int		*maxClients;
+	void			(*FastConPrint)(const char *message);
+	const char *	(*FastGetClientName)(int client);	// NULL if not connected
+	const char *	(*FastGetClientConVarValue)(int client, const char *name);
+	const char *	(*FastGetCvarString)(ConVar *cvar);
 };
 
 } // namespace SourceMod
@@ -0,0 +1,75 @@
+// vim: set ts=4 sw=4 tw=99 noet:
+// =============================================================================
+// SourceMod
+// Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+// =============================================================================
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License, version 3.0, as published by the
+// Free Software Foundation.
+// 
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// As a special exception, AlliedModders LLC gives you permission to link the
+// code of this program (as well as its derivative works) to "Half-Life 2," the
+// "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+// by the Valve Corporation.  You must obey the GNU General Public License in
+// all respects for all other code used.  Additionally, AlliedModders LLC grants
+// this exception to all derivative works.  AlliedModders LLC defines further
+// exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+// or <http://www.sourcemod.net/license.php>.
+#ifndef _INCLUDE_SOURCEMOD_BRIDGE_INCLUDE_ICONTAINERBRIDGE_H_
+#define _INCLUDE_SOURCEMOD_BRIDGE_INCLUDE_ICONTAINERBRIDGE_H_
+
+#include <IHandleSys.h>
+
+struct CellTrie;
+
+namespace SourceMod {
+
+class ICellArray;
+
+// Receives the entries of a StringMap, see IContainerBridge::VisitStringMap.
+class IStringMapVisitor
+{
+public:
+	virtual void OnCell(const char *key, cell_t value) = 0;
+	virtual void OnString(const char *key, const char *value) = 0;
+	virtual void OnArray(const char *key, const cell_t *values, size_t count) = 0;
+};
+
+// Lets Core build and read the StringMap and ArrayList objects owned by
+// logic, for bulk conversions that would otherwise need a native call per
+// element.
+class IContainerBridge
+{
+public:
+	// Creates an empty StringMap owned by |owner|. Returns BAD_HANDLE on failure.
+	virtual Handle_t CreateStringMap(IdentityToken_t *owner, CellTrie **map) = 0;
+
+	// Creates an empty ArrayList owned by |owner|. Returns BAD_HANDLE on failure.
+	virtual Handle_t CreateArrayList(IdentityToken_t *owner, size_t blocksize, ICellArray **array) = 0;
+
+	// Returns the map behind a StringMap handle, or null if the handle is
+	// not a StringMap readable by |owner|.
+	virtual CellTrie *ReadStringMap(Handle_t hndl, IdentityToken_t *owner) = 0;
+
+	// Adds or replaces an entry.
+	virtual void SetStringMapCell(CellTrie *map, const char *key, cell_t value) = 0;
+	virtual void SetStringMapString(CellTrie *map, const char *key, const char *value) = 0;
+	virtual void SetStringMapArray(CellTrie *map, const char *key, const cell_t *values, size_t count) = 0;
+
+	// Calls |visitor| once per entry, in no particular order. The map must
+	// not be changed while it is visited.
+	virtual void VisitStringMap(CellTrie *map, IStringMapVisitor *visitor) = 0;
+};
+
+} // namespace SourceMod
+
+#endif // _INCLUDE_SOURCEMOD_BRIDGE_INCLUDE_ICONTAINERBRIDGE_H_
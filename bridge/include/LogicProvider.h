@@ -51,6 +51,7 @@ class IExtensionSys;
 class ITextParsers;
 class ILogger;
 class ICellArray;
+class IContainerBridge;
 
 struct sm_logic_t
 {
@@ -76,6 +77,11 @@ struct sm_logic_t
 	void			(*SetEntityLumpWritable)(bool writable);
 	bool			(*ParseEntityLumpString)(const char *entityString, int &status, size_t &position);
 	const char *	(*GetEntityLumpString)();
+	void			(*SetSuspendedForwards)(const char *names);
+	bool			(*IsProfilingActive)();
+	void			(*EnterProfileScope)(const char *group, const char *name);
+	void			(*LeaveProfileScope)();
+	void			(*MaterializeLanguage)(unsigned int langid);
 	IScriptManager	*scripts;
 	IShareSys		*sharesys;
 	IExtensionSys	*extsys;
@@ -86,6 +92,7 @@ struct sm_logic_t
 	ILogger			*logger;
 	IRootConsole	*rootmenu;
 	IProviderCallbacks *callbacks;
+	IContainerBridge *containers;
 	float			sentinel;
 };
 
@@ -51,6 +51,9 @@ ChatTriggers::ChatTriggers() : m_bWillProcessInPost(false),
 {
 	m_PubTrigger = "!";
 	m_PrivTrigger = "/";
+	memset(m_TriggerChars, 0, sizeof(m_TriggerChars));
+	m_TriggerChars[(unsigned char)'!'] = (1 << ChatTrigger_Public);
+	m_TriggerChars[(unsigned char)'/'] = (1 << ChatTrigger_Private);
 	m_bIsChatTrigger = false;
 	m_bPluginIgnored = true;
 #if SOURCE_ENGINE == SE_EPISODEONE
@@ -80,6 +83,14 @@ void ChatTriggers::SetChatTrigger(ChatTriggerType type, const char *value)
 	}
 	*dest = '\0';
 
+	uint8_t bit = (1 << type);
+	for (size_t i = 0; i < sizeof(m_TriggerChars); i++) {
+		m_TriggerChars[i] &= ~bit;
+	}
+	for (const char *p = filtered.get(); *p != '\0'; p++) {
+		m_TriggerChars[(unsigned char)*p] |= bit;
+	}
+
 	if (type == ChatTrigger_Private) {
 		m_PrivTrigger = filtered.get();
 	} else {
@@ -227,8 +238,8 @@ bool ChatTriggers::OnSayCommand_Pre(int client, const ICommandArgs *command)
 	 * but losing the last quote in the OnClientSayCommand_Post ("message) forward.
 	 * To compensate this, we copy the args into our own buffer where the engine won't mess with
 	 * and strip the quotes. */
-	delete [] m_ArgSBackup;
-	m_ArgSBackup = new char[CCommand::MaxCommandLength()+1];
+	if (!m_ArgSBackup)
+		m_ArgSBackup = new char[CCommand::MaxCommandLength()+1];
 	memcpy(m_ArgSBackup, args, len+1);
 
 	/* Strip the quotes from the argument */
@@ -273,16 +284,10 @@ bool ChatTriggers::OnSayCommand_Pre(int client, const ICommandArgs *command)
 		return true;
 	}
 
-	bool is_trigger = false;
-	bool is_silent = false;
-
 	// Prefer the silent trigger in case of clashes.
-	if (strchr(m_PrivTrigger.c_str(), m_ArgSBackup[0])) {
-		is_trigger = true;
-		is_silent = true;
-	} else if (strchr(m_PubTrigger.c_str(), m_ArgSBackup[0])) {
-		is_trigger = true;
-	}
+	uint8_t trigger = m_TriggerChars[(unsigned char)m_ArgSBackup[0]];
+	bool is_silent = (trigger & (1 << ChatTrigger_Private)) != 0;
+	bool is_trigger = (trigger != 0);
 
 	if (is_trigger) {
 		// Bump the args past the chat trigger - we only support single-character triggers now.
@@ -340,14 +345,17 @@ bool ChatTriggers::OnSayCommand_Post(int client, const ICommandArgs *command)
 
 bool ChatTriggers::PreProcessTrigger(edict_t *pEdict, const char *args)
 {
-	/* Extract a command. This is kind of sloppy. */
-	char cmd_buf[64];
+	/* Extract a command. This is kind of sloppy.  The command is copied in behind an "sm_"
+	 * prefix, so both spellings can be looked up from the same buffer.
+	 */
+	char new_buf[3 + 64] = {'s', 'm', '_'};
+	char *cmd_buf = &new_buf[3];
 	size_t cmd_len = 0;
 	const char *inptr = args;
 	while (*inptr != '\0'
 			&& !textparsers->IsWhitespace(inptr)
 			&& *inptr != '"'
-			&& cmd_len < sizeof(cmd_buf) - 1)
+			&& cmd_len < sizeof(new_buf) - 3 - 1)
 	{
 		cmd_buf[cmd_len++] = *inptr++;
 	}
@@ -368,13 +376,6 @@ bool ChatTriggers::PreProcessTrigger(edict_t *pEdict, const char *args)
 			return false;
 		}
 
-		/* Now, prepend.  Don't worry about the buffers.  This will
-		 * work because the sizes are limited from earlier.
-		 */
-		char new_buf[80];
-		strcpy(new_buf, "sm_");
-		ke::SafeStrcpy(&new_buf[3], sizeof(new_buf)-3, cmd_buf);
-
 		/* Recheck */
 		if (!g_ConCmds.LookForSourceModCommand(new_buf))
 		{
@@ -78,6 +78,7 @@ private:
 	std::vector<ke::RefPtr<CommandHook>> hooks_;
 	std::string m_PubTrigger;
 	std::string m_PrivTrigger;
+	uint8_t m_TriggerChars[256];	/* bit (1 << ChatTriggerType) set for each trigger character */
 	bool m_bWillProcessInPost;
 	bool m_bIsChatTrigger;
 	bool m_bWasFloodedMessage;
@@ -33,6 +33,7 @@
 
 #include <bridge/include/IScriptManager.h>
 #include "ChatTriggers.h"
+#include "ConsoleDetours.h"
 #include "HalfLife2.h"
 #include "PlayerManager.h"
 #include "command_args.h"
@@ -40,6 +41,8 @@
 #include "provider.h"
 #include "sm_stringutil.h"
 #include "sourcemod.h"
+#include "TimerSys.h"
+#include <stdlib.h>
 
 using namespace ke;
 
@@ -50,6 +53,16 @@ void RegisterInPlugin(CmdHook *hook);
 
 ConCmdManager::ConCmdManager()
 {
+	for (int i = 0; i < CmdRate_Groups; i++)
+	{
+		m_RateLimit[i] = 0.0f;
+		m_RateBurst[i] = 0.0f;
+		m_RateAllowed[i] = 0;
+		m_RateDropped[i] = 0;
+	}
+	memset(m_RateBuckets, 0, sizeof(m_RateBuckets));
+	memset(m_LastDropped, 0, sizeof(m_LastDropped));
+	m_TrustedDepth = 0;
 }
 
 ConCmdManager::~ConCmdManager()
@@ -60,12 +73,120 @@ void ConCmdManager::OnSourceModAllInitialized()
 {
 	scripts->AddPluginsListener(this);
 	rootmenu->AddRootConsoleCommand3("cmds", "List console commands", this);
+	rootmenu->AddRootConsoleCommand3("cmdrate", "Show client command flood counters", this);
 }
 
 void ConCmdManager::OnSourceModShutdown()
 {
 	scripts->RemovePluginsListener(this);
 	rootmenu->RemoveRootConsoleCommand("cmds", this);
+	rootmenu->RemoveRootConsoleCommand("cmdrate", this);
+}
+
+ConfigResult ConCmdManager::OnSourceModConfigChanged(const char *key, 
+													 const char *value, 
+													 ConfigSource source, 
+													 char *error, 
+													 size_t maxlength)
+{
+	static const struct
+	{
+		const char *key;
+		CommandRateGroup group;
+		bool burst;
+	} rateKeys[] =
+	{
+		{"ChatCommandRate", CmdRate_Chat, false},
+		{"ChatCommandBurst", CmdRate_Chat, true},
+		{"ClientCommandRate", CmdRate_Other, false},
+		{"ClientCommandBurst", CmdRate_Other, true},
+	};
+
+	for (size_t i = 0; i < sizeof(rateKeys) / sizeof(rateKeys[0]); i++)
+	{
+		if (strcmp(key, rateKeys[i].key) != 0)
+			continue;
+
+		char *end;
+		double amount = strtod(value, &end);
+		if (!value[0] || *end != '\0' || amount < 0.0)
+		{
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be a non-negative number");
+			return ConfigResult_Reject;
+		}
+
+		if (rateKeys[i].burst)
+			m_RateBurst[rateKeys[i].group] = (float)amount;
+		else
+			m_RateLimit[rateKeys[i].group] = (float)amount;
+		return ConfigResult_Accept;
+	}
+
+	return ConfigResult_Ignore;
+}
+
+static CommandRateGroup GetCommandRateGroup(const char *cmd)
+{
+	if (strncasecmp(cmd, "say", 3) == 0 &&
+	    (cmd[3] == '\0' || cmd[3] == '2' || cmd[3] == '_'))
+	{
+		return CmdRate_Chat;
+	}
+	return CmdRate_Other;
+}
+
+bool ConCmdManager::ChargeClientCommand(int client, const char *cmd)
+{
+	if (client < 1 || client > SM_MAXPLAYERS || m_TrustedDepth)
+		return true;
+
+	CommandRateGroup group = GetCommandRateGroup(cmd);
+	float rate = m_RateLimit[group];
+	if (rate <= 0.0f)
+	{
+		m_LastDropped[client] = false;
+		return true;
+	}
+
+	CPlayer *pPlayer = g_Players.GetPlayerByIndex(client);
+	if (!pPlayer || pPlayer->IsFakeClient())
+	{
+		m_LastDropped[client] = false;
+		return true;
+	}
+
+	/* Buckets are keyed by userid so a new client in the slot starts full. */
+	float burst = m_RateBurst[group] > 1.0f ? m_RateBurst[group] : 1.0f;
+	double now = *g_pUniversalTime;
+	CommandRateBucket &bucket = m_RateBuckets[client][group];
+	int userid = pPlayer->GetUserId();
+	if (bucket.userid != userid)
+	{
+		bucket.userid = userid;
+		bucket.tokens = burst;
+		bucket.last = now;
+		bucket.dropped = 0;
+	}
+	else if (now > bucket.last)
+	{
+		bucket.tokens += (float)((now - bucket.last) * rate);
+		if (bucket.tokens > burst)
+			bucket.tokens = burst;
+		bucket.last = now;
+	}
+
+	if (bucket.tokens < 1.0f)
+	{
+		bucket.dropped++;
+		m_RateDropped[group]++;
+		m_LastDropped[client] = true;
+		return false;
+	}
+
+	bucket.tokens -= 1.0f;
+	m_RateAllowed[group]++;
+	m_LastDropped[client] = false;
+	return true;
 }
 
 void ConCmdManager::OnUnlinkConCommandBase(ConCommandBase *pBase, const char *name)
@@ -211,6 +332,18 @@ bool ConCmdManager::InternalDispatch(int client, const ICommandArgs *args)
 	 */
 	const char *cmd = g_HL2.CurrentCommandName();
 
+	/* With command listeners active, ConsoleDetours has already charged this 
+	 * command; otherwise this is the first place that sees it.
+	 */
+	if (client)
+	{
+		bool dropped = g_ConsoleDetours.IsEnabled()
+		               ? WasLastCommandDropped(client)
+		               : !ChargeClientCommand(client, cmd);
+		if (dropped)
+			return true;
+	}
+
 	ConCmdInfo *pInfo = FindInTrie(cmd);
 	if (pInfo == NULL)
 	{
@@ -571,6 +704,7 @@ ConCmdInfo *ConCmdManager::AddOrFindCommand(const char *name, const char *descri
 		}
 
 		pInfo->pCmd = pCmd;
+		pInfo->lowerName = ke::Lowercase(pCmd->GetName());
 
 		m_Cmds.insert(name, pInfo);
 		AddToCmdList(pInfo);
@@ -579,8 +713,67 @@ ConCmdInfo *ConCmdManager::AddOrFindCommand(const char *name, const char *descri
 	return pInfo;
 }
 
+void ConCmdManager::ListCommandRates()
+{
+	static const char *groupNames[CmdRate_Groups] = {"chat", "other"};
+
+	UTIL_ConsolePrint("[SM] Client command flood limits:");
+	UTIL_ConsolePrint("  %-8s %-10s %-10s %-12s %s", "[Group]", "[Rate]", "[Burst]", "[Allowed]", "[Dropped]");
+	for (int i = 0; i < CmdRate_Groups; i++)
+	{
+		char rate[16];
+		if (m_RateLimit[i] > 0.0f)
+			ke::SafeSprintf(rate, sizeof(rate), "%.1f/s", m_RateLimit[i]);
+		else
+			ke::SafeStrcpy(rate, sizeof(rate), "off");
+		UTIL_ConsolePrint("  %-8s %-10s %-10.0f %-12llu %llu",
+			groupNames[i],
+			rate,
+			m_RateBurst[i],
+			(unsigned long long)m_RateAllowed[i],
+			(unsigned long long)m_RateDropped[i]);
+	}
+
+	bool header = false;
+	int maxClients = g_Players.GetMaxClients();
+	for (int client = 1; client <= maxClients; client++)
+	{
+		CPlayer *pPlayer = g_Players.GetPlayerByIndex(client);
+		if (!pPlayer || !pPlayer->IsConnected())
+			continue;
+
+		unsigned int dropped[CmdRate_Groups];
+		bool any = false;
+		for (int i = 0; i < CmdRate_Groups; i++)
+		{
+			const CommandRateBucket &bucket = m_RateBuckets[client][i];
+			dropped[i] = (bucket.userid == pPlayer->GetUserId()) ? bucket.dropped : 0;
+			any = any || dropped[i];
+		}
+		if (!any)
+			continue;
+
+		if (!header)
+		{
+			UTIL_ConsolePrint("  %-6s %-32s %-10s %s", "[#]", "[Name]", "[Chat]", "[Other]");
+			header = true;
+		}
+		UTIL_ConsolePrint("  %-6d %-32.31s %-10u %u",
+			pPlayer->GetUserId(),
+			pPlayer->GetName(),
+			dropped[CmdRate_Chat],
+			dropped[CmdRate_Other]);
+	}
+}
+
 void ConCmdManager::OnRootConsoleCommand(const char *cmdname, const ICommandArgs *command)
 {
+	if (strcmp(cmdname, "cmdrate") == 0)
+	{
+		ListCommandRates();
+		return;
+	}
+
 	if (command->ArgC() >= 3)
 	{
 		const char *text = command->Arg(2);
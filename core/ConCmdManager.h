@@ -32,6 +32,7 @@
 #ifndef _INCLUDE_SOURCEMOD_CONCMDMANAGER_H_
 #define _INCLUDE_SOURCEMOD_CONCMDMANAGER_H_
 
+#include <ctype.h>
 #include <list>
 #include <memory>
 
@@ -47,6 +48,7 @@
 #include <sh_string.h>
 #include <IRootConsoleMenu.h>
 #include <IAdminSystem.h>
+#include <IPlayerHelpers.h>
 #include "concmd_cleaner.h"
 #include "GameHooks.h"
 #include <sm_namehashset.h>
@@ -112,6 +114,7 @@ struct ConCmdInfo
 
 	bool sourceMod;					/**< Determines whether or not concmd was created by a SourceMod plugin */
 	ConCommand *pCmd;				/**< Pointer to the command itself */
+	std::string lowerName;			/**< Case-folded command name, used as the lookup key */
 	CmdHookList hooks;				/**< Hook list */
 	FlagBits eflags;				/**< Effective admin flags */
 	ke::RefPtr<CommandHook> sh_hook;   /**< SourceHook hook, if any. */
@@ -119,26 +122,52 @@ struct ConCmdInfo
 
 	struct ConCmdPolicy
 	{
-		static inline bool matches(const char *name, ConCmdInfo *info)
+		static inline char fold(char c)
 		{
-			const char *conCmdChars = info->pCmd->GetName();
-
-			std::string concmdName = ke::Lowercase(conCmdChars);
-			std::string input = ke::Lowercase(name);
+			return (char)tolower((unsigned char)c);
+		}
 
-			return concmdName == input;
+		static inline bool matches(const char *name, ConCmdInfo *info)
+		{
+			/* Lookups happen on every command dispatch, so fold in place instead of copying. */
+			const char *key = info->lowerName.c_str();
+			while (*key && fold(*name) == *key)
+			{
+				name++;
+				key++;
+			}
+			return *name == '\0' && *key == '\0';
 		}
 
 		static inline uint32_t hash(const detail::CharsAndLength &key)
 		{
-			std::string lower = ke::Lowercase(key.c_str());
-			return detail::CharsAndLength(lower.c_str()).hash();
+			return key.foldedHash();
 		}
 	};
 };
 
 typedef List<ConCmdInfo *> ConCmdList;
 
+/**
+ * Client commands are flood-limited with one token bucket per client and 
+ * command group.  Each command takes a token; tokens refill at "rate" per 
+ * second up to "burst".  A rate of 0 disables limiting for the group.
+ */
+enum CommandRateGroup
+{
+	CmdRate_Chat,		/**< say, say_team and friends */
+	CmdRate_Other,		/**< Everything else */
+	CmdRate_Groups
+};
+
+struct CommandRateBucket
+{
+	int userid;
+	float tokens;
+	double last;
+	unsigned int dropped;
+};
+
 class ConCmdManager :
 	public SMGlobalClass,
 	public IRootConsoleCommand,
@@ -152,6 +181,8 @@ public:
 public: //SMGlobalClass
 	void OnSourceModAllInitialized();
 	void OnSourceModShutdown();
+	ConfigResult OnSourceModConfigChanged(const char *key, const char *value,
+		ConfigSource source, char *error, size_t maxlength);
 public: //IPluginsListener
 	void OnPluginDestroyed(IPlugin *plugin);
 public: //IRootConsoleCommand
@@ -171,6 +202,31 @@ public:
 	void UpdateAdminCmdFlags(const char *cmd, OverrideType type, FlagBits bits, bool remove);
 	bool LookForSourceModCommand(const char *cmd);
 	bool LookForCommandAdminFlags(const char *cmd, FlagBits *pFlags);
+	/**
+	 * Takes a token for a command sent by a client.  Returns false if the 
+	 * client is flooding and the command must be dropped before any plugin 
+	 * sees it.
+	 */
+	bool ChargeClientCommand(int client, const char *cmd);
+	/**
+	 * Returns the verdict of the last command charged to a client.  Used by 
+	 * dispatch paths that run after the command was already charged.
+	 */
+	bool WasLastCommandDropped(int client) const
+	{
+		return m_LastDropped[client];
+	}
+	/**
+	 * Commands issued by plugins on behalf of a client are not limited.
+	 */
+	void EnterTrustedCommand()
+	{
+		m_TrustedDepth++;
+	}
+	void LeaveTrustedCommand()
+	{
+		m_TrustedDepth--;
+	}
 private:
 	bool InternalDispatch(int client, const ICommandArgs *args);
 	ResultType RunAdminCommand(ConCmdInfo *pInfo, int client, int args);
@@ -179,6 +235,7 @@ private:
 	void RemoveConCmd(ConCmdInfo *info, const char *cmd, bool untrack);
 	bool CheckAccess(int client, const char *cmd, AdminCmdInfo *pAdmin);
 	ConCmdInfo *FindInTrie(const char *name);
+	void ListCommandRates();
 public:
 	inline const List<ConCmdInfo *> & GetCommandList()
 	{
@@ -190,6 +247,14 @@ private:
 	NameHashSet<ConCmdInfo *, ConCmdInfo::ConCmdPolicy> m_Cmds; /* command lookup */
 	GroupMap m_CmdGrps;				/* command group map */
 	ConCmdList m_CmdList;			/* command list */
+
+	float m_RateLimit[CmdRate_Groups];	/* tokens per second, 0 = unlimited */
+	float m_RateBurst[CmdRate_Groups];	/* bucket size */
+	CommandRateBucket m_RateBuckets[SM_MAXPLAYERS + 1][CmdRate_Groups];
+	bool m_LastDropped[SM_MAXPLAYERS + 1];
+	uint64_t m_RateAllowed[CmdRate_Groups];
+	uint64_t m_RateDropped[CmdRate_Groups];
+	int m_TrustedDepth;
 };
 
 extern ConCmdManager g_ConCmds;
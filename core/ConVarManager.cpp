@@ -31,6 +31,7 @@
 #include "HalfLife2.h"
 #include "sm_stringutil.h"
 #include <sh_vector.h>
+#include <algorithm>
 #include <sm_namehashset.h>
 #include "logic_bridge.h"
 #include "sourcemod.h"
@@ -40,6 +41,7 @@
 ConVarManager g_ConVarManager;
 
 const ParamType CONVARCHANGE_PARAMS[] = {Param_Cell, Param_String, Param_String};
+const ParamType CONVARBATCH_PARAMS[] = {Param_Array, Param_Cell};
 typedef List<const ConVar *> ConVarList;
 NameHashSet<ConVarInfo *, ConVarInfo::ConVarPolicy> convar_cache;
 
@@ -81,8 +83,10 @@ public:
 
 ConVarReentrancyGuard *ConVarReentrancyGuard::chain = NULL;
 
-ConVarManager::ConVarManager() : m_ConVarType(0)
+ConVarManager::ConVarManager() : m_ConVarType(0), m_pCurrentBatch(NULL), m_pBatchForward(NULL),
+	m_FlushQueued(false), m_Flushing(false)
 {
+	m_ConVarQueries.init();
 }
 
 ConVarManager::~ConVarManager()
@@ -129,6 +133,10 @@ void ConVarManager::OnSourceModShutdown()
 		{
 			forwardsys->ReleaseForward(pInfo->pChangeForward);
 		}
+		if (pInfo->pDeferredForward != NULL)
+		{
+			forwardsys->ReleaseForward(pInfo->pDeferredForward);
+		}
 		if (pInfo->sourceMod)
 		{
 			/* If we created it, we won't be tracking it, therefore it is 
@@ -154,6 +162,13 @@ void ConVarManager::OnSourceModShutdown()
 		delete pInfo;
 	}
 	convar_cache.clear();
+	m_PendingChanges.clear();
+
+	if (m_pBatchForward != NULL)
+	{
+		forwardsys->ReleaseForward(m_pBatchForward);
+		m_pBatchForward = NULL;
+	}
 
 	g_Players.RemoveClientListener(this);
 
@@ -186,6 +201,14 @@ void ConVarManager::OnUnlinkConCommandBase(ConCommandBase *pBase, const char *na
 	m_ConVars.remove(pInfo);
 	convar_cache.remove(name);
 
+	/* Don't deliver a queued change for it */
+	if (pInfo->changePending)
+	{
+		m_PendingChanges.erase(std::remove(m_PendingChanges.begin(), m_PendingChanges.end(), pInfo),
+		                       m_PendingChanges.end());
+	}
+	std::replace(m_FlushList.begin(), m_FlushList.end(), pInfo, (ConVarInfo *)NULL);
+
 	/* Now make sure no plugins are referring to this pointer */
 	IPluginIterator *pl_iter = scripts->GetPluginIterator();
 	while (pl_iter->MorePlugins())
@@ -207,6 +230,22 @@ void ConVarManager::OnUnlinkConCommandBase(ConCommandBase *pBase, const char *na
 	delete pInfo;
 }
 
+void ConVarManager::OnPluginCreated(IPlugin *plugin)
+{
+	/* None of the plugin's code is running, so its heap is empty and starts right where its
+	 * data section ends.  BindConVar only accepts variables below that.
+	 */
+	IPluginContext *pContext = plugin->GetBaseContext();
+	cell_t heapBase, *phys;
+	if (!pContext || pContext->IsInExec() || pContext->HeapAlloc(1, &heapBase, &phys) != SP_ERROR_NONE)
+	{
+		return;
+	}
+	pContext->HeapPop(heapBase);
+
+	plugin->SetProperty("DataSectionEnd", (void *)(uintptr_t)heapBase);
+}
+
 void ConVarManager::OnPluginUnloaded(IPlugin *plugin)
 {
 	ConVarList *pConVarList;
@@ -227,48 +266,78 @@ void ConVarManager::OnPluginUnloaded(IPlugin *plugin)
 		}
 	}
 
+	/* Drop any variables this plugin bound to a convar */
+	IPluginContext *pContext = plugin->GetBaseContext();
+	for (List<ConVarInfo *>::iterator iter = m_ConVars.begin(); iter != m_ConVars.end(); ++iter)
+	{
+		List<ConVarBinding> &bindings = (*iter)->bindings;
+		for (List<ConVarBinding>::iterator b = bindings.begin(); b != bindings.end();)
+		{
+			if ((*b).pContext == pContext)
+			{
+				b = bindings.erase(b);
+				continue;
+			}
+
+			++b;
+		}
+	}
+
 	const IPluginRuntime * pRuntime = plugin->GetRuntime();
 
 	/* Remove convar queries for this plugin that haven't returned results yet */
-	for (List<ConVarQuery>::iterator iter = m_ConVarQueries.begin(); iter != m_ConVarQueries.end();)
+	for (ConVarQueryMap::iterator iter = m_ConVarQueries.iter(); !iter.empty(); iter.next())
 	{
-		ConVarQuery &query = (*iter);
+		ConVarQuery &query = iter->value;
 		if (query.pCallback->GetParentRuntime() == pRuntime)
 		{
-			iter = m_ConVarQueries.erase(iter);
-			continue;
+			if (query.pBatch)
+			{
+				CompleteBatchQuery(query, eQueryCvarValueStatus_Cancelled, "", false);
+			}
+			iter.erase();
 		}
-
-		++iter;
 	}
 }
 
 void ConVarManager::OnClientDisconnected(int client)
 {
-	/* Remove convar queries for this client that haven't returned results yet */
-	for (List<ConVarQuery>::iterator iter = m_ConVarQueries.begin(); iter != m_ConVarQueries.end();)
+	/* Remove convar queries for this client that haven't returned results yet.
+	 * Callbacks may start new queries, so only call them once we are done
+	 * walking the table.
+	 */
+	std::vector<ConVarQuery> cancelled;
+	for (ConVarQueryMap::iterator iter = m_ConVarQueries.iter(); !iter.empty(); iter.next())
 	{
-		ConVarQuery &query = (*iter);
-		if (query.client == client)
+		if (iter->value.client == client)
 		{
-			IPluginFunction *pCallback = query.pCallback;
-			if (pCallback)
-			{
-				cell_t ret;
-
-				pCallback->PushCell(query.cookie);
-				pCallback->PushCell(client);
-				pCallback->PushCell(eQueryCvarValueStatus_Cancelled);
-				pCallback->PushString("");
-				pCallback->PushString("");
-				pCallback->PushCell(query.value);
-				pCallback->Execute(&ret);
-			}
-			iter = m_ConVarQueries.erase(iter);
+			cancelled.push_back(iter->value);
+			iter.erase();
+		}
+	}
+
+	for (size_t i = 0; i < cancelled.size(); i++)
+	{
+		ConVarQuery &query = cancelled[i];
+		if (query.pBatch)
+		{
+			CompleteBatchQuery(query, eQueryCvarValueStatus_Cancelled, "", true);
 			continue;
 		}
 
-		++iter;
+		IPluginFunction *pCallback = query.pCallback;
+		if (pCallback)
+		{
+			cell_t ret;
+
+			pCallback->PushCell(query.cookie);
+			pCallback->PushCell(client);
+			pCallback->PushCell(eQueryCvarValueStatus_Cancelled);
+			pCallback->PushString("");
+			pCallback->PushString("");
+			pCallback->PushCell(query.value);
+			pCallback->Execute(&ret);
+		}
 	}
 }
 
@@ -383,6 +452,8 @@ Handle_t ConVarManager::CreateConVar(IPluginContext *pContext, const char *name,
 			pInfo = new ConVarInfo();
 			pInfo->sourceMod = false;
 			pInfo->pChangeForward = NULL;
+			pInfo->pDeferredForward = NULL;
+			pInfo->changePending = false;
 			pInfo->pVar = pConVar;
 
 			/* If we don't, then create a new handle from the convar */
@@ -415,6 +486,8 @@ Handle_t ConVarManager::CreateConVar(IPluginContext *pContext, const char *name,
 	pInfo->handle = hndl;
 	pInfo->sourceMod = true;
 	pInfo->pChangeForward = NULL;
+	pInfo->pDeferredForward = NULL;
+	pInfo->changePending = false;
 	pInfo->pPlugin = plugin;
 
 	/* Create a handle from the new convar */
@@ -466,6 +539,8 @@ Handle_t ConVarManager::FindConVar(const char *name)
 	pInfo = new ConVarInfo();
 	pInfo->sourceMod = false;
 	pInfo->pChangeForward = NULL;
+	pInfo->pDeferredForward = NULL;
+	pInfo->changePending = false;
 	pInfo->pVar = pConVar;
 
 	/* If we don't have a handle, then create a new one */
@@ -513,7 +588,7 @@ void ConVarManager::RemoveConVarChangeListener(const char *name, IConVarChangeLi
 	}
 }
 
-void ConVarManager::HookConVarChange(ConVar *pConVar, IPluginFunction *pFunction)
+void ConVarManager::HookConVarChange(ConVar *pConVar, IPluginFunction *pFunction, bool deferred)
 {
 	ConVarInfo *pInfo;
 	IChangeableForward *pForward;
@@ -521,14 +596,16 @@ void ConVarManager::HookConVarChange(ConVar *pConVar, IPluginFunction *pFunction
 	/* Find the convar in the lookup trie */
 	if (convar_cache_lookup(pConVar->GetName(), &pInfo))
 	{
+		IChangeableForward **ppForward = deferred ? &pInfo->pDeferredForward : &pInfo->pChangeForward;
+
 		/* Get the forward */
-		pForward = pInfo->pChangeForward;
+		pForward = *ppForward;
 
 		/* If forward does not exist, create it */
 		if (!pForward)
 		{
 			pForward = forwardsys->CreateForwardEx(NULL, ET_Ignore, 3, CONVARCHANGE_PARAMS);
-			pInfo->pChangeForward = pForward;
+			*ppForward = pForward;
 		}
 
 		/* Add function to forward's list */
@@ -536,7 +613,86 @@ void ConVarManager::HookConVarChange(ConVar *pConVar, IPluginFunction *pFunction
 	}
 }
 
-void ConVarManager::UnhookConVarChange(ConVar *pConVar, IPluginFunction *pFunction)
+void ConVarManager::BindConVar(ConVar *pConVar, IPluginContext *pContext, cell_t addr, ConVarBindType type, size_t maxlength)
+{
+	ConVarInfo *pInfo;
+
+	/* Find the convar in the lookup trie */
+	if (!convar_cache_lookup(pConVar->GetName(), &pInfo))
+	{
+		return;
+	}
+
+	ConVarBinding binding = { pContext, addr, type, maxlength };
+	WriteBinding(binding, pConVar);
+
+	/* Rebinding the same variable only updates how it is written */
+	for (List<ConVarBinding>::iterator iter = pInfo->bindings.begin(); iter != pInfo->bindings.end(); iter++)
+	{
+		ConVarBinding &other = (*iter);
+		if (other.pContext == pContext && other.addr == addr)
+		{
+			other = binding;
+			return;
+		}
+	}
+
+	pInfo->bindings.push_back(binding);
+}
+
+void ConVarManager::UnbindConVar(ConVar *pConVar, IPluginContext *pContext)
+{
+	ConVarInfo *pInfo;
+
+	/* Find the convar in the lookup trie */
+	if (!convar_cache_lookup(pConVar->GetName(), &pInfo))
+	{
+		return;
+	}
+
+	for (List<ConVarBinding>::iterator iter = pInfo->bindings.begin(); iter != pInfo->bindings.end();)
+	{
+		if ((*iter).pContext == pContext)
+		{
+			iter = pInfo->bindings.erase(iter);
+			continue;
+		}
+
+		++iter;
+	}
+}
+
+void ConVarManager::WriteBinding(const ConVarBinding &binding, ConVar *pConVar)
+{
+	if (binding.type == ConVarBind_String)
+	{
+		binding.pContext->StringToLocalUTF8(binding.addr, binding.maxlength, pConVar->GetString(), NULL);
+		return;
+	}
+
+	cell_t *addr;
+	if (binding.pContext->LocalToPhysAddr(binding.addr, &addr) != SP_ERROR_NONE)
+	{
+		return;
+	}
+
+	switch (binding.type)
+	{
+	case ConVarBind_Bool:
+		*addr = pConVar->GetBool() ? 1 : 0;
+		break;
+	case ConVarBind_Int:
+		*addr = pConVar->GetInt();
+		break;
+	case ConVarBind_Float:
+		*addr = sp_ftoc(pConVar->GetFloat());
+		break;
+	default:
+		break;
+	}
+}
+
+void ConVarManager::UnhookConVarChange(ConVar *pConVar, IPluginFunction *pFunction, bool deferred)
 {
 	ConVarInfo *pInfo;
 	IChangeableForward *pForward;
@@ -546,7 +702,7 @@ void ConVarManager::UnhookConVarChange(ConVar *pConVar, IPluginFunction *pFuncti
 	if (convar_cache_lookup(pConVar->GetName(), &pInfo))
 	{
 		/* Get the forward */
-		pForward = pInfo->pChangeForward;
+		pForward = deferred ? pInfo->pDeferredForward : pInfo->pChangeForward;
 
 		/* If the forward doesn't exist, we can't unhook anything */
 		if (!pForward)
@@ -562,6 +718,17 @@ void ConVarManager::UnhookConVarChange(ConVar *pConVar, IPluginFunction *pFuncti
 			return;
 		}
 
+		if (deferred)
+		{
+			/* It may be running right now; FlushDeferredChanges() frees it */
+			if (pForward->GetFunctionCount() == 0 && !m_Flushing)
+			{
+				forwardsys->ReleaseForward(pForward);
+				pInfo->pDeferredForward = NULL;
+			}
+			return;
+		}
+
 		/* If the forward now has 0 functions in it... */
 		if (pForward->GetFunctionCount() == 0 &&
 			!ConVarReentrancyGuard::IsCvarInChain(pConVar))
@@ -573,19 +740,214 @@ void ConVarManager::UnhookConVarChange(ConVar *pConVar, IPluginFunction *pFuncti
 	}
 }
 
+void ConVarManager::AddBatchChangeHook(IPluginFunction *pFunction)
+{
+	if (!m_pBatchForward)
+	{
+		m_pBatchForward = forwardsys->CreateForwardEx(NULL, ET_Ignore, 2, CONVARBATCH_PARAMS);
+	}
+
+	m_pBatchForward->AddFunction(pFunction);
+}
+
+bool ConVarManager::RemoveBatchChangeHook(IPluginFunction *pFunction)
+{
+	if (!m_pBatchForward || !m_pBatchForward->RemoveFunction(pFunction))
+	{
+		return false;
+	}
+
+	if (m_pBatchForward->GetFunctionCount() == 0 && !m_Flushing)
+	{
+		forwardsys->ReleaseForward(m_pBatchForward);
+		m_pBatchForward = NULL;
+	}
+
+	return true;
+}
+
+void ConVarManager::QueueDeferredChange(ConVarInfo *pInfo, const char *oldValue)
+{
+	/* Later changes in the same frame only move the final value */
+	if (pInfo->changePending)
+	{
+		return;
+	}
+
+	pInfo->changePending = true;
+	pInfo->pendingOldValue = oldValue;
+	m_PendingChanges.push_back(pInfo);
+
+	if (!m_FlushQueued)
+	{
+		m_FlushQueued = true;
+		g_SourceMod.AddFrameAction(FlushDeferredChangesAction, this);
+	}
+}
+
+void ConVarManager::FlushDeferredChangesAction(void *data)
+{
+	static_cast<ConVarManager *>(data)->FlushDeferredChanges();
+}
+
+void ConVarManager::FlushDeferredChanges()
+{
+	m_FlushQueued = false;
+
+	/* Hooks may change convars again; those changes go to the next frame.
+	 * Convars that go away while hooks run are cleared from m_FlushList.
+	 */
+	m_FlushList.swap(m_PendingChanges);
+
+	std::vector<cell_t> handles;
+	handles.reserve(m_FlushList.size());
+
+	m_Flushing = true;
+	for (size_t i = 0; i < m_FlushList.size(); i++)
+	{
+		ConVarInfo *pInfo = m_FlushList[i];
+		if (pInfo == NULL)
+		{
+			continue;
+		}
+		pInfo->changePending = false;
+
+		/* Changed and changed back */
+		ConVar *pConVar = pInfo->pVar;
+		if (strcmp(pConVar->GetString(), pInfo->pendingOldValue.c_str()) == 0)
+		{
+			continue;
+		}
+
+		handles.push_back(pInfo->handle);
+
+		IChangeableForward *pForward = pInfo->pDeferredForward;
+		if (pForward != NULL && pForward->GetFunctionCount() != 0)
+		{
+			pForward->PushCell(pInfo->handle);
+			pForward->PushString(pInfo->pendingOldValue.c_str());
+			pForward->PushString(pConVar->GetString());
+			pForward->Execute(NULL);
+		}
+	}
+
+	if (m_pBatchForward != NULL && m_pBatchForward->GetFunctionCount() != 0 && !handles.empty())
+	{
+		m_pBatchForward->PushArray(&handles[0], handles.size());
+		m_pBatchForward->PushCell(handles.size());
+		m_pBatchForward->Execute(NULL);
+	}
+	m_Flushing = false;
+
+	/* Free forwards that were emptied while they were running */
+	for (size_t i = 0; i < m_FlushList.size(); i++)
+	{
+		ConVarInfo *pInfo = m_FlushList[i];
+		if (pInfo != NULL && pInfo->pDeferredForward != NULL && pInfo->pDeferredForward->GetFunctionCount() == 0)
+		{
+			forwardsys->ReleaseForward(pInfo->pDeferredForward);
+			pInfo->pDeferredForward = NULL;
+		}
+	}
+	m_FlushList.clear();
+	if (m_pBatchForward != NULL && m_pBatchForward->GetFunctionCount() == 0)
+	{
+		forwardsys->ReleaseForward(m_pBatchForward);
+		m_pBatchForward = NULL;
+	}
+}
+
 QueryCvarCookie_t ConVarManager::QueryClientConVar(edict_t *pPlayer, const char *name, IPluginFunction *pCallback, Handle_t hndl)
 {
 	QueryCvarCookie_t cookie = sCoreProviderImpl.QueryClientConVar(IndexOfEdict(pPlayer), name);
 
 	if (pCallback != NULL)
 	{
-		ConVarQuery query = { cookie, pCallback, (cell_t) hndl, IndexOfEdict(pPlayer) };
-		m_ConVarQueries.push_back(query);
+		ConVarQuery query = { cookie, pCallback, (cell_t) hndl, IndexOfEdict(pPlayer), NULL, 0 };
+		ConVarQueryMap::Insert i = m_ConVarQueries.findForAdd(cookie);
+		if (i.found())
+		{
+			i->value = query;
+		}
+		else
+		{
+			m_ConVarQueries.add(i, cookie, query);
+		}
 	}
 
 	return cookie;
 }
 
+bool ConVarManager::QueryClientConVarBatch(int client, const char *const *names, unsigned int count,
+                                           IPluginFunction *pCallback, cell_t value)
+{
+	ConVarQueryBatch *pBatch = new ConVarQueryBatch();
+	pBatch->pCallback = pCallback;
+	pBatch->value = value;
+	pBatch->client = client;
+	pBatch->pending = 0;
+	pBatch->results.resize(count, eQueryCvarValueStatus_Cancelled);
+	pBatch->values.resize(count);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		QueryCvarCookie_t cookie = sCoreProviderImpl.QueryClientConVar(client, names[i]);
+		if (cookie == InvalidQueryCvarCookie)
+		{
+			continue;
+		}
+
+		ConVarQuery query = { cookie, pCallback, value, client, pBatch, i };
+		ConVarQueryMap::Insert ins = m_ConVarQueries.findForAdd(cookie);
+		if (ins.found())
+		{
+			ins->value = query;
+		}
+		else
+		{
+			m_ConVarQueries.add(ins, cookie, query);
+		}
+		pBatch->pending++;
+	}
+
+	if (pBatch->pending == 0)
+	{
+		delete pBatch;
+		return false;
+	}
+
+	return true;
+}
+
+void ConVarManager::CompleteBatchQuery(const ConVarQuery &query, cell_t result, const char *value, bool fire)
+{
+	ConVarQueryBatch *pBatch = query.pBatch;
+	pBatch->results[query.batchIndex] = result;
+	pBatch->values[query.batchIndex] = value;
+
+	if (--pBatch->pending != 0)
+	{
+		return;
+	}
+
+	if (fire)
+	{
+		cell_t ret;
+		ConVarQueryBatch *pPrevious = m_pCurrentBatch;
+		m_pCurrentBatch = pBatch;
+
+		pBatch->pCallback->PushCell(pBatch->client);
+		pBatch->pCallback->PushArray(pBatch->results.data(), pBatch->results.size());
+		pBatch->pCallback->PushCell(pBatch->results.size());
+		pBatch->pCallback->PushCell(pBatch->value);
+		pBatch->pCallback->Execute(&ret);
+
+		m_pCurrentBatch = pPrevious;
+	}
+
+	delete pBatch;
+}
+
 void ConVarManager::AddConVarToPluginList(IPlugin *plugin, const ConVar *pConVar)
 {
 	ConVarList *pConVarList;
@@ -640,6 +1002,12 @@ void ConVarManager::OnConVarChanged(ConVar *pConVar, const char *oldValue, float
 
 	IChangeableForward *pForward = pInfo->pChangeForward;
 
+	/* Update bound variables first, so change hooks already see the new value */
+	for (List<ConVarBinding>::iterator iter = pInfo->bindings.begin(); iter != pInfo->bindings.end(); iter++)
+	{
+		WriteBinding((*iter), pConVar);
+	}
+
 	if (pInfo->changeListeners.size() != 0)
 	{
 		for (auto i = pInfo->changeListeners.begin(); i != pInfo->changeListeners.end(); i++)
@@ -656,6 +1024,11 @@ void ConVarManager::OnConVarChanged(ConVar *pConVar, const char *oldValue, float
 		pForward->PushString(pConVar->GetString());
 		pForward->Execute(NULL);
 	}
+
+	if (pInfo->pDeferredForward != NULL || m_pBatchForward != NULL)
+	{
+		QueueDeferredChange(pInfo, oldValue);
+	}
 }
 
 bool ConVarManager::IsQueryingSupported()
@@ -670,21 +1043,25 @@ void ConVarManager::OnClientQueryFinished(QueryCvarCookie_t cookie,
 										  const char *cvarName,
 										  const char *cvarValue)
 {
-	IPluginFunction *pCallback = NULL;
-	cell_t value = 0;
-	List<ConVarQuery>::iterator iter;
+	ConVarQueryMap::Result r = m_ConVarQueries.find(cookie);
+	if (!r.found())
+	{
+		return;
+	}
+
+	ConVarQuery query = r->value;
+	m_ConVarQueries.remove(r);
 
-	for (iter = m_ConVarQueries.begin(); iter != m_ConVarQueries.end(); iter++)
+	if (query.pBatch)
 	{
-		ConVarQuery &query = (*iter);
-		if (query.cookie == cookie)
-		{
-			pCallback = query.pCallback;
-			value = query.value;
-			break;
-		}
+		const char *value = (result == eQueryCvarValueStatus_ValueIntact) ? cvarValue : "";
+		CompleteBatchQuery(query, result, value, true);
+		return;
 	}
 
+	IPluginFunction *pCallback = query.pCallback;
+	cell_t value = query.value;
+
 	if (pCallback)
 	{
 		cell_t ret;
@@ -705,8 +1082,6 @@ void ConVarManager::OnClientQueryFinished(QueryCvarCookie_t cookie,
 
 		pCallback->PushCell(value);
 		pCallback->Execute(&ret);
-
-		m_ConVarQueries.erase(iter);
 	}
 }
 #endif
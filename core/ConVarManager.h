@@ -44,6 +44,9 @@
 #include "concmd_cleaner.h"
 #include "PlayerManager.h"
 #include <sm_hashmap.h>
+#include <am-hashmap.h>
+#include <string>
+#include <vector>
 
 using namespace SourceHook;
 
@@ -53,6 +56,25 @@ public:
 	virtual void OnConVarChanged(ConVar *pConVar, const char *oldValue, float flOldValue) =0;
 };
 
+enum ConVarBindType
+{
+	ConVarBind_Bool,
+	ConVarBind_Int,
+	ConVarBind_Float,
+	ConVarBind_String,
+};
+
+/**
+ * A plugin variable that is rewritten whenever its convar changes
+ */
+struct ConVarBinding
+{
+	IPluginContext *pContext;			/**< Plugin owning the variable */
+	cell_t addr;						/**< Address of the variable */
+	ConVarBindType type;				/**< How to convert the value */
+	size_t maxlength;					/**< Buffer size for ConVarBind_String */
+};
+
 /**
  * Holds SourceMod-specific information about a convar
  */
@@ -61,9 +83,13 @@ struct ConVarInfo
 	Handle_t handle;					/**< Handle to self */
 	bool sourceMod;						/**< Determines whether or not convar was created by a SourceMod plugin */
 	IChangeableForward *pChangeForward;	/**< Forward associated with convar */
+	IChangeableForward *pDeferredForward;	/**< Forward called once per frame with the net change */
+	bool changePending;					/**< Convar is queued for deferred delivery */
+	std::string pendingOldValue;		/**< Value before the first change this frame */
 	ConVar *pVar;						/**< The actual convar */
 	IPlugin *pPlugin; 					/**< Originally owning plugin */
 	List<IConVarChangeListener *> changeListeners;
+	List<ConVarBinding> bindings;		/**< Plugin variables bound to the value */
 
 	struct ConVarPolicy
 	{
@@ -79,12 +105,24 @@ struct ConVarInfo
 
 		static inline uint32_t hash(const detail::CharsAndLength &key)
 		{
-			std::string lower = ke::Lowercase(key.c_str());
-			return detail::CharsAndLength(lower.c_str()).hash();
+			return key.foldedHash();
 		}
 	};
 };
 
+/**
+ * Collects one client's results for a batch of convar queries
+ */
+struct ConVarQueryBatch
+{
+	IPluginFunction *pCallback;			/**< Function that will be called when all queries are finished */
+	cell_t value;						/**< Optional value passed to query function */
+	cell_t client;						/**< Client being queried */
+	unsigned int pending;				/**< Queries that have not returned yet */
+	std::vector<cell_t> results;		/**< ConVarQueryResult per cvar, in request order */
+	std::vector<std::string> values;	/**< Value per cvar, in request order */
+};
+
 /**
  * Holds information about a client convar query
  */
@@ -94,6 +132,8 @@ struct ConVarQuery
 	IPluginFunction *pCallback;			/**< Function that will be called when query is finished */
 	cell_t value;						/**< Optional value passed to query function */
 	cell_t client;						/**< Only used for cleaning up on client disconnection */
+	ConVarQueryBatch *pBatch;			/**< Batch this query is part of, or NULL */
+	unsigned int batchIndex;			/**< Position of this query within its batch */
 };
 
 class ConVarManager :
@@ -115,6 +155,7 @@ public: // IHandleTypeDispatch
 	void OnHandleDestroy(HandleType_t type, void *object);
 	bool GetHandleApproxSize(HandleType_t type, void *object, unsigned int *pSize);
 public: // IPluginsListener
+	void OnPluginCreated(IPlugin *plugin);
 	void OnPluginUnloaded(IPlugin *plugin);
 public: //IRootConsoleCommand
 	void OnRootConsoleCommand(const char *cmdname, const ICommandArgs *command) override;
@@ -136,13 +177,33 @@ public:
 
 	/**
 	 * Add a function to call when the specified convar changes.
+	 *
+	 * Deferred hooks are called once, at the start of the next frame, with the
+	 * value from before the first change and the final value.
 	 */
-	void HookConVarChange(ConVar *pConVar, IPluginFunction *pFunction);
+	void HookConVarChange(ConVar *pConVar, IPluginFunction *pFunction, bool deferred = false);
 
 	/**
 	 * Remove a function from the forward that will be called when the specified convar changes.
 	 */
-	void UnhookConVarChange(ConVar *pConVar, IPluginFunction *pFunction);
+	void UnhookConVarChange(ConVar *pConVar, IPluginFunction *pFunction, bool deferred = false);
+
+	/**
+	 * Add or remove a function to call once per frame with every convar that
+	 * changed during the previous frame.
+	 */
+	void AddBatchChangeHook(IPluginFunction *pFunction);
+	bool RemoveBatchChangeHook(IPluginFunction *pFunction);
+
+	/**
+	 * Copy the convar's value into a plugin variable now and on every change.
+	 */
+	void BindConVar(ConVar *pConVar, IPluginContext *pContext, cell_t addr, ConVarBindType type, size_t maxlength);
+
+	/**
+	 * Remove every variable a plugin has bound to the specified convar.
+	 */
+	void UnbindConVar(ConVar *pConVar, IPluginContext *pContext);
 
 	void AddConVarChangeListener(const char *name, IConVarChangeListener *pListener);
 	void RemoveConVarChangeListener(const char *name, IConVarChangeListener *pListener);
@@ -153,6 +214,21 @@ public:
 	QueryCvarCookie_t QueryClientConVar(edict_t *pPlayer, const char *name, IPluginFunction *pCallback,
 	                                    Handle_t hndl);
 
+	/**
+	 * Starts queries for several convars on one client, with a single callback
+	 * once every one of them has finished.
+	 */
+	bool QueryClientConVarBatch(int client, const char *const *names, unsigned int count,
+	                            IPluginFunction *pCallback, cell_t value);
+
+	/**
+	 * Returns the batch whose callback is currently running, or NULL.
+	 */
+	inline const ConVarQueryBatch *GetCurrentQueryBatch() const
+	{
+		return m_pCurrentBatch;
+	}
+
 	bool IsQueryingSupported();
 
 	HandleError ReadConVarHandle(Handle_t hndl, ConVar **pVar, IPlugin **ppPlugin = nullptr);
@@ -173,10 +249,50 @@ private:
 	 * Adds a convar to a plugin's list.
 	 */
 	static void AddConVarToPluginList(IPlugin *plugin, const ConVar *pConVar);
+
+	/**
+	 * Records one query's result in its batch, firing the batch callback once
+	 * it was the last outstanding query.
+	 */
+	void CompleteBatchQuery(const ConVarQuery &query, cell_t result, const char *value, bool fire);
+
+	/**
+	 * Writes the convar's current value into a bound plugin variable.
+	 */
+	static void WriteBinding(const ConVarBinding &binding, ConVar *pConVar);
+
+	/**
+	 * Queues a change for the deferred and batch hooks.
+	 */
+	void QueueDeferredChange(ConVarInfo *pInfo, const char *oldValue);
+
+	/**
+	 * Delivers every queued change to the deferred and batch hooks.
+	 */
+	void FlushDeferredChanges();
+	static void FlushDeferredChangesAction(void *data);
 private:
 	HandleType_t m_ConVarType;
 	List<ConVarInfo *> m_ConVars;
-	List<ConVarQuery> m_ConVarQueries;
+	struct QueryCookiePolicy
+	{
+		static inline uint32_t hash(const QueryCvarCookie_t key)
+		{
+			return ke::HashInt32(key);
+		}
+		static inline bool matches(const QueryCvarCookie_t find, const QueryCvarCookie_t &key)
+		{
+			return find == key;
+		}
+	};
+	typedef ke::HashMap<QueryCvarCookie_t, ConVarQuery, QueryCookiePolicy> ConVarQueryMap;
+	ConVarQueryMap m_ConVarQueries;
+	ConVarQueryBatch *m_pCurrentBatch;
+	std::vector<ConVarInfo *> m_PendingChanges;
+	std::vector<ConVarInfo *> m_FlushList;
+	IChangeableForward *m_pBatchForward;
+	bool m_FlushQueued;
+	bool m_Flushing;
 };
 
 extern ConVarManager g_ConVarManager;
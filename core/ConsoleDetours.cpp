@@ -399,10 +399,16 @@ cell_t ConsoleDetours::Dispatch(ConCommand *pBase)
 	CCommand args;
 #endif
 	EngineArgs cargs(args);
+	int client = sCoreProviderImpl.CommandClient();
+
+	/* Flooded commands are dropped before listeners or the command itself run. */
+	if (client && !g_ConCmds.ChargeClientCommand(client, cargs.Arg(0)))
+		return Pl_Stop;
+
 	cell_t res;
 	{
 		AutoEnterCommand autoEnterCommand(&cargs);
-		res = g_ConsoleDetours.InternalDispatch(sCoreProviderImpl.CommandClient(), &cargs);
+		res = g_ConsoleDetours.InternalDispatch(client, &cargs);
 	}
 
 	return res;
@@ -52,6 +52,10 @@ public: // SMGlobalClass
 	void OnSourceModAllInitialized();
 	void OnSourceModShutdown();
 	void OnSourceModLevelChange(const char *mapName);
+	const char *GetGlobalClassName()
+	{
+		return "CoreConfig";
+	}
 public: // ITextListener_SMC
 	SMCResult ReadSMC_KeyValue(const SMCStates *states, const char *key, const char *value);
 public: // IRootConsoleCommand
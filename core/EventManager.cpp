@@ -120,12 +120,70 @@ void EventManager::OnHandleDestroy(HandleType_t type, void *object)
 
 void EventManager::OnPluginUnloaded(IPlugin *plugin)
 {
-	EventHookList *pHookList;
+	EventHookList *pHookList = NULL;
 	EventHookList::iterator iter;
 	EventHook *pHook;
 
+	plugin->GetProperty("EventHooks", reinterpret_cast<void **>(&pHookList), true);
+
+	// Filtered hooks aren't in the forwards, so they have to be dropped by hand. Each one holds a
+	// reference, except the one that created the hook: the hook list below drops that one.
+	IPluginContext *pContext = plugin->GetBaseContext();
+	std::vector<EventHook *> unused;
+	for (NameHashSet<EventHook *>::iterator hooks = m_EventHooks.iter(); !hooks.empty(); hooks.next())
+	{
+		pHook = *hooks;
+
+		bool isCreator = pHookList && pHookList->find(pHook) != pHookList->end();
+		bool keepCreatorRef = isCreator && pHook->createdFiltered;
+
+		std::vector<FilteredEventHook> *lists[] = {&pHook->preFiltered, &pHook->postFiltered};
+		for (size_t i = 0; i < 2; i++)
+		{
+			std::vector<FilteredEventHook> &list = *lists[i];
+			for (size_t j = 0; j < list.size(); )
+			{
+				if (list[j].pFunction->GetParentContext() != pContext)
+				{
+					j++;
+					continue;
+				}
+
+				list.erase(list.begin() + j);
+
+				if (keepCreatorRef)
+				{
+					keepCreatorRef = false;
+					continue;
+				}
+				pHook->refCount--;
+			}
+		}
+
+		/* Only possible once the creator is gone, so no hook list points at it anymore */
+		if (pHook->refCount == 0 && !isCreator)
+		{
+			unused.push_back(pHook);
+		}
+	}
+
+	for (size_t i = 0; i < unused.size(); i++)
+	{
+		pHook = unused[i];
+		if (pHook->pPreHook)
+		{
+			forwardsys->ReleaseForward(pHook->pPreHook);
+		}
+		if (pHook->pPostHook)
+		{
+			forwardsys->ReleaseForward(pHook->pPostHook);
+		}
+		m_EventHooks.remove(pHook->name.c_str());
+		delete pHook;
+	}
+
 	// If plugin has an event hook list...
-	if (plugin->GetProperty("EventHooks", reinterpret_cast<void **>(&pHookList), true))
+	if (pHookList)
 	{
 		for (iter = pHookList->begin(); iter != pHookList->end(); iter++)
 		{
@@ -143,6 +201,7 @@ void EventManager::OnPluginUnloaded(IPlugin *plugin)
 					forwardsys->ReleaseForward(pHook->pPostHook);
 				}
 
+				m_EventHooks.remove(pHook->name.c_str());
 				delete pHook;
 			}
 		}
@@ -165,7 +224,8 @@ int EventManager::GetEventDebugID()
 }
 #endif
 
-EventHookError EventManager::HookEvent(const char *name, IPluginFunction *pFunction, EventHookMode mode)
+EventHookError EventManager::HookEvent(const char *name, IPluginFunction *pFunction, EventHookMode mode,
+	const EventFilter *filter)
 {
 	EventHook *pHook;
 
@@ -196,7 +256,18 @@ EventHookError EventManager::HookEvent(const char *name, IPluginFunction *pFunct
 		/* Create new GameEventHook structure */
 		pHook = new EventHook();
 
-		if (mode == EventHookMode_Pre)
+		if (filter)
+		{
+			FilteredEventHook filtered = {pFunction, mode, *filter, pHook->nextFilterId++};
+			if (mode == EventHookMode_Pre)
+			{
+				pHook->preFiltered.push_back(filtered);
+			} else {
+				pHook->postFiltered.push_back(filtered);
+			}
+			pHook->createdFiltered = true;
+		}
+		else if (mode == EventHookMode_Pre)
 		{
 			/* Create forward for a pre hook */
 			pHook->pPreHook = forwardsys->CreateForwardEx(NULL, ET_Hook, 3, GAMEEVENT_PARAMS);
@@ -226,7 +297,21 @@ EventHookError EventManager::HookEvent(const char *name, IPluginFunction *pFunct
 
 	/* Hook structure already exists at this point */
 
-	if (mode == EventHookMode_Pre)
+	if (filter)
+	{
+		FilteredEventHook filtered = {pFunction, mode, *filter, pHook->nextFilterId++};
+		if (mode == EventHookMode_Pre)
+		{
+			pHook->preFiltered.push_back(filtered);
+		} else {
+			if (pHook->postFiltered.size() >= MAX_FILTERED_POST_HOOKS)
+			{
+				return EventHookErr_TooManyFilters;
+			}
+			pHook->postFiltered.push_back(filtered);
+		}
+	}
+	else if (mode == EventHookMode_Pre)
 	{
 		/* Create pre hook forward if necessary */
 		if (!pHook->pPreHook)
@@ -259,6 +344,20 @@ EventHookError EventManager::HookEvent(const char *name, IPluginFunction *pFunct
 	return EventHookErr_Okay;
 }
 
+static bool RemoveFilteredHook(std::vector<FilteredEventHook> &list, IPluginFunction *pFunction, EventHookMode mode)
+{
+	for (size_t i = 0; i < list.size(); i++)
+	{
+		if (list[i].pFunction == pFunction && list[i].mode == mode)
+		{
+			list.erase(list.begin() + i);
+			return true;
+		}
+	}
+
+	return false;
+}
+
 EventHookError EventManager::UnhookEvent(const char *name, IPluginFunction *pFunction, EventHookMode mode)
 {
 	EventHook *pHook;
@@ -270,25 +369,35 @@ EventHookError EventManager::UnhookEvent(const char *name, IPluginFunction *pFun
 		return EventHookErr_NotActive;
 	}
 
-	/* One forward to rule them all */
-	if (mode == EventHookMode_Pre)
+	/* Filtered hooks aren't in the forwards, so try those first */
+	if (!RemoveFilteredHook((mode == EventHookMode_Pre) ? pHook->preFiltered : pHook->postFiltered, pFunction, mode))
 	{
-		pEventForward = &pHook->pPreHook;
-	} else {
-		pEventForward = &pHook->pPostHook;
-	}
+		/* One forward to rule them all */
+		if (mode == EventHookMode_Pre)
+		{
+			pEventForward = &pHook->pPreHook;
+		} else {
+			pEventForward = &pHook->pPostHook;
+		}
 
-	/* Remove function from forward's list */
-	if (*pEventForward == NULL || !(*pEventForward)->RemoveFunction(pFunction))
-	{
-		return EventHookErr_InvalidCallback;
-	}
+		/* Remove function from forward's list */
+		if (*pEventForward == NULL || !(*pEventForward)->RemoveFunction(pFunction))
+		{
+			return EventHookErr_InvalidCallback;
+		}
 
-	/* If forward's list contains 0 functions now, free it */
-	if ((*pEventForward)->GetFunctionCount() == 0)
-	{
-		forwardsys->ReleaseForward(*pEventForward);
-		*pEventForward = NULL;
+		/* If forward's list contains 0 functions now, free it */
+		if ((*pEventForward)->GetFunctionCount() == 0)
+		{
+			forwardsys->ReleaseForward(*pEventForward);
+			*pEventForward = NULL;
+
+			/* With no post hooks left, nothing needs a copy of the event anymore */
+			if (mode != EventHookMode_Pre)
+			{
+				pHook->postCopy = false;
+			}
+		}
 	}
 
 	/* Decrement reference count */
@@ -381,6 +490,29 @@ void EventManager::CancelCreatedEvent(EventInfo *pInfo)
 	m_FreeEvents.push(pInfo);
 }
 
+static bool EventFilterMatches(const EventFilter &filter, IGameEvent *pEvent)
+{
+	const char *key = filter.key.c_str();
+
+	switch (filter.type)
+	{
+	case EventFilter_Equals:
+		return pEvent->GetInt(key) == filter.value;
+	case EventFilter_StringEquals:
+		return strcmp(pEvent->GetString(key), filter.str.c_str()) == 0;
+	case EventFilter_IsClient:
+		{
+			int client = g_Players.GetClientOfUserId(pEvent->GetInt(key));
+			CPlayer *pPlayer = g_Players.GetPlayerByIndex(client);
+			return pPlayer && pPlayer->IsConnected();
+		}
+	case EventFilter_NonZero:
+		return pEvent->GetInt(key) != 0;
+	}
+
+	return false;
+}
+
 /* IGameEventManager2::FireEvent hook */
 bool EventManager::OnFireEvent(IGameEvent *pEvent, bool bDontBroadcast)
 {
@@ -408,7 +540,7 @@ bool EventManager::OnFireEvent(IGameEvent *pEvent, bool bDontBroadcast)
 
 		pForward = pHook->pPreHook;
 
-		if (pForward)
+		if (pForward || !pHook->preFiltered.empty())
 		{
 			EventInfo info(pEvent, NULL);
 			HandleSecurity sec(NULL, g_pCoreIdent);
@@ -416,22 +548,64 @@ bool EventManager::OnFireEvent(IGameEvent *pEvent, bool bDontBroadcast)
 
 			info.bDontBroadcast = bDontBroadcast;
 
-			EventForwardFilter filter(&info);
+			if (pForward)
+			{
+				EventForwardFilter filter(&info);
 
-			pForward->PushCell(hndl);
-			pForward->PushString(name);
-			pForward->PushCell(bDontBroadcast);
-			pForward->Execute(&res, &filter);
+				pForward->PushCell(hndl);
+				pForward->PushString(name);
+				pForward->PushCell(bDontBroadcast);
+				pForward->Execute(&res, &filter);
+			}
+
+			/* Index instead of iterating, a callback may unhook itself */
+			for (size_t i = 0; i < pHook->preFiltered.size() && res < Pl_Stop; i++)
+			{
+				IPluginFunction *pFunction = pHook->preFiltered[i].pFunction;
+				if (!pFunction->IsRunnable() || !EventFilterMatches(pHook->preFiltered[i].filter, pEvent))
+				{
+					continue;
+				}
+
+				cell_t tempres = Pl_Continue;
+				pFunction->PushCell(hndl);
+				pFunction->PushString(name);
+				pFunction->PushCell(info.bDontBroadcast);
+				if (pFunction->Execute(&tempres) == SP_ERROR_NONE && tempres > res)
+				{
+					res = tempres;
+				}
+			}
 
 			broadcast = info.bDontBroadcast;
 
 			handlesys->FreeHandle(hndl, &sec);
 		}
 
-		if (pHook->postCopy)
+		/* The engine frees the event before the post hook runs, so post filters are checked
+		 * now, and a copy is the only way post hooks can read the event.  Only pay for one if
+		 * a post hook that reads the event will actually be called, and always push a slot so
+		 * the post hook stays in step with this stack.
+		 */
+		EventPostState state;
+		state.pCopy = NULL;
+		state.numMatched = 0;
+
+		bool needCopy = pHook->postCopy && pHook->pPostHook && pHook->pPostHook->GetFunctionCount() != 0;
+		for (size_t i = 0; i < pHook->postFiltered.size() && state.numMatched < MAX_FILTERED_POST_HOOKS; i++)
 		{
-			m_EventCopies.push(gameevents->DuplicateEvent(pEvent));
+			if (EventFilterMatches(pHook->postFiltered[i].filter, pEvent))
+			{
+				state.matched[state.numMatched++] = pHook->postFiltered[i].id;
+				needCopy = needCopy || pHook->postFiltered[i].mode == EventHookMode_Post;
+			}
+		}
+
+		if (needCopy)
+		{
+			state.pCopy = gameevents->DuplicateEvent(pEvent);
 		}
+		m_EventCopies.push(state);
 
 		if (res >= Pl_Handled)
 		{
@@ -468,36 +642,60 @@ bool EventManager::OnFireEvent_Post(IGameEvent *pEvent, bool bDontBroadcast)
 
 	if (pHook != NULL)
 	{
+		EventPostState state = m_EventCopies.front();
+		m_EventCopies.pop();
+
 		pForward = pHook->pPostHook;
 
-		if (pForward)
+		if (state.pCopy)
 		{
-			if (pHook->postCopy)
-			{
-				info.bDontBroadcast = bDontBroadcast;
-				info.pEvent = m_EventCopies.front();
-				info.pOwner = NULL;
-				hndl = handlesys->CreateHandle(m_EventType, &info, NULL, g_pCoreIdent, NULL);
-
-				pForward->PushCell(hndl);
-			} else {
-				pForward->PushCell(BAD_HANDLE);
-			}
+			info.bDontBroadcast = bDontBroadcast;
+			info.pEvent = state.pCopy;
+			info.pOwner = NULL;
+			hndl = handlesys->CreateHandle(m_EventType, &info, NULL, g_pCoreIdent, NULL);
+		}
 
+		if (pForward)
+		{
+			pForward->PushCell(pHook->postCopy ? hndl : BAD_HANDLE);
 			pForward->PushString(pHook->name.c_str());
 			pForward->PushCell(bDontBroadcast);
 			pForward->Execute(NULL);
+		}
 
-			if (pHook->postCopy)
+		/* A callback may unhook (or hook) filtered post hooks, so look each one up by id again */
+		for (unsigned int slot = 0; slot < state.numMatched; slot++)
+		{
+			size_t i = 0;
+			while (i < pHook->postFiltered.size() && pHook->postFiltered[i].id != state.matched[slot])
 			{
-				/* Free handle */
-				HandleSecurity sec(NULL, g_pCoreIdent);
-				handlesys->FreeHandle(hndl, &sec);
+				i++;
+			}
+			if (i == pHook->postFiltered.size())
+			{
+				continue;
+			}
 
-				/* Free event structure */
-				gameevents->FreeEvent(info.pEvent);
-				m_EventCopies.pop();
+			IPluginFunction *pFunction = pHook->postFiltered[i].pFunction;
+			if (!pFunction->IsRunnable())
+			{
+				continue;
 			}
+
+			pFunction->PushCell(pHook->postFiltered[i].mode == EventHookMode_Post ? hndl : BAD_HANDLE);
+			pFunction->PushString(pHook->name.c_str());
+			pFunction->PushCell(bDontBroadcast);
+			pFunction->Execute(NULL);
+		}
+
+		if (state.pCopy)
+		{
+			/* Free handle */
+			HandleSecurity sec(NULL, g_pCoreIdent);
+			handlesys->FreeHandle(hndl, &sec);
+
+			/* Free event structure */
+			gameevents->FreeEvent(state.pCopy);
 		}
 
 		/* Decrement reference count, check if a delayed delete is needed */
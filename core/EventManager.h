@@ -40,6 +40,7 @@
 #include <IHandleSys.h>
 #include <IForwardSys.h>
 #include <IPluginSys.h>
+#include <vector>
 
 class IClient;
 
@@ -58,6 +59,46 @@ struct EventInfo
 	bool bDontBroadcast;
 };
 
+enum EventHookMode
+{
+	EventHookMode_Pre,
+	EventHookMode_Post,
+	EventHookMode_PostNoCopy
+};
+
+enum EventFilterType
+{
+	EventFilter_Equals,			/**< Integer key equals the value */
+	EventFilter_StringEquals,	/**< String key equals the string */
+	EventFilter_IsClient,		/**< Integer key is the userid of a connected client */
+	EventFilter_NonZero,		/**< Integer key is not zero */
+};
+
+struct EventFilter
+{
+	EventFilterType type;
+	std::string key;
+	int value;
+	std::string str;
+};
+
+/* A hook whose callback is only called when its filter matches. These don't go through the
+ * hook's forwards, so the filter is checked before any transition into the plugin.
+ */
+struct FilteredEventHook
+{
+	IPluginFunction *pFunction;
+	EventHookMode mode;
+	EventFilter filter;
+	unsigned int id;
+};
+
+/* Post filters are checked in the pre hook (the event is gone by the post hook), so each
+ * fire records the ids of the ones that matched. Ids are never reused, so a hook removed or
+ * added by a callback in between can't shift the record onto another hook.
+ */
+#define MAX_FILTERED_POST_HOOKS		32
+
 struct EventHook
 {
 	EventHook()
@@ -66,12 +107,18 @@ struct EventHook
 		pPostHook = NULL;
 		postCopy = false;
 		refCount = 0;
+		createdFiltered = false;
+		nextFilterId = 0;
 	}
 	IChangeableForward *pPreHook;
 	IChangeableForward *pPostHook;
 	bool postCopy;
 	unsigned int refCount;
+	bool createdFiltered;		/* The creating plugin's reference is held by a filtered hook */
+	unsigned int nextFilterId;
 	std::string name;
+	std::vector<FilteredEventHook> preFiltered;
+	std::vector<FilteredEventHook> postFiltered;
 
 	static inline bool matches(const char *name, const EventHook *hook)
 	{
@@ -83,19 +130,21 @@ struct EventHook
 	}
 };
 
-enum EventHookMode
-{
-	EventHookMode_Pre,
-	EventHookMode_Post,
-	EventHookMode_PostNoCopy
-};
-
 enum EventHookError
 {
 	EventHookErr_Okay = 0,			/**< No error */
 	EventHookErr_InvalidEvent,		/**< Specified event does not exist */
 	EventHookErr_NotActive,			/**< Specified event has no active hook */
 	EventHookErr_InvalidCallback,	/**< Specified event does not fire specified callback */ 
+	EventHookErr_TooManyFilters,	/**< Specified event has too many filtered post hooks */
+};
+
+/* State carried from the pre hook of a fire to its post hook */
+struct EventPostState
+{
+	IGameEvent *pCopy;
+	unsigned int numMatched;
+	unsigned int matched[MAX_FILTERED_POST_HOOKS];
 };
 
 class EventManager :
@@ -128,7 +177,8 @@ public:
 		return m_EventType;
 	}
 public:
-	EventHookError HookEvent(const char *name, IPluginFunction *pFunction, EventHookMode mode=EventHookMode_Post);
+	EventHookError HookEvent(const char *name, IPluginFunction *pFunction, EventHookMode mode=EventHookMode_Post,
+		const EventFilter *filter=NULL);
 	EventHookError UnhookEvent(const char *name, IPluginFunction *pFunction, EventHookMode mode=EventHookMode_Post);
 	EventInfo *CreateEvent(IPluginContext *pContext, const char *name, bool force=false);
 	void FireEvent(EventInfo *pInfo, bool bDontBroadcast=false);
@@ -142,7 +192,7 @@ private:
 	NameHashSet<EventHook *> m_EventHooks;
 	CStack<EventInfo *> m_FreeEvents;
 	CStack<EventHook *> m_EventStack;
-	CStack<IGameEvent *> m_EventCopies;
+	CStack<EventPostState> m_EventCopies;
 };
 
 extern EventManager g_EventManager;
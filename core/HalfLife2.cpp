@@ -30,10 +30,12 @@
  */
 
 #include "HalfLife2.h"
+#include "MapIndex.h"
 #include "sourcemod.h"
 #include "sourcemm_api.h"
 #include "UserMessages.h"
 #include "PlayerManager.h"
+#include "ConCmdManager.h"
 #include "sm_stringutil.h"
 #include <IGameConfigs.h>
 #include <compat_wrappers.h>
@@ -80,8 +82,13 @@ static CEntInfo *EntInfoArray()
 CHalfLife2::CHalfLife2()
 {
 	m_Maps.init();
+	m_PropCacheSerial = 0;
+	m_NetpropTableMode = NetpropTables_Lazy;
+	m_bClassTablesPrebuilt = false;
+	m_bPrebuildDone = false;
 
 	m_pGetCommandLine = NULL;
+	m_bDeferStateChanges = false;
 }
 
 CHalfLife2::~CHalfLife2()
@@ -152,6 +159,46 @@ void CHalfLife2::OnSourceModAllInitialized_Post()
 ConfigResult CHalfLife2::OnSourceModConfigChanged(const char *key, const char *value,
 	ConfigSource source, char *error, size_t maxlength)
 {
+	if (strcasecmp(key, "DeferEdictStateChanges") == 0)
+	{
+		if (strcasecmp(value, "no") == 0)
+		{
+			FlushDeferredStateChanges();
+			m_bDeferStateChanges = false;
+			return ConfigResult_Accept;
+		}
+		else if (strcasecmp(value, "yes") == 0)
+		{
+			m_bDeferStateChanges = true;
+			return ConfigResult_Accept;
+		}
+
+		ke::SafeStrcpy(error, maxlength, "Invalid value: must be \"yes\" or \"no\"");
+		return ConfigResult_Reject;
+	}
+
+	if (strcasecmp(key, "NetpropTables") == 0)
+	{
+		if (strcasecmp(value, "lazy") == 0)
+		{
+			m_NetpropTableMode = NetpropTables_Lazy;
+		}
+		else if (strcasecmp(value, "levelinit") == 0)
+		{
+			m_NetpropTableMode = NetpropTables_LevelInit;
+		}
+		else if (strcasecmp(value, "background") == 0)
+		{
+			m_NetpropTableMode = NetpropTables_Background;
+		}
+		else
+		{
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be \"lazy\", \"levelinit\" or \"background\"");
+			return ConfigResult_Reject;
+		}
+		return ConfigResult_Accept;
+	}
+
 	if (strcasecmp(key, "FollowCSGOServerGuidelines") == 0)
 	{
 #if SOURCE_ENGINE == SE_CSGO
@@ -318,10 +365,47 @@ IChangeInfoAccessor *CBaseEdict::GetChangeAccessor()
 }
 #endif
 
-bool UTIL_FindInSendTable(SendTable *pTable, 
-						  const char *name,
-						  sm_sendprop_info_t *info,
-						  unsigned int offset)
+static void UTIL_GetSendPropInfo(SendProp *prop, unsigned int offset, sm_sendprop_info_t *info)
+{
+	SendTable *pInnerTable = prop->GetDataTable();
+
+	// get true offset of CUtlVector
+	if (utlVecOffsetOffset != -1 && prop->GetOffset() == 0 && pInnerTable && pInnerTable->GetNumProps())
+	{
+		SendProp *pLengthProxy = pInnerTable->GetProp(0);
+		const char *ipname = pLengthProxy->GetName();
+		if (ipname && strcmp(ipname, "lengthproxy") == 0 && pLengthProxy->GetExtraData())
+		{
+			info->prop = prop;
+			info->actual_offset = offset + *reinterpret_cast<size_t *>(reinterpret_cast<intptr_t>(pLengthProxy->GetExtraData()) + utlVecOffsetOffset);
+			return;
+		}
+	}
+	info->prop = prop;
+	info->actual_offset = offset + prop->GetOffset();
+}
+
+/**
+ * Adds |name| to a flattened table unless it is already there. Tables are
+ * filled depth-first, each prop before the tables nested in it, so where a
+ * name occurs more than once the entry kept is the first one a search by
+ * name would have found.
+ */
+template <typename Set, typename Entry>
+static void UTIL_AddFlatName(Set &set, const char *name, Entry &entry)
+{
+	typename Set::Insert i = set.findForAdd(name);
+	if (i.found())
+	{
+		return;
+	}
+	entry.name = name;
+	set.add(i, entry);
+}
+
+/* Nested props are also added by path, e.g. "m_Local.m_flStepSize"; base classes do not add a path component. */
+static void UTIL_FlattenSendTable(SendTable *pTable, const std::string &path, unsigned int offset,
+	NameHashSet<DataTableInfo::SendPropInfo> &lookup)
 {
 	int props = pTable->GetNumProps();
 	for (int i = 0; i < props; i++)
@@ -329,77 +413,76 @@ bool UTIL_FindInSendTable(SendTable *pTable,
 		SendProp *prop = pTable->GetProp(i);
 
 		// Skip InsideArray props (SendPropArray / SendPropArray2),
-		// we'll find them later by their containing array.
-		if (prop->IsInsideArray()) {
+		// they are reached through their containing array.
+		if (prop->IsInsideArray())
+		{
 			continue;
 		}
 
 		const char *pname = prop->GetName();
 		SendTable *pInnerTable = prop->GetDataTable();
+		std::string subpath = path;
 
-		if (pname && strcmp(name, pname) == 0)
+		if (pname)
 		{
-			// get true offset of CUtlVector
-			if (utlVecOffsetOffset != -1 && prop->GetOffset() == 0 && pInnerTable && pInnerTable->GetNumProps())
+			DataTableInfo::SendPropInfo entry;
+			UTIL_GetSendPropInfo(prop, offset, &entry.info);
+			UTIL_AddFlatName(lookup, pname, entry);
+
+			if (strcmp(pname, "baseclass") != 0)
 			{
-				SendProp *pLengthProxy = pInnerTable->GetProp(0);
-				const char *ipname = pLengthProxy->GetName();
-				if (ipname && strcmp(ipname, "lengthproxy") == 0 && pLengthProxy->GetExtraData())
+				subpath = path.empty() ? std::string(pname) : path + "." + pname;
+				if (!path.empty())
 				{
-					info->prop = prop;
-					info->actual_offset = offset + *reinterpret_cast<size_t *>(reinterpret_cast<intptr_t>(pLengthProxy->GetExtraData()) + utlVecOffsetOffset);
-					return true;
+					UTIL_AddFlatName(lookup, subpath.c_str(), entry);
 				}
 			}
-			info->prop = prop;
-			info->actual_offset = offset + info->prop->GetOffset();
-			return true;
 		}
+
 		if (pInnerTable)
 		{
-			if (UTIL_FindInSendTable(pInnerTable, 
-				name,
-				info,
-				offset + prop->GetOffset())
-				)
-			{
-				return true;
-			}
+			UTIL_FlattenSendTable(pInnerTable, subpath, offset + prop->GetOffset(), lookup);
 		}
 	}
-
-	return false;
 }
 
-bool UTIL_FindDataMapInfo(datamap_t *pMap, const char *name, sm_datatable_info_t *pDataTable)
+static void UTIL_FlattenDataMap(datamap_t *pMap, const std::string &path, unsigned int offset, DataMapCache &cache)
 {
-	while (pMap)
+	for (; pMap; pMap = pMap->baseMap)
 	{
 		for (int i = 0; i < pMap->dataNumFields; ++i)
 		{
-			if (pMap->dataDesc[i].fieldName == NULL)
+			typedescription_t *td = &pMap->dataDesc[i];
+			if (td->fieldName == NULL)
 			{
 				continue;
 			}
-			if (strcmp(name, pMap->dataDesc[i].fieldName) == 0)
+
+			DataMapCacheInfo entry;
+			entry.info.prop = td;
+			entry.info.actual_offset = offset + GetTypeDescOffs(td);
+			UTIL_AddFlatName(cache, td->fieldName, entry);
+
+			std::string subpath = path.empty() ? std::string(td->fieldName) : path + "." + td->fieldName;
+			if (!path.empty())
 			{
-				pDataTable->prop = &(pMap->dataDesc[i]);
-				pDataTable->actual_offset = GetTypeDescOffs(pDataTable->prop);
-				return true;
+				UTIL_AddFlatName(cache, subpath.c_str(), entry);
 			}
-			if (pMap->dataDesc[i].td == NULL || !UTIL_FindDataMapInfo(pMap->dataDesc[i].td, name, pDataTable))
+
+			if (td->td)
 			{
-				continue;
+				UTIL_FlattenDataMap(td->td, subpath, entry.info.actual_offset, cache);
 			}
-			
-			pDataTable->actual_offset += GetTypeDescOffs(&(pMap->dataDesc[i]));
-			return true;
 		}
-		
-		pMap = pMap->baseMap;
 	}
+}
 
-	return false; 
+/* Only reads engine data, so it is safe to run off the main thread. */
+static DataTableInfo *UTIL_BuildDataTableInfo(ServerClass *sc)
+{
+	DataTableInfo *pInfo = new DataTableInfo(sc);
+	UTIL_FlattenSendTable(sc->m_pTable, std::string(), 0, pInfo->lookup);
+	return pInfo;
 }
 
 ServerClass *CHalfLife2::FindServerClass(const char *classname)
@@ -423,27 +506,48 @@ ServerClass *CHalfLife2::FindEntityServerClass(CBaseEntity *pEntity)
 	return pNetwork->GetServerClass();
 }
 
+/**
+ * Class and prop names mostly arrive from plugin string literals and engine
+ * ServerClass names, which sit at the same address call after call. Those
+ * resolve through the site cache without being hashed again. Names are only
+ * interned once they are found, so the interned set is bounded by the props
+ * that exist.
+ */
+template <typename Set>
+typename Set::Result CHalfLife2::FindName(Set &set, const char *name)
+{
+	if (const InternedString *interned = m_NameSites.Find(name))
+	{
+		return set.find(interned->key());
+	}
+
+	typename Set::Result r = set.find(name);
+	if (r.found())
+	{
+		m_NameSites.Remember(name, m_Names.Intern(name));
+	}
+	return r;
+}
+
 DataTableInfo *CHalfLife2::_FindServerClass(const char *classname)
 {
-	DataTableInfo *pInfo = NULL;
-	if (!m_Classes.retrieve(classname, &pInfo))
+	NameHashSet<DataTableInfo *>::Result r = FindName(m_Classes, classname);
+	if (r.found())
 	{
-		ServerClass *sc = gamedll->GetAllServerClasses();
-		while (sc)
+		return *r;
+	}
+
+	for (ServerClass *sc = gamedll->GetAllServerClasses(); sc; sc = sc->m_pNext)
+	{
+		if (strcmp(classname, sc->GetName()) == 0)
 		{
-			if (strcmp(classname, sc->GetName()) == 0)
-			{
-				pInfo = new DataTableInfo(sc);
-				m_Classes.insert(classname, pInfo);
-				break;
-			}
-			sc = sc->m_pNext;
+			DataTableInfo *pInfo = UTIL_BuildDataTableInfo(sc);
+			m_Classes.insert(classname, pInfo);
+			return pInfo;
 		}
-		if (!pInfo)
-			return NULL;
 	}
 
-	return pInfo;
+	return NULL;
 }
 
 bool CHalfLife2::FindSendPropInfo(const char *classname, const char *offset, sm_sendprop_info_t *info)
@@ -455,25 +559,15 @@ bool CHalfLife2::FindSendPropInfo(const char *classname, const char *offset, sm_
 		return false;
 	}
 
-	DataTableInfo::SendPropInfo temp;
-
-	if (!pInfo->lookup.retrieve(offset, &temp))
+	/* The class table is complete, so a miss needs no tree walk. */
+	NameHashSet<DataTableInfo::SendPropInfo>::Result r = FindName(pInfo->lookup, offset);
+	if (!r.found())
 	{
-		bool found = UTIL_FindInSendTable(pInfo->sc->m_pTable, offset, &temp.info, 0);
-		temp.name = offset;
-
-		pInfo->lookup.insert(offset, temp);
-
-		if (found)
-		{
-			*info = temp.info;
-		}
-
-		return found;
+		return false;
 	}
 
-	*info = temp.info;
-	return info->prop != nullptr;
+	*info = r->info;
+	return true;
 }
 
 SendProp *CHalfLife2::FindInSendTable(const char *classname, const char *offset)
@@ -504,31 +598,92 @@ bool CHalfLife2::FindDataMapInfo(datamap_t *pMap, const char *offset, sm_datatab
 {
 	DataTableMap::Insert i = m_Maps.findForAdd(pMap);
 	if (!i.found())
-		m_Maps.add(i, pMap, new DataMapCache());
+	{
+		DataMapCache *cache = new DataMapCache();
+		UTIL_FlattenDataMap(pMap, std::string(), 0, *cache);
+		m_Maps.add(i, pMap, cache);
+	}
 
-	DataMapCache *cache = i->value;
-	DataMapCacheInfo temp;
+	DataMapCache::Result r = FindName(*i->value, offset);
+	if (!r.found())
+	{
+		return false;
+	}
+
+	*pDataTable = r->info;
+	return true;
+}
 
-	if (!cache->retrieve(offset, &temp))
+void CHalfLife2::OnSourceModLevelChange(const char *mapName)
+{
+	/* Server classes never change while the game is loaded; one build serves every map. */
+	if (m_NetpropTableMode == NetpropTables_Lazy || m_bClassTablesPrebuilt)
 	{
-		bool found = UTIL_FindDataMapInfo(pMap, offset, &temp.info);
-		temp.name = offset;
+		return;
+	}
+	m_bClassTablesPrebuilt = true;
 
-		cache->insert(offset, temp);
+	if (m_NetpropTableMode == NetpropTables_LevelInit)
+	{
+		for (ServerClass *sc = gamedll->GetAllServerClasses(); sc; sc = sc->m_pNext)
+		{
+			if (!m_Classes.contains(sc->GetName()))
+			{
+				m_Classes.insert(sc->GetName(), UTIL_BuildDataTableInfo(sc));
+			}
+		}
+		return;
+	}
+
+	PrebuildClassTables();
+}
+
+void CHalfLife2::PrebuildClassTables()
+{
+	ServerClass *classes = gamedll->GetAllServerClasses();
 
-		if (found)
+	m_bPrebuildDone = false;
+	m_PrebuildThread = std::thread([this, classes]() -> void {
+		for (ServerClass *sc = classes; sc; sc = sc->m_pNext)
 		{
-			*pDataTable = temp.info;
+			m_Prebuilt.push_back(UTIL_BuildDataTableInfo(sc));
 		}
+		m_bPrebuildDone.store(true, std::memory_order_release);
+	});
+}
+
+/* Hands the worker's tables over on the main thread. Classes already built lazily keep theirs. */
+void CHalfLife2::FinishClassTablePrebuild()
+{
+	m_PrebuildThread.join();
 
-		return found;
+	for (DataTableInfo *pInfo : m_Prebuilt)
+	{
+		NameHashSet<DataTableInfo *>::Insert i = m_Classes.findForAdd(pInfo->sc->GetName());
+		if (i.found())
+		{
+			delete pInfo;
+			continue;
+		}
+		m_Classes.add(i, pInfo);
 	}
+	m_Prebuilt.clear();
+}
 
-	*pDataTable = temp.info;
-	return pDataTable->prop != nullptr;
+void CHalfLife2::OnSourceModShutdown()
+{
+	if (m_PrebuildThread.joinable())
+	{
+		m_PrebuildThread.join();
+		for (DataTableInfo *pInfo : m_Prebuilt)
+		{
+			delete pInfo;
+		}
+		m_Prebuilt.clear();
+	}
 }
 
-void CHalfLife2::SetEdictStateChanged(edict_t *pEdict, unsigned short offset)
+static void EdictStateChanged(edict_t *pEdict, unsigned short offset)
 {
 #if SOURCE_ENGINE != SE_DARKMESSIAH
 	if (g_pSharedChangeInfo != NULL)
@@ -549,12 +704,124 @@ void CHalfLife2::SetEdictStateChanged(edict_t *pEdict, unsigned short offset)
 	}
 }
 
+void CHalfLife2::SetEdictStateChanged(edict_t *pEdict, unsigned short offset)
+{
+	if (m_bDeferStateChanges)
+	{
+		DeferEdictStateChanged(pEdict, offset);
+		return;
+	}
+
+	EdictStateChanged(pEdict, offset);
+}
+
+void CHalfLife2::DeferEdictStateChanged(edict_t *pEdict, unsigned short offset)
+{
+	int index = IndexOfEdict(pEdict);
+	if (index < 0)
+	{
+		EdictStateChanged(pEdict, offset);
+		return;
+	}
+
+	if ((size_t)index >= m_DeferredSlots.size())
+	{
+		m_DeferredSlots.resize(index + 1, 0);
+	}
+
+	int slot = m_DeferredSlots[index];
+	if (!slot)
+	{
+		DeferredStateChange change;
+		change.pEdict = pEdict;
+		change.count = 0;
+		m_DeferredChanges.push_back(change);
+		slot = m_DeferredSlots[index] = (int)m_DeferredChanges.size();
+	}
+
+	DeferredStateChange &change = m_DeferredChanges[slot - 1];
+	if (change.count > kMaxDeferredOffsets)
+	{
+		return;
+	}
+
+	if (!offset)
+	{
+		change.count = kMaxDeferredOffsets + 1;
+		return;
+	}
+
+	for (unsigned short i = 0; i < change.count; i++)
+	{
+		if (change.offsets[i] == offset)
+		{
+			return;
+		}
+	}
+
+	/* The engine would overflow into a full update here anyway. */
+	if (change.count == kMaxDeferredOffsets)
+	{
+		change.count = kMaxDeferredOffsets + 1;
+		return;
+	}
+
+	change.offsets[change.count++] = offset;
+}
+
+void CHalfLife2::FlushDeferredStateChanges()
+{
+	for (size_t i = 0; i < m_DeferredChanges.size(); i++)
+	{
+		DeferredStateChange &change = m_DeferredChanges[i];
+		m_DeferredSlots[IndexOfEdict(change.pEdict)] = 0;
+
+		if (change.pEdict->IsFree())
+		{
+			continue;
+		}
+
+		if (change.count > kMaxDeferredOffsets)
+		{
+			EdictStateChanged(change.pEdict, 0);
+			continue;
+		}
+
+		for (unsigned short j = 0; j < change.count; j++)
+		{
+			EdictStateChanged(change.pEdict, change.offsets[j]);
+		}
+	}
+
+	m_DeferredChanges.clear();
+}
+
+void CHalfLife2::OnGameFramePost(bool simulating)
+{
+	/* Runs after the game's frame and before the snapshot is built. */
+	if (!m_DeferredChanges.empty())
+	{
+		FlushDeferredStateChanges();
+	}
+
+	if (m_PrebuildThread.joinable() && m_bPrebuildDone.load(std::memory_order_acquire))
+	{
+		FinishClassTablePrebuild();
+	}
+}
+
 bool CHalfLife2::TextMsg(int client, int dest, const char *msg)
+{
+	cell_t players[] = {client};
+
+	return TextMsg(players, 1, dest, msg);
+}
+
+bool CHalfLife2::TextMsg(cell_t *players, int count, int dest, const char *msg)
 {
 #ifndef USE_PROTOBUF_USERMESSAGES
 	bf_write *pBitBuf = NULL;
 #endif
-	cell_t players[] = {client};
 
 	if (dest == HUD_PRINTTALK)
 	{
@@ -568,7 +835,7 @@ bool CHalfLife2::TextMsg(int client, int dest, const char *msg)
 
 #if SOURCE_ENGINE == SE_CSGO || SOURCE_ENGINE == SE_BLADE || SOURCE_ENGINE == SE_MCV
 			CCSUsrMsg_SayText *pMsg;
-			if ((pMsg = (CCSUsrMsg_SayText *)g_UserMsgs.StartProtobufMessage(m_SayTextMsg, players, 1, USERMSG_RELIABLE)) == NULL)
+			if ((pMsg = (CCSUsrMsg_SayText *)g_UserMsgs.StartProtobufMessage(m_SayTextMsg, players, count, USERMSG_RELIABLE)) == NULL)
 			{
 				return false;
 			}
@@ -577,7 +844,7 @@ bool CHalfLife2::TextMsg(int client, int dest, const char *msg)
 			pMsg->set_text(buffer);
 			pMsg->set_chat(false);
 #else
-			if ((pBitBuf = g_UserMsgs.StartBitBufMessage(m_SayTextMsg, players, 1, USERMSG_RELIABLE)) == NULL)
+			if ((pBitBuf = g_UserMsgs.StartBitBufMessage(m_SayTextMsg, players, count, USERMSG_RELIABLE)) == NULL)
 			{
 				return false;
 			}
@@ -595,7 +862,7 @@ bool CHalfLife2::TextMsg(int client, int dest, const char *msg)
 
 #if SOURCE_ENGINE == SE_CSGO || SOURCE_ENGINE == SE_BLADE || SOURCE_ENGINE == SE_MCV
 	CCSUsrMsg_TextMsg *pMsg;
-	if ((pMsg = (CCSUsrMsg_TextMsg *)g_UserMsgs.StartProtobufMessage(m_MsgTextMsg, players, 1, USERMSG_RELIABLE)) == NULL)
+	if ((pMsg = (CCSUsrMsg_TextMsg *)g_UserMsgs.StartProtobufMessage(m_MsgTextMsg, players, count, USERMSG_RELIABLE)) == NULL)
 	{
 		return false;
 	}
@@ -608,7 +875,7 @@ bool CHalfLife2::TextMsg(int client, int dest, const char *msg)
 	pMsg->add_params("");
 	pMsg->add_params("");
 #else
-	if ((pBitBuf = g_UserMsgs.StartBitBufMessage(m_MsgTextMsg, players, 1, USERMSG_RELIABLE)) == NULL)
+	if ((pBitBuf = g_UserMsgs.StartBitBufMessage(m_MsgTextMsg, players, count, USERMSG_RELIABLE)) == NULL)
 	{
 		return false;
 	}
@@ -776,7 +1043,9 @@ void CHalfLife2::ProcessFakeCliCmdQueue()
 		if (g_Players.GetClientOfUserId(pFake->userid) == pFake->client)
 		{
 			CPlayer *pPlayer = g_Players.GetPlayerByIndex(pFake->client);
+			g_ConCmds.EnterTrustedCommand();
 			serverpluginhelpers->ClientCommand(pPlayer->GetEdict(), pFake->cmd.c_str());
+			g_ConCmds.LeaveTrustedCommand();
 		}
 
 		m_CmdQueue.pop();
@@ -1328,13 +1597,30 @@ SMFindMapResult CHalfLife2::FindMap(const char *pMapName, char *pFoundMap, size_
 		return SMFindMapResult::NotFound;
 	}
 #endif
-	
+
+	SMFindMapResult result;
+	if (g_MapIndex.Lookup(pMapName, &result, pFoundMap, nMapNameMax))
+	{
+		return result;
+	}
+
+	/* pFoundMap may be pMapName; remember the result before overwriting it. */
+	char found[PLATFORM_MAX_PATH];
+	result = FindMapInEngine(pMapName, found, sizeof(found));
+	g_MapIndex.Remember(pMapName, result, found);
+
+	ke::SafeStrcpy(pFoundMap, nMapNameMax, found);
+	return result;
+}
+
+SMFindMapResult CHalfLife2::FindMapInEngine(const char *pMapName, char *pFoundMap, size_t nMapNameMax)
+{
 	ke::SafeStrcpy(pFoundMap, nMapNameMax, pMapName);
 
 #if SOURCE_ENGINE >= SE_LEFT4DEAD
 	static char mapNameTmp[PLATFORM_MAX_PATH];
 	g_SourceMod.Format(mapNameTmp, sizeof(mapNameTmp), "maps%c%s.bsp", PLATFORM_SEP_CHAR, pMapName);
-	if (filesystem->FileExists(mapNameTmp, "GAME"))
+	if (g_MapIndex.HasMapFile(pMapName) || filesystem->FileExists(mapNameTmp, "GAME"))
 	{
 		// If this is already an exact match, don't attempt to autocomplete it further (de_dust -> de_dust2).
 		// ... but still check that map file is actually valid.
@@ -1603,6 +1889,8 @@ uint64_t CHalfLife2::GetServerSteamId64() const
 
 void CHalfLife2::RemoveDataTableCache(datamap_t *pMap)
 {
+	m_PropCacheSerial++;
+
 	if (pMap == nullptr)
 	{
 		m_Maps.clear();
@@ -1614,6 +1902,8 @@ void CHalfLife2::RemoveDataTableCache(datamap_t *pMap)
 
 bool CHalfLife2::RemoveSendPropCache(const char *classname)
 {
+	m_PropCacheSerial++;
+
 	if (classname == nullptr)
 	{
 		m_Classes.clear();
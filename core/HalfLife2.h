@@ -40,6 +40,7 @@
 #include <am-hashmap.h>
 #include <sm_hashmap.h>
 #include <sm_namehashset.h>
+#include <sm_interned.h>
 #include "sm_globals.h"
 #include "sm_queue.h"
 #include <IGameHelpers.h>
@@ -49,6 +50,9 @@
 #include <ihandleentity.h>
 #include <tier0/icommandline.h>
 #include <string_t.h>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 namespace SourceMod {
 class ICommandArgs;
@@ -89,6 +93,7 @@ static const int ENTREF_MASK = (1 << 31);
 #define FORMAT_SOURCE_BIN_NAME(basename) \
 	(SOURCE_BIN_PREFIX basename SOURCE_BIN_SUFFIX SOURCE_BIN_EXT)
 
+/* |lookup| holds every prop of the class, by name and by dotted path. */
 struct DataTableInfo
 {
 	struct SendPropInfo
@@ -149,6 +154,7 @@ struct DataMapCacheInfo
 	sm_datatable_info_t info;
 };
 
+/* Every field of a datamap, by name and by dotted path. */
 typedef NameHashSet<DataMapCacheInfo> DataMapCache;
 
 struct DelayedFakeCliCmd
@@ -216,8 +222,14 @@ public:
 	void OnSourceModAllInitialized();
 	void OnSourceModAllInitialized_Post();
 	/*void OnSourceModAllShutdown();*/
+	void OnSourceModShutdown() override;
+	void OnSourceModLevelChange(const char *mapName) override;
 	ConfigResult OnSourceModConfigChanged(const char *key, const char *value,
 		ConfigSource source, char *error, size_t maxlength) override;
+	const char *GetGlobalClassName() override
+	{
+		return "GameHelpers";
+	}
 public: //IGameHelpers
 	SendProp *FindInSendTable(const char *classname, const char *offset);
 	bool FindSendPropInfo(const char *classname, const char *offset, sm_sendprop_info_t *info);
@@ -228,6 +240,7 @@ public: //IGameHelpers
 	bool FindDataMapInfo(datamap_t *pMap, const char *offset, sm_datatable_info_t *pDataTable);
 	void SetEdictStateChanged(edict_t *pEdict, unsigned short offset);
 	bool TextMsg(int client, int dest, const char *msg);
+	bool TextMsg(cell_t *players, int count, int dest, const char *msg);
 	bool HintTextMsg(int client, const char *msg);
 	bool HintTextMsg(cell_t *players, int count, const char *msg);
 	bool ShowVGUIMenu(int client, const char *name, KeyValues *data, bool show);
@@ -263,6 +276,11 @@ public: //IGameHelpers
 	uint64_t GetServerSteamId64() const override;
 	void RemoveDataTableCache(datamap_t *pMap = nullptr);
 	bool RemoveSendPropCache(const char *classname = nullptr);
+	/* Changes whenever either of the caches above is flushed. */
+	unsigned int GetPropCacheSerial() const
+	{
+		return m_PropCacheSerial;
+	}
 public:
 	void AddToFakeCliCmdQueue(int client, int userid, const char *cmd);
 	void ProcessFakeCliCmdQueue();
@@ -271,10 +289,20 @@ public:
 	const char *CurrentCommandName();
 	void AddDelayedKick(int client, int userid, const char *msg);
 	void ProcessDelayedKicks();
+public:
+	void OnGameFramePost(bool simulating);
+	void FlushDeferredStateChanges();
+private:
+	void DeferEdictStateChanged(edict_t *pEdict, unsigned short offset);
 private:
 	void PushCommandStack(const ICommandArgs *cmd);
 	void PopCommandStack();
 	DataTableInfo *_FindServerClass(const char *classname);
+	template <typename Set>
+	typename Set::Result FindName(Set &set, const char *name);
+	void PrebuildClassTables();
+	void FinishClassTablePrebuild();
+	SMFindMapResult FindMapInEngine(const char *pMapName, char *pFoundMap, size_t nMapNameMax);
 private:
 	void InitLogicalEntData();
 	void InitCommandLine();
@@ -283,6 +311,20 @@ private:
 
 	NameHashSet<DataTableInfo *> m_Classes;
 	DataTableMap m_Maps;
+	StringInterner m_Names;
+	InternedSiteCache m_NameSites;
+	enum NetpropTableMode
+	{
+		NetpropTables_Lazy,			/* flatten each class on first use */
+		NetpropTables_LevelInit,	/* flatten every class at the first LevelInit */
+		NetpropTables_Background,	/* same, on a worker thread */
+	};
+	NetpropTableMode m_NetpropTableMode;
+	bool m_bClassTablesPrebuilt;
+	std::thread m_PrebuildThread;
+	std::atomic<bool> m_bPrebuildDone;
+	std::vector<DataTableInfo *> m_Prebuilt;	/* owned by m_PrebuildThread until it is done */
+	unsigned int m_PropCacheSerial;
 	int m_MsgTextMsg;
 	int m_HinTextMsg;
 	int m_SayTextMsg;
@@ -292,6 +334,18 @@ private:
 	CStack<CachedCommandInfo> m_CommandStack;
 	Queue<DelayedKickInfo> m_DelayedKicks;
 	void *m_pGetCommandLine;
+
+	/* Same limit as the engine's per-edict change list (MAX_CHANGE_OFFSETS). */
+	static const unsigned short kMaxDeferredOffsets = 19;
+	struct DeferredStateChange
+	{
+		edict_t *pEdict;
+		unsigned short offsets[kMaxDeferredOffsets];
+		unsigned short count;	/* > kMaxDeferredOffsets means the whole edict changed */
+	};
+	std::vector<DeferredStateChange> m_DeferredChanges;
+	std::vector<int> m_DeferredSlots;	/* edict index -> m_DeferredChanges index + 1 */
+	bool m_bDeferStateChanges;
 #if SOURCE_ENGINE == SE_CSGO
 public:
 	bool CanSetCSGOEntProp(const char *pszPropName)
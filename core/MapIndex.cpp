@@ -0,0 +1,185 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#include "MapIndex.h"
+#include "sourcemod.h"
+#include "sourcemm_api.h"
+#include "sm_stringutil.h"
+#include <amtl/am-string.h>
+
+MapIndex g_MapIndex;
+
+MapIndex::MapIndex()
+	: m_Stamp(0),
+	  m_Checked(0),
+	  m_Scanned(false),
+	  m_RebuildQueued(false)
+{
+	m_Files.init();
+}
+
+void MapIndex::OnSourceModLevelChange(const char *mapName)
+{
+	/* Workshop maps are downloaded right before a level change. */
+	m_Checked = 0;
+}
+
+void MapIndex::OnSourceModShutdown()
+{
+	m_Resolved.clear();
+	m_Files.clear();
+	m_Scanned = false;
+}
+
+bool MapIndex::Lookup(const char *name, SMFindMapResult *result, char *found, size_t maxlength)
+{
+	CheckForChanges();
+
+	StringHashMap<Resolved>::Result r = m_Resolved.find(name);
+	if (!r.found())
+	{
+		return false;
+	}
+
+	*result = r->value.result;
+	if (found && maxlength)
+	{
+		ke::SafeStrcpy(found, maxlength, r->value.found.c_str());
+	}
+	return true;
+}
+
+void MapIndex::Remember(const char *name, SMFindMapResult result, const char *found)
+{
+	if (m_Resolved.elements() >= kMaxResolved)
+	{
+		m_Resolved.clear();
+	}
+
+	Resolved resolved;
+	resolved.result = result;
+	resolved.found = found ? found : name;
+	m_Resolved.replace(name, std::move(resolved));
+}
+
+bool MapIndex::HasMapFile(const char *name)
+{
+	CheckForChanges();
+	return m_Files.has(name);
+}
+
+void MapIndex::CheckForChanges()
+{
+	if (!m_Scanned)
+	{
+		Rebuild();
+		return;
+	}
+
+	time_t now = time(NULL);
+	if (m_RebuildQueued || now - m_Checked < kRecheckSeconds)
+	{
+		return;
+	}
+	m_Checked = now;
+
+	if (GetFolderStamp() != m_Stamp)
+	{
+		m_RebuildQueued = true;
+		g_SourceMod.AddFrameAction(RebuildAction, this);
+	}
+}
+
+long MapIndex::GetFolderStamp()
+{
+	/* Adding or replacing a map changes its folder's time; a new workshop map
+	 * adds a folder under maps/workshop.
+	 */
+	return filesystem->GetFileTime("maps", "GAME") * 31 + filesystem->GetFileTime("maps/workshop", "GAME");
+}
+
+void MapIndex::RebuildAction(void *data)
+{
+	MapIndex *index = (MapIndex *)data;
+	index->m_RebuildQueued = false;
+	index->Rebuild();
+}
+
+void MapIndex::Rebuild()
+{
+	m_Scanned = true;
+	m_Checked = time(NULL);
+	m_Stamp = GetFolderStamp();
+
+	m_Resolved.clear();
+	m_Files.clear();
+
+	ScanFolder("maps", "");
+
+	FileFindHandle_t findHandle;
+	const char *fileName = filesystem->FindFirstEx("maps/workshop/*", "GAME", &findHandle);
+	while (fileName)
+	{
+		if (fileName[0] != '.' && filesystem->FindIsDirectory(findHandle))
+		{
+			char folder[PLATFORM_MAX_PATH];
+			char prefix[PLATFORM_MAX_PATH];
+			ke::SafeSprintf(folder, sizeof(folder), "maps/workshop/%s", fileName);
+			ke::SafeSprintf(prefix, sizeof(prefix), "workshop/%s/", fileName);
+			ScanFolder(folder, prefix);
+		}
+		fileName = filesystem->FindNext(findHandle);
+	}
+	filesystem->FindClose(findHandle);
+}
+
+void MapIndex::ScanFolder(const char *folder, const char *prefix)
+{
+	char wildcard[PLATFORM_MAX_PATH];
+	ke::SafeSprintf(wildcard, sizeof(wildcard), "%s/*.bsp", folder);
+
+	FileFindHandle_t findHandle;
+	const char *fileName = filesystem->FindFirstEx(wildcard, "GAME", &findHandle);
+	while (fileName)
+	{
+		char name[PLATFORM_MAX_PATH];
+		size_t len = ke::SafeSprintf(name, sizeof(name), "%s%s", prefix, fileName);
+		if (len > 4)
+		{
+			/* Strip ".bsp" */
+			name[len - 4] = '\0';
+			m_Files.add(name);
+		}
+		fileName = filesystem->FindNext(findHandle);
+	}
+	filesystem->FindClose(findHandle);
+}
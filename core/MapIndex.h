@@ -0,0 +1,97 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#ifndef _INCLUDE_SOURCEMOD_MAP_INDEX_H_
+#define _INCLUDE_SOURCEMOD_MAP_INDEX_H_
+
+#include "sm_globals.h"
+#include "HalfLife2.h"
+#include <sm_hashmap.h>
+#include <am-hashset.h>
+#include <time.h>
+#include <string>
+
+using namespace SourceMod;
+
+/**
+ * Remembers what FindMap resolved each name to, so that repeated lookups
+ * (sm_map, nominations, map lists) do not walk the maps folder or run the
+ * engine's autocomplete again. Alongside that it keeps the set of .bsp
+ * files under maps/ and maps/workshop/<id>/, which answers exact-name
+ * checks without touching the disk.
+ *
+ * Everything is dropped when the maps folders change. The folders are
+ * checked at most every kRecheckSeconds, and the new scan runs on
+ * a later frame; lookups keep using the old data until it is done.
+ */
+class MapIndex : public SMGlobalClass
+{
+public: // SMGlobalClass
+	void OnSourceModLevelChange(const char *mapName) override;
+	void OnSourceModShutdown() override;
+public:
+	MapIndex();
+
+	/* Returns true and fills |result| (and |found|) if |name| was resolved before. */
+	bool Lookup(const char *name, SMFindMapResult *result, char *found, size_t maxlength);
+	void Remember(const char *name, SMFindMapResult result, const char *found);
+
+	/* True if maps/<name>.bsp was present at the last scan. */
+	bool HasMapFile(const char *name);
+private:
+	static const time_t kRecheckSeconds = 30;
+	/* Names come from user input; don't let typos grow the cache forever. */
+	static const size_t kMaxResolved = 4096;
+
+	struct Resolved
+	{
+		SMFindMapResult result;
+		std::string found;
+	};
+
+	void CheckForChanges();
+	long GetFolderStamp();
+	void Rebuild();
+	void ScanFolder(const char *folder, const char *prefix);
+	static void RebuildAction(void *data);
+private:
+	StringHashMap<Resolved> m_Resolved;
+	ke::HashSet<std::string, detail::StringHashMapPolicy> m_Files;
+	long m_Stamp;
+	time_t m_Checked;
+	bool m_Scanned;
+	bool m_RebuildQueued;
+};
+
+extern MapIndex g_MapIndex;
+
+#endif //_INCLUDE_SOURCEMOD_MAP_INDEX_H_
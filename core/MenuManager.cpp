@@ -38,6 +38,7 @@
 #include "sourcemm_api.h"
 #include "PlayerManager.h"
 #include "MenuStyle_Valve.h"
+#include "MenuStyle_Radio.h"
 #include <IGameConfigs.h>
 #include "sourcemm_api.h"
 #include "logic_bridge.h"
@@ -242,6 +243,42 @@ IMenuPanel *MenuManager::RenderMenu(int client, menu_states_t &md, ItemOrder ord
 		return NULL;
 	}
 
+	/* If the handler doesn't draw per client, a page only depends on the
+	 * language, so menus shown to many clients at once (votes, mostly) are
+	 * rendered once per page.  Only radio pages can be copied.
+	 */
+	CRadioMenu *cacheMenu = NULL;
+	if (menu->GetDrawStyle() == &g_RadioMenuStyle
+		&& md.mh->GetMenuAPIVersion2() >= 18
+		&& !md.mh->IsMenuDrawnPerClient(menu)
+		&& !menu->IsPerClientShuffled())
+	{
+		cacheMenu = static_cast<CRadioMenu *>(menu);
+
+		IMenuPanel *panel = cacheMenu->GetCachedPage(client, md, order);
+		if (panel)
+		{
+			md.mh->OnMenuDisplay(menu, client, panel);
+			return panel;
+		}
+	}
+
+	unsigned int firstItem = md.firstItem;
+	unsigned int lastItem = md.lastItem;
+
+	IMenuPanel *panel = DrawMenuPage(client, md, order);
+	if (panel && cacheMenu)
+	{
+		cacheMenu->CachePage(client, firstItem, lastItem, order, md, panel);
+	}
+
+	return panel;
+}
+
+IMenuPanel *MenuManager::DrawMenuPage(int client, menu_states_t &md, ItemOrder order)
+{
+	IBaseMenu *menu = md.menu;
+
 	struct
 	{
 		unsigned int position;
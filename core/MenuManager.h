@@ -98,6 +98,7 @@ public:
 	std::string *GetMenuSound(ItemSelection sel);
 protected:
 	Handle_t CreateMenuHandle(IBaseMenu *menu, IdentityToken_t *pOwner);
+	IMenuPanel *DrawMenuPage(int client, menu_states_t &states, ItemOrder order);
 	Handle_t CreateStyleHandle(IMenuStyle *style);
 private:
 	int m_ShowMenu;
@@ -641,6 +641,7 @@ bool CBaseMenu::AppendItem(const char *info, const ItemDrawInfo &draw)
 	item.style = draw.style;
 
 	m_items.push_back(std::move(item));
+	InvalidateRenderCache();
 	return true;
 }
 
@@ -662,6 +663,7 @@ bool CBaseMenu::InsertItem(unsigned int position, const char *info, const ItemDr
 	item.style = draw.style;
 
 	m_items.emplace(m_items.begin() + position, std::move(item));
+	InvalidateRenderCache();
 	return true;
 }
 
@@ -671,12 +673,14 @@ bool CBaseMenu::RemoveItem(unsigned int position)
 		return false;
 
 	m_items.erase(m_items.begin() + position);
+	InvalidateRenderCache();
 	return true;
 }
 
 void CBaseMenu::RemoveAllItems()
 {
 	m_items.clear();
+	InvalidateRenderCache();
 }
 
 const char *CBaseMenu::GetItemInfo(unsigned int position, ItemDrawInfo *draw/* =NULL */, int client/* =0 */)
@@ -721,6 +725,7 @@ void CBaseMenu::ShufflePerClient(int start, int stop)
 			m_RandomMaps[i][j] = tmp;
 		}
 	}
+	InvalidateRenderCache();
 }
 
 void CBaseMenu::SetClientMapping(int client, int *array, int length)
@@ -731,6 +736,7 @@ void CBaseMenu::SetClientMapping(int client, int *array, int length)
 	{
 		m_RandomMaps[client][i] = array[i];
 	}
+	InvalidateRenderCache();
 }
 
 bool CBaseMenu::IsPerClientShuffled()
@@ -773,6 +779,7 @@ bool CBaseMenu::SetPagination(unsigned int itemsPerPage)
 	}
 
 	m_Pagination = itemsPerPage;
+	InvalidateRenderCache();
 
 	return true;
 }
@@ -790,6 +797,7 @@ IMenuStyle *CBaseMenu::GetDrawStyle()
 void CBaseMenu::SetDefaultTitle(const char *message)
 {
 	m_Title = message;
+	InvalidateRenderCache();
 }
 
 const char *CBaseMenu::GetDefaultTitle()
@@ -877,6 +885,7 @@ unsigned int CBaseMenu::GetMenuOptionFlags()
 void CBaseMenu::SetMenuOptionFlags(unsigned int flags)
 {
 	m_nFlags = flags;
+	InvalidateRenderCache();
 }
 
 IMenuHandler *CBaseMenu::GetHandler()
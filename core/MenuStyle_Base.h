@@ -163,6 +163,11 @@ public:
 	virtual bool IsPerClientShuffled();
 	virtual unsigned int GetRealItemIndex(int client, unsigned int position);
 	unsigned int GetBaseMemUsage();
+protected:
+	/* Called whenever something that affects rendering changes. */
+	virtual void InvalidateRenderCache()
+	{
+	}
 private:
 	void InternalDelete();
 protected:
@@ -38,6 +38,7 @@
 #include <bridge/include/ILogger.h>
 #endif
 #include "logic_bridge.h"
+#include <algorithm>
 
 #ifdef USE_PROTOBUF_USERMESSAGES
 #include <google/protobuf/descriptor.h>
@@ -62,8 +63,12 @@ unsigned int g_RadioMenuTimeout = 0;
 
 #define MAX_MENUSLOT_KEYS 10
 
+// how long before a timed display runs out to renew it
+#define RADIO_EXPIRE_MARGIN 0.5f
+
 static unsigned int s_RadioMaxPageItems = MAX_MENUSLOT_KEYS;
 static bool s_RadioClosesOnInvalidSlot = false;
+static float s_RadioRefreshInterval = 0.2f;
 
 CRadioStyle::CRadioStyle()
 {
@@ -72,6 +77,28 @@ CRadioStyle::CRadioStyle()
 	{
 		m_players[i].Radio_SetIndex(i);
 	}
+	m_bHasPending = false;
+}
+
+ConfigResult CRadioStyle::OnSourceModConfigChanged(const char *key, 
+												   const char *value, 
+												   ConfigSource source, 
+												   char *error, 
+												   size_t maxlength)
+{
+	if (strcmp(key, "RadioMenuRefreshInterval") == 0)
+	{
+		float interval = (float)atof(value);
+		if (interval < 0.0f)
+		{
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be 0 or greater");
+			return ConfigResult_Reject;
+		}
+		s_RadioRefreshInterval = interval;
+		return ConfigResult_Accept;
+	}
+
+	return ConfigResult_Ignore;
 }
 
 void CRadioStyle::OnSourceModAllInitialized()
@@ -81,6 +108,12 @@ void CRadioStyle::OnSourceModAllInitialized()
 
 void CRadioStyle::OnSourceModLevelChange(const char *mapName)
 {
+	/* Clients drop their HUD when the level changes. */
+	for (size_t i = 0; i < 256+1; i++)
+	{
+		m_players[i].Radio_Forget();
+	}
+
 	if (g_bRadioInit)
 	{
 		return;
@@ -158,6 +191,9 @@ bool CRadioStyle::OnClientCommand(int client, const char *cmdname, const CComman
 {
 	if (strcmp(cmdname, "menuselect") == 0)
 	{
+		/* Whatever the client showed, it has closed it now. */
+		m_players[client].Radio_Forget();
+
 		if (!m_players[client].bInMenu)
 		{
 			m_players[client].bInExternMenu = false;
@@ -217,10 +253,18 @@ void CRadioStyle::OnUserMessageSent(int msg_id)
 		}
 		m_players[client].bInExternMenu = true;
 		m_players[client].menuHoldTime = g_last_holdtime;
+		m_players[client].Radio_Forget();
 	}
 	g_last_client_count = 0;
 }
 
+void CRadioStyle::OnClientDisconnected(int client)
+{
+	BaseMenuStyle::OnClientDisconnected(client);
+
+	m_players[client].Radio_Forget();
+}
+
 void CRadioStyle::SendDisplay(int client, IMenuPanel *display)
 {
 	CRadioDisplay *rDisplay = (CRadioDisplay *)display;
@@ -304,6 +348,32 @@ void CRadioStyle::ProcessWatchList()
 	}
 }
 
+void CRadioStyle::SchedulePendingDisplays()
+{
+	m_bHasPending = true;
+}
+
+void CRadioStyle::ProcessPendingDisplays()
+{
+	if (!m_bHasPending)
+	{
+		return;
+	}
+
+	m_bHasPending = false;
+
+	float now = gpGlobals->curtime;
+	unsigned int max_clients = g_Players.GetMaxClients();
+	for (unsigned int i = 1; i <= max_clients; i++)
+	{
+		CRadioMenuPlayer *pPlayer = GetRadioMenuPlayer(i);
+		if (pPlayer->Radio_RunPending(now))
+		{
+			m_bHasPending = true;
+		}
+	}
+}
+
 unsigned int CRadioStyle::GetApproxMemUsage()
 {
 	return sizeof(CRadioStyle) + (sizeof(CRadioMenuPlayer) * 257);
@@ -443,7 +513,7 @@ void CRadioDisplay::SendRawDisplay(int client, unsigned int time)
 	int _sel_keys = (keys == 0) ? (1<<9) : keys;
 	CRadioMenuPlayer *pPlayer = g_RadioMenuStyle.GetRadioMenuPlayer(client);
 	pPlayer->Radio_Init(_sel_keys, m_Title.c_str(), m_BufferText.c_str());
-	pPlayer->Radio_Refresh();
+	pPlayer->Radio_Display(time);
 }
 
 void CRadioMenuPlayer::Radio_SetIndex(unsigned int index)
@@ -456,23 +526,109 @@ bool CRadioMenuPlayer::Radio_NeedsRefresh()
 	return (gpGlobals->curtime - display_last_refresh >= g_RadioMenuTimeout);
 }
 
-void CRadioMenuPlayer::Radio_Init(int keys, const char *title, const char *text)
+void CRadioMenuPlayer::Radio_Forget()
 {
+	display_shown = false;
+	display_visible = false;
+	display_pending = 0.0f;
+}
+
+void CRadioMenuPlayer::Radio_Display(unsigned int time)
+{
+	/* Nothing of ours is up, so there's nothing to throttle against. */
+	if (!display_visible)
+	{
+		Radio_Refresh();
+		return;
+	}
+
+	float now = gpGlobals->curtime;
+	float due = display_last_refresh + s_RadioRefreshInterval;
+	if (display_shown && time != 0 && display_expire != 0.0f)
+	{
+		/* Same text and keys: only resend once the client's copy is about to run out. */
+		if (display_expire >= now + time)
+		{
+			display_pending = 0.0f;
+			return;
+		}
+		due = std::max(due, display_expire - RADIO_EXPIRE_MARGIN);
+	}
+	else if (display_shown && time == 0 && display_expire == 0.0f)
+	{
+		/* Same text and keys, and it never times out. */
+		display_pending = 0.0f;
+		return;
+	}
+
+	if (due <= now)
+	{
+		Radio_Refresh();
+		return;
+	}
+
+	/* Hold it back; whatever is in display_pkt by then gets sent. */
+	display_pending = due;
+	g_RadioMenuStyle.SchedulePendingDisplays();
+}
+
+bool CRadioMenuPlayer::Radio_RunPending(float now)
+{
+	if (display_pending == 0.0f)
+	{
+		return false;
+	}
+
+	/* Drop it if the menu went away or ran out while we were waiting. */
+	if (!bInMenu
+		|| bInExternMenu
+		|| (menuHoldTime != 0 && now - menuStartTime >= menuHoldTime))
+	{
+		display_pending = 0.0f;
+		return false;
+	}
+
+	if (display_pending > now)
+	{
+		return true;
+	}
+
+	Radio_Refresh();
+	return false;
+}
+
+bool CRadioMenuPlayer::Radio_Init(int keys, const char *title, const char *text)
+{
+	char pkt[sizeof(display_pkt)];
+	size_t len;
+
 	if (title[0] != '\0')
 	{
-		display_len = ke::SafeSprintf(display_pkt, 
-			sizeof(display_pkt), 
+		len = ke::SafeSprintf(pkt, 
+			sizeof(pkt), 
 			"%s\n%s", 
 			title,
 			text);
 	}
 	else
 	{
-		display_len = ke::SafeStrcpy(display_pkt, 
-			sizeof(display_pkt), 
+		len = ke::SafeStrcpy(pkt, 
+			sizeof(pkt), 
 			text);
 	}
 
+	int new_keys = s_RadioClosesOnInvalidSlot ? 0x7ff : keys;
+	if (display_shown
+		&& len == display_len
+		&& new_keys == display_keys
+		&& memcmp(pkt, display_pkt, len) == 0)
+	{
+		return false;
+	}
+
+	memcpy(display_pkt, pkt, len + 1);
+	display_len = len;
+
 	// Some games have implemented CHudMenu::SelectMenuItem to close the menu
 	// even if an invalid slot has been selected, which causes us a problem as
 	// we'll never get any notification from the client and we'll keep the menu
@@ -481,7 +637,12 @@ void CRadioMenuPlayer::Radio_Init(int keys, const char *title, const char *text)
 	// We don't want to do this for every game as the common SelectMenuItem
 	// implementation ignores invalid selections and keeps the menu open, which
 	// is a much nicer user experience.
-	display_keys = s_RadioClosesOnInvalidSlot ? 0x7ff : keys;
+	display_keys = new_keys;
+
+	/* Not sent yet */
+	display_shown = false;
+
+	return true;
 }
 
 void CRadioMenuPlayer::Radio_Refresh()
@@ -542,6 +703,10 @@ void CRadioMenuPlayer::Radio_Refresh()
 #endif
 
 	display_last_refresh = gpGlobals->curtime;
+	display_expire = time ? (display_last_refresh + time) : 0.0f;
+	display_pending = 0.0f;
+	display_shown = true;
+	display_visible = true;
 }
 
 int CRadioDisplay::GetAmountRemaining()
@@ -635,7 +800,90 @@ void CRadioMenu::Cancel_Finally()
 
 unsigned int CRadioMenu::GetApproxMemUsage()
 {
-	return sizeof(CRadioMenu) + GetBaseMemUsage();
+	return sizeof(CRadioMenu) + GetBaseMemUsage()
+		+ (m_RenderedPages.size() * sizeof(RenderedPage));
+}
+
+void CRadioMenu::InvalidateRenderCache()
+{
+	m_RenderedPages.clear();
+}
+
+IMenuPanel *CRadioMenu::GetCachedPage(int client, menu_states_t &md, ItemOrder order)
+{
+	CPlayer *pPlayer = g_Players.GetPlayerByIndex(client);
+	if (!pPlayer)
+	{
+		return NULL;
+	}
+
+	unsigned int language = pPlayer->GetLanguageId();
+	for (size_t i = 0; i < m_RenderedPages.size(); i++)
+	{
+		const RenderedPage &page = m_RenderedPages[i];
+		if (page.order != order
+			|| page.firstItem != md.firstItem
+			|| page.lastItem != md.lastItem
+			|| page.language != language)
+		{
+			continue;
+		}
+
+		CRadioDisplay *display = g_RadioMenuStyle.MakeRadioDisplay(this);
+		display->m_Title.assign(page.title.c_str());
+		display->m_BufferText.assign(page.text.c_str());
+		display->m_NextPos = page.nextPos;
+		display->keys = page.keys;
+
+		md.firstItem = page.outFirstItem;
+		md.lastItem = page.outLastItem;
+		md.item_on_page = page.item_on_page;
+		memcpy(md.slots, page.slots, sizeof(md.slots));
+
+		return display;
+	}
+
+	return NULL;
+}
+
+void CRadioMenu::CachePage(int client,
+						   unsigned int firstItem,
+						   unsigned int lastItem,
+						   ItemOrder order,
+						   const menu_states_t &md,
+						   IMenuPanel *panel)
+{
+	CPlayer *pPlayer = g_Players.GetPlayerByIndex(client);
+	if (!pPlayer)
+	{
+		return;
+	}
+
+	/* Menus are a handful of pages in a handful of languages; anything
+	 * beyond that is not worth keeping.
+	 */
+	static const size_t kMaxRenderedPages = 16;
+	if (m_RenderedPages.size() >= kMaxRenderedPages)
+	{
+		m_RenderedPages.clear();
+	}
+
+	CRadioDisplay *display = (CRadioDisplay *)panel;
+
+	RenderedPage page;
+	page.order = order;
+	page.firstItem = firstItem;
+	page.lastItem = lastItem;
+	page.language = pPlayer->GetLanguageId();
+	page.outFirstItem = md.firstItem;
+	page.outLastItem = md.lastItem;
+	page.item_on_page = md.item_on_page;
+	memcpy(page.slots, md.slots, sizeof(page.slots));
+	page.title = display->m_Title.c_str();
+	page.text = display->m_BufferText.c_str();
+	page.nextPos = display->m_NextPos;
+	page.keys = display->keys;
+	m_RenderedPages.push_back(std::move(page));
 }
 
 const char *g_RadioNumTable[11] = 
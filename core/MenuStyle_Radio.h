@@ -42,6 +42,8 @@
 #include <sh_stack.h>
 #include <sh_string.h>
 #include <compat_wrappers.h>
+#include <string>
+#include <vector>
 #include "logic/common_logic.h"
 #include "AutoHandleRooter.h"
 
@@ -53,16 +55,23 @@ class CRadioMenu;
 class CRadioMenuPlayer : public CBaseMenuPlayer
 {
 public:
-	void Radio_Init(int keys, const char *title, const char *buffer);
+	bool Radio_Init(int keys, const char *title, const char *buffer);
 	bool Radio_NeedsRefresh();
 	void Radio_Refresh();
 	void Radio_SetIndex(unsigned int index);
+	void Radio_Forget();
+	void Radio_Display(unsigned int time);
+	bool Radio_RunPending(float now);
 private:
 	unsigned int m_index;
 	size_t display_len;
 	char display_pkt[512];
 	int display_keys;
 	float display_last_refresh;
+	float display_expire = 0.0f;	/* When the client drops the display, 0 if never */
+	float display_pending = 0.0f;	/* When a held back send is due, 0 if none */
+	bool display_shown = false;		/* Client is known to still show display_pkt */
+	bool display_visible = false;	/* Client is known to show one of our displays */
 };
 
 class CRadioStyle : 
@@ -80,6 +89,11 @@ public: //SMGlobalClass
 	void OnSourceModAllInitialized();
 	void OnSourceModLevelChange(const char *mapName);
 	void OnSourceModShutdown();
+	ConfigResult OnSourceModConfigChanged(const char *key, 
+		const char *value, 
+		ConfigSource source, 
+		char *error, 
+		size_t maxlength);
 public: //BaseMenuStyle
 	CBaseMenuPlayer *GetMenuPlayer(int client);
 	void SendDisplay(int client, IMenuPanel *display);
@@ -97,6 +111,8 @@ public: //IUserMessageListener
 	void OnUserMessage(int msg_id, bf_write *bf, IRecipientFilter *pFilter);
 #endif
 	void OnUserMessageSent(int msg_id);
+public: //IClientListener
+	void OnClientDisconnected(int client);
 public:
 	bool IsSupported();
 	bool OnClientCommand(int client, const char *cmdname, const CCommand &cmd);
@@ -104,14 +120,18 @@ public:
 	CRadioDisplay *MakeRadioDisplay(CRadioMenu *menu=NULL);
 	void FreeRadioDisplay(CRadioDisplay *display);
 	CRadioMenuPlayer *GetRadioMenuPlayer(int client);
+	void ProcessPendingDisplays();
+	void SchedulePendingDisplays();
 private:
 	CRadioMenuPlayer *m_players;
+	bool m_bHasPending;
 	CStack<CRadioDisplay *> m_FreeDisplays;
 };
 
 class CRadioDisplay : public IMenuPanel
 {
 	friend class CRadioStyle;
+	friend class CRadioMenu;
 public:
 	CRadioDisplay();
 	CRadioDisplay(CRadioMenu *menu);
@@ -154,6 +174,38 @@ public:
 	bool SetPagination(unsigned int itemsPerPage);
 	void Cancel_Finally();
 	unsigned int GetApproxMemUsage();
+public:
+	IMenuPanel *GetCachedPage(int client, menu_states_t &md, ItemOrder order);
+	void CachePage(int client,
+		unsigned int firstItem,
+		unsigned int lastItem,
+		ItemOrder order,
+		const menu_states_t &md,
+		IMenuPanel *panel);
+protected:
+	void InvalidateRenderCache();
+private:
+	/* A page as rendered for one language, reusable for any client whose
+	 * handler does not draw per client.
+	 */
+	struct RenderedPage
+	{
+		/* Inputs */
+		ItemOrder order;
+		unsigned int firstItem;
+		unsigned int lastItem;
+		unsigned int language;
+		/* Outputs */
+		unsigned int outFirstItem;
+		unsigned int outLastItem;
+		unsigned int item_on_page;
+		menu_slots_t slots[11];
+		std::string title;
+		std::string text;
+		unsigned int nextPos;
+		int keys;
+	};
+	std::vector<RenderedPage> m_RenderedPages;
 };
 
 extern CRadioStyle g_RadioMenuStyle;
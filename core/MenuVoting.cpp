@@ -83,6 +83,15 @@ ConVar sm_vote_client_console("sm_vote_progress_client_console",
 					   true,
 					   1.0);
 
+ConVar sm_vote_progress_interval("sm_vote_progress_interval",
+					   "0.25",
+					   0,
+					   "Minimum time in seconds between live vote progress updates sent to plugins",
+					   true,
+					   0.0,
+					   false,
+					   0.0);
+
 
 #if SOURCE_ENGINE >= SE_ORANGEBOX
 void OnVoteDelayChange(IConVar *cvar, const char *value, float flOldValue);
@@ -170,7 +179,9 @@ void VoteMenuHandler::OnClientDisconnected(int client)
 		{
 			assert((unsigned)item < m_Items);
 			assert(m_Votes[item] > 0);
-			m_Votes[item]--;
+			RemoveVote(item);
+			m_NumVotes--;
+			QueueProgress();
 		}
 		m_ClientVotes[client] = VOTE_NOT_VOTING;
 	}
@@ -269,10 +280,11 @@ bool VoteMenuHandler::RedrawToClient(int client, bool revotes)
 		}
 		assert((unsigned)m_ClientVotes[client] < m_Items);
 		assert(m_Votes[m_ClientVotes[client]] > 0);
-		m_Votes[m_ClientVotes[client]]--;
+		RemoveVote(m_ClientVotes[client]);
 		m_ClientVotes[client] = VOTE_PENDING;
 		m_Revoting[client] = true;
 		m_NumVotes--;
+		QueueProgress();
 	}
 
 	if (m_nMenuTime == MENU_TIME_FOREVER)
@@ -332,6 +344,18 @@ bool VoteMenuHandler::InitializeVoting(IBaseMenu *menu,
 		}
 	}
 
+	/* Everything starts tied, in item order */
+	if (m_Order.size() < (size_t)m_Items)
+	{
+		m_Order.resize(m_Items);
+		m_Rank.resize(m_Items);
+	}
+	for (unsigned int i=0; i<m_Items; i++)
+	{
+		m_Order[i] = i;
+		m_Rank[i] = i;
+	}
+
 	m_pCurMenu = menu;
 	m_VoteTime = time;
 	m_VoteFlags = flags;
@@ -378,10 +402,89 @@ void VoteMenuHandler::DecrementPlayerCount()
 	}
 }
 
-int SortVoteItems(const void *item1, const void *item2)
+void VoteMenuHandler::AddVote(unsigned int item)
+{
+	unsigned int count = ++m_Votes[item];
+
+	/* Move the item up past anything it now beats.  Ties keep their order,
+	 * so this only walks the items that had the same count.
+	 */
+	unsigned int pos = m_Rank[item];
+	while (pos > 0 && m_Votes[m_Order[pos - 1]] < count)
+	{
+		unsigned int other = m_Order[pos - 1];
+		m_Order[pos] = other;
+		m_Rank[other] = pos;
+		pos--;
+	}
+	m_Order[pos] = item;
+	m_Rank[item] = pos;
+}
+
+void VoteMenuHandler::RemoveVote(unsigned int item)
+{
+	unsigned int count = --m_Votes[item];
+
+	unsigned int pos = m_Rank[item];
+	while (pos + 1 < m_Items && m_Votes[m_Order[pos + 1]] > count)
+	{
+		unsigned int other = m_Order[pos + 1];
+		m_Order[pos] = other;
+		m_Rank[other] = pos;
+		pos++;
+	}
+	m_Order[pos] = item;
+	m_Rank[item] = pos;
+}
+
+void VoteMenuHandler::BuildItemList(menu_vote_result_t &vote, menu_vote_result_t::menu_item_vote_t *item_vote)
 {
-	return ((menu_vote_result_t::menu_item_vote_t *)item2)->count 
-		- ((menu_vote_result_t::menu_item_vote_t *)item1)->count;
+	/* m_Order is already sorted descending, so stop at the first item with no votes */
+	for (unsigned int i=0; i<m_Items; i++)
+	{
+		unsigned int item = m_Order[i];
+		if (m_Votes[item] == 0)
+		{
+			break;
+		}
+		item_vote[vote.num_items].count = m_Votes[item];
+		item_vote[vote.num_items].item = item;
+		vote.num_votes += m_Votes[item];
+		vote.num_items++;
+	}
+	vote.item_list = item_vote;
+}
+
+void VoteMenuHandler::QueueProgress()
+{
+	if (!m_bStarted || m_progressTimer || m_pHandler->GetMenuAPIVersion2() < 19)
+	{
+		return;
+	}
+
+	float interval = sm_vote_progress_interval.GetFloat();
+	float elapsed = gpGlobals->curtime - m_fLastProgress;
+	if (elapsed >= interval || elapsed < 0.0f)
+	{
+		SendProgress();
+		return;
+	}
+
+	/* Too soon; send whatever the tally is once the interval is up */
+	m_progressTimer = g_Timers.CreateTimer(this, interval - elapsed, NULL, TIMER_FLAG_NO_MAPCHANGE);
+}
+
+void VoteMenuHandler::SendProgress()
+{
+	menu_vote_result_t vote;
+	menu_vote_result_t::menu_item_vote_t item_vote[256];
+
+	memset(&vote, 0, sizeof(vote));
+	BuildItemList(vote, item_vote);
+	vote.num_clients = m_TotalClients;
+
+	m_fLastProgress = gpGlobals->curtime;
+	m_pHandler->OnMenuVoteProgress(m_pCurMenu, &vote);
 }
 
 void VoteMenuHandler::EndVoting()
@@ -405,6 +508,11 @@ void VoteMenuHandler::EndVoting()
 		g_Timers.KillTimer(m_displayTimer);
 	}
 
+	if (m_progressTimer)
+	{
+		g_Timers.KillTimer(m_progressTimer);
+	}
+
 	if (m_bCancelled)
 	{
 		/* If we were cancelled, don't bother tabulating anything.
@@ -425,18 +533,8 @@ void VoteMenuHandler::EndVoting()
 
 	memset(&vote, 0, sizeof(vote));
 
-	/* Build the item list */
-	for (unsigned int i=0; i<m_Items; i++)
-	{
-		if (m_Votes[i] > 0)
-		{
-			item_vote[vote.num_items].count = m_Votes[i];
-			item_vote[vote.num_items].item = i;
-			vote.num_votes += m_Votes[i];
-			vote.num_items++;
-		}
-	}
-	vote.item_list = item_vote;
+	/* Build the item list, sorted descending like we promised */
+	BuildItemList(vote, item_vote);
 
 	if (!vote.num_votes)
 	{
@@ -460,12 +558,6 @@ void VoteMenuHandler::EndVoting()
 	}
 	vote.client_list = client_vote;
 
-	/* Sort the item list descending like we promised */
-	qsort(item_vote,
-		vote.num_items,
-		sizeof(menu_vote_result_t::menu_item_vote_t),
-		SortVoteItems);
-
 	/* Save states, then clear what we've saved.
 	 * This makes us re-entrant, which is always the safe way to go.
 	 */
@@ -504,6 +596,16 @@ unsigned int VoteMenuHandler::OnMenuDisplayItem(IBaseMenu *menu, int client, IMe
 	return m_pHandler->OnMenuDisplayItem(menu, client, panel, item, dr);
 }
 
+bool VoteMenuHandler::IsMenuDrawnPerClient(IBaseMenu *menu)
+{
+	if (m_pHandler->GetMenuAPIVersion2() < 18)
+	{
+		return true;
+	}
+
+	return m_pHandler->IsMenuDrawnPerClient(menu);
+}
+
 void VoteMenuHandler::OnMenuDrawItem(IBaseMenu *menu, int client, unsigned int item, unsigned int &style)
 {
 	m_pHandler->OnMenuDrawItem(menu, client, item, style);
@@ -516,7 +618,7 @@ void VoteMenuHandler::OnMenuSelect(IBaseMenu *menu, int client, unsigned int ite
 	{
 		unsigned int index = menu->GetRealItemIndex(client, item);
 		m_ClientVotes[client] = index;
-		m_Votes[index]++;
+		AddVote(index);
 		m_NumVotes++;
 
 		if (sm_vote_chat.GetBool() || sm_vote_console.GetBool() || sm_vote_client_console.GetBool())
@@ -570,6 +672,7 @@ void VoteMenuHandler::OnMenuSelect(IBaseMenu *menu, int client, unsigned int ite
 
 		BuildVoteLeaders();
 		DrawHintProgress();
+		QueueProgress();
 	}
 
 	m_pHandler->OnMenuSelect(menu, client, item);
@@ -594,6 +697,8 @@ void VoteMenuHandler::InternalReset()
 	m_pHandler = NULL;
 	m_leaderList[0] = '\0';
 	m_displayTimer = NULL;
+	m_progressTimer = NULL;
+	m_fLastProgress = 0.0f;
 	m_TotalClients = 0;
 }
 
@@ -653,44 +758,31 @@ void VoteMenuHandler::BuildVoteLeaders()
 		return;
 	}
 
-	menu_vote_result_t vote;
-	menu_vote_result_t::menu_item_vote_t item_vote[256];
-
-	memset(&vote, 0, sizeof(vote));
-
-	/* Build the item list */
-	for (unsigned int i=0; i<m_Items; i++)
-	{
-		if (m_Votes[i] > 0)
-		{
-			item_vote[vote.num_items].count = m_Votes[i];
-			item_vote[vote.num_items].item = i;
-			vote.num_votes += m_Votes[i];
-			vote.num_items++;
-		}
-	}
-	vote.item_list = item_vote;
-	assert(vote.num_votes);
-
-	/* Sort the item list descending */
-	qsort(item_vote,
-		vote.num_items,
-		sizeof(menu_vote_result_t::menu_item_vote_t),
-		SortVoteItems);
-
 	/* Take the top 3 (if applicable) and draw them */
 	int len = 0;
-	for (unsigned int i=0; i<vote.num_items && i<3; i++)
+	for (unsigned int i=0; i<m_Items && i<3; i++)
 	{
-		int curItem = vote.item_list[i].item;
+		unsigned int curItem = m_Order[i];
+		if (m_Votes[curItem] == 0)
+		{
+			break;
+		}
 		ItemDrawInfo dr;
 		m_pCurMenu->GetItemInfo(curItem, &dr);
-		len += g_SourceMod.Format(m_leaderList + len, sizeof(m_leaderList) - len, "\n%i. %s: (%i)", i+1, dr.display, vote.item_list[i].count);
+		len += g_SourceMod.Format(m_leaderList + len, sizeof(m_leaderList) - len, "\n%i. %s: (%i)", i+1, dr.display, m_Votes[curItem]);
 	}
 }
 
 SourceMod::ResultType VoteMenuHandler::OnTimer(ITimer *pTimer, void *pData)
 {
+	if (pTimer == m_progressTimer)
+	{
+		/* Forget it first, the handler may end the vote */
+		m_progressTimer = NULL;
+		SendProgress();
+		return Pl_Stop;
+	}
+
 	DrawHintProgress();
 
 	return Pl_Continue;
@@ -698,5 +790,12 @@ SourceMod::ResultType VoteMenuHandler::OnTimer(ITimer *pTimer, void *pData)
 
 void VoteMenuHandler::OnTimerEnd(ITimer *pTimer, void *pData)
 {
-	m_displayTimer = NULL;
+	if (pTimer == m_displayTimer)
+	{
+		m_displayTimer = NULL;
+	}
+	else if (pTimer == m_progressTimer)
+	{
+		m_progressTimer = NULL;
+	}
 }
@@ -63,6 +63,7 @@ public: //IMenuHandler
 	void OnMenuEnd(IBaseMenu *menu, MenuEndReason reason);
 	void OnMenuDrawItem(IBaseMenu *menu, int client, unsigned int item, unsigned int &style);
 	unsigned int OnMenuDisplayItem(IBaseMenu *menu, int client, IMenuPanel *panel, unsigned int item, const ItemDrawInfo &dr);
+	bool IsMenuDrawnPerClient(IBaseMenu *menu);
 public: //ITimedEvent
 	ResultType OnTimer(ITimer *pTimer, void *pData);
 	void OnTimerEnd(ITimer *pTimer, void *pData);
@@ -92,12 +93,19 @@ private:
 	void StartVoting();
 	void DrawHintProgress();
 	void BuildVoteLeaders();
+	void AddVote(unsigned int item);
+	void RemoveVote(unsigned int item);
+	void BuildItemList(menu_vote_result_t &vote, menu_vote_result_t::menu_item_vote_t *item_vote);
+	void QueueProgress();
+	void SendProgress();
 private:
 	IMenuHandler *m_pHandler;
 	unsigned int m_Clients;
 	unsigned int m_TotalClients;
 	unsigned int m_Items;
 	CVector<unsigned int> m_Votes;
+	CVector<unsigned int> m_Order;		/* Item indexes, by vote count, descending */
+	CVector<unsigned int> m_Rank;		/* Position of each item in m_Order */
 	IBaseMenu *m_pCurMenu;
 	bool m_bStarted;
 	bool m_bCancelled;
@@ -110,6 +118,8 @@ private:
 	bool m_Revoting[256+1];
 	char m_leaderList[1024];
 	ITimer *m_displayTimer;
+	ITimer *m_progressTimer;
+	float m_fLastProgress;
 };
 
 #endif //_INCLUDE_SOURCEMOD_MENUVOTING_H_
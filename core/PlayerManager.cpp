@@ -40,6 +40,7 @@
 #include "TimerSys.h"
 #include "Logger.h"
 #include "ChatTriggers.h"
+#include "StartupTimeline.h"
 #include "HalfLife2.h"
 #include <inetchannel.h>
 #include <iclient.h>
@@ -54,6 +55,14 @@
 #include <bridge/include/IScriptManager.h>
 #include <bridge/include/ILogger.h>
 
+#ifndef PRIu64
+#ifdef _WIN32
+#define PRIu64 "I64u"
+#else
+#define PRIu64 "llu"
+#endif
+#endif
+
 PlayerManager g_Players;
 bool g_OnMapStarted = false;
 IForward *PreAdminCheck = NULL;
@@ -128,6 +137,9 @@ public:
 PlayerManager::PlayerManager()
 {
 	m_AuthQueue = NULL;
+	memset(m_ClientStateBits, 0, sizeof(m_ClientStateBits));
+	memset(m_ClientStateFlags, 0, sizeof(m_ClientStateFlags));
+	m_SteamIdLookUp.init();
 	m_bServerActivated = false;
 	m_maxClients = 0;
 
@@ -136,6 +148,7 @@ PlayerManager::PlayerManager()
 
 	m_bInCCKVHook = false;
 	m_bAuthstringValidation = true; // use steam auth by default
+	m_bCoalesceClientPrints = false;
 
 	m_UserIdLookUp = new int[USHRT_MAX+1];
 	memset(m_UserIdLookUp, 0, sizeof(int) * (USHRT_MAX+1));
@@ -304,6 +317,17 @@ ConfigResult PlayerManager::OnSourceModConfigChanged(const char *key,
 			return ConfigResult_Reject;
 		}
 		return ConfigResult_Accept;
+	} else if (strcmp( key, "CoalesceClientPrints" ) == 0) {
+		if (strcasecmp(value, "yes") == 0)
+		{
+			m_bCoalesceClientPrints = true;
+		} else if ( strcasecmp(value, "no") == 0) {
+			m_bCoalesceClientPrints = false;
+		} else {
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be \"yes\" or \"no\"");
+			return ConfigResult_Reject;
+		}
+		return ConfigResult_Accept;
 	}
 	return ConfigResult_Ignore;
 }
@@ -326,10 +350,16 @@ void PlayerManager::OnServerActivate(edict_t *pEdictList, int edictCount, int cl
 	g_OnMapStarted = true;
 	m_bServerActivated = true;
 
+	g_StartupTimeline.BeginPhase("ServerActivate");
+
+	g_StartupTimeline.BeginPhase("Extension OnCoreMapStart");
 	extsys->CallOnCoreMapStart(pEdictList, edictCount, m_maxClients);
+	g_StartupTimeline.EndPhase();
 
+	g_StartupTimeline.BeginPhase("OnMapStart");
 	m_onActivate->Execute(NULL);
 	m_onActivate2->Execute(NULL);
+	g_StartupTimeline.EndPhase();
 
 	List<IClientListener *>::iterator iter;
 	for (iter = m_hooks.begin(); iter != m_hooks.end(); iter++)
@@ -340,14 +370,16 @@ void PlayerManager::OnServerActivate(edict_t *pEdictList, int edictCount, int cl
 		}
 	}
 
-	SMGlobalClass *cls = SMGlobalClass::head;
-	while (cls)
-	{
-		cls->OnSourceModLevelActivated();
-		cls = cls->m_pGlobalClassNext;
-	}
+	g_StartupTimeline.NotifyAll("OnSourceModLevelActivated", [](SMGlobalClass *pBase, const void *) -> void {
+		pBase->OnSourceModLevelActivated();
+	});
 
+	g_StartupTimeline.BeginPhase("Config execution");
 	SM_ExecuteAllConfigs();
+	g_StartupTimeline.EndPhase();
+
+	g_StartupTimeline.EndPhase();
+	g_StartupTimeline.EndLevelChange(g_HL2.GetCurrentMap());
 }
 
 bool PlayerManager::IsServerActivated()
@@ -413,7 +445,7 @@ void PlayerManager::RunAuthChecks()
 		pPlayer = &m_Players[m_AuthQueue[i]];
 		pPlayer->UpdateAuthIds();
 		
-		authstr = pPlayer->m_AuthID.c_str();
+		authstr = pPlayer->m_AuthID;
 
 		if (!pPlayer->IsAuthStringValidated())
 		{
@@ -723,14 +755,14 @@ void PlayerManager::OnClientPutInServer(edict_t *pEntity, const char *playername
 		for (iter=m_hooks.begin(); iter!=m_hooks.end(); iter++)
 		{
 			pListener = (*iter);
-			pListener->OnClientAuthorized(client, steamId ? steamId : pPlayer->m_AuthID.c_str());
+			pListener->OnClientAuthorized(client, steamId ? steamId : pPlayer->m_AuthID);
 		}
 		/* Finally, tell plugins */
 		if (m_clauth->GetFunctionCount())
 		{
 			m_clauth->PushCell(client);
 			/* For legacy reasons, people are expecting the Steam2 id here if using Steam auth */
-			m_clauth->PushString(steamId ? steamId : pPlayer->m_AuthID.c_str());
+			m_clauth->PushString(steamId ? steamId : pPlayer->m_AuthID);
 			m_clauth->Execute(NULL);
 		}
 		pPlayer->Authorize_Post();
@@ -829,6 +861,9 @@ void PlayerManager::OnClientDisconnect(edict_t *pEntity)
 		return;
 	}
 
+	/* Prints queued for the next frame, including any from the forward above, go out now */
+	FlushPrintfBuffer(client);
+
 	if (pPlayer->WasCountedAsInGame())
 	{
 		m_PlayerCount--;
@@ -897,8 +932,9 @@ void PlayerManager::OnClientPrintf(edict_t *pEdict, const char *szMsg)
 	if (nMsgLen + 1 >= SVC_Print_BufferSize) // +1 for NETMSG_TYPE_BITS
 		RETURN_META(MRES_IGNORED);
 
-	// enqueue msgs if we'd overflow the SVC_Print buffer (+7 as ceil)
-	if (!player.m_PrintfBuffer.empty() || (nNumBitsWritten + NETMSG_TYPE_BITS + 7) / 8 + nMsgLen >= SVC_Print_BufferSize)
+	// enqueue msgs if we'd overflow the SVC_Print buffer (+7 as ceil), or always
+	// when coalescing so that every print made this frame goes out as one message
+	if (m_bCoalesceClientPrints || !player.m_PrintfBuffer.empty() || (nNumBitsWritten + NETMSG_TYPE_BITS + 7) / 8 + nMsgLen >= SVC_Print_BufferSize)
 	{
 		// Don't send any more messages for this player until the buffer is empty.
 		// Queue up a gameframe hook to empty the buffer (if we haven't already)
@@ -923,13 +959,38 @@ void PlayerManager::OnPrintfFrameAction(unsigned int serial)
 		return;
 	}
 
-	INetChannel *pNetChan = static_cast<INetChannel *>(engine->GetPlayerNetInfo(client));
-	if (pNetChan == NULL)
+	if (!SendPrintfBuffer(client))
 	{
 		player.ClearNetchannelQueue();
 		return;
 	}
 
+	if (!player.m_PrintfBuffer.empty())
+	{
+		// continue processing it on the next gameframe as buffer is not empty
+		g_SourceMod.AddFrameAction(PrintfBuffer_FrameAction, (void *)(uintptr_t)player.GetSerial());
+	}
+}
+
+void PlayerManager::FlushPrintfBuffer(int client)
+{
+	CPlayer &player = m_Players[client];
+	if (player.m_PrintfBuffer.empty())
+		return;
+
+	// the client is leaving, so whatever doesn't fit in this frame's SVC_Print space is lost;
+	// a frame action still pending for it finds an empty buffer
+	SendPrintfBuffer(client);
+	player.ClearNetchannelQueue();
+}
+
+bool PlayerManager::SendPrintfBuffer(int client)
+{
+	CPlayer &player = m_Players[client];
+	INetChannel *pNetChan = static_cast<INetChannel *>(engine->GetPlayerNetInfo(client));
+	if (pNetChan == NULL)
+		return false;
+
 	while (!player.m_PrintfBuffer.empty())
 	{
 #if SOURCE_ENGINE == SE_EPISODEONE || SOURCE_ENGINE == SE_DARKMESSIAH
@@ -938,22 +999,36 @@ void PlayerManager::OnPrintfFrameAction(unsigned int serial)
 		int nNumBitsWritten = pNetChan->GetNumBitsWritten(false); // SVC_Print uses unreliable netchan
 #endif
 
-		std::string &string = player.m_PrintfBuffer.front();
+		size_t nUsed = (nNumBitsWritten + NETMSG_TYPE_BITS + 7) / 8;
 
-		// stop if we'd overflow the SVC_Print buffer  (+7 as ceil)
-		if ((nNumBitsWritten + NETMSG_TYPE_BITS + 7) / 8 + string.length() >= SVC_Print_BufferSize)
-			break;
+		// merge as many consecutive queued strings as fit in the remaining SVC_Print space
+		std::string merged;
+		while (!player.m_PrintfBuffer.empty())
+		{
+			std::string &string = player.m_PrintfBuffer.front();
 
-		SH_CALL(engine, &IVEngineServer::ClientPrintf)(player.m_pEdict, string.c_str());
+			// stop if we'd overflow the SVC_Print buffer  (+7 as ceil)
+			if (nUsed + merged.length() + string.length() >= SVC_Print_BufferSize)
+				break;
 
-		player.m_PrintfBuffer.pop_front();
-	}
+			if (merged.empty())
+				merged.swap(string);
+			else
+				merged.append(string);
 
-	if (!player.m_PrintfBuffer.empty())
-	{
-		// continue processing it on the next gameframe as buffer is not empty
-		g_SourceMod.AddFrameAction(PrintfBuffer_FrameAction, (void *)(uintptr_t)player.GetSerial());
+			player.m_PrintfBuffer.pop_front();
+
+			if (!m_bCoalesceClientPrints)
+				break;
+		}
+
+		if (merged.empty())
+			break;
+
+		SH_CALL(engine, &IVEngineServer::ClientPrintf)(player.m_pEdict, merged.c_str());
 	}
+
+	return true;
 }
 
 void ClientConsolePrint(edict_t *e, const char *fmt, ...)
@@ -1094,6 +1169,11 @@ void PlayerManager::OnClientCommand(edict_t *pEntity)
 		return;
 	}
 
+	if (!g_ConCmds.ChargeClientCommand(client, args.Arg(0)))
+	{
+		RETURN_META(MRES_SUPERCEDE);
+	}
+
 	if (strcmp(args.Arg(0), "sm") == 0)
 	{
 		if (args.ArgC() > 1 && strcmp(args.Arg(1), "plugins") == 0)
@@ -1367,6 +1447,11 @@ void PlayerManager::OnClientSettingsChanged(edict_t *pEntity)
 
 void PlayerManager::OnClientLanguageChanged(int client, unsigned int language)
 {
+	/* The language can arrive long after connect (CS:GO queries it), so make sure its
+	 * phrases are loaded before any plugin hears about it.
+	 */
+	logicore.MaterializeLanguage(language);
+
 	m_cllang->PushCell(client);
 	m_cllang->PushCell(language);
 	m_cllang->Execute(NULL);
@@ -1391,6 +1476,203 @@ int PlayerManager::GetNumPlayers()
 	return m_PlayerCount;
 }
 
+void PlayerManager::UpdateClientState(int client)
+{
+	if (client < 1 || client > SM_MAXPLAYERS)
+	{
+		return;
+	}
+
+	CPlayer *pPlayer = &m_Players[client];
+	unsigned int flags = 0;
+	if (pPlayer->m_IsConnected)
+		flags |= ClientState_Connected;
+	if (pPlayer->m_IsInGame)
+		flags |= ClientState_InGame;
+	if (pPlayer->m_bFakeClient)
+		flags |= ClientState_FakeClient;
+	if (pPlayer->m_IsAuthorized)
+		flags |= ClientState_Authorized;
+	if (pPlayer->m_bIsSourceTV)
+		flags |= ClientState_SourceTV;
+	if (pPlayer->m_bIsReplay)
+		flags |= ClientState_Replay;
+
+	m_ClientStateFlags[client] = flags;
+
+	uint64_t bit = uint64_t(1) << (client % 64);
+	for (int i = 0; i < kClientStateBits; i++)
+	{
+		uint64_t &word = m_ClientStateBits[i][client / 64];
+		if (flags & (1 << i))
+			word |= bit;
+		else
+			word &= ~bit;
+	}
+}
+
+void PlayerManager::GetClientStateMask(unsigned int flags, unsigned int exclude, uint64_t *mask)
+{
+	for (int w = 0; w < kClientStateWords; w++)
+	{
+		int base = w * 64;
+		if (base > m_maxClients)
+		{
+			mask[w] = 0;
+			continue;
+		}
+
+		uint64_t word = ~uint64_t(0);
+		if (w == 0)
+		{
+			word &= ~uint64_t(1);
+		}
+		if (m_maxClients - base < 63)
+		{
+			word &= (uint64_t(1) << (m_maxClients - base + 1)) - 1;
+		}
+		for (int i = 0; i < kClientStateBits; i++)
+		{
+			if (flags & (1 << i))
+				word &= m_ClientStateBits[i][w];
+			else if (exclude & (1 << i))
+				word &= ~m_ClientStateBits[i][w];
+		}
+		mask[w] = word;
+	}
+}
+
+int PlayerManager::ClientsInMask(const uint64_t *mask, int *clients)
+{
+	int count = 0;
+	for (int w = 0; w < kClientStateWords; w++)
+	{
+		uint64_t word = mask[w];
+		for (int bit = 0; word; bit++, word >>= 1)
+		{
+			if (word & 1)
+			{
+				clients[count++] = w * 64 + bit;
+			}
+		}
+	}
+	return count;
+}
+
+unsigned int PlayerManager::GetClientStateFlags(int client)
+{
+	if (client < 1 || client > m_maxClients)
+	{
+		return 0;
+	}
+	return m_ClientStateFlags[client];
+}
+
+int PlayerManager::GetClientsMatching(unsigned int flags, unsigned int exclude, int team, int *clients, int maxclients)
+{
+	/* Alive and team can change without us seeing it, so they are read live,
+	 * and only make sense for clients that are in game. */
+	bool bAlive = (flags & ClientState_Alive) != 0;
+	bool bDead = (exclude & ClientState_Alive) != 0;
+	if (bAlive || bDead || team >= 0)
+	{
+		flags |= ClientState_InGame;
+	}
+
+	uint64_t mask[kClientStateWords];
+	GetClientStateMask(flags, exclude, mask);
+
+	int count = 0;
+	for (int w = 0; w < kClientStateWords && count < maxclients; w++)
+	{
+		int base = w * 64;
+		uint64_t word = mask[w];
+		for (int bit = 0; word && count < maxclients; bit++, word >>= 1)
+		{
+			if (!(word & 1))
+			{
+				continue;
+			}
+
+			int client = base + bit;
+			CPlayer *pPlayer = &m_Players[client];
+			if ((flags & ClientState_InGame) && !pPlayer->IsInGame())
+			{
+				continue;
+			}
+			if (bAlive || bDead)
+			{
+				bool alive = (pPlayer->GetLifeState() == PLAYER_LIFE_ALIVE);
+				if ((bAlive && !alive) || (bDead && alive))
+				{
+					continue;
+				}
+			}
+			if (team >= 0)
+			{
+				IPlayerInfo *pInfo = pPlayer->GetPlayerInfo();
+				if (!pInfo || pInfo->GetTeamIndex() != team)
+				{
+					continue;
+				}
+			}
+
+			clients[count++] = client;
+		}
+	}
+
+	return count;
+}
+
+void PlayerManager::UpdateSteamIdLookup(CPlayer *pPlayer)
+{
+	uint64_t steamId = pPlayer->m_SteamId.IsValid() ? pPlayer->m_SteamId.ConvertToUint64() : 0;
+	if (steamId == pPlayer->m_IndexedSteamId64)
+	{
+		return;
+	}
+
+	if (pPlayer->m_IndexedSteamId64)
+	{
+		SteamIdLookup::Result r = m_SteamIdLookUp.find(pPlayer->m_IndexedSteamId64);
+		if (r.found() && r->value == pPlayer->m_iIndex)
+		{
+			m_SteamIdLookUp.remove(r);
+		}
+	}
+
+	pPlayer->m_IndexedSteamId64 = steamId;
+	if (steamId)
+	{
+		SteamIdLookup::Insert i = m_SteamIdLookUp.findForAdd(steamId);
+		if (i.found())
+		{
+			i->value = pPlayer->m_iIndex;
+		}
+		else
+		{
+			m_SteamIdLookUp.add(i, steamId, pPlayer->m_iIndex);
+		}
+	}
+}
+
+int PlayerManager::GetClientOfSteamId64(uint64_t steamId, bool validated)
+{
+	SteamIdLookup::Result r = m_SteamIdLookUp.find(steamId);
+	if (!r.found())
+	{
+		return 0;
+	}
+
+	CPlayer *pPlayer = GetPlayerByIndex(r->value);
+	if (!pPlayer || !pPlayer->IsConnected() || pPlayer->GetSteamId64(validated) != steamId)
+	{
+		return 0;
+	}
+
+	return r->value;
+}
+
 int PlayerManager::GetClientOfUserId(int userid)
 {
 	if (userid < 0 || userid > USHRT_MAX)
@@ -1585,9 +1867,16 @@ int PlayerManager::InternalFilterCommandTarget(CPlayer *pAdmin, CPlayer *pTarget
 void PlayerManager::ProcessCommandTarget(cmd_target_info_t *info)
 {
 	CPlayer *pTarget, *pAdmin;
-	int max_clients, total = 0;
+	int total = 0;
+
+	/* Candidate slots come from the cached state bitsets, so targeting only
+	 * ever visits clients that can possibly match. */
+	uint64_t mask[kClientStateWords];
+	int candidates[SM_MAXPLAYERS];
+	int num_candidates;
 
-	max_clients = GetMaxClients();
+	GetClientStateMask(ClientState_Connected, 0, mask);
+	num_candidates = ClientsInMask(mask, candidates);
 
 	if (info->max_targets < 1)
 	{
@@ -1673,16 +1962,10 @@ void PlayerManager::ProcessCommandTarget(cmd_target_info_t *info)
 				new_pattern[p] = '\0';
 			}
 
-			for (int i = 1; i <= max_clients; i++)
+			for (int c = 0; c < num_candidates; c++)
 			{
-				if ((pTarget = GetPlayerByIndex(i)) == NULL)
-				{
-					continue;
-				}
-				if (!pTarget->IsConnected())
-				{
-					continue;
-				}
+				int i = candidates[c];
+				pTarget = &m_Players[i];
 				
 				// We want to make it easy for people to be kicked/banned, so don't require validation for command targets.
 				const char *steamId = steamIdType == 2 ? pTarget->GetSteam2Id(false) : pTarget->GetSteam3Id(false);
@@ -1706,16 +1989,10 @@ void PlayerManager::ProcessCommandTarget(cmd_target_info_t *info)
 		}
 
 		/* See if an exact name matches */
-		for (int i = 1; i <= max_clients; i++)
+		for (int c = 0; c < num_candidates; c++)
 		{
-			if ((pTarget = GetPlayerByIndex(i)) == NULL)
-			{
-				continue;
-			}
-			if  (!pTarget->IsConnected())
-			{
-				continue;
-			}
+			int i = candidates[c];
+			pTarget = &m_Players[i];
 			if (strcmp(pTarget->GetName(), &info->pattern[1]) == 0)
 			{
 				if ((info->reason = FilterCommandTarget(pAdmin, pTarget, info->flags))
@@ -1820,19 +2097,32 @@ void PlayerManager::ProcessCommandTarget(cmd_target_info_t *info)
 
 		if (is_multi)
 		{
-			for (int i = 1; i <= max_clients && total < info->max_targets; i++)
+			unsigned int need = ((info->flags & COMMAND_FILTER_CONNECTED) == COMMAND_FILTER_CONNECTED)
+				? ClientState_Connected
+				: ClientState_InGame;
+			unsigned int exclude = 0;
+			if (bots_only)
 			{
-				if ((pTarget = GetPlayerByIndex(i)) == NULL)
-				{
-					continue;
-				}
-				if (FilterCommandTarget(pAdmin, pTarget, info->flags) > 0)
+				need |= ClientState_FakeClient;
+			}
+			if ((info->flags & COMMAND_FILTER_NO_BOTS) == COMMAND_FILTER_NO_BOTS)
+			{
+				exclude |= ClientState_FakeClient;
+			}
+			GetClientStateMask(need, exclude, mask);
+			if (skip_client > 0 && skip_client <= SM_MAXPLAYERS)
+			{
+				mask[skip_client / 64] &= ~(uint64_t(1) << (skip_client % 64));
+			}
+			num_candidates = ClientsInMask(mask, candidates);
+
+			/* Immunity, life state and edict validity are not cached. */
+			for (int c = 0; c < num_candidates && total < info->max_targets; c++)
+			{
+				int i = candidates[c];
+				if (InternalFilterCommandTarget(pAdmin, &m_Players[i], info->flags) > 0)
 				{
-					if ((!bots_only || pTarget->IsFakeClient())
-						&& skip_client != i)
-					{
-						info->targets[total++] = i;
-					}
+					info->targets[total++] = i;
 				}
 			}
 
@@ -1852,17 +2142,30 @@ void PlayerManager::ProcessCommandTarget(cmd_target_info_t *info)
 		}
 	}
 
-	/* Check partial names */
-	int found_client = 0;
-	CPlayer *pFoundClient = NULL;
-	for (int i = 1; i <= max_clients; i++)
+	/* Check partial names against the lowercased names kept by SetName().
+	 * A pattern longer than any name cannot match. */
+	char lowered[MAX_PLAYER_NAME_LENGTH];
+	size_t pattern_len = strlen(info->pattern);
+	if (pattern_len >= sizeof(lowered))
+	{
+		num_candidates = 0;
+	}
+	else
 	{
-		if ((pTarget = GetPlayerByIndex(i)) == NULL)
+		for (size_t i = 0; i <= pattern_len; i++)
 		{
-			continue;
+			lowered[i] = tolower((unsigned char)info->pattern[i]);
 		}
+	}
 
-		if (logicore.stristr(pTarget->GetName(), info->pattern) != NULL)
+	int found_client = 0;
+	CPlayer *pFoundClient = NULL;
+	for (int c = 0; c < num_candidates; c++)
+	{
+		int i = candidates[c];
+		pTarget = &m_Players[i];
+
+		if (strstr(pTarget->m_NameLower, lowered) != NULL)
 		{
 			if (found_client)
 			{
@@ -2025,6 +2328,8 @@ void CPlayer::Initialize(const char *name, const char *ip, edict_t *pEntity)
 	}
 	m_IpNoPort.assign(ip2);
 
+	g_Players.UpdateClientState(m_iIndex);
+
 #if SOURCE_ENGINE == SE_TF2      \
 	|| SOURCE_ENGINE == SE_CSS   \
 	|| SOURCE_ENGINE == SE_DODS  \
@@ -2065,6 +2370,7 @@ void CPlayer::Connect()
 	}
 
 	m_IsInGame = true;
+	g_Players.UpdateClientState(m_iIndex);
 
 	const char *var = g_Players.GetPassInfoVar();
 	int client = IndexOfEdict(m_pEdict);
@@ -2084,11 +2390,14 @@ void CPlayer::UpdateAuthIds()
 	if (m_IsAuthorized || (!SetEngineString() && !SetCSteamID()))
 		return;
 	
-	// Now cache Steam2/3 rendered ids
+	// Now cache Steam2/3/64 rendered ids
+	m_SteamId64[0] = '\0';
+	g_Players.UpdateSteamIdLookup(this);
+
 	if (IsFakeClient())
 	{
-		m_Steam2Id = "BOT";
-		m_Steam3Id = "BOT";
+		ke::SafeStrcpy(m_Steam2Id, sizeof(m_Steam2Id), "BOT");
+		ke::SafeStrcpy(m_Steam3Id, sizeof(m_Steam3Id), "BOT");
 		return;
 	}
 	
@@ -2096,14 +2405,14 @@ void CPlayer::UpdateAuthIds()
 	{
 		if (g_HL2.IsLANServer())
 		{
-			m_Steam2Id = "STEAM_ID_LAN";
-			m_Steam3Id = "STEAM_ID_LAN";
+			ke::SafeStrcpy(m_Steam2Id, sizeof(m_Steam2Id), "STEAM_ID_LAN");
+			ke::SafeStrcpy(m_Steam3Id, sizeof(m_Steam3Id), "STEAM_ID_LAN");
 			return;
 		}
 		else
 		{
-			m_Steam2Id = "STEAM_ID_PENDING";
-			m_Steam3Id = "STEAM_ID_PENDING";
+			ke::SafeStrcpy(m_Steam2Id, sizeof(m_Steam2Id), "STEAM_ID_PENDING");
+			ke::SafeStrcpy(m_Steam3Id, sizeof(m_Steam3Id), "STEAM_ID_PENDING");
 		}
 		
 		return;
@@ -2116,31 +2425,31 @@ void CPlayer::UpdateAuthIds()
 		steam2universe = k_EUniverseInvalid;
 	}
 	
-	char szAuthBuffer[64];
-	ke::SafeSprintf(szAuthBuffer, sizeof(szAuthBuffer), "STEAM_%u:%u:%u", steam2universe, m_SteamId.GetAccountID() & 1, m_SteamId.GetAccountID() >> 1);
-	
-	m_Steam2Id = szAuthBuffer;
+	ke::SafeSprintf(m_Steam2Id, sizeof(m_Steam2Id), "STEAM_%u:%u:%u", steam2universe, m_SteamId.GetAccountID() & 1, m_SteamId.GetAccountID() >> 1);
 	
 	// TODO: make sure all hl2sdks' steamclientpublic.h have k_unSteamUserDesktopInstance.
 	if (m_SteamId.GetUnAccountInstance() == 1 /* k_unSteamUserDesktopInstance */)
 	{
-		ke::SafeSprintf(szAuthBuffer, sizeof(szAuthBuffer), "[U:%u:%u]", m_SteamId.GetEUniverse(), m_SteamId.GetAccountID());
+		ke::SafeSprintf(m_Steam3Id, sizeof(m_Steam3Id), "[U:%u:%u]", m_SteamId.GetEUniverse(), m_SteamId.GetAccountID());
 	}
 	else
 	{
-		ke::SafeSprintf(szAuthBuffer, sizeof(szAuthBuffer), "[U:%u:%u:%u]", m_SteamId.GetEUniverse(), m_SteamId.GetAccountID(), m_SteamId.GetUnAccountInstance());
+		ke::SafeSprintf(m_Steam3Id, sizeof(m_Steam3Id), "[U:%u:%u:%u]", m_SteamId.GetEUniverse(), m_SteamId.GetAccountID(), m_SteamId.GetUnAccountInstance());
+	}
+
+	if (!g_HL2.IsLANServer())
+	{
+		ke::SafeSprintf(m_SteamId64, sizeof(m_SteamId64), "%" PRIu64, m_SteamId.ConvertToUint64());
 	}
-	
-	m_Steam3Id = szAuthBuffer;
 }
 
 bool CPlayer::SetEngineString()
 {
 	const char *authstr = engine->GetPlayerNetworkIDString(m_pEdict);
-	if (!authstr || m_AuthID.compare(authstr) == 0)
+	if (!authstr || strcmp(m_AuthID, authstr) == 0)
 		return false;
 
-	m_AuthID = authstr;
+	ke::SafeStrcpy(m_AuthID, sizeof(m_AuthID), authstr);
 	SetCSteamID();
 	return true;
 }
@@ -2185,6 +2494,7 @@ bool CPlayer::SetCSteamID()
 void CPlayer::Authorize()
 {
 	m_IsAuthorized = true;
+	g_Players.UpdateClientState(m_iIndex);
 }
 
 void CPlayer::Disconnect()
@@ -2194,11 +2504,14 @@ void CPlayer::Disconnect()
 	m_IsInGame = false;
 	m_IsAuthorized = false;
 	m_Name.clear();
+	m_NameLower[0] = '\0';
 	m_Ip.clear();
-	m_AuthID = "";
+	m_AuthID[0] = '\0';
 	m_SteamId = k_steamIDNil;
-	m_Steam2Id = "";
-	m_Steam3Id = "";
+	m_Steam2Id[0] = '\0';
+	m_Steam3Id[0] = '\0';
+	m_SteamId64[0] = '\0';
+	g_Players.UpdateSteamIdLookup(this);
 	m_pEdict = NULL;
 	m_Info = NULL;
 	m_pIClient = NULL;
@@ -2213,6 +2526,7 @@ void CPlayer::Disconnect()
 	m_LanguageCookie = InvalidQueryCvarCookie;
 #endif
 	ClearNetchannelQueue();
+	g_Players.UpdateClientState(m_iIndex);
 }
 
 void CPlayer::ClearNetchannelQueue(void)
@@ -2247,6 +2561,12 @@ void CPlayer::SetName(const char *name)
 	}
 
 	m_Name.assign(szNewName);
+
+	for (i = 0; szNewName[i] != '\0'; i++)
+	{
+		m_NameLower[i] = tolower((unsigned char)szNewName[i]);
+	}
+	m_NameLower[i] = '\0';
 }
 
 const char *CPlayer::GetName()
@@ -2266,7 +2586,7 @@ const char *CPlayer::GetAuthString(bool validated)
 		return NULL;
 	}
 
-	return m_AuthID.c_str();
+	return m_AuthID;
 }
 
 const CSteamID &CPlayer::GetSteamId(bool validated)
@@ -2282,22 +2602,32 @@ const CSteamID &CPlayer::GetSteamId(bool validated)
 
 const char *CPlayer::GetSteam2Id(bool validated)
 {
-	if (!m_Steam2Id.length() || (validated && !IsAuthStringValidated()))
+	if (!m_Steam2Id[0] || (validated && !IsAuthStringValidated()))
 	{
 		return NULL;
 	}
 
-	return m_Steam2Id.c_str();
+	return m_Steam2Id;
 }
 
 const char *CPlayer::GetSteam3Id(bool validated)
 {
-	if (!m_Steam3Id.length() || (validated && !IsAuthStringValidated()))
+	if (!m_Steam3Id[0] || (validated && !IsAuthStringValidated()))
 	{
 		return NULL;
 	}
 
-	return m_Steam3Id.c_str();
+	return m_Steam3Id;
+}
+
+const char *CPlayer::GetSteamId64String(bool validated)
+{
+	if (!m_SteamId64[0] || (validated && !IsAuthStringValidated()))
+	{
+		return NULL;
+	}
+
+	return m_SteamId64;
 }
 
 unsigned int CPlayer::GetSteamAccountID(bool validated)
@@ -2418,6 +2748,10 @@ void CPlayer::DumpAdmin(bool deleting)
 void CPlayer::Kick(const char *str)
 {
 	MarkAsBeingKicked();
+
+	/* Anything printed to the client right before the kick must reach it first */
+	g_Players.FlushPrintfBuffer(m_iIndex);
+
 	IClient *pClient = GetIClient();
 	if (pClient == nullptr)
 	{
@@ -2563,8 +2897,17 @@ void CPlayer::DoBasicAdminChecks()
 		}
 	}
 
-	/* Check steam id */
-	if ((id = adminsys->FindAdminByIdentity("steam", m_AuthID.c_str())) != INVALID_ADMIN_ID)
+	/* Check steam id; real accounts go through the account id index */
+	unsigned int accountId = GetSteamAccountID(false);
+	if (accountId != 0)
+	{
+		id = adminsys->FindAdminBySteamAccount(accountId);
+	}
+	else
+	{
+		id = adminsys->FindAdminByIdentity("steam", m_AuthID);
+	}
+	if (id != INVALID_ADMIN_ID)
 	{
 		if (g_Players.CheckSetAdmin(client, this, id))
 		{
@@ -44,6 +44,7 @@
 #include <sh_vector.h>
 #include <am-string.h>
 #include <am-deque.h>
+#include <am-hashmap.h>
 #include "ConVarManager.h"
 
 #include <steam/steamclientpublic.h>
@@ -82,6 +83,7 @@ public:
 	uint64_t GetSteamId64(bool validated = true) { return GetSteamId(validated).ConvertToUint64(); }
 	const char *GetSteam2Id(bool validated = true);
 	const char *GetSteam3Id(bool validated = true);
+	const char *GetSteamId64String(bool validated = true);
 	edict_t *GetEdict();
 	bool IsInGame();
 	bool WasCountedAsInGame();
@@ -132,11 +134,15 @@ private:
 	bool m_IsAuthorized = false;
 	bool m_bIsInKickQueue = false;
 	String m_Name;
+	char m_NameLower[MAX_PLAYER_NAME_LENGTH] = "";
 	String m_Ip;
 	String m_IpNoPort;
-	std::string m_AuthID;
-	std::string m_Steam2Id;
-	std::string m_Steam3Id;
+	/* All auth id formats are rendered once by UpdateAuthIds(). */
+	char m_AuthID[64] = "";
+	char m_Steam2Id[32] = "";
+	char m_Steam3Id[32] = "";
+	char m_SteamId64[24] = "";
+	uint64_t m_IndexedSteamId64 = 0;
 	AdminId m_Admin = INVALID_ADMIN_ID;
 	bool m_TempAdmin = false;
 	edict_t *m_pEdict = nullptr;
@@ -144,7 +150,7 @@ private:
 	IClient *m_pIClient = nullptr;
 	String m_LastPassword;
 	bool m_bAdminCheckSignalled = false;
-	int m_iIndex;
+	int m_iIndex = 0;
 	unsigned int m_LangId = SOURCEMOD_LANGUAGE_ENGLISH;
 	unsigned int m_OriginalLangId = SOURCEMOD_LANGUAGE_ENGLISH;
 	int m_UserId = -1;
@@ -174,6 +180,10 @@ public: //SMGlobalClass
 	void OnSourceModLevelEnd();
 	ConfigResult OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source, char *error, size_t maxlength);
 	void OnSourceModMaxPlayersChanged(int newvalue);
+	const char *GetGlobalClassName()
+	{
+		return "PlayerManager";
+	}
 public:
 	CPlayer *GetPlayerByIndex(int client) const;
 	void RunAuthChecks();
@@ -198,6 +208,10 @@ public:
 	void OnServerHibernationUpdate(bool bHibernating);
 	void OnClientPrintf(edict_t *pEdict, const char *szMsg);
 	void OnPrintfFrameAction(unsigned int serial);
+	/* Sends whatever queued prints still fit, and drops the rest; for disconnects and kicks. */
+	void FlushPrintfBuffer(int client);
+private:
+	bool SendPrintfBuffer(int client);
 public: //IPlayerManager
 	void AddClientListener(IClientListener *listener);
 	void RemoveClientListener(IClientListener *listener);
@@ -215,11 +229,18 @@ public: //IPlayerManager
 	int GetClientFromSerial(unsigned int serial);
 	void ClearAdminId(AdminId id);
 	void RecheckAnyAdmins();
+	unsigned int GetClientStateFlags(int client);
+	int GetClientsMatching(unsigned int flags, unsigned int exclude, int team, int *clients, int maxclients);
+	int GetClientOfSteamId64(uint64_t steamId, bool validated);
 public:
 	inline int MaxClients()
 	{
 		return m_maxClients;
 	}
+	inline const int *MaxClientsPtr() const
+	{
+		return &m_maxClients;
+	}
 	inline int NumPlayers()
 	{
 		return m_PlayerCount;
@@ -244,6 +265,10 @@ public:
 private:
 	void OnServerActivate(edict_t *pEdictList, int edictCount, int clientMax);
 	void InvalidatePlayer(CPlayer *pPlayer);
+	void UpdateClientState(int client);
+	void GetClientStateMask(unsigned int flags, unsigned int exclude, uint64_t *mask);
+	int ClientsInMask(const uint64_t *mask, int *clients);
+	void UpdateSteamIdLookup(CPlayer *pPlayer);
 private:
 	List<IClientListener *> m_hooks;
 	IForward *m_clconnect;
@@ -269,6 +294,7 @@ private:
 	String m_PassInfoVar;
 	bool m_QueryLang;
 	bool m_bAuthstringValidation; // are we validating admins with steam before authorizing?
+	bool m_bCoalesceClientPrints; // are console prints batched into one SVC_Print per frame?
 	bool m_bIsListenServer;
 	int m_ListenClient;
 	bool m_bIsSourceTVActive;
@@ -276,6 +302,25 @@ private:
 	int m_SourceTVUserId;
 	int m_ReplayUserId;
 	bool m_bInCCKVHook;
+	/* Dense copies of each client's ClientState_* bits, one bitset per bit
+	 * plus one flags word per client, kept in step by UpdateClientState(). */
+	static const int kClientStateBits = 6;
+	static const int kClientStateWords = (SM_MAXPLAYERS + 1 + 63) / 64;
+	uint64_t m_ClientStateBits[kClientStateBits][kClientStateWords];
+	unsigned int m_ClientStateFlags[SM_MAXPLAYERS + 1];
+	struct SteamId64Policy
+	{
+		static inline uint32_t hash(const uint64_t key)
+		{
+			return ke::HashInt64(key);
+		}
+		static inline bool matches(const uint64_t find, const uint64_t &key)
+		{
+			return find == key;
+		}
+	};
+	typedef ke::HashMap<uint64_t, int, SteamId64Policy> SteamIdLookup;
+	SteamIdLookup m_SteamIdLookUp;
 private:
 	static const int NETMSG_TYPE_BITS = 5; // SVC_Print overhead for netmsg type
 	static const int SVC_Print_BufferSize = 2048 - 1; // -1 for terminating \0
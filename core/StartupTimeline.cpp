@@ -0,0 +1,282 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "StartupTimeline.h"
+#include "sourcemod.h"
+#include "logic_bridge.h"
+#include <bridge/include/ILogger.h>
+#include <string.h>
+#include <memory>
+#include <thread>
+
+StartupTimeline g_StartupTimeline;
+
+void StartupTimeline::OnSourceModAllInitialized()
+{
+	rootmenu->AddRootConsoleCommand3("startup", "Show the startup or last level change timeline", this);
+}
+
+void StartupTimeline::OnSourceModShutdown()
+{
+	rootmenu->RemoveRootConsoleCommand("startup", this);
+}
+
+void StartupTimeline::Record::Close()
+{
+	while (!open.empty())
+	{
+		Entry &entry = entries[open.back().first];
+		entry.ms = StartupElapsedMs(open.back().second);
+		if (entry.depth == 0)
+		{
+			total += entry.ms;
+		}
+		open.pop_back();
+	}
+}
+
+void StartupTimeline::BeginPhase(const char *name)
+{
+	if (!m_Current)
+	{
+		return;
+	}
+
+	Entry entry;
+	entry.name = name;
+	entry.depth = (unsigned int)m_Current->open.size();
+	entry.ms = 0.0;
+	m_Current->entries.push_back(entry);
+	m_Current->open.push_back(std::make_pair(m_Current->entries.size() - 1, Clock::now()));
+}
+
+void StartupTimeline::EndPhase()
+{
+	if (!m_Current || m_Current->open.empty())
+	{
+		return;
+	}
+
+	Entry &entry = m_Current->entries[m_Current->open.back().first];
+	entry.ms = StartupElapsedMs(m_Current->open.back().second);
+	if (entry.depth == 0)
+	{
+		m_Current->total += entry.ms;
+	}
+	m_Current->open.pop_back();
+}
+
+void StartupTimeline::RecordStep(const char *name, double ms)
+{
+	if (!m_Current)
+	{
+		return;
+	}
+
+	Entry entry;
+	entry.name = name;
+	entry.depth = (unsigned int)m_Current->open.size();
+	entry.ms = ms;
+	m_Current->entries.push_back(entry);
+	if (entry.depth == 0)
+	{
+		m_Current->total += ms;
+	}
+}
+
+void StartupTimeline::NotifyAll(const char *phase, NotifyFn fn, const void *data)
+{
+	SMGlobalClass *pBase;
+
+	if (!m_Current)
+	{
+		for (pBase = SMGlobalClass::head; pBase; pBase = pBase->m_pGlobalClassNext)
+		{
+			fn(pBase, data);
+		}
+		return;
+	}
+
+	BeginPhase(phase);
+
+	/* Classes without a name are only interesting as a group. */
+	double unnamed = 0.0;
+	for (pBase = SMGlobalClass::head; pBase; pBase = pBase->m_pGlobalClassNext)
+	{
+		Clock::time_point start = Clock::now();
+		fn(pBase, data);
+		double ms = StartupElapsedMs(start);
+
+		const char *name = pBase->GetGlobalClassName();
+		if (name)
+		{
+			RecordStep(name, ms);
+		}
+		else
+		{
+			unnamed += ms;
+		}
+	}
+	RecordStep("(other classes)", unnamed);
+
+	EndPhase();
+}
+
+void StartupTimeline::RunPreloads()
+{
+	std::vector<SMGlobalClass *> classes;
+	for (SMGlobalClass *pBase = SMGlobalClass::head; pBase; pBase = pBase->m_pGlobalClassNext)
+	{
+		if (pBase->HasPreloadWork())
+		{
+			classes.push_back(pBase);
+		}
+	}
+
+	if (classes.empty())
+	{
+		return;
+	}
+
+	BeginPhase("OnSourceModPreload (concurrent)");
+
+	std::vector<double> times(classes.size(), 0.0);
+	std::vector<std::unique_ptr<std::thread>> threads;
+	for (size_t i = 0; i < classes.size(); i++)
+	{
+		threads.emplace_back(new std::thread([&classes, &times, i]() -> void {
+			Clock::time_point start = Clock::now();
+			classes[i]->OnSourceModPreload();
+			times[i] = StartupElapsedMs(start);
+		}));
+	}
+
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		threads[i]->join();
+	}
+
+	for (size_t i = 0; i < classes.size(); i++)
+	{
+		const char *name = classes[i]->GetGlobalClassName();
+		RecordStep(name ? name : "(unnamed class)", times[i]);
+	}
+
+	EndPhase();
+}
+
+void StartupTimeline::Finish()
+{
+	if (m_StartupDone)
+	{
+		return;
+	}
+
+	m_Startup.Close();
+	m_Startup.title = "Startup";
+	m_StartupDone = true;
+	m_Current = NULL;
+
+	LogRecord(m_Startup);
+}
+
+void StartupTimeline::BeginLevelChange()
+{
+	if (!m_StartupDone)
+	{
+		return;
+	}
+
+	m_Level = Record();
+	m_Current = &m_Level;
+}
+
+void StartupTimeline::EndLevelChange(const char *mapName)
+{
+	if (m_Current != &m_Level)
+	{
+		return;
+	}
+
+	m_Level.Close();
+	m_Level.title = "Level change to ";
+	m_Level.title += mapName;
+	m_Current = NULL;
+}
+
+void StartupTimeline::LogRecord(const Record &record)
+{
+	/* Only the top-level phases go to the log; "sm startup" has the rest. */
+	logger->LogMessage("[SM] %s took %.1f ms", record.title.c_str(), record.total);
+	for (size_t i = 0; i < record.entries.size(); i++)
+	{
+		const Entry &entry = record.entries[i];
+		if (entry.depth == 0)
+		{
+			logger->LogMessage("[SM]   %-40s %9.1f ms", entry.name.c_str(), entry.ms);
+		}
+	}
+}
+
+void StartupTimeline::PrintRecord(const Record &record)
+{
+	UTIL_ConsolePrint("[SM] %s timeline (%.1f ms total):", record.title.c_str(), record.total);
+	for (size_t i = 0; i < record.entries.size(); i++)
+	{
+		const Entry &entry = record.entries[i];
+		unsigned int indent = entry.depth * 2;
+		int width = 40 - (int)indent;
+		UTIL_ConsolePrint("  %*s%-*s %9.2f ms", indent, "", width > 0 ? width : 0, entry.name.c_str(), entry.ms);
+	}
+}
+
+void StartupTimeline::OnRootConsoleCommand(const char *cmdname, const ICommandArgs *command)
+{
+	if (command->ArgC() >= 3 && strcmp(command->Arg(2), "level") == 0)
+	{
+		if (m_Level.title.empty())
+		{
+			UTIL_ConsolePrint("[SM] No level change has been recorded yet.");
+			return;
+		}
+
+		PrintRecord(m_Level);
+		return;
+	}
+
+	if (!m_StartupDone)
+	{
+		UTIL_ConsolePrint("[SM] Startup has not finished yet.");
+		return;
+	}
+
+	PrintRecord(m_Startup);
+}
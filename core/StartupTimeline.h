@@ -0,0 +1,121 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_SOURCEMOD_STARTUP_TIMELINE_H_
+#define _INCLUDE_SOURCEMOD_STARTUP_TIMELINE_H_
+
+#include "sm_globals.h"
+#include <IRootConsoleMenu.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace SourceMod;
+
+/**
+ * Records how long each startup phase, each SMGlobalClass hook and each
+ * extension load took, from module load until plugins are first loaded.
+ * The result is logged once and can be shown again with "sm startup".
+ *
+ * After startup, every level change is recorded the same way, from
+ * LevelShutdown of the old map until the new map is activated, and the
+ * most recent one is shown by "sm startup level".
+ */
+class StartupTimeline :
+	public SMGlobalClass,
+	public IRootConsoleCommand
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+	typedef void (*NotifyFn)(SMGlobalClass *pBase, const void *data);
+public: // SMGlobalClass
+	void OnSourceModAllInitialized() override;
+	void OnSourceModShutdown() override;
+public: // IRootConsoleCommand
+	void OnRootConsoleCommand(const char *cmdname, const ICommandArgs *command) override;
+public:
+	/* Phases nest; steps are recorded under the innermost open phase. */
+	void BeginPhase(const char *name);
+	void EndPhase();
+	void RecordStep(const char *name, double ms);
+
+	/* Runs an SMGlobalClass hook on every class, timing each one. */
+	void NotifyAll(const char *phase, NotifyFn fn, const void *data = NULL);
+
+	/* Runs OnSourceModPreload for every class with preload work, concurrently. */
+	void RunPreloads();
+
+	/* Stops recording startup and logs the summary. */
+	void Finish();
+
+	/* Starts or stops recording a level change; ignored during startup. */
+	void BeginLevelChange();
+	void EndLevelChange(const char *mapName);
+
+	bool IsRecording() const
+	{
+		return m_Current != NULL;
+	}
+private:
+	struct Entry
+	{
+		std::string name;
+		unsigned int depth;
+		double ms;
+	};
+	struct Record
+	{
+		std::vector<Entry> entries;
+		/* Indexes into entries of the open phases, with their start times */
+		std::vector<std::pair<size_t, Clock::time_point>> open;
+		double total = 0.0;
+		std::string title;
+
+		void Close();
+	};
+	void LogRecord(const Record &record);
+	void PrintRecord(const Record &record);
+private:
+	Record m_Startup;
+	Record m_Level;
+	/* The record being written to, or NULL between level changes */
+	Record *m_Current = &m_Startup;
+	bool m_StartupDone = false;
+};
+
+static inline double StartupElapsedMs(StartupTimeline::Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(StartupTimeline::Clock::now() - start).count();
+}
+
+extern StartupTimeline g_StartupTimeline;
+
+#endif //_INCLUDE_SOURCEMOD_STARTUP_TIMELINE_H_
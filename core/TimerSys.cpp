@@ -30,13 +30,19 @@
  */
 
 #include <time.h>
+#include <math.h>
+#include <stdlib.h>
 #include "TimerSys.h"
 #include "sourcemm_api.h"
 #include "frame_hooks.h"
 #include "ConVarManager.h"
 #include "logic_bridge.h"
+#include "sourcemod.h"
+#include "PlayerManager.h"
+#include <amtl/am-string.h>
 
 #define TIMER_MIN_ACCURACY		0.1
+#define IDLE_CHECK_INTERVAL		1.0
 
 TimerSystem g_Timers;
 double g_fUniversalTime = 0.0f;
@@ -156,7 +162,110 @@ inline double CalcNextThink(double last, float interval)
 	}
 }
 
-void ITimer::Initialize(ITimedEvent *pCallbacks, float fInterval, float fToExec, void *pData, int flags)
+#define TIMER_WHEEL_ROOT_MASK		(TIMER_WHEEL_ROOT_SIZE - 1)
+#define TIMER_WHEEL_LEVEL_MASK		(TIMER_WHEEL_LEVEL_SIZE - 1)
+#define TIMER_WHEEL_MAX_DELTA		((int64_t)1 << (TIMER_WHEEL_ROOT_BITS + (TIMER_WHEEL_LEVELS - 1) * TIMER_WHEEL_LEVEL_BITS))
+#define TIMER_TICK_EPSILON			0.000001
+
+/**
+ * Timers created with TIMER_FLAG_ALIGN fire on multiples of their interval on 
+ * the universal clock, so every aligned timer sharing an interval expires at 
+ * the exact same time, lands in the same wheel bucket and is dispatched in one 
+ * batch instead of each keeping its own phase.  Returns the first boundary at 
+ * or after the given time.
+ */
+static inline double AlignToInterval(double time, float interval)
+{
+	return ceil(time / interval - TIMER_TICK_EPSILON) * interval;
+}
+
+static inline bool IsAlignedTimer(int flags, float interval)
+{
+	return (flags & (TIMER_FLAG_REPEAT|TIMER_FLAG_ALIGN)) == (TIMER_FLAG_REPEAT|TIMER_FLAG_ALIGN)
+		&& interval >= TIMER_MIN_ACCURACY;
+}
+
+/**
+ * Returns the first wheel tick at which the given time is reached.
+ */
+static inline int64_t TimeToExpireTick(double time)
+{
+	return (int64_t)ceil(time / TIMER_MIN_ACCURACY - TIMER_TICK_EPSILON);
+}
+
+/**
+ * Returns the last wheel tick that has been reached by the given time.
+ */
+static inline int64_t TimeToCurrentTick(double time)
+{
+	return (int64_t)floor(time / TIMER_MIN_ACCURACY + TIMER_TICK_EPSILON);
+}
+
+static inline int LevelShift(int level)
+{
+	return TIMER_WHEEL_ROOT_BITS + (level - 1) * TIMER_WHEEL_LEVEL_BITS;
+}
+
+void TimerBucket::Append(ITimer *pTimer)
+{
+	pTimer->m_pBucket = this;
+	pTimer->m_pNext = NULL;
+	pTimer->m_pPrev = m_pTail;
+	if (m_pTail)
+	{
+		m_pTail->m_pNext = pTimer;
+	}
+	else
+	{
+		m_pHead = pTimer;
+	}
+	m_pTail = pTimer;
+	m_Count++;
+}
+
+void TimerBucket::Remove(ITimer *pTimer)
+{
+	if (pTimer->m_pPrev)
+	{
+		pTimer->m_pPrev->m_pNext = pTimer->m_pNext;
+	}
+	else
+	{
+		m_pHead = pTimer->m_pNext;
+	}
+	if (pTimer->m_pNext)
+	{
+		pTimer->m_pNext->m_pPrev = pTimer->m_pPrev;
+	}
+	else
+	{
+		m_pTail = pTimer->m_pPrev;
+	}
+	pTimer->m_pBucket = NULL;
+	pTimer->m_pPrev = NULL;
+	pTimer->m_pNext = NULL;
+	m_Count--;
+}
+
+ITimer *TimerBucket::PopFront()
+{
+	ITimer *pTimer = m_pHead;
+	if (pTimer)
+	{
+		Remove(pTimer);
+	}
+	return pTimer;
+}
+
+void TimerBucket::TakeFrom(TimerBucket &other)
+{
+	while (!other.empty())
+	{
+		Append(other.PopFront());
+	}
+}
+
+void ITimer::Initialize(ITimedEvent *pCallbacks, float fInterval, double fToExec, void *pData, int flags)
 {
 	m_Listener = pCallbacks;
 	m_Interval = fInterval;
@@ -165,6 +274,10 @@ void ITimer::Initialize(ITimedEvent *pCallbacks, float fInterval, float fToExec,
 	m_Flags = flags;
 	m_InExec = false;
 	m_KillMe = false;
+	m_ExpireTick = 0;
+	m_pBucket = NULL;
+	m_pPrev = NULL;
+	m_pNext = NULL;
 }
 
 TimerSystem::TimerSystem()
@@ -173,6 +286,15 @@ TimerSystem::TimerSystem()
 	m_bHasMapTickedYet = false;
 	m_bHasMapSimulatedYet = false;
 	m_fLastTickedTime = 0.0f;
+	m_CurTick = 0;
+	m_TimerCount = 0;
+	m_fIdleResolution = 0.0f;
+	m_fIdleDelay = 30.0f;
+	m_IdleForwards = "OnGameFrame";
+	m_bIdle = false;
+	m_fEmptySince = -1.0;
+	m_fNextIdleCheck = 0.0;
+	m_fHooksThink = 0.0;
 }
 
 TimerSystem::~TimerSystem()
@@ -190,6 +312,9 @@ void TimerSystem::OnSourceModAllInitialized()
 	sharesys->AddInterface(NULL, this);
 	m_pOnGameFrame = forwardsys->CreateForward("OnGameFrame", ET_Ignore, 0, NULL);
 	m_pOnMapTimeLeftChanged = forwardsys->CreateForward("OnMapTimeLeftChanged", ET_Ignore, 0, NULL);
+	m_pOnIdleModeChanged = forwardsys->CreateForward("OnServerIdleModeChanged", ET_Ignore, 1, NULL, Param_Cell);
+
+	rootmenu->AddRootConsoleCommand3("timers", "Show timer wheel occupancy", this);
 }
 
 void TimerSystem::OnSourceModGameInitialized()
@@ -204,9 +329,60 @@ void TimerSystem::OnSourceModGameInitialized()
 
 void TimerSystem::OnSourceModShutdown()
 {
+	rootmenu->RemoveRootConsoleCommand("timers", this);
+
 	SetMapTimer(NULL);
 	forwardsys->ReleaseForward(m_pOnGameFrame);
 	forwardsys->ReleaseForward(m_pOnMapTimeLeftChanged);
+	forwardsys->ReleaseForward(m_pOnIdleModeChanged);
+}
+
+ConfigResult TimerSystem::OnSourceModConfigChanged(const char *key, 
+												   const char *value, 
+												   ConfigSource source, 
+												   char *error, 
+												   size_t maxlength)
+{
+	bool resolution = (strcmp(key, "IdleTimerResolution") == 0);
+	if (resolution || strcmp(key, "IdleModeDelay") == 0)
+	{
+		char *end;
+		double seconds = strtod(value, &end);
+		if (!value[0] || *end != '\0' || seconds < 0.0)
+		{
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be a number of seconds");
+			return ConfigResult_Reject;
+		}
+
+		if (resolution)
+		{
+			m_fIdleResolution = (float)seconds;
+			if (m_fIdleResolution > 0.0f && m_fIdleResolution < TIMER_MIN_ACCURACY)
+			{
+				m_fIdleResolution = TIMER_MIN_ACCURACY;
+			}
+			if (m_fIdleResolution == 0.0f && m_bIdle)
+			{
+				SetIdle(false);
+			}
+		}
+		else
+		{
+			m_fIdleDelay = (float)seconds;
+		}
+		return ConfigResult_Accept;
+	}
+	else if (strcmp(key, "IdleSuspendForwards") == 0)
+	{
+		m_IdleForwards = value;
+		if (m_bIdle)
+		{
+			logicore.SetSuspendedForwards(m_IdleForwards.c_str());
+		}
+		return ConfigResult_Accept;
+	}
+
+	return ConfigResult_Ignore;
 }
 
 void TimerSystem::OnSourceModLevelEnd()
@@ -215,6 +391,61 @@ void TimerSystem::OnSourceModLevelEnd()
 	m_bHasMapSimulatedYet = false;
 }
 
+void TimerSystem::CheckIdle()
+{
+	if (m_fIdleResolution <= 0.0f)
+	{
+		return;
+	}
+
+	bool empty = true;
+	int maxClients = g_Players.GetMaxClients();
+	for (int i = 1; i <= maxClients; i++)
+	{
+		CPlayer *pPlayer = g_Players.GetPlayerByIndex(i);
+		if (pPlayer->IsConnected() && !pPlayer->IsFakeClient())
+		{
+			empty = false;
+			break;
+		}
+	}
+
+	if (!empty)
+	{
+		m_fEmptySince = -1.0;
+		if (m_bIdle)
+		{
+			SetIdle(false);
+		}
+		return;
+	}
+
+	if (m_fEmptySince < 0.0)
+	{
+		m_fEmptySince = g_fUniversalTime;
+	}
+	if (!m_bIdle && g_fUniversalTime - m_fEmptySince >= m_fIdleDelay)
+	{
+		SetIdle(true);
+	}
+}
+
+void TimerSystem::SetIdle(bool idle)
+{
+	m_bIdle = idle;
+	logicore.SetSuspendedForwards(idle ? m_IdleForwards.c_str() : "");
+
+	if (!idle)
+	{
+		/* Catch up on anything that was coalesced right away. */
+		g_fTimerThink = g_fUniversalTime;
+		m_fHooksThink = g_fUniversalTime;
+	}
+
+	m_pOnIdleModeChanged->PushCell(idle ? 1 : 0);
+	m_pOnIdleModeChanged->Execute(NULL);
+}
+
 void TimerSystem::GameFrame(bool simulating)
 {
 	if (simulating && m_bHasMapTickedYet)
@@ -234,14 +465,28 @@ void TimerSystem::GameFrame(bool simulating)
 	m_fLastTickedTime = gpGlobals->curtime;
 	m_bHasMapTickedYet = true;
 
+	if (g_fUniversalTime >= m_fNextIdleCheck)
+	{
+		CheckIdle();
+		m_fNextIdleCheck = g_fUniversalTime + IDLE_CHECK_INTERVAL;
+	}
+
 	if (g_fUniversalTime >= g_fTimerThink)
 	{
 		RunFrame();
 
-		g_fTimerThink = CalcNextThink(g_fTimerThink, TIMER_MIN_ACCURACY);
+		g_fTimerThink = CalcNextThink(g_fTimerThink, m_bIdle ? m_fIdleResolution : TIMER_MIN_ACCURACY);
 	}
 
-	RunFrameHooks(simulating);
+	/* While idle, frame hooks (database and async file callbacks, queued frame 
+	 * actions and so on) are coalesced onto the same coarse clock as timers.
+	 */
+	if (!m_bIdle || g_fUniversalTime >= m_fHooksThink)
+	{
+		RunFrameHooks(simulating);
+
+		m_fHooksThink = g_fUniversalTime + m_fIdleResolution;
+	}
 
 	if (m_pOnGameFrame->GetFunctionCount())
 	{
@@ -249,56 +494,168 @@ void TimerSystem::GameFrame(bool simulating)
 	}
 }
 
+void TimerSystem::Schedule(ITimer *pTimer)
+{
+	int64_t expires = TimeToExpireTick(pTimer->m_ToExec);
+	if (expires < m_CurTick)
+	{
+		expires = m_CurTick;
+	}
+	pTimer->m_ExpireTick = expires;
+
+	int64_t delta = expires - m_CurTick;
+	if (delta < TIMER_WHEEL_ROOT_SIZE)
+	{
+		m_Root[expires & TIMER_WHEEL_ROOT_MASK].Append(pTimer);
+		return;
+	}
+
+	/* Timers beyond the wheel's horizon park in the farthest bucket and are 
+	 * re-evaluated each time that bucket cascades.
+	 */
+	if (delta >= TIMER_WHEEL_MAX_DELTA)
+	{
+		expires = m_CurTick + TIMER_WHEEL_MAX_DELTA - 1;
+		delta = TIMER_WHEEL_MAX_DELTA - 1;
+	}
+
+	for (int level = 1; level < TIMER_WHEEL_LEVELS; level++)
+	{
+		if (delta < ((int64_t)TIMER_WHEEL_ROOT_SIZE << (level * TIMER_WHEEL_LEVEL_BITS)))
+		{
+			m_Levels[level - 1][(expires >> LevelShift(level)) & TIMER_WHEEL_LEVEL_MASK].Append(pTimer);
+			return;
+		}
+	}
+}
+
+void TimerSystem::Unschedule(ITimer *pTimer)
+{
+	if (pTimer->m_pBucket)
+	{
+		pTimer->m_pBucket->Remove(pTimer);
+	}
+}
+
+void TimerSystem::Release(ITimer *pTimer)
+{
+	m_TimerCount--;
+	m_FreeTimers.push(pTimer);
+}
+
+bool TimerSystem::Cascade(int level)
+{
+	int index = (int)((m_CurTick >> LevelShift(level)) & TIMER_WHEEL_LEVEL_MASK);
+
+	TimerBucket moving;
+	moving.TakeFrom(m_Levels[level - 1][index]);
+	while (!moving.empty())
+	{
+		Schedule(moving.PopFront());
+	}
+
+	return (index == 0);
+}
+
+void TimerSystem::RunTimer(ITimer *pTimer)
+{
+	pTimer->m_InExec = true;
+	ResultType res = pTimer->m_Listener->OnTimer(pTimer, pTimer->m_pData);
+
+	if (!(pTimer->m_Flags & TIMER_FLAG_REPEAT) || pTimer->m_KillMe || (res == Pl_Stop))
+	{
+		pTimer->m_Listener->OnTimerEnd(pTimer, pTimer->m_pData);
+		Release(pTimer);
+		return;
+	}
+
+	pTimer->m_InExec = false;
+	pTimer->m_ToExec = CalcNextThink(pTimer->m_ToExec, pTimer->m_Interval);
+	if (IsAlignedTimer(pTimer->m_Flags, pTimer->m_Interval))
+	{
+		pTimer->m_ToExec = AlignToInterval(pTimer->m_ToExec, pTimer->m_Interval);
+	}
+	Schedule(pTimer);
+}
+
 void TimerSystem::RunFrame()
 {
 	ITimer *pTimer;
-	TimerIter iter;
-
 	double curtime = GetSimulatedTime();
-	for (iter=m_SingleTimers.begin(); iter!=m_SingleTimers.end(); )
+	int64_t now = TimeToCurrentTick(curtime);
+
+	if (!m_TimerCount)
 	{
-		pTimer = (*iter);
-		if (curtime >= pTimer->m_ToExec)
-		{
-			pTimer->m_InExec = true;
-			pTimer->m_Listener->OnTimer(pTimer, pTimer->m_pData);
-			pTimer->m_Listener->OnTimerEnd(pTimer, pTimer->m_pData);
-			iter = m_SingleTimers.erase(iter);
-			m_FreeTimers.push(pTimer);
-		} 
-		else 
+		/* Nothing to cascade, so jump straight to the present. */
+		if (m_CurTick <= now)
 		{
-			break;
+			m_CurTick = now + 1;
 		}
+		return;
 	}
 
-	ResultType res;
-	for (iter=m_LoopTimers.begin(); iter!=m_LoopTimers.end(); )
+	/* Every bucket up to the current tick is due in its entirety.  The cursor 
+	 * moves past a bucket before it is dispatched, so timers rescheduled by 
+	 * their own callbacks always land in a bucket that is still ahead.
+	 */
+	while (m_CurTick <= now)
 	{
-		pTimer = (*iter);
-		if (curtime >= pTimer->m_ToExec)
+		m_Firing.TakeFrom(m_Root[m_CurTick & TIMER_WHEEL_ROOT_MASK]);
+
+		m_CurTick++;
+		if ((m_CurTick & TIMER_WHEEL_ROOT_MASK) == 0)
 		{
-			pTimer->m_InExec = true;
-			res = pTimer->m_Listener->OnTimer(pTimer, pTimer->m_pData);
-			if (pTimer->m_KillMe || (res == Pl_Stop))
+			for (int level = 1; level < TIMER_WHEEL_LEVELS; level++)
 			{
-				pTimer->m_Listener->OnTimerEnd(pTimer, pTimer->m_pData);
-				iter = m_LoopTimers.erase(iter);
-				m_FreeTimers.push(pTimer);
-				continue;
+				if (!Cascade(level))
+				{
+					break;
+				}
+			}
+		}
+
+		while ((pTimer = m_Firing.PopFront()) != NULL)
+		{
+			if (curtime >= pTimer->m_ToExec)
+			{
+				RunTimer(pTimer);
+			}
+			else
+			{
+				Schedule(pTimer);
 			}
-			pTimer->m_InExec = false;
-			pTimer->m_ToExec = CalcNextThink(pTimer->m_ToExec, pTimer->m_Interval);
 		}
-		iter++;
+	}
+
+	/* Frames do not line up with tick boundaries, so timers expiring in the 
+	 * upcoming tick may already be due.
+	 */
+	m_Firing.TakeFrom(m_Root[m_CurTick & TIMER_WHEEL_ROOT_MASK]);
+	while ((pTimer = m_Firing.PopFront()) != NULL)
+	{
+		if (curtime >= pTimer->m_ToExec)
+		{
+			RunTimer(pTimer);
+		}
+		else
+		{
+			Schedule(pTimer);
+		}
 	}
 }
 
 ITimer *TimerSystem::CreateTimer(ITimedEvent *pCallbacks, float fInterval, void *pData, int flags)
 {
 	ITimer *pTimer;
-	TimerIter iter;
-	float to_exec = GetSimulatedTime() + fInterval;
+	double to_exec = GetSimulatedTime() + fInterval;
+
+	/* Never fire sooner than an unaligned timer would; the first run lands on 
+	 * the next boundary, at most one extra interval away.
+	 */
+	if (IsAlignedTimer(flags, fInterval))
+	{
+		to_exec = AlignToInterval(to_exec, fInterval);
+	}
 
 	if (m_FreeTimers.empty())
 	{
@@ -309,35 +666,10 @@ ITimer *TimerSystem::CreateTimer(ITimedEvent *pCallbacks, float fInterval, void
 	}
 
 	pTimer->Initialize(pCallbacks, fInterval, to_exec, pData, flags);
+	m_TimerCount++;
 
-	if (flags & TIMER_FLAG_REPEAT)
-	{
-		m_LoopTimers.push_back(pTimer);
-		goto return_timer;
-	}
-
-	if (m_SingleTimers.size() >= 1)
-	{
-		iter = --m_SingleTimers.end();
-		if ((*iter)->m_ToExec <= to_exec)
-		{
-			goto normal_insert_end;
-		}
-	}
-
-	for (iter=m_SingleTimers.begin(); iter!=m_SingleTimers.end(); iter++)
-	{
-		if ((*iter)->m_ToExec >= to_exec)
-		{
-			m_SingleTimers.insert(iter, pTimer);
-			goto return_timer;
-		}
-	}
+	Schedule(pTimer);
 
-normal_insert_end:
-	m_SingleTimers.push_back(pTimer);
-
-return_timer:
 	return pTimer;
 }
 
@@ -356,8 +688,8 @@ void TimerSystem::FireTimerOnce(ITimer *pTimer, bool delayExec)
 	if (!(pTimer->m_Flags & TIMER_FLAG_REPEAT))
 	{
 		pTimer->m_Listener->OnTimerEnd(pTimer, pTimer->m_pData);
-		m_SingleTimers.remove(pTimer);
-		m_FreeTimers.push(pTimer);
+		Unschedule(pTimer);
+		Release(pTimer);
 	} 
 	else 
 	{
@@ -366,13 +698,19 @@ void TimerSystem::FireTimerOnce(ITimer *pTimer, bool delayExec)
 			if (delayExec)
 			{
 				pTimer->m_ToExec = GetSimulatedTime() + pTimer->m_Interval;
+				if (IsAlignedTimer(pTimer->m_Flags, pTimer->m_Interval))
+				{
+					pTimer->m_ToExec = AlignToInterval(pTimer->m_ToExec, pTimer->m_Interval);
+				}
+				Unschedule(pTimer);
+				Schedule(pTimer);
 			}
 			pTimer->m_InExec = false;
 			return;
 		}
 		pTimer->m_Listener->OnTimerEnd(pTimer, pTimer->m_pData);
-		m_LoopTimers.remove(pTimer);
-		m_FreeTimers.push(pTimer);
+		Unschedule(pTimer);
+		Release(pTimer);
 	}
 }
 
@@ -392,37 +730,34 @@ void TimerSystem::KillTimer(ITimer *pTimer)
 	pTimer->m_InExec = true; /* The timer it's not really executed but this check needs to be done */
 	pTimer->m_Listener->OnTimerEnd(pTimer, pTimer->m_pData);
 
-	if (pTimer->m_Flags & TIMER_FLAG_REPEAT)
+	Unschedule(pTimer);
+	Release(pTimer);
+}
+
+static void CollectMapChangeTimers(TimerBucket &bucket, CStack<ITimer *> &list)
+{
+	for (ITimer *pTimer = bucket.front(); pTimer != NULL; pTimer = pTimer->m_pNext)
 	{
-		m_LoopTimers.remove(pTimer);
-	} else {
-		m_SingleTimers.remove(pTimer);
+		if (pTimer->m_Flags & TIMER_FLAG_NO_MAPCHANGE)
+		{
+			list.push(pTimer);
+		}
 	}
-
-	m_FreeTimers.push(pTimer);
 }
 
 CStack<ITimer *> s_tokill;
 void TimerSystem::RemoveMapChangeTimers()
 {
-	ITimer *pTimer;
-	TimerIter iter;
-
-	for (iter=m_SingleTimers.begin(); iter!=m_SingleTimers.end(); iter++)
+	for (int i = 0; i < TIMER_WHEEL_ROOT_SIZE; i++)
 	{
-		pTimer = (*iter);
-		if (pTimer->m_Flags & TIMER_FLAG_NO_MAPCHANGE)
-		{
-			s_tokill.push(pTimer);
-		}
+		CollectMapChangeTimers(m_Root[i], s_tokill);
 	}
 
-	for (iter=m_LoopTimers.begin(); iter!=m_LoopTimers.end(); iter++)
+	for (int level = 0; level < TIMER_WHEEL_LEVELS - 1; level++)
 	{
-		pTimer = (*iter);
-		if (pTimer->m_Flags & TIMER_FLAG_NO_MAPCHANGE)
+		for (int i = 0; i < TIMER_WHEEL_LEVEL_SIZE; i++)
 		{
-			s_tokill.push(pTimer);
+			CollectMapChangeTimers(m_Levels[level][i], s_tokill);
 		}
 	}
 
@@ -433,6 +768,41 @@ void TimerSystem::RemoveMapChangeTimers()
 	}
 }
 
+void TimerSystem::OnRootConsoleCommand(const char *cmdname, const ICommandArgs *command)
+{
+	UTIL_ConsolePrint("[SM] %u live timers, wheel at tick %lld (%.1f seconds).",
+		m_TimerCount,
+		(long long)m_CurTick,
+		GetSimulatedTime());
+	UTIL_ConsolePrint("  %-6s %-9s %-9s %-8s %-8s %s", "Level", "Span", "Buckets", "Used", "Timers", "Largest");
+
+	for (int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+	{
+		TimerBucket *buckets = (level == 0) ? m_Root : m_Levels[level - 1];
+		int size = (level == 0) ? TIMER_WHEEL_ROOT_SIZE : TIMER_WHEEL_LEVEL_SIZE;
+		int64_t span = (level == 0) ? 1 : ((int64_t)1 << LevelShift(level));
+
+		unsigned int used = 0, timers = 0, largest = 0;
+		for (int i = 0; i < size; i++)
+		{
+			unsigned int count = buckets[i].size();
+			if (count)
+			{
+				used++;
+				timers += count;
+				if (count > largest)
+				{
+					largest = count;
+				}
+			}
+		}
+
+		char spanbuf[16];
+		ke::SafeSprintf(spanbuf, sizeof(spanbuf), "%.1fs", span * TIMER_MIN_ACCURACY);
+		UTIL_ConsolePrint("  %-6d %-9s %-9d %-8u %-8u %u", level, spanbuf, size, used, timers, largest);
+	}
+}
+
 IMapTimer *TimerSystem::SetMapTimer(IMapTimer *pTimer)
 {
 	IMapTimer *old = m_pMapTimer;
@@ -32,7 +32,10 @@
 #ifndef _INCLUDE_SOURCEMOD_CTIMERSYS_H_
 #define _INCLUDE_SOURCEMOD_CTIMERSYS_H_
 
+#include <stdint.h>
+#include <string>
 #include <ITimerSystem.h>
+#include <IRootConsoleMenu.h>
 #include <sh_stack.h>
 #include <sh_list.h>
 #include "sourcemm_api.h"
@@ -41,13 +44,52 @@
 using namespace SourceHook;
 using namespace SourceMod;
 
-typedef List<ITimer *> TimerList;
-typedef List<ITimer *>::iterator TimerIter;
+/**
+ * Timers are kept in a hierarchical timing wheel.  Level 0 has one bucket 
+ * per timer tick (TIMER_MIN_ACCURACY seconds), each higher level covers 
+ * a full revolution of the level below it.  Buckets from a higher level are 
+ * cascaded downwards as the wheel turns, so a frame only ever touches the 
+ * timers that are due.
+ */
+#define TIMER_WHEEL_ROOT_BITS	8
+#define TIMER_WHEEL_ROOT_SIZE	(1 << TIMER_WHEEL_ROOT_BITS)
+#define TIMER_WHEEL_LEVEL_BITS	6
+#define TIMER_WHEEL_LEVEL_SIZE	(1 << TIMER_WHEEL_LEVEL_BITS)
+#define TIMER_WHEEL_LEVELS		4		/**< Including the root level */
+
+class TimerBucket
+{
+public:
+	TimerBucket() : m_pHead(NULL), m_pTail(NULL), m_Count(0)
+	{
+	}
+public:
+	void Append(ITimer *pTimer);
+	void Remove(ITimer *pTimer);
+	ITimer *PopFront();
+	void TakeFrom(TimerBucket &other);
+	bool empty() const
+	{
+		return m_pHead == NULL;
+	}
+	unsigned int size() const
+	{
+		return m_Count;
+	}
+	ITimer *front() const
+	{
+		return m_pHead;
+	}
+private:
+	ITimer *m_pHead;
+	ITimer *m_pTail;
+	unsigned int m_Count;
+};
 
 class SourceMod::ITimer
 {
 public:
-	void Initialize(ITimedEvent *pCallbacks, float fInterval, float fToExec, void *pData, int flags);
+	void Initialize(ITimedEvent *pCallbacks, float fInterval, double fToExec, void *pData, int flags);
 	ITimedEvent *m_Listener;
 	void *m_pData;
 	float m_Interval;
@@ -55,11 +97,17 @@ public:
 	int m_Flags;
 	bool m_InExec;
 	bool m_KillMe;
+	/* Wheel linkage, only valid while m_pBucket is non-NULL. */
+	int64_t m_ExpireTick;
+	TimerBucket *m_pBucket;
+	ITimer *m_pPrev;
+	ITimer *m_pNext;
 };
 
 class TimerSystem : 
 	public ITimerSystem,
-	public SMGlobalClass
+	public SMGlobalClass,
+	public IRootConsoleCommand
 {
 public:
 	TimerSystem();
@@ -69,6 +117,10 @@ public: //SMGlobalClass
 	void OnSourceModLevelEnd();
 	void OnSourceModGameInitialized();
 	void OnSourceModShutdown();
+	ConfigResult OnSourceModConfigChanged(const char *key, const char *value,
+		ConfigSource source, char *error, size_t maxlength);
+public: //IRootConsoleCommand
+	void OnRootConsoleCommand(const char *cmdname, const ICommandArgs *command) override;
 public: //ITimerSystem
 	ITimer *CreateTimer(ITimedEvent *pCallbacks, float fInterval, void *pData, int flags);
 	void KillTimer(ITimer *pTimer);
@@ -83,9 +135,28 @@ public:
 	void RunFrame();
 	void RemoveMapChangeTimers();
 	void GameFrame(bool simulating);
+	bool IsIdle() const
+	{
+		return m_bIdle;
+	}
+	unsigned int GetTimerCount() const
+	{
+		return m_TimerCount;
+	}
 private:
-	List<ITimer *> m_SingleTimers;
-	List<ITimer *> m_LoopTimers;
+	void CheckIdle();
+	void SetIdle(bool idle);
+	void Schedule(ITimer *pTimer);
+	void Unschedule(ITimer *pTimer);
+	void Release(ITimer *pTimer);
+	bool Cascade(int level);
+	void RunTimer(ITimer *pTimer);
+private:
+	TimerBucket m_Root[TIMER_WHEEL_ROOT_SIZE];
+	TimerBucket m_Levels[TIMER_WHEEL_LEVELS - 1][TIMER_WHEEL_LEVEL_SIZE];
+	TimerBucket m_Firing;		/** Bucket currently being dispatched */
+	int64_t m_CurTick;			/** Next wheel tick to be processed */
+	unsigned int m_TimerCount;
 	CStack<ITimer *> m_FreeTimers;
 	IMapTimer *m_pMapTimer;
 
@@ -96,8 +167,22 @@ private:
 									us while ticking.
 									*/
 
+	/* Idle ("hibernation") mode, entered once no human has been connected for 
+	 * m_fIdleDelay seconds.  Timers and frame hooks then only think every 
+	 * m_fIdleResolution seconds and the forwards named in m_IdleForwards are 
+	 * suspended.
+	 */
+	float m_fIdleResolution;	/** 0 disables idle mode */
+	float m_fIdleDelay;
+	std::string m_IdleForwards;
+	bool m_bIdle;
+	double m_fEmptySince;		/** Negative while humans are connected */
+	double m_fNextIdleCheck;
+	double m_fHooksThink;
+
 	IForward *m_pOnGameFrame;
 	IForward *m_pOnMapTimeLeftChanged;
+	IForward *m_pOnIdleModeChanged;
 };
 
 time_t GetAdjustedTime(time_t *buf = NULL);
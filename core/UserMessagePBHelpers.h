@@ -85,6 +85,19 @@
 		return false;                                         \
 	}
 
+// Validates a [start, start + count) slice of a repeated field once, so that
+// bulk accessors don't need a bounds check per element.
+#define CHECK_REPEATED_RANGE(start, count) \
+	int elemCount = msg->GetReflection()->FieldSize(*msg, field); \
+	if (start < 0 || count < 0 || start > elemCount)          \
+	{                                                         \
+		return false;                                         \
+	}                                                         \
+	if (count > elemCount - start)                            \
+	{                                                         \
+		count = elemCount - start;                            \
+	}
+
 typedef List<Handle_t> PBHandleList;
 
 class SMProtobufMessage
@@ -1183,6 +1196,161 @@ public:
 		return true;
 	}
 
+	// Copies up to *count values starting at start into out, and stores the
+	// number of values copied in *count.
+	inline bool GetRepeatedInt32Array(const char *pszFieldName, int start, int32 *out, int *count)
+	{
+		GETCHECK_FIELD();
+		CHECK_FIELD_TYPE3(INT32, UINT32, ENUM);
+		CHECK_FIELD_REPEATED();
+
+		int num = *count;
+		CHECK_REPEATED_RANGE(start, num);
+
+		const protobuf::Reflection *pReflection = msg->GetReflection();
+		for (int i = 0; i < num; i++)
+		{
+			if (fieldType == protobuf::FieldDescriptor::CPPTYPE_UINT32)
+				out[i] = (int32)pReflection->GetRepeatedUInt32(*msg, field, start + i);
+			else if (fieldType == protobuf::FieldDescriptor::CPPTYPE_INT32)
+				out[i] = pReflection->GetRepeatedInt32(*msg, field, start + i);
+			else // CPPTYPE_ENUM
+				out[i] = pReflection->GetRepeatedEnum(*msg, field, start + i)->number();
+		}
+
+		*count = num;
+		return true;
+	}
+
+	inline bool AddInt32Array(const char *pszFieldName, const int32 *values, int count)
+	{
+		GETCHECK_FIELD();
+		CHECK_FIELD_TYPE3(INT32, UINT32, ENUM);
+		CHECK_FIELD_REPEATED();
+
+		if (count < 0)
+			return false;
+
+		const protobuf::Reflection *pReflection = msg->GetReflection();
+		if (fieldType == protobuf::FieldDescriptor::CPPTYPE_ENUM)
+		{
+			// Validate every value up front so a bad one doesn't leave the field half-written.
+			for (int i = 0; i < count; i++)
+			{
+				if (!field->enum_type()->FindValueByNumber(values[i]))
+					return false;
+			}
+
+			for (int i = 0; i < count; i++)
+			{
+				pReflection->AddEnum(msg, field, field->enum_type()->FindValueByNumber(values[i]));
+			}
+		}
+		else if (fieldType == protobuf::FieldDescriptor::CPPTYPE_UINT32)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				pReflection->AddUInt32(msg, field, (uint32)values[i]);
+			}
+		}
+		else // CPPTYPE_INT32
+		{
+			for (int i = 0; i < count; i++)
+			{
+				pReflection->AddInt32(msg, field, values[i]);
+			}
+		}
+
+		return true;
+	}
+
+	inline bool GetRepeatedFloatArray(const char *pszFieldName, int start, float *out, int *count)
+	{
+		GETCHECK_FIELD();
+		CHECK_FIELD_TYPE2(FLOAT, DOUBLE);
+		CHECK_FIELD_REPEATED();
+
+		int num = *count;
+		CHECK_REPEATED_RANGE(start, num);
+
+		const protobuf::Reflection *pReflection = msg->GetReflection();
+		for (int i = 0; i < num; i++)
+		{
+			if (fieldType == protobuf::FieldDescriptor::CPPTYPE_DOUBLE)
+				out[i] = (float)pReflection->GetRepeatedDouble(*msg, field, start + i);
+			else
+				out[i] = pReflection->GetRepeatedFloat(*msg, field, start + i);
+		}
+
+		*count = num;
+		return true;
+	}
+
+	inline bool AddFloatArray(const char *pszFieldName, const float *values, int count)
+	{
+		GETCHECK_FIELD();
+		CHECK_FIELD_TYPE2(FLOAT, DOUBLE);
+		CHECK_FIELD_REPEATED();
+
+		if (count < 0)
+			return false;
+
+		const protobuf::Reflection *pReflection = msg->GetReflection();
+		for (int i = 0; i < count; i++)
+		{
+			if (fieldType == protobuf::FieldDescriptor::CPPTYPE_DOUBLE)
+				pReflection->AddDouble(msg, field, (double)values[i]);
+			else
+				pReflection->AddFloat(msg, field, values[i]);
+		}
+
+		return true;
+	}
+
+	// Vectors are packed as consecutive x, y, z triples in out/values.
+	inline bool GetRepeatedVectorArray(const char *pszFieldName, int start, float *out, int *count)
+	{
+		GETCHECK_FIELD();
+		CHECK_FIELD_TYPE(MESSAGE);
+		CHECK_FIELD_REPEATED();
+
+		int num = *count;
+		CHECK_REPEATED_RANGE(start, num);
+
+		const protobuf::Reflection *pReflection = msg->GetReflection();
+		for (int i = 0; i < num; i++)
+		{
+			const CMsgVector &msgVec = (const CMsgVector &)pReflection->GetRepeatedMessage(*msg, field, start + i);
+			out[i * 3 + 0] = msgVec.x();
+			out[i * 3 + 1] = msgVec.y();
+			out[i * 3 + 2] = msgVec.z();
+		}
+
+		*count = num;
+		return true;
+	}
+
+	inline bool AddVectorArray(const char *pszFieldName, const float *values, int count)
+	{
+		GETCHECK_FIELD();
+		CHECK_FIELD_TYPE(MESSAGE);
+		CHECK_FIELD_REPEATED();
+
+		if (count < 0)
+			return false;
+
+		const protobuf::Reflection *pReflection = msg->GetReflection();
+		for (int i = 0; i < count; i++)
+		{
+			CMsgVector *msgVec = (CMsgVector *)pReflection->AddMessage(msg, field);
+			msgVec->set_x(values[i * 3 + 0]);
+			msgVec->set_y(values[i * 3 + 1]);
+			msgVec->set_z(values[i * 3 + 2]);
+		}
+
+		return true;
+	}
+
 private:
 	protobuf::Message *msg;
 	PBHandleList childHandles;
@@ -32,6 +32,7 @@
 #include "UserMessages.h"
 #include "sm_stringutil.h"
 #include "logic_bridge.h"
+#include "sourcemod.h"
 
 #if SOURCE_ENGINE == SE_CSGO
 #include <cstrike15_usermessage_helpers.h>
@@ -60,9 +61,10 @@ UserMessages::UserMessages()
 	: m_InterceptBuffer(m_pBase, 2500)
 {
 #else
-	: m_InterceptBuffer(NULL)
+	: m_InterceptBuffer(NULL), m_InterceptId(INVALID_MESSAGE_ID)
 {
 #endif
+	memset(m_SentCount, 0, sizeof(m_SentCount));
 	m_HookCount = 0;
 	m_InExec = false;
 	m_InHook = false;
@@ -78,6 +80,17 @@ UserMessages::~UserMessages()
 		delete (*iter);
 	}
 	m_FreeListeners.popall();
+
+#ifdef USE_PROTOBUF_USERMESSAGES
+	for (size_t i = 0; i < 255; i++)
+	{
+		while (!m_MessagePool[i].empty())
+		{
+			delete m_MessagePool[i].front();
+			m_MessagePool[i].pop();
+		}
+	}
+#endif
 }
 
 void UserMessages::OnSourceModStartup(bool late)
@@ -91,10 +104,13 @@ void UserMessages::OnSourceModStartup(bool late)
 void UserMessages::OnSourceModAllInitialized()
 {
 	sharesys->AddInterface(NULL, this);
+	rootmenu->AddRootConsoleCommand3("usermsgs", "Show user messages sent by plugins", this);
 }
 
 void UserMessages::OnSourceModAllShutdown()
 {
+	rootmenu->RemoveRootConsoleCommand("usermsgs", this);
+
 	if (m_HookCount)
 	{
 #if SOURCE_ENGINE == SE_CSGO || SOURCE_ENGINE == SE_BLADE || SOURCE_ENGINE == SE_MCV
@@ -110,6 +126,31 @@ void UserMessages::OnSourceModAllShutdown()
 	m_HookCount = 0;
 }
 
+void UserMessages::OnRootConsoleCommand(const char *cmdname, const ICommandArgs *command)
+{
+	char name[64];
+	unsigned int total = 0;
+
+	UTIL_ConsolePrint("[SM] User messages sent by plugins:");
+	UTIL_ConsolePrint("  %-4s %-32.31s %s", "[Id]", "[Name]", "[Sent]");
+	for (int i = 0; i < 255; i++)
+	{
+		if (!m_SentCount[i])
+		{
+			continue;
+		}
+
+		if (!GetMessageName(i, name, sizeof(name)))
+		{
+			ke::SafeStrcpy(name, sizeof(name), "<unknown>");
+		}
+
+		UTIL_ConsolePrint("  %-4d %-32.31s %u", i, name, m_SentCount[i]);
+		total += m_SentCount[i];
+	}
+	UTIL_ConsolePrint("[SM] %u message(s) in total.", total);
+}
+
 int UserMessages::GetMessageIndex(const char *msg)
 {
 #if SOURCE_ENGINE == SE_CSGO
@@ -268,7 +309,7 @@ google::protobuf::Message *UserMessages::StartProtobufMessage(int msg_id, const
 	if (m_CurFlags & USERMSG_BLOCKHOOKS)
 	{
 		// direct message creation, return buffer "from engine". keep track
-		m_FakeEngineBuffer = GetMessagePrototype(msg_id)->New();
+		m_FakeEngineBuffer = AcquireMessage(msg_id);
 		buffer = m_FakeEngineBuffer;
 	} else {
 		char messageName[32];
@@ -283,12 +324,12 @@ google::protobuf::Message *UserMessages::StartProtobufMessage(int msg_id, const
 		{
 		case MRES_IGNORED:
 		case MRES_HANDLED:
-			m_FakeEngineBuffer = GetMessagePrototype(msg_id)->New();
+			m_FakeEngineBuffer = AcquireMessage(msg_id);
 			buffer = m_FakeEngineBuffer;
 			break;		
 
 		case MRES_OVERRIDE:
-			m_FakeEngineBuffer = GetMessagePrototype(msg_id)->New();
+			m_FakeEngineBuffer = AcquireMessage(msg_id);
 		// fallthrough
 		case MRES_SUPERCEDE:
 			buffer = msg;
@@ -309,11 +350,16 @@ bool UserMessages::EndMessage()
 		return false;
 	}
 
+	if (m_CurId >= 0 && m_CurId < 255)
+	{
+		m_SentCount[m_CurId]++;
+	}
+
 #if SOURCE_ENGINE == SE_CSGO || SOURCE_ENGINE == SE_BLADE || SOURCE_ENGINE == SE_MCV
 	if (m_CurFlags & USERMSG_BLOCKHOOKS)
 	{
 		ENGINE_CALL(SendUserMessage)(static_cast<IRecipientFilter &>(m_CellRecFilter), m_CurId, *m_FakeEngineBuffer);
-		delete m_FakeEngineBuffer;
+		ReleaseMessage(m_CurId, m_FakeEngineBuffer);
 		m_FakeEngineBuffer = NULL;
 	} else {
 		OnMessageEnd_Pre();
@@ -324,7 +370,7 @@ bool UserMessages::EndMessage()
 		case MRES_HANDLED:
 		case MRES_OVERRIDE:
 			engine->SendUserMessage(static_cast<IRecipientFilter &>(m_CellRecFilter), m_CurId, *m_FakeEngineBuffer);
-			delete m_FakeEngineBuffer;
+			ReleaseMessage(m_CurId, m_FakeEngineBuffer);
 			m_FakeEngineBuffer = NULL;
 			break;
 		//case MRES_SUPERCEDE:
@@ -456,6 +502,32 @@ const protobuf::Message *UserMessages::GetMessagePrototype(int msg_type)
 	return g_VietnamUsermessageHelpers.GetPrototype(msg_type);
 #endif
 }
+
+protobuf::Message *UserMessages::AcquireMessage(int msg_type)
+{
+	CStack<protobuf::Message *> &pool = m_MessagePool[msg_type];
+	if (pool.empty())
+	{
+		return GetMessagePrototype(msg_type)->New();
+	}
+
+	protobuf::Message *msg = pool.front();
+	pool.pop();
+	return msg;
+}
+
+void UserMessages::ReleaseMessage(int msg_type, protobuf::Message *msg)
+{
+	CStack<protobuf::Message *> &pool = m_MessagePool[msg_type];
+	if (pool.size() >= USERMSG_POOL_SIZE)
+	{
+		delete msg;
+		return;
+	}
+
+	msg->Clear();
+	pool.push(msg);
+}
 #endif
 
 #ifdef USE_PROTOBUF_USERMESSAGES
@@ -599,8 +671,9 @@ bf_write *UserMessages::OnStartMessage_Pre(IRecipientFilter *filter, int msg_typ
 	{
 #ifdef USE_PROTOBUF_USERMESSAGES
 		if (m_InterceptBuffer)
-			delete m_InterceptBuffer;
-		m_InterceptBuffer = GetMessagePrototype(msg_type)->New();
+			ReleaseMessage(m_InterceptId, m_InterceptBuffer);
+		m_InterceptBuffer = AcquireMessage(msg_type);
+		m_InterceptId = msg_type;
 
 		UM_RETURN_META_VALUE(MRES_SUPERCEDE, m_InterceptBuffer);
 #else
@@ -798,7 +871,7 @@ void UserMessages::OnMessageEnd_Pre()
 		uint8 *data = (uint8 *)stackalloc(size);
 		m_OrigBuffer->SerializePartialToArray(data, size);
 
-		protobuf::Message *pTempMsg = GetMessagePrototype(m_CurId)->New();
+		protobuf::Message *pTempMsg = AcquireMessage(m_CurId);
 		pTempMsg->ParsePartialFromArray(data, size);
 #else
 		bf_write *pTempMsg = m_OrigBuffer;
@@ -824,7 +897,7 @@ void UserMessages::OnMessageEnd_Pre()
 		}
 
 #if SOURCE_ENGINE == SE_CSGO || SOURCE_ENGINE == SE_BLADE || SOURCE_ENGINE == SE_MCV
-		delete pTempMsg;
+		ReleaseMessage(m_CurId, pTempMsg);
 #endif
 	}
 
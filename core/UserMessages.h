@@ -40,6 +40,7 @@
 #include "sm_globals.h"
 #include <sh_list.h>
 #include <sh_stack.h>
+#include <IRootConsoleMenu.h>
 
 using namespace SourceHook;
 using namespace SourceMod;
@@ -60,6 +61,9 @@ using namespace google;
 
 #define INVALID_MESSAGE_ID -1
 
+/* Cleared messages kept around per message type, so busy message types don't allocate */
+#define USERMSG_POOL_SIZE	4
+
 struct ListenerInfo
 {
 #ifdef USE_PROTOBUF_USERMESSAGES
@@ -77,7 +81,8 @@ typedef List<ListenerInfo *>::iterator MsgIter;
 
 class UserMessages : 
 	public IUserMessages,
-	public SMGlobalClass
+	public SMGlobalClass,
+	public IRootConsoleCommand
 {
 public:
 	UserMessages();
@@ -86,6 +91,8 @@ public: //SMGlobalClass
 	void OnSourceModStartup(bool late);
 	void OnSourceModAllInitialized();
 	void OnSourceModAllShutdown();
+public: //IRootConsoleCommand
+	void OnRootConsoleCommand(const char *cmdname, const ICommandArgs *command) override;
 public: //IUserMessages
 	int GetMessageIndex(const char *msg);
 	bool GetMessageName(int msgid, char *buffer, size_t maxlength) const;
@@ -122,6 +129,8 @@ public:
 private:
 #ifdef USE_PROTOBUF_USERMESSAGES
 	const protobuf::Message *GetMessagePrototype(int msg_type);
+	protobuf::Message *AcquireMessage(int msg_type);
+	void ReleaseMessage(int msg_type, protobuf::Message *msg);
 	bool InternalHook(int msg_id, IProtobufUserMessageListener *pListener, bool intercept, bool isNew);
 	bool InternalUnhook(int msg_id, IProtobufUserMessageListener *pListener, bool intercept, bool isNew);
 #else
@@ -146,7 +155,11 @@ private:
 	META_RES m_FakeMetaRes;
 
 	protobuf::Message *m_InterceptBuffer;
+	int m_InterceptId;
+
+	CStack<protobuf::Message *> m_MessagePool[255];
 #endif
+	unsigned int m_SentCount[255];
 	size_t m_HookCount;
 	bool m_InHook;
 	bool m_BlockEndPost;
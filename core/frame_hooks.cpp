@@ -36,12 +36,19 @@
 #include "PlayerManager.h"
 #include "CoreConfig.h"
 #include <sm_queue.h>
+#include <sm_mpsc_queue.h>
 #include <IThreader.h>
+#include <am-string.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
 #include "sourcemod.h"
 
 static IMutex *frame_mutex;
 static Queue<FrameAction> *frame_queue;
 static Queue<FrameAction> *frame_actions;
+static MpscQueue<FrameAction> post_queue;
+static unsigned int post_budget_us = 2000;
 static float g_LastMenuTime = 0.0f;
 static float g_LastAuthCheck = 0.0f;
 bool g_PendingInternalPush = false;
@@ -62,6 +69,23 @@ public:
 		delete frame_actions;
 		frame_mutex->DestroyThis();
 	}
+
+	ConfigResult OnSourceModConfigChanged(const char *key, const char *value,
+		ConfigSource source, char *error, size_t maxlength)
+	{
+		if (strcmp(key, "GameThreadPostBudget") != 0)
+			return ConfigResult_Ignore;
+
+		char *end;
+		unsigned long budget = strtoul(value, &end, 10);
+		if (!value[0] || *end != '\0')
+		{
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be a number of microseconds");
+			return ConfigResult_Reject;
+		}
+		post_budget_us = (unsigned int)budget;
+		return ConfigResult_Accept;
+	}
 } s_FrameActionInit;
 
 void AddFrameAction(const FrameAction & action)
@@ -71,6 +95,26 @@ void AddFrameAction(const FrameAction & action)
 	frame_mutex->Unlock();
 }
 
+void PostFrameAction(const FrameAction & action)
+{
+	post_queue.push(action);
+}
+
+static void RunPostedActions()
+{
+	using namespace std::chrono;
+
+	/* Always run at least one action so a slow one cannot stall the queue. */
+	steady_clock::time_point deadline = steady_clock::now() + microseconds(post_budget_us);
+	FrameAction item(NULL, NULL);
+	while (post_queue.pop(&item))
+	{
+		item.action(item.data);
+		if (post_budget_us && steady_clock::now() >= deadline)
+			break;
+	}
+}
+
 void RunFrameHooks(bool simulating)
 {
 	/* It's okay if this check races. */
@@ -94,6 +138,11 @@ void RunFrameHooks(bool simulating)
 		}
 	}
 
+	if (!post_queue.empty())
+	{
+		RunPostedActions();
+	}
+
 	/* Frame based hooks */
 	g_HL2.ProcessFakeCliCmdQueue();
 	g_HL2.ProcessDelayedKicks();
@@ -114,6 +163,8 @@ void RunFrameHooks(bool simulating)
 		g_LastMenuTime = curtime;
 	}
 
+	g_RadioMenuStyle.ProcessPendingDisplays();
+
 	if (*g_NumPlayersToAuth && curtime - g_LastAuthCheck >= 0.7f)
 	{
 		g_Players.RunAuthChecks();
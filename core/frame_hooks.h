@@ -48,6 +48,7 @@ struct FrameAction
 extern bool g_PendingInternalPush;
 
 void AddFrameAction(const FrameAction & action);
+void PostFrameAction(const FrameAction & action);
 void RunFrameHooks(bool simulating);
 
 #endif //_INCLUDE_SOURCEMOD_FRAME_HOOKS_H_
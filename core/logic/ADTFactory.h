@@ -34,7 +34,7 @@
 
 #include <IADTFactory.h>
 #include "common_logic.h"
-#include <sm_hashmap.h>
+#include <sm_flatmap.h>
 
 using namespace SourceMod;
 
@@ -50,7 +50,7 @@ public:
 	virtual void Clear();
 	virtual void Destroy();
 private:
-	StringHashMap<void *> map_;
+	StringFlatMap<void *> map_;
 };
 
 class ADTFactory : 
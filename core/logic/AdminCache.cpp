@@ -218,10 +218,14 @@ private:
 AdminCache::AdminCache()
 {
 	m_pStrings = new BaseStringTable(1024);
-	m_pMemory = m_pStrings->GetMemTable();
+	m_pMemory = new BaseMemTable(1024);
+	m_StringGeneration = 0;
+	m_LiveStringBytes = 0;
 	m_FreeGroupList = m_FirstGroup = m_LastGroup = INVALID_GROUP_ID;
 	m_FreeUserList = m_FirstUser = m_LastUser = INVALID_ADMIN_ID;
 	m_pCacheFwd = NULL;
+	m_pIdentityFwd = NULL;
+	m_GroupOverrideSerial = 0;
 	m_FirstGroup = -1;
 	m_InvalidatingAdmins = false;
 	m_destroying = false;
@@ -241,6 +245,7 @@ AdminCache::~AdminCache()
 		delete *iter;
 	}
 
+	delete m_pMemory;
 	delete m_pStrings;
 }
 
@@ -291,6 +296,7 @@ void AdminCache::OnSourceModStartup(bool late)
 void AdminCache::OnSourceModAllInitialized()
 {
 	m_pCacheFwd = forwardsys->CreateForward("OnRebuildAdminCache", ET_Ignore, 1, NULL, Param_Cell);
+	m_pIdentityFwd = forwardsys->CreateForward("OnRebuildAdminIdentity", ET_Ignore, 2, NULL, Param_String, Param_String);
 	sharesys->AddInterface(NULL, this);
 }
 
@@ -317,6 +323,8 @@ void AdminCache::OnSourceModShutdown()
 {
 	forwardsys->ReleaseForward(m_pCacheFwd);
 	m_pCacheFwd = NULL;
+	forwardsys->ReleaseForward(m_pIdentityFwd);
+	m_pIdentityFwd = NULL;
 }
 
 void AdminCache::OnSourceModPluginsLoaded()
@@ -439,7 +447,7 @@ AdminId AdminCache::CreateAdmin(const char *name)
 
 	if (name && name[0] != '\0')
 	{
-		int nameidx = m_pStrings->AddString(name);
+		int nameidx = InternString(name);
 		pUser = (AdminUser *)m_pMemory->GetAddress(id);
 		pUser->nameidx = nameidx;
 	}
@@ -489,7 +497,7 @@ GroupId AdminCache::AddGroup(const char *group_name)
 		m_LastGroup = id;
 	}
 
-	int nameidx = m_pStrings->AddString(group_name);
+	int nameidx = InternString(group_name);
 	pGroup = (AdminGroup *)m_pMemory->GetAddress(id);
 	pGroup->nameidx = nameidx;
 
@@ -524,6 +532,7 @@ void AdminCache::SetGroupAddFlag(GroupId id, AdminFlag flag, bool enabled)
 	}
 
 	FlagBits bits = (1<<(FlagBits)flag);
+	FlagBits old_flags = pGroup->addflags;
 
 	if (enabled)
 	{
@@ -531,6 +540,11 @@ void AdminCache::SetGroupAddFlag(GroupId id, AdminFlag flag, bool enabled)
 	} else {
 		pGroup->addflags &= ~bits;
 	}
+
+	if (pGroup->addflags != old_flags)
+	{
+		RefreshGroupMembers(id);
+	}
 }
 
 bool AdminCache::GetGroupAddFlag(GroupId id, AdminFlag flag)
@@ -730,6 +744,7 @@ void AdminCache::AddGroupCommandOverride(GroupId id, const char *name, OverrideT
 	}
 
 	map->insert(name, rule);
+	m_GroupOverrideSerial++;
 }
 
 bool AdminCache::GetGroupCommandOverride(GroupId id, const char *name, OverrideType type, OverrideRule *pRule)
@@ -807,12 +822,21 @@ bool AdminCache::InvalidateAdmin(AdminId id)
 		pOther->prev_user = pUser->prev_user;
 	}
 
+	/* Ids are recycled, so the memo has to go with the admin */
+	m_OverrideCache.erase(id);
+
 	/* Unlink from auth tables */
 	if (pUser->auth.identidx != -1)
 	{
 		AuthMethod *method = GetMethodByIndex(pUser->auth.index);
 		if (method)
-			method->identities.remove(m_pStrings->GetString(pUser->auth.identidx));
+		{
+			const char *ident = m_pStrings->GetString(pUser->auth.identidx);
+			uint32_t accountId;
+			if (method->name.compare("steam") == 0 && GetUnifiedSteamAccount(ident, &accountId))
+				m_SteamAccounts.erase(accountId);
+			method->identities.remove(ident);
+		}
 	}
 
 	/* Clear table counts */
@@ -868,6 +892,7 @@ void AdminCache::InvalidateGroup(GroupId id)
 	pGroup->pCmdGrpTable = NULL;
 	delete pGroup->pCmdTable;
 	pGroup->pCmdTable = NULL;
+	m_GroupOverrideSerial++;
 
 	/* Link into the free list */
 	pGroup->magic = GRP_MAGIC_UNSET;
@@ -913,6 +938,49 @@ void AdminCache::InvalidateGroup(GroupId id)
 	}
 }
 
+void AdminCache::RefreshGroupMembers(GroupId id)
+{
+	AdminGroup *pGroup = (AdminGroup *)m_pMemory->GetAddress(id);
+	AdminGroup *pOther;
+
+	/* Members computed their effective permissions when they inherited the 
+	 * group, so a live change has to be pushed to them.  Admin immunity is 
+	 * stored already merged, so it can only be raised here.
+	 */
+	int idx = m_FirstUser;
+	AdminUser *pUser;
+	int *table;
+	while (idx != INVALID_ADMIN_ID)
+	{
+		pUser = (AdminUser *)m_pMemory->GetAddress(idx);
+		if (pUser->grp_count > 0)
+		{
+			table = (int *)m_pMemory->GetAddress(pUser->grp_table);
+			for (unsigned int i=0; i<pUser->grp_count; i++)
+			{
+				if (table[i] != id)
+				{
+					continue;
+				}
+
+				pUser->eflags = pUser->flags;
+				for (unsigned int j=0; j<pUser->grp_count; j++)
+				{
+					pOther = (AdminGroup *)m_pMemory->GetAddress(table[j]);
+					pUser->eflags |= pOther->addflags;
+				}
+				if (pGroup->immunity_level > pUser->immunity_level)
+				{
+					pUser->immunity_level = pGroup->immunity_level;
+				}
+				pUser->serialchange++;
+				break;
+			}
+		}
+		idx = pUser->next_user;
+	}
+}
+
 void AdminCache::InvalidateGroupCache()
 {
 	/* Nuke the free list */
@@ -940,6 +1008,48 @@ void AdminCache::InvalidateGroupCache()
 
 	/* Reset the memory table */
 	m_pMemory->Reset();
+
+	TrimStringPool();
+}
+
+int AdminCache::InternString(const char *str)
+{
+	StringHashMap<InternedName>::Insert i = m_InternedNames.findForAdd(str);
+	if (i.found())
+	{
+		if (i->value.generation != m_StringGeneration)
+		{
+			i->value.generation = m_StringGeneration;
+			m_LiveStringBytes += strlen(str) + 1;
+		}
+		return i->value.index;
+	}
+
+	InternedName name;
+	name.index = m_pStrings->AddString(str);
+	name.generation = m_StringGeneration;
+	m_LiveStringBytes += strlen(str) + 1;
+
+	m_InternedNames.add(i, str);
+	i->value = name;
+	return name.index;
+}
+
+void AdminCache::TrimStringPool()
+{
+	/* Every user and group is gone at this point, so nothing refers to the
+	 * pool. Keep it for the rebuild unless most of it went unused during
+	 * the last cache lifetime, e.g. after a large admin list was replaced.
+	 */
+	unsigned int used = m_pStrings->GetMemTable()->GetActualMemUsed();
+	if (m_destroying || (used > 65536 && used > m_LiveStringBytes * 2))
+	{
+		m_pStrings->Reset();
+		m_InternedNames.clear();
+	}
+
+	m_StringGeneration++;
+	m_LiveStringBytes = 0;
 }
 
 void AdminCache::AddAdminListener(IAdminListener *pListener)
@@ -981,6 +1091,8 @@ void AdminCache::InvalidateAdminCache(bool unlink_admins)
 	{
 		(*iter)->identities.clear();
 	}
+	m_SteamAccounts.clear();
+	m_OverrideCache.clear();
 	
 	if (unlink_admins)
 	{
@@ -1045,6 +1157,40 @@ void AdminCache::DumpAdminCache(AdminCachePart part, bool rebuild)
 	}
 }
 
+void AdminCache::ReloadAdminIdentity(const char *auth, const char *ident)
+{
+	/* Drops just this admin (and any client using it), then asks the sources
+	 * to load it again.  Groups, overrides and every other admin stay intact.
+	 */
+	AdminId id = FindAdminByIdentity(auth, ident);
+	if (id != INVALID_ADMIN_ID)
+	{
+		InvalidateAdmin(id);
+	}
+
+	if (m_destroying)
+	{
+		return;
+	}
+
+	List<IAdminListener *>::iterator iter;
+	for (iter=m_hooks.begin(); iter!=m_hooks.end(); iter++)
+	{
+		IAdminListener *pListener = (*iter);
+		if (pListener->GetInterfaceVersion() < 9)
+		{
+			continue;
+		}
+		pListener->OnRebuildAdminIdentity(auth, ident);
+	}
+	m_pIdentityFwd->PushString(auth);
+	m_pIdentityFwd->PushString(ident);
+	m_pIdentityFwd->Execute();
+
+	/* Only clients without an admin are looked up again. */
+	playerhelpers->RecheckAnyAdmins();
+}
+
 const char *AdminCache::GetAdminName(AdminId id)
 {
 	AdminUser *pUser = (AdminUser *)m_pMemory->GetAddress(id);
@@ -1133,6 +1279,21 @@ bool AdminCache::GetUnifiedSteamIdentity(const char *ident, char *out, size_t ma
 	return false;
 }
 
+bool AdminCache::GetUnifiedSteamAccount(const char *ident, uint32_t *accountId)
+{
+	/* Unified identities are "Y:Z", where the account id is Z*2+Y */
+	if ((ident[0] != '0' && ident[0] != '1') || ident[1] != ':')
+		return false;
+
+	char *end;
+	unsigned long z = strtoul(&ident[2], &end, 10);
+	if (end == &ident[2] || *end != '\0')
+		return false;
+
+	*accountId = (uint32_t)(z << 1) | (uint32_t)(ident[0] - '0');
+	return true;
+}
+
 bool AdminCache::BindAdminIdentity(AdminId id, const char *auth, const char *ident)
 {
 	if (ident[0] == '\0')
@@ -1152,26 +1313,41 @@ bool AdminCache::BindAdminIdentity(AdminId id, const char *auth, const char *ide
 
 	/* If the auth type is steam, the id could be in a number of formats. Unify it. */
 	char steamIdent[16];
+	bool is_steam = false;
 	if (strcmp(auth, "steam") == 0)
 	{
 		if (!GetUnifiedSteamIdentity(ident, steamIdent, sizeof(steamIdent)))
 			return false;
 		
 		ident = steamIdent;
+		is_steam = true;
 	}
 
 	if (method->identities.contains(ident))
 		return false;
 
-	int i_ident = m_pStrings->AddString(ident);
+	int i_ident = InternString(ident);
 
 	pUser = (AdminUser *)m_pMemory->GetAddress(id);
 	pUser->auth.identidx = i_ident;
 	GetMethodIndex(auth, &pUser->auth.index);
 
+	/* Steam admins are also indexed by account id, for connection checks */
+	uint32_t accountId;
+	if (is_steam && GetUnifiedSteamAccount(ident, &accountId))
+		m_SteamAccounts[accountId] = id;
+
 	return method->identities.insert(ident, id);
 }
 
+AdminId AdminCache::FindAdminBySteamAccount(unsigned int accountId)
+{
+	std::unordered_map<uint32_t, AdminId>::const_iterator iter = m_SteamAccounts.find(accountId);
+	if (iter == m_SteamAccounts.end())
+		return INVALID_ADMIN_ID;
+	return iter->second;
+}
+
 AdminId AdminCache::FindAdminByIdentity(const char *auth, const char *identity)
 {
 	AuthMethod *method;
@@ -1425,7 +1601,7 @@ void AdminCache::SetAdminPassword(AdminId id, const char *password)
 		return;
 	}
 
-	int i_password = m_pStrings->AddString(password);
+	int i_password = InternString(password);
 	pUser = (AdminUser *)m_pMemory->GetAddress(id);
 	pUser->password = i_password;
 }
@@ -1694,6 +1870,11 @@ unsigned int AdminCache::SetGroupImmunityLevel(GroupId gid, unsigned int level)
 
 	pGroup->immunity_level = level;
 
+	if (level > old_level)
+	{
+		RefreshGroupMembers(gid);
+	}
+
 	return old_level;
 }
 
@@ -2038,34 +2219,15 @@ bool AdminCache::CheckAdminCommandAccess(AdminId adm, const char *cmd, FlagBits
 			return true;
 		}
 
-		/* Check for overrides
-		* :TODO: is it worth optimizing this?
-		*/
-		unsigned int groups = GetAdminGroupCount(adm);
-		GroupId gid;
-		OverrideRule rule;
-		bool override = false;
-		for (unsigned int i = 0; i<groups; i++)
+		/* Check for overrides */
+		int rule = GetCachedCommandRule(adm, cmd);
+		if (rule == Command_Allow)
 		{
-			gid = GetAdminGroup(adm, i, NULL);
-			/* First get group-level override */
-			override = GetGroupCommandOverride(gid, cmd, Override_CommandGroup, &rule);
-			/* Now get the specific command override */
-			if (GetGroupCommandOverride(gid, cmd, Override_Command, &rule))
-			{
-				override = true;
-			}
-			if (override)
-			{
-				if (rule == Command_Allow)
-				{
-					return true;
-				}
-				else if (rule == Command_Deny)
-				{
-					return false;
-				}
-			}
+			return true;
+		}
+		else if (rule == Command_Deny)
+		{
+			return false;
 		}
 
 		/* See if our other flags match */
@@ -2077,3 +2239,55 @@ bool AdminCache::CheckAdminCommandAccess(AdminId adm, const char *cmd, FlagBits
 
 	return false;
 }
+
+int AdminCache::GetCachedCommandRule(AdminId adm, const char *cmd)
+{
+	AdminUser *pUser = GetUser(adm);
+	if (!pUser)
+	{
+		return -1;
+	}
+
+	/* Inheriting or losing a group bumps the admin's serial; editing any
+	 * group's overrides bumps the global one.  Either way, start over.
+	 */
+	AdminOverrideCache &cache = m_OverrideCache[adm];
+	if (cache.serial != pUser->serialchange || cache.grp_serial != m_GroupOverrideSerial)
+	{
+		cache.rules.clear();
+		cache.serial = pUser->serialchange;
+		cache.grp_serial = m_GroupOverrideSerial;
+	}
+
+	int result;
+	if (cache.rules.retrieve(cmd, &result))
+	{
+		return result;
+	}
+
+	result = -1;
+	unsigned int groups = pUser->grp_count;
+	GroupId gid;
+	OverrideRule rule;
+	bool override = false;
+	for (unsigned int i = 0; i<groups; i++)
+	{
+		gid = GetAdminGroup(adm, i, NULL);
+		/* First get group-level override */
+		override = GetGroupCommandOverride(gid, cmd, Override_CommandGroup, &rule);
+		/* Now get the specific command override */
+		if (GetGroupCommandOverride(gid, cmd, Override_Command, &rule))
+		{
+			override = true;
+		}
+		if (override && (rule == Command_Allow || rule == Command_Deny))
+		{
+			result = rule;
+			break;
+		}
+	}
+
+	cache.rules.insert(cmd, result);
+
+	return result;
+}
@@ -35,12 +35,12 @@
 #include "common_logic.h"
 #include <IAdminSystem.h>
 #include "sm_memtable.h"
-#include <sm_trie.h>
 #include <sh_list.h>
 #include <sh_string.h>
 #include <IForwardSys.h>
 #include <sm_hashmap.h>
 #include <sm_namehashset.h>
+#include <unordered_map>
 
 using namespace SourceHook;
 
@@ -111,6 +111,19 @@ struct AdminUser
 	unsigned int serialchange;		/* Serial # for changes */
 };
 
+/* Per-admin memo of group command override lookups.  Entries are -1 when no
+ * group overrides the name, otherwise the OverrideRule that applies.
+ */
+struct AdminOverrideCache
+{
+	AdminOverrideCache() : serial(0), grp_serial(0)
+	{
+	}
+	unsigned int serial;			/* AdminUser::serialchange it was built for */
+	unsigned int grp_serial;		/* AdminCache::m_GroupOverrideSerial it was built for */
+	StringHashMap<int> rules;
+};
+
 class AdminCache : 
 	public IAdminSystem,
 	public SMGlobalClass
@@ -124,6 +137,10 @@ public: //SMGlobalClass
 	void OnSourceModLevelChange(const char *mapName);
 	void OnSourceModShutdown();
 	void OnSourceModPluginsLoaded();
+	const char *GetGlobalClassName()
+	{
+		return "AdminCache";
+	}
 public: //IAdminSystem
 	/** Command cache stuff */
 	void AddCommandOverride(const char *cmd, OverrideType type, FlagBits flags);
@@ -186,6 +203,8 @@ public: //IAdminSystem
 	bool FindFlagChar(AdminFlag flag, char *c);
 	bool IsValidAdmin(AdminId id);
 	bool CheckClientCommandAccess(int client, const char *cmd, FlagBits cmdflags);
+	void ReloadAdminIdentity(const char *auth, const char *ident);
+	AdminId FindAdminBySteamAccount(unsigned int accountId);
 public:
 	bool DumpCache(const char *filename);
 	AdminGroup *GetGroup(GroupId gid);
@@ -196,6 +215,10 @@ private:
 	void _UnsetCommandOverride(const char *cmd);
 	void _UnsetCommandGroupOverride(const char *group);
 	void InvalidateGroupCache();
+	int InternString(const char *str);
+	void TrimStringPool();
+	void RefreshGroupMembers(GroupId id);
+	int GetCachedCommandRule(AdminId adm, const char *cmd);
 	void InvalidateAdminCache(bool unlink_admins);
 	void DumpCommandOverrideCache(OverrideType type);
 	AuthMethod *GetMethodByIndex(unsigned int index);
@@ -203,11 +226,23 @@ private:
 	const char *GetMethodName(unsigned int index);
 	void NameFlag(const char *str, AdminFlag flag);
 	bool GetUnifiedSteamIdentity(const char *ident, char *out, size_t maxlen);
+	bool GetUnifiedSteamAccount(const char *ident, uint32_t *accountId);
 public:
 	typedef StringHashMap<FlagBits> FlagMap;
 
+	struct InternedName
+	{
+		int index;
+		unsigned int generation;
+	};
+
+	/* Names, identities and passwords live in their own arena, which is not
+	 * reset with m_pMemory, so unchanged strings are reused on rebuilds. */
 	BaseStringTable *m_pStrings;
 	BaseMemTable *m_pMemory;
+	StringHashMap<InternedName> m_InternedNames;
+	unsigned int m_StringGeneration;
+	unsigned int m_LiveStringBytes;
 	FlagMap m_CmdOverrides;
 	FlagMap m_CmdGrpOverrides;
 	int m_FirstGroup;
@@ -218,12 +253,16 @@ public:
 	List<AuthMethod *> m_AuthMethods;
 	NameHashSet<AuthMethod *> m_AuthTables;
 	IForward *m_pCacheFwd;
+	IForward *m_pIdentityFwd;
 	int m_FirstUser;
 	int m_LastUser;
 	int m_FreeUserList;
 	bool m_InvalidatingAdmins;
 	bool m_destroying;
 	StringHashMap<AdminFlag> m_LevelNames;
+	std::unordered_map<AdminId, AdminOverrideCache> m_OverrideCache;
+	std::unordered_map<uint32_t, AdminId> m_SteamAccounts;
+	unsigned int m_GroupOverrideSerial;
 };
 
 extern AdminCache g_Admins;
@@ -0,0 +1,136 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include <stdio.h>
+#include "BlobStore.h"
+#include "sm_crc32.h"
+#include <ISourceMod.h>
+
+BlobStore g_BlobStore;
+
+std::vector<uint8_t> &BlobWriter::Finish()
+{
+	BlobHeader header;
+	header.magic = BLOB_MAGIC;
+	header.version = BLOB_VERSION;
+	header.kind = (uint16_t)kind_;
+	header.size = (uint32_t)(buffer_.size() - sizeof(BlobHeader));
+	header.crc = UTIL_CRC32C(&buffer_[sizeof(BlobHeader)], header.size);
+	memcpy(&buffer_[0], &header, sizeof(header));
+	return buffer_;
+}
+
+bool BlobReader::Open(const std::vector<uint8_t> &blob, BlobKind kind)
+{
+	BlobHeader header;
+	if (blob.size() < sizeof(header))
+		return false;
+
+	memcpy(&header, &blob[0], sizeof(header));
+	if (header.magic != BLOB_MAGIC
+		|| header.version != BLOB_VERSION
+		|| header.kind != (uint16_t)kind
+		|| header.size != blob.size() - sizeof(header))
+	{
+		return false;
+	}
+
+	pos_ = blob.data() + sizeof(header);
+	end_ = pos_ + header.size;
+	return UTIL_CRC32C(pos_, header.size) == header.crc;
+}
+
+void BlobStore::OnSourceModShutdown()
+{
+	stash_.clear();
+}
+
+bool BlobStore::SaveFile(const char *path, const std::vector<uint8_t> &blob)
+{
+	char realpath[PLATFORM_MAX_PATH];
+	g_pSM->BuildPath(Path_Game, realpath, sizeof(realpath), "%s", path);
+
+	FILE *fp = fopen(realpath, "wb");
+	if (!fp)
+		return false;
+
+	bool ok = fwrite(blob.data(), 1, blob.size(), fp) == blob.size();
+	if (fclose(fp) != 0)
+		ok = false;
+	return ok;
+}
+
+bool BlobStore::LoadFile(const char *path, std::vector<uint8_t> *blob)
+{
+	char realpath[PLATFORM_MAX_PATH];
+	g_pSM->BuildPath(Path_Game, realpath, sizeof(realpath), "%s", path);
+
+	FILE *fp = fopen(realpath, "rb");
+	if (!fp)
+		return false;
+
+	long size = -1;
+	if (fseek(fp, 0, SEEK_END) == 0)
+		size = ftell(fp);
+	if (size < (long)sizeof(BlobHeader) || fseek(fp, 0, SEEK_SET) != 0)
+	{
+		fclose(fp);
+		return false;
+	}
+
+	blob->resize(size);
+	bool ok = fread(blob->data(), 1, size, fp) == (size_t)size;
+	fclose(fp);
+	return ok;
+}
+
+void BlobStore::Stash(const char *key, std::vector<uint8_t> &&blob)
+{
+	stash_.replace(key, std::move(blob));
+}
+
+bool BlobStore::Unstash(const char *key, std::vector<uint8_t> *blob, bool remove)
+{
+	std::vector<uint8_t> *stored;
+	if (!stash_.retrieve(key, &stored))
+		return false;
+
+	if (remove)
+	{
+		*blob = std::move(*stored);
+		stash_.remove(key);
+	}
+	else
+	{
+		*blob = *stored;
+	}
+	return true;
+}
@@ -0,0 +1,180 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_SOURCEMOD_BLOB_STORE_H_
+#define _INCLUDE_SOURCEMOD_BLOB_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <sm_hashmap.h>
+#include "common_logic.h"
+
+enum BlobKind
+{
+	BlobKind_ArrayList = 1,
+	BlobKind_StringMap,
+	BlobKind_DataPack,
+};
+
+/**
+ * Every blob starts with this header, followed by |size| bytes of payload
+ * whose CRC32C is |crc|. Values are stored in host byte order; a blob is
+ * meant to be read back by the server that wrote it.
+ */
+struct BlobHeader
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t kind;
+	uint32_t size;
+	uint32_t crc;
+};
+
+#define BLOB_MAGIC		0x424D5353		/* "SSMB" */
+#define BLOB_VERSION	2
+
+/**
+ * Builds a blob in one growing buffer.
+ */
+class BlobWriter
+{
+public:
+	BlobWriter(BlobKind kind) : kind_(kind), buffer_(sizeof(BlobHeader))
+	{
+	}
+	void Write(const void *data, size_t bytes)
+	{
+		const uint8_t *ptr = reinterpret_cast<const uint8_t *>(data);
+		buffer_.insert(buffer_.end(), ptr, ptr + bytes);
+	}
+	void WriteU32(uint32_t val)
+	{
+		Write(&val, sizeof(val));
+	}
+	void WriteString(const char *str, size_t length)
+	{
+		WriteU32((uint32_t)length);
+		Write(str, length);
+	}
+	void Reserve(size_t bytes)
+	{
+		buffer_.reserve(buffer_.size() + bytes);
+	}
+
+	/* Fills in the header; the writer should not be used afterwards. */
+	std::vector<uint8_t> &Finish();
+
+private:
+	BlobKind kind_;
+	std::vector<uint8_t> buffer_;
+};
+
+/**
+ * Walks the payload of a blob. Every read is bounds checked and fails
+ * once the payload is exhausted.
+ */
+class BlobReader
+{
+public:
+	BlobReader() : pos_(NULL), end_(NULL)
+	{
+	}
+
+	/* Checks the header and checksum of |blob|. */
+	bool Open(const std::vector<uint8_t> &blob, BlobKind kind);
+
+	const uint8_t *Take(size_t bytes)
+	{
+		if ((size_t)(end_ - pos_) < bytes)
+			return NULL;
+		const uint8_t *ptr = pos_;
+		pos_ += bytes;
+		return ptr;
+	}
+	bool Read(void *out, size_t bytes)
+	{
+		const uint8_t *ptr = Take(bytes);
+		if (!ptr)
+			return false;
+		memcpy(out, ptr, bytes);
+		return true;
+	}
+	bool ReadU32(uint32_t *out)
+	{
+		return Read(out, sizeof(*out));
+	}
+	/* Returns the string's bytes, which are not null-terminated. */
+	const char *ReadString(size_t *length)
+	{
+		uint32_t len;
+		if (!ReadU32(&len))
+			return NULL;
+		*length = len;
+		return reinterpret_cast<const char *>(Take(len));
+	}
+	size_t Remaining() const
+	{
+		return end_ - pos_;
+	}
+
+private:
+	const uint8_t *pos_;
+	const uint8_t *end_;
+};
+
+/**
+ * Saves and loads blobs, either as files or in an in-memory store that
+ * lives as long as SourceMod does, so it survives map changes and plugin
+ * reloads without touching the disk.
+ */
+class BlobStore : public SMGlobalClass
+{
+public: // SMGlobalClass
+	void OnSourceModShutdown() override;
+
+public:
+	/* |path| is relative to the game folder. Each is a single write or read. */
+	bool SaveFile(const char *path, const std::vector<uint8_t> &blob);
+	bool LoadFile(const char *path, std::vector<uint8_t> *blob);
+
+	/* Replaces any blob already stored under |key|. */
+	void Stash(const char *key, std::vector<uint8_t> &&blob);
+	bool Unstash(const char *key, std::vector<uint8_t> *blob, bool remove);
+
+private:
+	StringHashMap<std::vector<uint8_t>> stash_;
+};
+
+extern BlobStore g_BlobStore;
+
+#endif //_INCLUDE_SOURCEMOD_BLOB_STORE_H_
@@ -36,6 +36,11 @@
 
 #include "CDataPack.h"
 
+/* Packs freed by Free() are kept here, storage intact, for the next New(). */
+static std::vector<CDataPack *> sFreePacks;
+static const size_t kMaxFreePacks = 64;
+static const size_t kMaxFreePackBytes = 4096;
+
 CDataPack::CDataPack()
 {
 	Initialize();
@@ -46,15 +51,44 @@ CDataPack::~CDataPack()
 	Initialize();
 }
 
+CDataPack *CDataPack::New()
+{
+	if (sFreePacks.empty())
+		return new CDataPack();
+
+	CDataPack *pack = sFreePacks.back();
+	sFreePacks.pop_back();
+	return pack;
+}
+
+void CDataPack::Free(CDataPack *pack)
+{
+	if (sFreePacks.size() >= kMaxFreePacks || pack->GetMemoryUsage() > kMaxFreePackBytes)
+	{
+		delete pack;
+		return;
+	}
+
+	pack->Initialize();
+	sFreePacks.push_back(pack);
+}
+
+void CDataPack::ReleasePool()
+{
+	for (size_t i = 0; i < sFreePacks.size(); i++)
+		delete sFreePacks[i];
+	sFreePacks.clear();
+}
+
 void CDataPack::Initialize()
 {
 	position = 0;
-	
-	do
-	{
-	} while (this->RemoveItem());
+	lent = false;
+	orphaned = false;
 
-	elements.clear();
+	/* Keep the storage around; a reset pack is usually refilled with the same data. */
+	data.clear();
+	offsets.clear();
 }
 
 void CDataPack::ResetSize()
@@ -62,76 +96,68 @@ void CDataPack::ResetSize()
 	Initialize();
 }
 
+uint8_t *CDataPack::InsertElement(CDataPackType type, size_t size)
+{
+	size_t bytes = GetElementBytes(size);
+	size_t offset = (position < offsets.size()) ? offsets[position] : data.size();
+
+	data.insert(data.begin() + offset, bytes, 0);
+	for (size_t i = position; i < offsets.size(); i++)
+		offsets[i] += bytes;
+	offsets.insert(offsets.begin() + position, offset);
+
+	ElementHeader *header = reinterpret_cast<ElementHeader *>(&data[offset]);
+	header->type = type;
+	header->size = static_cast<uint32_t>(size);
+	position++;
+
+	return reinterpret_cast<uint8_t *>(header + 1);
+}
+
 size_t CDataPack::CreateMemory(size_t size, void **addr)
 {
-	InternalPack val;
-	val.type = CDataPackType::Raw;
-	val.pData.vval = new uint8_t[size + sizeof(size)];
-	reinterpret_cast<size_t *>(val.pData.vval)[0] = size;
-	elements.emplace(elements.begin() + position, val);
+	uint8_t *ptr = InsertElement(CDataPackType::Raw, size);
+	if (addr)
+		*addr = ptr;
 
-	return position++;
+	return position - 1;
 }
 
 void CDataPack::PackCell(cell_t cell)
 {
-	InternalPack val;
-	val.type = CDataPackType::Cell;
-	val.pData.cval = cell;
-	elements.emplace(elements.begin() + position, val);
-	position++;
+	uint8_t *ptr = InsertElement(CDataPackType::Cell, sizeof(cell_t));
+	memcpy(ptr, &cell, sizeof(cell_t));
 }
 
 void CDataPack::PackFunction(cell_t function)
 {
-	InternalPack val;
-	val.type = CDataPackType::Function;
-	val.pData.cval = function;
-	elements.emplace(elements.begin() + position, val);
-	position++;
+	uint8_t *ptr = InsertElement(CDataPackType::Function, sizeof(cell_t));
+	memcpy(ptr, &function, sizeof(cell_t));
 }
 
 void CDataPack::PackFloat(float floatval)
 {
-	InternalPack val;
-	val.type = CDataPackType::Float;
-	val.pData.fval = floatval;
-	elements.emplace(elements.begin() + position, val);
-	position++;
+	uint8_t *ptr = InsertElement(CDataPackType::Float, sizeof(float));
+	memcpy(ptr, &floatval, sizeof(float));
 }
 
 void CDataPack::PackString(const char *string)
 {
-	InternalPack val;
-	val.type = CDataPackType::String;
-	std::string *sval = new std::string(string);
-	val.pData.sval = sval;
-	elements.emplace(elements.begin() + position, val);
-	position++;
+	size_t len = strlen(string);
+	uint8_t *ptr = InsertElement(CDataPackType::String, len + 1);
+	memcpy(ptr, string, len + 1);
 }
 
 void CDataPack::PackCellArray(cell_t const *vals, cell_t count)
 {
-	InternalPack val;
-	val.type = CDataPackType::CellArray;
-
-	val.pData.aval = new cell_t [count + 1];
-	memcpy(&val.pData.aval[1], vals, sizeof(cell_t) * count);
-	val.pData.aval[0] = count;
-	elements.emplace(elements.begin() + position, val);
-	position++;
+	uint8_t *ptr = InsertElement(CDataPackType::CellArray, sizeof(cell_t) * count);
+	memcpy(ptr, vals, sizeof(cell_t) * count);
 }
 
 void CDataPack::PackFloatArray(cell_t const *vals, cell_t count)
 {
-	InternalPack val;
-	val.type = CDataPackType::FloatArray;
-
-	val.pData.aval = new cell_t [count + 1];
-	memcpy(&val.pData.aval[1], vals, sizeof(cell_t) * count);
-	val.pData.aval[0] = count;
-	elements.emplace(elements.begin() + position, val);
-	position++;
+	uint8_t *ptr = InsertElement(CDataPackType::FloatArray, sizeof(cell_t) * count);
+	memcpy(ptr, vals, sizeof(cell_t) * count);
 }
 
 void CDataPack::Reset() const
@@ -146,7 +172,7 @@ size_t CDataPack::GetPosition() const
 
 bool CDataPack::SetPosition(size_t pos) const
 {
-	if (pos > elements.size())
+	if (pos > offsets.size())
 		return false;
 
 	position = pos;
@@ -155,36 +181,42 @@ bool CDataPack::SetPosition(size_t pos) const
 
 cell_t CDataPack::ReadCell() const
 {
-	if (!IsReadable() || elements[position].type != CDataPackType::Cell)
+	if (!IsReadable() || GetCurrentType() != CDataPackType::Cell)
 		return 0;
-	
-	return elements[position++].pData.cval;
+
+	cell_t val;
+	memcpy(&val, GetPayload(position++), sizeof(cell_t));
+	return val;
 }
 
 cell_t CDataPack::ReadFunction() const
 {
-	if (!IsReadable() || elements[position].type != CDataPackType::Function)
+	if (!IsReadable() || GetCurrentType() != CDataPackType::Function)
 		return 0;
-	
-	return elements[position++].pData.cval;
+
+	cell_t val;
+	memcpy(&val, GetPayload(position++), sizeof(cell_t));
+	return val;
 }
 
 float CDataPack::ReadFloat() const
 {
-	if (!IsReadable() || elements[position].type != CDataPackType::Float)
+	if (!IsReadable() || GetCurrentType() != CDataPackType::Float)
 		return 0;
-	
-	return elements[position++].pData.fval;
+
+	float val;
+	memcpy(&val, GetPayload(position++), sizeof(float));
+	return val;
 }
 
 bool CDataPack::IsReadable(size_t bytes) const
 {
-	return (position < elements.size());
+	return (position < offsets.size());
 }
 
 const char *CDataPack::ReadString(size_t *len) const
 {
-	if (!IsReadable() || elements[position].type != CDataPackType::String)
+	if (!IsReadable() || GetCurrentType() != CDataPackType::String)
 	{
 		if (len)
 			*len = 0;
@@ -192,16 +224,15 @@ const char *CDataPack::ReadString(size_t *len) const
 		return nullptr;
 	}
 
-	const std::string &val = *elements[position++].pData.sval;
 	if (len)
-		*len = val.size();
+		*len = GetHeader(position)->size - 1;
 
-	return val.c_str();
+	return reinterpret_cast<const char *>(GetPayload(position++));
 }
 
 cell_t *CDataPack::ReadCellArray(cell_t *size) const
 {
-	if (!IsReadable() || elements[position].type != CDataPackType::CellArray)
+	if (!IsReadable() || GetCurrentType() != CDataPackType::CellArray)
 	{
 		if(size)
 			*size = 0;
@@ -209,19 +240,15 @@ cell_t *CDataPack::ReadCellArray(cell_t *size) const
 		return nullptr;
 	}
 
-	cell_t *val = elements[position].pData.aval;
-	cell_t *ptr = &(val[1]);
-	++position;
-
 	if (size)
-		*size = val[0];
+		*size = GetHeader(position)->size / sizeof(cell_t);
 
-	return ptr;
+	return reinterpret_cast<cell_t *>(GetPayload(position++));
 }
 
 cell_t *CDataPack::ReadFloatArray(cell_t *size) const
 {
-	if (!IsReadable() || elements[position].type != CDataPackType::FloatArray)
+	if (!IsReadable() || GetCurrentType() != CDataPackType::FloatArray)
 	{
 		if(size)
 			*size = 0;
@@ -229,35 +256,100 @@ cell_t *CDataPack::ReadFloatArray(cell_t *size) const
 		return nullptr;
 	}
 
-	cell_t *val = elements[position].pData.aval;
-	cell_t *ptr = &(val[1]);
-	++position;
-
 	if (size)
-		*size = val[0];
+		*size = GetHeader(position)->size / sizeof(cell_t);
 
-	return ptr;
+	return reinterpret_cast<cell_t *>(GetPayload(position++));
 }
 
 void *CDataPack::ReadMemory(size_t *size) const
 {
-	void *ptr = nullptr;
-	if (!IsReadable() || elements[position].type != CDataPackType::Raw)
-		return ptr;
-
-	size_t *val = reinterpret_cast<size_t *>(elements[position].pData.vval);
-	ptr = &(val[1]);
-	++position;
+	if (!IsReadable() || GetCurrentType() != CDataPackType::Raw)
+		return nullptr;
 
 	if (size)
-		*size = val[0]; /* Egor!!!! */
+		*size = GetHeader(position)->size;
 
-	return ptr;
+	return GetPayload(position++);
+}
+
+bool CDataPack::SetRawData(const uint8_t *buf, size_t size)
+{
+	Initialize();
+
+	size_t offset = 0;
+	while (offset < size)
+	{
+		ElementHeader header;
+		if (size - offset < sizeof(header))
+			break;
+		memcpy(&header, buf + offset, sizeof(header));
+
+		bool valid;
+		switch (header.type)
+		{
+		case CDataPackType::Cell:
+		case CDataPackType::Float:
+		case CDataPackType::Function:
+			valid = (header.size == sizeof(cell_t));
+			break;
+		case CDataPackType::String:
+			valid = (header.size >= 1 && header.size <= size - offset - sizeof(header)
+				&& buf[offset + sizeof(header) + header.size - 1] == '\0');
+			break;
+		case CDataPackType::CellArray:
+		case CDataPackType::FloatArray:
+			valid = (header.size % sizeof(cell_t) == 0);
+			break;
+		case CDataPackType::Raw:
+			valid = true;
+			break;
+		default:
+			valid = false;
+			break;
+		}
+
+		size_t bytes = GetElementBytes(header.size);
+		if (!valid || bytes > size - offset)
+			break;
+
+		offsets.push_back(offset);
+		offset += bytes;
+	}
+
+	if (offset != size)
+	{
+		Initialize();
+		return false;
+	}
+
+	data.assign(buf, buf + size);
+	return true;
+}
+
+void CDataPack::Lend(CDataPack &loan)
+{
+	loan.data.swap(data);
+	loan.offsets.swap(offsets);
+	loan.position = position;
+
+	position = 0;
+	lent = true;
+}
+
+void CDataPack::Return(CDataPack &loan)
+{
+	data.swap(loan.data);
+	offsets.swap(loan.offsets);
+	position = loan.position;
+
+	loan.Initialize();
+	lent = false;
 }
 
 bool CDataPack::RemoveItem(size_t pos)
 {
-	if (!elements.size())
+	if (!offsets.size())
 	{
 		return false;
 	}
@@ -267,7 +359,7 @@ bool CDataPack::RemoveItem(size_t pos)
 		pos = position;
 	}
 	
-	if (pos >= elements.size())
+	if (pos >= offsets.size())
 	{
 		return false;
 	}
@@ -277,28 +369,14 @@ bool CDataPack::RemoveItem(size_t pos)
 		--position;
 	}
 
-	switch (elements[pos].type)
-	{
-		case CDataPackType::Raw:
-		{
-			delete [] elements[pos].pData.vval;
-			break;
-		}
+	size_t offset = offsets[pos];
+	size_t end = (pos + 1 < offsets.size()) ? offsets[pos + 1] : data.size();
+	size_t bytes = end - offset;
 
-		case CDataPackType::String:
-		{
-			delete elements[pos].pData.sval;
-			break;
-		}
-
-		case CDataPackType::CellArray:
-		case CDataPackType::FloatArray:
-		{
-			delete [] elements[pos].pData.aval;
-			break;
-		}
-	}
+	data.erase(data.begin() + offset, data.begin() + end);
+	offsets.erase(offsets.begin() + pos);
+	for (size_t i = pos; i < offsets.size(); i++)
+		offsets[i] -= bytes;
 
-	elements.erase(elements.begin() + pos);
 	return true;
 }
@@ -54,6 +54,22 @@ public:
 	CDataPack();
 	~CDataPack();
 
+	/**
+	 * @brief Returns an empty pack, reusing a recently freed one if possible.
+	 */
+	static CDataPack *New();
+
+	/**
+	 * @brief Releases a pack obtained from New(). Small packs are kept for
+	 * reuse along with their storage.
+	 */
+	static void Free(CDataPack *pack);
+
+	/**
+	 * @brief Destroys every pooled pack.
+	 */
+	static void ReleasePool();
+
 public: // Originally IDataReader
 	/**
 	 * @brief Resets the position in the data stream to the beginning.
@@ -201,26 +217,86 @@ public: // Originally IDataPack
 
 public:
 	void Initialize();
-	inline size_t GetCapacity() const { return this->elements.size(); };
-	inline CDataPackType GetCurrentType(void) const { return this->elements[this->position].type; };
+	inline size_t GetCapacity() const { return this->offsets.size(); };
+	inline size_t GetMemoryUsage() const { return this->data.capacity() + this->offsets.capacity() * sizeof(size_t); };
+	inline CDataPackType GetCurrentType(void) const { return (CDataPackType)GetHeader(this->position)->type; };
 	bool RemoveItem(size_t pos = -1);
 
+	/**
+	 * @brief Returns the packed element stream, for serialization.
+	 */
+	inline const std::vector<uint8_t> &GetRawData() const { return this->data; };
+
+	/**
+	 * @brief Replaces the pack's contents with a stream from GetRawData().
+	 * The position is reset to the beginning.
+	 *
+	 * @param buf		Stream to copy.
+	 * @param size		Size of the stream, in bytes.
+	 * @return			True on success, false (leaving the pack empty) if the
+	 *					stream is malformed.
+	 */
+	bool SetRawData(const uint8_t *buf, size_t size);
+
+	/**
+	 * @brief Moves the pack's contents and position into |loan| without
+	 * copying them, leaving this pack empty and marked as lent until Return().
+	 *
+	 * @param loan		Empty pack to move the contents into.
+	 */
+	void Lend(CDataPack &loan);
+
+	/**
+	 * @brief Moves the contents lent out by Lend() back into this pack.
+	 *
+	 * @param loan		Pack that was passed to Lend().
+	 */
+	void Return(CDataPack &loan);
+
+	inline bool IsLent() const { return this->lent; };
+
+	/**
+	 * @brief Marks a lent pack whose Handle was closed, so whoever holds the
+	 * loan frees it after Return().
+	 */
+	inline void Orphan() { this->orphaned = true; };
+	inline bool IsOrphaned() const { return this->orphaned; };
+
 private:
-	typedef union {
-		cell_t cval;
-		float fval;
-		uint8_t *vval;
-		std::string *sval;
-		cell_t *aval;
-	} InternalPackValue;
-	
-	typedef struct {
-		InternalPackValue pData;
-		CDataPackType type;
-	} InternalPack;
-
-	std::vector<InternalPack> elements;
+	/**
+	 * Every element is stored in |data| as a header followed by its payload
+	 * (the cell, float, string with terminator, or array), padded so the
+	 * next header stays 8-byte aligned. |offsets| maps element indexes, which
+	 * is what positions are, to byte offsets into |data|.
+	 */
+	struct ElementHeader
+	{
+		uint32_t type;
+		uint32_t size;
+	};
+
+	static inline size_t GetElementBytes(size_t size)
+	{
+		return sizeof(ElementHeader) + ((size + 7) & ~size_t(7));
+	}
+
+	inline const ElementHeader *GetHeader(size_t index) const
+	{
+		return reinterpret_cast<const ElementHeader *>(&this->data[this->offsets[index]]);
+	}
+
+	inline uint8_t *GetPayload(size_t index) const
+	{
+		return const_cast<uint8_t *>(reinterpret_cast<const uint8_t *>(GetHeader(index) + 1));
+	}
+
+	uint8_t *InsertElement(CDataPackType type, size_t size);
+
+	std::vector<uint8_t> data;
+	std::vector<size_t> offsets;
 	mutable size_t position;
+	bool lent;
+	bool orphaned;
 };
 
 #endif //_INCLUDE_SOURCEMOD_CDATAPACK_H_
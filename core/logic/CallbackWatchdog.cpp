@@ -0,0 +1,229 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#include "CallbackWatchdog.h"
+#include "ExtensionSys.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <ISourceMod.h>
+#include <bridge/include/ILogger.h>
+#include <bridge/include/IScriptManager.h>
+
+CallbackWatchdog g_CallbackWatchdog;
+
+CallbackWatchdog::CallbackWatchdog()
+ : depth_(0),
+   seq_local_(0),
+   reported_(0),
+   count_offenders_(false),
+   initialized_(false),
+   seq_(0),
+   flagged_(0),
+   busy_ms_(0),
+   threshold_ms_(0),
+   stop_(false)
+{
+}
+
+void
+CallbackWatchdog::OnSourceModAllInitialized()
+{
+	initialized_ = true;
+	UpdateThread();
+}
+
+void
+CallbackWatchdog::OnSourceModShutdown()
+{
+	threshold_ms_ = 0;
+	UpdateThread();
+	initialized_ = false;
+}
+
+ConfigResult
+CallbackWatchdog::OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source,
+                                           char *error, size_t maxlength)
+{
+	if (strcmp(key, "CallbackWatchdogCountOffenders") == 0) {
+		if (strcasecmp(value, "yes") == 0) {
+			count_offenders_ = true;
+		} else if (strcasecmp(value, "no") == 0) {
+			count_offenders_ = false;
+			offenders_.clear();
+		} else {
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be \"yes\" or \"no\"");
+			return ConfigResult_Reject;
+		}
+		return ConfigResult_Accept;
+	}
+
+	if (strcmp(key, "CallbackWatchdogThreshold") != 0)
+		return ConfigResult_Ignore;
+
+	char *end;
+	unsigned long threshold = strtoul(value, &end, 10);
+	if (!value[0] || *end != '\0') {
+		ke::SafeStrcpy(error, maxlength, "Invalid value: must be a number of milliseconds");
+		return ConfigResult_Reject;
+	}
+	threshold_ms_ = (unsigned int)threshold;
+	UpdateThread();
+	return ConfigResult_Accept;
+}
+
+void
+CallbackWatchdog::UpdateThread()
+{
+	bool wanted = initialized_ && threshold_ms_ > 0;
+	if (wanted == !!thread_)
+		return;
+
+	if (wanted) {
+		stop_ = false;
+		thread_.reset(new std::thread([this]() -> void { ThreadMain(); }));
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(lock_);
+		stop_ = true;
+	}
+	wake_.notify_one();
+	thread_->join();
+	thread_ = nullptr;
+}
+
+void
+CallbackWatchdog::ThreadMain()
+{
+	using namespace std::chrono;
+
+	uint32_t last = 0;
+	steady_clock::time_point since;
+
+	std::unique_lock<std::mutex> lock(lock_);
+	while (!stop_) {
+		unsigned int threshold = threshold_ms_.load(std::memory_order_relaxed);
+		wake_.wait_for(lock, milliseconds(std::max(threshold / 4, 5u)));
+		if (stop_)
+			break;
+
+		// Odd values mean the main thread is inside a callback.
+		uint32_t seq = seq_.load(std::memory_order_acquire);
+		steady_clock::time_point now = steady_clock::now();
+		if (seq != last) {
+			last = seq;
+			since = now;
+			continue;
+		}
+		if (!(seq & 1))
+			continue;
+
+		uint32_t busy = (uint32_t)duration_cast<milliseconds>(now - since).count();
+		busy_ms_.store(busy, std::memory_order_relaxed);
+		if (busy >= threshold && flagged_.load(std::memory_order_relaxed) != seq)
+			flagged_.store(seq, std::memory_order_release);
+	}
+}
+
+void
+CallbackWatchdog::DescribeFrame(const Frame &frame, std::string *owner)
+{
+	if (frame.func) {
+		SMPlugin *plugin = scripts->FindPluginByContext(frame.func->GetParentContext()->GetContext());
+		if (plugin) {
+			*owner = plugin->GetFilename();
+			return;
+		}
+	}
+
+	if (!frame.owner || frame.owner == g_pCoreIdent)
+		*owner = "SourceMod";
+	else if (IExtension *ext = g_Extensions.GetExtensionFromIdent(frame.owner))
+		*owner = ext->GetFilename();
+	else if (SMPlugin *plugin = scripts->FindPluginByIdentity(frame.owner))
+		*owner = plugin->GetFilename();
+	else
+		*owner = "<unknown>";
+}
+
+void
+CallbackWatchdog::Report()
+{
+	reported_ = seq_local_;
+
+	unsigned int depth = std::min(depth_, kMaxFrames);
+	const Frame &top = frames_[depth - 1];
+
+	std::string owner;
+	DescribeFrame(top, &owner);
+
+	unsigned int busy = busy_ms_.load(std::memory_order_relaxed);
+	if (count_offenders_) {
+		unsigned int count = ++offenders_[owner];
+		logger->LogError("[SM] Callback \"%s\" in %s kept the server busy for at least %u ms (%u time%s so far)",
+		                 top.name, owner.c_str(), busy, count, count == 1 ? "" : "s");
+	} else {
+		logger->LogError("[SM] Callback \"%s\" in %s kept the server busy for at least %u ms",
+		                 top.name, owner.c_str(), busy);
+	}
+
+	if (depth < 2)
+		return;
+
+	logger->LogError("[SM] Called from:");
+	for (unsigned int i = depth - 1; i-- > 0; ) {
+		DescribeFrame(frames_[i], &owner);
+		logger->LogError("[SM]   \"%s\" in %s", frames_[i].name, owner.c_str());
+	}
+
+	// The callers are still executing, so their script frames can be walked.
+	for (unsigned int i = depth - 1; i-- > 0; ) {
+		if (!frames_[i].func)
+			continue;
+
+		IPluginContext *pContext = frames_[i].func->GetParentContext();
+		IFrameIterator *it = pContext->CreateFrameIterator();
+		for (unsigned int n = 0; !it->Done(); it->Next()) {
+			if (!it->IsScriptedFrame())
+				continue;
+			const char *file = it->FilePath();
+			const char *func = it->FunctionName();
+			logger->LogError("[SM]   [%u] Line %d, %s::%s", n++, it->LineNumber(),
+			                 file ? file : "<unknown>", func ? func : "<unknown>");
+		}
+		pContext->DestroyFrameIterator(it);
+		break;
+	}
+}
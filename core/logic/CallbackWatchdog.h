@@ -0,0 +1,121 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#ifndef _include_sourcemod_logic_callback_watchdog_h_
+#define _include_sourcemod_logic_callback_watchdog_h_
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <IPluginSys.h>
+#include "common_logic.h"
+
+using namespace SourceMod;
+
+// Reports callbacks that keep the main thread busy for longer than
+// CallbackWatchdogThreshold milliseconds.
+//
+// The main thread never reads a clock for this: entering and leaving the
+// outermost callback bumps a sequence number, and a background thread samples
+// it. If the same odd (busy) value is seen for longer than the threshold, the
+// call is flagged, and the main thread logs it - with the chain of active
+// callbacks and the SourcePawn stack of the callers that are still running -
+// as soon as the flagged callback (or one nested in it) returns.
+class CallbackWatchdog : public SMGlobalClass
+{
+public:
+	CallbackWatchdog();
+
+	void Enter(IdentityToken_t *owner, IPluginFunction *func, const char *name) {
+		if (depth_ < kMaxFrames)
+			frames_[depth_] = Frame{owner, func, name};
+		if (depth_++ == 0)
+			seq_.store(++seq_local_, std::memory_order_release);
+	}
+	void Leave() {
+		if (flagged_.load(std::memory_order_relaxed) == seq_local_ && reported_ != seq_local_)
+			Report();
+		if (--depth_ == 0)
+			seq_.store(++seq_local_, std::memory_order_release);
+	}
+
+	// SMGlobalClass
+	ConfigResult OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source,
+	                                      char *error, size_t maxlength) override;
+	void OnSourceModAllInitialized() override;
+	void OnSourceModShutdown() override;
+
+private:
+	static const unsigned int kMaxFrames = 16;
+
+	struct Frame
+	{
+		IdentityToken_t *owner;
+		IPluginFunction *func;
+		const char *name;
+	};
+
+	void Report();
+	void DescribeFrame(const Frame &frame, std::string *owner);
+	void UpdateThread();
+	void ThreadMain();
+
+private:
+	// Main thread only.
+	Frame frames_[kMaxFrames];
+	unsigned int depth_;
+	uint32_t seq_local_;
+	uint32_t reported_;
+	std::unordered_map<std::string, unsigned int> offenders_;
+	bool count_offenders_;
+	bool initialized_;
+
+	// Shared with the watchdog thread.
+	std::atomic<uint32_t> seq_;
+	std::atomic<uint32_t> flagged_;
+	std::atomic<uint32_t> busy_ms_;
+	std::atomic<unsigned int> threshold_ms_;
+
+	std::unique_ptr<std::thread> thread_;
+	std::mutex lock_;
+	std::condition_variable wake_;
+	bool stop_;
+};
+
+extern CallbackWatchdog g_CallbackWatchdog;
+
+#endif // _include_sourcemod_logic_callback_watchdog_h_
@@ -34,6 +34,11 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <ICellArray.h>
 #include <amtl/am-bits.h>
 
@@ -42,7 +47,7 @@ extern HandleType_t htCellArray;
 class CellArray : public ICellArray
 {
 public:
-	CellArray(size_t blocksize) : m_Data(NULL), m_BlockSize(blocksize), m_AllocSize(0), m_Size(0)
+	CellArray(size_t blocksize) : m_Data(NULL), m_BlockSize(blocksize), m_AllocSize(0), m_Size(0), m_Frozen(false)
 	{
 	}
 
@@ -71,7 +76,7 @@ public:
 	*/
 	static void Free(ICellArray *arr)
 	{
-		delete arr;
+		delete static_cast<CellArray *>(arr);
 	}
 
 	// ICellArray
@@ -81,6 +86,7 @@ public:
 		return m_Size;
 	}
 
+	/* Rows appended by push() or resize() are picked up lazily by the index. */
 	cell_t *push()
 	{
 		if (!GrowIfNeeded(1))
@@ -105,16 +111,26 @@ public:
 	void clear()
 	{
 		m_Size = 0;
+		InvalidateIndex();
 	}
 
 	bool swap(size_t item1, size_t item2)
 	{
+		/* Removing the same entry from the index twice would corrupt it */
+		if (item1 == item2)
+		{
+			return true;
+		}
+
 		/* Make sure there is extra space available */
 		if (!GrowIfNeeded(1))
 		{
 			return false;
 		}
 
+		IndexRemove(item1);
+		IndexRemove(item2);
+
 		cell_t *pri = at(item1);
 		cell_t *alt = at(item2);
 
@@ -125,6 +141,9 @@ public:
 		memcpy(pri, alt, sizeof(cell_t) * m_BlockSize);
 		memcpy(alt, temp, sizeof(cell_t) * m_BlockSize);
 
+		IndexAdd(item1);
+		IndexAdd(item2);
+
 		return true;
 	}
 
@@ -133,10 +152,17 @@ public:
 		/* If we're at the end, take the easy way out */
 		if (index == m_Size - 1)
 		{
+			IndexRemove(index);
+			if (m_Index && m_Index->indexed > index)
+			{
+				m_Index->indexed = index;
+			}
 			m_Size--;
 			return;
 		}
 
+		InvalidateIndex();
+
 		/* Otherwise, it's time to move stuff! */
 		size_t remaining_indexes = (m_Size - 1) - index;
 		cell_t *src = at(index + 1);
@@ -146,6 +172,35 @@ public:
 		m_Size--;
 	}
 
+	cell_t *push_range(size_t count)
+	{
+		if (!GrowIfNeeded(count))
+		{
+			return NULL;
+		}
+		cell_t *arr = &m_Data[m_Size * m_BlockSize];
+		m_Size += count;
+		return arr;
+	}
+
+	cell_t *insert_range(size_t index, size_t count)
+	{
+		if (!GrowIfNeeded(count))
+		{
+			return NULL;
+		}
+
+		InvalidateIndex();
+
+		cell_t *src = at(index);
+		cell_t *dst = at(index + count);
+		memmove(dst, src, sizeof(cell_t) * m_BlockSize * (m_Size-index));
+
+		m_Size += count;
+
+		return src;
+	}
+
 	cell_t *insert_at(size_t index)
 	{
 		/* Make sure it'll fit */
@@ -154,6 +209,8 @@ public:
 			return NULL;
 		}
 
+		InvalidateIndex();
+
 		/* move everything up */
 		cell_t *src = at(index);
 		cell_t *dst = at(index + 1);
@@ -168,6 +225,10 @@ public:
 	{
 		if (count <= m_Size)
 		{
+			if (m_Index && count < m_Index->indexed)
+			{
+				InvalidateIndex();
+			}
 			m_Size = count;
 			return true;
 		}
@@ -207,6 +268,218 @@ public:
 		return m_AllocSize * m_BlockSize * sizeof(cell_t);
 	}
 
+	size_t capacity() const
+	{
+		return m_AllocSize;
+	}
+
+	bool reserve(size_t count)
+	{
+		if (count <= m_AllocSize)
+		{
+			return true;
+		}
+		if (!ke::IsUintPtrMultiplySafe(count, sizeof(cell_t) * m_BlockSize))
+		{
+			return false;
+		}
+		return Reallocate(count);
+	}
+
+	bool shrink_to_fit()
+	{
+		if (m_Size == m_AllocSize)
+		{
+			return true;
+		}
+		if (!m_Size)
+		{
+			free(m_Data);
+			m_Data = NULL;
+			m_AllocSize = 0;
+			return true;
+		}
+		return Reallocate(m_Size);
+	}
+
+public:
+	/**
+	 * Makes the array permanently read-only. Storage is trimmed to the
+	 * current size and any index is brought up to date, so that nothing a
+	 * reader does afterwards writes to the array; that is what makes it safe
+	 * to share between plugins and to read from other threads. Callers that
+	 * modify arrays must check frozen() first.
+	 */
+	void freeze()
+	{
+		if (m_Frozen)
+		{
+			return;
+		}
+		if (m_Index)
+		{
+			IndexCatchUp();
+		}
+		shrink_to_fit();
+		m_Frozen = true;
+	}
+
+	bool frozen() const
+	{
+		return m_Frozen;
+	}
+
+public:
+	/**
+	 * An optional hash index over one block of every row, used by FindValue and
+	 * (case-sensitive) FindString. Structural changes made through this class keep
+	 * it current; callers that write into a row through at() or base() must
+	 * bracket the write with IndexRemove()/IndexAdd(), or call InvalidateIndex().
+	 */
+	bool SetIndex(size_t block, bool strings)
+	{
+		if (block >= m_BlockSize)
+		{
+			return false;
+		}
+		m_Index.reset(new Index(block, strings));
+		return true;
+	}
+
+	void ClearIndex()
+	{
+		m_Index = nullptr;
+	}
+
+	bool HasIndex(size_t block, bool strings) const
+	{
+		return m_Index && m_Index->block == block && m_Index->strings == strings;
+	}
+
+	void InvalidateIndex()
+	{
+		if (m_Index)
+		{
+			m_Index->rows.clear();
+			m_Index->indexed = 0;
+		}
+	}
+
+	void IndexRemove(size_t row)
+	{
+		if (!m_Index || row >= m_Index->indexed)
+		{
+			return;
+		}
+
+		auto iter = m_Index->rows.find(RowKey(row));
+		if (iter == m_Index->rows.end())
+		{
+			return;
+		}
+
+		std::vector<size_t> &rows = iter->second;
+		auto pos = std::lower_bound(rows.begin(), rows.end(), row);
+		if (pos != rows.end() && *pos == row)
+		{
+			rows.erase(pos);
+		}
+		if (rows.empty())
+		{
+			m_Index->rows.erase(iter);
+		}
+	}
+
+	void IndexAdd(size_t row)
+	{
+		if (!m_Index || row >= m_Index->indexed)
+		{
+			return;
+		}
+
+		std::vector<size_t> &rows = m_Index->rows[RowKey(row)];
+		rows.insert(std::upper_bound(rows.begin(), rows.end(), row), row);
+	}
+
+	/**
+	 * Finds the first row after |startidx| (or the last row before it, if
+	 * |reverse| is set) whose indexed block matches |key|. Returns -1 if no row
+	 * matches. |startidx| follows the FindValue/FindString conventions.
+	 */
+	int IndexFind(const std::string &key, int startidx, bool reverse)
+	{
+		IndexCatchUp();
+
+		auto iter = m_Index->rows.find(key);
+		if (iter == m_Index->rows.end())
+		{
+			return -1;
+		}
+
+		const std::vector<size_t> &rows = iter->second;
+		if (reverse)
+		{
+			size_t limit = (startidx < 0) ? m_Size : (size_t)startidx;
+			auto pos = std::lower_bound(rows.begin(), rows.end(), limit);
+			return (pos == rows.begin()) ? -1 : (int)*(pos - 1);
+		}
+
+		if (startidx < 0)
+		{
+			return (int)rows.front();
+		}
+		auto pos = std::upper_bound(rows.begin(), rows.end(), (size_t)startidx);
+		return (pos == rows.end()) ? -1 : (int)*pos;
+	}
+
+	static std::string IndexKey(cell_t value)
+	{
+		return std::string((const char *)&value, sizeof(value));
+	}
+
+	static std::string IndexKey(const char *str)
+	{
+		return std::string(str);
+	}
+
+private:
+	/* Adds rows appended since the last lookup. */
+	void IndexCatchUp()
+	{
+		while (m_Index->indexed < m_Size)
+		{
+			size_t row = m_Index->indexed++;
+			m_Index->rows[RowKey(row)].push_back(row);
+		}
+	}
+
+	std::string RowKey(size_t row) const
+	{
+		const cell_t *blk = &at(row)[m_Index->block];
+		if (!m_Index->strings)
+		{
+			return IndexKey(*blk);
+		}
+
+		const char *str = (const char *)blk;
+		size_t maxlen = (m_BlockSize - m_Index->block) * sizeof(cell_t);
+		return std::string(str, strnlen(str, maxlen));
+	}
+
+	struct Index
+	{
+		Index(size_t block, bool strings)
+			: block(block), strings(strings), indexed(0)
+		{
+		}
+
+		size_t block;
+		bool strings;
+		/* Rows [0, indexed) are in the table; sorted row numbers per key. */
+		size_t indexed;
+		std::unordered_map<std::string, std::vector<size_t>> rows;
+	};
+
 private:
 	bool GrowIfNeeded(size_t count)
 	{
@@ -235,6 +508,10 @@ private:
 			newAllocSize *= 2;
 		}
 		/* finally, allocate the new block */
+		return Reallocate(newAllocSize);
+	}
+	bool Reallocate(size_t newAllocSize)
+	{
 		cell_t *data = static_cast<cell_t*>(realloc(m_Data, sizeof(cell_t) * m_BlockSize * newAllocSize));
 		/* Update state if allocation was successful */
 		if (data)
@@ -249,6 +526,8 @@ private:
 	size_t m_BlockSize;
 	size_t m_AllocSize;
 	size_t m_Size;
+	std::unique_ptr<Index> m_Index;
+	bool m_Frozen;
 };
 
 #endif /* _INCLUDE_SOURCEMOD_CELLARRAY_H_ */
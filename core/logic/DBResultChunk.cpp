@@ -0,0 +1,325 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "DBResultChunk.h"
+#include "stringutil.h"
+
+DBResultChunk::DBResultChunk(IResultSet *source, unsigned int affectedRows, unsigned int insertId)
+ : m_ColCount(0), m_RowCount(0), m_CurRow(0),
+   m_AffectedRows(affectedRows), m_InsertID(insertId)
+{
+	if (!source)
+	{
+		return;
+	}
+
+	m_ColCount = source->GetFieldCount();
+	m_Names.reserve(m_ColCount);
+	m_Types.reserve(m_ColCount);
+	m_DataTypes.reserve(m_ColCount);
+	for (unsigned int i = 0; i < m_ColCount; i++)
+	{
+		const char *name = source->FieldNumToName(i);
+		m_Names.push_back(name ? name : "");
+		m_Types.push_back(source->GetFieldType(i));
+		m_DataTypes.push_back(source->GetFieldDataType(i));
+	}
+}
+
+bool DBResultChunk::CopyRow(IResultSet *source)
+{
+	IResultRow *row = source->CurrentRow();
+	if (!row)
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < m_ColCount; i++)
+	{
+		Cell cell;
+		cell.offset = m_Data.size();
+		cell.length = 0;
+		cell.null = row->IsNull(i);
+
+		const char *str;
+		size_t length;
+		if (!cell.null && row->GetString(i, &str, &length) == DBVal_Data)
+		{
+			m_Data.append(str, length);
+			cell.length = length;
+		}
+
+		/* Terminate every value so GetString() can point straight into the buffer */
+		m_Data.push_back('\0');
+		m_Cells.push_back(cell);
+	}
+
+	m_RowCount++;
+	return true;
+}
+
+unsigned int DBResultChunk::Fill(IResultSet *source, unsigned int maxRows)
+{
+	unsigned int copied = 0;
+	while (copied < maxRows && source->FetchRow())
+	{
+		CopyRow(source);
+		copied++;
+	}
+	return copied;
+}
+
+IResultSet *DBResultChunk::GetResultSet()
+{
+	return m_ColCount ? this : NULL;
+}
+
+bool DBResultChunk::FetchMoreResults()
+{
+	return false;
+}
+
+void DBResultChunk::Destroy()
+{
+	delete this;
+}
+
+unsigned int DBResultChunk::GetRowCount()
+{
+	return m_RowCount;
+}
+
+unsigned int DBResultChunk::GetFieldCount()
+{
+	return m_ColCount;
+}
+
+const char *DBResultChunk::FieldNumToName(unsigned int columnId)
+{
+	if (columnId >= m_ColCount)
+	{
+		return NULL;
+	}
+
+	return m_Names[columnId].c_str();
+}
+
+bool DBResultChunk::FieldNameToNum(const char *name, unsigned int *columnId)
+{
+	for (unsigned int i = 0; i < m_ColCount; i++)
+	{
+		if (m_Names[i].compare(name) == 0)
+		{
+			if (columnId)
+			{
+				*columnId = i;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+bool DBResultChunk::MoreRows()
+{
+	return (m_CurRow < m_RowCount);
+}
+
+IResultRow *DBResultChunk::FetchRow()
+{
+	if (m_CurRow >= m_RowCount)
+	{
+		/* Put us one after so we know to block CurrentRow() */
+		m_CurRow = m_RowCount + 1;
+		return NULL;
+	}
+	m_CurRow++;
+	return this;
+}
+
+IResultRow *DBResultChunk::CurrentRow()
+{
+	if (!m_CurRow || m_CurRow > m_RowCount)
+	{
+		return NULL;
+	}
+	return this;
+}
+
+bool DBResultChunk::Rewind()
+{
+	m_CurRow = 0;
+	return true;
+}
+
+DBType DBResultChunk::GetFieldType(unsigned int field)
+{
+	if (field >= m_ColCount)
+	{
+		return DBType_Unknown;
+	}
+	return m_Types[field];
+}
+
+DBType DBResultChunk::GetFieldDataType(unsigned int field)
+{
+	if (field >= m_ColCount)
+	{
+		return DBType_Unknown;
+	}
+	return m_DataTypes[field];
+}
+
+const DBResultChunk::Cell *DBResultChunk::GetCell(unsigned int columnId)
+{
+	if (!m_CurRow || m_CurRow > m_RowCount || columnId >= m_ColCount)
+	{
+		return NULL;
+	}
+	return &m_Cells[(m_CurRow - 1) * m_ColCount + columnId];
+}
+
+DBResult DBResultChunk::GetString(unsigned int columnId, const char **pString, size_t *length)
+{
+	const Cell *cell = GetCell(columnId);
+	if (!cell)
+	{
+		return DBVal_Error;
+	}
+
+	*pString = &m_Data[cell->offset];
+	if (length)
+	{
+		*length = cell->length;
+	}
+
+	return cell->null ? DBVal_Null : DBVal_Data;
+}
+
+DBResult DBResultChunk::CopyString(unsigned int columnId, char *buffer, size_t maxlength, size_t *written)
+{
+	const char *str;
+	DBResult res = GetString(columnId, &str, NULL);
+	if (res == DBVal_Error)
+	{
+		return DBVal_Error;
+	}
+
+	size_t wr = strncopy(buffer, str, maxlength);
+	if (written)
+	{
+		*written = wr;
+	}
+
+	return res;
+}
+
+DBResult DBResultChunk::GetFloat(unsigned int columnId, float *pFloat)
+{
+	const Cell *cell = GetCell(columnId);
+	if (!cell)
+	{
+		return DBVal_Error;
+	} else if (cell->null) {
+		*pFloat = 0.0f;
+		return DBVal_Null;
+	}
+
+	*pFloat = (float)atof(&m_Data[cell->offset]);
+	return DBVal_Data;
+}
+
+DBResult DBResultChunk::GetInt(unsigned int columnId, int *pInt)
+{
+	const Cell *cell = GetCell(columnId);
+	if (!cell)
+	{
+		return DBVal_Error;
+	} else if (cell->null) {
+		*pInt = 0;
+		return DBVal_Null;
+	}
+
+	*pInt = atoi(&m_Data[cell->offset]);
+	return DBVal_Data;
+}
+
+bool DBResultChunk::IsNull(unsigned int columnId)
+{
+	const Cell *cell = GetCell(columnId);
+	return !cell || cell->null;
+}
+
+size_t DBResultChunk::GetDataSize(unsigned int columnId)
+{
+	const Cell *cell = GetCell(columnId);
+	return cell ? cell->length : 0;
+}
+
+DBResult DBResultChunk::GetBlob(unsigned int columnId, const void **pData, size_t *length)
+{
+	const Cell *cell = GetCell(columnId);
+	if (!cell)
+	{
+		return DBVal_Error;
+	}
+
+	*pData = cell->null ? NULL : &m_Data[cell->offset];
+	if (length)
+	{
+		*length = cell->length;
+	}
+
+	return cell->null ? DBVal_Null : DBVal_Data;
+}
+
+DBResult DBResultChunk::CopyBlob(unsigned int columnId, void *buffer, size_t maxlength, size_t *written)
+{
+	const Cell *cell = GetCell(columnId);
+	if (!cell)
+	{
+		return DBVal_Error;
+	}
+
+	size_t toCopy = (cell->length > maxlength) ? maxlength : cell->length;
+	if (buffer && toCopy)
+	{
+		memcpy(buffer, &m_Data[cell->offset], toCopy);
+	}
+	if (written)
+	{
+		*written = toCopy;
+	}
+
+	return cell->null ? DBVal_Null : DBVal_Data;
+}
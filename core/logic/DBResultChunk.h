@@ -0,0 +1,117 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_SOURCEMOD_DB_RESULT_CHUNK_H_
+#define _INCLUDE_SOURCEMOD_DB_RESULT_CHUNK_H_
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <IDBDriver.h>
+
+using namespace SourceMod;
+
+/**
+ * A self-contained block of rows copied out of an IResultStream, so that a
+ * streamed query can be handed to the main thread a piece at a time while the
+ * worker keeps reading.  Values are kept as text, the way MySQL returns
+ * unprepared results; GetInt() and GetFloat() parse them on demand.
+ */
+class DBResultChunk :
+	public IQuery,
+	public IResultSet,
+	public IResultRow
+{
+public:
+	DBResultChunk(IResultSet *source, unsigned int affectedRows, unsigned int insertId);
+public:
+	/* Copies the source's current row; returns false if none is available. */
+	bool CopyRow(IResultSet *source);
+	/* Reads up to maxRows rows from the source and returns how many were copied. */
+	unsigned int Fill(IResultSet *source, unsigned int maxRows);
+	inline size_t GetMemoryUsage() const
+	{
+		return m_Data.size() + m_Cells.size() * sizeof(Cell);
+	}
+	inline unsigned int GetAffectedRows() const
+	{
+		return m_AffectedRows;
+	}
+	inline unsigned int GetInsertID() const
+	{
+		return m_InsertID;
+	}
+public: //IQuery
+	IResultSet *GetResultSet();
+	bool FetchMoreResults();
+	void Destroy();
+public: //IResultSet
+	unsigned int GetRowCount();
+	unsigned int GetFieldCount();
+	const char *FieldNumToName(unsigned int columnId);
+	bool FieldNameToNum(const char *name, unsigned int *columnId);
+	bool MoreRows();
+	IResultRow *FetchRow();
+	IResultRow *CurrentRow();
+	bool Rewind();
+	DBType GetFieldType(unsigned int field);
+	DBType GetFieldDataType(unsigned int field);
+public: //IResultRow
+	DBResult GetString(unsigned int columnId, const char **pString, size_t *length);
+	DBResult CopyString(unsigned int columnId, char *buffer, size_t maxlength, size_t *written);
+	DBResult GetFloat(unsigned int columnId, float *pFloat);
+	DBResult GetInt(unsigned int columnId, int *pInt);
+	bool IsNull(unsigned int columnId);
+	size_t GetDataSize(unsigned int columnId);
+	DBResult GetBlob(unsigned int columnId, const void **pData, size_t *length);
+	DBResult CopyBlob(unsigned int columnId, void *buffer, size_t maxlength, size_t *written);
+private:
+	struct Cell
+	{
+		size_t offset;
+		size_t length;
+		bool null;
+	};
+	const Cell *GetCell(unsigned int columnId);
+private:
+	std::vector<std::string> m_Names;
+	std::vector<DBType> m_Types;
+	std::vector<DBType> m_DataTypes;
+	std::vector<Cell> m_Cells;
+	std::string m_Data;
+	unsigned int m_ColCount;
+	unsigned int m_RowCount;
+	unsigned int m_CurRow;
+	unsigned int m_AffectedRows;
+	unsigned int m_InsertID;
+};
+
+#endif //_INCLUDE_SOURCEMOD_DB_RESULT_CHUNK_H_
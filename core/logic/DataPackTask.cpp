@@ -0,0 +1,159 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "common_logic.h"
+#include "CDataPack.h"
+#include "DataPackTask.h"
+#include "ThreadPool.h"
+
+/* Owns the lent contents while the task runs; gives them back on completion. */
+class DataPackLoan final
+	: public IThreadTask,
+	  public IDataPackBuffer
+{
+public:
+	DataPackLoan(CDataPack *pack, IDataPackTask *task)
+	 : pack_(pack),
+	   task_(task)
+	{
+		pack_->Lend(loan_);
+	}
+
+	/* Only used when the pool refused the task. */
+	void Cancel()
+	{
+		pack_->Return(loan_);
+		delete this;
+	}
+
+public: // IThreadTask
+	const char *GetTaskType() override
+	{
+		return task_->GetTaskType();
+	}
+	void RunTask() override
+	{
+		task_->RunTask(this);
+	}
+	void OnTaskComplete(bool cancelled) override
+	{
+		pack_->Return(loan_);
+		if (pack_->IsOrphaned())
+			CDataPack::Free(pack_);
+
+		IDataPackTask *task = task_;
+		delete this;
+		task->OnTaskComplete(cancelled);
+	}
+
+public: // IDataPackBuffer
+	void Reset() override
+	{
+		loan_.Reset();
+	}
+	void Clear() override
+	{
+		loan_.ResetSize();
+	}
+	bool IsReadable() override
+	{
+		return loan_.IsReadable();
+	}
+	bool ReadCell(cell_t *value) override
+	{
+		if (!loan_.IsReadable() || loan_.GetCurrentType() != CDataPackType::Cell)
+			return false;
+		*value = loan_.ReadCell();
+		return true;
+	}
+	bool ReadFloat(float *value) override
+	{
+		if (!loan_.IsReadable() || loan_.GetCurrentType() != CDataPackType::Float)
+			return false;
+		*value = loan_.ReadFloat();
+		return true;
+	}
+	const char *ReadString(size_t *length) override
+	{
+		return loan_.ReadString(length);
+	}
+	const cell_t *ReadCellArray(size_t *count) override
+	{
+		cell_t size;
+		const cell_t *cells = loan_.ReadCellArray(&size);
+		if (count)
+			*count = size_t(size);
+		return cells;
+	}
+	void PackCell(cell_t value) override
+	{
+		loan_.PackCell(value);
+	}
+	void PackFloat(float value) override
+	{
+		loan_.PackFloat(value);
+	}
+	void PackString(const char *string) override
+	{
+		loan_.PackString(string);
+	}
+	void PackCellArray(const cell_t *values, size_t count) override
+	{
+		loan_.PackCellArray(values, cell_t(count));
+	}
+
+private:
+	CDataPack *pack_;
+	IDataPackTask *task_;
+	CDataPack loan_;
+};
+
+bool AddDataPackTask(IdentityToken_t *owner, Handle_t hndl, IdentityToken_t *packOwner,
+	IDataPackTask *task, HandleError *err)
+{
+	HandleSecurity sec(packOwner, g_pCoreIdent);
+	CDataPack *pack;
+
+	HandleError herr = handlesys->ReadHandle(hndl, g_DataPackType, &sec, (void **)&pack);
+	if (err)
+		*err = herr;
+	if (herr != HandleError_None || !task || pack->IsLent())
+		return false;
+
+	DataPackLoan *loan = new DataPackLoan(pack, task);
+	if (!g_ThreadPool.AddTask(owner, loan))
+	{
+		loan->Cancel();
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,50 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_SOURCEMOD_DATAPACK_TASK_H_
+#define _INCLUDE_SOURCEMOD_DATAPACK_TASK_H_
+
+#include <IHandleSys.h>
+#include <IThreader.h>
+
+using namespace SourceMod;
+
+extern HandleType_t g_DataPackType;
+
+/**
+ * Implements IThreader::AddDataPackTask: moves a pack's contents into a loan, 
+ * runs the task on the shared pool and puts the contents back before the 
+ * task's completion callback.
+ */
+bool AddDataPackTask(IdentityToken_t *owner, Handle_t hndl, IdentityToken_t *packOwner,
+	IDataPackTask *task, HandleError *err);
+
+#endif //_INCLUDE_SOURCEMOD_DATAPACK_TASK_H_
@@ -34,8 +34,11 @@
 #include "HandleSys.h"
 #include "ExtensionSys.h"
 #include "PluginSys.h"
+#include "FrameScheduler.h"
+#include "ProfileTools.h"
 #include <chrono>
 #include <amtl/am-thread.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <IThreader.h>
 #include <bridge/include/ILogger.h>
@@ -50,14 +53,26 @@ using namespace std::chrono_literals;
 DBManager g_DBMan;
 
 DBManager::DBManager() 
-	: m_Terminate(false),
+	: m_WorkerCount(DB_DEFAULT_WORKER_THREADS),
+	  m_NextWorker(0),
+	  m_ThinkBudget(DB_DEFAULT_THINK_BUDGET),
+	  m_Terminate(false),
+	  m_QueryCacheBytes(0),
+	  m_QueryCacheHits(0),
+	  m_QueryCacheMisses(0),
+	  m_ConfigsLoaded(false),
 	  m_pDefault(NULL)
 {
 }
 
 static void FrameHook(bool simulating)
 {
+	bool scoped = g_ProfileToolManager.IsActive();
+	if (scoped)
+		g_ProfileToolManager.EnterScope("database", "think");
 	g_DBMan.RunFrame();
+	if (scoped)
+		g_ProfileToolManager.LeaveScope();
 }
 
 void DBManager::OnSourceModAllInitialized()
@@ -81,26 +96,112 @@ void DBManager::OnSourceModAllInitialized()
 	g_pSM->AddGameFrameHook(&FrameHook);
 
 	auto sm_reload_databases = [this] (int client, const ICommandArgs *args) -> bool {
-		m_Builder.StartParse();
+		ReloadConfigs();
 		return true;
 	};
 	bridge->DefineCommand("sm_reload_databases", "Reparse database configurations file", sm_reload_databases);
+
+	rootmenu->AddRootConsoleCommand3("db", "Database worker statistics", this);
+}
+
+void DBManager::DeferredReloadConfigs(void *data)
+{
+	((DBManager *)data)->ReloadConfigs();
 }
 
 void DBManager::OnSourceModLevelChange(const char *mapName)
+{
+	/* Connections keep using the current entries until the reload runs. */
+	if (m_ConfigsLoaded && g_FrameScheduler.DeferLevelWork())
+	{
+		g_FrameScheduler.CancelTasks(g_pCoreIdent, DeferredReloadConfigs);
+		g_FrameScheduler.AddTask(g_pCoreIdent, FrameTask_Normal, DeferredReloadConfigs, this);
+		return;
+	}
+
+	ReloadConfigs();
+}
+
+void DBManager::ReloadConfigs()
 {
 	m_Builder.StartParse();
+	m_ConfigsLoaded = true;
+
+	/* Pools survive a reload only if their entry is unchanged. */
+	ConfDbInfoList &list = m_Builder.GetConfigList();
+	std::vector<ke::RefPtr<ConnectionPool>> stale;
+	{
+		std::lock_guard<std::mutex> lock(m_PoolLock);
+		for (auto iter = m_Pools.begin(); iter != m_Pools.end(); )
+		{
+			ke::RefPtr<ConfDbInfo> info = list.GetDatabaseConf(iter->first.c_str());
+			if (!info || !iter->second->Matches(info))
+			{
+				stale.push_back(iter->second);
+				iter = m_Pools.erase(iter);
+			} else {
+				iter++;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < stale.size(); i++)
+	{
+		stale[i]->Retire();
+	}
 }
 
 void DBManager::OnSourceModShutdown()
 {
+	rootmenu->RemoveRootConsoleCommand("db", this);
 	g_pSM->RemoveGameFrameHook(&FrameHook);
 	KillWorkerThread();
+	RetirePools(NULL);
+	PurgeQueryCache(NULL, false);
 	g_PluginSys.RemovePluginsListener(this);
 	g_HandleSys.RemoveType(m_DatabaseType, g_pCoreIdent);
 	g_HandleSys.RemoveType(m_DriverType, g_pCoreIdent);
 }
 
+ConfigResult DBManager::OnSourceModConfigChanged(const char *key,
+												 const char *value,
+												 ConfigSource source,
+												 char *error,
+												 size_t maxlength)
+{
+	if (strcmp(key, "DBWorkerThreads") == 0)
+	{
+		int count = atoi(value);
+		if (count < 1 || count > DB_MAX_WORKER_THREADS)
+		{
+			ke::SafeSprintf(error, maxlength, "Invalid value: must be between 1 and %d", DB_MAX_WORKER_THREADS);
+			return ConfigResult_Reject;
+		}
+
+		/* Connections are pinned by worker index, so the pool has to be 
+		 * drained before it can be resized.  Workers restart on demand.
+		 */
+		if ((unsigned int)count != m_WorkerCount)
+		{
+			KillWorkerThread();
+			m_WorkerCount = count;
+		}
+		return ConfigResult_Accept;
+	}
+	else if (strcmp(key, "DBThinkBudget") == 0)
+	{
+		int budget = atoi(value);
+		if (budget < 0)
+		{
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be 0 or a positive number of microseconds");
+			return ConfigResult_Reject;
+		}
+		m_ThinkBudget = budget;
+		return ConfigResult_Accept;
+	}
+	return ConfigResult_Ignore;
+}
+
 unsigned int DBManager::GetInterfaceVersion()
 {
 	return SMINTERFACE_DBI_VERSION;
@@ -166,7 +267,7 @@ bool DBManager::Connect(const char *name, IDBDriver **pdr, IDatabase **pdb, bool
 		{
 			*pdr = pInfo->realDriver;
 		}
-		*pdb = pInfo->realDriver->Connect(&pInfo->info, persistent, error, maxlength);
+		*pdb = ConnectConf(pInfo, pInfo->realDriver, persistent, error, maxlength);
 		return (*pdb != NULL);
 	}
 
@@ -180,6 +281,153 @@ bool DBManager::Connect(const char *name, IDBDriver **pdr, IDatabase **pdb, bool
 	return false;
 }
 
+IDatabase *DBManager::ConnectConf(const ke::RefPtr<ConfDbInfo> &info, IDBDriver *driver, bool persistent,
+	char *error, size_t maxlength)
+{
+	/* Persistent connections are already shared by the driver. */
+	if (persistent || !info->poolMaxIdle)
+	{
+		return driver->Connect(&info->info, persistent, error, maxlength);
+	}
+
+	ke::RefPtr<ConnectionPool> pool;
+	{
+		std::lock_guard<std::mutex> lock(m_PoolLock);
+		auto iter = m_Pools.find(info->name);
+		if (iter != m_Pools.end() && iter->second->GetDriver() == driver && iter->second->Matches(info))
+		{
+			pool = iter->second;
+		} else {
+			pool = new ConnectionPool(info, driver);
+			m_Pools[info->name] = pool;
+		}
+	}
+
+	return pool->Acquire(error, maxlength);
+}
+
+void DBManager::RetirePools(IDBDriver *driver)
+{
+	std::vector<ke::RefPtr<ConnectionPool>> retired;
+	{
+		std::lock_guard<std::mutex> lock(m_PoolLock);
+		for (auto iter = m_Pools.begin(); iter != m_Pools.end(); )
+		{
+			if (!driver || iter->second->GetDriver() == driver)
+			{
+				retired.push_back(iter->second);
+				iter = m_Pools.erase(iter);
+			} else {
+				iter++;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < retired.size(); i++)
+	{
+		retired[i]->Retire();
+	}
+}
+
+class TPoolMaintenanceOp : public IDBThreadOperation
+{
+public:
+	TPoolMaintenanceOp(ConnectionPool *pool)
+	 : m_pPool(pool)
+	{
+	}
+	IdentityToken_t *GetOwner()
+	{
+		return g_pCoreIdent;
+	}
+	IDBDriver *GetDriver()
+	{
+		return m_pPool->GetDriver();
+	}
+	void RunThreadPart()
+	{
+		m_pPool->Maintain();
+	}
+	void RunThinkPart()
+	{
+	}
+	void CancelThinkPart()
+	{
+	}
+	void Destroy()
+	{
+		delete this;
+	}
+private:
+	ke::RefPtr<ConnectionPool> m_pPool;
+};
+
+void DBManager::MaintainPools()
+{
+	std::vector<ke::RefPtr<ConnectionPool>> pools;
+	{
+		std::lock_guard<std::mutex> lock(m_PoolLock);
+		for (auto iter = m_Pools.begin(); iter != m_Pools.end(); iter++)
+		{
+			pools.push_back(iter->second);
+		}
+	}
+
+	for (size_t i = 0; i < pools.size(); i++)
+	{
+		if (!pools[i]->BeginMaintenance())
+		{
+			continue;
+		}
+
+		/* Pings and reconnects block, so they belong on a worker. */
+		TPoolMaintenanceOp *op = new TPoolMaintenanceOp(pools[i]);
+		if (!AddToThreadQueue(op, PrioQueue_Low))
+		{
+			op->RunThreadPart();
+			op->Destroy();
+		}
+	}
+}
+
+void DBManager::ListPools()
+{
+	std::vector<ke::RefPtr<ConnectionPool>> pools;
+	{
+		std::lock_guard<std::mutex> lock(m_PoolLock);
+		for (auto iter = m_Pools.begin(); iter != m_Pools.end(); iter++)
+		{
+			pools.push_back(iter->second);
+		}
+	}
+
+	if (pools.empty())
+	{
+		rootmenu->ConsolePrint("[SM] No connection pools are open (set \"pool_max_idle\" in databases.cfg).");
+		return;
+	}
+
+	rootmenu->ConsolePrint("[SM] Listing %d connection pool(s):", (int)pools.size());
+	rootmenu->ConsolePrint("  %-20.20s %-8.8s %5s %6s %8s %8s %7s %9s %5s %8s",
+		"Name", "Driver", "Idle", "Leased", "Created", "Reused", "Reaped", "ConnFails", "Pings", "Backoff");
+	for (size_t i = 0; i < pools.size(); i++)
+	{
+		DBPoolStats stats;
+		pools[i]->GetStats(&stats);
+		rootmenu->ConsolePrint("  %-20.20s %-8.8s %5u %6u %8llu %8llu %7llu %9llu %5llu %7us",
+			pools[i]->GetName(),
+			pools[i]->GetDriver()->GetIdentifier(),
+			stats.idle,
+			stats.leased,
+			(unsigned long long)stats.created,
+			(unsigned long long)stats.reused,
+			(unsigned long long)stats.reaped,
+			(unsigned long long)stats.connectFailures,
+			(unsigned long long)stats.pingFailures,
+			stats.backoff);
+	}
+}
+
 void DBManager::AddDriver(IDBDriver *pDriver)
 {
 	 /* Let's kill the worker.  Join the thread and let the queries flush.
@@ -209,6 +457,9 @@ void DBManager::RemoveDriver(IDBDriver *pDriver)
 		}
 	}
 
+	RetirePools(pDriver);
+	PurgeQueryCache(pDriver, false);
+
 	ConfDbInfoList &list = m_Builder.GetConfigList();
 	for (auto conf : list) {
 		if (conf->realDriver == pDriver)
@@ -373,21 +624,75 @@ IDBDriver *DBManager::FindOrLoadDriver(const char *name)
 
 void DBManager::KillWorkerThread()
 {
-	if (m_Worker)
+	if (m_Workers.empty())
+	{
+		return;
+	}
+
 	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		m_Terminate = true;
+		for (size_t i = 0; i < m_Workers.size(); i++)
 		{
-			std::lock_guard<std::mutex> lock(m_Lock);
-			m_Terminate = true;
-			m_QueueEvent.notify_all();
+			m_Workers[i]->event.notify_all();
 		}
-		m_Worker->join();
-		m_Worker = nullptr;
-		m_Terminate = false;
 	}
+	for (size_t i = 0; i < m_Workers.size(); i++)
+	{
+		if (m_Workers[i]->thread)
+		{
+			m_Workers[i]->thread->join();
+		}
+	}
+	m_Workers.clear();
+	m_Terminate = false;
 }
 
 static IdentityToken_t *s_pAddBlock = NULL;
 
+DBWorker *DBManager::GetWorker(unsigned int index)
+{
+	if (m_Workers.empty())
+	{
+		for (unsigned int i = 0; i < m_WorkerCount; i++)
+		{
+			m_Workers.emplace_back(new DBWorker);
+			m_Workers.back()->index = i;
+		}
+	}
+
+	DBWorker *worker = m_Workers[index % m_Workers.size()].get();
+	if (!worker->thread)
+	{
+		char name[32];
+		ke::SafeSprintf(name, sizeof(name), "SM Database Worker %u", worker->index);
+		worker->thread = ke::NewThread(name, [this, worker]() -> void {
+			Run(worker);
+		});
+	}
+	return worker;
+}
+
+DBWorker *DBManager::GetConnectionWorker(IDatabase *db)
+{
+	/* Fibonacci hash of the connection pointer; the low bits are just 
+	 * allocator alignment.  Every entry point must pick workers through 
+	 * here, or one connection could end up being used by two threads.
+	 */
+	uint64_t key = (uint64_t)(uintptr_t)db;
+	return GetWorker((unsigned int)((key * 0x9E3779B97F4A7C15ULL) >> 32));
+}
+
+bool DBManager::QueueOperation(DBWorker *worker, IDBThreadOperation *op, PrioQueueLevel prio)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	Queue<IDBThreadOperation *> &queue = worker->queue.GetQueue(prio);
+	queue.push(op);
+	m_Counters.queued.fetch_add(1, std::memory_order_relaxed);
+	worker->event.notify_one();
+	return true;
+}
+
 bool DBManager::AddToThreadQueue(IDBThreadOperation *op, PrioQueueLevel prio)
 {
 	if (s_pAddBlock && op->GetOwner() == s_pAddBlock)
@@ -395,48 +700,53 @@ bool DBManager::AddToThreadQueue(IDBThreadOperation *op, PrioQueueLevel prio)
 		return false;
 	}
 
-	if (!m_Worker)
+	/* The operation cannot tell us its connection, so all of these keep 
+	 * their relative order by sharing the worker a NULL connection hashes 
+	 * to.  Callers that know their connection use AddToConnectionQueue().
+	 */
+	return QueueOperation(GetConnectionWorker(NULL), op, prio);
+}
+
+bool DBManager::AddToConnectionQueue(IDBThreadOperation *op, PrioQueueLevel prio, IDatabase *db)
+{
+	if (s_pAddBlock && op->GetOwner() == s_pAddBlock)
 	{
-		m_Worker = ke::NewThread("SM Database Worker", [this]() -> void {
-			Run();
-		});
+		return false;
 	}
 
-	/* Add to the queue */
+	/* Operations that are not bound to a connection yet may run anywhere. */
+	if (!db)
 	{
-		std::lock_guard<std::mutex> lock(m_Lock);
-		Queue<IDBThreadOperation *> &queue = m_OpQueue.GetQueue(prio);
-		queue.push(op);
-		m_QueueEvent.notify_one();
+		return QueueOperation(GetWorker(m_NextWorker++), op, prio);
 	}
 
-	return true;
+	return QueueOperation(GetConnectionWorker(db), op, prio);
 }
 
-void DBManager::Run()
+void DBManager::Run(DBWorker *worker)
 {
 	// Initialize DB threadsafety.
 	for (size_t i=0; i < m_drivers.size(); i++)
 	{
 		if (m_drivers[i]->IsThreadSafe())
-			m_drSafety.push_back(m_drivers[i]->InitializeThreadSafety());
+			worker->drSafety.push_back(m_drivers[i]->InitializeThreadSafety());
 		else
-			m_drSafety.push_back(false);
+			worker->drSafety.push_back(false);
 	}
 
 	// Run actual worker thread logic.
-	ThreadMain();
+	ThreadMain(worker);
 
 	// Shutdown DB threadsafety.
 	for (size_t i=0; i<m_drivers.size(); i++)
 	{
-		if (m_drSafety[i])
+		if (worker->drSafety[i])
 			m_drivers[i]->ShutdownThreadSafety();
 	}
-	m_drSafety.clear();
+	worker->drSafety.clear();
 }
 
-void DBManager::ThreadMain()
+void DBManager::ThreadMain(DBWorker *worker)
 {
 	std::unique_lock<std::mutex> lock(m_Lock);
 
@@ -446,19 +756,20 @@ void DBManager::ThreadMain()
 		// we process all operations we can before checking to terminate.
 		// There's no risk of starvation since the main thread blocks on us
 		// terminating.
-		auto queue = &m_OpQueue.GetLikelyQueue();
+		auto queue = &worker->queue.GetLikelyQueue();
 		if (queue->empty()) {
 			// If the queue is empty and we've been asked to stop, leave now.
 			if (m_Terminate)
 				return;
 
 			// Otherwise, wait for something to happen.
-			m_QueueEvent.wait(lock);
+			worker->event.wait(lock);
 			continue;
 		}
 
 		IDBThreadOperation *op = queue->first();
 		queue->pop();
+		m_Counters.queued.fetch_sub(1, std::memory_order_relaxed);
 
 		// Unlock the queue when we run the query, so the main thread can
 		// keep pumping events. We re-acquire the lock to check for more
@@ -467,15 +778,20 @@ void DBManager::ThreadMain()
 		// anyway, so after we've depleted the queue here, we'll just
 		// reach the terminate at the top of the loop.
 		lock.unlock();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 		op->RunThreadPart();
+		uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+		m_Counters.executed.fetch_add(1, std::memory_order_relaxed);
+		m_Counters.totalTime.fetch_add(us, std::memory_order_relaxed);
+		uint64_t peak = m_Counters.peakTime.load(std::memory_order_relaxed);
+		while (us > peak && !m_Counters.peakTime.compare_exchange_weak(peak, us, std::memory_order_relaxed))
+			;
 
 		// Re-acquire the lock and give the data back to the main thread
 		// immediately. We use a separate lock to minimize game thread
 		// contention.
-		{
-			std::lock_guard<std::mutex> think_lock(m_ThinkLock);
-			m_ThinkQueue.push(op);
-		}
+		AddToThinkQueue(op);
 
 		// Note that we add a 20ms delay after processing a query. This is
 		// questionable but the intent is to avoid starving the game thread.
@@ -486,23 +802,237 @@ void DBManager::ThreadMain()
 	}
 }
 
+void DBManager::GetQueueDepths(size_t *workers, size_t *think)
+{
+	int64_t queued = m_Counters.queued.load(std::memory_order_relaxed);
+	*workers = queued > 0 ? (size_t)queued : 0;
+
+	std::lock_guard<std::mutex> lock(m_ThinkLock);
+	*think = m_ThinkQueue.size();
+}
+
+void DBManager::AddToThinkQueue(IDBThreadOperation *op)
+{
+	std::lock_guard<std::mutex> think_lock(m_ThinkLock);
+	m_ThinkQueue.push(op);
+}
+
 void DBManager::RunFrame()
 {
-	/* Don't bother if we're empty */
-	if (!m_ThinkQueue.size())
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (now >= m_NextPoolCheck)
+	{
+		m_NextPoolCheck = now + 1s;
+		MaintainPools();
+		PurgeQueryCache(NULL, true);
+	}
+
+	/* Don't bother if we're empty; workers push under the lock, so even 
+	 * this peek needs it.
+	 */
+	{
+		std::lock_guard<std::mutex> lock(m_ThinkLock);
+		if (m_ThinkQueue.empty())
+		{
+			return;
+		}
+	}
+
+	/* Finish operations until the frame budget is used up; whatever is left 
+	 * carries over to the next frame.  At least one operation always runs, 
+	 * so a budget of 0 finishes exactly one per frame.
+	 */
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	uint64_t elapsed = 0;
+	bool pending = true;
+	while (pending)
+	{
+		IDBThreadOperation *op;
+		{
+			std::lock_guard<std::mutex> lock(m_ThinkLock);
+			if (m_ThinkQueue.empty())
+			{
+				break;
+			}
+			if (m_ThinkQueue.size() > m_ThinkStats.peakDepth)
+			{
+				m_ThinkStats.peakDepth = m_ThinkQueue.size();
+			}
+			op = m_ThinkQueue.first();
+			m_ThinkQueue.pop();
+		}
+		op->RunThinkPart();
+		op->Destroy();
+		m_ThinkStats.completed++;
+
+		elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+		pending = (elapsed < m_ThinkBudget);
+	}
+
+	m_ThinkStats.busyFrames++;
+	m_ThinkStats.totalTime += elapsed;
+	if (elapsed > m_ThinkStats.peakFrameTime)
+	{
+		m_ThinkStats.peakFrameTime = elapsed;
+	}
+	if (!pending)
+	{
+		std::lock_guard<std::mutex> lock(m_ThinkLock);
+		if (!m_ThinkQueue.empty())
+		{
+			m_ThinkStats.overBudget++;
+		}
+	}
+}
+
+DBResultChunk *DBManager::FindCachedQuery(IDatabase *db, const std::string &query)
+{
+	auto iter = m_QueryCache.find(std::make_pair(db, query));
+	if (iter == m_QueryCache.end())
+	{
+		m_QueryCacheMisses++;
+		return NULL;
+	}
+
+	if (std::chrono::steady_clock::now() >= iter->second.expires)
+	{
+		EraseCachedQuery(iter);
+		m_QueryCacheMisses++;
+		return NULL;
+	}
+
+	m_QueryCacheHits++;
+
+	DBResultChunk *copy = new DBResultChunk(*iter->second.snapshot);
+	copy->Rewind();
+	return copy;
+}
+
+void DBManager::CacheQuery(IDatabase *db, const std::string &query, DBResultChunk *snapshot, unsigned int ttl)
+{
+	size_t size = snapshot->GetMemoryUsage() + query.size();
+
+	/* One huge result shouldn't push everything else out. */
+	if (size > DB_QUERY_CACHE_MAX_BYTES / 4)
+	{
+		delete snapshot;
+		return;
+	}
+
+	auto key = std::make_pair(db, query);
+	auto iter = m_QueryCache.find(key);
+	if (iter != m_QueryCache.end())
+	{
+		EraseCachedQuery(iter);
+	}
+
+	/* Make room by dropping whatever would expire soonest. */
+	while (m_QueryCacheBytes + size > DB_QUERY_CACHE_MAX_BYTES && !m_QueryCache.empty())
+	{
+		auto victim = m_QueryCache.begin();
+		for (auto it = m_QueryCache.begin(); it != m_QueryCache.end(); it++)
+		{
+			if (it->second.expires < victim->second.expires)
+			{
+				victim = it;
+			}
+		}
+		EraseCachedQuery(victim);
+	}
+
+	DBCachedQuery &entry = m_QueryCache[key];
+	entry.snapshot.reset(snapshot);
+	entry.expires = std::chrono::steady_clock::now() + std::chrono::seconds(ttl);
+	m_QueryCacheBytes += size;
+	db->IncReferenceCount();
+}
+
+unsigned int DBManager::InvalidateCachedQueries(IDatabase *db, const char *query)
+{
+	if (query && query[0] != '\0')
+	{
+		auto iter = m_QueryCache.find(std::make_pair(db, std::string(query)));
+		if (iter == m_QueryCache.end())
+		{
+			return 0;
+		}
+		EraseCachedQuery(iter);
+		return 1;
+	}
+
+	unsigned int count = 0;
+	auto iter = m_QueryCache.lower_bound(std::make_pair(db, std::string()));
+	while (iter != m_QueryCache.end() && iter->first.first == db)
+	{
+		auto next = std::next(iter);
+		EraseCachedQuery(iter);
+		iter = next;
+		count++;
+	}
+	return count;
+}
+
+void DBManager::EraseCachedQuery(std::map<std::pair<IDatabase *, std::string>, DBCachedQuery>::iterator iter)
+{
+	IDatabase *db = iter->first.first;
+	m_QueryCacheBytes -= iter->second.snapshot->GetMemoryUsage() + iter->first.second.size();
+	m_QueryCache.erase(iter);
+	db->Close();
+}
+
+void DBManager::PurgeQueryCache(IDBDriver *driver, bool expiredOnly)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	for (auto iter = m_QueryCache.begin(); iter != m_QueryCache.end(); )
 	{
+		auto next = std::next(iter);
+		if ((!driver || iter->first.first->GetDriver() == driver)
+			&& (!expiredOnly || now >= iter->second.expires))
+		{
+			EraseCachedQuery(iter);
+		}
+		iter = next;
+	}
+}
+
+void DBManager::OnRootConsoleCommand(const char *cmdname, const ICommandArgs *command)
+{
+	if (command->ArgC() >= 3 && strcmp(command->Arg(2), "reset") == 0)
+	{
+		m_ThinkStats.Reset();
+		rootmenu->ConsolePrint("[SM] Database statistics have been reset.");
+		return;
+	}
+	if (command->ArgC() >= 3 && strcmp(command->Arg(2), "pools") == 0)
+	{
+		ListPools();
 		return;
 	}
 
-	/* Dump one thing per-frame so the server stays sane. */
-	IDBThreadOperation *op;
+	size_t depth;
 	{
 		std::lock_guard<std::mutex> lock(m_ThinkLock);
-		op = m_ThinkQueue.first();
-		m_ThinkQueue.pop();
+		depth = m_ThinkQueue.size();
 	}
-	op->RunThinkPart();
-	op->Destroy();
+
+	const DBThinkStats &stats = m_ThinkStats;
+	rootmenu->ConsolePrint("[SM] Database workers: %u configured, %u started", m_WorkerCount, (unsigned int)m_Workers.size());
+	rootmenu->ConsolePrint("  Think budget:         %u us per frame", m_ThinkBudget);
+	rootmenu->ConsolePrint("  Think queue depth:    %u (peak %u)", (unsigned int)depth, (unsigned int)stats.peakDepth);
+	rootmenu->ConsolePrint("  Completed operations: %llu", (unsigned long long)stats.completed);
+	rootmenu->ConsolePrint("  Busy frames:          %llu (%llu ended over budget)",
+		(unsigned long long)stats.busyFrames,
+		(unsigned long long)stats.overBudget);
+	rootmenu->ConsolePrint("  Think time:           %llu us total, %.1f us per busy frame, %llu us peak",
+		(unsigned long long)stats.totalTime,
+		stats.busyFrames ? (double)stats.totalTime / stats.busyFrames : 0.0,
+		(unsigned long long)stats.peakFrameTime);
+	rootmenu->ConsolePrint("  Query cache:          %u entries, %u bytes, %llu hits, %llu misses",
+		(unsigned int)m_QueryCache.size(),
+		(unsigned int)m_QueryCacheBytes,
+		(unsigned long long)m_QueryCacheHits,
+		(unsigned long long)m_QueryCacheMisses);
+	rootmenu->ConsolePrint("  Use \"sm db pools\" to list connection pools.");
 }
 
 void DBManager::OnSourceModIdentityDropped(IdentityToken_t *pToken)
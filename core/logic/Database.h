@@ -33,27 +33,106 @@
 #define _INCLUDE_DATABASE_MANAGER_H_
 
 #include "common_logic.h"
+#include <stdint.h>
+#include <atomic>
 #include <sh_vector.h>
 #include <am-string.h>
 #include <sh_list.h>
 #include <IThreader.h>
 #include <IPluginSys.h>
+#include <IRootConsoleMenu.h>
 #include <condition_variable>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 #include "sm_simple_prioqueue.h"
 #include <am-refcounting.h>
 #include "DatabaseConfBuilder.h"
+#include "DatabasePool.h"
+#include "DBResultChunk.h"
 
 using namespace SourceHook;
 
+#define DB_DEFAULT_WORKER_THREADS	4
+#define DB_MAX_WORKER_THREADS		32
+#define DB_DEFAULT_THINK_BUDGET		1000		/* microseconds */
+#define DB_QUERY_CACHE_MAX_BYTES	(8 * 1024 * 1024)
+
+/**
+ * Counters for the game-thread side of threaded operations.
+ */
+struct DBThinkStats
+{
+	DBThinkStats()
+	{
+		Reset();
+	}
+	void Reset()
+	{
+		completed = 0;
+		busyFrames = 0;
+		overBudget = 0;
+		totalTime = 0;
+		peakFrameTime = 0;
+		peakDepth = 0;
+	}
+	uint64_t completed;			/* operations whose think part has run */
+	uint64_t busyFrames;		/* frames that had at least one operation to finish */
+	uint64_t overBudget;		/* frames that ended with work still queued */
+	uint64_t totalTime;			/* microseconds spent in think parts */
+	uint64_t peakFrameTime;		/* microseconds, worst single frame */
+	size_t peakDepth;			/* largest think queue seen at the start of a frame */
+};
+
+/**
+ * Worker-side counters, updated without locks so the metrics exporter can 
+ * read them from the game thread at any time.
+ */
+struct DBWorkerCounters
+{
+	std::atomic<int64_t> queued{0};			/* operations waiting for a worker */
+	std::atomic<uint64_t> executed{0};		/* thread parts run */
+	std::atomic<uint64_t> totalTime{0};		/* microseconds spent in thread parts */
+	std::atomic<uint64_t> peakTime{0};		/* microseconds, slowest thread part since last read */
+};
+
+/**
+ * A single database worker thread.  Every connection is pinned to one 
+ * worker so its operations stay in order, while different connections can 
+ * run in parallel.  All queues are guarded by DBManager::m_Lock.
+ */
+struct DBWorker
+{
+	DBWorker() : index(0)
+	{
+	}
+	unsigned int index;
+	PrioQueue<IDBThreadOperation *> queue;
+	std::unique_ptr<std::thread> thread;
+	std::condition_variable event;
+	CVector<bool> drSafety;			/* which drivers are safe? */
+};
+
+/**
+ * A cached result for Database.QueryCached.  The snapshot is never modified;
+ * each hit gets its own copy to walk through.  The entry holds a reference to
+ * its connection so the key can't be reused by another one while it lives.
+ */
+struct DBCachedQuery
+{
+	std::shared_ptr<const DBResultChunk> snapshot;
+	std::chrono::steady_clock::time_point expires;
+};
 
 class DBManager : 
 	public IDBManager,
 	public SMGlobalClass,
 	public IHandleTypeDispatch,
-	public IPluginsListener
+	public IPluginsListener,
+	public IRootConsoleCommand
 {
 public:
 	DBManager();
@@ -64,7 +143,13 @@ public: //SMGlobalClass
 	void OnSourceModAllInitialized();
 	void OnSourceModLevelChange(const char *mapName);
 	void OnSourceModIdentityDropped(IdentityToken_t *pToken);
+	const char *GetGlobalClassName()
+	{
+		return "DBManager";
+	}
 	void OnSourceModShutdown();
+	ConfigResult OnSourceModConfigChanged(const char *key, const char *value,
+		ConfigSource source, char *error, size_t maxlength);
 public: //IHandleTypeDispatch
 	void OnHandleDestroy(HandleType_t type, void *object);
 public: //IDBManager
@@ -73,47 +158,90 @@ public: //IDBManager
 	const DatabaseInfo *FindDatabaseConf(const char *name);
 	ke::RefPtr<ConfDbInfo> GetDatabaseConf(const char *name);
 	bool Connect(const char *name, IDBDriver **pdr, IDatabase **pdb, bool persistent, char *error, size_t maxlength);
+	/* Connects for a named configuration, through its pool if it has one. */
+	IDatabase *ConnectConf(const ke::RefPtr<ConfDbInfo> &info, IDBDriver *driver, bool persistent,
+		char *error, size_t maxlength);
 	unsigned int GetDriverCount();
 	IDBDriver *GetDriver(unsigned int index);
 	Handle_t CreateHandle(DBHandleType type, void *ptr, IdentityToken_t *pToken);
 	HandleError ReadHandle(Handle_t hndl, DBHandleType type, void **ptr);
 	HandleError ReleaseHandle(Handle_t hndl, DBHandleType type, IdentityToken_t *token);
 	void AddDependency(IExtension *myself, IDBDriver *driver);
-public: //ke::IRunnable
-	void Run();
-	void ThreadMain();
+	bool AddToConnectionQueue(IDBThreadOperation *op, PrioQueueLevel prio, IDatabase *db);
+public:
+	void Run(DBWorker *worker);
+	void ThreadMain(DBWorker *worker);
 public: //IPluginsListener
 	void OnPluginWillUnload(IPlugin *plugin);
+public: //IRootConsoleCommand
+	void OnRootConsoleCommand(const char *cmdname, const ICommandArgs *command) override;
 public:
 	IDBDriver *FindOrLoadDriver(const char *name);
 	IDBDriver *GetDefaultDriver();
 	std::string GetDefaultDriverName();
 	bool AddToThreadQueue(IDBThreadOperation *op, PrioQueueLevel prio);
+	/* Hands a finished operation to the main thread; safe to call from workers. */
+	void AddToThinkQueue(IDBThreadOperation *op);
 	void RunFrame();
+	/* Operations waiting for a worker, and finished ones waiting for the game thread. */
+	void GetQueueDepths(size_t *workers, size_t *think);
+	inline DBWorkerCounters &GetWorkerCounters()
+	{
+		return m_Counters;
+	}
+	/* Query result cache; main thread only. */
+	DBResultChunk *FindCachedQuery(IDatabase *db, const std::string &query);
+	void CacheQuery(IDatabase *db, const std::string &query, DBResultChunk *snapshot, unsigned int ttl);
+	unsigned int InvalidateCachedQueries(IDatabase *db, const char *query);
 	inline HandleType_t GetDatabaseType()
 	{
 		return m_DatabaseType;
 	}
 private:
 	void ClearConfigs();
+	void ReloadConfigs();
+	static void DeferredReloadConfigs(void *data);
 	void KillWorkerThread();
+	void RetirePools(IDBDriver *driver);
+	void MaintainPools();
+	void ListPools();
+	void PurgeQueryCache(IDBDriver *driver, bool expiredOnly);
+	void EraseCachedQuery(std::map<std::pair<IDatabase *, std::string>, DBCachedQuery>::iterator iter);
+	DBWorker *GetWorker(unsigned int index);
+	/* Worker that owns a connection; NULL maps to the legacy queue's worker. */
+	DBWorker *GetConnectionWorker(IDatabase *db);
+	bool QueueOperation(DBWorker *worker, IDBThreadOperation *op, PrioQueueLevel prio);
 private:
 	CVector<IDBDriver *> m_drivers;
 
 	/* Threading stuff */
-	PrioQueue<IDBThreadOperation *> m_OpQueue;
+	std::vector<std::unique_ptr<DBWorker>> m_Workers;
+	unsigned int m_WorkerCount;
+	unsigned int m_NextWorker;
 	Queue<IDBThreadOperation *> m_ThinkQueue;
-	CVector<bool> m_drSafety;			/* which drivers are safe? */
-	std::unique_ptr<std::thread> m_Worker;
-	std::condition_variable m_QueueEvent;
 	std::mutex m_ThinkLock;
+	unsigned int m_ThinkBudget;
+	DBThinkStats m_ThinkStats;
+	DBWorkerCounters m_Counters;
 	std::mutex m_Lock;
 	bool m_Terminate;
 
+	/* Connection pools by configuration name */
+	std::unordered_map<std::string, ke::RefPtr<ConnectionPool>> m_Pools;
+	std::mutex m_PoolLock;
+	std::chrono::steady_clock::time_point m_NextPoolCheck;
+
+	/* Cached read results by connection and query text */
+	std::map<std::pair<IDatabase *, std::string>, DBCachedQuery> m_QueryCache;
+	size_t m_QueryCacheBytes;
+	uint64_t m_QueryCacheHits;
+	uint64_t m_QueryCacheMisses;
+
 	DatabaseConfBuilder m_Builder;
 	HandleType_t m_DriverType;
 	HandleType_t m_DatabaseType;
 	char m_Filename[PLATFORM_MAX_PATH];
+	bool m_ConfigsLoaded;
 	IDBDriver *m_pDefault;
 };
 
@@ -137,6 +137,18 @@ SMCResult DatabaseConfBuilder::ReadSMC_KeyValue(const SMCStates *states, const c
 			m_ParseCurrent->info.maxTimeout = atoi(value);
 		} else if (strcmp(key, "port") == 0) {
 			m_ParseCurrent->info.port = atoi(value);
+		} else if (strcmp(key, "pool_min_idle") == 0) {
+			m_ParseCurrent->poolMinIdle = atoi(value);
+		} else if (strcmp(key, "pool_max_idle") == 0) {
+			m_ParseCurrent->poolMaxIdle = atoi(value);
+		} else if (strcmp(key, "pool_idle_timeout") == 0) {
+			m_ParseCurrent->poolIdleTimeout = atoi(value);
+		} else if (strcmp(key, "pool_ping_interval") == 0) {
+			m_ParseCurrent->poolPingInterval = atoi(value);
+		} else {
+			/* Anything else is left for the driver to interpret. */
+			m_ParseCurrent->optionStore.push_back(key);
+			m_ParseCurrent->optionStore.push_back(value);
 		}
 	}
 
@@ -158,6 +170,19 @@ SMCResult DatabaseConfBuilder::ReadSMC_LeavingSection(const SMCStates *states)
 		m_ParseCurrent->info.host = m_ParseCurrent->host.c_str();
 		m_ParseCurrent->info.user = m_ParseCurrent->user.c_str();
 		m_ParseCurrent->info.pass = m_ParseCurrent->pass.c_str();
+		if (m_ParseCurrent->poolMinIdle > m_ParseCurrent->poolMaxIdle)
+		{
+			m_ParseCurrent->poolMinIdle = m_ParseCurrent->poolMaxIdle;
+		}
+		if (!m_ParseCurrent->optionStore.empty())
+		{
+			for (size_t i = 0; i < m_ParseCurrent->optionStore.size(); i++)
+			{
+				m_ParseCurrent->options.push_back(m_ParseCurrent->optionStore[i].c_str());
+			}
+			m_ParseCurrent->options.push_back(NULL);
+			m_ParseCurrent->info.options = m_ParseCurrent->options.data();
+		}
 		
 		/* Save it.. */
 		m_ParseCurrent->AddRef();
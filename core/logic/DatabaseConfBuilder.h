@@ -41,10 +41,14 @@
 #include <am-refcounting.h>
 #include <am-refcounting-threadsafe.h>
 
+#define DB_POOL_DEFAULT_IDLE_TIMEOUT	300
+#define DB_POOL_DEFAULT_PING_INTERVAL	60
+
 class ConfDbInfo : public ke::RefcountedThreadsafe<ConfDbInfo>
 {
 public:
-	ConfDbInfo() : realDriver(NULL)
+	ConfDbInfo() : realDriver(NULL), poolMinIdle(0), poolMaxIdle(0),
+		poolIdleTimeout(DB_POOL_DEFAULT_IDLE_TIMEOUT), poolPingInterval(DB_POOL_DEFAULT_PING_INTERVAL)
 	{
 	}
 	std::string name;
@@ -55,6 +59,12 @@ public:
 	std::string database;
 	IDBDriver *realDriver;
 	DatabaseInfo info;
+	unsigned int poolMinIdle;		/* idle connections kept open ahead of time */
+	unsigned int poolMaxIdle;		/* 0 disables pooling for this entry */
+	unsigned int poolIdleTimeout;	/* seconds before surplus idle connections close */
+	unsigned int poolPingInterval;	/* seconds between health checks, 0 = never */
+	std::vector<std::string> optionStore;	/* unrecognized keys and values, for the driver */
+	std::vector<const char *> options;		/* NULL-terminated view of optionStore */
 };
 
 class ConfDbInfoList : public std::vector<ke::RefPtr<ConfDbInfo>>
@@ -0,0 +1,453 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include <string.h>
+#include <vector>
+#include "DatabasePool.h"
+#include "common_logic.h"
+#include <am-string.h>
+#include <bridge/include/ILogger.h>
+
+ConnectionPool::ConnectionPool(const ke::RefPtr<ConfDbInfo> &info, IDBDriver *driver)
+ : m_pInfo(info), m_pDriver(driver), m_Leased(0), m_Failures(0),
+   m_Retired(false), m_Maintaining(false)
+{
+	memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+ConnectionPool::~ConnectionPool()
+{
+	Retire();
+}
+
+bool ConnectionPool::Matches(const ConfDbInfo *info) const
+{
+	const ke::RefPtr<ConfDbInfo> &mine = m_pInfo;
+	return mine->driver == info->driver
+		&& mine->host == info->host
+		&& mine->database == info->database
+		&& mine->user == info->user
+		&& mine->pass == info->pass
+		&& mine->info.port == info->info.port
+		&& mine->info.maxTimeout == info->info.maxTimeout
+		&& mine->poolMinIdle == info->poolMinIdle
+		&& mine->poolMaxIdle == info->poolMaxIdle
+		&& mine->poolIdleTimeout == info->poolIdleTimeout
+		&& mine->poolPingInterval == info->poolPingInterval
+		&& mine->optionStore == info->optionStore;
+}
+
+bool ConnectionPool::InBackoff(Clock::time_point now, unsigned int *remaining)
+{
+	if (!m_Failures || now >= m_RetryAt)
+	{
+		return false;
+	}
+	if (remaining)
+	{
+		auto left = std::chrono::duration_cast<std::chrono::seconds>(m_RetryAt - now);
+		*remaining = (unsigned int)left.count() + 1;
+	}
+	return true;
+}
+
+IDatabase *ConnectionPool::Open(char *error, size_t maxlength)
+{
+	IDatabase *db = m_pDriver->Connect(&m_pInfo->info, false, error, maxlength);
+
+	std::lock_guard<std::mutex> lock(m_Lock);
+	if (!db)
+	{
+		/* 1, 2, 4, ... seconds, so a server that is down sees a trickle of
+		 * attempts instead of one per caller.
+		 */
+		unsigned int delay = 1u << (m_Failures < 5 ? m_Failures : 5);
+		if (delay > DB_POOL_MAX_BACKOFF)
+		{
+			delay = DB_POOL_MAX_BACKOFF;
+		}
+		m_Failures++;
+		m_RetryAt = Clock::now() + std::chrono::seconds(delay);
+		m_Stats.connectFailures++;
+		return NULL;
+	}
+
+	m_Failures = 0;
+	m_Stats.created++;
+	return db;
+}
+
+IDatabase *ConnectionPool::Acquire(char *error, size_t maxlength)
+{
+	IDatabase *db = NULL;
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		if (!m_Idle.empty())
+		{
+			/* Newest first, so surplus connections age out at the front. */
+			db = m_Idle.back().db;
+			m_Idle.pop_back();
+			m_Stats.reused++;
+		} else {
+			unsigned int remaining;
+			if (InBackoff(Clock::now(), &remaining))
+			{
+				ke::SafeSprintf(error, maxlength,
+					"Connection pool \"%s\" is waiting %u more second(s) before reconnecting",
+					GetName(), remaining);
+				return NULL;
+			}
+		}
+	}
+
+	if (!db && (db = Open(error, maxlength)) == NULL)
+	{
+		return NULL;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		m_Leased++;
+	}
+	return new PooledDatabase(this, db);
+}
+
+void ConnectionPool::Return(IDatabase *db, bool used, bool reusable)
+{
+	/* MySQL and PostgreSQL accept a ROLLBACK with no transaction open; where
+	 * it fails, the state of the session is unknown, so don't hand it out.
+	 */
+	if (reusable && used)
+	{
+		db->LockForFullAtomicOperation();
+		reusable = db->DoSimpleQuery("ROLLBACK");
+		db->UnlockFromFullAtomicOperation();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		m_Leased--;
+		if (reusable && !m_Retired && m_Idle.size() < m_pInfo->poolMaxIdle)
+		{
+			Clock::time_point now = Clock::now();
+			m_Idle.push_back(IdleConnection{db, now, now});
+			return;
+		}
+	}
+
+	db->Close();
+}
+
+bool ConnectionPool::BeginMaintenance()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	if (m_Maintaining || m_Retired)
+	{
+		return false;
+	}
+	m_Maintaining = true;
+	return true;
+}
+
+void ConnectionPool::Maintain()
+{
+	std::vector<IDatabase *> expired;
+	std::vector<IdleConnection> checks;
+	Clock::time_point now = Clock::now();
+	auto idleTimeout = std::chrono::seconds(m_pInfo->poolIdleTimeout);
+	auto pingInterval = std::chrono::seconds(m_pInfo->poolPingInterval);
+
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+
+		/* Reap the oldest surplus connections first. */
+		while (m_Idle.size() > m_pInfo->poolMinIdle && now - m_Idle.front().since >= idleTimeout)
+		{
+			expired.push_back(m_Idle.front().db);
+			m_Idle.pop_front();
+			m_Stats.reaped++;
+		}
+
+		/* Take connections due a health check out of circulation. */
+		if (m_pInfo->poolPingInterval)
+		{
+			for (auto iter = m_Idle.begin(); iter != m_Idle.end(); )
+			{
+				if (now - iter->checked >= pingInterval)
+				{
+					checks.push_back(*iter);
+					iter = m_Idle.erase(iter);
+				} else {
+					iter++;
+				}
+			}
+		}
+	}
+
+	for (size_t i = 0; i < expired.size(); i++)
+	{
+		expired[i]->Close();
+	}
+
+	unsigned int lost = 0;
+	for (size_t i = 0; i < checks.size(); i++)
+	{
+		IDatabase *db = checks[i].db;
+
+		db->LockForFullAtomicOperation();
+		bool alive = db->DoSimpleQuery("SELECT 1");
+		db->UnlockFromFullAtomicOperation();
+
+		if (alive)
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			if (!m_Retired)
+			{
+				checks[i].checked = Clock::now();
+				m_Idle.push_back(checks[i]);
+				continue;
+			}
+		} else {
+			lost++;
+		}
+		db->Close();
+	}
+
+	/* Top the pool back up to its minimum, reconnecting whatever failed. */
+	while (true)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			m_Stats.pingFailures += lost;
+			lost = 0;
+			if (m_Retired || m_Idle.size() >= m_pInfo->poolMinIdle || InBackoff(Clock::now(), NULL))
+			{
+				m_Maintaining = false;
+				return;
+			}
+		}
+
+		char error[255];
+		IDatabase *db = Open(error, sizeof(error));
+		if (!db)
+		{
+			logger->LogError("[SM] Unable to refill connection pool \"%s\": %s", GetName(), error);
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(m_Lock);
+		if (m_Retired)
+		{
+			m_Maintaining = false;
+			db->Close();
+			return;
+		}
+		Clock::time_point created = Clock::now();
+		m_Idle.push_back(IdleConnection{db, created, created});
+	}
+}
+
+void ConnectionPool::Retire()
+{
+	std::deque<IdleConnection> idle;
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		m_Retired = true;
+		idle.swap(m_Idle);
+	}
+
+	for (size_t i = 0; i < idle.size(); i++)
+	{
+		idle[i].db->Close();
+	}
+}
+
+void ConnectionPool::GetStats(DBPoolStats *stats)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	*stats = m_Stats;
+	stats->idle = (unsigned int)m_Idle.size();
+	stats->leased = m_Leased;
+	stats->backoff = 0;
+	InBackoff(Clock::now(), &stats->backoff);
+}
+
+PooledDatabase::PooledDatabase(ConnectionPool *pool, IDatabase *db)
+ : m_pPool(pool), m_pDatabase(db), m_RefCount(1), m_Used(false), m_SessionChanged(false)
+{
+}
+
+bool PooledDatabase::Close()
+{
+	if (--m_RefCount != 0)
+	{
+		return false;
+	}
+
+	m_pPool->Return(m_pDatabase, m_Used, !m_SessionChanged);
+	delete this;
+	return true;
+}
+
+void PooledDatabase::IncReferenceCount()
+{
+	m_RefCount++;
+}
+
+const char *PooledDatabase::GetError(int *errorCode)
+{
+	return m_pDatabase->GetError(errorCode);
+}
+
+bool PooledDatabase::DoSimpleQuery(const char *query)
+{
+	m_Used = true;
+	return m_pDatabase->DoSimpleQuery(query);
+}
+
+IQuery *PooledDatabase::DoQuery(const char *query)
+{
+	m_Used = true;
+	return m_pDatabase->DoQuery(query);
+}
+
+IPreparedQuery *PooledDatabase::PrepareQuery(const char *query, char *error, size_t maxlength, int *errCode)
+{
+	m_Used = true;
+	return m_pDatabase->PrepareQuery(query, error, maxlength, errCode);
+}
+
+bool PooledDatabase::QuoteString(const char *str, char buffer[], size_t maxlen, size_t *newSize)
+{
+	return m_pDatabase->QuoteString(str, buffer, maxlen, newSize);
+}
+
+unsigned int PooledDatabase::GetAffectedRows()
+{
+	return m_pDatabase->GetAffectedRows();
+}
+
+unsigned int PooledDatabase::GetInsertID()
+{
+	return m_pDatabase->GetInsertID();
+}
+
+bool PooledDatabase::LockForFullAtomicOperation()
+{
+	return m_pDatabase->LockForFullAtomicOperation();
+}
+
+void PooledDatabase::UnlockFromFullAtomicOperation()
+{
+	m_pDatabase->UnlockFromFullAtomicOperation();
+}
+
+IDBDriver *PooledDatabase::GetDriver()
+{
+	return m_pDatabase->GetDriver();
+}
+
+bool PooledDatabase::DoSimpleQueryEx(const char *query, size_t len)
+{
+	m_Used = true;
+	return m_pDatabase->DoSimpleQueryEx(query, len);
+}
+
+IQuery *PooledDatabase::DoQueryEx(const char *query, size_t len)
+{
+	m_Used = true;
+	return m_pDatabase->DoQueryEx(query, len);
+}
+
+unsigned int PooledDatabase::GetAffectedRowsForQuery(IQuery *query)
+{
+	return m_pDatabase->GetAffectedRowsForQuery(query);
+}
+
+unsigned int PooledDatabase::GetInsertIDForQuery(IQuery *query)
+{
+	return m_pDatabase->GetInsertIDForQuery(query);
+}
+
+bool PooledDatabase::SetCharacterSet(const char *characterset)
+{
+	m_SessionChanged = true;
+	return m_pDatabase->SetCharacterSet(characterset);
+}
+
+bool PooledDatabase::GetStatementCacheStats(DBStatementCacheStats *stats)
+{
+	if (GetDriver()->GetDBIVersion() < 10)
+	{
+		return false;
+	}
+	return m_pDatabase->GetStatementCacheStats(stats);
+}
+
+IResultStream *PooledDatabase::DoQueryStream(const char *query, size_t len)
+{
+	m_Used = true;
+	if (GetDriver()->GetDBIVersion() < 10)
+	{
+		return IDatabase::DoQueryStream(query, len);
+	}
+	return m_pDatabase->DoQueryStream(query, len);
+}
+
+size_t PooledDatabase::DoQueryBatch(const char * const *queries, const size_t *lengths, size_t count,
+	IQuery **results)
+{
+	m_Used = true;
+	if (GetDriver()->GetDBIVersion() < 10)
+	{
+		return IDatabase::DoQueryBatch(queries, lengths, count, results);
+	}
+	return m_pDatabase->DoQueryBatch(queries, lengths, count, results);
+}
+
+bool PooledDatabase::QuoteStringEx(const char *str, size_t len, char buffer[], size_t maxlen, size_t *newSize)
+{
+	if (GetDriver()->GetDBIVersion() < 12)
+	{
+		return IDatabase::QuoteStringEx(str, len, buffer, maxlen, newSize);
+	}
+	return m_pDatabase->QuoteStringEx(str, len, buffer, maxlen, newSize);
+}
+
+size_t PooledDatabase::QuoteStrings(const char * const *strs, const size_t *lengths, size_t count,
+	char buffer[], size_t maxlen, size_t *sizes)
+{
+	if (GetDriver()->GetDBIVersion() < 12)
+	{
+		return IDatabase::QuoteStrings(strs, lengths, count, buffer, maxlen, sizes);
+	}
+	return m_pDatabase->QuoteStrings(strs, lengths, count, buffer, maxlen, sizes);
+}
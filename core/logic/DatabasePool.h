@@ -0,0 +1,172 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_SOURCEMOD_DATABASE_POOL_H_
+#define _INCLUDE_SOURCEMOD_DATABASE_POOL_H_
+
+#include <stdint.h>
+#include <IDBDriver.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <am-refcounting-threadsafe.h>
+#include "DatabaseConfBuilder.h"
+
+using namespace SourceMod;
+
+/* Longest wait imposed on reconnects after repeated failures. */
+#define DB_POOL_MAX_BACKOFF			30		/* seconds */
+
+struct DBPoolStats
+{
+	unsigned int idle;
+	unsigned int leased;
+	uint64_t created;
+	uint64_t reused;
+	uint64_t reaped;
+	uint64_t connectFailures;
+	uint64_t pingFailures;
+	unsigned int backoff;		/* seconds until reconnects are allowed again */
+};
+
+/**
+ * Idle connections for one databases.cfg entry that sets "pool_max_idle".
+ *
+ * Non-persistent connects for that entry are served from the pool, and a
+ * connection goes back to it once every Handle and operation using it is
+ * gone.  Idle connections are pinged and reaped by Maintain(), which runs on
+ * a database worker.  After a failed connect the pool refuses new connects
+ * for a growing interval instead of letting every caller wait out its own
+ * timeout against a server that is down.
+ *
+ * A connection that ran statements is rolled back when it is returned, so a
+ * transaction left open by one lease never leaks into the next.  If that
+ * fails, or the lease changed the character set, the connection is closed
+ * instead of being pooled.  Temporary tables and user variables created with
+ * plain SQL are not tracked and survive between leases.
+ */
+class ConnectionPool : public ke::RefcountedThreadsafe<ConnectionPool>
+{
+	typedef std::chrono::steady_clock Clock;
+
+	struct IdleConnection
+	{
+		IDatabase *db;
+		Clock::time_point since;
+		Clock::time_point checked;
+	};
+public:
+	ConnectionPool(const ke::RefPtr<ConfDbInfo> &info, IDBDriver *driver);
+	~ConnectionPool();
+public:
+	/* Thread safe; returns a leased connection or NULL with an error. */
+	IDatabase *Acquire(char *error, size_t maxlength);
+	/* Called when the last reference to a leased connection is dropped.
+	 * |used| says whether the lease ran statements, |reusable| whether it left
+	 * session state behind that a rollback can't undo.
+	 */
+	void Return(IDatabase *db, bool used, bool reusable);
+	/* Pings, reaps and refills idle connections. Blocks; run on a worker. */
+	void Maintain();
+	/* Marks a maintenance pass as queued; false if one already is. */
+	bool BeginMaintenance();
+	/* Closes every idle connection and stops accepting returns. */
+	void Retire();
+	/* Whether this pool still describes the given configuration. */
+	bool Matches(const ConfDbInfo *info) const;
+	void GetStats(DBPoolStats *stats);
+	inline const char *GetName() const
+	{
+		return m_pInfo->name.c_str();
+	}
+	inline IDBDriver *GetDriver() const
+	{
+		return m_pDriver;
+	}
+private:
+	IDatabase *Open(char *error, size_t maxlength);
+	bool InBackoff(Clock::time_point now, unsigned int *remaining);
+private:
+	ke::RefPtr<ConfDbInfo> m_pInfo;
+	IDBDriver *m_pDriver;
+	std::mutex m_Lock;
+	std::deque<IdleConnection> m_Idle;
+	unsigned int m_Leased;
+	unsigned int m_Failures;
+	Clock::time_point m_RetryAt;
+	bool m_Retired;
+	bool m_Maintaining;
+	DBPoolStats m_Stats;
+};
+
+/**
+ * The IDatabase handed out for a pooled connection.  It forwards everything
+ * to the real connection and returns it to the pool instead of closing it.
+ */
+class PooledDatabase : public IDatabase
+{
+public:
+	PooledDatabase(ConnectionPool *pool, IDatabase *db);
+public: //IDatabase
+	bool Close() override;
+	const char *GetError(int *errorCode=NULL) override;
+	bool DoSimpleQuery(const char *query) override;
+	IQuery *DoQuery(const char *query) override;
+	IPreparedQuery *PrepareQuery(const char *query, char *error, size_t maxlength, int *errCode=NULL) override;
+	bool QuoteString(const char *str, char buffer[], size_t maxlen, size_t *newSize) override;
+	unsigned int GetAffectedRows() override;
+	unsigned int GetInsertID() override;
+	bool LockForFullAtomicOperation() override;
+	void UnlockFromFullAtomicOperation() override;
+	void IncReferenceCount() override;
+	IDBDriver *GetDriver() override;
+	bool DoSimpleQueryEx(const char *query, size_t len) override;
+	IQuery *DoQueryEx(const char *query, size_t len) override;
+	unsigned int GetAffectedRowsForQuery(IQuery *query) override;
+	unsigned int GetInsertIDForQuery(IQuery *query) override;
+	bool SetCharacterSet(const char *characterset) override;
+	bool GetStatementCacheStats(DBStatementCacheStats *stats) override;
+	IResultStream *DoQueryStream(const char *query, size_t len) override;
+	size_t DoQueryBatch(const char * const *queries, const size_t *lengths, size_t count,
+		IQuery **results) override;
+	bool QuoteStringEx(const char *str, size_t len, char buffer[], size_t maxlen, size_t *newSize) override;
+	size_t QuoteStrings(const char * const *strs, const size_t *lengths, size_t count,
+		char buffer[], size_t maxlen, size_t *sizes) override;
+private:
+	ke::RefPtr<ConnectionPool> m_pPool;
+	IDatabase *m_pDatabase;
+	std::atomic<unsigned int> m_RefCount;
+	std::atomic<bool> m_Used;
+	std::atomic<bool> m_SessionChanged;
+};
+
+#endif //_INCLUDE_SOURCEMOD_DATABASE_POOL_H_
@@ -32,16 +32,156 @@
 #include <ISourceMod.h>
 #include <IPluginSys.h>
 #include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
 #include "DebugReporter.h"
 #include "Logger.h"
 
 DebugReport g_DbgReporter;
 
+// Past this many distinct fingerprints the table is flushed and restarted,
+// so a plugin generating unique locations cannot grow it without bound.
+static const size_t kMaxFingerprints = 4096;
+
+static inline uint64_t HashMix(uint64_t h, uint64_t v)
+{
+	// FNV-1a over the eight bytes of v.
+	for (int i = 0; i < 8; i++)
+	{
+		h ^= (v >> (i * 8)) & 0xff;
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+static inline uint64_t HashMix(uint64_t h, const char *str)
+{
+	if (!str)
+		return HashMix(h, uint64_t(0));
+	for (; *str; str++)
+	{
+		h ^= (unsigned char)*str;
+		h *= 0x100000001b3ULL;
+	}
+	return HashMix(h, uint64_t(1));
+}
+
+static const uint64_t kHashSeed = 0xcbf29ce484222325ULL;
+
 void DebugReport::OnSourceModAllInitialized()
 {
 	g_pSourcePawn->SetDebugListener(this);
 }
 
+void DebugReport::OnSourceModShutdown()
+{
+	FlushSuppressed(true);
+	if (m_FlushTimer)
+		timersys->KillTimer(m_FlushTimer);
+}
+
+ConfigResult DebugReport::OnSourceModConfigChanged(const char *key, const char *value,
+                                                   ConfigSource source, char *error,
+                                                   size_t maxlength)
+{
+	bool burst = strcmp(key, "ErrorReportBurst") == 0;
+	if (!burst && strcmp(key, "ErrorReportWindow") != 0)
+		return ConfigResult_Ignore;
+
+	char *end;
+	unsigned long number = strtoul(value, &end, 10);
+	if (!value[0] || *end != '\0' || (!burst && number == 0))
+	{
+		ke::SafeStrcpy(error, maxlength, burst
+			? "Invalid value: must be a number of reports"
+			: "Invalid value: must be a positive number of seconds");
+		return ConfigResult_Reject;
+	}
+
+	FlushSuppressed(true);
+	m_Fingerprints.clear();
+	if (burst)
+		m_Burst = (unsigned int)number;
+	else
+		m_Window = std::chrono::seconds(number);
+	return ConfigResult_Accept;
+}
+
+bool DebugReport::ShouldReport(uint64_t key, const char *blame, const char *message)
+{
+	if (!m_Burst)
+		return true;
+
+	if (m_Fingerprints.size() >= kMaxFingerprints && m_Fingerprints.find(key) == m_Fingerprints.end())
+	{
+		FlushSuppressed(true);
+		m_Fingerprints.clear();
+	}
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	Fingerprint &fp = m_Fingerprints[key];
+	if (!fp.reports || now - fp.window_start >= m_Window)
+	{
+		if (fp.suppressed)
+			LogSuppressed(fp);
+		fp.window_start = now;
+		fp.reports = 0;
+		fp.suppressed = 0;
+		fp.blame = blame ? blame : "<unknown>";
+	}
+
+	if (fp.reports < m_Burst)
+	{
+		fp.reports++;
+		return true;
+	}
+
+	fp.suppressed++;
+	fp.last_message = message;
+	if (!m_FlushTimer)
+		m_FlushTimer = timersys->CreateTimer(this, float(m_Window.count()), nullptr, TIMER_FLAG_REPEAT);
+	return false;
+}
+
+void DebugReport::LogSuppressed(const Fingerprint &fp)
+{
+	g_Logger.LogError("[SM] %u repeats of an error blamed on %s were suppressed in the last %d seconds (last: %s)",
+		fp.suppressed, fp.blame.c_str(), (int)m_Window.count(), fp.last_message.c_str());
+}
+
+void DebugReport::FlushSuppressed(bool all)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	for (auto iter = m_Fingerprints.begin(); iter != m_Fingerprints.end(); )
+	{
+		Fingerprint &fp = iter->second;
+		if (!all && now - fp.window_start < m_Window)
+		{
+			iter++;
+			continue;
+		}
+		if (fp.suppressed)
+			LogSuppressed(fp);
+		iter = m_Fingerprints.erase(iter);
+	}
+}
+
+ResultType DebugReport::OnTimer(ITimer *pTimer, void *pData)
+{
+	FlushSuppressed(false);
+	for (const auto &entry : m_Fingerprints)
+	{
+		if (entry.second.suppressed)
+			return Pl_Continue;
+	}
+	return Pl_Stop;
+}
+
+void DebugReport::OnTimerEnd(ITimer *pTimer, void *pData)
+{
+	m_FlushTimer = nullptr;
+}
+
 void DebugReport::OnDebugSpew(const char *msg, ...)
 {
 	va_list ap;
@@ -70,6 +210,10 @@ void DebugReport::GenerateErrorVA(IPluginContext *ctx, cell_t func_idx, int err,
 
 	const char *plname = pluginsys->FindPluginByContext(ctx->GetContext())->GetFilename();
 
+	uint64_t key = HashMix(HashMix(HashMix(kHashSeed, plname), uint64_t(err)), uint64_t(func_idx));
+	if (!ShouldReport(key, plname, buffer))
+		return;
+
 	if (err >= 0) {
 		const char *error = g_pSourcePawn2->GetErrorString(err);
 		if (error)
@@ -104,6 +248,11 @@ void DebugReport::GenerateCodeError(IPluginContext *pContext, uint32_t code_addr
 	va_end(ap);
 
 	const char *plname = pluginsys->FindPluginByContext(pContext->GetContext())->GetFilename();
+
+	uint64_t key = HashMix(HashMix(HashMix(kHashSeed, plname), uint64_t(err)), uint64_t(code_addr));
+	if (!ShouldReport(key, plname, buffer))
+		return;
+
 	const char *error = g_pSourcePawn2->GetErrorString(err);
 
 	if (error)
@@ -167,11 +316,24 @@ void DebugReport::ReportError(const IErrorReport &report, IFrameIterator &iter)
 	if (report.Blame()) 
 	{
 		blame = report.Blame()->DebugName();
-	} else {
-	    // Find the nearest plugin to blame.
-		for (; !iter.Done(); iter.Next()) 
+	}
+
+	// Only walk down to the nearest scripted frame: it gives the plugin to
+	// blame and, with the native on top (if any), the error's fingerprint.
+	const char *native = nullptr;
+	const char *function = nullptr;
+	int line = 0;
+	for (; !iter.Done(); iter.Next()) 
+	{
+		if (iter.IsNativeFrame())
 		{
-			if (iter.IsScriptedFrame()) 
+			if (!native)
+				native = iter.FunctionName();
+			continue;
+		}
+		if (iter.IsScriptedFrame()) 
+		{
+			if (!blame)
 			{
 				IPlugin *plugin = pluginsys->FindPluginByContext(iter.Context()->GetContext());
 				if (plugin)
@@ -180,11 +342,21 @@ void DebugReport::ReportError(const IErrorReport &report, IFrameIterator &iter)
 				} else {
 					blame = iter.Context()->GetRuntime()->GetFilename();
 				}
-				break;
 			}
+			function = iter.FunctionName();
+			line = iter.LineNumber();
+			break;
 		}
 	}
 
+	uint64_t key = HashMix(kHashSeed, blame);
+	key = HashMix(key, uint64_t(report.Code()));
+	key = HashMix(key, native);
+	key = HashMix(key, function);
+	key = HashMix(key, uint64_t(line));
+	if (!ShouldReport(key, blame, report.Message()))
+		return;
+
 	iter.Reset();
 
 	g_Logger.LogError("[SM] Exception reported: %s", report.Message());
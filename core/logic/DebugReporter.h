@@ -34,15 +34,26 @@
 
 #include "sp_vm_api.h"
 #include "common_logic.h"
+#include <ITimerSystem.h>
 #include <am-vector.h>
 #include <am-string.h>
+#include <chrono>
+#include <string>
+#include <unordered_map>
 
 class DebugReport : 
 	public SMGlobalClass, 
-	public IDebugListener
+	public IDebugListener,
+	public ITimedEvent
 {
 public: // SMGlobalClass
 	void OnSourceModAllInitialized();
+	void OnSourceModShutdown();
+	ConfigResult OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source,
+	                                      char *error, size_t maxlength);
+public: // ITimedEvent
+	ResultType OnTimer(ITimer *pTimer, void *pData);
+	void OnTimerEnd(ITimer *pTimer, void *pData);
 public: // IDebugListener
 	void ReportError(const IErrorReport &report, IFrameIterator &iter);
 	void OnDebugSpew(const char *msg, ...);
@@ -55,6 +66,26 @@ public:
 	std::vector<std::string> GetStackTrace(IFrameIterator *iter);
 private:
 	int _GetPluginIndex(IPluginContext *ctx);
+
+	// Errors are fingerprinted by (plugin, error code, code location). Each
+	// fingerprint may log up to m_Burst reports per m_Window; the rest are
+	// only counted, and summarized once the window closes.
+	struct Fingerprint
+	{
+		std::chrono::steady_clock::time_point window_start;
+		unsigned int reports = 0;
+		unsigned int suppressed = 0;
+		std::string blame;
+		std::string last_message;
+	};
+	bool ShouldReport(uint64_t key, const char *blame, const char *message);
+	void FlushSuppressed(bool all);
+	void LogSuppressed(const Fingerprint &fp);
+
+	std::unordered_map<uint64_t, Fingerprint> m_Fingerprints;
+	unsigned int m_Burst = 10;
+	std::chrono::seconds m_Window = std::chrono::seconds(10);
+	ITimer *m_FlushTimer = nullptr;
 };
 
 extern DebugReport g_DbgReporter;
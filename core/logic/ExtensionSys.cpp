@@ -29,15 +29,20 @@
  * Version: $Id$
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 
+#include <chrono>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "ExtensionSys.h"
 #include <ILibrarySys.h>
 #include <ISourceMod.h>
 #include "common_logic.h"
 #include "PluginSys.h"
+#include "ThreadPool.h"
 #include <am-utility.h>
 #include <am-string.h>
 #include <bridge/include/CoreProvider.h>
@@ -46,6 +51,52 @@
 CExtensionManager g_Extensions;
 IdentityType_t g_ExtType;
 
+/* Bound in place of a deferred extension's natives. The first call loads the
+ * extension, which rebinds every plugin to the real natives, and then
+ * forwards the call.
+ */
+class DeferredNative final : public INativeCallback
+{
+public:
+	DeferredNative(CExtension *ext, const char *name)
+		: ext_(ext),
+		  name_(name)
+	{}
+
+	void AddRef() override {
+		refcount_++;
+	}
+	void Release() override {
+		assert(refcount_ > 0);
+		if (--refcount_ == 0)
+			delete this;
+	}
+	int Invoke(IPluginContext *ctx, const cell_t *params) override {
+		// Rebinding drops the plugins' references to us.
+		ke::RefPtr<DeferredNative> self(this);
+
+		char error[256];
+		if (!g_Extensions.LoadDeferred(ext_, error, sizeof(error)))
+			return ctx->ThrowNativeError("Extension \"%s\" failed to load: %s", ext_->GetFilename(), error);
+
+		ke::RefPtr<Native> entry = g_ShareSys.FindNative(name_.c_str());
+		if (!entry || !entry->native)
+			return ctx->ThrowNativeError("Native \"%s\" is not provided by extension \"%s\"", name_.c_str(), ext_->GetFilename());
+
+		return entry->native->func(ctx, params);
+	}
+
+private:
+	size_t refcount_ = 0;
+	CExtension *ext_;
+	std::string name_;
+};
+
+static void BuildManifestPath(char *buffer, size_t maxlength, const char *file)
+{
+	g_pSM->BuildPath(Path_SM, buffer, maxlength, "data/lazyexts/%s.txt", file);
+}
+
 void CExtension::Initialize(const char *filename, const char *path, bool bRequired)
 {
 	m_bRequired = bRequired;
@@ -53,6 +104,7 @@ void CExtension::Initialize(const char *filename, const char *path, bool bRequir
 	m_pIdentToken = NULL;
 	unload_code = 0;
 	m_bFullyLoaded = false;
+	m_bDeferred = false;
 	m_File.assign(filename);
 	m_Path.assign(path);
 	char real_name[PLATFORM_MAX_PATH];
@@ -340,7 +392,137 @@ void CExtension::MarkAllLoaded()
 	{
 		m_bFullyLoaded = true;
 		m_pAPI->OnExtensionsAllLoaded();
+
+		if (g_Extensions.IsLazyLoadingEnabled())
+		{
+			WriteManifest();
+		}
+	}
+}
+
+/* Lazy-loadable extensions leave a list of their natives and libraries
+ * behind, so the next startup can bind stubs instead of loading them.
+ */
+void CExtension::WriteManifest()
+{
+	if (IsExternal())
+	{
+		return;
+	}
+
+	char path[PLATFORM_MAX_PATH];
+	BuildManifestPath(path, sizeof(path), m_RealFile.c_str());
+
+	/* Stubs can only stand in for natives. Anything that hands out
+	 * interfaces or lives in Metamod has to load up front.
+	 */
+	time_t mtime;
+	if (m_pAPI->GetExtensionVersion() < 9
+		|| !m_pAPI->IsLazyLoadable()
+		|| m_pAPI->IsMetamodExtension()
+		|| !m_Interfaces.empty()
+		|| !libsys->FileTime(m_Path.c_str(), FileTime_LastChange, &mtime))
+	{
+		if (libsys->PathExists(path))
+		{
+			remove(path);
+		}
+		return;
+	}
+
+	char dir[PLATFORM_MAX_PATH];
+	g_pSM->BuildPath(Path_SM, dir, sizeof(dir), "data/lazyexts");
+	if (!libsys->IsPathDirectory(dir) && !libsys->CreateFolder(dir))
+	{
+		return;
+	}
+
+	FILE *fp = fopen(path, "wt");
+	if (!fp)
+	{
+		return;
+	}
+
+	fprintf(fp, "mtime %lld\n", (long long)mtime);
+	for (List<String>::iterator iter = m_Libraries.begin(); iter != m_Libraries.end(); iter++)
+	{
+		fprintf(fp, "library %s\n", (*iter).c_str());
+	}
+	for (size_t i = 0; i < m_natives.size(); i++)
+	{
+		for (const sp_nativeinfo_t *native = m_natives[i]; native->func && native->name; native++)
+		{
+			fprintf(fp, "native %s\n", native->name);
+		}
+	}
+
+	fclose(fp);
+}
+
+bool CExtension::Defer()
+{
+	time_t mtime;
+	if (!libsys->FileTime(m_Path.c_str(), FileTime_LastChange, &mtime))
+	{
+		return false;
+	}
+
+	char path[PLATFORM_MAX_PATH];
+	BuildManifestPath(path, sizeof(path), m_RealFile.c_str());
+
+	FILE *fp = fopen(path, "rt");
+	if (!fp)
+	{
+		return false;
+	}
+
+	bool current = false;
+	std::vector<std::string> natives;
+	std::vector<std::string> libraries;
+
+	char line[256];
+	while (fgets(line, sizeof(line), fp))
+	{
+		size_t len = strlen(line);
+		while (len && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+		{
+			line[--len] = '\0';
+		}
+
+		if (strncmp(line, "mtime ", 6) == 0)
+		{
+			current = (strtoll(&line[6], NULL, 10) == (long long)mtime);
+		}
+		else if (strncmp(line, "library ", 8) == 0)
+		{
+			libraries.push_back(&line[8]);
+		}
+		else if (strncmp(line, "native ", 7) == 0)
+		{
+			natives.push_back(&line[7]);
+		}
+	}
+
+	fclose(fp);
+
+	/* A rebuilt binary may not have the same natives. */
+	if (!current || natives.empty())
+	{
+		return false;
+	}
+
+	m_bDeferred = true;
+
+	for (size_t i = 0; i < natives.size(); i++)
+	{
+		AddStubNative(natives[i].c_str(), new DeferredNative(this, natives[i].c_str()));
+	}
+	for (size_t i = 0; i < libraries.size(); i++)
+	{
+		g_Extensions.AddLibrary(this, libraries[i].c_str());
 	}
+
+	return true;
 }
 
 void CExtension::AddPlugin(CPlugin *pPlugin)
@@ -439,6 +621,12 @@ void CExtension::AddInterface(SMInterface *pInterface)
 
 bool CExtension::IsRunning(char *error, size_t maxlength)
 {
+	/* Loaded as soon as something needs it. */
+	if (m_bDeferred)
+	{
+		return true;
+	}
+
 	if (!IsLoaded())
 	{
 		if (error)
@@ -480,6 +668,31 @@ void CExtensionManager::OnSourceModShutdown()
 	g_ShareSys.DestroyIdentType(g_ExtType);
 }
 
+ConfigResult CExtensionManager::OnSourceModConfigChanged(const char *key, const char *value,
+	ConfigSource source, char *error, size_t maxlength)
+{
+	if (strcmp(key, "LazyExtensions") != 0)
+	{
+		return ConfigResult_Ignore;
+	}
+
+	if (strcasecmp(value, "yes") == 0)
+	{
+		m_bLazyLoading = true;
+	}
+	else if (strcasecmp(value, "no") == 0)
+	{
+		m_bLazyLoading = false;
+	}
+	else
+	{
+		ke::SafeStrcpy(error, maxlength, "Invalid value: must be \"yes\" or \"no\"");
+		return ConfigResult_Reject;
+	}
+
+	return ConfigResult_Accept;
+}
+
 void CExtensionManager::Shutdown()
 {
 	List<CExtension *>::iterator iter;
@@ -528,13 +741,13 @@ void CExtensionManager::TryAutoload()
 		len = ke::SafeStrcpy(file, sizeof(file), lfile);
 		strcpy(&file[len - 9], ".ext");
 
-		LoadAutoExtension(file);
+		LoadAutoExtension(file, true, true);
 		
 		pDir->NextEntry();
 	}
 }
 
-IExtension *CExtensionManager::LoadAutoExtension(const char *path, bool bErrorOnMissing)
+IExtension *CExtensionManager::LoadAutoExtension(const char *path, bool bErrorOnMissing, bool bAllowDefer)
 {
 	/* Remove platform extension if it's there. Compat hack. */
 	const char *ext = libsys->GetFileExtension(path);
@@ -543,16 +756,21 @@ IExtension *CExtensionManager::LoadAutoExtension(const char *path, bool bErrorOn
 		char path2[PLATFORM_MAX_PATH];
 		ke::SafeStrcpy(path2, sizeof(path2), path);
 		path2[strlen(path) - strlen(PLATFORM_LIB_EXT) - 1] = '\0';
-		return LoadAutoExtension(path2, bErrorOnMissing);
+		return LoadAutoExtension(path2, bErrorOnMissing, bAllowDefer);
 	}
 
+	char error[256];
 	IExtension *pAlready;
 	if ((pAlready=FindExtensionByFile(path)) != NULL)
 	{
+		CExtension *pExt = (CExtension *)pAlready;
+		if (pExt->IsDeferred() && !bAllowDefer)
+		{
+			LoadDeferred(pExt, error, sizeof(error));
+		}
 		return pAlready;
 	}
 
-	char error[256];
 	CExtension *p = new CLocalExtension(path, bErrorOnMissing);
 
 	/* We put us in the list beforehand so extensions that check for each other
@@ -560,7 +778,18 @@ IExtension *CExtensionManager::LoadAutoExtension(const char *path, bool bErrorOn
 	 */
 	m_Libs.push_back(p);
 
-	if (!p->Load(error, sizeof(error)) || !p->IsLoaded())
+	if (bAllowDefer && m_bLazyLoading && p->Defer())
+	{
+		return p;
+	}
+
+	/* Inclusive of any extensions this one pulls in while loading. */
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bool loaded = p->Load(error, sizeof(error)) && p->IsLoaded();
+	bridge->RecordStartupStep(p->GetFilename(),
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+	if (!loaded)
 	{
 		if (bErrorOnMissing || libsys->IsPathFile(p->GetPath()))
 		{
@@ -573,6 +802,41 @@ IExtension *CExtensionManager::LoadAutoExtension(const char *path, bool bErrorOn
 	return p;
 }
 
+bool CExtensionManager::LoadDeferred(CExtension *pExt, char *error, size_t maxlength)
+{
+	if (!pExt->IsDeferred())
+	{
+		return pExt->IsRunning(error, maxlength);
+	}
+
+	/* The real natives replace the stubs under the same owner, so plugins
+	 * bound to the stubs keep their dependency on us.
+	 */
+	pExt->m_bDeferred = false;
+	pExt->DropStubNatives();
+
+	if (!pExt->Load(error, maxlength) || !pExt->IsLoaded())
+	{
+		logger->LogError("[SM] Unable to load extension \"%s\": %s", pExt->GetFilename(), error);
+		pExt->SetError(error);
+
+		for (List<String>::iterator iter = pExt->m_Libraries.begin(); iter != pExt->m_Libraries.end(); iter++)
+		{
+			scripts->OnLibraryAction((*iter).c_str(), LibraryAction_Removed);
+		}
+		pExt->m_Libraries.clear();
+		return false;
+	}
+
+	if (!pExt->m_bFullyLoaded)
+	{
+		pExt->MarkAllLoaded();
+	}
+
+	g_ShareSys.RebindNatives();
+	return true;
+}
+
 IExtension *CExtensionManager::FindExtensionByFile(const char *file)
 {
 	List<CExtension *>::iterator iter;
@@ -647,6 +911,10 @@ IExtension *CExtensionManager::LoadExtension(const char *file, char *error, size
 	IExtension *pAlready;
 	if ((pAlready=FindExtensionByFile(file)) != NULL)
 	{
+		if (((CExtension *)pAlready)->IsDeferred() && !LoadDeferred((CExtension *)pAlready, error, maxlength))
+		{
+			return NULL;
+		}
 		return pAlready;
 	}
 
@@ -749,6 +1017,9 @@ bool CExtensionManager::UnloadExtension(IExtension *_pExt)
 	if (m_Libs.find(pExt) == m_Libs.end())
 		return false;
 
+	/* Finish or cancel its pool tasks while its code is still loaded */
+	g_ThreadPool.CancelTasks(pExt->GetIdentity());
+
 	/* Tell it to unload */
 	if (pExt->IsLoaded())
 		pExt->GetAPI()->OnExtensionUnload();
@@ -763,7 +1034,7 @@ bool CExtensionManager::UnloadExtension(IExtension *_pExt)
 	List<CExtension *> UnloadQueue;
 
 	/* Handle dependencies */
-	if (pExt->IsLoaded())
+	if (pExt->IsLoaded() || pExt->IsDeferred())
 	{
 		/* Unload any dependent plugins */
 		List<CPlugin *>::iterator p_iter = pExt->m_Dependents.begin();
@@ -941,6 +1212,10 @@ void CExtensionManager::OnRootConsoleCommand(const char *cmdname, const ICommand
 						rootmenu->ConsolePrint("[%02d] %s (%s): %s", num, name, version, descr);
 					}
 				}
+				else if (pExt->IsDeferred())
+				{
+					rootmenu->ConsolePrint("[%02d] <DEFERRED> file \"%s\": loads on first native call", num, pExt->GetFilename());
+				}
 				else if(pExt->IsRequired() || libsys->PathExists(pExt->GetPath()))
 				{
 					rootmenu->ConsolePrint("[%02d] <FAILED> file \"%s\": %s", num, pExt->GetFilename(), pExt->m_Error.c_str());
@@ -967,7 +1242,8 @@ void CExtensionManager::OnRootConsoleCommand(const char *cmdname, const ICommand
 			ke::SafeSprintf(path, sizeof(path), "%s%s%s", filename, !strstr(filename, ".ext") ? ".ext" : "",
 				!strstr(filename, "." PLATFORM_LIB_EXT) ? "." PLATFORM_LIB_EXT : "");
 			
-			if (FindExtensionByFile(path) != NULL)
+			IExtension *pAlready = FindExtensionByFile(path);
+			if (pAlready != NULL && !((CExtension *)pAlready)->IsDeferred())
 			{
 				rootmenu->ConsolePrint("[SM] Extension %s is already loaded.", path);
 				return;
@@ -1029,7 +1305,12 @@ void CExtensionManager::OnRootConsoleCommand(const char *cmdname, const ICommand
 				return;
 			}
 
-			if (!pExt->IsLoaded())
+			if (pExt->IsDeferred())
+			{
+				rootmenu->ConsolePrint(" File: %s", pExt->GetFilename());
+				rootmenu->ConsolePrint(" Loaded: No (deferred until a native is called)");
+			}
+			else if (!pExt->IsLoaded())
 			{
 				rootmenu->ConsolePrint(" File: %s", pExt->GetFilename());
 				rootmenu->ConsolePrint(" Loaded: No (%s)", pExt->m_Error.c_str());
@@ -1248,7 +1529,7 @@ CExtension *CExtensionManager::GetExtensionFromIdent(IdentityToken_t *ptr)
 	return NULL;
 }
 
-CExtensionManager::CExtensionManager()
+CExtensionManager::CExtensionManager() : m_bLazyLoading(true)
 {
 }
 
@@ -1259,6 +1540,16 @@ CExtensionManager::~CExtensionManager()
 void CExtensionManager::AddLibrary(IExtension *pSource, const char *library)
 {
 	CExtension *pExt = (CExtension *)pSource;
+
+	/* Deferred extensions announce their libraries before they load. */
+	for (List<String>::iterator iter = pExt->m_Libraries.begin(); iter != pExt->m_Libraries.end(); iter++)
+	{
+		if ((*iter).compare(library) == 0)
+		{
+			return;
+		}
+	}
+
 	pExt->AddLibrary(library);
 	scripts->OnLibraryAction(library, LibraryAction_Added);
 }
@@ -1325,7 +1616,10 @@ void CExtensionManager::CallOnCoreMapStart(edict_t *pEdictList, int edictCount,
 		}
 		if (pAPI->GetExtensionVersion() > 3)
 		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 			pAPI->OnCoreMapStart(pEdictList, edictCount, clientMax);
+			bridge->RecordStartupStep((*iter)->GetFilename(),
+				std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
 		}
 	}
 }
@@ -1343,7 +1637,10 @@ void CExtensionManager::CallOnCoreMapEnd()
 		}
 		if (pAPI->GetExtensionVersion() > 7)
 		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 			pAPI->OnCoreMapEnd();
+			bridge->RecordStartupStep((*iter)->GetFilename(),
+				std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
 		}
 	}
 }
@@ -81,6 +81,12 @@ public:
 	void MarkAllLoaded();
 	void AddLibrary(const char *library);
 	bool IsRequired();
+	bool Defer();
+	void WriteManifest();
+	bool IsDeferred() const
+	{
+		return m_bDeferred;
+	}
 public:
 	virtual bool Load(char *error, size_t maxlength);
 	virtual bool IsLoaded() =0;
@@ -106,6 +112,7 @@ protected:
 	unsigned int unload_code;
 	bool m_bFullyLoaded;
 	bool m_bRequired;
+	bool m_bDeferred;
 };
 
 class CLocalExtension : public CExtension
@@ -149,6 +156,12 @@ public:
 public: //SMGlobalClass
 	void OnSourceModAllInitialized();
 	void OnSourceModShutdown();
+	ConfigResult OnSourceModConfigChanged(const char *key, const char *value,
+		ConfigSource source, char *error, size_t maxlength);
+	const char *GetGlobalClassName()
+	{
+		return "ExtensionManager";
+	}
 public: //IExtensionManager
 	IExtension *LoadExtension(const char *path, 
 		char *error,
@@ -166,7 +179,12 @@ public: //IPluginsListener
 public: //IRootConsoleCommand
 	void OnRootConsoleCommand(const char *cmdname, const ICommandArgs *command) override;
 public:
-	IExtension *LoadAutoExtension(const char *path, bool bErrorOnMissing=true);
+	IExtension *LoadAutoExtension(const char *path, bool bErrorOnMissing=true, bool bAllowDefer=false);
+	bool LoadDeferred(CExtension *pExt, char *error, size_t maxlength);
+	bool IsLazyLoadingEnabled() const
+	{
+		return m_bLazyLoading;
+	}
 	void BindDependency(IExtension *pOwner, IfaceInfo *pInfo);
 	void AddInterface(IExtension *pOwner, SMInterface *pInterface);
 	void BindChildPlugin(IExtension *pParent, SMPlugin *pPlugin);
@@ -192,6 +210,7 @@ private:
 	CExtension *FindByOrder(unsigned int num);
 private:
 	List<CExtension *> m_Libs;
+	bool m_bLazyLoading;
 };
 
 extern CExtensionManager g_Extensions;
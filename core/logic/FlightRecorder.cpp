@@ -0,0 +1,375 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#include "FlightRecorder.h"
+#include "ProfileTools.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+#include <vector>
+#include <ISourceMod.h>
+#include <bridge/include/ILogger.h>
+
+FlightRecorder g_FlightRecorder;
+
+// Don't flood logs/ when the server hitches repeatedly.
+static const int64_t kDumpCooldownNs = 30LL * 1000 * 1000 * 1000;
+
+static inline int64_t
+Now()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void
+WriteJsonString(FILE *fp, const char *str)
+{
+	fputc('"', fp);
+	for (const char *p = str; *p; p++) {
+		unsigned char c = (unsigned char)*p;
+		if (c == '"' || c == '\\')
+			fprintf(fp, "\\%c", c);
+		else if (c < 0x20)
+			fprintf(fp, "\\u%04x", c);
+		else
+			fputc(c, fp);
+	}
+	fputc('"', fp);
+}
+
+FlightRecorder::FlightRecorder()
+	: recording_(false),
+	  initialized_(false),
+	  attached_(false),
+	  head_(0),
+	  count_(0),
+	  last_frame_(0),
+	  last_dump_(0),
+	  threshold_ms_(0),
+	  history_(8)
+{
+}
+
+void
+FlightRecorder::OnSourceModAllInitialized()
+{
+	pluginsys->AddPluginsListener(this);
+	initialized_ = true;
+	Update();
+}
+
+void
+FlightRecorder::OnSourceModShutdown()
+{
+	threshold_ms_ = 0;
+	Update();
+	pluginsys->RemovePluginsListener(this);
+	initialized_ = false;
+}
+
+ConfigResult
+FlightRecorder::OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source,
+                                         char *error, size_t maxlength)
+{
+	bool threshold = strcmp(key, "SlowFrameThreshold") == 0;
+	if (!threshold && strcmp(key, "SlowFrameHistory") != 0)
+		return ConfigResult_Ignore;
+
+	char *end;
+	unsigned long number = strtoul(value, &end, 10);
+	if (!value[0] || *end != '\0') {
+		ke::SafeStrcpy(error, maxlength, "Invalid value: must be a number");
+		return ConfigResult_Reject;
+	}
+
+	if (threshold) {
+		threshold_ms_ = (unsigned int)number;
+		Update();
+	} else {
+		if (number > 64) {
+			ke::SafeStrcpy(error, maxlength, "Invalid value: at most 64 frames can be kept");
+			return ConfigResult_Reject;
+		}
+		history_ = (unsigned int)number;
+	}
+	return ConfigResult_Accept;
+}
+
+void
+FlightRecorder::Update()
+{
+	bool wanted = initialized_ && threshold_ms_ > 0;
+	if (wanted == recording_)
+		return;
+
+	if (wanted) {
+		if (!ring_)
+			ring_.reset(new Event[kRingSize]);
+		head_ = 0;
+		count_ = 0;
+		last_frame_ = 0;
+		main_thread_ = std::this_thread::get_id();
+		recording_ = true;
+		AttachToVM();
+	} else {
+		DetachFromVM();
+		recording_ = false;
+		ring_ = nullptr;
+	}
+}
+
+void
+FlightRecorder::AttachToVM()
+{
+	// Core scopes still reach us through ProfileToolManager while a console
+	// profile owns the slot.
+	if (!recording_ || attached_ || g_ProfileToolManager.HasActiveTool())
+		return;
+
+	g_pSourcePawn2->SetProfilingTool(this);
+	g_pSourcePawn2->EnableProfiling();
+	attached_ = true;
+}
+
+void
+FlightRecorder::DetachFromVM()
+{
+	if (!attached_)
+		return;
+
+	attached_ = false;
+	if (g_ProfileToolManager.HasActiveTool())
+		return;
+	g_pSourcePawn2->DisableProfiling();
+	g_pSourcePawn2->SetProfilingTool(nullptr);
+}
+
+const char *
+FlightRecorder::Name()
+{
+	return "flightrecorder";
+}
+
+const char *
+FlightRecorder::Description()
+{
+	return "Always-on slow frame recorder";
+}
+
+bool
+FlightRecorder::Start()
+{
+	return recording_;
+}
+
+void
+FlightRecorder::Stop(void (*render)(const char *fmt, ...))
+{
+}
+
+void
+FlightRecorder::Dump()
+{
+}
+
+bool
+FlightRecorder::IsActive()
+{
+	return recording_;
+}
+
+bool
+FlightRecorder::IsAttached()
+{
+	return true;
+}
+
+void
+FlightRecorder::RenderHelp(void (*render)(const char *fmt, ...))
+{
+	render("The flight recorder is configured with SlowFrameThreshold in core.cfg.");
+}
+
+void
+FlightRecorder::Record(EventType type, const char *group, const char *name)
+{
+	if (!recording_ || std::this_thread::get_id() != main_thread_)
+		return;
+
+	Event &event = ring_[head_];
+	event.ts = Now();
+	event.group = group;
+	event.name = name;
+	event.type = type;
+
+	head_ = (head_ + 1) & (kRingSize - 1);
+	if (count_ < kRingSize)
+		count_++;
+}
+
+void
+FlightRecorder::EnterScope(const char *group, const char *name)
+{
+	Record(EventType::Enter, group, name);
+}
+
+void
+FlightRecorder::LeaveScope()
+{
+	Record(EventType::Leave, nullptr, nullptr);
+}
+
+void
+FlightRecorder::OnPluginUnloaded(IPlugin *plugin)
+{
+	// Recorded names may point into the plugin.
+	count_ = 0;
+	last_frame_ = 0;
+}
+
+void
+FlightRecorder::OnFrame()
+{
+	if (!recording_)
+		return;
+
+	Record(EventType::Frame, nullptr, nullptr);
+
+	int64_t now = ring_[(head_ + kRingSize - 1) & (kRingSize - 1)].ts;
+	int64_t frame_ns = last_frame_ ? now - last_frame_ : 0;
+	last_frame_ = now;
+
+	if (frame_ns < int64_t(threshold_ms_) * 1000000)
+		return;
+	if (last_dump_ && now - last_dump_ < kDumpCooldownNs)
+		return;
+	last_dump_ = now;
+
+	std::string path;
+	if (Write(frame_ns, &path)) {
+		logger->LogMessage("[SM] Frame took %.1f ms; wrote the last %u frames to \"%s\"",
+		                   double(frame_ns) / 1e6, history_ + 1, path.c_str());
+	}
+}
+
+bool
+FlightRecorder::Write(int64_t frame_ns, std::string *path)
+{
+	size_t start = (head_ + kRingSize - count_) & (kRingSize - 1);
+	auto at = [&](size_t i) -> const Event & {
+		return ring_[(start + i) & (kRingSize - 1)];
+	};
+
+	// The newest marker ends the slow frame; keep it, the marker that began
+	// it, and one more marker per frame of history.
+	size_t first = 0;
+	unsigned int markers = 0;
+	for (size_t i = count_; i-- > 0; ) {
+		if (at(i).type == EventType::Frame && ++markers == history_ + 2) {
+			first = i;
+			break;
+		}
+	}
+
+	char stamp[64];
+	time_t t = g_pSM->GetAdjustedTime();
+	strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", localtime(&t));
+
+	char buffer[PLATFORM_MAX_PATH];
+	g_pSM->BuildPath(Path_SM, buffer, sizeof(buffer), "logs/slowframe_%s.json", stamp);
+	*path = buffer;
+
+	FILE *fp = fopen(buffer, "wt");
+	if (!fp) {
+		logger->LogError("[SM] Failed to open \"%s\" for writing", buffer);
+		return false;
+	}
+
+	int64_t base = at(first).ts;
+	int64_t threshold_ns = int64_t(threshold_ms_) * 1000000;
+	bool first_event = true;
+
+	auto write = [&](const char *name, const char *cat, int tid, int64_t ts, int64_t dur) -> void {
+		fprintf(fp, "%s\n{\"name\":", first_event ? "" : ",");
+		WriteJsonString(fp, name ? name : "<unknown>");
+		fprintf(fp, ",\"cat\":");
+		WriteJsonString(fp, cat ? cat : "other");
+		fprintf(fp, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%d}",
+			double(ts - base) / 1e3, double(dur) / 1e3, tid);
+		first_event = false;
+	};
+
+	// Frames go on their own track so hitches stand out above the scopes.
+	std::vector<const Event *> stack;
+	const Event *frame = nullptr;
+	int64_t last = base;
+
+	fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"slow_frame_ms\":%.3f},\"traceEvents\":[",
+		double(frame_ns) / 1e6);
+	for (size_t i = first; i < count_; i++) {
+		const Event &event = at(i);
+		last = event.ts;
+
+		switch (event.type) {
+		case EventType::Enter:
+			stack.push_back(&event);
+			break;
+		case EventType::Leave:
+			// A leave with no matching enter belongs to a scope that was
+			// overwritten or entered before recording began; drop it.
+			if (!stack.empty()) {
+				const Event *enter = stack.back();
+				stack.pop_back();
+				write(enter->name, enter->group, 0, enter->ts, event.ts - enter->ts);
+			}
+			break;
+		case EventType::Frame:
+			if (frame) {
+				int64_t dur = event.ts - frame->ts;
+				write(dur >= threshold_ns ? "slow frame" : "frame", "frames", 1, frame->ts, dur);
+			}
+			frame = &event;
+			break;
+		}
+	}
+	while (!stack.empty()) {
+		const Event *enter = stack.back();
+		stack.pop_back();
+		write(enter->name, enter->group, 0, enter->ts, last - enter->ts);
+	}
+	fprintf(fp, "\n]}\n");
+	fclose(fp);
+	return true;
+}
@@ -0,0 +1,138 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#ifndef _include_sourcemod_logic_flight_recorder_h_
+#define _include_sourcemod_logic_flight_recorder_h_
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <sp_vm_api.h>
+#include <IPluginSys.h>
+#include "common_logic.h"
+
+using namespace SourcePawn;
+using namespace SourceMod;
+
+// Always-on recorder for slow frames. While SlowFrameThreshold is set, every
+// scope that goes through ProfileToolManager (forwards, timers, frame tasks,
+// database think, profiling events) is kept in a small ring buffer, along
+// with a marker per game frame. When nothing else is profiling, the recorder
+// is also installed as the VM's profiling tool, so plugin functions and
+// natives are recorded as well.
+//
+// When a frame takes longer than the threshold, that frame and the
+// SlowFrameHistory frames before it are written to logs/ as a Chrome Trace
+// Event file.
+//
+// Event names are kept as pointers, so the ring is cleared whenever a plugin
+// unloads.
+class FlightRecorder
+	: public IProfilingTool,
+	  public IPluginsListener,
+	  public SMGlobalClass
+{
+public:
+	FlightRecorder();
+
+	bool IsRecording() const {
+		return recording_;
+	}
+
+	void OnFrame();
+
+	// Takes or gives up the VM's profiling tool slot; a profile started from
+	// the console has priority.
+	void AttachToVM();
+	void DetachFromVM();
+
+	// IProfilingTool
+	const char *Name() override;
+	const char *Description() override;
+	bool Start() override;
+	void Stop(void (*render)(const char *fmt, ...)) override;
+	void Dump() override;
+	bool IsActive() override;
+	bool IsAttached() override;
+	void EnterScope(const char *group, const char *name) override;
+	void LeaveScope() override;
+	void RenderHelp(void (*render)(const char *fmt, ...)) override;
+
+	// IPluginsListener
+	void OnPluginUnloaded(IPlugin *plugin) override;
+
+	// SMGlobalClass
+	ConfigResult OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source,
+	                                      char *error, size_t maxlength) override;
+	void OnSourceModAllInitialized() override;
+	void OnSourceModShutdown() override;
+
+private:
+	enum class EventType : uint8_t
+	{
+		Enter,
+		Leave,
+		Frame
+	};
+
+	struct Event
+	{
+		int64_t ts;
+		const char *group;
+		const char *name;
+		EventType type;
+	};
+
+	static const size_t kRingSize = 1 << 16;
+
+	void Record(EventType type, const char *group, const char *name);
+	void Update();
+	bool Write(int64_t frame_ns, std::string *path);
+
+private:
+	bool recording_;
+	bool initialized_;
+	bool attached_;
+	std::thread::id main_thread_;
+	std::unique_ptr<Event[]> ring_;
+	size_t head_;
+	size_t count_;
+	int64_t last_frame_;
+	int64_t last_dump_;
+	unsigned int threshold_ms_;
+	unsigned int history_;
+};
+
+extern FlightRecorder g_FlightRecorder;
+
+#endif // _include_sourcemod_logic_flight_recorder_h_
@@ -0,0 +1,207 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "ForwardProfiler.h"
+#include "common_logic.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+ForwardProfiler g_ForwardProfiler;
+
+ForwardProfiler::ForwardProfiler()
+	: enabled_(false),
+	  sample_rate_(1),
+	  counter_(0),
+	  started_at_(0),
+	  elapsed_(0)
+{
+}
+
+ForwardProfiler::FuncStats *
+ForwardProfiler::FindOrCreate(IPluginFunction *func, const char *forward)
+{
+	auto iter = live_.find(func);
+	if (iter != live_.end())
+		return iter->second.get();
+
+	std::unique_ptr<FuncStats> stats(new FuncStats());
+	stats->ctx = func->GetParentContext();
+	stats->function = func->DebugName();
+	stats->forward = forward;
+
+	IPlugin *plugin = pluginsys->FindPluginByContext(stats->ctx->GetContext());
+	stats->plugin = plugin ? plugin->GetFilename() : "<unknown>";
+
+	FuncStats *ptr = stats.get();
+	live_.emplace(func, std::move(stats));
+	return ptr;
+}
+
+void
+ForwardProfiler::Record(IPluginFunction *func, const char *forward, int64_t ns)
+{
+	FuncStats *stats = FindOrCreate(func, forward);
+	stats->times.Record(ns > 0 ? uint64_t(ns) : 0);
+}
+
+void
+ForwardProfiler::Start(unsigned int sample_rate)
+{
+	Reset();
+	sample_rate_ = std::max(sample_rate, 1u);
+	counter_ = 0;
+	enabled_ = true;
+	started_at_ = Now();
+}
+
+void
+ForwardProfiler::Stop()
+{
+	if (!enabled_)
+		return;
+	enabled_ = false;
+	elapsed_ += Now() - started_at_;
+}
+
+void
+ForwardProfiler::Reset()
+{
+	live_.clear();
+	retired_.clear();
+	elapsed_ = 0;
+	started_at_ = Now();
+}
+
+void
+ForwardProfiler::OnPluginUnloaded(IPlugin *plugin)
+{
+	// The plugin's IPluginFunction pointers are about to be freed, so move
+	// its entries out of the lookup table. They still show up in dumps.
+	IPluginContext *ctx = plugin->GetBaseContext();
+	for (auto iter = live_.begin(); iter != live_.end(); ) {
+		if (iter->second->ctx == ctx) {
+			iter->second->ctx = nullptr;
+			retired_.push_back(std::move(iter->second));
+			iter = live_.erase(iter);
+		} else {
+			iter++;
+		}
+	}
+}
+
+void
+ForwardProfiler::Dump(size_t limit)
+{
+	std::vector<const FuncStats *> list;
+	for (const auto &entry : live_)
+		list.push_back(entry.second.get());
+	for (const auto &entry : retired_)
+		list.push_back(entry.get());
+
+	if (list.empty()) {
+		rootmenu->ConsolePrint("No forward timings have been recorded.");
+		return;
+	}
+
+	std::sort(list.begin(), list.end(), [](const FuncStats *a, const FuncStats *b) {
+		return a->times.Total() > b->times.Total();
+	});
+
+	int64_t elapsed = elapsed_ + (enabled_ ? Now() - started_at_ : 0);
+	rootmenu->ConsolePrint("Forward timings over %.1fs (sampling 1 in %u, %s):",
+		double(elapsed) / 1e9, sample_rate_, enabled_ ? "running" : "stopped");
+	rootmenu->ConsolePrint("  %10s %10s %9s %9s %9s  %s",
+		"calls", "total ms", "avg us", "p99 us", "max us", "function");
+
+	size_t count = std::min(limit, list.size());
+	for (size_t i = 0; i < count; i++) {
+		const FuncStats *stats = list[i];
+		rootmenu->ConsolePrint("  %10llu %10.2f %9.1f %9.1f %9.1f  %s::%s (%s)%s",
+			(unsigned long long)stats->times.Count(),
+			double(stats->times.Total()) / 1e6,
+			stats->times.Mean() / 1e3,
+			double(stats->times.Percentile(0.99)) / 1e3,
+			double(stats->times.Max()) / 1e3,
+			stats->plugin.c_str(),
+			stats->function.c_str(),
+			stats->forward.c_str(),
+			stats->ctx ? "" : " [unloaded]");
+	}
+	if (count < list.size())
+		rootmenu->ConsolePrint("  ... %u more function(s) not shown.", unsigned(list.size() - count));
+}
+
+void
+ForwardProfiler::OnRootConsoleCommand(const ICommandArgs *args)
+{
+	const char *cmd = args->ArgC() >= 4 ? args->Arg(3) : "";
+
+	if (strcmp(cmd, "start") == 0) {
+		unsigned int sample_rate = 1;
+		if (args->ArgC() >= 5)
+			sample_rate = unsigned(std::max(atoi(args->Arg(4)), 1));
+		if (enabled_) {
+			rootmenu->ConsolePrint("Forward profiling is already active.");
+			return;
+		}
+		Start(sample_rate);
+		rootmenu->ConsolePrint("Started forward profiling (sampling 1 in %u).", sample_rate_);
+		return;
+	}
+	if (strcmp(cmd, "stop") == 0) {
+		if (!enabled_) {
+			rootmenu->ConsolePrint("Forward profiling is not active.");
+			return;
+		}
+		Stop();
+		Dump(25);
+		return;
+	}
+	if (strcmp(cmd, "dump") == 0) {
+		size_t limit = 25;
+		if (args->ArgC() >= 5)
+			limit = size_t(std::max(atoi(args->Arg(4)), 1));
+		Dump(limit);
+		return;
+	}
+	if (strcmp(cmd, "reset") == 0) {
+		Reset();
+		rootmenu->ConsolePrint("Forward timings have been reset.");
+		return;
+	}
+
+	rootmenu->ConsolePrint("Forward profiling commands:");
+	rootmenu->DrawGenericOption("start [n]", "Start timing forward listeners, sampling 1 in n calls.");
+	rootmenu->DrawGenericOption("stop", "Stop timing and dump the results.");
+	rootmenu->DrawGenericOption("dump [n]", "Dump the n most expensive functions (default 25).");
+	rootmenu->DrawGenericOption("reset", "Clear all recorded timings.");
+}
@@ -0,0 +1,110 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _include_sourcemod_logic_forward_profiler_h_
+#define _include_sourcemod_logic_forward_profiler_h_
+
+#include <stdint.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sp_vm_api.h>
+#include <IPluginSys.h>
+#include <IRootConsoleMenu.h>
+#include "LatencyHistogram.h"
+
+using namespace SourcePawn;
+using namespace SourceMod;
+
+// Collects per-function timings for forward listeners. It is independent of
+// the SourcePawn profiling tools, so it can run at the same time as vprof.
+// Timings are inclusive: a listener that fires another forward is charged for
+// that forward's listeners as well.
+class ForwardProfiler
+{
+public:
+	ForwardProfiler();
+
+	bool IsEnabled() const {
+		return enabled_;
+	}
+
+	// Returns true if the current forward execution should be timed. Only one
+	// in every |sample_rate_| executions is sampled.
+	bool Sample() {
+		if (++counter_ < sample_rate_)
+			return false;
+		counter_ = 0;
+		return true;
+	}
+
+	static int64_t Now() {
+		using namespace std::chrono;
+		return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+	}
+
+	void Record(IPluginFunction *func, const char *forward, int64_t ns);
+
+	void Start(unsigned int sample_rate);
+	void Stop();
+	void Reset();
+	void Dump(size_t limit);
+
+	void OnPluginUnloaded(IPlugin *plugin);
+	void OnRootConsoleCommand(const ICommandArgs *args);
+
+private:
+	struct FuncStats
+	{
+		IPluginContext *ctx;
+		std::string plugin;
+		std::string function;
+		std::string forward;
+		LatencyHistogram times;
+	};
+
+	FuncStats *FindOrCreate(IPluginFunction *func, const char *forward);
+
+private:
+	bool enabled_;
+	unsigned int sample_rate_;
+	unsigned int counter_;
+	int64_t started_at_;
+	int64_t elapsed_;
+	std::unordered_map<IPluginFunction *, std::unique_ptr<FuncStats>> live_;
+	std::vector<std::unique_ptr<FuncStats>> retired_;
+};
+
+extern ForwardProfiler g_ForwardProfiler;
+
+#endif // _include_sourcemod_logic_forward_profiler_h_
@@ -30,8 +30,14 @@
 #include <string.h>
 #include "ForwardSys.h"
 #include "DebugReporter.h"
+#include "ForwardProfiler.h"
+#include "PluginSys.h"
+#include "ProfileTools.h"
+#include "PluginTimeTracker.h"
+#include "MetricsExporter.h"
 #include "common_logic.h"
 #include <bridge/include/IScriptManager.h>
+#include <bridge/include/CoreProvider.h>
 #include <amtl/am-string.h>
 #include <ReentrantList.h>
 
@@ -61,6 +67,7 @@ IForward *CForwardManager::CreateForward(const char *name, ExecType et, unsigned
 	{
 		scripts->AddFunctionsToForward(name, fwd);
 
+		fwd->SetSuspended(IsSuspendedName(fwd->GetForwardName()));
 		m_managed.push_back(fwd);
 	}
 
@@ -78,6 +85,7 @@ IChangeableForward *CForwardManager::CreateForwardEx(const char *name, ExecType
 
 	if (fwd)
 	{
+		fwd->SetSuspended(IsSuspendedName(fwd->GetForwardName()));
 		m_unmanaged.push_back(fwd);
 	}
 
@@ -97,6 +105,8 @@ void CForwardManager::OnPluginLoaded(IPlugin *plugin)
 
 void CForwardManager::OnPluginUnloaded(IPlugin *plugin)
 {
+	g_ForwardProfiler.OnPluginUnloaded(plugin);
+
 	for (ForwardIter iter(m_managed); !iter.done(); iter.next()) {
 		CForward *fwd = (*iter);
 		fwd->RemoveFunctionsOfPlugin(plugin);
@@ -142,6 +152,43 @@ void CForwardManager::ReleaseForward(IForward *aForward)
 	delete fwd;
 }
 
+bool CForwardManager::IsSuspendedName(const char *name) const
+{
+	for (size_t i = 0; i < m_SuspendedNames.size(); i++) {
+		if (m_SuspendedNames[i] == name)
+			return true;
+	}
+	return false;
+}
+
+void CForwardManager::SetSuspendedForwards(const char *names)
+{
+	m_SuspendedNames.clear();
+
+	const char *pos = names ? names : "";
+	while (*pos) {
+		const char *end = strchr(pos, ',');
+		if (!end)
+			end = pos + strlen(pos);
+
+		const char *first = pos;
+		const char *last = end;
+		while (first < last && (*first == ' ' || *first == '\t'))
+			first++;
+		while (last > first && (last[-1] == ' ' || last[-1] == '\t'))
+			last--;
+		if (last > first)
+			m_SuspendedNames.push_back(std::string(first, last - first));
+
+		pos = *end ? end + 1 : end;
+	}
+
+	for (ForwardIter iter(m_managed); !iter.done(); iter.next())
+		(*iter)->SetSuspended(IsSuspendedName((*iter)->GetForwardName()));
+	for (ForwardIter iter(m_unmanaged); !iter.done(); iter.next())
+		(*iter)->SetSuspended(IsSuspendedName((*iter)->GetForwardName()));
+}
+
 void CForwardManager::OnPluginPauseChange(IPlugin *plugin, bool paused)
 {
 	if (paused)
@@ -167,10 +214,12 @@ CForward::CForward(ExecType et, const char *name, const ParamType *types, unsign
 	: m_numparams(0),
 	  m_varargs(0),
 	  m_ExecType(et),
+	  m_bSuspended(false),
 	  m_curparam(0),
 	  m_errstate(SP_ERROR_NONE)
 {
 	ke::SafeStrcpy(m_name, sizeof(m_name), name ? name : "");
+	m_bPluginCallback = CPlugin::IsProfiledCallback(m_name);
 
 	for (unsigned i = 0; i < num_params; i++)
 		m_types[i] = types[i];
@@ -233,6 +282,16 @@ int CForward::Execute(cell_t *result, IForwardFilter *filter)
 		return err;
 	}
 
+	if (m_bSuspended)
+	{
+		Cancel();
+		if (result)
+			*result = Pl_Continue;
+		return SP_ERROR_NONE;
+	}
+
+	ForwardMetricsScope metrics;
+
 	cell_t cur_result = 0;
 	cell_t high_result = 0;
 	cell_t low_result = 0;
@@ -240,17 +299,32 @@ int CForward::Execute(cell_t *result, IForwardFilter *filter)
 	unsigned int success=0;
 	unsigned int num_params = m_curparam;
 	FwdParamInfo temp_info[SP_MAX_EXEC_PARAMS];
+	FwdArgInfo args[SP_MAX_EXEC_PARAMS];
+	bool timed = g_ForwardProfiler.IsEnabled() && g_ForwardProfiler.Sample();
 
 	/* Save local, reset */
-	memcpy(temp_info, m_params, sizeof(m_params));
+	memcpy(temp_info, m_params, num_params * sizeof(FwdParamInfo));
 	m_curparam = 0;
 
+	bool scoped = g_ProfileToolManager.IsActive();
+	if (scoped)
+		g_ProfileToolManager.EnterScope("forwards", m_name);
+
+	/* Work out how each parameter is pushed once for the whole call, rather than
+	 * once per listener. A filter may rewrite the parameters for each function,
+	 * so in that case the layout is resolved again after Preprocess().
+	 */
+	_ResolveArgs(temp_info, num_params, args);
+
 	for (FuncIter iter(m_functions); !iter.done(); iter.next())
 	{
 		IPluginFunction *func = (*iter);
 
 		if (filter)
+		{
 			filter->Preprocess(func, temp_info);
+			_ResolveArgs(temp_info, num_params, args);
+		}
 
 		if (func->GetParentRuntime()->IsPaused())
 			continue;
@@ -260,24 +334,21 @@ int CForward::Execute(cell_t *result, IForwardFilter *filter)
 			int err = SP_ERROR_PARAM;
 			FwdParamInfo *param = &temp_info[i];
 
-			ParamType type;
-			if (i >= m_numparams || m_types[i] == Param_Any)
-				type = param->pushedas;
-			else
-				type = m_types[i];
-
-			if ((i >= m_numparams) || (type & SP_PARAMFLAG_BYREF))
-			{
-				/* If we're byref or we're vararg, we always push everything by ref.
-				* Even if they're byval, we must push them byref.
-				*/
-				err = _ExecutePushRef(func, type, param);
-			}
-			else
+			switch (args[i].kind)
 			{
-				/* If we're not byref or not vararg, our job is a bit easier. */
-				assert(type == Param_Cell || type == Param_Float);
+			case FwdArg_Value:
 				err = func->PushCell(param->val);
+				break;
+			case FwdArg_VarValue:
+				/* Varargs are always passed by reference, but nothing reads a
+				 * by-value argument back, so don't ask for a copyback. This also
+				 * keeps one listener from changing what the next one sees.
+				 */
+				err = func->PushCellByRef(&param->val, 0);
+				break;
+			default:
+				err = _ExecutePushRef(func, args[i].type, param);
+				break;
 			}
 
 			if (err != SP_ERROR_NONE)
@@ -291,7 +362,26 @@ int CForward::Execute(cell_t *result, IForwardFilter *filter)
 		}
 		
 		/* Call the function and deal with the return value. */
-		if ((err=func->Execute(&cur_result)) == SP_ERROR_NONE)
+		int64_t start = (timed || m_bPluginCallback) ? ForwardProfiler::Now() : 0;
+		{
+			PluginTimeScope scope(func, m_name);
+			err = func->Execute(&cur_result);
+		}
+		if (timed || m_bPluginCallback)
+		{
+			int64_t ns = ForwardProfiler::Now() - start;
+			if (timed)
+				g_ForwardProfiler.Record(func, m_name, ns);
+			if (m_bPluginCallback)
+			{
+				if (CPlugin *pl = g_PluginSys.GetPluginByCtx(func->GetParentContext()->GetContext())) {
+					pl->RecordCallbackTime(m_name, ns);
+					bridge->RecordStartupStep(pl->GetFilename(), double(ns) / 1000000.0);
+				}
+			}
+		}
+
+		if (err == SP_ERROR_NONE)
 		{
 			success++;
 			switch (m_ExecType)
@@ -367,9 +457,35 @@ done:
 		}
 	}
 
+	if (scoped)
+		g_ProfileToolManager.LeaveScope();
+
 	return SP_ERROR_NONE;
 }
 
+void CForward::_ResolveArgs(const FwdParamInfo *params, unsigned int num_params, FwdArgInfo *args)
+{
+	for (unsigned int i=0; i<num_params; i++)
+	{
+		ParamType type;
+		if (i >= m_numparams || m_types[i] == Param_Any)
+			type = params[i].pushedas;
+		else
+			type = m_types[i];
+
+		args[i].type = type;
+		if (type & SP_PARAMFLAG_BYREF)
+		{
+			args[i].kind = FwdArg_Ref;
+		}
+		else
+		{
+			assert(type == Param_Cell || type == Param_Float);
+			args[i].kind = (i >= m_numparams) ? FwdArg_VarValue : FwdArg_Value;
+		}
+	}
+}
+
 int CForward::_ExecutePushRef(IPluginFunction *func, ParamType type, FwdParamInfo *param)
 {
 	/* If we're byref or we're vararg, we always push everything by ref.
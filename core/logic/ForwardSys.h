@@ -33,9 +33,25 @@
 #include "common_logic.h"
 #include "ISourceMod.h"
 #include "ReentrantList.h"
+#include <string>
+#include <vector>
 
 typedef ReentrantList<IPluginFunction *>::iterator FuncIter;
 
+/* How a forward parameter is handed to each listener. */
+enum FwdArgKind
+{
+	FwdArg_Value,		/* Pushed by value */
+	FwdArg_VarValue,	/* By-value vararg, pushed by reference without copyback */
+	FwdArg_Ref,			/* Pushed by reference, copied back if the caller asked for it */
+};
+
+struct FwdArgInfo
+{
+	ParamType type;
+	FwdArgKind kind;
+};
+
 /* :TODO: a global name max define for sourcepawn, should mirror compiler's sNAMEMAX */
 #define FORWARDS_NAME_MAX		64
 
@@ -68,6 +84,10 @@ public:
 								   const ParamType *types, 
 								   va_list ap);
 	bool IsFunctionRegistered(IPluginFunction *func);
+	inline void SetSuspended(bool suspended)
+	{
+		m_bSuspended = suspended;
+	}
 private:
 	CForward(ExecType et, const char *name,
 	         const ParamType *types, unsigned num_params);
@@ -75,6 +95,7 @@ private:
 	int PushNullString();
 	int PushNullVector();
 	int _ExecutePushRef(IPluginFunction *func, ParamType type, FwdParamInfo *param);
+	void _ResolveArgs(const FwdParamInfo *params, unsigned int num_params, FwdArgInfo *args);
 	void _Int_PushArray(cell_t *inarray, unsigned int cells, int flags);
 	void _Int_PushString(cell_t *inarray, unsigned int cells, int sz_flags, int cp_flags);
 	inline int SetError(int err)
@@ -93,6 +114,8 @@ protected:
 	unsigned int m_numparams;
 	unsigned int m_varargs;
 	ExecType m_ExecType;
+	bool m_bPluginCallback;		/* Listener times are kept for "sm plugins profile" */
+	bool m_bSuspended;			/* Execute() is a no-op while the server is idle */
 
 	/* State information */
 	unsigned int m_curparam;
@@ -118,15 +141,24 @@ public: //IForwardManager
 		...);
 	IForward *FindForward(const char *name, IChangeableForward **ifchng);
 	void ReleaseForward(IForward *forward);
+public:
+	/**
+	 * Suspends every forward, current or future, whose name is in the comma-separated
+	 * list; any forward not in it is resumed. An empty list resumes everything.
+	 */
+	void SetSuspendedForwards(const char *names);
 public: //IPluginsListener
 	void OnPluginLoaded(IPlugin *plugin);
 	void OnPluginUnloaded(IPlugin *plugin);
 	void OnPluginPauseChange(IPlugin *plugin, bool paused);
 public: //SMGlobalClass
 	void OnSourceModAllInitialized();
+private:
+	bool IsSuspendedName(const char *name) const;
 private:
 	ReentrantList<CForward *> m_managed;
 	ReentrantList<CForward *> m_unmanaged;
+	std::vector<std::string> m_SuspendedNames;
 
 	typedef ReentrantList<CForward *>::iterator ForwardIter;
 };
@@ -0,0 +1,282 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "FrameScheduler.h"
+#include "ExtensionSys.h"
+#include "PluginTimeTracker.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <IHandleSys.h>
+#include <ISourceMod.h>
+#include <bridge/include/IScriptManager.h>
+
+FrameScheduler g_FrameScheduler;
+
+/* Default time budget for normal and low priority tasks, in microseconds. */
+static const unsigned int kDefaultBudgetUs = 1000;
+
+static inline int64_t
+Now()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+FrameScheduler::FrameScheduler()
+	: budget_us_(kDefaultBudgetUs),
+	  over_budget_frames_(0),
+	  defer_level_work_(false)
+{
+}
+
+void
+FrameScheduler::AddTask(IdentityToken_t *owner, FrameTaskPriority priority, FRAMETASK fn, void *data)
+{
+	AddTask(owner, priority, fn, data, nullptr);
+}
+
+void
+FrameScheduler::AddTask(IdentityToken_t *owner, FrameTaskPriority priority, FRAMETASK fn, void *data,
+                        FRAMETASK dropped)
+{
+	if (priority < FrameTask_High || priority >= FrameTask_Priorities)
+		priority = FrameTask_Normal;
+
+	Task task = {owner, fn, data, dropped};
+	queues_[priority].push_back(task);
+}
+
+unsigned int
+FrameScheduler::CancelTasks(IdentityToken_t *owner, FRAMETASK fn)
+{
+	unsigned int count = 0;
+	for (size_t i = 0; i < FrameTask_Priorities; i++) {
+		std::deque<Task> &queue = queues_[i];
+		for (auto iter = queue.begin(); iter != queue.end(); ) {
+			if (iter->owner != owner || (fn && iter->fn != fn)) {
+				iter++;
+				continue;
+			}
+
+			Task task = *iter;
+			iter = queue.erase(iter);
+			if (task.dropped)
+				task.dropped(task.data);
+			count++;
+		}
+	}
+	return count;
+}
+
+unsigned int
+FrameScheduler::GetFrameBudget()
+{
+	return budget_us_;
+}
+
+void
+FrameScheduler::RunTask(const Task &task)
+{
+	int64_t start = Now();
+	{
+		PluginTimeScope scope(task.owner, "frame task");
+		task.fn(task.data);
+	}
+	int64_t elapsed = Now() - start;
+
+	OwnerStats &stats = stats_[task.owner];
+	stats.run++;
+	stats.total_ns += elapsed;
+	stats.max_ns = std::max(stats.max_ns, elapsed);
+}
+
+void
+FrameScheduler::RunFrame()
+{
+	// Only tasks that were queued before this frame started are run, so a
+	// task that queues itself again waits for the next frame.
+	size_t counts[FrameTask_Priorities];
+	for (size_t i = 0; i < FrameTask_Priorities; i++)
+		counts[i] = queues_[i].size();
+
+	for (size_t n = counts[FrameTask_High]; n && !queues_[FrameTask_High].empty(); n--) {
+		Task task = queues_[FrameTask_High].front();
+		queues_[FrameTask_High].pop_front();
+		RunTask(task);
+	}
+
+	if (!counts[FrameTask_Normal] && !counts[FrameTask_Low])
+		return;
+
+	int64_t deadline = Now() + int64_t(budget_us_) * 1000;
+	bool ran = false;
+	for (size_t prio = FrameTask_Normal; prio < FrameTask_Priorities; prio++) {
+		std::deque<Task> &queue = queues_[prio];
+		for (size_t n = counts[prio]; n && !queue.empty(); n--) {
+			if (ran && Now() >= deadline) {
+				over_budget_frames_++;
+				return;
+			}
+
+			Task task = queue.front();
+			queue.pop_front();
+			RunTask(task);
+			ran = true;
+		}
+
+		// Low priority tasks only get whatever normal ones leave over.
+		if (!queue.empty())
+			return;
+	}
+}
+
+void
+FrameScheduler::OnPluginUnloaded(IPlugin *plugin)
+{
+	IdentityToken_t *ident = plugin->GetIdentity();
+	CancelTasks(ident, nullptr);
+	stats_.erase(ident);
+}
+
+static const char *
+GetOwnerName(IdentityToken_t *owner)
+{
+	if (!owner || owner == g_pCoreIdent)
+		return "CORE";
+	if (IExtension *ext = g_Extensions.GetExtensionFromIdent(owner))
+		return ext->GetFilename();
+	if (SMPlugin *plugin = scripts->FindPluginByIdentity(owner))
+		return plugin->GetFilename();
+	return "<unknown>";
+}
+
+void
+FrameScheduler::OnRootConsoleCommand(const char *cmdname, const ICommandArgs *args)
+{
+	if (args->ArgC() >= 3 && strcmp(args->Arg(2), "reset") == 0) {
+		stats_.clear();
+		over_budget_frames_ = 0;
+		rootmenu->ConsolePrint("[SM] Frame task statistics have been reset.");
+		return;
+	}
+
+	rootmenu->ConsolePrint("[SM] Frame tasks: budget %u us per frame, %llu frames ran out of budget",
+		budget_us_, (unsigned long long)over_budget_frames_);
+	rootmenu->ConsolePrint("  Pending: %u high, %u normal, %u low",
+		(unsigned int)queues_[FrameTask_High].size(),
+		(unsigned int)queues_[FrameTask_Normal].size(),
+		(unsigned int)queues_[FrameTask_Low].size());
+
+	std::unordered_map<IdentityToken_t *, unsigned int> pending;
+	for (size_t i = 0; i < FrameTask_Priorities; i++) {
+		for (const Task &task : queues_[i])
+			pending[task.owner]++;
+	}
+
+	std::vector<IdentityToken_t *> owners;
+	for (const auto &entry : stats_)
+		owners.push_back(entry.first);
+	for (const auto &entry : pending) {
+		if (stats_.find(entry.first) == stats_.end())
+			owners.push_back(entry.first);
+	}
+	if (owners.empty())
+		return;
+
+	std::sort(owners.begin(), owners.end(), [this](IdentityToken_t *a, IdentityToken_t *b) {
+		return stats_[a].total_ns > stats_[b].total_ns;
+	});
+
+	rootmenu->ConsolePrint("  %-30.30s %8s %10s %10s %10s", "Owner", "Pending", "Run", "Total ms", "Max ms");
+	for (IdentityToken_t *owner : owners) {
+		const OwnerStats &stats = stats_[owner];
+		rootmenu->ConsolePrint("  %-30.30s %8u %10llu %10.2f %10.3f",
+			GetOwnerName(owner), pending[owner], (unsigned long long)stats.run,
+			double(stats.total_ns) / 1000000.0, double(stats.max_ns) / 1000000.0);
+	}
+}
+
+ConfigResult
+FrameScheduler::OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source,
+                                         char *error, size_t maxlength)
+{
+	if (strcmp(key, "DeferLevelChangeWork") == 0) {
+		if (strcasecmp(value, "yes") == 0) {
+			defer_level_work_ = true;
+		} else if (strcasecmp(value, "no") == 0) {
+			defer_level_work_ = false;
+		} else {
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be \"yes\" or \"no\"");
+			return ConfigResult_Reject;
+		}
+		return ConfigResult_Accept;
+	}
+
+	if (strcmp(key, "FrameTaskBudget") != 0)
+		return ConfigResult_Ignore;
+
+	char *end;
+	unsigned long budget = strtoul(value, &end, 10);
+	if (!value[0] || *end != '\0') {
+		ke::SafeStrcpy(error, maxlength, "Invalid value: must be a number of microseconds");
+		return ConfigResult_Reject;
+	}
+	budget_us_ = (unsigned int)budget;
+	return ConfigResult_Accept;
+}
+
+void
+FrameScheduler::OnSourceModAllInitialized()
+{
+	sharesys->AddInterface(NULL, this);
+	pluginsys->AddPluginsListener(this);
+	rootmenu->AddRootConsoleCommand3("frametasks", "Frame task scheduler statistics", this);
+}
+
+void
+FrameScheduler::OnSourceModShutdown()
+{
+	rootmenu->RemoveRootConsoleCommand("frametasks", this);
+	pluginsys->RemovePluginsListener(this);
+
+	for (size_t i = 0; i < FrameTask_Priorities; i++) {
+		for (const Task &task : queues_[i]) {
+			if (task.dropped)
+				task.dropped(task.data);
+		}
+		queues_[i].clear();
+	}
+	stats_.clear();
+}
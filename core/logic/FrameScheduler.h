@@ -0,0 +1,116 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _include_sourcemod_logic_frame_scheduler_h_
+#define _include_sourcemod_logic_frame_scheduler_h_
+
+#include <stdint.h>
+#include <deque>
+#include <unordered_map>
+#include <IFrameScheduler.h>
+#include <IPluginSys.h>
+#include <IRootConsoleMenu.h>
+#include "common_logic.h"
+
+using namespace SourceMod;
+
+// Implements IFrameScheduler. Tasks are kept in one FIFO per priority and
+// drained from the game frame hook; see IFrameScheduler.h for the policy.
+class FrameScheduler
+	: public IFrameScheduler,
+	  public IPluginsListener,
+	  public IRootConsoleCommand,
+	  public SMGlobalClass
+{
+public:
+	FrameScheduler();
+
+	// IFrameScheduler
+	void AddTask(IdentityToken_t *owner, FrameTaskPriority priority, FRAMETASK fn, void *data) override;
+	unsigned int CancelTasks(IdentityToken_t *owner, FRAMETASK fn) override;
+	unsigned int GetFrameBudget() override;
+
+	// Like AddTask(), but |dropped| is called with |data| instead of |fn| if
+	// the task is cancelled, so that the data can be freed.
+	void AddTask(IdentityToken_t *owner, FrameTaskPriority priority, FRAMETASK fn, void *data,
+	             FRAMETASK dropped);
+
+	// Called once per game frame.
+	void RunFrame();
+
+	// Whether level change work that can wait, such as rereading config and
+	// translation files, should be queued here instead of run during the
+	// change ("DeferLevelChangeWork" in core.cfg).
+	bool DeferLevelWork() const {
+		return defer_level_work_;
+	}
+
+	// IPluginsListener
+	void OnPluginUnloaded(IPlugin *plugin) override;
+
+	// IRootConsoleCommand
+	void OnRootConsoleCommand(const char *cmdname, const ICommandArgs *args) override;
+
+	// SMGlobalClass
+	ConfigResult OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source,
+	                                      char *error, size_t maxlength) override;
+	void OnSourceModAllInitialized() override;
+	void OnSourceModShutdown() override;
+
+private:
+	struct Task
+	{
+		IdentityToken_t *owner;
+		FRAMETASK fn;
+		void *data;
+		FRAMETASK dropped;
+	};
+
+	struct OwnerStats
+	{
+		uint64_t run = 0;
+		int64_t total_ns = 0;
+		int64_t max_ns = 0;
+	};
+
+	void RunTask(const Task &task);
+
+private:
+	std::deque<Task> queues_[FrameTask_Priorities];
+	std::unordered_map<IdentityToken_t *, OwnerStats> stats_;
+	unsigned int budget_us_;
+	uint64_t over_budget_frames_;
+	bool defer_level_work_;
+};
+
+extern FrameScheduler g_FrameScheduler;
+
+#endif // _include_sourcemod_logic_frame_scheduler_h_
@@ -43,6 +43,7 @@
 #include <IRootConsoleMenu.h>
 #include "common_logic.h"
 #include "sm_crc32.h"
+#include "GameDataCache.h"
 #include "MemoryUtils.h"
 #include <am-string.h>
 #include <bridge/include/ILogger.h>
@@ -636,6 +637,9 @@ SMCResult CGameConfig::ReadSMC_LeavingSection(const SMCStates *states)
 #endif
 				}
 
+				PendingSignature pending;
+				pending.name = m_offset;
+
 				if (!final_addr)
 				{
 					/* First, preprocess the signature */
@@ -648,13 +652,19 @@ SMCResult CGameConfig::ReadSMC_LeavingSection(const SMCStates *states)
 
 					real_bytes = UTIL_DecodeHexString(real_sig, sizeof(real_sig), s_TempSig.sig);
 
-					if (real_bytes >= 1)
+					if (real_bytes >= 1
+						&& !g_GameConfigs.FindCachedSignature(s_TempSig.library, binInfo, s_TempSig.sig, real_sig, real_bytes, &final_addr))
 					{
-						final_addr = g_MemUtils.FindPattern(addrInBase, (char*) real_sig, real_bytes);
+						/* Leave the scan for ResolvePendingSignatures */
+						pending.library = s_TempSig.library;
+						pending.sig = s_TempSig.sig;
+						pending.pattern.assign((const char *)real_sig, real_bytes);
+						pending.binInfo = binInfo;
 					}
 				}
 
-				m_Sigs.replace(m_offset.c_str(), final_addr);
+				pending.addr = final_addr;
+				m_PendingSigs.push_back(std::move(pending));
 			}
 
 			m_ParseState = PSTATE_GAMEDEFS_SIGNATURES;
@@ -959,7 +969,7 @@ bool CGameConfig::EnterFile(const char *file, char *error, size_t maxlength)
 		}
 
 		this->SetParseEngine(pEngine[iter]);
-		if ((err=textparsers->ParseSMCFile(m_CurFile, this, &state, error, maxlength))
+		if ((err=ParseGameDataFile(m_CurFile, this, &state, error, maxlength))
 			!= SMCError_Okay)
 		{
 			const char *msg = textparsers->GetSMCErrorString(err);
@@ -979,13 +989,65 @@ bool CGameConfig::EnterFile(const char *file, char *error, size_t maxlength)
 				m_CustomLevel = 0;
 			}
 
+			ResolvePendingSignatures();
 			return false;
 		}
 	}
 
+	ResolvePendingSignatures();
 	return true;
 }
 
+void CGameConfig::ResolvePendingSignatures()
+{
+	/* Find every pattern from the same library in a single pass over it */
+	std::vector<MemoryPattern> patterns;
+	std::vector<size_t> owners;
+	std::vector<void *> results;
+	for (size_t i = 0; i < m_PendingSigs.size(); i++)
+	{
+		if (m_PendingSigs[i].pattern.empty())
+		{
+			continue;
+		}
+
+		void *addrInBase = m_PendingSigs[i].binInfo.m_pAddr;
+		patterns.clear();
+		owners.clear();
+		for (size_t j = i; j < m_PendingSigs.size(); j++)
+		{
+			const PendingSignature &sig = m_PendingSigs[j];
+			if (!sig.pattern.empty() && sig.binInfo.m_pAddr == addrInBase)
+			{
+				MemoryPattern pattern = { sig.pattern.data(), sig.pattern.size() };
+				patterns.push_back(pattern);
+				owners.push_back(j);
+			}
+		}
+
+		results.resize(patterns.size());
+		g_MemUtils.FindPatterns(addrInBase, patterns.data(), patterns.size(), results.data());
+
+		for (size_t k = 0; k < owners.size(); k++)
+		{
+			PendingSignature &sig = m_PendingSigs[owners[k]];
+			sig.addr = results[k];
+			if (sig.addr)
+			{
+				g_GameConfigs.CacheSignature(sig.library.c_str(), sig.binInfo, sig.sig.c_str(), sig.addr);
+			}
+			sig.pattern.clear();
+		}
+	}
+
+	/* Apply in file order so later entries still override earlier ones */
+	for (size_t i = 0; i < m_PendingSigs.size(); i++)
+	{
+		m_Sigs.replace(m_PendingSigs[i].name.c_str(), m_PendingSigs[i].addr);
+	}
+	m_PendingSigs.clear();
+}
+
 void CGameConfig::SetBaseEngine(const char *engine)
 {
 	m_pBaseEngine = engine;
@@ -1124,7 +1186,7 @@ void GameBinPathManager::Init()
 	}
 }
 
-GameConfigManager::GameConfigManager()
+GameConfigManager::GameConfigManager() : m_SigCacheLoaded(false), m_SigCacheDirty(false)
 {
 }
 
@@ -1135,6 +1197,10 @@ GameConfigManager::~GameConfigManager()
 void GameConfigManager::OnSourceModStartup(bool late)
 {
 	m_gameBinPathManager.Init();
+
+	/* Nearly every gamedata file needs these, start identifying them now */
+	PrefetchGameBinaryInfo("engine");
+	PrefetchGameBinaryInfo("server");
 	
 	LoadGameConfigFile("core.games", &g_pGameConf, NULL, 0);
 
@@ -1143,6 +1209,21 @@ void GameConfigManager::OnSourceModStartup(bool late)
 	bridge->GetGameName(g_GameName + 1, sizeof(g_GameName) - 1);
 }
 
+bool GameConfigManager::HasPreloadWork()
+{
+	return true;
+}
+
+void GameConfigManager::OnSourceModPreload()
+{
+	PrecompileSMCFolder("gamedata_cache", "gamedata", true);
+}
+
+const char *GameConfigManager::GetGlobalClassName()
+{
+	return "GameConfigManager";
+}
+
 void GameConfigManager::OnSourceModAllInitialized()
 {
 	/* NOW initialize the game file */
@@ -1160,6 +1241,10 @@ void GameConfigManager::OnSourceModAllInitialized()
 void GameConfigManager::OnSourceModAllShutdown()
 {
 	CloseGameConfigFile(g_pGameConf);
+	SaveSignatureCache();
+
+	/* Waits on anything still running */
+	m_pendingBinInfos.clear();
 }
 
 bool GameConfigManager::LoadGameConfigFile(const char *file, IGameConfig **_pConfig, char *error, size_t maxlength)
@@ -1202,6 +1287,9 @@ bool GameConfigManager::LoadGameConfigFile(const char *file, IGameConfig **_pCon
 
 	m_Lookup.insert(file, pConfig);
 
+	/* Persist anything we had to scan for, in case we don't shut down cleanly */
+	SaveSignatureCache();
+
 	*_pConfig = pConfig;
 	return retval;
 }
@@ -1259,17 +1347,15 @@ void GameConfigManager::RemoveCachedConfig(CGameConfig *config)
 	m_Lookup.remove(config->m_File);
 }
 
-void GameConfigManager::CacheGameBinaryInfo(const char* pszName)
+/* Doesn't touch any shared state, so it can run on a worker thread */
+static GameBinaryInfo ComputeGameBinaryInfo(std::string name, std::vector<std::string> paths)
 {
 	GameBinaryInfo info;
 
-	char name[64];
-	bridge->FormatSourceBinaryName(pszName, name, sizeof(name));
-
 	char binary_path[PLATFORM_MAX_PATH];
-	for (auto it = m_gameBinPathManager.Paths().begin(); it != m_gameBinPathManager.Paths().end(); ++it)
+	for (auto it = paths.begin(); it != paths.end(); ++it)
 	{
-		ke::SafeSprintf(binary_path, sizeof(binary_path), "%s%s%s", it->c_str(), it->back() == PLATFORM_SEP_CHAR ? "" : PLATFORM_SEP, name);
+		ke::SafeSprintf(binary_path, sizeof(binary_path), "%s%s%s", it->c_str(), it->back() == PLATFORM_SEP_CHAR ? "" : PLATFORM_SEP, name.c_str());
 #if defined PLATFORM_WINDOWS
 		HMODULE hModule = LoadLibraryA(binary_path);
 		if (hModule)
@@ -1317,6 +1403,39 @@ void GameConfigManager::CacheGameBinaryInfo(const char* pszName)
 		}
 	}
 
+	return info;
+}
+
+void GameConfigManager::PrefetchGameBinaryInfo(const char* pszName)
+{
+	GameBinaryInfo info;
+	if (m_gameBinInfos.retrieve(pszName, &info) || m_pendingBinInfos.count(pszName))
+		return;
+
+	char name[64];
+	bridge->FormatSourceBinaryName(pszName, name, sizeof(name));
+
+	m_pendingBinInfos[pszName] = std::async(std::launch::async, ComputeGameBinaryInfo,
+		std::string(name), m_gameBinPathManager.Paths());
+}
+
+void GameConfigManager::CacheGameBinaryInfo(const char* pszName)
+{
+	GameBinaryInfo info;
+
+	auto pending = m_pendingBinInfos.find(pszName);
+	if (pending != m_pendingBinInfos.end())
+	{
+		info = pending->second.get();
+		m_pendingBinInfos.erase(pending);
+	}
+	else
+	{
+		char name[64];
+		bridge->FormatSourceBinaryName(pszName, name, sizeof(name));
+		info = ComputeGameBinaryInfo(name, m_gameBinPathManager.Paths());
+	}
+
 	// But insert regardless, to cache the first lookup (even as failed)
 	m_gameBinInfos.insert(pszName, info);
 }
@@ -1330,3 +1449,166 @@ bool GameConfigManager::TryGetGameBinaryInfo(const char* pszName, GameBinaryInfo
 
 	return m_gameBinInfos.retrieve(pszName, pDest);
 }
+
+static std::string MakeSignatureCacheKey(const char *library, uint32_t crc, const char *sig)
+{
+	char crcstr[16];
+	ke::SafeSprintf(crcstr, sizeof(crcstr), "%08X", crc);
+
+	std::string key(library);
+	key += ' ';
+	key += crcstr;
+	key += ' ';
+	key += sig;
+	return key;
+}
+
+void GameConfigManager::LoadSignatureCache()
+{
+	m_SigCacheLoaded = true;
+
+	char path[PLATFORM_MAX_PATH];
+	g_pSM->BuildPath(Path_SM, path, sizeof(path), "data/gamedata_sigcache.txt");
+
+	FILE *fp = fopen(path, "rt");
+	if (!fp)
+	{
+		return;
+	}
+
+	/* Each line is: <library> <crc32> <offset> <signature> */
+	char line[2048];
+	while (fgets(line, sizeof(line), fp))
+	{
+		char library[64];
+		unsigned int crc;
+		unsigned long long offset;
+		int sigpos;
+		if (sscanf(line, "%63s %x %llx %n", library, &crc, &offset, &sigpos) != 3)
+		{
+			continue;
+		}
+
+		char *sig = &line[sigpos];
+		size_t len = strlen(sig);
+		while (len > 0 && (sig[len - 1] == '\n' || sig[len - 1] == '\r'))
+		{
+			sig[--len] = '\0';
+		}
+		if (len == 0)
+		{
+			continue;
+		}
+
+		CachedSignature entry;
+		entry.library = library;
+		entry.crc = crc;
+		entry.sig = sig;
+		entry.offset = (uintptr_t)offset;
+		m_SigCache[MakeSignatureCacheKey(library, crc, sig)] = entry;
+	}
+
+	fclose(fp);
+}
+
+void GameConfigManager::SaveSignatureCache()
+{
+	if (!m_SigCacheDirty)
+	{
+		return;
+	}
+	m_SigCacheDirty = false;
+
+	char path[PLATFORM_MAX_PATH];
+	g_pSM->BuildPath(Path_SM, path, sizeof(path), "data/gamedata_sigcache.txt");
+
+	FILE *fp = fopen(path, "wt");
+	if (!fp)
+	{
+		return;
+	}
+
+	for (auto iter = m_SigCache.begin(); iter != m_SigCache.end(); ++iter)
+	{
+		const CachedSignature &entry = iter->second;
+
+		/* Drop entries for binaries that have been updated since */
+		GameBinaryInfo info;
+		if (m_gameBinInfos.retrieve(entry.library.c_str(), &info) && info.m_crcOK && info.m_crc != entry.crc)
+		{
+			continue;
+		}
+
+		fprintf(fp, "%s %08X %llx %s\n", entry.library.c_str(), entry.crc, (unsigned long long)entry.offset, entry.sig.c_str());
+	}
+
+	fclose(fp);
+}
+
+bool GameConfigManager::FindCachedSignature(const char *library, const GameBinaryInfo &info, const char *sig,
+	const unsigned char *pattern, size_t len, void **addr)
+{
+	/* Without a CRC we can't tell whether the binary changed */
+	if (!info.m_crcOK)
+	{
+		return false;
+	}
+
+	if (!m_SigCacheLoaded)
+	{
+		LoadSignatureCache();
+	}
+
+	auto iter = m_SigCache.find(MakeSignatureCacheKey(library, info.m_crc, sig));
+	if (iter == m_SigCache.end())
+	{
+		return false;
+	}
+
+	const DynLibInfo *lib = g_MemUtils.GetLibraryInfo(info.m_pAddr);
+	uintptr_t offset = iter->second.offset;
+	if (!lib || offset + len > lib->memorySize)
+	{
+		return false;
+	}
+
+	/* Make sure the bytes still match, same as FindPattern would check them */
+	const char *ptr = lib->originalCopy.get() + offset;
+	for (size_t i = 0; i < len; i++)
+	{
+		if (pattern[i] != '\x2A' && (char)pattern[i] != ptr[i])
+		{
+			return false;
+		}
+	}
+
+	*addr = reinterpret_cast<char *>(lib->baseAddress) + offset;
+	return true;
+}
+
+void GameConfigManager::CacheSignature(const char *library, const GameBinaryInfo &info, const char *sig, void *addr)
+{
+	if (!info.m_crcOK)
+	{
+		return;
+	}
+
+	if (!m_SigCacheLoaded)
+	{
+		LoadSignatureCache();
+	}
+
+	const DynLibInfo *lib = g_MemUtils.GetLibraryInfo(info.m_pAddr);
+	if (!lib)
+	{
+		return;
+	}
+
+	CachedSignature entry;
+	entry.library = library;
+	entry.crc = info.m_crc;
+	entry.sig = sig;
+	entry.offset = reinterpret_cast<uintptr_t>(addr) - reinterpret_cast<uintptr_t>(lib->baseAddress);
+	m_SigCache[MakeSignatureCacheKey(library, info.m_crc, sig)] = entry;
+	m_SigCacheDirty = true;
+}
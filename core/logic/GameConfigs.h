@@ -39,11 +39,21 @@
 #include <sm_hashmap.h>
 #include <sm_namehashset.h>
 #include <unordered_set>
+#include <unordered_map>
+#include <vector>
+#include <future>
 
 using namespace SourceMod;
 
 class SendProp;
 
+struct GameBinaryInfo
+{
+	void *m_pAddr = nullptr;
+	uint32_t m_crc = 0;
+	bool m_crcOK = false;
+};
+
 class CGameConfig : 
 	public ITextListener_SMC,
 	public IGameConfig,
@@ -58,6 +68,7 @@ public:
 	bool EnterFile(const char *file, char *error, size_t maxlength);
 	void SetBaseEngine(const char *engine);
 	void SetParseEngine(const char *engine);
+	void ResolvePendingSignatures();
 public: //ITextListener_SMC
 	SMCResult ReadSMC_NewSection(const SMCStates *states, const char *name);
 	SMCResult ReadSMC_KeyValue(const SMCStates *states, const char *key, const char *value);
@@ -84,6 +95,18 @@ private:
 	StringHashMap<SendProp *> m_Props;
 	StringHashMap<std::string> m_Keys;
 	StringHashMap<void *> m_Sigs;
+
+	/* Signatures seen in the current file, scanned for together once it's parsed */
+	struct PendingSignature
+	{
+		std::string name;
+		void *addr;
+		std::string library;
+		std::string sig;
+		std::string pattern;
+		GameBinaryInfo binInfo;
+	};
+	std::vector<PendingSignature> m_PendingSigs;
 	/* Parse states */
 	int m_ParseState;
 	unsigned int m_IgnoreLevel;
@@ -129,13 +152,6 @@ private:
 	time_t m_ModTime;
 };
 
-struct GameBinaryInfo
-{
-	void *m_pAddr = nullptr;
-	uint32_t m_crc = 0;
-	bool m_crcOK = false;
-};
-
 class GameBinPathManager
 {
 public:
@@ -172,16 +188,38 @@ public: //IGameConfigManager
 	void ReleaseLock();
 public: //SMGlobalClass
 	void OnSourceModStartup(bool late);
+	bool HasPreloadWork();
+	void OnSourceModPreload();
 	void OnSourceModAllInitialized();
 	void OnSourceModAllShutdown();
+	const char *GetGlobalClassName();
 public:
 	bool TryGetGameBinaryInfo(const char* pszName, GameBinaryInfo* pDest);
 	void RemoveCachedConfig(CGameConfig *config);
+	bool FindCachedSignature(const char *library, const GameBinaryInfo &info, const char *sig,
+		const unsigned char *pattern, size_t len, void **addr);
+	void CacheSignature(const char *library, const GameBinaryInfo &info, const char *sig, void *addr);
+	void SaveSignatureCache();
 private:
 	void CacheGameBinaryInfo(const char* pszName);
+	void PrefetchGameBinaryInfo(const char* pszName);
+	void LoadSignatureCache();
 private:
 	NameHashSet<CGameConfig *> m_Lookup;
 	StringHashMap<GameBinaryInfo> m_gameBinInfos;
+	/* Binary lookups still running on a worker thread */
+	std::unordered_map<std::string, std::future<GameBinaryInfo>> m_pendingBinInfos;
+	/* Resolved signature offsets, keyed by library, binary CRC and signature */
+	struct CachedSignature
+	{
+		std::string library;
+		uint32_t crc;
+		std::string sig;
+		uintptr_t offset;
+	};
+	std::unordered_map<std::string, CachedSignature> m_SigCache;
+	bool m_SigCacheLoaded;
+	bool m_SigCacheDirty;
 public:
 	StringHashMap<ITextListener_SMC *> m_customHandlers;
 	GameBinPathManager m_gameBinPathManager;
@@ -0,0 +1,418 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2024 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "common_logic.h"
+#include "GameDataCache.h"
+#include "sm_crc32.h"
+#include <ILibrarySys.h>
+#include <ISourceMod.h>
+#include <am-string.h>
+#include <stdio.h>
+#include <string.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define GAMEDATA_CACHE_MAGIC	0x44474D53		/* "SMGD" */
+#define GAMEDATA_CACHE_VERSION	2
+
+enum CachedEventType
+{
+	CachedEvent_NewSection,
+	CachedEvent_KeyValue,
+	CachedEvent_LeavingSection,
+};
+
+struct CachedEvent
+{
+	CachedEventType type;
+	SMCStates states;
+	const char *first;
+	const char *second;
+};
+
+static void WriteUInt32(std::string &out, uint32_t value)
+{
+	out.append((const char *)&value, sizeof(value));
+}
+
+static void WriteString(std::string &out, const char *str)
+{
+	uint32_t len = (uint32_t)strlen(str);
+	WriteUInt32(out, len);
+	out.append(str, len + 1);
+}
+
+static bool ReadUInt32(const char *&ptr, const char *end, uint32_t *value)
+{
+	if ((size_t)(end - ptr) < sizeof(uint32_t))
+	{
+		return false;
+	}
+	memcpy(value, ptr, sizeof(uint32_t));
+	ptr += sizeof(uint32_t);
+	return true;
+}
+
+static bool ReadString(const char *&ptr, const char *end, const char **str)
+{
+	uint32_t len;
+	if (!ReadUInt32(ptr, end, &len) || (size_t)(end - ptr) <= len || ptr[len] != '\0')
+	{
+		return false;
+	}
+	*str = ptr;
+	ptr += len + 1;
+	return true;
+}
+
+static bool ReadWholeFile(const char *path, std::string &out)
+{
+	FILE *fp = fopen(path, "rb");
+	if (!fp)
+	{
+		return false;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	bool ok = size >= 0;
+	if (ok)
+	{
+		out.resize((size_t)size);
+		ok = size == 0 || fread(&out[0], (size_t)size, 1, fp) == 1;
+	}
+
+	fclose(fp);
+	return ok;
+}
+
+/**
+ * Forwards parse events to the real listener, and records them in the
+ * compiled format as they go by.
+ */
+class GameDataRecorder : public ITextListener_SMC
+{
+public:
+	GameDataRecorder(ITextListener_SMC *listener) : m_Listener(listener), m_NumEvents(0), m_Halted(false)
+	{
+	}
+public:
+	void ReadSMC_ParseStart()
+	{
+		m_Listener->ReadSMC_ParseStart();
+	}
+	void ReadSMC_ParseEnd(bool halted, bool failed)
+	{
+		m_Listener->ReadSMC_ParseEnd(halted, failed);
+	}
+	SMCResult ReadSMC_NewSection(const SMCStates *states, const char *name)
+	{
+		Record(CachedEvent_NewSection, states, name, NULL);
+		return Check(m_Listener->ReadSMC_NewSection(states, name));
+	}
+	SMCResult ReadSMC_KeyValue(const SMCStates *states, const char *key, const char *value)
+	{
+		Record(CachedEvent_KeyValue, states, key, value);
+		return Check(m_Listener->ReadSMC_KeyValue(states, key, value));
+	}
+	SMCResult ReadSMC_LeavingSection(const SMCStates *states)
+	{
+		Record(CachedEvent_LeavingSection, states, NULL, NULL);
+		return Check(m_Listener->ReadSMC_LeavingSection(states));
+	}
+	SMCResult ReadSMC_RawLine(const SMCStates *states, const char *line)
+	{
+		return Check(m_Listener->ReadSMC_RawLine(states, line));
+	}
+private:
+	void Record(CachedEventType type, const SMCStates *states, const char *first, const char *second)
+	{
+		WriteUInt32(m_Events, (uint32_t)type);
+		WriteUInt32(m_Events, states->line);
+		WriteUInt32(m_Events, states->col);
+		if (first)
+		{
+			WriteString(m_Events, first);
+		}
+		if (second)
+		{
+			WriteString(m_Events, second);
+		}
+		m_NumEvents++;
+	}
+	SMCResult Check(SMCResult res)
+	{
+		/* A halted parse didn't see the whole file, so it can't be cached */
+		if (res != SMCResult_Continue)
+		{
+			m_Halted = true;
+		}
+		return res;
+	}
+public:
+	ITextListener_SMC *m_Listener;
+	std::string m_Events;
+	uint32_t m_NumEvents;
+	bool m_Halted;
+};
+
+static void GetCachePath(const char *cachedir, const char *file, char *buffer, size_t maxlength)
+{
+	g_pSM->BuildPath(Path_SM, buffer, maxlength, "data/%s/%08X.bin", cachedir, UTIL_CRC32(file, strlen(file)));
+}
+
+static bool LoadCachedEvents(const std::string &cache, const char *file, uint32_t crc, uint32_t size,
+							 std::vector<CachedEvent> &events)
+{
+	const char *ptr = cache.data();
+	const char *end = ptr + cache.size();
+
+	uint32_t magic, version, cachedCrc, cachedSize, numEvents;
+	const char *cachedFile;
+	if (!ReadUInt32(ptr, end, &magic) || magic != GAMEDATA_CACHE_MAGIC
+		|| !ReadUInt32(ptr, end, &version) || version != GAMEDATA_CACHE_VERSION
+		|| !ReadUInt32(ptr, end, &cachedCrc) || cachedCrc != crc
+		|| !ReadUInt32(ptr, end, &cachedSize) || cachedSize != size
+		|| !ReadString(ptr, end, &cachedFile) || strcmp(cachedFile, file) != 0
+		|| !ReadUInt32(ptr, end, &numEvents))
+	{
+		return false;
+	}
+
+	/* Validate everything up front, so a damaged cache never half-runs */
+	events.reserve(numEvents);
+	for (uint32_t i = 0; i < numEvents; i++)
+	{
+		CachedEvent ev;
+		uint32_t type, line, col;
+		if (!ReadUInt32(ptr, end, &type) || !ReadUInt32(ptr, end, &line) || !ReadUInt32(ptr, end, &col))
+		{
+			return false;
+		}
+
+		ev.type = (CachedEventType)type;
+		ev.states.line = line;
+		ev.states.col = col;
+		ev.first = NULL;
+		ev.second = NULL;
+
+		switch (ev.type)
+		{
+		case CachedEvent_NewSection:
+			if (!ReadString(ptr, end, &ev.first))
+				return false;
+			break;
+		case CachedEvent_KeyValue:
+			if (!ReadString(ptr, end, &ev.first) || !ReadString(ptr, end, &ev.second))
+				return false;
+			break;
+		case CachedEvent_LeavingSection:
+			break;
+		default:
+			return false;
+		}
+
+		events.push_back(ev);
+	}
+
+	return ptr == end;
+}
+
+static SMCError ReplayEvents(const std::vector<CachedEvent> &events, ITextListener_SMC *listener, SMCStates *states)
+{
+	SMCStates last = {1, 0};
+
+	listener->ReadSMC_ParseStart();
+
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		const CachedEvent &ev = events[i];
+		last = ev.states;
+
+		SMCResult res;
+		switch (ev.type)
+		{
+		case CachedEvent_NewSection:
+			res = listener->ReadSMC_NewSection(&last, ev.first);
+			break;
+		case CachedEvent_KeyValue:
+			res = listener->ReadSMC_KeyValue(&last, ev.first, ev.second);
+			break;
+		default:
+			res = listener->ReadSMC_LeavingSection(&last);
+			break;
+		}
+
+		if (res != SMCResult_Continue)
+		{
+			SMCError err = (res == SMCResult_HaltFail) ? SMCError_Custom : SMCError_Okay;
+			if (states != NULL)
+			{
+				*states = last;
+			}
+			listener->ReadSMC_ParseEnd(true, (err == SMCError_Custom));
+			return err;
+		}
+	}
+
+	listener->ReadSMC_ParseEnd(false, false);
+
+	if (states != NULL)
+	{
+		*states = last;
+	}
+
+	return SMCError_Okay;
+}
+
+static void WriteCache(const char *cachedir, const char *file, uint32_t crc, uint32_t size,
+					   const GameDataRecorder &recorder)
+{
+	char path[PLATFORM_MAX_PATH];
+	g_pSM->BuildPath(Path_SM, path, sizeof(path), "data/%s", cachedir);
+	if (!libsys->IsPathDirectory(path) && !libsys->CreateFolder(path))
+	{
+		return;
+	}
+
+	std::string out;
+	WriteUInt32(out, GAMEDATA_CACHE_MAGIC);
+	WriteUInt32(out, GAMEDATA_CACHE_VERSION);
+	WriteUInt32(out, crc);
+	WriteUInt32(out, size);
+	WriteString(out, file);
+	WriteUInt32(out, recorder.m_NumEvents);
+	out += recorder.m_Events;
+
+	GetCachePath(cachedir, file, path, sizeof(path));
+	FILE *fp = fopen(path, "wb");
+	if (!fp)
+	{
+		return;
+	}
+
+	fwrite(out.data(), out.size(), 1, fp);
+	fclose(fp);
+}
+
+SMCError ParseGameDataFile(const char *file,
+						   ITextListener_SMC *listener,
+						   SMCStates *states,
+						   char *error,
+						   size_t maxlength)
+{
+	return ParseCachedSMCFile("gamedata_cache", file, listener, states, error, maxlength);
+}
+
+SMCError ParseCachedSMCFile(const char *cachedir,
+							const char *file,
+							ITextListener_SMC *listener,
+							SMCStates *states,
+							char *error,
+							size_t maxlength)
+{
+	std::string text;
+	if (!ReadWholeFile(file, text))
+	{
+		/* Let the text parser produce the usual error */
+		return textparsers->ParseSMCFile(file, listener, states, error, maxlength);
+	}
+
+	uint32_t crc = UTIL_CRC32C(text.data(), text.size());
+	uint32_t size = (uint32_t)text.size();
+
+	char path[PLATFORM_MAX_PATH];
+	GetCachePath(cachedir, file, path, sizeof(path));
+
+	std::string cache;
+	std::vector<CachedEvent> events;
+	if (ReadWholeFile(path, cache) && LoadCachedEvents(cache, file, crc, size, events))
+	{
+		SMCError err = ReplayEvents(events, listener, states);
+		const char *errstr = textparsers->GetSMCErrorString(err);
+		ke::SafeStrcpy(error, maxlength, errstr != NULL ? errstr : "Unknown error");
+		return err;
+	}
+
+	GameDataRecorder recorder(listener);
+	SMCError err = textparsers->ParseSMCStream(text.data(), text.size(), &recorder, states, error, maxlength);
+	if (err == SMCError_Okay && !recorder.m_Halted)
+	{
+		WriteCache(cachedir, file, crc, size, recorder);
+	}
+
+	return err;
+}
+
+void PrecompileSMCFolder(const char *cachedir, const char *folder, bool recurse)
+{
+	char path[PLATFORM_MAX_PATH];
+	g_pSM->BuildPath(Path_SM, path, sizeof(path), "%s", folder);
+
+	std::unique_ptr<IDirectory> dir(libsys->OpenDirectory(path));
+	if (!dir)
+	{
+		return;
+	}
+
+	ITextListener_SMC listener;
+	for (; dir->MoreFiles(); dir->NextEntry())
+	{
+		const char *name = dir->GetEntryName();
+		if (dir->IsEntryDirectory())
+		{
+			if (recurse && name[0] != '.')
+			{
+				char sub[PLATFORM_MAX_PATH];
+				ke::SafeSprintf(sub, sizeof(sub), "%s/%s", folder, name);
+				PrecompileSMCFolder(cachedir, sub, recurse);
+			}
+			continue;
+		}
+
+		size_t len = strlen(name);
+		if (!dir->IsEntryFile() || len < 4 || strcmp(&name[len - 4], ".txt") != 0)
+		{
+			continue;
+		}
+
+		/* Same path form the real loads use, since the cache is keyed by it. */
+		char file[PLATFORM_MAX_PATH];
+		g_pSM->BuildPath(Path_SM, file, sizeof(file), "%s/%s", folder, name);
+
+		SMCStates states;
+		char error[256];
+		ParseCachedSMCFile(cachedir, file, &listener, &states, error, sizeof(error));
+	}
+}
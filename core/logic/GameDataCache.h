@@ -0,0 +1,88 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2024 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_SOURCEMOD_GAMEDATA_CACHE_H_
+#define _INCLUDE_SOURCEMOD_GAMEDATA_CACHE_H_
+
+#include <ITextParsers.h>
+
+using namespace SourceMod;
+
+/**
+ * Parses a gamedata file the same way ITextParsers::ParseSMCFile does, but
+ * replays the parse events from a compiled copy in data/gamedata_cache when
+ * the file's CRC32C still matches the one it was compiled from. The compiled
+ * copy is (re)written whenever the text file has to be parsed.
+ *
+ * @param file			Path of the text file.
+ * @param listener		Listener to receive the parse events.
+ * @param states		Optional, receives the last parse state.
+ * @param error			Buffer for an error message.
+ * @param maxlength		Maximum length of the error buffer.
+ * @return				SMCError_Okay on success.
+ */
+SMCError ParseGameDataFile(const char *file,
+						   ITextListener_SMC *listener,
+						   SMCStates *states,
+						   char *error,
+						   size_t maxlength);
+
+/**
+ * Same as ParseGameDataFile, but keeps the compiled copy in data/<cachedir>
+ * so other kinds of config files can share the cache format.
+ *
+ * @param cachedir		Folder name under data/ for the compiled copy.
+ * @param file			Path of the text file.
+ * @param listener		Listener to receive the parse events.
+ * @param states		Optional, receives the last parse state.
+ * @param error			Buffer for an error message.
+ * @param maxlength		Maximum length of the error buffer.
+ * @return				SMCError_Okay on success.
+ */
+SMCError ParseCachedSMCFile(const char *cachedir,
+							const char *file,
+							ITextListener_SMC *listener,
+							SMCStates *states,
+							char *error,
+							size_t maxlength);
+
+/**
+ * Brings the compiled copy of every .txt file in a folder under the
+ * SourceMod path up to date, without delivering any parse events. Touches
+ * nothing but the files themselves, so it is safe to run off the main thread.
+ *
+ * @param cachedir		Folder name under data/ for the compiled copies.
+ * @param folder		Folder to scan, relative to the SourceMod path.
+ * @param recurse		Whether to descend into subfolders.
+ */
+void PrecompileSMCFolder(const char *cachedir, const char *folder, bool recurse);
+
+#endif //_INCLUDE_SOURCEMOD_GAMEDATA_CACHE_H_
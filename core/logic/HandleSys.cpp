@@ -32,7 +32,11 @@
 #include "HandleSys.h"
 #include <time.h>
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
 #include "common_logic.h"
 #include "ShareSys.h"
 #include "ExtensionSys.h"
@@ -41,6 +45,7 @@
 #include <bridge/include/ILogger.h>
 #include <bridge/include/CoreProvider.h>
 #include <ISourceMod.h>
+#include <ITimerSystem.h>
 
 #include "sm_platform.h"
 #ifdef PLATFORM_WINDOWS
@@ -66,6 +71,9 @@ inline HandleError IdentityHandle(IdentityToken_t *token, unsigned int *index)
 
 HandleSystem::HandleSystem()
 {
+	m_HotHandles = new QHandleHot[HANDLESYS_MAX_HANDLES + 1];
+	memset(m_HotHandles, 0, sizeof(QHandleHot) * (HANDLESYS_MAX_HANDLES + 1));
+
 	m_Handles = new QHandle[HANDLESYS_MAX_HANDLES + 1];
 	memset(m_Handles, 0, sizeof(QHandle) * (HANDLESYS_MAX_HANDLES + 1));
 
@@ -73,10 +81,15 @@ HandleSystem::HandleSystem()
 	memset(m_Types, 0, sizeof(QHandleType) * HANDLESYS_TYPEARRAY_SIZE);
 
 	m_TypeTail = 0;
+	m_HandlesCreated = 0;
+	m_SampleCursor = 0;
+	m_AllocSampleRate = 0;
+	m_AllocSampleCountdown = 0;
 }
 
 HandleSystem::~HandleSystem()
 {
+	delete [] m_HotHandles;
 	delete [] m_Handles;
 	delete [] m_Types;
 }
@@ -324,26 +337,32 @@ HandleError HandleSystem::MakePrimHandle(HandleType_t type,
 	}
 
 	QHandle *pHandle = &m_Handles[handle];
+	QHandleHot *pHot = &m_HotHandles[handle];
 	
-	assert(pHandle->set == false);
+	assert(pHot->set == HandleSet_None);
 
 	if (++m_HSerial >= HANDLESYS_MAX_SERIALS)
 	{
 		m_HSerial = 1;
 	}
+	m_HandlesCreated++;
 
 	/* Set essential information */
-	pHandle->set = identity ? HandleSet_Identity : HandleSet_Used;
+	pHot->set = identity ? HandleSet_Identity : HandleSet_Used;
+	pHot->type = type;
+	pHot->serial = m_HSerial;
+	pHot->object = NULL;
+	pHot->access_special = false;
+	pHot->read_rule = ReadRuleFor(m_Types[type].hndlSec);
 	pHandle->refcount = 1;
-	pHandle->type = type;
-	pHandle->serial = m_HSerial;
 	pHandle->owner = owner;
 	pHandle->ch_next = 0;
-	pHandle->access_special = false;
 	pHandle->is_destroying = false;
+	pHandle->acct_bytes = 0;
+	pHandle->alloc_site = 0;
 
 	/* Create the hash value */
-	Handle_t hash = pHandle->serial;
+	Handle_t hash = pHot->serial;
 	hash <<= HANDLESYS_HANDLE_BITS;
 	hash |= handle;
 
@@ -457,13 +476,21 @@ Handle_t HandleSystem::CreateHandleInt(HandleType_t type,
 
 	if (pAccess)
 	{
-		pHandle->access_special = true;
+		m_HotHandles[index].access_special = true;
+		m_HotHandles[index].read_rule = ReadRuleFor(*pAccess);
 		pHandle->sec = *pAccess;
 	}
 
-	pHandle->object = object;
+	m_HotHandles[index].object = object;
 	pHandle->clone = 0;
 	pHandle->timestamp = g_pSM->GetAdjustedTime();
+	ChargeHandleMemory(index);
+
+	if (m_AllocSampleRate && owner && !identity && --m_AllocSampleCountdown == 0)
+	{
+		m_AllocSampleCountdown = m_AllocSampleRate;
+		RecordAllocSite(index, owner);
+	}
 	return handle;
 }
 
@@ -516,37 +543,38 @@ HandleError HandleSystem::GetHandle(Handle_t handle,
 		return HandleError_Index;
 	}
 
-	QHandle *pHandle = &m_Handles[index];
+	const QHandleHot *pHot = &m_HotHandles[index];
 
-	if (!pHandle->set
-		|| (pHandle->set == HandleSet_Freed && !ignoreFree))
+	if (!pHot->set
+		|| (pHot->set == HandleSet_Freed && !ignoreFree))
 	{
 		return HandleError_Freed;
-	} else if (pHandle->set == HandleSet_Identity
+	} else if (pHot->set == HandleSet_Identity
 			   && ident != g_ShareSys.GetIdentRoot())
 	{
 		/* Only IdentityHandle() can read this! */
 		return HandleError_Identity;
 	}
-	if (pHandle->serial != serial)
+	if (pHot->serial != serial)
 	{
 		return HandleError_Changed;
 	}
 
-	*in_pHandle = pHandle;
+	*in_pHandle = &m_Handles[index];
 	*in_index = index;
 
 	return HandleError_None;
 }
 
-bool HandleSystem::CheckAccess(QHandle *pHandle, HandleAccessRight right, const HandleSecurity *pSecurity)
+bool HandleSystem::CheckAccess(unsigned int index, HandleAccessRight right, const HandleSecurity *pSecurity)
 {
-	QHandleType *pType = &m_Types[pHandle->type];
+	const QHandleHot *pHot = &m_HotHandles[index];
+	QHandleType *pType = &m_Types[pHot->type];
 	unsigned int access;
 
-	if (pHandle->access_special)
+	if (pHot->access_special)
 	{
-		access = pHandle->sec.access[right];
+		access = m_Handles[index].sec.access[right];
 	} else {
 		access = pType->hndlSec.access[right];
 	}
@@ -565,7 +593,7 @@ bool HandleSystem::CheckAccess(QHandle *pHandle, HandleAccessRight right, const
 	/* Check if the owner is allowed */
 	if (access & HANDLE_RESTRICT_OWNER)
 	{
-		IdentityToken_t *owner = pHandle->owner;
+		IdentityToken_t *owner = m_Handles[index].owner;
 		if (owner
 			&& (!pSecurity || pSecurity->pOwner != owner))
 		{
@@ -584,20 +612,24 @@ HandleError HandleSystem::CloneHandle(QHandle *pHandle, unsigned int index, Hand
 	Handle_t new_handle;
 	HandleError err;
 
-	if ((err=MakePrimHandle(pHandle->type, &pNewHandle, &new_index, &new_handle, newOwner)) != HandleError_None)
+	if ((err=MakePrimHandle(m_HotHandles[index].type, &pNewHandle, &new_index, &new_handle, newOwner)) != HandleError_None)
 	{
 		return err;
 	}
 
 	/* Assign permissions from parent */
-	if (pHandle->access_special)
+	if (m_HotHandles[index].access_special)
 	{
-		pNewHandle->access_special = true;
+		m_HotHandles[new_index].access_special = true;
+		m_HotHandles[new_index].read_rule = m_HotHandles[index].read_rule;
 		pNewHandle->sec = pHandle->sec;
 	}
 
+	/* The clone never destroys the object, but carrying the parent's pointer
+	 * lets ReadHandle() resolve it without following the clone link.
+	 */
 	pNewHandle->clone = index;
-	pNewHandle->object = NULL;
+	m_HotHandles[new_index].object = m_HotHandles[index].object;
 	pHandle->refcount++;
 
 	*newhandle = new_handle;
@@ -618,13 +650,13 @@ HandleError HandleSystem::CloneHandle(Handle_t handle, Handle_t *newhandle, Iden
 	}
 
 	/* Identities cannot be cloned */
-	if (pHandle->set == HandleSet_Identity)
+	if (m_HotHandles[index].set == HandleSet_Identity)
 	{
 		return HandleError_Identity;
 	}
 
 	/* Check if the handle can be cloned */
-	if (!CheckAccess(pHandle, HandleAccess_Clone, pSecurity))
+	if (!CheckAccess(index, HandleAccess_Clone, pSecurity))
 	{
 		return HandleError_Access;
 	}
@@ -672,8 +704,8 @@ void HandleSystem::GetHandleUnchecked(Handle_t hndl, QHandle *& pHandle, unsigne
 
 	pHandle = &m_Handles[index];
 
-	assert(pHandle->set && pHandle->set != HandleSet_Freed);
-	assert(pHandle->serial == serial);
+	assert(m_HotHandles[index].set && m_HotHandles[index].set != HandleSet_Freed);
+	assert(m_HotHandles[index].serial == serial);
 }
 
 HandleError HandleSystem::FreeHandle(QHandle *pHandle, unsigned int index)
@@ -686,7 +718,8 @@ HandleError HandleSystem::FreeHandle(QHandle *pHandle, unsigned int index)
 		return HandleError_None;
 	}
 
-	QHandleType *pType = &m_Types[pHandle->type];
+	QHandleHot *pHot = &m_HotHandles[index];
+	QHandleType *pType = &m_Types[pHot->type];
 
 	if (pHandle->owner && pHandle->owner->num_handles > 0)
 		pHandle->owner->num_handles--;
@@ -710,15 +743,16 @@ HandleError HandleSystem::FreeHandle(QHandle *pHandle, unsigned int index)
 		if (--pMaster->refcount == 0)
 		{
 			/* Type should be the same but do this anyway... */
-			pType = &m_Types[pMaster->type];
+			QHandleHot *pMasterHot = &m_HotHandles[master];
+			pType = &m_Types[pMasterHot->type];
 			pMaster->is_destroying = true;
-			if (pMaster->object)
+			if (pMasterHot->object)
 			{
-				pType->dispatch->OnHandleDestroy(pMaster->type, pMaster->object);
+				pType->dispatch->OnHandleDestroy(pMasterHot->type, pMasterHot->object);
 			}
 			ReleasePrimHandle(master);
 		}
-	} else if (pHandle->set == HandleSet_Identity) {
+	} else if (pHot->set == HandleSet_Identity) {
 		/* If we're an identity, skip all this stuff!
 		 * NOTE: SHARESYS DOES NOT CARE ABOUT THE DESTRUCTOR
 		 */
@@ -729,14 +763,14 @@ HandleError HandleSystem::FreeHandle(QHandle *pHandle, unsigned int index)
 		if (--pHandle->refcount == 0)
 		{
 			pHandle->is_destroying = true;
-			if (pHandle->object)
+			if (pHot->object)
 			{
-				pType->dispatch->OnHandleDestroy(pHandle->type, pHandle->object);
+				pType->dispatch->OnHandleDestroy(pHot->type, pHot->object);
 			}
 			ReleasePrimHandle(index);
 		} else {
 			/* We must be cloned, so mark ourselves as freed */
-			pHandle->set = HandleSet_Freed;
+			pHot->set = HandleSet_Freed;
 			/* Now, unlink us, so we're not being tracked by the owner */
 			if (pHandle->owner)
 			{
@@ -760,7 +794,7 @@ HandleError HandleSystem::FreeHandle(Handle_t handle, const HandleSecurity *pSec
 		return err;
 	}
 
-	if (!CheckAccess(pHandle, HandleAccess_Delete, pSecurity))
+	if (!CheckAccess(index, HandleAccess_Delete, pSecurity))
 	{
 		return HandleError_Access;
 	}
@@ -773,28 +807,38 @@ HandleError HandleSystem::ReadHandle(Handle_t handle, HandleType_t type, const H
 	unsigned int index;
 	QHandle *pHandle;
 	HandleError err;
-	IdentityToken_t *ident = pSecurity ? pSecurity->pIdentity : NULL;
+	IdentityToken_t *ident;
+
+	/* Exact type, live Handle and an access rule known to pass: no further checks needed. */
+	if (TryReadFast(handle, type, pSecurity, object))
+	{
+		return HandleError_None;
+	}
+
+	ident = pSecurity ? pSecurity->pIdentity : NULL;
 
 	if ((err=GetHandle(handle, ident, &pHandle, &index)) != HandleError_None)
 	{
 		return err;
 	}
 
-	if (!CheckAccess(pHandle, HandleAccess_Read, pSecurity))
+	if (!CheckAccess(index, HandleAccess_Read, pSecurity))
 	{
 		return HandleError_Access;
 	}
 
+	const QHandleHot *pHot = &m_HotHandles[index];
+
 	/* Check the type inheritance */
-	if (pHandle->type & HANDLESYS_SUBTYPE_MASK)
+	if (pHot->type & HANDLESYS_SUBTYPE_MASK)
 	{
-		if (pHandle->type != type
-			&& (TypeParent(pHandle->type) != TypeParent(type)))
+		if (pHot->type != type
+			&& (TypeParent(pHot->type) != TypeParent(type)))
 		{
 			return HandleError_Type;
 		}
 	} else if (type) {
-		if (pHandle->type != type)
+		if (pHot->type != type)
 		{
 			return HandleError_Type;
 		}
@@ -802,12 +846,8 @@ HandleError HandleSystem::ReadHandle(Handle_t handle, HandleType_t type, const H
 
 	if (object)
 	{
-		/* if we're a clone, the rules change - object is ONLY in our reference */
-		if (pHandle->clone)
-		{
-			pHandle = &m_Handles[pHandle->clone];
-		}
-		*object = pHandle->object;
+		/* Clones carry their parent's object pointer. */
+		*object = pHot->object;
 	}
 
 	return HandleError_None;
@@ -824,6 +864,8 @@ void HandleSystem::UnlinkHandleFromOwner(QHandle *pHandle, unsigned int index)
 		return;
 	}
 
+	pHandle->owner->handle_bytes -= pHandle->acct_bytes;
+	pHandle->acct_bytes = 0;
 	pHandle->owner = NULL;
 
 	/* Note that since 0 is an invalid handle, if any of these links are 0,
@@ -866,7 +908,7 @@ void HandleSystem::UnlinkHandleFromOwner(QHandle *pHandle, unsigned int index)
 void HandleSystem::ReleasePrimHandle(unsigned int index)
 {
 	QHandle *pHandle = &m_Handles[index];
-	HandleSet set = pHandle->set;
+	HandleSet set = (HandleSet)m_HotHandles[index].set;
 
 	if (pHandle->owner && (set != HandleSet_Identity))
 	{
@@ -887,15 +929,15 @@ void HandleSystem::ReleasePrimHandle(unsigned int index)
 			pLocal = &m_Handles[ch_index];
 #if defined _DEBUG
 			assert(old_index != ch_index);
-			assert(pLocal->set == HandleSet_Used);
+			assert(m_HotHandles[ch_index].set == HandleSet_Used);
 			old_index = ch_index;
 #endif
 			FreeHandle(pLocal, ch_index);
 		}
 	}
 
-	pHandle->set = HandleSet_None;
-	m_Types[pHandle->type].opened--;
+	m_HotHandles[index].set = HandleSet_None;
+	m_Types[m_HotHandles[index].type].opened--;
 	m_Handles[++m_FreeHandles].freeID = index;
 }
 
@@ -938,16 +980,14 @@ bool HandleSystem::RemoveType(HandleType_t type, IdentityToken_t *ident)
 	/* Make sure nothing is using this type. */
 	if (pType->opened)
 	{
-		QHandle *pHandle;
 		for (unsigned int i=1; i<=m_HandleTail; i++)
 		{
-			pHandle = &m_Handles[i];
-			if (!pHandle->set || pHandle->type != type)
+			if (!m_HotHandles[i].set || m_HotHandles[i].type != type)
 			{
 				continue;
 			}
 
-			FreeHandle(pHandle, i);
+			FreeHandle(&m_Handles[i], i);
 
 			if (pType->opened == 0)
 			{
@@ -1008,25 +1048,13 @@ bool HandleSystem::TryAndFreeSomeHandles()
 	{
 		IPlugin *plugin = pl_iter->GetPlugin();
 		IdentityToken_t *identity = plugin->GetIdentity();
-		unsigned int handle_count = 0;
 
 		if (identity == NULL)
 		{
 			continue;
 		}
 
-		/* Search all handles */
-		for (unsigned int i = 1; i <= m_HandleTail; i++)
-		{
-			if (m_Handles[i].set != HandleSet_Used)
-			{
-				continue;
-			}
-			if (m_Handles[i].owner == identity)
-			{
-				handle_count++;
-			}
-		}
+		unsigned int handle_count = (unsigned int)identity->num_handles;
 
 		if (handle_count > highest_handle_count)
 		{
@@ -1045,36 +1073,48 @@ bool HandleSystem::TryAndFreeSomeHandles()
 	HANDLE_LOG_VERY_BAD("[SM] Contact the author(s) of this plugin to correct this error.", highest_handle_count);
 	HANDLE_LOG_VERY_BAD("--------------------------------------------------------------------------");
 
-	const IdentityToken_t *pIdentity = highest_owner->GetIdentity();
+	IdentityToken_t *pIdentity = highest_owner->GetIdentity();
 	unsigned int total = 0, highest_index = 0, total_size = 0, size;
 	unsigned int * pCount = new unsigned int[HANDLESYS_TYPEARRAY_SIZE+1];
 	memset(pCount, 0, ((HANDLESYS_TYPEARRAY_SIZE + 1) * sizeof(unsigned int)));
 
 	const QHandle *oldest = nullptr;
 	const QHandle *newest = nullptr;
-	for (unsigned int i = 1; i <= m_HandleTail; ++i)
+	HandleType_t oldest_type = 0, newest_type = 0;
+
+	/* Walk the plugin's own chain rather than the whole Handle table. */
+	unsigned int ident_index = 0;
+	if (IdentityHandle(pIdentity, &ident_index) != HandleError_None)
 	{
+		ident_index = 0;
+	}
+
+	for (unsigned int i = ident_index ? m_Handles[ident_index].ch_prev : 0; i != 0; i = m_Handles[i].ch_next)
+	{
+		const QHandleHot &Hot = m_HotHandles[i];
 		const QHandle &Handle = m_Handles[i];
-		if (Handle.set != HandleSet_Used || Handle.owner != pIdentity)
+		if (Hot.set != HandleSet_Used)
 		{
 			continue;
 		}
 
-		++pCount[Handle.type];
+		++pCount[Hot.type];
 		++total;
 
-		if (Handle.type >= highest_index)
+		if (Hot.type >= highest_index)
 		{
-			highest_index = ((Handle.type) + 1);
+			highest_index = ((Hot.type) + 1);
 		}
 
 		if (!oldest || oldest->timestamp > Handle.timestamp)
 		{
 			oldest = &Handle;
+			oldest_type = Hot.type;
 		}
 		if (!newest || newest->timestamp < Handle.timestamp)
 		{
 			newest = &Handle;
+			newest_type = Hot.type;
 		}
 		
 		if (Handle.clone != 0)
@@ -1082,7 +1122,7 @@ bool HandleSystem::TryAndFreeSomeHandles()
 			continue;
 		}
 
-		if (m_Types[Handle.type].dispatch->GetHandleApproxSize(Handle.type, Handle.object, &size))
+		if (m_Types[Hot.type].dispatch->GetHandleApproxSize(Hot.type, Hot.object, &size))
 		{
 			total_size += size;
 		}
@@ -1129,8 +1169,8 @@ bool HandleSystem::TryAndFreeSomeHandles()
 
 
 	HANDLE_LOG_VERY_BAD("--------------------------------------------------------------------------");
-	HANDLE_LOG_VERY_BAD("Oldest Living Handle: %s created at %s", m_Types[oldest->type].name->c_str(), oldstamp);
-	HANDLE_LOG_VERY_BAD("Newest Living Handle: %s created at %s", m_Types[newest->type].name->c_str(), newstamp);
+	HANDLE_LOG_VERY_BAD("Oldest Living Handle: %s created at %s", m_Types[oldest_type].name->c_str(), oldstamp);
+	HANDLE_LOG_VERY_BAD("Newest Living Handle: %s created at %s", m_Types[newest_type].name->c_str(), newstamp);
 	HANDLE_LOG_VERY_BAD("-- Approximately %d bytes of memory are in use by (%u) Handles.\n", total_size, total);
 	delete [] pCount;
 
@@ -1151,57 +1191,309 @@ static void rep(const HandleReporter &fn, const char *fmt, ...)
 	fn(buffer);
 }
 
+void HandleSystem::CountOwnedHandles(IdentityToken_t *owner, std::map<std::string, unsigned int> &counts)
+{
+	unsigned int owner_index;
+	if (!owner || IdentityHandle(owner, &owner_index) != HandleError_None)
+	{
+		return;
+	}
+
+	/* Walk the owner's Handle chain rather than the whole Handle array. */
+	for (unsigned int i = m_Handles[owner_index].ch_prev; i != 0; i = m_Handles[i].ch_next)
+	{
+		QHandleType *pType = &m_Types[m_HotHandles[i].type];
+		counts[pType->name ? *pType->name : "ANON"]++;
+	}
+}
+
+void HandleSystem::CountHandlesByType(std::map<std::string, unsigned int> &counts)
+{
+	for (unsigned int i = 1; i <= m_HandleTail; i++)
+	{
+		if (m_HotHandles[i].set != HandleSet_Used)
+		{
+			continue;
+		}
+
+		QHandleType *pType = &m_Types[m_HotHandles[i].type];
+		counts[pType->name ? *pType->name : "ANON"]++;
+	}
+}
+
+void HandleSystem::ChargeHandleMemory(unsigned int index)
+{
+	QHandle *pHandle = &m_Handles[index];
+	const QHandleHot *pHot = &m_HotHandles[index];
+
+	/* Clones share their parent's object, which is charged to the parent's owner. */
+	if (pHot->set != HandleSet_Used || !pHandle->owner || pHandle->clone || !pHot->object)
+	{
+		return;
+	}
+
+	IHandleTypeDispatch *dispatch = m_Types[pHot->type].dispatch;
+	unsigned int size;
+	if (dispatch->GetDispatchVersion() < HANDLESYS_MEMUSAGE_MIN_VERSION
+		|| !dispatch->GetHandleApproxSize(pHot->type, pHot->object, &size))
+	{
+		size = 0;
+	}
+
+	pHandle->owner->handle_bytes += size;
+	pHandle->owner->handle_bytes -= pHandle->acct_bytes;
+	pHandle->acct_bytes = size;
+}
+
+void HandleSystem::SampleHandleMemory(unsigned int budget, size_t softLimit)
+{
+	while (budget--)
+	{
+		if (++m_SampleCursor > m_HandleTail)
+		{
+			m_SampleCursor = 0;
+			CheckHandleMemoryLimits(softLimit);
+			return;
+		}
+		ChargeHandleMemory(m_SampleCursor);
+	}
+}
+
+void HandleSystem::CheckHandleMemoryLimits(size_t softLimit)
+{
+	for (IPluginIterator *pl_iter = g_PluginSys.GetPluginIterator(); pl_iter->MorePlugins(); pl_iter->NextPlugin())
+	{
+		IPlugin *plugin = pl_iter->GetPlugin();
+		IdentityToken_t *identity = plugin->GetIdentity();
+		if (!identity)
+		{
+			continue;
+		}
+
+		if (!softLimit || identity->handle_bytes < softLimit / 2)
+		{
+			/* Re-arm once the plugin has given back most of it. */
+			identity->warned_handle_bytes = 0;
+			continue;
+		}
+
+		/* Warn on crossing the limit, then again each time the total doubles. */
+		if (identity->handle_bytes < softLimit
+			|| (identity->warned_handle_bytes && identity->handle_bytes < identity->warned_handle_bytes * 2))
+		{
+			continue;
+		}
+
+		identity->warned_handle_bytes = identity->handle_bytes;
+		logger->LogError("[SM] Warning: plugin %s holds approximately %u KB in %u Handles (soft limit %u KB)",
+			plugin->GetFilename(),
+			(unsigned int)(identity->handle_bytes / 1024),
+			(unsigned int)identity->num_handles,
+			(unsigned int)(softLimit / 1024));
+	}
+}
+
+void HandleSystem::SetAllocSampleRate(unsigned int rate)
+{
+	if (rate == m_AllocSampleRate)
+	{
+		return;
+	}
+
+	m_AllocSampleRate = rate;
+	m_AllocSampleCountdown = rate;
+
+	/* Old site indexes would point at the wrong entries once the table is cleared. */
+	for (unsigned int i = 1; i <= m_HandleTail; i++)
+	{
+		m_Handles[i].alloc_site = 0;
+	}
+	m_AllocSites.clear();
+	m_AllocSiteLookup.clear();
+}
+
+void HandleSystem::RecordAllocSite(unsigned int index, IdentityToken_t *owner)
+{
+	SMPlugin *plugin = scripts->FindPluginByIdentity(owner);
+	if (!plugin)
+	{
+		return;
+	}
+
+	IPluginContext *pContext = plugin->GetBaseContext();
+	if (!pContext)
+	{
+		return;
+	}
+
+	HandleAllocSite site;
+	site.plugin = plugin->GetFilename();
+	site.line = 0;
+
+	/* The innermost native is the creator; the first scripted frame below it is the call site. */
+	IFrameIterator *it = pContext->CreateFrameIterator();
+	for (; !it->Done(); it->Next())
+	{
+		if (it->IsNativeFrame())
+		{
+			if (site.native.empty() && it->FunctionName())
+				site.native = it->FunctionName();
+			continue;
+		}
+		if (it->IsScriptedFrame())
+		{
+			if (it->FunctionName())
+				site.function = it->FunctionName();
+			if (it->FilePath())
+				site.file = it->FilePath();
+			site.line = it->LineNumber();
+			break;
+		}
+	}
+	pContext->DestroyFrameIterator(it);
+
+	std::string key = site.plugin + '\n' + site.native + '\n' + site.file + ':' + std::to_string(site.line);
+	auto iter = m_AllocSiteLookup.find(key);
+	if (iter == m_AllocSiteLookup.end())
+	{
+		m_AllocSites.push_back(std::move(site));
+		iter = m_AllocSiteLookup.emplace(key, (unsigned int)m_AllocSites.size()).first;
+	}
+
+	m_Handles[index].alloc_site = iter->second;
+}
+
+void HandleSystem::DumpLeaks(const HandleReporter &fn)
+{
+	if (!m_AllocSampleRate)
+	{
+		rep(fn, "Handle creation sampling is off; set \"HandleLeakSampleRate\" in core.cfg to enable it.");
+		return;
+	}
+
+	struct SiteStats
+	{
+		unsigned int site;
+		unsigned int count;
+		size_t bytes;
+		time_t oldest;
+		double total_age;
+	};
+
+	std::vector<SiteStats> stats(m_AllocSites.size());
+	for (size_t i = 0; i < stats.size(); i++)
+	{
+		stats[i].site = (unsigned int)i;
+		stats[i].count = 0;
+		stats[i].bytes = 0;
+		stats[i].oldest = 0;
+		stats[i].total_age = 0.0;
+	}
+
+	time_t now = g_pSM->GetAdjustedTime();
+	for (unsigned int i = 1; i <= m_HandleTail; i++)
+	{
+		const QHandle &Handle = m_Handles[i];
+		if (!Handle.alloc_site || m_HotHandles[i].set != HandleSet_Used)
+		{
+			continue;
+		}
+
+		SiteStats &s = stats[Handle.alloc_site - 1];
+		if (!s.count || Handle.timestamp < s.oldest)
+		{
+			s.oldest = Handle.timestamp;
+		}
+		s.count++;
+		s.bytes += Handle.acct_bytes;
+		s.total_age += difftime(now, Handle.timestamp);
+	}
+
+	stats.erase(std::remove_if(stats.begin(), stats.end(), [](const SiteStats &s) {
+		return s.count == 0;
+	}), stats.end());
+	std::sort(stats.begin(), stats.end(), [](const SiteStats &a, const SiteStats &b) {
+		return a.count > b.count;
+	});
+
+	rep(fn, "Live Handles by creation site, sampling 1 in %u creations (estimated = sampled x %u)",
+		m_AllocSampleRate, m_AllocSampleRate);
+	rep(fn, "%-8.8s\t%-10.10s\t%-10.10s\t%-10.10s\t%-10.10s\t%-24.24s\t%-28.28s\t%s",
+		"Sampled", "Estimated", "Oldest(s)", "AvgAge(s)", "Memory", "Plugin", "Native", "Call site");
+	rep(fn, "---------------------------------------------------------------------------------------------");
+	for (const SiteStats &s : stats)
+	{
+		const HandleAllocSite &site = m_AllocSites[s.site];
+		rep(fn, "%-8u\t%-10u\t%-10u\t%-10u\t%-10u\t%-24.24s\t%-28.28s\t%s:%u (%s)",
+			s.count,
+			s.count * m_AllocSampleRate,
+			(unsigned int)difftime(now, s.oldest),
+			(unsigned int)(s.total_age / s.count),
+			(unsigned int)s.bytes,
+			site.plugin.c_str(),
+			site.native.empty() ? "<unknown>" : site.native.c_str(),
+			site.file.empty() ? "<unknown>" : site.file.c_str(),
+			site.line,
+			site.function.empty() ? "<unknown>" : site.function.c_str());
+	}
+}
+
+static const char *GetOwnerName(IdentityToken_t *pOwner)
+{
+	if (!pOwner)
+	{
+		return "NONE";
+	}
+	if (pOwner == g_pCoreIdent)
+	{
+		return "CORE";
+	}
+	if (pOwner == scripts->GetIdentity())
+	{
+		return "PLUGINSYS";
+	}
+
+	IExtension *ext = g_Extensions.GetExtensionFromIdent(pOwner);
+	if (ext)
+	{
+		return ext->GetFilename();
+	}
+
+	SMPlugin *pPlugin = scripts->FindPluginByIdentity(pOwner);
+	if (pPlugin)
+	{
+		return pPlugin->GetFilename();
+	}
+
+	return "UNKNOWN";
+}
+
 void HandleSystem::Dump(const HandleReporter &fn)
 {
 	unsigned int total_size = 0;
+	std::vector<IdentityToken_t *> owners;
+	std::unordered_set<IdentityToken_t *> seen_owners;
 	rep(fn, "%-10.10s\t%-20.20s\t%-20.20s\t%-10.10s\t%-30.30s", "Handle", "Owner", "Type", "Memory", "Time Created");
 	rep(fn, "---------------------------------------------------------------------------------------------");
 	
 	const char *fmt = bridge->GetCvarString(g_datetime_format);
 	for (unsigned int i = 1; i <= m_HandleTail; i++)
 	{
-		if (m_Handles[i].set != HandleSet_Used)
+		if (m_HotHandles[i].set != HandleSet_Used)
 		{
 			continue;
 		}
 		/* Get the index */
-		unsigned int index = (m_Handles[i].serial << HANDLESYS_HANDLE_BITS) | i;
+		unsigned int index = (m_HotHandles[i].serial << HANDLESYS_HANDLE_BITS) | i;
 		/* Determine the owner */
-		const char *owner = "UNKNOWN";
-		if (m_Handles[i].owner)
+		IdentityToken_t *pOwner = m_Handles[i].owner;
+		const char *owner = GetOwnerName(pOwner);
+		if (pOwner && seen_owners.insert(pOwner).second)
 		{
-			IdentityToken_t	*pOwner = m_Handles[i].owner;
-			if (pOwner == g_pCoreIdent)
-			{
-				owner = "CORE";
-			}
-			else if (pOwner == scripts->GetIdentity())
-			{
-				owner = "PLUGINSYS";
-			}
-			else
-			{
-				IExtension *ext = g_Extensions.GetExtensionFromIdent(pOwner);
-				if (ext)
-				{
-					owner = ext->GetFilename();
-				}
-				else
-				{
-					SMPlugin *pPlugin = scripts->FindPluginByIdentity(pOwner);
-					if (pPlugin)
-					{
-						owner = pPlugin->GetFilename();
-					}
-				}
-			}
-		}
-		else
-		{
-			owner = "NONE";
+			owners.push_back(pOwner);
 		}
 		const char *type = "ANON";
-		QHandleType *pType = &m_Types[m_Handles[i].type];
+		QHandleType *pType = &m_Types[m_HotHandles[i].type];
 		unsigned int size = 0;
 		unsigned int parentIdx;
 		bool bresult;
@@ -1217,12 +1509,12 @@ void HandleSystem::Dump(const HandleReporter &fn)
 			}
 			else
 			{
-				bresult = pType->dispatch->GetHandleApproxSize(m_Handles[parentIdx].type, m_Handles[parentIdx].object, &size);
+				bresult = pType->dispatch->GetHandleApproxSize(m_HotHandles[parentIdx].type, m_HotHandles[parentIdx].object, &size);
 			}
 		}
 		else
 		{
-			bresult = pType->dispatch->GetHandleApproxSize(m_Handles[i].type, m_Handles[i].object, &size);
+			bresult = pType->dispatch->GetHandleApproxSize(m_HotHandles[i].type, m_HotHandles[i].object, &size);
 		}
 
 		char date[256]; // 256 should be more than enough
@@ -1254,4 +1546,78 @@ void HandleSystem::Dump(const HandleReporter &fn)
 		}
 	}
 	rep(fn, "-- Approximately %d bytes of memory are in use by Handles.\n", total_size);
+
+	/* These are the per-identity counts kept alongside each owner's Handle chain. */
+	std::sort(owners.begin(), owners.end(), [](IdentityToken_t *a, IdentityToken_t *b) {
+		return a->num_handles > b->num_handles;
+	});
+
+	rep(fn, "%-30.30s\t%-10.10s\t%-10.10s", "Owner", "Handles", "Memory");
+	rep(fn, "---------------------------------------------------------------------------------------------");
+	for (IdentityToken_t *pOwner : owners)
+	{
+		rep(fn, "%-30.30s\t%-10u\t%u", GetOwnerName(pOwner), (unsigned int)pOwner->num_handles,
+			(unsigned int)pOwner->handle_bytes);
+	}
 }
+
+/**
+ * Keeps the per-owner byte totals fresh. Sizes are charged when a Handle is created and
+ * released when it leaves its owner; containers grow in between, so a slice of the table
+ * is re-measured every second and the whole table about every HANDLEMEM_PASS_SECONDS.
+ * Also applies the HandleLeakSampleRate setting.
+ */
+#define HANDLEMEM_PASS_SECONDS		30
+#define HANDLEMEM_MIN_BUDGET		1024
+
+class HandleMemorySampler :
+	public SMGlobalClass,
+	public ITimedEvent
+{
+public:
+	void OnSourceModAllInitialized()
+	{
+		m_Timer = timersys->CreateTimer(this, 1.0f, nullptr, TIMER_FLAG_REPEAT);
+	}
+	void OnSourceModShutdown()
+	{
+		if (m_Timer)
+			timersys->KillTimer(m_Timer);
+	}
+	ConfigResult OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source,
+		char *error, size_t maxlength)
+	{
+		bool limit = strcmp(key, "HandleMemoryWarnLimit") == 0;
+		if (!limit && strcmp(key, "HandleLeakSampleRate") != 0)
+			return ConfigResult_Ignore;
+
+		char *end;
+		unsigned long number = strtoul(value, &end, 10);
+		if (!value[0] || *end != '\0')
+		{
+			ke::SafeStrcpy(error, maxlength, limit
+				? "Invalid value: must be a number of megabytes"
+				: "Invalid value: must be a number of creations per sample");
+			return ConfigResult_Reject;
+		}
+
+		if (limit)
+			m_SoftLimit = size_t(number) * 1024 * 1024;
+		else
+			g_HandleSys.SetAllocSampleRate((unsigned int)number);
+		return ConfigResult_Accept;
+	}
+	ResultType OnTimer(ITimer *pTimer, void *pData)
+	{
+		unsigned int budget = std::max(g_HandleSys.GetHandleTail() / HANDLEMEM_PASS_SECONDS, (unsigned int)HANDLEMEM_MIN_BUDGET);
+		g_HandleSys.SampleHandleMemory(budget, m_SoftLimit);
+		return Pl_Continue;
+	}
+	void OnTimerEnd(ITimer *pTimer, void *pData)
+	{
+		m_Timer = nullptr;
+	}
+private:
+	ITimer *m_Timer = nullptr;
+	size_t m_SoftLimit = 0;
+} s_HandleMemorySampler;
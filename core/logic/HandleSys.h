@@ -33,8 +33,13 @@
 #define _INCLUDE_SOURCEMOD_HANDLESYSTEM_H_
 
 #include <stdio.h>
+#include <stdint.h>
 
+#include <map>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <amtl/am-string.h>
 #include <amtl/am-function.h>
@@ -68,9 +73,14 @@
  *   The second vector is the identity linked list.  An identity has its own handle, so
  * these handles are used as sentinel nodes for index linking.  They point to the first and last
  * index into the handle array.  Each subsequent Handle who is owned by that identity is mapped into
- * that list.  This lets owning identities be unloaded in O(n) time.
+ * that list.  This lets owning identities be unloaded in O(n) time, where n is the number of
+ * Handles that identity owns, and IdentityToken_t::num_handles tracks the same count.
  *
  *   Eventually, there may be a third list for type chains.
+ *
+ *   The fields every lookup needs (object, serial, type and state) are not part of
+ * the QHandle at all; they live in a parallel QHandleHot vector with the same indexes,
+ * so that validating and reading a Handle does not pull in the rest of its bookkeeping.
  */
 
 enum HandleSet
@@ -81,17 +91,42 @@ enum HandleSet
 	HandleSet_Identity,		/* The Handle is a special identity */
 };
 
+/**
+ * Precomputed outcome of the read access check, so ReadHandle() can skip CheckAccess()
+ * for the common rules.
+ */
+enum HandleReadRule
+{
+	HandleRead_Checked = 0,	/* Anything else; go through CheckAccess() */
+	HandleRead_Open,		/* Readable by anyone */
+	HandleRead_Identity,	/* Readable by the type's identity only (the default) */
+};
+
+/**
+ * Per-Handle data read by GetHandle(), CheckAccess() and ReadHandle(). Kept at 16 bytes
+ * so four Handles share a cache line.
+ */
+struct QHandleHot
+{
+	void *object;				/* Unmaintained object pointer (for clones, the parent's object) */
+	unsigned int serial;		/* Serial no. for sanity checking */
+	uint16_t type;				/* Handle type */
+	uint8_t set;				/* Information about the handle's state (HandleSet) */
+	uint8_t access_special : 1;	/* Whether or not access rules are special or type-derived */
+	uint8_t read_rule : 2;		/* HandleReadRule for the effective read access */
+};
+
+static_assert(sizeof(QHandleHot) == 16, "QHandleHot should stay at 16 bytes");
+static_assert(HANDLESYS_TYPEARRAY_SIZE <= UINT16_MAX, "Handle types must fit in QHandleHot::type");
+
 struct QHandle
 {
-	HandleType_t type;			/* Handle type */
-	void *object;				/* Unmaintained object pointer */
 	IdentityToken_t *owner;		/* Identity of object which owns this */
-	unsigned int serial;		/* Serial no. for sanity checking */
 	unsigned int refcount;		/* Reference count for safe destruction */
 	unsigned int clone;			/* If non-zero, this is our cloned parent index */
-	HandleSet set;				/* Information about the handle's state */
-	bool access_special;		/* Whether or not access rules are special or type-derived */
 	bool is_destroying;			/* Whether or not the handle is being destroyed */
+	unsigned int acct_bytes;	/* Approximate size currently charged to the owner */
+	unsigned int alloc_site;	/* 1-based HandleAllocSite index if creation was sampled, else 0 */
 	HandleAccess sec;			/* Security rules */
 	time_t timestamp;			/* Creation timestamp */
 	/* The following variables are unrelated to the Handle array, and used 
@@ -123,6 +158,19 @@ struct QHandleType
 	}
 };
 
+/**
+ * Where a sampled Handle was created: the plugin, the native that created it and the
+ * first scripted frame below that native.
+ */
+struct HandleAllocSite
+{
+	std::string plugin;
+	std::string native;
+	std::string function;
+	std::string file;
+	unsigned int line;
+};
+
 typedef ke::Function<void(const char *)> HandleReporter;
 
 class HandleSystem : 
@@ -177,6 +225,40 @@ public: //IHandleSystem
 
 	void Dump(const HandleReporter &reporter);
 
+	/* Counts the Handles owned by an identity, by type name. */
+	void CountOwnedHandles(IdentityToken_t *owner, std::map<std::string, unsigned int> &counts);
+
+	/* Counts every live Handle, by type name. */
+	void CountHandlesByType(std::map<std::string, unsigned int> &counts);
+
+	/**
+	 * Re-measures up to |budget| Handles with GetHandleApproxSize, continuing where the
+	 * previous call stopped, and updates the byte totals of their owners. Once a full pass
+	 * over the table completes, plugins above |softLimit| bytes (0 for none) are warned about.
+	 */
+	void SampleHandleMemory(unsigned int budget, size_t softLimit);
+
+	/**
+	 * Records the creation site of one in every |rate| plugin-owned Handles (0 disables).
+	 * Sites are kept until the rate changes.
+	 */
+	void SetAllocSampleRate(unsigned int rate);
+
+	/* Groups live sampled Handles by creation site, with counts and ages. */
+	void DumpLeaks(const HandleReporter &reporter);
+
+	/* Number of Handles created since startup, by any owner */
+	inline unsigned int GetHandlesCreated() const
+	{
+		return m_HandlesCreated;
+	}
+
+	/* Highest Handle index in use so far */
+	inline unsigned int GetHandleTail() const
+	{
+		return m_HandleTail;
+	}
+
 	/* Bypasses security checks. */
 	Handle_t FastCloneHandle(Handle_t hndl);
 protected:
@@ -218,7 +300,59 @@ protected:
 	/**
 	 * Helper function to check access rights.
 	 */
-	bool CheckAccess(QHandle *pHandle, HandleAccessRight right, const HandleSecurity *pSecurity);
+	bool CheckAccess(unsigned int index, HandleAccessRight right, const HandleSecurity *pSecurity);
+
+	static inline uint8_t ReadRuleFor(const HandleAccess &access)
+	{
+		switch (access.access[HandleAccess_Read])
+		{
+		case 0:
+			return HandleRead_Open;
+		case HANDLE_RESTRICT_IDENTITY:
+			return HandleRead_Identity;
+		default:
+			return HandleRead_Checked;
+		}
+	}
+
+	/**
+	 * Resolves a live, non-identity Handle of exactly |type| whose read rule can be
+	 * decided without CheckAccess(). Returns false if the full path must run instead;
+	 * that path reports the precise error.
+	 */
+	inline bool TryReadFast(Handle_t handle, HandleType_t type, const HandleSecurity *pSecurity, void **object)
+	{
+		unsigned int index = (handle & HANDLESYS_HANDLE_MASK);
+		if (!type || index == 0 || index > m_HandleTail)
+		{
+			return false;
+		}
+
+		const QHandleHot *pHot = &m_HotHandles[index];
+		if (pHot->set != HandleSet_Used
+			|| pHot->serial != (handle >> HANDLESYS_HANDLE_BITS)
+			|| pHot->type != type)
+		{
+			return false;
+		}
+
+		if (pHot->read_rule != HandleRead_Open)
+		{
+			if (pHot->read_rule != HandleRead_Identity
+				|| !pSecurity
+				|| !pSecurity->pIdentity
+				|| pSecurity->pIdentity != m_Types[type].typeSec.ident)
+			{
+				return false;
+			}
+		}
+
+		if (object)
+		{
+			*object = pHot->object;
+		}
+		return true;
+	}
 
 	/** 
 	 * Some wrappers for internal functions, so we can pass indexes instead of encoded handles.
@@ -226,11 +360,15 @@ protected:
 	HandleError FreeHandle(QHandle *pHandle, unsigned int index);
 	void UnlinkHandleFromOwner(QHandle *pHandle, unsigned int index);
 	HandleError CloneHandle(QHandle *pHandle, unsigned int index, Handle_t *newhandle, IdentityToken_t *newOwner);
+	void ChargeHandleMemory(unsigned int index);
+	void RecordAllocSite(unsigned int index, IdentityToken_t *owner);
+	void CheckHandleMemoryLimits(size_t softLimit);
 	Handle_t CreateHandleInt(HandleType_t type, void *object, const HandleSecurity *pSec, HandleError *err, const HandleAccess *pAccess, bool identity);
 
 	bool TryAndFreeSomeHandles();
 	HandleError TryAllocHandle(unsigned int *handle);
 private:
+	QHandleHot *m_HotHandles;
 	QHandle *m_Handles;
 	QHandleType *m_Types;
 	NameHashSet<QHandleType *> m_TypeLookup;
@@ -239,6 +377,12 @@ private:
 	unsigned int m_HandleTail;
 	unsigned int m_FreeHandles;
 	unsigned int m_HSerial;
+	unsigned int m_HandlesCreated;
+	unsigned int m_SampleCursor;
+	unsigned int m_AllocSampleRate;
+	unsigned int m_AllocSampleCountdown;
+	std::vector<HandleAllocSite> m_AllocSites;
+	std::unordered_map<std::string, unsigned int> m_AllocSiteLookup;
 };
 
 extern HandleSystem g_HandleSys;
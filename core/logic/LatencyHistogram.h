@@ -0,0 +1,139 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _include_sourcemod_logic_latency_histogram_h_
+#define _include_sourcemod_logic_latency_histogram_h_
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+
+// Log-linear histogram of nanosecond durations, in the style of HdrHistogram.
+// Each power of two is split into 16 linear buckets, so percentiles are
+// reported to within ~6% of the true value. Durations above ~4.8 hours share
+// the last bucket.
+class LatencyHistogram
+{
+public:
+	static const unsigned kSubBucketBits = 4;
+	static const size_t kSubBuckets = size_t(1) << kSubBucketBits;
+	static const size_t kBuckets = 41 * kSubBuckets;
+
+	LatencyHistogram() {
+		Reset();
+	}
+
+	void Reset() {
+		count_ = 0;
+		total_ = 0;
+		min_ = 0;
+		max_ = 0;
+		memset(buckets_, 0, sizeof(buckets_));
+	}
+
+	void Record(uint64_t ns) {
+		if (!count_ || ns < min_)
+			min_ = ns;
+		if (ns > max_)
+			max_ = ns;
+		count_++;
+		total_ += ns;
+		buckets_[BucketOf(ns)]++;
+	}
+
+	uint64_t Count() const {
+		return count_;
+	}
+	uint64_t Total() const {
+		return total_;
+	}
+	uint64_t Min() const {
+		return min_;
+	}
+	uint64_t Max() const {
+		return max_;
+	}
+	double Mean() const {
+		return count_ ? double(total_) / double(count_) : 0.0;
+	}
+
+	// |fraction| is in [0, 1], e.g. 0.99 for p99.
+	uint64_t Percentile(double fraction) const {
+		if (!count_)
+			return 0;
+
+		fraction = std::min(std::max(fraction, 0.0), 1.0);
+		uint64_t wanted = uint64_t(double(count_) * fraction);
+		if (wanted >= count_)
+			wanted = count_ - 1;
+
+		uint64_t seen = 0;
+		for (size_t i = 0; i < kBuckets; i++) {
+			seen += buckets_[i];
+			if (seen > wanted)
+				return std::min(std::max(BucketLimit(i), min_), max_);
+		}
+		return max_;
+	}
+
+private:
+	static size_t BucketOf(uint64_t ns) {
+		if (ns < kSubBuckets)
+			return size_t(ns);
+
+		unsigned msb = 0;
+		for (uint64_t v = ns; v > 1; v >>= 1)
+			msb++;
+
+		unsigned shift = msb - kSubBucketBits;
+		size_t bucket = (shift + 1) * kSubBuckets + size_t((ns >> shift) & (kSubBuckets - 1));
+		return std::min(bucket, kBuckets - 1);
+	}
+
+	// Largest value that maps into the given bucket.
+	static uint64_t BucketLimit(size_t bucket) {
+		if (bucket < kSubBuckets)
+			return bucket;
+
+		unsigned shift = unsigned(bucket / kSubBuckets) - 1;
+		uint64_t sub = bucket % kSubBuckets;
+		return ((kSubBuckets + sub + 1) << shift) - 1;
+	}
+
+private:
+	uint64_t count_;
+	uint64_t total_;
+	uint64_t min_;
+	uint64_t max_;
+	uint32_t buckets_[kBuckets];
+};
+
+#endif // _include_sourcemod_logic_latency_histogram_h_
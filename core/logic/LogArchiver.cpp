@@ -0,0 +1,515 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include "common_logic.h"
+#include "LogArchiver.h"
+#include <am-string.h>
+#include <am-thread.h>
+#if defined PLATFORM_WINDOWS
+#include <sys/utime.h>
+#elif defined PLATFORM_POSIX
+#include <utime.h>
+#include <sys/resource.h>
+#if defined PLATFORM_LINUX
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#endif
+
+#if defined PLATFORM_WINDOWS
+#define ZLIB_LIBRARY "zlib1.dll"
+#elif defined PLATFORM_APPLE
+#define ZLIB_LIBRARY "libz.1.dylib"
+#else
+#define ZLIB_LIBRARY "libz.so.1"
+#endif
+
+static const char *BaseName(const char *path)
+{
+	const char *name = path;
+	for (const char *ptr = path; *ptr != '\0'; ptr++)
+	{
+		if (*ptr == '/' || *ptr == '\\')
+		{
+			name = ptr + 1;
+		}
+	}
+	return name;
+}
+
+static bool EndsWith(const std::string &str, const char *suffix)
+{
+	size_t len = strlen(suffix);
+	return str.size() >= len && str.compare(str.size() - len, len, suffix) == 0;
+}
+
+/* L<date>[n].log, errors_<date>.log, their rotated pieces, archives and leftovers. */
+static bool IsLogFileName(const std::string &name)
+{
+	bool prefix = (name.size() > 1 && name[0] == 'L' && name[1] >= '0' && name[1] <= '9')
+		|| name.compare(0, 7, "errors_") == 0;
+
+	return prefix && (EndsWith(name, ".log") || EndsWith(name, ".gz") || EndsWith(name, ".gz.part"));
+}
+
+static bool StatFile(const char *path, time_t *modified, uint64_t *size)
+{
+#ifdef PLATFORM_WINDOWS
+	struct _stat64 s;
+	if (_stat64(path, &s) != 0)
+#elif defined PLATFORM_POSIX
+	struct stat s;
+	if (stat(path, &s) != 0)
+#endif
+	{
+		return false;
+	}
+
+	*modified = s.st_mtime;
+	*size = (uint64_t)s.st_size;
+	return true;
+}
+
+/* Lowers both CPU and, where the platform allows it, I/O priority of the calling thread. */
+static void LowerThreadPriority()
+{
+#if defined PLATFORM_WINDOWS
+	SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+#elif defined PLATFORM_LINUX
+	/* On Linux, both of these apply to the calling thread only. */
+	setpriority(PRIO_PROCESS, 0, 19);
+#if defined SYS_ioprio_set
+	const int kIoprioWhoProcess = 1;
+	const int kIoprioClassIdle = 3;
+	syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, kIoprioClassIdle << 13);
+#endif
+#elif defined PLATFORM_APPLE
+	setpriority(PRIO_DARWIN_THREAD, 0, PRIO_DARWIN_BG);
+#endif
+}
+
+LogArchiver::LogArchiver()
+ : m_Terminate(false),
+   m_Kicked(false),
+   m_Compress(false),
+   m_MaxDays(0),
+   m_MaxBytes(0),
+   m_Zlib(NULL),
+   m_ZlibFailed(false),
+   m_GzOpen(NULL),
+   m_GzWrite(NULL),
+   m_GzClose(NULL)
+{
+}
+
+LogArchiver::~LogArchiver()
+{
+	Stop();
+}
+
+void LogArchiver::Start(const char *logDir, const char *fatalPath)
+{
+	if (m_Thread)
+	{
+		return;
+	}
+
+	m_LogDir = logDir;
+	m_FatalPath = fatalPath;
+	m_Terminate = false;
+	m_Kicked = true;
+	m_Thread = ke::NewThread("SM Log Archiver", [this]() -> void {
+		Run();
+	});
+}
+
+void LogArchiver::Stop()
+{
+	if (!m_Thread)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		m_Terminate = true;
+		m_WakeEvent.notify_all();
+	}
+	m_Thread->join();
+	m_Thread = nullptr;
+
+	m_Ready.clear();
+	if (m_Zlib)
+	{
+		m_Zlib->CloseLibrary();
+		m_Zlib = NULL;
+	}
+	m_ZlibFailed = false;
+}
+
+bool LogArchiver::IsEnabled()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	return m_Compress || m_MaxDays || m_MaxBytes;
+}
+
+void LogArchiver::SetCompression(bool gzip)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	m_Compress = gzip;
+}
+
+void LogArchiver::SetRetention(unsigned int maxDays, uint64_t maxBytes)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	m_MaxDays = maxDays;
+	m_MaxBytes = maxBytes;
+}
+
+void LogArchiver::SetActive(LogTarget target, const char *path)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	m_Active[target] = BaseName(path);
+}
+
+void LogArchiver::Submit(const char *path)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	m_Submitted.emplace_back(BaseName(path));
+	m_WakeEvent.notify_one();
+}
+
+void LogArchiver::Kick()
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	m_Kicked = true;
+	m_WakeEvent.notify_one();
+}
+
+void LogArchiver::Run()
+{
+	LowerThreadPriority();
+
+	std::unique_lock<std::mutex> lock(m_Lock);
+	for (;;)
+	{
+		/* A timeout still sweeps, to catch files that have settled since. */
+		m_WakeEvent.wait_for(lock, std::chrono::seconds(kSweepIntervalSeconds), [this]() -> bool {
+			return m_Terminate || m_Kicked || !m_Submitted.empty();
+		});
+		if (m_Terminate)
+		{
+			break;
+		}
+
+		m_Kicked = false;
+		m_Ready.insert(m_Ready.end(), m_Submitted.begin(), m_Submitted.end());
+		m_Submitted.clear();
+
+		lock.unlock();
+		Sweep();
+		lock.lock();
+	}
+}
+
+void LogArchiver::Sweep()
+{
+	bool compress;
+	unsigned int maxDays;
+	uint64_t maxBytes;
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		compress = m_Compress;
+		maxDays = m_MaxDays;
+		maxBytes = m_MaxBytes;
+	}
+
+	if (compress && LoadZlib())
+	{
+		std::vector<LogFile> files;
+		ListFiles(files);
+
+		time_t now = time(NULL);
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			const LogFile &file = files[i];
+
+			/* Only this thread writes these, so any found here were abandoned. */
+			if (EndsWith(file.name, ".gz.part"))
+			{
+				remove((m_LogDir + PLATFORM_SEP + file.name).c_str());
+				continue;
+			}
+
+			if (!EndsWith(file.name, ".log") || IsActive(file.name))
+			{
+				continue;
+			}
+
+			bool ready = std::find(m_Ready.begin(), m_Ready.end(), file.name) != m_Ready.end();
+			if (!ready && now - file.modified < (time_t)kSettleSeconds)
+			{
+				continue;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_Lock);
+				if (m_Terminate)
+				{
+					return;
+				}
+			}
+
+			Compress(file);
+		}
+	}
+	m_Ready.clear();
+
+	if (maxDays || maxBytes)
+	{
+		EnforceRetention(maxDays, maxBytes);
+	}
+}
+
+void LogArchiver::ListFiles(std::vector<LogFile> &files)
+{
+	IDirectory *dir = libsys->OpenDirectory(m_LogDir.c_str());
+	if (!dir)
+	{
+		return;
+	}
+
+	while (dir->MoreFiles())
+	{
+		if (dir->IsEntryFile())
+		{
+			LogFile file;
+			file.name = dir->GetEntryName();
+			if (IsLogFileName(file.name)
+				&& StatFile((m_LogDir + PLATFORM_SEP + file.name).c_str(), &file.modified, &file.size))
+			{
+				files.push_back(file);
+			}
+		}
+		dir->NextEntry();
+	}
+	libsys->CloseDirectory(dir);
+
+	/* Oldest first. */
+	std::sort(files.begin(), files.end(), [](const LogFile &a, const LogFile &b) -> bool {
+		return a.modified < b.modified;
+	});
+}
+
+bool LogArchiver::Compress(const LogFile &file)
+{
+	std::string path = m_LogDir + PLATFORM_SEP + file.name;
+
+	std::string dest = path + ".gz";
+	for (unsigned int n = 1; libsys->PathExists(dest.c_str()); n++)
+	{
+		dest = path + "." + std::to_string(n) + ".gz";
+	}
+	std::string part = dest + ".part";
+
+	FILE *in = fopen(path.c_str(), "rb");
+	if (!in)
+	{
+		return false;
+	}
+
+	void *out = m_GzOpen(part.c_str(), "wb6");
+	if (!out)
+	{
+		fclose(in);
+		Report("[SM] Unable to create log archive \"%s\": %s", part.c_str(), strerror(errno));
+		return false;
+	}
+
+	bool ok = true;
+	std::unique_ptr<char[]> chunk(new char[kChunkSize]);
+	for (;;)
+	{
+		size_t len = fread(chunk.get(), 1, kChunkSize, in);
+		if (len == 0)
+		{
+			ok = !ferror(in);
+			break;
+		}
+		if (m_GzWrite(out, chunk.get(), (unsigned int)len) != (int)len)
+		{
+			ok = false;
+			break;
+		}
+
+		std::lock_guard<std::mutex> lock(m_Lock);
+		if (m_Terminate)
+		{
+			ok = false;
+			break;
+		}
+	}
+	fclose(in);
+
+	if (m_GzClose(out) != 0)
+	{
+		ok = false;
+	}
+
+	/* Give up if the file was written to while we were reading it. */
+	time_t modified;
+	uint64_t size;
+	if (ok && (!StatFile(path.c_str(), &modified, &size) || modified != file.modified || size != file.size))
+	{
+		ok = false;
+	}
+
+	if (!ok || rename(part.c_str(), dest.c_str()) != 0)
+	{
+		remove(part.c_str());
+		return false;
+	}
+
+	/* Keep the log's own age on the archive, retention goes by it. */
+	struct utimbuf times;
+	times.actime = file.modified;
+	times.modtime = file.modified;
+	utime(dest.c_str(), &times);
+
+	remove(path.c_str());
+	return true;
+}
+
+void LogArchiver::EnforceRetention(unsigned int maxDays, uint64_t maxBytes)
+{
+	std::vector<LogFile> files;
+	ListFiles(files);
+
+	uint64_t total = 0;
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		total += files[i].size;
+	}
+
+	time_t now = time(NULL);
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		const LogFile &file = files[i];
+
+		bool expired = maxDays && now - file.modified > (time_t)maxDays * 86400;
+		bool over = maxBytes && total > maxBytes;
+		if (!expired && !over)
+		{
+			/* Everything after this is newer. */
+			break;
+		}
+
+		if (IsActive(file.name))
+		{
+			continue;
+		}
+
+		if (remove((m_LogDir + PLATFORM_SEP + file.name).c_str()) == 0)
+		{
+			total -= file.size;
+		}
+	}
+}
+
+bool LogArchiver::IsActive(const std::string &name)
+{
+	std::lock_guard<std::mutex> lock(m_Lock);
+	for (size_t i = 0; i < LogTarget_Count; i++)
+	{
+		if (m_Active[i] == name)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool LogArchiver::LoadZlib()
+{
+	if (m_Zlib)
+	{
+		return true;
+	}
+	if (m_ZlibFailed)
+	{
+		return false;
+	}
+
+	char error[255];
+	m_Zlib = libsys->OpenLibrary(ZLIB_LIBRARY, error, sizeof(error));
+	if (m_Zlib)
+	{
+		m_GzOpen = (GzOpenFn)m_Zlib->GetSymbolAddress("gzopen");
+		m_GzWrite = (GzWriteFn)m_Zlib->GetSymbolAddress("gzwrite");
+		m_GzClose = (GzCloseFn)m_Zlib->GetSymbolAddress("gzclose");
+		if (m_GzOpen && m_GzWrite && m_GzClose)
+		{
+			return true;
+		}
+
+		ke::SafeStrcpy(error, sizeof(error), "missing gzip functions");
+		m_Zlib->CloseLibrary();
+		m_Zlib = NULL;
+	}
+
+	/* Only reported once per run, retention keeps working without it. */
+	m_ZlibFailed = true;
+	Report("[SM] Log compression is disabled, unable to load %s: %s", ZLIB_LIBRARY, error);
+	return false;
+}
+
+void LogArchiver::Report(const char *fmt, ...)
+{
+	FILE *fp = fopen(m_FatalPath.c_str(), "at");
+	if (!fp)
+	{
+		return;
+	}
+
+	va_list ap;
+	va_start(ap, fmt);
+	vfprintf(fp, fmt, ap);
+	va_end(ap);
+	fputc('\n', fp);
+	fclose(fp);
+}
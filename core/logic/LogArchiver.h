@@ -0,0 +1,163 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_SOURCEMOD_LOG_ARCHIVER_H_
+#define _INCLUDE_SOURCEMOD_LOG_ARCHIVER_H_
+
+#include <stdint.h>
+#include <time.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ILibrarySys.h>
+#include "LogWriter.h"
+
+/**
+ * Compresses closed log files and enforces retention limits on a 
+ * low-priority background thread.
+ *
+ * Only SourceMod's own log files in the logs folder are touched (L*.log 
+ * and errors_*.log, including pieces split off by size rotation).  The 
+ * files the Logger currently writes to are never compressed or deleted.  
+ * Other closed files are picked up either when the writer hands them over 
+ * through Submit(), or by a periodic sweep once they have not been 
+ * modified for kSettleSeconds.
+ *
+ * Compression uses the system zlib, loaded on first use, and produces 
+ * regular .gz files.  If zlib cannot be loaded, files are left as they are 
+ * and only retention is enforced.
+ */
+class LogArchiver
+{
+public:
+	static const unsigned int kSweepIntervalSeconds = 300;
+	static const unsigned int kSettleSeconds = 60;
+	static const size_t kChunkSize = 65536;
+public:
+	LogArchiver();
+	~LogArchiver();
+public:
+	/**
+	 * Starts the archiver thread.  Problems are reported to the file at 
+	 * fatalPath.
+	 */
+	void Start(const char *logDir, const char *fatalPath);
+
+	/**
+	 * Joins the archiver thread.  A compression in progress is abandoned 
+	 * and its partial output removed; the original file is kept.
+	 */
+	void Stop();
+
+	bool IsRunning() const
+	{
+		return !!m_Thread;
+	}
+
+	/**
+	 * Returns whether there is anything for the archiver to do.
+	 */
+	bool IsEnabled();
+
+	void SetCompression(bool gzip);
+
+	/**
+	 * Sets the retention limits.  Files older than maxDays are deleted, then 
+	 * the oldest files are deleted until all log files together fit in 
+	 * maxBytes.  Zero disables a limit.
+	 */
+	void SetRetention(unsigned int maxDays, uint64_t maxBytes);
+
+	/**
+	 * Sets the file a target is currently written to, which the archiver 
+	 * will leave alone.
+	 */
+	void SetActive(LogTarget target, const char *path);
+
+	/**
+	 * Hands over a log file that will not be written to again, so it can be 
+	 * compressed without waiting for it to settle.  Thread-safe.
+	 */
+	void Submit(const char *path);
+
+	/**
+	 * Requests a sweep of the logs folder.  Thread-safe.
+	 */
+	void Kick();
+private:
+	struct LogFile
+	{
+		std::string name;
+		time_t modified;
+		uint64_t size;
+	};
+private:
+	void Run();
+	void Sweep();
+	void ListFiles(std::vector<LogFile> &files);
+	bool Compress(const LogFile &file);
+	void EnforceRetention(unsigned int maxDays, uint64_t maxBytes);
+	bool IsActive(const std::string &name);
+	bool LoadZlib();
+	void Report(const char *fmt, ...);
+private:
+	typedef void *(*GzOpenFn)(const char *, const char *);
+	typedef int (*GzWriteFn)(void *, const void *, unsigned int);
+	typedef int (*GzCloseFn)(void *);
+
+	std::unique_ptr<std::thread> m_Thread;
+	std::mutex m_Lock;
+	std::condition_variable m_WakeEvent;
+
+	/* Guarded by m_Lock. */
+	bool m_Terminate;
+	bool m_Kicked;
+	bool m_Compress;
+	unsigned int m_MaxDays;
+	uint64_t m_MaxBytes;
+	std::string m_Active[LogTarget_Count];
+	std::vector<std::string> m_Submitted;
+
+	/* Only touched by the archiver thread while it is running. */
+	std::string m_LogDir;
+	std::string m_FatalPath;
+	std::vector<std::string> m_Ready;
+	SourceMod::ILibrary *m_Zlib;
+	bool m_ZlibFailed;
+	GzOpenFn m_GzOpen;
+	GzWriteFn m_GzWrite;
+	GzCloseFn m_GzClose;
+};
+
+#endif //_INCLUDE_SOURCEMOD_LOG_ARCHIVER_H_
@@ -0,0 +1,356 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+#include "common_logic.h"
+#include "LogWriter.h"
+#include "LogArchiver.h"
+#include <am-thread.h>
+
+AsyncLogWriter::AsyncLogWriter()
+ : m_Entries(new Entry[kQueueSize]),
+   m_EnqueuePos(0),
+   m_DequeuePos(0),
+   m_Dropped(0),
+   m_Sleeping(false),
+   m_Policy(LogQueuePolicy_Drop),
+   m_RotateSize(0),
+   m_Archiver(NULL),
+   m_Terminate(false),
+   m_UnflushedBytes(0)
+{
+	for (size_t i = 0; i < kQueueSize; i++)
+	{
+		m_Entries[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	for (size_t i = 0; i < LogTarget_Count; i++)
+	{
+		m_Files[i] = NULL;
+		m_FileBytes[i] = 0;
+	}
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+	Stop();
+}
+
+void AsyncLogWriter::Start(const char *fatalPath)
+{
+	if (m_Thread)
+	{
+		return;
+	}
+
+	m_FatalPath = fatalPath;
+	m_Terminate = false;
+	m_Thread = ke::NewThread("SM Log Writer", [this]() -> void {
+		Run();
+	});
+}
+
+void AsyncLogWriter::Stop()
+{
+	if (!m_Thread)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_WakeLock);
+		m_Terminate = true;
+		m_WakeEvent.notify_all();
+	}
+	m_Thread->join();
+	m_Thread = nullptr;
+}
+
+bool AsyncLogWriter::Open(LogTarget target, const char *path)
+{
+	return Enqueue(Entry_Open, target, path, strlen(path));
+}
+
+bool AsyncLogWriter::Write(LogTarget target, const char *line, size_t length)
+{
+	return Enqueue(Entry_Line, target, line, length);
+}
+
+bool AsyncLogWriter::Enqueue(EntryType type, LogTarget target, const char *text, size_t length)
+{
+	/* Control entries must never be lost, otherwise lines would end up in 
+	 * a stale file.
+	 */
+	while (!TryEnqueue(type, target, text, length))
+	{
+		if (type == Entry_Line && m_Policy == LogQueuePolicy_Drop)
+		{
+			m_Dropped++;
+			return false;
+		}
+		std::this_thread::yield();
+	}
+
+	if (m_Sleeping.load())
+	{
+		std::lock_guard<std::mutex> lock(m_WakeLock);
+		m_WakeEvent.notify_one();
+	}
+
+	return true;
+}
+
+bool AsyncLogWriter::TryEnqueue(EntryType type, LogTarget target, const char *text, size_t length)
+{
+	Entry *entry;
+	size_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		entry = &m_Entries[pos & (kQueueSize - 1)];
+		size_t seq = entry->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+		if (diff == 0)
+		{
+			if (m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (diff < 0)
+		{
+			return false;
+		}
+		else
+		{
+			pos = m_EnqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	if (length >= kMaxLineLength)
+	{
+		length = kMaxLineLength - 1;
+	}
+
+	entry->type = type;
+	entry->target = target;
+	entry->length = length;
+	memcpy(entry->text, text, length);
+	entry->text[length] = '\0';
+	entry->sequence.store(pos + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool AsyncLogWriter::TryDequeue()
+{
+	/* Single consumer, so no CAS is needed on the read side. */
+	size_t pos = m_DequeuePos.load(std::memory_order_relaxed);
+	Entry *entry = &m_Entries[pos & (kQueueSize - 1)];
+	size_t seq = entry->sequence.load(std::memory_order_acquire);
+	if ((intptr_t)seq - (intptr_t)(pos + 1) < 0)
+	{
+		return false;
+	}
+
+	FILE *&fp = m_Files[entry->target];
+	std::string &path = m_Paths[entry->target];
+	uint64_t &bytes = m_FileBytes[entry->target];
+	if (entry->type == Entry_Open)
+	{
+		if (fp)
+		{
+			fclose(fp);
+			if (m_Archiver && path.compare(entry->text))
+			{
+				m_Archiver->Submit(path.c_str());
+			}
+		}
+		path = entry->text;
+		bytes = 0;
+		if ((fp = fopen(entry->text, "a+")) == NULL)
+		{
+			ReportOpenFailure(entry->text);
+		}
+		else if (fseek(fp, 0, SEEK_END) == 0)
+		{
+			long pos = ftell(fp);
+			bytes = pos > 0 ? (uint64_t)pos : 0;
+		}
+	}
+	else if (fp)
+	{
+		uint64_t limit = m_RotateSize.load(std::memory_order_relaxed);
+		if (limit && bytes && bytes + entry->length > limit)
+		{
+			Rotate(entry->target);
+		}
+		if (fp)
+		{
+			fwrite(entry->text, 1, entry->length, fp);
+			m_UnflushedBytes += entry->length;
+			bytes += entry->length;
+		}
+	}
+
+	m_DequeuePos.store(pos + 1, std::memory_order_relaxed);
+	entry->sequence.store(pos + kQueueSize, std::memory_order_release);
+
+	return true;
+}
+
+void AsyncLogWriter::Run()
+{
+	using namespace std::chrono;
+
+	steady_clock::time_point lastFlush = steady_clock::now();
+	std::unique_lock<std::mutex> lock(m_WakeLock);
+
+	for (;;)
+	{
+		lock.unlock();
+		while (TryDequeue())
+		{
+			if (m_UnflushedBytes >= kFlushBytes)
+			{
+				FlushAll();
+				lastFlush = steady_clock::now();
+			}
+		}
+		if (m_UnflushedBytes && steady_clock::now() - lastFlush >= milliseconds(kFlushIntervalMs))
+		{
+			FlushAll();
+			lastFlush = steady_clock::now();
+		}
+		lock.lock();
+
+		/* Publish that we are about to sleep before the final emptiness 
+		 * check, so producers that slip in afterwards will wake us.
+		 */
+		m_Sleeping = true;
+		size_t pos = m_DequeuePos.load(std::memory_order_relaxed);
+		bool empty = ((intptr_t)m_Entries[pos & (kQueueSize - 1)].sequence.load(std::memory_order_acquire) - (intptr_t)(pos + 1) < 0);
+		if (empty)
+		{
+			if (m_Terminate)
+			{
+				m_Sleeping = false;
+				break;
+			}
+			m_WakeEvent.wait_for(lock, milliseconds(kFlushIntervalMs));
+		}
+		m_Sleeping = false;
+	}
+
+	CloseAll();
+}
+
+void AsyncLogWriter::FlushAll()
+{
+	for (size_t i = 0; i < LogTarget_Count; i++)
+	{
+		if (m_Files[i])
+		{
+			fflush(m_Files[i]);
+		}
+	}
+	m_UnflushedBytes = 0;
+}
+
+void AsyncLogWriter::CloseAll()
+{
+	for (size_t i = 0; i < LogTarget_Count; i++)
+	{
+		if (m_Files[i])
+		{
+			fclose(m_Files[i]);
+			m_Files[i] = NULL;
+		}
+		m_Paths[i].clear();
+		m_FileBytes[i] = 0;
+	}
+	m_UnflushedBytes = 0;
+}
+
+void AsyncLogWriter::Rotate(LogTarget target)
+{
+	FILE *&fp = m_Files[target];
+	const std::string &path = m_Paths[target];
+
+	/* L20261015.log becomes L20261015.1.log, skipping names already taken 
+	 * by earlier pieces or their archives.
+	 */
+	std::string stem = path;
+	if (stem.size() > 4 && stem.compare(stem.size() - 4, 4, ".log") == 0)
+	{
+		stem.resize(stem.size() - 4);
+	}
+
+	std::string rotated;
+	for (unsigned int n = 1; ; n++)
+	{
+		rotated = stem + "." + std::to_string(n) + ".log";
+		if (!libsys->PathExists(rotated.c_str()) && !libsys->PathExists((rotated + ".gz").c_str()))
+		{
+			break;
+		}
+	}
+
+	fclose(fp);
+
+	/* If the rename fails, keep appending to the same file and try again 
+	 * once another rotation's worth has been written.
+	 */
+	bool renamed = (rename(path.c_str(), rotated.c_str()) == 0);
+	if ((fp = fopen(path.c_str(), "a+")) == NULL)
+	{
+		ReportOpenFailure(path.c_str());
+	}
+	m_FileBytes[target] = 0;
+
+	if (renamed && m_Archiver)
+	{
+		m_Archiver->Submit(rotated.c_str());
+	}
+}
+
+void AsyncLogWriter::ReportOpenFailure(const char *path)
+{
+	FILE *fp = fopen(m_FatalPath.c_str(), "at");
+	if (!fp)
+	{
+		return;
+	}
+
+	fprintf(fp, "[SM] Unexpected fatal logging error (file \"%s\"): %s\n", path, strerror(errno));
+	fclose(fp);
+}
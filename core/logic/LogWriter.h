@@ -0,0 +1,200 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_SOURCEMOD_LOG_WRITER_H_
+#define _INCLUDE_SOURCEMOD_LOG_WRITER_H_
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class LogArchiver;
+
+enum LogTarget
+{
+	LogTarget_Normal,
+	LogTarget_Error,
+	LogTarget_Count
+};
+
+enum LogQueuePolicy
+{
+	LogQueuePolicy_Drop,		/**< Discard lines while the queue is full and report how many were lost */
+	LogQueuePolicy_Block,		/**< Stall the logging thread until the writer frees up a slot */
+};
+
+/**
+ * Writes log lines to disk on a background thread.
+ *
+ * Lines are handed over through a fixed-size lock-free ring, so logging 
+ * from the game thread never waits on disk I/O unless the ring is full and 
+ * the queue policy is LogQueuePolicy_Block.  The writer keeps each target 
+ * file open and flushes once kFlushBytes have been written, or once 
+ * kFlushIntervalMs have passed since the first unflushed write.
+ *
+ * When a rotation size is set, a file that would grow past it is renamed to 
+ * the first free <name>.<n>.log and a fresh file is opened in its place.  
+ * Files the writer is done with are handed to the LogArchiver, if any.
+ */
+class AsyncLogWriter
+{
+public:
+	static const size_t kQueueSize = 256;				/**< Must be a power of two */
+	static const size_t kMaxLineLength = 3584;
+	static const size_t kFlushBytes = 16384;
+	static const unsigned int kFlushIntervalMs = 250;
+public:
+	AsyncLogWriter();
+	~AsyncLogWriter();
+public:
+	/**
+	 * Starts the writer thread.  Failures to open log files are reported 
+	 * to the file at fatalPath.
+	 */
+	void Start(const char *fatalPath);
+
+	/**
+	 * Writes out everything queued so far, closes all files and joins 
+	 * the writer thread.
+	 */
+	void Stop();
+
+	bool IsRunning() const
+	{
+		return !!m_Thread;
+	}
+
+	/**
+	 * Redirects a target to a new file.  The file is opened in append mode 
+	 * and the previous one is closed once every line queued before this 
+	 * call has been written.
+	 */
+	bool Open(LogTarget target, const char *path);
+
+	/**
+	 * Queues a fully formatted line (including the trailing newline).
+	 */
+	bool Write(LogTarget target, const char *line, size_t length);
+
+	/**
+	 * Returns the number of lines that were dropped since the last call.
+	 */
+	unsigned int TakeDropped()
+	{
+		return m_Dropped.exchange(0);
+	}
+
+	void SetQueuePolicy(LogQueuePolicy policy)
+	{
+		m_Policy = policy;
+	}
+
+	/**
+	 * Sets the size in bytes at which a log file is rotated, or 0 to never 
+	 * rotate.
+	 */
+	void SetRotateSize(uint64_t bytes)
+	{
+		m_RotateSize = bytes;
+	}
+
+	/**
+	 * Sets the archiver that closed files are handed to.  Must not be changed 
+	 * while the writer is running.
+	 */
+	void SetArchiver(LogArchiver *archiver)
+	{
+		m_Archiver = archiver;
+	}
+
+	/**
+	 * Returns the number of entries waiting for the writer thread.
+	 */
+	size_t GetQueueDepth() const
+	{
+		size_t head = m_EnqueuePos.load(std::memory_order_relaxed);
+		size_t tail = m_DequeuePos.load(std::memory_order_relaxed);
+		return head > tail ? head - tail : 0;
+	}
+private:
+	enum EntryType
+	{
+		Entry_Line,
+		Entry_Open,
+	};
+
+	struct Entry
+	{
+		std::atomic<size_t> sequence;
+		EntryType type;
+		LogTarget target;
+		size_t length;
+		char text[kMaxLineLength];
+	};
+private:
+	bool Enqueue(EntryType type, LogTarget target, const char *text, size_t length);
+	bool TryEnqueue(EntryType type, LogTarget target, const char *text, size_t length);
+	bool TryDequeue();
+	void Run();
+	void FlushAll();
+	void CloseAll();
+	void Rotate(LogTarget target);
+	void ReportOpenFailure(const char *path);
+private:
+	std::unique_ptr<Entry[]> m_Entries;
+	std::atomic<size_t> m_EnqueuePos;
+	std::atomic<size_t> m_DequeuePos;
+	std::atomic<unsigned int> m_Dropped;
+	std::atomic<bool> m_Sleeping;
+	LogQueuePolicy m_Policy;
+	std::atomic<uint64_t> m_RotateSize;
+	LogArchiver *m_Archiver;
+
+	std::unique_ptr<std::thread> m_Thread;
+	std::mutex m_WakeLock;
+	std::condition_variable m_WakeEvent;
+	bool m_Terminate;
+
+	/* Only touched by the writer thread while it is running. */
+	FILE *m_Files[LogTarget_Count];
+	std::string m_Paths[LogTarget_Count];
+	uint64_t m_FileBytes[LogTarget_Count];
+	size_t m_UnflushedBytes;
+	std::string m_FatalPath;
+};
+
+#endif //_INCLUDE_SOURCEMOD_LOG_WRITER_H_
@@ -95,6 +95,101 @@ ConfigResult Logger::OnSourceModConfigChanged(const char *key,
 			m_UserTimeFormat.assign(value);
 		}
 
+		return ConfigResult_Accept;
+	} else if (strcasecmp(key, "AsyncLogging") == 0) {
+		bool state;
+
+		if (strcasecmp(value, "on") == 0)
+		{
+			state = true;
+		} else if (strcasecmp(value, "off") == 0) {
+			state = false;
+		} else {
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be \"on\" or \"off\"");
+			return ConfigResult_Reject;
+		}
+
+		if (!state)
+		{
+			_StopAsyncWriter();
+		}
+		m_AsyncLogging = state;
+
+		return ConfigResult_Accept;
+	} else if (strcasecmp(key, "LogQueueFullPolicy") == 0) {
+		if (strcasecmp(value, "drop") == 0)
+		{
+			m_Writer.SetQueuePolicy(LogQueuePolicy_Drop);
+		} else if (strcasecmp(value, "block") == 0) {
+			m_Writer.SetQueuePolicy(LogQueuePolicy_Block);
+		} else {
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be [drop|block]");
+			return ConfigResult_Reject;
+		}
+
+		return ConfigResult_Accept;
+	} else if (strcasecmp(key, "SyncErrorLog") == 0) {
+		bool state;
+
+		if (strcasecmp(value, "yes") == 0)
+		{
+			state = true;
+		} else if (strcasecmp(value, "no") == 0) {
+			state = false;
+		} else {
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be \"yes\" or \"no\"");
+			return ConfigResult_Reject;
+		}
+
+		/* The error file must never be owned by both paths at once. */
+		if (state != m_SyncErrorLog)
+		{
+			_StopAsyncWriter();
+		}
+		m_SyncErrorLog = state;
+
+		return ConfigResult_Accept;
+	} else if (strcasecmp(key, "LogRotateSize") == 0) {
+		char *end;
+		unsigned long size = strtoul(value, &end, 10);
+		if (!value[0] || *end != '\0')
+		{
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be a size in megabytes, or 0");
+			return ConfigResult_Reject;
+		}
+
+		m_Writer.SetRotateSize((uint64_t)size * 1024 * 1024);
+
+		return ConfigResult_Accept;
+	} else if (strcasecmp(key, "LogCompression") == 0) {
+		if (strcasecmp(value, "none") == 0)
+		{
+			m_Archiver.SetCompression(false);
+		} else if (strcasecmp(value, "gzip") == 0) {
+			m_Archiver.SetCompression(true);
+		} else {
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be [none|gzip]");
+			return ConfigResult_Reject;
+		}
+
+		return ConfigResult_Accept;
+	} else if (strcasecmp(key, "LogRetentionDays") == 0 || strcasecmp(key, "LogRetentionSize") == 0) {
+		char *end;
+		unsigned long limit = strtoul(value, &end, 10);
+		if (!value[0] || *end != '\0')
+		{
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be a positive number, or 0");
+			return ConfigResult_Reject;
+		}
+
+		if (strcasecmp(key, "LogRetentionDays") == 0)
+		{
+			m_RetentionDays = (unsigned int)limit;
+		} else {
+			m_RetentionBytes = (uint64_t)limit * 1024 * 1024;
+		}
+		m_Archiver.SetRetention(m_RetentionDays, m_RetentionBytes);
+
 		return ConfigResult_Accept;
 	}
 
@@ -124,6 +219,12 @@ void Logger::OnSourceModLevelChange(const char *mapName)
 void Logger::CloseLogger()
 {
 	_CloseFile();
+
+	/* Anything logged after this point is written synchronously. */
+	_StopAsyncWriter();
+	m_AsyncLogging = false;
+
+	m_Archiver.Stop();
 }
 
 void Logger::_CloseFile()
@@ -211,6 +312,15 @@ void Logger::LogMessageEx(const char *vafmt, va_list ap)
 		return;
 	}
 
+	if (_UseAsyncWriter(false))
+	{
+		if (_PrepareAsyncNormal())
+		{
+			_QueueLine(LogTarget_Normal, vafmt, ap);
+		}
+		return;
+	}
+
 	FILE *pFile = _OpenNormal();
 	if (!pFile)
 	{
@@ -236,6 +346,15 @@ void Logger::LogErrorEx(const char *vafmt, va_list ap)
 		return;
 	}
 
+	if (_UseAsyncWriter(true))
+	{
+		if (_PrepareAsyncError())
+		{
+			_QueueLine(LogTarget_Error, vafmt, ap);
+		}
+		return;
+	}
+
 	FILE *pFile = _OpenError();
 	if (!pFile)
 	{
@@ -334,8 +453,11 @@ void Logger::_UpdateFiles(bool bLevelChange)
 		{
 			for (size_t iter = 0; iter < static_cast<size_t>(-1); ++iter)
 			{
+				/* Skip names whose log has already been archived, too. */
+				char archive[PLATFORM_MAX_PATH];
 				g_pSM->BuildPath(Path_SM, buff, sizeof(buff), "logs/L%s%u.log", currentDate.c_str(), iter);
-				if (!libsys->IsPathFile(buff))
+				ke::SafeSprintf(archive, sizeof(archive), "%s.gz", buff);
+				if (!libsys->IsPathFile(buff) && !libsys->IsPathFile(archive))
 				{
 					break;
 				}
@@ -370,6 +492,8 @@ void Logger::_UpdateFiles(bool bLevelChange)
 		_CloseError();
 		m_ErrorFileName = buff;
 	}
+
+	_UpdateArchiver();
 }
 
 FILE *Logger::_OpenNormal()
@@ -430,6 +554,134 @@ void Logger::_LogFatalOpen(std::string &str)
 	LogFatal("[SM] Platform returned error: \"%s\"", error);
 }
 
+bool Logger::_UseAsyncWriter(bool error)
+{
+	if (!m_AsyncLogging || (error && m_SyncErrorLog))
+	{
+		return false;
+	}
+
+	if (!m_Writer.IsRunning())
+	{
+		char path[PLATFORM_MAX_PATH];
+		g_pSM->BuildPath(Path_Game, path, sizeof(path), "sourcemod_fatal.log");
+		m_Writer.Start(path);
+	}
+
+	return true;
+}
+
+bool Logger::_PrepareAsyncNormal()
+{
+	_UpdateFiles();
+
+	if (m_WriterNormalName.compare(m_NormalFileName))
+	{
+		if (!m_Writer.Open(LogTarget_Normal, m_NormalFileName.c_str()))
+		{
+			return false;
+		}
+		m_WriterNormalName = m_NormalFileName;
+	}
+
+	if (!m_DamagedNormalFile)
+	{
+		char line[AsyncLogWriter::kMaxLineLength];
+		size_t len = ke::SafeSprintf(line, sizeof(line), "L %s: SourceMod log file session started (file \"%s\") (Version \"%s\")\n", GetFormattedDate(), m_NormalFileName.c_str(), SOURCEMOD_VERSION);
+		m_Writer.Write(LogTarget_Normal, line, len);
+		m_DamagedNormalFile = true;
+	}
+
+	return true;
+}
+
+bool Logger::_PrepareAsyncError()
+{
+	_UpdateFiles();
+
+	if (m_WriterErrorName.compare(m_ErrorFileName))
+	{
+		if (!m_Writer.Open(LogTarget_Error, m_ErrorFileName.c_str()))
+		{
+			return false;
+		}
+		m_WriterErrorName = m_ErrorFileName;
+	}
+
+	if (!m_DamagedErrorFile)
+	{
+		char line[AsyncLogWriter::kMaxLineLength];
+		const char *date = GetFormattedDate();
+		size_t len = ke::SafeSprintf(line, sizeof(line), "L %s: SourceMod error session started\n", date);
+		m_Writer.Write(LogTarget_Error, line, len);
+		len = ke::SafeSprintf(line, sizeof(line), "L %s: Info (map \"%s\") (file \"%s\")\n", date, m_CurrentMapName.c_str(), m_ErrorFileName.c_str());
+		m_Writer.Write(LogTarget_Error, line, len);
+		m_DamagedErrorFile = true;
+	}
+
+	return true;
+}
+
+void Logger::_QueueLine(LogTarget target, const char *msg, va_list ap)
+{
+	static ConVar *sv_logecho = bridge->FindConVar("sv_logecho");
+
+	char buffer[3072];
+	ke::SafeVsprintf(buffer, sizeof(buffer), msg, ap);
+
+	const char *date = GetFormattedDate();
+
+	char line[AsyncLogWriter::kMaxLineLength];
+	size_t len;
+
+	unsigned int dropped = m_Writer.TakeDropped();
+	if (dropped)
+	{
+		len = ke::SafeSprintf(line, sizeof(line), "L %s: [SM] %u log message(s) were dropped because the log queue was full\n", date, dropped);
+		m_Writer.Write(target, line, len);
+	}
+
+	len = ke::SafeSprintf(line, sizeof(line), "L %s: %s\n", date, buffer);
+	m_Writer.Write(target, line, len);
+
+	if (!sv_logecho || bridge->GetCvarBool(sv_logecho))
+	{
+		bridge->ConPrint(line);
+	}
+}
+
+void Logger::_StopAsyncWriter()
+{
+	m_Writer.Stop();
+	m_WriterNormalName.clear();
+	m_WriterErrorName.clear();
+}
+
+void Logger::_UpdateArchiver()
+{
+	if (!m_Archiver.IsEnabled())
+	{
+		return;
+	}
+
+	/* The archiver must know which files are in use before its first sweep. */
+	m_Archiver.SetActive(LogTarget_Normal, m_NormalFileName.c_str());
+	m_Archiver.SetActive(LogTarget_Error, m_ErrorFileName.c_str());
+
+	if (!m_Archiver.IsRunning())
+	{
+		char logs[PLATFORM_MAX_PATH];
+		char fatal[PLATFORM_MAX_PATH];
+		g_pSM->BuildPath(Path_SM, logs, sizeof(logs), "logs");
+		g_pSM->BuildPath(Path_Game, fatal, sizeof(fatal), "sourcemod_fatal.log");
+		m_Archiver.Start(logs, fatal);
+	}
+	else
+	{
+		m_Archiver.Kick();
+	}
+}
+
 void Logger::_CloseNormal()
 {
 	if (m_DamagedNormalFile)
@@ -36,6 +36,8 @@
 #include <stdio.h>
 #include <amtl/am-string.h>
 #include <bridge/include/ILogger.h>
+#include "LogWriter.h"
+#include "LogArchiver.h"
 
 enum LogType
 {
@@ -53,8 +55,9 @@ enum LoggingMode
 class Logger : public SMGlobalClass, public ILogger
 {
 public:
-	Logger() : m_Day(-1), m_Mode(LoggingMode_Daily), m_Active(true), m_DamagedNormalFile(false), m_DamagedErrorFile(false), m_isUsingDefaultTimeFormat(true)
+	Logger() : m_Day(-1), m_Mode(LoggingMode_Daily), m_Active(true), m_DamagedNormalFile(false), m_DamagedErrorFile(false), m_isUsingDefaultTimeFormat(true), m_AsyncLogging(true), m_SyncErrorLog(true), m_RetentionDays(0), m_RetentionBytes(0)
 	{
+		m_Writer.SetArchiver(&m_Archiver);
 	}
 public: //SMGlobalClass
 	ConfigResult OnSourceModConfigChanged(const char *key, 
@@ -80,6 +83,11 @@ public:
 	/* This version does not print to console, and is thus thread-safe */
 	void LogToFileOnly(FILE *fp, const char *msg, ...);
 	void LogToFileOnlyEx(FILE *fp, const char *msg, va_list ap);
+	/* Number of lines waiting on the async writer thread */
+	size_t GetQueueDepth() const
+	{
+		return m_Writer.GetQueueDepth();
+	}
 private:
 	void _MapChange(const char *mapname);
 
@@ -96,6 +104,13 @@ private:
 	void _PrintToGameLog(const char *fmt, va_list ap);
 	void _UpdateFiles(bool bLevelChange = false);
 	const char* GetFormattedDate() const;
+
+	bool _UseAsyncWriter(bool error);
+	bool _PrepareAsyncNormal();
+	bool _PrepareAsyncError();
+	void _QueueLine(LogTarget target, const char *msg, va_list ap);
+	void _StopAsyncWriter();
+	void _UpdateArchiver();
 private:
 	std::string m_NormalFileName;
 	std::string m_ErrorFileName;
@@ -109,6 +124,16 @@ private:
 	bool m_DamagedNormalFile;
 	bool m_DamagedErrorFile;
 	bool m_isUsingDefaultTimeFormat;
+
+	AsyncLogWriter m_Writer;
+	std::string m_WriterNormalName;
+	std::string m_WriterErrorName;
+	bool m_AsyncLogging;
+	bool m_SyncErrorLog;
+
+	LogArchiver m_Archiver;
+	unsigned int m_RetentionDays;
+	uint64_t m_RetentionBytes;
 };
 
 extern Logger g_Logger;
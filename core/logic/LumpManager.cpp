@@ -31,32 +31,185 @@
 
 #include "LumpManager.h"
 
-#include <iomanip>
-#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 
 EntityLumpParseResult::operator bool() const {
 	return m_Status == Status_OK;
 }
 
+EntityLumpEntry::EntityLumpEntry(EntityLumpManager* manager)
+	: m_pManager(manager), m_pViews(nullptr), m_nViews(0), m_bOwned(true)
+{
+}
+
+EntityLumpEntry::EntityLumpEntry(EntityLumpManager* manager, const EntityLumpKeyValueView* views, size_t count)
+	: m_pManager(manager), m_pViews(views), m_nViews(count), m_bOwned(false)
+{
+}
+
+size_t EntityLumpEntry::size() const {
+	return m_bOwned ? m_Owned.size() : m_nViews;
+}
+
+const char* EntityLumpEntry::Key(size_t index) const {
+	return m_bOwned ? m_Owned[index].first.c_str() : m_pViews[index].first.data();
+}
+
+const char* EntityLumpEntry::Value(size_t index) const {
+	return m_bOwned ? m_Owned[index].second.c_str() : m_pViews[index].second.data();
+}
+
+int EntityLumpEntry::FindKey(const char* key, size_t start) const {
+	for (size_t i = start; i < size(); i++) {
+		if (strcmp(Key(i), key) == 0) {
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
+
+void EntityLumpEntry::Update(size_t index, const char* key, const char* value) {
+	Materialize();
+	auto& pair = m_Owned[index];
+	if (key != nullptr) {
+		pair.first = key;
+	}
+	if (value != nullptr) {
+		pair.second = value;
+	}
+	m_pManager->InvalidateIndex();
+}
+
+void EntityLumpEntry::Insert(size_t index, const char* key, const char* value) {
+	Materialize();
+	m_Owned.emplace(m_Owned.begin() + index, key, value);
+	m_pManager->InvalidateIndex();
+}
+
+void EntityLumpEntry::Erase(size_t index) {
+	Materialize();
+	m_Owned.erase(m_Owned.begin() + index);
+	m_pManager->InvalidateIndex();
+}
+
+void EntityLumpEntry::Append(const char* key, const char* value) {
+	Materialize();
+	m_Owned.emplace_back(key, value);
+	m_pManager->InvalidateIndex();
+}
+
+void EntityLumpEntry::Materialize() {
+	if (m_bOwned) {
+		return;
+	}
+	m_Owned.reserve(m_nViews);
+	for (size_t i = 0; i < m_nViews; i++) {
+		m_Owned.emplace_back(m_pViews[i].first, m_pViews[i].second);
+	}
+	m_pViews = nullptr;
+	m_nViews = 0;
+	m_bOwned = true;
+}
+
+bool EntityLumpEntry::IsMaterialized() const {
+	return m_bOwned;
+}
+
+static char* SkipWhitespace(char* pos) {
+	while (*pos != '\0' && isspace(static_cast<unsigned char>(*pos))) {
+		pos++;
+	}
+	return pos;
+}
+
+/**
+ * Reads a quoted string in place, with the same backslash escaping as std::quoted.  The
+ * unescaped contents are null-terminated over the closing quote (or earlier, if anything was
+ * unescaped), so views into the buffer can be handed out as C strings.
+ */
+static bool ReadQuoted(char*& pos, std::string_view& out) {
+	if (*pos != '"') {
+		return false;
+	}
+	char* start = ++pos;
+	char* write = start;
+	while (*pos != '"') {
+		if (*pos == '\0') {
+			return false;
+		}
+		if (*pos == '\\' && pos[1] != '\0') {
+			pos++;
+		}
+		*write++ = *pos++;
+	}
+	pos++;
+	*write = '\0';
+	out = std::string_view(start, write - start);
+	return true;
+}
+
+EntityLumpManager::EntityLumpManager() : m_ParseMode(ParseMode_Lazy), m_bIndexValid(false) {
+}
+
+void EntityLumpManager::SetParseMode(EntityLumpParseMode mode) {
+	m_ParseMode = mode;
+}
+
 EntityLumpParseResult EntityLumpManager::Parse(const char* pMapEntities) {
+	// drop the entries before the buffer they may still point into
 	m_Entities.clear();
+	m_KeyValues.clear();
+	InvalidateIndex();
+	
+	m_Buffer = pMapEntities;
 	
-	std::istringstream mapEntities(pMapEntities);
+	char* base = &m_Buffer[0];
+	char* pos = base;
+	
+	// m_KeyValues may still reallocate while parsing, so entries are created once it is done
+	std::vector<std::pair<size_t, size_t>> ranges;
+	auto finish = [&](EntityLumpParseResult result) {
+		m_Entities.reserve(ranges.size());
+		for (const auto& range : ranges) {
+			auto entry = std::make_shared<EntityLumpEntry>(this, m_KeyValues.data() + range.first, range.second);
+			if (m_ParseMode == ParseMode_Owned) {
+				entry->Materialize();
+			}
+			m_Entities.push_back(std::move(entry));
+		}
+		if (m_ParseMode == ParseMode_Owned) {
+			std::string().swap(m_Buffer);
+			std::vector<EntityLumpKeyValueView>().swap(m_KeyValues);
+		}
+		return result;
+	};
+	
+	// Report errors where the istringstream parser did: a stream that had run into the end of
+	// the input reported -1, and a bad block opener was only seen after the whitespace
+	// following it had been skipped.
+	auto error = [&](const char* at) {
+		return finish(EntityLumpParseResult {
+			Status_UnexpectedChar, *at == '\0' ? std::streamoff(-1) : std::streamoff(at - base)
+		});
+	};
 	
 	for (;;) {
-		std::string token;
-		mapEntities >> std::ws >> token >> std::ws;
+		pos = SkipWhitespace(pos);
+		if (*pos == '\0') {
+			break;
+		}
 		
 		// Assert that we're at the start of a new block, otherwise we're done parsing
-		if (token != "{") {
-			if (token == "\0") {
-				break;
-			} else {
-				return EntityLumpParseResult {
-					Status_UnexpectedChar, mapEntities.tellg()
-				};
-			}
+		char* token = pos;
+		while (*pos != '\0' && !isspace(static_cast<unsigned char>(*pos))) {
+			pos++;
 		}
+		if (pos - token != 1 || *token != '{') {
+			return error(SkipWhitespace(pos));
+		}
+		pos = SkipWhitespace(pos);
 		
 		/**
 		 * Parse key / value pairs until we reach a closing brace.  We currently assume there
@@ -66,47 +219,48 @@ EntityLumpParseResult EntityLumpManager::Parse(const char* pMapEntities) {
 		 * braces (`shared/mapentities_shared.cpp::MapEntity_ParseToken`), but I haven't seen
 		 * those in practice.
 		 */
-		EntityLumpEntry entry;
-		while (mapEntities.peek() != '}') {
-			std::string key, value;
+		size_t first = m_KeyValues.size();
+		while (*pos != '}') {
+			std::string_view key, value;
 			
-			if (mapEntities.peek() != '"') {
-				return EntityLumpParseResult {
-					Status_UnexpectedChar, mapEntities.tellg()
-				};
+			if (!ReadQuoted(pos, key)) {
+				return error(pos);
 			}
-			mapEntities >> quoted(key) >> std::ws;
+			pos = SkipWhitespace(pos);
 			
-			if (mapEntities.peek() != '"') {
-				return EntityLumpParseResult {
-					Status_UnexpectedChar, mapEntities.tellg()
-				};
+			if (!ReadQuoted(pos, value)) {
+				return error(pos);
 			}
-			mapEntities >> quoted(value) >> std::ws;
+			pos = SkipWhitespace(pos);
 			
-			entry.emplace_back(key, value);
+			m_KeyValues.emplace_back(key, value);
 		}
-		mapEntities.get();
-		m_Entities.push_back(std::make_shared<EntityLumpEntry>(entry));
+		pos++;
+		ranges.emplace_back(first, m_KeyValues.size() - first);
 	}
 	
-	return EntityLumpParseResult{};
+	return finish(EntityLumpParseResult{});
 }
 
 std::string EntityLumpManager::Dump() {
-	std::ostringstream stream;
+	std::string result;
+	result.reserve(m_Buffer.size());
 	for (const auto& entry : m_Entities) {
 		// ignore empty entries
-		if (entry->empty()) {
+		if (entry->size() == 0) {
 			continue;
 		}
-		stream << "{\n";
-		for (const auto& pair : *entry) {
-			stream << '"' << pair.first << "\" \"" << pair.second << '"' << '\n';
+		result += "{\n";
+		for (size_t i = 0; i < entry->size(); i++) {
+			result += '"';
+			result += entry->Key(i);
+			result += "\" \"";
+			result += entry->Value(i);
+			result += "\"\n";
 		}
-		stream << "}\n";
+		result += "}\n";
 	}
-	return stream.str();
+	return result;
 }
 
 std::weak_ptr<EntityLumpEntry> EntityLumpManager::Get(size_t index) {
@@ -115,17 +269,76 @@ std::weak_ptr<EntityLumpEntry> EntityLumpManager::Get(size_t index) {
 
 void EntityLumpManager::Erase(size_t index) {
 	m_Entities.erase(m_Entities.begin() + index);
+	InvalidateIndex();
 }
 
 void EntityLumpManager::Insert(size_t index) {
-	m_Entities.emplace(m_Entities.begin() + index, std::make_shared<EntityLumpEntry>());
+	m_Entities.emplace(m_Entities.begin() + index, std::make_shared<EntityLumpEntry>(this));
+	InvalidateIndex();
 }
 
 size_t EntityLumpManager::Append() {
-	auto it = m_Entities.emplace(m_Entities.end(), std::make_shared<EntityLumpEntry>());
+	auto it = m_Entities.emplace(m_Entities.end(), std::make_shared<EntityLumpEntry>(this));
+	InvalidateIndex();
 	return std::distance(m_Entities.begin(), it);
 }
 
 size_t EntityLumpManager::Length() {
 	return m_Entities.size();
 }
+
+int EntityLumpManager::FindByClassname(const char* classname, int start) {
+	BuildIndex();
+	return FindIndexed(m_ClassnameIndex, classname, start);
+}
+
+int EntityLumpManager::FindByTargetname(const char* targetname, int start) {
+	BuildIndex();
+	return FindIndexed(m_TargetnameIndex, targetname, start);
+}
+
+void EntityLumpManager::InvalidateIndex() {
+	m_bIndexValid = false;
+}
+
+void EntityLumpManager::BuildIndex() {
+	if (m_bIndexValid) {
+		return;
+	}
+	
+	// keys view into the entries themselves; any write to an entry invalidates the index first
+	m_ClassnameIndex.clear();
+	m_TargetnameIndex.clear();
+	for (size_t i = 0; i < m_Entities.size(); i++) {
+		const auto& entry = m_Entities[i];
+		
+		int key = entry->FindKey("classname", 0);
+		if (key != -1) {
+			m_ClassnameIndex[entry->Value(key)].push_back(i);
+		}
+		
+		key = entry->FindKey("targetname", 0);
+		if (key != -1) {
+			m_TargetnameIndex[entry->Value(key)].push_back(i);
+		}
+	}
+	m_bIndexValid = true;
+}
+
+int EntityLumpManager::FindIndexed(const EntityIndex& index, const char* name, int start) {
+	auto it = index.find(name);
+	if (it == index.end()) {
+		return -1;
+	}
+	
+	// entity indices are pushed in order, so each list is already sorted
+	const auto& entities = it->second;
+	auto result = entities.begin();
+	if (start >= 0) {
+		result = std::upper_bound(entities.begin(), entities.end(), static_cast<size_t>(start));
+	}
+	if (result == entities.end()) {
+		return -1;
+	}
+	return static_cast<int>(*result);
+}
@@ -35,6 +35,8 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 /**
  * Entity lump manager.  Provides a list that stores a list of key / value pairs and the
@@ -46,10 +48,62 @@
  * @brief Class definition for object that parses lumps.
  */
 
+class EntityLumpManager;
+
+/**
+ * @brief A key / value pair that has not been copied out of the parsed lump.  Both views point
+ * into the manager's lump buffer and are null-terminated.
+ */
+using EntityLumpKeyValueView = std::pair<std::string_view, std::string_view>;
+
 /**
- * @brief A container of key / value pairs.
+ * @brief An ordered container of key / value pairs.
+ *
+ * Entries produced by a lazy parse read directly out of the manager's lump buffer; the first
+ * write copies the pairs into owned strings.
  */
-using EntityLumpEntry = std::vector<std::pair<std::string, std::string>>;
+class EntityLumpEntry
+{
+public:
+	EntityLumpEntry(EntityLumpManager* manager);
+	EntityLumpEntry(EntityLumpManager* manager, const EntityLumpKeyValueView* views, size_t count);
+
+	size_t size() const;
+
+	/**
+	 * @brief Returns the key / value at the given index.  The returned strings are
+	 * null-terminated and remain valid until the entry is next written to.
+	 */
+	const char* Key(size_t index) const;
+	const char* Value(size_t index) const;
+
+	/**
+	 * @brief Returns the index of the first key after start that matches, or -1.
+	 */
+	int FindKey(const char* key, size_t start) const;
+
+	/**
+	 * @brief Replaces the key and / or value at the given index.  Null arguments are left as-is.
+	 */
+	void Update(size_t index, const char* key, const char* value);
+	void Insert(size_t index, const char* key, const char* value);
+	void Erase(size_t index);
+	void Append(const char* key, const char* value);
+
+	/**
+	 * @brief Copies any pairs still referencing the lump buffer into owned strings.
+	 */
+	void Materialize();
+
+	bool IsMaterialized() const;
+
+private:
+	EntityLumpManager* m_pManager;
+	const EntityLumpKeyValueView* m_pViews;
+	size_t m_nViews;
+	std::vector<std::pair<std::string, std::string>> m_Owned;
+	bool m_bOwned;
+};
 
 enum EntityLumpParseStatus {
 	Status_OK,
@@ -60,6 +114,11 @@ enum EntityLumpParseStatus {
  * @brief Result of parsing an entity lump.  On a parse error, m_Status is not Status_OK and
  * m_Position indicates the offset within the string that caused the parse error.
  */
+enum EntityLumpParseMode {
+	ParseMode_Owned,	/**< Copy every key / value into its own string while parsing. */
+	ParseMode_Lazy,		/**< Keep the lump buffer and copy entries out only when written. */
+};
+
 struct EntityLumpParseResult {
 	EntityLumpParseStatus m_Status;
 	std::streamoff m_Position;
@@ -74,10 +133,17 @@ struct EntityLumpParseResult {
 class EntityLumpManager
 {
 public:
+	EntityLumpManager();
+
 	/**
 	 * @brief Parses the map entities string into an internal representation.
 	 */
 	EntityLumpParseResult Parse(const char* pMapEntities);
+
+	/**
+	 * @brief Sets how the next call to Parse stores key / value pairs.
+	 */
+	void SetParseMode(EntityLumpParseMode mode);
 	
 	/**
 	 * @brief Dumps the current internal representation out to an std::string.
@@ -109,8 +175,36 @@ public:
 	 */
 	size_t Length();
 
+	/**
+	 * @brief Returns the index of the next entity after start whose "classname" (or
+	 * "targetname") value matches exactly, or -1 if there is none.  Pass -1 as start to search
+	 * from the beginning.
+	 */
+	int FindByClassname(const char* classname, int start);
+	int FindByTargetname(const char* targetname, int start);
+
+	/**
+	 * @brief Drops the classname / targetname indices; they are rebuilt on the next lookup.
+	 */
+	void InvalidateIndex();
+
+private:
+	using EntityIndex = std::unordered_map<std::string_view, std::vector<size_t>>;
+
+	void BuildIndex();
+	int FindIndexed(const EntityIndex& index, const char* name, int start);
+
 private:
 	std::vector<std::shared_ptr<EntityLumpEntry>> m_Entities;
+	EntityLumpParseMode m_ParseMode;
+
+	// Lazily parsed entries point into these; neither is touched again until the next Parse.
+	std::string m_Buffer;
+	std::vector<EntityLumpKeyValueView> m_KeyValues;
+
+	EntityIndex m_ClassnameIndex;
+	EntityIndex m_TargetnameIndex;
+	bool m_bIndexValid;
 };
 
 #endif // _INCLUDE_LUMPMANAGER_H_
@@ -0,0 +1,141 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_SOURCEMOD_MAPPED_FILE_H_
+#define _INCLUDE_SOURCEMOD_MAPPED_FILE_H_
+
+#include <limits.h>
+#include <stddef.h>
+#include <sm_platform.h>
+#if defined PLATFORM_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * A whole file mapped into memory.
+ *
+ * Read-only mappings share the page cache with every other reader.  
+ * Copy-on-write mappings may be modified in place; those writes never reach 
+ * the file on disk.  Empty files open successfully with a NULL base.
+ */
+class MappedFile
+{
+public:
+	MappedFile() : base(NULL), length(0), slack(0)
+#if defined PLATFORM_WINDOWS
+		, hFile(INVALID_HANDLE_VALUE), hMap(NULL)
+#endif
+	{
+	}
+	~MappedFile()
+	{
+#if defined PLATFORM_WINDOWS
+		if (base)
+			UnmapViewOfFile(base);
+		if (hMap)
+			CloseHandle(hMap);
+		if (hFile != INVALID_HANDLE_VALUE)
+			CloseHandle(hFile);
+#else
+		if (base)
+			munmap(base, length);
+#endif
+	}
+	bool Open(const char *file, bool copyOnWrite)
+	{
+#if defined PLATFORM_WINDOWS
+		hFile = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (hFile == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(hFile, &size) || size.QuadPart > UINT_MAX / 2)
+			return false;
+		if (size.QuadPart == 0)
+			return true;
+
+		hMap = CreateFileMappingA(hFile, NULL, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+		if (!hMap)
+			return false;
+
+		base = (char *)MapViewOfFile(hMap, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+		if (!base)
+			return false;
+
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		size_t page = info.dwPageSize;
+		length = (size_t)size.QuadPart;
+#else
+		int fd = open(file, O_RDONLY);
+		if (fd == -1)
+			return false;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size > UINT_MAX / 2)
+		{
+			close(fd);
+			return false;
+		}
+		if (st.st_size == 0)
+		{
+			close(fd);
+			return true;
+		}
+
+		void *addr = mmap(NULL, st.st_size, copyOnWrite ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (addr == MAP_FAILED)
+			return false;
+
+		size_t page = (size_t)sysconf(_SC_PAGESIZE);
+		base = (char *)addr;
+		length = (size_t)st.st_size;
+#endif
+		/* The rest of the last page is zero-filled and part of the mapping. */
+		slack = (length % page) ? page - (length % page) : 0;
+		return true;
+	}
+public:
+	char *base;
+	size_t length;
+	size_t slack;		/**< Addressable bytes past the end of the file */
+#if defined PLATFORM_WINDOWS
+private:
+	HANDLE hFile;
+	HANDLE hMap;
+#endif
+};
+
+#endif //_INCLUDE_SOURCEMOD_MAPPED_FILE_H_
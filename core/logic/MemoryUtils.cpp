@@ -28,10 +28,19 @@
  */
 
 #include "MemoryUtils.h"
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PATTERN_SCAN_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
 #ifdef PLATFORM_LINUX
 #include <fcntl.h>
 #include <link.h>
 #include <sys/mman.h>
+#include <unistd.h>
 
 #define PAGE_SIZE			4096
 #define PAGE_ALIGN_UP(x)	((x + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1))
@@ -43,6 +52,8 @@
 #include <mach-o/dyld_images.h>
 #include <mach-o/loader.h>
 #include <mach-o/nlist.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #endif // PLATFORM_APPLE
 
 MemoryUtils g_MemUtils;
@@ -76,43 +87,178 @@ void MemoryUtils::OnSourceModAllInitialized()
 	sharesys->AddInterface(NULL, this);
 }
 
+static inline bool PatternMatches(const char *ptr, const char *pattern, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+	{
+		if (pattern[i] != '\x2A' && pattern[i] != ptr[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+#ifdef PATTERN_SCAN_SSE2
+static inline unsigned int LowestBit(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long bit;
+	_BitScanForward(&bit, mask);
+	return bit;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+#endif
+
 void *MemoryUtils::FindPattern(const void *libPtr, const char *pattern, size_t len)
 {
 	const DynLibInfo* lib = nullptr;
 
-	if ((lib = GetLibraryInfo(libPtr)) == nullptr)
+	if ((lib = GetLibraryInfo(libPtr)) == nullptr || len > lib->memorySize)
 	{
 		return NULL;
 	}
 
 	// Search in the original unaltered state of the binary.
-	char *start = lib->originalCopy.get();
-	char *ptr = start;
-	char *end = ptr + lib->memorySize - len;
+	const char *start = lib->originalCopy.get();
+	size_t last = lib->memorySize - len;
+	size_t pos = 0;
 
-	bool found;
-	while (ptr < end)
+	// Anchor on the first and last bytes that aren't wildcards.
+	size_t first_anchor = 0;
+	while (first_anchor < len && pattern[first_anchor] == '\x2A')
 	{
-		found = true;
-		for (register size_t i = 0; i < len; i++)
+		first_anchor++;
+	}
+
+	if (first_anchor < len)
+	{
+		size_t last_anchor = len - 1;
+		while (pattern[last_anchor] == '\x2A')
 		{
-			if (pattern[i] != '\x2A' && pattern[i] != ptr[i])
+			last_anchor--;
+		}
+
+#ifdef PATTERN_SCAN_SSE2
+		// Test 16 candidate positions at a time against both anchors, and only
+		// run the full comparison where both of them match.
+		const __m128i first = _mm_set1_epi8(pattern[first_anchor]);
+		const __m128i last_byte = _mm_set1_epi8(pattern[last_anchor]);
+		while (pos + 16 <= last)
+		{
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(start + pos + first_anchor));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(start + pos + last_anchor));
+			unsigned int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last_byte)));
+			while (mask)
 			{
-				found = false;
-				break;
+				size_t i = pos + LowestBit(mask);
+				// Translate the found offset into the actual live binary memory space.
+				if (PatternMatches(start + i, pattern, len))
+					return reinterpret_cast<char *>(lib->baseAddress) + i;
+				mask &= mask - 1;
 			}
+			pos += 16;
 		}
+#endif
+	}
 
-		// Translate the found offset into the actual live binary memory space.
-		if (found)
-			return reinterpret_cast<char *>(lib->baseAddress) + (ptr - start);
-
-		ptr++;
+	for (; pos < last; pos++)
+	{
+		if (PatternMatches(start + pos, pattern, len))
+			return reinterpret_cast<char *>(lib->baseAddress) + pos;
 	}
 
 	return NULL;
 }
 
+size_t MemoryUtils::FindPatterns(const void *libPtr, const MemoryPattern *patterns, size_t count, void **results)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		results[i] = NULL;
+	}
+
+	const DynLibInfo* lib = nullptr;
+	if ((lib = GetLibraryInfo(libPtr)) == nullptr)
+	{
+		return 0;
+	}
+
+	const char *start = lib->originalCopy.get();
+	size_t size = lib->memorySize;
+
+	// Bucket every pattern by its first non-wildcard byte, so a single pass
+	// over the image only runs full comparisons for patterns whose anchor
+	// byte is at the current position.
+	struct Candidate
+	{
+		size_t index;
+		size_t anchor;
+	};
+	std::vector<Candidate> buckets[256];
+	size_t remaining = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const MemoryPattern &p = patterns[i];
+		if (p.len == 0 || p.len > size)
+		{
+			continue;
+		}
+
+		size_t anchor = 0;
+		while (anchor < p.len && p.pattern[anchor] == '\x2A')
+		{
+			anchor++;
+		}
+
+		// All wildcards matches the start of the image, same as FindPattern.
+		if (anchor == p.len)
+		{
+			if (size > p.len)
+				results[i] = lib->baseAddress;
+			continue;
+		}
+
+		Candidate c = { i, anchor };
+		buckets[(unsigned char)p.pattern[anchor]].push_back(c);
+		remaining++;
+	}
+
+	for (size_t pos = 0; pos < size && remaining; pos++)
+	{
+		std::vector<Candidate> &bucket = buckets[(unsigned char)start[pos]];
+		for (size_t j = 0; j < bucket.size(); j++)
+		{
+			const Candidate &c = bucket[j];
+			const MemoryPattern &p = patterns[c.index];
+			if (pos < c.anchor || pos - c.anchor >= size - p.len)
+			{
+				continue;
+			}
+
+			size_t match = pos - c.anchor;
+			if (PatternMatches(start + match, p.pattern, p.len))
+			{
+				results[c.index] = reinterpret_cast<char *>(lib->baseAddress) + match;
+				bucket.erase(bucket.begin() + j);
+				j--;
+				remaining--;
+			}
+		}
+	}
+
+	size_t found = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (results[i])
+			found++;
+	}
+	return found;
+}
+
 void *MemoryUtils::ResolveSymbol(void *handle, const char *symbol)
 {
 #ifdef PLATFORM_WINDOWS
@@ -174,16 +320,16 @@ void *MemoryUtils::ResolveSymbol(void *handle, const char *symbol)
 		libtable = new LibSymbolTable();
 		libtable->table.Initialize();
 		libtable->lib_base = dlmap->l_addr;
-		libtable->last_pos = 0;
+		libtable->indexed = false;
 		table = &libtable->table;
 		m_SymTables.push_back(libtable);
 	}
 
-	/* See if the symbol is already cached in our table */
+	/* Once a library is indexed, the table is authoritative */
 	symbol_entry = table->FindSymbol(symbol, strlen(symbol));
-	if (symbol_entry != NULL)
+	if (symbol_entry != NULL || libtable->indexed)
 	{
-		return symbol_entry->address;
+		return symbol_entry ? symbol_entry->address : NULL;
 	}
 
 	/* If symbol isn't in our table, then we have open the actual library */
@@ -243,13 +389,14 @@ void *MemoryUtils::ResolveSymbol(void *handle, const char *symbol)
 	strtab = (const char *)(map_base + strtab_hdr->sh_offset);
 	symbol_count = symtab_hdr->sh_size / symtab_hdr->sh_entsize;
 
-	/* Iterate symbol table starting from the position we were at last time */
-	for (uint32_t i = libtable->last_pos; i < symbol_count; i++)
+	/* Intern the whole symbol table in one pass, so the library file only has 
+	 * to be mapped once no matter how many symbols gamedata asks for.
+	 */
+	for (uint32_t i = 0; i < symbol_count; i++)
 	{
 		ElfSymbol &sym = symtab[i];
 		unsigned char sym_type = ELF_SYM_TYPE(sym.st_info);
 		const char *sym_name = strtab + sym.st_name;
-		Symbol *cur_sym;
 
 		/* Skip symbols that are undefined or do not refer to functions or objects */
 		if (sym.st_shndx == SHN_UNDEF || (sym_type != STT_FUNC && sym_type != STT_OBJECT))
@@ -257,17 +404,13 @@ void *MemoryUtils::ResolveSymbol(void *handle, const char *symbol)
 			continue;
 		}
 
-		/* Caching symbols as we go along */
-		cur_sym = table->InternSymbol(sym_name, strlen(sym_name), (void *)(dlmap->l_addr + sym.st_value));
-		if (strcmp(symbol, sym_name) == 0)
-		{
-			symbol_entry = cur_sym;
-			libtable->last_pos = ++i;
-			break;
-		}
+		table->InternSymbol(sym_name, strlen(sym_name), (void *)(dlmap->l_addr + sym.st_value));
 	}
+	libtable->indexed = true;
 
 	munmap(file_hdr, dlstat.st_size);
+
+	symbol_entry = table->FindSymbol(symbol, strlen(symbol));
 	return symbol_entry ? symbol_entry->address : NULL;
 
 #elif defined PLATFORM_APPLE
@@ -352,16 +495,16 @@ void *MemoryUtils::ResolveSymbol(void *handle, const char *symbol)
 		libtable = new LibSymbolTable();
 		libtable->table.Initialize();
 		libtable->lib_base = dlbase;
-		libtable->last_pos = 0;
+		libtable->indexed = false;
 		table = &libtable->table;
 		m_SymTables.push_back(libtable);
 	}
 	
-	/* See if the symbol is already cached in our table */
+	/* Once a library is indexed, the table is authoritative */
 	symbol_entry = table->FindSymbol(symbol, strlen(symbol));
-	if (symbol_entry != NULL)
+	if (symbol_entry != NULL || libtable->indexed)
 	{
-		return symbol_entry->address;
+		return symbol_entry ? symbol_entry->address : NULL;
 	}
 	
 	/* If symbol isn't in our table, then we have to locate it in memory */
@@ -409,13 +552,12 @@ void *MemoryUtils::ResolveSymbol(void *handle, const char *symbol)
 	strtab = (const char *)(linkedit_addr + symtab_hdr->stroff - linkedit_hdr->fileoff);
 	symbol_count = symtab_hdr->nsyms;
 	
-	/* Iterate symbol table starting from the position we were at last time */
-	for (uint32_t i = libtable->last_pos; i < symbol_count; i++)
+	/* Intern the whole symbol table in one pass */
+	for (uint32_t i = 0; i < symbol_count; i++)
 	{
 		MachSymbol &sym = symtab[i];
 		/* Ignore the prepended underscore on all symbols, so +1 here */
 		const char *sym_name = strtab + sym.n_un.n_strx + 1;
-		Symbol *cur_sym;
 		
 		/* Skip symbols that are undefined */
 		if (sym.n_sect == NO_SECT)
@@ -423,16 +565,11 @@ void *MemoryUtils::ResolveSymbol(void *handle, const char *symbol)
 			continue;
 		}
 		
-		/* Caching symbols as we go along */
-		cur_sym = table->InternSymbol(sym_name, strlen(sym_name), (void *)(dlbase + sym.n_value));
-		if (strcmp(symbol, sym_name) == 0)
-		{
-			symbol_entry = cur_sym;
-			libtable->last_pos = ++i;
-			break;
-		}
+		table->InternSymbol(sym_name, strlen(sym_name), (void *)(dlbase + sym.n_value));
 	}
+	libtable->indexed = true;
 	
+	symbol_entry = table->FindSymbol(symbol, strlen(symbol));
 	return symbol_entry ? symbol_entry->address : NULL;
 
 #endif
@@ -671,3 +808,58 @@ const DynLibInfo *MemoryUtils::GetLibraryInfo(const void *libPtr)
 
 	return &i->value;
 }
+
+bool MemoryUtils::IsRangeAccessible(const void *addr, size_t len)
+{
+	uintptr_t start = reinterpret_cast<uintptr_t>(addr);
+	uintptr_t end = start + len;
+
+	if (addr == NULL || len == 0 || end < start)
+	{
+		return false;
+	}
+
+	/* Fast path: the whole range sits inside a loaded binary's image */
+	const DynLibInfo *lib = GetLibraryInfo(addr);
+	if (lib)
+	{
+		uintptr_t libBase = reinterpret_cast<uintptr_t>(lib->baseAddress);
+		if (start >= libBase && end <= libBase + lib->memorySize)
+		{
+			return true;
+		}
+	}
+
+#ifdef PLATFORM_WINDOWS
+	/* Walk every region the range touches, each must be committed and readable */
+	MEMORY_BASIC_INFORMATION info;
+	uintptr_t cur = start;
+	while (cur < end)
+	{
+		if (!VirtualQuery(reinterpret_cast<LPCVOID>(cur), &info, sizeof(info)))
+		{
+			return false;
+		}
+
+		if (info.State != MEM_COMMIT || (info.Protect & (PAGE_NOACCESS|PAGE_GUARD)) != 0)
+		{
+			return false;
+		}
+
+		cur = reinterpret_cast<uintptr_t>(info.BaseAddress) + info.RegionSize;
+	}
+	return true;
+#else
+	/* mincore() fails with ENOMEM if any page in the range is unmapped */
+	uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+	uintptr_t first = start & ~(pageSize - 1);
+	size_t span = end - first;
+
+#ifdef PLATFORM_APPLE
+	std::vector<char> residency((span + pageSize - 1) / pageSize);
+#else
+	std::vector<unsigned char> residency((span + pageSize - 1) / pageSize);
+#endif
+	return mincore(reinterpret_cast<void *>(first), span, residency.data()) == 0;
+#endif
+}
@@ -47,6 +47,15 @@ using namespace SourceMod;
 #include <CoreServices/CoreServices.h>
 #endif
 
+/**
+ * @brief A byte pattern for MemoryUtils::FindPatterns. 0x2A bytes are wildcards.
+ */
+struct MemoryPattern
+{
+	const char *pattern;
+	size_t len;
+};
+
 struct DynLibInfo
 {
 	void *baseAddress;
@@ -59,7 +68,7 @@ struct LibSymbolTable
 {
 	SymbolTable table;
 	uintptr_t lib_base;
-	uint32_t last_pos;
+	bool indexed;		/* Every symbol of the library has been interned */
 };
 #endif
 
@@ -77,6 +86,8 @@ public: // IMemoryUtils
 	void *ResolveSymbol(void *handle, const char *symbol);
 public:
 	const DynLibInfo *GetLibraryInfo(const void *libPtr);
+	bool IsRangeAccessible(const void *addr, size_t len);
+	size_t FindPatterns(const void *libPtr, const MemoryPattern *patterns, size_t count, void **results);
 #if defined PLATFORM_LINUX || defined PLATFORM_APPLE
 private:
 	CVector<LibSymbolTable *> m_SymTables;
@@ -0,0 +1,290 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#include "MetricsExporter.h"
+#include "Database.h"
+#include "HandleSys.h"
+#include "Logger.h"
+#include "PluginTimeTracker.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <vector>
+#include <ISourceMod.h>
+#include <bridge/include/CoreProvider.h>
+
+MetricsExporter g_MetricsExporter;
+
+int64_t
+MetricsExporter::Now()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+MetricsExporter::MetricsExporter()
+ : last_frame_(0),
+   frames_(0),
+   window_start_(0),
+   forward_depth_(0),
+   forward_start_(0),
+   forward_ns_(0),
+   forward_calls_(0),
+   path_("data/metrics.prom"),
+   interval_(0),
+   timer_(nullptr),
+   initialized_(false)
+{
+}
+
+void
+MetricsExporter::OnSourceModAllInitialized()
+{
+	initialized_ = true;
+	UpdateTimer();
+}
+
+void
+MetricsExporter::OnSourceModShutdown()
+{
+	if (timer_)
+		timersys->KillTimer(timer_);
+	initialized_ = false;
+}
+
+ConfigResult
+MetricsExporter::OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source,
+                                          char *error, size_t maxlength)
+{
+	if (strcmp(key, "MetricsExportFile") == 0) {
+		if (!value[0]) {
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be a file path");
+			return ConfigResult_Reject;
+		}
+		path_ = value;
+		return ConfigResult_Accept;
+	}
+
+	if (strcmp(key, "MetricsExportInterval") != 0)
+		return ConfigResult_Ignore;
+
+	char *end;
+	unsigned long interval = strtoul(value, &end, 10);
+	if (!value[0] || *end != '\0') {
+		ke::SafeStrcpy(error, maxlength, "Invalid value: must be a number of seconds");
+		return ConfigResult_Reject;
+	}
+	interval_ = (unsigned int)interval;
+	UpdateTimer();
+	return ConfigResult_Accept;
+}
+
+void
+MetricsExporter::UpdateTimer()
+{
+	if (!initialized_)
+		return;
+	if (timer_)
+		timersys->KillTimer(timer_);
+
+	g_PluginTimeTracker.SetCollectTotals(interval_ > 0);
+	last_busy_.clear();
+	frame_times_.Reset();
+	last_frame_ = 0;
+	window_start_ = Now();
+	if (interval_)
+		timer_ = timersys->CreateTimer(this, float(interval_), nullptr, TIMER_FLAG_REPEAT);
+}
+
+void
+MetricsExporter::OnFrame()
+{
+	if (!interval_)
+		return;
+
+	int64_t now = Now();
+	if (last_frame_)
+		frame_times_.Record(uint64_t(now - last_frame_));
+	last_frame_ = now;
+	frames_++;
+}
+
+ResultType
+MetricsExporter::OnTimer(ITimer *pTimer, void *pData)
+{
+	Export();
+	return Pl_Continue;
+}
+
+void
+MetricsExporter::OnTimerEnd(ITimer *pTimer, void *pData)
+{
+	timer_ = nullptr;
+}
+
+static void
+WriteLabelValue(FILE *fp, const char *str)
+{
+	for (; *str; str++) {
+		if (*str == '\n') {
+			fputs("\\n", fp);
+			continue;
+		}
+		if (*str == '"' || *str == '\\')
+			fputc('\\', fp);
+		fputc(*str, fp);
+	}
+}
+
+static void
+WriteHeader(FILE *fp, const char *name, const char *type, const char *help)
+{
+	fprintf(fp, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+void
+MetricsExporter::Export()
+{
+	int64_t now = Now();
+	int64_t window_ns = std::max<int64_t>(now - window_start_, 1);
+	window_start_ = now;
+
+	char path[PLATFORM_MAX_PATH];
+	char temp[PLATFORM_MAX_PATH];
+	g_pSM->BuildPath(Path_SM, path, sizeof(path), "%s", path_.c_str());
+	ke::SafeSprintf(temp, sizeof(temp), "%s.tmp", path);
+
+	FILE *fp = fopen(temp, "w");
+	if (!fp)
+		return;
+
+	WriteHeader(fp, "sourcemod_frame_time_seconds", "summary",
+	            "Time between server frames over the last export interval.");
+	static const double kQuantiles[] = {0.5, 0.9, 0.99};
+	for (double q : kQuantiles) {
+		fprintf(fp, "sourcemod_frame_time_seconds{quantile=\"%g\"} %.9f\n", q,
+		        frame_times_.Percentile(q) / 1e9);
+	}
+	fprintf(fp, "sourcemod_frame_time_seconds_sum %.9f\n", frame_times_.Total() / 1e9);
+	fprintf(fp, "sourcemod_frame_time_seconds_count %llu\n", (unsigned long long)frame_times_.Count());
+	WriteHeader(fp, "sourcemod_frame_time_max_seconds", "gauge",
+	            "Longest frame over the last export interval.");
+	fprintf(fp, "sourcemod_frame_time_max_seconds %.9f\n", frame_times_.Max() / 1e9);
+	WriteHeader(fp, "sourcemod_frames_total", "counter", "Server frames seen.");
+	fprintf(fp, "sourcemod_frames_total %llu\n", (unsigned long long)frames_);
+	frame_times_.Reset();
+
+	WriteHeader(fp, "sourcemod_timers", "gauge", "Timers currently scheduled.");
+	fprintf(fp, "sourcemod_timers %llu\n", (unsigned long long)bridge->GetTimerCount());
+
+	WriteHeader(fp, "sourcemod_forward_dispatch_seconds_total", "counter",
+	            "Time spent dispatching forwards to plugins.");
+	fprintf(fp, "sourcemod_forward_dispatch_seconds_total %.9f\n", forward_ns_ / 1e9);
+	WriteHeader(fp, "sourcemod_forward_dispatch_total", "counter", "Forward dispatches.");
+	fprintf(fp, "sourcemod_forward_dispatch_total %llu\n", (unsigned long long)forward_calls_);
+
+	size_t db_workers, db_think;
+	g_DBMan.GetQueueDepths(&db_workers, &db_think);
+	DBWorkerCounters &db = g_DBMan.GetWorkerCounters();
+	WriteHeader(fp, "sourcemod_db_queue_depth", "gauge",
+	            "Database operations waiting for a worker thread, or for the main thread.");
+	fprintf(fp, "sourcemod_db_queue_depth{queue=\"worker\"} %llu\n", (unsigned long long)db_workers);
+	fprintf(fp, "sourcemod_db_queue_depth{queue=\"think\"} %llu\n", (unsigned long long)db_think);
+	WriteHeader(fp, "sourcemod_db_operations_total", "counter",
+	            "Database operations run on worker threads.");
+	fprintf(fp, "sourcemod_db_operations_total %llu\n",
+	        (unsigned long long)db.executed.load(std::memory_order_relaxed));
+	WriteHeader(fp, "sourcemod_db_operation_seconds_total", "counter",
+	            "Time worker threads spent running database operations.");
+	fprintf(fp, "sourcemod_db_operation_seconds_total %.6f\n",
+	        db.totalTime.load(std::memory_order_relaxed) / 1e6);
+	WriteHeader(fp, "sourcemod_db_operation_max_seconds", "gauge",
+	            "Slowest database operation over the last export interval.");
+	fprintf(fp, "sourcemod_db_operation_max_seconds %.6f\n",
+	        db.peakTime.exchange(0, std::memory_order_relaxed) / 1e6);
+
+	std::map<std::string, unsigned int> handles;
+	g_HandleSys.CountHandlesByType(handles);
+	WriteHeader(fp, "sourcemod_handles", "gauge", "Live Handles by type.");
+	for (const auto &entry : handles) {
+		fputs("sourcemod_handles{type=\"", fp);
+		WriteLabelValue(fp, entry.first.c_str());
+		fprintf(fp, "\"} %u\n", entry.second);
+	}
+
+	WriteHeader(fp, "sourcemod_log_queue_depth", "gauge",
+	            "Log lines waiting for the asynchronous log writer.");
+	fprintf(fp, "sourcemod_log_queue_depth %llu\n", (unsigned long long)g_Logger.GetQueueDepth());
+
+	std::vector<std::pair<const char *, PluginTimeTracker::Usage>> rows;
+	g_PluginTimeTracker.GetTotals(rows);
+	WriteHeader(fp, "sourcemod_owner_cpu_seconds_total", "counter",
+	            "Server time spent in each plugin or extension, excluding time in others it called.");
+	for (const auto &row : rows) {
+		fputs("sourcemod_owner_cpu_seconds_total{owner=\"", fp);
+		WriteLabelValue(fp, row.first);
+		fprintf(fp, "\"} %.9f\n", row.second.busy_ns / 1e9);
+	}
+	WriteHeader(fp, "sourcemod_owner_calls_total", "counter",
+	            "Calls from core into each plugin or extension.");
+	for (const auto &row : rows) {
+		fputs("sourcemod_owner_calls_total{owner=\"", fp);
+		WriteLabelValue(fp, row.first);
+		fprintf(fp, "\"} %llu\n", (unsigned long long)row.second.calls);
+	}
+	WriteHeader(fp, "sourcemod_owner_cpu_share", "gauge",
+	            "Fraction of wall-clock time spent in each plugin or extension over the last export interval.");
+	std::unordered_map<std::string, int64_t> busy;
+	for (const auto &row : rows) {
+		int64_t delta = row.second.busy_ns;
+		auto iter = last_busy_.find(row.first);
+		if (iter != last_busy_.end() && iter->second <= delta)
+			delta -= iter->second;
+		busy[row.first] = row.second.busy_ns;
+
+		fputs("sourcemod_owner_cpu_share{owner=\"", fp);
+		WriteLabelValue(fp, row.first);
+		fprintf(fp, "\"} %.6f\n", double(delta) / window_ns);
+	}
+	last_busy_ = std::move(busy);
+
+	fclose(fp);
+
+#if defined PLATFORM_WINDOWS
+	// rename() does not replace an existing file on Windows.
+	remove(path);
+#endif
+	rename(temp, path);
+}
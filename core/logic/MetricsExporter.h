@@ -0,0 +1,136 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#ifndef _include_sourcemod_logic_plugin_time_tracker_h_
+#ifndef _include_sourcemod_logic_metrics_exporter_h_
+#define _include_sourcemod_logic_metrics_exporter_h_
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <ITimerSystem.h>
+#include "common_logic.h"
+#include "LatencyHistogram.h"
+
+using namespace SourceMod;
+
+// Periodically writes core runtime counters to a file in the Prometheus text
+// format, so node_exporter's textfile collector (or anything that can read a
+// file) can scrape them. The file is written beside the target and renamed
+// over it, so readers never see half a dump.
+//
+// Counters are gathered from the systems that already keep them; the only
+// ones added for this are the frame-time histogram and forward dispatch time
+// kept here, and the DB worker counters in DBManager. Nothing is timed while
+// MetricsExportInterval is 0.
+class MetricsExporter
+	: public SMGlobalClass,
+	  public ITimedEvent
+{
+public:
+	MetricsExporter();
+
+	bool IsActive() const {
+		return interval_ > 0;
+	}
+
+	// Called once per server frame.
+	void OnFrame();
+
+	// Main thread only. Only the outermost forward call is timed, so nested
+	// forwards are not counted twice.
+	void BeginForward() {
+		if (forward_depth_++ == 0)
+			forward_start_ = Now();
+	}
+	void EndForward() {
+		if (--forward_depth_ == 0) {
+			forward_ns_ += Now() - forward_start_;
+			forward_calls_++;
+		}
+	}
+
+	// SMGlobalClass
+	ConfigResult OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source,
+	                                      char *error, size_t maxlength) override;
+	void OnSourceModAllInitialized() override;
+	void OnSourceModShutdown() override;
+
+	// ITimedEvent
+	ResultType OnTimer(ITimer *pTimer, void *pData) override;
+	void OnTimerEnd(ITimer *pTimer, void *pData) override;
+
+	static int64_t Now();
+
+private:
+	void Export();
+	void UpdateTimer();
+
+private:
+	LatencyHistogram frame_times_;
+	int64_t last_frame_;
+	uint64_t frames_;
+	int64_t window_start_;
+	unsigned int forward_depth_;
+	int64_t forward_start_;
+	int64_t forward_ns_;
+	uint64_t forward_calls_;
+	// Owner busy time at the previous export, for per-interval CPU share.
+	std::unordered_map<std::string, int64_t> last_busy_;
+	std::string path_;
+	unsigned int interval_;
+	ITimer *timer_;
+	bool initialized_;
+};
+
+extern MetricsExporter g_MetricsExporter;
+
+// Times a forward dispatch for the exporter, if it is running.
+class ForwardMetricsScope
+{
+public:
+	ForwardMetricsScope()
+	 : active_(g_MetricsExporter.IsActive())
+	{
+		if (active_)
+			g_MetricsExporter.BeginForward();
+	}
+	~ForwardMetricsScope() {
+		if (active_)
+			g_MetricsExporter.EndForward();
+	}
+
+private:
+	bool active_;
+};
+
+#endif // _include_sourcemod_logic_metrics_exporter_h_
@@ -70,16 +70,30 @@ struct Native : public ke::Refcounted<Native>
 		  fake(std::move(fake))
 	{
 	}
+	Native(CNativeOwner *owner, const char *name, const ke::RefPtr<INativeCallback> &stub)
+		: owner(owner),
+		  native(nullptr),
+		  fake(nullptr),
+		  stub_name(name),
+		  stub(stub)
+	{
+	}
 
 	CNativeOwner *owner;
 	const sp_nativeinfo_t *native;
 	std::unique_ptr<FakeNative> fake;
 
+	// Placeholder for a native of an extension that has not been loaded yet.
+	std::string stub_name;
+	ke::RefPtr<INativeCallback> stub;
+
 	const char *name() const
 	{
 		if (native)
 			return native->name;
-		return fake->name.c_str();
+		if (fake)
+			return fake->name.c_str();
+		return stub_name.c_str();
 	}
 
 	static inline bool matches(const char *name, const ke::RefPtr<Native> &entry)
@@ -65,6 +65,20 @@ void CNativeOwner::AddNatives(const sp_nativeinfo_t *natives)
 	m_natives.push_back(natives);
 }
 
+void CNativeOwner::AddStubNative(const char *name, const ke::RefPtr<INativeCallback> &stub)
+{
+	ke::RefPtr<Native> entry = g_ShareSys.AddStubToCache(this, name, stub);
+	if (entry)
+		m_stubs.push_back(entry);
+}
+
+void CNativeOwner::DropStubNatives()
+{
+	for (size_t i = 0; i < m_stubs.size(); i++)
+		g_ShareSys.ClearNativeFromCache(this, m_stubs[i]->name());
+	m_stubs.clear();
+}
+
 void CNativeOwner::UnbindWeakRef(const WeakNative &ref)
 {
 	IPluginContext *pContext;
@@ -100,6 +114,8 @@ void CNativeOwner::DropEverything()
 	for (size_t i = 0; i < m_fakes.size(); i++)
 		g_ShareSys.ClearNativeFromCache(this, m_fakes[i]->name());
 	m_fakes.clear();
+
+	DropStubNatives();
 }
 
 void CNativeOwner::DropWeakRefsTo(CPlugin *pPlugin)
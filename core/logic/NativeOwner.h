@@ -65,6 +65,8 @@ public:
 	virtual void DropEverything();
 public:
 	void AddNatives(const sp_nativeinfo_t *info);
+	void AddStubNative(const char *name, const ke::RefPtr<INativeCallback> &stub);
+	void DropStubNatives();
 public:
 	void SetMarkSerial(unsigned int serial);
 	unsigned int GetMarkSerial();
@@ -81,6 +83,7 @@ protected:
 	List<WeakNative> m_WeakRefs;
 	std::vector<const sp_nativeinfo_t *> m_natives;
 	std::vector<ke::RefPtr<Native> > m_fakes;
+	std::vector<ke::RefPtr<Native> > m_stubs;
 };
 
 extern CNativeOwner g_CoreNatives;
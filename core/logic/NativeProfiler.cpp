@@ -0,0 +1,275 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "NativeProfiler.h"
+#include "ShareSys.h"
+#include "PluginSys.h"
+#include "common_logic.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <ISourceMod.h>
+
+NativeProfiler g_NativeProfiler;
+
+static inline int64_t
+Now()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+class ProfiledNative final : public INativeCallback
+{
+public:
+	ProfiledNative(const ke::RefPtr<Native> &entry, NativeProfiler::Stats *stats)
+		: entry_(entry),
+		  func_(entry->native ? entry->native->func : nullptr),
+		  stats_(stats)
+	{
+		if (entry->fake)
+			inner_ = entry->fake->wrapper;
+		else if (entry->stub)
+			inner_ = entry->stub;
+	}
+
+	void AddRef() override {
+		refcount_++;
+	}
+	void Release() override {
+		assert(refcount_ > 0);
+		if (--refcount_ == 0)
+			delete this;
+	}
+	int Invoke(IPluginContext *ctx, const cell_t *params) override {
+		int64_t start = Now();
+		int rval = func_ ? func_(ctx, params) : inner_->Invoke(ctx, params);
+		uint64_t elapsed = uint64_t(std::max(Now() - start, int64_t(0)));
+
+		stats_->calls++;
+		stats_->total_ns += elapsed;
+		if (elapsed > stats_->max_ns)
+			stats_->max_ns = elapsed;
+		return rval;
+	}
+
+private:
+	size_t refcount_ = 0;
+	ke::RefPtr<Native> entry_;
+	SPVM_NATIVE_FUNC func_;
+	ke::RefPtr<INativeCallback> inner_;
+	NativeProfiler::Stats *stats_;
+};
+
+NativeProfiler::NativeProfiler()
+	: enabled_(false),
+	  started_at_(0),
+	  elapsed_(0)
+{
+}
+
+ke::RefPtr<INativeCallback>
+NativeProfiler::Wrap(CPlugin *plugin, const ke::RefPtr<Native> &entry)
+{
+	// Stats are keyed by name rather than by pointer, so a reloaded plugin
+	// keeps accumulating into the same rows.
+	std::string key = plugin->GetFilename();
+	key.push_back('\0');
+	key.append(entry->name());
+
+	std::unique_ptr<Stats> &stats = stats_[key];
+	if (!stats) {
+		stats.reset(new Stats());
+		stats->plugin = plugin->GetFilename();
+		stats->native = entry->name();
+	}
+
+	return new ProfiledNative(entry, stats.get());
+}
+
+void
+NativeProfiler::Start()
+{
+	Reset();
+	enabled_ = true;
+	started_at_ = Now();
+	g_ShareSys.RebindNatives();
+}
+
+void
+NativeProfiler::Stop()
+{
+	if (!enabled_)
+		return;
+	enabled_ = false;
+	elapsed_ += Now() - started_at_;
+	g_ShareSys.RebindNatives();
+}
+
+void
+NativeProfiler::Reset()
+{
+	// Bound wrappers point at these entries, so clear them in place.
+	for (auto &entry : stats_) {
+		entry.second->calls = 0;
+		entry.second->total_ns = 0;
+		entry.second->max_ns = 0;
+	}
+	elapsed_ = 0;
+	started_at_ = Now();
+}
+
+void
+NativeProfiler::Dump(const char *sort, const char *file)
+{
+	std::vector<const Stats *> list;
+	for (const auto &entry : stats_) {
+		if (entry.second->calls)
+			list.push_back(entry.second.get());
+	}
+
+	if (list.empty()) {
+		rootmenu->ConsolePrint("No native calls have been recorded.");
+		return;
+	}
+
+	if (strcmp(sort, "calls") == 0) {
+		std::sort(list.begin(), list.end(), [](const Stats *a, const Stats *b) {
+			return a->calls > b->calls;
+		});
+	} else if (strcmp(sort, "avg") == 0) {
+		std::sort(list.begin(), list.end(), [](const Stats *a, const Stats *b) {
+			return double(a->total_ns) / double(a->calls) > double(b->total_ns) / double(b->calls);
+		});
+	} else if (strcmp(sort, "max") == 0) {
+		std::sort(list.begin(), list.end(), [](const Stats *a, const Stats *b) {
+			return a->max_ns > b->max_ns;
+		});
+	} else {
+		std::sort(list.begin(), list.end(), [](const Stats *a, const Stats *b) {
+			return a->total_ns > b->total_ns;
+		});
+	}
+
+	int64_t elapsed = elapsed_ + (enabled_ ? Now() - started_at_ : 0);
+
+	if (file) {
+		char path[PLATFORM_MAX_PATH];
+		g_pSM->BuildPath(Path_Game, path, sizeof(path), "%s", file);
+
+		FILE *fp = fopen(path, "wt");
+		if (!fp) {
+			rootmenu->ConsolePrint("Failed to open \"%s\" for writing.", path);
+			return;
+		}
+
+		fprintf(fp, "# Native timings over %.1fs\n", double(elapsed) / 1e9);
+		fprintf(fp, "plugin\tnative\tcalls\ttotal_us\tavg_us\tmax_us\n");
+		for (const Stats *stats : list) {
+			fprintf(fp, "%s\t%s\t%llu\t%.1f\t%.3f\t%.1f\n",
+				stats->plugin.c_str(),
+				stats->native.c_str(),
+				(unsigned long long)stats->calls,
+				double(stats->total_ns) / 1e3,
+				double(stats->total_ns) / double(stats->calls) / 1e3,
+				double(stats->max_ns) / 1e3);
+		}
+		fclose(fp);
+
+		rootmenu->ConsolePrint("Wrote %u native timing rows to \"%s\".", unsigned(list.size()), path);
+		return;
+	}
+
+	rootmenu->ConsolePrint("Native timings over %.1fs (%s):",
+		double(elapsed) / 1e9, enabled_ ? "running" : "stopped");
+	rootmenu->ConsolePrint("  %10s %10s %9s %9s  %s",
+		"calls", "total ms", "avg us", "max us", "native");
+
+	size_t count = std::min(list.size(), size_t(25));
+	for (size_t i = 0; i < count; i++) {
+		const Stats *stats = list[i];
+		rootmenu->ConsolePrint("  %10llu %10.2f %9.2f %9.1f  %s (%s)",
+			(unsigned long long)stats->calls,
+			double(stats->total_ns) / 1e6,
+			double(stats->total_ns) / double(stats->calls) / 1e3,
+			double(stats->max_ns) / 1e3,
+			stats->native.c_str(),
+			stats->plugin.c_str());
+	}
+	if (count < list.size())
+		rootmenu->ConsolePrint("  ... %u more row(s); dump to a file to see everything.", unsigned(list.size() - count));
+}
+
+void
+NativeProfiler::OnRootConsoleCommand(const ICommandArgs *args)
+{
+	const char *cmd = args->ArgC() >= 4 ? args->Arg(3) : "";
+
+	if (strcmp(cmd, "start") == 0) {
+		if (enabled_) {
+			rootmenu->ConsolePrint("Native profiling is already active.");
+			return;
+		}
+		Start();
+		rootmenu->ConsolePrint("Started native profiling.");
+		return;
+	}
+	if (strcmp(cmd, "stop") == 0) {
+		if (!enabled_) {
+			rootmenu->ConsolePrint("Native profiling is not active.");
+			return;
+		}
+		Stop();
+		Dump("time", nullptr);
+		return;
+	}
+	if (strcmp(cmd, "dump") == 0) {
+		const char *sort = args->ArgC() >= 5 ? args->Arg(4) : "time";
+		const char *file = args->ArgC() >= 6 ? args->Arg(5) : nullptr;
+		Dump(sort, file);
+		return;
+	}
+	if (strcmp(cmd, "reset") == 0) {
+		Reset();
+		rootmenu->ConsolePrint("Native timings have been reset.");
+		return;
+	}
+
+	rootmenu->ConsolePrint("Native profiling commands:");
+	rootmenu->DrawGenericOption("start", "Start timing native calls per plugin.");
+	rootmenu->DrawGenericOption("stop", "Stop timing and restore the original native bindings.");
+	rootmenu->DrawGenericOption("dump [sort] [file]", "Sort by time, calls, avg or max; optionally write all rows to a file.");
+	rootmenu->DrawGenericOption("reset", "Clear all recorded timings.");
+}
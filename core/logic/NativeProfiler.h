@@ -0,0 +1,93 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _include_sourcemod_logic_native_profiler_h_
+#define _include_sourcemod_logic_native_profiler_h_
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <sp_vm_api.h>
+#include <IRootConsoleMenu.h>
+#include <am-refcounting.h>
+#include "Native.h"
+
+using namespace SourcePawn;
+using namespace SourceMod;
+
+class CPlugin;
+
+// Times native calls per calling plugin. While it is running, every bound
+// native is rebound through a small timing wrapper. Stopping it restores the
+// original bindings, so nothing is added to native calls when it is off.
+class NativeProfiler
+{
+public:
+	struct Stats
+	{
+		std::string plugin;
+		std::string native;
+		uint64_t calls;
+		uint64_t total_ns;
+		uint64_t max_ns;
+	};
+
+public:
+	NativeProfiler();
+
+	bool IsEnabled() const {
+		return enabled_;
+	}
+
+	// Returns a callback that forwards to |entry| and charges its time to
+	// |plugin|. Only valid while the profiler is enabled.
+	ke::RefPtr<INativeCallback> Wrap(CPlugin *plugin, const ke::RefPtr<Native> &entry);
+
+	void Start();
+	void Stop();
+	void Reset();
+
+	void OnRootConsoleCommand(const ICommandArgs *args);
+
+private:
+	void Dump(const char *sort, const char *file);
+
+private:
+	bool enabled_;
+	int64_t started_at_;
+	int64_t elapsed_;
+	std::unordered_map<std::string, std::unique_ptr<Stats>> stats_;
+};
+
+extern NativeProfiler g_NativeProfiler;
+
+#endif // _include_sourcemod_logic_native_profiler_h_
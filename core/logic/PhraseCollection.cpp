@@ -70,6 +70,7 @@ IPhraseFile *CPhraseCollection::AddPhraseFile(const char *filename)
 	}
 
 	m_Files.push_back(pFile);
+	g_Translator.OnPhrasesChanged();
 
 	return pFile;
 }
@@ -31,6 +31,8 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <algorithm>
+#include <atomic>
 #include "PluginSys.h"
 #include "ShareSys.h"
 #include <ILibrarySys.h>
@@ -43,8 +45,11 @@
 #include "common_logic.h"
 #include "Translator.h"
 #include "Logger.h"
+#include "HandleSys.h"
+#include "ForwardProfiler.h"
 #include "frame_tasks.h"
 #include <amtl/am-string.h>
+#include <amtl/am-thread.h>
 #include <bridge/include/IVEngineServerBridge.h>
 #include <bridge/include/CoreProvider.h>
 
@@ -365,8 +370,10 @@ bool CPlugin::OnPluginStart()
 	if (!pFunction)
 		return true;
 
-	int err;
-	if ((err=pFunction->Execute(&result)) != SP_ERROR_NONE) {
+	int64_t start = ForwardProfiler::Now();
+	int err = pFunction->Execute(&result);
+	m_LoadProfile.plugin_start = ForwardProfiler::Now() - start;
+	if (err != SP_ERROR_NONE) {
 		EvictWithError(Plugin_Error, "Error detected in plugin startup (see error logs)");
 		return false;
 	}
@@ -415,7 +422,9 @@ void CPlugin::Call_OnAllPluginsLoaded()
 	{
 		if ((pFunction = m_pRuntime->GetFunctionByName("OnMapStart")) != NULL)
 		{
+			int64_t start = ForwardProfiler::Now();
 			pFunction->Execute(NULL);
+			m_LoadProfile.map_start = ForwardProfiler::Now() - start;
 		}
 	}
 
@@ -425,6 +434,24 @@ void CPlugin::Call_OnAllPluginsLoaded()
 	}
 }
 
+bool CPlugin::IsProfiledCallback(const char *forward)
+{
+	return strcmp(forward, "OnConfigsExecuted") == 0 || strcmp(forward, "OnMapStart") == 0 ||
+		strcmp(forward, "OnMapInit") == 0 || strcmp(forward, "OnMapEnd") == 0;
+}
+
+void CPlugin::RecordCallbackTime(const char *forward, int64_t ns)
+{
+	if (strcmp(forward, "OnConfigsExecuted") == 0)
+		m_LoadProfile.configs_executed = ns;
+	else if (strcmp(forward, "OnMapStart") == 0)
+		m_LoadProfile.map_start = ns;
+	else if (strcmp(forward, "OnMapInit") == 0)
+		m_LoadProfile.map_init = ns;
+	else if (strcmp(forward, "OnMapEnd") == 0)
+		m_LoadProfile.map_end = ns;
+}
+
 APLRes CPlugin::AskPluginLoad()
 {
 	assert(m_status == Plugin_Created);
@@ -485,13 +512,21 @@ void *CPlugin::GetPluginStructure()
 }
 
 // Only called during plugin construction.
-bool CPlugin::TryCompile()
+bool CPlugin::TryCompile(PreloadedBinary *preload)
 {
-	char fullpath[PLATFORM_MAX_PATH];
-	g_pSM->BuildPath(Path_SM, fullpath, sizeof(fullpath), "plugins/%s", m_filename);
-
 	char loadmsg[255];
-	m_pRuntime.reset(g_pSourcePawn2->LoadBinaryFromFile(fullpath, loadmsg, sizeof(loadmsg)));
+	if (preload) {
+		m_pRuntime = std::move(preload->runtime);
+		ke::SafeStrcpy(loadmsg, sizeof(loadmsg), preload->error.c_str());
+		m_LoadProfile.load = preload->load_time;
+	} else {
+		char fullpath[PLATFORM_MAX_PATH];
+		g_pSM->BuildPath(Path_SM, fullpath, sizeof(fullpath), "plugins/%s", m_filename);
+
+		int64_t start = ForwardProfiler::Now();
+		m_pRuntime.reset(g_pSourcePawn2->LoadBinaryFromFile(fullpath, loadmsg, sizeof(loadmsg)));
+		m_LoadProfile.load = ForwardProfiler::Now() - start;
+	}
 	if (!m_pRuntime) {
 		EvictWithError(Plugin_BadLoad, "Unable to load plugin (%s)", loadmsg);
 		return false;
@@ -847,6 +882,7 @@ CPluginManager::CPluginManager()
 	m_LoadingLocked = false;
 
 	m_bBlockBadPlugins = true;
+	m_ParallelLoadThreads = 0;
 }
 
 CPluginManager::~CPluginManager()
@@ -871,10 +907,74 @@ void CPluginManager::LoadAll_FirstPass(const char *config, const char *basedir)
 {
 	/* First read in the database of plugin settings */
 	m_AllPluginsLoaded = false;
-	LoadPluginsFromDir(basedir, NULL);
+
+	std::vector<std::string> files;
+	FindPluginsInDir(basedir, NULL, files);
+
+	if (m_ParallelLoadThreads && files.size() > 1 && !m_LoadingLocked) {
+		LoadPluginsParallel(files);
+		return;
+	}
+
+	for (size_t i = 0; i < files.size(); i++)
+		LoadAutoPlugin(files[i].c_str());
+}
+
+void CPluginManager::LoadPluginsParallel(const std::vector<std::string> &files)
+{
+	// Only the SourcePawn loader runs on the workers: reading the file,
+	// decompressing it and verifying the image. Everything that touches
+	// other plugins or the game (natives, AskPluginLoad, OnPluginStart)
+	// still happens below, on this thread and in directory order.
+	std::vector<PreloadedBinary> binaries(files.size());
+	for (size_t i = 0; i < files.size(); i++) {
+		// Plugins that LoadPlugin() would keep as already loaded aren't read again.
+		CPlugin *pPlugin;
+		if (m_LoadLookup.retrieve(files[i].c_str(), &pPlugin)
+			&& pPlugin->GetStatus() != Plugin_BadLoad
+			&& pPlugin->GetStatus() != Plugin_Error
+			&& pPlugin->GetStatus() != Plugin_Failed)
+		{
+			continue;
+		}
+
+		char fullpath[PLATFORM_MAX_PATH];
+		g_pSM->BuildPath(Path_SM, fullpath, sizeof(fullpath), "plugins/%s", files[i].c_str());
+		binaries[i].path = fullpath;
+		binaries[i].wanted = true;
+	}
+
+	std::atomic<size_t> next(0);
+	auto worker = [&binaries, &next]() -> void {
+		for (size_t i = next++; i < binaries.size(); i = next++) {
+			PreloadedBinary &binary = binaries[i];
+			if (!binary.wanted)
+				continue;
+
+			char loadmsg[255];
+			int64_t start = ForwardProfiler::Now();
+			binary.runtime.reset(g_pSourcePawn2->LoadBinaryFromFile(binary.path.c_str(), loadmsg, sizeof(loadmsg)));
+			binary.load_time = ForwardProfiler::Now() - start;
+			if (!binary.runtime)
+				binary.error = loadmsg;
+		}
+	};
+
+	unsigned int count = std::min<size_t>(m_ParallelLoadThreads, files.size());
+	std::vector<std::unique_ptr<std::thread>> threads;
+	for (unsigned int i = 0; i < count; i++) {
+		char name[32];
+		ke::SafeSprintf(name, sizeof(name), "SM Plugin Loader %u", i);
+		threads.emplace_back(ke::NewThread(name, worker));
+	}
+	for (size_t i = 0; i < threads.size(); i++)
+		threads[i]->join();
+
+	for (size_t i = 0; i < files.size(); i++)
+		LoadAutoPlugin(files[i].c_str(), binaries[i].wanted ? &binaries[i] : nullptr);
 }
 
-void CPluginManager::LoadPluginsFromDir(const char *basedir, const char *localpath)
+void CPluginManager::FindPluginsInDir(const char *basedir, const char *localpath, std::vector<std::string> &files)
 {
 	char base_path[PLATFORM_MAX_PATH];
 
@@ -913,14 +1013,14 @@ void CPluginManager::LoadPluginsFromDir(const char *basedir, const char *localpa
 			} else {
 				libsys->PathFormat(new_local, sizeof(new_local), "%s/%s", localpath, dir->GetEntryName());
 			}
-			LoadPluginsFromDir(basedir, new_local);
+			FindPluginsInDir(basedir, new_local, files);
 		} else if (dir->IsEntryFile()) {
 			const char *name = dir->GetEntryName();
 			size_t len = strlen(name);
 			if (len >= 4
 				&& strcmp(&name[len-4], ".smx") == 0)
 			{
-				/* If the filename matches, load the plugin */
+				/* If the filename matches, queue the plugin */
 				char plugin[PLATFORM_MAX_PATH];
 				if (localpath == NULL)
 				{
@@ -928,7 +1028,7 @@ void CPluginManager::LoadPluginsFromDir(const char *basedir, const char *localpa
 				} else {
 					libsys->PathFormat(plugin, sizeof(plugin), "%s/%s", localpath, name);
 				}
-				LoadAutoPlugin(plugin);
+				files.push_back(plugin);
 			}
 		}
 		dir->NextEntry();
@@ -936,7 +1036,8 @@ void CPluginManager::LoadPluginsFromDir(const char *basedir, const char *localpa
 	libsys->CloseDirectory(dir);
 }
 
-LoadRes CPluginManager::LoadPlugin(CPlugin **aResult, const char *path, bool debug, PluginType type)
+LoadRes CPluginManager::LoadPlugin(CPlugin **aResult, const char *path, bool debug, PluginType type,
+                                   PreloadedBinary *preload)
 {
 	if (m_LoadingLocked)
 		return LoadRes_NeverLoad;
@@ -962,7 +1063,7 @@ LoadRes CPluginManager::LoadPlugin(CPlugin **aResult, const char *path, bool deb
 		}
 	}
 
-	CPlugin *plugin = CompileAndPrep(path);
+	CPlugin *plugin = CompileAndPrep(path, preload);
 
 	// Assign our outparam so we can return early. It must be set.
 	*aResult = plugin;
@@ -1034,11 +1135,11 @@ IPlugin *CPluginManager::LoadPlugin(const char *path, bool debug, PluginType typ
 	return pl;
 }
 
-void CPluginManager::LoadAutoPlugin(const char *plugin)
+void CPluginManager::LoadAutoPlugin(const char *plugin, PreloadedBinary *preload)
 {
 	CPlugin *pl = NULL;
 	LoadRes res;
-	if ((res=LoadPlugin(&pl, plugin, false, PluginType_MapUpdated)) == LoadRes_Failure)
+	if ((res=LoadPlugin(&pl, plugin, false, PluginType_MapUpdated, preload)) == LoadRes_Failure)
 	{
 		g_Logger.LogError("[SM] Failed to load plugin \"%s\": %s.", plugin, pl->GetErrorMsg());
 	}
@@ -1217,6 +1318,13 @@ void CPlugin::SetWaitingToUnload(bool andReload)
 	m_state = andReload ? PluginState::WaitingToUnloadAndReload : PluginState::WaitingToUnload;
 }
 
+void CPluginManager::BindNatives(CPlugin *pPlugin, bool bCoreOnly)
+{
+	int64_t start = ForwardProfiler::Now();
+	g_ShareSys.BindNativesToPlugin(pPlugin, bCoreOnly);
+	pPlugin->LoadProfile().bind += ForwardProfiler::Now() - start;
+}
+
 void CPluginManager::LoadExtensions(CPlugin *pPlugin)
 {
 	auto callback = [pPlugin] (const sp_pubvar_t *pubvar, const CPlugin::ExtVar& ext) -> bool
@@ -1225,7 +1333,7 @@ void CPluginManager::LoadExtensions(CPlugin *pPlugin)
 		/* Attempt to auto-load if necessary */
 		if (ext.autoload) {
 			libsys->PathFormat(path, PLATFORM_MAX_PATH, "%s", ext.file);
-			g_Extensions.LoadAutoExtension(path, ext.required);
+			g_Extensions.LoadAutoExtension(path, ext.required, true);
 		}
 		return true;
 	};
@@ -1268,7 +1376,7 @@ bool CPluginManager::RequireExtensions(CPlugin *pPlugin)
 	return pPlugin->ForEachExtVar(std::move(callback));
 }
 
-CPlugin *CPluginManager::CompileAndPrep(const char *path)
+CPlugin *CPluginManager::CompileAndPrep(const char *path, PreloadedBinary *preload)
 {
 	CPlugin *plugin = CPlugin::Create(path);
 	if (plugin->GetStatus() != Plugin_Uncompiled) {
@@ -1276,7 +1384,7 @@ CPlugin *CPluginManager::CompileAndPrep(const char *path)
 		return plugin;
 	}
 
-	if (!plugin->TryCompile())
+	if (!plugin->TryCompile(preload))
 		return plugin;
 	assert(plugin->GetStatus() == Plugin_Created);
 
@@ -1284,7 +1392,7 @@ CPlugin *CPluginManager::CompileAndPrep(const char *path)
 		return plugin;
 	assert(plugin->GetStatus() == Plugin_Created);
 
-	g_ShareSys.BindNativesToPlugin(plugin, true);
+	BindNatives(plugin, true);
 	plugin->InitIdentity();
 	return plugin;
 }
@@ -1329,7 +1437,7 @@ bool CPluginManager::RunSecondPass(CPlugin *pPlugin)
 		return false;
 
 	// Run another binding pass.
-	g_ShareSys.BindNativesToPlugin(pPlugin, false);
+	BindNatives(pPlugin, false);
 
 	// Find any unbound natives. Right now, these are not allowed.
 	IPluginContext *pContext = pPlugin->GetBaseContext();
@@ -1401,7 +1509,7 @@ void CPluginManager::TryRefreshDependencies(CPlugin *pPlugin)
 {
 	assert(pPlugin->GetBaseContext() != NULL);
 
-	g_ShareSys.BindNativesToPlugin(pPlugin, false);
+	BindNatives(pPlugin, false);
 
 	bool all_found = pPlugin->ForEachRequiredLib([this, pPlugin] (const char *lib) -> bool {
 		CPlugin *found = nullptr;
@@ -1634,6 +1742,15 @@ ConfigResult CPluginManager::OnSourceModConfigChanged(const char *key,
 			return ConfigResult_Reject;
 		}
 		return ConfigResult_Accept;
+	} else if (strcmp(key, "ParallelPluginLoad") == 0) {
+		char *end;
+		unsigned long threads = strtoul(value, &end, 10);
+		if (!value[0] || *end != '\0' || threads > 32) {
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be a number of threads from 0 to 32");
+			return ConfigResult_Reject;
+		}
+		m_ParallelLoadThreads = (unsigned int)threads;
+		return ConfigResult_Accept;
 	}
 	return ConfigResult_Ignore;
 }
@@ -1996,6 +2113,11 @@ void CPluginManager::OnRootConsoleCommand(const char *cmdname, const ICommandArg
 			}
 			return;
 		}
+		else if (strcmp(cmd, "profile") == 0)
+		{
+			ListPluginProfiles();
+			return;
+		}
 		else if (strcmp(cmd, "refresh") == 0)
 		{
 			RefreshAll();
@@ -2075,6 +2197,7 @@ void CPluginManager::OnRootConsoleCommand(const char *cmdname, const ICommandArg
 	rootmenu->DrawGenericOption("load", "Load a plugin");
 	rootmenu->DrawGenericOption("load_lock", "Prevents any more plugins from being loaded");
 	rootmenu->DrawGenericOption("load_unlock", "Re-enables plugin loading");
+	rootmenu->DrawGenericOption("profile", "Show load times, memory and Handles per plugin");
 	rootmenu->DrawGenericOption("refresh", "Reloads/refreshes all plugins in the plugins folder");
 	rootmenu->DrawGenericOption("reload", "Reloads a plugin");
 	rootmenu->DrawGenericOption("unload", "Unload a plugin");
@@ -2135,6 +2258,75 @@ void CPluginManager::ReloadPluginImpl(int id, const char filename[], PluginType
 	m_plugins.insertBefore(iter, static_cast<CPlugin *>(newpl));
 }
 
+static inline double NsToMs(int64_t ns)
+{
+	return double(ns) / 1000000.0;
+}
+
+void CPluginManager::ListPluginProfiles()
+{
+	if (!GetPluginCount())
+	{
+		rootmenu->ConsolePrint("[SM] No plugins loaded");
+		return;
+	}
+
+	rootmenu->ConsolePrint("[SM] Plugin load profile (times in ms, memory in KB):");
+	rootmenu->ConsolePrint("  %-4s %8s %8s %8s %8s %8s %8s %8s %8s %8s  %s",
+		"#", "Load", "Bind", "Start", "Configs", "MapInit", "MapStart", "MapEnd", "Memory", "Handles", "File");
+
+	PluginLoadProfile total;
+	size_t total_memory = 0;
+	unsigned int total_handles = 0;
+	unsigned int id = 1;
+	for (PluginIter iter(m_plugins); !iter.done(); iter.next(), id++) {
+		CPlugin *pl = (*iter);
+		const PluginLoadProfile &profile = pl->LoadProfile();
+
+		size_t memory = pl->CalcMemUsage();
+		if (IPluginRuntime *runtime = pl->GetRuntime())
+			memory += runtime->GetMemUsage();
+
+		std::map<std::string, unsigned int> handles;
+		g_HandleSys.CountOwnedHandles(pl->GetIdentity(), handles);
+		unsigned int num_handles = 0;
+		for (auto i = handles.begin(); i != handles.end(); i++)
+			num_handles += i->second;
+
+		rootmenu->ConsolePrint("  %-4u %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %8u %8u  %s",
+			id, NsToMs(profile.load), NsToMs(profile.bind), NsToMs(profile.plugin_start),
+			NsToMs(profile.configs_executed), NsToMs(profile.map_init), NsToMs(profile.map_start),
+			NsToMs(profile.map_end),
+			(unsigned int)(memory / 1024), num_handles, pl->GetFilename());
+
+		if (!handles.empty()) {
+			std::string line;
+			for (auto i = handles.begin(); i != handles.end(); i++) {
+				if (!line.empty())
+					line += ", ";
+				line += i->first + " " + std::to_string(i->second);
+			}
+			rootmenu->ConsolePrint("       Handles: %s", line.c_str());
+		}
+
+		total.load += profile.load;
+		total.bind += profile.bind;
+		total.plugin_start += profile.plugin_start;
+		total.configs_executed += profile.configs_executed;
+		total.map_init += profile.map_init;
+		total.map_start += profile.map_start;
+		total.map_end += profile.map_end;
+		total_memory += memory;
+		total_handles += num_handles;
+	}
+
+	rootmenu->ConsolePrint("  %-4s %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %8u %8u",
+		"All", NsToMs(total.load), NsToMs(total.bind), NsToMs(total.plugin_start),
+		NsToMs(total.configs_executed), NsToMs(total.map_init), NsToMs(total.map_start),
+		NsToMs(total.map_end),
+		(unsigned int)(total_memory / 1024), total_handles);
+}
+
 void CPluginManager::RefreshAll()
 {
 	/* If we're in a load lock, just skip this whole bit. */
@@ -37,6 +37,8 @@
 #include <time.h>
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <IPluginSys.h>
 #include <IHandleSys.h>
@@ -63,6 +65,35 @@ class CPlayer;
 
 using namespace SourceHook;
 
+/**
+ * A plugin binary that was read, decompressed and verified by a load worker
+ * before the main thread got to it. Exactly one of runtime or error is set.
+ */
+struct PreloadedBinary
+{
+	std::string path;
+	std::unique_ptr<IPluginRuntime> runtime;
+	std::string error;
+	int64_t load_time = 0;
+	bool wanted = false;
+};
+
+/**
+ * How long a plugin took to load and to run its lifecycle callbacks, in
+ * nanoseconds, for "sm plugins profile". Callback times are for the most
+ * recent call.
+ */
+struct PluginLoadProfile
+{
+	int64_t load = 0;				// Reading, decompressing and verifying the binary
+	int64_t bind = 0;				// All native binding passes
+	int64_t plugin_start = 0;
+	int64_t configs_executed = 0;
+	int64_t map_init = 0;
+	int64_t map_start = 0;
+	int64_t map_end = 0;
+};
+
 enum LoadRes
 {
 	LoadRes_Successful,
@@ -242,9 +273,18 @@ public:
 		return true;
 	}
 
-	bool TryCompile();
+	bool TryCompile(PreloadedBinary *preload = nullptr);
 	void BindFakeNativesTo(CPlugin *other);
 
+	PluginLoadProfile &LoadProfile() {
+		return m_LoadProfile;
+	}
+
+	// Whether a forward is one of the lifecycle callbacks in PluginLoadProfile,
+	// and if so, records how long this plugin's listener took.
+	static bool IsProfiledCallback(const char *forward);
+	void RecordCallbackTime(const char *forward, int64_t ns);
+
 protected:
 	void DependencyDropped(CPlugin *pOwner);
 
@@ -284,6 +324,7 @@ private:
 	List<String> m_RequiredLibs;
 	IdentityToken_t *m_ident;
 	time_t m_LastFileModTime;
+	PluginLoadProfile m_LoadProfile;
 	Handle_t m_handle;
 	char m_DateTime[256];
 
@@ -362,6 +403,10 @@ public: //SMGlobalClass
 	void OnSourceModAllInitialized();
 	void OnSourceModShutdown();
 	ConfigResult OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source, char *error, size_t maxlength);
+	const char *GetGlobalClassName()
+	{
+		return "PluginManager";
+	}
 	void OnSourceModMaxPlayersChanged(int newvalue);
 public: //IHandleTypeDispatch
 	void OnHandleDestroy(HandleType_t type, void *object);
@@ -437,14 +482,21 @@ public:
 
 	void ForEachPlugin(ke::Function<void(CPlugin *)> callback);
 private:
-	LoadRes LoadPlugin(CPlugin **pPlugin, const char *path, bool debug, PluginType type);
+	LoadRes LoadPlugin(CPlugin **pPlugin, const char *path, bool debug, PluginType type,
+		PreloadedBinary *preload = nullptr);
+
+	void LoadAutoPlugin(const char *plugin, PreloadedBinary *preload = nullptr);
 
-	void LoadAutoPlugin(const char *plugin);
+	/**
+	 * Recursively collects all plugins in the given directory, in load order.
+	 */
+	void FindPluginsInDir(const char *basedir, const char *localdir, std::vector<std::string> &files);
 
 	/**
-	 * Recursively loads all plugins in the given directory.
+	 * Reads and verifies the given plugins on a worker pool, then loads them
+	 * in order on the main thread.
 	 */
-	void LoadPluginsFromDir(const char *basedir, const char *localdir);
+	void LoadPluginsParallel(const std::vector<std::string> &files);
 
 	/**
 	 * Adds a plugin object.  This is wrapped by LoadPlugin functions.
@@ -452,12 +504,14 @@ private:
 	void AddPlugin(CPlugin *pPlugin);
 
 	// First pass for loading a plugin, and its helpers.
-	CPlugin *CompileAndPrep(const char *path);
+	CPlugin *CompileAndPrep(const char *path, PreloadedBinary *preload);
 	bool MalwareCheckPass(CPlugin *pPlugin);
 
 	// Runs the second loading pass on a plugin.
 	bool RunSecondPass(CPlugin *pPlugin);
 	void LoadExtensions(CPlugin *pPlugin);
+	void BindNatives(CPlugin *pPlugin, bool bCoreOnly);
+	void ListPluginProfiles();
 	bool RequireExtensions(CPlugin *pPlugin);
 	bool FindOrRequirePluginDeps(CPlugin *pPlugin);
 
@@ -519,6 +573,7 @@ private:
 	
 	// Config
 	bool m_bBlockBadPlugins;
+	unsigned int m_ParallelLoadThreads;
 	
 	// Forwards
 	IForward *m_pOnLibraryAdded;
@@ -0,0 +1,310 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#include "PluginTimeTracker.h"
+#include "ExtensionSys.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+#include <ISourceMod.h>
+#include <bridge/include/IScriptManager.h>
+
+PluginTimeTracker g_PluginTimeTracker;
+
+static inline int64_t
+Now()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+PluginTimeTracker::PluginTimeTracker()
+ : window_start_(0),
+   interval_(0),
+   json_(false),
+   collect_totals_(false),
+   timer_(nullptr),
+   initialized_(false)
+{
+}
+
+void
+PluginTimeTracker::OnSourceModAllInitialized()
+{
+	pluginsys->AddPluginsListener(this);
+	initialized_ = true;
+	UpdateTimer();
+}
+
+void
+PluginTimeTracker::OnSourceModShutdown()
+{
+	if (timer_)
+		timersys->KillTimer(timer_);
+	pluginsys->RemovePluginsListener(this);
+	initialized_ = false;
+}
+
+ConfigResult
+PluginTimeTracker::OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source,
+                                            char *error, size_t maxlength)
+{
+	if (strcmp(key, "PluginTimeExportFormat") == 0) {
+		if (strcasecmp(value, "json") == 0) {
+			json_ = true;
+		} else if (strcasecmp(value, "csv") == 0) {
+			json_ = false;
+		} else {
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be \"csv\" or \"json\"");
+			return ConfigResult_Reject;
+		}
+		return ConfigResult_Accept;
+	}
+
+	if (strcmp(key, "PluginTimeExportInterval") != 0)
+		return ConfigResult_Ignore;
+
+	char *end;
+	unsigned long interval = strtoul(value, &end, 10);
+	if (!value[0] || *end != '\0') {
+		ke::SafeStrcpy(error, maxlength, "Invalid value: must be a number of seconds");
+		return ConfigResult_Reject;
+	}
+	interval_ = (unsigned int)interval;
+	UpdateTimer();
+	return ConfigResult_Accept;
+}
+
+void
+PluginTimeTracker::UpdateTimer()
+{
+	if (!initialized_)
+		return;
+	if (timer_)
+		timersys->KillTimer(timer_);
+
+	usage_.clear();
+	window_start_ = Now();
+	if (interval_)
+		timer_ = timersys->CreateTimer(this, float(interval_), nullptr, TIMER_FLAG_REPEAT);
+}
+
+const char *
+PluginTimeTracker::OwnerName(IdentityToken_t *owner)
+{
+	auto iter = owner_names_.find(owner);
+	if (iter != owner_names_.end())
+		return iter->second;
+
+	const char *name = "<unknown>";
+	if (!owner || owner == g_pCoreIdent)
+		name = "SourceMod";
+	else if (IExtension *ext = g_Extensions.GetExtensionFromIdent(owner))
+		name = ext->GetFilename();
+	else if (SMPlugin *plugin = scripts->FindPluginByIdentity(owner))
+		name = plugin->GetFilename();
+
+	const char *interned = names_.insert(name).first->c_str();
+	owner_names_[owner] = interned;
+	return interned;
+}
+
+void
+PluginTimeTracker::SetCollectTotals(bool collect)
+{
+	collect_totals_ = collect;
+	if (!collect)
+		totals_.clear();
+}
+
+void
+PluginTimeTracker::GetTotals(std::vector<std::pair<const char *, Usage>> &rows)
+{
+	// Bring the running scope up to date so its owner is not under-reported.
+	if (!stack_.empty() && stack_.back().start) {
+		int64_t now = Now();
+		Charge(stack_.back().owner, now - stack_.back().start);
+		stack_.back().start = now;
+	}
+
+	for (const auto &entry : totals_)
+		rows.emplace_back(OwnerName(entry.first), entry.second);
+}
+
+void
+PluginTimeTracker::Charge(IdentityToken_t *owner, int64_t ns)
+{
+	if (interval_)
+		usage_[owner].busy_ns += ns;
+	if (collect_totals_)
+		totals_[owner].busy_ns += ns;
+}
+
+void
+PluginTimeTracker::Enter(IdentityToken_t *owner, const char *name)
+{
+	int64_t now = 0;
+	if (Accounting()) {
+		// Time is exclusive: pause whoever called into this owner.
+		now = Now();
+		if (!stack_.empty() && stack_.back().start)
+			Charge(stack_.back().owner, now - stack_.back().start);
+		if (interval_)
+			usage_[owner].calls++;
+		if (collect_totals_)
+			totals_[owner].calls++;
+	}
+
+	bool profiled = g_ProfileToolManager.IsActive();
+	if (profiled)
+		g_ProfileToolManager.EnterScope(OwnerName(owner), name);
+
+	stack_.push_back(Scope{owner, now, profiled});
+}
+
+void
+PluginTimeTracker::Enter(IPluginFunction *func, const char *name)
+{
+	IPlugin *plugin = pluginsys->FindPluginByContext(func->GetParentContext()->GetContext());
+	Enter(plugin ? plugin->GetIdentity() : nullptr, name);
+}
+
+void
+PluginTimeTracker::Leave()
+{
+	Scope scope = stack_.back();
+	stack_.pop_back();
+
+	if (scope.profiled)
+		g_ProfileToolManager.LeaveScope();
+
+	if (Accounting()) {
+		int64_t now = Now();
+		if (scope.start)
+			Charge(scope.owner, now - scope.start);
+		if (!stack_.empty())
+			stack_.back().start = now;
+	}
+}
+
+void
+PluginTimeTracker::OnPluginUnloaded(IPlugin *plugin)
+{
+	// The identity may be reused by the next plugin.
+	usage_.erase(plugin->GetIdentity());
+	totals_.erase(plugin->GetIdentity());
+	owner_names_.erase(plugin->GetIdentity());
+}
+
+ResultType
+PluginTimeTracker::OnTimer(ITimer *pTimer, void *pData)
+{
+	Export();
+	return Pl_Continue;
+}
+
+void
+PluginTimeTracker::OnTimerEnd(ITimer *pTimer, void *pData)
+{
+	timer_ = nullptr;
+}
+
+static void
+WriteJsonString(FILE *fp, const char *str)
+{
+	fputc('"', fp);
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			fputc('\\', fp);
+		fputc(*str, fp);
+	}
+	fputc('"', fp);
+}
+
+void
+PluginTimeTracker::Export()
+{
+	int64_t now = Now();
+	int64_t window_ns = std::max<int64_t>(now - window_start_, 1);
+	window_start_ = now;
+
+	// Split a scope that spans the export between the two windows.
+	if (!stack_.empty() && stack_.back().start) {
+		Charge(stack_.back().owner, now - stack_.back().start);
+		stack_.back().start = now;
+	}
+
+	std::vector<std::pair<const char *, Usage>> rows;
+	for (const auto &entry : usage_)
+		rows.emplace_back(OwnerName(entry.first), entry.second);
+	usage_.clear();
+
+	std::sort(rows.begin(), rows.end(),
+	          [](const std::pair<const char *, Usage> &a, const std::pair<const char *, Usage> &b) {
+		return a.second.busy_ns > b.second.busy_ns;
+	});
+
+	char path[PLATFORM_MAX_PATH];
+	g_pSM->BuildPath(Path_SM, path, sizeof(path), json_ ? "logs/plugin_time.json" : "logs/plugin_time.csv");
+
+	FILE *fp = fopen(path, "a");
+	if (!fp)
+		return;
+
+	long long t = (long long)g_pSM->GetAdjustedTime();
+	if (json_) {
+		fprintf(fp, "{\"time\":%lld,\"window_ms\":%.3f,\"owners\":[", t, window_ns / 1000000.0);
+		for (size_t i = 0; i < rows.size(); i++) {
+			fputs(i ? ",{\"name\":" : "{\"name\":", fp);
+			WriteJsonString(fp, rows[i].first);
+			fprintf(fp, ",\"calls\":%llu,\"busy_ms\":%.3f,\"share\":%.6f}",
+			        (unsigned long long)rows[i].second.calls,
+			        rows[i].second.busy_ns / 1000000.0,
+			        double(rows[i].second.busy_ns) / window_ns);
+		}
+		fputs("]}\n", fp);
+	} else {
+		fseek(fp, 0, SEEK_END);
+		if (ftell(fp) == 0)
+			fputs("time,owner,calls,busy_ms,share\n", fp);
+		for (size_t i = 0; i < rows.size(); i++) {
+			fprintf(fp, "%lld,%s,%llu,%.3f,%.6f\n", t, rows[i].first,
+			        (unsigned long long)rows[i].second.calls,
+			        rows[i].second.busy_ns / 1000000.0,
+			        double(rows[i].second.busy_ns) / window_ns);
+		}
+	}
+	fclose(fp);
+}
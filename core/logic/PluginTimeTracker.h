@@ -0,0 +1,161 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#ifndef _include_sourcemod_logic_plugin_time_tracker_h_
+#define _include_sourcemod_logic_plugin_time_tracker_h_
+
+#include <stdint.h>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <IPluginSys.h>
+#include <ITimerSystem.h>
+#include "common_logic.h"
+#include "ProfileTools.h"
+#include "CallbackWatchdog.h"
+
+using namespace SourceMod;
+
+// Attributes server time to the plugin or extension that spent it, at the
+// points where core calls into them (forward listeners, timers and frame
+// tasks). Two consumers share the same scopes:
+//
+//  - The active profiling tool gets a nested scope per owner, whose group is
+//    the owner's name, so "vprof_generate_report_budget" (or a trace) shows
+//    one budget group per plugin and extension.
+//  - When PluginTimeExportInterval is set, exclusive time per owner is
+//    accumulated and written to logs/ every interval as CSV or JSON lines,
+//    without needing VProf to be running.
+//  - When the metrics exporter asks for totals, exclusive time per owner is
+//    also kept as a running total that is never reset.
+class PluginTimeTracker
+	: public SMGlobalClass,
+	  public IPluginsListener,
+	  public ITimedEvent
+{
+public:
+	PluginTimeTracker();
+
+	struct Usage
+	{
+		int64_t busy_ns = 0;
+		uint64_t calls = 0;
+	};
+
+	bool IsActive() const {
+		return Accounting() || g_ProfileToolManager.IsActive();
+	}
+
+	void SetCollectTotals(bool collect);
+	void GetTotals(std::vector<std::pair<const char *, Usage>> &rows);
+
+	void Enter(IdentityToken_t *owner, const char *name);
+	void Enter(IPluginFunction *func, const char *name);
+	void Leave();
+
+	// SMGlobalClass
+	ConfigResult OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source,
+	                                      char *error, size_t maxlength) override;
+	void OnSourceModAllInitialized() override;
+	void OnSourceModShutdown() override;
+
+	// IPluginsListener
+	void OnPluginUnloaded(IPlugin *plugin) override;
+
+	// ITimedEvent
+	ResultType OnTimer(ITimer *pTimer, void *pData) override;
+	void OnTimerEnd(ITimer *pTimer, void *pData) override;
+
+private:
+	struct Scope
+	{
+		IdentityToken_t *owner;
+		int64_t start;
+		bool profiled;
+	};
+
+	bool Accounting() const {
+		return interval_ > 0 || collect_totals_;
+	}
+	void Charge(IdentityToken_t *owner, int64_t ns);
+	const char *OwnerName(IdentityToken_t *owner);
+	void Export();
+	void UpdateTimer();
+
+private:
+	std::vector<Scope> stack_;
+	std::unordered_map<IdentityToken_t *, Usage> usage_;
+	std::unordered_map<IdentityToken_t *, Usage> totals_;
+	// Profiling tools may keep group name pointers, so names live forever.
+	std::set<std::string> names_;
+	std::unordered_map<IdentityToken_t *, const char *> owner_names_;
+	int64_t window_start_;
+	unsigned int interval_;
+	bool json_;
+	bool collect_totals_;
+	ITimer *timer_;
+	bool initialized_;
+};
+
+extern PluginTimeTracker g_PluginTimeTracker;
+
+// Charges the enclosed code to a plugin or extension, if anything is
+// listening, and lets the callback watchdog see it.
+class PluginTimeScope
+{
+public:
+	PluginTimeScope(IdentityToken_t *owner, const char *name)
+	 : active_(g_PluginTimeTracker.IsActive())
+	{
+		g_CallbackWatchdog.Enter(owner, nullptr, name);
+		if (active_)
+			g_PluginTimeTracker.Enter(owner, name);
+	}
+	PluginTimeScope(IPluginFunction *func, const char *name)
+	 : active_(g_PluginTimeTracker.IsActive())
+	{
+		g_CallbackWatchdog.Enter(nullptr, func, name);
+		if (active_)
+			g_PluginTimeTracker.Enter(func, name);
+	}
+	~PluginTimeScope() {
+		if (active_)
+			g_PluginTimeTracker.Leave();
+		g_CallbackWatchdog.Leave();
+	}
+
+private:
+	bool active_;
+};
+
+#endif // _include_sourcemod_logic_plugin_time_tracker_h_
@@ -26,6 +26,9 @@
 // or <http://www.sourcemod.net/license.php>.
 
 #include "ProfileTools.h"
+#include "ForwardProfiler.h"
+#include "NativeProfiler.h"
+#include "frame_tasks.h"
 #include <stdarg.h>
 #include <am-string.h>
 
@@ -49,6 +52,28 @@ ProfileToolManager::OnSourceModShutdown()
 	rootmenu->RemoveRootConsoleCommand("prof", this);
 }
 
+void
+ProfileToolManager::RenderFrameBlockStats(const ICommandArgs *args)
+{
+	if (args->ArgC() >= 4 && strcmp(args->Arg(3), "reset") == 0) {
+		ResetFrameBlockStats();
+		rootmenu->ConsolePrint("[SM] RequestFrame allocation counters reset.");
+		return;
+	}
+
+	FrameBlockStats stats;
+	GetFrameBlockStats(&stats);
+
+	uint64_t reused = stats.requests - stats.allocations;
+	rootmenu->ConsolePrint("[SM] RequestFrame data blocks (%u bytes each):", (unsigned)kFrameBlockSize);
+	rootmenu->ConsolePrint("  Requests:     %llu", (unsigned long long)stats.requests);
+	rootmenu->ConsolePrint("  Heap allocs:  %llu", (unsigned long long)stats.allocations);
+	rootmenu->ConsolePrint("  Reused:       %llu (%.1f%%)", (unsigned long long)reused,
+	                       stats.requests ? (100.0 * reused) / stats.requests : 0.0);
+	rootmenu->ConsolePrint("  Outstanding:  %u (peak %u)", (unsigned)stats.outstanding, (unsigned)stats.peak);
+	rootmenu->ConsolePrint("  Free list:    %u", (unsigned)stats.pooled);
+}
+
 IProfilingTool *
 ProfileToolManager::FindToolByName(const char *name)
 {
@@ -87,6 +112,7 @@ ProfileToolManager::StartFromConsole(IProfilingTool *tool)
 		return;
 	}
 
+	g_FlightRecorder.DetachFromVM();
 	g_pSourcePawn2->SetProfilingTool(active_);
 	g_pSourcePawn2->EnableProfiling();
 	rootmenu->ConsolePrint("Started profiling with %s.", active_->Name());
@@ -97,6 +123,19 @@ ProfileToolManager::StartFromConsole(IProfilingTool *tool)
 void
 ProfileToolManager::OnRootConsoleCommand(const char *cmdname, const ICommandArgs *args)
 {
+	if (args->ArgC() >= 3 && strcmp(args->Arg(2), "forwards") == 0) {
+		g_ForwardProfiler.OnRootConsoleCommand(args);
+		return;
+	}
+	if (args->ArgC() >= 3 && strcmp(args->Arg(2), "natives") == 0) {
+		g_NativeProfiler.OnRootConsoleCommand(args);
+		return;
+	}
+	if (args->ArgC() >= 3 && strcmp(args->Arg(2), "frames") == 0) {
+		RenderFrameBlockStats(args);
+		return;
+	}
+
 	if (tools_.size() == 0) {
 		rootmenu->ConsolePrint("No profiling tools are enabled.");
 		return;
@@ -121,6 +160,7 @@ ProfileToolManager::OnRootConsoleCommand(const char *cmdname, const ICommandArgs
 			g_pSourcePawn2->SetProfilingTool(nullptr);
 			active_->Stop(render_help);
 			active_ = nullptr;
+			g_FlightRecorder.AttachToVM();
 			return;
 		}
 		if (strcmp(cmdname, "dump") == 0) {
@@ -188,4 +228,7 @@ ProfileToolManager::OnRootConsoleCommand(const char *cmdname, const ICommandArgs
 	rootmenu->DrawGenericOption("stop", "Stop the current profile session.");
 	rootmenu->DrawGenericOption("dump", "Dumps output from the current profile session.");
 	rootmenu->DrawGenericOption("help", "Display help text for a profiler.");
+	rootmenu->DrawGenericOption("forwards", "Time forward listeners per plugin function.");
+	rootmenu->DrawGenericOption("natives", "Time native calls per calling plugin.");
+	rootmenu->DrawGenericOption("frames", "Show RequestFrame allocation counts (\"reset\" to clear).");
 }
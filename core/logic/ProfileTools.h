@@ -33,6 +33,7 @@
 #include <IShareSys.h>
 #include <IRootConsoleMenu.h>
 #include "common_logic.h"
+#include "FlightRecorder.h"
 
 using namespace SourcePawn;
 
@@ -54,7 +55,12 @@ public:
 		tools_.push_back(tool);
 	}
 
+	// True if anything wants scopes: a profile started from the console, or
+	// the slow frame recorder.
 	bool IsActive() const {
+		return !!active_ || g_FlightRecorder.IsRecording();
+	}
+	bool HasActiveTool() const {
 		return !!active_;
 	}
 
@@ -64,16 +70,21 @@ public:
 	void EnterScope(const char *group, const char *name) {
 		if (active_)
 			active_->EnterScope(group, name);
+		if (g_FlightRecorder.IsRecording())
+			g_FlightRecorder.EnterScope(group, name);
 	}
 	void LeaveScope() {
 		if (active_)
 			active_->LeaveScope();
+		if (g_FlightRecorder.IsRecording())
+			g_FlightRecorder.LeaveScope();
 	}
 
 	IProfilingTool *FindToolByName(const char *name);
 
 private:
 	void StartFromConsole(IProfilingTool *tool);
+	void RenderFrameBlockStats(const ICommandArgs *args);
 
 private:
 	std::vector<IProfilingTool *> tools_;
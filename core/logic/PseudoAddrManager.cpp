@@ -29,6 +29,7 @@
 
 #include "PseudoAddrManager.h"
 #include <bridge/include/CoreProvider.h>
+#include <string.h>
 #ifdef PLATFORM_APPLE
 #include <mach/mach.h>
 #include <mach/vm_region.h>
@@ -42,6 +43,7 @@
 
 PseudoAddressManager::PseudoAddressManager() : m_dictionary(am::IPlatform::GetDefault())
 {
+	memset(m_cache, 0, sizeof(m_cache));
 }
 
 void PseudoAddressManager::Initialize() {
@@ -111,7 +113,45 @@ void *PseudoAddressManager::FromPseudoAddress(uint32_t paddr)
 	if (paddr == 0) {
 		return nullptr;
 	}
-	return m_dictionary.RecoverAddress(paddr).value_or(nullptr);
+
+	uint32_t page = paddr >> kPageShift;
+	const CachedPage &entry = m_cache[page & (kCacheSize - 1)];
+	if (entry.base != 0 && entry.page == page) {
+		return reinterpret_cast<void *>(entry.base + (paddr & kPageMask));
+	}
+
+	void *addr = m_dictionary.RecoverAddress(paddr).value_or(nullptr);
+	if (addr != nullptr) {
+		CachePage(paddr);
+	}
+	return addr;
+}
+
+void PseudoAddressManager::CachePage(uint32_t paddr)
+{
+	// Only cache pages that are mapped end to end onto one contiguous real
+	// range; a page straddling two dictionary ranges keeps taking the slow
+	// path. Mappings are never retired, so entries don't need invalidating.
+	uint32_t first = paddr & ~kPageMask;
+	uint32_t last = first | kPageMask;
+	if (first == 0) {
+		return;
+	}
+
+	auto base = m_dictionary.RecoverAddress(first);
+	auto end = m_dictionary.RecoverAddress(last);
+	if (!base || !end) {
+		return;
+	}
+
+	uintptr_t real_base = reinterpret_cast<uintptr_t>(*base);
+	if (reinterpret_cast<uintptr_t>(*end) - real_base != kPageMask) {
+		return;
+	}
+
+	CachedPage &entry = m_cache[(paddr >> kPageShift) & (kCacheSize - 1)];
+	entry.page = paddr >> kPageShift;
+	entry.base = real_base;
 }
 
 uint32_t PseudoAddressManager::ToPseudoAddress(void *addr)
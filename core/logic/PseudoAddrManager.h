@@ -42,7 +42,22 @@ public:
 	uint32_t ToPseudoAddress(void *addr);
 	void Initialize();
 private:
+	void CachePage(uint32_t paddr);
+private:
+	// Direct-mapped cache of pseudo pages that translate linearly, so that
+	// repeated accesses into the same object skip the dictionary walk.
+	static const uint32_t kPageShift = 12;
+	static const uint32_t kPageMask = (1u << kPageShift) - 1;
+	static const size_t kCacheSize = 256;
+
+	struct CachedPage
+	{
+		uint32_t page;
+		uintptr_t base;
+	};
+
 	am::AddressDict m_dictionary;
+	CachedPage m_cache[kCacheSize];
 };
 
 #endif // _INCLUDE_SOURCEMOD_PSEUDOADDRESSMANAGER_H_
@@ -252,7 +252,16 @@ void RootConsoleMenu::OnRootConsoleCommand(const char *cmdname, const ICommandAr
 static bool sm_dump_handles(int client, const ICommandArgs *args)
 {
 	if (args->ArgC() < 2) {
-		bridge->ConsolePrint("Usage: sm_dump_handles <file> or <log> for game logs");
+		bridge->ConsolePrint("Usage: sm_dump_handles <file>, <log> for game logs, or <leaks> for creation sites");
+		return true;
+	}
+
+	if (strcmp(args->Arg(1), "leaks") == 0) {
+		auto write_leaks_to_console = [] (const char *str) -> void
+		{
+			bridge->ConsolePrint("%s", str);
+		};
+		g_HandleSys.DumpLeaks(write_leaks_to_console);
 		return true;
 	}
 
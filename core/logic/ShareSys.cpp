@@ -39,9 +39,13 @@
 #include "common_logic.h"
 #include "PluginSys.h"
 #include "HandleSys.h"
+#include "NativeProfiler.h"
 
 using namespace ke;
 
+/* Number of plugin binaries whose native bindings are remembered. */
+#define SHARESYS_MAX_BINDING_CACHE		1024
+
 ShareSystem g_ShareSys;
 static unsigned int g_mark_serial = 0;
 
@@ -90,6 +94,8 @@ void ShareSystem::OnSourceModShutdown()
 
 	handlesys->RemoveType(m_IfaceType, GetIdentRoot());
 	handlesys->RemoveType(m_TypeRoot, GetIdentRoot());
+
+	m_Bindings.clear();
 }
 
 IdentityType_t ShareSystem::FindIdentType(const char *name)
@@ -275,6 +281,48 @@ void ShareSystem::BeginBindingFor(CPlugin *pPlugin)
 	g_mark_serial++;
 }
 
+ShareSystem::ResolvedNatives &ShareSystem::GetResolvedNatives(IPluginRuntime *pRuntime, uint32_t native_count)
+{
+	/* Plugins are bound several times while loading, and again every time
+	 * they are reloaded, usually with the same binary. Keying by the binary's
+	 * hashes lets all of those reuse one set of lookups.
+	 */
+	char key[65];
+	unsigned char *pCodeHash = pRuntime->GetCodeHash();
+	unsigned char *pDataHash = pRuntime->GetDataHash();
+	for (int i = 0; i < 16; i++)
+	{
+		ke::SafeSprintf(&key[i * 2], 3, "%02x", pCodeHash[i]);
+		ke::SafeSprintf(&key[32 + i * 2], 3, "%02x", pDataHash[i]);
+	}
+
+	StringHashMap<ResolvedNatives>::Insert i = m_Bindings.findForAdd(key);
+	if (!i.found())
+	{
+		/* Old binaries are never removed individually, so just start over
+		 * once a lot of them have built up. */
+		if (m_Bindings.elements() >= SHARESYS_MAX_BINDING_CACHE)
+		{
+			m_Bindings.clear();
+			i = m_Bindings.findForAdd(key);
+		}
+		if (!m_Bindings.add(i, key))
+		{
+			static ResolvedNatives empty;
+			empty.assign(native_count, nullptr);
+			return empty;
+		}
+	}
+
+	ResolvedNatives &resolved = i->value;
+	if (resolved.size() != native_count)
+	{
+		resolved.clear();
+		resolved.resize(native_count);
+	}
+	return resolved;
+}
+
 void ShareSystem::BindNativesToPlugin(CPlugin *pPlugin, bool bCoreOnly)
 {
 	IPluginContext *pContext = pPlugin->GetBaseContext();
@@ -282,6 +330,7 @@ void ShareSystem::BindNativesToPlugin(CPlugin *pPlugin, bool bCoreOnly)
 	BeginBindingFor(pPlugin);
 
 	uint32_t native_count = pContext->GetNativesNum();
+	ResolvedNatives &resolved = GetResolvedNatives(pContext->GetRuntime(), native_count);
 	for (uint32_t i = 0; i < native_count; i++)
 	{
 		const sp_native_t *native = pContext->GetRuntime()->GetNative(i);
@@ -292,8 +341,13 @@ void ShareSystem::BindNativesToPlugin(CPlugin *pPlugin, bool bCoreOnly)
 		if (native->status == SP_NATIVE_BOUND)
 			continue;
 
-		/* Otherwise, the native must be in our cache. */
-		RefPtr<Native> pEntry = FindNative(native->name);
+		/* Otherwise, the native must be in our cache. A previous resolution
+		 * is still good as long as its owner hasn't dropped it, which also
+		 * clears the owner.
+		 */
+		RefPtr<Native> &pEntry = resolved[i];
+		if (!pEntry || !pEntry->owner || strcmp(pEntry->name(), native->name) != 0)
+			pEntry = FindNative(native->name);
 		if (!pEntry)
 			continue;
 
@@ -329,7 +383,7 @@ void ShareSystem::BindNativeToPlugin(CPlugin *pPlugin, const sp_native_t *native
                                      const RefPtr<Native> &pEntry)
 {
 	uint32_t flags = 0;
-	if (pEntry->fake)
+	if (pEntry->fake || pEntry->stub)
 	{
 		/* This native is not necessarily optional, but we don't guarantee
 		 * that its address is long-lived. */
@@ -364,13 +418,51 @@ void ShareSystem::BindNativeToPlugin(CPlugin *pPlugin, const sp_native_t *native
 		}
 	}
 
+	UpdateNativeBinding(pPlugin, index, pEntry, flags);
+}
+
+void ShareSystem::UpdateNativeBinding(CPlugin *pPlugin, uint32_t index, const RefPtr<Native> &pEntry,
+                                      uint32_t flags)
+{
 	auto rt = pPlugin->GetRuntime();
-	if (pEntry->fake)
+	if (g_NativeProfiler.IsEnabled())
+		rt->UpdateNativeBindingObject(index, g_NativeProfiler.Wrap(pPlugin, pEntry), flags, nullptr);
+	else if (pEntry->fake)
 		rt->UpdateNativeBindingObject(index, pEntry->fake->wrapper, flags, nullptr);
+	else if (pEntry->stub)
+		rt->UpdateNativeBindingObject(index, pEntry->stub, flags, nullptr);
 	else
 		rt->UpdateNativeBinding(index, pEntry->native->func, flags, nullptr);
 }
 
+void ShareSystem::RebindNatives()
+{
+	g_PluginSys.ForEachPlugin([this] (CPlugin *pPlugin) -> void {
+		IPluginRuntime *rt = pPlugin->GetRuntime();
+		if (!rt)
+			return;
+
+		uint32_t native_count = pPlugin->GetBaseContext()->GetNativesNum();
+		for (uint32_t i = 0; i < native_count; i++)
+		{
+			const sp_native_t *native = rt->GetNative(i);
+			if (!native || native->status != SP_NATIVE_BOUND)
+				continue;
+
+			RefPtr<Native> pEntry = FindNative(native->name);
+			if (!pEntry || !pEntry->owner)
+				continue;
+
+			/* Same flags as BindNativeToPlugin(), without redoing the dependency bookkeeping. */
+			uint32_t flags = (pEntry->fake || pEntry->stub) ? SP_NTVFLAG_EPHEMERAL : 0;
+			if (pEntry->owner != &g_CoreNatives)
+				flags |= (native->flags & SP_NTVFLAG_OPTIONAL);
+
+			UpdateNativeBinding(pPlugin, i, pEntry, flags);
+		}
+	});
+}
+
 AlreadyRefed<Native> ShareSystem::AddNativeToCache(CNativeOwner *pOwner, const sp_nativeinfo_t *ntv)
 {
 	NativeCache::Insert i = m_NtvCache.findForAdd(ntv->name);
@@ -382,6 +474,17 @@ AlreadyRefed<Native> ShareSystem::AddNativeToCache(CNativeOwner *pOwner, const s
 	return entry.forget();
 }
 
+AlreadyRefed<Native> ShareSystem::AddStubToCache(CNativeOwner *pOwner, const char *name, const RefPtr<INativeCallback> &stub)
+{
+	NativeCache::Insert i = m_NtvCache.findForAdd(name);
+	if (i.found())
+		return nullptr;
+
+	RefPtr<Native> entry = new Native(pOwner, name, stub);
+	m_NtvCache.insert(name, entry);
+	return entry.forget();
+}
+
 void ShareSystem::ClearNativeFromCache(CNativeOwner *pOwner, const char *name)
 {
 	NativeCache::Result r = m_NtvCache.find(name);
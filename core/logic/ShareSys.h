@@ -32,6 +32,7 @@
 #ifndef _INCLUDE_SOURCEMOD_SHARESYSTEM_H_
 #define _INCLUDE_SOURCEMOD_SHARESYSTEM_H_
 
+#include <vector>
 #include <IShareSys.h>
 #include <IHandleSys.h>
 #include <am-string.h>
@@ -54,6 +55,8 @@ namespace SourceMod
 		IdentityType_t type = 0;
 		size_t num_handles = 0;
 		bool warned_handle_usage = false;
+		size_t handle_bytes = 0;		/* Approximate memory held by owned Handles */
+		size_t warned_handle_bytes = 0;	/* handle_bytes at the last soft limit warning */
 	};
 };
 
@@ -126,12 +129,19 @@ public:
 	void BindNativeToPlugin(CPlugin *pPlugin, const ke::RefPtr<Native> &pEntry);
 	ke::AlreadyRefed<Native> AddFakeNative(IPluginFunction *pFunc, const char *name, SPVM_FAKENATIVE_FUNC func);
 	ke::RefPtr<Native> FindNative(const char *name);
+	/* Re-applies every bound native, e.g. after the native profiler is toggled. */
+	void RebindNatives();
 private:
 	ke::AlreadyRefed<Native> AddNativeToCache(CNativeOwner *pOwner, const sp_nativeinfo_t *ntv);
+	ke::AlreadyRefed<Native> AddStubToCache(CNativeOwner *pOwner, const char *name, const ke::RefPtr<INativeCallback> &stub);
 	void ClearNativeFromCache(CNativeOwner *pOwner, const char *name);
 	void BindNativeToPlugin(CPlugin *pPlugin, const sp_native_t *ntv,  uint32_t index, const ke::RefPtr<Native> &pEntry);
+	void UpdateNativeBinding(CPlugin *pPlugin, uint32_t index, const ke::RefPtr<Native> &pEntry, uint32_t flags);
 private:
 	typedef NameHashSet<ke::RefPtr<Native>, Native> NativeCache;
+	typedef std::vector<ke::RefPtr<Native>> ResolvedNatives;
+
+	ResolvedNatives &GetResolvedNatives(IPluginRuntime *pRuntime, uint32_t native_count);
 
 	List<IfaceInfo> m_Interfaces;
 	HandleType_t m_TypeRoot;
@@ -139,6 +149,8 @@ private:
 	HandleType_t m_IfaceType;
 	IdentityType_t m_CoreType;
 	NativeCache m_NtvCache;
+	/* The natives each plugin binary resolved to last time, by binary hash. */
+	StringHashMap<ResolvedNatives> m_Bindings;
 	StringHashMap<Capability> m_caps;
 };
 
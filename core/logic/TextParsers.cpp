@@ -35,9 +35,11 @@
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <limits.h>
 #include "TextParsers.h"
 #include <ILibrarySys.h>
 #include <am-string.h>
+#include "MappedFile.h"
 
 TextParsers g_TextParser;
 ITextParsers *textparsers = &g_TextParser;
@@ -96,8 +98,62 @@ bool FileStreamReader(void *stream, char *buffer, size_t maxlength, unsigned int
 	return (ferror((FILE *)stream) == 0);
 }
 
+/**
+ * Memory mapped files
+ *
+ * The file is mapped copy-on-write and parsed in place, so keys and values are handed to the
+ * listener as pointers into the mapping.  Only the terminators and unescaped strings touch the
+ * pages, and those writes never reach the file on disk.
+ */
+
+struct MappedStream
+{
+	size_t length;
+	bool consumed;
+};
+
+bool MappedStreamReader(void *stream, char *buffer, size_t maxlength, unsigned int *read)
+{
+	MappedStream *ms = (MappedStream *)stream;
+
+	/* The whole file is already sitting in the buffer, so hand it over exactly once. */
+	*read = ms->consumed ? 0 : static_cast<unsigned int>(ms->length);
+	ms->consumed = true;
+
+	return true;
+}
+
+bool TextParsers::ParseMapped_SMC(const char *file, ITextListener_SMC *smc, SMCStates *states, SMCError *result)
+{
+	/* The tokenizer may look two bytes past the end of the file, so those have to be inside the
+	 * last mapped page.
+	 */
+	MappedFile map;
+	if (!map.Open(file, true) || map.length == 0 || map.slack < 2)
+	{
+		return false;
+	}
+
+	MappedStream ms;
+	ms.length = map.length;
+	ms.consumed = false;
+
+	/* One byte past the end is the terminator the reader never writes, and one more keeps a file
+	 * without any newline from being mistaken for an overflowing token.
+	 */
+	*result = ParseBuffer_SMC(&ms, MappedStreamReader, map.base, map.length + 2, smc, states);
+
+	return true;
+}
+
 SMCError TextParsers::ParseFile_SMC(const char *file, ITextListener_SMC *smc, SMCStates *states)
 {
+	SMCError result;
+	if (ParseMapped_SMC(file, smc, states, &result))
+	{
+		return result;
+	}
+
 	FILE *fp = fopen(file, "rt");
 
 	if (!fp)
@@ -110,7 +166,7 @@ SMCError TextParsers::ParseFile_SMC(const char *file, ITextListener_SMC *smc, SM
 		return SMCError_StreamOpen;
 	}
 
-	SMCError result = ParseStream_SMC(fp, FileStreamReader, smc, states);
+	result = ParseStream_SMC(fp, FileStreamReader, smc, states);
 
 	fclose(fp);
 
@@ -124,6 +180,15 @@ SMCError TextParsers::ParseSMCFile(const char *file,
 								   size_t maxsize)
 {
 	const char *errstr;
+	SMCError result;
+
+	if (ParseMapped_SMC(file, smc_listener, states, &result))
+	{
+		errstr = GetSMCErrorString(result);
+		ke::SafeStrcpy(buffer, maxsize, errstr != NULL ? errstr : "Unknown error");
+		return result;
+	}
+
 	FILE *fp = fopen(file, "rt");
 
 	if (fp == NULL)
@@ -139,7 +204,7 @@ SMCError TextParsers::ParseSMCFile(const char *file,
 		return SMCError_StreamOpen;
 	}
 
-	SMCError result = ParseStream_SMC(fp, FileStreamReader, smc_listener, states);
+	result = ParseStream_SMC(fp, FileStreamReader, smc_listener, states);
 
 	fclose(fp);
 
@@ -327,8 +392,19 @@ SMCError TextParsers::ParseStream_SMC(void *stream,
 								   ITextListener_SMC *smc, 
 								   SMCStates *pStates)
 {
-	char *reparse_point = NULL;
 	char in_buf[4096];
+
+	return ParseBuffer_SMC(stream, srdr, in_buf, sizeof(in_buf), smc, pStates);
+}
+
+SMCError TextParsers::ParseBuffer_SMC(void *stream,
+									  STREAMREADER srdr,
+									  char *in_buf,
+									  size_t bufsize,
+									  ITextListener_SMC *smc,
+									  SMCStates *pStates)
+{
+	char *reparse_point = NULL;
 	char *parse_point = in_buf;
 	char *line_begin = in_buf;
 	unsigned int read;
@@ -361,7 +437,7 @@ SMCError TextParsers::ParseStream_SMC(void *stream,
 	 * What makes this particularly annoying is that we cache pointers everywhere, so when 
 	 * the shifting process takes place, all those pointers must be shifted as well.
 	 */
-	while (srdr(stream, parse_point, sizeof(in_buf) - (parse_point - in_buf) - 1, &read))
+	while (srdr(stream, parse_point, bufsize - (parse_point - in_buf) - 1, &read))
 	{
 		if (!read)
 		{
@@ -735,7 +811,7 @@ SMCError TextParsers::ParseStream_SMC(void *stream,
 				parse_point -= bytes;
 			}
 		} 
-		else if (read == sizeof(in_buf) - 1) 
+		else if (read == bufsize - 1) 
 		{
 			err = SMCError_TokenOverflow;
 			goto failed;
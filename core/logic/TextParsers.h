@@ -87,6 +87,18 @@ private:
 		ITextListener_SMC *smc,
 		SMCStates *states);
 
+	SMCError ParseBuffer_SMC(void *stream,
+		STREAMREADER srdr,
+		char *in_buf,
+		size_t bufsize,
+		ITextListener_SMC *smc,
+		SMCStates *states);
+
+	bool ParseMapped_SMC(const char *file,
+		ITextListener_SMC *smc,
+		SMCStates *states,
+		SMCError *result);
+
 };
 
 extern TextParsers g_TextParser;
@@ -0,0 +1,386 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#include "ThreadPool.h"
+#include "ForwardProfiler.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <am-string.h>
+
+ThreadPool g_ThreadPool;
+
+/* Upper bound on the pool size, whether configured or detected. */
+static const unsigned int kMaxPoolThreads = 32;
+
+/* Index of the pool thread we are running on, or -1 off the pool. */
+static thread_local int sWorkerIndex = -1;
+
+ThreadPool::ThreadPool()
+	: pending_(0),
+	  next_queue_(0),
+	  started_(false),
+	  shutdown_(false),
+	  configured_threads_(0)
+{
+}
+
+bool
+ThreadPool::Start()
+{
+	std::lock_guard<std::mutex> lock(wake_lock_);
+	if (shutdown_)
+		return false;
+	if (started_)
+		return true;
+
+	unsigned int count = configured_threads_;
+	if (!count) {
+		// Leave a core for the game's main thread.
+		unsigned int cores = std::thread::hardware_concurrency();
+		count = cores > 1 ? std::min(cores - 1, 8u) : 1;
+	}
+	count = std::min(count, kMaxPoolThreads);
+
+	for (unsigned int i = 0; i < count; i++)
+		queues_.emplace_back(new WorkQueue);
+	for (unsigned int i = 0; i < count; i++)
+		threads_.emplace_back(new std::thread([this, i]() -> void { WorkerMain(i); }));
+
+	started_.store(true, std::memory_order_release);
+	return true;
+}
+
+void
+ThreadPool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(wake_lock_);
+		shutdown_ = true;
+		if (!started_)
+			return;
+	}
+	wake_cv_.notify_all();
+
+	// Running tasks are allowed to finish; queued ones are cancelled below.
+	for (const auto &thread : threads_)
+		thread->join();
+	threads_.clear();
+	started_ = false;
+
+	for (const auto &queue : queues_) {
+		std::deque<Job> jobs;
+		{
+			std::lock_guard<std::mutex> lock(queue->lock);
+			jobs.swap(queue->jobs);
+		}
+		for (const Job &job : jobs)
+			FinishJob(job, true, false, 0, 0);
+	}
+	pending_ = 0;
+
+	std::vector<Completion> done;
+	{
+		std::lock_guard<std::mutex> lock(done_lock_);
+		done.swap(done_);
+	}
+	for (const Completion &entry : done)
+		Deliver(entry);
+}
+
+bool
+ThreadPool::AddTask(IdentityToken_t *owner, IThreadTask *task)
+{
+	if (!task)
+		return false;
+	if (!started_.load(std::memory_order_acquire) && !Start())
+		return false;
+
+	{
+		std::lock_guard<std::mutex> lock(done_lock_);
+		inflight_[owner]++;
+	}
+
+	size_t index;
+	if (sWorkerIndex >= 0)
+		index = size_t(sWorkerIndex);
+	else
+		index = next_queue_++ % queues_.size();
+
+	WorkQueue *queue = queues_[index].get();
+	{
+		std::lock_guard<std::mutex> lock(queue->lock);
+		queue->jobs.push_back(Job{owner, task, ForwardProfiler::Now()});
+		pending_++;
+	}
+
+	// Take the lock so a thread cannot miss the wakeup between checking
+	// pending_ and going to sleep.
+	{
+		std::lock_guard<std::mutex> lock(wake_lock_);
+	}
+	wake_cv_.notify_one();
+	return true;
+}
+
+bool
+ThreadPool::TakeJob(size_t index, Job *job, bool *stolen)
+{
+	WorkQueue *own = queues_[index].get();
+	{
+		std::lock_guard<std::mutex> lock(own->lock);
+		if (!own->jobs.empty()) {
+			*job = own->jobs.front();
+			own->jobs.pop_front();
+			pending_--;
+			*stolen = false;
+			return true;
+		}
+	}
+
+	for (size_t i = 1; i < queues_.size(); i++) {
+		WorkQueue *victim = queues_[(index + i) % queues_.size()].get();
+		std::lock_guard<std::mutex> lock(victim->lock);
+		if (!victim->jobs.empty()) {
+			*job = victim->jobs.back();
+			victim->jobs.pop_back();
+			pending_--;
+			*stolen = true;
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+ThreadPool::WorkerMain(size_t index)
+{
+	sWorkerIndex = int(index);
+
+	for (;;) {
+		Job job;
+		bool stolen;
+		if (TakeJob(index, &job, &stolen)) {
+			int64_t start = ForwardProfiler::Now();
+			job.task->RunTask();
+			int64_t end = ForwardProfiler::Now();
+			FinishJob(job, false, stolen, start - job.queued_at, end - start);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(wake_lock_);
+		wake_cv_.wait(lock, [this]() -> bool {
+			return shutdown_ || pending_.load() > 0;
+		});
+		if (shutdown_)
+			return;
+	}
+}
+
+void
+ThreadPool::FinishJob(const Job &job, bool cancelled, bool stolen, int64_t wait_ns, int64_t run_ns)
+{
+	std::lock_guard<std::mutex> lock(done_lock_);
+	done_.push_back(Completion{job, cancelled, stolen, wait_ns, run_ns});
+
+	auto iter = inflight_.find(job.owner);
+	if (iter != inflight_.end() && --iter->second == 0)
+		inflight_.erase(iter);
+	done_cv_.notify_all();
+}
+
+void
+ThreadPool::Deliver(const Completion &done)
+{
+	TypeStats &stats = stats_[done.job.task->GetTaskType()];
+	if (done.cancelled) {
+		stats.cancelled++;
+	} else {
+		stats.completed++;
+		if (done.stolen)
+			stats.stolen++;
+		stats.wait_ns += done.wait_ns;
+		stats.run_ns += done.run_ns;
+		stats.max_run_ns = std::max(stats.max_run_ns, done.run_ns);
+	}
+
+	done.job.task->OnTaskComplete(done.cancelled);
+}
+
+void
+ThreadPool::RunFrame()
+{
+	if (!started_.load(std::memory_order_relaxed))
+		return;
+
+	std::vector<Completion> done;
+	{
+		std::lock_guard<std::mutex> lock(done_lock_);
+		if (done_.empty())
+			return;
+		done.swap(done_);
+	}
+	for (const Completion &entry : done)
+		Deliver(entry);
+}
+
+unsigned int
+ThreadPool::CancelTasks(IdentityToken_t *owner)
+{
+	if (!started_)
+		return 0;
+
+	unsigned int cancelled = 0;
+	for (const auto &queue : queues_) {
+		std::vector<Job> removed;
+		{
+			std::lock_guard<std::mutex> lock(queue->lock);
+			auto iter = queue->jobs.begin();
+			while (iter != queue->jobs.end()) {
+				if (iter->owner == owner) {
+					removed.push_back(*iter);
+					iter = queue->jobs.erase(iter);
+					pending_--;
+				} else {
+					iter++;
+				}
+			}
+		}
+		for (const Job &job : removed)
+			FinishJob(job, true, false, 0, 0);
+		cancelled += (unsigned int)removed.size();
+	}
+
+	// Wait for anything of the owner's that is still running, then hand
+	// back all of its results now rather than on the next frame.
+	std::vector<Completion> mine;
+	{
+		std::unique_lock<std::mutex> lock(done_lock_);
+		done_cv_.wait(lock, [this, owner]() -> bool {
+			return inflight_.find(owner) == inflight_.end();
+		});
+
+		auto iter = done_.begin();
+		while (iter != done_.end()) {
+			if (iter->job.owner == owner) {
+				mine.push_back(*iter);
+				iter = done_.erase(iter);
+			} else {
+				iter++;
+			}
+		}
+	}
+	for (const Completion &entry : mine)
+		Deliver(entry);
+	return cancelled;
+}
+
+unsigned int
+ThreadPool::GetThreadCount()
+{
+	if (!started_ && !Start())
+		return 0;
+	return (unsigned int)threads_.size();
+}
+
+void
+ThreadPool::OnRootConsoleCommand(const char *cmdname, const ICommandArgs *args)
+{
+	if (args->ArgC() >= 3 && strcmp(args->Arg(2), "reset") == 0) {
+		stats_.clear();
+		rootmenu->ConsolePrint("[SM] Thread pool statistics have been reset.");
+		return;
+	}
+
+	if (!started_) {
+		rootmenu->ConsolePrint("[SM] The thread pool has not been started.");
+		return;
+	}
+
+	size_t inflight = 0;
+	{
+		std::lock_guard<std::mutex> lock(done_lock_);
+		for (const auto &entry : inflight_)
+			inflight += entry.second;
+	}
+	rootmenu->ConsolePrint("[SM] Thread pool: %u threads, %u queued, %u in flight",
+		(unsigned int)threads_.size(), (unsigned int)pending_.load(), (unsigned int)inflight);
+
+	if (stats_.empty())
+		return;
+
+	rootmenu->ConsolePrint("  %-24.24s %10s %9s %8s %12s %12s %10s", "Type", "Done", "Cancelled",
+		"Stolen", "Avg wait ms", "Avg run ms", "Max ms");
+	for (const auto &entry : stats_) {
+		const TypeStats &stats = entry.second;
+		double done = stats.completed ? double(stats.completed) : 1.0;
+		rootmenu->ConsolePrint("  %-24.24s %10llu %9llu %8llu %12.3f %12.3f %10.3f",
+			entry.first.c_str(), (unsigned long long)stats.completed,
+			(unsigned long long)stats.cancelled, (unsigned long long)stats.stolen,
+			double(stats.wait_ns) / done / 1000000.0, double(stats.run_ns) / done / 1000000.0,
+			double(stats.max_run_ns) / 1000000.0);
+	}
+}
+
+ConfigResult
+ThreadPool::OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source,
+                                     char *error, size_t maxlength)
+{
+	if (strcmp(key, "ThreadPoolThreads") != 0)
+		return ConfigResult_Ignore;
+
+	char *end;
+	unsigned long count = strtoul(value, &end, 10);
+	if (!value[0] || *end != '\0' || count > kMaxPoolThreads) {
+		ke::SafeSprintf(error, maxlength, "Invalid value: must be between 0 and %u", kMaxPoolThreads);
+		return ConfigResult_Reject;
+	}
+	if (started_ && count != configured_threads_) {
+		ke::SafeStrcpy(error, maxlength, "The thread pool size cannot be changed after it has started");
+		return ConfigResult_Reject;
+	}
+	configured_threads_ = (unsigned int)count;
+	return ConfigResult_Accept;
+}
+
+void
+ThreadPool::OnSourceModAllInitialized()
+{
+	rootmenu->AddRootConsoleCommand3("threadpool", "Shared thread pool statistics", this);
+}
+
+void
+ThreadPool::OnSourceModShutdown()
+{
+	rootmenu->RemoveRootConsoleCommand("threadpool", this);
+	Stop();
+}
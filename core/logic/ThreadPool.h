@@ -0,0 +1,145 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#ifndef _include_sourcemod_logic_thread_pool_h_
+#define _include_sourcemod_logic_thread_pool_h_
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <IThreader.h>
+#include <IRootConsoleMenu.h>
+#include "common_logic.h"
+
+using namespace SourceMod;
+
+// Shared pool behind IThreader::AddTask. Each thread owns a deque; the main
+// thread deals submissions out round-robin, tasks submitted from a pool
+// thread go to that thread's deque, and idle threads steal from the back of
+// the others. Finished tasks are handed back to the main thread in RunFrame().
+class ThreadPool
+	: public IRootConsoleCommand,
+	  public SMGlobalClass
+{
+public:
+	ThreadPool();
+
+	bool AddTask(IdentityToken_t *owner, IThreadTask *task);
+	unsigned int CancelTasks(IdentityToken_t *owner);
+	unsigned int GetThreadCount();
+
+	// Called once per game frame to deliver completion callbacks.
+	void RunFrame();
+
+	// IRootConsoleCommand
+	void OnRootConsoleCommand(const char *cmdname, const ICommandArgs *args) override;
+
+	// SMGlobalClass
+	ConfigResult OnSourceModConfigChanged(const char *key, const char *value, ConfigSource source,
+	                                      char *error, size_t maxlength) override;
+	void OnSourceModAllInitialized() override;
+	void OnSourceModShutdown() override;
+
+private:
+	struct Job
+	{
+		IdentityToken_t *owner;
+		IThreadTask *task;
+		int64_t queued_at;
+	};
+
+	struct Completion
+	{
+		Job job;
+		bool cancelled;
+		bool stolen;
+		int64_t wait_ns;
+		int64_t run_ns;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex lock;
+		std::deque<Job> jobs;
+	};
+
+	struct TypeStats
+	{
+		uint64_t completed = 0;
+		uint64_t cancelled = 0;
+		uint64_t stolen = 0;
+		int64_t wait_ns = 0;
+		int64_t run_ns = 0;
+		int64_t max_run_ns = 0;
+	};
+
+	bool Start();
+	void Stop();
+	void WorkerMain(size_t index);
+	bool TakeJob(size_t index, Job *job, bool *stolen);
+	void FinishJob(const Job &job, bool cancelled, bool stolen, int64_t wait_ns, int64_t run_ns);
+	void Deliver(const Completion &done);
+
+private:
+	std::vector<std::unique_ptr<WorkQueue>> queues_;
+	std::vector<std::unique_ptr<std::thread>> threads_;
+	std::atomic<size_t> pending_;
+	std::atomic<size_t> next_queue_;
+	std::atomic<bool> started_;
+
+	// Guards starting and stopping the pool, and wakes idle threads.
+	std::mutex wake_lock_;
+	std::condition_variable wake_cv_;
+	bool shutdown_;
+
+	// Tasks that have been submitted but not yet handed back, per owner.
+	std::mutex done_lock_;
+	std::condition_variable done_cv_;
+	std::vector<Completion> done_;
+	std::unordered_map<IdentityToken_t *, unsigned int> inflight_;
+
+	// Only touched on the main thread.
+	std::map<std::string, TypeStats> stats_;
+	unsigned int configured_threads_;
+};
+
+extern ThreadPool g_ThreadPool;
+
+#endif // _include_sourcemod_logic_thread_pool_h_
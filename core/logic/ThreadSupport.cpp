@@ -39,6 +39,8 @@
 #include <mutex>
 #include <thread>
 #include "BaseWorker.h"
+#include "DataPackTask.h"
+#include "ThreadPool.h"
 #include "ThreadSupport.h"
 #include "common_logic.h"
 
@@ -462,6 +464,11 @@ public:
 	IEventSignal *MakeEventSignal() override;
 	IThreadWorker *MakeWorker(IThreadWorkerCallbacks *hooks, bool threaded) override;
 	void DestroyWorker(IThreadWorker *pWorker) override;
+	bool AddTask(IdentityToken_t *owner, IThreadTask *task) override;
+	bool AddDataPackTask(IdentityToken_t *owner, Handle_t pack, IdentityToken_t *packOwner,
+		IDataPackTask *task, HandleError *err) override;
+	unsigned int CancelTasks(IdentityToken_t *owner) override;
+	unsigned int GetPoolThreadCount() override;
 } sCompatThreader;
 
 void CompatThreader::MakeThread(IThread *pThread)
@@ -540,6 +547,27 @@ void CompatThreader::DestroyWorker(IThreadWorker *pWorker)
 	delete pWorker;
 }
 
+bool CompatThreader::AddTask(IdentityToken_t *owner, IThreadTask *task)
+{
+	return g_ThreadPool.AddTask(owner, task);
+}
+
+bool CompatThreader::AddDataPackTask(IdentityToken_t *owner, Handle_t pack, IdentityToken_t *packOwner,
+	IDataPackTask *task, HandleError *err)
+{
+	return ::AddDataPackTask(owner, pack, packOwner, task, err);
+}
+
+unsigned int CompatThreader::CancelTasks(IdentityToken_t *owner)
+{
+	return g_ThreadPool.CancelTasks(owner);
+}
+
+unsigned int CompatThreader::GetPoolThreadCount()
+{
+	return g_ThreadPool.GetThreadCount();
+}
+
 IThreader *g_pThreader = &sCompatThreader;
 
 class RegThreadStuff : public SMGlobalClass
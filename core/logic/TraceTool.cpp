@@ -0,0 +1,310 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "TraceTool.h"
+#include "ProfileTools.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+#include <ISourceMod.h>
+
+TraceTool g_TraceTool;
+
+static inline int64_t
+Now()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void
+WriteJsonString(FILE *fp, const char *str)
+{
+	fputc('"', fp);
+	for (const char *p = str; *p; p++) {
+		unsigned char c = (unsigned char)*p;
+		if (c == '"' || c == '\\')
+			fprintf(fp, "\\%c", c);
+		else if (c < 0x20)
+			fprintf(fp, "\\u%04x", c);
+		else
+			fputc(c, fp);
+	}
+	fputc('"', fp);
+}
+
+TraceTool::TraceTool()
+	: active_(false),
+	  head_(0),
+	  count_(0)
+{
+}
+
+void
+TraceTool::OnSourceModAllInitialized()
+{
+	g_ProfileToolManager.RegisterTool(this);
+	pluginsys->AddPluginsListener(this);
+}
+
+void
+TraceTool::OnSourceModShutdown()
+{
+	pluginsys->RemovePluginsListener(this);
+}
+
+const char *
+TraceTool::Name()
+{
+	return "trace";
+}
+
+const char *
+TraceTool::Description()
+{
+	return "Built-in tracer (Chrome trace and flamegraph output)";
+}
+
+bool
+TraceTool::Start()
+{
+	if (!ring_)
+		ring_.reset(new Event[kRingSize]);
+
+	head_ = 0;
+	count_ = 0;
+	strings_.clear();
+	interned_.clear();
+	main_thread_ = std::this_thread::get_id();
+	active_ = true;
+	return true;
+}
+
+void
+TraceTool::Stop(void (*render)(const char *fmt, ...))
+{
+	active_ = false;
+
+	std::string json, folded;
+	if (Write(&json, &folded)) {
+		render("Wrote %u trace events to:", unsigned(count_));
+		render("  %s", json.c_str());
+		render("  %s", folded.c_str());
+	}
+
+	ring_ = nullptr;
+	strings_.clear();
+	interned_.clear();
+}
+
+void
+TraceTool::Dump()
+{
+	std::string json, folded;
+	if (!Write(&json, &folded))
+		return;
+
+	rootmenu->ConsolePrint("Wrote %u trace events to:", unsigned(count_));
+	rootmenu->ConsolePrint("  %s", json.c_str());
+	rootmenu->ConsolePrint("  %s", folded.c_str());
+}
+
+bool
+TraceTool::IsActive()
+{
+	return active_;
+}
+
+bool
+TraceTool::IsAttached()
+{
+	return true;
+}
+
+uint32_t
+TraceTool::Intern(const char *str)
+{
+	// Names are usually long-lived VM strings, so the pointer is a good key.
+	// Plugins can reuse a buffer for different profiling event names though,
+	// so confirm the contents before trusting a hit.
+	auto iter = interned_.find(str);
+	if (iter != interned_.end() && strings_[iter->second] == str)
+		return iter->second;
+
+	uint32_t id = uint32_t(strings_.size());
+	strings_.emplace_back(str);
+	interned_[str] = id;
+	return id;
+}
+
+void
+TraceTool::EnterScope(const char *group, const char *name)
+{
+	if (!active_ || std::this_thread::get_id() != main_thread_)
+		return;
+
+	Event &event = ring_[head_];
+	event.ts = Now();
+	event.name = Intern(name ? name : "<unknown>");
+	event.group = Intern(group ? group : "other");
+
+	head_ = (head_ + 1) & (kRingSize - 1);
+	if (count_ < kRingSize)
+		count_++;
+}
+
+void
+TraceTool::LeaveScope()
+{
+	if (!active_ || std::this_thread::get_id() != main_thread_)
+		return;
+
+	Event &event = ring_[head_];
+	event.ts = Now();
+	event.name = kLeave;
+	event.group = 0;
+
+	head_ = (head_ + 1) & (kRingSize - 1);
+	if (count_ < kRingSize)
+		count_++;
+}
+
+void
+TraceTool::OnPluginUnloaded(IPlugin *plugin)
+{
+	// The plugin's strings are about to go away; copies stay in strings_.
+	interned_.clear();
+}
+
+bool
+TraceTool::Write(std::string *json_path, std::string *folded_path)
+{
+	if (!ring_ || !count_) {
+		rootmenu->ConsolePrint("No trace events have been recorded.");
+		return false;
+	}
+
+	char stamp[64];
+	time_t t = g_pSM->GetAdjustedTime();
+	strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", localtime(&t));
+
+	char path[PLATFORM_MAX_PATH];
+	g_pSM->BuildPath(Path_SM, path, sizeof(path), "logs/trace_%s.json", stamp);
+	*json_path = path;
+	g_pSM->BuildPath(Path_SM, path, sizeof(path), "logs/trace_%s.folded", stamp);
+	*folded_path = path;
+
+	FILE *fp = fopen(json_path->c_str(), "wt");
+	if (!fp) {
+		rootmenu->ConsolePrint("Failed to open \"%s\" for writing.", json_path->c_str());
+		return false;
+	}
+
+	struct Frame
+	{
+		const Event *enter;
+		int64_t children;
+		size_t path_len;
+	};
+	std::vector<Frame> stack;
+	std::string stack_path;
+	std::unordered_map<std::string, int64_t> folded;
+
+	size_t start = (head_ + kRingSize - count_) & (kRingSize - 1);
+	int64_t base = ring_[start].ts;
+	int64_t last = base;
+	bool first = true;
+
+	auto close = [&](int64_t ts) -> void {
+		Frame frame = stack.back();
+		stack.pop_back();
+
+		int64_t dur = ts - frame.enter->ts;
+		folded[stack_path] += dur - frame.children;
+		stack_path.resize(frame.path_len);
+		if (!stack.empty())
+			stack.back().children += dur;
+
+		fprintf(fp, "%s\n{\"name\":", first ? "" : ",");
+		WriteJsonString(fp, strings_[frame.enter->name].c_str());
+		fprintf(fp, ",\"cat\":");
+		WriteJsonString(fp, strings_[frame.enter->group].c_str());
+		fprintf(fp, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":0}",
+			double(frame.enter->ts - base) / 1e3, double(dur) / 1e3);
+		first = false;
+	};
+
+	fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	for (size_t i = 0; i < count_; i++) {
+		const Event *event = &ring_[(start + i) & (kRingSize - 1)];
+		last = event->ts;
+
+		if (event->name != kLeave) {
+			stack.push_back(Frame{event, 0, stack_path.size()});
+			if (!stack_path.empty())
+				stack_path.push_back(';');
+			stack_path.append(strings_[event->name]);
+		} else if (!stack.empty()) {
+			close(event->ts);
+		}
+		// A leave with no matching enter belongs to a scope that was
+		// overwritten in the ring buffer; drop it.
+	}
+	while (!stack.empty())
+		close(last);
+	fprintf(fp, "\n]}\n");
+	fclose(fp);
+
+	fp = fopen(folded_path->c_str(), "wt");
+	if (!fp) {
+		rootmenu->ConsolePrint("Failed to open \"%s\" for writing.", folded_path->c_str());
+		return false;
+	}
+	for (const auto &entry : folded) {
+		// flamegraph.pl wants integer sample counts; use microseconds.
+		long long us = (long long)(entry.second / 1000);
+		if (us > 0)
+			fprintf(fp, "%s %lld\n", entry.first.c_str(), us);
+	}
+	fclose(fp);
+	return true;
+}
+
+void
+TraceTool::RenderHelp(void (*render)(const char *fmt, ...))
+{
+	render("The trace tool records every profiled scope (plugin callbacks, natives, forwards,");
+	render("timers and profiling events) and writes two files to logs/ on stop or dump:");
+	render("  trace_<time>.json    - open in chrome://tracing or https://ui.perfetto.dev");
+	render("  trace_<time>.folded  - feed to flamegraph.pl or speedscope");
+	render("Only the most recent %u events are kept.", unsigned(kRingSize));
+}
@@ -0,0 +1,108 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _include_sourcemod_logic_trace_tool_h_
+#define _include_sourcemod_logic_trace_tool_h_
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sp_vm_api.h>
+#include <IPluginSys.h>
+#include "common_logic.h"
+
+using namespace SourcePawn;
+using namespace SourceMod;
+
+// Built-in profiling tool that records every scope into a fixed-size ring
+// buffer. On stop it writes a Chrome Trace Event file (chrome://tracing,
+// Perfetto) and a folded-stack file (flamegraph.pl, speedscope) to logs/.
+//
+// Only scopes entered on the main thread are recorded. The ring buffer is
+// single-producer and lock-free; when it fills up the oldest events are
+// overwritten.
+class TraceTool
+	: public IProfilingTool,
+	  public IPluginsListener,
+	  public SMGlobalClass
+{
+public:
+	TraceTool();
+
+	// IProfilingTool
+	const char *Name() override;
+	const char *Description() override;
+	bool Start() override;
+	void Stop(void (*render)(const char *fmt, ...)) override;
+	void Dump() override;
+	bool IsActive() override;
+	bool IsAttached() override;
+	void EnterScope(const char *group, const char *name) override;
+	void LeaveScope() override;
+	void RenderHelp(void (*render)(const char *fmt, ...)) override;
+
+	// IPluginsListener
+	void OnPluginUnloaded(IPlugin *plugin) override;
+
+	// SMGlobalClass
+	void OnSourceModAllInitialized() override;
+	void OnSourceModShutdown() override;
+
+private:
+	struct Event
+	{
+		int64_t ts;
+		uint32_t name;			// kLeave for a LeaveScope() event
+		uint32_t group;
+	};
+
+	static const size_t kRingSize = 1 << 19;
+	static const uint32_t kLeave = UINT32_MAX;
+
+	uint32_t Intern(const char *str);
+	bool Write(std::string *json_path, std::string *folded_path);
+
+private:
+	bool active_;
+	std::thread::id main_thread_;
+	std::unique_ptr<Event[]> ring_;
+	size_t head_;
+	size_t count_;
+	std::vector<std::string> strings_;
+	std::unordered_map<const char *, uint32_t> interned_;
+};
+
+extern TraceTool g_TraceTool;
+
+#endif // _include_sourcemod_logic_trace_tool_h_
@@ -41,6 +41,8 @@
 #include "PhraseCollection.h"
 #include "stringutil.h"
 #include "sprintf.h"
+#include "GameDataCache.h"
+#include "FrameScheduler.h"
 #include <am-string.h>
 #include <bridge/include/ILogger.h>
 #include <bridge/include/CoreProvider.h>
@@ -73,6 +75,7 @@ CPhraseFile::CPhraseFile(Translator *pTranslator, const char *file)
 	m_LangCount = pTranslator->GetLanguageCount();
 	m_File.assign(file);
 	m_pTranslator = pTranslator;
+	m_OnlyLang = -1;
 }
 
 CPhraseFile::~CPhraseFile()
@@ -92,6 +95,12 @@ void CPhraseFile::ParseError(const char *message, ...)
 
 void CPhraseFile::ParseWarning(const char *message, ...)
 {
+	/* Already reported when the base file was first parsed. */
+	if (m_OnlyLang != -1)
+	{
+		return;
+	}
+
 	char buffer[1024];
 	va_list ap;
 	va_start(ap, message);
@@ -107,6 +116,25 @@ void CPhraseFile::ParseWarning(const char *message, ...)
 	logger->LogError("[SM] %s", buffer);
 }
 
+void CPhraseFile::BuildBasePath(char *path, size_t maxlength)
+{
+	g_pSM->BuildPath(Path_SM, path, maxlength, "translations/%s", m_File.c_str());
+
+	//backwards compatibility shim
+	/* :HACKHACK: Change .cfg/.txt and vice versa for compatibility */
+	if (!libsys->PathExists(path))
+	{
+		if (m_File.compare("common.cfg") == 0)
+		{
+			UTIL_ReplaceAll(path, maxlength, "common.cfg", "common.phrases.txt", true);
+		} else if (strstr(path, ".cfg")) {
+			UTIL_ReplaceAll(path, maxlength, ".cfg", ".txt", true);
+		} else if (strstr(path, ".txt")) {
+			UTIL_ReplaceAll(path, maxlength, ".txt", ".cfg", true);
+		}
+	}
+}
+
 void CPhraseFile::ReparseFile()
 {
 	m_PhraseLookup.clear();
@@ -118,75 +146,83 @@ void CPhraseFile::ReparseFile()
 		return;
 	}
 
-	SMCError err;
+	/* Inline translations are only kept for languages that are materialized. */
 	char path[PLATFORM_MAX_PATH];
-	g_pSM->BuildPath(Path_SM, path, PLATFORM_MAX_PATH, "translations/%s", m_File.c_str());
+	BuildBasePath(path, sizeof(path));
+	ParseTranslationFile(path, m_File.c_str());
 
-	//backwards compatibility shim
-	/* :HACKHACK: Change .cfg/.txt and vice versa for compatibility */
-	if (!libsys->PathExists(path))
+	/* Other languages are only loaded once something actually uses them. */
+	for (unsigned int i = 1; i < m_LangCount; i++)
 	{
-		if (m_File.compare("common.cfg") == 0)
+		if (m_pTranslator->IsLanguageMaterialized(i))
 		{
-			UTIL_ReplaceAll(path, sizeof(path), "common.cfg", "common.phrases.txt", true);
-		} else if (strstr(path, ".cfg")) {
-			UTIL_ReplaceAll(path, sizeof(path), ".cfg", ".txt", true);
-		} else if (strstr(path, ".txt")) {
-			UTIL_ReplaceAll(path, sizeof(path), ".txt", ".cfg", true);
+			LoadLanguageFile(i);
 		}
 	}
+}
 
-	SMCStates states;
-
-	if ((err=textparsers->ParseFile_SMC(path, this, &states)) != SMCError_Okay)
+void CPhraseFile::LoadLanguage(unsigned int lang_id)
+{
+	if (lang_id >= m_LangCount)
 	{
-		const char *msg = textparsers->GetSMCErrorString(err);
-		if (!msg)
-		{
-			msg = m_ParseError.c_str();
-		}
-
-		logger->LogError("[SM] Fatal error encountered parsing translation file \"%s\"", m_File.c_str());
-		logger->LogError("[SM] Error (line %d, column %d): %s", states.line, states.col, msg);
+		return;
 	}
 
+	/* Pick up this language's inline translations from the base file, which were
+	 * skipped while it was not materialized. Phrases and formats already exist. */
+	char path[PLATFORM_MAX_PATH];
+	BuildBasePath(path, sizeof(path));
+	m_OnlyLang = (int)lang_id;
+	ParseTranslationFile(path, m_File.c_str());
+	m_OnlyLang = -1;
+
+	LoadLanguageFile(lang_id);
+}
+
+void CPhraseFile::LoadLanguageFile(unsigned int lang_id)
+{
 	const char *code;
-	for (unsigned int i = 1; i < m_LangCount; i++)
+	if (lang_id >= m_LangCount || !m_pTranslator->GetLanguageInfo(lang_id, &code, NULL))
 	{
-		if (!m_pTranslator->GetLanguageInfo(i, &code, NULL))
-		{
-			continue;
-		}
+		return;
+	}
 
-		g_pSM->BuildPath(Path_SM, 
-			path,
-			PLATFORM_MAX_PATH,
-			"translations/%s/%s",
-			code,
-			m_File.c_str());
+	char path[PLATFORM_MAX_PATH];
+	g_pSM->BuildPath(Path_SM, 
+		path,
+		PLATFORM_MAX_PATH,
+		"translations/%s/%s",
+		code,
+		m_File.c_str());
+
+	/* Speculatively load these. */
+	if (!libsys->PathExists(path))
+	{
+		return;
+	}
 
-		/* Speculatively load these. */
-		if (!libsys->PathExists(path))
-		{
-			continue;
-		}
+	char name[PLATFORM_MAX_PATH];
+	ke::SafeSprintf(name, sizeof(name), "%s/%s", code, m_File.c_str());
 
-		if ((err=textparsers->ParseFile_SMC(path, this, &states)) != SMCError_Okay)
-		{
-			const char *msg = textparsers->GetSMCErrorString(err);
-			if (!msg)
-			{
-				msg = m_ParseError.c_str();
-			}
+	ParseTranslationFile(path, name);
+}
 
-			logger->LogError("[SM] Fatal error encountered parsing translation file \"%s/%s\"", 
-				code, 
-				m_File.c_str());
-			logger->LogError("[SM] Error (line %d, column %d): %s",
-				states.line,
-				states.col,
-				msg);
+void CPhraseFile::ParseTranslationFile(const char *path, const char *name)
+{
+	SMCError err;
+	SMCStates states;
+	char error[256];
+
+	if ((err=ParseCachedSMCFile("translation_cache", path, this, &states, error, sizeof(error))) != SMCError_Okay)
+	{
+		const char *msg = textparsers->GetSMCErrorString(err);
+		if (!msg)
+		{
+			msg = m_ParseError.c_str();
 		}
+
+		logger->LogError("[SM] Fatal error encountered parsing translation file \"%s\"", name);
+		logger->LogError("[SM] Error (line %d, column %d): %s", states.line, states.col, msg);
 	}
 }
 
@@ -487,6 +523,13 @@ SMCResult CPhraseFile::ReadSMC_KeyValue(const SMCStates *states, const char *key
 			return SMCResult_Continue;
 		}
 
+		/* Languages nobody uses are left out until MaterializeLanguage() asks for them. */
+		if ((m_OnlyLang != -1 && lang != (unsigned int)m_OnlyLang)
+			|| !m_pTranslator->IsLanguageMaterialized(lang))
+		{
+			return SMCResult_Continue;
+		}
+
 		/* See how many bytes we need for this string, then allocate.
 		 * NOTE: THIS SHOULD GUARANTEE THAT WE DO NOT NEED TO NEED TO SIZE CHECK 
 		 */
@@ -687,7 +730,7 @@ const char *CPhraseFile::GetFilename()
  ** MAIN TRANSLATOR CODE **
  **************************/
 
-Translator::Translator() : m_ServerLang(SOURCEMOD_LANGUAGE_ENGLISH)
+Translator::Translator() : m_ServerLang(SOURCEMOD_LANGUAGE_ENGLISH), m_Generation(0)
 {
 	m_pStringTab = new BaseStringTable(2048);
 	strncopy(m_InitialLang, "en", sizeof(m_InitialLang));
@@ -726,6 +769,8 @@ ConfigResult Translator::OnSourceModConfigChanged(const char *key,
 			}
 
 			m_ServerLang = index;
+			MaterializeLanguage(index);
+			OnPhrasesChanged();
 		} else {
 			strncopy(m_InitialLang, value, sizeof(m_InitialLang));
 		}
@@ -736,11 +781,40 @@ ConfigResult Translator::OnSourceModConfigChanged(const char *key,
 	return ConfigResult_Ignore;
 }
 
+static void DeferredLanguageRebuild(void *data)
+{
+	((Translator *)data)->RebuildLanguageDatabase();
+}
+
 void Translator::OnSourceModLevelChange(const char *mapName)
 {
+	/* The phrases from the last map stay usable until the rebuild runs. */
+	if (g_FrameScheduler.DeferLevelWork() && !m_Languages.empty())
+	{
+		g_FrameScheduler.CancelTasks(g_pCoreIdent, DeferredLanguageRebuild);
+		g_FrameScheduler.AddTask(g_pCoreIdent, FrameTask_Normal, DeferredLanguageRebuild, this);
+		return;
+	}
+
 	RebuildLanguageDatabase();
 }
 
+bool Translator::HasPreloadWork()
+{
+	return true;
+}
+
+void Translator::OnSourceModPreload()
+{
+	/* English phrase files are always parsed, so compile them ahead of time. */
+	PrecompileSMCFolder("translation_cache", "translations", false);
+}
+
+const char *Translator::GetGlobalClassName()
+{
+	return "Translator";
+}
+
 void Translator::OnSourceModAllInitialized()
 {
 	AddLanguage("en", "English");
@@ -755,6 +829,7 @@ void Translator::OnSourceModAllInitialized()
 	g_pCorePhrases->AddPhraseFile("core.phrases");
 
 	sharesys->AddInterface(NULL, this);
+	playerhelpers->AddClientListener(this);
 
 	auto sm_reload_translations = [this] (int client, const ICommandArgs *args) -> bool {
 		RebuildLanguageDatabase();
@@ -766,9 +841,44 @@ void Translator::OnSourceModAllInitialized()
 
 void Translator::OnSourceModShutdown()
 {
+	playerhelpers->RemoveClientListener(this);
 	g_pCorePhrases->Destroy();
 }
 
+void Translator::OnClientConnected(int client)
+{
+	MaterializeLanguage(GetClientLanguage(client));
+}
+
+void Translator::OnClientSettingsChanged(int client)
+{
+	MaterializeLanguage(GetClientLanguage(client));
+}
+
+bool Translator::IsLanguageMaterialized(unsigned int index)
+{
+	return index < m_Materialized.size() && m_Materialized[index];
+}
+
+void Translator::MaterializeLanguage(unsigned int index)
+{
+	if (index >= m_Materialized.size() || m_Materialized[index])
+	{
+		return;
+	}
+
+	/* Loading can grow the string table, so this must never be reached while a
+	 * translation returned by a lookup is still being formatted.
+	 */
+	m_Materialized[index] = true;
+	OnPhrasesChanged();
+
+	for (size_t i=0; i<m_Files.size(); i++)
+	{
+		m_Files[i]->LoadLanguage(index);
+	}
+}
+
 bool Translator::GetLanguageByCode(const char *code, unsigned int *index)
 {
 	return m_LCodeLookup.retrieve(code, index);
@@ -817,6 +927,7 @@ unsigned int Translator::FindOrAddPhraseFile(const char *phrase_file)
 	m_Files.push_back(pFile);
 
 	pFile->ReparseFile();
+	OnPhrasesChanged();
 
 	return idx;
 }
@@ -824,6 +935,7 @@ unsigned int Translator::FindOrAddPhraseFile(const char *phrase_file)
 void Translator::RebuildLanguageDatabase()
 {
 	/* Erase everything we have */
+	OnPhrasesChanged();
 	m_LCodeLookup.clear();
 	m_LAliases.clear();
 	m_pStringTab->Reset();
@@ -865,6 +977,23 @@ void Translator::RebuildLanguageDatabase()
 		logger->LogError("[SM] Fatal error, no languages found! Translation will not work.");
 	}
 
+	/* Only the server's language and whatever connected clients use get loaded up front. */
+	m_Materialized.clear();
+	for (size_t i=0; i<m_Languages.size(); i++)
+	{
+		m_Materialized.push_back(i == SOURCEMOD_LANGUAGE_ENGLISH || i == m_ServerLang);
+	}
+
+	int maxClients = playerhelpers->GetMaxClients();
+	for (int i = 1; i <= maxClients; i++)
+	{
+		IGamePlayer *pPlayer = playerhelpers->GetGamePlayer(i);
+		if (pPlayer && pPlayer->IsConnected() && pPlayer->GetLanguageId() < m_Materialized.size())
+		{
+			m_Materialized[pPlayer->GetLanguageId()] = true;
+		}
+	}
+
 	for (size_t i=0; i<m_Files.size(); i++)
 	{
 		m_Files[i]->ReparseFile();
@@ -39,6 +39,7 @@
 #include "sm_memtable.h"
 #include "ITextParsers.h"
 #include <ITranslator.h>
+#include <IPlayerHelpers.h>
 #include "PhraseCollection.h"
 
 /* :TODO: write a templatized version of tries? */
@@ -69,6 +70,7 @@ public:
 	~CPhraseFile();
 public:
 	void ReparseFile();
+	void LoadLanguage(unsigned int lang_id);
 	const char *GetFilename();
 	TransError GetTranslation(const char *szPhrase, unsigned int lang_id, Translation *pTrans);
 	bool TranslationPhraseExists(const char *phrase);
@@ -81,6 +83,9 @@ public: //ITextListener_SMC
 private:
 	void ParseError(const char *message, ...);
 	void ParseWarning(const char *message, ...);
+	void ParseTranslationFile(const char *path, const char *name);
+	void BuildBasePath(char *path, size_t maxlength);
+	void LoadLanguageFile(unsigned int lang_id);
 private:
 	StringHashMap<int> m_PhraseLookup;
 	String m_File;
@@ -93,12 +98,14 @@ private:
 	String m_ParseError;
 	String m_LastPhraseString;
 	bool m_FileLogged;
+	int m_OnlyLang;		/* While re-reading the base file for one language, that language; else -1 */
 };
 
 class Translator : 
 	public ITextListener_SMC,
 	public SMGlobalClass,
-	public ITranslator
+	public ITranslator,
+	public IClientListener
 {
 public:
 	Translator();
@@ -109,9 +116,15 @@ public: // SMGlobalClass
 		ConfigSource source, 
 		char *error, 
 		size_t maxlength);
+	bool HasPreloadWork();
+	void OnSourceModPreload();
 	void OnSourceModAllInitialized();
 	void OnSourceModLevelChange(const char *mapName);
 	void OnSourceModShutdown();
+	const char *GetGlobalClassName();
+public: // IClientListener
+	void OnClientConnected(int client);
+	void OnClientSettingsChanged(int client);
 public: // ITextListener_SMC
 	void ReadSMC_ParseStart();
 	SMCResult ReadSMC_NewSection(const SMCStates *states, const char *name);
@@ -124,6 +137,18 @@ public:
 	bool GetLanguageByCode(const char *code, unsigned int *index);
 	bool GetLanguageByName(const char *name, unsigned int *index);
 	CPhraseFile *GetFileByIndex(unsigned int index);
+	bool IsLanguageMaterialized(unsigned int index);
+	void MaterializeLanguage(unsigned int index);
+
+	/* Bumped whenever a phrase lookup could start resolving differently. */
+	inline unsigned int GetGeneration() const
+	{
+		return m_Generation;
+	}
+	inline void OnPhrasesChanged()
+	{
+		m_Generation++;
+	}
 public: //ITranslator
 	unsigned int GetServerLanguage();
 	unsigned int GetClientLanguage(int client);
@@ -154,6 +179,7 @@ private:
 private:
 	CVector<Language *> m_Languages;
 	CVector<CPhraseFile *> m_Files;
+	CVector<bool> m_Materialized;
 	BaseStringTable *m_pStringTab;
 	StringHashMap<unsigned int> m_LCodeLookup;
 	StringHashMap<unsigned int> m_LAliases;
@@ -161,6 +187,7 @@ private:
 	String m_CustomError;
 	unsigned int m_ServerLang;
 	char m_InitialLang[4];
+	unsigned int m_Generation;
 };
 
 /* Nice little wrapper to handle error logging and whatnot */
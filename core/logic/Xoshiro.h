@@ -0,0 +1,109 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#ifndef _include_sourcemod_logic_xoshiro_h_
+#define _include_sourcemod_logic_xoshiro_h_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// xoshiro256** by Blackman and Vigna. Four words of state, a few shifts and
+// rotates per output, and a period of 2^256-1; much cheaper than MTRand and
+// small enough to hand out per-Handle.
+class Xoshiro256
+{
+public:
+	explicit Xoshiro256(uint64_t seed = 0) {
+		Seed(seed);
+	}
+
+	// Expands a 64-bit seed with splitmix64, which never yields the all-zero
+	// state xoshiro cannot leave.
+	void Seed(uint64_t seed) {
+		for (size_t i = 0; i < 4; i++)
+			s_[i] = SplitMix(&seed);
+	}
+
+	uint64_t Next() {
+		uint64_t result = Rotl(s_[1] * 5, 7) * 9;
+		uint64_t t = s_[1] << 17;
+		s_[2] ^= s_[0];
+		s_[3] ^= s_[1];
+		s_[1] ^= s_[2];
+		s_[0] ^= s_[3];
+		s_[2] ^= t;
+		s_[3] = Rotl(s_[3], 45);
+		return result;
+	}
+
+	uint32_t Next32() {
+		return uint32_t(Next() >> 32);
+	}
+
+	// Uniform in [0, 1), using the top 24 bits so every value is exact.
+	float NextFloat() {
+		return float(Next() >> 40) * (1.0f / 16777216.0f);
+	}
+
+	// Uniform in [0, range), without modulo bias (Lemire's method). A range
+	// of 0 means the full 32-bit range.
+	uint32_t Below(uint32_t range) {
+		if (range == 0)
+			return Next32();
+		uint64_t m = uint64_t(Next32()) * range;
+		uint32_t low = uint32_t(m);
+		if (low < range) {
+			uint32_t threshold = uint32_t(-range) % range;
+			while (low < threshold) {
+				m = uint64_t(Next32()) * range;
+				low = uint32_t(m);
+			}
+		}
+		return uint32_t(m >> 32);
+	}
+
+private:
+	static uint64_t Rotl(uint64_t x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+	static uint64_t SplitMix(uint64_t *x) {
+		uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+
+private:
+	uint64_t s_[4];
+};
+
+#endif // _include_sourcemod_logic_xoshiro_h_
@@ -52,6 +52,10 @@
 #include "ProfileTools.h"
 #include "Logger.h"
 #include "frame_tasks.h"
+#include "FrameScheduler.h"
+#include "ThreadPool.h"
+#include "MetricsExporter.h"
+#include "FlightRecorder.h"
 #include "sprintf.h"
 #include "LibrarySys.h"
 #include "RootConsoleMenu.h"
@@ -158,9 +162,37 @@ static const char* GetEntityLumpString()
 	return g_strMapEntities.c_str();
 }
 
+static void SetSuspendedForwards(const char *names)
+{
+	g_Forwards.SetSuspendedForwards(names);
+}
+
+static bool IsProfilingActive()
+{
+	return g_ProfileToolManager.IsActive();
+}
+
+static void EnterProfileScope(const char *group, const char *name)
+{
+	g_ProfileToolManager.EnterScope(group, name);
+}
+
+static void LeaveProfileScope()
+{
+	g_ProfileToolManager.LeaveScope();
+}
+
+static void MaterializeLanguage(unsigned int langid)
+{
+	g_Translator.MaterializeLanguage(langid);
+}
+
 // Defined in smn_filesystem.cpp.
 extern bool OnLogPrint(const char *msg);
 
+// Defined in smn_adt_trie.cpp.
+extern IContainerBridge *const g_pContainerBridge;
+
 class ProviderCallbackListener : public IProviderCallbacks
 {
 public:
@@ -169,6 +201,10 @@ public:
 	}
 	void OnThink(bool simulating) override {
 		RunScheduledFrameTasks(simulating);
+		g_FrameScheduler.RunFrame();
+		g_ThreadPool.RunFrame();
+		g_MetricsExporter.OnFrame();
+		g_FlightRecorder.OnFrame();
 	}
 } sProviderCallbackListener;
 
@@ -196,6 +232,11 @@ static sm_logic_t logic =
 	SetEntityLumpWritable,
 	ParseEntityLumpString,
 	GetEntityLumpString,
+	SetSuspendedForwards,
+	IsProfilingActive,
+	EnterProfileScope,
+	LeaveProfileScope,
+	MaterializeLanguage,
 	&g_PluginSys,
 	&g_ShareSys,
 	&g_Extensions,
@@ -206,6 +247,7 @@ static sm_logic_t logic =
 	&g_Logger,
 	&g_RootMenu,
 	&sProviderCallbackListener,
+	g_pContainerBridge,
 	-1.0f
 };
 
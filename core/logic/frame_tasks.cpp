@@ -33,6 +33,18 @@ using namespace SourceMod;
 std::vector<ke::Function<void()>> sNextTasks;
 std::vector<ke::Function<void()>> sWorkTasks;
 
+// Upper bound on retained blocks, so one burst does not pin memory forever.
+static const size_t kMaxPooledFrameBlocks = 4096;
+
+union FrameBlock
+{
+	FrameBlock *next;
+	char data[kFrameBlockSize];
+};
+
+static FrameBlock *sFreeBlocks = nullptr;
+static FrameBlockStats sBlockStats = {};
+
 void
 SourceMod::ScheduleTaskForNextFrame(ke::Function<void()>&& task)
 {
@@ -54,3 +66,50 @@ SourceMod::RunScheduledFrameTasks(bool simulating)
 		sWorkTasks[i]();
 	sWorkTasks.clear();
 }
+
+void *
+SourceMod::AllocFrameBlock()
+{
+	FrameBlock *block = sFreeBlocks;
+	if (block) {
+		sFreeBlocks = block->next;
+		sBlockStats.pooled--;
+	} else {
+		block = new FrameBlock;
+		sBlockStats.allocations++;
+	}
+
+	sBlockStats.requests++;
+	if (++sBlockStats.outstanding > sBlockStats.peak)
+		sBlockStats.peak = sBlockStats.outstanding;
+	return block->data;
+}
+
+void
+SourceMod::FreeFrameBlock(void *ptr)
+{
+	FrameBlock *block = reinterpret_cast<FrameBlock *>(ptr);
+	sBlockStats.outstanding--;
+
+	if (sBlockStats.pooled >= kMaxPooledFrameBlocks) {
+		delete block;
+		return;
+	}
+	block->next = sFreeBlocks;
+	sFreeBlocks = block;
+	sBlockStats.pooled++;
+}
+
+void
+SourceMod::GetFrameBlockStats(FrameBlockStats *stats)
+{
+	*stats = sBlockStats;
+}
+
+void
+SourceMod::ResetFrameBlockStats()
+{
+	sBlockStats.requests = 0;
+	sBlockStats.allocations = 0;
+	sBlockStats.peak = sBlockStats.outstanding;
+}
@@ -28,6 +28,8 @@
 #define _include_sourcemod_logic_frame_tasks_h_
 
 #include <am-function.h>
+#include <stddef.h>
+#include <stdint.h>
 
 namespace SourceMod {
 
@@ -35,6 +37,27 @@ void ScheduleTaskForNextFrame(ke::Function<void()>&& task);
 
 void RunScheduledFrameTasks(bool simulating);
 
+// Small fixed-size blocks for data that only needs to live until a queued
+// frame callback runs. Freed blocks are kept on a free list instead of going
+// back to the heap, since RequestFrame-heavy plugins churn through hundreds
+// of them per frame.
+static const size_t kFrameBlockSize = 32;
+
+void *AllocFrameBlock();
+void FreeFrameBlock(void *block);
+
+struct FrameBlockStats
+{
+	uint64_t requests;      // Total blocks handed out.
+	uint64_t allocations;   // Requests that had to go to the heap.
+	size_t outstanding;     // Blocks currently handed out.
+	size_t peak;            // Highest value of outstanding.
+	size_t pooled;          // Blocks sitting on the free list.
+};
+
+void GetFrameBlockStats(FrameBlockStats *stats);
+void ResetFrameBlockStats();
+
 }
 
 #endif // _include_sourcemod_logic_frame_tasks_h_
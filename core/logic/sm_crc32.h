@@ -31,8 +31,26 @@
 #define _INCLUDE_SOURCEMOD_CRC32_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
+/**
+ * CRC32 (IEEE 802.3, as used by zlib). Gamedata CRC sections and on-disk
+ * caches store these values, so the result never changes; only the
+ * implementation (PCLMUL, ARMv8 or slicing-by-8, picked at runtime) does.
+ */
 unsigned int UTIL_CRC32(const void *data, size_t data_length);
 
+/**
+ * CRC32C (Castagnoli). Uses the SSE4.2 or ARMv8 CRC instructions when
+ * available, so it is the cheaper choice for new integrity checks.
+ */
+unsigned int UTIL_CRC32C(const void *data, size_t data_length);
+
+/**
+ * Fast non-cryptographic 64-bit hash (XXH64). Suitable for cache keys and
+ * change detection, not for anything adversarial.
+ */
+uint64_t UTIL_Hash64(const void *data, size_t len, uint64_t seed = 0);
+
 #endif //_INCLUDE_SOURCEMOD_CRC32_H_
 
@@ -31,12 +31,14 @@
 
 #include <string.h>
 #include <assert.h>
-#include <sm_trie_tpl.h>
+#include <sm_flatmap.h>
 #include "sm_trie.h"
 
+using namespace SourceMod;
+
 struct Trie
 {
-	KTrie<void *> k;
+	StringFlatMap<void *> k;
 };
 
 Trie *sm_trie_create()
@@ -61,19 +63,7 @@ bool sm_trie_replace(Trie *trie, const char *key, void *value)
 
 bool sm_trie_retrieve(Trie *trie, const char *key, void **value)
 {
-	void **pValue = trie->k.retrieve(key);
-	
-	if (!pValue)
-	{
-		return false;
-	}
-
-	if (value)
-	{
-		*value = *pValue;
-	}
-
-	return true;
+	return trie->k.retrieve(key, value);
 }
 
 bool sm_trie_delete(Trie *trie, const char *key)
@@ -91,31 +81,27 @@ size_t sm_trie_mem_usage(Trie *trie)
 	return trie->k.mem_usage();
 }
 
-struct trie_iter_data
-{
-	SM_TRIE_BAD_ITERATOR iter;
-	void *ptr;
-	Trie *pTrie;
-};
-
-void our_trie_iterator(KTrie<void *> *pTrie, const char *name, void *& obj, void *data)
-{
-	trie_iter_data *our_iter;
-
-	our_iter = (trie_iter_data *)data;
-	our_iter->iter(our_iter->pTrie, name, &obj, our_iter->ptr);
-}
-
 void sm_trie_bad_iterator(Trie *trie,
 						  char *buffer,
 						  size_t maxlength,
 						  SM_TRIE_BAD_ITERATOR iter,
 						  void *data)
 {
-	trie_iter_data our_iter;
+	if (!maxlength)
+	{
+		return;
+	}
 
-	our_iter.iter = iter;
-	our_iter.ptr = data;
-	our_iter.pTrie = trie;
-	trie->k.bad_iterator(buffer, maxlength, &our_iter, our_trie_iterator);
+	/* Callers expect the key in |buffer|, as KTrie used to build it there. */
+	trie->k.for_each([&](const char *key, void *&value) {
+		size_t len = strlen(key);
+		if (len >= maxlength)
+		{
+			len = maxlength - 1;
+		}
+		memcpy(buffer, key, len);
+		buffer[len] = '\0';
+
+		iter(trie, buffer, &value, data);
+	});
 }
@@ -362,6 +362,31 @@ static cell_t RemoveAdmin(IPluginContext *pContext, const cell_t *params)
 	return adminsys->InvalidateAdmin(id);
 }
 
+static cell_t RemoveAdmGroup(IPluginContext *pContext, const cell_t *params)
+{
+	GroupId id = params[1];
+
+	if (!adminsys->GetGroupName(id))
+	{
+		return 0;
+	}
+
+	adminsys->InvalidateGroup(id);
+
+	return 1;
+}
+
+static cell_t ReloadAdminIdentity(IPluginContext *pContext, const cell_t *params)
+{
+	char *auth, *ident;
+	pContext->LocalToString(params[1], &auth);
+	pContext->LocalToString(params[2], &ident);
+
+	adminsys->ReloadAdminIdentity(auth, ident);
+
+	return 1;
+}
+
 static cell_t FlagBitsToBitArray(IPluginContext *pContext, const cell_t *params)
 {
 	FlagBits bits = (FlagBits)params[1];
@@ -571,6 +596,8 @@ REGISTER_NATIVES(adminNatives)
 	{"GetAdminPassword",		GetAdminPassword},
 	{"FindAdminByIdentity",		FindAdminByIdentity},
 	{"RemoveAdmin",				RemoveAdmin},
+	{"RemoveAdmGroup",			RemoveAdmGroup},
+	{"ReloadAdminIdentity",		ReloadAdminIdentity},
 	{"FlagBitsToBitArray",		FlagBitsToBitArray},
 	{"FlagBitArrayToBits",		FlagBitArrayToBits},
 	{"FlagArrayToBits",			FlagArrayToBits},
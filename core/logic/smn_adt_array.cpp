@@ -30,8 +30,10 @@
  */
 
 #include <stdlib.h>
+#include <limits.h>
 #include "common_logic.h"
 #include "CellArray.h"
+#include "BlobStore.h"
 #include "stringutil.h"
 #include <IHandleSys.h>
 
@@ -64,6 +66,11 @@ public: //IHandleTypeDispatch
 	}
 } s_CellArrayHelpers;
 
+static cell_t ThrowFrozenArray(IPluginContext *pContext, Handle_t hndl)
+{
+	return pContext->ThrowNativeError("ArrayList %x is frozen and cannot be modified", hndl);
+}
+
 static cell_t CreateArray(IPluginContext *pContext, const cell_t *params)
 {
 	if (!params[1])
@@ -103,6 +110,11 @@ static cell_t ClearArray(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
 	}
 
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
 	array->clear();
 
 	return 1;
@@ -120,6 +132,11 @@ static cell_t ResizeArray(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
 	}
 
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
 	if (!array->resize(params[2]))
 	{
 		return pContext->ThrowNativeError("Unable to resize array to \"%u\"", params[2]);
@@ -155,6 +172,11 @@ static cell_t PushArrayCell(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
 	}
 
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
 	cell_t *blk = array->push();
 	if (!blk)
 	{
@@ -178,6 +200,11 @@ static cell_t PushArrayString(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
 	}
 
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
 	cell_t *blk = array->push();
 	if (!blk)
 	{
@@ -204,6 +231,11 @@ static cell_t PushArrayArray(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
 	}
 
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
 	cell_t *blk = array->push();
 	if (!blk)
 	{
@@ -358,13 +390,19 @@ static cell_t SetArrayCell(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
 	}
 
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
 	size_t idx = (size_t)params[2];
 	if (idx >= array->size())
 	{
 		return pContext->ThrowNativeError("Invalid index %d (count: %d)", idx, array->size());
 	}
 
-	cell_t *blk = array->at(idx);
+	size_t row = idx;
+	cell_t *blk = array->at(row);
 
 	idx = (size_t)params[4];
 	if (params[5] == 0)
@@ -373,14 +411,17 @@ static cell_t SetArrayCell(IPluginContext *pContext, const cell_t *params)
 		{
 			return pContext->ThrowNativeError("Invalid block %d (blocksize: %d)", idx, array->blocksize());
 		}
+		array->IndexRemove(row);
 		blk[idx] = params[3];
 	} else {
 		if (idx >= array->blocksize() * 4)
 		{
 			return pContext->ThrowNativeError("Invalid byte %d (blocksize: %d bytes)", idx, array->blocksize() * 4);
 		}
+		array->IndexRemove(row);
 		*((char *)blk + idx) = (char)params[3];
 	}
+	array->IndexAdd(row);
 
 	return 1;
 }
@@ -397,6 +438,11 @@ static cell_t SetArrayString(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
 	}
 
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
 	size_t idx = (size_t)params[2];
 	if (idx >= array->size())
 	{
@@ -426,7 +472,18 @@ static cell_t SetArrayString(IPluginContext *pContext, const cell_t *params)
 		maxlength = (size_t)params[4];
 	}
 
-	return strncopy((char*)blk, str, maxlength);
+	// A write that runs past the end of this row also touches the next one.
+	if (maxlength > (array->blocksize() - blocknumber) * sizeof(cell_t))
+	{
+		array->InvalidateIndex();
+		return strncopy((char*)blk, str, maxlength);
+	}
+
+	array->IndexRemove(idx);
+	size_t written = strncopy((char*)blk, str, maxlength);
+	array->IndexAdd(idx);
+
+	return written;
 }
 
 static cell_t SetArrayArray(IPluginContext *pContext, const cell_t *params)
@@ -441,6 +498,11 @@ static cell_t SetArrayArray(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
 	}
 
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
 	size_t idx = (size_t)params[2];
 	if (idx >= array->size())
 	{
@@ -469,7 +531,17 @@ static cell_t SetArrayArray(IPluginContext *pContext, const cell_t *params)
 	cell_t *addr;
 	pContext->LocalToPhysAddr(params[3], &addr);
 
+	// A write that runs past the end of this row also touches the next one.
+	if (blocknumber + indexes > array->blocksize())
+	{
+		array->InvalidateIndex();
+		memcpy(blk, addr, sizeof(cell_t) * indexes);
+		return indexes;
+	}
+
+	array->IndexRemove(idx);
 	memcpy(blk, addr, sizeof(cell_t) * indexes);
+	array->IndexAdd(idx);
 
 	return indexes;
 }
@@ -486,6 +558,11 @@ static cell_t ShiftArrayUp(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
 	}
 
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
 	size_t idx = (size_t)params[2];
 	if (idx >= array->size())
 	{
@@ -509,6 +586,11 @@ static cell_t RemoveFromArray(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
 	}
 
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
 	size_t idx = (size_t)params[2];
 	if (idx >= array->size())
 	{
@@ -532,6 +614,11 @@ static cell_t SwapArrayItems(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
 	}
 
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
 	size_t idx1 = (size_t)params[2];
 	size_t idx2 = (size_t)params[3];
 	if (idx1 >= array->size())
@@ -615,12 +702,18 @@ static cell_t FindStringInArray(IPluginContext *pContext, const cell_t *params)
 		reverse = params[5];
 	}
 
+	bool caseSensitive = (params[0] < 6 || params[6]);
 	typedef int (*STRCOMPARE)(const char *, const char *);
-	STRCOMPARE comparefn = (params[0] < 6 || params[6]) ? strcmp : strcasecmp;
+	STRCOMPARE comparefn = caseSensitive ? strcmp : strcasecmp;
 
 	char *str;
 	pContext->LocalToString(params[2], &str);
 
+	if (caseSensitive && array->HasIndex(blocknumber, true))
+	{
+		return array->IndexFind(CellArray::IndexKey(str), startidx, reverse);
+	}
+
 	if (reverse)
 	{
 		if (startidx < 0)
@@ -695,6 +788,11 @@ static cell_t FindValueInArray(IPluginContext *pContext, const cell_t *params)
 		reverse = params[5];
 	}
 
+	if (array->HasIndex(blocknumber, false))
+	{
+		return array->IndexFind(CellArray::IndexKey(params[2]), startidx, reverse);
+	}
+
 	if (reverse)
 	{
 		if (startidx < 0)
@@ -744,6 +842,587 @@ static cell_t GetArrayBlockSize(IPluginContext *pContext, const cell_t *params)
 	return array->blocksize();
 }
 
+static cell_t GetArrayCapacity(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	return (cell_t)array->capacity();
+}
+
+static cell_t ReserveArray(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
+	if (params[2] < 0)
+	{
+		return pContext->ThrowNativeError("Invalid capacity %d", params[2]);
+	}
+
+	if (!array->reserve((size_t)params[2]))
+	{
+		return pContext->ThrowNativeError("Unable to reserve space for %d items", params[2]);
+	}
+
+	return 1;
+}
+
+static cell_t ShrinkArrayToFit(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	if (!array->shrink_to_fit())
+	{
+		return pContext->ThrowNativeError("Unable to shrink array");
+	}
+
+	return 1;
+}
+
+// Resolves a plugin buffer holding |count| whole blocks, making sure all of it
+// lies inside the plugin's memory. Throws and returns NULL on failure.
+static cell_t *GetBlockBuffer(IPluginContext *pContext, CellArray *array, cell_t addr, cell_t count)
+{
+	if (count < 0)
+	{
+		pContext->ReportError("Invalid block count %d", count);
+		return NULL;
+	}
+
+	size_t blocksize = array->blocksize();
+	if ((size_t)count > INT_MAX / (blocksize * sizeof(cell_t)))
+	{
+		pContext->ReportError("Block count %d is too large (blocksize: %d)", count, blocksize);
+		return NULL;
+	}
+
+	cell_t *buffer, *last;
+	size_t cells = (size_t)count * blocksize;
+	if (pContext->LocalToPhysAddr(addr, &buffer) != SP_ERROR_NONE
+		|| (cells && pContext->LocalToPhysAddr(addr + (cell_t)((cells - 1) * sizeof(cell_t)), &last) != SP_ERROR_NONE))
+	{
+		pContext->ReportError("Buffer is too small for %d blocks (blocksize: %d)", count, blocksize);
+		return NULL;
+	}
+
+	return buffer;
+}
+
+// Validates that [index, index + count) is a range of existing items.
+static bool CheckBlockRange(IPluginContext *pContext, CellArray *array, cell_t index, cell_t count)
+{
+	if (index < 0 || count < 0 || (size_t)index > array->size() || (size_t)count > array->size() - index)
+	{
+		pContext->ReportError("Invalid range %d..%d (count: %d)", index, index + count, array->size());
+		return false;
+	}
+	return true;
+}
+
+static cell_t PushArrayBlocks(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
+	cell_t *addr = GetBlockBuffer(pContext, array, params[2], params[3]);
+	if (!addr)
+	{
+		return 0;
+	}
+
+	size_t first = array->size();
+	cell_t *blk = array->push_range((size_t)params[3]);
+	if (!blk)
+	{
+		return pContext->ThrowNativeError("Failed to grow array");
+	}
+
+	memcpy(blk, addr, sizeof(cell_t) * array->blocksize() * params[3]);
+
+	return (cell_t)first;
+}
+
+static cell_t GetArrayBlocks(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	if (!CheckBlockRange(pContext, array, params[2], params[4]))
+	{
+		return 0;
+	}
+
+	cell_t *addr = GetBlockBuffer(pContext, array, params[3], params[4]);
+	if (!addr)
+	{
+		return 0;
+	}
+
+	memcpy(addr, array->at(params[2]), sizeof(cell_t) * array->blocksize() * params[4]);
+
+	return params[4];
+}
+
+static cell_t SetArrayBlocks(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
+	if (!CheckBlockRange(pContext, array, params[2], params[4]))
+	{
+		return 0;
+	}
+
+	cell_t *addr = GetBlockBuffer(pContext, array, params[3], params[4]);
+	if (!addr)
+	{
+		return 0;
+	}
+
+	size_t first = (size_t)params[2];
+	size_t last = first + (size_t)params[4];
+	for (size_t i = first; i < last; i++)
+	{
+		array->IndexRemove(i);
+	}
+
+	memcpy(array->at(first), addr, sizeof(cell_t) * array->blocksize() * params[4]);
+
+	for (size_t i = first; i < last; i++)
+	{
+		array->IndexAdd(i);
+	}
+
+	return params[4];
+}
+
+static cell_t InsertArrayBlocks(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
+	if (!CheckBlockRange(pContext, array, params[2], 0))
+	{
+		return 0;
+	}
+
+	cell_t *addr = GetBlockBuffer(pContext, array, params[3], params[4]);
+	if (!addr)
+	{
+		return 0;
+	}
+
+	cell_t *blk = array->insert_range((size_t)params[2], (size_t)params[4]);
+	if (!blk)
+	{
+		return pContext->ThrowNativeError("Failed to grow array");
+	}
+
+	memcpy(blk, addr, sizeof(cell_t) * array->blocksize() * params[4]);
+
+	return params[4];
+}
+
+static cell_t CopyArrayBlocks(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
+	CellArray *source;
+	if ((err = handlesys->ReadHandle(params[2], htCellArray, &sec, (void **)&source))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[2], err);
+	}
+
+	if (source->blocksize() != array->blocksize())
+	{
+		return pContext->ThrowNativeError("Block size mismatch (source: %d, destination: %d)", source->blocksize(), array->blocksize());
+	}
+
+	cell_t start = params[3];
+	cell_t count = params[4];
+	if (count == -1 && start >= 0 && (size_t)start <= source->size())
+	{
+		count = (cell_t)(source->size() - start);
+	}
+
+	if (!CheckBlockRange(pContext, source, start, count))
+	{
+		return 0;
+	}
+
+	size_t first = array->size();
+	cell_t *blk = array->push_range((size_t)count);
+	if (!blk)
+	{
+		return pContext->ThrowNativeError("Failed to grow array");
+	}
+
+	/* Fetch the source row after growing, in case source and destination are the same. */
+	memcpy(blk, source->at(start), sizeof(cell_t) * array->blocksize() * count);
+
+	return (cell_t)first;
+}
+
+static cell_t SetArrayIndex(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
+	size_t blocknumber = (size_t)params[2];
+	if (!array->SetIndex(blocknumber, params[3] != 0))
+	{
+		return pContext->ThrowNativeError("Invalid block %d (blocksize: %d)", blocknumber, array->blocksize());
+	}
+
+	return 1;
+}
+
+static cell_t ClearArrayIndex(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
+	array->ClearIndex();
+
+	return 1;
+}
+
+static cell_t FreezeArray(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	array->freeze();
+
+	return 1;
+}
+
+static cell_t IsArrayFrozen(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	return array->frozen() ? 1 : 0;
+}
+
+static cell_t RemoveInvalidEntRefs(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
+	size_t blocksize = array->blocksize();
+	size_t blocknumber = (size_t)params[2];
+	if (blocknumber >= blocksize)
+	{
+		return pContext->ThrowNativeError("Invalid block %d (blocksize: %d)", blocknumber, blocksize);
+	}
+
+	/* Single pass: survivors are moved down over the holes, then the tail is cut. */
+	cell_t *base = array->base();
+	size_t count = array->size();
+	size_t kept = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		cell_t *row = &base[i * blocksize];
+		if (!gamehelpers->ReferenceToEntity(row[blocknumber]))
+		{
+			continue;
+		}
+
+		if (kept != i)
+		{
+			memcpy(&base[kept * blocksize], row, sizeof(cell_t) * blocksize);
+		}
+		kept++;
+	}
+
+	if (kept == count)
+	{
+		return 0;
+	}
+
+	array->InvalidateIndex();
+	array->resize(kept);
+
+	return (cell_t)(count - kept);
+}
+
+/* Payload: block size, item count, then every item's cells. */
+static void SerializeArray(CellArray *array, BlobWriter &writer)
+{
+	size_t bytes = sizeof(cell_t) * array->blocksize() * array->size();
+	writer.Reserve(sizeof(uint32_t) * 2 + bytes);
+	writer.WriteU32((uint32_t)array->blocksize());
+	writer.WriteU32((uint32_t)array->size());
+	writer.Write(array->base(), bytes);
+}
+
+static cell_t DeserializeArray(IPluginContext *pContext, CellArray *array, const std::vector<uint8_t> &blob)
+{
+	BlobReader reader;
+	uint32_t blocksize, count;
+	if (!reader.Open(blob, BlobKind_ArrayList) || !reader.ReadU32(&blocksize) || !reader.ReadU32(&count))
+	{
+		return 0;
+	}
+
+	if (blocksize != array->blocksize())
+	{
+		return pContext->ThrowNativeError("Saved block size %u does not match array block size %d", blocksize, array->blocksize());
+	}
+
+	uint64_t bytes = (uint64_t)sizeof(cell_t) * blocksize * count;
+	if (bytes != reader.Remaining())
+	{
+		return 0;
+	}
+
+	array->clear();
+	if (!array->resize(count))
+	{
+		return pContext->ThrowNativeError("Unable to resize array to \"%u\"", count);
+	}
+	reader.Read(array->base(), (size_t)bytes);
+
+	return 1;
+}
+
+static cell_t SaveArrayToFile(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	char *path;
+	pContext->LocalToString(params[2], &path);
+
+	BlobWriter writer(BlobKind_ArrayList);
+	SerializeArray(array, writer);
+
+	return g_BlobStore.SaveFile(path, writer.Finish()) ? 1 : 0;
+}
+
+static cell_t LoadArrayFromFile(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
+	char *path;
+	pContext->LocalToString(params[2], &path);
+
+	std::vector<uint8_t> blob;
+	if (!g_BlobStore.LoadFile(path, &blob))
+	{
+		return 0;
+	}
+
+	return DeserializeArray(pContext, array, blob);
+}
+
+static cell_t SaveArrayToMemory(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	char *key;
+	pContext->LocalToString(params[2], &key);
+
+	BlobWriter writer(BlobKind_ArrayList);
+	SerializeArray(array, writer);
+	g_BlobStore.Stash(key, std::move(writer.Finish()));
+
+	return 1;
+}
+
+static cell_t LoadArrayFromMemory(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&array))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	if (array->frozen())
+	{
+		return ThrowFrozenArray(pContext, params[1]);
+	}
+
+	char *key;
+	pContext->LocalToString(params[2], &key);
+
+	std::vector<uint8_t> blob;
+	if (!g_BlobStore.Unstash(key, &blob, params[3] != 0))
+	{
+		return 0;
+	}
+
+	return DeserializeArray(pContext, array, blob);
+}
+
 REGISTER_NATIVES(cellArrayNatives)
 {
 	{"ClearArray",					ClearArray},
@@ -788,6 +1467,23 @@ REGISTER_NATIVES(cellArrayNatives)
 	{"ArrayList.FindString",		FindStringInArray},
 	{"ArrayList.FindValue",			FindValueInArray},
 	{"ArrayList.BlockSize.get",		GetArrayBlockSize},
+	{"ArrayList.Capacity.get",		GetArrayCapacity},
+	{"ArrayList.Reserve",			ReserveArray},
+	{"ArrayList.ShrinkToFit",		ShrinkArrayToFit},
+	{"ArrayList.PushBlocks",		PushArrayBlocks},
+	{"ArrayList.GetBlocks",			GetArrayBlocks},
+	{"ArrayList.SetBlocks",			SetArrayBlocks},
+	{"ArrayList.InsertBlocks",		InsertArrayBlocks},
+	{"ArrayList.CopyFrom",			CopyArrayBlocks},
+	{"ArrayList.SetIndex",			SetArrayIndex},
+	{"ArrayList.ClearIndex",		ClearArrayIndex},
+	{"ArrayList.SaveToFile",		SaveArrayToFile},
+	{"ArrayList.LoadFromFile",		LoadArrayFromFile},
+	{"ArrayList.SaveToMemory",		SaveArrayToMemory},
+	{"ArrayList.LoadFromMemory",	LoadArrayFromMemory},
+	{"ArrayList.Freeze",			FreezeArray},
+	{"ArrayList.Frozen.get",		IsArrayFrozen},
+	{"ArrayList.RemoveInvalidEntRefs",	RemoveInvalidEntRefs},
 
 	{NULL,							NULL},
 };
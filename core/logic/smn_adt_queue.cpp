@@ -0,0 +1,521 @@
+/**
+* vim: set ts=4 sw=4 tw=99 noet :
+* =============================================================================
+* SourceMod
+* Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+* =============================================================================
+*
+* This program is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License, version 3.0, as published by the
+* Free Software Foundation.
+* 
+* This program is distributed in the hope that it will be useful, but WITHOUT
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+* FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+* details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+* As a special exception, AlliedModders LLC gives you permission to link the
+* code of this program (as well as its derivative works) to "Half-Life 2," the
+* "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+* by the Valve Corporation.  You must obey the GNU General Public License in
+* all respects for all other code used.  Additionally, AlliedModders LLC grants
+* this exception to all derivative works.  AlliedModders LLC defines further
+* exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+* or <http://www.sourcemod.net/license.php>.
+*
+* Version: $Id$
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <amtl/am-bits.h>
+#include "common_logic.h"
+#include "handle_helpers.h"
+#include "stringutil.h"
+#include <IHandleSys.h>
+
+HandleType_t htCellQueue;
+
+/**
+ * FIFO of fixed-size blocks in a ring buffer, so both ends are O(1).
+ * Capacity is always a power of two.
+ */
+class CellQueue
+{
+public:
+	CellQueue(size_t blocksize) : m_Data(NULL), m_BlockSize(blocksize), m_AllocSize(0), m_Head(0), m_Size(0)
+	{
+	}
+
+	~CellQueue()
+	{
+		free(m_Data);
+	}
+
+	size_t size() const
+	{
+		return m_Size;
+	}
+
+	size_t blocksize() const
+	{
+		return m_BlockSize;
+	}
+
+	size_t mem_usage() const
+	{
+		return m_AllocSize * m_BlockSize * sizeof(cell_t);
+	}
+
+	/* The index'th block from the front. */
+	cell_t *at(size_t index) const
+	{
+		return &m_Data[((m_Head + index) & (m_AllocSize - 1)) * m_BlockSize];
+	}
+
+	cell_t *push()
+	{
+		if (!reserve(m_Size + 1))
+		{
+			return NULL;
+		}
+		cell_t *blk = at(m_Size);
+		m_Size++;
+		return blk;
+	}
+
+	void pop(size_t count = 1)
+	{
+		m_Head = (m_Head + count) & (m_AllocSize - 1);
+		m_Size -= count;
+		if (!m_Size)
+		{
+			m_Head = 0;
+		}
+	}
+
+	void clear()
+	{
+		m_Head = 0;
+		m_Size = 0;
+	}
+
+	bool reserve(size_t count)
+	{
+		if (count <= m_AllocSize)
+		{
+			return true;
+		}
+
+		size_t newAllocSize = m_AllocSize ? m_AllocSize : 8;
+		while (newAllocSize < count)
+		{
+			if (!ke::IsUintPtrMultiplySafe(newAllocSize, 2))
+			{
+				return false;
+			}
+			newAllocSize *= 2;
+		}
+		if (!ke::IsUintPtrMultiplySafe(newAllocSize, sizeof(cell_t) * m_BlockSize))
+		{
+			return false;
+		}
+
+		/* Unwrap into the new buffer so the front is at 0 again */
+		cell_t *data = (cell_t *)malloc(newAllocSize * m_BlockSize * sizeof(cell_t));
+		if (!data)
+		{
+			return false;
+		}
+		CopyOut(data, 0, m_Size);
+		free(m_Data);
+
+		m_Data = data;
+		m_AllocSize = newAllocSize;
+		m_Head = 0;
+		return true;
+	}
+
+	/* Copies count blocks, starting index blocks from the front, in order. */
+	void CopyOut(cell_t *dest, size_t index, size_t count) const
+	{
+		if (!count)
+		{
+			return;
+		}
+
+		size_t start = (m_Head + index) & (m_AllocSize - 1);
+		size_t first = std::min(count, m_AllocSize - start);
+		memcpy(dest, &m_Data[start * m_BlockSize], first * m_BlockSize * sizeof(cell_t));
+		memcpy(&dest[first * m_BlockSize], m_Data, (count - first) * m_BlockSize * sizeof(cell_t));
+	}
+
+	/* Appends count blocks to the back. */
+	bool CopyIn(const cell_t *src, size_t count)
+	{
+		if (!ke::IsUintPtrAddSafe(m_Size, count) || !reserve(m_Size + count))
+		{
+			return false;
+		}
+		if (!count)
+		{
+			return true;
+		}
+
+		size_t start = (m_Head + m_Size) & (m_AllocSize - 1);
+		size_t first = std::min(count, m_AllocSize - start);
+		memcpy(&m_Data[start * m_BlockSize], src, first * m_BlockSize * sizeof(cell_t));
+		memcpy(m_Data, &src[first * m_BlockSize], (count - first) * m_BlockSize * sizeof(cell_t));
+		m_Size += count;
+		return true;
+	}
+
+	CellQueue *clone() const
+	{
+		CellQueue *queue = new CellQueue(m_BlockSize);
+		if (!queue->reserve(m_AllocSize))
+		{
+			delete queue;
+			return NULL;
+		}
+		CopyOut(queue->m_Data, 0, m_Size);
+		queue->m_Size = m_Size;
+		return queue;
+	}
+
+private:
+	cell_t *m_Data;
+	size_t m_BlockSize;
+	size_t m_AllocSize;
+	size_t m_Head;
+	size_t m_Size;
+};
+
+class CellQueueHelpers : 
+	public SMGlobalClass,
+	public IHandleTypeDispatch
+{
+public: //SMGlobalClass
+	void OnSourceModAllInitialized()
+	{
+		htCellQueue = handlesys->CreateType("CellQueue", this, 0, NULL, NULL, g_pCoreIdent, NULL);
+	}
+	void OnSourceModShutdown()
+	{
+		handlesys->RemoveType(htCellQueue, g_pCoreIdent);
+	}
+public: //IHandleTypeDispatch
+	void OnHandleDestroy(HandleType_t type, void *object)
+	{
+		CellQueue *queue = (CellQueue *)object;
+		delete queue;
+	}
+	bool GetHandleApproxSize(HandleType_t type, void *object, unsigned int *pSize)
+	{
+		CellQueue *queue = (CellQueue *)object;
+		*pSize = sizeof(CellQueue) + queue->mem_usage();
+		return true;
+	}
+} s_CellQueueHelpers;
+
+static cell_t ArrayQueue_ArrayQueue(IPluginContext *pContext, const cell_t *params)
+{
+	if (params[1] < 1)
+	{
+		return pContext->ThrowNativeError("Invalid block size (must be > 0)");
+	}
+
+	CellQueue *queue = new CellQueue(params[1]);
+
+	if (params[2] > 0 && !queue->reserve(params[2]))
+	{
+		delete queue;
+		return pContext->ThrowNativeError("Failed to reserve room for %d items", params[2]);
+	}
+
+	Handle_t hndl = handlesys->CreateHandle(htCellQueue, queue, pContext->GetIdentity(), g_pCoreIdent, NULL);
+	if (!hndl)
+	{
+		delete queue;
+	}
+
+	return hndl;
+}
+
+static cell_t ArrayQueue_Clear(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<CellQueue> queue(pContext, params[1], htCellQueue);
+	if (!queue.Ok())
+		return 0;
+
+	queue->clear();
+	return 1;
+}
+
+static cell_t ArrayQueue_Clone(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<CellQueue> queue(pContext, params[1], htCellQueue);
+	if (!queue.Ok())
+		return 0;
+
+	CellQueue *copy = queue->clone();
+	if (!copy)
+		return pContext->ThrowNativeError("Failed to clone queue. Out of memory.");
+
+	Handle_t hndl = handlesys->CreateHandle(htCellQueue, copy, pContext->GetIdentity(), g_pCoreIdent, NULL);
+	if (!hndl)
+	{
+		delete copy;
+	}
+
+	return hndl;
+}
+
+static cell_t ArrayQueue_Enqueue(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<CellQueue> queue(pContext, params[1], htCellQueue);
+	if (!queue.Ok())
+		return 0;
+
+	cell_t *blk = queue->push();
+	if (!blk)
+		return pContext->ThrowNativeError("Failed to grow queue");
+
+	*blk = params[2];
+	return 1;
+}
+
+static cell_t ArrayQueue_EnqueueString(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<CellQueue> queue(pContext, params[1], htCellQueue);
+	if (!queue.Ok())
+		return 0;
+
+	cell_t *blk = queue->push();
+	if (!blk)
+		return pContext->ThrowNativeError("Failed to grow queue");
+
+	char *str;
+	pContext->LocalToString(params[2], &str);
+
+	strncopy((char *)blk, str, queue->blocksize() * sizeof(cell_t));
+	return 1;
+}
+
+static cell_t ArrayQueue_EnqueueArray(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<CellQueue> queue(pContext, params[1], htCellQueue);
+	if (!queue.Ok())
+		return 0;
+
+	cell_t *blk = queue->push();
+	if (!blk)
+		return pContext->ThrowNativeError("Failed to grow queue");
+
+	cell_t *addr;
+	pContext->LocalToPhysAddr(params[2], &addr);
+
+	size_t indexes = queue->blocksize();
+	if (params[3] != -1 && (size_t)params[3] <= queue->blocksize())
+		indexes = params[3];
+
+	memcpy(blk, addr, sizeof(cell_t) * indexes);
+	return 1;
+}
+
+static cell_t ArrayQueue_EnqueueMany(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<CellQueue> queue(pContext, params[1], htCellQueue);
+	if (!queue.Ok())
+		return 0;
+
+	if (params[3] < 0)
+		return pContext->ThrowNativeError("Invalid item count %d", params[3]);
+
+	cell_t *addr;
+	pContext->LocalToPhysAddr(params[2], &addr);
+
+	if (!queue->CopyIn(addr, params[3]))
+		return pContext->ThrowNativeError("Failed to grow queue");
+
+	return 1;
+}
+
+static cell_t ReadBlock(IPluginContext *pContext, CellQueue *queue, cell_t block, cell_t asChar, bool remove)
+{
+	if (queue->size() == 0)
+		return pContext->ThrowNativeError("queue is empty");
+
+	cell_t *blk = queue->at(0);
+	size_t idx = (size_t)block;
+
+	cell_t rval;
+	if (asChar == 0) {
+		if (idx >= queue->blocksize())
+			return pContext->ThrowNativeError("Invalid block %d (blocksize: %d)", idx, queue->blocksize());
+		rval = blk[idx];
+	} else {
+		if (idx >= queue->blocksize() * sizeof(cell_t))
+			return pContext->ThrowNativeError("Invalid byte %d (blocksize: %d bytes)", idx, queue->blocksize() * sizeof(cell_t));
+		rval = (cell_t)*((char *)blk + idx);
+	}
+
+	if (remove)
+		queue->pop();
+	return rval;
+}
+
+static cell_t ArrayQueue_Dequeue(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<CellQueue> queue(pContext, params[1], htCellQueue);
+	if (!queue.Ok())
+		return 0;
+
+	return ReadBlock(pContext, queue, params[2], params[3], true);
+}
+
+static cell_t ArrayQueue_Peek(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<CellQueue> queue(pContext, params[1], htCellQueue);
+	if (!queue.Ok())
+		return 0;
+
+	return ReadBlock(pContext, queue, params[2], params[3], false);
+}
+
+static cell_t ReadString(IPluginContext *pContext, const cell_t *params, bool remove)
+{
+	OpenHandle<CellQueue> queue(pContext, params[1], htCellQueue);
+	if (!queue.Ok())
+		return 0;
+
+	if (queue->size() == 0)
+		return pContext->ThrowNativeError("queue is empty");
+
+	cell_t *pWritten;
+	pContext->LocalToPhysAddr(params[4], &pWritten);
+
+	size_t numWritten;
+	pContext->StringToLocalUTF8(params[2], params[3], (char *)queue->at(0), &numWritten);
+	*pWritten = (cell_t)numWritten;
+
+	if (remove)
+		queue->pop();
+	return 1;
+}
+
+static cell_t ArrayQueue_DequeueString(IPluginContext *pContext, const cell_t *params)
+{
+	return ReadString(pContext, params, true);
+}
+
+static cell_t ArrayQueue_PeekString(IPluginContext *pContext, const cell_t *params)
+{
+	return ReadString(pContext, params, false);
+}
+
+static cell_t ReadArray(IPluginContext *pContext, const cell_t *params, bool remove)
+{
+	OpenHandle<CellQueue> queue(pContext, params[1], htCellQueue);
+	if (!queue.Ok())
+		return 0;
+
+	if (queue->size() == 0)
+		return pContext->ThrowNativeError("queue is empty");
+
+	cell_t *addr;
+	pContext->LocalToPhysAddr(params[2], &addr);
+
+	size_t indexes = queue->blocksize();
+	if (params[3] != -1 && (size_t)params[3] <= queue->blocksize())
+		indexes = params[3];
+
+	memcpy(addr, queue->at(0), sizeof(cell_t) * indexes);
+
+	if (remove)
+		queue->pop();
+	return 0;
+}
+
+static cell_t ArrayQueue_DequeueArray(IPluginContext *pContext, const cell_t *params)
+{
+	return ReadArray(pContext, params, true);
+}
+
+static cell_t ArrayQueue_PeekArray(IPluginContext *pContext, const cell_t *params)
+{
+	return ReadArray(pContext, params, false);
+}
+
+static cell_t ArrayQueue_DequeueMany(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<CellQueue> queue(pContext, params[1], htCellQueue);
+	if (!queue.Ok())
+		return 0;
+
+	if (params[3] < 0)
+		return pContext->ThrowNativeError("Invalid item count %d", params[3]);
+
+	cell_t *addr;
+	pContext->LocalToPhysAddr(params[2], &addr);
+
+	size_t count = std::min((size_t)params[3], queue->size());
+	queue->CopyOut(addr, 0, count);
+	queue->pop(count);
+
+	return (cell_t)count;
+}
+
+static cell_t ArrayQueue_Empty(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<CellQueue> queue(pContext, params[1], htCellQueue);
+	if (!queue.Ok())
+		return 0;
+
+	return queue->size() == 0 ? 1 : 0;
+}
+
+static cell_t ArrayQueue_Length(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<CellQueue> queue(pContext, params[1], htCellQueue);
+	if (!queue.Ok())
+		return 0;
+
+	return (cell_t)queue->size();
+}
+
+static cell_t ArrayQueue_BlockSize(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<CellQueue> queue(pContext, params[1], htCellQueue);
+	if (!queue.Ok())
+		return 0;
+
+	return (cell_t)queue->blocksize();
+}
+
+REGISTER_NATIVES(cellQueueNatives)
+{
+	{"ArrayQueue.ArrayQueue",		ArrayQueue_ArrayQueue},
+	{"ArrayQueue.Clear",			ArrayQueue_Clear},
+	{"ArrayQueue.Clone",			ArrayQueue_Clone},
+	{"ArrayQueue.Enqueue",			ArrayQueue_Enqueue},
+	{"ArrayQueue.EnqueueString",	ArrayQueue_EnqueueString},
+	{"ArrayQueue.EnqueueArray",		ArrayQueue_EnqueueArray},
+	{"ArrayQueue.EnqueueMany",		ArrayQueue_EnqueueMany},
+	{"ArrayQueue.Dequeue",			ArrayQueue_Dequeue},
+	{"ArrayQueue.DequeueString",	ArrayQueue_DequeueString},
+	{"ArrayQueue.DequeueArray",		ArrayQueue_DequeueArray},
+	{"ArrayQueue.DequeueMany",		ArrayQueue_DequeueMany},
+	{"ArrayQueue.Peek",				ArrayQueue_Peek},
+	{"ArrayQueue.PeekString",		ArrayQueue_PeekString},
+	{"ArrayQueue.PeekArray",		ArrayQueue_PeekArray},
+	{"ArrayQueue.Empty.get",		ArrayQueue_Empty},
+	{"ArrayQueue.Length.get",		ArrayQueue_Length},
+	{"ArrayQueue.BlockSize.get",	ArrayQueue_BlockSize},
+
+	{NULL,							NULL},
+};
@@ -74,6 +74,13 @@ static cell_t CreateStack(IPluginContext *pContext, const cell_t *params)
 
 	CellArray *array = new CellArray(params[1]);
 
+	/* Optional room to reserve up front, so large searches don't regrow */
+	if (params[0] >= 2 && params[2] > 0 && !array->reserve(params[2]))
+	{
+		delete array;
+		return pContext->ThrowNativeError("Failed to reserve room for %d items", params[2]);
+	}
+
 	Handle_t hndl = handlesys->CreateHandle(htCellStack, array, pContext->GetIdentity(), g_pCoreIdent, NULL);
 	if (!hndl)
 	{
@@ -481,6 +488,52 @@ static cell_t ArrayStack_TopArray(IPluginContext *pContext, const cell_t *params
 	return 0;
 }
 
+static cell_t ArrayStack_PushMany(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<CellArray> array(pContext, params[1], htCellStack);
+	if (!array.Ok())
+		return 0;
+
+	if (params[3] < 0)
+		return pContext->ThrowNativeError("Invalid item count %d", params[3]);
+	if (params[3] == 0)
+		return 0;
+
+	cell_t *addr;
+	pContext->LocalToPhysAddr(params[2], &addr);
+
+	cell_t *blk = array->push_range(params[3]);
+	if (!blk)
+		return pContext->ThrowNativeError("Failed to grow stack");
+
+	memcpy(blk, addr, sizeof(cell_t) * array->blocksize() * params[3]);
+	return 0;
+}
+
+static cell_t ArrayStack_PopMany(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<CellArray> array(pContext, params[1], htCellStack);
+	if (!array.Ok())
+		return 0;
+
+	if (params[3] < 0)
+		return pContext->ThrowNativeError("Invalid item count %d", params[3]);
+
+	cell_t *addr;
+	pContext->LocalToPhysAddr(params[2], &addr);
+
+	/* Items come out top first, as repeated PopArray() calls would return them */
+	size_t count = std::min((size_t)params[3], array->size());
+	size_t blocksize = array->blocksize();
+	for (size_t i = 0; i < count; i++)
+	{
+		memcpy(&addr[i * blocksize], array->at(array->size() - 1 - i), sizeof(cell_t) * blocksize);
+	}
+	array->resize(array->size() - count);
+
+	return (cell_t)count;
+}
+
 static cell_t GetStackBlockSize(IPluginContext *pContext, const cell_t *params)
 {
 	HandleError err;
@@ -537,6 +590,8 @@ REGISTER_NATIVES(cellStackNatives)
 	{"ArrayStack.Push",				PushStackCell},
 	{"ArrayStack.PushString",		PushStackString},
 	{"ArrayStack.PushArray",		PushStackArray},
+	{"ArrayStack.PushMany",			ArrayStack_PushMany},
+	{"ArrayStack.PopMany",			ArrayStack_PopMany},
 	{"ArrayStack.Empty.get",		IsStackEmpty},
 	{"ArrayStack.BlockSize.get",	GetStackBlockSize},
 	{"ArrayStack.Length.get",		GetStackSize},
@@ -37,12 +37,17 @@
 #include <am-refcounting.h>
 #include <sm_hashmap.h>
 #include "sm_memtable.h"
+#include "BlobStore.h"
+#include "CellArray.h"
+#include <bridge/include/IContainerBridge.h>
 #include <IHandleSys.h>
 
 HandleType_t htCellTrie;
 HandleType_t htSnapshot;
 HandleType_t htIntCellTrie;
 HandleType_t htIntSnapshot;
+HandleType_t htTrieIterator;
+HandleType_t htIntTrieIterator;
 
 enum EntryType
 {
@@ -125,6 +130,27 @@ public:
 		return type() == EntryType_String;
 	}
 
+	// Releases buffer space the value does not use, including the buffer a
+	// cell keeps from an earlier string or array.
+	void compact() {
+		ArrayInfo *array = raw();
+		if (!array)
+			return;
+		if (isCell()) {
+			free(array);
+			control_ = uintptr_t(EntryType_Cell);
+			return;
+		}
+		size_t bytes = isString() ? array->length + 1 : array->length * sizeof(cell_t);
+		if (array->maxbytes <= bytes)
+			return;
+		ArrayInfo *smaller = (ArrayInfo *)realloc(array, bytes + sizeof(ArrayInfo));
+		if (!smaller)
+			return;
+		smaller->maxbytes = bytes;
+		setTypeAndPointer(type(), smaller);
+	}
+
 private:
 	Entry(const Entry &other) = delete;
 
@@ -168,14 +194,44 @@ private:
 	cell_t data_;
 };
 
+// |version| changes whenever a key is added or removed, which is what
+// invalidates outstanding iterators. Overwriting a value does not.
+//
+// A |frozen| map can never be modified again. Lookups never write to the
+// table, so a frozen map can be shared through CloneHandle and read from
+// any thread without copying it.
 struct CellTrie
 {
-	StringHashMap<Entry> map;
+	typedef StringHashMap<Entry> MapType;
+
+	MapType map;
+	unsigned int version = 0;
+	bool frozen = false;
 };
 
 struct IntCellTrie
 {
-	IntHashMap<Entry> map;
+	typedef IntHashMap<Entry> MapType;
+
+	MapType map;
+	unsigned int version = 0;
+	bool frozen = false;
+};
+
+template <typename T>
+struct TrieIterator
+{
+	TrieIterator(Handle_t hndl, T *trie)
+		: map(hndl),
+		  version(trie->version),
+		  iter(trie->map.iter()),
+		  started(false)
+	{ }
+
+	Handle_t map;
+	unsigned int version;
+	typename T::MapType::iterator iter;
+	bool started;
 };
 
 struct TrieSnapshot
@@ -218,9 +274,13 @@ public: //SMGlobalClass
 		htSnapshot = handlesys->CreateType("TrieSnapshot", this, 0, NULL, NULL, g_pCoreIdent, NULL);
 		htIntCellTrie = handlesys->CreateType("IntTrie", this, 0, NULL, NULL, g_pCoreIdent, NULL);
 		htIntSnapshot = handlesys->CreateType("IntTrieSnapshot", this, 0, NULL, NULL, g_pCoreIdent, NULL);
+		htTrieIterator = handlesys->CreateType("TrieIterator", this, 0, NULL, NULL, g_pCoreIdent, NULL);
+		htIntTrieIterator = handlesys->CreateType("IntTrieIterator", this, 0, NULL, NULL, g_pCoreIdent, NULL);
 	}
 	void OnSourceModShutdown()
 	{
+		handlesys->RemoveType(htTrieIterator, g_pCoreIdent);
+		handlesys->RemoveType(htIntTrieIterator, g_pCoreIdent);
 		handlesys->RemoveType(htSnapshot, g_pCoreIdent);
 		handlesys->RemoveType(htCellTrie, g_pCoreIdent);
 		handlesys->RemoveType(htIntSnapshot, g_pCoreIdent);
@@ -247,6 +307,14 @@ public: //IHandleTypeDispatch
 			IntTrieSnapshot *snapshot = (IntTrieSnapshot *)object;
 			delete snapshot;
 		}
+		else if (type == htTrieIterator)
+		{
+			delete (TrieIterator<CellTrie> *)object;
+		}
+		else if (type == htIntTrieIterator)
+		{
+			delete (TrieIterator<IntCellTrie> *)object;
+		}
 	}
 	bool GetHandleApproxSize(HandleType_t type, void *object, unsigned int *pSize)
 	{
@@ -274,11 +342,26 @@ public: //IHandleTypeDispatch
 			*pSize = sizeof(IntTrieSnapshot) + snapshot->mem_usage();
 			return true;
 		}
+		else if (type == htTrieIterator)
+		{
+			*pSize = sizeof(TrieIterator<CellTrie>);
+			return true;
+		}
+		else if (type == htIntTrieIterator)
+		{
+			*pSize = sizeof(TrieIterator<IntCellTrie>);
+			return true;
+		}
 		
 		return false;
 	}
 } s_CellTrieHelpers;
 
+static cell_t ThrowFrozenMap(IPluginContext *pContext, Handle_t hndl)
+{
+	return pContext->ThrowNativeError("Map %x is frozen and cannot be modified", hndl);
+}
+
 static cell_t CreateTrie(IPluginContext *pContext, const cell_t *params)
 {
 	CellTrie *pTrie = new CellTrie;
@@ -323,6 +406,11 @@ static cell_t SetTrieValue(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
 	}
 
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, hndl);
+	}
+
 	char *key;
 	pContext->LocalToString(params[2], &key);
 
@@ -331,6 +419,7 @@ static cell_t SetTrieValue(IPluginContext *pContext, const cell_t *params)
 	{
 		if (!pTrie->map.add(i, key))
 			return 0;
+		pTrie->version++;
 		i->value.setCell(params[3]);
 		return 1;
 	}
@@ -356,6 +445,11 @@ static cell_t SetIntTrieValue(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
 	}
 
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, hndl);
+	}
+
 	int32_t key = params[2];
 
 	IntHashMap<Entry>::Insert i = pTrie->map.findForAdd(key);
@@ -363,6 +457,7 @@ static cell_t SetIntTrieValue(IPluginContext *pContext, const cell_t *params)
 	{
 		if (!pTrie->map.add(i, key))
 			return 0;
+		pTrie->version++;
 		i->value.setCell(params[3]);
 		return 1;
 	}
@@ -388,6 +483,11 @@ static cell_t SetTrieArray(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
 	}
 
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, hndl);
+	}
+
 	if (params[4] < 0)
 	{
 		return pContext->ThrowNativeError("Invalid array size: %d", params[4]);
@@ -403,6 +503,7 @@ static cell_t SetTrieArray(IPluginContext *pContext, const cell_t *params)
 	{
 		if (!pTrie->map.add(i, key))
 			return 0;
+		pTrie->version++;
 		i->key = key;
 		i->value.setArray(array, params[4]);
 		return 1;
@@ -429,6 +530,11 @@ static cell_t SetIntTrieArray(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
 	}
 
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, hndl);
+	}
+
 	if (params[4] < 0)
 	{
 		return pContext->ThrowNativeError("Invalid array size: %d", params[4]);
@@ -443,6 +549,7 @@ static cell_t SetIntTrieArray(IPluginContext *pContext, const cell_t *params)
 	{
 		if (!pTrie->map.add(i, key))
 			return 0;
+		pTrie->version++;
 		i->key = key;
 		i->value.setArray(array, params[4]);
 		return 1;
@@ -469,6 +576,11 @@ static cell_t SetTrieString(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
 	}
 
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, hndl);
+	}
+
 	char *key, *val;
 	pContext->LocalToString(params[2], &key);
 	pContext->LocalToString(params[3], &val);
@@ -478,6 +590,7 @@ static cell_t SetTrieString(IPluginContext *pContext, const cell_t *params)
 	{
 		if (!pTrie->map.add(i, key))
 			return 0;
+		pTrie->version++;
 		i->value.setString(val);
 		return 1;
 	}
@@ -503,6 +616,11 @@ static cell_t SetIntTrieString(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
 	}
 
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, hndl);
+	}
+
 	int32_t key = params[2];
 	char *val;
 	pContext->LocalToString(params[3], &val);
@@ -512,6 +630,7 @@ static cell_t SetIntTrieString(IPluginContext *pContext, const cell_t *params)
 	{
 		if (!pTrie->map.add(i, key))
 			return 0;
+		pTrie->version++;
 		i->value.setString(val);
 		return 1;
 	}
@@ -578,6 +697,11 @@ static cell_t RemoveFromTrie(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
 	}
 
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, hndl);
+	}
+
 	char *key;
 	pContext->LocalToString(params[2], &key);
 
@@ -586,6 +710,7 @@ static cell_t RemoveFromTrie(IPluginContext *pContext, const cell_t *params)
 		return 0;
 
 	pTrie->map.remove(r);
+	pTrie->version++;
 	return 1;
 }
 
@@ -603,6 +728,11 @@ static cell_t RemoveFromIntTrie(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
 	}
 
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, hndl);
+	}
+
 	int32_t key = params[2];
 
 	IntHashMap<Entry>::Result r = pTrie->map.find(key);
@@ -610,6 +740,7 @@ static cell_t RemoveFromIntTrie(IPluginContext *pContext, const cell_t *params)
 		return 0;
 
 	pTrie->map.remove(r);
+	pTrie->version++;
 	return 1;
 }
 
@@ -628,7 +759,13 @@ static cell_t ClearTrie(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
 	}
 
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, hndl);
+	}
+
 	pTrie->map.clear();
+	pTrie->version++;
 	return 1;
 }
 
@@ -647,7 +784,13 @@ static cell_t ClearIntTrie(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
 	}
 
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, hndl);
+	}
+
 	pTrie->map.clear();
+	pTrie->version++;
 	return 1;
 }
 
@@ -1207,59 +1350,925 @@ static cell_t CloneIntTrie(IPluginContext *pContext, const cell_t *params)
 	return hndl;
 }
 
-REGISTER_NATIVES(trieNatives)
+// Resolves a plugin cell buffer of |count| entries, checking that all of it
+// lies inside plugin memory. Reports an error and returns NULL on failure.
+static cell_t *GetBatchBuffer(IPluginContext *pContext, cell_t addr, cell_t count)
 {
-	{"ClearTrie",				ClearTrie},
-	{"CreateTrie",				CreateTrie},
-	{"GetTrieArray",			GetTrieArray},
-	{"GetTrieString",			GetTrieString},
-	{"GetTrieValue",			GetTrieValue},
-	{"RemoveFromTrie",			RemoveFromTrie},
-	{"SetTrieArray",			SetTrieArray},
-	{"SetTrieString",			SetTrieString},
-	{"SetTrieValue",			SetTrieValue},
-	{"GetTrieSize",				GetTrieSize},
+	cell_t *buffer, *last;
+	if (count < 0)
+	{
+		pContext->ReportError("Invalid key count %d", count);
+		return NULL;
+	}
+	if (pContext->LocalToPhysAddr(addr, &buffer) != SP_ERROR_NONE
+		|| (count && pContext->LocalToPhysAddr(addr + (count - 1) * sizeof(cell_t), &last) != SP_ERROR_NONE))
+	{
+		pContext->ReportError("Buffer is too small for %d keys", count);
+		return NULL;
+	}
+	return buffer;
+}
 
-	{"CreateTrieSnapshot",		CreateTrieSnapshot},
-	{"TrieSnapshotLength",		TrieSnapshotLength},
-	{"TrieSnapshotKeyBufferSize", TrieSnapshotKeyBufferSize},
-	{"GetTrieSnapshotKey",		GetTrieSnapshotKey},
+// Fetches entry |index| of a plugin char[][]. Older runtimes store each slot
+// as a byte offset from the slot itself instead of an address.
+static bool GetBatchKey(IPluginContext *pContext, cell_t keys_addr, cell_t *keys, cell_t index, char **key)
+{
+	cell_t addr = keys[index];
+	if (!pContext->GetRuntime()->UsesDirectArrays())
+		addr += keys_addr + index * sizeof(cell_t);
+	if (pContext->LocalToString(addr, key) != SP_ERROR_NONE)
+	{
+		pContext->ReportError("Invalid key at index %d", index);
+		return false;
+	}
+	return true;
+}
 
-	// Transitional syntax support.
-	{"StringMap.StringMap",		CreateTrie},
-	{"StringMap.Clear",			ClearTrie},
-	{"StringMap.GetArray",		GetTrieArray},
-	{"StringMap.GetString",		GetTrieString},
-	{"StringMap.GetValue",		GetTrieValue},
-	{"StringMap.ContainsKey",	ContainsKeyInTrie},
-	{"StringMap.Remove",		RemoveFromTrie},
-	{"StringMap.SetArray",		SetTrieArray},
-	{"StringMap.SetString",		SetTrieString},
-	{"StringMap.SetValue",		SetTrieValue},
-	{"StringMap.Size.get",		GetTrieSize},
-	{"StringMap.Snapshot",		CreateTrieSnapshot},
-	{"StringMap.Clone",			CloneTrie},
+static cell_t SetTrieValues(IPluginContext *pContext, const cell_t *params)
+{
+	CellTrie *pTrie;
+	HandleError err;
+	HandleSecurity sec = HandleSecurity(pContext->GetIdentity(), g_pCoreIdent);
 
-	{"IntMap.IntMap",			CreateIntTrie},
-	{"IntMap.Clear",			ClearIntTrie},
-	{"IntMap.GetArray",			GetIntTrieArray},
-	{"IntMap.GetString",		GetIntTrieString},
-	{"IntMap.GetValue",			GetIntTrieValue},
-	{"IntMap.ContainsKey",		ContainsKeyInIntTrie},
-	{"IntMap.Remove",			RemoveFromIntTrie},
-	{"IntMap.SetArray",			SetIntTrieArray},
-	{"IntMap.SetString",		SetIntTrieString},
-	{"IntMap.SetValue",			SetIntTrieValue},
-	{"IntMap.Size.get",			GetIntTrieSize},
-	{"IntMap.Snapshot",			CreateIntTrieSnapshot},
-	{"IntMap.Clone",			CloneIntTrie},
+	Handle_t hndl = params[1];
 
-	{"StringMapSnapshot.Length.get",	TrieSnapshotLength},
-	{"StringMapSnapshot.KeyBufferSize", TrieSnapshotKeyBufferSize},
-	{"StringMapSnapshot.GetKey",		GetTrieSnapshotKey},
+	if ((err = handlesys->ReadHandle(hndl, htCellTrie, &sec, (void **)&pTrie))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
+	}
 
-	{"IntMapSnapshot.Length.get",	IntTrieSnapshotLength},
-	{"IntMapSnapshot.GetKey",		GetIntTrieSnapshotKey},
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, hndl);
+	}
+
+	cell_t count = params[4];
+	cell_t *keys, *values;
+	if (!(keys = GetBatchBuffer(pContext, params[2], count))
+		|| !(values = GetBatchBuffer(pContext, params[3], count)))
+	{
+		return 0;
+	}
+
+	cell_t stored = 0;
+	for (cell_t n = 0; n < count; n++)
+	{
+		char *key;
+		if (!GetBatchKey(pContext, params[2], keys, n, &key))
+			return 0;
+
+		StringHashMap<Entry>::Insert i = pTrie->map.findForAdd(key);
+		if (!i.found())
+		{
+			if (!pTrie->map.add(i, key))
+				continue;
+			pTrie->version++;
+		}
+		else if (!params[5])
+		{
+			continue;
+		}
+
+		i->value.setCell(values[n]);
+		stored++;
+	}
+
+	return stored;
+}
+
+static cell_t GetTrieValues(IPluginContext *pContext, const cell_t *params)
+{
+	CellTrie *pTrie;
+	HandleError err;
+	HandleSecurity sec = HandleSecurity(pContext->GetIdentity(), g_pCoreIdent);
+
+	Handle_t hndl = params[1];
+
+	if ((err = handlesys->ReadHandle(hndl, htCellTrie, &sec, (void **)&pTrie))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
+	}
+
+	cell_t count = params[4];
+	cell_t *keys, *values;
+	if (!(keys = GetBatchBuffer(pContext, params[2], count))
+		|| !(values = GetBatchBuffer(pContext, params[3], count)))
+	{
+		return 0;
+	}
+
+	cell_t found = 0;
+	for (cell_t n = 0; n < count; n++)
+	{
+		char *key;
+		if (!GetBatchKey(pContext, params[2], keys, n, &key))
+			return 0;
+
+		values[n] = params[5];
+
+		StringHashMap<Entry>::Result r = pTrie->map.find(key);
+		if (!r.found())
+			continue;
+
+		// Same single-cell array compatibility as GetTrieValue().
+		if (r->value.isCell())
+			values[n] = r->value.cell();
+		else if (r->value.isArray() && r->value.arrayLength() == 1)
+			values[n] = r->value.array()[0];
+		else
+			continue;
+		found++;
+	}
+
+	return found;
+}
+
+static cell_t ContainsKeysInTrie(IPluginContext *pContext, const cell_t *params)
+{
+	CellTrie *pTrie;
+	HandleError err;
+	HandleSecurity sec = HandleSecurity(pContext->GetIdentity(), g_pCoreIdent);
+
+	Handle_t hndl = params[1];
+
+	if ((err = handlesys->ReadHandle(hndl, htCellTrie, &sec, (void **)&pTrie))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
+	}
+
+	cell_t count = params[4];
+	cell_t *keys, *results;
+	if (!(keys = GetBatchBuffer(pContext, params[2], count))
+		|| !(results = GetBatchBuffer(pContext, params[3], count)))
+	{
+		return 0;
+	}
+
+	cell_t found = 0;
+	for (cell_t n = 0; n < count; n++)
+	{
+		char *key;
+		if (!GetBatchKey(pContext, params[2], keys, n, &key))
+			return 0;
+
+		results[n] = pTrie->map.contains(key) ? 1 : 0;
+		found += results[n];
+	}
+
+	return found;
+}
+
+static cell_t RemoveKeysFromTrie(IPluginContext *pContext, const cell_t *params)
+{
+	CellTrie *pTrie;
+	HandleError err;
+	HandleSecurity sec = HandleSecurity(pContext->GetIdentity(), g_pCoreIdent);
+
+	Handle_t hndl = params[1];
+
+	if ((err = handlesys->ReadHandle(hndl, htCellTrie, &sec, (void **)&pTrie))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
+	}
+
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, hndl);
+	}
+
+	cell_t count = params[3];
+	cell_t *keys;
+	if (!(keys = GetBatchBuffer(pContext, params[2], count)))
+		return 0;
+
+	cell_t removed = 0;
+	for (cell_t n = 0; n < count; n++)
+	{
+		char *key;
+		if (!GetBatchKey(pContext, params[2], keys, n, &key))
+			return 0;
+
+		StringHashMap<Entry>::Result r = pTrie->map.find(key);
+		if (!r.found())
+			continue;
+
+		pTrie->map.remove(r);
+		removed++;
+	}
+
+	if (removed)
+		pTrie->version++;
+
+	return removed;
+}
+
+static cell_t MergeTrie(IPluginContext *pContext, const cell_t *params)
+{
+	CellTrie *pTrie;
+	HandleError err;
+	HandleSecurity sec = HandleSecurity(pContext->GetIdentity(), g_pCoreIdent);
+
+	Handle_t hndl = params[1];
+
+	if ((err = handlesys->ReadHandle(hndl, htCellTrie, &sec, (void **)&pTrie))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
+	}
+
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, hndl);
+	}
+
+	CellTrie *pSource;
+	if ((err = handlesys->ReadHandle(params[2], htCellTrie, &sec, (void **)&pSource))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", params[2], err);
+	}
+
+	if (pSource == pTrie)
+		return 0;
+
+	cell_t copied = 0;
+	for (StringHashMap<Entry>::iterator it = pSource->map.iter(); !it.empty(); it.next())
+	{
+		const char *key = it->key.c_str();
+		StringHashMap<Entry>::Insert i = pTrie->map.findForAdd(key);
+		if (!i.found())
+		{
+			if (!pTrie->map.add(i, key))
+				continue;
+			pTrie->version++;
+		}
+		else if (!params[3])
+		{
+			continue;
+		}
+
+		const Entry &value = it->value;
+		if (value.isCell())
+			i->value.setCell(value.cell());
+		else if (value.isString())
+			i->value.setString(value.c_str());
+		else if (value.isArray())
+			i->value.setArray(value.array(), value.arrayLength());
+		copied++;
+	}
+
+	return copied;
+}
+
+static inline HandleType_t TrieHandleType(CellTrie *)
+{
+	return htCellTrie;
+}
+
+static inline HandleType_t TrieHandleType(IntCellTrie *)
+{
+	return htIntCellTrie;
+}
+
+static inline HandleType_t IteratorHandleType(CellTrie *)
+{
+	return htTrieIterator;
+}
+
+static inline HandleType_t IteratorHandleType(IntCellTrie *)
+{
+	return htIntTrieIterator;
+}
+
+template <typename T>
+static cell_t CreateTrieIterator(IPluginContext *pContext, const cell_t *params)
+{
+	HandleError err;
+	HandleSecurity sec = HandleSecurity(pContext->GetIdentity(), g_pCoreIdent);
+
+	Handle_t hndl = params[1];
+
+	T *pTrie;
+	if ((err = handlesys->ReadHandle(hndl, TrieHandleType((T *)NULL), &sec, (void **)&pTrie))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
+	}
+
+	TrieIterator<T> *iter = new TrieIterator<T>(hndl, pTrie);
+	if ((hndl = handlesys->CreateHandle(IteratorHandleType((T *)NULL), iter, pContext->GetIdentity(), g_pCoreIdent, NULL))
+		== BAD_HANDLE)
+	{
+		delete iter;
+		return BAD_HANDLE;
+	}
+
+	return hndl;
+}
+
+template <typename T>
+static cell_t FreezeTrie(IPluginContext *pContext, const cell_t *params)
+{
+	HandleError err;
+	HandleSecurity sec = HandleSecurity(pContext->GetIdentity(), g_pCoreIdent);
+
+	T *pTrie;
+	if ((err = handlesys->ReadHandle(params[1], TrieHandleType((T *)NULL), &sec, (void **)&pTrie))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", params[1], err);
+	}
+
+	if (pTrie->frozen)
+	{
+		return 1;
+	}
+
+	for (typename T::MapType::iterator it = pTrie->map.iter(); !it.empty(); it.next())
+	{
+		it->value.compact();
+	}
+	pTrie->frozen = true;
+
+	return 1;
+}
+
+template <typename T>
+static cell_t IsTrieFrozen(IPluginContext *pContext, const cell_t *params)
+{
+	HandleError err;
+	HandleSecurity sec = HandleSecurity(pContext->GetIdentity(), g_pCoreIdent);
+
+	T *pTrie;
+	if ((err = handlesys->ReadHandle(params[1], TrieHandleType((T *)NULL), &sec, (void **)&pTrie))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", params[1], err);
+	}
+
+	return pTrie->frozen ? 1 : 0;
+}
+
+// Reads an iterator Handle and checks that its map is still alive and has not
+// had keys added or removed. If |current| is set, the iterator must also be
+// positioned on an entry. Reports an error and returns NULL on failure.
+template <typename T>
+static TrieIterator<T> *ReadTrieIterator(IPluginContext *pContext, Handle_t hndl, bool current)
+{
+	HandleError err;
+	HandleSecurity sec = HandleSecurity(pContext->GetIdentity(), g_pCoreIdent);
+
+	TrieIterator<T> *iter;
+	if ((err = handlesys->ReadHandle(hndl, IteratorHandleType((T *)NULL), &sec, (void **)&iter))
+		!= HandleError_None)
+	{
+		pContext->ReportError("Invalid Handle %x (error %d)", hndl, err);
+		return NULL;
+	}
+
+	T *pTrie;
+	if ((err = handlesys->ReadHandle(iter->map, TrieHandleType((T *)NULL), &sec, (void **)&pTrie))
+		!= HandleError_None)
+	{
+		pContext->ReportError("Iterated map Handle %x is no longer valid (error %d)", iter->map, err);
+		return NULL;
+	}
+
+	if (pTrie->version != iter->version)
+	{
+		pContext->ReportError("Map was modified during iteration");
+		return NULL;
+	}
+
+	if (current && (!iter->started || iter->iter.empty()))
+	{
+		pContext->ReportError("Iterator is not positioned on an entry");
+		return NULL;
+	}
+
+	return iter;
+}
+
+template <typename T>
+static cell_t TrieIteratorNext(IPluginContext *pContext, const cell_t *params)
+{
+	TrieIterator<T> *iter = ReadTrieIterator<T>(pContext, params[1], false);
+	if (!iter)
+		return 0;
+
+	if (!iter->started)
+		iter->started = true;
+	else if (!iter->iter.empty())
+		iter->iter.next();
+
+	return iter->iter.empty() ? 0 : 1;
+}
+
+template <typename T>
+static cell_t TrieIteratorGetValue(IPluginContext *pContext, const cell_t *params)
+{
+	TrieIterator<T> *iter = ReadTrieIterator<T>(pContext, params[1], true);
+	if (!iter)
+		return 0;
+
+	cell_t *pValue;
+	pContext->LocalToPhysAddr(params[2], &pValue);
+
+	Entry &value = iter->iter->value;
+	if (value.isCell())
+	{
+		*pValue = value.cell();
+		return 1;
+	}
+
+	// Same single-cell array compatibility as GetTrieValue().
+	if (value.isArray() && value.arrayLength() == 1)
+	{
+		*pValue = value.array()[0];
+		return 1;
+	}
+
+	return 0;
+}
+
+template <typename T>
+static cell_t TrieIteratorGetArray(IPluginContext *pContext, const cell_t *params)
+{
+	TrieIterator<T> *iter = ReadTrieIterator<T>(pContext, params[1], true);
+	if (!iter)
+		return 0;
+
+	if (params[3] < 0)
+	{
+		return pContext->ThrowNativeError("Invalid array size: %d", params[3]);
+	}
+
+	cell_t *pValue, *pSize;
+	pContext->LocalToPhysAddr(params[2], &pValue);
+	pContext->LocalToPhysAddr(params[4], &pSize);
+
+	Entry &value = iter->iter->value;
+	if (!value.isArray())
+		return 0;
+
+	if (!value.array())
+	{
+		*pSize = 0;
+		return 1;
+	}
+
+	if (!params[3])
+		return 1;
+
+	size_t length = value.arrayLength();
+	if (length > size_t(params[3]))
+		*pSize = params[3];
+	else
+		*pSize = length;
+
+	memcpy(pValue, value.array(), sizeof(cell_t) * pSize[0]);
+	return 1;
+}
+
+template <typename T>
+static cell_t TrieIteratorGetString(IPluginContext *pContext, const cell_t *params)
+{
+	TrieIterator<T> *iter = ReadTrieIterator<T>(pContext, params[1], true);
+	if (!iter)
+		return 0;
+
+	if (params[3] < 0)
+	{
+		return pContext->ThrowNativeError("Invalid buffer size: %d", params[3]);
+	}
+
+	cell_t *pSize;
+	pContext->LocalToPhysAddr(params[4], &pSize);
+
+	Entry &value = iter->iter->value;
+	if (!value.isString())
+		return 0;
+
+	size_t written;
+	pContext->StringToLocalUTF8(params[2], params[3], value.c_str(), &written);
+
+	*pSize = (cell_t)written;
+	return 1;
+}
+
+static cell_t TrieIteratorGetKey(IPluginContext *pContext, const cell_t *params)
+{
+	TrieIterator<CellTrie> *iter = ReadTrieIterator<CellTrie>(pContext, params[1], true);
+	if (!iter)
+		return 0;
+
+	size_t written;
+	pContext->StringToLocalUTF8(params[2], params[3], iter->iter->key.c_str(), &written);
+	return written;
+}
+
+static cell_t TrieIteratorKeyBufferSize(IPluginContext *pContext, const cell_t *params)
+{
+	TrieIterator<CellTrie> *iter = ReadTrieIterator<CellTrie>(pContext, params[1], true);
+	if (!iter)
+		return 0;
+
+	return iter->iter->key.length() + 1;
+}
+
+static cell_t IntTrieIteratorGetKey(IPluginContext *pContext, const cell_t *params)
+{
+	TrieIterator<IntCellTrie> *iter = ReadTrieIterator<IntCellTrie>(pContext, params[1], true);
+	if (!iter)
+		return 0;
+
+	return iter->iter->key;
+}
+
+class ContainerBridge : public IContainerBridge
+{
+public:
+	Handle_t CreateStringMap(IdentityToken_t *owner, CellTrie **map) override
+	{
+		CellTrie *pTrie = new CellTrie;
+		Handle_t hndl = handlesys->CreateHandle(htCellTrie, pTrie, owner, g_pCoreIdent, NULL);
+		if (!hndl)
+		{
+			delete pTrie;
+			return BAD_HANDLE;
+		}
+		*map = pTrie;
+		return hndl;
+	}
+
+	Handle_t CreateArrayList(IdentityToken_t *owner, size_t blocksize, ICellArray **array) override
+	{
+		CellArray *pArray = new CellArray(blocksize);
+		Handle_t hndl = handlesys->CreateHandle(htCellArray, pArray, owner, g_pCoreIdent, NULL);
+		if (!hndl)
+		{
+			delete pArray;
+			return BAD_HANDLE;
+		}
+		*array = pArray;
+		return hndl;
+	}
+
+	CellTrie *ReadStringMap(Handle_t hndl, IdentityToken_t *owner) override
+	{
+		CellTrie *pTrie;
+		HandleSecurity sec(owner, g_pCoreIdent);
+		if (handlesys->ReadHandle(hndl, htCellTrie, &sec, (void **)&pTrie) != HandleError_None)
+		{
+			return NULL;
+		}
+		return pTrie;
+	}
+
+	void SetStringMapCell(CellTrie *map, const char *key, cell_t value) override
+	{
+		FindForSet(map, key)->setCell(value);
+	}
+
+	void SetStringMapString(CellTrie *map, const char *key, const char *value) override
+	{
+		FindForSet(map, key)->setString(value);
+	}
+
+	void SetStringMapArray(CellTrie *map, const char *key, const cell_t *values, size_t count) override
+	{
+		FindForSet(map, key)->setArray(const_cast<cell_t *>(values), count);
+	}
+
+	void VisitStringMap(CellTrie *map, IStringMapVisitor *visitor) override
+	{
+		for (StringHashMap<Entry>::iterator it = map->map.iter(); !it.empty(); it.next())
+		{
+			const char *key = it->key.c_str();
+			const Entry &entry = it->value;
+			if (entry.isCell())
+			{
+				visitor->OnCell(key, entry.cell());
+			}
+			else if (entry.isString())
+			{
+				visitor->OnString(key, entry.c_str());
+			}
+			else
+			{
+				visitor->OnArray(key, entry.array(), entry.arrayLength());
+			}
+		}
+	}
+
+private:
+	Entry *FindForSet(CellTrie *map, const char *key)
+	{
+		StringHashMap<Entry>::Insert i = map->map.findForAdd(key);
+		if (!i.found())
+		{
+			if (!map->map.add(i, key))
+			{
+				fprintf(stderr, "Out of memory!\n");
+				abort();
+			}
+			map->version++;
+		}
+		return &i->value;
+	}
+} s_ContainerBridge;
+
+extern IContainerBridge *const g_pContainerBridge = &s_ContainerBridge;
+
+/* Payload: entry count, then each key followed by its type and value. */
+static void SerializeTrie(CellTrie *pTrie, BlobWriter &writer)
+{
+	writer.WriteU32((uint32_t)pTrie->map.elements());
+	for (StringHashMap<Entry>::iterator it = pTrie->map.iter(); !it.empty(); it.next())
+	{
+		const Entry &entry = it->value;
+		writer.WriteString(it->key.c_str(), it->key.length());
+		if (entry.isCell())
+		{
+			writer.WriteU32(EntryType_Cell);
+			writer.WriteU32((uint32_t)entry.cell());
+		}
+		else if (entry.isString())
+		{
+			writer.WriteU32(EntryType_String);
+			writer.WriteString(entry.c_str(), strlen(entry.c_str()));
+		}
+		else
+		{
+			writer.WriteU32(EntryType_CellArray);
+			writer.WriteU32((uint32_t)entry.arrayLength());
+			writer.Write(entry.array(), entry.arrayLength() * sizeof(cell_t));
+		}
+	}
+}
+
+static bool DeserializeTrie(CellTrie *pTrie, const std::vector<uint8_t> &blob)
+{
+	BlobReader reader;
+	uint32_t count;
+	if (!reader.Open(blob, BlobKind_StringMap) || !reader.ReadU32(&count))
+	{
+		return false;
+	}
+
+	pTrie->map.clear();
+	pTrie->version++;
+
+	std::string key, str;
+	std::unique_ptr<cell_t[]> cells;
+	size_t cellsLength = 0;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		size_t length;
+		const char *chars = reader.ReadString(&length);
+		uint32_t type;
+		if (!chars || !reader.ReadU32(&type))
+		{
+			return false;
+		}
+		key.assign(chars, length);
+
+		StringHashMap<Entry>::Insert insert = pTrie->map.findForAdd(key.c_str());
+		if (!insert.found() && !pTrie->map.add(insert, key.c_str()))
+		{
+			return false;
+		}
+
+		if (type == EntryType_Cell)
+		{
+			uint32_t value;
+			if (!reader.ReadU32(&value))
+			{
+				return false;
+			}
+			insert->value.setCell((cell_t)value);
+		}
+		else if (type == EntryType_String)
+		{
+			if (!(chars = reader.ReadString(&length)))
+			{
+				return false;
+			}
+			str.assign(chars, length);
+			insert->value.setString(str.c_str());
+		}
+		else if (type == EntryType_CellArray)
+		{
+			uint32_t num;
+			const uint8_t *data;
+			if (!reader.ReadU32(&num) || !(data = reader.Take((size_t)num * sizeof(cell_t))))
+			{
+				return false;
+			}
+			/* The payload has no alignment guarantees, so copy it out first. */
+			if (num > cellsLength)
+			{
+				cells.reset(new cell_t[num]);
+				cellsLength = num;
+			}
+			memcpy(cells.get(), data, num * sizeof(cell_t));
+			insert->value.setArray(cells.get(), num);
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return reader.Remaining() == 0;
+}
+
+static cell_t SaveTrieToFile(IPluginContext *pContext, const cell_t *params)
+{
+	HandleError err;
+	HandleSecurity sec = HandleSecurity(pContext->GetIdentity(), g_pCoreIdent);
+
+	CellTrie *pTrie;
+	if ((err = handlesys->ReadHandle(params[1], htCellTrie, &sec, (void **)&pTrie))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", params[1], err);
+	}
+
+	char *path;
+	pContext->LocalToString(params[2], &path);
+
+	BlobWriter writer(BlobKind_StringMap);
+	SerializeTrie(pTrie, writer);
+
+	return g_BlobStore.SaveFile(path, writer.Finish()) ? 1 : 0;
+}
+
+static cell_t LoadTrieFromFile(IPluginContext *pContext, const cell_t *params)
+{
+	HandleError err;
+	HandleSecurity sec = HandleSecurity(pContext->GetIdentity(), g_pCoreIdent);
+
+	CellTrie *pTrie;
+	if ((err = handlesys->ReadHandle(params[1], htCellTrie, &sec, (void **)&pTrie))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", params[1], err);
+	}
+
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, params[1]);
+	}
+
+	char *path;
+	pContext->LocalToString(params[2], &path);
+
+	std::vector<uint8_t> blob;
+	if (!g_BlobStore.LoadFile(path, &blob))
+	{
+		return 0;
+	}
+
+	return DeserializeTrie(pTrie, blob) ? 1 : 0;
+}
+
+static cell_t SaveTrieToMemory(IPluginContext *pContext, const cell_t *params)
+{
+	HandleError err;
+	HandleSecurity sec = HandleSecurity(pContext->GetIdentity(), g_pCoreIdent);
+
+	CellTrie *pTrie;
+	if ((err = handlesys->ReadHandle(params[1], htCellTrie, &sec, (void **)&pTrie))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", params[1], err);
+	}
+
+	char *key;
+	pContext->LocalToString(params[2], &key);
+
+	BlobWriter writer(BlobKind_StringMap);
+	SerializeTrie(pTrie, writer);
+	g_BlobStore.Stash(key, std::move(writer.Finish()));
+
+	return 1;
+}
+
+static cell_t LoadTrieFromMemory(IPluginContext *pContext, const cell_t *params)
+{
+	HandleError err;
+	HandleSecurity sec = HandleSecurity(pContext->GetIdentity(), g_pCoreIdent);
+
+	CellTrie *pTrie;
+	if ((err = handlesys->ReadHandle(params[1], htCellTrie, &sec, (void **)&pTrie))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", params[1], err);
+	}
+
+	if (pTrie->frozen)
+	{
+		return ThrowFrozenMap(pContext, params[1]);
+	}
+
+	char *key;
+	pContext->LocalToString(params[2], &key);
+
+	std::vector<uint8_t> blob;
+	if (!g_BlobStore.Unstash(key, &blob, params[3] != 0))
+	{
+		return 0;
+	}
+
+	return DeserializeTrie(pTrie, blob) ? 1 : 0;
+}
+
+REGISTER_NATIVES(trieNatives)
+{
+	{"ClearTrie",				ClearTrie},
+	{"CreateTrie",				CreateTrie},
+	{"GetTrieArray",			GetTrieArray},
+	{"GetTrieString",			GetTrieString},
+	{"GetTrieValue",			GetTrieValue},
+	{"RemoveFromTrie",			RemoveFromTrie},
+	{"SetTrieArray",			SetTrieArray},
+	{"SetTrieString",			SetTrieString},
+	{"SetTrieValue",			SetTrieValue},
+	{"GetTrieSize",				GetTrieSize},
+
+	{"CreateTrieSnapshot",		CreateTrieSnapshot},
+	{"TrieSnapshotLength",		TrieSnapshotLength},
+	{"TrieSnapshotKeyBufferSize", TrieSnapshotKeyBufferSize},
+	{"GetTrieSnapshotKey",		GetTrieSnapshotKey},
+
+	// Transitional syntax support.
+	{"StringMap.StringMap",		CreateTrie},
+	{"StringMap.Clear",			ClearTrie},
+	{"StringMap.GetArray",		GetTrieArray},
+	{"StringMap.GetString",		GetTrieString},
+	{"StringMap.GetValue",		GetTrieValue},
+	{"StringMap.ContainsKey",	ContainsKeyInTrie},
+	{"StringMap.Remove",		RemoveFromTrie},
+	{"StringMap.SetArray",		SetTrieArray},
+	{"StringMap.SetString",		SetTrieString},
+	{"StringMap.SetValue",		SetTrieValue},
+	{"StringMap.Size.get",		GetTrieSize},
+	{"StringMap.Snapshot",		CreateTrieSnapshot},
+	{"StringMap.Clone",			CloneTrie},
+	{"StringMap.Iterator",		CreateTrieIterator<CellTrie>},
+	{"StringMap.SetValues",		SetTrieValues},
+	{"StringMap.GetValues",		GetTrieValues},
+	{"StringMap.ContainsKeys",	ContainsKeysInTrie},
+	{"StringMap.RemoveKeys",	RemoveKeysFromTrie},
+	{"StringMap.Merge",			MergeTrie},
+	{"StringMap.SaveToFile",	SaveTrieToFile},
+	{"StringMap.LoadFromFile",	LoadTrieFromFile},
+	{"StringMap.SaveToMemory",	SaveTrieToMemory},
+	{"StringMap.LoadFromMemory",	LoadTrieFromMemory},
+	{"StringMap.Freeze",		FreezeTrie<CellTrie>},
+	{"StringMap.Frozen.get",	IsTrieFrozen<CellTrie>},
+
+	{"IntMap.IntMap",			CreateIntTrie},
+	{"IntMap.Clear",			ClearIntTrie},
+	{"IntMap.GetArray",			GetIntTrieArray},
+	{"IntMap.GetString",		GetIntTrieString},
+	{"IntMap.GetValue",			GetIntTrieValue},
+	{"IntMap.ContainsKey",		ContainsKeyInIntTrie},
+	{"IntMap.Remove",			RemoveFromIntTrie},
+	{"IntMap.SetArray",			SetIntTrieArray},
+	{"IntMap.SetString",		SetIntTrieString},
+	{"IntMap.SetValue",			SetIntTrieValue},
+	{"IntMap.Size.get",			GetIntTrieSize},
+	{"IntMap.Snapshot",			CreateIntTrieSnapshot},
+	{"IntMap.Clone",			CloneIntTrie},
+	{"IntMap.Iterator",			CreateTrieIterator<IntCellTrie>},
+	{"IntMap.Freeze",			FreezeTrie<IntCellTrie>},
+	{"IntMap.Frozen.get",		IsTrieFrozen<IntCellTrie>},
+
+	{"StringMapSnapshot.Length.get",	TrieSnapshotLength},
+	{"StringMapSnapshot.KeyBufferSize", TrieSnapshotKeyBufferSize},
+	{"StringMapSnapshot.GetKey",		GetTrieSnapshotKey},
+
+	{"IntMapSnapshot.Length.get",	IntTrieSnapshotLength},
+	{"IntMapSnapshot.GetKey",		GetIntTrieSnapshotKey},
+
+	{"StringMapIterator.Next",			TrieIteratorNext<CellTrie>},
+	{"StringMapIterator.GetKey",		TrieIteratorGetKey},
+	{"StringMapIterator.KeyBufferSize.get",	TrieIteratorKeyBufferSize},
+	{"StringMapIterator.GetValue",		TrieIteratorGetValue<CellTrie>},
+	{"StringMapIterator.GetArray",		TrieIteratorGetArray<CellTrie>},
+	{"StringMapIterator.GetString",		TrieIteratorGetString<CellTrie>},
+
+	{"IntMapIterator.Next",			TrieIteratorNext<IntCellTrie>},
+	{"IntMapIterator.Key.get",		IntTrieIteratorGetKey},
+	{"IntMapIterator.GetValue",		TrieIteratorGetValue<IntCellTrie>},
+	{"IntMapIterator.GetArray",		TrieIteratorGetArray<IntCellTrie>},
+	{"IntMapIterator.GetString",	TrieIteratorGetString<IntCellTrie>},
 
 	{NULL,						NULL},
 };
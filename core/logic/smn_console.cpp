@@ -98,7 +98,7 @@ static cell_t sm_PrintToServer(IPluginContext *pCtx, const cell_t *params)
 	buffer[res++] = '\n';
 	buffer[res] = '\0';
 
-	bridge->ConPrint(buffer);
+	bridge->FastConPrint(buffer);
 
 	return 1;
 }
@@ -106,7 +106,7 @@ static cell_t sm_PrintToServer(IPluginContext *pCtx, const cell_t *params)
 static cell_t sm_PrintToConsole(IPluginContext *pCtx, const cell_t *params)
 {
 	int index = params[1];
-	if ((index < 0) || (index > playerhelpers->GetMaxClients()))
+	if ((index < 0) || (index > *bridge->maxClients))
 	{
 		return pCtx->ThrowNativeError("Client index %d is invalid", index);
 	}
@@ -144,7 +144,7 @@ static cell_t sm_PrintToConsole(IPluginContext *pCtx, const cell_t *params)
 		pPlayer->PrintToConsole(buffer);
 	}
 	else {
-		bridge->ConPrint(buffer);
+		bridge->FastConPrint(buffer);
 	}
 
 	return 1;
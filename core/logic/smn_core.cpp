@@ -32,6 +32,7 @@
 #include <time.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <iomanip>
 #include <sstream>
 #include <list>
@@ -60,6 +61,7 @@
 #include <bridge/include/IScriptManager.h>
 #include <bridge/include/IExtensionBridge.h>
 #include "PseudoAddrManager.h"
+#include "MemoryUtils.h"
 #include <sh_vector.h>
 
 using namespace SourceMod;
@@ -777,7 +779,8 @@ static cell_t GetExtensionFileStatus(IPluginContext *pContext, const cell_t *par
 		return -2;
 	}
 	
-	if (!pExtension->IsLoaded())
+	/* Deferred extensions aren't loaded yet, but report as running. */
+	if (!pExtension->IsLoaded() && !pExtension->IsRunning(NULL, 0))
 	{
 		return -1;
 	}
@@ -862,23 +865,32 @@ enum NumberType
 //memory addresses below 0x10000 are automatically considered invalid for dereferencing
 #define VALID_MINIMUM_MEMORY_ADDRESS 0x10000
 
-static cell_t LoadFromAddress(IPluginContext *pContext, const cell_t *params)
+static void *ResolveAddress(IPluginContext *pContext, cell_t addr, cell_t offset)
 {
-	void *addr = reinterpret_cast<void*>(params[1]);
+	void *base = reinterpret_cast<void*>(addr);
 	if (pContext->GetRuntime()->FindPubvarByName("__Virtual_Address__", nullptr) == SP_ERROR_NONE) {
-		addr = pseudoAddr.FromPseudoAddress(params[1]);
+		base = pseudoAddr.FromPseudoAddress(addr);
 	}
 
-	if (addr == NULL)
+	if (base == NULL)
 	{
-		return pContext->ThrowNativeError("Address cannot be null");
+		pContext->ReportError("Address cannot be null");
+		return NULL;
 	}
-	else if (reinterpret_cast<uintptr_t>(addr) < VALID_MINIMUM_MEMORY_ADDRESS)
+
+	// The offset is applied to the real address, so an offset access never
+	// needs its own pseudo-address translation.
+	void *target = reinterpret_cast<uint8_t*>(base) + offset;
+	if (reinterpret_cast<uintptr_t>(target) < VALID_MINIMUM_MEMORY_ADDRESS)
 	{
-		return pContext->ThrowNativeError("Invalid address %p is pointing to reserved memory.", addr);
+		pContext->ReportError("Invalid address %p is pointing to reserved memory.", target);
+		return NULL;
 	}
-	NumberType size = static_cast<NumberType>(params[2]);
+	return target;
+}
 
+static cell_t LoadNumber(IPluginContext *pContext, void *addr, NumberType size)
+{
 	switch(size)
 	{
 	case NumberType_Int8:
@@ -892,24 +904,56 @@ static cell_t LoadFromAddress(IPluginContext *pContext, const cell_t *params)
 	}
 }
 
-static cell_t StoreToAddress(IPluginContext *pContext, const cell_t *params)
+static cell_t StoreNumber(IPluginContext *pContext, void *addr, cell_t data, NumberType size, bool updateMemAccess)
 {
-	void *addr = reinterpret_cast<void*>(params[1]);
-	if (pContext->GetRuntime()->FindPubvarByName("__Virtual_Address__", nullptr) == SP_ERROR_NONE) {
-		addr = pseudoAddr.FromPseudoAddress(params[1]);
+	switch(size)
+	{
+	case NumberType_Int8:
+		if (updateMemAccess)
+		{
+			SourceHook::SetMemAccess(addr, sizeof(uint8_t), SH_MEM_READ|SH_MEM_WRITE|SH_MEM_EXEC);
+		}
+		*reinterpret_cast<uint8_t*>(addr) = data;
+		break;
+	case NumberType_Int16:
+		if (updateMemAccess)
+		{
+			SourceHook::SetMemAccess(addr, sizeof(uint16_t), SH_MEM_READ|SH_MEM_WRITE|SH_MEM_EXEC);
+		}
+		*reinterpret_cast<uint16_t*>(addr) = data;
+		break;
+	case NumberType_Int32:
+		if (updateMemAccess)
+		{
+			SourceHook::SetMemAccess(addr, sizeof(uint32_t), SH_MEM_READ|SH_MEM_WRITE|SH_MEM_EXEC);
+		}
+		*reinterpret_cast<uint32_t*>(addr) = data;
+		break;
+	default:
+		return pContext->ThrowNativeError("Invalid number types %d", size);
 	}
 
+	return 0;
+}
+
+static cell_t LoadFromAddress(IPluginContext *pContext, const cell_t *params)
+{
+	void *addr = ResolveAddress(pContext, params[1], 0);
 	if (addr == NULL)
 	{
-		return pContext->ThrowNativeError("Address cannot be null");
+		return 0;
 	}
-	else if (reinterpret_cast<uintptr_t>(addr) < VALID_MINIMUM_MEMORY_ADDRESS)
+
+	return LoadNumber(pContext, addr, static_cast<NumberType>(params[2]));
+}
+
+static cell_t StoreToAddress(IPluginContext *pContext, const cell_t *params)
+{
+	void *addr = ResolveAddress(pContext, params[1], 0);
+	if (addr == NULL)
 	{
-		return pContext->ThrowNativeError("Invalid address %p is pointing to reserved memory.", addr);
+		return 0;
 	}
-	cell_t data = params[2];
-
-	NumberType size = static_cast<NumberType>(params[3]);
 
 	// new parameter added after SM 1.10; defaults to true for backwards compatibility
 	bool updateMemAccess = true;
@@ -918,33 +962,213 @@ static cell_t StoreToAddress(IPluginContext *pContext, const cell_t *params)
 		updateMemAccess = params[4];
 	}
 
+	return StoreNumber(pContext, addr, params[2], static_cast<NumberType>(params[3]), updateMemAccess);
+}
+
+static cell_t LoadFromAddressOffset(IPluginContext *pContext, const cell_t *params)
+{
+	void *addr = ResolveAddress(pContext, params[1], params[2]);
+	if (addr == NULL)
+	{
+		return 0;
+	}
+
+	return LoadNumber(pContext, addr, static_cast<NumberType>(params[3]));
+}
+
+static cell_t StoreToAddressOffset(IPluginContext *pContext, const cell_t *params)
+{
+	void *addr = ResolveAddress(pContext, params[1], params[2]);
+	if (addr == NULL)
+	{
+		return 0;
+	}
+
+	return StoreNumber(pContext, addr, params[3], static_cast<NumberType>(params[4]), params[5] != 0);
+}
+
+static size_t GetNumberTypeSize(NumberType size)
+{
 	switch(size)
 	{
 	case NumberType_Int8:
-		if (updateMemAccess)
-		{
-			SourceHook::SetMemAccess(addr, sizeof(uint8_t), SH_MEM_READ|SH_MEM_WRITE|SH_MEM_EXEC);
-		}
-		*reinterpret_cast<uint8_t*>(addr) = data;
+		return sizeof(uint8_t);
+	case NumberType_Int16:
+		return sizeof(uint16_t);
+	case NumberType_Int32:
+		return sizeof(uint32_t);
+	default:
+		return 0;
+	}
+}
+
+// Resolves a whole range up front so the copy loops below never need to
+// translate or validate individual elements.
+static uint8_t *ResolveRange(IPluginContext *pContext, cell_t addr, cell_t count, cell_t stride, size_t width)
+{
+	if (count < 0)
+	{
+		pContext->ReportError("Invalid element count %d", count);
+		return NULL;
+	}
+	if (stride < 0 || static_cast<size_t>(stride) < width)
+	{
+		pContext->ReportError("Stride %d is smaller than the element size %d", stride, static_cast<int>(width));
+		return NULL;
+	}
+	if (count > 1 && static_cast<size_t>(count - 1) > (SIZE_MAX - width) / static_cast<size_t>(stride))
+	{
+		pContext->ReportError("Address range of %d elements with stride %d is too large", count, stride);
+		return NULL;
+	}
+
+	uint8_t *base = reinterpret_cast<uint8_t*>(ResolveAddress(pContext, addr, 0));
+	if (base == NULL)
+	{
+		return NULL;
+	}
+
+	size_t len = static_cast<size_t>(count - 1) * stride + width;
+	if (!g_MemUtils.IsRangeAccessible(base, len))
+	{
+		pContext->ReportError("Address range %p-%p is not accessible.", base, base + len);
+		return NULL;
+	}
+	return base;
+}
+
+template <typename T>
+static void ReadStrided(const uint8_t *src, size_t stride, cell_t *dest, cell_t count)
+{
+	for (cell_t i = 0; i < count; i++, src += stride)
+	{
+		T value;
+		memcpy(&value, src, sizeof(T));
+		dest[i] = value;
+	}
+}
+
+template <typename T>
+static void WritePacked(uint8_t *dest, const cell_t *src, cell_t count)
+{
+	for (cell_t i = 0; i < count; i++, dest += sizeof(T))
+	{
+		T value = static_cast<T>(src[i]);
+		memcpy(dest, &value, sizeof(T));
+	}
+}
+
+static cell_t LoadStrided(IPluginContext *pContext, cell_t addr, cell_t stride, cell_t buffer, cell_t count, NumberType size)
+{
+	size_t width = GetNumberTypeSize(size);
+	if (width == 0)
+	{
+		return pContext->ThrowNativeError("Invalid number types %d", size);
+	}
+	if (stride == 0)
+	{
+		stride = static_cast<cell_t>(width);
+	}
+
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	uint8_t *base = ResolveRange(pContext, addr, count, stride, width);
+	if (base == NULL)
+	{
+		return 0;
+	}
+
+	cell_t *dest;
+	pContext->LocalToPhysAddr(buffer, &dest);
+
+	switch(size)
+	{
+	case NumberType_Int8:
+		ReadStrided<uint8_t>(base, stride, dest, count);
 		break;
 	case NumberType_Int16:
-		if (updateMemAccess)
-		{
-			SourceHook::SetMemAccess(addr, sizeof(uint16_t), SH_MEM_READ|SH_MEM_WRITE|SH_MEM_EXEC);
-		}
-		*reinterpret_cast<uint16_t*>(addr) = data;
+		ReadStrided<uint16_t>(base, stride, dest, count);
 		break;
 	case NumberType_Int32:
-		if (updateMemAccess)
+		if (static_cast<size_t>(stride) == width)
 		{
-			SourceHook::SetMemAccess(addr, sizeof(uint32_t), SH_MEM_READ|SH_MEM_WRITE|SH_MEM_EXEC);
+			memcpy(dest, base, count * width);
+		}
+		else
+		{
+			ReadStrided<uint32_t>(base, stride, dest, count);
 		}
-		*reinterpret_cast<uint32_t*>(addr) = data;
 		break;
 	default:
+		break;
+	}
+
+	return count;
+}
+
+static cell_t LoadArrayFromAddress(IPluginContext *pContext, const cell_t *params)
+{
+	return LoadStrided(pContext, params[1], 0, params[2], params[3], static_cast<NumberType>(params[4]));
+}
+
+static cell_t LoadFromAddressStrided(IPluginContext *pContext, const cell_t *params)
+{
+	if (params[2] <= 0)
+	{
+		return pContext->ThrowNativeError("Invalid stride %d", params[2]);
+	}
+
+	return LoadStrided(pContext, params[1], params[2], params[3], params[4], static_cast<NumberType>(params[5]));
+}
+
+static cell_t StoreArrayToAddress(IPluginContext *pContext, const cell_t *params)
+{
+	NumberType size = static_cast<NumberType>(params[4]);
+	size_t width = GetNumberTypeSize(size);
+	if (width == 0)
+	{
 		return pContext->ThrowNativeError("Invalid number types %d", size);
 	}
 
+	cell_t count = params[3];
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	uint8_t *base = ResolveRange(pContext, params[1], count, static_cast<cell_t>(width), width);
+	if (base == NULL)
+	{
+		return 0;
+	}
+
+	cell_t *src;
+	pContext->LocalToPhysAddr(params[2], &src);
+
+	// Adjust protection once for the whole range instead of per element.
+	if (params[5])
+	{
+		SourceHook::SetMemAccess(base, count * width, SH_MEM_READ|SH_MEM_WRITE|SH_MEM_EXEC);
+	}
+
+	switch(size)
+	{
+	case NumberType_Int8:
+		WritePacked<uint8_t>(base, src, count);
+		break;
+	case NumberType_Int16:
+		WritePacked<uint16_t>(base, src, count);
+		break;
+	case NumberType_Int32:
+		memcpy(base, src, count * width);
+		break;
+	default:
+		break;
+	}
+
 	return 0;
 }
 
@@ -1209,6 +1433,11 @@ REGISTER_NATIVES(coreNatives)
 	{"RequireFeature",          RequireFeature},
 	{"LoadFromAddress",         LoadFromAddress},
 	{"StoreToAddress",          StoreToAddress},
+	{"LoadFromAddressOffset",   LoadFromAddressOffset},
+	{"StoreToAddressOffset",    StoreToAddressOffset},
+	{"LoadArrayFromAddress",    LoadArrayFromAddress},
+	{"LoadFromAddressStrided",  LoadFromAddressStrided},
+	{"StoreArrayToAddress",     StoreArrayToAddress},
 	{"LoadAddressFromAddress",  LoadAddressFromAddress},
 	{"StoreAddressToAddress",   StoreAddressToAddress},
 	{"IsNullVector",			IsNullVector},
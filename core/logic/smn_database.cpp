@@ -29,15 +29,21 @@
  * Version: $Id$
  */
 
+#include <chrono>
+#include <climits>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 
 #include "common_logic.h"
 #include "Database.h"
+#include "DBResultChunk.h"
 #include "ExtensionSys.h"
 #include "sprintf.h"
 #include "stringutil.h"
 #include "ISourceMod.h"
 #include "AutoHandleRooter.h"
+#include "CellArray.h"
 #include "common_logic.h"
 #include <amtl/am-string.h>
 #include <amtl/am-vector.h>
@@ -53,9 +59,14 @@ struct CombinedQuery
 {
 	IQuery *query;
 	IDatabase *db;
+	DBResultChunk *chunk;
 
 	CombinedQuery(IQuery *query, IDatabase *db)
-	: query(query), db(db)
+	: query(query), db(db), chunk(NULL)
+	{
+	}
+	CombinedQuery(DBResultChunk *chunk, IDatabase *db)
+	: query(chunk), db(db), chunk(chunk)
 	{
 	}
 };
@@ -149,7 +160,8 @@ inline HandleError ReadQueryHndl(Handle_t hndl, IPluginContext *pContext, IQuery
 	return ret;
 }
 
-inline HandleError ReadQueryAndDbHndl(Handle_t hndl, IPluginContext *pContext, IQuery **query, IDatabase **db)
+inline HandleError ReadQueryAndDbHndl(Handle_t hndl, IPluginContext *pContext, IQuery **query, IDatabase **db,
+	DBResultChunk **chunk = NULL)
 {
 	HandleSecurity sec;
 	CombinedQuery *c;
@@ -161,6 +173,10 @@ inline HandleError ReadQueryAndDbHndl(Handle_t hndl, IPluginContext *pContext, I
 	{
 		*query = c->query;
 		*db = c->db;
+		if (chunk)
+		{
+			*chunk = c->chunk;
+		}
 	}
 	return ret;
 }
@@ -188,10 +204,10 @@ inline HandleError ReadDbOrStmtHndl(Handle_t hndl, IPluginContext *pContext, IDa
 class TQueryOp : public IDBThreadOperation
 {
 public:
-	TQueryOp(IDatabase *db, IPluginFunction *pf, const char *query, cell_t data) : 
+	TQueryOp(IDatabase *db, IPluginFunction *pf, const char *query, cell_t data, unsigned int cacheTTL = 0) : 
 	  m_pDatabase(db), m_pFunction(pf), m_Query(query), m_Data(data),
 	  me(scripts->FindPluginByContext(pf->GetParentContext()->GetContext())),
-	  m_pQuery(NULL)
+	  m_pQuery(NULL), m_pChunk(NULL), m_CacheTTL(cacheTTL)
 	{
 		/* We always increase the reference count because this is potentially
 		 * asynchronous.  Otherwise the original handle could be closed while 
@@ -227,6 +243,12 @@ public:
 	{
 		return m_pDatabase->GetDriver();
 	}
+	/* Serves the query from the result cache instead of the database. */
+	void SetCachedResult(DBResultChunk *chunk)
+	{
+		m_pQuery = m_pChunk = chunk;
+		m_CacheTTL = 0;
+	}
 	void RunThreadPart()
 	{
 		m_pDatabase->LockForFullAtomicOperation();
@@ -235,6 +257,19 @@ public:
 		{
 			g_pSM->Format(error, sizeof(error), "%s", m_pDatabase->GetError());
 		}
+		else if (m_CacheTTL && m_pQuery->GetResultSet())
+		{
+			/* Snapshot the rows here, off the main thread, so the result can be
+			 * cached; the plugin reads from the snapshot too.
+			 */
+			IResultSet *rs = m_pQuery->GetResultSet();
+			m_pChunk = new DBResultChunk(rs,
+				m_pDatabase->GetAffectedRowsForQuery(m_pQuery),
+				m_pDatabase->GetInsertIDForQuery(m_pQuery));
+			m_pChunk->Fill(rs, UINT_MAX);
+			m_pQuery->Destroy();
+			m_pQuery = m_pChunk;
+		}
 		m_pDatabase->UnlockFromFullAtomicOperation();
 	}
 	void CancelThinkPart()
@@ -255,9 +290,16 @@ public:
 
 		Handle_t qh = BAD_HANDLE;
 		
+		if (m_pChunk && m_CacheTTL)
+		{
+			g_DBMan.CacheQuery(m_pDatabase, m_Query.c_str(), new DBResultChunk(*m_pChunk), m_CacheTTL);
+		}
+
 		if (m_pQuery)
 		{
-			CombinedQuery *c = new CombinedQuery(m_pQuery, m_pDatabase);
+			CombinedQuery *c = m_pChunk
+				? new CombinedQuery(m_pChunk, m_pDatabase)
+				: new CombinedQuery(m_pQuery, m_pDatabase);
 			
 			qh = CreateLocalHandle(hCombinedQueryType, c, &sec);
 			if (qh != BAD_HANDLE)
@@ -294,6 +336,296 @@ private:
 	cell_t m_Data;
 	IPlugin *me;
 	IQuery *m_pQuery;
+	DBResultChunk *m_pChunk;	/* m_pQuery, when it is a result snapshot */
+	unsigned int m_CacheTTL;
+	char error[255];
+	Handle_t m_MyHandle;
+};
+
+/* Flow control shared between a streamed query and the blocks it has handed
+ * to the main thread.
+ */
+struct StreamFlowState
+{
+	std::mutex lock;
+	std::condition_variable cond;
+	unsigned int inFlight = 0;
+};
+
+class TStreamBlockOp : public IDBThreadOperation
+{
+public:
+	TStreamBlockOp(IDatabase *db, IPluginFunction *pf, IPlugin *me, Handle_t dbHandle, cell_t data,
+		DBResultChunk *chunk, const std::shared_ptr<StreamFlowState> &flow)
+	 : m_pDatabase(db), m_pFunction(pf), me(me), m_DbHandle(dbHandle), m_Data(data),
+	   m_pChunk(chunk), m_Flow(flow)
+	{
+	}
+	~TStreamBlockOp()
+	{
+		if (m_pChunk)
+		{
+			m_pChunk->Destroy();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Flow->lock);
+			m_Flow->inFlight--;
+		}
+		m_Flow->cond.notify_one();
+	}
+	IdentityToken_t *GetOwner()
+	{
+		return me->GetIdentity();
+	}
+	IDBDriver *GetDriver()
+	{
+		return m_pDatabase->GetDriver();
+	}
+	void RunThreadPart()
+	{
+	}
+	void CancelThinkPart()
+	{
+		/* The query's final callback reports the cancellation. */
+	}
+	void RunThinkPart()
+	{
+		if (!m_pFunction->IsRunnable())
+			return;
+
+		HandleSecurity sec(me->GetIdentity(), g_pCoreIdent);
+
+		CombinedQuery *c = new CombinedQuery(m_pChunk, m_pDatabase);
+		Handle_t qh = CreateLocalHandle(hCombinedQueryType, c, &sec);
+		if (qh == BAD_HANDLE)
+		{
+			delete c;
+			return;
+		}
+		m_pChunk = NULL;
+
+		m_pFunction->PushCell(m_DbHandle);
+		m_pFunction->PushCell(qh);
+		m_pFunction->PushString("");
+		m_pFunction->PushCell(m_Data);
+		m_pFunction->PushCell(0);
+		m_pFunction->Execute(NULL);
+
+		handlesys->FreeHandle(qh, &sec);
+	}
+	void Destroy()
+	{
+		delete this;
+	}
+private:
+	IDatabase *m_pDatabase;
+	IPluginFunction *m_pFunction;
+	IPlugin *me;
+	Handle_t m_DbHandle;
+	cell_t m_Data;
+	DBResultChunk *m_pChunk;
+	std::shared_ptr<StreamFlowState> m_Flow;
+};
+
+class TStreamQueryOp : public IDBThreadOperation
+{
+	/* Blocks that may be waiting on the main thread at once. */
+	static const unsigned int kMaxBlocksInFlight = 4;
+
+	/* If the main thread makes no progress for this long it is probably
+	 * blocked on this very connection (or on shutdown), so emit the block
+	 * anyway.  The wait is repeated for every block, so a stalled main thread
+	 * slows the stream down instead of letting it buffer the whole result.
+	 */
+	static constexpr std::chrono::milliseconds kStallTimeout{250};
+public:
+	TStreamQueryOp(IDatabase *db, IPluginFunction *pf, const char *query, cell_t data, unsigned int blockRows)
+	 : m_pDatabase(db), m_pFunction(pf), m_Query(query), m_Data(data), m_BlockRows(blockRows),
+	   me(scripts->FindPluginByContext(pf->GetParentContext()->GetContext())),
+	   m_pLast(NULL), m_Synchronous(false), m_Flow(std::make_shared<StreamFlowState>())
+	{
+		error[0] = '\0';
+
+		m_pDatabase->IncReferenceCount();
+
+		HandleSecurity sec(me->GetIdentity(), g_pCoreIdent);
+		m_MyHandle = CreateLocalHandle(g_DBMan.GetDatabaseType(), m_pDatabase, &sec);
+	}
+	~TStreamQueryOp()
+	{
+		for (size_t i = 0; i < m_Pending.size(); i++)
+		{
+			m_Pending[i]->Destroy();
+		}
+		if (m_pLast)
+		{
+			m_pLast->Destroy();
+		}
+
+		if (m_MyHandle != BAD_HANDLE)
+		{
+			HandleSecurity sec(me->GetIdentity(), g_pCoreIdent);
+			handlesys->FreeHandle(m_MyHandle, &sec);
+		} else {
+			m_pDatabase->Close();
+		}
+	}
+	IdentityToken_t *GetOwner()
+	{
+		return me->GetIdentity();
+	}
+	IDBDriver *GetDriver()
+	{
+		return m_pDatabase->GetDriver();
+	}
+	void SetSynchronous()
+	{
+		m_Synchronous = true;
+	}
+	void RunThreadPart()
+	{
+		m_pDatabase->LockForFullAtomicOperation();
+
+		IResultStream *stream;
+		if (m_pDatabase->GetDriver()->GetDBIVersion() >= 10)
+		{
+			stream = m_pDatabase->DoQueryStream(m_Query.c_str(), m_Query.size());
+		} else {
+			IQuery *query = m_pDatabase->DoQuery(m_Query.c_str());
+			stream = query ? new BufferedResultStream(m_pDatabase, query) : NULL;
+		}
+
+		if (!stream)
+		{
+			g_pSM->Format(error, sizeof(error), "%s", m_pDatabase->GetError());
+			m_pDatabase->UnlockFromFullAtomicOperation();
+			return;
+		}
+
+		IResultSet *rs = stream->GetResultSet();
+		while (true)
+		{
+			DBResultChunk *chunk = new DBResultChunk(rs, stream->GetAffectedRows(), stream->GetInsertID());
+			if (!rs || chunk->Fill(rs, m_BlockRows) < m_BlockRows || !rs->MoreRows())
+			{
+				m_pLast = chunk;
+				break;
+			}
+
+			if (!m_Synchronous)
+			{
+				WaitForRoom();
+			}
+			Emit(chunk);
+		}
+
+		int errCode = 0;
+		const char *err = stream->GetError(&errCode);
+		if (errCode != 0)
+		{
+			g_pSM->Format(error, sizeof(error), "%s", err);
+			m_pLast->Destroy();
+			m_pLast = NULL;
+		}
+
+		stream->Destroy();
+		m_pDatabase->UnlockFromFullAtomicOperation();
+	}
+	void CancelThinkPart()
+	{
+		if (!m_pFunction->IsRunnable())
+			return;
+
+		m_pFunction->PushCell(BAD_HANDLE);
+		m_pFunction->PushCell(BAD_HANDLE);
+		m_pFunction->PushString("Driver is unloading");
+		m_pFunction->PushCell(m_Data);
+		m_pFunction->PushCell(1);
+		m_pFunction->Execute(NULL);
+	}
+	void RunThinkPart()
+	{
+		HandleSecurity sec(me->GetIdentity(), g_pCoreIdent);
+
+		/* Blocks collected without a worker thread are delivered in order here. */
+		for (size_t i = 0; i < m_Pending.size(); i++)
+		{
+			TStreamBlockOp op(m_pDatabase, m_pFunction, me, m_MyHandle, m_Data, m_Pending[i], m_Flow);
+			m_Pending[i] = NULL;
+			op.RunThinkPart();
+		}
+		m_Pending.clear();
+
+		Handle_t qh = BAD_HANDLE;
+		if (m_pLast)
+		{
+			CombinedQuery *c = new CombinedQuery(m_pLast, m_pDatabase);
+
+			qh = CreateLocalHandle(hCombinedQueryType, c, &sec);
+			if (qh != BAD_HANDLE)
+			{
+				m_pLast = NULL;
+			} else {
+				g_pSM->Format(error, sizeof(error), "Could not alloc handle");
+				delete c;
+			}
+		}
+
+		if (m_pFunction->IsRunnable())
+		{
+			m_pFunction->PushCell(m_MyHandle);
+			m_pFunction->PushCell(qh);
+			m_pFunction->PushString(qh == BAD_HANDLE ? error : "");
+			m_pFunction->PushCell(m_Data);
+			m_pFunction->PushCell(1);
+			m_pFunction->Execute(NULL);
+		}
+
+		if (qh != BAD_HANDLE)
+		{
+			handlesys->FreeHandle(qh, &sec);
+		}
+	}
+	void Destroy()
+	{
+		delete this;
+	}
+private:
+	void Emit(DBResultChunk *chunk)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Flow->lock);
+			m_Flow->inFlight++;
+		}
+
+		if (m_Synchronous)
+		{
+			m_Pending.push_back(chunk);
+			return;
+		}
+
+		g_DBMan.AddToThinkQueue(new TStreamBlockOp(m_pDatabase, m_pFunction, me, m_MyHandle, m_Data,
+			chunk, m_Flow));
+	}
+	void WaitForRoom()
+	{
+		std::unique_lock<std::mutex> lock(m_Flow->lock);
+		m_Flow->cond.wait_for(lock, kStallTimeout, [this]() -> bool {
+			return m_Flow->inFlight < kMaxBlocksInFlight;
+		});
+	}
+private:
+	IDatabase *m_pDatabase;
+	IPluginFunction *m_pFunction;
+	std::string m_Query;
+	cell_t m_Data;
+	unsigned int m_BlockRows;
+	IPlugin *me;
+	DBResultChunk *m_pLast;
+	std::vector<DBResultChunk *> m_Pending;
+	bool m_Synchronous;
+	std::shared_ptr<StreamFlowState> m_Flow;
 	char error[255];
 	Handle_t m_MyHandle;
 };
@@ -335,7 +667,7 @@ public:
 	{
 		if (m_pInfo)
 		{
-			m_pDatabase = m_pDriver->Connect(&m_pInfo->info, false, error, sizeof(error));
+			m_pDatabase = g_DBMan.ConnectConf(m_pInfo, m_pDriver, false, error, sizeof(error));
 		}
 	}
 	void CancelThinkPart()
@@ -490,7 +822,7 @@ static cell_t ConnectToDbAsync(IPluginContext *pContext, const cell_t *params, A
 	TConnectOp *op = new TConnectOp(pf, driver, conf, acm, params[3]);
 	IPlugin *pPlugin = scripts->FindPluginByContext(pContext->GetContext());
 	if (pPlugin->GetProperty("DisallowDBThreads", NULL)
-		|| !g_DBMan.AddToThreadQueue(op, PrioQueue_High))
+		|| !g_DBMan.AddToConnectionQueue(op, PrioQueue_High, NULL))
 	{
 		/* Do everything right now */
 		op->RunThreadPart();
@@ -640,10 +972,11 @@ static cell_t SQL_GetAffectedRows(IPluginContext *pContext, const cell_t *params
 	IDatabase *db = NULL;
 	IPreparedQuery *stmt = NULL;
 	IQuery *query = NULL;
+	DBResultChunk *chunk = NULL;
 	HandleError err;
 
 	if (((err = ReadDbOrStmtHndl(params[1], pContext, &db, &stmt)) != HandleError_None)
-		&& ((err = ReadQueryAndDbHndl(params[1], pContext, &query, &db)) != HandleError_None))
+		&& ((err = ReadQueryAndDbHndl(params[1], pContext, &query, &db, &chunk)) != HandleError_None))
 	{
 		return pContext->ThrowNativeError("Invalid statement, db, or query Handle %x (error: %d)", params[1], err);
 	}
@@ -653,6 +986,10 @@ static cell_t SQL_GetAffectedRows(IPluginContext *pContext, const cell_t *params
 	{
 		return stmt->GetAffectedRows();
 	}
+	else if (chunk)
+	{
+		return chunk->GetAffectedRows();
+	}
 	else if (query)
 	{
 		return db->GetAffectedRowsForQuery(query);
@@ -670,15 +1007,20 @@ static cell_t SQL_GetInsertId(IPluginContext *pContext, const cell_t *params)
 	IDatabase *db = NULL;
 	IQuery *query = NULL;
 	IPreparedQuery *stmt = NULL;
+	DBResultChunk *chunk = NULL;
 	HandleError err;
 
 	if (((err = ReadDbOrStmtHndl(params[1], pContext, &db, &stmt)) != HandleError_None)
-		&& ((err = ReadQueryAndDbHndl(params[1], pContext, &query, &db)) != HandleError_None))
+		&& ((err = ReadQueryAndDbHndl(params[1], pContext, &query, &db, &chunk)) != HandleError_None))
 	{
 		return pContext->ThrowNativeError("Invalid statement, db, or query Handle %x (error: %d)", params[1], err);
 	}
 
-	if (query)
+	if (chunk)
+	{
+		return chunk->GetInsertID();
+	}
+	else if (query)
 	{
 		return db->GetInsertIDForQuery(query);
 	}
@@ -761,8 +1103,10 @@ static cell_t SQL_FormatQuery(IPluginContext *pContext, const cell_t *params)
 	}
 
 	g_FormatEscapeDatabase = db;
+	g_FormatEscapeHasLength = db->GetDriver()->GetDBIVersion() >= 12;
 	cell_t result = InternalFormat(pContext, params, 1);
 	g_FormatEscapeDatabase = NULL;
+	g_FormatEscapeHasLength = false;
 
 	return result;
 }
@@ -869,9 +1213,142 @@ static cell_t SQL_TQuery(IPluginContext *pContext, const cell_t *params)
 
 	TQueryOp *op = new TQueryOp(db, pf, query, data);
 	if (pPlugin->GetProperty("DisallowDBThreads", NULL)
-		|| !g_DBMan.AddToThreadQueue(op, level))
+		|| !g_DBMan.AddToConnectionQueue(op, level, db))
+	{
+		/* Do everything right now */
+		op->RunThreadPart();
+		op->RunThinkPart();
+		op->Destroy();
+	}
+
+	return 1;
+}
+
+static cell_t Database_QueryCached(IPluginContext *pContext, const cell_t *params)
+{
+	IDatabase *db = NULL;
+	HandleError err;
+
+	if ((err = g_DBMan.ReadHandle(params[1], DBHandle_Database, (void **)&db))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid database Handle %x (error: %d)", params[1], err);
+	}
+
+	if (!db->GetDriver()->IsThreadSafe())
+	{
+		return pContext->ThrowNativeError("Driver \"%s\" is not thread safe!", db->GetDriver()->GetIdentifier());
+	}
+
+	IPluginFunction *pf = pContext->GetFunctionById(params[2]);
+	if (!pf)
+	{
+		return pContext->ThrowNativeError("Function id %x is invalid", params[2]);
+	}
+
+	char *query;
+	pContext->LocalToString(params[3], &query);
+
+	unsigned int ttl = (params[4] > 0) ? params[4] : 0;
+	cell_t data = params[5];
+	PrioQueueLevel level = PrioQueue_Normal;
+	if (params[6] == (cell_t)PrioQueue_High)
+	{
+		level = PrioQueue_High;
+	} else if (params[6] == (cell_t)PrioQueue_Low) {
+		level = PrioQueue_Low;
+	}
+
+	TQueryOp *op = new TQueryOp(db, pf, query, data, ttl);
+
+	/* A hit skips the database thread and completes on the next frame, so the
+	 * callback still never runs from inside this native.
+	 */
+	DBResultChunk *cached = ttl ? g_DBMan.FindCachedQuery(db, query) : NULL;
+	if (cached)
+	{
+		op->SetCachedResult(cached);
+		g_DBMan.AddToThinkQueue(op);
+		return 1;
+	}
+
+	IPlugin *pPlugin = scripts->FindPluginByContext(pContext->GetContext());
+	if (pPlugin->GetProperty("DisallowDBThreads", NULL)
+		|| !g_DBMan.AddToConnectionQueue(op, level, db))
+	{
+		/* Do everything right now */
+		op->RunThreadPart();
+		op->RunThinkPart();
+		op->Destroy();
+	}
+
+	return 1;
+}
+
+static cell_t Database_InvalidateCache(IPluginContext *pContext, const cell_t *params)
+{
+	IDatabase *db = NULL;
+	HandleError err;
+
+	if ((err = g_DBMan.ReadHandle(params[1], DBHandle_Database, (void **)&db))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid database Handle %x (error: %d)", params[1], err);
+	}
+
+	char *query;
+	pContext->LocalToString(params[2], &query);
+
+	return g_DBMan.InvalidateCachedQueries(db, query);
+}
+
+static cell_t Database_QueryStream(IPluginContext *pContext, const cell_t *params)
+{
+	IDatabase *db = NULL;
+	HandleError err;
+
+	if ((err = g_DBMan.ReadHandle(params[1], DBHandle_Database, (void **)&db))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid database Handle %x (error: %d)", params[1], err);
+	}
+
+	if (!db->GetDriver()->IsThreadSafe())
+	{
+		return pContext->ThrowNativeError("Driver \"%s\" is not thread safe!", db->GetDriver()->GetIdentifier());
+	}
+
+	IPluginFunction *pf = pContext->GetFunctionById(params[2]);
+	if (!pf)
+	{
+		return pContext->ThrowNativeError("Function id %x is invalid", params[2]);
+	}
+
+	if (params[5] < 1)
+	{
+		return pContext->ThrowNativeError("Invalid block size %d", params[5]);
+	}
+
+	char *query;
+	pContext->LocalToString(params[3], &query);
+
+	cell_t data = params[4];
+	PrioQueueLevel level = PrioQueue_Normal;
+	if (params[6] == (cell_t)PrioQueue_High)
+	{
+		level = PrioQueue_High;
+	} else if (params[6] == (cell_t)PrioQueue_Low) {
+		level = PrioQueue_Low;
+	}
+
+	IPlugin *pPlugin = scripts->FindPluginByContext(pContext->GetContext());
+
+	TStreamQueryOp *op = new TStreamQueryOp(db, pf, query, data, params[5]);
+	if (pPlugin->GetProperty("DisallowDBThreads", NULL)
+		|| !g_DBMan.AddToConnectionQueue(op, level, db))
 	{
 		/* Do everything right now */
+		op->SetSynchronous();
 		op->RunThreadPart();
 		op->RunThinkPart();
 		op->Destroy();
@@ -1300,6 +1777,223 @@ static cell_t SQL_FetchSize(IPluginContext *pContext, const cell_t *params)
 	return row->GetDataSize(params[2]);
 }
 
+static IResultSet *ReadBulkResultSet(IPluginContext *pContext, cell_t hndl)
+{
+	IQuery *query;
+	HandleError err;
+
+	if ((err = ReadQueryHndl(hndl, pContext, &query)) != HandleError_None)
+	{
+		pContext->ReportError("Invalid query Handle %x (error: %d)", hndl, err);
+		return NULL;
+	}
+
+	IResultSet *rs = query->GetResultSet();
+	if (!rs)
+	{
+		pContext->ReportError("No current result set");
+		return NULL;
+	}
+
+	return rs;
+}
+
+static ICellArray *ReadBulkList(IPluginContext *pContext, cell_t hndl)
+{
+	CellArray *array;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(hndl, htCellArray, &sec, (void **)&array)) != HandleError_None)
+	{
+		pContext->ReportError("Invalid Handle %x (error: %d)", hndl, err);
+		return NULL;
+	}
+	if (array->frozen())
+	{
+		pContext->ReportError("ArrayList %x is frozen and cannot be modified", hndl);
+		return NULL;
+	}
+
+	return array;
+}
+
+static inline size_t BulkRowLimit(cell_t maxrows)
+{
+	return (maxrows < 0) ? (size_t)-1 : (size_t)maxrows;
+}
+
+static cell_t FetchNumberColumn(IPluginContext *pContext, const cell_t *params, bool asFloat)
+{
+	IResultSet *rs = ReadBulkResultSet(pContext, params[1]);
+	if (!rs)
+	{
+		return 0;
+	}
+
+	unsigned int field = params[2];
+	if (field >= rs->GetFieldCount())
+	{
+		return pContext->ThrowNativeError("Invalid field index %d", params[2]);
+	}
+
+	cell_t *buffer;
+	pContext->LocalToPhysAddr(params[3], &buffer);
+
+	cell_t rows = 0;
+	IResultRow *row;
+	while (rows < params[4] && (row = rs->FetchRow()) != NULL)
+	{
+		DBResult res;
+		cell_t value;
+		if (asFloat)
+		{
+			float f;
+			res = row->GetFloat(field, &f);
+			value = sp_ftoc(f);
+		} else {
+			int i;
+			res = row->GetInt(field, &i);
+			value = i;
+		}
+
+		if (res == DBVal_Error)
+		{
+			return pContext->ThrowNativeError("Error fetching data from field %d", params[2]);
+		} else if (res == DBVal_TypeMismatch) {
+			return pContext->ThrowNativeError("Could not fetch data in field %d as %s", params[2], asFloat ? "a float" : "an integer");
+		}
+
+		buffer[rows++] = (res == DBVal_Null) ? params[5] : value;
+	}
+
+	return rows;
+}
+
+static cell_t DBResultSet_FetchIntColumn(IPluginContext *pContext, const cell_t *params)
+{
+	return FetchNumberColumn(pContext, params, false);
+}
+
+static cell_t DBResultSet_FetchFloatColumn(IPluginContext *pContext, const cell_t *params)
+{
+	return FetchNumberColumn(pContext, params, true);
+}
+
+static cell_t DBResultSet_FetchStringColumn(IPluginContext *pContext, const cell_t *params)
+{
+	IResultSet *rs = ReadBulkResultSet(pContext, params[1]);
+	if (!rs)
+	{
+		return 0;
+	}
+
+	unsigned int field = params[2];
+	if (field >= rs->GetFieldCount())
+	{
+		return pContext->ThrowNativeError("Invalid field index %d", params[2]);
+	}
+
+	ICellArray *array = ReadBulkList(pContext, params[3]);
+	if (!array)
+	{
+		return 0;
+	}
+
+	size_t maxlength = array->blocksize() * sizeof(cell_t);
+	size_t limit = BulkRowLimit(params[4]);
+	size_t rows = 0;
+	IResultRow *row;
+	while (rows < limit && (row = rs->FetchRow()) != NULL)
+	{
+		cell_t *blk = array->push();
+		if (!blk)
+		{
+			return pContext->ThrowNativeError("Failed to grow array");
+		}
+
+		DBResult res = row->CopyString(field, (char *)blk, maxlength, NULL);
+		if (res == DBVal_Error)
+		{
+			return pContext->ThrowNativeError("Error fetching data from field %d", params[2]);
+		} else if (res == DBVal_TypeMismatch) {
+			return pContext->ThrowNativeError("Could not fetch data in field %d as a string", params[2]);
+		} else if (res == DBVal_Null) {
+			*(char *)blk = '\0';
+		}
+		rows++;
+	}
+
+	return (cell_t)rows;
+}
+
+static cell_t DBResultSet_FetchRows(IPluginContext *pContext, const cell_t *params)
+{
+	IResultSet *rs = ReadBulkResultSet(pContext, params[1]);
+	if (!rs)
+	{
+		return 0;
+	}
+
+	ICellArray *array = ReadBulkList(pContext, params[2]);
+	if (!array)
+	{
+		return 0;
+	}
+
+	unsigned int fields = rs->GetFieldCount();
+	if (array->blocksize() < fields)
+	{
+		return pContext->ThrowNativeError("ArrayList block size %d is smaller than the field count %d",
+			(int)array->blocksize(), fields);
+	}
+
+	/* Decide each column's conversion once rather than per row. */
+	std::vector<bool> isFloat(fields);
+	for (unsigned int i = 0; i < fields; i++)
+	{
+		isFloat[i] = (rs->GetFieldType(i) == DBType_Float);
+	}
+
+	size_t limit = BulkRowLimit(params[3]);
+	size_t rows = 0;
+	IResultRow *row;
+	while (rows < limit && (row = rs->FetchRow()) != NULL)
+	{
+		cell_t *blk = array->push();
+		if (!blk)
+		{
+			return pContext->ThrowNativeError("Failed to grow array");
+		}
+
+		for (unsigned int i = 0; i < fields; i++)
+		{
+			DBResult res;
+			if (isFloat[i])
+			{
+				float f;
+				res = row->GetFloat(i, &f);
+				blk[i] = sp_ftoc(f);
+			} else {
+				int iv;
+				res = row->GetInt(i, &iv);
+				blk[i] = iv;
+			}
+
+			if (res == DBVal_Error || res == DBVal_TypeMismatch)
+			{
+				array->remove(array->size() - 1);
+				return pContext->ThrowNativeError("Could not fetch data in field %d as %s", i, isFloat[i] ? "a float" : "an integer");
+			} else if (res == DBVal_Null) {
+				blk[i] = 0;
+			}
+		}
+		rows++;
+	}
+
+	return (cell_t)rows;
+}
+
 static cell_t SQL_BindParamInt(IPluginContext *pContext, const cell_t *params)
 {
 	IPreparedQuery *stmt;
@@ -1511,6 +2205,34 @@ static cell_t SQL_SetCharset(IPluginContext *pContext, const cell_t *params)
 	return db->SetCharacterSet(characterset);
 }
 
+static cell_t Database_GetStatementCacheStats(IPluginContext *pContext, const cell_t *params)
+{
+	IDatabase *db = NULL;
+	HandleError err;
+
+	if ((err = g_DBMan.ReadHandle(params[1], DBHandle_Database, (void **)&db))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid database Handle %x (error: %d)", params[1], err);
+	}
+
+	DBStatementCacheStats stats;
+	if (db->GetDriver()->GetDBIVersion() < 10 || !db->GetStatementCacheStats(&stats))
+	{
+		return 0;
+	}
+
+	cell_t *hits, *misses, *cached;
+	pContext->LocalToPhysAddr(params[2], &hits);
+	pContext->LocalToPhysAddr(params[3], &misses);
+	pContext->LocalToPhysAddr(params[4], &cached);
+	*hits = stats.hits;
+	*misses = stats.misses;
+	*cached = stats.cached;
+
+	return 1;
+}
+
 static cell_t SQL_CreateTransaction(IPluginContext *pContext, const cell_t *params)
 {
 	Transaction *txn = new Transaction();
@@ -1609,6 +2331,33 @@ private:
 		return result;
 	}
 
+	// Lets the driver send the queries together where it can; results still
+	// map one-to-one onto the transaction's entries.
+	bool ExecBatch()
+	{
+		size_t count = txn_->entries.size();
+		std::vector<const char *> queries(count);
+		std::vector<size_t> lengths(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			queries[i] = txn_->entries[i].query.c_str();
+			lengths[i] = txn_->entries[i].query.size();
+		}
+
+		std::vector<IQuery *> results(count, NULL);
+		size_t ran = db_->DoQueryBatch(queries.data(), lengths.data(), count, results.data());
+		results_.insert(results_.end(), results.begin(), results.begin() + ran);
+
+		if (ran < count)
+		{
+			SetDbError();
+			db_->DoSimpleQuery("ROLLBACK");
+			failIndex_ = (cell_t)ran;
+			return false;
+		}
+		return true;
+	}
+
 	void ExecuteTransaction()
 	{
 		if (!db_->DoSimpleQuery("BEGIN"))
@@ -1617,16 +2366,24 @@ private:
 			return;
 		}
 
-		for (size_t i = 0; i < txn_->entries.size(); i++)
+		if (db_->GetDriver()->GetDBIVersion() >= 10)
 		{
-			Transaction::Entry &entry = txn_->entries[i];
-			IQuery *result = Exec(entry.query.c_str());
-			if (!result)
-			{
-				failIndex_ = (cell_t)i;
+			if (!ExecBatch())
 				return;
+		}
+		else
+		{
+			for (size_t i = 0; i < txn_->entries.size(); i++)
+			{
+				Transaction::Entry &entry = txn_->entries[i];
+				IQuery *result = Exec(entry.query.c_str());
+				if (!result)
+				{
+					failIndex_ = (cell_t)i;
+					return;
+				}
+				results_.push_back(result);
 			}
-			results_.push_back(result);
 		}
 
 		if (!db_->DoSimpleQuery("COMMIT"))
@@ -1809,7 +2566,7 @@ static cell_t SQL_ExecuteTransaction(IPluginContext *pContext, const cell_t *par
 	handlesys->FreeHandle(params[2], &sec);
 
 	IPlugin *pPlugin = scripts->FindPluginByContext(pContext->GetContext());
-	if (pPlugin->GetProperty("DisallowDBThreads", NULL) || !g_DBMan.AddToThreadQueue(op, priority))
+	if (pPlugin->GetProperty("DisallowDBThreads", NULL) || !g_DBMan.AddToConnectionQueue(op, priority, db))
 	{
 		// Do everything right now.
 		op->RunThreadPart();
@@ -1843,6 +2600,10 @@ REGISTER_NATIVES(dbNatives)
 	{"DBResultSet.FetchInt",			SQL_FetchInt},
 	{"DBResultSet.IsFieldNull",			SQL_IsFieldNull},
 	{"DBResultSet.FetchSize",			SQL_FetchSize},
+	{"DBResultSet.FetchIntColumn",		DBResultSet_FetchIntColumn},
+	{"DBResultSet.FetchFloatColumn",	DBResultSet_FetchFloatColumn},
+	{"DBResultSet.FetchStringColumn",	DBResultSet_FetchStringColumn},
+	{"DBResultSet.FetchRows",			DBResultSet_FetchRows},
 
 	{"Transaction.Transaction",			SQL_CreateTransaction},
 	{"Transaction.AddQuery",			SQL_AddQuery},
@@ -1854,6 +2615,7 @@ REGISTER_NATIVES(dbNatives)
 	{"Database.Connect",				Database_Connect},
 	{"Database.Driver.get",				Database_Driver_get},
 	{"Database.SetCharset",				SQL_SetCharset},
+	{"Database.GetStatementCacheStats",	Database_GetStatementCacheStats},
 	{"Database.Escape",					SQL_QuoteString},
 	{"Database.Format",					SQL_FormatQuery},
 	{"Database.IsSameConnection",		SQL_IsSameConnection},
@@ -1861,6 +2623,9 @@ REGISTER_NATIVES(dbNatives)
 
 	// Note: The callback is ABI compatible so we can re-use the native.
 	{"Database.Query",					SQL_TQuery},
+	{"Database.QueryCached",			Database_QueryCached},
+	{"Database.InvalidateCache",		Database_InvalidateCache},
+	{"Database.QueryStream",			Database_QueryStream},
 
 	{"SQL_BindParamInt",		SQL_BindParamInt},
 	{"SQL_BindParamFloat",		SQL_BindParamFloat},
@@ -33,6 +33,7 @@
 #include <IHandleSys.h>
 #include <ISourceMod.h>
 #include "CDataPack.h"
+#include "BlobStore.h"
 
 HandleType_t g_DataPackType;
 
@@ -58,29 +59,45 @@ public:
 	{
 		handlesys->RemoveType(g_DataPackType, g_pCoreIdent);
 		g_DataPackType = 0;
+		CDataPack::ReleasePool();
 	}
 	void OnHandleDestroy(HandleType_t type, void *object)
 	{
-		delete reinterpret_cast<CDataPack *>(object);
+		CDataPack *pack = reinterpret_cast<CDataPack *>(object);
+
+		/* A worker still holds the contents; the loan frees the pack when it ends. */
+		if (pack->IsLent())
+		{
+			pack->Orphan();
+			return;
+		}
+
+		CDataPack::Free(pack);
 	}
 	bool GetHandleApproxSize(HandleType_t type, void *object, unsigned int *pSize)
 	{
 		CDataPack *pack = reinterpret_cast<CDataPack *>(object);
-		*pSize = sizeof(CDataPack) + pack->GetCapacity();
+		*pSize = sizeof(CDataPack) + pack->GetMemoryUsage();
 		return true;
 	}
 };
 
+static cell_t ThrowLentPack(IPluginContext *pContext, Handle_t hndl)
+{
+	return pContext->ThrowNativeError("Data pack handle %x is in use by a worker thread.", hndl);
+}
+
 static cell_t smn_CreateDataPack(IPluginContext *pContext, const cell_t *params)
 {
-	CDataPack *pDataPack = new CDataPack();
+	CDataPack *pDataPack = CDataPack::New();
 
-	if (!pDataPack)
+	Handle_t hndl = handlesys->CreateHandle(g_DataPackType, pDataPack, pContext->GetIdentity(), g_pCoreIdent, NULL);
+	if (hndl == BAD_HANDLE)
 	{
-		return 0;
+		CDataPack::Free(pDataPack);
 	}
 
-	return handlesys->CreateHandle(g_DataPackType, pDataPack, pContext->GetIdentity(), g_pCoreIdent, NULL);
+	return hndl;
 }
 
 static cell_t smn_WritePackCell(IPluginContext *pContext, const cell_t *params)
@@ -99,6 +116,11 @@ static cell_t smn_WritePackCell(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	bool insert = (params[0] >= 3) ? params[3] : false;
 	if (!insert)
 	{
@@ -126,6 +148,11 @@ static cell_t smn_WritePackFloat(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	bool insert = (params[0] >= 3) ? params[3] : false;
 	if (!insert)
 	{
@@ -153,6 +180,11 @@ static cell_t smn_WritePackString(IPluginContext *pContext, const cell_t *params
 		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	bool insert = (params[0] >= 3) ? params[3] : false;
 	if (!insert)
 	{
@@ -182,6 +214,11 @@ static cell_t smn_WritePackCellArray(IPluginContext *pContext, const cell_t *par
 		return 0;
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	if (!params[4])
 	{
 		pDataPack->RemoveItem();
@@ -210,6 +247,11 @@ static cell_t smn_WritePackFloatArray(IPluginContext *pContext, const cell_t *pa
 		return 0;
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	if (!params[4])
 	{
 		pDataPack->RemoveItem();
@@ -238,6 +280,11 @@ static cell_t smn_WritePackFunction(IPluginContext *pContext, const cell_t *para
 		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	bool insert = (params[0] >= 3) ? params[3] : false;
 	if (!insert)
 	{
@@ -277,6 +324,11 @@ static cell_t smn_ReadPackCell(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	if (!pDataPack->IsReadable())
 	{
 		return pContext->ThrowNativeError("Data pack operation is out of bounds.");
@@ -306,6 +358,11 @@ static cell_t smn_ReadPackFloat(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	if (!pDataPack->IsReadable())
 	{
 		return pContext->ThrowNativeError("Data pack operation is out of bounds.");
@@ -335,6 +392,11 @@ static cell_t smn_ReadPackString(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	if (!pDataPack->IsReadable())
 	{
 		return pContext->ThrowNativeError("Data pack operation is out of bounds.");
@@ -367,6 +429,11 @@ static cell_t smn_ReadPackFunction(IPluginContext *pContext, const cell_t *param
 		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	if (!pDataPack->IsReadable())
 	{
 		return pContext->ThrowNativeError("Data pack operation is out of bounds.");
@@ -401,6 +468,11 @@ static cell_t smn_ReadPackCellArray(IPluginContext *pContext, const cell_t *para
 		return 0;
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	if (!pDataPack->IsReadable())
 	{
 		pContext->ReportError("Data pack operation is out of bounds.");
@@ -452,6 +524,11 @@ static cell_t smn_ReadPackFloatArray(IPluginContext *pContext, const cell_t *par
 		return 0;
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	if (!pDataPack->IsReadable())
 	{
 		pContext->ReportError("Data pack operation is out of bounds.");
@@ -503,6 +580,11 @@ static cell_t smn_ResetPack(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	if (params[2])
 	{
 		pDataPack->ResetSize();
@@ -531,6 +613,11 @@ static cell_t smn_GetPackPosition(IPluginContext *pContext, const cell_t *params
 		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	return static_cast<cell_t>(pDataPack->GetPosition());
 }
 
@@ -550,6 +637,11 @@ static cell_t smn_SetPackPosition(IPluginContext *pContext, const cell_t *params
 		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	if (!pDataPack->SetPosition(params[2]))
 	{
 		return pContext->ThrowNativeError("Invalid data pack position, %d is out of bounds (%d)", params[2], pDataPack->GetCapacity());
@@ -574,9 +666,159 @@ static cell_t smn_IsPackReadable(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
 	}
 
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
 	return pDataPack->IsReadable(params[2]) ? 1 : 0;
 }
 
+/* Payload: the pack's element stream, as is. */
+static std::vector<uint8_t> &SerializeDataPack(CDataPack *pDataPack, BlobWriter &writer)
+{
+	const std::vector<uint8_t> &data = pDataPack->GetRawData();
+	writer.Reserve(data.size());
+	writer.Write(data.data(), data.size());
+	return writer.Finish();
+}
+
+static bool DeserializeDataPack(CDataPack *pDataPack, const std::vector<uint8_t> &blob)
+{
+	BlobReader reader;
+	if (!reader.Open(blob, BlobKind_DataPack))
+	{
+		return false;
+	}
+
+	size_t size = reader.Remaining();
+	return pDataPack->SetRawData(reader.Take(size), size);
+}
+
+static cell_t smn_SavePackToFile(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError herr;
+	HandleSecurity sec;
+	CDataPack *pDataPack;
+
+	sec.pOwner = pContext->GetIdentity();
+	sec.pIdentity = g_pCoreIdent;
+
+	if ((herr=handlesys->ReadHandle(hndl, g_DataPackType, &sec, (void **)&pDataPack))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
+	}
+
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
+	char *path;
+	pContext->LocalToString(params[2], &path);
+
+	BlobWriter writer(BlobKind_DataPack);
+	return g_BlobStore.SaveFile(path, SerializeDataPack(pDataPack, writer)) ? 1 : 0;
+}
+
+static cell_t smn_LoadPackFromFile(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError herr;
+	HandleSecurity sec;
+	CDataPack *pDataPack;
+
+	sec.pOwner = pContext->GetIdentity();
+	sec.pIdentity = g_pCoreIdent;
+
+	if ((herr=handlesys->ReadHandle(hndl, g_DataPackType, &sec, (void **)&pDataPack))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
+	}
+
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
+	char *path;
+	pContext->LocalToString(params[2], &path);
+
+	std::vector<uint8_t> blob;
+	if (!g_BlobStore.LoadFile(path, &blob))
+	{
+		return 0;
+	}
+
+	return DeserializeDataPack(pDataPack, blob) ? 1 : 0;
+}
+
+static cell_t smn_SavePackToMemory(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError herr;
+	HandleSecurity sec;
+	CDataPack *pDataPack;
+
+	sec.pOwner = pContext->GetIdentity();
+	sec.pIdentity = g_pCoreIdent;
+
+	if ((herr=handlesys->ReadHandle(hndl, g_DataPackType, &sec, (void **)&pDataPack))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
+	}
+
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
+	char *key;
+	pContext->LocalToString(params[2], &key);
+
+	BlobWriter writer(BlobKind_DataPack);
+	g_BlobStore.Stash(key, std::move(SerializeDataPack(pDataPack, writer)));
+
+	return 1;
+}
+
+static cell_t smn_LoadPackFromMemory(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError herr;
+	HandleSecurity sec;
+	CDataPack *pDataPack;
+
+	sec.pOwner = pContext->GetIdentity();
+	sec.pIdentity = g_pCoreIdent;
+
+	if ((herr=handlesys->ReadHandle(hndl, g_DataPackType, &sec, (void **)&pDataPack))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid data pack handle %x (error %d).", hndl, herr);
+	}
+
+	if (pDataPack->IsLent())
+	{
+		return ThrowLentPack(pContext, hndl);
+	}
+
+	char *key;
+	pContext->LocalToString(params[2], &key);
+
+	std::vector<uint8_t> blob;
+	if (!g_BlobStore.Unstash(key, &blob, params[3] != 0))
+	{
+		return 0;
+	}
+
+	return DeserializeDataPack(pDataPack, blob) ? 1 : 0;
+}
+
 static DataPackNatives s_DataPackNatives;
 
 REGISTER_NATIVES(datapacknatives)
@@ -613,5 +855,9 @@ REGISTER_NATIVES(datapacknatives)
 	{"DataPack.Position.get",		smn_GetPackPosition},
 	{"DataPack.Position.set",		smn_SetPackPosition},
 	{"DataPack.IsReadable",			smn_IsPackReadable},
+	{"DataPack.SaveToFile",			smn_SavePackToFile},
+	{"DataPack.LoadFromFile",		smn_LoadPackFromFile},
+	{"DataPack.SaveToMemory",		smn_SavePackToMemory},
+	{"DataPack.LoadFromMemory",		smn_LoadPackFromMemory},
 	{NULL,							NULL}
 };
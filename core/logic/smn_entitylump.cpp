@@ -34,8 +34,6 @@
 
 #include "LumpManager.h"
 
-#include <algorithm>
-
 HandleType_t g_EntityLumpEntryType;
 
 std::string g_strMapEntities;
@@ -57,6 +55,29 @@ public: //SMGlobalClass
 	{
 		handlesys->RemoveType(g_EntityLumpEntryType, g_pCoreIdent);
 	}
+	ConfigResult OnSourceModConfigChanged(const char *key, const char *value,
+		ConfigSource source, char *error, size_t maxlength)
+	{
+		if (strcmp(key, "LazyEntityLump") != 0)
+		{
+			return ConfigResult_Ignore;
+		}
+		
+		if (strcasecmp(value, "yes") == 0)
+		{
+			lumpmanager->SetParseMode(ParseMode_Lazy);
+		}
+		else if (strcasecmp(value, "no") == 0)
+		{
+			lumpmanager->SetParseMode(ParseMode_Owned);
+		}
+		else
+		{
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be \"yes\" or \"no\"");
+			return ConfigResult_Reject;
+		}
+		return ConfigResult_Accept;
+	}
 public: //IHandleTypeDispatch
 	void OnHandleDestroy(HandleType_t type, void* object)
 	{
@@ -121,6 +142,30 @@ cell_t sm_LumpManagerLength(IPluginContext *pContext, const cell_t *params) {
 	return lumpmanager->Length();
 }
 
+cell_t sm_LumpManagerFindByClassname(IPluginContext *pContext, const cell_t *params) {
+	int start = params[2];
+	if (start < -1 || start >= static_cast<int>(lumpmanager->Length())) {
+		return pContext->ThrowNativeError("Invalid start index %d", start);
+	}
+	
+	char *classname;
+	pContext->LocalToString(params[1], &classname);
+	
+	return lumpmanager->FindByClassname(classname, start);
+}
+
+cell_t sm_LumpManagerFindByTargetname(IPluginContext *pContext, const cell_t *params) {
+	int start = params[2];
+	if (start < -1 || start >= static_cast<int>(lumpmanager->Length())) {
+		return pContext->ThrowNativeError("Invalid start index %d", start);
+	}
+	
+	char *targetname;
+	pContext->LocalToString(params[1], &targetname);
+	
+	return lumpmanager->FindByTargetname(targetname, start);
+}
+
 cell_t sm_LumpEntryGet(IPluginContext *pContext, const cell_t *params) {
 	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
 	HandleError err;
@@ -143,11 +188,9 @@ cell_t sm_LumpEntryGet(IPluginContext *pContext, const cell_t *params) {
 		return pContext->ThrowNativeError("Invalid index %d", index);
 	}
 	
-	const auto& pair = (*entry)[index];
-	
 	size_t nBytes;
-	pContext->StringToLocalUTF8(params[3], params[4], pair.first.c_str(), &nBytes);
-	pContext->StringToLocalUTF8(params[5], params[6], pair.second.c_str(), &nBytes);
+	pContext->StringToLocalUTF8(params[3], params[4], entry->Key(index), &nBytes);
+	pContext->StringToLocalUTF8(params[5], params[6], entry->Value(index), &nBytes);
 	
 	return 0;
 }
@@ -182,13 +225,7 @@ cell_t sm_LumpEntryUpdate(IPluginContext *pContext, const cell_t *params) {
 	pContext->LocalToStringNULL(params[3], &key);
 	pContext->LocalToStringNULL(params[4], &value);
 	
-	auto& pair = (*entry)[index];
-	if (key != nullptr) {
-		pair.first = key;
-	}
-	if (value != nullptr) {
-		pair.second = value;
-	}
+	entry->Update(index, key, value);
 	
 	return 0;
 }
@@ -223,7 +260,7 @@ cell_t sm_LumpEntryInsert(IPluginContext *pContext, const cell_t *params) {
 	pContext->LocalToString(params[3], &key);
 	pContext->LocalToString(params[4], &value);
 	
-	entry->emplace(entry->begin() + index, key, value);
+	entry->Insert(index, key, value);
 	
 	return 0;
 }
@@ -254,7 +291,7 @@ cell_t sm_LumpEntryErase(IPluginContext *pContext, const cell_t *params) {
 		return pContext->ThrowNativeError("Invalid index %d", index);
 	}
 	
-	entry->erase(entry->begin() + index);
+	entry->Erase(index);
 	
 	return 0;
 }
@@ -284,7 +321,7 @@ cell_t sm_LumpEntryAppend(IPluginContext *pContext, const cell_t *params) {
 	pContext->LocalToString(params[2], &key);
 	pContext->LocalToString(params[3], &value);
 	
-	entry->emplace_back(key, value);
+	entry->Append(key, value);
 	
 	return 0;
 }
@@ -316,16 +353,7 @@ cell_t sm_LumpEntryFindKey(IPluginContext *pContext, const cell_t *params) {
 	char *key;
 	pContext->LocalToString(params[2], &key);
 	
-	auto matches_key = [&key](std::pair<std::string,std::string> pair) {
-		return pair.first == key;
-	};
-	
-	auto result = std::find_if(entry->begin() + start, entry->end(), matches_key);
-	
-	if (result == entry->end()) {
-		return -1;
-	}
-	return std::distance(entry->begin(), result);
+	return entry->FindKey(key, start);
 }
 
 cell_t sm_LumpEntryLength(IPluginContext *pContext, const cell_t *params) {
@@ -354,6 +382,8 @@ REGISTER_NATIVES(entityLumpNatives)
 	{ "EntityLump.Insert", sm_LumpManagerInsert },
 	{ "EntityLump.Append", sm_LumpManagerAppend },
 	{ "EntityLump.Length", sm_LumpManagerLength },
+	{ "EntityLump.FindByClassname", sm_LumpManagerFindByClassname },
+	{ "EntityLump.FindByTargetname", sm_LumpManagerFindByTargetname },
 	
 	{ "EntityLumpEntry.Get", sm_LumpEntryGet },
 	{ "EntityLumpEntry.Update", sm_LumpEntryUpdate },
@@ -39,14 +39,14 @@
 
 using namespace SourceHook;
 
-static cell_t s_curparams[SP_MAX_EXEC_PARAMS+1];
+/* The caller's own parameter frame. It stays put for the whole call, even if
+ * the native calls back into the caller, so nothing needs to be copied. */
+static const cell_t *s_curparams = NULL;
 static FakeNative *s_curnative = NULL;
 static IPluginContext *s_curcaller = NULL;
 
-cell_t FakeNativeRouter(IPluginContext *pContext, const cell_t *params, void *pData)
+static cell_t RouteFakeNative(IPluginContext *pContext, const cell_t *params, FakeNative *native, bool direct)
 {
-	FakeNative *native = (FakeNative *)pData;
-
 	/* Check if too many parameters were passed */
 	if (params[0] > SP_MAX_EXEC_PARAMS)
 	{
@@ -61,48 +61,49 @@ cell_t FakeNativeRouter(IPluginContext *pContext, const cell_t *params, void *pD
 
 	CPlugin *pCaller = g_PluginSys.GetPluginByCtx(pContext->GetContext());
 
-	/* Save any old data on the stack */
+	/* Save any outer call, if this one is nested */
 	FakeNative *pSaveNative = s_curnative;
 	IPluginContext *pSaveCaller = s_curcaller;
-	cell_t save_params[SP_MAX_EXEC_PARAMS+1];
-	if (pSaveNative != NULL)
-	{
-		/* Copy all old parameters */
-		for (cell_t i=0; i<=s_curparams[0]; i++)
-		{
-			save_params[i] = s_curparams[i];
-		}
-	}
+	const cell_t *pSaveParams = s_curparams;
 
-	/* Save the current parameters */
 	s_curnative = native;
 	s_curcaller = pContext;
-	for (cell_t i=0; i<=params[0]; i++)
-	{
-		s_curparams[i] = params[i];
-	}
+	s_curparams = params;
 
 	// Push info and execute. If Invoke() fails, the error will propagate up.
 	// We still carry on below to clear our global state.
 	cell_t result = 0;
 	native->call->PushCell(pCaller->GetMyHandle());
+	if (direct)
+	{
+		/* An empty array can't be pushed, so a native without parameters
+		 * gets a single unused cell. */
+		static cell_t no_params = 0;
+		if (params[0] > 0)
+			native->call->PushArray(const_cast<cell_t *>(&params[1]), params[0], 0);
+		else
+			native->call->PushArray(&no_params, 1, 0);
+	}
 	native->call->PushCell(params[0]);
 	native->call->Invoke(&result);
 
-	/* Restore everything from the stack if necessary */
 	s_curnative = pSaveNative;
 	s_curcaller = pSaveCaller;
-	if (pSaveNative != NULL)
-	{
-		for (cell_t i=0; i<=save_params[0]; i++)
-		{
-			s_curparams[i] = save_params[i];
-		}
-	}
+	s_curparams = pSaveParams;
 
 	return result;
 }
 
+cell_t FakeNativeRouter(IPluginContext *pContext, const cell_t *params, void *pData)
+{
+	return RouteFakeNative(pContext, params, (FakeNative *)pData, false);
+}
+
+cell_t FakeNativeDirectRouter(IPluginContext *pContext, const cell_t *params, void *pData)
+{
+	return RouteFakeNative(pContext, params, (FakeNative *)pData, true);
+}
+
 static cell_t CreateNative(IPluginContext *pContext, const cell_t *params)
 {
 	char *name;
@@ -126,6 +127,29 @@ static cell_t CreateNative(IPluginContext *pContext, const cell_t *params)
 	return 1;
 }
 
+static cell_t CreateNativeDirect(IPluginContext *pContext, const cell_t *params)
+{
+	char *name;
+	CPlugin *pPlugin;
+
+	pContext->LocalToString(params[1], &name);
+
+	IPluginFunction *pFunction = pContext->GetFunctionById(params[2]);
+	if (!pFunction)
+	{
+		return pContext->ThrowNativeError("Failed to create native \"%s\", function %x is not a valid function", name, params[2]);
+	}
+
+	pPlugin = g_PluginSys.GetPluginByCtx(pContext->GetContext());
+
+	if (!pPlugin->AddFakeNative(pFunction, name, FakeNativeDirectRouter))
+	{
+		return pContext->ThrowNativeError("Failed to create native \"%s\", name is probably already in use", name);
+	}
+
+	return 1;
+}
+
 static cell_t ThrowNativeError(IPluginContext *pContext, const cell_t *params)
 {
 	if (!s_curnative || (s_curnative->ctx != pContext))
@@ -264,6 +288,27 @@ static cell_t GetNativeCell(IPluginContext *pContext, const cell_t *params)
 	return s_curparams[param];
 }
 
+static cell_t GetNativeCells(IPluginContext *pContext, const cell_t *params)
+{
+	if (!s_curnative || (s_curnative->ctx != pContext))
+	{
+		return pContext->ThrowNativeError("Not called from inside a native function");
+	}
+
+	cell_t start = params[1];
+	cell_t count = params[2];
+	if (count < 0 || start < 1 || start + count - 1 > s_curparams[0])
+	{
+		return pContext->ThrowNativeErrorEx(SP_ERROR_PARAM, "Invalid parameter range: %d to %d", start, start + count - 1);
+	}
+
+	cell_t *out;
+	pContext->LocalToPhysAddr(params[3], &out);
+	memcpy(out, &s_curparams[start], count * sizeof(cell_t));
+
+	return count;
+}
+
 static cell_t GetNativeCellRef(IPluginContext *pContext, const cell_t *params)
 {
 	if (!s_curnative || (s_curnative->ctx != pContext))
@@ -507,8 +552,10 @@ static cell_t IsNativeParamNullString(IPluginContext *pContext, const cell_t *pa
 REGISTER_NATIVES(nativeNatives)
 {
 	{"CreateNative",			CreateNative},
+	{"CreateNativeDirect",		CreateNativeDirect},
 	{"GetNativeArray",			GetNativeArray},
 	{"GetNativeCell",			GetNativeCell},
+	{"GetNativeCells",			GetNativeCells},
 	{"GetNativeCellRef",		GetNativeCellRef},
 	{"GetNativeFunction",       GetNativeFunction},
 	{"GetNativeString",			GetNativeString},
@@ -32,6 +32,9 @@
 #include <assert.h>
 #include <sys/stat.h>
 #include <string.h>
+#include <chrono>
+#include <memory>
+#include <vector>
 #include <IHandleSys.h>
 #include <ILibrarySys.h>
 #include <IPluginSys.h>
@@ -71,6 +74,11 @@ class SystemFile;
 class FileObject
 {
 public:
+	typedef std::chrono::steady_clock Clock;
+
+	FileObject()
+	: flush_interval_(0)
+	{}
 	virtual ~FileObject()
 	{}
 	virtual size_t Size() = 0;
@@ -89,6 +97,31 @@ public:
 	virtual SystemFile *AsSystemFile() {
 		return NULL;
 	}
+
+	// Replaces the stdio buffer; only possible before any other I/O.
+	virtual bool SetBufferSize(size_t size) {
+		return false;
+	}
+
+	// When non-zero, explicit flushes are deferred and the file is instead
+	// flushed from the game frame at most once per interval.
+	int flush_interval() const {
+		return flush_interval_;
+	}
+	void set_flush_interval(int ms) {
+		flush_interval_ = ms;
+		next_flush_ = Clock::now() + std::chrono::milliseconds(ms);
+	}
+	bool FlushDue(Clock::time_point now) {
+		if (now < next_flush_)
+			return false;
+		next_flush_ = now + std::chrono::milliseconds(flush_interval_);
+		return true;
+	}
+
+private:
+	int flush_interval_;
+	Clock::time_point next_flush_;
 };
 
 class ValveFile : public FileObject
@@ -171,7 +204,8 @@ class SystemFile : public FileObject
 {
 public:
 	SystemFile(FILE *fp)
-	: fp_(fp)
+	: fp_(fp),
+	  used_(false)
 	{}
 	~SystemFile() {
 		Close();
@@ -213,15 +247,19 @@ public:
 	}
 
 	size_t Read(void *pOut, int size) override {
+		used_ = true;
 		return fread(pOut, 1, size, fp_);
 	}
 	char *ReadLine(char *pOut, int size) override {
+		used_ = true;
 		return fgets(pOut, size, fp_);
 	}
 	size_t Write(const void *pData, int size) override {
+		used_ = true;
 		return fwrite(pData, 1, size, fp_);
 	}
 	bool Seek(int pos, int seek_type) override  {
+		used_ = true;
 		return fseek(fp_, pos, seek_type) == 0;
 	}
 	int Tell() override {
@@ -242,15 +280,34 @@ public:
 		fclose(fp_);
 		fp_ = nullptr;
 	}
+	bool SetBufferSize(size_t size) override {
+		// setvbuf() is only defined before the first operation on the stream.
+		if (!fp_ || used_)
+			return false;
+
+		std::unique_ptr<char[]> buffer;
+		if (size)
+			buffer = std::make_unique<char[]>(size);
+		if (setvbuf(fp_, buffer.get(), size ? _IOFBF : _IONBF, size) != 0)
+			return false;
+
+		// The stream keeps using the buffer until fclose(), which happens in
+		// Close() before the buffer is released.
+		buffer_ = std::move(buffer);
+		return true;
+	}
 	virtual SystemFile *AsSystemFile() {
 		return this;
 	}
-	FILE *fp() const {
+	FILE *fp() {
+		used_ = true;
 		return fp_;
 	}
 
 private:
 	FILE *fp_;
+	bool used_;
+	std::unique_ptr<char[]> buffer_;
 };
 
 struct ValveDirectory
@@ -276,9 +333,11 @@ public:
 		g_ValveDirType = handlesys->CreateType("ValveDirectory", this, 0, NULL, NULL, g_pCoreIdent, NULL);
 		g_pLogHook = forwardsys->CreateForwardEx(NULL, ET_Hook, 1, NULL, Param_String);
 		pluginsys->AddPluginsListener(this);
+		g_pSM->AddGameFrameHook(&AutoFlushHook);
 	}
 	virtual void OnSourceModShutdown()
 	{
+		g_pSM->RemoveGameFrameHook(&AutoFlushHook);
 		pluginsys->RemovePluginsListener(this);
 		forwardsys->ReleaseForward(g_pLogHook);
 		handlesys->RemoveType(g_DirType, g_pCoreIdent);
@@ -293,6 +352,8 @@ public:
 		if (type == g_FileType)
 		{
 			FileObject *file = (FileObject *)object;
+			if (file->flush_interval())
+				RemoveAutoFlush(file);
 			delete file;
 		}
 		else if (type == g_DirType)
@@ -326,8 +387,45 @@ public:
 		g_pLogHook->Execute(&result);
 		return result >= Pl_Handled;
 	}
+	void AddAutoFlush(FileObject *file)
+	{
+		m_AutoFlush.push_back(file);
+	}
+	void RemoveAutoFlush(FileObject *file)
+	{
+		for (size_t i = 0; i < m_AutoFlush.size(); i++)
+		{
+			if (m_AutoFlush[i] == file)
+			{
+				m_AutoFlush[i] = m_AutoFlush.back();
+				m_AutoFlush.pop_back();
+				return;
+			}
+		}
+	}
+	void RunAutoFlush()
+	{
+		if (m_AutoFlush.empty())
+			return;
+
+		FileObject::Clock::time_point now = FileObject::Clock::now();
+		for (size_t i = 0; i < m_AutoFlush.size(); i++)
+		{
+			if (m_AutoFlush[i]->FlushDue(now))
+				m_AutoFlush[i]->Flush();
+		}
+	}
+private:
+	static void AutoFlushHook(bool simulating);
+private:
+	std::vector<FileObject *> m_AutoFlush;
 } s_FileNatives;
 
+void FileNatives::AutoFlushHook(bool simulating)
+{
+	s_FileNatives.RunAutoFlush();
+}
+
 bool OnLogPrint(const char *msg)
 {
 	return s_FileNatives.LogPrint(msg);
@@ -866,6 +964,10 @@ static cell_t sm_FlushFile(IPluginContext *pContext, const cell_t *params)
 	if (!file.Ok())
 		return 0;
 
+	// Auto-flushed files are written out from the game frame instead.
+	if (file->flush_interval())
+		return 1;
+
 	return file->Flush() ? 1 : 0;
 }
 
@@ -1229,6 +1331,49 @@ static cell_t File_WriteTyped(IPluginContext *pContext, const cell_t *params)
 	return !!(file->Write(&value, sizeof(value)) == sizeof(value));
 }
 
+static cell_t File_SetBufferSize(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<FileObject> file(pContext, params[1], g_FileType);
+	if (!file.Ok())
+		return 0;
+
+	static const cell_t kMaxBufferSize = 16 * 1024 * 1024;
+	if (params[2] < 0 || params[2] > kMaxBufferSize)
+		return pContext->ThrowNativeError("Invalid buffer size %d (max %d)", params[2], kMaxBufferSize);
+
+	return file->SetBufferSize(params[2]) ? 1 : 0;
+}
+
+static cell_t File_AutoFlushGet(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<FileObject> file(pContext, params[1], g_FileType);
+	if (!file.Ok())
+		return 0;
+
+	return file->flush_interval();
+}
+
+static cell_t File_AutoFlushSet(IPluginContext *pContext, const cell_t *params)
+{
+	OpenHandle<FileObject> file(pContext, params[1], g_FileType);
+	if (!file.Ok())
+		return 0;
+
+	if (params[2] < 0)
+		return pContext->ThrowNativeError("Invalid auto-flush interval %d", params[2]);
+
+	bool was_enabled = file->flush_interval() != 0;
+	file->set_flush_interval(params[2]);
+
+	if (params[2] && !was_enabled) {
+		s_FileNatives.AddAutoFlush(file);
+	} else if (!params[2] && was_enabled) {
+		s_FileNatives.RemoveAutoFlush(file);
+		file->Flush();
+	}
+	return 0;
+}
+
 REGISTER_NATIVES(filesystem)
 {
 	{"OpenDirectory",			sm_OpenDirectory},
@@ -1282,6 +1427,9 @@ REGISTER_NATIVES(filesystem)
 	{"File.WriteInt8",			File_WriteTyped<int8_t>},
 	{"File.WriteInt16",			File_WriteTyped<int16_t>},
 	{"File.WriteInt32",			File_WriteTyped<int32_t>},
+	{"File.SetBufferSize",		File_SetBufferSize},
+	{"File.AutoFlush.get",		File_AutoFlushGet},
+	{"File.AutoFlush.set",		File_AutoFlushSet},
 
 	// Transitional syntax support.
 	{"DirectoryListing.GetNext",			sm_ReadDirEntry},
@@ -0,0 +1,552 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <IHandleSys.h>
+#include <ILibrarySys.h>
+#include <IPluginSys.h>
+#include <ISourceMod.h>
+#include "common_logic.h"
+#include "CellArray.h"
+#include <am-thread.h>
+#include <bridge/include/CoreProvider.h>
+
+/* File I/O that runs on a small worker pool so that large reads, writes and 
+ * directory scans don't stall the game thread.  Paths are resolved on the 
+ * main thread, the workers only ever touch the C runtime and ILibrarySys, 
+ * and results are handed back to plugins from a game frame hook.
+ */
+
+HandleType_t g_FileBufferType = 0;
+
+static const unsigned int kAsyncFileWorkers = 2;
+
+/* The bytes of a file read by ReadFileAsync. */
+struct FileBuffer
+{
+	std::string data;
+};
+
+enum AsyncFileOpType
+{
+	AsyncFile_Read,
+	AsyncFile_Write,
+	AsyncFile_ListDir,
+};
+
+struct AsyncFileOp
+{
+	AsyncFileOpType type;
+	std::string path;
+	bool append;
+	bool success;
+
+	/* Write payload going in, file contents coming out. */
+	std::unique_ptr<FileBuffer> buffer;
+	std::vector<std::string> entries;
+
+	/* Only touched on the main thread. */
+	IPluginContext *context;
+	IPluginFunction *callback;
+	cell_t data;
+	bool cancelled;
+};
+
+class AsyncFileManager :
+	public SMGlobalClass,
+	public IHandleTypeDispatch,
+	public IPluginsListener
+{
+public:
+	AsyncFileManager() : m_Terminate(false)
+	{
+	}
+public: // SMGlobalClass
+	void OnSourceModAllInitialized() override
+	{
+		g_FileBufferType = handlesys->CreateType("FileBuffer", this, 0, NULL, NULL, g_pCoreIdent, NULL);
+		pluginsys->AddPluginsListener(this);
+		g_pSM->AddGameFrameHook(&FrameHook);
+	}
+	void OnSourceModShutdown() override
+	{
+		g_pSM->RemoveGameFrameHook(&FrameHook);
+		pluginsys->RemovePluginsListener(this);
+
+		/* Let queued writes reach the disk, then drop the results; nobody 
+		 * is left to receive them.
+		 */
+		StopWorkers();
+		for (size_t i = 0; i < m_Pending.size(); i++)
+			delete m_Pending[i];
+		m_Pending.clear();
+		m_Done.clear();
+
+		handlesys->RemoveType(g_FileBufferType, g_pCoreIdent);
+		g_FileBufferType = 0;
+	}
+public: // IHandleTypeDispatch
+	void OnHandleDestroy(HandleType_t type, void *object) override
+	{
+		delete (FileBuffer *)object;
+	}
+	bool GetHandleApproxSize(HandleType_t type, void *object, unsigned int *pSize) override
+	{
+		*pSize = sizeof(FileBuffer) + (unsigned int)((FileBuffer *)object)->data.size();
+		return true;
+	}
+public: // IPluginsListener
+	void OnPluginUnloaded(IPlugin *plugin) override
+	{
+		IPluginContext *pContext = plugin->GetBaseContext();
+		for (size_t i = 0; i < m_Pending.size(); i++)
+		{
+			if (m_Pending[i]->context == pContext)
+				m_Pending[i]->cancelled = true;
+		}
+	}
+public:
+	void Submit(AsyncFileOp *op)
+	{
+		op->success = false;
+		op->cancelled = false;
+		m_Pending.push_back(op);
+
+		StartWorkers();
+
+		std::lock_guard<std::mutex> lock(m_Lock);
+		m_Queue.push_back(op);
+		m_Event.notify_one();
+	}
+private:
+	static void FrameHook(bool simulating);
+
+	void StartWorkers()
+	{
+		if (!m_Workers.empty())
+			return;
+
+		m_Terminate = false;
+		for (unsigned int i = 0; i < kAsyncFileWorkers; i++)
+		{
+			char name[32];
+			ke::SafeSprintf(name, sizeof(name), "SM File Worker %u", i);
+			m_Workers.emplace_back(ke::NewThread(name, [this]() -> void {
+				ThreadMain();
+			}));
+		}
+	}
+
+	void StopWorkers()
+	{
+		if (m_Workers.empty())
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			m_Terminate = true;
+			m_Event.notify_all();
+		}
+		for (size_t i = 0; i < m_Workers.size(); i++)
+			m_Workers[i]->join();
+		m_Workers.clear();
+	}
+
+	void ThreadMain()
+	{
+		std::unique_lock<std::mutex> lock(m_Lock);
+		while (true)
+		{
+			/* Drain the queue before honouring a terminate request. */
+			if (m_Queue.empty())
+			{
+				if (m_Terminate)
+					return;
+				m_Event.wait(lock);
+				continue;
+			}
+
+			AsyncFileOp *op = m_Queue.front();
+			m_Queue.pop_front();
+
+			lock.unlock();
+			RunOperation(op);
+			{
+				std::lock_guard<std::mutex> done_lock(m_DoneLock);
+				m_Done.push_back(op);
+			}
+			lock.lock();
+		}
+	}
+
+	static void RunOperation(AsyncFileOp *op)
+	{
+		switch (op->type)
+		{
+			case AsyncFile_Read:
+			{
+				FILE *fp = fopen(op->path.c_str(), "rb");
+				if (!fp)
+					break;
+
+				op->buffer.reset(new FileBuffer);
+				char chunk[16384];
+				size_t read;
+				while ((read = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+					op->buffer->data.append(chunk, read);
+
+				op->success = !ferror(fp);
+				fclose(fp);
+				break;
+			}
+
+			case AsyncFile_Write:
+			{
+				FILE *fp = fopen(op->path.c_str(), op->append ? "ab" : "wb");
+				if (!fp)
+					break;
+
+				const std::string &data = op->buffer->data;
+				op->success = (fwrite(data.data(), 1, data.size(), fp) == data.size());
+				if (fclose(fp) != 0)
+					op->success = false;
+				break;
+			}
+
+			case AsyncFile_ListDir:
+			{
+				IDirectory *pDir = libsys->OpenDirectory(op->path.c_str());
+				if (!pDir)
+					break;
+
+				while (pDir->MoreFiles())
+				{
+					const char *name = pDir->GetEntryName();
+					if (strcmp(name, ".") != 0 && strcmp(name, "..") != 0)
+					{
+						op->entries.push_back(name);
+						if (pDir->IsEntryDirectory())
+							op->entries.back().push_back('/');
+					}
+					pDir->NextEntry();
+				}
+
+				libsys->CloseDirectory(pDir);
+				op->success = true;
+				break;
+			}
+		}
+	}
+
+	void RunFrame()
+	{
+		if (m_Pending.empty())
+			return;
+
+		std::deque<AsyncFileOp *> done;
+		{
+			std::lock_guard<std::mutex> lock(m_DoneLock);
+			done.swap(m_Done);
+		}
+
+		while (!done.empty())
+		{
+			AsyncFileOp *op = done.front();
+			done.pop_front();
+
+			for (size_t i = 0; i < m_Pending.size(); i++)
+			{
+				if (m_Pending[i] == op)
+				{
+					m_Pending.erase(m_Pending.begin() + i);
+					break;
+				}
+			}
+
+			if (!op->cancelled && op->callback)
+				Deliver(op);
+
+			delete op;
+		}
+	}
+
+	void Deliver(AsyncFileOp *op)
+	{
+		IPluginFunction *pFunc = op->callback;
+		HandleSecurity sec(op->context->GetIdentity(), g_pCoreIdent);
+		Handle_t hndl = BAD_HANDLE;
+
+		/* Result handles belong to the plugin but only live for the duration 
+		 * of the callback, unless the plugin clones them.
+		 */
+		if (op->type == AsyncFile_Read && op->success)
+		{
+			hndl = handlesys->CreateHandle(g_FileBufferType, op->buffer.get(), op->context->GetIdentity(), g_pCoreIdent, NULL);
+			if (hndl != BAD_HANDLE)
+				op->buffer.release();
+		}
+		else if (op->type == AsyncFile_ListDir && op->success)
+		{
+			CellArray *array = new CellArray(PLATFORM_MAX_PATH / sizeof(cell_t) + 1);
+			for (size_t i = 0; i < op->entries.size(); i++)
+			{
+				cell_t *blk = array->push();
+				if (!blk)
+					break;
+				ke::SafeStrcpy((char *)blk, array->blocksize() * sizeof(cell_t), op->entries[i].c_str());
+			}
+
+			hndl = handlesys->CreateHandle(htCellArray, array, op->context->GetIdentity(), g_pCoreIdent, NULL);
+			if (hndl == BAD_HANDLE)
+				delete array;
+		}
+
+		pFunc->PushCell(op->success);
+		if (op->type != AsyncFile_Write)
+			pFunc->PushCell(hndl);
+		pFunc->PushCell(op->data);
+		pFunc->Execute(NULL);
+
+		if (hndl != BAD_HANDLE)
+			handlesys->FreeHandle(hndl, &sec);
+	}
+private:
+	std::vector<std::unique_ptr<std::thread>> m_Workers;
+	std::deque<AsyncFileOp *> m_Queue;
+	std::mutex m_Lock;
+	std::condition_variable m_Event;
+	bool m_Terminate;
+
+	std::deque<AsyncFileOp *> m_Done;
+	std::mutex m_DoneLock;
+
+	/* Every submitted operation that hasn't been delivered yet. */
+	std::vector<AsyncFileOp *> m_Pending;
+} s_AsyncFiles;
+
+void AsyncFileManager::FrameHook(bool simulating)
+{
+	s_AsyncFiles.RunFrame();
+}
+
+static AsyncFileOp *CreateFileOp(IPluginContext *pContext, AsyncFileOpType type, cell_t path, cell_t callback, cell_t data)
+{
+	char *file;
+	pContext->LocalToString(path, &file);
+
+	IPluginFunction *pFunc = NULL;
+	if (callback != -1)
+	{
+		pFunc = pContext->GetFunctionById(callback);
+		if (!pFunc)
+		{
+			pContext->ReportError("Invalid function id (%x)", callback);
+			return NULL;
+		}
+	}
+
+	char realpath[PLATFORM_MAX_PATH];
+	g_pSM->BuildPath(Path_Game, realpath, sizeof(realpath), "%s", file);
+
+	AsyncFileOp *op = new AsyncFileOp;
+	op->type = type;
+	op->path = realpath;
+	op->append = false;
+	op->context = pContext;
+	op->callback = pFunc;
+	op->data = data;
+	return op;
+}
+
+static cell_t sm_ReadFileAsync(IPluginContext *pContext, const cell_t *params)
+{
+	AsyncFileOp *op = CreateFileOp(pContext, AsyncFile_Read, params[1], params[2], params[3]);
+	if (!op)
+		return 0;
+
+	s_AsyncFiles.Submit(op);
+	return 1;
+}
+
+static cell_t sm_WriteFileAsync(IPluginContext *pContext, const cell_t *params)
+{
+	char *contents;
+	pContext->LocalToString(params[2], &contents);
+
+	cell_t length = params[3];
+	if (length < 0)
+		length = (cell_t)strlen(contents);
+
+	AsyncFileOp *op = CreateFileOp(pContext, AsyncFile_Write, params[1], params[5], params[6]);
+	if (!op)
+		return 0;
+
+	/* The plugin's memory can't be read from another thread, so this is the 
+	 * only copy the write makes.
+	 */
+	op->append = !!params[4];
+	op->buffer.reset(new FileBuffer);
+	op->buffer->data.assign(contents, length);
+
+	s_AsyncFiles.Submit(op);
+	return 1;
+}
+
+static cell_t sm_ListDirectoryAsync(IPluginContext *pContext, const cell_t *params)
+{
+	AsyncFileOp *op = CreateFileOp(pContext, AsyncFile_ListDir, params[1], params[2], params[3]);
+	if (!op)
+		return 0;
+
+	s_AsyncFiles.Submit(op);
+	return 1;
+}
+
+static FileBuffer *ReadFileBuffer(IPluginContext *pContext, cell_t hndl)
+{
+	FileBuffer *buffer;
+	HandleError herr;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((herr = handlesys->ReadHandle(hndl, g_FileBufferType, &sec, (void **)&buffer)) != HandleError_None)
+	{
+		pContext->ReportError("Invalid FileBuffer handle %x (error %d)", hndl, herr);
+		return NULL;
+	}
+	return buffer;
+}
+
+static cell_t FileBuffer_Length(IPluginContext *pContext, const cell_t *params)
+{
+	FileBuffer *buffer = ReadFileBuffer(pContext, params[1]);
+	if (!buffer)
+		return 0;
+
+	return (cell_t)buffer->data.size();
+}
+
+static cell_t FileBuffer_Read(IPluginContext *pContext, const cell_t *params)
+{
+	FileBuffer *buffer = ReadFileBuffer(pContext, params[1]);
+	if (!buffer)
+		return 0;
+
+	cell_t offset = params[2];
+	cell_t num_items = params[4];
+	cell_t size = params[5];
+	if (size != 1 && size != 2 && size != 4)
+		return pContext->ThrowNativeError("Invalid size specifier (%d is not 1, 2, or 4)", size);
+	if (offset < 0 || (size_t)offset > buffer->data.size())
+		return pContext->ThrowNativeError("Offset %d is out of bounds (length %d)", offset, (int)buffer->data.size());
+	if (num_items < 0)
+		return pContext->ThrowNativeError("Invalid item count %d", num_items);
+
+	size_t avail = (buffer->data.size() - offset) / size;
+	if ((size_t)num_items > avail)
+		num_items = (cell_t)avail;
+
+	cell_t *items;
+	pContext->LocalToPhysAddr(params[3], &items);
+
+	const unsigned char *src = (const unsigned char *)buffer->data.data() + offset;
+	for (cell_t i = 0; i < num_items; i++, src += size)
+	{
+		switch (size)
+		{
+			case 4:
+				memcpy(&items[i], src, sizeof(cell_t));
+				break;
+			case 2:
+			{
+				uint16_t val;
+				memcpy(&val, src, sizeof(val));
+				items[i] = val;
+				break;
+			}
+			case 1:
+				items[i] = *src;
+				break;
+		}
+	}
+
+	return num_items;
+}
+
+static cell_t FileBuffer_ReadString(IPluginContext *pContext, const cell_t *params)
+{
+	FileBuffer *buffer = ReadFileBuffer(pContext, params[1]);
+	if (!buffer)
+		return 0;
+
+	cell_t offset = params[2];
+	if (offset < 0 || (size_t)offset > buffer->data.size())
+		return pContext->ThrowNativeError("Offset %d is out of bounds (length %d)", offset, (int)buffer->data.size());
+	if (params[4] <= 0)
+		return pContext->ThrowNativeError("Invalid buffer size %d", params[4]);
+
+	char *dest;
+	pContext->LocalToString(params[3], &dest);
+
+	size_t len = buffer->data.size() - offset;
+	if (len > (size_t)params[4] - 1)
+		len = (size_t)params[4] - 1;
+
+	const char *src = buffer->data.data() + offset;
+	const char *nul = (const char *)memchr(src, '\0', len);
+	if (nul)
+		len = nul - src;
+
+	memcpy(dest, src, len);
+	dest[len] = '\0';
+
+	return (cell_t)len;
+}
+
+REGISTER_NATIVES(asyncfilenatives)
+{
+	{"ReadFileAsync",			sm_ReadFileAsync},
+	{"WriteFileAsync",			sm_WriteFileAsync},
+	{"ListDirectoryAsync",		sm_ListDirectoryAsync},
+
+	{"FileBuffer.Length.get",	FileBuffer_Length},
+	{"FileBuffer.Read",			FileBuffer_Read},
+	{"FileBuffer.ReadString",	FileBuffer_ReadString},
+
+	{NULL,						NULL},
+};
@@ -34,7 +34,9 @@
 #include <stdlib.h>
 #include "common_logic.h"
 #include "MersenneTwister.h"
+#include "Xoshiro.h"
 #include <IPluginSys.h>
+#include <IHandleSys.h>
 #include <am-utility.h>
 #include <am-float.h>
 
@@ -295,21 +297,31 @@ static cell_t sm_ArcTangent2(IPluginContext *pCtx, const cell_t *params)
 	return sp_ftoc(val1);
 }
 
+HandleType_t g_RandomType = 0;
+
 class RandomHelpers :
 	public SMGlobalClass,
-	public IPluginsListener
+	public IPluginsListener,
+	public IHandleTypeDispatch
 {
 public:
 	void OnSourceModAllInitialized()
 	{
 		pluginsys->AddPluginsListener(this);
+		g_RandomType = handlesys->CreateType("Random", this, 0, NULL, NULL, g_pCoreIdent, NULL);
 	}
 
 	void OnSourceModShutdown()
 	{
+		handlesys->RemoveType(g_RandomType, g_pCoreIdent);
 		pluginsys->RemovePluginsListener(this);
 	}
 
+	void OnHandleDestroy(HandleType_t type, void *object)
+	{
+		delete (Xoshiro256 *)object;
+	}
+
 	void OnPluginDestroyed(IPlugin *plugin)
 	{
 		MTRand *mtrand;
@@ -357,6 +369,190 @@ static cell_t SetURandomSeed(IPluginContext *ctx, const cell_t *params)
 	return 1;
 }
 
+static cell_t GetURandomIntArray(IPluginContext *ctx, const cell_t *params)
+{
+	if (params[2] < 0)
+		return ctx->ThrowNativeError("Invalid count %d", params[2]);
+
+	cell_t *buffer;
+	ctx->LocalToPhysAddr(params[1], &buffer);
+
+	MTRand *randobj = s_RandHelpers.RandObjForPlugin(ctx);
+	for (cell_t i = 0; i < params[2]; i++)
+		buffer[i] = randobj->randInt() & 0x7FFFFFFF;
+	return 1;
+}
+
+static cell_t GetURandomFloatArray(IPluginContext *ctx, const cell_t *params)
+{
+	if (params[2] < 0)
+		return ctx->ThrowNativeError("Invalid count %d", params[2]);
+
+	cell_t *buffer;
+	ctx->LocalToPhysAddr(params[1], &buffer);
+
+	MTRand *randobj = s_RandHelpers.RandObjForPlugin(ctx);
+	for (cell_t i = 0; i < params[2]; i++)
+		buffer[i] = sp_ftoc((float)randobj->rand());
+	return 1;
+}
+
+static Xoshiro256 *ReadRandom(IPluginContext *ctx, Handle_t hndl)
+{
+	HandleSecurity sec(ctx->GetIdentity(), g_pCoreIdent);
+	HandleError err;
+	Xoshiro256 *rng;
+
+	if ((err = handlesys->ReadHandle(hndl, g_RandomType, &sec, (void **)&rng))
+		!= HandleError_None)
+	{
+		ctx->ReportError("Invalid Random handle %x (error %d)", hndl, err);
+		return NULL;
+	}
+	return rng;
+}
+
+static inline uint64_t RandomSeedFromParams(const cell_t *params)
+{
+	return (uint64_t(uint32_t(params[2])) << 32) | uint32_t(params[1]);
+}
+
+static cell_t Random_Random(IPluginContext *ctx, const cell_t *params)
+{
+	uint64_t seed = RandomSeedFromParams(params);
+	if (!seed)
+	{
+		/* Draw the seed from the plugin's own stream, so unseeded generators
+		 * are independent of each other. */
+		MTRand *randobj = s_RandHelpers.RandObjForPlugin(ctx);
+		seed = (uint64_t(randobj->randInt()) << 32) | randobj->randInt();
+	}
+
+	Xoshiro256 *rng = new Xoshiro256(seed);
+	Handle_t hndl = handlesys->CreateHandle(g_RandomType, rng, ctx->GetIdentity(), g_pCoreIdent, NULL);
+	if (hndl == BAD_HANDLE)
+		delete rng;
+	return hndl;
+}
+
+static cell_t Random_SetSeed(IPluginContext *ctx, const cell_t *params)
+{
+	Xoshiro256 *rng = ReadRandom(ctx, params[1]);
+	if (!rng)
+		return 0;
+
+	rng->Seed(RandomSeedFromParams(&params[1]));
+	return 1;
+}
+
+static cell_t Random_NextInt(IPluginContext *ctx, const cell_t *params)
+{
+	Xoshiro256 *rng = ReadRandom(ctx, params[1]);
+	if (!rng)
+		return 0;
+
+	return rng->Next32() & 0x7FFFFFFF;
+}
+
+static cell_t Random_NextFloat(IPluginContext *ctx, const cell_t *params)
+{
+	Xoshiro256 *rng = ReadRandom(ctx, params[1]);
+	if (!rng)
+		return 0;
+
+	return sp_ftoc(rng->NextFloat());
+}
+
+static inline cell_t RandomIntInRange(Xoshiro256 *rng, cell_t min, cell_t max)
+{
+	/* Inclusive; the full [INT_MIN, INT_MAX] span wraps to a range of 0. */
+	uint32_t range = uint32_t(max) - uint32_t(min) + 1;
+	return cell_t(uint32_t(min) + rng->Below(range));
+}
+
+static cell_t Random_IntRange(IPluginContext *ctx, const cell_t *params)
+{
+	Xoshiro256 *rng = ReadRandom(ctx, params[1]);
+	if (!rng)
+		return 0;
+	if (params[2] > params[3])
+		return ctx->ThrowNativeError("Invalid range [%d, %d]", params[2], params[3]);
+
+	return RandomIntInRange(rng, params[2], params[3]);
+}
+
+static cell_t Random_FloatRange(IPluginContext *ctx, const cell_t *params)
+{
+	Xoshiro256 *rng = ReadRandom(ctx, params[1]);
+	if (!rng)
+		return 0;
+
+	float min = sp_ctof(params[2]);
+	float max = sp_ctof(params[3]);
+	return sp_ftoc(min + (max - min) * rng->NextFloat());
+}
+
+static cell_t Random_FillInts(IPluginContext *ctx, const cell_t *params)
+{
+	Xoshiro256 *rng = ReadRandom(ctx, params[1]);
+	if (!rng)
+		return 0;
+	if (params[3] < 0)
+		return ctx->ThrowNativeError("Invalid count %d", params[3]);
+	if (params[4] > params[5])
+		return ctx->ThrowNativeError("Invalid range [%d, %d]", params[4], params[5]);
+
+	cell_t *buffer;
+	ctx->LocalToPhysAddr(params[2], &buffer);
+
+	for (cell_t i = 0; i < params[3]; i++)
+		buffer[i] = RandomIntInRange(rng, params[4], params[5]);
+	return 1;
+}
+
+static cell_t Random_FillFloats(IPluginContext *ctx, const cell_t *params)
+{
+	Xoshiro256 *rng = ReadRandom(ctx, params[1]);
+	if (!rng)
+		return 0;
+	if (params[3] < 0)
+		return ctx->ThrowNativeError("Invalid count %d", params[3]);
+
+	cell_t *buffer;
+	ctx->LocalToPhysAddr(params[2], &buffer);
+
+	float min = sp_ctof(params[4]);
+	float scale = sp_ctof(params[5]) - min;
+	for (cell_t i = 0; i < params[3]; i++)
+		buffer[i] = sp_ftoc(min + scale * rng->NextFloat());
+	return 1;
+}
+
+static cell_t Random_FillUnitVectors(IPluginContext *ctx, const cell_t *params)
+{
+	Xoshiro256 *rng = ReadRandom(ctx, params[1]);
+	if (!rng)
+		return 0;
+	if (params[3] < 0)
+		return ctx->ThrowNativeError("Invalid count %d", params[3]);
+
+	cell_t *buffer;
+	ctx->LocalToPhysAddr(params[2], &buffer);
+
+	/* Uniform on the sphere: z is uniform in [-1, 1), the azimuth uniform in
+	 * [0, 2pi). */
+	for (cell_t i = 0; i < params[3]; i++)
+	{
+		float z = rng->NextFloat() * 2.0f - 1.0f;
+		float t = rng->NextFloat() * 6.28318530717958647692f;
+		float r = sqrtf(1.0f - z * z);
+		buffer[i * 3 + 0] = sp_ftoc(r * cosf(t));
+		buffer[i * 3 + 1] = sp_ftoc(r * sinf(t));
+		buffer[i * 3 + 2] = sp_ftoc(z);
+	}
+	return 1;
+}
+
 REGISTER_NATIVES(floatnatives)
 {
 	{"float",			sm_float},
@@ -398,6 +594,17 @@ REGISTER_NATIVES(floatnatives)
 	{"GetURandomInt",	GetURandomInt},
 	{"GetURandomFloat",	GetURandomFloat},
 	{"SetURandomSeed",	SetURandomSeed},
+	{"GetURandomIntArray",	GetURandomIntArray},
+	{"GetURandomFloatArray",	GetURandomFloatArray},
+	{"Random.Random",	Random_Random},
+	{"Random.SetSeed",	Random_SetSeed},
+	{"Random.NextInt",	Random_NextInt},
+	{"Random.NextFloat",	Random_NextFloat},
+	{"Random.IntRange",	Random_IntRange},
+	{"Random.FloatRange",	Random_FloatRange},
+	{"Random.FillInts",	Random_FillInts},
+	{"Random.FillFloats",	Random_FillFloats},
+	{"Random.FillUnitVectors",	Random_FillUnitVectors},
 	{NULL,				NULL}
 };
 
@@ -30,15 +30,32 @@
  */
 
 #include <memory>
+#include <new>
+#include <vector>
 
 #include "common_logic.h"
 #include <IPluginSys.h>
 #include <IHandleSys.h>
 #include <IForwardSys.h>
 #include <ISourceMod.h>
+#include "FrameScheduler.h"
+#include "frame_tasks.h"
 
 HandleType_t g_GlobalFwdType = 0;
 HandleType_t g_PrivateFwdType = 0;
+HandleType_t g_PreparedCallType = 0;
+
+/* A call to a function or forward whose signature was checked once, up front.
+ * Only the target is looked up again on every call, since plugins and
+ * forwards can go away in the meantime.
+ */
+struct PreparedCall
+{
+	Handle_t plugin;			/* Plugin owning the function, if calling a function */
+	funcid_t funcid;
+	Handle_t forward;			/* Forward, if calling one */
+	std::vector<ParamType> types;
+};
 
 static bool s_CallStarted = false;
 static ICallable *s_pCallable = NULL;
@@ -67,16 +84,25 @@ public:
 
 		/* Create 'PrivateFwd' handle type */
 		g_PrivateFwdType = handlesys->CreateType("PrivateFwd", this, g_GlobalFwdType, NULL, &sec, g_pCoreIdent, NULL);
+
+		g_PreparedCallType = handlesys->CreateType("PreparedCall", this, 0, NULL, NULL, g_pCoreIdent, NULL);
 	}
 
 	void OnSourceModShutdown()
 	{
+		handlesys->RemoveType(g_PreparedCallType, g_pCoreIdent);
 		handlesys->RemoveType(g_PrivateFwdType, g_pCoreIdent);
 		handlesys->RemoveType(g_GlobalFwdType, g_pCoreIdent);
 	}
 
 	void OnHandleDestroy(HandleType_t type, void *object)
 	{
+		if (type == g_PreparedCallType)
+		{
+			delete static_cast<PreparedCall *>(object);
+			return;
+		}
+
 		IForward *pForward = static_cast<IForward *>(object);
 
 		forwardsys->ReleaseForward(pForward);
@@ -84,6 +110,13 @@ public:
 
 	bool GetHandleApproxSize(HandleType_t type, void *object, unsigned int *pSize)
 	{
+		if (type == g_PreparedCallType)
+		{
+			PreparedCall *call = static_cast<PreparedCall *>(object);
+			*pSize = sizeof(PreparedCall) + call->types.size() * sizeof(ParamType);
+			return true;
+		}
+
 		*pSize = sizeof(IForward*) + (((IForward *)object)->GetFunctionCount() * 12);
 		return true;
 	}
@@ -687,36 +720,228 @@ static cell_t sm_CallCancel(IPluginContext *pContext, const cell_t *params)
 	return 1;
 }
 
+static PreparedCall *CreatePreparedCall(IPluginContext *pContext, const cell_t *params, int first_type)
+{
+	PreparedCall *call = new PreparedCall;
+	call->plugin = 0;
+	call->funcid = 0;
+	call->forward = 0;
+
+	cell_t *addr;
+	for (int i = first_type; i <= params[0]; i++)
+	{
+		pContext->LocalToPhysAddr(params[i], &addr);
+		ParamType type = static_cast<ParamType>(*addr);
+		switch (type)
+		{
+		case Param_Any:
+		case Param_Cell:
+		case Param_Float:
+		case Param_CellByRef:
+		case Param_FloatByRef:
+			call->types.push_back(type);
+			break;
+		default:
+			delete call;
+			pContext->ReportError("Parameter %d has a type that cannot be prepared; only cells, floats, and references to them are supported",
+				i - first_type + 1);
+			return NULL;
+		}
+	}
+
+	return call;
+}
+
+static cell_t sm_CreatePreparedCall(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError err;
+	IPlugin *pPlugin;
+
+	if (params[0] - 2 > SP_MAX_EXEC_PARAMS)
+	{
+		return pContext->ThrowNativeErrorEx(SP_ERROR_PARAMS_MAX, NULL);
+	}
+
+	if (hndl == 0)
+	{
+		pPlugin = pluginsys->FindPluginByContext(pContext->GetContext());
+	} else {
+		pPlugin = pluginsys->PluginFromHandle(hndl, &err);
+
+		if (!pPlugin)
+		{
+			return pContext->ThrowNativeError("Plugin handle %x is invalid (error %d)", hndl, err);
+		}
+	}
+
+	cell_t funcid = params[2];
+	if (funcid <= 0 || !pPlugin->GetBaseContext()->GetFunctionById(funcid))
+	{
+		return pContext->ThrowNativeError("Invalid function id (%X)", funcid);
+	}
+
+	PreparedCall *call = CreatePreparedCall(pContext, params, 3);
+	if (!call)
+		return 0;
+	call->plugin = pPlugin->GetMyHandle();
+	call->funcid = funcid;
+
+	Handle_t out = handlesys->CreateHandle(g_PreparedCallType, call, pContext->GetIdentity(), g_pCoreIdent, NULL);
+	if (out == BAD_HANDLE)
+		delete call;
+	return out;
+}
+
+static cell_t sm_CreatePreparedForwardCall(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError err;
+	IForward *pForward;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if (params[0] - 1 > SP_MAX_EXEC_PARAMS)
+	{
+		return pContext->ThrowNativeErrorEx(SP_ERROR_PARAMS_MAX, NULL);
+	}
+
+	if ((err=handlesys->ReadHandle(hndl, g_GlobalFwdType, &sec, (void **)&pForward))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid forward handle %x (error %d)", hndl, err);
+	}
+
+	PreparedCall *call = CreatePreparedCall(pContext, params, 2);
+	if (!call)
+		return 0;
+	call->forward = hndl;
+
+	Handle_t out = handlesys->CreateHandle(g_PreparedCallType, call, pContext->GetIdentity(), g_pCoreIdent, NULL);
+	if (out == BAD_HANDLE)
+		delete call;
+	return out;
+}
+
+static cell_t sm_PreparedCallExecute(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError err;
+	PreparedCall *call;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err=handlesys->ReadHandle(hndl, g_PreparedCallType, &sec, (void **)&call))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid prepared call handle %x (error %d)", hndl, err);
+	}
+
+	if (params[3] != (cell_t)call->types.size())
+	{
+		return pContext->ThrowNativeError("Prepared call takes %d arguments, %d given", (int)call->types.size(), params[3]);
+	}
+
+	cell_t *args, *result;
+	pContext->LocalToPhysAddr(params[2], &args);
+	pContext->LocalToPhysAddr(params[4], &result);
+
+	IPluginFunction *pFunction = NULL;
+	IForward *pForward = NULL;
+	ICallable *pCallable;
+	if (call->forward)
+	{
+		if ((err=handlesys->ReadHandle(call->forward, g_GlobalFwdType, &sec, (void **)&pForward))
+			!= HandleError_None)
+		{
+			return pContext->ThrowNativeError("Forward handle %x of this call has been closed (error %d)", call->forward, err);
+		}
+		pCallable = pForward;
+	} else {
+		IPlugin *pPlugin = pluginsys->PluginFromHandle(call->plugin, &err);
+		if (!pPlugin || !(pFunction = pPlugin->GetBaseContext()->GetFunctionById(call->funcid)))
+		{
+			return pContext->ThrowNativeError("The plugin containing the function of this call has been unloaded");
+		}
+		pCallable = pFunction;
+	}
+
+	for (size_t i = 0; i < call->types.size(); i++)
+	{
+		int err;
+		if (call->types[i] == Param_FloatByRef)
+			err = pCallable->PushFloatByRef(reinterpret_cast<float *>(&args[i]));
+		else if (call->types[i] == Param_CellByRef)
+			err = pCallable->PushCellByRef(&args[i]);
+		else if (call->types[i] == Param_Float)
+			err = pCallable->PushFloat(sp_ctof(args[i]));
+		else
+			err = pCallable->PushCell(args[i]);
+
+		if (err)
+		{
+			pCallable->Cancel();
+			return pContext->ThrowNativeErrorEx(err, NULL);
+		}
+	}
+
+	// Note: Execute() swallows exceptions, so this is okay.
+	if (pFunction)
+		return pFunction->Execute(result);
+	return pForward->Execute(result, NULL);
+}
+
+static cell_t sm_PreparedCallParamCount(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError err;
+	PreparedCall *call;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err=handlesys->ReadHandle(hndl, g_PreparedCallType, &sec, (void **)&call))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid prepared call handle %x (error %d)", hndl, err);
+	}
+
+	return (cell_t)call->types.size();
+}
+
+/* Plain data in a pooled frame block; no per-call forward or Handle. */
 struct SMFrameActionData
 {
-	SMFrameActionData(Handle_t handle, Handle_t ownerhandle, cell_t data) : handle(handle), ownerhandle(ownerhandle), data(data)
+	SMFrameActionData(Handle_t ownerhandle, funcid_t funcid, cell_t data) : ownerhandle(ownerhandle), funcid(funcid), data(data)
 	{
 	};
-	Handle_t handle;
 	Handle_t ownerhandle;
+	funcid_t funcid;
 	cell_t data;
 };
 
+static_assert(sizeof(SMFrameActionData) <= kFrameBlockSize, "SMFrameActionData must fit in a frame block");
+
 static void PawnFrameAction(void *pData)
 {
-	std::unique_ptr<SMFrameActionData> frame(reinterpret_cast<SMFrameActionData *>(pData));
-	IPlugin *pPlugin = pluginsys->PluginFromHandle(frame->ownerhandle, NULL);
-	if (!pPlugin)
+	SMFrameActionData *frame = reinterpret_cast<SMFrameActionData *>(pData);
+	Handle_t ownerhandle = frame->ownerhandle;
+	funcid_t funcid = frame->funcid;
+	cell_t data = frame->data;
+
+	frame->~SMFrameActionData();
+	FreeFrameBlock(frame);
+
+	IPlugin *pPlugin = pluginsys->PluginFromHandle(ownerhandle, NULL);
+	if (!pPlugin || pPlugin->GetStatus() != Plugin_Running)
 	{
 		return;
 	}
 
-	IChangeableForward *pForward;
-	HandleSecurity sec(pPlugin->GetIdentity(), g_pCoreIdent);
-	if (handlesys->ReadHandle(frame->handle, g_PrivateFwdType, &sec, (void **)&pForward) != HandleError_None)
+	IPluginFunction *pFunction = pPlugin->GetBaseContext()->GetFunctionById(funcid);
+	if (!pFunction)
 	{
 		return;
 	}
 
-	pForward->PushCell(frame->data);
-	pForward->Execute(NULL);
-
-	handlesys->FreeHandle(frame->handle, &sec);
+	pFunction->PushCell(data);
+	pFunction->Execute(NULL);
 }
 
 static cell_t sm_AddFrameAction(IPluginContext *pContext, const cell_t *params)
@@ -728,19 +953,64 @@ static cell_t sm_AddFrameAction(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid function id (%X)", params[1]);
 	}
 
-	IChangeableForward *pForward = forwardsys->CreateForwardEx(NULL, ET_Ignore, 1, NULL, Param_Cell);
-	IdentityToken_t *pIdentity = pContext->GetIdentity();
-	Handle_t Handle = handlesys->CreateHandle(g_PrivateFwdType, pForward, pIdentity, g_pCoreIdent, NULL);
-	if (Handle == BAD_HANDLE)
+	void *block = AllocFrameBlock();
+	SMFrameActionData *pData = new (block) SMFrameActionData(pPlugin->GetMyHandle(), params[1], params[2]);
+	g_pSM->AddFrameAction(PawnFrameAction, pData);
+	return 1;
+}
+
+struct PawnFrameTask
+{
+	Handle_t plugin;
+	funcid_t funcid;
+	cell_t data;
+};
+
+static void RunPawnFrameTask(void *pData)
+{
+	std::unique_ptr<PawnFrameTask> task(reinterpret_cast<PawnFrameTask *>(pData));
+
+	/* Tasks are cancelled when their plugin unloads, but it may be paused. */
+	IPlugin *pPlugin = pluginsys->PluginFromHandle(task->plugin, NULL);
+	if (!pPlugin || pPlugin->GetStatus() != Plugin_Running)
 	{
-		forwardsys->ReleaseForward(pForward);
-		return 0;
+		return;
+	}
+
+	IPluginFunction *pFunction = pPlugin->GetBaseContext()->GetFunctionById(task->funcid);
+	if (!pFunction)
+	{
+		return;
 	}
 
-	pForward->AddFunction(pFunction);
+	pFunction->PushCell(task->data);
+	pFunction->Execute(NULL);
+}
+
+static void DropPawnFrameTask(void *pData)
+{
+	delete reinterpret_cast<PawnFrameTask *>(pData);
+}
 
-	SMFrameActionData *pData = new SMFrameActionData(Handle, pPlugin->GetMyHandle(), params[2]);
-	g_pSM->AddFrameAction(PawnFrameAction, pData);
+static cell_t sm_AddFrameTask(IPluginContext *pContext, const cell_t *params)
+{
+	IPlugin *pPlugin = pluginsys->FindPluginByContext(pContext->GetContext());
+	if (!pPlugin->GetBaseContext()->GetFunctionById(params[1]))
+	{
+		return pContext->ThrowNativeError("Invalid function id (%X)", params[1]);
+	}
+
+	FrameTaskPriority priority = static_cast<FrameTaskPriority>(params[3]);
+	if (priority < FrameTask_High || priority >= FrameTask_Priorities)
+	{
+		return pContext->ThrowNativeError("Invalid frame task priority %d", params[3]);
+	}
+
+	PawnFrameTask *task = new PawnFrameTask;
+	task->plugin = pPlugin->GetMyHandle();
+	task->funcid = params[1];
+	task->data = params[2];
+	g_FrameScheduler.AddTask(pContext->GetIdentity(), priority, RunPawnFrameTask, task, DropPawnFrameTask);
 	return 1;
 }
 
@@ -768,6 +1038,7 @@ REGISTER_NATIVES(functionNatives)
 	{"Call_Finish",                         sm_CallFinish},
 	{"Call_Cancel",                         sm_CallCancel},
 	{"RequestFrame",                        sm_AddFrameAction},
+	{"RequestFrameTask",                    sm_AddFrameTask},
 
 	{"GlobalForward.GlobalForward",         sm_CreateGlobalForward},
 	{"GlobalForward.FunctionCount.get",     sm_GetForwardFunctionCount},
@@ -777,5 +1048,10 @@ REGISTER_NATIVES(functionNatives)
 	{"PrivateForward.RemoveFunction",       sm_RemoveFromForward},
 	{"PrivateForward.RemoveAllFunctions",   sm_RemoveAllFromForward},
 
+	{"PreparedCall.PreparedCall",           sm_CreatePreparedCall},
+	{"PreparedCall.FromForward",            sm_CreatePreparedForwardCall},
+	{"PreparedCall.Execute",                sm_PreparedCallExecute},
+	{"PreparedCall.ParamCount.get",         sm_PreparedCallParamCount},
+
 	{NULL,                                  NULL},
 };
@@ -32,6 +32,7 @@
 #include "common_logic.h"
 #include <IHandleSys.h>
 #include <IPluginSys.h>
+#include "HandleSys.h"
 
 using namespace SourceMod;
 
@@ -113,12 +114,18 @@ static cell_t sm_GetMyHandle(IPluginContext *pContext, const cell_t *params)
 	return pPlugin->GetMyHandle();
 }
 
+static cell_t sm_GetHandleAllocCount(IPluginContext *pContext, const cell_t *params)
+{
+	return (cell_t)g_HandleSys.GetHandlesCreated();
+}
+
 REGISTER_NATIVES(handles)
 {
 	{"IsValidHandle",			sm_IsValidHandle},
 	{"CloseHandle",				sm_CloseHandle},
 	{"CloneHandle",				sm_CloneHandle},
 	{"GetMyHandle",				sm_GetMyHandle},
+	{"GetHandleAllocCount",		sm_GetHandleAllocCount},
 	{"Handle.Clone",			sm_CloneHandle},
 	{"Handle.Close",			sm_CloseHandle},
 	{"Handle.~Handle",			sm_CloseHandle},
@@ -56,6 +56,7 @@ static cell_t sm_IsTranslatedForLanguage(IPluginContext *pCtx, const cell_t *par
 	pCtx->LocalToString(params[1], &phrase);
 	
 	int langid = params[2];
+	g_Translator.MaterializeLanguage(langid);
 
 	Translation trans;
 	return (collection->FindTranslation(phrase, langid, &trans) == Trans_Okay);
@@ -140,6 +141,7 @@ static cell_t sm_SetClientLanguage(IPluginContext *pContext, const cell_t *param
 	}
 	
 	player->SetLanguageId(params[2]);
+	g_Translator.MaterializeLanguage(params[2]);
 
 	return 1;
 }
@@ -38,6 +38,9 @@
 #include <ITextParsers.h>
 #include <ISourceMod.h>
 #include "stringutil.h"
+#include "FrameScheduler.h"
+#include <sm_hashmap.h>
+#include <time.h>
 #include <bridge/include/CoreProvider.h>
 #include <bridge/include/ILogger.h>
 #include <bridge/include/IFileSystemBridge.h>
@@ -50,9 +53,6 @@ struct maplist_info_t
 	bool bIsPath;
 	char name[PLATFORM_MAX_PATH];
 	char path[PLATFORM_MAX_PATH];
-	time_t last_modified_time;
-	CellArray *pArray;
-	int serial;
 
 	static inline bool matches(const char *key, const maplist_info_t *value)
 	{
@@ -68,6 +68,43 @@ struct maplist_info_t
 #define MAPLIST_FLAG_CLEARARRAY		(1<<1)		/**< If an input array is specified, clear it before adding. */
 #define MAPLIST_FLAG_NO_DEFAULT		(1<<2)		/**< Do not read "default" or "mapcyclefile" on failure. */
 
+#define MAPLIST_FOLDER_RECHECK		30			/**< Seconds between checks of the maps folders for changes. */
+
+/**
+ * Parsed contents of one map cycle file, shared by every map list that
+ * points at it. The serial only changes when the maps in it do.
+ */
+struct mapfile_cache_t
+{
+	time_t mtime;
+	unsigned int size;
+	CellArray *pArray;
+	int serial;
+};
+
+static bool IsSameMapArray(CellArray *a, CellArray *b)
+{
+	if (a == NULL || b == NULL)
+	{
+		return a == b;
+	}
+
+	if (a->size() != b->size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < a->size(); i++)
+	{
+		if (strcmp((char *)a->at(i), (char *)b->at(i)) != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 class MapLists : public SMGlobalClass, public ITextListener_SMC
 {
 public:
@@ -83,14 +120,29 @@ public:
 		m_pMapCycleFile = NULL;
 		m_ConfigLastChanged = 0;
 		m_nSerialChange = 0;
+		m_pFolderArray = NULL;
+		m_FolderSerial = 0;
+		m_FolderScanned = false;
+		m_FolderRefreshQueued = false;
+		m_FolderStamp = 0;
+		m_FolderChecked = 0;
 	}
 	void OnSourceModAllInitialized()
 	{
 		g_pSM->BuildPath(Path_SM, m_ConfigFile, sizeof(m_ConfigFile), "configs/maplists.cfg");
 	}
+	void OnSourceModLevelChange(const char *mapName)
+	{
+		/* Look for new maps on the next request instead of waiting out the interval. */
+		m_FolderChecked = 0;
+	}
 	void OnSourceModShutdown()
 	{
+		g_FrameScheduler.CancelTasks(g_pCoreIdent, RefreshMapsFolder);
+		m_FolderRefreshQueued = false;
+
 		DumpCache(NULL);
+		DumpFileCache();
 	}
 	void GetMapCycleFilePath(char *pBuffer, int maxlen)
 	{
@@ -116,11 +168,8 @@ public:
 			pMapList = new maplist_info_t;
 			pMapList->bIsCompat = true;
 			pMapList->bIsPath = true;
-			pMapList->last_modified_time = 0;
 			strncopy(pMapList->name, name, sizeof(pMapList->name));
-			pMapList->pArray = NULL;
 			strncopy(pMapList->path, file, sizeof(pMapList->path));
-			pMapList->serial = 0;
 			m_ListLookup.insert(name, pMapList);
 			m_MapLists.push_back(pMapList);
 			return;
@@ -132,14 +181,11 @@ public:
 
 		strncopy(path, file, sizeof(path));
 
-		/* If the path matches, don't reset the serial/time */
 		if (strcmp(path, pMapList->path) == 0)
 			return;
 
 		strncopy(pMapList->path, path, sizeof(pMapList->path));
 		pMapList->bIsPath = true;
-		pMapList->last_modified_time = 0;
-		pMapList->serial = 0;
 	}
 	void UpdateCache()
 	{
@@ -178,10 +224,6 @@ public:
 		strncopy(pDefList->name, "mapcyclefile", sizeof(pDefList->name));
 
 		GetMapCycleFilePath(pDefList->path, sizeof(pDefList->path));
-		
-		pDefList->last_modified_time = 0;
-		pDefList->pArray = NULL;
-		pDefList->serial = 0;
 
 		m_ListLookup.insert("mapcyclefile", pDefList);
 		m_MapLists.push_back(pDefList);
@@ -212,7 +254,6 @@ public:
 			if (m_ListLookup.contains((*iter)->name))
 			{
 				/* The compatibility shim is no longer needed. */
-				delete (*iter)->pArray;
 				delete (*iter);
 			}
 			else
@@ -427,11 +468,9 @@ public:
 	}
 	ICellArray *UpdateMapList(ICellArray *pUseArray, const char *name, int *pSerial, unsigned int flags)
 	{
-		int change_serial;
+		int change_serial = -1;
 		CellArray *pNewArray = NULL;
-		bool success, free_new_array;
-
-		free_new_array = false;
+		bool success;
 		
 		if ((success = GetMapList(&pNewArray, name, &change_serial)) == false)
 		{
@@ -451,12 +490,6 @@ public:
 			}
 		}
 
-		/* If there was a success, and the serial has not changed, bail out. */
-		if (success && *pSerial == change_serial)
-		{
-			return NULL;
-		}
-
 		/**
 		 * If there was a success but no map list, we need to look in the maps folder.
 		 * If there was a failure and the flag is specified, we need to look in the maps folder.
@@ -464,54 +497,7 @@ public:
 		if ((success && pNewArray == NULL)
 			|| (!success && ((flags & MAPLIST_FLAG_MAPSFOLDER) == MAPLIST_FLAG_MAPSFOLDER)))
 		{
-			pNewArray = new CellArray(64);
-			free_new_array = true;
-
-			cell_t *blk;
-
-			FileFindHandle_t findHandle;
-			const char *fileName = bridge->filesystem->FindFirstEx("maps/*.bsp", "GAME", &findHandle);
-
-			while (fileName)
-			{
-				char buffer[PLATFORM_MAX_PATH];
-
-				UTIL_StripExtension(fileName, buffer, sizeof(buffer));
-
-				if (!gamehelpers->IsMapValid(buffer))
-				{
-					fileName = bridge->filesystem->FindNext(findHandle);
-					continue;
-				}
-
-				if ((blk = pNewArray->push()) == NULL)
-				{
-					fileName = bridge->filesystem->FindNext(findHandle);
-					continue;
-				}
-
-				strncopy((char *)blk, buffer, 255);
-
-				fileName = bridge->filesystem->FindNext(findHandle);
-			}
-
-			bridge->filesystem->FindClose(findHandle);
-
-			/* Remove the array if there were no items. */
-			if (pNewArray->size() == 0)
-			{
-				delete pNewArray;
-				pNewArray = NULL;
-			}
-			else
-			{
-				qsort(pNewArray->base(), 
-					pNewArray->size(), 
-					pNewArray->blocksize() * sizeof(cell_t), 
-					sort_maps_in_adt_array);
-			}
-
-			change_serial = -1;
+			pNewArray = GetMapsFolder(&change_serial);
 		}
 
 		/* If there is still no array by this point, bail out. */
@@ -521,19 +507,18 @@ public:
 			return NULL;
 		}
 
+		/* If the serial has not changed, the caller's copy is still good. */
+		if (*pSerial == change_serial)
+		{
+			return NULL;
+		}
+
 		*pSerial = change_serial;
 
 		/* If there is no input array, return something temporary. */
 		if (pUseArray == NULL)
 		{
-			if (free_new_array)
-			{
-				return pNewArray;
-			}
-			else
-			{
-				return pNewArray->clone();
-			}
+			return pNewArray->clone();
 		}
 
 		/* Clear the input array if necessary. */
@@ -552,19 +537,12 @@ public:
 			strncopy((char *)blk_dst, (char *)blk_src, pUseArray->blocksize() * sizeof(cell_t));
 		}
 
-		/* Free resources if necessary. */
-		if (free_new_array)
-		{
-			delete pNewArray;
-		}
-
 		/* Return the array we were given. */
 		return pUseArray;
 	}
 private:
 	bool GetMapList(CellArray **ppArray, const char *name, int *pSerial)
 	{
-		time_t last_time;
 		maplist_info_t *pMapList;
 
 		if (!m_ListLookup.retrieve(name, &pMapList))
@@ -588,83 +566,255 @@ private:
 			if (strcmp(path, pMapList->path) != 0)
 			{
 				strncopy(pMapList->path, path, sizeof(pMapList->path));
-				pMapList->last_modified_time = 0;
 			}
 		}
 
+		mapfile_cache_t *pFile = GetMapFile(pMapList->path);
+		if (pFile == NULL || pFile->pArray == NULL || pFile->pArray->size() == 0)
+		{
+			return false;
+		}
+
+		*pSerial = pFile->serial;
+		*ppArray = pFile->pArray;
+
+		return true;
+	}
+	mapfile_cache_t *GetMapFile(const char *path)
+	{
+		time_t mtime;
 		char realpath[PLATFORM_MAX_PATH];
-		g_pSM->BuildPath(Path_Game, realpath, sizeof(realpath), "%s", pMapList->path);
+		g_pSM->BuildPath(Path_Game, realpath, sizeof(realpath), "%s", path);
 
-		if (!libsys->FileTime(realpath, FileTime_LastChange, &last_time)
-			|| last_time > pMapList->last_modified_time)
+		/* Files outside the mod folder can't be stat'd; those are re-read every time. */
+		if (!libsys->FileTime(realpath, FileTime_LastChange, &mtime))
 		{
-			/* Reparse */
-			FileHandle_t fp;
-			cell_t *blk;
-			char buffer[255];
+			mtime = 0;
+		}
+		unsigned int size = bridge->filesystem->Size(path, "GAME");
 
-			if ((fp = bridge->filesystem->Open(pMapList->path, "rt", "GAME")) == NULL)
-			{
-				return false;
-			}
+		mapfile_cache_t *pFile = NULL;
+		if (m_FileCache.retrieve(path, &pFile)
+			&& mtime != 0
+			&& pFile->mtime == mtime
+			&& pFile->size == size)
+		{
+			return pFile;
+		}
 
-			delete pMapList->pArray;
-			pMapList->pArray = new CellArray(64);
+		CellArray *pArray = ReadMapFile(path);
+		if (pArray == NULL)
+		{
+			return NULL;
+		}
 
-			while (!bridge->filesystem->EndOfFile(fp) && bridge->filesystem->ReadLine(buffer, sizeof(buffer), fp) != NULL)
+		if (pFile == NULL)
+		{
+			pFile = new mapfile_cache_t;
+			pFile->pArray = NULL;
+			pFile->serial = 0;
+			m_FileCache.insert(path, pFile);
+		}
+
+		pFile->mtime = mtime;
+		pFile->size = size;
+
+		if (pFile->pArray != NULL && IsSameMapArray(pFile->pArray, pArray))
+		{
+			delete pArray;
+			return pFile;
+		}
+
+		delete pFile->pArray;
+		pFile->pArray = pArray;
+		pFile->serial = ++m_nSerialChange;
+
+		return pFile;
+	}
+	CellArray *ReadMapFile(const char *path)
+	{
+		FileHandle_t fp;
+		cell_t *blk;
+		char buffer[255];
+
+		if ((fp = bridge->filesystem->Open(path, "rt", "GAME")) == NULL)
+		{
+			return NULL;
+		}
+
+		CellArray *pArray = new CellArray(64);
+
+		while (!bridge->filesystem->EndOfFile(fp) && bridge->filesystem->ReadLine(buffer, sizeof(buffer), fp) != NULL)
+		{
+			size_t len = strlen(buffer);
+			char *ptr = UTIL_TrimWhitespace(buffer, len);
+			if (*ptr == '\0'
+				|| *ptr == ';'
+				|| strncmp(ptr, "//", 2) == 0)
 			{
-				size_t len = strlen(buffer);
-				char *ptr = UTIL_TrimWhitespace(buffer, len);
-				if (*ptr == '\0'
-					|| *ptr == ';'
-					|| strncmp(ptr, "//", 2) == 0)
-				{
-					continue;
-				}
-				
-				if (strcmp(bridge->GetSourceEngineName(), "insurgency") == 0
-					|| strcmp(bridge->GetSourceEngineName(), "doi") == 0)
+				continue;
+			}
+			
+			if (strcmp(bridge->GetSourceEngineName(), "insurgency") == 0
+				|| strcmp(bridge->GetSourceEngineName(), "doi") == 0)
+			{
+				// Insurgency and Day of Infamy (presumably?) doesn't allow spaces in map names
+				// and do use a space to delimit the map name from the map mode
+				int i = 0;
+				while (ptr[i] != 0)
 				{
-					// Insurgency and Day of Infamy (presumably?) doesn't allow spaces in map names
-					// and do use a space to delimit the map name from the map mode
-					int i = 0;
-					while (ptr[i] != 0)
+					if (ptr[i] == ' ')
 					{
-						if (ptr[i] == ' ')
-						{
-							ptr[i] = 0;
-							break;
-						}
-						++i;
+						ptr[i] = 0;
+						break;
 					}
+					++i;
 				}
+			}
 
-				if (!gamehelpers->IsMapValid(ptr))
-				{
-					continue;
-				}
+			if (!gamehelpers->IsMapValid(ptr))
+			{
+				continue;
+			}
 
-				if ((blk = pMapList->pArray->push()) != NULL)
-				{
-					strncopy((char *)blk, ptr, 255);
-				}
+			if ((blk = pArray->push()) != NULL)
+			{
+				strncopy((char *)blk, ptr, 255);
 			}
+		}
 
-			bridge->filesystem->Close(fp);
+		bridge->filesystem->Close(fp);
 
-			pMapList->last_modified_time = last_time;
-			pMapList->serial = ++m_nSerialChange;
+		return pArray;
+	}
+	CellArray *GetMapsFolder(int *pSerial)
+	{
+		if (!m_FolderScanned)
+		{
+			RescanMapsFolder();
 		}
+		else if (!m_FolderRefreshQueued && time(NULL) - m_FolderChecked >= MAPLIST_FOLDER_RECHECK)
+		{
+			/* Serve what we have and rescan on a later frame if anything moved. */
+			m_FolderChecked = time(NULL);
+			if (GetMapsFolderStamp() != m_FolderStamp)
+			{
+				m_FolderRefreshQueued = true;
+				g_FrameScheduler.AddTask(g_pCoreIdent, FrameTask_Low, RefreshMapsFolder, this);
+			}
+		}
+
+		*pSerial = m_FolderSerial;
+		return m_pFolderArray;
+	}
+	static void RefreshMapsFolder(void *data)
+	{
+		MapLists *pLists = (MapLists *)data;
+		pLists->m_FolderRefreshQueued = false;
+		pLists->RescanMapsFolder();
+	}
+	uint64_t GetMapsFolderStamp()
+	{
+		/* Combined modification times of every maps folder on the GAME search path */
+		char paths[4096];
+		bridge->filesystem->GetSearchPath("GAME", false, paths, sizeof(paths));
 
-		if (pMapList->pArray == NULL || pMapList->pArray->size() == 0)
+		uint64_t stamp = 0;
+		char *dir = paths;
+		while (dir != NULL && *dir != '\0')
 		{
-			return false;
+			char *next = strchr(dir, ';');
+			if (next != NULL)
+			{
+				*next++ = '\0';
+			}
+
+			char maps[PLATFORM_MAX_PATH];
+			time_t mtime;
+			ke::SafeSprintf(maps, sizeof(maps), "%smaps", dir);
+			if (libsys->FileTime(maps, FileTime_LastChange, &mtime))
+			{
+				stamp = stamp * 31 + (uint64_t)mtime;
+			}
+
+			dir = next;
 		}
 
-		*pSerial = pMapList->serial;
-		*ppArray = pMapList->pArray;
+		return stamp;
+	}
+	void RescanMapsFolder()
+	{
+		m_FolderScanned = true;
+		m_FolderChecked = time(NULL);
+		m_FolderStamp = GetMapsFolderStamp();
 
-		return true;
+		CellArray *pArray = new CellArray(64);
+		cell_t *blk;
+
+		FileFindHandle_t findHandle;
+		const char *fileName = bridge->filesystem->FindFirstEx("maps/*.bsp", "GAME", &findHandle);
+
+		while (fileName)
+		{
+			char buffer[PLATFORM_MAX_PATH];
+
+			UTIL_StripExtension(fileName, buffer, sizeof(buffer));
+
+			if (!gamehelpers->IsMapValid(buffer))
+			{
+				fileName = bridge->filesystem->FindNext(findHandle);
+				continue;
+			}
+
+			if ((blk = pArray->push()) == NULL)
+			{
+				fileName = bridge->filesystem->FindNext(findHandle);
+				continue;
+			}
+
+			strncopy((char *)blk, buffer, 255);
+
+			fileName = bridge->filesystem->FindNext(findHandle);
+		}
+
+		bridge->filesystem->FindClose(findHandle);
+
+		/* Remove the array if there were no items. */
+		if (pArray->size() == 0)
+		{
+			delete pArray;
+			pArray = NULL;
+		}
+		else
+		{
+			qsort(pArray->base(), 
+				pArray->size(), 
+				pArray->blocksize() * sizeof(cell_t), 
+				sort_maps_in_adt_array);
+		}
+
+		if (IsSameMapArray(m_pFolderArray, pArray))
+		{
+			delete pArray;
+			return;
+		}
+
+		delete m_pFolderArray;
+		m_pFolderArray = pArray;
+		m_FolderSerial = ++m_nSerialChange;
+	}
+	void DumpFileCache()
+	{
+		for (StringHashMap<mapfile_cache_t *>::iterator iter = m_FileCache.iter(); !iter.empty(); iter.next())
+		{
+			delete iter->value->pArray;
+			delete iter->value;
+		}
+		m_FileCache.clear();
+
+		delete m_pFolderArray;
+		m_pFolderArray = NULL;
+		m_FolderScanned = false;
 	}
 	void DumpCache(List<maplist_info_t *> *compat_list)
 	{
@@ -679,7 +829,6 @@ private:
 			}
 			else
 			{
-				delete (*iter)->pArray;
 				delete (*iter);
 			}
 			iter = m_MapLists.erase(iter);
@@ -695,6 +844,13 @@ private:
 	unsigned int m_IgnoreLevel;
 	maplist_info_t *m_pCurMapList;
 	int m_nSerialChange;
+	StringHashMap<mapfile_cache_t *> m_FileCache;
+	CellArray *m_pFolderArray;
+	int m_FolderSerial;
+	bool m_FolderScanned;
+	bool m_FolderRefreshQueued;
+	uint64_t m_FolderStamp;
+	time_t m_FolderChecked;
 } s_MapLists;
 
 static cell_t LoadMapList(IPluginContext *pContext, const cell_t *params)
@@ -721,6 +877,10 @@ static cell_t LoadMapList(IPluginContext *pContext, const cell_t *params)
 		{
 			return pContext->ThrowNativeError("Invalid Handle %x (error %d)", hndl, err);
 		}
+		if (static_cast<CellArray *>(pArray)->frozen())
+		{
+			return pContext->ThrowNativeError("ArrayList %x is frozen and cannot be modified", hndl);
+		}
 	}
 
 	/* Make sure the map list cache is up to date at the root */
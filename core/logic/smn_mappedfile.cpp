@@ -0,0 +1,348 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include <ctype.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <IHandleSys.h>
+#include <ISourceMod.h>
+#include "common_logic.h"
+#include "MappedFile.h"
+
+/* Read-only, memory mapped files for large static datasets.  The data stays 
+ * in the page cache instead of being copied line by line into plugin 
+ * strings, and an index of line starts is built on first use so plugins can 
+ * jump to a line or binary search a sorted file.
+ */
+
+HandleType_t g_MappedFileType = 0;
+
+struct MappedFileObject
+{
+	MappedFile map;
+	bool indexed = false;
+	std::vector<uint32_t> lines;		/* Offset of the first byte of each line */
+
+	void BuildLineIndex()
+	{
+		if (indexed)
+			return;
+
+		indexed = true;
+		if (!map.length)
+			return;
+
+		lines.push_back(0);
+
+		const char *base = map.base;
+		const char *end = base + map.length;
+		const char *nl;
+		for (const char *p = base; (nl = (const char *)memchr(p, '\n', end - p)) != NULL; p = nl + 1)
+		{
+			if (nl + 1 < end)
+				lines.push_back((uint32_t)(nl + 1 - base));
+		}
+	}
+
+	/* Returns the line's text without its line terminator. */
+	const char *GetLine(size_t line, size_t *len)
+	{
+		size_t start = lines[line];
+		size_t stop = (line + 1 < lines.size()) ? lines[line + 1] : map.length;
+		while (stop > start && (map.base[stop - 1] == '\n' || map.base[stop - 1] == '\r'))
+			stop--;
+		*len = stop - start;
+		return map.base + start;
+	}
+};
+
+class MappedFileNatives :
+	public SMGlobalClass,
+	public IHandleTypeDispatch
+{
+public: // SMGlobalClass
+	void OnSourceModAllInitialized() override
+	{
+		g_MappedFileType = handlesys->CreateType("MappedFile", this, 0, NULL, NULL, g_pCoreIdent, NULL);
+	}
+	void OnSourceModShutdown() override
+	{
+		handlesys->RemoveType(g_MappedFileType, g_pCoreIdent);
+		g_MappedFileType = 0;
+	}
+public: // IHandleTypeDispatch
+	void OnHandleDestroy(HandleType_t type, void *object) override
+	{
+		delete (MappedFileObject *)object;
+	}
+	bool GetHandleApproxSize(HandleType_t type, void *object, unsigned int *pSize) override
+	{
+		/* The mapping itself is shared page cache; only count the index. */
+		MappedFileObject *file = (MappedFileObject *)object;
+		*pSize = sizeof(MappedFileObject) + (unsigned int)(file->lines.capacity() * sizeof(uint32_t));
+		return true;
+	}
+} s_MappedFileNatives;
+
+static MappedFileObject *ReadMappedFile(IPluginContext *pContext, cell_t hndl)
+{
+	MappedFileObject *file;
+	HandleError herr;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((herr = handlesys->ReadHandle(hndl, g_MappedFileType, &sec, (void **)&file)) != HandleError_None)
+	{
+		pContext->ReportError("Invalid MappedFile handle %x (error %d)", hndl, herr);
+		return NULL;
+	}
+	return file;
+}
+
+static cell_t MappedFile_Open(IPluginContext *pContext, const cell_t *params)
+{
+	char *path;
+	pContext->LocalToString(params[1], &path);
+
+	char realpath[PLATFORM_MAX_PATH];
+	g_pSM->BuildPath(Path_Game, realpath, sizeof(realpath), "%s", path);
+
+	MappedFileObject *file = new MappedFileObject;
+	if (!file->map.Open(realpath, false))
+	{
+		delete file;
+		return BAD_HANDLE;
+	}
+
+	Handle_t hndl = handlesys->CreateHandle(g_MappedFileType, file, pContext->GetIdentity(), g_pCoreIdent, NULL);
+	if (hndl == BAD_HANDLE)
+		delete file;
+
+	return hndl;
+}
+
+static cell_t MappedFile_Length(IPluginContext *pContext, const cell_t *params)
+{
+	MappedFileObject *file = ReadMappedFile(pContext, params[1]);
+	if (!file)
+		return 0;
+
+	return (cell_t)file->map.length;
+}
+
+static cell_t MappedFile_Read(IPluginContext *pContext, const cell_t *params)
+{
+	MappedFileObject *file = ReadMappedFile(pContext, params[1]);
+	if (!file)
+		return 0;
+
+	cell_t offset = params[2];
+	cell_t num_items = params[4];
+	cell_t size = params[5];
+	if (size != 1 && size != 2 && size != 4)
+		return pContext->ThrowNativeError("Invalid size specifier (%d is not 1, 2, or 4)", size);
+	if (offset < 0 || (size_t)offset > file->map.length)
+		return pContext->ThrowNativeError("Offset %d is out of bounds (length %d)", offset, (int)file->map.length);
+	if (num_items < 0)
+		return pContext->ThrowNativeError("Invalid item count %d", num_items);
+
+	size_t avail = (file->map.length - offset) / size;
+	if ((size_t)num_items > avail)
+		num_items = (cell_t)avail;
+
+	cell_t *items;
+	pContext->LocalToPhysAddr(params[3], &items);
+
+	const unsigned char *src = (const unsigned char *)file->map.base + offset;
+	for (cell_t i = 0; i < num_items; i++, src += size)
+	{
+		switch (size)
+		{
+			case 4:
+				memcpy(&items[i], src, sizeof(cell_t));
+				break;
+			case 2:
+			{
+				uint16_t val;
+				memcpy(&val, src, sizeof(val));
+				items[i] = val;
+				break;
+			}
+			case 1:
+				items[i] = *src;
+				break;
+		}
+	}
+
+	return num_items;
+}
+
+static cell_t MappedFile_ReadString(IPluginContext *pContext, const cell_t *params)
+{
+	MappedFileObject *file = ReadMappedFile(pContext, params[1]);
+	if (!file)
+		return 0;
+
+	cell_t offset = params[2];
+	if (offset < 0 || (size_t)offset > file->map.length)
+		return pContext->ThrowNativeError("Offset %d is out of bounds (length %d)", offset, (int)file->map.length);
+	if (params[4] <= 0)
+		return pContext->ThrowNativeError("Invalid buffer size %d", params[4]);
+
+	size_t len = file->map.length - offset;
+	if (len > (size_t)params[4] - 1)
+		len = (size_t)params[4] - 1;
+
+	const char *src = file->map.base + offset;
+	const char *nul = len ? (const char *)memchr(src, '\0', len) : NULL;
+	if (nul)
+		len = nul - src;
+
+	char *dest;
+	pContext->LocalToString(params[3], &dest);
+	memcpy(dest, src, len);
+	dest[len] = '\0';
+
+	return (cell_t)len;
+}
+
+static cell_t MappedFile_LineCount(IPluginContext *pContext, const cell_t *params)
+{
+	MappedFileObject *file = ReadMappedFile(pContext, params[1]);
+	if (!file)
+		return 0;
+
+	file->BuildLineIndex();
+	return (cell_t)file->lines.size();
+}
+
+static cell_t MappedFile_GetLineOffset(IPluginContext *pContext, const cell_t *params)
+{
+	MappedFileObject *file = ReadMappedFile(pContext, params[1]);
+	if (!file)
+		return 0;
+
+	file->BuildLineIndex();
+	if (params[2] < 0 || (size_t)params[2] >= file->lines.size())
+		return -1;
+
+	return (cell_t)file->lines[params[2]];
+}
+
+static cell_t MappedFile_ReadLine(IPluginContext *pContext, const cell_t *params)
+{
+	MappedFileObject *file = ReadMappedFile(pContext, params[1]);
+	if (!file)
+		return 0;
+
+	file->BuildLineIndex();
+	if (params[2] < 0 || (size_t)params[2] >= file->lines.size())
+		return -1;
+
+	size_t len;
+	const char *line = file->GetLine(params[2], &len);
+
+	if (params[4] <= 0)
+		return pContext->ThrowNativeError("Invalid buffer size %d", params[4]);
+	if (len > (size_t)params[4] - 1)
+		len = (size_t)params[4] - 1;
+
+	char *dest;
+	pContext->LocalToString(params[3], &dest);
+	memcpy(dest, line, len);
+	dest[len] = '\0';
+
+	return (cell_t)len;
+}
+
+static int CompareLine(const char *line, size_t len, const char *key, size_t keylen, bool caseSensitive)
+{
+	size_t n = (len < keylen) ? len : keylen;
+	for (size_t i = 0; i < n; i++)
+	{
+		int a = (unsigned char)line[i];
+		int b = (unsigned char)key[i];
+		if (!caseSensitive)
+		{
+			a = tolower(a);
+			b = tolower(b);
+		}
+		if (a != b)
+			return a - b;
+	}
+	return (len < keylen) ? -1 : (len > keylen) ? 1 : 0;
+}
+
+static cell_t MappedFile_FindSortedLine(IPluginContext *pContext, const cell_t *params)
+{
+	MappedFileObject *file = ReadMappedFile(pContext, params[1]);
+	if (!file)
+		return 0;
+
+	char *key;
+	pContext->LocalToString(params[2], &key);
+	size_t keylen = strlen(key);
+	bool caseSensitive = !!params[3];
+
+	file->BuildLineIndex();
+
+	size_t lo = 0, hi = file->lines.size();
+	while (lo < hi)
+	{
+		size_t mid = lo + (hi - lo) / 2;
+		size_t len;
+		const char *line = file->GetLine(mid, &len);
+
+		int cmp = CompareLine(line, len, key, keylen, caseSensitive);
+		if (cmp == 0)
+			return (cell_t)mid;
+		if (cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return -1;
+}
+
+REGISTER_NATIVES(mappedfilenatives)
+{
+	{"MappedFile.MappedFile",		MappedFile_Open},
+	{"MappedFile.Length.get",		MappedFile_Length},
+	{"MappedFile.Read",				MappedFile_Read},
+	{"MappedFile.ReadString",		MappedFile_ReadString},
+	{"MappedFile.LineCount.get",	MappedFile_LineCount},
+	{"MappedFile.GetLineOffset",	MappedFile_GetLineOffset},
+	{"MappedFile.ReadLine",			MappedFile_ReadLine},
+	{"MappedFile.FindSortedLine",	MappedFile_FindSortedLine},
+
+	{NULL,							NULL},
+};
@@ -63,6 +63,7 @@ enum MenuAction
 	MenuAction_VoteCancel = (1<<7),	/**< (VOTE ONLY): A vote sequence has been cancelled (nothing passed) */
 	MenuAction_DrawItem = (1<<8),	/**< A style is being drawn; return the new style (param1=client, param2=item) */
 	MenuAction_DisplayItem = (1<<9),	/**< the odd duck */
+	MenuAction_VoteProgress = (1<<10),	/**< (VOTE ONLY): Live tally (param1=votes, param2=clients) */
 };
 
 static HandleError ReadMenuHandle(Handle_t handle, IBaseMenu **menu)
@@ -138,9 +139,11 @@ public:
 	void OnMenuVoteStart(IBaseMenu *menu);
 	void OnMenuVoteResults(IBaseMenu *menu, const menu_vote_result_t *results);
 	void OnMenuVoteCancel(IBaseMenu *menu, VoteCancelReason reason);
+	void OnMenuVoteProgress(IBaseMenu *menu, const menu_vote_result_t *results);
 	void OnMenuDrawItem(IBaseMenu *menu, int client, unsigned int item, unsigned int &style);
 	unsigned int OnMenuDisplayItem(IBaseMenu *menu, int client, IMenuPanel *panel, unsigned int item, const ItemDrawInfo &dr);
 	bool OnSetHandlerOption(const char *option, const void *data);
+	bool IsMenuDrawnPerClient(IBaseMenu *menu);
 private:
 	cell_t DoAction(IBaseMenu *menu, MenuAction action, cell_t param1, cell_t param2, cell_t def_res=0);
 private:
@@ -321,6 +324,7 @@ static IMenuPanel *s_pCurPanel = NULL;
 static unsigned int s_CurPanelReturn = 0;
 static const ItemDrawInfo *s_CurDrawInfo = NULL;
 static unsigned int *s_CurSelectPosition = NULL;
+static const menu_vote_result_t *s_CurVoteProgress = NULL;
 
 /**
  * MENU HANDLER WRAPPER
@@ -401,6 +405,21 @@ void CMenuHandler::OnMenuVoteCancel(IBaseMenu *menu, VoteCancelReason reason)
 	DoAction(menu, MenuAction_VoteCancel, reason, 0);
 }
 
+void CMenuHandler::OnMenuVoteProgress(IBaseMenu *menu, const menu_vote_result_t *results)
+{
+	if ((m_Flags & (int)MenuAction_VoteProgress) != (int)MenuAction_VoteProgress)
+	{
+		return;
+	}
+
+	const menu_vote_result_t *old_progress = s_CurVoteProgress;
+	s_CurVoteProgress = results;
+
+	DoAction(menu, MenuAction_VoteProgress, results->num_votes, results->num_clients);
+
+	s_CurVoteProgress = old_progress;
+}
+
 void CMenuHandler::OnMenuDrawItem(IBaseMenu *menu, int client, unsigned int item, unsigned int &style)
 {
 	if ((m_Flags & (int)MenuAction_DrawItem) == (int)MenuAction_DrawItem)
@@ -539,6 +558,12 @@ void CMenuHandler::OnMenuVoteResults(IBaseMenu *menu, const menu_vote_result_t *
 	m_pVoteResults->Execute(NULL);
 }
 
+bool CMenuHandler::IsMenuDrawnPerClient(IBaseMenu *menu)
+{
+	const int draw_actions = MenuAction_Display|MenuAction_DrawItem|MenuAction_DisplayItem;
+	return (m_Flags & draw_actions) != 0;
+}
+
 bool CMenuHandler::OnSetHandlerOption(const char *option, const void *data)
 {
 	if (strcmp(option, "set_vote_results_handler") == 0)
@@ -1480,6 +1505,36 @@ static cell_t GetMenuSelectionPosition(IPluginContext *pContext, const cell_t *p
 	return *s_CurSelectPosition;
 }
 
+static cell_t GetMenuVoteProgress(IPluginContext *pContext, const cell_t *params)
+{
+	if (!s_CurVoteProgress)
+	{
+		return pContext->ThrowNativeError("Can only be called from inside a MenuAction_VoteProgress callback");
+	}
+
+	cell_t *items, *votes;
+	pContext->LocalToPhysAddr(params[1], &items);
+	pContext->LocalToPhysAddr(params[2], &votes);
+
+	unsigned int count = s_CurVoteProgress->num_items;
+	if (params[3] < 0)
+	{
+		count = 0;
+	}
+	else if (count > (unsigned int)params[3])
+	{
+		count = (unsigned int)params[3];
+	}
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		items[i] = s_CurVoteProgress->item_list[i].item;
+		votes[i] = s_CurVoteProgress->item_list[i].count;
+	}
+
+	return count;
+}
+
 static cell_t IsClientInVotePool(IPluginContext *pContext, const cell_t *params)
 {
 	int client;
@@ -1620,6 +1675,7 @@ REGISTER_NATIVES(menuNatives)
 	{"GetMenuOptionFlags",		GetMenuOptionFlags},
 	{"GetMenuPagination",		GetMenuPagination},
 	{"GetMenuSelectionPosition",GetMenuSelectionPosition},
+	{"GetMenuVoteProgress",		GetMenuVoteProgress},
 	{"GetMenuStyle",			GetMenuStyle},
 	{"GetMenuStyleHandle",		GetMenuStyleHandle},
 	{"GetMenuTitle",			GetMenuTitle},
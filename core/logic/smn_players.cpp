@@ -304,29 +304,29 @@ static cell_t sm_GetClientName(IPluginContext *pCtx, const cell_t *params)
 				return pCtx->ThrowNativeError("Could not find \"hostname\" cvar");
 			}
 		}
-		pCtx->StringToLocalUTF8(params[2], static_cast<size_t>(params[3]), bridge->GetCvarString(hostname), NULL);
+		pCtx->StringToLocalUTF8(params[2], static_cast<size_t>(params[3]), bridge->FastGetCvarString(hostname), NULL);
 		return 1;
 	}
 
-	if ((index < 1) || (index > playerhelpers->GetMaxClients()))
+	if ((index < 1) || (index > *bridge->maxClients))
 	{
 		return pCtx->ThrowNativeError("Client index %d is invalid", index);
 	}
 
-	IGamePlayer *pPlayer = playerhelpers->GetGamePlayer(index);
-	if (!pPlayer->IsConnected())
+	const char *name = bridge->FastGetClientName(index);
+	if (!name)
 	{
 		return pCtx->ThrowNativeError("Client %d is not connected", index);
 	}
 
-	pCtx->StringToLocalUTF8(params[2], static_cast<size_t>(params[3]), pPlayer->GetName(), NULL);
+	pCtx->StringToLocalUTF8(params[2], static_cast<size_t>(params[3]), name, NULL);
 	return 1;
 }
 
 static cell_t sm_GetClientIP(IPluginContext *pCtx, const cell_t *params)
 {
 	int index = params[1];
-	if ((index < 1) || (index > playerhelpers->GetMaxClients()))
+	if ((index < 1) || (index > *bridge->maxClients))
 	{
 		return pCtx->ThrowNativeError("Client index %d is invalid", index);
 	}
@@ -353,7 +353,7 @@ static cell_t SteamIdToLocal(IPluginContext *pCtx, int index, AuthIdType authTyp
 {
 	pCtx->StringToLocal(local_addr, bytes, "STEAM_ID_STOP_IGNORING_RETVALS");
 
-	if ((index < 1) || (index > playerhelpers->GetMaxClients()))
+	if ((index < 1) || (index > *bridge->maxClients))
 	{
 		return pCtx->ThrowNativeError("Client index %d is invalid", index);
 	}
@@ -397,23 +397,18 @@ static cell_t SteamIdToLocal(IPluginContext *pCtx, int index, AuthIdType authTyp
 		break;
 	
 	case AuthIdType::SteamId64:
+		if (pPlayer->IsFakeClient() || gamehelpers->IsLANServer())
 		{
-			if (pPlayer->IsFakeClient() || gamehelpers->IsLANServer())
-			{
-				return 0;
-			}
-			
-			uint64_t steamId = pPlayer->GetSteamId64(validate);
-			if (steamId == 0)
-			{
-				return 0;
-			}
-			
-			char szAuth[64];
-			ke::SafeSprintf(szAuth, sizeof(szAuth), "%" PRIu64, steamId);
-			
-			pCtx->StringToLocal(local_addr, bytes, szAuth);
+			return 0;
 		}
+
+		authstr = pPlayer->GetSteamId64String(validate);
+		if (!authstr || authstr[0] == '\0')
+		{
+			return 0;
+		}
+
+		pCtx->StringToLocal(local_addr, bytes, authstr);
 		break;
 	}	
 
@@ -439,7 +434,7 @@ static cell_t sm_GetClientAuthId(IPluginContext *pCtx, const cell_t *params)
 static cell_t sm_GetSteamAccountID(IPluginContext *pCtx, const cell_t *params)
 {
 	int index = params[1];
-	if ((index < 1) || (index > playerhelpers->GetMaxClients()))
+	if ((index < 1) || (index > *bridge->maxClients))
 	{
 		return pCtx->ThrowNativeError("Client index %d is invalid", index);
 	}
@@ -456,18 +451,18 @@ static cell_t sm_GetSteamAccountID(IPluginContext *pCtx, const cell_t *params)
 static cell_t sm_IsClientConnected(IPluginContext *pCtx, const cell_t *params)
 {
 	int index = params[1];
-	if ((index < 1) || (index > playerhelpers->GetMaxClients()))
+	if ((index < 1) || (index > *bridge->maxClients))
 	{
 		return pCtx->ThrowNativeError("Client index %d is invalid", index);
 	}
 
-	return (playerhelpers->GetGamePlayer(index)->IsConnected()) ? 1 : 0;
+	return (playerhelpers->GetClientStateFlags(index) & ClientState_Connected) ? 1 : 0;
 }
 
 static cell_t sm_IsClientInGame(IPluginContext *pCtx, const cell_t *params)
 {
 	int index = params[1];
-	if ((index < 1) || (index > playerhelpers->GetMaxClients()))
+	if ((index < 1) || (index > *bridge->maxClients))
 	{
 		return pCtx->ThrowNativeError("Client index %d is invalid", index);
 	}
@@ -478,63 +473,85 @@ static cell_t sm_IsClientInGame(IPluginContext *pCtx, const cell_t *params)
 static cell_t sm_IsClientAuthorized(IPluginContext *pCtx, const cell_t *params)
 {
 	int index = params[1];
-	if ((index < 1) || (index > playerhelpers->GetMaxClients()))
+	if ((index < 1) || (index > *bridge->maxClients))
 	{
 		return pCtx->ThrowNativeError("Client index %d is invalid", index);
 	}
 
-	return (playerhelpers->GetGamePlayer(index)->IsAuthorized()) ? 1 : 0;
+	return (playerhelpers->GetClientStateFlags(index) & ClientState_Authorized) ? 1 : 0;
 }
 
 static cell_t sm_IsClientFakeClient(IPluginContext *pCtx, const cell_t *params)
 {
 	int index = params[1];
-	if ((index < 1) || (index > playerhelpers->GetMaxClients()))
+	if ((index < 1) || (index > *bridge->maxClients))
 	{
 		return pCtx->ThrowNativeError("Client index %d is invalid", index);
 	}
 
-	IGamePlayer *pPlayer = playerhelpers->GetGamePlayer(index);
-	if (!pPlayer->IsConnected())
+	unsigned int state = playerhelpers->GetClientStateFlags(index);
+	if (!(state & ClientState_Connected))
 	{
 		return pCtx->ThrowNativeError("Client %d is not connected", index);
 	}
 
-	return (pPlayer->IsFakeClient()) ? 1 : 0;
+	return (state & ClientState_FakeClient) ? 1 : 0;
 }
 
 static cell_t sm_IsClientSourceTV(IPluginContext *pCtx, const cell_t *params)
 {
 	int index = params[1];
-	if ((index < 1) || (index > playerhelpers->GetMaxClients()))
+	if ((index < 1) || (index > *bridge->maxClients))
 	{
 		return pCtx->ThrowNativeError("Client index %d is invalid", index);
 	}
 
-	IGamePlayer *pPlayer = playerhelpers->GetGamePlayer(index);
-	if (!pPlayer->IsConnected())
+	unsigned int state = playerhelpers->GetClientStateFlags(index);
+	if (!(state & ClientState_Connected))
 	{
 		return pCtx->ThrowNativeError("Client %d is not connected", index);
 	}
 
-	return (pPlayer->IsSourceTV()) ? 1 : 0;
+	return (state & ClientState_SourceTV) ? 1 : 0;
 }
 
 static cell_t sm_IsClientReplay(IPluginContext *pCtx, const cell_t *params)
 {
 	int index = params[1];
-	if ((index < 1) || (index > playerhelpers->GetMaxClients()))
+	if ((index < 1) || (index > *bridge->maxClients))
 	{
 		return pCtx->ThrowNativeError("Client index %d is invalid", index);
 	}
 
-	IGamePlayer *pPlayer = playerhelpers->GetGamePlayer(index);
-	if (!pPlayer->IsConnected())
+	unsigned int state = playerhelpers->GetClientStateFlags(index);
+	if (!(state & ClientState_Connected))
 	{
 		return pCtx->ThrowNativeError("Client %d is not connected", index);
 	}
 
-	return (pPlayer->IsReplay()) ? 1 : 0;
+	return (state & ClientState_Replay) ? 1 : 0;
+}
+
+static cell_t sm_GetClientsMatching(IPluginContext *pCtx, const cell_t *params)
+{
+	cell_t *clients;
+	pCtx->LocalToPhysAddr(params[2], &clients);
+
+	int maxlen = params[3];
+	if (maxlen <= 0)
+	{
+		return 0;
+	}
+
+	int found[SM_MAXPLAYERS];
+	int count = playerhelpers->GetClientsMatching(params[1], params[4], params[5], found,
+		maxlen < SM_MAXPLAYERS ? maxlen : SM_MAXPLAYERS);
+	for (int i = 0; i < count; i++)
+	{
+		clients[i] = found[i];
+	}
+
+	return count;
 }
 
 static cell_t sm_GetClientInfo(IPluginContext *pContext, const cell_t *params)
@@ -553,7 +570,7 @@ static cell_t sm_GetClientInfo(IPluginContext *pContext, const cell_t *params)
 	char *key;
 	pContext->LocalToString(params[2], &key);
 
-	const char *val = engine->GetClientConVarValue(client, key);
+	const char *val = bridge->FastGetClientConVarValue(client, key);
 	if (!val)
 	{
 		return false;
@@ -1065,6 +1082,21 @@ static cell_t GetClientOfUserId(IPluginContext *pContext, const cell_t *params)
 	return playerhelpers->GetClientOfUserId(params[1]);
 }
 
+static cell_t GetClientOfSteamId64(IPluginContext *pContext, const cell_t *params)
+{
+	char *str;
+	pContext->LocalToString(params[1], &str);
+
+	char *end;
+	uint64_t steamId = strtoull(str, &end, 10);
+	if (steamId == 0 || end == str || *end != '\0')
+	{
+		return 0;
+	}
+
+	return playerhelpers->GetClientOfSteamId64(steamId, params[2] != 0);
+}
+
 static cell_t _ShowActivity(IPluginContext *pContext,
 	const cell_t *params,
 	const char *tag,
@@ -1621,6 +1653,7 @@ REGISTER_NATIVES(playernatives)
 	{ "GetClientAuthId", sm_GetClientAuthId },
 	{ "GetSteamAccountID", sm_GetSteamAccountID },
 	{ "GetClientCount", sm_GetClientCount },
+	{ "GetClientsMatching", sm_GetClientsMatching },
 	{ "GetClientInfo", sm_GetClientInfo },
 	{ "GetClientIP", sm_GetClientIP },
 	{ "GetClientName", sm_GetClientName },
@@ -1650,6 +1683,7 @@ REGISTER_NATIVES(playernatives)
 	{ "GetClientModel", GetModelName },
 	{ "GetClientHealth", GetHealth },
 	{ "GetClientOfUserId", GetClientOfUserId },
+	{ "GetClientOfSteamId64", GetClientOfSteamId64 },
 	{ "ShowActivity", ShowActivity },
 	{ "ShowActivityEx", ShowActivityEx },
 	{ "ShowActivity2", ShowActivity2 },
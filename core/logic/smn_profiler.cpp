@@ -37,7 +37,11 @@
 #include <sys/time.h>
 #endif
 #include "ProfileTools.h"
+#include "LatencyHistogram.h"
+#include <limits.h>
 #include <string.h>
+#include <algorithm>
+#include <memory>
 
 struct Profiler
 {
@@ -46,6 +50,20 @@ struct Profiler
 		started = false;
 		stopped = false;
 	}
+
+	/* Length of the last start/stop cycle. */
+	double Elapsed() const
+	{
+#if defined PLATFORM_WINDOWS
+		LONGLONG diff = end.QuadPart - start.QuadPart;
+		return diff * freq;
+#else
+		int64_t start_us = int64_t(start.tv_sec) * 1000000 + start.tv_usec;
+		int64_t stop_us = int64_t(end.tv_sec) * 1000000 + end.tv_usec;
+		return double(stop_us - start_us) / 1000000.0;
+#endif
+	}
+
 #if defined PLATFORM_WINDOWS
 	LARGE_INTEGER start;
 	LARGE_INTEGER end;
@@ -56,6 +74,8 @@ struct Profiler
 #endif
 	bool started;
 	bool stopped;
+	/* Every completed cycle, allocated on the first Stop(). */
+	std::unique_ptr<LatencyHistogram> samples;
 };
 
 HandleType_t g_ProfilerType = 0;
@@ -151,6 +171,92 @@ static cell_t StopProfiling(IPluginContext *pContext, const cell_t *params)
 	prof->started = false;
 	prof->stopped = true;
 
+	if (!prof->samples)
+		prof->samples.reset(new LatencyHistogram());
+	prof->samples->Record(uint64_t(std::max(prof->Elapsed(), 0.0) * 1e9));
+
+	return 1;
+}
+
+static Profiler *ReadProfiler(IPluginContext *pContext, Handle_t hndl)
+{
+	HandleSecurity sec = HandleSecurity(pContext->GetIdentity(), g_pCoreIdent);
+	HandleError err;
+	Profiler *prof;
+
+	if ((err = handlesys->ReadHandle(hndl, g_ProfilerType, &sec, (void **)&prof))
+		!= HandleError_None)
+	{
+		pContext->ReportError("Invalid Handle %x (error %d)", hndl, err);
+		return NULL;
+	}
+
+	return prof;
+}
+
+static cell_t Profiler_SamplesGet(IPluginContext *pContext, const cell_t *params)
+{
+	Profiler *prof = ReadProfiler(pContext, params[1]);
+	if (!prof)
+		return 0;
+
+	if (!prof->samples)
+		return 0;
+	return (cell_t)std::min(prof->samples->Count(), uint64_t(INT_MAX));
+}
+
+static cell_t Profiler_MinTimeGet(IPluginContext *pContext, const cell_t *params)
+{
+	Profiler *prof = ReadProfiler(pContext, params[1]);
+	if (!prof)
+		return 0;
+
+	float fTime = prof->samples ? float(prof->samples->Min() / 1e9) : 0.0f;
+	return sp_ftoc(fTime);
+}
+
+static cell_t Profiler_MaxTimeGet(IPluginContext *pContext, const cell_t *params)
+{
+	Profiler *prof = ReadProfiler(pContext, params[1]);
+	if (!prof)
+		return 0;
+
+	float fTime = prof->samples ? float(prof->samples->Max() / 1e9) : 0.0f;
+	return sp_ftoc(fTime);
+}
+
+static cell_t Profiler_MeanTimeGet(IPluginContext *pContext, const cell_t *params)
+{
+	Profiler *prof = ReadProfiler(pContext, params[1]);
+	if (!prof)
+		return 0;
+
+	float fTime = prof->samples ? float(prof->samples->Mean() / 1e9) : 0.0f;
+	return sp_ftoc(fTime);
+}
+
+static cell_t Profiler_GetPercentile(IPluginContext *pContext, const cell_t *params)
+{
+	Profiler *prof = ReadProfiler(pContext, params[1]);
+	if (!prof)
+		return 0;
+
+	float pct = sp_ctof(params[2]);
+	if (pct < 0.0f || pct > 100.0f)
+		return pContext->ThrowNativeError("Percentile %f is out of range (0-100)", pct);
+
+	float fTime = prof->samples ? float(prof->samples->Percentile(pct / 100.0) / 1e9) : 0.0f;
+	return sp_ftoc(fTime);
+}
+
+static cell_t Profiler_ResetSamples(IPluginContext *pContext, const cell_t *params)
+{
+	Profiler *prof = ReadProfiler(pContext, params[1]);
+	if (!prof)
+		return 0;
+
+	if (prof->samples)
+		prof->samples->Reset();
 	return 1;
 }
 
@@ -172,17 +278,7 @@ static cell_t GetProfilerTime(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Profiler was never stopped");
 	}
 
-	float fTime;
-
-#if defined PLATFORM_WINDOWS
-	LONGLONG diff = prof->end.QuadPart - prof->start.QuadPart;
-	double seconds = diff * prof->freq;
-	fTime = (float)seconds;
-#else
-	int64_t start_us = int64_t(prof->start.tv_sec) * 1000000 + prof->start.tv_usec;
-	int64_t stop_us = int64_t(prof->end.tv_sec) * 1000000 + prof->end.tv_usec;
-	fTime = double(stop_us - start_us) / 1000000.0;
-#endif
+	float fTime = (float)prof->Elapsed();
 
 	return sp_ftoc(fTime);
 }
@@ -228,6 +324,12 @@ REGISTER_NATIVES(profilerNatives)
 	{"Profiler.Time.get",       GetProfilerTime},
 	{"Profiler.Start",          StartProfiling},
 	{"Profiler.Stop",           StopProfiling},
+	{"Profiler.Samples.get",    Profiler_SamplesGet},
+	{"Profiler.MinTime.get",    Profiler_MinTimeGet},
+	{"Profiler.MaxTime.get",    Profiler_MaxTimeGet},
+	{"Profiler.MeanTime.get",   Profiler_MeanTimeGet},
+	{"Profiler.GetPercentile",  Profiler_GetPercentile},
+	{"Profiler.ResetSamples",   Profiler_ResetSamples},
 	{NULL,						NULL},
 };
 
@@ -32,10 +32,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <algorithm>
+#include <memory>
 #include "common_logic.h"
 #include "CellArray.h"
 #include <IHandleSys.h>
-#include <amtl/am-raii.h>
 
 /***********************************
  *   About the double array hack   *
@@ -105,71 +106,178 @@ void sort_random(cell_t *array, cell_t size)
 	}
 }
 
-int sort_ints_asc(const void *int1, const void *int2)
+/* Arrays up to this many elements go through std::sort; below it the radix
+ * sort's histogram passes cost more than they save.
+ */
+#define SORT_RADIX_THRESHOLD	64
+
+/* Maps an integer cell onto an unsigned key with the same ordering. */
+static inline uint32_t sort_int_key(cell_t val)
 {
-	return (*(int *)int1) - (*(int *)int2);
+	return (uint32_t)val ^ 0x80000000u;
 }
 
-int sort_ints_desc(const void *int1, const void *int2)
+/* Maps a float cell onto an unsigned key with the same ordering. Positive
+ * values get the sign bit set, negative values are inverted so a larger
+ * magnitude sorts lower. NaNs end up past the infinities of their sign.
+ */
+static inline uint32_t sort_float_key(cell_t val)
 {
-	return (*(int *)int2) - (*(int *)int1);
+	uint32_t bits = (uint32_t)val;
+	return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
 }
 
-static cell_t sm_SortIntegers(IPluginContext *pContext, const cell_t *params)
+struct sort_cell_key
 {
-	cell_t *array;
-	cell_t array_size = params[2];
-	cell_t type = params[3];
+	sort_cell_key(bool floats, bool descending)
+		: floats(floats), flip(descending ? 0xFFFFFFFFu : 0)
+	{
+	}
+	inline uint32_t operator()(cell_t val) const
+	{
+		return (floats ? sort_float_key(val) : sort_int_key(val)) ^ flip;
+	}
+	bool floats;
+	uint32_t flip;
+};
 
-	pContext->LocalToPhysAddr(params[1], &array);
+struct sort_block_key
+{
+	uint32_t key;
+	uint32_t index;
+};
 
-	if (type == Sort_Ascending)
+/**
+ * Stable LSD radix sort on a 32-bit key, one byte per pass. Passes where
+ * every element falls into the same bucket are skipped, which is the
+ * common case for small-ranged scores. Returns whichever of data and
+ * scratch ends up holding the sorted elements.
+ */
+template <typename T, typename KeyFn>
+static T *radix_sort(T *data, T *scratch, size_t count, const KeyFn &key)
+{
+	size_t buckets[4][256];
+	memset(buckets, 0, sizeof(buckets));
+
+	for (size_t i = 0; i < count; i++)
 	{
-		qsort(array, array_size, sizeof(cell_t), sort_ints_asc);
+		uint32_t k = key(data[i]);
+		buckets[0][k & 0xFF]++;
+		buckets[1][(k >> 8) & 0xFF]++;
+		buckets[2][(k >> 16) & 0xFF]++;
+		buckets[3][k >> 24]++;
 	}
-	else if (type == Sort_Descending)
+
+	T *src = data;
+	T *dst = scratch;
+	for (unsigned int pass = 0; pass < 4; pass++)
 	{
-		qsort(array, array_size, sizeof(cell_t), sort_ints_desc);
+		size_t *bucket = buckets[pass];
+		unsigned int shift = pass * 8;
+
+		if (bucket[(key(src[0]) >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		size_t offs = 0;
+		for (unsigned int i = 0; i < 256; i++)
+		{
+			size_t num = bucket[i];
+			bucket[i] = offs;
+			offs += num;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			dst[bucket[(key(src[i]) >> shift) & 0xFF]++] = src[i];
+		}
+
+		std::swap(src, dst);
 	}
-	else
+
+	return src;
+}
+
+static void sort_cells(cell_t *array, size_t count, const sort_cell_key &key)
+{
+	if (count < 2)
 	{
-		sort_random(array, array_size);
+		return;
 	}
 
-	return 1;
+	/* Equal keys mean equal cells here, so stability does not matter. */
+	if (count <= SORT_RADIX_THRESHOLD)
+	{
+		std::sort(array, array + count, [&key](cell_t a, cell_t b) -> bool {
+			return key(a) < key(b);
+		});
+		return;
+	}
+
+	std::unique_ptr<cell_t[]> scratch(new cell_t[count]);
+	cell_t *sorted = radix_sort(array, scratch.get(), count, key);
+	if (sorted != array)
+	{
+		memcpy(array, sorted, count * sizeof(cell_t));
+	}
 }
 
-int sort_floats_asc(const void *float1, const void *float2)
+/* Rearranges fixed-size blocks into the order given by a sorted key list. */
+static void sort_permute_blocks(cell_t *array, size_t count, size_t blocksize, const sort_block_key *order)
 {
-	float r1 = *(float *)float1;
-	float r2 = *(float *)float2;
-	
-	if (r1 < r2)
+	size_t bytes = blocksize * sizeof(cell_t);
+	std::unique_ptr<cell_t[]> copy(new cell_t[count * blocksize]);
+
+	for (size_t i = 0; i < count; i++)
 	{
-		return -1;
-	} else if (r2 < r1) {
-		return 1;
-	} else {
-		return 0;
+		memcpy(&copy[i * blocksize], &array[order[i].index * blocksize], bytes);
 	}
+
+	memcpy(array, copy.get(), count * bytes);
 }
 
-int sort_floats_desc(const void *float1, const void *float2)
+/* Sorts blocks by the integer or float value in their first cell. Blocks
+ * with equal keys keep their relative order.
+ */
+static void sort_cell_blocks(cell_t *array, size_t count, size_t blocksize, const sort_cell_key &key)
 {
-	float r1 = *(float *)float1;
-	float r2 = *(float *)float2;
+	if (blocksize == 1)
+	{
+		sort_cells(array, count, key);
+		return;
+	}
 
-	if (r1 < r2)
+	if (count < 2)
 	{
-		return 1;
-	} else if (r2 < r1) {
-		return -1;
-	} else {
-		return 0;
+		return;
+	}
+
+	std::unique_ptr<sort_block_key[]> keys(new sort_block_key[count * 2]);
+	for (size_t i = 0; i < count; i++)
+	{
+		keys[i].key = key(array[i * blocksize]);
+		keys[i].index = (uint32_t)i;
+	}
+
+	sort_block_key *sorted = keys.get();
+	if (count <= SORT_RADIX_THRESHOLD)
+	{
+		std::sort(sorted, sorted + count, [](const sort_block_key &a, const sort_block_key &b) -> bool {
+			return a.key < b.key || (a.key == b.key && a.index < b.index);
+		});
+	}
+	else
+	{
+		sorted = radix_sort(sorted, sorted + count, count, [](const sort_block_key &elem) -> uint32_t {
+			return elem.key;
+		});
 	}
+
+	sort_permute_blocks(array, count, blocksize, sorted);
 }
 
-static cell_t sm_SortFloats(IPluginContext *pContext, const cell_t *params)
+static cell_t sm_SortIntegers(IPluginContext *pContext, const cell_t *params)
 {
 	cell_t *array;
 	cell_t array_size = params[2];
@@ -177,13 +285,9 @@ static cell_t sm_SortFloats(IPluginContext *pContext, const cell_t *params)
 
 	pContext->LocalToPhysAddr(params[1], &array);
 
-	if (type == Sort_Ascending)
+	if (type == Sort_Ascending || type == Sort_Descending)
 	{
-		qsort(array, array_size, sizeof(cell_t), sort_floats_asc);
-	}
-	else if (type == Sort_Descending)
-	{
-		qsort(array, array_size, sizeof(cell_t), sort_floats_desc);
+		sort_cells(array, array_size, sort_cell_key(false, type == Sort_Descending));
 	}
 	else
 	{
@@ -193,29 +297,24 @@ static cell_t sm_SortFloats(IPluginContext *pContext, const cell_t *params)
 	return 1;
 }
 
-static cell_t *g_CurStringArray = NULL;
-static cell_t *g_CurRebaseMap = NULL;
-
-int sort_strings_asc_legacy(const void *blk1, const void *blk2)
+static cell_t sm_SortFloats(IPluginContext *pContext, const cell_t *params)
 {
-	cell_t reloc1 = *(cell_t *)blk1;
-	cell_t reloc2 = *(cell_t *)blk2;
-	
-	char *str1 = ((char *)(&g_CurStringArray[reloc1]) + g_CurRebaseMap[reloc1]);
-	char *str2 = ((char *)(&g_CurStringArray[reloc2]) + g_CurRebaseMap[reloc2]);
-
-	return strcmp(str1, str2);
-}
+	cell_t *array;
+	cell_t array_size = params[2];
+	cell_t type = params[3];
 
-int sort_strings_desc_legacy(const void *blk1, const void *blk2)
-{
-	cell_t reloc1 = *(cell_t *)blk1;
-	cell_t reloc2 = *(cell_t *)blk2;
+	pContext->LocalToPhysAddr(params[1], &array);
 
-	char *str1 = ((char *)(&g_CurStringArray[reloc1]) + g_CurRebaseMap[reloc1]);
-	char *str2 = ((char *)(&g_CurStringArray[reloc2]) + g_CurRebaseMap[reloc2]);
+	if (type == Sort_Ascending || type == Sort_Descending)
+	{
+		sort_cells(array, array_size, sort_cell_key(true, type == Sort_Descending));
+	}
+	else
+	{
+		sort_random(array, array_size);
+	}
 
-	return strcmp(str2, str1);
+	return 1;
 }
 
 static cell_t sm_SortStrings_Legacy(IPluginContext *pContext, const cell_t *params)
@@ -235,22 +334,29 @@ static cell_t sm_SortStrings_Legacy(IPluginContext *pContext, const cell_t *para
 		return 0;
 	}
 
-	g_CurStringArray = array;
-	g_CurRebaseMap = phys_addr;
-
 	for (int i=0; i<array_size; i++)
 	{
 		phys_addr[i] = array[i];
 		array[i] = i;
 	}
 
+	/* The string behind an index only depends on its original slot and offset,
+	 * so it stays valid while the indices are shuffled around. */
+	auto get_string = [array, phys_addr](cell_t reloc) -> const char * {
+		return (const char *)(&array[reloc]) + phys_addr[reloc];
+	};
+
 	if (type == Sort_Ascending)
 	{
-		qsort(array, array_size, sizeof(cell_t), sort_strings_asc_legacy);
+		std::sort(array, array + array_size, [&get_string](cell_t a, cell_t b) -> bool {
+			return strcmp(get_string(a), get_string(b)) < 0;
+		});
 	}
 	else if (type == Sort_Descending)
 	{
-		qsort(array, array_size, sizeof(cell_t), sort_strings_desc_legacy);
+		std::sort(array, array + array_size, [&get_string](cell_t a, cell_t b) -> bool {
+			return strcmp(get_string(b), get_string(a)) < 0;
+		});
 	}
 	else
 	{
@@ -270,45 +376,14 @@ static cell_t sm_SortStrings_Legacy(IPluginContext *pContext, const cell_t *para
 
 	pContext->HeapPop(amx_addr);
 
-	g_CurStringArray = NULL;
-	g_CurRebaseMap = NULL;
-
 	return 1;
 }
 
-static IPluginContext* sSortContext = nullptr;
-
-int sort_strings_asc(const void *blk1, const void *blk2)
-{
-	cell_t str_addr1 = *(cell_t *)blk1;
-	cell_t str_addr2 = *(cell_t *)blk2;
-
-	char *str1;
-	char *str2;
-	if (sSortContext->LocalToString(str_addr1, &str1) != SP_ERROR_NONE ||
-		sSortContext->LocalToString(str_addr2, &str2) != SP_ERROR_NONE)
-	{
-		return 0;
-	}
-
-	return strcmp(str1, str2);
-}
-
-int sort_strings_desc(const void *blk1, const void *blk2)
+struct sort_string_ref
 {
-	cell_t str_addr1 = *(cell_t *)blk1;
-	cell_t str_addr2 = *(cell_t *)blk2;
-
-	char *str1;
-	char *str2;
-	if (sSortContext->LocalToString(str_addr1, &str1) != SP_ERROR_NONE ||
-		sSortContext->LocalToString(str_addr2, &str2) != SP_ERROR_NONE)
-	{
-		return 0;
-	}
-
-	return strcmp(str2, str1);
-}
+	const char *str;
+	cell_t addr;
+};
 
 static cell_t sm_SortStrings(IPluginContext *pContext, const cell_t *params)
 {
@@ -322,20 +397,48 @@ static cell_t sm_SortStrings(IPluginContext *pContext, const cell_t *params)
 
 	pContext->LocalToPhysAddr(params[1], &array);
 
-	ke::SaveAndSet<IPluginContext*> set_context(&sSortContext, pContext);
+	if (type != Sort_Ascending && type != Sort_Descending)
+	{
+		sort_random(array, array_size);
+		return 1;
+	}
 
-	if (type == Sort_Ascending)
+	if (array_size < 2)
 	{
-		qsort(array, array_size, sizeof(cell_t), sort_strings_asc);
+		return 1;
 	}
-	else if (type == Sort_Descending)
+
+	/* Resolve every string once up front instead of twice per comparison. */
+	std::unique_ptr<sort_string_ref[]> refs(new sort_string_ref[array_size]);
+	for (cell_t i = 0; i < array_size; i++)
 	{
-		qsort(array, array_size, sizeof(cell_t), sort_strings_desc);
+		char *str;
+		if (pContext->LocalToString(array[i], &str) != SP_ERROR_NONE)
+		{
+			str = (char *)"";
+		}
+		refs[i].str = str;
+		refs[i].addr = array[i];
+	}
+
+	if (type == Sort_Ascending)
+	{
+		std::sort(refs.get(), refs.get() + array_size, [](const sort_string_ref &a, const sort_string_ref &b) -> bool {
+			return strcmp(a.str, b.str) < 0;
+		});
 	}
 	else
 	{
-		sort_random(array, array_size);
+		std::sort(refs.get(), refs.get() + array_size, [](const sort_string_ref &a, const sort_string_ref &b) -> bool {
+			return strcmp(b.str, a.str) < 0;
+		});
 	}
+
+	for (cell_t i = 0; i < array_size; i++)
+	{
+		array[i] = refs[i].addr;
+	}
+
 	return 1;
 }
 
@@ -539,14 +642,65 @@ enum SortType
 	Sort_String,
 };
 
-int sort_adtarray_strings_asc(const void *str1, const void *str2)
+/* Packs the first four characters of a block string so most comparisons
+ * can be settled without calling strcmp. Characters past the terminator
+ * are zero, which keeps the prefix order identical to strcmp's.
+ */
+static inline uint32_t sort_string_prefix(const char *str)
 {
-	return strcmp((char *) str1, (char *) str2);
+	uint32_t prefix = 0;
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		prefix <<= 8;
+		if (*str)
+		{
+			prefix |= (unsigned char)*str++;
+		}
+	}
+	return prefix;
 }
 
-int sort_adtarray_strings_desc(const void *str1, const void *str2)
+/* Sorts string blocks with an introsort over block indices, then moves the
+ * blocks once. Equal strings keep their relative order.
+ */
+static void sort_string_blocks(cell_t *array, size_t count, size_t blocksize, bool descending)
 {
-	return strcmp((char *) str2, (char *) str1);
+	if (count < 2)
+	{
+		return;
+	}
+
+	std::unique_ptr<sort_block_key[]> keys(new sort_block_key[count]);
+	for (size_t i = 0; i < count; i++)
+	{
+		keys[i].key = sort_string_prefix((const char *)&array[i * blocksize]);
+		keys[i].index = (uint32_t)i;
+	}
+
+	auto compare = [array, blocksize](const sort_block_key &a, const sort_block_key &b) -> int {
+		if (a.key != b.key)
+		{
+			return (a.key < b.key) ? -1 : 1;
+		}
+		return strcmp((const char *)&array[a.index * blocksize], (const char *)&array[b.index * blocksize]);
+	};
+
+	if (!descending)
+	{
+		std::sort(keys.get(), keys.get() + count, [&compare](const sort_block_key &a, const sort_block_key &b) -> bool {
+			int res = compare(a, b);
+			return res < 0 || (res == 0 && a.index < b.index);
+		});
+	}
+	else
+	{
+		std::sort(keys.get(), keys.get() + count, [&compare](const sort_block_key &a, const sort_block_key &b) -> bool {
+			int res = compare(b, a);
+			return res < 0 || (res == 0 && a.index < b.index);
+		});
+	}
+
+	sort_permute_blocks(array, count, blocksize, keys.get());
 }
 
 void sort_adt_random(CellArray *cArray)
@@ -573,6 +727,11 @@ static cell_t sm_SortADTArray(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
 	}
 
+	if (cArray->frozen())
+	{
+		return pContext->ThrowNativeError("ArrayList %x is frozen and cannot be sorted", params[1]);
+	}
+
 	cell_t order = params[2];
 	
 	if (order == Sort_Random)
@@ -587,40 +746,17 @@ static cell_t sm_SortADTArray(IPluginContext *pContext, const cell_t *params)
 	size_t blocksize = cArray->blocksize();
 	cell_t *array = cArray->base();
 
-	if (type == Sort_Integer)
+	if (type == Sort_Integer || type == Sort_Float)
 	{
-		if (order == Sort_Ascending)
-		{
-			qsort(array, arraysize, blocksize * sizeof(cell_t), sort_ints_asc);
-		}
-		else
-		{
-			qsort(array, arraysize, blocksize * sizeof(cell_t), sort_ints_desc);
-		}
-	}
-	else if (type == Sort_Float)
-	{
-		if (order == Sort_Ascending)
-		{
-			qsort(array, arraysize, blocksize * sizeof(cell_t), sort_floats_asc);
-		}
-		else
-		{
-			qsort(array, arraysize, blocksize * sizeof(cell_t), sort_floats_desc);
-		}
+		sort_cell_blocks(array, arraysize, blocksize, sort_cell_key(type == Sort_Float, order != Sort_Ascending));
 	}
 	else if (type == Sort_String)
 	{
-		if (order == Sort_Ascending)
-		{
-			qsort(array, arraysize, blocksize * sizeof(cell_t), sort_adtarray_strings_asc);
-		}
-		else
-		{
-			qsort(array, arraysize, blocksize * sizeof(cell_t), sort_adtarray_strings_desc);
-		}
+		sort_string_blocks(array, arraysize, blocksize, order != Sort_Ascending);
 	}
 
+	cArray->InvalidateIndex();
+
 	return 1;
 }
 
@@ -664,6 +800,11 @@ static cell_t sm_SortADTArrayCustom(IPluginContext *pContext, const cell_t *para
 		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
 	}
 
+	if (cArray->frozen())
+	{
+		return pContext->ThrowNativeError("ArrayList %x is frozen and cannot be sorted", params[1]);
+	}
+
 	IPluginFunction *pFunction = pContext->GetFunctionById(params[2]);
 	if (!pFunction)
 	{
@@ -687,6 +828,177 @@ static cell_t sm_SortADTArrayCustom(IPluginContext *pContext, const cell_t *para
 	qsort(array, arraysize, blocksize * sizeof(cell_t), sort_adtarray_custom);
 
 	g_SortInfoADT = oldinfo;
+	cArray->InvalidateIndex();
+
+	return 1;
+}
+
+/* Upper bound on the number of keys in one SortByKeys call. */
+#define SORT_MAX_KEYS		16
+
+struct sort_key_spec
+{
+	size_t block;
+	cell_t type;
+	bool descending;
+};
+
+/* Three-way comparison of two rows under a list of keys. */
+static int sort_compare_rows(const cell_t *row1, const cell_t *row2, size_t blocksize,
+	const sort_key_spec *keys, size_t numKeys)
+{
+	for (size_t i = 0; i < numKeys; i++)
+	{
+		const sort_key_spec &spec = keys[i];
+		int res;
+
+		if (spec.type == Sort_String)
+		{
+			size_t maxbytes = (blocksize - spec.block) * sizeof(cell_t);
+			res = strncmp((const char *)&row1[spec.block], (const char *)&row2[spec.block], maxbytes);
+			if (spec.descending)
+			{
+				res = -res;
+			}
+		}
+		else
+		{
+			sort_cell_key key(spec.type == Sort_Float, spec.descending);
+			uint32_t k1 = key(row1[spec.block]);
+			uint32_t k2 = key(row2[spec.block]);
+			res = (k1 < k2) ? -1 : (k1 > k2) ? 1 : 0;
+		}
+
+		if (res != 0)
+		{
+			return res;
+		}
+	}
+
+	return 0;
+}
+
+static cell_t sm_SortADTArrayByKeys(IPluginContext *pContext, const cell_t *params)
+{
+	CellArray *cArray;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((err = handlesys->ReadHandle(params[1], htCellArray, &sec, (void **)&cArray))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	if (cArray->frozen())
+	{
+		return pContext->ThrowNativeError("ArrayList %x is frozen and cannot be sorted", params[1]);
+	}
+
+	cell_t numKeys = params[5];
+	if (numKeys < 1 || numKeys > SORT_MAX_KEYS)
+	{
+		return pContext->ThrowNativeError("Invalid number of sort keys %d (must be 1-%d)", numKeys, SORT_MAX_KEYS);
+	}
+
+	cell_t *blocks, *types, *orders;
+	pContext->LocalToPhysAddr(params[2], &blocks);
+	pContext->LocalToPhysAddr(params[3], &types);
+	pContext->LocalToPhysAddr(params[4], &orders);
+
+	size_t blocksize = cArray->blocksize();
+	bool allNumeric = true;
+	sort_key_spec keys[SORT_MAX_KEYS];
+
+	for (cell_t i = 0; i < numKeys; i++)
+	{
+		if (blocks[i] < 0 || (size_t)blocks[i] >= blocksize)
+		{
+			return pContext->ThrowNativeError("Invalid block %d for sort key %d (blocksize: %d)", blocks[i], i, (int)blocksize);
+		}
+		if (types[i] < Sort_Integer || types[i] > Sort_String)
+		{
+			return pContext->ThrowNativeError("Invalid type %d for sort key %d", types[i], i);
+		}
+		if (orders[i] != Sort_Ascending && orders[i] != Sort_Descending)
+		{
+			return pContext->ThrowNativeError("Invalid order %d for sort key %d", orders[i], i);
+		}
+
+		keys[i].block = blocks[i];
+		keys[i].type = types[i];
+		keys[i].descending = (orders[i] == Sort_Descending);
+		if (keys[i].type == Sort_String)
+		{
+			allNumeric = false;
+		}
+	}
+
+	bool stable = params[6] != 0;
+	size_t arraysize = cArray->size();
+	cell_t *array = cArray->base();
+
+	if (arraysize < 2)
+	{
+		return 1;
+	}
+
+	std::unique_ptr<sort_block_key[]> order(new sort_block_key[arraysize * 2]);
+	sort_block_key *sorted = order.get();
+	for (size_t i = 0; i < arraysize; i++)
+	{
+		sorted[i].key = 0;
+		sorted[i].index = (uint32_t)i;
+	}
+
+	if (allNumeric && arraysize > SORT_RADIX_THRESHOLD)
+	{
+		/* Stable radix passes from the least significant key to the most
+		 * significant one leave the rows ordered by the whole key list.
+		 */
+		sort_block_key *scratch = sorted + arraysize;
+		for (cell_t i = numKeys - 1; i >= 0; i--)
+		{
+			const sort_key_spec &spec = keys[i];
+			sort_cell_key key(spec.type == Sort_Float, spec.descending);
+			for (size_t j = 0; j < arraysize; j++)
+			{
+				sorted[j].key = key(array[sorted[j].index * blocksize + spec.block]);
+			}
+
+			sort_block_key *result = radix_sort(sorted, scratch, arraysize, [](const sort_block_key &elem) -> uint32_t {
+				return elem.key;
+			});
+			if (result != sorted)
+			{
+				scratch = sorted;
+				sorted = result;
+			}
+		}
+	}
+	else
+	{
+		auto compare = [array, blocksize, &keys, numKeys](const sort_block_key &a, const sort_block_key &b) -> int {
+			return sort_compare_rows(&array[a.index * blocksize], &array[b.index * blocksize], blocksize, keys, numKeys);
+		};
+
+		if (stable)
+		{
+			std::sort(sorted, sorted + arraysize, [&compare](const sort_block_key &a, const sort_block_key &b) -> bool {
+				int res = compare(a, b);
+				return res < 0 || (res == 0 && a.index < b.index);
+			});
+		}
+		else
+		{
+			std::sort(sorted, sorted + arraysize, [&compare](const sort_block_key &a, const sort_block_key &b) -> bool {
+				return compare(a, b) < 0;
+			});
+		}
+	}
+
+	sort_permute_blocks(array, arraysize, blocksize, sorted);
+	cArray->InvalidateIndex();
 
 	return 1;
 }
@@ -703,6 +1015,7 @@ REGISTER_NATIVES(sortNatives)
 	
 	{"ArrayList.Sort",          sm_SortADTArray},
 	{"ArrayList.SortCustom",    sm_SortADTArrayCustom},
+	{"ArrayList.SortByKeys",    sm_SortADTArrayByKeys},
 	
 	{NULL,                      NULL},
 };
@@ -567,23 +567,19 @@ static cell_t SplitString(IPluginContext *pContext, const cell_t *params)
 		return -1;
 	}
 
-	/**
-	 * Note that it's <= ... you could also just add 1,
-	 * but this is a bit nicer
-	 */
-	for (size_t i=0; i<=textLen - splitLen; i++)
+	const char *pos = UTIL_FindString(text, textLen, split, splitLen);
+	if (pos != NULL)
 	{
-		if (strncmp(&text[i], split, splitLen) == 0)
+		size_t i = pos - text;
+
+		/* Split hereeeee */
+		if (i >= maxLen)
 		{
-			/* Split hereeeee */
-			if (i >= maxLen)
-			{
-				pContext->StringToLocalUTF8(params[3], maxLen, text, NULL);
-			} else {
-				pContext->StringToLocalUTF8(params[3], i+1, text, NULL);
-			}
-			return (cell_t)(i + splitLen);
+			pContext->StringToLocalUTF8(params[3], maxLen, text, NULL);
+		} else {
+			pContext->StringToLocalUTF8(params[3], i+1, text, NULL);
 		}
+		return (cell_t)(i + splitLen);
 	}
 
 	return -1;
@@ -0,0 +1,470 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include <ctype.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <IHandleSys.h>
+#include "common_logic.h"
+
+/* Multi-word matchers for chat filters and the like.  The word list is 
+ * compiled into an Aho-Corasick automaton, so a message is checked against 
+ * every word in a single pass instead of one StrContains() per word.
+ */
+
+HandleType_t g_StringMatcherType = 0;
+
+struct StringMatch
+{
+	size_t start;
+	size_t length;
+	int word;
+};
+
+class StringMatcher
+{
+public:
+	StringMatcher(bool caseSensitive, bool wholeWords)
+		: case_sensitive_(caseSensitive),
+		  whole_words_(wholeWords),
+		  dirty_(true),
+		  class_count_(0)
+	{
+	}
+
+	int AddWord(const char *word)
+	{
+		words_.push_back(word);
+		dirty_ = true;
+		return (int)(words_.size() - 1);
+	}
+
+	size_t WordCount() const
+	{
+		return words_.size();
+	}
+
+	const std::string &GetWord(size_t index) const
+	{
+		return words_[index];
+	}
+
+	/* Finds matches from left to right, taking the longest word at each 
+	 * position and never returning overlapping matches.
+	 */
+	size_t FindMatches(const char *text, size_t len, std::vector<StringMatch> &out, size_t max);
+
+	size_t ApproxSize() const
+	{
+		size_t size = sizeof(StringMatcher);
+		for (size_t i = 0; i < words_.size(); i++)
+			size += words_[i].capacity();
+		size += delta_.capacity() * sizeof(int32_t);
+		size += word_at_.capacity() * sizeof(int32_t);
+		size += out_link_.capacity() * sizeof(int32_t);
+		return size;
+	}
+
+private:
+	void Compile();
+
+	bool IsBoundary(const char *text, size_t len, size_t start, size_t end) const
+	{
+		if (start > 0 && IsWordChar(text[start - 1]))
+			return false;
+		if (end < len && IsWordChar(text[end]))
+			return false;
+		return true;
+	}
+
+	static bool IsWordChar(char c)
+	{
+		/* Multi-byte characters count as letters so words aren't split mid-character. */
+		unsigned char uc = (unsigned char)c;
+		return uc >= 0x80 || isalnum(uc) || uc == '_';
+	}
+
+private:
+	bool case_sensitive_;
+	bool whole_words_;
+	bool dirty_;
+	std::vector<std::string> words_;
+
+	/* Bytes are mapped to classes, with every byte that appears in no word 
+	 * sharing class 0, which keeps the transition table small.
+	 */
+	uint16_t classes_[256];
+	unsigned int class_count_;
+	std::vector<int32_t> delta_;		/* state * class_count_ + class -> state */
+	std::vector<int32_t> word_at_;		/* word ending at a state, or -1 */
+	std::vector<int32_t> out_link_;		/* next state down the fail chain ending a word, or -1 */
+
+	/* Longest match starting at each offset, reused between calls */
+	std::vector<StringMatch> best_;
+};
+
+void StringMatcher::Compile()
+{
+	dirty_ = false;
+
+	memset(classes_, 0, sizeof(classes_));
+	unsigned int count = 1;
+	for (size_t i = 0; i < words_.size(); i++)
+	{
+		for (size_t j = 0; j < words_[i].size(); j++)
+		{
+			unsigned char c = (unsigned char)words_[i][j];
+			if (!case_sensitive_)
+				c = (unsigned char)tolower(c);
+			if (!classes_[c])
+				classes_[c] = (uint16_t)count++;
+		}
+	}
+	if (!case_sensitive_)
+	{
+		for (unsigned int c = 0; c < 256; c++)
+			classes_[c] = classes_[(unsigned char)tolower(c)];
+	}
+	class_count_ = count;
+
+	/* Build the trie. */
+	const size_t K = class_count_;
+	delta_.assign(K, -1);
+	word_at_.assign(1, -1);
+	for (size_t i = 0; i < words_.size(); i++)
+	{
+		size_t state = 0;
+		for (size_t j = 0; j < words_[i].size(); j++)
+		{
+			size_t slot = state * K + classes_[(unsigned char)words_[i][j]];
+			if (delta_[slot] < 0)
+			{
+				delta_[slot] = (int32_t)word_at_.size();
+				delta_.resize(delta_.size() + K, -1);
+				word_at_.push_back(-1);
+			}
+			state = delta_[slot];
+		}
+
+		/* Duplicates keep the index they were first added with. */
+		if (word_at_[state] < 0)
+			word_at_[state] = (int32_t)i;
+	}
+
+	/* Fill in failure transitions breadth first, turning the trie into a 
+	 * complete transition table.
+	 */
+	size_t states = word_at_.size();
+	std::vector<int32_t> fail(states, 0);
+	std::vector<int32_t> queue;
+	queue.reserve(states);
+	out_link_.assign(states, -1);
+
+	for (size_t c = 0; c < K; c++)
+	{
+		if (delta_[c] < 0)
+		{
+			delta_[c] = 0;
+			continue;
+		}
+		queue.push_back(delta_[c]);
+	}
+
+	for (size_t head = 0; head < queue.size(); head++)
+	{
+		int32_t r = queue[head];
+		for (size_t c = 0; c < K; c++)
+		{
+			int32_t s = delta_[r * K + c];
+			int32_t f = delta_[fail[r] * K + c];
+			if (s < 0)
+			{
+				delta_[r * K + c] = f;
+				continue;
+			}
+			fail[s] = f;
+			out_link_[s] = (word_at_[f] >= 0) ? f : out_link_[f];
+			queue.push_back(s);
+		}
+	}
+}
+
+size_t StringMatcher::FindMatches(const char *text, size_t len, std::vector<StringMatch> &out, size_t max)
+{
+	out.clear();
+	if (words_.empty() || !max)
+		return 0;
+
+	if (dirty_)
+		Compile();
+
+	StringMatch none = { 0, 0, -1 };
+	best_.assign(len, none);
+
+	const size_t K = class_count_;
+	int32_t state = 0;
+	for (size_t i = 0; i < len; i++)
+	{
+		state = delta_[state * K + classes_[(unsigned char)text[i]]];
+
+		int32_t s = (word_at_[state] >= 0) ? state : out_link_[state];
+		for (; s >= 0; s = out_link_[s])
+		{
+			int word = word_at_[s];
+			size_t length = words_[word].size();
+			size_t start = i + 1 - length;
+			if (whole_words_ && !IsBoundary(text, len, start, i + 1))
+				continue;
+			if (length > best_[start].length)
+			{
+				best_[start].start = start;
+				best_[start].length = length;
+				best_[start].word = word;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < len && out.size() < max; )
+	{
+		if (!best_[i].length)
+		{
+			i++;
+			continue;
+		}
+		out.push_back(best_[i]);
+		i += best_[i].length;
+	}
+
+	return out.size();
+}
+
+class StringMatcherNatives :
+	public SMGlobalClass,
+	public IHandleTypeDispatch
+{
+public: // SMGlobalClass
+	void OnSourceModAllInitialized() override
+	{
+		g_StringMatcherType = handlesys->CreateType("StringMatcher", this, 0, NULL, NULL, g_pCoreIdent, NULL);
+	}
+	void OnSourceModShutdown() override
+	{
+		handlesys->RemoveType(g_StringMatcherType, g_pCoreIdent);
+		g_StringMatcherType = 0;
+	}
+public: // IHandleTypeDispatch
+	void OnHandleDestroy(HandleType_t type, void *object) override
+	{
+		delete (StringMatcher *)object;
+	}
+	bool GetHandleApproxSize(HandleType_t type, void *object, unsigned int *pSize) override
+	{
+		*pSize = (unsigned int)((StringMatcher *)object)->ApproxSize();
+		return true;
+	}
+} s_StringMatcherNatives;
+
+static StringMatcher *ReadStringMatcher(IPluginContext *pContext, cell_t hndl)
+{
+	StringMatcher *matcher;
+	HandleError herr;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	if ((herr = handlesys->ReadHandle(hndl, g_StringMatcherType, &sec, (void **)&matcher)) != HandleError_None)
+	{
+		pContext->ReportError("Invalid StringMatcher handle %x (error %d)", hndl, herr);
+		return NULL;
+	}
+	return matcher;
+}
+
+static cell_t StringMatcher_Create(IPluginContext *pContext, const cell_t *params)
+{
+	StringMatcher *matcher = new StringMatcher(!!params[1], !!params[2]);
+
+	Handle_t hndl = handlesys->CreateHandle(g_StringMatcherType, matcher, pContext->GetIdentity(), g_pCoreIdent, NULL);
+	if (hndl == BAD_HANDLE)
+		delete matcher;
+
+	return hndl;
+}
+
+static cell_t StringMatcher_AddWord(IPluginContext *pContext, const cell_t *params)
+{
+	StringMatcher *matcher = ReadStringMatcher(pContext, params[1]);
+	if (!matcher)
+		return 0;
+
+	char *word;
+	pContext->LocalToString(params[2], &word);
+	if (word[0] == '\0')
+		return pContext->ThrowNativeError("Cannot add an empty word");
+
+	return matcher->AddWord(word);
+}
+
+static cell_t StringMatcher_WordCount(IPluginContext *pContext, const cell_t *params)
+{
+	StringMatcher *matcher = ReadStringMatcher(pContext, params[1]);
+	if (!matcher)
+		return 0;
+
+	return (cell_t)matcher->WordCount();
+}
+
+static cell_t StringMatcher_GetWord(IPluginContext *pContext, const cell_t *params)
+{
+	StringMatcher *matcher = ReadStringMatcher(pContext, params[1]);
+	if (!matcher)
+		return 0;
+
+	cell_t index = params[2];
+	if (index < 0 || (size_t)index >= matcher->WordCount())
+		return pContext->ThrowNativeError("Invalid word index %d (count %d)", index, (int)matcher->WordCount());
+
+	size_t bytes;
+	pContext->StringToLocalUTF8(params[3], params[4], matcher->GetWord(index).c_str(), &bytes);
+	return (cell_t)bytes;
+}
+
+static cell_t StringMatcher_FindFirst(IPluginContext *pContext, const cell_t *params)
+{
+	StringMatcher *matcher = ReadStringMatcher(pContext, params[1]);
+	if (!matcher)
+		return 0;
+
+	char *text;
+	pContext->LocalToString(params[2], &text);
+
+	std::vector<StringMatch> matches;
+	if (!matcher->FindMatches(text, strlen(text), matches, 1))
+		return -1;
+
+	cell_t *length, *word;
+	pContext->LocalToPhysAddr(params[3], &length);
+	pContext->LocalToPhysAddr(params[4], &word);
+	*length = (cell_t)matches[0].length;
+	*word = matches[0].word;
+
+	return (cell_t)matches[0].start;
+}
+
+static cell_t StringMatcher_FindAll(IPluginContext *pContext, const cell_t *params)
+{
+	StringMatcher *matcher = ReadStringMatcher(pContext, params[1]);
+	if (!matcher)
+		return 0;
+
+	cell_t max = params[5];
+	if (max < 0)
+		return pContext->ThrowNativeError("Invalid maximum match count %d", max);
+
+	char *text;
+	pContext->LocalToString(params[2], &text);
+
+	std::vector<StringMatch> matches;
+	size_t count = matcher->FindMatches(text, strlen(text), matches, (size_t)max);
+
+	cell_t *offsets, *words;
+	pContext->LocalToPhysAddr(params[3], &offsets);
+	pContext->LocalToPhysAddr(params[4], &words);
+	for (size_t i = 0; i < count; i++)
+	{
+		offsets[i] = (cell_t)matches[i].start;
+		words[i] = matches[i].word;
+	}
+
+	return (cell_t)count;
+}
+
+static cell_t StringMatcher_ReplaceAll(IPluginContext *pContext, const cell_t *params)
+{
+	StringMatcher *matcher = ReadStringMatcher(pContext, params[1]);
+	if (!matcher)
+		return 0;
+
+	char *text, *replacement;
+	pContext->LocalToString(params[2], &text);
+	pContext->LocalToString(params[4], &replacement);
+	bool per_char = !!params[5];
+
+	size_t len = strlen(text);
+	std::vector<StringMatch> matches;
+	size_t count = matcher->FindMatches(text, len, matches, len);
+	if (!count)
+		return 0;
+
+	std::string result;
+	result.reserve(len);
+
+	size_t pos = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		const StringMatch &match = matches[i];
+		result.append(text + pos, match.start - pos);
+
+		size_t repeats = 1;
+		if (per_char)
+		{
+			/* Once per character, not per byte, for multi-byte words */
+			repeats = 0;
+			for (size_t j = match.start; j < match.start + match.length; j++)
+			{
+				if (((unsigned char)text[j] & 0xC0) != 0x80)
+					repeats++;
+			}
+		}
+		while (repeats--)
+			result.append(replacement);
+
+		pos = match.start + match.length;
+	}
+	result.append(text + pos, len - pos);
+
+	pContext->StringToLocalUTF8(params[2], params[3], result.c_str(), NULL);
+
+	return (cell_t)count;
+}
+
+REGISTER_NATIVES(stringmatchernatives)
+{
+	{"StringMatcher.StringMatcher",		StringMatcher_Create},
+	{"StringMatcher.AddWord",			StringMatcher_AddWord},
+	{"StringMatcher.WordCount.get",		StringMatcher_WordCount},
+	{"StringMatcher.GetWord",			StringMatcher_GetWord},
+	{"StringMatcher.FindFirst",			StringMatcher_FindFirst},
+	{"StringMatcher.FindAll",			StringMatcher_FindAll},
+	{"StringMatcher.ReplaceAll",		StringMatcher_ReplaceAll},
+
+	{NULL,								NULL},
+};
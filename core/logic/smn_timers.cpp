@@ -36,6 +36,8 @@
 #include <IPluginSys.h>
 #include <sh_stack.h>
 #include "DebugReporter.h"
+#include "ProfileTools.h"
+#include "PluginTimeTracker.h"
 #include <bridge/include/CoreProvider.h>
 
 using namespace SourceHook;
@@ -141,7 +143,22 @@ ResultType TimerNatives::OnTimer(ITimer *pTimer, void *pData)
 
 	pFunc->PushCell(pInfo->TimerHandle);
 	pFunc->PushCell(pInfo->UserData);
-	pFunc->Execute(&res);
+
+	bool scoped = g_ProfileToolManager.IsActive();
+	if (scoped)
+	{
+		g_ProfileToolManager.EnterScope("timers", pFunc->DebugName());
+	}
+
+	{
+		PluginTimeScope scope(pFunc, pFunc->DebugName());
+		pFunc->Execute(&res);
+	}
+
+	if (scoped)
+	{
+		g_ProfileToolManager.LeaveScope();
+	}
 
 	return static_cast<ResultType>(res);
 }
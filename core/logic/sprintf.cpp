@@ -35,10 +35,29 @@
 #include <ITranslator.h>
 #include <bridge/include/IScriptManager.h>
 #include <bridge/include/CoreProvider.h>
+#include <limits.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Translator.h"
 
 using namespace SourceMod;
 
 IDatabase *g_FormatEscapeDatabase = NULL;
+bool g_FormatEscapeHasLength = false;
+
+/* Nesting depth of phrases being formatted.  Their text points into the string
+ * table, which loading a language can reallocate.
+ */
+static unsigned int s_TranslationDepth = 0;
+
+static inline void MaterializeForLookup(unsigned int langid)
+{
+	if (s_TranslationDepth == 0)
+	{
+		g_Translator.MaterializeLanguage(langid);
+	}
+}
 
 #define LADJUST			0x00000001		/* left adjustment */
 #define ZEROPAD			0x00000002		/* zero (as opposed to blank) pad */
@@ -63,6 +82,12 @@ inline void ReorderTranslationParams(const Translation *pTrans, cell_t *params)
 	memcpy(params, new_params, pTrans->fmt_count * sizeof(cell_t));
 }
 
+static bool FindCachedTranslation(IPhraseCollection *pPhrases, const char *key, unsigned int langid,
+	char *buffer, size_t maxlen, IPluginContext *pCtx, const cell_t *params, int *arg, size_t *len);
+static void CacheTranslation(IPhraseCollection *pPhrases, const char *key, unsigned int langid,
+	const Translation &trans, const char *buffer, size_t maxlen, size_t len, IPluginContext *pCtx,
+	const cell_t *params, int arg_in, int arg_out);
+
 size_t Translate(char *buffer,
 				 size_t maxlen,
 				 IPluginContext *pCtx,
@@ -78,6 +103,9 @@ size_t Translate(char *buffer,
 	IPlugin *pl = scripts->FindPluginByContext(pCtx->GetContext());
 	unsigned int max_params = 0;
 	IPhraseCollection *pPhrases;
+	unsigned int cache_langid = UINT_MAX;
+	int arg_in = *arg;
+	size_t len;
 
 	pPhrases = pl->GetPhrases();
 
@@ -96,6 +124,20 @@ try_serverlang:
 		goto error_out;
 	}
 
+	MaterializeForLookup(langid);
+
+	/* Loops like PrintToChatAll() format the same phrase once per client; clients sharing a
+	 * language get the text rendered for the first of them.
+	 */
+	if (cache_langid == UINT_MAX)
+	{
+		cache_langid = langid;
+		if (FindCachedTranslation(pPhrases, key, langid, buffer, maxlen, pCtx, params, arg, &len))
+		{
+			return len;
+		}
+	}
+
 	if (pPhrases->FindTranslation(key, langid, &pTrans) != Trans_Okay)
 	{
 		if (target != SOURCEMOD_SERVER_LANGUAGE && langid != g_Translator.GetServerLanguage())
@@ -139,12 +181,23 @@ try_serverlang:
 		memcpy(new_params, params, sizeof(cell_t) * (params[0] + 1));
 		ReorderTranslationParams(&pTrans, &new_params[*arg]);
 
-		return atcprintf(buffer, maxlen, pTrans.szPhrase, pCtx, new_params, arg);
+		s_TranslationDepth++;
+		len = atcprintf(buffer, maxlen, pTrans.szPhrase, pCtx, new_params, arg);
+		s_TranslationDepth--;
 	}
 	else
 	{
-		return atcprintf(buffer, maxlen, pTrans.szPhrase, pCtx, params, arg);
+		s_TranslationDepth++;
+		len = atcprintf(buffer, maxlen, pTrans.szPhrase, pCtx, params, arg);
+		s_TranslationDepth--;
 	}
+
+	/* Errors are thrown with a zero length; empty text is not worth keeping either. */
+	if (len)
+	{
+		CacheTranslation(pPhrases, key, cache_langid, pTrans, buffer, maxlen, len, pCtx, params, arg_in, *arg);
+	}
+	return len;
 	
 error_out:
 	*error = true;
@@ -182,6 +235,7 @@ bool AddString(char **buf_p, size_t &maxlen, const char *string, int width, int
 		size--;
 	}
 
+	int srclen = size;
 	if (size > (int)maxlen)
 	{
 		size = maxlen;
@@ -200,21 +254,30 @@ bool AddString(char **buf_p, size_t &maxlen, const char *string, int width, int
 
 	if (g_FormatEscapeDatabase && (flags & NOESCAPE) == 0)
 	{
-		char *tempBuffer = NULL;
-		if (prec != -1)
+		size_t newSize;
+		bool ret;
+		if (g_FormatEscapeHasLength)
 		{
-			// I doubt anyone will ever do this, so just allocate.
-			tempBuffer = new char[maxlen + 1];
-			memcpy(tempBuffer, string, size);
-			tempBuffer[size] = '\0';
+			// Escape straight out of plugin memory, no terminator needed.
+			ret = g_FormatEscapeDatabase->QuoteStringEx(string, prec != -1 ? size : srclen, buf, maxlen + 1, &newSize);
 		}
+		else
+		{
+			char *tempBuffer = NULL;
+			if (prec != -1)
+			{
+				// I doubt anyone will ever do this, so just allocate.
+				tempBuffer = new char[maxlen + 1];
+				memcpy(tempBuffer, string, size);
+				tempBuffer[size] = '\0';
+			}
 
-		size_t newSize;
-		bool ret = g_FormatEscapeDatabase->QuoteString(tempBuffer ? tempBuffer : string, buf, maxlen + 1, &newSize);
+			ret = g_FormatEscapeDatabase->QuoteString(tempBuffer ? tempBuffer : string, buf, maxlen + 1, &newSize);
 
-		if (tempBuffer)
-		{
-			delete[] tempBuffer;
+			if (tempBuffer)
+			{
+				delete[] tempBuffer;
+			}
 		}
 
 		if (!ret)
@@ -872,6 +935,8 @@ try_again:
 					lang_id = g_Translator.GetServerLanguage();
 				}
 
+				MaterializeForLookup(lang_id);
+
 				if (pPhrases == NULL)
 				{
 					if (pFailPhrase != NULL)
@@ -909,6 +974,7 @@ try_again:
 					}
 				}
 
+				bool formatted;
 				if (trans.fmt_count)
 				{
 					unsigned int i;
@@ -930,7 +996,8 @@ try_again:
 						new_params[curparam + i] = const_cast<void *>(params[curparam + trans.fmt_order[i]]);
 					}
 
-					if (!gnprintf(buf_p,
+					s_TranslationDepth++;
+					formatted = gnprintf(buf_p,
 							llen,
 							trans.szPhrase,
 							pPhrases,
@@ -938,14 +1005,13 @@ try_again:
 							numparams,
 							curparam,
 							&out_length,
-							pFailPhrase))
-					{
-						return false;
-					}
+							pFailPhrase);
+					s_TranslationDepth--;
 				}
 				else
 				{
-					if (!gnprintf(buf_p,
+					s_TranslationDepth++;
+					formatted = gnprintf(buf_p,
 						llen,
 						trans.szPhrase,
 						pPhrases,
@@ -953,10 +1019,13 @@ try_again:
 						numparams,
 						curparam,
 						&out_length,
-						pFailPhrase))
-					{
-						return false;
-					}
+						pFailPhrase);
+					s_TranslationDepth--;
+				}
+
+				if (!formatted)
+				{
+					return false;
 				}
 
 				buf_p += out_length;
@@ -1041,40 +1110,91 @@ done:
 	return true;
 }
 
-size_t atcprintf(char *buffer, size_t maxlen, const char *format, IPluginContext *pCtx, const cell_t *params, int *param)
+// Pre-parsed form of a format string: literal text runs plus conversion
+// specifiers, so a format that is used over and over is only tokenized once.
+struct FormatToken
 {
-	if (!buffer || !maxlen)
+	char conv;			// conversion character, or '\0' for a literal run
+	int flags;
+	int width;
+	int prec;
+	size_t lit_pos;		// literal run, as an offset into CompiledFormat::literals
+	size_t lit_len;
+};
+
+struct CompiledFormat
+{
+	const char *key = nullptr;		// address the format was last read from
+	std::string format;				// copy of the format, to validate hits
+	std::string literals;
+	std::vector<FormatToken> tokens;
+	unsigned int in_use = 0;		// nested calls (%t/%T) can't recycle a slot in use
+};
+
+// Formats are almost always plugin string literals or phrase text, which
+// keep their address, so slots are picked by address. Contents are always
+// compared, since a buffer can be reused for a different format.
+#define FORMAT_CACHE_SLOTS	512
+
+static CompiledFormat s_FormatCache[FORMAT_CACHE_SLOTS];
+
+class CompiledFormatPin
+{
+public:
+	CompiledFormatPin(CompiledFormat *cf) : cf_(cf)
 	{
-		return 0;
+		cf_->in_use++;
+	}
+	~CompiledFormatPin()
+	{
+		cf_->in_use--;
 	}
+private:
+	CompiledFormat *cf_;
+};
 
-	int arg;
-	int args = params[0];
-	char *buf_p;
+static void AddFormatLiteral(CompiledFormat *cf, const char *text, size_t len)
+{
+	if (!len)
+	{
+		return;
+	}
+
+	if (cf->tokens.empty() || cf->tokens.back().conv != '\0')
+	{
+		FormatToken tok = { '\0', 0, 0, -1, cf->literals.size(), 0 };
+		cf->tokens.push_back(tok);
+	}
+
+	cf->literals.append(text, len);
+	cf->tokens.back().lit_len += len;
+}
+
+static void CompileFormat(CompiledFormat *cf, const char *format)
+{
 	char ch;
 	int flags;
 	int width;
 	int prec;
 	int n;
-	char sign;
-	const char *fmt;
-	size_t llen = maxlen - 1;
+	const char *fmt = format;
 
-	buf_p = buffer;
-	arg = *param;
-	fmt = format;
+	cf->format.assign(format);
+	cf->literals.clear();
+	cf->tokens.clear();
 
 	while (true)
 	{
 		// run through the format string until we hit a '%' or '\0'
-		for (ch = *fmt; llen && ((ch = *fmt) != '\0') && (ch != '%'); fmt++)
+		const char *lit = fmt;
+		while ((ch = *fmt) != '\0' && ch != '%')
 		{
-			*buf_p++ = ch;
-			llen--;
+			fmt++;
 		}
-		if ((ch == '\0') || (llen <= 0))
+		AddFormatLiteral(cf, lit, fmt - lit);
+		if (ch == '\0')
 		{
-			goto done;
+			return;
 		}
 
 		// skip over the '%'
@@ -1084,7 +1204,6 @@ size_t atcprintf(char *buffer, size_t maxlen, const char *format, IPluginContext
 		flags = 0;
 		width = 0;
 		prec = -1;
-		sign = '\0';
 
 rflag:
 		ch = *fmt++;
@@ -1135,6 +1254,273 @@ reswitch:
 				width = n;
 				goto reswitch;
 			}
+		case 'c':
+		case 'b':
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'f':
+		case 'L':
+		case 'N':
+		case 'E':
+		case 's':
+		case 'T':
+		case 't':
+		case 'X':
+		case 'x':
+			{
+				FormatToken tok = { ch, flags, width, prec, 0, 0 };
+				cf->tokens.push_back(tok);
+				break;
+			}
+		case '\0':
+			{
+				// a trailing '%' is printed as-is
+				AddFormatLiteral(cf, "%", 1);
+				return;
+			}
+		default:
+			{
+				// "%%" and unknown conversions print the character itself
+				AddFormatLiteral(cf, &ch, 1);
+				break;
+			}
+		}
+	}
+}
+
+static CompiledFormat *FindCompiledFormat(const char *format, CompiledFormat *scratch)
+{
+	uintptr_t addr = reinterpret_cast<uintptr_t>(format);
+	CompiledFormat *cf = &s_FormatCache[(addr ^ (addr >> 9)) % FORMAT_CACHE_SLOTS];
+	if (cf->key == format && cf->format == format)
+	{
+		return cf;
+	}
+
+	if (cf->in_use)
+	{
+		cf = scratch;
+	}
+
+	CompileFormat(cf, format);
+	cf->key = format;
+
+	return cf;
+}
+
+// Rendered phrases, so a phrase formatted with the same arguments for many clients
+// is only rendered once per language. An entry is reused only if everything the
+// output depends on still matches: the phrase collection and translation generation,
+// the language, the buffer size, the parameter count and position, and the values
+// of every argument the phrase consumes (string contents included).
+struct CachedTranslation
+{
+	IPhraseCollection *phrases = nullptr;
+	unsigned int generation = 0;
+	unsigned int langid = 0;
+	size_t maxlen = 0;
+	cell_t num_params = 0;
+	int arg_in = 0;
+	int arg_out = 0;
+	std::string key;
+	std::vector<std::pair<char, int>> inputs;	// conversion, offset from arg_in
+	std::string signature;
+	std::string output;
+};
+
+#define TRANSLATION_CACHE_SLOTS	64
+
+static CachedTranslation s_TranslationCache[TRANSLATION_CACHE_SLOTS];
+
+static CachedTranslation *TranslationSlot(IPhraseCollection *pPhrases, const char *key, unsigned int langid)
+{
+	uint32_t h = 2166136261u;
+	for (const char *p = key; *p; p++)
+	{
+		h = (h ^ (unsigned char)*p) * 16777619u;
+	}
+	uintptr_t addr = reinterpret_cast<uintptr_t>(pPhrases);
+	h ^= (uint32_t)(addr >> 4) * 31u + langid;
+	return &s_TranslationCache[h % TRANSLATION_CACHE_SLOTS];
+}
+
+static bool BuildTranslationSignature(std::string &sig, const std::vector<std::pair<char, int>> &inputs,
+	IPluginContext *pCtx, const cell_t *params, int arg_in)
+{
+	sig.clear();
+	for (size_t i = 0; i < inputs.size(); i++)
+	{
+		cell_t param = params[arg_in + inputs[i].second];
+		if (inputs[i].first == 's' || inputs[i].first == 'c')
+		{
+			char *str;
+			if (pCtx->LocalToString(param, &str) != SP_ERROR_NONE)
+			{
+				return false;
+			}
+			sig.append(str, strlen(str) + 1);
+		}
+		else
+		{
+			cell_t *value;
+			if (pCtx->LocalToPhysAddr(param, &value) != SP_ERROR_NONE)
+			{
+				return false;
+			}
+			sig.append(reinterpret_cast<const char *>(value), sizeof(cell_t));
+		}
+	}
+	return true;
+}
+
+static bool FindCachedTranslation(IPhraseCollection *pPhrases, const char *key, unsigned int langid,
+	char *buffer, size_t maxlen, IPluginContext *pCtx, const cell_t *params, int *arg, size_t *len)
+{
+	if (g_FormatEscapeDatabase)
+	{
+		return false;
+	}
+
+	CachedTranslation *ct = TranslationSlot(pPhrases, key, langid);
+	if (ct->phrases != pPhrases
+		|| ct->generation != g_Translator.GetGeneration()
+		|| ct->langid != langid
+		|| ct->maxlen != maxlen
+		|| ct->num_params != params[0]
+		|| ct->arg_in != *arg
+		|| ct->key != key)
+	{
+		return false;
+	}
+
+	std::string sig;
+	if (!BuildTranslationSignature(sig, ct->inputs, pCtx, params, *arg) || sig != ct->signature)
+	{
+		return false;
+	}
+
+	memcpy(buffer, ct->output.c_str(), ct->output.size() + 1);
+	*arg = ct->arg_out;
+	*len = ct->output.size();
+	return true;
+}
+
+static void CacheTranslation(IPhraseCollection *pPhrases, const char *key, unsigned int langid,
+	const Translation &trans, const char *buffer, size_t maxlen, size_t len, IPluginContext *pCtx,
+	const cell_t *params, int arg_in, int arg_out)
+{
+	if (g_FormatEscapeDatabase)
+	{
+		return;
+	}
+
+	// Only phrases whose output is a pure function of their arguments qualify:
+	// no client names or entities, and no nested translations.
+	CompiledFormat scratch;
+	CompiledFormat *cf = FindCompiledFormat(trans.szPhrase, &scratch);
+	std::vector<std::pair<char, int>> inputs;
+	for (size_t i = 0; i < cf->tokens.size(); i++)
+	{
+		char conv = cf->tokens[i].conv;
+		switch (conv)
+		{
+		case '\0':
+			continue;
+		case 'c':
+		case 'b':
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'f':
+		case 's':
+		case 'X':
+		case 'x':
+			break;
+		default:
+			return;
+		}
+
+		int n = (int)inputs.size();
+		if (trans.fmt_count)
+		{
+			if ((unsigned int)n >= trans.fmt_count)
+			{
+				return;
+			}
+			n = trans.fmt_order[n];
+			if (n < 0)
+			{
+				return;
+			}
+		}
+		inputs.push_back(std::make_pair(conv, n));
+	}
+
+	CachedTranslation *ct = TranslationSlot(pPhrases, key, langid);
+	if (!BuildTranslationSignature(ct->signature, inputs, pCtx, params, arg_in))
+	{
+		ct->phrases = nullptr;
+		return;
+	}
+
+	ct->phrases = pPhrases;
+	ct->generation = g_Translator.GetGeneration();
+	ct->langid = langid;
+	ct->maxlen = maxlen;
+	ct->num_params = params[0];
+	ct->arg_in = arg_in;
+	ct->arg_out = arg_out;
+	ct->key = key;
+	ct->inputs.swap(inputs);
+	ct->output.assign(buffer, len);
+}
+
+size_t atcprintf(char *buffer, size_t maxlen, const char *format, IPluginContext *pCtx, const cell_t *params, int *param)
+{
+	if (!buffer || !maxlen)
+	{
+		return 0;
+	}
+
+	CompiledFormat scratch;
+	CompiledFormat *cf = FindCompiledFormat(format, &scratch);
+	CompiledFormatPin pin(cf);
+
+	int arg;
+	int args = params[0];
+	char *buf_p;
+	int flags;
+	int width;
+	int prec;
+	size_t llen = maxlen - 1;
+
+	buf_p = buffer;
+	arg = *param;
+
+	for (size_t i = 0; i < cf->tokens.size(); i++)
+	{
+		const FormatToken &tok = cf->tokens[i];
+		if (!llen)
+		{
+			goto done;
+		}
+
+		if (tok.conv == '\0')
+		{
+			size_t len = (tok.lit_len < llen) ? tok.lit_len : llen;
+			memcpy(buf_p, &cf->literals[tok.lit_pos], len);
+			buf_p += len;
+			llen -= len;
+			continue;
+		}
+
+		flags = tok.flags;
+		width = tok.width;
+		prec = tok.prec;
+
+		switch (tok.conv)
+		{
 		case 'c':
 			{
 				CHECK_ARGS(0);
@@ -1307,36 +1693,6 @@ reswitch:
 				arg++;
 				break;
 			}
-		case '%':
-			{
-				if (!llen)
-				{
-					goto done;
-				}
-				*buf_p++ = ch;
-				llen--;
-				break;
-			}
-		case '\0':
-			{
-				if (!llen)
-				{
-					goto done;
-				}
-				*buf_p++ = '%';
-				llen--;
-				goto done;
-			}
-		default:
-			{
-				if (!llen)
-				{
-					goto done;
-				}
-				*buf_p++ = ch;
-				llen--;
-				break;
-			}
 		}
 	}
 
@@ -1345,4 +1701,3 @@ done:
 	*param = arg;
 	return (maxlen - llen - 1);
 }
-
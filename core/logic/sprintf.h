@@ -59,5 +59,7 @@ bool gnprintf(char *buffer,
               const char **pFailPhrase);
 
 extern SourceMod::IDatabase *g_FormatEscapeDatabase;
+/* Whether g_FormatEscapeDatabase supports IDatabase::QuoteStringEx. */
+extern bool g_FormatEscapeHasLength;
 
 #endif // _include_sourcemod_core_logic_sprintf_h_
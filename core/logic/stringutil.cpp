@@ -38,43 +38,96 @@
 #include "sprintf.h"
 #include <am-string.h>
 #include "TextParsers.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define STRING_SEARCH_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
 
 // We're in logic so we don't have this from the SDK.
 #ifndef MIN
 #define MIN( a, b ) ( ( ( a ) < ( b ) ) ? ( a ) : ( b ) )
 #endif
 
-const char *stristr(const char *str, const char *substr)
+#ifdef STRING_SEARCH_SSE2
+static inline unsigned int LowestBit(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long bit;
+	_BitScanForward(&bit, mask);
+	return bit;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+// Matches either case of an ASCII letter, or the byte itself otherwise.
+static inline __m128i FoldedEquals(__m128i chars, __m128i lower, __m128i upper)
+{
+	return _mm_or_si128(_mm_cmpeq_epi8(chars, lower), _mm_cmpeq_epi8(chars, upper));
+}
+#endif
+
+const char *UTIL_FindString(const char *str, size_t len, const char *search, size_t searchLen, bool caseSensitive)
 {
-	if (!*substr)
+	if (searchLen == 0)
+	{
+		return str;
+	}
+	if (searchLen > len)
 	{
-		return ((char *)str);
+		return NULL;
 	}
 
-	char *needle = (char *)substr;
-	char *prevloc = (char *)str;
-	char *haystack = (char *)str;
-
-	while (*haystack)
+	size_t last = len - searchLen;
+	size_t pos = 0;
+
+#ifdef STRING_SEARCH_SSE2
+	// Test 16 candidate positions at a time against the first and last
+	// bytes of the search string, and only compare fully where both match.
+	unsigned char first = search[0];
+	unsigned char last_byte = search[searchLen - 1];
+	const __m128i first_lo = _mm_set1_epi8(caseSensitive ? first : tolower(first));
+	const __m128i first_up = _mm_set1_epi8(caseSensitive ? first : toupper(first));
+	const __m128i last_lo = _mm_set1_epi8(caseSensitive ? last_byte : tolower(last_byte));
+	const __m128i last_up = _mm_set1_epi8(caseSensitive ? last_byte : toupper(last_byte));
+	while (pos + 16 <= last + 1)
 	{
-		if (tolower(*haystack) == tolower(*needle))
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + pos));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + pos + searchLen - 1));
+		unsigned int mask = _mm_movemask_epi8(_mm_and_si128(FoldedEquals(a, first_lo, first_up),
+		                                                    FoldedEquals(b, last_lo, last_up)));
+		while (mask)
 		{
-			haystack++;
-			if (!*++needle)
+			size_t i = pos + LowestBit(mask);
+			if ((caseSensitive ? memcmp(str + i, search, searchLen) : strncasecmp(str + i, search, searchLen)) == 0)
 			{
-				return prevloc;
+				return str + i;
 			}
+			mask &= mask - 1;
 		}
-		else
+		pos += 16;
+	}
+#endif
+
+	for (; pos <= last; pos++)
+	{
+		if ((caseSensitive ? memcmp(str + pos, search, searchLen) : strncasecmp(str + pos, search, searchLen)) == 0)
 		{
-			haystack = ++prevloc;
-			needle = (char *)substr;
+			return str + pos;
 		}
 	}
 
 	return NULL;
 }
 
+const char *stristr(const char *str, const char *substr)
+{
+	return UTIL_FindString(str, strlen(str), substr, strlen(substr), false);
+}
+
 unsigned int strncopy(char *dest, const char *src, size_t count)
 {
 	return ke::SafeStrcpy(dest, count, src);
@@ -148,8 +201,25 @@ char *UTIL_ReplaceEx(char *subject, size_t maxLen, const char *search, size_t se
 	/* Subtract one off the maxlength so we can include the null terminator */
 	maxLen--;
 
+	/* The search string can be scanned for directly unless it has a null 
+	 * terminator inside searchLen, where strncmp() stops early.
+	 */
+	bool canSkip = (strnlen(search, searchLen) == searchLen);
+
 	while (*ptr != '\0' && (browsed <= textLen - searchLen))
 	{
+		/* Jump straight to the next possible match */
+		if (canSkip)
+		{
+			const char *next = UTIL_FindString(ptr, textLen - browsed, search, searchLen, caseSensitive);
+			if (next == NULL)
+			{
+				return NULL;
+			}
+			browsed += next - ptr;
+			ptr = const_cast<char *>(next);
+		}
+
 		/* See if we get a comparison */
 		if ((caseSensitive ? strncmp(ptr, search, searchLen) : strncasecmp(ptr, search, searchLen)) == 0)
 		{
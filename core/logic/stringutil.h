@@ -33,6 +33,8 @@
 #define _INCLUDE_SOURCEMOD_COMMON_STRINGUTIL_H_
 
 const char *stristr(const char *str, const char *substr);
+const char *UTIL_FindString(const char *str, size_t len, const char *search, size_t searchLen,
+                            bool caseSensitive = true);
 unsigned int strncopy(char *dest, const char *src, size_t count);
 unsigned int UTIL_ReplaceAll(char *subject, size_t maxlength, const char *search,
                              const char *replace, bool caseSensitive = true);
@@ -45,12 +45,23 @@
 #include "ConCmdManager.h"
 #include "IDBDriver.h"
 #include "provider.h"
+#include "StartupTimeline.h"
 #include "sm_convar.h"
 #include <amtl/os/am-shared-library.h>
 #include <amtl/os/am-path.h>
 #include <bridge/include/IVEngineServerBridge.h>
 #include <bridge/include/IPlayerInfoBridge.h>
 #include <bridge/include/IFileSystemBridge.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+#if defined PLATFORM_WINDOWS
+#include <intrin.h>
+#define BRIDGE_RETURN_ADDRESS()	_ReturnAddress()
+#else
+#include <dlfcn.h>
+#define BRIDGE_RETURN_ADDRESS()	__builtin_return_address(0)
+#endif
 
 sm_logic_t logicore;
 
@@ -66,36 +77,154 @@ IAdminSystem *adminsys = nullptr;
 ILogger *logger = nullptr;
 IRootConsole *rootmenu = nullptr;
 
+/* "sm bridge start" counts calls into the bridge by entry point and by the
+ * address in logic they were made from, to find which ones are hot.
+ */
+class BridgeCallStats :
+	public SMGlobalClass,
+	public IRootConsoleCommand
+{
+public:
+	void OnSourceModAllInitialized() override
+	{
+		rootmenu->AddRootConsoleCommand3("bridge", "Count core bridge calls per call site", this);
+	}
+	void OnSourceModShutdown() override
+	{
+		rootmenu->RemoveRootConsoleCommand("bridge", this);
+	}
+	void OnRootConsoleCommand(const char *cmdname, const ICommandArgs *args) override;
+
+	void Hit(const char *name, void *caller)
+	{
+		m_Counts[std::make_pair(name, caller)]++;
+	}
+
+public:
+	bool enabled = false;
+private:
+	std::map<std::pair<const char *, void *>, uint64_t> m_Counts;
+} s_BridgeStats;
+
+#define COUNT_BRIDGE_CALL(name) \
+	if (s_BridgeStats.enabled) \
+		s_BridgeStats.Hit(name, BRIDGE_RETURN_ADDRESS())
+
+static void DescribeCaller(void *addr, char *buffer, size_t maxlength)
+{
+	const char *module = "?";
+	uintptr_t base = 0;
+#if defined PLATFORM_WINDOWS
+	HMODULE hModule;
+	char path[MAX_PATH];
+	if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+	                       (LPCSTR)addr, &hModule)
+		&& GetModuleFileNameA(hModule, path, sizeof(path)))
+	{
+		module = path;
+		base = (uintptr_t)hModule;
+	}
+#else
+	Dl_info info;
+	if (dladdr(addr, &info) && info.dli_fname)
+	{
+		module = info.dli_fname;
+		base = (uintptr_t)info.dli_fbase;
+	}
+#endif
+	const char *slash = strrchr(module, PLATFORM_SEP_CHAR);
+	ke::SafeSprintf(buffer, maxlength, "%s+0x%zx", slash ? slash + 1 : module, (size_t)((uintptr_t)addr - base));
+}
+
+void BridgeCallStats::OnRootConsoleCommand(const char *cmdname, const ICommandArgs *args)
+{
+	const char *sub = args->ArgC() >= 3 ? args->Arg(2) : "";
+	if (strcmp(sub, "start") == 0)
+	{
+		enabled = true;
+		rootmenu->ConsolePrint("[SM] Counting bridge calls. Use \"sm bridge dump\" to see them.");
+		return;
+	}
+	if (strcmp(sub, "stop") == 0)
+	{
+		enabled = false;
+		rootmenu->ConsolePrint("[SM] Stopped counting bridge calls.");
+		return;
+	}
+	if (strcmp(sub, "reset") == 0)
+	{
+		m_Counts.clear();
+		rootmenu->ConsolePrint("[SM] Bridge call counters reset.");
+		return;
+	}
+	if (strcmp(sub, "dump") != 0)
+	{
+		rootmenu->ConsolePrint("SourceMod Bridge Menu:");
+		rootmenu->DrawGenericOption("start", "Start counting bridge calls");
+		rootmenu->DrawGenericOption("stop", "Stop counting bridge calls");
+		rootmenu->DrawGenericOption("dump", "Show the busiest call sites");
+		rootmenu->DrawGenericOption("reset", "Clear the counters");
+		return;
+	}
+
+	std::vector<std::pair<uint64_t, std::pair<const char *, void *>>> rows;
+	for (const auto &entry : m_Counts)
+		rows.emplace_back(entry.second, entry.first);
+	std::sort(rows.begin(), rows.end(),
+		[](const decltype(rows)::value_type &a, const decltype(rows)::value_type &b) {
+			return a.first > b.first;
+		});
+
+	rootmenu->ConsolePrint("[SM] Bridge calls by call site%s:", enabled ? "" : " (not counting)");
+	rootmenu->ConsolePrint("  %-12s %-36s %s", "Calls", "Entry point", "Caller");
+	for (size_t i = 0; i < rows.size() && i < 50; i++)
+	{
+		char caller[256];
+		DescribeCaller(rows[i].second.second, caller, sizeof(caller));
+		rootmenu->ConsolePrint("  %-12llu %-36s %s", (unsigned long long)rows[i].first,
+			rows[i].second.first, caller);
+	}
+}
+
 class VEngineServer_Logic : public IVEngineServerBridge
 {
 public:
 	virtual bool IsDedicatedServer()
 	{
+		COUNT_BRIDGE_CALL("engine->IsDedicatedServer");
 		return engine->IsDedicatedServer();
 	}
 	virtual void InsertServerCommand(const char *cmd)
 	{
+		COUNT_BRIDGE_CALL("engine->InsertServerCommand");
 		engine->InsertServerCommand(cmd);
 	}
 	virtual void ServerCommand(const char *cmd)
 	{
+		COUNT_BRIDGE_CALL("engine->ServerCommand");
 		engine->ServerCommand(cmd);
 	}
 	virtual void ServerExecute()
 	{
+		COUNT_BRIDGE_CALL("engine->ServerExecute");
 		engine->ServerExecute();
 	}
 	virtual const char *GetClientConVarValue(int clientIndex, const char *name)
 	{
+		COUNT_BRIDGE_CALL("engine->GetClientConVarValue");
 		return engine->GetClientConVarValue(clientIndex, name);
 	}
 	virtual void ClientCommand(edict_t *pEdict, const char *szCommand)
 	{
+		COUNT_BRIDGE_CALL("engine->ClientCommand");
 		engine->ClientCommand(pEdict, "%s", szCommand);
 	}
 	virtual void FakeClientCommand(edict_t *pEdict, const char *szCommand)
 	{
+		COUNT_BRIDGE_CALL("engine->FakeClientCommand");
+		g_ConCmds.EnterTrustedCommand();
 		serverpluginhelpers->ClientCommand(pEdict, szCommand);
+		g_ConCmds.LeaveTrustedCommand();
 	}
 } engine_wrapper;
 
@@ -220,26 +349,32 @@ class VPlayerInfo_Logic : public IPlayerInfoBridge
 public:
 	bool IsObserver(IPlayerInfo *pInfo)
 	{
+		COUNT_BRIDGE_CALL("playerInfo->IsObserver");
 		return pInfo->IsObserver();
 	}
 	int GetTeamIndex(IPlayerInfo *pInfo)
 	{
+		COUNT_BRIDGE_CALL("playerInfo->GetTeamIndex");
 		return pInfo->GetTeamIndex();
 	}
 	int GetFragCount(IPlayerInfo *pInfo)
 	{
+		COUNT_BRIDGE_CALL("playerInfo->GetFragCount");
 		return pInfo->GetFragCount();
 	}
 	int GetDeathCount(IPlayerInfo *pInfo)
 	{
+		COUNT_BRIDGE_CALL("playerInfo->GetDeathCount");
 		return pInfo->GetDeathCount();
 	}
 	int GetArmorValue(IPlayerInfo *pInfo)
 	{
+		COUNT_BRIDGE_CALL("playerInfo->GetArmorValue");
 		return pInfo->GetArmorValue();
 	}
 	void GetAbsOrigin(IPlayerInfo *pInfo, float *x, float *y, float *z)
 	{
+		COUNT_BRIDGE_CALL("playerInfo->GetAbsOrigin");
 		Vector vec = pInfo->GetAbsOrigin();
 		*x = vec.x;
 		*y = vec.y;
@@ -247,6 +382,7 @@ public:
 	}
 	void GetAbsAngles(IPlayerInfo *pInfo, float *x, float *y, float *z)
 	{
+		COUNT_BRIDGE_CALL("playerInfo->GetAbsAngles");
 		QAngle ang = pInfo->GetAbsAngles();
 		*x = ang.x;
 		*y = ang.y;
@@ -254,6 +390,7 @@ public:
 	}
 	void GetPlayerMins(IPlayerInfo *pInfo, float *x, float *y, float *z)
 	{
+		COUNT_BRIDGE_CALL("playerInfo->GetPlayerMins");
 		Vector vec = pInfo->GetPlayerMins();
 		*x = vec.x;
 		*y = vec.y;
@@ -261,6 +398,7 @@ public:
 	}
 	void GetPlayerMaxs(IPlayerInfo *pInfo, float *x, float *y, float *z)
 	{
+		COUNT_BRIDGE_CALL("playerInfo->GetPlayerMaxs");
 		Vector vec = pInfo->GetPlayerMaxs();
 		*x = vec.x;
 		*y = vec.y;
@@ -268,22 +406,53 @@ public:
 	}
 	const char *GetWeaponName(IPlayerInfo *pInfo)
 	{
+		COUNT_BRIDGE_CALL("playerInfo->GetWeaponName");
 		return pInfo->GetWeaponName();
 	}
 	const char *GetModelName(IPlayerInfo *pInfo)
 	{
+		COUNT_BRIDGE_CALL("playerInfo->GetModelName");
 		return pInfo->GetModelName();
 	}
 	int GetHealth(IPlayerInfo *pInfo)
 	{
+		COUNT_BRIDGE_CALL("playerInfo->GetHealth");
 		return pInfo->GetHealth();
 	}
 	void ChangeTeam(IPlayerInfo *pInfo, int iTeamNum)
 	{
+		COUNT_BRIDGE_CALL("playerInfo->ChangeTeam");
 		pInfo->ChangeTeam(iTeamNum);
 	}
 } playerinfo_wrapper;
 
+static void fast_con_print(const char *message)
+{
+	COUNT_BRIDGE_CALL("FastConPrint");
+	META_CONPRINT(message);
+}
+
+static const char *fast_get_client_name(int client)
+{
+	COUNT_BRIDGE_CALL("FastGetClientName");
+	CPlayer *pPlayer = g_Players.GetPlayerByIndex(client);
+	if (!pPlayer || !pPlayer->IsConnected())
+		return NULL;
+	return pPlayer->GetName();
+}
+
+static const char *fast_get_client_convar_value(int client, const char *name)
+{
+	COUNT_BRIDGE_CALL("FastGetClientConVarValue");
+	return engine->GetClientConVarValue(client, name);
+}
+
+static const char *fast_get_cvar_string(ConVar *cvar)
+{
+	COUNT_BRIDGE_CALL("FastGetCvarString");
+	return cvar->GetString();
+}
+
 static ConVar sm_show_activity("sm_show_activity", "13", FCVAR_SPONLY, "Activity display setting (see sourcemod.cfg)");
 static ConVar sm_immunity_mode("sm_immunity_mode", "1", FCVAR_SPONLY, "Mode for deciding immunity protection");
 static ConVar sm_datetime_format("sm_datetime_format", "%m/%d/%Y - %H:%M:%S", 0, "Default formatting time rules");
@@ -334,6 +503,16 @@ static int get_global_target()
 	return g_SourceMod.GetGlobalTarget();
 }
 
+static void record_startup_step(const char *name, double ms)
+{
+	g_StartupTimeline.RecordStep(name, ms);
+}
+
+static size_t get_timer_count()
+{
+	return g_Timers.GetTimerCount();
+}
+
 void UTIL_ConsolePrintVa(const char *fmt, va_list ap)
 {
 	char buffer[512];
@@ -434,6 +613,13 @@ CoreProviderImpl::CoreProviderImpl()
 	this->UpdateAdminCmdFlags = update_admin_cmd_flags;
 	this->LookForCommandAdminFlags = look_for_cmd_admin_flags;
 	this->GetGlobalTarget = get_global_target;
+	this->RecordStartupStep = record_startup_step;
+	this->GetTimerCount = get_timer_count;
+	this->maxClients = g_Players.MaxClientsPtr();
+	this->FastConPrint = fast_con_print;
+	this->FastGetClientName = fast_get_client_name;
+	this->FastGetClientConVarValue = fast_get_client_convar_value;
+	this->FastGetCvarString = fast_get_cvar_string;
 	this->gamesuffix = GAMEFIX;
 	this->serverGlobals = &::serverGlobals;
 	this->listeners = nullptr;
@@ -441,16 +627,19 @@ CoreProviderImpl::CoreProviderImpl()
 
 ConVar *CoreProviderImpl::FindConVar(const char *name)
 {
+	COUNT_BRIDGE_CALL("bridge->FindConVar");
 	return icvar->FindVar(name);
 }
 
 const char *CoreProviderImpl::GetCvarString(ConVar* cvar)
 {
+	COUNT_BRIDGE_CALL("bridge->GetCvarString");
 	return cvar->GetString();
 }
 
 bool CoreProviderImpl::GetCvarBool(ConVar* cvar)
 {
+	COUNT_BRIDGE_CALL("bridge->GetCvarBool");
 	return cvar->GetBool();
 }
 
@@ -557,16 +746,19 @@ bool CoreProviderImpl::SymbolsAreHidden()
 
 void CoreProviderImpl::LogToGame(const char *message)
 {
+	COUNT_BRIDGE_CALL("bridge->LogToGame");
 	Engine_LogPrintWrapper(message);
 }
 
 void CoreProviderImpl::ConPrint(const char *message)
 {
+	COUNT_BRIDGE_CALL("bridge->ConPrint");
 	META_CONPRINT(message);
 }
 
 void CoreProviderImpl::ConsolePrint(const char *fmt, ...)
 {
+	COUNT_BRIDGE_CALL("bridge->ConsolePrint");
 	va_list ap;
 	va_start(ap, fmt);
 	UTIL_ConsolePrintVa(fmt, ap);
@@ -575,26 +767,31 @@ void CoreProviderImpl::ConsolePrint(const char *fmt, ...)
 
 void CoreProviderImpl::ConsolePrintVa(const char *message, va_list ap)
 {
+	COUNT_BRIDGE_CALL("bridge->ConsolePrintVa");
 	UTIL_ConsolePrintVa(message, ap);
 }
 
 bool CoreProviderImpl::IsMapLoading()
 {
+	COUNT_BRIDGE_CALL("bridge->IsMapLoading");
 	return g_SourceMod.IsMapLoading();
 }
 
 bool CoreProviderImpl::IsMapRunning()
 {
+	COUNT_BRIDGE_CALL("bridge->IsMapRunning");
 	return g_SourceMod.IsMapRunning();
 }
 
 int CoreProviderImpl::MaxClients()
 {
+	COUNT_BRIDGE_CALL("bridge->MaxClients");
 	return g_Players.MaxClients();
 }
 
 bool CoreProviderImpl::DescribePlayer(int entRef, const char **namep, const char **authp, int *useridp)
 {
+	COUNT_BRIDGE_CALL("bridge->DescribePlayer");
 	int index = entRef;
 	if (entRef & ENTREF_MASK)
 	{
@@ -645,11 +842,13 @@ void CoreProviderImpl::UnloadMMSPlugin(int id)
 
 bool CoreProviderImpl::IsClientConVarQueryingSupported()
 {
+	COUNT_BRIDGE_CALL("bridge->IsClientConVarQueryingSupported");
 	return hooks_.GetClientCvarQueryMode() != ClientCvarQueryMode::Unavailable;
 }
 
 int CoreProviderImpl::QueryClientConVar(int client, const char *cvar)
 {
+	COUNT_BRIDGE_CALL("bridge->QueryClientConVar");
 #if SOURCE_ENGINE != SE_DARKMESSIAH
 	switch (hooks_.GetClientCvarQueryMode()) {
 	case ClientCvarQueryMode::DLL:
@@ -98,6 +98,26 @@ public:
 	{
 	}
 
+	/**
+	 * @brief Return true if OnSourceModPreload() has work to do.
+	 */
+	virtual bool HasPreloadWork()
+	{
+		return false;
+	}
+
+	/**
+	 * @brief Called on its own thread after OnSourceModStartup, concurrently
+	 * with the preload work of other classes. OnSourceModAllInitialized is not
+	 * called until every preload has returned.
+	 *
+	 * Only self-contained work, such as parsing files into a cache, is safe
+	 * here; no other SourceMod service may be used.
+	 */
+	virtual void OnSourceModPreload()
+	{
+	}
+
 	/**
 	 * @brief Called after all global classes have been started up
 	 */
@@ -190,6 +210,15 @@ public:
 	virtual void OnSourceModMaxPlayersChanged(int newvalue)
 	{
 	}
+
+	/**
+	 * @brief Returns a name for the startup timeline, or NULL to have this
+	 * class counted with the other unnamed ones.
+	 */
+	virtual const char *GetGlobalClassName()
+	{
+		return NULL;
+	}
 public:
 	SMGlobalClass *m_pGlobalClassNext;
 	static SMGlobalClass *head;
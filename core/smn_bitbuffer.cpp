@@ -354,6 +354,48 @@ static cell_t smn_BfWriteAngles(IPluginContext *pCtx, const cell_t *params)
 	return 1;
 }
 
+static cell_t smn_BfWriteBytes(IPluginContext *pCtx, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError herr;
+	HandleSecurity sec;
+	bf_write *pBitBuf;
+
+	sec.pOwner = NULL;
+	sec.pIdentity = g_pCoreIdent;
+
+	if ((herr=handlesys->ReadHandle(hndl, g_WrBitBufType, &sec, (void **)&pBitBuf))
+		!= HandleError_None)
+	{
+		return pCtx->ThrowNativeError("Invalid bit buffer handle %x (error %d)", hndl, herr);
+	}
+
+	int count = params[3];
+	if (count < 0 || count > (pBitBuf->GetNumBitsLeft() >> 3))
+	{
+		return pCtx->ThrowNativeError("Cannot write %d bytes, only %d bytes left in buffer", count, pBitBuf->GetNumBitsLeft() >> 3);
+	}
+
+	cell_t *data;
+	pCtx->LocalToPhysAddr(params[2], &data);
+
+	/* Cells are narrowed to bytes in chunks so the buffer is only touched once per chunk. */
+	unsigned char chunk[256];
+	while (count > 0)
+	{
+		int len = (count > (int)sizeof(chunk)) ? (int)sizeof(chunk) : count;
+		for (int i = 0; i < len; i++)
+		{
+			chunk[i] = (unsigned char)data[i];
+		}
+		pBitBuf->WriteBytes(chunk, len);
+		data += len;
+		count -= len;
+	}
+
+	return 1;
+}
+
 static cell_t smn_BfReadBool(IPluginContext *pCtx, const cell_t *params)
 {
 	Handle_t hndl = static_cast<Handle_t>(params[1]);
@@ -662,6 +704,54 @@ static cell_t smn_BfReadAngles(IPluginContext *pCtx, const cell_t *params)
 	return 1;
 }
 
+static cell_t smn_BfReadBytes(IPluginContext *pCtx, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError herr;
+	HandleSecurity sec;
+	bf_read *pBitBuf;
+
+	sec.pOwner = NULL;
+	sec.pIdentity = g_pCoreIdent;
+
+	if ((herr=handlesys->ReadHandle(hndl, g_RdBitBufType, &sec, (void **)&pBitBuf))
+		!= HandleError_None)
+	{
+		return pCtx->ThrowNativeError("Invalid bit buffer handle %x (error %d)", hndl, herr);
+	}
+
+	int count = params[3];
+	if (count < 0)
+	{
+		return pCtx->ThrowNativeError("Invalid byte count %d", count);
+	}
+
+	int left = pBitBuf->GetNumBitsLeft() >> 3;
+	if (count > left)
+	{
+		count = left;
+	}
+
+	cell_t *data;
+	pCtx->LocalToPhysAddr(params[2], &data);
+
+	int total = count;
+	unsigned char chunk[256];
+	while (count > 0)
+	{
+		int len = (count > (int)sizeof(chunk)) ? (int)sizeof(chunk) : count;
+		pBitBuf->ReadBytes(chunk, len);
+		for (int i = 0; i < len; i++)
+		{
+			data[i] = chunk[i];
+		}
+		data += len;
+		count -= len;
+	}
+
+	return total;
+}
+
 static cell_t smn_BfGetNumBytesLeft(IPluginContext *pCtx, const cell_t *params)
 {
 	Handle_t hndl = static_cast<Handle_t>(params[1]);
@@ -728,6 +818,7 @@ REGISTER_NATIVES(bitbufnatives)
 	{"BfWrite.WriteVecCoord",	smn_BfWriteVecCoord},
 	{"BfWrite.WriteVecNormal",	smn_BfWriteVecNormal},
 	{"BfWrite.WriteAngles",		smn_BfWriteAngles},
+	{"BfWrite.WriteBytes",		smn_BfWriteBytes},
 
 	{"BfRead.ReadBool",			smn_BfReadBool},
 	{"BfRead.ReadByte",			smn_BfReadByte},
@@ -743,6 +834,7 @@ REGISTER_NATIVES(bitbufnatives)
 	{"BfRead.ReadVecCoord",		smn_BfReadVecCoord},
 	{"BfRead.ReadVecNormal",	smn_BfReadVecNormal},
 	{"BfRead.ReadAngles",		smn_BfReadAngles},
+	{"BfRead.ReadBytes",		smn_BfReadBytes},
 	{"BfRead.BytesLeft.get",	smn_BfGetNumBytesLeft},
 
 	{NULL,						NULL}
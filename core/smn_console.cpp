@@ -191,8 +191,7 @@ private:
 		}
 		static inline uint32_t hash(const detail::CharsAndLength &key)
 		{
-			std::string lower = ke::Lowercase(key.c_str());
-			return detail::CharsAndLength(lower.c_str()).hash();
+			return key.foldedHash();
 		}
 	};
 	NameHashSet<ConCommandBase *, ConCommandPolicy> m_CmdFlags;
@@ -279,6 +278,73 @@ static cell_t sm_FindConVar(IPluginContext *pContext, const cell_t *params)
 	return g_ConVarManager.FindConVar(name);
 }
 
+static cell_t ChangeHook(IPluginContext *pContext, const cell_t *params, bool hook, bool deferred)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError err;
+	ConVar *pConVar;
+
+	if ((err=g_ConVarManager.ReadConVarHandle(hndl, &pConVar))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid convar handle %x (error %d)", hndl, err);
+	}
+
+	IPluginFunction *pFunction = pContext->GetFunctionById(params[2]);
+
+	if (!pFunction)
+	{
+		return pContext->ThrowNativeError("Invalid function id (%X)", params[2]);
+	}
+
+	if (hook)
+	{
+		g_ConVarManager.HookConVarChange(pConVar, pFunction, deferred);
+	}
+	else
+	{
+		g_ConVarManager.UnhookConVarChange(pConVar, pFunction, deferred);
+	}
+
+	return 1;
+}
+
+static cell_t ConVar_AddDeferredChangeHook(IPluginContext *pContext, const cell_t *params)
+{
+	return ChangeHook(pContext, params, true, true);
+}
+
+static cell_t ConVar_RemoveDeferredChangeHook(IPluginContext *pContext, const cell_t *params)
+{
+	return ChangeHook(pContext, params, false, true);
+}
+
+static cell_t AddConVarBatchChangeHook(IPluginContext *pContext, const cell_t *params)
+{
+	IPluginFunction *pFunction = pContext->GetFunctionById(params[1]);
+
+	if (!pFunction)
+	{
+		return pContext->ThrowNativeError("Invalid function id (%X)", params[1]);
+	}
+
+	g_ConVarManager.AddBatchChangeHook(pFunction);
+
+	return 1;
+}
+
+static cell_t RemoveConVarBatchChangeHook(IPluginContext *pContext, const cell_t *params)
+{
+	IPluginFunction *pFunction = pContext->GetFunctionById(params[1]);
+
+	if (!pFunction)
+	{
+		return pContext->ThrowNativeError("Invalid function id (%X)", params[1]);
+	}
+
+	return g_ConVarManager.RemoveBatchChangeHook(pFunction) ? 1 : 0;
+}
+
 static cell_t sm_HookConVarChange(IPluginContext *pContext, const cell_t *params)
 {
 	Handle_t hndl = static_cast<Handle_t>(params[1]);
@@ -327,6 +393,86 @@ static cell_t sm_UnhookConVarChange(IPluginContext *pContext, const cell_t *para
 	return 1;
 }
 
+/* Bound variables are written long after the bind returns, so they must be globals: the
+ * range has to lie inside the plugin's data section, which ends where its heap begins.
+ */
+static bool IsGlobalAddress(IPluginContext *pContext, cell_t addr, size_t bytes)
+{
+	IPlugin *pPlugin = scripts->FindPluginByContext(pContext->GetContext());
+	void *dataEnd;
+	if (!pPlugin || !pPlugin->GetProperty("DataSectionEnd", &dataEnd))
+	{
+		return false;
+	}
+
+	size_t size = (size_t)(uintptr_t)dataEnd;
+	return addr >= 0 && bytes <= size && (size_t)addr <= size - bytes;
+}
+
+static cell_t BindConVarValue(IPluginContext *pContext, const cell_t *params, ConVarBindType type, size_t maxlength)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError err;
+	ConVar *pConVar;
+
+	if ((err=g_ConVarManager.ReadConVarHandle(hndl, &pConVar))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid convar handle %x (error %d)", hndl, err);
+	}
+
+	if (!IsGlobalAddress(pContext, params[2], (type == ConVarBind_String) ? maxlength : sizeof(cell_t)))
+	{
+		return pContext->ThrowNativeError("Only global variables can be bound to a convar");
+	}
+
+	g_ConVarManager.BindConVar(pConVar, pContext, params[2], type, maxlength);
+
+	return 1;
+}
+
+static cell_t ConVar_BindBool(IPluginContext *pContext, const cell_t *params)
+{
+	return BindConVarValue(pContext, params, ConVarBind_Bool, 0);
+}
+
+static cell_t ConVar_BindInt(IPluginContext *pContext, const cell_t *params)
+{
+	return BindConVarValue(pContext, params, ConVarBind_Int, 0);
+}
+
+static cell_t ConVar_BindFloat(IPluginContext *pContext, const cell_t *params)
+{
+	return BindConVarValue(pContext, params, ConVarBind_Float, 0);
+}
+
+static cell_t ConVar_BindString(IPluginContext *pContext, const cell_t *params)
+{
+	if (params[3] <= 0)
+	{
+		return pContext->ThrowNativeError("Invalid buffer size %d", params[3]);
+	}
+
+	return BindConVarValue(pContext, params, ConVarBind_String, params[3]);
+}
+
+static cell_t ConVar_Unbind(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError err;
+	ConVar *pConVar;
+
+	if ((err=g_ConVarManager.ReadConVarHandle(hndl, &pConVar))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid convar handle %x (error %d)", hndl, err);
+	}
+
+	g_ConVarManager.UnbindConVar(pConVar, pContext);
+
+	return 1;
+}
+
 static cell_t sm_GetConVarBool(IPluginContext *pContext, const cell_t *params)
 {
 	Handle_t hndl = static_cast<Handle_t>(params[1]);
@@ -730,6 +876,106 @@ static cell_t sm_QueryClientConVar(IPluginContext *pContext, const cell_t *param
 	return g_ConVarManager.QueryClientConVar(pPlayer->GetEdict(), name, pCallback, params[4]);
 }
 
+static cell_t sm_QueryClientConVarBatch(IPluginContext *pContext, const cell_t *params)
+{
+	if (!g_ConVarManager.IsQueryingSupported())
+	{
+		if (!s_QueryAlreadyWarned)
+		{
+			s_QueryAlreadyWarned = true;
+			return pContext->ThrowNativeError("Game does not support client convar querying (one time warning)");
+		}
+
+		return 0;
+	}
+
+	cell_t *clients, *names;
+	cell_t numClients = params[2];
+	cell_t numCvars = params[4];
+
+	if (numClients < 0)
+	{
+		return pContext->ThrowNativeError("Invalid client count %d", numClients);
+	}
+	if (numCvars < 1)
+	{
+		return pContext->ThrowNativeError("Invalid convar count %d", numCvars);
+	}
+
+	pContext->LocalToPhysAddr(params[1], &clients);
+	pContext->LocalToPhysAddr(params[3], &names);
+
+	IPluginFunction *pCallback = pContext->GetFunctionById(params[5]);
+	if (!pCallback)
+	{
+		return pContext->ThrowNativeError("Invalid function id (%X)", params[5]);
+	}
+
+	/* Older runtimes store each char[][] slot as an offset from the slot itself */
+	std::vector<const char *> cvarNames(numCvars);
+	for (cell_t i = 0; i < numCvars; i++)
+	{
+		cell_t addr = names[i];
+		if (!pContext->GetRuntime()->UsesDirectArrays())
+		{
+			addr += params[3] + i * sizeof(cell_t);
+		}
+
+		char *name;
+		if (pContext->LocalToString(addr, &name) != SP_ERROR_NONE)
+		{
+			return pContext->ThrowNativeError("Invalid convar name at index %d", i);
+		}
+		cvarNames[i] = name;
+	}
+
+	cell_t started = 0;
+	for (cell_t i = 0; i < numClients; i++)
+	{
+		CPlayer *pPlayer = g_Players.GetPlayerByIndex(clients[i]);
+		if (!pPlayer)
+		{
+			return pContext->ThrowNativeError("Client index %d is invalid", clients[i]);
+		}
+		if (!pPlayer->IsConnected())
+		{
+			return pContext->ThrowNativeError("Client %d is not connected", clients[i]);
+		}
+
+		/* Trying a query on a bot results in callback not be fired, so don't bother */
+		if (pPlayer->IsFakeClient())
+		{
+			continue;
+		}
+
+		if (g_ConVarManager.QueryClientConVarBatch(clients[i], cvarNames.data(), numCvars, pCallback, params[6]))
+		{
+			started++;
+		}
+	}
+
+	return started;
+}
+
+static cell_t sm_GetConVarQueryBatchValue(IPluginContext *pContext, const cell_t *params)
+{
+	const ConVarQueryBatch *pBatch = g_ConVarManager.GetCurrentQueryBatch();
+	if (!pBatch)
+	{
+		return pContext->ThrowNativeError("No convar query batch callback is running");
+	}
+
+	cell_t index = params[1];
+	if (index < 0 || (size_t)index >= pBatch->results.size())
+	{
+		return pContext->ThrowNativeError("Invalid convar index %d", index);
+	}
+
+	pContext->StringToLocalUTF8(params[2], params[3], pBatch->values[index].c_str(), NULL);
+
+	return pBatch->results[index];
+}
+
 static cell_t sm_RegServerCmd(IPluginContext *pContext, const cell_t *params)
 {
 	char *name,*help;
@@ -1531,6 +1777,8 @@ REGISTER_NATIVES(consoleNatives)
 	{"FindConVar",			sm_FindConVar},
 	{"HookConVarChange",	sm_HookConVarChange},
 	{"UnhookConVarChange",	sm_UnhookConVarChange},
+	{"AddConVarBatchChangeHook",	AddConVarBatchChangeHook},
+	{"RemoveConVarBatchChangeHook",	RemoveConVarBatchChangeHook},
 	{"GetConVarBool",		sm_GetConVarBool},
 	{"SetConVarBool",		sm_SetConVarNum},
 	{"GetConVarInt",		sm_GetConVarInt},
@@ -1546,6 +1794,8 @@ REGISTER_NATIVES(consoleNatives)
 	{"GetConVarBounds",		sm_GetConVarBounds},
 	{"SetConVarBounds",		sm_SetConVarBounds},
 	{"QueryClientConVar",	sm_QueryClientConVar},
+	{"QueryClientConVarBatch",	sm_QueryClientConVarBatch},
+	{"GetConVarQueryBatchValue",	sm_GetConVarQueryBatchValue},
 	{"GetConVarDefault",	GetConVarDefault},
 	{"RegServerCmd",		sm_RegServerCmd},
 	{"RegConsoleCmd",		sm_RegConsoleCmd},
@@ -1593,6 +1843,13 @@ REGISTER_NATIVES(consoleNatives)
 	{"ConVar.ReplicateToClient",	ConVar_ReplicateToClient},
 	{"ConVar.AddChangeHook",	sm_HookConVarChange},
 	{"ConVar.RemoveChangeHook",	sm_UnhookConVarChange},
+	{"ConVar.AddDeferredChangeHook",	ConVar_AddDeferredChangeHook},
+	{"ConVar.RemoveDeferredChangeHook",	ConVar_RemoveDeferredChangeHook},
+	{"ConVar.BindBool",			ConVar_BindBool},
+	{"ConVar.BindInt",			ConVar_BindInt},
+	{"ConVar.BindFloat",		ConVar_BindFloat},
+	{"ConVar.BindString",		ConVar_BindString},
+	{"ConVar.Unbind",			ConVar_Unbind},
 
 	{"CommandIterator.CommandIterator",	sm_CommandIterator},
 	{"CommandIterator.Next",		sm_CommandIteratorNext},
@@ -37,6 +37,8 @@
 #include <IGameConfigs.h>
 #include "sm_stringutil.h"
 #include "logic_bridge.h"
+#include <limits.h>
+#include <string>
 
 // These values need to mirror the values in entity_prop_stocks
 #define ENTFLAG_ONGROUND		(1 << 0)
@@ -2776,6 +2778,640 @@ static cell_t GetEntityAddress(IPluginContext *pContext, const cell_t *params)
 	return reinterpret_cast<uintptr_t>(pEntity);
 }
 
+/**
+ * A PropAccessor names a property once and remembers where it lives for the
+ * class it was last used on, so hot reads skip the SendProp/datamap name
+ * lookups entirely. The cache is keyed on the entity's ServerClass (for
+ * Prop_Send) or datamap (for Prop_Data); using the accessor on another class
+ * re-resolves it, and flushing HL2's prop caches invalidates it.
+ */
+enum PropAccessorKind
+{
+	PropAccessor_Int = 0,
+	PropAccessor_Float,
+	PropAccessor_Ent,
+};
+
+struct PropAccessor
+{
+	PropType type;
+	PropAccessorKind kind;
+	std::string prop;
+	int element;
+	int size;
+
+	/* Resolved descriptor, valid while |key| and |serial| match. */
+	void *key;
+	unsigned int serial;
+	int offset;
+	int bit_count;
+	bool is_unsigned;
+	bool can_set;
+	PropEntType ent_type;
+};
+
+HandleType_t g_PropAccessorType = 0;
+
+class PropAccessorHelpers :
+	public SMGlobalClass,
+	public IHandleTypeDispatch
+{
+public: //SMGlobalClass
+	void OnSourceModAllInitialized()
+	{
+		g_PropAccessorType = handlesys->CreateType("PropAccessor", this, 0, NULL, NULL, g_pCoreIdent, NULL);
+	}
+	void OnSourceModShutdown()
+	{
+		handlesys->RemoveType(g_PropAccessorType, g_pCoreIdent);
+		g_PropAccessorType = 0;
+	}
+public: //IHandleTypeDispatch
+	void OnHandleDestroy(HandleType_t type, void *object)
+	{
+		delete (PropAccessor *)object;
+	}
+	bool GetHandleApproxSize(HandleType_t type, void *object, unsigned int *pSize)
+	{
+		*pSize = sizeof(PropAccessor) + ((PropAccessor *)object)->prop.size();
+		return true;
+	}
+} s_PropAccessorHelpers;
+
+static inline void *GetPropAccessorKey(PropAccessor *acc, CBaseEntity *pEntity)
+{
+	if (acc->type == Prop_Send)
+	{
+		return g_HL2.FindEntityServerClass(pEntity);
+	}
+	return CBaseEntity_GetDataDescMap(pEntity);
+}
+
+/* Resolves |acc| against the class of |pEntity|. Returns 0 after throwing on failure. */
+static cell_t ResolvePropAccessor(IPluginContext *pContext, cell_t entref, CBaseEntity *pEntity, PropAccessor *acc, void *key)
+{
+	/* The FIND_PROP_* macros report params[1] as the entity. */
+	const cell_t params[2] = {1, entref};
+	const char *prop = acc->prop.c_str();
+	int element = acc->element;
+	int offset;
+	int bit_count = 0;
+	bool is_unsigned = false;
+	PropEntType ent_type = PropEnt_Unknown;
+
+	if (!key)
+	{
+		return pContext->ThrowNativeError("Could not retrieve %s for entity %d (%d)",
+			(acc->type == Prop_Send) ? "server class" : "datamap",
+			g_HL2.ReferenceToIndex(params[1]),
+			params[1]);
+	}
+
+	if (acc->type == Prop_Data)
+	{
+		typedescription_t *td;
+
+		FIND_PROP_DATA(td);
+
+		if (td->fieldType == FIELD_CUSTOM && (td->flags & FTYPEDESC_OUTPUT) == FTYPEDESC_OUTPUT)
+		{
+			return pContext->ThrowNativeError("Data field %s is a variant, which accessors do not support", prop);
+		}
+
+		switch (acc->kind)
+		{
+		case PropAccessor_Int:
+			{
+				if ((bit_count = MatchTypeDescAsInteger(td->fieldType, td->flags)) == 0)
+				{
+					return pContext->ThrowNativeError("Data field %s is not an integer (%d)",
+						prop,
+						td->fieldType);
+				}
+				break;
+			}
+		case PropAccessor_Float:
+			{
+				if (td->fieldType != FIELD_FLOAT && td->fieldType != FIELD_TIME)
+				{
+					return pContext->ThrowNativeError("Data field %s is not a float (%d != [%d,%d])",
+						prop,
+						td->fieldType,
+						FIELD_FLOAT,
+						FIELD_TIME);
+				}
+				break;
+			}
+		case PropAccessor_Ent:
+			{
+				switch (td->fieldType)
+				{
+				case FIELD_EHANDLE:
+					ent_type = PropEnt_Handle;
+					break;
+				case FIELD_CLASSPTR:
+					ent_type = PropEnt_Entity;
+					break;
+				case FIELD_EDICT:
+					ent_type = PropEnt_Edict;
+					break;
+				}
+
+				if (ent_type == PropEnt_Unknown)
+				{
+					return pContext->ThrowNativeError("Data field %s is not an entity nor edict (%d)",
+						prop,
+						td->fieldType);
+				}
+				break;
+			}
+		}
+
+		CHECK_SET_PROP_DATA_OFFSET();
+	}
+	else if (acc->kind == PropAccessor_Float)
+	{
+		FIND_PROP_SEND(DPT_Float, "float");
+	}
+	else
+	{
+		FIND_PROP_SEND(DPT_Int, "integer");
+		is_unsigned = ((pProp->GetFlags() & SPROP_UNSIGNED) == SPROP_UNSIGNED);
+		ent_type = PropEnt_Handle;
+
+#if SOURCE_ENGINE == SE_CSS || SOURCE_ENGINE == SE_HL2DM || SOURCE_ENGINE == SE_DODS \
+	|| SOURCE_ENGINE == SE_BMS || SOURCE_ENGINE == SE_SDK2013 || SOURCE_ENGINE == SE_TF2 \
+	|| SOURCE_ENGINE == SE_CSGO || SOURCE_ENGINE == SE_BLADE || SOURCE_ENGINE == SE_PVKII \
+	|| SOURCE_ENGINE == SE_MCV
+		if (pProp->GetFlags() & SPROP_VARINT)
+		{
+			bit_count = sizeof(int) * 8;
+		}
+#endif
+	}
+
+	if (bit_count < 1)
+	{
+		bit_count = acc->size * 8;
+	}
+
+	acc->key = key;
+	acc->serial = g_HL2.GetPropCacheSerial();
+	acc->offset = offset;
+	acc->bit_count = bit_count;
+	acc->is_unsigned = is_unsigned;
+	acc->can_set = (acc->type != Prop_Send || CanSetPropName(prop));
+	acc->ent_type = ent_type;
+
+	return 1;
+}
+
+static PropAccessor *ReadPropAccessor(IPluginContext *pContext, Handle_t hndl)
+{
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), g_pCoreIdent);
+
+	PropAccessor *acc;
+	if ((err = handlesys->ReadHandle(hndl, g_PropAccessorType, &sec, (void **)&acc))
+		!= HandleError_None)
+	{
+		pContext->ReportError("Invalid PropAccessor handle %x (error %d)", hndl, err);
+		return NULL;
+	}
+
+	return acc;
+}
+
+/* Makes sure |acc| is resolved for the class of |pEntity|. Returns false after throwing on failure. */
+static inline bool BindPropAccessor(IPluginContext *pContext, cell_t entref, CBaseEntity *pEntity, PropAccessor *acc)
+{
+	void *key = GetPropAccessorKey(acc, pEntity);
+	if (key == acc->key && acc->serial == g_HL2.GetPropCacheSerial())
+	{
+		return true;
+	}
+
+	return ResolvePropAccessor(pContext, entref, pEntity, acc, key) != 0;
+}
+
+/* Reads the value |acc| describes. Floats are returned as their cell bits. */
+static cell_t ReadPropAccessorValue(PropAccessor *acc, CBaseEntity *pEntity)
+{
+	uint8_t *addr = (uint8_t *)pEntity + acc->offset;
+
+	switch (acc->kind)
+	{
+	case PropAccessor_Int:
+		{
+			if (acc->bit_count >= 17)
+			{
+				return *(int32_t *)addr;
+			}
+			else if (acc->bit_count >= 9)
+			{
+				return acc->is_unsigned ? *(uint16_t *)addr : *(int16_t *)addr;
+			}
+			else if (acc->bit_count >= 2)
+			{
+				return acc->is_unsigned ? *(uint8_t *)addr : *(int8_t *)addr;
+			}
+
+			return *(bool *)addr ? 1 : 0;
+		}
+	case PropAccessor_Float:
+		{
+			return sp_ftoc(*(float *)addr);
+		}
+	case PropAccessor_Ent:
+		{
+			switch (acc->ent_type)
+			{
+			case PropEnt_Handle:
+				{
+					CBaseHandle *hndl = (CBaseHandle *)addr;
+					CBaseEntity *pHandleEntity = g_HL2.ReferenceToEntity(hndl->GetEntryIndex());
+
+					if (!pHandleEntity || *hndl != reinterpret_cast<IHandleEntity *>(pHandleEntity)->GetRefEHandle())
+						return -1;
+
+					return g_HL2.EntityToBCompatRef(pHandleEntity);
+				}
+			case PropEnt_Entity:
+				{
+					return g_HL2.EntityToBCompatRef(*(CBaseEntity **)addr);
+				}
+			case PropEnt_Edict:
+				{
+					edict_t *pOtherEdict = *(edict_t **)addr;
+					if (!pOtherEdict || pOtherEdict->IsFree())
+						return -1;
+
+					return IndexOfEdict(pOtherEdict);
+				}
+			default:
+				break;
+			}
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Stores the value |acc| describes. Returns false after throwing on failure.
+ * The caller is responsible for marking the edict as changed.
+ */
+static bool WritePropAccessorValue(IPluginContext *pContext, PropAccessor *acc, CBaseEntity *pEntity, cell_t value)
+{
+	if (!acc->can_set)
+	{
+		pContext->ReportError("Cannot set %s with \"FollowCSGOServerGuidelines\" option enabled.", acc->prop.c_str());
+		return false;
+	}
+
+	uint8_t *addr = (uint8_t *)pEntity + acc->offset;
+
+	switch (acc->kind)
+	{
+	case PropAccessor_Int:
+		{
+			if (acc->bit_count >= 17)
+			{
+				*(int32_t *)addr = value;
+			}
+			else if (acc->bit_count >= 9)
+			{
+				*(int16_t *)addr = (int16_t)value;
+			}
+			else if (acc->bit_count >= 2)
+			{
+				*(int8_t *)addr = (int8_t)value;
+			}
+			else
+			{
+				*(bool *)addr = value ? true : false;
+			}
+			break;
+		}
+	case PropAccessor_Float:
+		{
+			*(float *)addr = sp_ctof(value);
+			break;
+		}
+	case PropAccessor_Ent:
+		{
+			CBaseEntity *pOther = GetEntity(value);
+			if (!pOther && value != -1)
+			{
+				pContext->ReportError("Entity %d (%d) is invalid", g_HL2.ReferenceToIndex(value), value);
+				return false;
+			}
+
+			switch (acc->ent_type)
+			{
+			case PropEnt_Handle:
+				{
+					((CBaseHandle *)addr)->Set((IHandleEntity *)pOther);
+					break;
+				}
+			case PropEnt_Entity:
+				{
+					*(CBaseEntity **)addr = pOther;
+					break;
+				}
+			case PropEnt_Edict:
+				{
+					edict_t *pOtherEdict = NULL;
+					if (pOther)
+					{
+						pOtherEdict = BaseEntityToEdict(pOther);
+						if (!pOtherEdict || pOtherEdict->IsFree())
+						{
+							pContext->ReportError("Entity %d (%d) does not have a valid edict", g_HL2.ReferenceToIndex(value), value);
+							return false;
+						}
+					}
+
+					*(edict_t **)addr = pOtherEdict;
+					break;
+				}
+			default:
+				break;
+			}
+			break;
+		}
+	}
+
+	return true;
+}
+
+static cell_t CreatePropAccessor(IPluginContext *pContext, const cell_t *params)
+{
+	if (params[1] != Prop_Send && params[1] != Prop_Data)
+	{
+		return pContext->ThrowNativeError("Invalid Property type %d", params[1]);
+	}
+
+	if (params[3] < PropAccessor_Int || params[3] > PropAccessor_Ent)
+	{
+		return pContext->ThrowNativeError("Invalid accessor value type %d", params[3]);
+	}
+
+	char *prop;
+	pContext->LocalToString(params[2], &prop);
+
+	PropAccessor *acc = new PropAccessor;
+	acc->type = (PropType)params[1];
+	acc->kind = (PropAccessorKind)params[3];
+	acc->prop = prop;
+	acc->element = params[4];
+	acc->size = params[5];
+	acc->key = NULL;
+	acc->serial = 0;
+	acc->offset = 0;
+	acc->bit_count = 0;
+	acc->is_unsigned = false;
+	acc->can_set = false;
+	acc->ent_type = PropEnt_Unknown;
+
+	Handle_t hndl = handlesys->CreateHandle(g_PropAccessorType, acc, pContext->GetIdentity(), g_pCoreIdent, NULL);
+	if (hndl == BAD_HANDLE)
+	{
+		delete acc;
+	}
+
+	return hndl;
+}
+
+static cell_t GetEntPropAccessor(IPluginContext *pContext, const cell_t *params, PropAccessorKind kind)
+{
+	CBaseEntity *pEntity;
+	edict_t *pEdict;
+	if (!IndexToAThings(params[1], &pEntity, &pEdict))
+	{
+		return pContext->ThrowNativeError("Entity %d (%d) is invalid", g_HL2.ReferenceToIndex(params[1]), params[1]);
+	}
+
+	PropAccessor *acc = ReadPropAccessor(pContext, params[2]);
+	if (!acc)
+	{
+		return 0;
+	}
+
+	if (acc->kind != kind)
+	{
+		return pContext->ThrowNativeError("PropAccessor for %s was created for another value type (%d != %d)", acc->prop.c_str(), acc->kind, kind);
+	}
+
+	if (!BindPropAccessor(pContext, params[1], pEntity, acc))
+	{
+		return 0;
+	}
+
+	return ReadPropAccessorValue(acc, pEntity);
+}
+
+static cell_t SetEntPropAccessor(IPluginContext *pContext, const cell_t *params, PropAccessorKind kind)
+{
+	CBaseEntity *pEntity;
+	edict_t *pEdict;
+	if (!IndexToAThings(params[1], &pEntity, &pEdict))
+	{
+		return pContext->ThrowNativeError("Entity %d (%d) is invalid", g_HL2.ReferenceToIndex(params[1]), params[1]);
+	}
+
+	PropAccessor *acc = ReadPropAccessor(pContext, params[2]);
+	if (!acc)
+	{
+		return 0;
+	}
+
+	if (acc->kind != kind)
+	{
+		return pContext->ThrowNativeError("PropAccessor for %s was created for another value type (%d != %d)", acc->prop.c_str(), acc->kind, kind);
+	}
+
+	if (!BindPropAccessor(pContext, params[1], pEntity, acc)
+		|| !WritePropAccessorValue(pContext, acc, pEntity, params[3]))
+	{
+		return 0;
+	}
+
+	if (acc->type == Prop_Send && (pEdict != NULL))
+	{
+		g_HL2.SetEdictStateChanged(pEdict, acc->offset);
+	}
+
+	return 1;
+}
+
+static cell_t GetEntPropFast(IPluginContext *pContext, const cell_t *params)
+{
+	return GetEntPropAccessor(pContext, params, PropAccessor_Int);
+}
+
+static cell_t SetEntPropFast(IPluginContext *pContext, const cell_t *params)
+{
+	return SetEntPropAccessor(pContext, params, PropAccessor_Int);
+}
+
+static cell_t GetEntPropFloatFast(IPluginContext *pContext, const cell_t *params)
+{
+	return GetEntPropAccessor(pContext, params, PropAccessor_Float);
+}
+
+static cell_t SetEntPropFloatFast(IPluginContext *pContext, const cell_t *params)
+{
+	return SetEntPropAccessor(pContext, params, PropAccessor_Float);
+}
+
+static cell_t GetEntPropEntFast(IPluginContext *pContext, const cell_t *params)
+{
+	return GetEntPropAccessor(pContext, params, PropAccessor_Ent);
+}
+
+static cell_t SetEntPropEntFast(IPluginContext *pContext, const cell_t *params)
+{
+	return SetEntPropAccessor(pContext, params, PropAccessor_Ent);
+}
+
+#define MAX_BULK_PROP_ACCESSORS		64
+
+/**
+ * Validates the entity list, accessor list and value buffer of a bulk prop
+ * native and reads the accessor handles into |accs|. Returns false after
+ * throwing on failure.
+ */
+static bool ReadBulkPropArgs(IPluginContext *pContext, const cell_t *params, cell_t **entities, PropAccessor **accs, cell_t **values)
+{
+	cell_t numEntities = params[2];
+	cell_t numAccessors = params[4];
+
+	if (numEntities < 0)
+	{
+		pContext->ReportError("Invalid entity count %d", numEntities);
+		return false;
+	}
+	if (numAccessors < 0 || numAccessors > MAX_BULK_PROP_ACCESSORS)
+	{
+		pContext->ReportError("Invalid accessor count %d (max %d)", numAccessors, MAX_BULK_PROP_ACCESSORS);
+		return false;
+	}
+
+	cell_t *handles, *last;
+	size_t cells = (size_t)numEntities * numAccessors;
+	if (pContext->LocalToPhysAddr(params[1], entities) != SP_ERROR_NONE
+		|| (numEntities && pContext->LocalToPhysAddr(params[1] + (numEntities - 1) * sizeof(cell_t), &last) != SP_ERROR_NONE)
+		|| pContext->LocalToPhysAddr(params[3], &handles) != SP_ERROR_NONE
+		|| (numAccessors && pContext->LocalToPhysAddr(params[3] + (numAccessors - 1) * sizeof(cell_t), &last) != SP_ERROR_NONE)
+		|| cells > INT_MAX / sizeof(cell_t)
+		|| pContext->LocalToPhysAddr(params[5], values) != SP_ERROR_NONE
+		|| (cells && pContext->LocalToPhysAddr(params[5] + (cell_t)((cells - 1) * sizeof(cell_t)), &last) != SP_ERROR_NONE))
+	{
+		pContext->ReportError("Buffers are too small for %d entities and %d accessors", numEntities, numAccessors);
+		return false;
+	}
+
+	for (cell_t i = 0; i < numAccessors; i++)
+	{
+		if ((accs[i] = ReadPropAccessor(pContext, handles[i])) == NULL)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static cell_t GetEntPropsFast(IPluginContext *pContext, const cell_t *params)
+{
+	cell_t *entities, *values;
+	PropAccessor *accs[MAX_BULK_PROP_ACCESSORS];
+	if (!ReadBulkPropArgs(pContext, params, &entities, accs, &values))
+	{
+		return 0;
+	}
+
+	cell_t numEntities = params[2];
+	cell_t numAccessors = params[4];
+	cell_t read = 0;
+
+	for (cell_t i = 0; i < numEntities; i++)
+	{
+		CBaseEntity *pEntity;
+		edict_t *pEdict;
+		if (!IndexToAThings(entities[i], &pEntity, &pEdict))
+		{
+			continue;
+		}
+
+		cell_t *row = &values[i * numAccessors];
+		for (cell_t j = 0; j < numAccessors; j++)
+		{
+			if (!BindPropAccessor(pContext, entities[i], pEntity, accs[j]))
+			{
+				return 0;
+			}
+			row[j] = ReadPropAccessorValue(accs[j], pEntity);
+		}
+		read++;
+	}
+
+	return read;
+}
+
+static cell_t SetEntPropsFast(IPluginContext *pContext, const cell_t *params)
+{
+	cell_t *entities, *values;
+	PropAccessor *accs[MAX_BULK_PROP_ACCESSORS];
+	if (!ReadBulkPropArgs(pContext, params, &entities, accs, &values))
+	{
+		return 0;
+	}
+
+	cell_t numEntities = params[2];
+	cell_t numAccessors = params[4];
+	cell_t written = 0;
+
+	for (cell_t i = 0; i < numEntities; i++)
+	{
+		CBaseEntity *pEntity;
+		edict_t *pEdict;
+		if (!IndexToAThings(entities[i], &pEntity, &pEdict))
+		{
+			continue;
+		}
+
+		int changed = 0;
+		int changed_offset = 0;
+		cell_t *row = &values[i * numAccessors];
+		for (cell_t j = 0; j < numAccessors; j++)
+		{
+			if (!BindPropAccessor(pContext, entities[i], pEntity, accs[j])
+				|| !WritePropAccessorValue(pContext, accs[j], pEntity, row[j]))
+			{
+				return 0;
+			}
+
+			if (accs[j]->type == Prop_Send)
+			{
+				changed++;
+				changed_offset = accs[j]->offset;
+			}
+		}
+
+		/* One networked field can be flagged precisely; several are flagged as a full change. */
+		if (changed && pEdict != NULL)
+		{
+			g_HL2.SetEdictStateChanged(pEdict, (changed == 1) ? changed_offset : 0);
+		}
+		written++;
+	}
+
+	return written;
+}
+
 REGISTER_NATIVES(entityNatives)
 {
 	{"ChangeEdictState",		ChangeEdictState},
@@ -2823,5 +3459,14 @@ REGISTER_NATIVES(entityNatives)
 	{"FindDataMapInfo",		FindDataMapInfo},
 	{"LoadEntityFromHandleAddress",	LoadEntityFromHandleAddress},
 	{"StoreEntityToHandleAddress",	StoreEntityToHandleAddress},
+	{"PropAccessor.PropAccessor",	CreatePropAccessor},
+	{"GetEntPropFast",			GetEntPropFast},
+	{"SetEntPropFast",			SetEntPropFast},
+	{"GetEntPropFloatFast",		GetEntPropFloatFast},
+	{"SetEntPropFloatFast",		SetEntPropFloatFast},
+	{"GetEntPropEntFast",		GetEntPropEntFast},
+	{"SetEntPropEntFast",		SetEntPropEntFast},
+	{"GetEntPropsFast",			GetEntPropsFast},
+	{"SetEntPropsFast",			SetEntPropsFast},
 	{NULL,						NULL}
 };
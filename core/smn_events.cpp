@@ -77,6 +77,52 @@ static cell_t sm_HookEventEx(IPluginContext *pContext, const cell_t *params)
 	return 1;
 }
 
+static cell_t sm_HookEventFiltered(IPluginContext *pContext, const cell_t *params)
+{
+	char *name, *key, *str;
+	IPluginFunction *pFunction;
+
+	pContext->LocalToString(params[1], &name);
+	pFunction = pContext->GetFunctionById(params[2]);
+
+	if (!pFunction)
+	{
+		return pContext->ThrowNativeError("Invalid function id (%X)", params[2]);
+	}
+
+	EventFilter filter;
+	switch (params[5])
+	{
+	case EventFilter_Equals:
+	case EventFilter_StringEquals:
+	case EventFilter_IsClient:
+	case EventFilter_NonZero:
+		filter.type = static_cast<EventFilterType>(params[5]);
+		break;
+	default:
+		return pContext->ThrowNativeError("Invalid event filter type %d", params[5]);
+	}
+
+	pContext->LocalToString(params[4], &key);
+	pContext->LocalToString(params[7], &str);
+	filter.key = key;
+	filter.value = params[6];
+	filter.str = str;
+
+	EventHookError err = g_EventManager.HookEvent(name, pFunction, static_cast<EventHookMode>(params[3]), &filter);
+	if (err == EventHookErr_InvalidEvent)
+	{
+		return 0;
+	}
+	else if (err == EventHookErr_TooManyFilters)
+	{
+		return pContext->ThrowNativeError("Game event \"%s\" has too many filtered post hooks (max %d)",
+			name, MAX_FILTERED_POST_HOOKS);
+	}
+
+	return 1;
+}
+
 static cell_t sm_UnhookEvent(IPluginContext *pContext, const cell_t *params)
 {
 	char *name;
@@ -458,6 +504,7 @@ REGISTER_NATIVES(gameEventNatives)
 {
 	{"HookEvent",			sm_HookEvent},
 	{"HookEventEx",			sm_HookEventEx},
+	{"HookEventFiltered",	sm_HookEventFiltered},
 	{"UnhookEvent",			sm_UnhookEvent},
 	{"CreateEvent",			sm_CreateEvent},
 	{"FireEvent",			sm_FireEvent},
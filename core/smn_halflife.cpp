@@ -36,6 +36,7 @@
 #include "HalfLife2.h"
 
 #include <vstdlib/random.h>
+#include <memory>
 
 static cell_t SetRandomSeed(IPluginContext *pContext, const cell_t *params)
 {
@@ -413,6 +414,122 @@ static cell_t PrintHintText(IPluginContext *pContext, const cell_t *params)
 	return 1;
 }
 
+/* Formats once per language among the recipients and sends one user message
+ * to every group of recipients whose text came out the same.
+ */
+static cell_t PrintToClientsGrouped(IPluginContext *pContext, const cell_t *params, bool hint)
+{
+	cell_t *clients;
+	pContext->LocalToPhysAddr(params[1], &clients);
+
+	int numClients = params[2];
+	if (numClients < 0 || numClients > SM_MAXPLAYERS)
+	{
+		return pContext->ThrowNativeError("Invalid number of clients %d", numClients);
+	}
+
+	unsigned int langs[SM_MAXPLAYERS];
+	for (int i = 0; i < numClients; i++)
+	{
+		CPlayer *pPlayer = g_Players.GetPlayerByIndex(clients[i]);
+
+		if (!pPlayer)
+		{
+			return pContext->ThrowNativeError("Client index %d is invalid", clients[i]);
+		}
+
+		if (!pPlayer->IsInGame())
+		{
+			return pContext->ThrowNativeError("Client %d is not in game", clients[i]);
+		}
+
+		langs[i] = pPlayer->GetLanguageId();
+	}
+
+	struct MessageGroup
+	{
+		char text[254];
+		cell_t players[SM_MAXPLAYERS];
+		int count;
+	};
+
+	std::unique_ptr<MessageGroup[]> groups(new MessageGroup[numClients > 0 ? numClients : 1]);
+	int numGroups = 0;
+	bool done[SM_MAXPLAYERS] = {false};
+
+	int oldTarget = g_SourceMod.GetGlobalTarget();
+	for (int i = 0; i < numClients; i++)
+	{
+		if (done[i])
+		{
+			continue;
+		}
+
+		/* Translations only depend on the target's language, so one format covers everyone sharing it */
+		MessageGroup *group = &groups[numGroups];
+		g_SourceMod.SetGlobalTarget(clients[i]);
+		{
+			DetectExceptions eh(pContext);
+			g_SourceMod.FormatString(group->text, sizeof(group->text), pContext, params, 3);
+			if (eh.HasException())
+			{
+				g_SourceMod.SetGlobalTarget(oldTarget);
+				return 0;
+			}
+		}
+
+		/* Different languages can still render the same text, e.g. without any phrases */
+		for (int j = 0; j < numGroups; j++)
+		{
+			if (strcmp(groups[j].text, group->text) == 0)
+			{
+				group = &groups[j];
+				break;
+			}
+		}
+
+		if (group == &groups[numGroups])
+		{
+			group->count = 0;
+			numGroups++;
+		}
+
+		for (int j = i; j < numClients; j++)
+		{
+			if (!done[j] && langs[j] == langs[i])
+			{
+				group->players[group->count++] = clients[j];
+				done[j] = true;
+			}
+		}
+	}
+	g_SourceMod.SetGlobalTarget(oldTarget);
+
+	for (int i = 0; i < numGroups; i++)
+	{
+		bool sent = hint
+			? g_HL2.HintTextMsg(groups[i].players, groups[i].count, groups[i].text)
+			: g_HL2.TextMsg(groups[i].players, groups[i].count, HUD_PRINTTALK, groups[i].text);
+
+		if (!sent)
+		{
+			return pContext->ThrowNativeError("Could not send a usermessage");
+		}
+	}
+
+	return numGroups;
+}
+
+static cell_t PrintToChatClients(IPluginContext *pContext, const cell_t *params)
+{
+	return PrintToClientsGrouped(pContext, params, false);
+}
+
+static cell_t PrintHintTextClients(IPluginContext *pContext, const cell_t *params)
+{
+	return PrintToClientsGrouped(pContext, params, true);
+}
+
 static cell_t ShowVGUIPanel(IPluginContext *pContext, const cell_t *params)
 {
 	HandleError herr;
@@ -559,6 +676,63 @@ static cell_t ReferenceToIndex(IPluginContext *pContext, const cell_t *params)
 	return g_HL2.ReferenceToIndex(params[1]);
 }
 
+static cell_t ReferencesToIndexes(IPluginContext *pContext, const cell_t *params)
+{
+	cell_t count = params[3];
+	if (count < 0)
+	{
+		return pContext->ThrowNativeError("Invalid count %d", count);
+	}
+
+	cell_t *refs, *indexes;
+	pContext->LocalToPhysAddr(params[1], &refs);
+	pContext->LocalToPhysAddr(params[2], &indexes);
+
+	cell_t valid = 0;
+	for (cell_t i = 0; i < count; i++)
+	{
+		indexes[i] = g_HL2.ReferenceToIndex(refs[i]);
+		if ((unsigned)indexes[i] != INVALID_EHANDLE_INDEX)
+		{
+			valid++;
+		}
+	}
+
+	return valid;
+}
+
+static cell_t IndexesToReferences(IPluginContext *pContext, const cell_t *params)
+{
+	cell_t count = params[3];
+	if (count < 0)
+	{
+		return pContext->ThrowNativeError("Invalid count %d", count);
+	}
+
+	cell_t *indexes, *refs;
+	pContext->LocalToPhysAddr(params[1], &indexes);
+	pContext->LocalToPhysAddr(params[2], &refs);
+
+	cell_t valid = 0;
+	for (cell_t i = 0; i < count; i++)
+	{
+		/* Unlike EntIndexToEntRef, a bad index is reported in place rather than thrown. */
+		if (indexes[i] < 0 || indexes[i] >= NUM_ENT_ENTRIES)
+		{
+			refs[i] = INVALID_EHANDLE_INDEX;
+			continue;
+		}
+
+		refs[i] = g_HL2.IndexToReference(indexes[i]);
+		if ((unsigned)refs[i] != INVALID_EHANDLE_INDEX)
+		{
+			valid++;
+		}
+	}
+
+	return valid;
+}
+
 static cell_t ReferenceToBCompatRef(IPluginContext *pContext, const cell_t *params)
 {
 	return g_HL2.ReferenceToBCompatRef(params[1]);
@@ -636,12 +810,16 @@ REGISTER_NATIVES(halflifeNatives)
 	{"PrintToChat",				PrintToChat},
 	{"PrintCenterText",			PrintCenterText},
 	{"PrintHintText",			PrintHintText},
+	{"PrintToChatClients",		PrintToChatClients},
+	{"PrintHintTextClients",	PrintHintTextClients},
 	{"ShowVGUIPanel",			ShowVGUIPanel},
 	{"IsPlayerAlive",			smn_IsPlayerAlive},
 	{"GuessSDKVersion",			GuessSDKVersion},
 	{"GetEngineVersion",		GetEngineVersion},
 	{"EntIndexToEntRef",		IndexToReference},
 	{"EntRefToEntIndex",		ReferenceToIndex},
+	{"EntRefsToEntIndexes",		ReferencesToIndexes},
+	{"EntIndexesToEntRefs",		IndexesToReferences},
 	{"MakeCompatEntRef",		ReferenceToBCompatRef},
 	{"GetClientsInRange",		GetClientsInRange},
 	{NULL,						NULL},
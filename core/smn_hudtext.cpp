@@ -36,6 +36,7 @@
 #include "PlayerManager.h"
 #include "logic_bridge.h"
 #include "sourcemod.h"
+#include <string>
 
 #if SOURCE_ENGINE == SE_CSGO
 #include <game/shared/csgo/protobuf/cstrike15_usermessages.pb.h>
@@ -54,12 +55,6 @@ struct hud_syncobj_t
 	int player_channels[256 + 1];
 };
 
-struct player_chaninfo_t
-{
-	double chan_times[MAX_HUD_CHANNELS];
-	hud_syncobj_t *chan_syncobjs[MAX_HUD_CHANNELS];
-};
-
 struct hud_text_parms
 {
 	float       x;
@@ -75,6 +70,32 @@ struct hud_text_parms
 	bool        isSet = false;
 };
 
+/* What a client was last sent on a channel, and until when it stays up. */
+struct hud_sentinfo_t
+{
+	bool valid = false;
+	double expire_time = 0.0;
+	double last_request = 0.0;
+	hud_text_parms parms;
+	std::string text;
+};
+
+struct player_chaninfo_t
+{
+	double chan_times[MAX_HUD_CHANNELS];
+	hud_syncobj_t *chan_syncobjs[MAX_HUD_CHANNELS];
+	hud_sentinfo_t chan_sent[MAX_HUD_CHANNELS];
+};
+
+static bool SameHudParams(const hud_text_parms &a, const hud_text_parms &b)
+{
+	return a.x == b.x && a.y == b.y && a.effect == b.effect
+		&& a.r1 == b.r1 && a.g1 == b.g1 && a.b1 == b.b1 && a.a1 == b.a1
+		&& a.r2 == b.r2 && a.g2 == b.g2 && a.b2 == b.b2 && a.a2 == b.a2
+		&& a.fadeinTime == b.fadeinTime && a.fadeoutTime == b.fadeoutTime
+		&& a.holdTime == b.holdTime && a.fxTime == b.fxTime;
+}
+
 class HudMsgHelpers : 
 	public SMGlobalClass,
 	public IHandleTypeDispatch,
@@ -117,6 +138,7 @@ public:
 		}
 
 		delete [] m_PlayerHuds;
+		m_PlayerHuds = NULL;
 		handlesys->RemoveType(m_hHudSyncObj, g_pCoreIdent);
 
 		g_Players.RemoveClientListener(this);
@@ -135,6 +157,38 @@ public:
 		return true;
 	}
 
+	virtual ConfigResult OnSourceModConfigChanged(const char *key, const char *value,
+		ConfigSource source, char *error, size_t maxlength)
+	{
+		if (strcasecmp(key, "SuppressRepeatedHudText") != 0)
+		{
+			return ConfigResult_Ignore;
+		}
+
+		if (strcasecmp(value, "yes") == 0)
+		{
+			m_bSuppressRepeats = true;
+		}
+		else if (strcasecmp(value, "no") == 0)
+		{
+			m_bSuppressRepeats = false;
+		}
+		else
+		{
+			ke::SafeStrcpy(error, maxlength, "Invalid value: must be \"yes\" or \"no\"");
+			return ConfigResult_Reject;
+		}
+
+		if (m_PlayerHuds)
+		{
+			for (int i = 1; i <= 256; i++)
+			{
+				InvalidateSent(i, -1);
+			}
+		}
+		return ConfigResult_Accept;
+	}
+
 	virtual void OnClientConnected(int client)
 	{
 		player_chaninfo_t *player;
@@ -142,6 +196,59 @@ public:
 		player = &m_PlayerHuds[client];
 		memset(player->chan_syncobjs, 0, sizeof(player->chan_syncobjs));
 		memset(player->chan_times, 0, sizeof(player->chan_times));
+		InvalidateSent(client, -1);
+	}
+
+	/**
+	 * Decides whether a HUD message needs to go out. An identical message
+	 * (same channel, text, position, colors and timings) is skipped while the
+	 * copy the client already has stays on screen long enough that the
+	 * caller's next refresh, judged by how often it has been calling, will
+	 * arrive before it fades.
+	 */
+	bool ShouldSendHudText(int client, const hud_text_parms &parms, const char *text)
+	{
+		hud_sentinfo_t *sent;
+		double now, interval;
+
+		if (!m_bSuppressRepeats)
+		{
+			return true;
+		}
+
+		sent = &m_PlayerHuds[client].chan_sent[parms.channel];
+		now = *g_pUniversalTime;
+		interval = now - sent->last_request;
+		sent->last_request = now;
+
+		if (sent->valid
+			&& sent->expire_time - now > interval * 1.5
+			&& SameHudParams(sent->parms, parms)
+			&& sent->text == text)
+		{
+			return false;
+		}
+
+		sent->valid = true;
+		sent->expire_time = now + parms.fadeinTime + parms.holdTime;
+		sent->parms = parms;
+		sent->text = text;
+		return true;
+	}
+
+	void InvalidateSent(int client, int channel)
+	{
+		player_chaninfo_t *player;
+
+		player = &m_PlayerHuds[client];
+		for (int i = 0; i < MAX_HUD_CHANNELS; i++)
+		{
+			if (channel == -1 || channel == i)
+			{
+				player->chan_sent[i].valid = false;
+				player->chan_sent[i].last_request = 0.0;
+			}
+		}
 	}
 
 	Handle_t CreateHudSyncObj(IdentityToken_t *pIdent)
@@ -258,7 +365,8 @@ public:
 	}
 private:
 	HandleType_t m_hHudSyncObj;
-	player_chaninfo_t *m_PlayerHuds;
+	player_chaninfo_t *m_PlayerHuds = NULL;
+	bool m_bSuppressRepeats = true;
 } s_HudMsgHelpers;
 
 hud_text_parms g_hud_params;
@@ -423,7 +531,10 @@ static cell_t ShowSyncHudText(IPluginContext *pContext, const cell_t *params)
 	}
 
 	g_hud_params.channel = s_HudMsgHelpers.AutoSelectChannel(client, obj);
-	UTIL_SendHudText(client, g_hud_params, message_buffer);
+	if (s_HudMsgHelpers.ShouldSendHudText(client, g_hud_params, message_buffer))
+	{
+		UTIL_SendHudText(client, g_hud_params, message_buffer);
+	}
 
 	return 1;
 }
@@ -462,7 +573,10 @@ static cell_t ClearSyncHud(IPluginContext *pContext, const cell_t *params)
 	}
 
 	g_hud_params.channel = channel;
-	UTIL_SendHudText(client, g_hud_params, "");
+	if (s_HudMsgHelpers.ShouldSendHudText(client, g_hud_params, ""))
+	{
+		UTIL_SendHudText(client, g_hud_params, "");
+	}
 
 	return g_hud_params.channel;
 }
@@ -516,15 +630,46 @@ static cell_t ShowHudText(IPluginContext *pContext, const cell_t *params)
 		s_HudMsgHelpers.ManualSelectChannel(client, g_hud_params.channel);
 	}
 
-	UTIL_SendHudText(client, g_hud_params, message_buffer);
+	if (s_HudMsgHelpers.ShouldSendHudText(client, g_hud_params, message_buffer))
+	{
+		UTIL_SendHudText(client, g_hud_params, message_buffer);
+	}
 
 	return g_hud_params.channel;
 }
 
+static cell_t RefreshHudText(IPluginContext *pContext, const cell_t *params)
+{
+	int client;
+	int channel;
+
+	if (!s_HudMsgHelpers.IsSupported())
+	{
+		return 0;
+	}
+
+	client = params[1];
+	if (g_Players.GetPlayerByIndex(client) == NULL)
+	{
+		return pContext->ThrowNativeError("Invalid client index %d", client);
+	}
+
+	channel = params[2];
+	if (channel < -1 || channel >= MAX_HUD_CHANNELS)
+	{
+		return pContext->ThrowNativeError("Invalid channel %d", channel);
+	}
+
+	s_HudMsgHelpers.InvalidateSent(client, channel);
+
+	return 1;
+}
+
 REGISTER_NATIVES(hudNatives)
 {
 	{"ClearSyncHud",				ClearSyncHud},
 	{"CreateHudSynchronizer",		CreateHudSynchronizer},
+	{"RefreshHudText",				RefreshHudText},
 	{"SetHudTextParams",			SetHudTextParams},
 	{"SetHudTextParamsEx",			SetHudTextParamsEx},
 	{"ShowHudText",					ShowHudText},
@@ -38,6 +38,9 @@
 #include <KeyValues.h>
 #include "utlbuffer.h"
 #include "logic_bridge.h"
+#include <unordered_set>
+#include <bridge/include/IContainerBridge.h>
+#include <ICellArray.h>
 
 HandleType_t g_KeyValueType;
 
@@ -84,6 +87,10 @@ public:
 
 		/* Check how much memory the actual thing takes up */		
 		size += CalcKVSizeR(pStk->pBase);
+		if (pStk->pIndex)
+		{
+			size += sizeof(KeyValueIndex) + pStk->pIndex->GetMemUsage();
+		}
 
 		*pSize = size;
 
@@ -118,6 +125,87 @@ KeyValues *SourceModBase::ReadKeyValuesHandle(Handle_t hndl, HandleError *err, b
 	return (root) ? pStk->pBase : pStk->pCurRoot.front();
 }
 
+void KeyValueIndex::MakeKey(KeyValues *pParent, const char *name, size_t length)
+{
+	char prefix[24];
+	ke::SafeSprintf(prefix, sizeof(prefix), "%p/", (void *)pParent);
+
+	m_Key.assign(prefix);
+	for (size_t i = 0; i < length; i++)
+	{
+		m_Key.push_back((char)tolower((unsigned char)name[i]));
+	}
+}
+
+void KeyValueIndex::Build(KeyValues *pRoot)
+{
+	m_Nodes.clear();
+
+	std::vector<KeyValues *> pending(1, pRoot);
+	while (!pending.empty())
+	{
+		KeyValues *pParent = pending.back();
+		pending.pop_back();
+
+		for (KeyValues *pChild = pParent->GetFirstSubKey(); pChild; pChild = pChild->GetNextKey())
+		{
+			const char *name = pChild->GetName();
+			MakeKey(pParent, name, strlen(name));
+
+			/* Key names are matched case-insensitively and the first sibling
+			 * wins, as with FindKey. */
+			m_Nodes.insert(m_Key.c_str(), pChild);
+
+			if (pChild->GetFirstSubKey())
+			{
+				pending.push_back(pChild);
+			}
+		}
+	}
+}
+
+KeyValues *KeyValueIndex::Find(KeyValues *pNode, const char *path)
+{
+	while (*path)
+	{
+		const char *sep = strchr(path, '/');
+		size_t length = sep ? (size_t)(sep - path) : strlen(path);
+
+		MakeKey(pNode, path, length);
+		if (!m_Nodes.retrieve(m_Key.c_str(), &pNode))
+		{
+			return NULL;
+		}
+
+		if (!sep)
+		{
+			break;
+		}
+		path = sep + 1;
+	}
+
+	return pNode;
+}
+
+/**
+ * Returns the section a getter should read |*key| from. On a frozen handle
+ * the key is resolved through the index and cleared, so the getter reads the
+ * node's own value; NULL means the key does not exist. Otherwise this is the
+ * current section and the key is left alone.
+ */
+static KeyValues *FindReadSection(KeyValueStack *pStk, char **key)
+{
+	KeyValues *pSection = pStk->pCurRoot.front();
+	if (!pStk->pIndex || !*key || !**key)
+	{
+		return pSection;
+	}
+
+	pSection = pStk->pIndex->Find(pSection, *key);
+	*key = NULL;
+	return pSection;
+}
+
 static cell_t smn_KvSetString(IPluginContext *pCtx, const cell_t *params)
 {
 	Handle_t hndl = static_cast<Handle_t>(params[1]);
@@ -134,6 +222,11 @@ static cell_t smn_KvSetString(IPluginContext *pCtx, const cell_t *params)
 		return pCtx->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
 	}
 
+	if (pStk->pIndex)
+	{
+		return pCtx->ThrowNativeError("KeyValues handle %x is frozen and cannot be modified", hndl);
+	}
+
 	char *key, *value;
 	pCtx->LocalToStringNULL(params[2], &key);
 	pCtx->LocalToString(params[3], &value);
@@ -159,6 +252,11 @@ static cell_t smn_KvSetNum(IPluginContext *pCtx, const cell_t *params)
 		return pCtx->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
 	}
 
+	if (pStk->pIndex)
+	{
+		return pCtx->ThrowNativeError("KeyValues handle %x is frozen and cannot be modified", hndl);
+	}
+
 	char *key;
 	pCtx->LocalToStringNULL(params[2], &key);
 
@@ -183,6 +281,11 @@ static cell_t smn_KvSetUInt64(IPluginContext *pCtx, const cell_t *params)
 		return pCtx->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
 	}
 
+	if (pStk->pIndex)
+	{
+		return pCtx->ThrowNativeError("KeyValues handle %x is frozen and cannot be modified", hndl);
+	}
+
 	char *key;
 	cell_t *addr;
 	uint64 value;
@@ -211,6 +314,11 @@ static cell_t smn_KvSetFloat(IPluginContext *pCtx, const cell_t *params)
 		return pCtx->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
 	}
 
+	if (pStk->pIndex)
+	{
+		return pCtx->ThrowNativeError("KeyValues handle %x is frozen and cannot be modified", hndl);
+	}
+
 	char *key;
 	pCtx->LocalToStringNULL(params[2], &key);
 
@@ -235,6 +343,11 @@ static cell_t smn_KvSetColor(IPluginContext *pCtx, const cell_t *params)
 		return pCtx->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
 	}
 
+	if (pStk->pIndex)
+	{
+		return pCtx->ThrowNativeError("KeyValues handle %x is frozen and cannot be modified", hndl);
+	}
+
 	char *key;
 	pCtx->LocalToStringNULL(params[2], &key);
 
@@ -260,6 +373,11 @@ static cell_t smn_KvSetVector(IPluginContext *pCtx, const cell_t *params)
 		return pCtx->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
 	}
 
+	if (pStk->pIndex)
+	{
+		return pCtx->ThrowNativeError("KeyValues handle %x is frozen and cannot be modified", hndl);
+	}
+
 	char *key;
 	char buffer[64];
 	cell_t *vector;
@@ -294,7 +412,8 @@ static cell_t smn_KvGetString(IPluginContext *pCtx, const cell_t *params)
 	pCtx->LocalToStringNULL(params[2], &key);
 	pCtx->LocalToString(params[5], &defvalue);
 
-	value = pStk->pCurRoot.front()->GetString(key, defvalue);
+	KeyValues *pSection = FindReadSection(pStk, &key);
+	value = pSection ? pSection->GetString(key, defvalue) : defvalue;
 	pCtx->StringToLocalUTF8(params[3], params[4], value, NULL);
 
 	return 1;
@@ -320,7 +439,8 @@ static cell_t smn_KvGetNum(IPluginContext *pCtx, const cell_t *params)
 	char *key;
 	pCtx->LocalToStringNULL(params[2], &key);
 
-	value = pStk->pCurRoot.front()->GetInt(key, params[3]);
+	KeyValues *pSection = FindReadSection(pStk, &key);
+	value = pSection ? pSection->GetInt(key, params[3]) : params[3];
 
 	return value;
 }
@@ -345,7 +465,8 @@ static cell_t smn_KvGetFloat(IPluginContext *pCtx, const cell_t *params)
 	char *key;
 	pCtx->LocalToStringNULL(params[2], &key);
 
-	value = pStk->pCurRoot.front()->GetFloat(key, sp_ctof(params[3]));
+	KeyValues *pSection = FindReadSection(pStk, &key);
+	value = pSection ? pSection->GetFloat(key, sp_ctof(params[3])) : sp_ctof(params[3]);
 
 	return sp_ftoc(value);
 }
@@ -375,7 +496,8 @@ static cell_t smn_KvGetColor(IPluginContext *pCtx, const cell_t *params)
 	pCtx->LocalToPhysAddr(params[5], &b);
 	pCtx->LocalToPhysAddr(params[6], &a);
 
-	color = pStk->pCurRoot.front()->GetColor(key);
+	KeyValues *pSection = FindReadSection(pStk, &key);
+	color = pSection ? pSection->GetColor(key) : Color();
 	*r = color.r();
 	*g = color.g();
 	*b = color.b();
@@ -407,7 +529,8 @@ static cell_t smn_KvGetUInt64(IPluginContext *pCtx, const cell_t *params)
 	pCtx->LocalToPhysAddr(params[3], &addr);
 	pCtx->LocalToPhysAddr(params[4], &defvalue);
 
-	value = pStk->pCurRoot.front()->GetUint64(key, static_cast<uint64>(*defvalue));
+	KeyValues *pSection = FindReadSection(pStk, &key);
+	value = pSection ? pSection->GetUint64(key, static_cast<uint64>(*defvalue)) : static_cast<uint64>(*defvalue);
 	*reinterpret_cast<uint64 *>(addr) = value;
 
 	return 1;
@@ -439,7 +562,8 @@ static cell_t smn_KvGetVector(IPluginContext *pCtx, const cell_t *params)
 
 	ke::SafeSprintf(buffer, sizeof(buffer), "%f %f %f", sp_ctof(defvector[0]), sp_ctof(defvector[1]), sp_ctof(defvector[2]));
 
-	value = pStk->pCurRoot.front()->GetString(key, buffer);
+	KeyValues *pSection = FindReadSection(pStk, &key);
+	value = pSection ? pSection->GetString(key, buffer) : buffer;
 
 	float out;
 	int components = 0;
@@ -524,7 +648,15 @@ static cell_t smn_KvJumpToKey(IPluginContext *pCtx, const cell_t *params)
 	pCtx->LocalToString(params[2], &name);
 
 	KeyValues *pSubKey = pStk->pCurRoot.front();
-	pSubKey = pSubKey->FindKey(name, (params[3]) ? true : false);
+	if (pStk->pIndex)
+	{
+		/* Nothing can be created in a frozen tree. */
+		pSubKey = pStk->pIndex->Find(pSubKey, name);
+	}
+	else
+	{
+		pSubKey = pSubKey->FindKey(name, (params[3]) ? true : false);
+	}
 	if (!pSubKey)
 	{
 		return 0;
@@ -733,6 +865,11 @@ static cell_t smn_KvSetSectionName(IPluginContext *pCtx, const cell_t *params)
 		return pCtx->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
 	}
 
+	if (pStk->pIndex)
+	{
+		return pCtx->ThrowNativeError("KeyValues handle %x is frozen and cannot be modified", hndl);
+	}
+
 	pCtx->LocalToString(params[2], &name);
 
 	KeyValues *pSection = pStk->pCurRoot.front();
@@ -760,7 +897,8 @@ static cell_t smn_KvGetDataType(IPluginContext *pCtx, const cell_t *params)
 
 	pCtx->LocalToString(params[2], &name);
 
-	return pStk->pCurRoot.front()->GetDataType(name);
+	KeyValues *pSection = FindReadSection(pStk, &name);
+	return pSection ? pSection->GetDataType(name) : KeyValues::TYPE_NONE;
 }
 
 static cell_t smn_KeyValuesToFile(IPluginContext *pCtx, const cell_t *params)
@@ -803,6 +941,11 @@ static cell_t smn_FileToKeyValues(IPluginContext *pCtx, const cell_t *params)
 		return pCtx->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
 	}
 
+	if (pStk->pIndex)
+	{
+		return pCtx->ThrowNativeError("KeyValues handle %x is frozen and cannot be modified", hndl);
+	}
+
 	pCtx->LocalToString(params[2], &path);
 
 	kv = pStk->pCurRoot.front();
@@ -826,6 +969,11 @@ static cell_t smn_StringToKeyValues(IPluginContext *pCtx, const cell_t *params)
 		return pCtx->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
 	}
 
+	if (pStk->pIndex)
+	{
+		return pCtx->ThrowNativeError("KeyValues handle %x is frozen and cannot be modified", hndl);
+	}
+
 	char *buffer;
 	char *resourceName;
 	pCtx->LocalToString(params[2], &buffer);
@@ -891,6 +1039,11 @@ static cell_t smn_KvDeleteThis(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
 	}
 
+	if (pStk->pIndex)
+	{
+		return pContext->ThrowNativeError("KeyValues handle %x is frozen and cannot be modified", hndl);
+	}
+
 	if (pStk->pCurRoot.size() < 2)
 	{
 		return 0;
@@ -945,6 +1098,11 @@ static cell_t smn_KvDeleteKey(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
 	}
 
+	if (pStk->pIndex)
+	{
+		return pContext->ThrowNativeError("KeyValues handle %x is frozen and cannot be modified", hndl);
+	}
+
 	if (pStk->pCurRoot.size() < 2)
 	{
 		return 0;
@@ -1015,6 +1173,11 @@ static cell_t smn_CopySubkeys(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Invalid key value handle %x (error %d)", hndl_parent, herr);
 	}
 
+	if (pStk_parent->pIndex)
+	{
+		return pContext->ThrowNativeError("KeyValues handle %x is frozen and cannot be modified", hndl_parent);
+	}
+
 	pStk_copied->pCurRoot.front()->CopySubkeys(pStk_parent->pCurRoot.front());
 
 	return 1;
@@ -1180,6 +1343,430 @@ static cell_t smn_KeyValuesExportLength(IPluginContext *pContext, const cell_t *
 	return (cell_t)buffer.TellPut();
 }
 
+static cell_t smn_KvFreeze(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError herr;
+	HandleSecurity sec;
+	KeyValueStack *pStk;
+
+	sec.pOwner = NULL;
+	sec.pIdentity = g_pCoreIdent;
+
+	if ((herr=handlesys->ReadHandle(hndl, g_KeyValueType, &sec, (void **)&pStk))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
+	}
+
+	if (!pStk->pIndex)
+	{
+		pStk->pIndex.reset(new KeyValueIndex);
+		pStk->pIndex->Build(pStk->pBase);
+	}
+
+	return 1;
+}
+
+static cell_t smn_KvIsFrozen(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError herr;
+	HandleSecurity sec;
+	KeyValueStack *pStk;
+
+	sec.pOwner = NULL;
+	sec.pIdentity = g_pCoreIdent;
+
+	if ((herr=handlesys->ReadHandle(hndl, g_KeyValueType, &sec, (void **)&pStk))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
+	}
+
+	return pStk->pIndex ? 1 : 0;
+}
+
+static cell_t smn_KeyValuesToBinaryFile(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError herr;
+	HandleSecurity sec;
+	KeyValueStack *pStk;
+
+	sec.pOwner = NULL;
+	sec.pIdentity = g_pCoreIdent;
+
+	if ((herr=handlesys->ReadHandle(hndl, g_KeyValueType, &sec, (void **)&pStk))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
+	}
+
+	char *path;
+	pContext->LocalToString(params[2], &path);
+
+	/* WriteAsBinary also writes every following sibling, so a section that
+	 * has any is written from a copy, which has none.
+	 */
+	KeyValues *kv = pStk->pCurRoot.front();
+	KeyValues *copy = kv->GetNextKey() ? kv->MakeCopy() : NULL;
+
+	CUtlBuffer buffer;
+	bool ok = (copy ? copy : kv)->WriteAsBinary(buffer);
+	if (copy)
+	{
+		copy->deleteThis();
+	}
+	if (!ok)
+	{
+		return 0;
+	}
+
+	FileHandle_t f = basefilesystem->Open(path, "wb");
+	if (!f)
+	{
+		return 0;
+	}
+
+	int size = buffer.TellPut();
+	ok = (basefilesystem->Write(buffer.Base(), size, f) == size);
+	basefilesystem->Close(f);
+
+	return ok ? 1 : 0;
+}
+
+static cell_t smn_BinaryFileToKeyValues(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError herr;
+	HandleSecurity sec;
+	KeyValueStack *pStk;
+
+	sec.pOwner = NULL;
+	sec.pIdentity = g_pCoreIdent;
+
+	if ((herr=handlesys->ReadHandle(hndl, g_KeyValueType, &sec, (void **)&pStk))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
+	}
+
+	if (pStk->pIndex)
+	{
+		return pContext->ThrowNativeError("KeyValues handle %x is frozen and cannot be modified", hndl);
+	}
+
+	char *path;
+	pContext->LocalToString(params[2], &path);
+
+	FileHandle_t f = basefilesystem->Open(path, "rb");
+	if (!f)
+	{
+		return 0;
+	}
+
+	CUtlBuffer buffer;
+	int size = basefilesystem->Size(f);
+	buffer.EnsureCapacity(size);
+	bool ok = (basefilesystem->Read(buffer.Base(), size, f) == size);
+	basefilesystem->Close(f);
+	if (!ok)
+	{
+		return 0;
+	}
+	buffer.SeekPut(CUtlBuffer::SEEK_HEAD, size);
+
+	/* Read into a detached node first, so a bad file leaves the tree alone
+	 * and the current section keeps its place among its siblings.
+	 */
+	KeyValues *loaded = new KeyValues("");
+	if (!loaded->ReadAsBinary(buffer))
+	{
+		loaded->deleteThis();
+		return 0;
+	}
+
+	KeyValues *kv = pStk->pCurRoot.front();
+	KeyValues *sub;
+	while ((sub = kv->GetFirstSubKey()) != NULL)
+	{
+		kv->RemoveSubKey(sub);
+		sub->deleteThis();
+	}
+	kv->SetName(loaded->GetName());
+	loaded->CopySubkeys(kv);
+	loaded->deleteThis();
+
+	return 1;
+}
+
+/* StringMap nesting deeper than this is not followed by ImportFromStringMap. */
+#define KV_MAX_IMPORT_DEPTH		64
+
+static inline bool KvIsSection(KeyValues *pNode)
+{
+	return pNode->GetFirstSubKey() != NULL || pNode->GetDataType() == KeyValues::TYPE_NONE;
+}
+
+/**
+ * Copies KeyValues sections into StringMaps. Values keep their KeyValues
+ * type: ints and floats become cells, uint64s and colors become arrays of
+ * 2 and 4 cells, and everything else a string. Subsections become nested
+ * StringMap handles, or with |flatten|, "sub/key" entries in the same map.
+ * As with FindKey, the first of several same-named keys wins.
+ */
+class KvToStringMap
+{
+public:
+	KvToStringMap(IdentityToken_t *owner, bool flatten)
+		: m_pOwner(owner), m_bFlatten(flatten)
+	{
+	}
+
+	Handle_t Convert(KeyValues *pSection, const char *nameKey)
+	{
+		CellTrie *map;
+		Handle_t hndl = logicore.containers->CreateStringMap(m_pOwner, &map);
+		if (hndl == BAD_HANDLE)
+		{
+			return BAD_HANDLE;
+		}
+
+		std::unordered_set<std::string> seen;
+		std::string prefix;
+		if (nameKey && nameKey[0])
+		{
+			logicore.containers->SetStringMapString(map, nameKey, pSection->GetName());
+			seen.insert(nameKey);
+		}
+		Fill(map, pSection, prefix, seen);
+
+		return hndl;
+	}
+
+private:
+	void Fill(CellTrie *map, KeyValues *pSection, std::string &prefix, std::unordered_set<std::string> &seen)
+	{
+		size_t base = prefix.size();
+		for (KeyValues *pChild = pSection->GetFirstSubKey(); pChild; pChild = pChild->GetNextKey())
+		{
+			prefix.resize(base);
+			prefix.append(pChild->GetName());
+			if (!seen.insert(prefix).second)
+			{
+				continue;
+			}
+
+			if (!KvIsSection(pChild))
+			{
+				SetValue(map, prefix.c_str(), pChild);
+			}
+			else if (m_bFlatten)
+			{
+				prefix.push_back('/');
+				Fill(map, pChild, prefix, seen);
+			}
+			else
+			{
+				Handle_t sub = Convert(pChild, NULL);
+				if (sub != BAD_HANDLE)
+				{
+					logicore.containers->SetStringMapCell(map, prefix.c_str(), sub);
+				}
+			}
+		}
+		prefix.resize(base);
+	}
+
+	void SetValue(CellTrie *map, const char *key, KeyValues *pValue)
+	{
+		switch (pValue->GetDataType())
+		{
+		case KeyValues::TYPE_INT:
+			logicore.containers->SetStringMapCell(map, key, pValue->GetInt());
+			break;
+		case KeyValues::TYPE_FLOAT:
+			logicore.containers->SetStringMapCell(map, key, sp_ftoc(pValue->GetFloat()));
+			break;
+		case KeyValues::TYPE_UINT64:
+			{
+				uint64 value = pValue->GetUint64();
+				cell_t cells[2];
+				memcpy(cells, &value, sizeof(cells));
+				logicore.containers->SetStringMapArray(map, key, cells, 2);
+				break;
+			}
+		case KeyValues::TYPE_COLOR:
+			{
+				Color color = pValue->GetColor();
+				cell_t cells[4] = {color.r(), color.g(), color.b(), color.a()};
+				logicore.containers->SetStringMapArray(map, key, cells, 4);
+				break;
+			}
+		default:
+			logicore.containers->SetStringMapString(map, key, pValue->GetString());
+			break;
+		}
+	}
+
+private:
+	IdentityToken_t *m_pOwner;
+	bool m_bFlatten;
+};
+
+/**
+ * Writes StringMap entries into a KeyValues section, the reverse of
+ * KvToStringMap: cells become ints, strings stay strings, and 2- and 4-cell
+ * arrays become uint64s and colors. Keys with '/' create the path. With
+ * |nested|, cells that are StringMap handles become subsections.
+ */
+class StringMapToKv : public IStringMapVisitor
+{
+public:
+	StringMapToKv(IdentityToken_t *owner, bool nested, KeyValues *pSection, unsigned int depth)
+		: m_pOwner(owner), m_bNested(nested), m_pSection(pSection), m_Depth(depth)
+	{
+	}
+
+	void OnCell(const char *key, cell_t value) override
+	{
+		CellTrie *sub;
+		if (m_bNested && m_Depth < KV_MAX_IMPORT_DEPTH
+			&& (sub = logicore.containers->ReadStringMap(value, m_pOwner)) != NULL)
+		{
+			StringMapToKv child(m_pOwner, m_bNested, m_pSection->FindKey(key, true), m_Depth + 1);
+			logicore.containers->VisitStringMap(sub, &child);
+			return;
+		}
+		m_pSection->SetInt(key, value);
+	}
+
+	void OnString(const char *key, const char *value) override
+	{
+		m_pSection->SetString(key, value);
+	}
+
+	void OnArray(const char *key, const cell_t *values, size_t count) override
+	{
+		if (count == 2)
+		{
+			uint64 value;
+			memcpy(&value, values, sizeof(value));
+			m_pSection->SetUint64(key, value);
+		}
+		else if (count == 4)
+		{
+			m_pSection->SetColor(key, Color(values[0], values[1], values[2], values[3]));
+		}
+	}
+
+private:
+	IdentityToken_t *m_pOwner;
+	bool m_bNested;
+	KeyValues *m_pSection;
+	unsigned int m_Depth;
+};
+
+static cell_t smn_KvToStringMap(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError herr;
+	HandleSecurity sec;
+	KeyValueStack *pStk;
+
+	sec.pOwner = NULL;
+	sec.pIdentity = g_pCoreIdent;
+
+	if ((herr=handlesys->ReadHandle(hndl, g_KeyValueType, &sec, (void **)&pStk))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
+	}
+
+	KvToStringMap converter(pContext->GetIdentity(), params[2] != 0);
+	return converter.Convert(pStk->pCurRoot.front(), NULL);
+}
+
+static cell_t smn_KvToArrayList(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError herr;
+	HandleSecurity sec;
+	KeyValueStack *pStk;
+
+	sec.pOwner = NULL;
+	sec.pIdentity = g_pCoreIdent;
+
+	if ((herr=handlesys->ReadHandle(hndl, g_KeyValueType, &sec, (void **)&pStk))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
+	}
+
+	char *nameKey;
+	pContext->LocalToString(params[2], &nameKey);
+
+	ICellArray *array;
+	Handle_t list = logicore.containers->CreateArrayList(pContext->GetIdentity(), 1, &array);
+	if (list == BAD_HANDLE)
+	{
+		return BAD_HANDLE;
+	}
+
+	KvToStringMap converter(pContext->GetIdentity(), params[3] != 0);
+	for (KeyValues *pChild = pStk->pCurRoot.front()->GetFirstSubKey(); pChild; pChild = pChild->GetNextKey())
+	{
+		if (!KvIsSection(pChild))
+		{
+			continue;
+		}
+
+		Handle_t map = converter.Convert(pChild, nameKey);
+		cell_t *blk;
+		if (map == BAD_HANDLE || (blk = array->push()) == NULL)
+		{
+			break;
+		}
+		*blk = map;
+	}
+
+	return list;
+}
+
+static cell_t smn_StringMapToKv(IPluginContext *pContext, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError herr;
+	HandleSecurity sec;
+	KeyValueStack *pStk;
+
+	sec.pOwner = NULL;
+	sec.pIdentity = g_pCoreIdent;
+
+	if ((herr=handlesys->ReadHandle(hndl, g_KeyValueType, &sec, (void **)&pStk))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid key value handle %x (error %d)", hndl, herr);
+	}
+
+	if (pStk->pIndex)
+	{
+		return pContext->ThrowNativeError("KeyValues handle %x is frozen and cannot be modified", hndl);
+	}
+
+	CellTrie *map = logicore.containers->ReadStringMap(params[2], pContext->GetIdentity());
+	if (!map)
+	{
+		return pContext->ThrowNativeError("Invalid StringMap handle %x", params[2]);
+	}
+
+	StringMapToKv importer(pContext->GetIdentity(), params[3] != 0, pStk->pCurRoot.front(), 0);
+	logicore.containers->VisitStringMap(map, &importer);
+
+	return 1;
+}
+
 static KeyValueNatives s_KeyValueNatives;
 
 REGISTER_NATIVES(keyvaluenatives)
@@ -1256,6 +1843,13 @@ REGISTER_NATIVES(keyvaluenatives)
 	{"KeyValues.ExportToFile",			smn_KeyValuesToFile},
 	{"KeyValues.ExportToString",		smn_KeyValuesToString},
 	{"KeyValues.ExportLength.get",		smn_KeyValuesExportLength},
+	{"KeyValues.ExportToBinaryFile",	smn_KeyValuesToBinaryFile},
+	{"KeyValues.ImportFromBinaryFile",	smn_BinaryFileToKeyValues},
+	{"KeyValues.Freeze",				smn_KvFreeze},
+	{"KeyValues.Frozen.get",			smn_KvIsFrozen},
+	{"KeyValues.ExportToStringMap",		smn_KvToStringMap},
+	{"KeyValues.ExportToArrayList",		smn_KvToArrayList},
+	{"KeyValues.ImportFromStringMap",	smn_StringMapToKv},
 
 	{NULL,						NULL}
 };
@@ -32,18 +32,49 @@
 #ifndef _INCLUDE_SOURCEMOD_KVWRAPPER_H_
 #define _INCLUDE_SOURCEMOD_KVWRAPPER_H_
 
+#include <memory>
+#include <string>
 #include <IHandleSys.h>
 #include <sh_stack.h>
+#include <sm_hashmap.h>
 
 using namespace SourceMod;
 
 class KeyValues;
 
+/**
+ * Hashed lookup of every node in a KeyValues tree, keyed by parent node and
+ * lower-cased child name. The tree must not change once it is indexed.
+ */
+class KeyValueIndex
+{
+public:
+	void Build(KeyValues *pRoot);
+
+	/* Resolves a '/'-separated path below |pNode|, like KeyValues::FindKey. */
+	KeyValues *Find(KeyValues *pNode, const char *path);
+
+	size_t GetMemUsage() const
+	{
+		return m_Nodes.mem_usage();
+	}
+
+private:
+	void MakeKey(KeyValues *pParent, const char *name, size_t length);
+
+private:
+	StringHashMap<KeyValues *> m_Nodes;
+	std::string m_Key;
+};
+
 struct KeyValueStack
 {
 	KeyValues *pBase;
 	SourceHook::CStack<KeyValues *> pCurRoot;
 	bool m_bDeleteOnDestroy = true;
+
+	/* Set once the handle is frozen; the tree is read-only from then on. */
+	std::unique_ptr<KeyValueIndex> pIndex;
 };
 
 extern HandleType_t g_KeyValueType;
@@ -760,6 +760,105 @@ static cell_t smn_PbAddVector2D(IPluginContext *pCtx, const cell_t *params)
 	return 1;
 }
 
+static cell_t smn_PbReadIntArray(IPluginContext *pCtx, const cell_t *params)
+{
+	GET_MSG_FROM_HANDLE_OR_ERR();
+	GET_FIELD_NAME_OR_ERR();
+
+	cell_t *out;
+	pCtx->LocalToPhysAddr(params[3], &out);
+
+	int count = params[4];
+	if (!msg->GetRepeatedInt32Array(strField, params[5], (int32 *)out, &count))
+	{
+		return pCtx->ThrowNativeError("Invalid field \"%s\"[%d..%d] for message \"%s\"", strField, params[5], params[5] + params[4], msg->GetProtobufMessage()->GetTypeName().c_str());
+	}
+
+	return count;
+}
+
+static cell_t smn_PbReadFloatArray(IPluginContext *pCtx, const cell_t *params)
+{
+	GET_MSG_FROM_HANDLE_OR_ERR();
+	GET_FIELD_NAME_OR_ERR();
+
+	cell_t *out;
+	pCtx->LocalToPhysAddr(params[3], &out);
+
+	int count = params[4];
+	if (!msg->GetRepeatedFloatArray(strField, params[5], (float *)out, &count))
+	{
+		return pCtx->ThrowNativeError("Invalid field \"%s\"[%d..%d] for message \"%s\"", strField, params[5], params[5] + params[4], msg->GetProtobufMessage()->GetTypeName().c_str());
+	}
+
+	return count;
+}
+
+static cell_t smn_PbReadVectorArray(IPluginContext *pCtx, const cell_t *params)
+{
+	GET_MSG_FROM_HANDLE_OR_ERR();
+	GET_FIELD_NAME_OR_ERR();
+
+	cell_t *out;
+	pCtx->LocalToPhysAddr(params[3], &out);
+
+	int count = params[4] / 3;
+	if (!msg->GetRepeatedVectorArray(strField, params[5], (float *)out, &count))
+	{
+		return pCtx->ThrowNativeError("Invalid field \"%s\"[%d..%d] for message \"%s\"", strField, params[5], params[5] + params[4] / 3, msg->GetProtobufMessage()->GetTypeName().c_str());
+	}
+
+	return count;
+}
+
+static cell_t smn_PbAddIntArray(IPluginContext *pCtx, const cell_t *params)
+{
+	GET_MSG_FROM_HANDLE_OR_ERR();
+	GET_FIELD_NAME_OR_ERR();
+
+	cell_t *values;
+	pCtx->LocalToPhysAddr(params[3], &values);
+
+	if (!msg->AddInt32Array(strField, (const int32 *)values, params[4]))
+	{
+		return pCtx->ThrowNativeError("Invalid field \"%s\" or values for message \"%s\"", strField, msg->GetProtobufMessage()->GetTypeName().c_str());
+	}
+
+	return 1;
+}
+
+static cell_t smn_PbAddFloatArray(IPluginContext *pCtx, const cell_t *params)
+{
+	GET_MSG_FROM_HANDLE_OR_ERR();
+	GET_FIELD_NAME_OR_ERR();
+
+	cell_t *values;
+	pCtx->LocalToPhysAddr(params[3], &values);
+
+	if (!msg->AddFloatArray(strField, (const float *)values, params[4]))
+	{
+		return pCtx->ThrowNativeError("Invalid field \"%s\" for message \"%s\"", strField, msg->GetProtobufMessage()->GetTypeName().c_str());
+	}
+
+	return 1;
+}
+
+static cell_t smn_PbAddVectorArray(IPluginContext *pCtx, const cell_t *params)
+{
+	GET_MSG_FROM_HANDLE_OR_ERR();
+	GET_FIELD_NAME_OR_ERR();
+
+	cell_t *values;
+	pCtx->LocalToPhysAddr(params[3], &values);
+
+	if (!msg->AddVectorArray(strField, (const float *)values, params[4]))
+	{
+		return pCtx->ThrowNativeError("Invalid field \"%s\" for message \"%s\"", strField, msg->GetProtobufMessage()->GetTypeName().c_str());
+	}
+
+	return 1;
+}
+
 static cell_t smn_PbRemoveRepeatedFieldValue(IPluginContext *pCtx, const cell_t *params)
 {
 	GET_MSG_FROM_HANDLE_OR_ERR();
@@ -886,6 +985,12 @@ REGISTER_NATIVES(protobufnatives)
 	{"Protobuf.AddAngle",					smn_PbAddAngle},
 	{"Protobuf.AddVector",					smn_PbAddVector},
 	{"Protobuf.AddVector2D",				smn_PbAddVector2D},
+	{"Protobuf.ReadIntArray",				smn_PbReadIntArray},
+	{"Protobuf.ReadFloatArray",				smn_PbReadFloatArray},
+	{"Protobuf.ReadVectorArray",			smn_PbReadVectorArray},
+	{"Protobuf.AddIntArray",				smn_PbAddIntArray},
+	{"Protobuf.AddFloatArray",				smn_PbAddFloatArray},
+	{"Protobuf.AddVectorArray",				smn_PbAddVectorArray},
 	{"Protobuf.RemoveRepeatedFieldValue",	smn_PbRemoveRepeatedFieldValue},
 	{"Protobuf.ReadMessage",				smn_PbReadMessage},
 	{"Protobuf.ReadRepeatedMessage",		smn_PbReadRepeatedMessage},
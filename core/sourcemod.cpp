@@ -38,10 +38,12 @@
 #include "sm_stringutil.h"
 #include "PlayerManager.h"
 #include "TimerSys.h"
+#include "HalfLife2.h"
 #include <IGameConfigs.h>
 #include "frame_hooks.h"
 #include "logic_bridge.h"
 #include "provider.h"
+#include "StartupTimeline.h"
 #include <amtl/os/am-shared-library.h>
 #include <amtl/os/am-path.h>
 #include <bridge/include/IExtensionBridge.h>
@@ -205,10 +207,12 @@ bool SourceModBase::InitializeSourceMod(char *error, size_t maxlength, bool late
 	ke::path::Format(m_SMBaseDir, sizeof(m_SMBaseDir), "%s/%s", g_BaseDir.c_str(), basepath);
 	ke::path::Format(m_SMRelDir, sizeof(m_SMRelDir), "%s", basepath);
 
+	StartupTimeline::Clock::time_point start = StartupTimeline::Clock::now();
 	if (!sCoreProviderImpl.LoadBridge(error, maxlength))
 	{
 		return false;
 	}
+	g_StartupTimeline.RecordStep("Logic bridge load", StartupElapsedMs(start));
 
 	/* There will always be a path by this point, since it was force-set above. */
 	m_GotBasePath = true;
@@ -220,6 +224,7 @@ bool SourceModBase::InitializeSourceMod(char *error, size_t maxlength, bool late
 #endif
 
 	/* Attempt to load the JIT! */
+	start = StartupTimeline::Clock::now();
 	char file[PLATFORM_MAX_PATH];
 	char myerror[255];
 	g_SMAPI->PathFormat(file, sizeof(file), "%s/bin/" PLATFORM_ARCH_FOLDER SOURCEPAWN_DLL ".%s",
@@ -274,6 +279,7 @@ bool SourceModBase::InitializeSourceMod(char *error, size_t maxlength, bool late
 		g_pSourcePawn2->SetJitEnabled(!sm_disable_jit);
 
 	g_pPawnEnv->SetDebugMetadataFlags(jit_metadata_flags);
+	g_StartupTimeline.RecordStep("SourcePawn load", StartupElapsedMs(start));
 
 	sSourceModInitialized = true;
 
@@ -294,6 +300,7 @@ void SourceModBase::StartSourceMod(bool late)
 {
 	SH_ADD_HOOK(IServerGameDLL, LevelShutdown, gamedll, SH_MEMBER(this, &SourceModBase::LevelShutdown), false);
 	SH_ADD_HOOK(IServerGameDLL, GameFrame, gamedll, SH_MEMBER(&g_Timers, &TimerSystem::GameFrame), false);
+	SH_ADD_HOOK(IServerGameDLL, GameFrame, gamedll, SH_MEMBER(&g_HL2, &CHalfLife2::OnGameFramePost), true);
 
 	enginePatch = SH_GET_CALLCLASS(engine);
 	gamedllPatch = SH_GET_CALLCLASS(gamedll);
@@ -301,34 +308,33 @@ void SourceModBase::StartSourceMod(bool late)
 	sCoreProviderImpl.InitializeBridge();
 
 	/* Initialize CoreConfig to get the SourceMod base path properly - this parses core.cfg */
+	StartupTimeline::Clock::time_point start = StartupTimeline::Clock::now();
 	g_CoreConfig.Initialize();
+	g_StartupTimeline.RecordStep("core.cfg", StartupElapsedMs(start));
 
 	/* Notify! */
-	SMGlobalClass *pBase = SMGlobalClass::head;
-	while (pBase)
-	{
+	g_StartupTimeline.NotifyAll("OnSourceModStartup", [](SMGlobalClass *pBase, const void *) -> void {
 		pBase->OnSourceModStartup(false);
-		pBase = pBase->m_pGlobalClassNext;
-	}
+	});
+
+	/* Independent file parsing (translations, gamedata) runs side by side. */
+	g_StartupTimeline.RunPreloads();
+
+	start = StartupTimeline::Clock::now();
 	g_pGameConf = logicore.GetCoreGameConfig();
+	g_StartupTimeline.RecordStep("Core gamedata", StartupElapsedMs(start));
 
 	sCoreProviderImpl.InitializeHooks();
 
 	/* Notify! */
-	pBase = SMGlobalClass::head;
-	while (pBase)
-	{
+	g_StartupTimeline.NotifyAll("OnSourceModAllInitialized", [](SMGlobalClass *pBase, const void *) -> void {
 		pBase->OnSourceModAllInitialized();
-		pBase = pBase->m_pGlobalClassNext;
-	}
+	});
 
 	/* Notify! */
-	pBase = SMGlobalClass::head;
-	while (pBase)
-	{
+	g_StartupTimeline.NotifyAll("OnSourceModAllInitialized_Post", [](SMGlobalClass *pBase, const void *) -> void {
 		pBase->OnSourceModAllInitialized_Post();
-		pBase = pBase->m_pGlobalClassNext;
-	}
+	});
 
 	/* Add us now... */
 	sharesys->AddInterface(NULL, this);
@@ -392,25 +398,24 @@ bool SourceModBase::LevelInit(char const *pMapName, char const *pMapEntities, ch
 	m_IsMapLoading = true;
 	m_ExecPluginReload = true;
 
+	g_StartupTimeline.BeginPhase("LevelInit");
+
 	/* Notify! */
-	SMGlobalClass *pBase = SMGlobalClass::head;
-	while (pBase)
-	{
-		pBase->OnSourceModLevelChange(pMapName);
-		pBase = pBase->m_pGlobalClassNext;
-	}
+	g_StartupTimeline.NotifyAll("OnSourceModLevelChange", [](SMGlobalClass *pBase, const void *data) -> void {
+		pBase->OnSourceModLevelChange((const char *)data);
+	}, pMapName);
 
 	DoGlobalPluginLoads();
 
 	m_IsMapLoading = false;
 
 	/* Notify! */
-	pBase = SMGlobalClass::head;
-	while (pBase)
-	{
+	g_StartupTimeline.NotifyAll("OnSourceModPluginsLoaded", [](SMGlobalClass *pBase, const void *) -> void {
 		pBase->OnSourceModPluginsLoaded();
-		pBase = pBase->m_pGlobalClassNext;
-	}
+	});
+
+	/* The first map's plugin load is the end of startup. */
+	g_StartupTimeline.Finish();
 
 	if (!g_pOnMapInit)
 	{
@@ -424,6 +429,8 @@ bool SourceModBase::LevelInit(char const *pMapName, char const *pMapEntities, ch
 
 	g_LevelEndBarrier = true;
 
+	g_StartupTimeline.BeginPhase("Entity lump and OnMapInit");
+
 	int parseError;
 	size_t position;
 	bool success = logicore.ParseEntityLumpString(pMapEntities, parseError, position);
@@ -433,6 +440,9 @@ bool SourceModBase::LevelInit(char const *pMapName, char const *pMapEntities, ch
 	g_pOnMapInit->Execute();
 	logicore.SetEntityLumpWritable(false);
 
+	g_StartupTimeline.EndPhase();
+	g_StartupTimeline.EndPhase();
+
 	if (!success)
 	{
 		logger->LogError("Map entity lump parsing for %s failed with error code %d on position %d", pMapName, parseError, position);
@@ -454,18 +464,23 @@ const char *SourceModBase::GetMapEntitiesString()
 
 void SourceModBase::LevelShutdown()
 {
+	/* Everything up to the next map's activation counts towards the change. */
+	g_StartupTimeline.BeginLevelChange();
+	g_StartupTimeline.BeginPhase("LevelShutdown");
+
 	if (g_LevelEndBarrier)
 	{
-		SMGlobalClass *next = SMGlobalClass::head;
-		while (next)
-		{
-			next->OnSourceModLevelEnd();
-			next = next->m_pGlobalClassNext;
-		}
+		g_StartupTimeline.NotifyAll("OnSourceModLevelEnd", [](SMGlobalClass *pBase, const void *) -> void {
+			pBase->OnSourceModLevelEnd();
+		});
 		
+		g_StartupTimeline.BeginPhase("OnMapEnd");
 		g_pOnMapEnd->Execute();
+		g_StartupTimeline.EndPhase();
 
+		g_StartupTimeline.BeginPhase("Extension OnCoreMapEnd");
 		extsys->CallOnCoreMapEnd();
+		g_StartupTimeline.EndPhase();
 
 		g_Timers.RemoveMapChangeTimers();
 
@@ -476,9 +491,13 @@ void SourceModBase::LevelShutdown()
 
 	if (m_ExecPluginReload)
 	{
+		g_StartupTimeline.BeginPhase("Plugin refresh");
 		scripts->RefreshAll();
+		g_StartupTimeline.EndPhase();
 		m_ExecPluginReload = false;
 	}
+
+	g_StartupTimeline.EndPhase();
 }
 
 bool SourceModBase::IsMapLoading() const
@@ -499,7 +518,9 @@ void SourceModBase::DoGlobalPluginLoads()
 		"plugins");
 
 	/* Load any auto extensions */
+	g_StartupTimeline.BeginPhase("Extension autoload");
 	extsys->TryAutoload();
+	g_StartupTimeline.EndPhase();
 
 	/* Fire the extensions ready message */
 	g_SMAPI->MetaFactory(SOURCEMOD_NOTICE_EXTENSIONS, NULL, NULL);
@@ -510,10 +531,14 @@ void SourceModBase::DoGlobalPluginLoads()
 	{
 		char path[PLATFORM_MAX_PATH];
 		ke::SafeSprintf(path, sizeof(path), "%s.ext." PLATFORM_LIB_EXT, game_ext);
+		g_StartupTimeline.BeginPhase("Game extension");
 		extsys->LoadAutoExtension(path);
+		g_StartupTimeline.EndPhase();
 	}
 
+	g_StartupTimeline.BeginPhase("Plugin load");
 	scripts->LoadAll(config_path, plugins_path);
+	g_StartupTimeline.EndPhase();
 }
 
 size_t SourceModBase::BuildPath(PathType type, char *buffer, size_t maxlength, const char *format, ...)
@@ -630,6 +655,7 @@ void SourceModBase::ShutdownServices()
 
 	SH_REMOVE_HOOK(IServerGameDLL, LevelShutdown, gamedll, SH_MEMBER(this, &SourceModBase::LevelShutdown), false);
 	SH_REMOVE_HOOK(IServerGameDLL, GameFrame, gamedll, SH_MEMBER(&g_Timers, &TimerSystem::GameFrame), false);
+	SH_REMOVE_HOOK(IServerGameDLL, GameFrame, gamedll, SH_MEMBER(&g_HL2, &CHalfLife2::OnGameFramePost), true);
 	SH_REMOVE_HOOK(IServerGameDLL, Think, gamedll, SH_MEMBER(logicore.callbacks, &IProviderCallbacks::OnThink), false);
 }
 
@@ -809,6 +835,26 @@ void SourceModBase::AddFrameAction(FRAMEACTION fn, void *data)
 	::AddFrameAction(FrameAction(fn, data));
 }
 
+void SourceModBase::PostToGameThread(FRAMEACTION fn, void *data)
+{
+	::PostFrameAction(FrameAction(fn, data));
+}
+
+bool SourceModBase::IsProfilingActive()
+{
+	return logicore.IsProfilingActive();
+}
+
+void SourceModBase::EnterProfileScope(const char *group, const char *name)
+{
+	logicore.EnterProfileScope(group, name);
+}
+
+void SourceModBase::LeaveProfileScope()
+{
+	logicore.LeaveProfileScope();
+}
+
 const char *SourceModBase::GetCoreConfigValue(const char *key)
 {
 	return g_CoreConfig.GetCoreConfigValue(key);
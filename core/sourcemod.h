@@ -137,6 +137,10 @@ public: // ISourceMod
 	bool IsMapRunning();
 	void *FromPseudoAddress(uint32_t pseudoAddr);
 	uint32_t ToPseudoAddress(void *addr);
+	void PostToGameThread(FRAMEACTION fn, void *data);
+	bool IsProfilingActive();
+	void EnterProfileScope(const char *group, const char *name);
+	void LeaveProfileScope();
 private:
 	void ShutdownServices();
 private:
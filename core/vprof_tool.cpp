@@ -40,6 +40,12 @@
 
 VProfTool sVProfTool;
 
+#if defined BUDGETFLAG_SERVER
+static const int kBudgetFlags = BUDGETFLAG_SERVER;
+#else
+static const int kBudgetFlags = 0;
+#endif
+
 void
 VProfTool::OnSourceModAllInitialized()
 {
@@ -108,7 +114,10 @@ VProfTool::EnterScope(const char *group, const char *name)
 	if (IsActive()) {
 		if (!group)
 			group = VPROF_BUDGETGROUP_OTHER_UNACCOUNTED;
-		g_VProfCurrentProfile.EnterScope(name, 1, group, false, 0);
+		// Core passes the owning plugin or extension's file name as the group
+		// around callbacks into it, so each one gets its own budget group.
+		// VProf creates groups on first use and copies their names.
+		g_VProfCurrentProfile.EnterScope(name, 1, group, false, kBudgetFlags);
 	}
 }
 
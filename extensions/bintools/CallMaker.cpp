@@ -151,16 +151,123 @@ ICallWrapper *CallMaker::CreateVCall(unsigned int vtblIdx,
 #endif
 }
 
+template <typename T>
+static inline void AppendCallKey(std::string &key, const T &value)
+{
+	key.append((const char *)&value, sizeof(T));
+}
+
+static void AppendCallKey(std::string &key, const SourceHook::PassInfo &info)
+{
+	AppendCallKey(key, info.size);
+	AppendCallKey(key, info.type);
+	AppendCallKey(key, info.flags);
+}
+
+static void AppendCallKey(std::string &key, const PassInfo *info)
+{
+	AppendCallKey(key, info->numFields);
+	for (unsigned int i=0; i<info->numFields; i++)
+	{
+		AppendCallKey(key, info->fields[i]);
+	}
+}
+
+/**
+ * Builds a canonical description of everything the JIT bakes into a call
+ * wrapper, so that identical requests can share one compiled stub.
+ */
+static std::string BuildCallKey(FuncAddrMethod method,
+								void *address,
+								const SourceHook::MemFuncInfo *info,
+								const SourceHook::ProtoInfo *protoInfo,
+								const PassInfo *retInfo,
+								const PassInfo paramInfo[],
+								unsigned int fnFlags)
+{
+	std::string key;
+	AppendCallKey(key, method);
+	if (method == FuncAddr_Direct)
+	{
+		AppendCallKey(key, address);
+	} else {
+		AppendCallKey(key, info->vtblindex);
+		AppendCallKey(key, info->vtbloffs);
+		AppendCallKey(key, info->thisptroffs);
+	}
+
+	AppendCallKey(key, protoInfo->convention);
+	AppendCallKey(key, protoInfo->numOfParams);
+	AppendCallKey(key, protoInfo->retPassInfo);
+	for (int i=1; i<=protoInfo->numOfParams; i++)
+	{
+		AppendCallKey(key, protoInfo->paramsPassInfo[i]);
+	}
+
+	/* x64 wrappers also depend on the function flags and object layouts */
+	AppendCallKey(key, fnFlags);
+	AppendCallKey(key, retInfo != NULL);
+	if (retInfo)
+	{
+		AppendCallKey(key, retInfo);
+	}
+	if (paramInfo)
+	{
+		for (int i=0; i<protoInfo->numOfParams; i++)
+		{
+			AppendCallKey(key, &paramInfo[i]);
+		}
+	}
+
+	return key;
+}
+
+CallWrapper *CallMaker2::FindCachedCall(const std::string &key)
+{
+	auto iter = m_CallCache.find(key);
+	if (iter == m_CallCache.end())
+	{
+		return NULL;
+	}
+
+	iter->second->AddRef();
+	return iter->second;
+}
+
+ICallWrapper *CallMaker2::CacheCall(const std::string &key, CallWrapper *pWrapper)
+{
+	pWrapper->SetCacheKey(key);
+	m_CallCache[key] = pWrapper;
+
+	return pWrapper;
+}
+
+void CallMaker2::RemoveCachedCall(CallWrapper *pWrapper)
+{
+	auto iter = m_CallCache.find(pWrapper->GetCacheKey());
+	if (iter != m_CallCache.end() && iter->second == pWrapper)
+	{
+		m_CallCache.erase(iter);
+	}
+}
+
 ICallWrapper *CallMaker2::CreateCall(void *address, const SourceHook::ProtoInfo *protoInfo)
 {
 #ifdef KE_ARCH_X86
-	CallWrapper *pWrapper = new CallWrapper(protoInfo);
+	std::string key = BuildCallKey(FuncAddr_Direct, address, NULL, protoInfo, NULL, NULL, 0);
+	CallWrapper *pWrapper = FindCachedCall(key);
+	if (pWrapper)
+	{
+		return pWrapper;
+	}
+
+	pWrapper = new CallWrapper(protoInfo);
 	pWrapper->SetCalleeAddr(address);
 
 	void *addr = JIT_CallCompile(pWrapper, FuncAddr_Direct);
 	pWrapper->SetCodeBaseAddr(addr);
 
-	return pWrapper;
+	return CacheCall(key, pWrapper);
 #else
 	return nullptr;
 #endif
@@ -170,13 +277,20 @@ ICallWrapper *CallMaker2::CreateVirtualCall(const SourceHook::ProtoInfo *protoIn
 											const SourceHook::MemFuncInfo *info)
 {
 #ifdef KE_ARCH_X86
-	CallWrapper *pWrapper = new CallWrapper(protoInfo);
+	std::string key = BuildCallKey(FuncAddr_VTable, NULL, info, protoInfo, NULL, NULL, 0);
+	CallWrapper *pWrapper = FindCachedCall(key);
+	if (pWrapper)
+	{
+		return pWrapper;
+	}
+
+	pWrapper = new CallWrapper(protoInfo);
 	pWrapper->SetMemFuncInfo(info);
 
 	void *addr = JIT_CallCompile(pWrapper, FuncAddr_VTable);
 	pWrapper->SetCodeBaseAddr(addr);
 
-	return pWrapper;
+	return CacheCall(key, pWrapper);
 #else
 	return nullptr;
 #endif
@@ -187,13 +301,20 @@ ICallWrapper *CallMaker2::CreateCall(void *address, const SourceHook::ProtoInfo
                                      unsigned int fnFlags)
 {
 #ifdef KE_ARCH_X64
-	CallWrapper *pWrapper = new CallWrapper(protoInfo, retInfo, paramInfo, fnFlags);
+	std::string key = BuildCallKey(FuncAddr_Direct, address, NULL, protoInfo, retInfo, paramInfo, fnFlags);
+	CallWrapper *pWrapper = FindCachedCall(key);
+	if (pWrapper)
+	{
+		return pWrapper;
+	}
+
+	pWrapper = new CallWrapper(protoInfo, retInfo, paramInfo, fnFlags);
 	pWrapper->SetCalleeAddr(address);
 
 	void *addr = JIT_CallCompile(pWrapper, FuncAddr_Direct);
 	pWrapper->SetCodeBaseAddr(addr);
 
-	return pWrapper;
+	return CacheCall(key, pWrapper);
 #else
 	return nullptr;
 #endif
@@ -206,13 +327,20 @@ ICallWrapper *CallMaker2::CreateVirtualCall(const SourceHook::ProtoInfo *protoIn
                                             unsigned int fnFlags)
 {
 #ifdef KE_ARCH_X64
-	CallWrapper *pWrapper = new CallWrapper(protoInfo, retInfo, paramInfo, fnFlags);
+	std::string key = BuildCallKey(FuncAddr_VTable, NULL, info, protoInfo, retInfo, paramInfo, fnFlags);
+	CallWrapper *pWrapper = FindCachedCall(key);
+	if (pWrapper)
+	{
+		return pWrapper;
+	}
+
+	pWrapper = new CallWrapper(protoInfo, retInfo, paramInfo, fnFlags);
 	pWrapper->SetMemFuncInfo(info);
 
 	void *addr = JIT_CallCompile(pWrapper, FuncAddr_VTable);
 	pWrapper->SetCodeBaseAddr(addr);
 
-	return pWrapper;
+	return CacheCall(key, pWrapper);
 #else
 	return nullptr;
 #endif
@@ -34,6 +34,7 @@
 
 
 #include "CallWrapper.h"
+#include <unordered_map>
 
 using namespace SourceMod;
 
@@ -67,6 +68,14 @@ public: //IBinTools2
 	ICallWrapper *CreateVirtualCall(const SourceHook::ProtoInfo *protoInfo,
 		const SourceHook::MemFuncInfo *info, const PassInfo *retInfo, 
 		const PassInfo paramInfo[], unsigned int fnFlags);
+public:
+	void RemoveCachedCall(CallWrapper *pWrapper);
+private:
+	CallWrapper *FindCachedCall(const std::string &key);
+	ICallWrapper *CacheCall(const std::string &key, CallWrapper *pWrapper);
+private:
+	/* Compiled wrappers keyed by signature and call target */
+	std::unordered_map<std::string, CallWrapper *> m_CallCache;
 #if 0
 	virtual IHookWrapper *CreateVirtualHook(SourceHook::ISourceHook *pSH, 
 		const SourceHook::ProtoInfo *protoInfo, 
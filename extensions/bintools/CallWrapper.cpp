@@ -33,7 +33,7 @@
 #include "CallWrapper.h"
 #include "CallMaker.h"
 
-CallWrapper::CallWrapper(const SourceHook::ProtoInfo *protoInfo) : m_FnFlags(0)
+CallWrapper::CallWrapper(const SourceHook::ProtoInfo *protoInfo) : m_FnFlags(0), m_RefCount(1)
 {
 	m_AddrCodeBase = NULL;
 	m_AddrCallee = NULL;
@@ -80,21 +80,35 @@ CallWrapper::CallWrapper(const SourceHook::ProtoInfo *protoInfo) : m_FnFlags(0)
 CallWrapper::CallWrapper(const SourceHook::ProtoInfo *protoInfo, const PassInfo *retInfo,
                          const PassInfo paramInfo[], unsigned int fnFlags) : CallWrapper(protoInfo)
 {
+	unsigned int argnum = protoInfo->numOfParams;
+
+	/* Wrappers can be shared between callers, so keep our own copy of the
+	 * object field lists instead of pointing into the first caller's memory.
+	 */
+	size_t numFields = retInfo ? retInfo->numFields : 0;
+	for (unsigned int i = 0; i < argnum; i++)
+	{
+		numFields += paramInfo[i].numFields;
+	}
+	m_Fields.reserve(numFields);
+
 	if (retInfo)
 	{
-		m_RetParam->fields = retInfo->fields;
+		m_RetParam->fields = m_Fields.data() + m_Fields.size();
 		m_RetParam->numFields = retInfo->numFields;
+		m_Fields.insert(m_Fields.end(), retInfo->fields, retInfo->fields + retInfo->numFields);
 	}
 	else
 	{
+		delete m_RetParam;
 		m_RetParam = nullptr;
 	}
 	
-	unsigned int argnum = protoInfo->numOfParams;
 	for (unsigned int i = 0; i < argnum; i++)
 	{
-		m_Params[i].info.fields = paramInfo[i].fields;
+		m_Params[i].info.fields = m_Fields.data() + m_Fields.size();
 		m_Params[i].info.numFields = paramInfo[i].numFields;
+		m_Fields.insert(m_Fields.end(), paramInfo[i].fields, paramInfo[i].fields + paramInfo[i].numFields);
 	}
 	
 	m_FnFlags = fnFlags;
@@ -109,6 +123,13 @@ CallWrapper::~CallWrapper()
 
 void CallWrapper::Destroy()
 {
+	if (--m_RefCount != 0)
+	{
+		return;
+	}
+
+	g_CallMaker2.RemoveCachedCall(this);
+
 	if (m_AddrCodeBase != NULL)
 	{
 		g_SPEngine->FreePageMemory(m_AddrCodeBase);
@@ -212,3 +233,18 @@ unsigned int CallWrapper::GetFunctionFlags()
 {
 	return m_FnFlags;
 }
+
+void CallWrapper::AddRef()
+{
+	m_RefCount++;
+}
+
+void CallWrapper::SetCacheKey(const std::string &key)
+{
+	m_CacheKey = key;
+}
+
+const std::string &CallWrapper::GetCacheKey()
+{
+	return m_CacheKey;
+}
@@ -34,6 +34,8 @@
 
 #include <IBinTools.h>
 #include <sourcehook_pibuilder.h>
+#include <string>
+#include <vector>
 
 using namespace SourceMod;
 
@@ -70,6 +72,10 @@ public:
 
 	void SetMemFuncInfo(const SourceHook::MemFuncInfo *funcInfo);
 	SourceHook::MemFuncInfo *GetMemFuncInfo();
+
+	void AddRef();
+	void SetCacheKey(const std::string &key);
+	const std::string &GetCacheKey();
 private:
 	PassEncode *m_Params;
 	SourceHook::ProtoInfo m_Info;
@@ -78,6 +84,9 @@ private:
 	void *m_AddrCodeBase;
 	SourceHook::MemFuncInfo m_FuncInfo;
 	unsigned int m_FnFlags;
+	std::vector<ObjectField> m_Fields;
+	unsigned int m_RefCount;
+	std::string m_CacheKey;
 };
 
 #endif //_INCLUDE_SOURCEMOD_CALLWRAPPER_H_
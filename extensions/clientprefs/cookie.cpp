@@ -88,7 +88,7 @@ Cookie *CookieManager::CreateCookie(const char *name, const char *description, C
 	}
 
 	/* First time cookie - Create from scratch */
-	pCookie = new Cookie(name, description, access);
+	pCookie = new Cookie(name, description, access, cookieList.size());
 	
 	/* Attempt to insert cookie into the db and get its ID num */
 	TQueryOp *op = new TQueryOp(Query_InsertCookie, pCookie);
@@ -104,42 +104,22 @@ Cookie *CookieManager::CreateCookie(const char *name, const char *description, C
 
 bool CookieManager::GetCookieValue(Cookie *pCookie, int client, char **value)
 {
-	CookieData *data = pCookie->data[client];
+	CookieData &data = GetClientData(client, pCookie);
+	data.present = true;
 
-	/* Check if a value has been set before */
-	if (data == NULL)
-	{
-		data = new CookieData("");
-		data->parent = pCookie;
-		clientData[client].push_back(data);
-		pCookie->data[client] = data;
-		data->changed = false;
-		data->timestamp = 0;
-	}
-
-	*value = &data->value[0];
+	*value = &data.value[0];
 
 	return true;
 }
 
 bool CookieManager::SetCookieValue(Cookie *pCookie, int client, const char *value)
 {
-	CookieData *data = pCookie->data[client];
+	CookieData &data = GetClientData(client, pCookie);
 
-	if (data == NULL)
-	{
-		data = new CookieData(value);
-		data->parent = pCookie;
-		clientData[client].push_back(data);
-		pCookie->data[client] = data;
-	}
-	else
-	{
-		UTIL_strncpy(data->value, value, MAX_VALUE_LENGTH);
-	}
-
-	data->changed = true;
-	data->timestamp = time(NULL);
+	UTIL_strncpy(data.value, value, MAX_VALUE_LENGTH);
+	data.present = true;
+	data.changed = true;
+	data.timestamp = time(NULL);
 
 	return true;
 }
@@ -170,8 +150,6 @@ void CookieManager::OnClientDisconnecting(int client)
 	statsLoaded[client] = false;
 	statsPending[client] = false;
 
-	CookieData *current = NULL;
-
 	g_ClientPrefs.AttemptReconnection();
 	
 	/* Save this cookie to the database */
@@ -185,31 +163,38 @@ void CookieManager::OnClientDisconnecting(int client)
 		g_ClientPrefs.ClearQueryCache(player->GetSerial());
 	}
 
-	std::vector<CookieData *> &clientvec = clientData[client];
+	/* All of this client's changed cookies go out in a single transaction */
+	TQueryOp *op = NULL;
+
+	std::vector<CookieData> &clientvec = clientData[client];
 	for (size_t iter = 0; iter < clientvec.size(); ++iter)
 	{
-		current = clientvec[iter];
-		dbId = current->parent->dbid;
+		CookieData &current = clientvec[iter];
+		dbId = cookieList[iter]->dbid;
 		
-		if (player == NULL || pAuth == NULL || !current->changed || dbId == -1)
+		if (player == NULL || pAuth == NULL || !current.changed || dbId == -1)
 		{
-			current->parent->data[client] = NULL;
-			delete current;
 			continue;
 		}
 
-		TQueryOp *op = new TQueryOp(Query_InsertData, client);
-
-		UTIL_strncpy(op->m_params.steamId, pAuth, MAX_NAME_LENGTH);
-		op->m_params.cookieId = dbId;
-		op->m_params.data = current;
-
-		g_ClientPrefs.AddQueryToQueue(op);
+		if (op == NULL)
+		{
+			op = new TQueryOp(Query_InsertDataBatch, client);
+			UTIL_strncpy(op->m_params.steamId, pAuth, MAX_NAME_LENGTH);
+		}
 
-		current->parent->data[client] = NULL;
+		CookieWrite write;
+		write.cookieId = dbId;
+		write.data = current;
+		op->m_params.batch.push_back(write);
 	}
 	
 	clientvec.clear();
+
+	if (op != NULL)
+	{
+		g_ClientPrefs.AddQueryToQueue(op);
+	}
 }
 
 void CookieManager::ClientConnectCallback(int serial, IQuery *data)
@@ -230,7 +215,6 @@ void CookieManager::ClientConnectCallback(int serial, IQuery *data)
 		return;
 	}
 
-	CookieData *pData;
 	IResultRow *row;
 	unsigned int timestamp;
 	CookieAccess access;
@@ -243,11 +227,6 @@ void CookieManager::ClientConnectCallback(int serial, IQuery *data)
 		const char *value = "";
 		row->GetString(1, &value, NULL);
 
-		pData = new CookieData(value);
-		pData->changed = false;
-
-		pData->timestamp = (row->GetInt(4, (int *)&timestamp) == DBVal_Data) ? timestamp : 0;
-
 		Cookie *parent = FindCookie(name);
 
 		if (parent == NULL)
@@ -261,9 +240,11 @@ void CookieManager::ClientConnectCallback(int serial, IQuery *data)
 			parent = CreateCookie(name, desc, access);
 		}
 
-		pData->parent = parent;
-		parent->data[client] = pData;
-		clientData[client].push_back(pData);
+		CookieData &cookieData = GetClientData(client, parent);
+		UTIL_strncpy(cookieData.value, value, MAX_VALUE_LENGTH);
+		cookieData.present = true;
+		cookieData.changed = false;
+		cookieData.timestamp = (row->GetInt(4, (int *)&timestamp) == DBVal_Data) ? timestamp : 0;
 	}
 
 	statsLoaded[client] = true;
@@ -367,15 +348,15 @@ void CookieManager::OnPluginDestroyed(IPlugin *plugin)
 
 bool CookieManager::GetCookieTime(Cookie *pCookie, int client, time_t *value)
 {
-	CookieData *data = pCookie->data[client];
+	std::vector<CookieData> &clientvec = clientData[client];
 
 	/* Check if a value has been set before */
-	if (data == NULL)
+	if (pCookie->index >= clientvec.size() || !clientvec[pCookie->index].present)
 	{
 		return false;
 	}
 
-	*value = data->timestamp;
+	*value = clientvec[pCookie->index].timestamp;
 
 	return true;
 }
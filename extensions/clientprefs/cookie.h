@@ -49,47 +49,48 @@ enum CookieAccess
 
 struct Cookie;
 
+/* Stored inline in each client's dense cookie array, indexed by Cookie::index */
 struct CookieData
 {
+	CookieData()
+	{
+		value[0] = '\0';
+		changed = false;
+		present = false;
+		timestamp = 0;
+	}
+
 	CookieData(const char *value)
 	{
 		UTIL_strncpy(this->value, value, MAX_VALUE_LENGTH);
+		changed = false;
+		present = true;
+		timestamp = 0;
 	}
 
 	char value[MAX_VALUE_LENGTH+1];
 	bool changed;
+	bool present;
 	time_t timestamp;
-	Cookie *parent;
 };
 
 struct Cookie
 {
-	Cookie(const char *name, const char *description, CookieAccess access)
+	Cookie(const char *name, const char *description, CookieAccess access, size_t index)
 	{
 		UTIL_strncpy(this->name, name, MAX_NAME_LENGTH);
 		UTIL_strncpy(this->description, description, MAX_DESC_LENGTH);
 
 		this->access = access;
+		this->index = index;
 
 		dbid = -1;
-
-		for (int i=0; i<=SM_MAXPLAYERS; i++)
-			data[i] = NULL;
-	}
-
-	~Cookie()
-	{
-		for (int i=0; i<=SM_MAXPLAYERS; i++)
-		{
-			if (data[i] != NULL)
-				delete data[i];
-		}
 	}
 
 	char name[MAX_NAME_LENGTH+1];
 	char description[MAX_DESC_LENGTH+1];
 	int dbid;
-	CookieData *data[SM_MAXPLAYERS+1];
+	size_t index; /* position in CookieManager::cookieList */
 	CookieAccess access;
 
 	static inline bool matches(const char *name, const Cookie *cookie)
@@ -130,6 +131,15 @@ public:
 	
 	bool AreClientCookiesPending(int client);
 
+private:
+	inline CookieData &GetClientData(int client, Cookie *pCookie)
+	{
+		std::vector<CookieData> &clientvec = clientData[client];
+		if (pCookie->index >= clientvec.size())
+			clientvec.resize(cookieList.size());
+		return clientvec[pCookie->index];
+	}
+
 public:
 	IForward *cookieDataLoadedForward;
 	std::vector<Cookie *> cookieList;
@@ -137,7 +147,7 @@ public:
 
 private:
 	NameHashSet<Cookie *> cookieFinder;
-	std::vector<CookieData *> clientData[SM_MAXPLAYERS+1];
+	std::vector<CookieData> clientData[SM_MAXPLAYERS+1];
 
 	bool connected[SM_MAXPLAYERS+1];
 	bool statsLoaded[SM_MAXPLAYERS+1];
@@ -81,7 +81,7 @@ bool ClientPrefs::SDK_OnLoad(char *error, size_t maxlength, bool late)
 
 	databaseLoading = true;
 	TQueryOp *op = new TQueryOp(Query_Connect, 0);
-	dbi->AddToThreadQueue(op, PrioQueue_High);
+	dbi->AddToConnectionQueue(op, PrioQueue_High, NULL);
 
 	dbi->AddDependency(myself, Driver);
 
@@ -203,7 +203,7 @@ void ClientPrefs::AttemptReconnection()
 	databaseLoading = true;
 	
 	TQueryOp *op = new TQueryOp(Query_Connect, 0);
-	dbi->AddToThreadQueue(op, PrioQueue_High);
+	dbi->AddToConnectionQueue(op, PrioQueue_High, NULL);
 	
 	this->CatchLateLoadClients(); /* DB reconnection, we should check if we missed anyone... */
 }
@@ -213,9 +213,12 @@ void ClientPrefs::DatabaseConnect()
 	char error[256];
 	int errCode = 0;
 
-	Database = AdoptRef(Driver->Connect(DBInfo, true, error, sizeof(error)));
+	/* The connection stays private to this operation until the tables exist;
+	 * once published, every query on it goes through its own worker queue.
+	 */
+	ke::RefPtr<IDatabase> db = AdoptRef(Driver->Connect(DBInfo, true, error, sizeof(error)));
 
-	if (!Database)
+	if (!db)
 	{
 		g_pSM->LogError(myself, error);
 		databaseLoading = false;
@@ -228,7 +231,7 @@ void ClientPrefs::DatabaseConnect()
 	{
 		g_DriverType = Driver_SQLite;
 
-		if (!Database->DoSimpleQuery(
+		if (!db->DoSimpleQuery(
 				"CREATE TABLE IF NOT EXISTS sm_cookies  \
 				( \
 					id INTEGER PRIMARY KEY AUTOINCREMENT, \
@@ -237,11 +240,11 @@ void ClientPrefs::DatabaseConnect()
 					access INTEGER \
 				)"))
 		{
-			g_pSM->LogMessage(myself, "Failed to CreateTable sm_cookies: %s", Database->GetError());
+			g_pSM->LogMessage(myself, "Failed to CreateTable sm_cookies: %s", db->GetError());
 			goto fatal_fail;
 		}
 
-		if (!Database->DoSimpleQuery(
+		if (!db->DoSimpleQuery(
 				"CREATE TABLE IF NOT EXISTS sm_cookie_cache \
 				( \
 					player varchar(65) NOT NULL, \
@@ -251,7 +254,7 @@ void ClientPrefs::DatabaseConnect()
 					PRIMARY KEY (player, cookie_id) \
 				)"))
 		{
-			g_pSM->LogMessage(myself, "Failed to CreateTable sm_cookie_cache: %s", Database->GetError());
+			g_pSM->LogMessage(myself, "Failed to CreateTable sm_cookie_cache: %s", db->GetError());
 			goto fatal_fail;
 		}
 	}
@@ -259,7 +262,7 @@ void ClientPrefs::DatabaseConnect()
 	{
 		g_DriverType = Driver_MySQL;
 
-		if (!Database->DoSimpleQuery(
+		if (!db->DoSimpleQuery(
 				"CREATE TABLE IF NOT EXISTS sm_cookies \
 				( \
 					id INTEGER unsigned NOT NULL auto_increment, \
@@ -269,11 +272,11 @@ void ClientPrefs::DatabaseConnect()
 					PRIMARY KEY (id) \
 				)"))
 		{
-			g_pSM->LogMessage(myself, "Failed to CreateTable sm_cookies: %s", Database->GetError());
+			g_pSM->LogMessage(myself, "Failed to CreateTable sm_cookies: %s", db->GetError());
 			goto fatal_fail;
 		}
 
-		if (!Database->DoSimpleQuery(
+		if (!db->DoSimpleQuery(
 				"CREATE TABLE IF NOT EXISTS sm_cookie_cache \
 				( \
 					player varchar(65) NOT NULL, \
@@ -283,7 +286,7 @@ void ClientPrefs::DatabaseConnect()
 					PRIMARY KEY (player, cookie_id) \
 				)"))
 		{
-			g_pSM->LogMessage(myself, "Failed to CreateTable sm_cookie_cache: %s", Database->GetError());
+			g_pSM->LogMessage(myself, "Failed to CreateTable sm_cookie_cache: %s", db->GetError());
 			goto fatal_fail;
 		}
 	}
@@ -291,7 +294,7 @@ void ClientPrefs::DatabaseConnect()
 	{
 		g_DriverType = Driver_PgSQL;
 		// PostgreSQL supports 'IF NOT EXISTS' as of 9.1
-		if (!Database->DoSimpleQuery(
+		if (!db->DoSimpleQuery(
 				"CREATE TABLE IF NOT EXISTS sm_cookies \
 				( \
 					id serial, \
@@ -301,11 +304,11 @@ void ClientPrefs::DatabaseConnect()
 					PRIMARY KEY (id) \
 				)"))
 		{
-			g_pSM->LogMessage(myself, "Failed to CreateTable sm_cookies: %s", Database->GetError());
+			g_pSM->LogMessage(myself, "Failed to CreateTable sm_cookies: %s", db->GetError());
 			goto fatal_fail;
 		}
 
-		if (!Database->DoSimpleQuery(
+		if (!db->DoSimpleQuery(
 				"CREATE TABLE IF NOT EXISTS sm_cookie_cache \
 				( \
 					player varchar(65) NOT NULL, \
@@ -315,11 +318,11 @@ void ClientPrefs::DatabaseConnect()
 					PRIMARY KEY (player, cookie_id) \
 				)"))
 		{
-			g_pSM->LogMessage(myself, "Failed to CreateTable sm_cookie_cache: %s", Database->GetError());
+			g_pSM->LogMessage(myself, "Failed to CreateTable sm_cookie_cache: %s", db->GetError());
 			goto fatal_fail;
 		}
 
-		if (!Database->DoSimpleQuery(
+		if (!db->DoSimpleQuery(
 				"CREATE TABLE IF NOT EXISTS sm_cookie_cache \
 				( \
 					player varchar(65) NOT NULL, \
@@ -329,11 +332,11 @@ void ClientPrefs::DatabaseConnect()
 					PRIMARY KEY (player, cookie_id) \
 				)"))
 		{
-			g_pSM->LogMessage(myself, "Failed to CreateTable sm_cookie_cache: %s", Database->GetError());
+			g_pSM->LogMessage(myself, "Failed to CreateTable sm_cookie_cache: %s", db->GetError());
 			goto fatal_fail;
 		}
 
-		if (!Database->DoSimpleQuery(
+		if (!db->DoSimpleQuery(
 				"CREATE OR REPLACE FUNCTION add_or_update_cookie(in_player VARCHAR(65), in_cookie INT, in_value VARCHAR(100), in_time INT) RETURNS VOID AS \
 					$$ \
 					BEGIN \
@@ -351,7 +354,7 @@ void ClientPrefs::DatabaseConnect()
 					END; \
 					$$ LANGUAGE plpgsql;"))
 		{
-			g_pSM->LogMessage(myself, "Failed to create function add_or_update_cookie: %s", Database->GetError());
+			g_pSM->LogMessage(myself, "Failed to create function add_or_update_cookie: %s", db->GetError());
 			goto fatal_fail;
 		}
 	}
@@ -361,17 +364,16 @@ void ClientPrefs::DatabaseConnect()
 		goto fatal_fail;
 	}
 
-	databaseLoading = false;
-
 	// Need a new scope because of the goto above.
 	{
 		std::lock_guard<std::mutex> lock(queryLock);
+		Database = db;
 		this->ProcessQueryCache();	
 	}
+	databaseLoading = false;
 	return;
 
 fatal_fail:
-	Database = NULL;
 	databaseLoading = false;
 }
 
@@ -390,7 +392,7 @@ bool ClientPrefs::AddQueryToQueue(TQueryOp *query)
 	}
 
 	query->SetDatabase(Database);
-	dbi->AddToThreadQueue(query, PrioQueue_Normal);
+	dbi->AddToConnectionQueue(query, PrioQueue_Normal, Database);
 	return true;
 }
 
@@ -403,7 +405,7 @@ void ClientPrefs::ProcessQueryCache()
 	{
 		TQueryOp *op = cachedQueries[iter];
 		op->SetDatabase(Database);
-		dbi->AddToThreadQueue(op, PrioQueue_Normal);
+		dbi->AddToConnectionQueue(op, PrioQueue_Normal, Database);
 	}
 
 	cachedQueries.clear();
@@ -136,6 +136,65 @@ void TQueryOp::SetDatabase(IDatabase *db)
 	m_driver = m_database->GetDriver();
 }
 
+bool TQueryOp::InsertData(const char *steamId, int cookieId, const CookieData *data)
+{
+	size_t ignore;
+	char query[2048];
+	char safe_id[128];
+	char safe_val[MAX_VALUE_LENGTH*2 + 1];
+
+	m_database->QuoteString(steamId,
+		safe_id,
+		sizeof(safe_id),
+		&ignore);
+	m_database->QuoteString(data->value,
+		safe_val,
+		sizeof(safe_val),
+		&ignore);
+
+	if (g_DriverType == Driver_MySQL)
+	{
+		g_pSM->Format(query, 
+			sizeof(query),
+			"INSERT INTO sm_cookie_cache (player, cookie_id, value, timestamp) 	\
+			 VALUES ('%s', %d, '%s', %d)									\
+			 ON DUPLICATE KEY UPDATE											\
+			 value = '%s', timestamp = %d",
+			safe_id,
+			cookieId,
+			safe_val,
+			(unsigned int)data->timestamp,
+			safe_val,
+			(unsigned int)data->timestamp);
+	}
+	else if (g_DriverType == Driver_SQLite)
+	{
+		g_pSM->Format(query,
+			sizeof(query),
+			"INSERT OR REPLACE INTO sm_cookie_cache						\
+			 (player, cookie_id, value, timestamp)						\
+			 VALUES ('%s', %d, '%s', %d)",
+			safe_id,
+			cookieId,
+			safe_val,
+			(unsigned int)data->timestamp);
+	}
+	else if (g_DriverType == Driver_PgSQL)
+	{
+		// Using a PL/Pgsql function, called add_or_update_cookie(),
+		// since Postgres does not have an 'OR REPLACE' functionality.
+		g_pSM->Format(query,
+			sizeof(query),
+			"SELECT add_or_update_cookie ('%s', %d, '%s', %d)",
+			safe_id,
+			cookieId,
+			safe_val,
+			(unsigned int)data->timestamp);
+	}
+
+	return m_database->DoSimpleQuery(query);
+}
+
 bool TQueryOp::BindParamsAndRun()
 {
 	size_t ignore;
@@ -222,66 +281,35 @@ bool TQueryOp::BindParamsAndRun()
 
 		case Query_InsertData:
 		{
-			char safe_id[128];
-			char safe_val[MAX_VALUE_LENGTH*2 + 1];
-
-			m_database->QuoteString(m_params.steamId,
-				safe_id,
-				sizeof(safe_id),
-				&ignore);
-			m_database->QuoteString(m_params.data->value,
-				safe_val,
-				sizeof(safe_val),
-				&ignore);
-
-			if (g_DriverType == Driver_MySQL)
-			{
-				g_pSM->Format(query, 
-					sizeof(query),
-					"INSERT INTO sm_cookie_cache (player, cookie_id, value, timestamp) 	\
-					 VALUES ('%s', %d, '%s', %d)									\
-					 ON DUPLICATE KEY UPDATE											\
-					 value = '%s', timestamp = %d",
-					safe_id,
-					m_params.cookieId,
-					safe_val,
-					(unsigned int)m_params.data->timestamp,
-					safe_val,
-					(unsigned int)m_params.data->timestamp);
-			}
-			else if (g_DriverType == Driver_SQLite)
-			{
-				g_pSM->Format(query,
-					sizeof(query),
-					"INSERT OR REPLACE INTO sm_cookie_cache						\
-					 (player, cookie_id, value, timestamp)						\
-					 VALUES ('%s', %d, '%s', %d)",
-					safe_id,
-					m_params.cookieId,
-					safe_val,
-					(unsigned int)m_params.data->timestamp);
-			}
-			else if (g_DriverType == Driver_PgSQL)
+			if (!InsertData(m_params.steamId, m_params.cookieId, m_params.data))
 			{
-				// Using a PL/Pgsql function, called add_or_update_cookie(),
-				// since Postgres does not have an 'OR REPLACE' functionality.
-				g_pSM->Format(query,
-					sizeof(query),
-					"SELECT add_or_update_cookie ('%s', %d, '%s', %d)",
-					safe_id,
-					m_params.cookieId,
-					safe_val,
-					(unsigned int)m_params.data->timestamp);
+				return false;
 			}
 
-			if (!m_database->DoSimpleQuery(query))
+			m_insertId = m_database->GetInsertID();
+
+			return true;
+		}
+
+		case Query_InsertDataBatch:
+		{
+			/* One transaction per client so the database only has to commit once */
+			if (!m_database->DoSimpleQuery("BEGIN"))
 			{
 				return false;
 			}
 
-			m_insertId = m_database->GetInsertID();
+			for (size_t iter = 0; iter < m_params.batch.size(); ++iter)
+			{
+				CookieWrite &write = m_params.batch[iter];
+				if (!InsertData(m_params.steamId, write.cookieId, &write.data))
+				{
+					m_database->DoSimpleQuery("ROLLBACK");
+					return false;
+				}
+			}
 
-			return true;
+			return m_database->DoSimpleQuery("COMMIT");
 		}
 
 		case Query_SelectId:
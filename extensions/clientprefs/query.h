@@ -43,12 +43,20 @@ enum querytype
 	Query_InsertData,
 	Query_SelectId,
 	Query_Connect,
+	Query_InsertDataBatch,
 };
 
 struct Cookie;
 struct CookieData;
 #define MAX_NAME_LENGTH 30
 
+/* A single cookie value to be written as part of a batch */
+struct CookieWrite
+{
+	int cookieId;
+	CookieData data;
+};
+
 /* This stores all the info required for our param binding until the thread is executed */
 struct ParamData
 {
@@ -63,6 +71,9 @@ struct ParamData
 
 	int cookieId;
 	CookieData *data;
+
+	/* All changed cookies of a client for InsertDataBatch queries, written in one transaction */
+	std::vector<CookieWrite> batch;
 };
 
 class TQueryOp : public IDBThreadOperation
@@ -98,6 +109,9 @@ public:
 	querytype PullQueryType();
 	int PullQuerySerial();
 
+private:
+	bool InsertData(const char *steamId, int cookieId, const CookieData *data);
+
 private:
 	IDatabase *m_database;
 	IDBDriver *m_driver;
@@ -342,6 +342,14 @@ const char *CStrike::GetExtensionDateString()
 
 void CStrike::OnPluginLoaded(IPlugin *plugin)
 {
+	bool hadPrice = m_WeaponPriceDetourEnabled;
+	bool hadTerminate = m_TerminateRoundDetourEnabled;
+	bool hadBuy = m_HandleBuyDetourEnabled;
+	bool hadDrop = m_CSWeaponDetourEnabled;
+
+	/* Install whatever this plugin needs in one go, so the game never sees half of them. */
+	CDetourManager::BeginTransaction();
+
 	if (!m_WeaponPriceDetourEnabled && g_pPriceForward->GetFunctionCount())
 	{
 		m_WeaponPriceDetourEnabled = CreateWeaponPriceDetour();
@@ -360,6 +368,30 @@ void CStrike::OnPluginLoaded(IPlugin *plugin)
 	{
 		m_CSWeaponDetourEnabled = CreateCSWeaponDropDetour();
 	}
+
+	if (CDetourManager::CommitTransaction())
+		return;
+
+	if (!hadPrice && m_WeaponPriceDetourEnabled)
+	{
+		RemoveWeaponPriceDetour();
+		m_WeaponPriceDetourEnabled = false;
+	}
+	if (!hadTerminate && m_TerminateRoundDetourEnabled)
+	{
+		RemoveTerminateRoundDetour();
+		m_TerminateRoundDetourEnabled = false;
+	}
+	if (!hadBuy && m_HandleBuyDetourEnabled)
+	{
+		RemoveHandleBuyDetour();
+		m_HandleBuyDetourEnabled = false;
+	}
+	if (!hadDrop && m_CSWeaponDetourEnabled)
+	{
+		RemoveCSWeaponDropDetour();
+		m_CSWeaponDetourEnabled = false;
+	}
 }
 
 void CStrike::OnPluginUnloaded(IPlugin *plugin)
@@ -4,6 +4,7 @@
 #include <amtl/am-string.h>
 #include <amtl/am-hashmap.h>
 #include <amtl/am-hashtable.h>
+#include <vector>
 
 #define MAX_WEAPON_NAME_LENGTH 80
 class CEconItemDefinition;
@@ -53,47 +54,64 @@ struct ItemDefHashValue
 	char m_szItemName[MAX_WEAPON_NAME_LENGTH];
 };
 
-struct StringPolicy
+// Item definitions with a price, built once after the item schema loads.
+// Def index and weapon ID lookups are direct array loads; classnames go
+// through a perfect hash (hash and displace), so any lookup touches at most
+// one entry and does a single strcmp.
+class ItemDefTable
 {
-	static inline uint32_t hash(const char *key)
+public:
+	ItemDefTable() : m_SlotMask(0)
 	{
-		return ke::FastHashCharSequence(key, strlen(key));
 	}
-	static inline bool matches(const char *find, const std::string &key)
+public:
+	void Build(std::vector<ItemDefHashValue> &&items);
+	void Clear();
+
+	bool empty() const
 	{
-		return key.compare(find) == 0;
+		return m_Items.empty();
 	}
-};
 
-struct IntegerPolicy
-{
-	static inline uint32_t hash(const int key)
+	const ItemDefHashValue *FindByDefIdx(unsigned int iDefIdx) const
 	{
-		return ke::HashInt32(key);
+		if (iDefIdx >= m_ByDefIdx.size() || m_ByDefIdx[iDefIdx] < 0)
+			return nullptr;
+		return &m_Items[m_ByDefIdx[iDefIdx]];
 	}
-	static inline bool matches(const int find, const int &key)
+
+	const ItemDefHashValue *FindByWeaponID(SMCSWeapon iWeaponID) const
 	{
-		return (key == find);
+		if ((int)iWeaponID < 0 || (size_t)iWeaponID >= m_ByWeaponID.size() || m_ByWeaponID[iWeaponID] < 0)
+			return nullptr;
+		return &m_Items[m_ByWeaponID[iWeaponID]];
 	}
-};
 
-struct WeaponIDPolicy
-{
-	static inline uint32_t hash(const SMCSWeapon key)
+	const ItemDefHashValue *FindByClassname(const char *classname) const;
+private:
+	static inline uint32_t HashName(const char *name)
 	{
-		return ke::HashInt32((int)key);
+		return ke::FastHashCharSequence(name, strlen(name));
 	}
-	static inline bool matches(const SMCSWeapon find, const SMCSWeapon &key)
+	static inline uint32_t Displace(uint32_t hash, uint32_t seed)
 	{
-		return (key == find);
+		hash ^= seed * 0x9e3779b9;
+		hash ^= hash >> 16;
+		hash *= 0x85ebca6b;
+		hash ^= hash >> 13;
+		hash *= 0xc2b2ae35;
+		hash ^= hash >> 16;
+		return hash;
 	}
+	bool BuildPerfectHash();
+private:
+	std::vector<ItemDefHashValue> m_Items;
+	std::vector<int> m_ByDefIdx;
+	std::vector<int> m_ByWeaponID;
+	std::vector<uint32_t> m_Seeds;
+	std::vector<int> m_Slots;
+	uint32_t m_SlotMask;
 };
 
-typedef ke::HashMap<std::string, ItemDefHashValue, StringPolicy> ClassnameMap;
-typedef ke::HashMap<int, ItemDefHashValue, IntegerPolicy> ItemIndexMap;
-typedef ke::HashMap<SMCSWeapon, ItemDefHashValue, WeaponIDPolicy> WeaponIDMap;
-
-extern ClassnameMap g_mapClassToDefIdx;
-extern ItemIndexMap g_mapDefIdxToClass;
-extern WeaponIDMap g_mapWeaponIDToDefIdx;
+extern ItemDefTable g_ItemDefs;
 #endif //_INCLUDE_CSTRIKE_HASH_H_
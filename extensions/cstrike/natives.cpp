@@ -387,7 +387,7 @@ static cell_t CS_TerminateRound(IPluginContext *pContext, const cell_t *params)
 static cell_t CS_WeaponIDToAlias(IPluginContext *pContext, const cell_t *params)
 {
 #if SOURCE_ENGINE == SE_CSGO
-	if(g_mapClassToDefIdx.elements() == 0)
+	if(g_ItemDefs.empty())
 		return pContext->ThrowNativeError("Failed to create weapon hashmap");
 #endif
 	if (!IsValidWeaponID(params[1]))
@@ -473,7 +473,7 @@ static cell_t CS_GetWeaponPrice(IPluginContext *pContext, const cell_t *params)
 #else
 static cell_t CS_GetWeaponPrice(IPluginContext *pContext, const cell_t *params)
 {
-	if (g_mapClassToDefIdx.elements() == 0)
+	if (g_ItemDefs.empty())
 		return pContext->ThrowNativeError("Failed to create weapon hashmap");
 
 	CBaseEntity *pEntity;
@@ -485,21 +485,21 @@ static cell_t CS_GetWeaponPrice(IPluginContext *pContext, const cell_t *params)
 	if (!IsValidWeaponID(params[2]))
 		return pContext->ThrowNativeError("Invalid WeaponID passed for this game");
 
-	WeaponIDMap::Result res = g_mapWeaponIDToDefIdx.find((SMCSWeapon)params[2]);
+	const ItemDefHashValue *pItem = g_ItemDefs.FindByWeaponID((SMCSWeapon)params[2]);
 
-	int price = res->value.m_iPrice;
+	int price = pItem->m_iPrice;
 
 	if (params[3] || weaponNameOffset == -1)
 		return price;
 
-	return CallPriceForward(params[1], res->value.m_szClassname, price);
+	return CallPriceForward(params[1], pItem->m_szClassname, price);
 }
 #endif
 
 static cell_t CS_AliasToWeaponID(IPluginContext *pContext, const cell_t *params)
 {
 #if SOURCE_ENGINE == SE_CSGO
-	if (g_mapClassToDefIdx.elements() == 0)
+	if (g_ItemDefs.empty())
 		return pContext->ThrowNativeError("Failed to create weapon hashmap");
 #endif
 	char *weapon;
@@ -932,12 +932,12 @@ static cell_t CS_UpdateClientModel(IPluginContext *pContext, const cell_t *param
 static cell_t CS_ItemDefIndexToID(IPluginContext *pContext, const cell_t *params)
 {
 #if SOURCE_ENGINE == SE_CSGO
-	ItemIndexMap::Result res = g_mapDefIdxToClass.find((uint16_t)params[1]);
+	const ItemDefHashValue *pItem = g_ItemDefs.FindByDefIdx((uint16_t)params[1]);
 
-	if (!res.found())
+	if (!pItem)
 		return  pContext->ThrowNativeError("Invalid item definition passed.");
 
-	return res->value.m_iWeaponID;
+	return pItem->m_iWeaponID;
 #else
 	return pContext->ThrowNativeError("CS_ItemDefIndexToID is not supported on this game");
 #endif
@@ -946,12 +946,12 @@ static cell_t CS_ItemDefIndexToID(IPluginContext *pContext, const cell_t *params
 static cell_t CS_WeaponIDToItemDefIndex(IPluginContext *pContext, const cell_t *params)
 {
 #if SOURCE_ENGINE == SE_CSGO
-	WeaponIDMap::Result res = g_mapWeaponIDToDefIdx.find((SMCSWeapon)params[1]);
+	const ItemDefHashValue *pItem = g_ItemDefs.FindByWeaponID((SMCSWeapon)params[1]);
 
-	if (!res.found())
+	if (!pItem)
 		return  pContext->ThrowNativeError("Invalid weapon id passed.");
 
-	return res->value.m_iDefIdx;
+	return pItem->m_iDefIdx;
 #else
 	return pContext->ThrowNativeError("CS_WeaponIDToItemDefIndex is not supported on this game");
 #endif
@@ -960,12 +960,12 @@ static cell_t CS_WeaponIDToItemDefIndex(IPluginContext *pContext, const cell_t *
 static cell_t CS_WeaponIDToLoadoutSlot(IPluginContext *pContext, const cell_t *params)
 {
 #if SOURCE_ENGINE == SE_CSGO
-	WeaponIDMap::Result res = g_mapWeaponIDToDefIdx.find((SMCSWeapon)params[1]);
+	const ItemDefHashValue *pItem = g_ItemDefs.FindByWeaponID((SMCSWeapon)params[1]);
 
-	if (!res.found())
+	if (!pItem)
 		return  pContext->ThrowNativeError("Invalid weapon id passed.");
 
-	return res->value.m_iLoadoutSlot;
+	return pItem->m_iLoadoutSlot;
 #else
 	return pContext->ThrowNativeError("CS_WeaponIDToLoadoutSlot is not supported on this game");
 #endif
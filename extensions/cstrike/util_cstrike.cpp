@@ -37,10 +37,9 @@
 
 #if SOURCE_ENGINE == SE_CSGO
 #include "itemdef-hash.h"
+#include <algorithm>
 
-ClassnameMap g_mapClassToDefIdx;
-ItemIndexMap g_mapDefIdxToClass;
-WeaponIDMap g_mapWeaponIDToDefIdx;
+ItemDefTable g_ItemDefs;
 #endif
 
 #define REGISTER_ADDR(name, defaultret, code) \
@@ -256,9 +255,7 @@ void CreateHashMaps()
 		}
 	}
 
-	g_mapClassToDefIdx.init();
-	g_mapDefIdxToClass.init();
-	g_mapWeaponIDToDefIdx.init();
+	std::vector<ItemDefHashValue> items;
 
 	CHashItemDef *map = (CHashItemDef *)((intptr_t)pSchema + iHashMapOffset);
 
@@ -285,24 +282,160 @@ void CreateHashMaps()
 				SMCSWeapon iWeaponID = GetWeaponIdFromDefIdx(iItemDefIdx);
 				int iLoadoutslot = node.pDef->GetDefaultLoadoutSlot();
 
-				ClassnameMap::Insert i = g_mapClassToDefIdx.findForAdd(classname);
-				g_mapClassToDefIdx.add(i, std::string(classname), ItemDefHashValue(iLoadoutslot, price, iWeaponID, iItemDefIdx, classname));
+				items.push_back(ItemDefHashValue(iLoadoutslot, price, iWeaponID, iItemDefIdx, classname));
+			}
+		}
+	}
+
+	g_ItemDefs.Build(std::move(items));
+}
+
+void ClearHashMaps()
+{
+	g_ItemDefs.Clear();
+}
+
+void ItemDefTable::Build(std::vector<ItemDefHashValue> &&items)
+{
+	Clear();
+	m_Items = std::move(items);
+
+	unsigned int maxDefIdx = 0;
+	int maxWeaponID = 0;
+	for (size_t i = 0; i < m_Items.size(); i++)
+	{
+		maxDefIdx = std::max(maxDefIdx, m_Items[i].m_iDefIdx);
+		maxWeaponID = std::max(maxWeaponID, (int)m_Items[i].m_iWeaponID);
+	}
+
+	m_ByDefIdx.assign(maxDefIdx + 1, -1);
+	m_ByWeaponID.assign(maxWeaponID + 1, -1);
+
+	// The first definition wins on duplicates, matching the old hash maps.
+	for (size_t i = 0; i < m_Items.size(); i++)
+	{
+		const ItemDefHashValue &item = m_Items[i];
+		if (m_ByDefIdx[item.m_iDefIdx] < 0)
+			m_ByDefIdx[item.m_iDefIdx] = (int)i;
+		if ((int)item.m_iWeaponID >= 0 && m_ByWeaponID[item.m_iWeaponID] < 0)
+			m_ByWeaponID[item.m_iWeaponID] = (int)i;
+	}
+
+	if (!BuildPerfectHash())
+	{
+		smutils->LogError(myself, "Could not build a perfect hash for %d item definitions, using a linear search", (int)m_Items.size());
+		m_Seeds.clear();
+		m_Slots.clear();
+	}
+}
+
+void ItemDefTable::Clear()
+{
+	m_Items.clear();
+	m_ByDefIdx.clear();
+	m_ByWeaponID.clear();
+	m_Seeds.clear();
+	m_Slots.clear();
+	m_SlotMask = 0;
+}
+
+bool ItemDefTable::BuildPerfectHash()
+{
+	if (m_Items.empty())
+		return true;
+
+	// Keys are spread over one bucket per item, then each bucket searches for a
+	// seed that moves all of its keys into free slots of a half-empty table.
+	uint32_t numBuckets = (uint32_t)m_Items.size();
+	uint32_t tableSize = 1;
+	while (tableSize < m_Items.size() * 2)
+		tableSize <<= 1;
+
+	std::vector<uint32_t> hashes(m_Items.size());
+	std::vector<std::vector<int>> buckets(numBuckets);
+	for (size_t i = 0; i < m_Items.size(); i++)
+	{
+		hashes[i] = HashName(m_Items[i].m_szClassname);
 
-				ItemIndexMap::Insert x = g_mapDefIdxToClass.findForAdd(iItemDefIdx);
-				g_mapDefIdxToClass.add(x, iItemDefIdx, ItemDefHashValue(iLoadoutslot, price, iWeaponID, iItemDefIdx, classname));
+		std::vector<int> &bucket = buckets[hashes[i] % numBuckets];
+		bool duplicate = false;
+		for (size_t j = 0; j < bucket.size(); j++)
+		{
+			if (strcmp(m_Items[bucket[j]].m_szClassname, m_Items[i].m_szClassname) == 0)
+			{
+				duplicate = true;
+				break;
+			}
+		}
+		if (!duplicate)
+			bucket.push_back((int)i);
+	}
 
-				WeaponIDMap::Insert t = g_mapWeaponIDToDefIdx.findForAdd(iWeaponID);
-				g_mapWeaponIDToDefIdx.add(t, iWeaponID, ItemDefHashValue(iLoadoutslot, price, iWeaponID, iItemDefIdx, classname));
+	// Place the fullest buckets first while the table is still empty.
+	std::vector<uint32_t> order(numBuckets);
+	for (uint32_t i = 0; i < numBuckets; i++)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b) {
+		return buckets[a].size() > buckets[b].size();
+	});
+
+	m_Seeds.assign(numBuckets, 0);
+	m_Slots.assign(tableSize, -1);
+	m_SlotMask = tableSize - 1;
+
+	static const uint32_t kMaxSeed = 1 << 16;
+	std::vector<uint32_t> slots;
+	for (uint32_t b : order)
+	{
+		const std::vector<int> &bucket = buckets[b];
+		if (bucket.empty())
+			break;
+
+		uint32_t seed;
+		for (seed = 1; seed < kMaxSeed; seed++)
+		{
+			slots.clear();
+			for (size_t k = 0; k < bucket.size(); k++)
+			{
+				uint32_t slot = Displace(hashes[bucket[k]], seed) & m_SlotMask;
+				if (m_Slots[slot] >= 0 || std::find(slots.begin(), slots.end(), slot) != slots.end())
+					break;
+				slots.push_back(slot);
 			}
+
+			if (slots.size() == bucket.size())
+				break;
 		}
+
+		if (seed == kMaxSeed)
+			return false;
+
+		m_Seeds[b] = seed;
+		for (size_t k = 0; k < bucket.size(); k++)
+			m_Slots[slots[k]] = bucket[k];
 	}
+
+	return true;
 }
 
-void ClearHashMaps()
+const ItemDefHashValue *ItemDefTable::FindByClassname(const char *classname) const
 {
-	g_mapClassToDefIdx.clear();
-	g_mapDefIdxToClass.clear();
-	g_mapWeaponIDToDefIdx.clear();
+	if (m_Slots.empty())
+	{
+		for (size_t i = 0; i < m_Items.size(); i++)
+		{
+			if (strcmp(m_Items[i].m_szClassname, classname) == 0)
+				return &m_Items[i];
+		}
+		return nullptr;
+	}
+
+	uint32_t hash = HashName(classname);
+	int index = m_Slots[Displace(hash, m_Seeds[hash % m_Seeds.size()]) & m_SlotMask];
+	if (index < 0 || strcmp(m_Items[index].m_szClassname, classname) != 0)
+		return nullptr;
+
+	return &m_Items[index];
 }
 
 SMCSWeapon GetWeaponIdFromDefIdx(uint16_t iDefIdx)
@@ -334,7 +467,7 @@ SMCSWeapon GetWeaponIdFromDefIdx(uint16_t iDefIdx)
 		return weaponIDMap[iDefIdx];
 }
 
-ItemDefHashValue *GetHashValueFromWeapon(const char *szWeapon)
+const ItemDefHashValue *GetHashValueFromWeapon(const char *szWeapon)
 {
 	char tempWeapon[MAX_WEAPON_NAME_LENGTH];
 
@@ -350,21 +483,16 @@ ItemDefHashValue *GetHashValueFromWeapon(const char *szWeapon)
 			char classname[MAX_WEAPON_NAME_LENGTH];
 			ke::SafeSprintf(classname, sizeof(classname), "%s%s", szClassPrefixs[i], tempWeapon);
 
-			ClassnameMap::Result res = g_mapClassToDefIdx.find(classname);
+			const ItemDefHashValue *pItem = g_ItemDefs.FindByClassname(classname);
 
-			if (res.found())
-				return &res->value;
+			if (pItem)
+				return pItem;
 		}
 
 		return NULL;
 	}
 
-	ClassnameMap::Result res = g_mapClassToDefIdx.find(tempWeapon);
-
-	if (res.found())
-		return &res->value;
-
-	return NULL;
+	return g_ItemDefs.FindByClassname(tempWeapon);
 }
 #endif
 
@@ -490,7 +618,7 @@ int AliasToWeaponID(const char *weapon)
 
 	return weaponID;
 #else
-	ItemDefHashValue *pHashValue = GetHashValueFromWeapon(weapon);
+	const ItemDefHashValue *pHashValue = GetHashValueFromWeapon(weapon);
 
 	if (pHashValue)
 		return pHashValue->m_iWeaponID;
@@ -525,10 +653,10 @@ const char *WeaponIDToAlias(int weaponID)
 
 	return alias;
 #else
-	WeaponIDMap::Result res = g_mapWeaponIDToDefIdx.find((SMCSWeapon)weaponID);
+	const ItemDefHashValue *pItem = g_ItemDefs.FindByWeaponID((SMCSWeapon)weaponID);
 
-	if (res.found())
-		return res->value.m_szItemName;
+	if (pItem)
+		return pItem->m_szItemName;
 
 	return NULL;
 #endif
@@ -539,8 +667,7 @@ bool IsValidWeaponID(int id)
 	if (id <= (int)SMCSWeapon_NONE)
 		return false;
 #if SOURCE_ENGINE == SE_CSGO
-	WeaponIDMap::Result res = g_mapWeaponIDToDefIdx.find((SMCSWeapon)id);
-	if (!res.found())
+	if (!g_ItemDefs.FindByWeaponID((SMCSWeapon)id))
 		return false;
 #else
 	else if (id > SMCSWeapon_NIGHTVISION || !GetWeaponInfo(id))
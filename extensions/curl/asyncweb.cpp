@@ -0,0 +1,472 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Webternet Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#include "asyncweb.h"
+#include <chrono>
+
+#if !defined _WIN32
+#include <sys/select.h>
+#endif
+
+/* How long the transfer thread waits on sockets before looking for new and aborted requests. */
+#define MAX_WAIT_MS		50
+
+AsyncWebClient g_AsyncWebClient;
+
+WebRequest::WebRequest(AsyncWebClient *_client, CURL *_curl)
+	: client(_client), curl(_curl), headers(NULL), stream(false), handler(NULL), userdata(NULL),
+	  started(false), inFlight(false), closed(false), aborted(false), responseCode(0),
+	  result(CURLE_OK)
+{
+	errorBuffer[0] = '\0';
+}
+
+WebRequest::~WebRequest()
+{
+	curl_easy_cleanup(curl);
+	curl_slist_free_all(headers);
+}
+
+bool WebRequest::AddHeader(const char *header)
+{
+	if (started)
+	{
+		return false;
+	}
+
+	curl_slist *list = curl_slist_append(headers, header);
+	if (list == NULL)
+	{
+		return false;
+	}
+	headers = list;
+	return true;
+}
+
+bool WebRequest::SetMethod(const char *_method)
+{
+	if (started)
+	{
+		return false;
+	}
+
+	method = _method;
+	if (curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str()))
+	{
+		return false;
+	}
+	return curl_easy_setopt(curl, CURLOPT_NOBODY, method == "HEAD" ? 1 : 0) == CURLE_OK;
+}
+
+bool WebRequest::SetBody(const void *data, size_t length)
+{
+	if (started)
+	{
+		return false;
+	}
+
+	body.assign((const char *)data, length);
+	if (curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)body.size()))
+	{
+		return false;
+	}
+	return curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.data()) == CURLE_OK;
+}
+
+void WebRequest::SetTimeout(unsigned int seconds)
+{
+	if (!started)
+	{
+		curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)seconds);
+	}
+}
+
+void WebRequest::SetFailOnHTTPError(bool fail)
+{
+	if (!started)
+	{
+		curl_easy_setopt(curl, CURLOPT_FAILONERROR, fail ? 1 : 0);
+	}
+}
+
+void WebRequest::SetStreamBody(bool _stream)
+{
+	if (!started)
+	{
+		stream = _stream;
+	}
+}
+
+bool WebRequest::Start(IWebRequestHandler *_handler, void *_userdata)
+{
+	if (started)
+	{
+		return false;
+	}
+
+	if (headers && curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers))
+	{
+		return false;
+	}
+
+	started = true;
+	handler = _handler;
+	userdata = _userdata;
+	client->Queue(this);
+	return true;
+}
+
+int WebRequest::GetResponseCode()
+{
+	return (int)responseCode;
+}
+
+const char *WebRequest::LastErrorMessage()
+{
+	return errorBuffer;
+}
+
+const void *WebRequest::GetResponseBody(size_t *length)
+{
+	*length = response.size();
+	return response.data();
+}
+
+void WebRequest::Close()
+{
+	if (closed)
+	{
+		return;
+	}
+
+	closed = true;
+	if (inFlight)
+	{
+		/* The client frees it once the transfer thread lets go of it. */
+		aborted = true;
+		return;
+	}
+
+	delete this;
+}
+
+size_t WebRequest::OnWrite(void *ptr, size_t size, size_t nmemb, void *_stream)
+{
+	WebRequest *request = (WebRequest *)_stream;
+
+	if (request->aborted)
+	{
+		/* Return a differing amount */
+		return (size == 0 || nmemb == 0) ? 1 : 0;
+	}
+
+	if (request->stream)
+	{
+		request->client->PostData(request, ptr, size * nmemb);
+	}
+	else
+	{
+		request->response.append((const char *)ptr, size * nmemb);
+	}
+
+	return size * nmemb;
+}
+
+AsyncWebClient::AsyncWebClient() : shuttingDown(false)
+{
+}
+
+bool AsyncWebClient::Start()
+{
+	shuttingDown = false;
+	worker = std::thread(&AsyncWebClient::Run, this);
+	return true;
+}
+
+void AsyncWebClient::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		shuttingDown = true;
+	}
+	wakeup.notify_one();
+
+	if (worker.joinable())
+	{
+		worker.join();
+	}
+
+	/* Nobody is left to hear about these. */
+	for (WebRequest *request : running)
+	{
+		delete request;
+	}
+	running.clear();
+	queued.clear();
+	events.clear();
+}
+
+WebRequest *AsyncWebClient::CreateRequest(const char *url)
+{
+	CURL *curl = curl_easy_init();
+	if (curl == NULL)
+	{
+		return NULL;
+	}
+
+	WebRequest *request = new WebRequest(this, curl);
+
+	if (curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, request->errorBuffer)
+		|| curl_easy_setopt(curl, CURLOPT_URL, url))
+	{
+		delete request;
+		return NULL;
+	}
+	curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1);
+	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WebRequest::OnWrite);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, request);
+	curl_easy_setopt(curl, CURLOPT_PRIVATE, request);
+
+	return request;
+}
+
+void AsyncWebClient::Queue(WebRequest *request)
+{
+	request->inFlight = true;
+	running.insert(request);
+
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		queued.push_back(request);
+	}
+	wakeup.notify_one();
+}
+
+void AsyncWebClient::RunEvents()
+{
+	std::deque<Event> ready;
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		if (events.empty())
+		{
+			return;
+		}
+		ready.swap(events);
+	}
+
+	/* A request's completion is always its last event, so nothing below touches it after. */
+	for (Event &event : ready)
+	{
+		WebRequest *request = event.request;
+		if (event.done)
+		{
+			Complete(request);
+			continue;
+		}
+
+		if (request->closed || request->aborted)
+		{
+			continue;
+		}
+
+		DownloadWriteStatus status = request->handler->OnRequestData(request,
+			request->userdata,
+			event.data.data(),
+			event.data.size());
+		if (status != DownloadWrite_Okay)
+		{
+			request->aborted = true;
+		}
+	}
+}
+
+void AsyncWebClient::Complete(WebRequest *request)
+{
+	request->inFlight = false;
+	running.erase(request);
+
+	if (request->closed)
+	{
+		delete request;
+		return;
+	}
+
+	request->handler->OnRequestComplete(request, request->userdata, request->result == CURLE_OK);
+}
+
+void AsyncWebClient::PostData(WebRequest *request, const void *data, size_t length)
+{
+	std::lock_guard<std::mutex> lock(queueLock);
+	events.emplace_back();
+	events.back().request = request;
+	events.back().done = false;
+	events.back().data.assign((const char *)data, length);
+}
+
+void AsyncWebClient::PostDone(WebRequest *request)
+{
+	std::lock_guard<std::mutex> lock(queueLock);
+	events.emplace_back();
+	events.back().request = request;
+	events.back().done = true;
+}
+
+void AsyncWebClient::Run()
+{
+	CURLM *multi = curl_multi_init();
+	curl_multi_setopt(multi, CURLMOPT_PIPELINING, 1L);
+
+	std::vector<WebRequest *> active;
+	std::vector<WebRequest *> added;
+	int stillRunning = 0;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(queueLock);
+			if (active.empty())
+			{
+				wakeup.wait(lock, [this] { return shuttingDown || !queued.empty(); });
+			}
+			if (shuttingDown)
+			{
+				break;
+			}
+			added.swap(queued);
+		}
+
+		for (WebRequest *request : added)
+		{
+			if (curl_multi_add_handle(multi, request->curl) != CURLM_OK)
+			{
+				request->result = CURLE_FAILED_INIT;
+				PostDone(request);
+				continue;
+			}
+			active.push_back(request);
+		}
+		added.clear();
+
+		/* Requests closed on the game thread may be waiting on a slow server; drop them now. */
+		for (size_t i = 0; i < active.size(); )
+		{
+			WebRequest *request = active[i];
+			if (!request->aborted)
+			{
+				i++;
+				continue;
+			}
+
+			curl_multi_remove_handle(multi, request->curl);
+			request->result = CURLE_ABORTED_BY_CALLBACK;
+			active[i] = active.back();
+			active.pop_back();
+			PostDone(request);
+		}
+
+		while (curl_multi_perform(multi, &stillRunning) == CURLM_CALL_MULTI_PERFORM)
+		{
+		}
+
+		CURLMsg *msg;
+		int left;
+		while ((msg = curl_multi_info_read(multi, &left)) != NULL)
+		{
+			if (msg->msg != CURLMSG_DONE)
+			{
+				continue;
+			}
+
+			CURL *easy = msg->easy_handle;
+			CURLcode result = msg->data.result;
+
+			WebRequest *request;
+			curl_easy_getinfo(easy, CURLINFO_PRIVATE, (char **)&request);
+			curl_multi_remove_handle(multi, easy);
+
+			request->result = result;
+			curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &request->responseCode);
+
+			for (size_t i = 0; i < active.size(); i++)
+			{
+				if (active[i] == request)
+				{
+					active[i] = active.back();
+					active.pop_back();
+					break;
+				}
+			}
+			PostDone(request);
+		}
+
+		if (active.empty())
+		{
+			continue;
+		}
+
+		long timeout = -1;
+		curl_multi_timeout(multi, &timeout);
+		if (timeout < 0 || timeout > MAX_WAIT_MS)
+		{
+			timeout = MAX_WAIT_MS;
+		}
+		if (timeout == 0)
+		{
+			continue;
+		}
+
+		fd_set readSet, writeSet, errorSet;
+		FD_ZERO(&readSet);
+		FD_ZERO(&writeSet);
+		FD_ZERO(&errorSet);
+
+		int maxfd = -1;
+		curl_multi_fdset(multi, &readSet, &writeSet, &errorSet, &maxfd);
+		if (maxfd == -1)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+			continue;
+		}
+
+		timeval tv;
+		tv.tv_sec = timeout / 1000;
+		tv.tv_usec = (timeout % 1000) * 1000;
+		select(maxfd + 1, &readSet, &writeSet, &errorSet, &tv);
+	}
+
+	for (WebRequest *request : active)
+	{
+		curl_multi_remove_handle(multi, request->curl);
+	}
+	curl_multi_cleanup(multi);
+}
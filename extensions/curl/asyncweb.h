@@ -0,0 +1,143 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Webternet Extension
+ * Copyright (C) 2004-2008 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#ifndef _INCLUDE_SOURCEMOD_CURL_ASYNCWEB_H_
+#define _INCLUDE_SOURCEMOD_CURL_ASYNCWEB_H_
+
+#include <IWebternet.h>
+#include <curl/curl.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace SourceMod;
+
+class AsyncWebClient;
+
+class WebRequest : public IWebRequest
+{
+	friend class AsyncWebClient;
+public:
+	WebRequest(AsyncWebClient *client, CURL *curl);
+	~WebRequest();
+public:
+	bool AddHeader(const char *header);
+	bool SetMethod(const char *method);
+	bool SetBody(const void *data, size_t length);
+	void SetTimeout(unsigned int seconds);
+	void SetFailOnHTTPError(bool fail);
+	void SetStreamBody(bool stream);
+	bool Start(IWebRequestHandler *handler, void *userdata);
+	int GetResponseCode();
+	const char *LastErrorMessage();
+	const void *GetResponseBody(size_t *length);
+	void Close();
+private:
+	static size_t OnWrite(void *ptr, size_t size, size_t nmemb, void *stream);
+private:
+	AsyncWebClient *client;
+	CURL *curl;
+	curl_slist *headers;
+	std::string body;
+	std::string method;
+	bool stream;
+	IWebRequestHandler *handler;
+	void *userdata;
+
+	/* Game thread only. */
+	bool started;
+	bool inFlight;
+	bool closed;
+
+	/* Set on the game thread to make the transfer thread give up. */
+	std::atomic<bool> aborted;
+
+	/* Written by the transfer thread while in flight, read on the game thread after. */
+	std::string response;
+	long responseCode;
+	CURLcode result;
+	char errorBuffer[CURL_ERROR_SIZE];
+};
+
+/**
+ * Runs every WebRequest on one curl multi handle, driven by a worker thread.
+ * The multi handle's connection cache lets requests to the same host reuse a
+ * kept-alive connection, and pipelining is enabled.  Results go through an
+ * event queue that the game thread drains each frame.
+ */
+class AsyncWebClient
+{
+public:
+	AsyncWebClient();
+public:
+	bool Start();
+	void Shutdown();
+
+	WebRequest *CreateRequest(const char *url);
+
+	/* Game thread. */
+	void Queue(WebRequest *request);
+	void RunEvents();
+
+	/* Transfer thread. */
+	void PostData(WebRequest *request, const void *data, size_t length);
+private:
+	struct Event
+	{
+		WebRequest *request;
+		bool done;
+		std::string data;
+	};
+
+	void Run();
+	void PostDone(WebRequest *request);
+	void Complete(WebRequest *request);
+private:
+	std::thread worker;
+	std::mutex queueLock;
+	std::condition_variable wakeup;
+	bool shuttingDown;
+	std::vector<WebRequest *> queued;
+	std::deque<Event> events;
+
+	/* Game thread only: every request between Queue() and its completion. */
+	std::unordered_set<WebRequest *> running;
+};
+
+extern AsyncWebClient g_AsyncWebClient;
+
+#endif /* _INCLUDE_SOURCEMOD_CURL_ASYNCWEB_H_ */
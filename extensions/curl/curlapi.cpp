@@ -1,4 +1,5 @@
 #include "curlapi.h"
+#include "asyncweb.h"
 
 Webternet g_webternet;
 
@@ -206,3 +207,8 @@ IWebForm *Webternet::CreateForm()
 {
 	return new WebForm();
 }
+
+IWebRequest *Webternet::CreateRequest(const char *url)
+{
+	return g_AsyncWebClient.CreateRequest(url);
+}
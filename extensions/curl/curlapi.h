@@ -83,6 +83,7 @@ public:
 public:
 	IWebTransfer *CreateSession();
 	IWebForm *CreateForm();
+	IWebRequest *CreateRequest(const char *url);
 };
 
 extern Webternet g_webternet;
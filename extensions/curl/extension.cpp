@@ -35,6 +35,9 @@
 #include <sm_platform.h>
 #include <curl/curl.h>
 #include "curlapi.h"
+#include "asyncweb.h"
+#include <atomic>
+#include <string>
 
 /**
  * @file extension.cpp
@@ -45,6 +48,79 @@ CurlExt curl_ext;		/**< Global singleton for extension's main interface */
 
 SMEXT_LINK(&curl_ext);
 
+HandleType_t g_WebRequestType = 0;
+
+/**
+ * Backs a plugin's WebRequest handle and forwards its results to the plugin's
+ * callbacks.
+ */
+class PluginWebRequest : public IWebRequestHandler
+{
+public:
+	PluginWebRequest(IWebRequest *request) : request(request), hndl(BAD_HANDLE),
+		onComplete(NULL), onData(NULL), data(0), sent(false), complete(false)
+	{
+	}
+	~PluginWebRequest()
+	{
+		request->Close();
+	}
+public:
+	DownloadWriteStatus OnRequestData(IWebRequest *req, void *userdata, const void *ptr, size_t length)
+	{
+		/* Plugins treat the block as a string, so keep a terminator after it. */
+		std::string block((const char *)ptr, length);
+
+		cell_t keepGoing = 1;
+		onData->PushCell(hndl);
+		onData->PushStringEx(&block[0], length + 1, SM_PARAM_STRING_COPY|SM_PARAM_STRING_BINARY, 0);
+		onData->PushCell((cell_t)length);
+		onData->PushCell(data);
+		onData->Execute(&keepGoing);
+
+		return keepGoing ? DownloadWrite_Okay : DownloadWrite_Error;
+	}
+	void OnRequestComplete(IWebRequest *req, void *userdata, bool success)
+	{
+		/* The transfer thread is done with the response; publish that before any plugin code
+		 * can ask for it.  The plugin may delete the handle, and with it this object, from
+		 * the callback.
+		 */
+		complete.store(true, std::memory_order_release);
+
+		onComplete->PushCell(hndl);
+		onComplete->PushCell(success ? 1 : 0);
+		onComplete->PushCell(req->GetResponseCode());
+		onComplete->PushString(success ? "" : req->LastErrorMessage());
+		onComplete->PushCell(data);
+		onComplete->Execute(NULL);
+	}
+public:
+	IWebRequest *request;
+	Handle_t hndl;
+	IPluginFunction *onComplete;
+	IPluginFunction *onData;
+	cell_t data;
+	bool sent;
+	std::atomic<bool> complete;
+};
+
+class WebRequestTypeHandler : public IHandleTypeDispatch
+{
+public:
+	void OnHandleDestroy(HandleType_t type, void *object)
+	{
+		delete (PluginWebRequest *)object;
+	}
+};
+
+WebRequestTypeHandler g_WebRequestTypeHandler;
+
+static void RunWebEvents(bool simulating)
+{
+	g_AsyncWebClient.RunEvents();
+}
+
 bool CurlExt::SDK_OnLoad(char *error, size_t maxlength, bool late)
 {
 	long flags;
@@ -68,11 +144,20 @@ bool CurlExt::SDK_OnLoad(char *error, size_t maxlength, bool late)
 		return false;
 	}
 
+	g_AsyncWebClient.Start();
+	smutils->AddGameFrameHook(RunWebEvents);
+
+	g_WebRequestType = handlesys->CreateType("WebRequest", &g_WebRequestTypeHandler, 0, NULL, NULL, myself->GetIdentity(), NULL);
+	sharesys->AddNatives(myself, webternet_natives);
+
 	return true;
 }
 
 void CurlExt::SDK_OnUnload()
 {
+	handlesys->RemoveType(g_WebRequestType, myself->GetIdentity());
+	smutils->RemoveGameFrameHook(RunWebEvents);
+	g_AsyncWebClient.Shutdown();
 	curl_global_cleanup();
 }
 
@@ -86,3 +171,233 @@ const char *CurlExt::GetExtensionDateString()
 	return SOURCEMOD_BUILD_TIME;
 }
 
+static PluginWebRequest *ReadWebRequest(IPluginContext *pContext, cell_t param)
+{
+	Handle_t hndl = static_cast<Handle_t>(param);
+	HandleSecurity sec(pContext->GetIdentity(), myself->GetIdentity());
+	HandleError err;
+
+	PluginWebRequest *req;
+	if ((err = handlesys->ReadHandle(hndl, g_WebRequestType, &sec, (void **)&req)) != HandleError_None)
+	{
+		pContext->ThrowNativeError("Invalid WebRequest handle %x (error %d)", hndl, err);
+		return NULL;
+	}
+	return req;
+}
+
+static PluginWebRequest *ReadUnsentWebRequest(IPluginContext *pContext, cell_t param)
+{
+	PluginWebRequest *req = ReadWebRequest(pContext, param);
+	if (req && req->sent)
+	{
+		pContext->ThrowNativeError("WebRequest has already been sent");
+		return NULL;
+	}
+	return req;
+}
+
+static bool IsRequestInProgress(PluginWebRequest *req)
+{
+	return req->sent && !req->complete.load(std::memory_order_acquire);
+}
+
+static cell_t WebRequest_Create(IPluginContext *pContext, const cell_t *params)
+{
+	char *url;
+	pContext->LocalToString(params[1], &url);
+
+	IWebRequest *request = g_webternet.CreateRequest(url);
+	if (!request)
+	{
+		return pContext->ThrowNativeError("Could not create web request");
+	}
+
+	PluginWebRequest *req = new PluginWebRequest(request);
+	HandleError err;
+	req->hndl = handlesys->CreateHandle(g_WebRequestType, req, pContext->GetIdentity(), myself->GetIdentity(), &err);
+	if (req->hndl == BAD_HANDLE)
+	{
+		delete req;
+		return pContext->ThrowNativeError("Could not create WebRequest handle (error %d)", err);
+	}
+
+	return req->hndl;
+}
+
+static cell_t WebRequest_AddHeader(IPluginContext *pContext, const cell_t *params)
+{
+	PluginWebRequest *req = ReadUnsentWebRequest(pContext, params[1]);
+	if (!req)
+	{
+		return 0;
+	}
+
+	char *name, *value;
+	pContext->LocalToString(params[2], &name);
+	pContext->LocalToString(params[3], &value);
+
+	std::string header(name);
+	header.append(": ");
+	header.append(value);
+
+	return req->request->AddHeader(header.c_str()) ? 1 : 0;
+}
+
+static cell_t WebRequest_SetMethod(IPluginContext *pContext, const cell_t *params)
+{
+	PluginWebRequest *req = ReadUnsentWebRequest(pContext, params[1]);
+	if (!req)
+	{
+		return 0;
+	}
+
+	char *method;
+	pContext->LocalToString(params[2], &method);
+
+	return req->request->SetMethod(method) ? 1 : 0;
+}
+
+static cell_t WebRequest_SetBody(IPluginContext *pContext, const cell_t *params)
+{
+	PluginWebRequest *req = ReadUnsentWebRequest(pContext, params[1]);
+	if (!req)
+	{
+		return 0;
+	}
+
+	char *body;
+	pContext->LocalToString(params[2], &body);
+
+	size_t length = params[3] < 0 ? strlen(body) : static_cast<size_t>(params[3]);
+
+	return req->request->SetBody(body, length) ? 1 : 0;
+}
+
+static cell_t WebRequest_SetTimeout(IPluginContext *pContext, const cell_t *params)
+{
+	PluginWebRequest *req = ReadUnsentWebRequest(pContext, params[1]);
+	if (!req)
+	{
+		return 0;
+	}
+
+	if (params[2] < 0)
+	{
+		return pContext->ThrowNativeError("Invalid timeout %d", params[2]);
+	}
+
+	req->request->SetTimeout(static_cast<unsigned int>(params[2]));
+	return 1;
+}
+
+static cell_t WebRequest_Send(IPluginContext *pContext, const cell_t *params)
+{
+	PluginWebRequest *req = ReadUnsentWebRequest(pContext, params[1]);
+	if (!req)
+	{
+		return 0;
+	}
+
+	IPluginFunction *onComplete = pContext->GetFunctionById(static_cast<funcid_t>(params[2]));
+	if (!onComplete)
+	{
+		return pContext->ThrowNativeError("Invalid completion function %x", params[2]);
+	}
+
+	IPluginFunction *onData = NULL;
+	if (params[3] != -1)
+	{
+		onData = pContext->GetFunctionById(static_cast<funcid_t>(params[3]));
+		if (!onData)
+		{
+			return pContext->ThrowNativeError("Invalid data function %x", params[3]);
+		}
+	}
+
+	req->onComplete = onComplete;
+	req->onData = onData;
+	req->data = params[4];
+	req->request->SetStreamBody(onData != NULL);
+
+	if (!req->request->Start(req, NULL))
+	{
+		return 0;
+	}
+
+	req->sent = true;
+	return 1;
+}
+
+static cell_t WebRequest_GetResponse(IPluginContext *pContext, const cell_t *params)
+{
+	PluginWebRequest *req = ReadWebRequest(pContext, params[1]);
+	if (!req)
+	{
+		return 0;
+	}
+	if (IsRequestInProgress(req))
+	{
+		return pContext->ThrowNativeError("WebRequest is still in progress");
+	}
+
+	size_t length;
+	const char *body = (const char *)req->request->GetResponseBody(&length);
+
+	char *buffer;
+	pContext->LocalToString(params[2], &buffer);
+
+	size_t maxlength = params[3] > 0 ? static_cast<size_t>(params[3]) : 0;
+	if (!maxlength)
+	{
+		return 0;
+	}
+
+	size_t copied = length < maxlength - 1 ? length : maxlength - 1;
+	memcpy(buffer, body, copied);
+	buffer[copied] = '\0';
+
+	return static_cast<cell_t>(copied);
+}
+
+static cell_t WebRequest_ResponseLength(IPluginContext *pContext, const cell_t *params)
+{
+	PluginWebRequest *req = ReadWebRequest(pContext, params[1]);
+	if (!req)
+	{
+		return 0;
+	}
+	if (IsRequestInProgress(req))
+	{
+		return pContext->ThrowNativeError("WebRequest is still in progress");
+	}
+
+	size_t length;
+	req->request->GetResponseBody(&length);
+	return static_cast<cell_t>(length);
+}
+
+static cell_t WebRequest_Status(IPluginContext *pContext, const cell_t *params)
+{
+	PluginWebRequest *req = ReadWebRequest(pContext, params[1]);
+	if (!req || IsRequestInProgress(req))
+	{
+		return 0;
+	}
+
+	return req->request->GetResponseCode();
+}
+
+const sp_nativeinfo_t webternet_natives[] =
+{
+	{"WebRequest.WebRequest",			WebRequest_Create},
+	{"WebRequest.AddHeader",			WebRequest_AddHeader},
+	{"WebRequest.SetMethod",			WebRequest_SetMethod},
+	{"WebRequest.SetBody",				WebRequest_SetBody},
+	{"WebRequest.SetTimeout",			WebRequest_SetTimeout},
+	{"WebRequest.Send",					WebRequest_Send},
+	{"WebRequest.GetResponse",			WebRequest_GetResponse},
+	{"WebRequest.ResponseLength.get",	WebRequest_ResponseLength},
+	{"WebRequest.Status.get",			WebRequest_Status},
+	{NULL,								NULL},
+};
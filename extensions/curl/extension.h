@@ -118,6 +118,8 @@ public:
 #endif
 };
 
+extern const sp_nativeinfo_t webternet_natives[];
+
 size_t UTIL_Format(char *buffer, size_t maxlength, const char *fmt, ...);
 size_t UTIL_FormatArgs(char *buffer, size_t maxlength, const char *fmt, va_list ap);
 
@@ -370,12 +370,15 @@ ReturnAction_t HandleDetour(HookType_t hookType, CHook* pDetour)
 		ReturnAction_t tempRet = ReturnAction_Ignored;
 		uint8_t *tempRetBuf = nullptr;
 
+		// Skip plugins whose filters reject this call without entering SourcePawn.
+		if (!pWrapper->filters.empty() && !pWrapper->PassesFilters())
+			continue;
+
 		// Find the this pointer for thiscalls.
 		// Don't even try to load it if the plugin doesn't care and set it to be ignored.
 		if (pWrapper->callConv == CallConv_THISCALL && pWrapper->thisType != ThisPointer_Ignore)
 		{
-			// The this pointer is implicitly always the first argument.
-			void *thisPtr = pDetour->GetArgument<void *>(0);
+			void *thisPtr = pWrapper->GetThisPointer();
 			cell_t thisAddr = GetThisPtr(pCallback->GetParentContext(), thisPtr, pWrapper->thisType);
 			pCallback->PushCell(thisAddr);
 		}
@@ -393,7 +396,7 @@ ReturnAction_t HandleDetour(HookType_t hookType, CHook* pDetour)
 				pCallback->GetParentRuntime()->GetDefaultContext()->BlamePluginError(pCallback, "Error creating ReturnHandle in preparation to call hook callback. (error %d)", err);
 
 				if (returnStruct)
-					delete returnStruct;
+					ReleaseReturnStruct(returnStruct);
 
 				// Don't call more callbacks. They will probably fail too.
 				break;
@@ -421,7 +424,7 @@ ReturnAction_t HandleDetour(HookType_t hookType, CHook* pDetour)
 				}
 
 				if (paramStruct)
-					delete paramStruct;
+					ReleaseParamStruct(paramStruct);
 
 				// Don't call more callbacks. They will probably fail too.
 				break;
@@ -522,6 +525,7 @@ ReturnAction_t HandleDetour(HookType_t hookType, CHook* pDetour)
 CDynamicHooksSourcePawn::CDynamicHooksSourcePawn(HookSetup *setup, CHook *pDetour, IPluginFunction *pCallback, bool post)
 {
 	this->params = setup->params;
+	this->filters = setup->filters;
 	this->offset = -1;
 	this->returnFlag = setup->returnFlag;
 	this->returnType = setup->returnType;
@@ -537,8 +541,8 @@ CDynamicHooksSourcePawn::CDynamicHooksSourcePawn(HookSetup *setup, CHook *pDetou
 
 HookReturnStruct *CDynamicHooksSourcePawn::GetReturnStruct()
 {
-	// Create buffers to store the return value of the function.
-	HookReturnStruct *res = new HookReturnStruct();
+	// Grab a pooled struct with buffers to store the return value of the function.
+	HookReturnStruct *res = AcquireReturnStruct();
 	res->isChanged = false;
 	res->type = this->returnType;
 	res->orgResult = NULL;
@@ -550,29 +554,29 @@ HookReturnStruct *CDynamicHooksSourcePawn::GetReturnStruct()
 		switch (this->returnType)
 		{
 		case ReturnType_String:
-			res->orgResult = malloc(sizeof(string_t));
-			res->newResult = malloc(sizeof(string_t));
+			res->orgResult = res->orgBuffer;
+			res->newResult = res->newBuffer;
 			*(string_t *)res->orgResult = m_pDetour->GetReturnValue<string_t>();
 			break;
 		case ReturnType_Int:
-			res->orgResult = malloc(sizeof(int));
-			res->newResult = malloc(sizeof(int));
+			res->orgResult = res->orgBuffer;
+			res->newResult = res->newBuffer;
 			*(int *)res->orgResult = m_pDetour->GetReturnValue<int>();
 			break;
 		case ReturnType_Bool:
-			res->orgResult = malloc(sizeof(bool));
-			res->newResult = malloc(sizeof(bool));
+			res->orgResult = res->orgBuffer;
+			res->newResult = res->newBuffer;
 			*(bool *)res->orgResult = m_pDetour->GetReturnValue<bool>();
 			break;
 		case ReturnType_Float:
-			res->orgResult = malloc(sizeof(float));
-			res->newResult = malloc(sizeof(float));
+			res->orgResult = res->orgBuffer;
+			res->newResult = res->newBuffer;
 			*(float *)res->orgResult = m_pDetour->GetReturnValue<float>();
 			break;
 		case ReturnType_Vector:
 		{
-			res->orgResult = malloc(sizeof(SDKVector));
-			res->newResult = malloc(sizeof(SDKVector));
+			res->orgResult = res->orgBuffer;
+			res->newResult = res->newBuffer;
 			SDKVector vec = m_pDetour->GetReturnValue<SDKVector>();
 			*(SDKVector *)res->orgResult = vec;
 			break;
@@ -584,34 +588,33 @@ HookReturnStruct *CDynamicHooksSourcePawn::GetReturnStruct()
 	}
 	// Pre hooks don't have access to the return value yet - duh.
 	// Just create the buffers for overridden values.
-	// TODO: Strip orgResult malloc.
 	else
 	{
 		switch (this->returnType)
 		{
 		case ReturnType_String:
-			res->orgResult = malloc(sizeof(string_t));
-			res->newResult = malloc(sizeof(string_t));
+			res->orgResult = res->orgBuffer;
+			res->newResult = res->newBuffer;
 			*(string_t *)res->orgResult = NULL_STRING;
 			break;
 		case ReturnType_Vector:
-			res->orgResult = malloc(sizeof(SDKVector));
-			res->newResult = malloc(sizeof(SDKVector));
+			res->orgResult = res->orgBuffer;
+			res->newResult = res->newBuffer;
 			*(SDKVector *)res->orgResult = SDKVector();
 			break;
 		case ReturnType_Int:
-			res->orgResult = malloc(sizeof(int));
-			res->newResult = malloc(sizeof(int));
+			res->orgResult = res->orgBuffer;
+			res->newResult = res->newBuffer;
 			*(int *)res->orgResult = 0;
 			break;
 		case ReturnType_Bool:
-			res->orgResult = malloc(sizeof(bool));
-			res->newResult = malloc(sizeof(bool));
+			res->orgResult = res->orgBuffer;
+			res->newResult = res->newBuffer;
 			*(bool *)res->orgResult = false;
 			break;
 		case ReturnType_Float:
-			res->orgResult = malloc(sizeof(float));
-			res->newResult = malloc(sizeof(float));
+			res->orgResult = res->orgBuffer;
+			res->newResult = res->newBuffer;
 			*(float *)res->orgResult = 0.0;
 			break;
 		}
@@ -623,7 +626,7 @@ HookReturnStruct *CDynamicHooksSourcePawn::GetReturnStruct()
 HookParamsStruct *CDynamicHooksSourcePawn::GetParamStruct()
 {
 	// Save argument values of detoured function.
-	HookParamsStruct *params = new HookParamsStruct();
+	HookParamsStruct *params = AcquireParamStruct();
 	params->dg = this;
 	
 	ICallingConvention* callingConvention = m_pDetour->m_pCallingConvention;
@@ -633,9 +636,7 @@ HookParamsStruct *CDynamicHooksSourcePawn::GetParamStruct()
 	size_t numArgs = argTypes.size();
 
 	// Create space for original parameters and changes plugins might do.
-	params->orgParams = (void **)malloc(paramsSize);
-	params->newParams = (void **)malloc(paramsSize);
-	params->isChanged = (bool *)malloc(numArgs * sizeof(bool));
+	params->Reserve(paramsSize, paramsSize, numArgs);
 
 	// Save old stack parameters.
 	if (stackSize > 0)
@@ -671,6 +672,34 @@ HookParamsStruct *CDynamicHooksSourcePawn::GetParamStruct()
 	return params;
 }
 
+void *CDynamicHooksSourcePawn::GetThisPointer()
+{
+	if (callConv != CallConv_THISCALL)
+		return nullptr;
+
+	// The this pointer is implicitly always the first argument.
+	// TODO: Support custom register for this ptr.
+	return m_pDetour->GetArgument<void *>(0);
+}
+
+bool CDynamicHooksSourcePawn::PassesFilters()
+{
+	size_t firstArg = (callConv == CallConv_THISCALL) ? 1 : 0;
+	void *thisPtr = GetThisPointer();
+
+	for (size_t i = 0; i < filters.size(); i++)
+	{
+		const HookFilter &filter = filters[i];
+		void *paramAddr = nullptr;
+		if (filter.param > 0)
+			paramAddr = m_pDetour->m_pCallingConvention->GetArgumentPtr(filter.param - 1 + firstArg, m_pDetour->m_pRegisters);
+
+		if (!HookFilterMatches(filter, this, thisPtr, paramAddr))
+			return false;
+	}
+	return true;
+}
+
 void CDynamicHooksSourcePawn::UpdateParamsFromStruct(HookParamsStruct *params)
 {
 	// Function had no params to update now.
@@ -56,6 +56,8 @@ public:
 	HookReturnStruct *GetReturnStruct();
 	HookParamsStruct *GetParamStruct();
 	void UpdateParamsFromStruct(HookParamsStruct *params);
+	bool PassesFilters();
+	void *GetThisPointer();
 
 public:
 	CHook *m_pDetour;
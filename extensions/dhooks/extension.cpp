@@ -105,11 +105,11 @@ void DHooks::OnHandleDestroy(HandleType_t type, void *object)
 	}
 	else if(type == g_HookParamsHandle)
 	{
-		delete (HookParamsStruct *)object;
+		ReleaseParamStruct((HookParamsStruct *)object);
 	}
 	else if(type == g_HookReturnHandle)
 	{
-		delete (HookReturnStruct *)object;
+		ReleaseReturnStruct((HookReturnStruct *)object);
 	}
 }
 
@@ -145,6 +145,7 @@ void DHooks::SDK_OnUnload()
 	handlesys->RemoveType(g_HookSetupHandle, myself->GetIdentity());
 	handlesys->RemoveType(g_HookParamsHandle, myself->GetIdentity());
 	handlesys->RemoveType(g_HookReturnHandle, myself->GetIdentity());
+	ClearHookStructPools();
 
 	gameconfs->RemoveUserConfigHook("Functions", g_pSignatures);
 }
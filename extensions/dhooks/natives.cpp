@@ -312,6 +312,7 @@ cell_t Native_SetFromConf(IPluginContext *pContext, const cell_t *params)
 	// Detour or vhook.
 	setup->funcAddr = addr;
 	setup->offset = offset;
+	setup->ResetCall();
 
 	if (addr == nullptr)
 	{
@@ -387,6 +388,99 @@ cell_t Native_AddParam(IPluginContext *pContext, const cell_t *params)
 
 	info.pass_type = GetParamTypePassType(info.type);
 	setup->params.push_back(info);
+	setup->ResetCall();
+
+	return 1;
+}
+
+static bool CheckFilterParam(IPluginContext *pContext, HookSetup *setup, HookFilterType type, int param)
+{
+	if (param == 0)
+	{
+		if (type == HookFilter_Equals)
+			return pContext->ThrowNativeError("Equality filters need a parameter, not the this pointer") != 0;
+
+		if (setup->thisType != ThisPointer_CBaseEntity || (setup->hookMethod == Detour && setup->callConv != CallConv_THISCALL))
+			return pContext->ThrowNativeError("Hook has no CBaseEntity this pointer to filter on") != 0;
+
+		return true;
+	}
+
+	if (param < 0 || (size_t)param > setup->params.size())
+		return pContext->ThrowNativeError("Invalid param number %i max params is %i", param, setup->params.size()) != 0;
+
+	HookParamType paramType = setup->params[param - 1].type;
+	if (type != HookFilter_Equals && paramType != HookParamType_CBaseEntity)
+		return pContext->ThrowNativeError("Param %i is not a CBaseEntity", param) != 0;
+
+	if (type == HookFilter_Equals
+		&& paramType != HookParamType_Int
+		&& paramType != HookParamType_Bool
+		&& paramType != HookParamType_Float
+		&& paramType != HookParamType_CBaseEntity
+		&& paramType != HookParamType_Edict)
+	{
+		return pContext->ThrowNativeError("Param %i type can't be compared against a value", param) != 0;
+	}
+
+	return true;
+}
+
+//native void DHookAddFilter(Handle setup, DHookFilter type, int param=0, any value=0);
+cell_t Native_AddFilter(IPluginContext *pContext, const cell_t *params)
+{
+	HookSetup *setup;
+
+	if(!GetHandleIfValidOrError(g_HookSetupHandle, (void **)&setup, pContext, params[1]))
+	{
+		return 0;
+	}
+
+	HookFilter filter;
+	filter.type = (HookFilterType)params[2];
+	filter.param = params[3];
+	filter.value = params[4];
+
+	if (filter.type != HookFilter_IsClient && filter.type != HookFilter_Equals)
+	{
+		return pContext->ThrowNativeError("Invalid filter type %d", params[2]);
+	}
+
+	if (!CheckFilterParam(pContext, setup, filter.type, filter.param))
+	{
+		return 0;
+	}
+
+	setup->filters.push_back(filter);
+
+	return 1;
+}
+
+//native void DHookAddClassnameFilter(Handle setup, int param, const char[] classname);
+cell_t Native_AddClassnameFilter(IPluginContext *pContext, const cell_t *params)
+{
+	HookSetup *setup;
+
+	if(!GetHandleIfValidOrError(g_HookSetupHandle, (void **)&setup, pContext, params[1]))
+	{
+		return 0;
+	}
+
+	HookFilter filter;
+	filter.type = HookFilter_Classname;
+	filter.param = params[2];
+	filter.value = 0;
+
+	if (!CheckFilterParam(pContext, setup, filter.type, filter.param))
+	{
+		return 0;
+	}
+
+	char *classname;
+	pContext->LocalToString(params[3], &classname);
+	filter.classname = classname;
+
+	setup->filters.push_back(filter);
 
 	return 1;
 }
@@ -705,6 +799,202 @@ cell_t Native_RemoveHookID(IPluginContext *pContext, const cell_t *params)
 	}
 	return 0;
 }
+static void *PluginToPointer(IPluginContext *pContext, cell_t value)
+{
+	if (pContext->GetRuntime()->FindPubvarByName("__Virtual_Address__", nullptr) == SP_ERROR_NONE) {
+		return g_pSM->FromPseudoAddress(value);
+	}
+	return reinterpret_cast<void *>(value);
+}
+
+static cell_t PointerToPlugin(IPluginContext *pContext, void *ptr)
+{
+	if (pContext->GetRuntime()->FindPubvarByName("__Virtual_Address__", nullptr) == SP_ERROR_NONE) {
+		return g_pSM->ToPseudoAddress(ptr);
+	}
+	return (cell_t)(intptr_t)ptr;
+}
+
+static bool BuildDirectCall(IPluginContext *pContext, HookSetup *setup)
+{
+	SourceMod::PassInfo returnInfo;
+	SourceMod::PassInfo *pReturnInfo = &returnInfo;
+
+	returnInfo.flags = PASSFLAG_BYVAL;
+	returnInfo.type = PassType_Basic;
+	returnInfo.size = sizeof(void *);
+	switch (setup->returnType)
+	{
+	case ReturnType_Void:
+		pReturnInfo = NULL;
+		break;
+	case ReturnType_Float:
+		returnInfo.type = PassType_Float;
+		returnInfo.size = sizeof(float);
+		break;
+	case ReturnType_Int:
+	case ReturnType_Bool:
+	case ReturnType_StringPtr:
+	case ReturnType_CharPtr:
+	case ReturnType_VectorPtr:
+	case ReturnType_CBaseEntity:
+	case ReturnType_Edict:
+		break;
+	default:
+		return pContext->ThrowNativeError("Return type %d can't be used in a direct call", setup->returnType) != 0;
+	}
+
+	std::vector<SourceMod::PassInfo> paramInfo(setup->params.size());
+	for (size_t i = 0; i < setup->params.size(); i++)
+	{
+		const ParamInfo &param = setup->params.at(i);
+		switch (param.type)
+		{
+		case HookParamType_Int:
+		case HookParamType_Bool:
+		case HookParamType_Float:
+		case HookParamType_StringPtr:
+		case HookParamType_CharPtr:
+		case HookParamType_VectorPtr:
+		case HookParamType_CBaseEntity:
+		case HookParamType_ObjectPtr:
+		case HookParamType_Edict:
+			break;
+		default:
+			return pContext->ThrowNativeError("Param %d type %d can't be used in a direct call", i + 1, param.type) != 0;
+		}
+		if (param.flags & PASSFLAG_BYREF)
+		{
+			return pContext->ThrowNativeError("Param %d is passed by reference, which direct calls don't support", i + 1) != 0;
+		}
+
+		paramInfo[i].flags = param.flags;
+		paramInfo[i].size = param.size;
+		paramInfo[i].type = (param.type == HookParamType_Float) ? PassType_Float : PassType_Basic;
+	}
+
+	setup->vcall = g_pBinTools->CreateVCall(setup->offset, 0, 0, pReturnInfo,
+		paramInfo.empty() ? NULL : &paramInfo[0], paramInfo.size());
+	if (!setup->vcall)
+	{
+		return pContext->ThrowNativeError("Failed to create call wrapper") != 0;
+	}
+	return true;
+}
+
+//native any DynamicHook.Call(any thisPtr, const any[] args={}, int numArgs=0);
+cell_t Native_CallVirtual(IPluginContext *pContext, const cell_t *params)
+{
+	HookSetup *setup;
+	if (!GetHandleIfValidOrError(g_HookSetupHandle, (void **)&setup, pContext, params[1]))
+	{
+		return 0;
+	}
+
+	if (setup->hookMethod != Virtual || !setup->IsVirtual())
+	{
+		return pContext->ThrowNativeError("Only virtual function setups can be called directly");
+	}
+
+	if ((size_t)params[4] != setup->params.size())
+	{
+		return pContext->ThrowNativeError("Expected %d arguments, got %d", setup->params.size(), params[4]);
+	}
+
+	void *iface = NULL;
+	switch (setup->hookType)
+	{
+	case HookType_Entity:
+		iface = gamehelpers->ReferenceToEntity(params[2]);
+		break;
+	case HookType_GameRules:
+		iface = g_pSDKTools->GetGameRules();
+		break;
+	case HookType_Raw:
+		iface = PluginToPointer(pContext, params[2]);
+		break;
+	}
+	if (!iface)
+	{
+		return pContext->ThrowNativeError("Invalid this pointer %x", params[2]);
+	}
+
+	if (!setup->vcall && !BuildDirectCall(pContext, setup))
+	{
+		return 0;
+	}
+
+	cell_t *args;
+	pContext->LocalToPhysAddr(params[3], &args);
+
+	/* Every supported type fits in a pointer-sized slot. */
+	unsigned char stack[sizeof(void *) * (SP_MAX_EXEC_PARAMS + 1)];
+	if (setup->params.size() > SP_MAX_EXEC_PARAMS)
+	{
+		return pContext->ThrowNativeError("Too many arguments");
+	}
+
+	unsigned char *vptr = stack;
+	*(void **)vptr = iface;
+	vptr += sizeof(void *);
+
+	for (size_t i = 0; i < setup->params.size(); i++)
+	{
+		memset(vptr, 0, sizeof(void *));
+		switch (setup->params.at(i).type)
+		{
+		case HookParamType_Int:
+		case HookParamType_Bool:
+			*(cell_t *)vptr = args[i];
+			break;
+		case HookParamType_Float:
+			*(float *)vptr = sp_ctof(args[i]);
+			break;
+		case HookParamType_CBaseEntity:
+			*(CBaseEntity **)vptr = (args[i] == -1) ? NULL : gamehelpers->ReferenceToEntity(args[i]);
+			break;
+		case HookParamType_Edict:
+			*(edict_t **)vptr = (args[i] == -1) ? NULL : gamehelpers->EdictOfIndex(args[i]);
+			break;
+		default:
+			*(void **)vptr = PluginToPointer(pContext, args[i]);
+			break;
+		}
+		vptr += setup->params.at(i).size;
+	}
+
+	union
+	{
+		void *ptr;
+		int i;
+		bool b;
+		float f;
+	} ret;
+	ret.ptr = NULL;
+
+	setup->vcall->Execute(stack, setup->returnType == ReturnType_Void ? NULL : &ret);
+
+	switch (setup->returnType)
+	{
+	case ReturnType_Int:
+		return ret.i;
+	case ReturnType_Bool:
+		return ret.b ? 1 : 0;
+	case ReturnType_Float:
+		return sp_ftoc(ret.f);
+	case ReturnType_CBaseEntity:
+		return ret.ptr ? gamehelpers->EntityToBCompatRef((CBaseEntity *)ret.ptr) : -1;
+	case ReturnType_Edict:
+		return ret.ptr ? gamehelpers->IndexOfEdict((edict_t *)ret.ptr) : -1;
+	case ReturnType_StringPtr:
+	case ReturnType_CharPtr:
+	case ReturnType_VectorPtr:
+		return PointerToPlugin(pContext, ret.ptr);
+	default:
+		return 0;
+	}
+}
+
 // native any:DHookGetParam(Handle:hParams, num);
 cell_t Native_GetParam(IPluginContext *pContext, const cell_t *params)
 {
@@ -1504,6 +1794,8 @@ sp_nativeinfo_t g_Natives[] =
 	{"DHookCreateFromConf",                 Native_DHookCreateFromConf},
 	{"DHookSetFromConf",                    Native_SetFromConf},
 	{"DHookAddParam",                       Native_AddParam},
+	{"DHookAddFilter",                      Native_AddFilter},
+	{"DHookAddClassnameFilter",             Native_AddClassnameFilter},
 	{"DHookEnableDetour",                   Native_EnableDetour},
 	{"DHookDisableDetour",                  Native_DisableDetour},
 	{"DHookEntity",                         Native_HookEntity},
@@ -1535,6 +1827,8 @@ sp_nativeinfo_t g_Natives[] =
 	// Methodmap API
 	{"DHookSetup.AddParam",                 Native_AddParam},
 	{"DHookSetup.SetFromConf",              Native_SetFromConf},
+	{"DHookSetup.AddFilter",                Native_AddFilter},
+	{"DHookSetup.AddClassnameFilter",       Native_AddClassnameFilter},
 
 	{"DynamicHook.DynamicHook",             Native_CreateHook},
 	{"DynamicHook.FromConf",                Native_DHookCreateFromConf},
@@ -1542,6 +1836,7 @@ sp_nativeinfo_t g_Natives[] =
 	{"DynamicHook.HookGamerules",           Native_HookGamerules_Methodmap},
 	{"DynamicHook.HookRaw",                 Native_HookRaw_Methodmap},
 	{"DynamicHook.RemoveHook",              Native_RemoveHookID},
+	{"DynamicHook.Call",                    Native_CallVirtual},
 
 	{"DynamicDetour.DynamicDetour",         Native_CreateDetour},
 	{"DynamicDetour.FromConf",              Native_DHookCreateFromConf},
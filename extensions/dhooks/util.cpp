@@ -44,19 +44,19 @@ void * GetObjectAddr(HookParamType type, unsigned int flags, void **params, size
 
 }
 
-size_t GetStackParamOffset(HookParamsStruct *paramStruct, unsigned int index)
+size_t GetStackParamOffset(DHooksInfo *dg, unsigned int index)
 {
-	assert(paramStruct->dg->params[index].custom_register == None);
+	assert(dg->params[index].custom_register == None);
 
 	size_t offset = 0;
 	for (unsigned int i = 0; i < index; i++)
 	{
 		// Only care for arguments on the stack before us.
-		if (paramStruct->dg->params[i].custom_register != None)
+		if (dg->params[i].custom_register != None)
 			continue;
 
 #ifndef WIN32
-		if (paramStruct->dg->params[i].type == HookParamType_Object && (paramStruct->dg->params[i].flags & PASSFLAG_ODTOR)) //Passed by refrence
+		if (dg->params[i].type == HookParamType_Object && (dg->params[i].flags & PASSFLAG_ODTOR)) //Passed by refrence
 		{
 			offset += sizeof(void *);
 			continue;
@@ -65,24 +65,24 @@ size_t GetStackParamOffset(HookParamsStruct *paramStruct, unsigned int index)
 #ifdef KE_ARCH_X64
 		offset += 8;
 #else
-		offset += paramStruct->dg->params[i].size;
+		offset += dg->params[i].size;
 #endif
 	}
 	return offset;
 }
 
-size_t GetRegisterParamOffset(HookParamsStruct *paramStruct, unsigned int index)
+size_t GetRegisterParamOffset(DHooksInfo *dg, unsigned int index)
 {
 	// TODO: Fix this up and get a pointer to the CDetour
-	assert(paramStruct->dg->params[index].custom_register != None);
+	assert(dg->params[index].custom_register != None);
 
 	// Need to get the size of the stack arguments first. Register arguments are stored after them in the buffer.
 	size_t stackSize = 0;
-	for (int i = paramStruct->dg->params.size() - 1; i >= 0; i--)
+	for (int i = dg->params.size() - 1; i >= 0; i--)
 	{
-		if (paramStruct->dg->params[i].custom_register == None)
+		if (dg->params[i].custom_register == None)
 		{
-			stackSize += paramStruct->dg->params[i].size;
+			stackSize += dg->params[i].size;
 		}
 	}
 
@@ -90,20 +90,25 @@ size_t GetRegisterParamOffset(HookParamsStruct *paramStruct, unsigned int index)
 	for (unsigned int i = 0; i < index; i++)
 	{
 		// Only care for arguments passed through a register as well before us.
-		if (paramStruct->dg->params[i].custom_register == None)
+		if (dg->params[i].custom_register == None)
 			continue;
 
-		offset += paramStruct->dg->params[i].size;
+		offset += dg->params[i].size;
 	}
 	return offset;
 }
 
-size_t GetParamOffset(HookParamsStruct *paramStruct, unsigned int index)
+size_t GetParamOffset(DHooksInfo *dg, unsigned int index)
 {
-	if (paramStruct->dg->params[index].custom_register == None)
-		return GetStackParamOffset(paramStruct, index);
+	if (dg->params[index].custom_register == None)
+		return GetStackParamOffset(dg, index);
 	else
-		return GetRegisterParamOffset(paramStruct, index);
+		return GetRegisterParamOffset(dg, index);
+}
+
+size_t GetParamOffset(HookParamsStruct *paramStruct, unsigned int index)
+{
+	return GetParamOffset(paramStruct->dg, index);
 }
 
 size_t GetParamTypeSize(HookParamType type)
@@ -74,6 +74,7 @@ enum PluginRegister
 	DHookRegister_ST0
 };
 
+size_t GetParamOffset(DHooksInfo *dg, unsigned int index);
 size_t GetParamOffset(HookParamsStruct *params, unsigned int index);
 void * GetObjectAddr(HookParamType type, unsigned int flags, void **params, size_t offset);
 size_t GetParamTypeSize(HookParamType type);
@@ -64,6 +64,30 @@
 		} \
 		break;
 
+/* The call wrapper only depends on the hook's signature, so it is compiled
+ * the first time the original function is called and kept on the callback.
+ */
+static inline ICallWrapper *GetVFunctionCall(DHooksCallback *dg, SourceMod::PassInfo *returnInfo, SourceMod::PassInfo *paramInfo)
+{
+	size_t retSize = returnInfo ? returnInfo->size : 0;
+	int retType = returnInfo ? (int)returnInfo->type : -1;
+
+	if(dg->vcall && dg->vcallRetSize == retSize && dg->vcallRetType == retType)
+	{
+		return dg->vcall;
+	}
+
+	if(dg->vcall)
+	{
+		dg->vcall->Destroy();
+	}
+
+	dg->vcall = g_pBinTools->CreateVCall(dg->offset, 0, 0, returnInfo, paramInfo, dg->params.size());
+	dg->vcallRetSize = retSize;
+	dg->vcallRetType = retType;
+	return dg->vcall;
+}
+
 template <class T>
 T CallVFunction(DHooksCallback *dg, HookParamsStruct *paramStruct, void *iface)
 {
@@ -151,16 +175,15 @@ T CallVFunction(DHooksCallback *dg, HookParamsStruct *paramStruct, void *iface)
 
 	if(dg->returnType == ReturnType_Void)
 	{
-		pCall = g_pBinTools->CreateVCall(dg->offset, 0, 0, NULL, paramInfo, dg->params.size());
+		pCall = GetVFunctionCall(dg, NULL, paramInfo);
 		pCall->Execute(vstk, NULL);
 	}
 	else
 	{
-		pCall = g_pBinTools->CreateVCall(dg->offset, 0, 0, &returnInfo, paramInfo, dg->params.size());
+		pCall = GetVFunctionCall(dg, &returnInfo, paramInfo);
 		pCall->Execute(vstk, &ret);
 	}
 
-	pCall->Destroy();
 	free(vstk);
 
 	if(paramInfo != NULL)
@@ -247,10 +270,9 @@ SDKVector CallVFunction<SDKVector>(DHooksCallback *dg, HookParamsStruct *paramSt
 
 	SDKVector ret;
 
-	pCall = g_pBinTools->CreateVCall(dg->offset, 0, 0, &returnInfo, paramInfo, dg->params.size());
+	pCall = GetVFunctionCall(dg, &returnInfo, paramInfo);
 	pCall->Execute(vstk, &ret);
 
-	pCall->Destroy();
 	free(vstk);
 
 	if(paramInfo != NULL)
@@ -338,10 +360,9 @@ string_t CallVFunction<string_t>(DHooksCallback *dg, HookParamsStruct *paramStru
 
 	string_t ret;
 
-	pCall = g_pBinTools->CreateVCall(dg->offset, 0, 0, &returnInfo, paramInfo, dg->params.size());
+	pCall = GetVFunctionCall(dg, &returnInfo, paramInfo);
 	pCall->Execute(vstk, &ret);
 
-	pCall->Destroy();
 	free(vstk);
 
 	if(paramInfo != NULL)
@@ -233,6 +233,7 @@ DHooksManager::DHooksManager(HookSetup *setup, void *iface, IPluginFunction *rem
 	this->callback->post = post;
 	this->callback->hookType = setup->hookType;
 	this->callback->params = setup->params;
+	this->callback->filters = setup->filters;
 
 	this->addr = 0;
 
@@ -328,13 +329,32 @@ size_t GetStackArgsSize(DHooksCallback *dg)
 	return res;
 }
 
+/* Every hook invocation needs a params and a return struct for the plugin
+ * callback. Keep released ones around so the hot path doesn't allocate;
+ * callbacks can nest, so the pools hold more than one of each.
+ */
+#define HOOK_STRUCT_POOL_SIZE 32
+
+static std::vector<HookReturnStruct *> s_ReturnStructPool;
+static std::vector<HookParamsStruct *> s_ParamStructPool;
+
+/* Large enough for any by-value return type we copy */
+#define HOOK_RETURN_BUFFER_SIZE (sizeof(SDKVector) > sizeof(string_t) ? sizeof(SDKVector) : sizeof(string_t))
+
+HookReturnStruct::HookReturnStruct()
+{
+	this->type = ReturnType_Void;
+	this->isChanged = false;
+	this->orgResult = NULL;
+	this->newResult = NULL;
+	this->orgBuffer = malloc(HOOK_RETURN_BUFFER_SIZE);
+	this->newBuffer = malloc(HOOK_RETURN_BUFFER_SIZE);
+}
+
 HookReturnStruct::~HookReturnStruct()
 {
-	if (this->type == ReturnType_String || this->type == ReturnType_Int || this->type == ReturnType_Bool || this->type == ReturnType_Float || this->type == ReturnType_Vector)
-	{
-		free(this->newResult);
-		free(this->orgResult);
-	}
+	free(this->orgBuffer);
+	free(this->newBuffer);
 }
 
 HookParamsStruct::~HookParamsStruct()
@@ -353,28 +373,107 @@ HookParamsStruct::~HookParamsStruct()
 	}
 }
 
+void HookParamsStruct::Reserve(size_t orgBytes, size_t newBytes, size_t numParams)
+{
+	if (orgBytes > this->orgSize)
+	{
+		free(this->orgParams);
+		this->orgParams = (void **)malloc(orgBytes);
+		this->orgSize = orgBytes;
+	}
+	if (newBytes > this->newSize)
+	{
+		free(this->newParams);
+		this->newParams = (void **)malloc(newBytes);
+		this->newSize = newBytes;
+	}
+	if (numParams > this->changedSize)
+	{
+		free(this->isChanged);
+		this->isChanged = (bool *)malloc(numParams * sizeof(bool));
+		this->changedSize = numParams;
+	}
+}
+
+HookReturnStruct *AcquireReturnStruct()
+{
+	if (s_ReturnStructPool.empty())
+	{
+		return new HookReturnStruct();
+	}
+
+	HookReturnStruct *res = s_ReturnStructPool.back();
+	s_ReturnStructPool.pop_back();
+	return res;
+}
+
+HookParamsStruct *AcquireParamStruct()
+{
+	if (s_ParamStructPool.empty())
+	{
+		return new HookParamsStruct();
+	}
+
+	HookParamsStruct *params = s_ParamStructPool.back();
+	s_ParamStructPool.pop_back();
+	return params;
+}
+
+void ReleaseReturnStruct(HookReturnStruct *res)
+{
+	if (s_ReturnStructPool.size() >= HOOK_STRUCT_POOL_SIZE)
+	{
+		delete res;
+		return;
+	}
+	s_ReturnStructPool.push_back(res);
+}
+
+void ReleaseParamStruct(HookParamsStruct *params)
+{
+	if (s_ParamStructPool.size() >= HOOK_STRUCT_POOL_SIZE)
+	{
+		delete params;
+		return;
+	}
+	params->dg = NULL;
+	s_ParamStructPool.push_back(params);
+}
+
+void ClearHookStructPools()
+{
+	for (size_t i = 0; i < s_ReturnStructPool.size(); i++)
+	{
+		delete s_ReturnStructPool[i];
+	}
+	s_ReturnStructPool.clear();
+
+	for (size_t i = 0; i < s_ParamStructPool.size(); i++)
+	{
+		delete s_ParamStructPool[i];
+	}
+	s_ParamStructPool.clear();
+}
+
 HookParamsStruct *GetParamStruct(DHooksCallback *dg, void **argStack, size_t argStackSize)
 {
-	HookParamsStruct *params = new HookParamsStruct();
+	HookParamsStruct *params = AcquireParamStruct();
 	params->dg = dg;
+	size_t paramsSize = GetParamsSize(dg);
 #ifdef  WIN32
 	if(dg->returnType != ReturnType_Vector)
 #else
 	if(dg->returnType != ReturnType_Vector && dg->returnType != ReturnType_String)
 #endif
 	{
-		params->orgParams = (void **)malloc(argStackSize);
+		params->Reserve(argStackSize, paramsSize, dg->params.size());
 		memcpy(params->orgParams, argStack, argStackSize);
 	}
 	else //Offset result ptr
 	{
-		params->orgParams = (void **)malloc(argStackSize-OBJECT_OFFSET);
+		params->Reserve(argStackSize-OBJECT_OFFSET, paramsSize, dg->params.size());
 		memcpy(params->orgParams, (void*)((uintptr_t)argStack + OBJECT_OFFSET), argStackSize - OBJECT_OFFSET);
 	}
-	size_t paramsSize = GetParamsSize(dg);
-
-	params->newParams = (void **)malloc(paramsSize);
-	params->isChanged = (bool *)malloc(dg->params.size() * sizeof(bool));
 
 	for (unsigned int i = 0; i < dg->params.size(); i++)
 	{
@@ -387,7 +486,7 @@ HookParamsStruct *GetParamStruct(DHooksCallback *dg, void **argStack, size_t arg
 
 HookReturnStruct *GetReturnStruct(DHooksCallback *dg)
 {
-	HookReturnStruct *res = new HookReturnStruct();
+	HookReturnStruct *res = AcquireReturnStruct();
 	res->isChanged = false;
 	res->type = dg->returnType;
 	res->orgResult = NULL;
@@ -398,29 +497,29 @@ HookReturnStruct *GetReturnStruct(DHooksCallback *dg)
 		switch(dg->returnType)
 		{
 			case ReturnType_String:
-				res->orgResult = malloc(sizeof(string_t));
-				res->newResult = malloc(sizeof(string_t));
+				res->orgResult = res->orgBuffer;
+				res->newResult = res->newBuffer;
 				*(string_t *)res->orgResult = META_RESULT_ORIG_RET(string_t);
 				break;
 			case ReturnType_Int:
-				res->orgResult = malloc(sizeof(int));
-				res->newResult = malloc(sizeof(int));
+				res->orgResult = res->orgBuffer;
+				res->newResult = res->newBuffer;
 				*(int *)res->orgResult = META_RESULT_ORIG_RET(int);
 				break;
 			case ReturnType_Bool:
-				res->orgResult = malloc(sizeof(bool));
-				res->newResult = malloc(sizeof(bool));
+				res->orgResult = res->orgBuffer;
+				res->newResult = res->newBuffer;
 				*(bool *)res->orgResult = META_RESULT_ORIG_RET(bool);
 				break;
 			case ReturnType_Float:
-				res->orgResult = malloc(sizeof(float));
-				res->newResult = malloc(sizeof(float));
+				res->orgResult = res->orgBuffer;
+				res->newResult = res->newBuffer;
 				*(float *)res->orgResult = META_RESULT_ORIG_RET(float);
 				break;
 			case ReturnType_Vector:
 			{
-				res->orgResult = malloc(sizeof(SDKVector));
-				res->newResult = malloc(sizeof(SDKVector));
+				res->orgResult = res->orgBuffer;
+				res->newResult = res->newBuffer;
 				SDKVector vec = META_RESULT_ORIG_RET(SDKVector);
 				*(SDKVector *)res->orgResult = vec;
 				break;
@@ -435,28 +534,28 @@ HookReturnStruct *GetReturnStruct(DHooksCallback *dg)
 		switch(dg->returnType)
 		{
 			case ReturnType_String:
-				res->orgResult = malloc(sizeof(string_t));
-				res->newResult = malloc(sizeof(string_t));
+				res->orgResult = res->orgBuffer;
+				res->newResult = res->newBuffer;
 				*(string_t *)res->orgResult = NULL_STRING;
 				break;
 			case ReturnType_Vector:
-				res->orgResult = malloc(sizeof(SDKVector));
-				res->newResult = malloc(sizeof(SDKVector));
+				res->orgResult = res->orgBuffer;
+				res->newResult = res->newBuffer;
 				*(SDKVector *)res->orgResult = SDKVector();
 				break;
 			case ReturnType_Int:
-				res->orgResult = malloc(sizeof(int));
-				res->newResult = malloc(sizeof(int));
+				res->orgResult = res->orgBuffer;
+				res->newResult = res->newBuffer;
 				*(int *)res->orgResult = 0;
 				break;
 			case ReturnType_Bool:
-				res->orgResult = malloc(sizeof(bool));
-				res->newResult = malloc(sizeof(bool));
+				res->orgResult = res->orgBuffer;
+				res->newResult = res->newBuffer;
 				*(bool *)res->orgResult = false;
 				break;
 			case ReturnType_Float:
-				res->orgResult = malloc(sizeof(float));
-				res->newResult = malloc(sizeof(float));
+				res->orgResult = res->orgBuffer;
+				res->newResult = res->newBuffer;
 				*(float *)res->orgResult = 0.0;
 				break;
 		}
@@ -465,6 +564,84 @@ HookReturnStruct *GetReturnStruct(DHooksCallback *dg)
 	return res;
 }
 
+bool HookFilterMatches(const HookFilter &filter, DHooksInfo *dg, void *thisPtr, void *paramAddr)
+{
+	if (filter.type == HookFilter_Equals)
+	{
+		switch (dg->params[filter.param - 1].type)
+		{
+			case HookParamType_Bool:
+				return (*(bool *)paramAddr ? 1 : 0) == filter.value;
+			case HookParamType_CBaseEntity:
+			{
+				CBaseEntity *pEntity = *(CBaseEntity **)paramAddr;
+				return (pEntity ? gamehelpers->EntityToBCompatRef(pEntity) : -1) == filter.value;
+			}
+			case HookParamType_Edict:
+			{
+				edict_t *pEdict = *(edict_t **)paramAddr;
+				return (pEdict ? gamehelpers->IndexOfEdict(pEdict) : -1) == filter.value;
+			}
+			default:
+				return *(cell_t *)paramAddr == filter.value;
+		}
+	}
+
+	CBaseEntity *pEntity = (filter.param == 0) ? (CBaseEntity *)thisPtr : *(CBaseEntity **)paramAddr;
+	if (!pEntity)
+	{
+		return false;
+	}
+
+	if (filter.type == HookFilter_IsClient)
+	{
+		int index = gamehelpers->EntityToBCompatRef(pEntity);
+		return index >= 1 && index <= playerhelpers->GetMaxClients();
+	}
+
+	const char *classname = gamehelpers->GetEntityClassname(pEntity);
+	if (!classname)
+	{
+		return false;
+	}
+
+	size_t len = filter.classname.size();
+	if (len > 0 && filter.classname[len - 1] == '*')
+	{
+		return strncmp(classname, filter.classname.c_str(), len - 1) == 0;
+	}
+	return strcmp(classname, filter.classname.c_str()) == 0;
+}
+
+static bool PassesHookFilters(DHooksCallback *dg, void **argStack)
+{
+	void *params = argStack;
+#ifdef  WIN32
+	if(dg->returnType == ReturnType_Vector)
+#else
+	if(dg->returnType == ReturnType_Vector || dg->returnType == ReturnType_String)
+#endif
+	{
+		params = (void *)((uintptr_t)argStack + OBJECT_OFFSET);
+	}
+
+	void *thisPtr = g_SHPtr->GetIfacePtr();
+	for (size_t i = 0; i < dg->filters.size(); i++)
+	{
+		const HookFilter &filter = dg->filters[i];
+		void *paramAddr = NULL;
+		if (filter.param > 0)
+		{
+			paramAddr = (void *)((intptr_t)params + GetParamOffset(dg, filter.param - 1));
+		}
+		if (!HookFilterMatches(filter, dg, thisPtr, paramAddr))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 cell_t GetThisPtr(IPluginContext* pContext, void *iface, ThisPointerType type)
 {
 	if (type == ThisPointer_CBaseEntity)
@@ -497,6 +674,12 @@ void *Callback(DHooksCallback *dg, void **argStack)
 #endif
 	//g_pSM->LogMessage(myself, "[DEFAULT]DHooksCallback(%p) argStack(%p) - argsize(%d)", dg, argStack, argsize);
 
+	if(!dg->filters.empty() && !PassesHookFilters(dg, argStack))
+	{
+		g_SHPtr->SetRes(MRES_IGNORED);
+		return NULL;
+	}
+
 	if(dg->thisType == ThisPointer_CBaseEntity || dg->thisType == ThisPointer_Address)
 	{
 		dg->plugin_callback->PushCell(GetThisPtr(dg->plugin_callback->GetParentContext(), g_SHPtr->GetIfacePtr(), dg->thisType));
@@ -510,7 +693,7 @@ void *Callback(DHooksCallback *dg, void **argStack)
 			dg->plugin_callback->Cancel();
 			if(returnStruct)
 			{
-				delete returnStruct;
+				ReleaseReturnStruct(returnStruct);
 			}
 			g_SHPtr->SetRes(MRES_IGNORED);
 			return NULL;
@@ -538,7 +721,7 @@ void *Callback(DHooksCallback *dg, void **argStack)
 			}
 			if(paramStruct)
 			{
-				delete paramStruct;
+				ReleaseParamStruct(paramStruct);
 			}
 			g_SHPtr->SetRes(MRES_IGNORED);
 			return NULL;
@@ -681,6 +864,12 @@ float Callback_float(DHooksCallback *dg, void **argStack)
 #endif
 	//g_pSM->LogMessage(myself, "[FLOAT]DHooksCallback(%p) argStack(%p) - argsize(%d)", dg, argStack, argsize);
 
+	if(!dg->filters.empty() && !PassesHookFilters(dg, argStack))
+	{
+		g_SHPtr->SetRes(MRES_IGNORED);
+		return 0.0;
+	}
+
 	if(dg->thisType == ThisPointer_CBaseEntity || dg->thisType == ThisPointer_Address)
 	{
 		dg->plugin_callback->PushCell(GetThisPtr(dg->plugin_callback->GetParentContext(), g_SHPtr->GetIfacePtr(), dg->thisType));
@@ -694,7 +883,7 @@ float Callback_float(DHooksCallback *dg, void **argStack)
 		dg->plugin_callback->Cancel();
 		if(returnStruct)
 		{
-			delete returnStruct;
+			ReleaseReturnStruct(returnStruct);
 		}
 		g_SHPtr->SetRes(MRES_IGNORED);
 		return 0.0;
@@ -716,11 +905,12 @@ float Callback_float(DHooksCallback *dg, void **argStack)
 			dg->plugin_callback->Cancel();
 			if(returnStruct)
 			{
-				delete returnStruct;
+				HandleSecurity sec(dg->plugin_callback->GetParentRuntime()->GetDefaultContext()->GetIdentity(), myself->GetIdentity());
+				handlesys->FreeHandle(rHndl, &sec);
 			}
 			if(paramStruct)
 			{
-				delete paramStruct;
+				ReleaseParamStruct(paramStruct);
 			}
 			g_SHPtr->SetRes(MRES_IGNORED);
 			return 0.0;
@@ -838,6 +1028,12 @@ SDKVector *Callback_vector(DHooksCallback *dg, void **argStack)
 #endif
 	//g_pSM->LogMessage(myself, "[VECTOR]DHooksCallback(%p) argStack(%p) - argsize(%d) - params count %d", dg, argStack, argsize, dg->params.size());
 
+	if(!dg->filters.empty() && !PassesHookFilters(dg, argStack))
+	{
+		g_SHPtr->SetRes(MRES_IGNORED);
+		return NULL;
+	}
+
 	if(dg->thisType == ThisPointer_CBaseEntity || dg->thisType == ThisPointer_Address)
 	{
 		dg->plugin_callback->PushCell(GetThisPtr(dg->plugin_callback->GetParentContext(), g_SHPtr->GetIfacePtr(), dg->thisType));
@@ -851,7 +1047,7 @@ SDKVector *Callback_vector(DHooksCallback *dg, void **argStack)
 		dg->plugin_callback->Cancel();
 		if(returnStruct)
 		{
-			delete returnStruct;
+			ReleaseReturnStruct(returnStruct);
 		}
 		g_SHPtr->SetRes(MRES_IGNORED);
 		return NULL;
@@ -873,11 +1069,12 @@ SDKVector *Callback_vector(DHooksCallback *dg, void **argStack)
 			dg->plugin_callback->Cancel();
 			if(returnStruct)
 			{
-				delete returnStruct;
+				HandleSecurity sec(dg->plugin_callback->GetParentRuntime()->GetDefaultContext()->GetIdentity(), myself->GetIdentity());
+				handlesys->FreeHandle(rHndl, &sec);
 			}
 			if(paramStruct)
 			{
-				delete paramStruct;
+				ReleaseParamStruct(paramStruct);
 			}
 			g_SHPtr->SetRes(MRES_IGNORED);
 			return NULL;
@@ -992,6 +1189,12 @@ string_t *Callback_stringt(DHooksCallback *dg, void **argStack)
 
 	size_t argsize = GetStackArgsSize(dg);
 
+	if(!dg->filters.empty() && !PassesHookFilters(dg, argStack))
+	{
+		g_SHPtr->SetRes(MRES_IGNORED);
+		return NULL;
+	}
+
 	if(dg->thisType == ThisPointer_CBaseEntity || dg->thisType == ThisPointer_Address)
 	{
 		dg->plugin_callback->PushCell(GetThisPtr(dg->plugin_callback->GetParentContext(), g_SHPtr->GetIfacePtr(), dg->thisType));
@@ -1005,7 +1208,7 @@ string_t *Callback_stringt(DHooksCallback *dg, void **argStack)
 		dg->plugin_callback->Cancel();
 		if(returnStruct)
 		{
-			delete returnStruct;
+			ReleaseReturnStruct(returnStruct);
 		}
 		g_SHPtr->SetRes(MRES_IGNORED);
 		return NULL;
@@ -1021,11 +1224,12 @@ string_t *Callback_stringt(DHooksCallback *dg, void **argStack)
 			dg->plugin_callback->Cancel();
 			if(returnStruct)
 			{
-				delete returnStruct;
+				HandleSecurity sec(dg->plugin_callback->GetParentRuntime()->GetDefaultContext()->GetIdentity(), myself->GetIdentity());
+				handlesys->FreeHandle(rHndl, &sec);
 			}
 			if(paramStruct)
 			{
-				delete paramStruct;
+				ReleaseParamStruct(paramStruct);
 			}
 			g_SHPtr->SetRes(MRES_IGNORED);
 			return NULL;
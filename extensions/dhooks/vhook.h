@@ -38,6 +38,7 @@
 #include <sourcehook_pibuilder.h>
 #include <registers.h>
 #include <vector>
+#include <string>
 
 #ifdef KE_ARCH_X64
 #include "sh_asm_x86_64.h"
@@ -142,18 +143,39 @@ struct ParamInfo
 class HookReturnStruct
 {
 public:
+	HookReturnStruct();
 	~HookReturnStruct();
 public:
 	ReturnType type;
 	bool isChanged;
 	void *orgResult;
 	void *newResult;
+	/* Storage for by-value results, kept across reuse from the pool */
+	void *orgBuffer;
+	void *newBuffer;
+};
+
+enum HookFilterType
+{
+	HookFilter_IsClient,
+	HookFilter_Equals,
+	HookFilter_Classname
+};
+
+/* Checked before the plugin callback runs; calls that don't match skip it */
+struct HookFilter
+{
+	HookFilterType type;
+	int param;					/**< 0 for the this pointer, otherwise 1-based param */
+	cell_t value;
+	std::string classname;		/**< Trailing '*' matches a prefix */
 };
 
 class DHooksInfo
 {
 public:
 	SourceHook::CVector<ParamInfo> params;
+	std::vector<HookFilter> filters;
 	int offset;
 	unsigned int returnFlag;
 	ReturnType returnType;
@@ -168,7 +190,7 @@ public:
 class DHooksCallback : public SourceHook::ISHDelegate, public DHooksInfo
 {
 public:
-	DHooksCallback()
+	DHooksCallback() : vcall(NULL), vcallRetSize(0), vcallRetType(-1)
 	{
 		//g_pSM->LogMessage(myself, "DHooksCallback(%p)", this);
 	}
@@ -177,6 +199,10 @@ public:
     virtual void DeleteThis()
 	{
 		*(void ***)this = this->oldvtable;
+		if(this->vcall)
+		{
+			this->vcall->Destroy();
+		}
 #ifdef KE_ARCH_X64
 		delete callThunk;
 #else
@@ -192,6 +218,10 @@ public:
 #ifdef KE_ARCH_X64
 	SourceHook::Asm::x64JitWriter* callThunk;
 #endif
+	/* Cached wrapper for calling the original function, see vfunc_call.h */
+	ICallWrapper *vcall;
+	size_t vcallRetSize;
+	int vcallRetType;
 };
 
 #if defined( WIN32 ) && !defined( KE_ARCH_X64 )
@@ -219,15 +249,29 @@ public:
 		this->newParams = NULL;
 		this->dg = NULL;
 		this->isChanged = NULL;
+		this->orgSize = 0;
+		this->newSize = 0;
+		this->changedSize = 0;
 	}
 	~HookParamsStruct();
+	void Reserve(size_t orgBytes, size_t newBytes, size_t numParams);
 public:
 	void **orgParams;
 	void **newParams;
 	bool *isChanged;
 	DHooksInfo *dg;
+	/* Allocated buffer sizes, so pooled structs only grow when needed */
+	size_t orgSize;
+	size_t newSize;
+	size_t changedSize;
 };
 
+HookReturnStruct *AcquireReturnStruct();
+HookParamsStruct *AcquireParamStruct();
+void ReleaseReturnStruct(HookReturnStruct *res);
+void ReleaseParamStruct(HookParamsStruct *params);
+void ClearHookStructPools();
+
 enum HookMethod {
 	Virtual,
 	Detour
@@ -247,6 +291,7 @@ public:
 		this->funcAddr = nullptr;
 		this->callback = callback;
 		this->hookMethod = Virtual;
+		this->vcall = nullptr;
 	};
 	HookSetup(ReturnType returnType, unsigned int returnFlag, CallingConvention callConv, ThisPointerType thisType, void *funcAddr)
 	{
@@ -259,13 +304,27 @@ public:
 		this->funcAddr = funcAddr;
 		this->callback = nullptr;
 		this->hookMethod = Detour;
+		this->vcall = nullptr;
+	};
+	~HookSetup()
+	{
+		ResetCall();
 	};
-	~HookSetup(){};
 
 	bool IsVirtual()
 	{
 		return this->offset != -1;
 	}
+
+	/* Must be called whenever the signature or offset changes */
+	void ResetCall()
+	{
+		if (this->vcall)
+		{
+			this->vcall->Destroy();
+			this->vcall = nullptr;
+		}
+	}
 public:
 	unsigned int returnFlag;
 	ReturnType returnType;
@@ -273,10 +332,13 @@ public:
 	CallingConvention callConv;
 	ThisPointerType thisType;
 	SourceHook::CVector<ParamInfo> params;
+	std::vector<HookFilter> filters;
 	int offset;
 	void *funcAddr;
 	IPluginFunction *callback;
 	HookMethod hookMethod;
+	/* Built by DynamicHook.Call on first use */
+	ICallWrapper *vcall;
 };
 
 #ifdef KE_ARCH_X64
@@ -339,6 +401,7 @@ public:
 };
 
 size_t GetStackArgsSize(DHooksCallback *dg);
+bool HookFilterMatches(const HookFilter &filter, DHooksInfo *dg, void *thisPtr, void *paramAddr);
 cell_t GetThisPtr(IPluginContext* pContext, void *iface, ThisPointerType type);
 
 extern IBinTools *g_pBinTools;
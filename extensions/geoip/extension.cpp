@@ -32,7 +32,10 @@
 #define _USE_MATH_DEFINES
 
 #include <sourcemod_version.h>
+#include <atomic>
 #include <cmath>
+#include <string>
+#include <thread>
 #include "extension.h"
 #include "geoip_util.h"
 
@@ -44,17 +47,26 @@
  * @brief Implement extension code here.
  */
 GeoIP_Extension g_GeoIP;
-MMDB_s mmdb;
+MMDB_s *mmdb = nullptr;
 
 SMEXT_LINK(&g_GeoIP);
 
-bool GeoIP_Extension::SDK_OnLoad(char *error, size_t maxlength, bool late)
+/**
+ * Result of a background (re)load, handed to the main thread through
+ * s_PendingLoad.  On failure, db is null and error says why.
+ */
+struct PendingLoad
 {
-	if (mmdb.filename) // Already loaded.
-	{
-		return true;
-	}
+	MMDB_s *db;
+	std::string error;
+};
 
+static std::atomic<PendingLoad *> s_PendingLoad(nullptr);
+static std::atomic<bool> s_Loading(false);
+static std::thread s_LoadThread;
+
+static bool FindDatabase(char *database, size_t maxlength)
+{
 	char m_GeoipDir[PLATFORM_MAX_PATH];
 	g_pSM->BuildPath(Path_SM, m_GeoipDir, sizeof(m_GeoipDir), "configs/geoip");
 
@@ -71,18 +83,7 @@ bool GeoIP_Extension::SDK_OnLoad(char *error, size_t maxlength, bool late)
 				size_t len = strlen(name);
 				if (len >= 5 && strcmp(&name[len-5], ".mmdb") == 0)
 				{
-					char database[PLATFORM_MAX_PATH];
-					libsys->PathFormat(database, sizeof(database), "%s/%s", m_GeoipDir, name);
-
-					int status = MMDB_open(database, MMDB_MODE_MMAP, &mmdb);
-
-					if (status != MMDB_SUCCESS)
-					{
-						ke::SafeSprintf(error, maxlength, "Failed to open GeoIP2 database %s: %s", database, MMDB_strerror(status));
-						libsys->CloseDirectory(dir);
-						return false;
-					}
-
+					libsys->PathFormat(database, maxlength, "%s/%s", m_GeoipDir, name);
 					hasEntry = true;
 					break;
 				}
@@ -92,34 +93,51 @@ bool GeoIP_Extension::SDK_OnLoad(char *error, size_t maxlength, bool late)
 		libsys->CloseDirectory(dir);
 	}
 
-	if (!hasEntry)
+	return hasEntry;
+}
+
+static MMDB_s *OpenDatabase(const char *database, char *error, size_t maxlength)
+{
+	MMDB_s *db = new MMDB_s;
+	int status = MMDB_open(database, MMDB_MODE_MMAP, db);
+
+	if (status != MMDB_SUCCESS)
 	{
-		ke::SafeStrcpy(error, maxlength, "Could not find GeoIP2 database.");
-		return false;
+		ke::SafeSprintf(error, maxlength, "Failed to open GeoIP2 database %s: %s", database, MMDB_strerror(status));
+		delete db;
+		return nullptr;
 	}
 
-	g_pShareSys->AddNatives(myself, geoip_natives);
-	g_pShareSys->RegisterLibrary(myself, "GeoIP");
+	return db;
+}
+
+static void CloseDatabase(MMDB_s *db)
+{
+	MMDB_close(db);
+	delete db;
+}
 
+static void LogDatabaseInfo(const char *action)
+{
 	char date[40];
-	const time_t epoch = (const time_t)mmdb.metadata.build_epoch;
+	const time_t epoch = (const time_t)mmdb->metadata.build_epoch;
 	strftime(date, 40, "%F %T UTC", gmtime(&epoch));
 
-	g_pSM->LogMessage(myself, "GeoIP2 database loaded: %s (%s) (%s)", mmdb.metadata.database_type, date, mmdb.filename);
+	g_pSM->LogMessage(myself, "GeoIP2 database %s: %s (%s) (%s)", action, mmdb->metadata.database_type, date, mmdb->filename);
 
-	if (mmdb.metadata.languages.count > 0)
+	if (mmdb->metadata.languages.count > 0)
 	{
 		char buf[64];
-		for (size_t i = 0; i < mmdb.metadata.languages.count; i++)
+		for (size_t i = 0; i < mmdb->metadata.languages.count; i++)
 		{
 			if (i == 0)
 			{
-				strcpy(buf, mmdb.metadata.languages.names[i]);
+				strcpy(buf, mmdb->metadata.languages.names[i]);
 			}
 			else
 			{
 				strcat(buf, " ");
-				strcat(buf, mmdb.metadata.languages.names[i]);
+				strcat(buf, mmdb->metadata.languages.names[i]);
 			}
 		}
 
@@ -130,13 +148,149 @@ bool GeoIP_Extension::SDK_OnLoad(char *error, size_t maxlength, bool late)
 	double days_since_update = difftime(now, epoch) / (60 * 60 * 24);
 	if (days_since_update > DATABASE_MAX_AGE)
 		smutils->LogMessage(myself, "Your database is older than %u days. You should consider downloading a newer version from e.g. https://dev.maxmind.com/geoip/geolite2-free-geolocation-data", DATABASE_MAX_AGE);
+}
+
+static void ReloadDatabase(std::string database)
+{
+	PendingLoad *load = new PendingLoad;
+
+	char error[255];
+	load->db = OpenDatabase(database.c_str(), error, sizeof(error));
+	if (!load->db)
+	{
+		load->error = error;
+	}
+
+	// Nothing has picked up an earlier reload yet; this one replaces it.
+	PendingLoad *stale = s_PendingLoad.exchange(load);
+	if (stale)
+	{
+		if (stale->db)
+		{
+			CloseDatabase(stale->db);
+		}
+		delete stale;
+	}
+	s_Loading = false;
+}
+
+void checkPendingDatabase()
+{
+	// Cheap enough to do on every native: one atomic load when nothing is waiting.
+	if (!s_PendingLoad.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	PendingLoad *load = s_PendingLoad.exchange(nullptr);
+	if (!load)
+	{
+		return;
+	}
+
+	if (load->db)
+	{
+		// Cached records point into the old database.
+		clearLookupCache();
+		CloseDatabase(mmdb);
+		mmdb = load->db;
+		LogDatabaseInfo("reloaded");
+	}
+	else
+	{
+		smutils->LogError(myself, "%s", load->error.c_str());
+	}
+
+	delete load;
+}
+
+bool GeoIP_Extension::SDK_OnLoad(char *error, size_t maxlength, bool late)
+{
+	if (mmdb) // Already loaded.
+	{
+		return true;
+	}
+
+	char database[PLATFORM_MAX_PATH];
+	if (!FindDatabase(database, sizeof(database)))
+	{
+		ke::SafeStrcpy(error, maxlength, "Could not find GeoIP2 database.");
+		return false;
+	}
+
+	mmdb = OpenDatabase(database, error, maxlength);
+	if (!mmdb)
+	{
+		return false;
+	}
+
+	g_pShareSys->AddNatives(myself, geoip_natives);
+	g_pShareSys->RegisterLibrary(myself, "GeoIP");
+	rootconsole->AddRootConsoleCommand3("geoip", "GeoIP2 database", this);
+
+	LogDatabaseInfo("loaded");
 
 	return true;
 }
 
 void GeoIP_Extension::SDK_OnUnload()
 {
-	MMDB_close(&mmdb);
+	rootconsole->RemoveRootConsoleCommand("geoip", this);
+
+	if (s_LoadThread.joinable())
+	{
+		s_LoadThread.join();
+	}
+
+	PendingLoad *load = s_PendingLoad.exchange(nullptr);
+	if (load)
+	{
+		if (load->db)
+		{
+			CloseDatabase(load->db);
+		}
+		delete load;
+	}
+
+	clearLookupCache();
+	if (mmdb)
+	{
+		CloseDatabase(mmdb);
+		mmdb = nullptr;
+	}
+}
+
+void GeoIP_Extension::OnRootConsoleCommand(const char *cmdname, const ICommandArgs *args)
+{
+	if (args->ArgC() >= 3 && strcmp(args->Arg(2), "reload") == 0)
+	{
+		if (s_Loading)
+		{
+			rootconsole->ConsolePrint("[SM] A GeoIP2 database reload is already in progress.");
+			return;
+		}
+
+		char database[PLATFORM_MAX_PATH];
+		if (!FindDatabase(database, sizeof(database)))
+		{
+			rootconsole->ConsolePrint("[SM] Could not find GeoIP2 database.");
+			return;
+		}
+
+		// The previous load, if any, has already finished.
+		if (s_LoadThread.joinable())
+		{
+			s_LoadThread.join();
+		}
+
+		s_Loading = true;
+		s_LoadThread = std::thread(ReloadDatabase, std::string(database));
+		rootconsole->ConsolePrint("[SM] Reloading GeoIP2 database %s in the background.", database);
+		return;
+	}
+
+	rootconsole->ConsolePrint("SourceMod GeoIP Menu:");
+	rootconsole->DrawGenericOption("reload", "Reopen the GeoIP2 database without blocking the server");
 }
 
 const char *GeoIP_Extension::GetExtensionVerString()
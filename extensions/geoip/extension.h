@@ -46,7 +46,9 @@
  * @brief Implementation of the GeoIP extension.
  * Note: Uncomment one of the pre-defined virtual functions in order to use it.
  */
-class GeoIP_Extension : public SDKExtension
+class GeoIP_Extension :
+	public SDKExtension,
+	public IRootConsoleCommand
 {
 public:
 	/**
@@ -119,9 +121,17 @@ public:
 	 */
 	//virtual bool SDK_OnMetamodPauseChange(bool paused, char *error, size_t maxlength);
 #endif
+public: //IRootConsoleCommand
+	void OnRootConsoleCommand(const char *cmdname, const ICommandArgs *args);
 };
 
-extern MMDB_s mmdb;
+/**
+ * @brief Installs a database opened in the background, if one is waiting.
+ * Must be called on the main thread before using mmdb.
+ */
+void checkPendingDatabase();
+
+extern MMDB_s *mmdb;
 extern const sp_nativeinfo_t geoip_natives[];
 
 #endif // _INCLUDE_SOURCEMOD_EXTENSION_PROPER_H_
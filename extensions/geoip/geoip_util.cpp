@@ -31,6 +31,11 @@
 
 #include "geoip_util.h"
 
+#include <list>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
 const char GeoIPCountryCode[252][3] =
 {
 	"AP", "EU", "AD", "AE", "AF", "AG", "AI", "AL", "AM", "AN",
@@ -91,25 +96,105 @@ const char GeoIPCountryCode3[252][4] =
 	"BLM", "MAF"
 };
 
-bool lookupByIp(const char *ip, const char **path, MMDB_entry_data_s *result)
+// Recently seen addresses.  Plugins tend to ask several Geoip natives about the
+// same client in a row, so each address keeps its database entry and every
+// path looked up on it, skipping both the address parse and the tree walk.
+#define LOOKUP_CACHE_SIZE 256
+
+struct CachedPath
+{
+	std::string path;
+	int status;
+	MMDB_entry_data_s data;
+};
+
+struct CachedAddress
+{
+	std::string ip;
+	bool found;
+	MMDB_entry_s entry;
+	std::vector<CachedPath> paths;
+};
+
+static std::list<CachedAddress> s_LookupLru;
+static std::unordered_map<std::string_view, std::list<CachedAddress>::iterator> s_LookupIndex;
+
+static CachedAddress *lookupAddress(const char *ip)
 {
+	auto iter = s_LookupIndex.find(ip);
+	if (iter != s_LookupIndex.end())
+	{
+		s_LookupLru.splice(s_LookupLru.begin(), s_LookupLru, iter->second);
+		return &s_LookupLru.front();
+	}
+
+	if (s_LookupLru.size() >= LOOKUP_CACHE_SIZE)
+	{
+		s_LookupIndex.erase(s_LookupLru.back().ip);
+		s_LookupLru.pop_back();
+	}
+
 	int gai_error = 0, mmdb_error = 0;
-	MMDB_lookup_result_s lookup = MMDB_lookup_string(&mmdb, ip, &gai_error, &mmdb_error);
+	MMDB_lookup_result_s lookup = MMDB_lookup_string(mmdb, ip, &gai_error, &mmdb_error);
+
+	s_LookupLru.emplace_front();
+	CachedAddress &address = s_LookupLru.front();
+	address.ip = ip;
+	address.found = gai_error == 0 && mmdb_error == MMDB_SUCCESS && lookup.found_entry;
+	address.entry = lookup.entry;
+	s_LookupIndex.emplace(address.ip, s_LookupLru.begin());
+
+	return &address;
+}
 
-	if (gai_error != 0 || mmdb_error != MMDB_SUCCESS || !lookup.found_entry)
+void clearLookupCache()
+{
+	s_LookupIndex.clear();
+	s_LookupLru.clear();
+}
+
+bool lookupByIp(const char *ip, const char **path, MMDB_entry_data_s *result)
+{
+	checkPendingDatabase();
+
+	CachedAddress *address = lookupAddress(ip);
+	if (!address->found)
 	{
 		return false;
 	}
 
-	MMDB_entry_data_s entry_data;
-	mmdb_error = MMDB_aget_value(&lookup.entry, &entry_data, path);
+	// Path components cannot contain a null, so it separates them in the key.
+	std::string key;
+	for (const char **part = path; *part; part++)
+	{
+		key.append(*part);
+		key.push_back('\0');
+	}
+
+	CachedPath *cached = nullptr;
+	for (CachedPath &entry : address->paths)
+	{
+		if (entry.path == key)
+		{
+			cached = &entry;
+			break;
+		}
+	}
 
-	if (mmdb_error != MMDB_SUCCESS)
+	if (!cached)
+	{
+		address->paths.emplace_back();
+		cached = &address->paths.back();
+		cached->path = std::move(key);
+		cached->status = MMDB_aget_value(&address->entry, &cached->data, path);
+	}
+
+	if (cached->status != MMDB_SUCCESS)
 	{
 		return false;
 	}
 
-	*result = entry_data;
+	*result = cached->data;
 
 	return true;
 }
@@ -167,7 +252,9 @@ int getContinentId(const char *code)
 
 const char *getLang(int target)
 {
-	if (target != -1 && mmdb.metadata.languages.count > 0)
+	checkPendingDatabase();
+
+	if (target != -1 && mmdb->metadata.languages.count > 0)
 	{
 		unsigned int langid;
 		const char *code;
@@ -187,9 +274,9 @@ const char *getLang(int target)
 			{
 				code = "zh-CN";
 			}
-			for (size_t i = 0; i < mmdb.metadata.languages.count; i++)
+			for (size_t i = 0; i < mmdb->metadata.languages.count; i++)
 			{
-				if (strcmp(code, mmdb.metadata.languages.names[i]) == 0)
+				if (strcmp(code, mmdb->metadata.languages.names[i]) == 0)
 				{
 					return code;
 				}
@@ -39,6 +39,7 @@ double lookupDouble(const char *ip, const char **path);
 int getContinentId(const char *code);
 const char *getLang(int target);
 std::string lookupString(const char *ip, const char **path);
+void clearLookupCache();
 
 extern const char GeoIPCountryCode[252][3];
 extern const char GeoIPCountryCode3[252][4];
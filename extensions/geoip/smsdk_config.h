@@ -58,6 +58,13 @@
  */
 //#define SMEXT_CONF_METAMOD		
 
+/**
+ * @brief Lets Core defer loading this extension until one of its natives is
+ * first called. See IExtensionInterface::IsLazyLoadable().
+ * NOTE: Uncomment to enable, comment to disable.
+ */
+#define SMEXT_CONF_LAZY
+
 /** Enable interfaces you want to use here by uncommenting lines */
 //#define SMEXT_ENABLE_FORWARDSYS
 //#define SMEXT_ENABLE_HANDLESYS
@@ -66,5 +73,6 @@
 //#define SMEXT_ENABLE_GAMECONF
 #define SMEXT_ENABLE_LIBSYS
 #define SMEXT_ENABLE_TRANSLATOR
+#define SMEXT_ENABLE_ROOTCONSOLEMENU
 
 #endif // _INCLUDE_SOURCEMOD_EXTENSION_CONFIG_H_
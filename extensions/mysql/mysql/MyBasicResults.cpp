@@ -303,8 +303,8 @@ DBResult MyBasicResults::CopyBlob(unsigned int columnId, void *buffer, size_t ma
 	return res;
 }
 
-MyQuery::MyQuery(MyDatabase *db, MYSQL_RES *res)
-: m_pParent(db), m_rs(res)
+MyQuery::MyQuery(MyDatabase *db, MYSQL_RES *res, bool chained)
+: m_pParent(db), m_rs(res), m_Chained(chained)
 {
 	m_InsertID = m_pParent->GetInsertID();
 	m_AffectedRows = m_pParent->GetAffectedRows();
@@ -332,7 +332,7 @@ unsigned int MyQuery::GetAffectedRows()
 
 bool MyQuery::FetchMoreResults()
 {
-	if (m_rs.m_pRes == NULL)
+	if (m_rs.m_pRes == NULL || !m_Chained)
 	{
 		return false;
 	} else if (!mysql_more_results(m_pParent->m_mysql)) {
@@ -373,3 +373,114 @@ void MyQuery::Destroy()
 	/* Self destruct */
 	delete this;
 }
+
+MyResultStream::MyResultStream(MyDatabase *db, MYSQL_RES *res)
+: MyBasicResults(res), m_pParent(db), m_Done(false), m_ErrorCode(0)
+{
+	m_InsertID = m_pParent->GetInsertID();
+	m_AffectedRows = m_pParent->GetAffectedRows();
+}
+
+unsigned int MyResultStream::GetRowCount()
+{
+	/* mysql_use_result() can't know the total, so report what we've read */
+	return m_CurRow;
+}
+
+bool MyResultStream::MoreRows()
+{
+	return !m_Done;
+}
+
+IResultRow *MyResultStream::FetchRow()
+{
+	if (m_Done)
+	{
+		return NULL;
+	}
+
+	m_Row = mysql_fetch_row(m_pRes);
+	if (!m_Row)
+	{
+		m_Done = true;
+
+		/* A NULL row is also how the client reports a dropped connection */
+		if ((m_ErrorCode = mysql_errno(m_pParent->m_mysql)) != 0)
+		{
+			m_Error.assign(mysql_error(m_pParent->m_mysql));
+		}
+		return NULL;
+	}
+
+	m_Lengths = mysql_fetch_lengths(m_pRes);
+	m_CurRow++;
+	return this;
+}
+
+IResultRow *MyResultStream::CurrentRow()
+{
+	if (!m_pRes || !m_Row)
+	{
+		return NULL;
+	}
+
+	return this;
+}
+
+bool MyResultStream::Rewind()
+{
+	return false;
+}
+
+IResultSet *MyResultStream::GetResultSet()
+{
+	if (m_pRes == NULL)
+	{
+		return NULL;
+	}
+
+	return this;
+}
+
+const char *MyResultStream::GetError(int *errCode)
+{
+	if (errCode)
+	{
+		*errCode = m_ErrorCode;
+	}
+
+	return m_Error.c_str();
+}
+
+unsigned int MyResultStream::GetInsertID()
+{
+	return m_InsertID;
+}
+
+unsigned int MyResultStream::GetAffectedRows()
+{
+	return m_AffectedRows;
+}
+
+void MyResultStream::Destroy()
+{
+	MYSQL *mysql = m_pParent->m_mysql;
+
+	/* Freeing an unbuffered result reads off whatever rows are left */
+	if (m_pRes != NULL)
+	{
+		mysql_free_result(m_pRes);
+	}
+
+	/* Discard any further result sets so the connection is usable again */
+	while (mysql_more_results(mysql) && mysql_next_result(mysql) == 0)
+	{
+		MYSQL_RES *res = mysql_use_result(mysql);
+		if (res != NULL)
+		{
+			mysql_free_result(res);
+		}
+	}
+
+	delete this;
+}
@@ -69,7 +69,7 @@ public: //IResultRow
 	size_t GetDataSize(unsigned int columnId);
 protected:
 	void Update();
-private:
+protected:
 	MYSQL_RES *m_pRes;
 	unsigned int m_CurRow;
 	MYSQL_ROW m_Row;
@@ -82,7 +82,7 @@ class MyQuery : public IQuery
 {
 	friend class MyBasicResults;
 public:
-	MyQuery(MyDatabase *db, MYSQL_RES *res);
+	MyQuery(MyDatabase *db, MYSQL_RES *res, bool chained=true);
 public:
 	IResultSet *GetResultSet();
 	bool FetchMoreResults();
@@ -95,6 +95,34 @@ private:
 	MyBasicResults m_rs;
 	unsigned int m_InsertID;
 	unsigned int m_AffectedRows;
+	bool m_Chained;		/* later result sets on the connection are ours */
+};
+
+class MyResultStream :
+	public MyBasicResults,
+	public IResultStream
+{
+public:
+	MyResultStream(MyDatabase *db, MYSQL_RES *res);
+public: //IResultSet
+	unsigned int GetRowCount();
+	bool MoreRows();
+	IResultRow *FetchRow();
+	IResultRow *CurrentRow();
+	bool Rewind();
+public: //IResultStream
+	IResultSet *GetResultSet();
+	const char *GetError(int *errCode=NULL);
+	unsigned int GetAffectedRows();
+	unsigned int GetInsertID();
+	void Destroy();
+private:
+	ke::RefPtr<MyDatabase> m_pParent;
+	unsigned int m_InsertID;
+	unsigned int m_AffectedRows;
+	bool m_Done;
+	int m_ErrorCode;
+	String m_Error;
 };
 
 #endif //_INCLUDE_SM_MYSQL_BASIC_RESULTS_H_
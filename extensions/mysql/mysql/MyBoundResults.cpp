@@ -33,6 +33,11 @@
 
 #define DEFAULT_BUFFER_SIZE		5
 
+/* Largest column buffer grown up front from a result's max_length.  Anything
+ * bigger is still refetched per row as it's read.
+ */
+#define PRESIZE_BUFFER_LIMIT	65536
+
 /* :IDEA: When we have to refetch a buffer to do type changes, should we rebind
  * the buffer so the next fetch will predict the proper cast?  Probably yes since
  * these things are done in standard iterations, but maybe users should be punished
@@ -69,6 +74,26 @@ enum_field_types GetTheirType(DBType type)
 	return MYSQL_TYPE_STRING;
 }
 
+static bool GetBindType(MYSQL_FIELD *field, enum_field_types *bindType)
+{
+	DBType type = GetOurType(field->type);
+	switch (type)
+	{
+	case DBType_Integer:
+		*bindType = MYSQL_TYPE_LONG;
+		return true;
+	case DBType_Float:
+		*bindType = MYSQL_TYPE_FLOAT;
+		return true;
+	case DBType_String:
+	case DBType_Blob:
+		*bindType = GetTheirType(type);
+		return true;
+	default:
+		return false;
+	}
+}
+
 MyBoundResults::MyBoundResults(MYSQL_STMT *stmt, MYSQL_RES *res, unsigned int num_fields)
 : m_stmt(stmt), m_pRes(res), m_ColCount(num_fields), m_Initialized(false), m_RowCount(0), m_CurRow(0)
 {
@@ -107,6 +132,64 @@ void MyBoundResults::Update()
 {
 	m_RowCount = (unsigned int)mysql_stmt_num_rows(m_stmt);
 	m_CurRow = 0;
+
+	if (!m_Initialized)
+	{
+		return;
+	}
+
+	/* The statement reports the longest value in each column once the rows are
+	 * stored, so grow the buffers now rather than refetching row by row.
+	 */
+	for (unsigned int i=0; i<m_ColCount; i++)
+	{
+		if (m_bind[i].buffer_type != MYSQL_TYPE_STRING && m_bind[i].buffer_type != MYSQL_TYPE_BLOB)
+		{
+			continue;
+		}
+
+		MYSQL_FIELD *field = mysql_fetch_field_direct(m_pRes, i);
+		size_t wanted = (size_t)field->max_length + 1;
+		if (wanted <= m_pull[i].length || wanted > PRESIZE_BUFFER_LIMIT)
+		{
+			continue;
+		}
+
+		delete [] m_pull[i].blob;
+		m_pull[i].blob = new unsigned char[wanted];
+		m_pull[i].length = wanted;
+		m_bind[i].buffer = m_pull[i].blob;
+		m_bind[i].buffer_length = (unsigned long)wanted;
+		m_bUpdatedBinds = true;
+	}
+}
+
+bool MyBoundResults::Matches(MYSQL_RES *res, unsigned int num_fields)
+{
+	if (!m_Initialized || num_fields != m_ColCount)
+	{
+		return false;
+	}
+
+	enum_field_types type;
+	for (unsigned int i=0; i<m_ColCount; i++)
+	{
+		if (!GetBindType(mysql_fetch_field_direct(res, i), &type) || type != m_bind[i].buffer_type)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void MyBoundResults::Reset(MYSQL_RES *res)
+{
+	/* Same shape as before, so the bind and its buffers carry over. */
+	m_pRes = res;
+	m_RowCount = 0;
+	m_CurRow = 0;
+	m_bUpdatedBinds = false;
 }
 
 bool MyBoundResults::Initialize()
@@ -117,20 +200,20 @@ bool MyBoundResults::Initialize()
 		for (unsigned int i=0; i<m_ColCount; i++)
 		{
 			MYSQL_FIELD *field = mysql_fetch_field_direct(m_pRes, i);
-			DBType type = GetOurType(field->type);
+			enum_field_types type;
+			if (!GetBindType(field, &type))
+			{
+				return false;
+			}
 
 			m_bind[i].length = &(m_pull[i].my_length);
 			m_bind[i].is_null = &(m_pull[i].my_null);
+			m_bind[i].buffer_type = type;
 
-			if (type == DBType_Integer)
+			if (type == MYSQL_TYPE_LONG || type == MYSQL_TYPE_FLOAT)
 			{
-				m_bind[i].buffer_type = MYSQL_TYPE_LONG;
-				m_bind[i].buffer = &(m_pull[i].data.ival);
-			} else if (type == DBType_Float) {
-				m_bind[i].buffer_type = MYSQL_TYPE_FLOAT;
 				m_bind[i].buffer = &(m_pull[i].data.ival);
-			} else if (type == DBType_String || type == DBType_Blob) {
-				m_bind[i].buffer_type = GetTheirType(type);
+			} else {
 
 				/* We bound this to 2048 bytes.  Otherwise a MEDIUMBLOB
 				 * or something could allocate horrible amounts of memory
@@ -146,8 +229,6 @@ bool MyBoundResults::Initialize()
 
 				m_bind[i].buffer = m_pull[i].blob;
 				m_bind[i].buffer_length = (unsigned long)creat_length;
-			} else {
-				return false;
 			}
 		}
 		m_Initialized = true;
@@ -83,6 +83,8 @@ public: //IResultRow
 public:
 	bool Initialize();
 	void Update();
+	bool Matches(MYSQL_RES *res, unsigned int num_fields);
+	void Reset(MYSQL_RES *res);
 private:
 	bool RefetchField(MYSQL_STMT *stmt, 
 		unsigned int id,
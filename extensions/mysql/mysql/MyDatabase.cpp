@@ -29,6 +29,7 @@
  * Version: $Id$
  */
 
+#include <ctype.h>
 #include "MyDatabase.h"
 #include "smsdk_ext.h"
 #include "MyBasicResults.h"
@@ -111,6 +112,7 @@ MyDatabase::~MyDatabase()
 	/* Remove us from the search list */
 	if (m_bPersistent)
 		g_MyDriver.RemoveFromList(this, true);
+	m_StmtCache.Clear();
 	mysql_close(m_mysql);
 }
 
@@ -151,7 +153,12 @@ const char *MyDatabase::GetError(int *errCode)
 
 bool MyDatabase::QuoteString(const char *str, char buffer[], size_t maxlength, size_t *newSize)
 {
-	unsigned long size = static_cast<unsigned long>(strlen(str));
+	return QuoteStringEx(str, strlen(str), buffer, maxlength, newSize);
+}
+
+bool MyDatabase::QuoteStringEx(const char *str, size_t len, char buffer[], size_t maxlength, size_t *newSize)
+{
+	unsigned long size = static_cast<unsigned long>(len);
 	unsigned long needed = size * 2 + 1;
 
 	if (maxlength < needed)
@@ -172,6 +179,24 @@ bool MyDatabase::QuoteString(const char *str, char buffer[], size_t maxlength, s
 	return true;
 }
 
+size_t MyDatabase::QuoteStrings(const char * const *strs, const size_t *lengths, size_t count,
+	char buffer[], size_t maxlen, size_t *sizes)
+{
+	size_t i;
+	for (i = 0; i < count; i++)
+	{
+		size_t written;
+		if (!MyDatabase::QuoteStringEx(strs[i], lengths[i], buffer, maxlen, &written))
+		{
+			break;
+		}
+		sizes[i] = written;
+		buffer += written + 1;
+		maxlen -= written + 1;
+	}
+	return i;
+}
+
 bool MyDatabase::DoSimpleQuery(const char *query)
 {
 	IQuery *pQuery = DoQuery(query);
@@ -234,6 +259,144 @@ IQuery *MyDatabase::DoQueryEx(const char *query, size_t len)
 	return new MyQuery(this, res);
 }
 
+IResultStream *MyDatabase::DoQueryStream(const char *query, size_t len)
+{
+	if (mysql_real_query(m_mysql, query, static_cast<unsigned long>(len)) != 0)
+	{
+		return NULL;
+	}
+
+	MYSQL_RES *res = NULL;
+	if (mysql_field_count(m_mysql))
+	{
+		res = mysql_use_result(m_mysql);
+		if (!res)
+		{
+			return NULL;
+		}
+	}
+
+	return new MyResultStream(this, res);
+}
+
+/* Keep each multi-statement packet well under the default max_allowed_packet */
+#define MAX_BATCH_BYTES		(512 * 1024)
+
+/* Drops a trailing delimiter, which would otherwise leave an empty statement
+ * behind once the queries are joined (rejected with ER_EMPTY_QUERY).
+ */
+static size_t TrimStatement(const char *query, size_t length)
+{
+	while (length > 0 && (query[length - 1] == ';' || isspace(static_cast<unsigned char>(query[length - 1]))))
+	{
+		length--;
+	}
+	return length;
+}
+
+size_t MyDatabase::DoQueryBatch(const char * const *queries, const size_t *lengths, size_t count, IQuery **results)
+{
+	if (count < 2 || mysql_set_server_option(m_mysql, MYSQL_OPTION_MULTI_STATEMENTS_ON) != 0)
+	{
+		return IDatabase::DoQueryBatch(queries, lengths, count, results);
+	}
+
+	size_t done = 0;
+	std::string batch;
+	while (done < count)
+	{
+		size_t end = done;
+		batch.clear();
+		while (end < count)
+		{
+			size_t length = TrimStatement(queries[end], lengths[end]);
+			if (end != done && batch.size() + length >= MAX_BATCH_BYTES)
+			{
+				break;
+			}
+
+			/* The newline ends any trailing "--" comment before the delimiter */
+			if (end != done)
+			{
+				batch.append("\n;\n");
+			}
+			batch.append(queries[end], length);
+			end++;
+		}
+
+		size_t size = end - done;
+		size_t ran = RunBatch(batch, size, &results[done]);
+		done += ran;
+		if (ran < size)
+		{
+			break;
+		}
+	}
+
+	mysql_set_server_option(m_mysql, MYSQL_OPTION_MULTI_STATEMENTS_OFF);
+	return done;
+}
+
+size_t MyDatabase::RunBatch(const std::string &batch, size_t count, IQuery **results)
+{
+	if (mysql_real_query(m_mysql, batch.c_str(), static_cast<unsigned long>(batch.size())) != 0)
+	{
+		return 0;
+	}
+
+	size_t got = 0;
+	bool failed = false;
+	bool overflow = false;
+	do
+	{
+		MYSQL_RES *res = NULL;
+		if (mysql_field_count(m_mysql))
+		{
+			res = mysql_store_result(m_mysql);
+			if (!res)
+			{
+				/* Keep reading the remaining results, or the connection is
+				 * left out of sync for the next command.
+				 */
+				failed = true;
+			}
+		}
+
+		if (failed)
+		{
+			if (res)
+			{
+				mysql_free_result(res);
+			}
+		} else if (got < count) {
+			results[got++] = new MyQuery(this, res, false);
+		} else {
+			overflow = true;
+			if (res)
+			{
+				mysql_free_result(res);
+			}
+		}
+
+		/* 0 means another result follows, -1 means we're done, >0 means the next statement failed */
+	} while (mysql_next_result(m_mysql) == 0);
+
+	/* A query held more than one statement, so results no longer line up
+	 * with queries.  Report the whole batch as failed.
+	 */
+	if (overflow)
+	{
+		for (size_t i = 0; i < got; i++)
+		{
+			results[i]->Destroy();
+			results[i] = NULL;
+		}
+		return 0;
+	}
+
+	return got;
+}
+
 unsigned int MyDatabase::GetAffectedRowsForQuery(IQuery *query)
 {
 	return static_cast<MyQuery*>(query)->GetAffectedRows();
@@ -246,7 +409,15 @@ unsigned int MyDatabase::GetInsertIDForQuery(IQuery *query)
 
 IPreparedQuery *MyDatabase::PrepareQuery(const char *query, char *error, size_t maxlength, int *errCode)
 {
-	MYSQL_STMT *stmt = mysql_stmt_init(m_mysql);
+	size_t length = strlen(query);
+
+	MYSQL_STMT *stmt;
+	if (m_StmtCache.Take(query, length, &stmt))
+	{
+		return new MyStatement(this, stmt, query, length);
+	}
+
+	stmt = mysql_stmt_init(m_mysql);
 	if (!stmt)
 	{
 		if (error)
@@ -258,7 +429,7 @@ IPreparedQuery *MyDatabase::PrepareQuery(const char *query, char *error, size_t
 		return NULL;
 	}
 
-	if (mysql_stmt_prepare(stmt, query, static_cast<unsigned long>(strlen(query))) != 0)
+	if (mysql_stmt_prepare(stmt, query, static_cast<unsigned long>(length)) != 0)
 	{
 		if (error)
 		{
@@ -272,7 +443,18 @@ IPreparedQuery *MyDatabase::PrepareQuery(const char *query, char *error, size_t
 		return NULL;
 	}
 
-	return new MyStatement(this, stmt);
+	return new MyStatement(this, stmt, query, length);
+}
+
+void MyDatabase::ReleaseStatement(const std::string &query, MYSQL_STMT *stmt)
+{
+	m_StmtCache.Give(query.c_str(), query.size(), stmt);
+}
+
+bool MyDatabase::GetStatementCacheStats(DBStatementCacheStats *stats)
+{
+	m_StmtCache.GetStats(stats);
+	return true;
 }
 
 bool MyDatabase::LockForFullAtomicOperation()
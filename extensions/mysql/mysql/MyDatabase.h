@@ -34,9 +34,17 @@
 
 #include <am-refcounting-threadsafe.h>
 #include <mutex>
+#include <string>
+#include <sm_stmtcache.h>
 #include "MyDriver.h"
 
+static inline void MyCloseStatement(MYSQL_STMT *stmt)
+{
+	mysql_stmt_close(stmt);
+}
+
 class MyQuery;
+class MyResultStream;
 class MyStatement;
 
 class MyDatabase
@@ -44,6 +52,7 @@ class MyDatabase
 	  public ke::RefcountedThreadsafe<MyDatabase>
 {
 	friend class MyQuery;
+	friend class MyResultStream;
 	friend class MyStatement;
 public:
 	MyDatabase(MYSQL *mysql, const DatabaseInfo *info, bool persistent);
@@ -66,10 +75,20 @@ public: //IDatabase
 	unsigned int GetAffectedRowsForQuery(IQuery *query);
 	unsigned int GetInsertIDForQuery(IQuery *query);
 	bool SetCharacterSet(const char *characterset);
+	bool GetStatementCacheStats(DBStatementCacheStats *stats);
+	IResultStream *DoQueryStream(const char *query, size_t len);
+	size_t DoQueryBatch(const char * const *queries, const size_t *lengths, size_t count, IQuery **results);
+	bool QuoteStringEx(const char *str, size_t len, char buffer[], size_t maxlen, size_t *newSize);
+	size_t QuoteStrings(const char * const *strs, const size_t *lengths, size_t count,
+		char buffer[], size_t maxlen, size_t *sizes);
 public:
 	const DatabaseInfo &GetInfo();
+	void ReleaseStatement(const std::string &query, MYSQL_STMT *stmt);
+private:
+	size_t RunBatch(const std::string &batch, size_t count, IQuery **results);
 private:
 	MYSQL *m_mysql;
+	StatementCache<MYSQL_STMT *, MyCloseStatement> m_StmtCache;
 	std::recursive_mutex m_FullLock;
 
 	/* ---------- */
@@ -32,8 +32,9 @@
 #include "MyStatement.h"
 #include "MyBoundResults.h"
 
-MyStatement::MyStatement(MyDatabase *db, MYSQL_STMT *stmt)
-: m_mysql(db->m_mysql), m_pParent(db), m_stmt(stmt), m_pRes(NULL), m_rs(NULL), m_Results(false)
+MyStatement::MyStatement(MyDatabase *db, MYSQL_STMT *stmt, const char *query, size_t length)
+: m_mysql(db->m_mysql), m_pParent(db), m_stmt(stmt), m_pRes(NULL), m_rs(NULL), m_Results(false),
+  m_Query(query, length), m_Cacheable(true)
 {
 	m_Params = (unsigned int)mysql_stmt_param_count(m_stmt);
 
@@ -48,6 +49,12 @@ MyStatement::MyStatement(MyDatabase *db, MYSQL_STMT *stmt)
 		m_bind = NULL;
 	}
 
+	/* Have mysql_stmt_store_result() record each column's longest value, so
+	 * result buffers can be sized once per execute instead of once per row.
+	 */
+	my_bool update_max = 1;
+	mysql_stmt_attr_set(m_stmt, STMT_ATTR_UPDATE_MAX_LENGTH, &update_max);
+
 	m_Results = false;
 }
 
@@ -60,6 +67,7 @@ MyStatement::~MyStatement()
 
 	/* Free result set structures */
 	ClearResults();
+	delete m_rs;
 
 	/* Free old blobs */
 	for (unsigned int i=0; i<m_Params; i++)
@@ -71,8 +79,19 @@ MyStatement::~MyStatement()
 	free(m_pushinfo);
 	free(m_bind);
 	
-	/* Close our mysql handles */
-	mysql_stmt_close(m_stmt);
+	/* Keep the server-side statement around for the next prepare of the same 
+	 * query. Parameters are bound again on every execute, so dropping any 
+	 * buffered rows is all the reset it needs.
+	 */
+	if (m_Cacheable)
+	{
+		mysql_stmt_free_result(m_stmt);
+		m_pParent->ReleaseStatement(m_Query, m_stmt);
+	}
+	else
+	{
+		mysql_stmt_close(m_stmt);
+	}
 }
 
 void MyStatement::Destroy()
@@ -82,11 +101,7 @@ void MyStatement::Destroy()
 
 void MyStatement::ClearResults()
 {
-	if (m_rs)
-	{
-		delete m_rs;
-		m_rs = NULL;
-	}
+	/* m_rs stays, so the next result can reuse its buffers. */
 	if (m_pRes)
 	{
 		mysql_free_result(m_pRes);
@@ -128,15 +143,25 @@ bool MyStatement::FetchMoreResults()
 		return false;
 	}
 
-	/* If we don't have a result manager, create one. */
-	if (!m_rs)
+	return BindResults(num_fields);
+}
+
+bool MyStatement::BindResults(unsigned int num_fields)
+{
+	/* Reuse the last result manager if the columns line up, else start over. */
+	if (m_rs && m_rs->Matches(m_pRes, num_fields))
 	{
+		m_rs->Reset(m_pRes);
+	}
+	else
+	{
+		delete m_rs;
 		m_rs = new MyBoundResults(m_stmt, m_pRes, num_fields);
 	}
 
 	/* Tell the result set to update its bind info,
-	* and initialize itself if necessary.
-	*/
+	 * and initialize itself if necessary.
+	 */
 	if (!(m_Results = m_rs->Initialize()))
 	{
 		return false;
@@ -288,12 +313,17 @@ bool MyStatement::Execute()
 	{
 		if (mysql_stmt_bind_param(m_stmt, m_bind) != 0)
 		{
+			m_Cacheable = false;
 			return false;
 		}
 	}
 
+	/* A failed execute may mean the server no longer knows this statement 
+	 * (after a reconnect, say), so it must not be reused.
+	 */
 	if (mysql_stmt_execute(m_stmt) != 0)
 	{
+		m_Cacheable = false;
 		return false;
 	}
 
@@ -313,25 +343,7 @@ bool MyStatement::Execute()
 		return true;
 	}
 
-	/* Create our result manager. */
-	m_rs = new MyBoundResults(m_stmt, m_pRes, num_fields);
-
-	/* Tell the result set to update its bind info,
-	 * and initialize itself if necessary.
-	 */
-	if (!(m_Results = m_rs->Initialize()))
-	{
-		return false;
-	}
-
-	/* Try precaching the results. */
-	m_Results = (mysql_stmt_store_result(m_stmt) == 0);
-
-	/* Update now that the data is known. */
-	m_rs->Update();
-
-	/* Return indicator */
-	return m_Results;
+	return BindResults(num_fields);
 }
 
 const char *MyStatement::GetError(int *errCode/* =NULL */)
@@ -49,7 +49,7 @@ struct ParamBind
 class MyStatement : public IPreparedQuery
 {
 public:
-	MyStatement(MyDatabase *db, MYSQL_STMT *stmt);
+	MyStatement(MyDatabase *db, MYSQL_STMT *stmt, const char *query, size_t length);
 	~MyStatement();
 public: //IQuery
 	IResultSet *GetResultSet();
@@ -68,6 +68,7 @@ public: //IPreparedQuery
 private:
 	void *CopyBlob(unsigned int param, const void *blobptr, size_t length);
 	void ClearResults();
+	bool BindResults(unsigned int num_fields);
 private:
 	MYSQL *m_mysql;
 	ke::RefPtr<MyDatabase> m_pParent;
@@ -76,8 +77,10 @@ private:
 	MYSQL_RES *m_pRes;
 	ParamBind *m_pushinfo;
 	unsigned int m_Params;
-	MyBoundResults *m_rs;
+	MyBoundResults *m_rs;		/* kept across executes while the result shape holds */
 	bool m_Results;
+	std::string m_Query;
+	bool m_Cacheable;		/* return the statement to the parent's cache on destroy */
 };
 
 #endif //_INCLUDE_SM_MYSQL_STATEMENT_H_
@@ -33,6 +33,10 @@
 #include "smsdk_ext.h"
 #include "PgBasicResults.h"
 #include "PgStatement.h"
+#if !defined PLATFORM_WINDOWS
+#include <errno.h>
+#include <poll.h>
+#endif
 
 // Some selected defines from postgresql 9.2.4's src/include/catalog/pg_type.h
 // Fast scan to extract the types that shouldn't be read as string.
@@ -130,8 +134,19 @@ DBType GetOurType(Oid type)
 
 PgDatabase::PgDatabase(PGconn *pgsql, const DatabaseInfo *info, bool persistent)
 	: m_pgsql(pgsql), m_lastInsertID(0), m_lastAffectedRows(0), m_preparedStatementID(0),
-  m_bPersistent(persistent)
+  m_QueryTimeout(0), m_bPersistent(persistent)
 {
+	if (info->dbiVersion >= 11 && info->options)
+	{
+		for (const char *const *opt = info->options; opt[0] != NULL; opt += 2)
+		{
+			if (strcmp(opt[0], "query_timeout") == 0)
+			{
+				m_QueryTimeout = atoi(opt[1]);
+			}
+		}
+	}
+
 	m_Host.assign(info->host);
 	m_Database.assign(info->database);
 	m_User.assign(info->user);
@@ -210,7 +225,12 @@ const char *PgDatabase::GetError(int *errCode)
 
 bool PgDatabase::QuoteString(const char *str, char buffer[], size_t maxlength, size_t *newSize)
 {
-	size_t size = strlen(str);
+	return QuoteStringEx(str, strlen(str), buffer, maxlength, newSize);
+}
+
+bool PgDatabase::QuoteStringEx(const char *str, size_t len, char buffer[], size_t maxlength, size_t *newSize)
+{
+	size_t size = len;
 	size_t needed = size * 2 + 1;
 
 	if (maxlength < needed)
@@ -232,6 +252,126 @@ bool PgDatabase::QuoteString(const char *str, char buffer[], size_t maxlength, s
 	return error == 0;
 }
 
+/* Waits up to timeoutMs (-1 = forever) for the socket to become readable.
+ * Returns >0 when readable, 0 on timeout and <0 on error.
+ */
+static int WaitForSocket(int sock, int timeoutMs)
+{
+#if defined PLATFORM_WINDOWS
+	fd_set fds;
+	FD_ZERO(&fds);
+	FD_SET((SOCKET)sock, &fds);
+
+	timeval tv;
+	timeval *ptv = NULL;
+	if (timeoutMs >= 0)
+	{
+		tv.tv_sec = timeoutMs / 1000;
+		tv.tv_usec = (timeoutMs % 1000) * 1000;
+		ptv = &tv;
+	}
+	return select(sock + 1, &fds, NULL, NULL, ptv);
+#else
+	pollfd pfd;
+	pfd.fd = sock;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+
+	int ready;
+	do
+	{
+		ready = poll(&pfd, 1, timeoutMs);
+	} while (ready < 0 && errno == EINTR);
+	return ready;
+#endif
+}
+
+PgQueryWait PgDatabase::BeginWait()
+{
+	PgQueryWait wait;
+	wait.timed = (m_QueryTimeout > 0);
+	wait.cancelled = false;
+	if (wait.timed)
+	{
+		wait.deadline = std::chrono::steady_clock::now() + std::chrono::seconds(m_QueryTimeout);
+	}
+	return wait;
+}
+
+void PgDatabase::CancelQuery()
+{
+	PGcancel *cancel = PQgetCancel(m_pgsql);
+	if (cancel)
+	{
+		char errbuf[256];
+		PQcancel(cancel, errbuf, sizeof(errbuf));
+		PQfreeCancel(cancel);
+	}
+}
+
+PGresult *PgDatabase::NextResult(PgQueryWait &wait)
+{
+	/* Read on our side of the socket, not inside libpq, so a query that runs
+	 * past query_timeout can be cancelled.  The server then answers with an
+	 * error result like any other failure.
+	 */
+	while (PQisBusy(m_pgsql))
+	{
+		int timeoutMs = -1;
+		if (wait.timed && !wait.cancelled)
+		{
+			std::chrono::steady_clock::duration left = wait.deadline - std::chrono::steady_clock::now();
+			if (left <= std::chrono::steady_clock::duration::zero())
+			{
+				CancelQuery();
+				wait.cancelled = true;
+				continue;
+			}
+			timeoutMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(left).count() + 1;
+		}
+
+		int sock = PQsocket(m_pgsql);
+		if (sock < 0)
+		{
+			break;
+		}
+
+		int ready = WaitForSocket(sock, timeoutMs);
+		if (ready < 0 || (ready > 0 && !PQconsumeInput(m_pgsql)))
+		{
+			/* The connection is broken; let libpq produce the error result. */
+			break;
+		}
+	}
+
+	return PQgetResult(m_pgsql);
+}
+
+PGresult *PgDatabase::AwaitResult(int sent)
+{
+	if (!sent)
+	{
+		return NULL;
+	}
+
+	/* Like PQexec: keep the last result, or the first error. */
+	PgQueryWait wait = BeginWait();
+	PGresult *result = NULL;
+	PGresult *res;
+	while ((res = NextResult(wait)) != NULL)
+	{
+		if (result && PQresultStatus(result) == PGRES_FATAL_ERROR)
+		{
+			PQclear(res);
+		} else {
+			PQclear(result);
+			result = res;
+		}
+	}
+
+	return result;
+}
+
 bool PgDatabase::DoSimpleQuery(const char *query)
 {
 	IQuery *pQuery = DoQuery(query);
@@ -245,7 +385,7 @@ bool PgDatabase::DoSimpleQuery(const char *query)
 
 IQuery *PgDatabase::DoQuery(const char *query)
 {
-	PGresult *res = PQexec(m_pgsql, query);
+	PGresult *res = AwaitResult(PQsendQuery(m_pgsql, query));
 	
 	ExecStatusType status = PQresultStatus(res);
 	
@@ -276,6 +416,68 @@ IQuery *PgDatabase::DoQueryEx(const char *query, size_t len)
 	return DoQuery(query);
 }
 
+size_t PgDatabase::DoQueryBatch(const char * const *queries, const size_t *lengths, size_t count, IQuery **results)
+{
+	if (count < 2)
+	{
+		return IDatabase::DoQueryBatch(queries, lengths, count, results);
+	}
+
+	/* A multi-statement simple query runs in one round trip and still
+	 * yields one PGresult per statement.  The newline ends any trailing
+	 * "--" comment before the delimiter.
+	 */
+	std::string batch;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (i)
+		{
+			batch.append("\n;\n");
+		}
+		batch.append(queries[i], lengths[i]);
+	}
+
+	if (!PQsendQuery(m_pgsql, batch.c_str()))
+	{
+		return 0;
+	}
+
+	size_t got = 0;
+	bool failed = false, overflow = false;
+	PgQueryWait wait = BeginWait();
+	PGresult *res;
+	while ((res = NextResult(wait)) != NULL)
+	{
+		/* Every result has to be drained before the connection is usable */
+		ExecStatusType status = PQresultStatus(res);
+		if (failed || (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK))
+		{
+			failed = true;
+			PQclear(res);
+		} else if (got >= count) {
+			overflow = true;
+			PQclear(res);
+		} else {
+			results[got++] = new PgQuery(this, res);
+		}
+	}
+
+	/* A query held more than one statement, so results no longer line up
+	 * with queries.  Report the whole batch as failed.
+	 */
+	if (overflow)
+	{
+		for (size_t i = 0; i < got; i++)
+		{
+			results[i]->Destroy();
+			results[i] = NULL;
+		}
+		return 0;
+	}
+
+	return got;
+}
+
 unsigned int PgDatabase::GetAffectedRowsForQuery(IQuery *query)
 {
 	return static_cast<PgQuery*>(query)->GetAffectedRows();
@@ -295,7 +497,7 @@ IPreparedQuery *PgDatabase::PrepareQuery(const char *query, char *error, size_t
 	m_preparedStatementID++;
 	
 	// Let postgresql guess the types of the arguments if there are any..
-	PGresult *res = PQprepare(m_pgsql, stmtName, query, 0, NULL);
+	PGresult *res = AwaitResult(PQsendPrepare(m_pgsql, stmtName, query, 0, NULL));
 
 	if (PQresultStatus(res) != PGRES_COMMAND_OK)
 	{
@@ -33,12 +33,22 @@
 #define _INCLUDE_SM_PGSQL_DATABASE_H_
 
 #include <amtl/am-refcounting-threadsafe.h>
+#include <chrono>
 #include <mutex>
+#include <string>
 #include "PgDriver.h"
 
 class PgQuery;
 class PgStatement;
 
+/* Progress of waiting on one sent query, see PgDatabase::NextResult. */
+struct PgQueryWait
+{
+	std::chrono::steady_clock::time_point deadline;
+	bool timed;
+	bool cancelled;
+};
+
 class PgDatabase 
 	: public IDatabase,
 	  public ke::RefcountedThreadsafe<PgDatabase>
@@ -66,9 +76,16 @@ public: //IDatabase
 	unsigned int GetAffectedRowsForQuery(IQuery *query);
 	unsigned int GetInsertIDForQuery(IQuery *query);
 	bool SetCharacterSet(const char *characterset);
+	size_t DoQueryBatch(const char * const *queries, const size_t *lengths, size_t count, IQuery **results);
+	bool QuoteStringEx(const char *str, size_t len, char buffer[], size_t maxlen, size_t *newSize);
 public:
 	const DatabaseInfo &GetInfo();
 	void SetLastIDAndRows(unsigned int insertID, unsigned int affectedRows);
+	PgQueryWait BeginWait();
+	PGresult *NextResult(PgQueryWait &wait);
+	PGresult *AwaitResult(int sent);
+private:
+	void CancelQuery();
 private:
 	PGconn *m_pgsql;
 	std::recursive_mutex m_FullLock;
@@ -78,6 +95,7 @@ private:
 	std::mutex m_LastQueryInfoLock;
 	
 	unsigned int m_preparedStatementID;
+	unsigned int m_QueryTimeout;	/* seconds, 0 = wait as long as it takes */
 
 	/* ---------- */
 	DatabaseInfo m_Info;
@@ -265,7 +265,7 @@ bool PgStatement::Execute()
 			}
 		}
 
-		res = PQexecPrepared(m_pgsql, m_stmtName, m_Params, paramValues, paramLengths, paramFormats, 0);
+		res = m_pParent->AwaitResult(PQsendQueryPrepared(m_pgsql, m_stmtName, m_Params, paramValues, paramLengths, paramFormats, 0));
 		delete [] paramFormats;
 		delete [] paramLengths;
 
@@ -287,7 +287,7 @@ bool PgStatement::Execute()
 	// There are no parameters to be bound!
 	else
 	{
-		res = PQexecPrepared(m_pgsql, m_stmtName, 0, NULL, NULL, NULL, 0);
+		res = m_pParent->AwaitResult(PQsendQueryPrepared(m_pgsql, m_stmtName, 0, NULL, NULL, NULL, 0));
 	}
 
 	ExecStatusType status = PQresultStatus(res);
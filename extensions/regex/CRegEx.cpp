@@ -35,12 +35,125 @@
 #include "CRegEx.h"
 #include "extension.h"
 
+RegexCache g_RegexCache;
+
+CompiledPattern::CompiledPattern(pcre *re, pcre_extra *extra)
+	: re(re), extra(extra)
+{
+}
+
+CompiledPattern::~CompiledPattern()
+{
+	if (extra)
+		pcre_free_study(extra);
+	pcre_free(re);
+}
+
+RegexCache::RegexCache() : mJitStack(nullptr)
+{
+}
+
+RegexCache::~RegexCache()
+{
+	Clear();
+	if (mJitStack)
+		pcre_jit_stack_free(mJitStack);
+}
+
+ke::RefPtr<CompiledPattern> RegexCache::Compile(const char *pattern, int iFlags,
+	int *errorCode, const char **error, int *errorOffset)
+{
+	// Patterns cannot contain a null, so it safely separates the flags.
+	std::string key(pattern);
+	key.push_back('\0');
+	key.append(reinterpret_cast<const char *>(&iFlags), sizeof(iFlags));
+
+	auto iter = mIndex.find(key);
+	if (iter != mIndex.end())
+	{
+		mLru.splice(mLru.begin(), mLru, iter->second);
+		return iter->second->second;
+	}
+
+	pcre *re = pcre_compile2(pattern, iFlags, errorCode, error, errorOffset, nullptr);
+	if (re == nullptr)
+		return nullptr;
+
+	// Study failures only cost us the optimization, so they are not errors.
+	const char *studyError;
+	pcre_extra *extra = pcre_study(re, PCRE_STUDY_JIT_COMPILE, &studyError);
+	if (extra)
+	{
+		// The default JIT stack is 32K of machine stack; give deep patterns room
+		// to recurse instead of failing with PCRE_ERROR_JIT_STACKLIMIT.
+		if (!mJitStack)
+			mJitStack = pcre_jit_stack_alloc(32 * 1024, 512 * 1024);
+		pcre_assign_jit_stack(extra, nullptr, mJitStack);
+	}
+
+	ke::RefPtr<CompiledPattern> compiled = new CompiledPattern(re, extra);
+
+	mLru.emplace_front(key, compiled);
+	mIndex.emplace(std::move(key), mLru.begin());
+
+	if (mLru.size() > REGEX_CACHE_SIZE)
+	{
+		mIndex.erase(mLru.back().first);
+		mLru.pop_back();
+	}
+
+	return compiled;
+}
+
+void RegexCache::Clear()
+{
+	mIndex.clear();
+	mLru.clear();
+}
+
+int RegexSet::Add(const char *pattern, int iFlags, int *errorCode, const char **error, int *errorOffset)
+{
+	ke::RefPtr<CompiledPattern> compiled = g_RegexCache.Compile(pattern, iFlags, errorCode, error, errorOffset);
+	if (!compiled)
+		return -1;
+
+	mPatterns.push_back(compiled);
+	return static_cast<int>(mPatterns.size() - 1);
+}
+
+int RegexSet::Match(const char *str, int *matches, size_t maxMatches)
+{
+	int len = static_cast<int>(strlen(str));
+	int found = 0;
+
+	for (size_t i = 0; i < mPatterns.size(); i++)
+	{
+		// No ovector: only whether it matched is wanted, which lets PCRE skip
+		// capture bookkeeping.
+		int rc = pcre_exec(mPatterns[i]->re, mPatterns[i]->extra, str, len, 0, 0, nullptr, 0);
+		if (rc == PCRE_ERROR_NOMATCH)
+			continue;
+		if (rc < 0)
+			return rc;
+
+		if (static_cast<size_t>(found) < maxMatches)
+			matches[found] = static_cast<int>(i);
+		found++;
+	}
+
+	return found;
+}
+
+size_t RegexSet::Length() const
+{
+	return mPatterns.size();
+}
+
 RegEx::RegEx()
 {
 	mErrorOffset = 0;
 	mErrorCode = 0;
 	mError = nullptr;
-	re = nullptr;
 	mFree = true;
 	subject = nullptr;
 	mMatchCount = 0;
@@ -51,9 +164,7 @@ void RegEx::Clear ()
 	mErrorOffset = 0;
 	mErrorCode = 0;
 	mError = nullptr;
-	if (re)
-		pcre_free(re);
-	re = nullptr;
+	mPattern = nullptr;
 	mFree = true;
 	if (subject)
 		free(subject);
@@ -82,9 +193,9 @@ int RegEx::Compile(const char *pattern, int iFlags)
 	if (!mFree)
 		Clear();
 		
-	re = pcre_compile2(pattern, iFlags, &mErrorCode, &mError, &mErrorOffset, nullptr);
+	mPattern = g_RegexCache.Compile(pattern, iFlags, &mErrorCode, &mError, &mErrorOffset);
 
-	if (re == nullptr)
+	if (!mPattern)
 	{
 		return 0;
 	}
@@ -98,7 +209,7 @@ int RegEx::Match(const char *const str, const size_t offset)
 {
 	int rc = 0;
 
-	if (mFree || re == nullptr)
+	if (mFree || !mPattern)
 		return -1;
 		
 	this->ClearMatch();
@@ -106,7 +217,7 @@ int RegEx::Match(const char *const str, const size_t offset)
 	//save str
 	subject = strdup(str);
 
-	rc = pcre_exec(re, nullptr, subject, strlen(subject), offset, 0, mMatches[0].mVector, MAX_CAPTURES);
+	rc = pcre_exec(mPattern->re, mPattern->extra, subject, strlen(subject), offset, 0, mMatches[0].mVector, MAX_CAPTURES);
 
 	if (rc < 0)
 	{
@@ -129,7 +240,7 @@ int RegEx::MatchAll(const char *str)
 {
 	int rc = 0;
 
-	if (mFree || re == nullptr)
+	if (mFree || !mPattern)
 		return -1;
 
 	this->ClearMatch();
@@ -141,7 +252,7 @@ int RegEx::MatchAll(const char *str)
 	size_t offset = 0;
 	unsigned int matches = 0;
 
-	while (matches < MAX_MATCHES && offset < len && (rc = pcre_exec(re, 0, subject, len, offset, 0, mMatches[matches].mVector, MAX_CAPTURES)) >= 0)
+	while (matches < MAX_MATCHES && offset < len && (rc = pcre_exec(mPattern->re, mPattern->extra, subject, len, offset, 0, mMatches[matches].mVector, MAX_CAPTURES)) >= 0)
 	{
 		offset = mMatches[matches].mVector[1];
 		mMatches[matches].mSubStringCount = rc;
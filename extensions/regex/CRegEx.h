@@ -29,6 +29,11 @@
  * Version: $Id$
  */
 #include <am-string.h>
+#include <am-refcounting.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #ifndef _INCLUDE_CREGEX_H
 #define _INCLUDE_CREGEX_H
@@ -36,6 +41,49 @@
 #define MAX_MATCHES 20
 #define MAX_CAPTURES MAX_MATCHES*3
 
+#define REGEX_CACHE_SIZE 64
+
+/**
+ * A compiled and studied pattern.  Patterns are immutable once compiled, so one
+ * can be shared by every RegEx created from the same pattern and flags.
+ */
+class CompiledPattern : public ke::Refcounted<CompiledPattern>
+{
+public:
+	CompiledPattern(pcre *re, pcre_extra *extra);
+	~CompiledPattern();
+public:
+	pcre *re;
+	pcre_extra *extra;
+};
+
+/**
+ * Process-wide LRU cache of compiled patterns, keyed on pattern and flags.
+ */
+class RegexCache
+{
+public:
+	RegexCache();
+	~RegexCache();
+public:
+	/**
+	 * Returns the compiled pattern, compiling and caching it on a miss.  On a
+	 * compile error, returns null and fills in the error fields.
+	 */
+	ke::RefPtr<CompiledPattern> Compile(const char *pattern, int iFlags,
+		int *errorCode, const char **error, int *errorOffset);
+	void Clear();
+private:
+	typedef std::pair<std::string, ke::RefPtr<CompiledPattern>> Entry;
+	typedef std::list<Entry> EntryList;
+
+	EntryList mLru;
+	std::unordered_map<std::string, EntryList::iterator> mIndex;
+	pcre_jit_stack *mJitStack;
+};
+
+extern RegexCache g_RegexCache;
+
 struct RegexMatch
 {
 	int mSubStringCount;
@@ -62,10 +110,34 @@ public:
 	int mMatchCount;
 	RegexMatch mMatches[MAX_MATCHES];
 private:
-	pcre *re;
+	ke::RefPtr<CompiledPattern> mPattern;
 	bool mFree;
 	char *subject;
 };
 
+/**
+ * A list of patterns that one subject is tested against in a single call.
+ */
+class RegexSet
+{
+public:
+	/**
+	 * Compiles and appends a pattern.  Returns its index, or -1 and fills in
+	 * the error fields on a compile error.
+	 */
+	int Add(const char *pattern, int iFlags, int *errorCode, const char **error, int *errorOffset);
+
+	/**
+	 * Tests str against every pattern, writing the indices of up to maxMatches
+	 * matching patterns.  Returns the total number of matching patterns, or a
+	 * PCRE error code (< 0) if a pattern failed to execute.
+	 */
+	int Match(const char *str, int *matches, size_t maxMatches);
+
+	size_t Length() const;
+private:
+	std::vector<ke::RefPtr<CompiledPattern>> mPatterns;
+};
+
 #endif //_INCLUDE_CREGEX_H
 
@@ -48,6 +48,7 @@ SMEXT_LINK(&g_RegexExtension);
 
 RegexHandler g_RegexHandler;
 HandleType_t g_RegexHandle=0;
+HandleType_t g_RegexSetHandle=0;
 
 
 
@@ -55,12 +56,15 @@ bool RegexExtension::SDK_OnLoad(char *error, size_t err_max, bool late)
 {
 	g_pShareSys->AddNatives(myself,regex_natives);
 	g_RegexHandle = g_pHandleSys->CreateType("Regex", &g_RegexHandler, 0, NULL, NULL, myself->GetIdentity(), NULL);
+	g_RegexSetHandle = g_pHandleSys->CreateType("RegexSet", &g_RegexHandler, 0, NULL, NULL, myself->GetIdentity(), NULL);
 	return true;
 }
 
 void RegexExtension::SDK_OnUnload()
 {
+	g_pHandleSys->RemoveType(g_RegexSetHandle, myself->GetIdentity());
 	g_pHandleSys->RemoveType(g_RegexHandle, myself->GetIdentity());
+	g_RegexCache.Clear();
 
 }
 
@@ -326,8 +330,169 @@ static cell_t GetRegexOffset(IPluginContext *pCtx, const cell_t *params)
 	return x->mMatches[params[2]].mVector[1];
 }
 
+static cell_t GetRegexCaptureOffsets(IPluginContext *pCtx, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError err;
+	HandleSecurity sec;
+	sec.pOwner = NULL;
+	sec.pIdentity = myself->GetIdentity();
+
+	RegEx *x;
+
+	if ((err = g_pHandleSys->ReadHandle(hndl, g_RegexHandle, &sec, (void **)&x)) != HandleError_None)
+	{
+		return pCtx->ThrowNativeError("Invalid regex handle %x (error %d)", hndl, err);
+	}
+
+	if (!x)
+	{
+		return pCtx->ThrowNativeError("Regex data not found\n");
+	}
+
+	int first = params[4];
+	int last = params[4];
+	if (first == -1)
+	{
+		first = 0;
+		last = x->mMatchCount - 1;
+	}
+	else if (first >= x->mMatchCount || first < 0)
+	{
+		return pCtx->ThrowNativeError("Invalid match index passed.\n");
+	}
+
+	cell_t *offsets;
+	pCtx->LocalToPhysAddr(params[2], &offsets);
+	cell_t maxlen = params[3];
+
+	/* Copy out whole (start, end) pairs only, so a plugin can always pair them up. */
+	cell_t written = 0;
+	for (int match = first; match <= last; match++)
+	{
+		const RegexMatch &m = x->mMatches[match];
+		for (int s = 0; s < m.mSubStringCount; s++)
+		{
+			if (written * 2 + 2 > maxlen)
+				return written;
+
+			offsets[written * 2] = m.mVector[2 * s];
+			offsets[written * 2 + 1] = m.mVector[2 * s + 1];
+			written++;
+		}
+	}
+
+	return written;
+}
+
+static cell_t CreateRegexSet(IPluginContext *pCtx, const cell_t *params)
+{
+	RegexSet *set = new RegexSet();
+
+	HandleError error = HandleError_None;
+	Handle_t hndl = g_pHandleSys->CreateHandle(g_RegexSetHandle, set, pCtx->GetIdentity(), myself->GetIdentity(), &error);
+	if (!hndl || error != HandleError_None)
+	{
+		delete set;
+		pCtx->ReportError("Allocation of regex set handle failed, error code #%d", error);
+		return 0;
+	}
+
+	return hndl;
+}
+
+static cell_t RegexSetAdd(IPluginContext *pCtx, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError err;
+	HandleSecurity sec;
+	sec.pOwner = NULL;
+	sec.pIdentity = myself->GetIdentity();
+
+	RegexSet *set;
+
+	if ((err = g_pHandleSys->ReadHandle(hndl, g_RegexSetHandle, &sec, (void **)&set)) != HandleError_None)
+	{
+		return pCtx->ThrowNativeError("Invalid regex set handle %x (error %d)", hndl, err);
+	}
+
+	char *regex;
+	pCtx->LocalToString(params[2], &regex);
+
+	int errorCode = 0, errorOffset = 0;
+	const char *error = nullptr;
+	int index = set->Add(regex, params[3], &errorCode, &error, &errorOffset);
+	if (index == -1)
+	{
+		cell_t *eError;
+		pCtx->LocalToPhysAddr(params[6], &eError);
+		*eError = pcre_posix_compile_error_map[errorCode];
+		pCtx->StringToLocal(params[4], params[5], error ? error : "unknown");
+	}
+
+	return index;
+}
+
+static cell_t RegexSetMatch(IPluginContext *pCtx, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError err;
+	HandleSecurity sec;
+	sec.pOwner = NULL;
+	sec.pIdentity = myself->GetIdentity();
+
+	RegexSet *set;
+
+	if ((err = g_pHandleSys->ReadHandle(hndl, g_RegexSetHandle, &sec, (void **)&set)) != HandleError_None)
+	{
+		return pCtx->ThrowNativeError("Invalid regex set handle %x (error %d)", hndl, err);
+	}
+
+	char *str;
+	pCtx->LocalToString(params[2], &str);
+
+	cell_t *matches;
+	pCtx->LocalToPhysAddr(params[3], &matches);
+	size_t maxMatches = params[4] > 0 ? static_cast<size_t>(params[4]) : 0;
+
+	int rc = set->Match(str, matches, maxMatches);
+	if (rc < 0)
+	{
+		cell_t *res;
+		pCtx->LocalToPhysAddr(params[5], &res);
+		*res = rc;
+		return -1;
+	}
+
+	return rc;
+}
+
+static cell_t GetRegexSetLength(IPluginContext *pCtx, const cell_t *params)
+{
+	Handle_t hndl = static_cast<Handle_t>(params[1]);
+	HandleError err;
+	HandleSecurity sec;
+	sec.pOwner = NULL;
+	sec.pIdentity = myself->GetIdentity();
+
+	RegexSet *set;
+
+	if ((err = g_pHandleSys->ReadHandle(hndl, g_RegexSetHandle, &sec, (void **)&set)) != HandleError_None)
+	{
+		return pCtx->ThrowNativeError("Invalid regex set handle %x (error %d)", hndl, err);
+	}
+
+	return static_cast<cell_t>(set->Length());
+}
+
 void RegexHandler::OnHandleDestroy(HandleType_t type, void *object)
 {
+	if (type == g_RegexSetHandle)
+	{
+		delete (RegexSet *)object;
+		return;
+	}
+
 	RegEx *x = (RegEx *)object;
 
 	x->Clear();
@@ -348,5 +513,11 @@ const sp_nativeinfo_t regex_natives[] =
 	{"Regex.MatchCount",		GetRegexMatchCount},
 	{"Regex.CaptureCount",		GetRegexCaptureCount},
 	{"Regex.MatchOffset",			GetRegexOffset},
+	{"Regex.GetCaptureOffsets",	GetRegexCaptureOffsets},
+
+	{"RegexSet.RegexSet",		CreateRegexSet},
+	{"RegexSet.Add",			RegexSetAdd},
+	{"RegexSet.Match",			RegexSetMatch},
+	{"RegexSet.Length.get",		GetRegexSetLength},
 	{NULL,							NULL},
 };
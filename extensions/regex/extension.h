@@ -128,6 +128,7 @@ public:
 
 extern RegexHandler g_RegexHandler;
 extern HandleType_t g_RegexHandle;
+extern HandleType_t g_RegexSetHandle;
 
 
 // Natives
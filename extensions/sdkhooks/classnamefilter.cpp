@@ -0,0 +1,174 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * Source SDK Hooks Extension
+ * Copyright (C) 2010-2012 Nicholas Hastings
+ * Copyright (C) 2009-2010 Erik Minekus
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#include "classnamefilter.h"
+#include <string.h>
+
+ClassnameFilters::ClassnameFilters() : m_Root('\0'), m_Count(0)
+{
+}
+
+ClassnameFilters::Node *ClassnameFilters::FindChild(const Node *node, char c) const
+{
+	for (size_t i = 0; i < node->children.size(); i++)
+	{
+		if (node->children[i]->ch == c)
+		{
+			return node->children[i].get();
+		}
+	}
+
+	return NULL;
+}
+
+std::vector<IPluginFunction *> *ClassnameFilters::FindList(const char *pattern, bool create)
+{
+	size_t length = strlen(pattern);
+	bool isPrefix = (length > 0 && pattern[length - 1] == '*');
+	if (isPrefix)
+	{
+		length--;
+	}
+
+	Node *node = &m_Root;
+	for (size_t i = 0; i < length; i++)
+	{
+		Node *child = FindChild(node, pattern[i]);
+		if (child == NULL)
+		{
+			if (!create)
+			{
+				return NULL;
+			}
+
+			child = new Node(pattern[i]);
+			node->children.emplace_back(child);
+		}
+		node = child;
+	}
+
+	return isPrefix ? &node->prefix : &node->exact;
+}
+
+bool ClassnameFilters::Add(const char *pattern, IPluginFunction *callback)
+{
+	std::vector<IPluginFunction *> *list = FindList(pattern, true);
+	for (size_t i = 0; i < list->size(); i++)
+	{
+		if ((*list)[i] == callback)
+		{
+			return false;
+		}
+	}
+
+	list->push_back(callback);
+	m_Count++;
+
+	return true;
+}
+
+bool ClassnameFilters::Remove(const char *pattern, IPluginFunction *callback)
+{
+	std::vector<IPluginFunction *> *list = FindList(pattern, false);
+	if (list == NULL)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < list->size(); i++)
+	{
+		if ((*list)[i] == callback)
+		{
+			list->erase(list->begin() + i);
+			m_Count--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ClassnameFilters::Remove(IPluginContext *pContext)
+{
+	Prune(&m_Root, pContext);
+}
+
+// Removes the context's callbacks beneath node; returns true if node is left empty
+bool ClassnameFilters::Prune(Node *node, IPluginContext *pContext)
+{
+	std::vector<IPluginFunction *> *lists[] = {&node->exact, &node->prefix};
+	for (size_t l = 0; l < 2; l++)
+	{
+		std::vector<IPluginFunction *> &list = *lists[l];
+		for (size_t i = 0; i < list.size(); i++)
+		{
+			if (pContext != NULL && pContext != list[i]->GetParentRuntime()->GetDefaultContext())
+			{
+				continue;
+			}
+
+			list.erase(list.begin() + i);
+			i--;
+			m_Count--;
+		}
+	}
+
+	for (size_t i = 0; i < node->children.size(); i++)
+	{
+		if (Prune(node->children[i].get(), pContext))
+		{
+			node->children.erase(node->children.begin() + i);
+			i--;
+		}
+	}
+
+	return node->exact.empty() && node->prefix.empty() && node->children.empty();
+}
+
+void ClassnameFilters::Collect(const char *classname, std::vector<IPluginFunction *> &callbacks) const
+{
+	const Node *node = &m_Root;
+	callbacks.insert(callbacks.end(), node->prefix.begin(), node->prefix.end());
+
+	for (const char *c = classname; *c != '\0'; c++)
+	{
+		node = FindChild(node, *c);
+		if (node == NULL)
+		{
+			return;
+		}
+
+		callbacks.insert(callbacks.end(), node->prefix.begin(), node->prefix.end());
+	}
+
+	callbacks.insert(callbacks.end(), node->exact.begin(), node->exact.end());
+}
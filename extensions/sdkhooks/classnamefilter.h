@@ -0,0 +1,79 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * Source SDK Hooks Extension
+ * Copyright (C) 2010-2012 Nicholas Hastings
+ * Copyright (C) 2009-2010 Erik Minekus
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_SDKHOOKS_CLASSNAMEFILTER_H_
+#define _INCLUDE_SDKHOOKS_CLASSNAMEFILTER_H_
+
+#include <sp_vm_api.h>
+#include <memory>
+#include <vector>
+
+using namespace SourcePawn;
+
+/**
+ * Plugin callbacks keyed by classname pattern, stored in a character trie so
+ * that finding the listeners for a classname costs one walk over its
+ * characters. A pattern ending in '*' matches every classname with that
+ * prefix; any other pattern must match exactly.
+ */
+class ClassnameFilters
+{
+public:
+	ClassnameFilters();
+public:
+	bool Add(const char *pattern, IPluginFunction *callback);
+	bool Remove(const char *pattern, IPluginFunction *callback);
+	void Remove(IPluginContext *pContext);
+	void Collect(const char *classname, std::vector<IPluginFunction *> &callbacks) const;
+	inline bool empty() const { return m_Count == 0; }
+private:
+	struct Node
+	{
+		Node(char c) : ch(c)
+		{
+		}
+
+		char ch;
+		std::vector<std::unique_ptr<Node>> children;
+		std::vector<IPluginFunction *> exact;
+		std::vector<IPluginFunction *> prefix;
+	};
+private:
+	Node *FindChild(const Node *node, char c) const;
+	std::vector<IPluginFunction *> *FindList(const char *pattern, bool create);
+	bool Prune(Node *node, IPluginContext *pContext);
+private:
+	Node m_Root;
+	size_t m_Count;
+};
+
+#endif // _INCLUDE_SDKHOOKS_CLASSNAMEFILTER_H_
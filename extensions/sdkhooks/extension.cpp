@@ -35,9 +35,11 @@
 #include "compat_wrappers.h"
 #include "macros.h"
 #include "natives.h"
+#include "hookstats.h"
 #include <sm_platform.h>
 #include <const.h>
 #include <IBinTools.h>
+#include <chrono>
 
 //#define SDKHOOKSDEBUG
 
@@ -95,6 +97,11 @@ HookTypeData g_HookTypes[SDKHook_MAXHOOKS] =
 
 	// There is no DT for CBaseMultiplayerPlayer. Going up a level
 	{"CanBeAutobalanced",     "DT_BasePlayer",          false},
+
+	{"OnTakeDamageInfo",      "",                       false},
+	{"OnTakeDamageInfoPost",  "",                       false},
+	{"OnTakeDamageAliveInfo", "DT_BaseCombatCharacter", false},
+	{"OnTakeDamageAliveInfoPost", "DT_BaseCombatCharacter", false},
 };
 
 SDKHooks g_Interface;
@@ -102,6 +109,7 @@ SMEXT_LINK(&g_Interface);
 
 CGlobalVars *gpGlobals;
 std::vector<CVTableList *> g_HookList[SDKHook_MAXHOOKS];
+EntityHookList *g_EntityHooks[NUM_ENT_ENTRIES];
 
 IBinTools *g_pBinTools = NULL;
 ICvar *icvar = NULL;
@@ -226,6 +234,8 @@ bool SDKHooks::SDK_OnLoad(char *error, size_t maxlength, bool late)
 	}
 
 	memset(m_EntityCache, INVALID_EHANDLE_INDEX, sizeof(m_EntityCache));
+	memset(m_EntityClassnameSet, 0, sizeof(m_EntityClassnameSet));
+	m_ClassnameIndex.clear();
 
 	CUtlVector<IEntityListener *> *entListeners = EntListeners();
 	if (!entListeners)
@@ -254,6 +264,8 @@ bool SDKHooks::SDK_OnLoad(char *error, size_t maxlength, bool late)
 	
 	plsys->AddPluginsListener(&g_Interface);
 
+	rootconsole->AddRootConsoleCommand3("sdkhooks", "SDKHooks dispatch statistics", this);
+
 	g_pOnEntityCreated = forwards->CreateForward("OnEntityCreated", ET_Ignore, 2, NULL, Param_Cell, Param_String);
 	g_pOnEntityDestroyed = forwards->CreateForward("OnEntityDestroyed", ET_Ignore, 1, NULL, Param_Cell);
 #ifdef GAMEDESC_CAN_CHANGE
@@ -276,6 +288,7 @@ bool SDKHooks::SDK_OnLoad(char *error, size_t maxlength, bool late)
 		if (IsEntityIndexInRange(index))
 		{
 			m_EntityCache[index] = gamehelpers->IndexToReference(index);
+			IndexEntityClassname(index, gamehelpers->GetEntityClassname((CBaseEntity *)pEnt));
 		}
 		else
 		{
@@ -285,8 +298,12 @@ bool SDKHooks::SDK_OnLoad(char *error, size_t maxlength, bool late)
 #else
 	for (int i = 0; i < NUM_ENT_ENTRIES; i++)
 	{
-		if (gamehelpers->ReferenceToEntity(i) != NULL)
+		CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(i);
+		if (pEntity != NULL)
+		{
 			m_EntityCache[i] = gamehelpers->IndexToReference(i);
+			IndexEntityClassname(i, gamehelpers->GetEntityClassname(pEntity));
+		}
 	}
 #endif
 
@@ -353,6 +370,7 @@ void SDKHooks::SDK_OnUnload()
 {
 	// Remove left over hooks
 	Unhook(reinterpret_cast<SourcePawn::IPluginContext *>(NULL));
+	m_EntityCreatedFilters.Remove(reinterpret_cast<SourcePawn::IPluginContext *>(NULL));
 
 	KILL_HOOK_IF_ACTIVE(g_hookOnLevelInit);
 
@@ -368,6 +386,8 @@ void SDKHooks::SDK_OnUnload()
 	forwards->ReleaseForward(g_pOnLevelInit);
 
 	plsys->RemovePluginsListener(&g_Interface);
+
+	rootconsole->RemoveRootConsoleCommand("sdkhooks", this);
 	
 	SH_REMOVE_HOOK(IServerGameDLL, LevelShutdown, gamedll, SH_MEMBER(this, &SDKHooks::LevelShutdown), true);
 	
@@ -424,6 +444,8 @@ void SDKHooks::OnPluginLoaded(IPlugin *plugin)
 void SDKHooks::OnPluginUnloaded(IPlugin *plugin)
 {
 	Unhook(plugin->GetBaseContext());
+	g_HookStats.RemovePlugin(plugin->GetBaseContext());
+	m_EntityCreatedFilters.Remove(plugin->GetBaseContext());
 
 	if (g_pOnLevelInit->GetFunctionCount() == 0)
 	{
@@ -436,6 +458,40 @@ void SDKHooks::OnPluginUnloaded(IPlugin *plugin)
 #endif
 }
 
+void SDKHooks::OnRootConsoleCommand(const char *cmdname, const ICommandArgs *args)
+{
+	if (args->ArgC() >= 3 && strcmp(args->Arg(2), "stats") == 0)
+	{
+		const char *action = args->ArgC() >= 4 ? args->Arg(3) : "";
+		if (strcmp(action, "start") == 0)
+		{
+			g_HookStats.Start();
+			rootconsole->ConsolePrint("[SM] SDKHooks dispatch stats are now being recorded.");
+		}
+		else if (strcmp(action, "stop") == 0)
+		{
+			g_HookStats.Stop();
+			rootconsole->ConsolePrint("[SM] SDKHooks dispatch stats are no longer being recorded.");
+		}
+		else if (strcmp(action, "reset") == 0)
+		{
+			g_HookStats.Reset();
+			rootconsole->ConsolePrint("[SM] SDKHooks dispatch stats have been reset.");
+		}
+		else
+		{
+			g_HookStats.Print();
+		}
+		return;
+	}
+
+	rootconsole->ConsolePrint("SourceMod SDKHooks Menu:");
+	rootconsole->DrawGenericOption("stats", "Show hook callback counts and times");
+	rootconsole->DrawGenericOption("stats start", "Start recording hook callback stats");
+	rootconsole->DrawGenericOption("stats stop", "Stop recording hook callback stats");
+	rootconsole->DrawGenericOption("stats reset", "Clear recorded hook callback stats");
+}
+
 void SDKHooks::OnClientPutInServer(int client)
 {
 	CBaseEntity *pPlayer = gamehelpers->ReferenceToEntity(client);
@@ -448,19 +504,23 @@ void SDKHooks::OnClientDisconnecting(int client)
 	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(client);
 	
 	HandleEntityDeleted(pEntity);
+	ClearTransmitClient(client);
 }
 
 void SDKHooks::LevelShutdown()
 {
 #if defined PLATFORM_LINUX
+	for (int index = 0; index < NUM_ENT_ENTRIES; ++index)
+	{
+		delete g_EntityHooks[index];
+		g_EntityHooks[index] = NULL;
+	}
+
 	for (size_t type = 0; type < SDKHook_MAXHOOKS; ++type)
 	{
 		std::vector<CVTableList *> &vtablehooklist = g_HookList[type];
 		for (size_t listentry = 0; listentry < vtablehooklist.size(); ++listentry)
 		{
-			std::vector<HookList> &pawnhooks = vtablehooklist[listentry]->hooks;
-			pawnhooks.clear();
-			
 			delete vtablehooklist[listentry];
 		}
 		vtablehooklist.clear();
@@ -493,20 +553,159 @@ FeatureStatus SDKHooks::GetFeatureStatus(FeatureType type, const char *name)
  * Functions
  */
 
-static void PopulateCallbackList(const std::vector<HookList> &source, std::vector<IPluginFunction *> &destination, int entity)
+static EntityHookList *GetEntityHookList(CBaseEntity *pEnt)
+{
+	cell_t ref = gamehelpers->EntityToReference(pEnt);
+	int index = gamehelpers->ReferenceToIndex(ref);
+	if (index < 0 || index >= NUM_ENT_ENTRIES)
+	{
+		return NULL;
+	}
+
+	EntityHookList *list = g_EntityHooks[index];
+	if (list == NULL || list->entity != ref)
+	{
+		return NULL;
+	}
+
+	return list;
+}
+
+static bool PopulateCallbackList(CBaseEntity *pEnt, SDKHookType type, std::vector<IPluginFunction *> &destination)
+{
+	// Callbacks are copied out since a callback may unhook itself (or others) while we dispatch
+	EntityHookList *list = GetEntityHookList(pEnt);
+	if (list == NULL || list->hooks[type].empty())
+	{
+		return false;
+	}
+
+	destination = list->hooks[type];
+	return true;
+}
+
+// Drops callbacks from a vtable's reference count, removing the vtable hook once unused
+static void ReleaseVTableHooks(size_t type, CVTableList *vtablelist, size_t count)
+{
+	vtablelist->hookcount -= count;
+
+#if !defined PLATFORM_LINUX
+	if (vtablelist->hookcount == 0)
+	{
+		std::vector<CVTableList *> &vtablehooklist = g_HookList[type];
+		for (size_t listentry = 0; listentry < vtablehooklist.size(); ++listentry)
+		{
+			if (vtablehooklist[listentry] == vtablelist)
+			{
+				vtablehooklist.erase(vtablehooklist.begin() + listentry);
+				break;
+			}
+		}
+
+		delete vtablelist;
+	}
+#endif
+}
+
+// Removes the callbacks of one hook type matching the filter, or all of them
+template <typename Filter>
+static void RemoveEntityHooks(EntityHookList *list, size_t type, Filter filter)
 {
-	destination.reserve(8);
-	for (size_t iter = 0; iter < source.size(); ++iter)
+	std::vector<IPluginFunction *> &hooks = list->hooks[type];
+	size_t removed = 0;
+	for (size_t entry = 0; entry < hooks.size(); ++entry)
 	{
-		if (source[iter].entity != entity)
+		if (!filter(hooks[entry]))
 		{
 			continue;
 		}
 
-		destination.push_back(source[iter].callback);
+		hooks.erase(hooks.begin() + entry);
+		entry--;
+		removed++;
+	}
+
+	if (removed == 0)
+	{
+		return;
+	}
+
+	ReleaseVTableHooks(type, list->vtables[type], removed);
+	if (hooks.empty() && (type != SDKHook_SetTransmit || list->transmit.mode == SDKTransmit_Default))
+	{
+		list->vtables[type] = NULL;
 	}
 }
 
+static void FreeEntityHookListIfEmpty(int index)
+{
+	EntityHookList *list = g_EntityHooks[index];
+	for (size_t type = 0; type < SDKHook_MAXHOOKS; ++type)
+	{
+		if (!list->hooks[type].empty())
+		{
+			return;
+		}
+	}
+
+	if (list->transmit.mode != SDKTransmit_Default)
+	{
+		return;
+	}
+
+	delete list;
+	g_EntityHooks[index] = NULL;
+}
+
+static void ClearTransmitMask(EntityHookList *list)
+{
+	if (list->transmit.mode == SDKTransmit_Default)
+	{
+		return;
+	}
+
+	list->transmit = TransmitMask();
+
+	ReleaseVTableHooks(SDKHook_SetTransmit, list->vtables[SDKHook_SetTransmit], 1);
+	if (list->hooks[SDKHook_SetTransmit].empty())
+	{
+		list->vtables[SDKHook_SetTransmit] = NULL;
+	}
+}
+
+static bool MatchAnyHook(IPluginFunction *)
+{
+	return true;
+}
+
+/**
+ * Runs a hook callback, timing it when dispatch stats are being recorded and
+ * wrapping it in a profiler scope when "sm prof" is running. Both are off by
+ * default, which leaves a flag test and one call into core.
+ */
+static inline void ExecuteHookCallback(IPluginFunction *callback, SDKHookType type, cell_t *result)
+{
+	bool profiled = g_pSM->IsProfilingActive();
+	if (!profiled && !g_HookStats.IsEnabled())
+	{
+		callback->Execute(result);
+		return;
+	}
+
+	if (profiled)
+		g_pSM->EnterProfileScope("sdkhooks", g_HookTypes[type].name);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	callback->Execute(result);
+	std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+
+	if (profiled)
+		g_pSM->LeaveProfileScope();
+
+	if (g_HookStats.IsEnabled())
+		g_HookStats.Record(type, callback, elapsed.count());
+}
+
 cell_t SDKHooks::Call(int entity, SDKHookType type, int other)
 {
 	return Call(gamehelpers->ReferenceToEntity(entity), type, gamehelpers->ReferenceToEntity(other));
@@ -521,35 +720,25 @@ cell_t SDKHooks::Call(CBaseEntity *pEnt, SDKHookType type, CBaseEntity *pOther)
 {
 	cell_t ret = Pl_Continue;
 
-	CVTableHook vhook(pEnt);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[type];
-	for (size_t entry = 0; entry < vtablehooklist.size(); ++entry)
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pEnt, type, callbackList))
 	{
-		if (vhook != vtablehooklist[entry]->vtablehook)
-		{
-			continue;
-		}
-
 		int entity = gamehelpers->EntityToBCompatRef(pEnt);
 		int other = gamehelpers->EntityToBCompatRef(pOther);
 
-		std::vector<IPluginFunction *> callbackList;
-		PopulateCallbackList(vtablehooklist[entry]->hooks, callbackList, entity);
-		for (entry = 0; entry < callbackList.size(); ++entry)
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
 		{
 			IPluginFunction *callback = callbackList[entry];
 			callback->PushCell(entity);
 			callback->PushCell(other);
 
 			cell_t res;
-			callback->Execute(&res);
+			ExecuteHookCallback(callback, type, &res);
 			if(res > ret)
 			{
 				ret = res;
 			}
 		}
-
-		break;
 	}
 
 	return ret;
@@ -587,6 +776,12 @@ void SDKHooks::SetupHooks()
 	CHECKOFFSET(Blocked,          true,  true);
 	CHECKOFFSET(CanBeAutobalanced, true, false);
 
+	// the *Info variants only differ in how damage info is passed to plugins
+	g_HookTypes[SDKHook_OnTakeDamageInfo].supported = g_HookTypes[SDKHook_OnTakeDamage].supported;
+	g_HookTypes[SDKHook_OnTakeDamageInfoPost].supported = g_HookTypes[SDKHook_OnTakeDamagePost].supported;
+	g_HookTypes[SDKHook_OnTakeDamageAliveInfo].supported = g_HookTypes[SDKHook_OnTakeDamage_Alive].supported;
+	g_HookTypes[SDKHook_OnTakeDamageAliveInfoPost].supported = g_HookTypes[SDKHook_OnTakeDamage_AlivePost].supported;
+
 	// this one is in a class all its own -_-
 	offset = 0;
 	g_pGameConf->GetOffset("GroundEntChanged", &offset);
@@ -626,6 +821,44 @@ HookReturn SDKHooks::Hook(int entity, SDKHookType type, IPluginFunction *callbac
 		}
 	}
 
+	EntityHookList *list = AcquireEntityHookList(pEnt);
+	if (list == NULL)
+		return HookRet_InvalidEntity;
+
+	// Add hook to the entity's hook list
+	CVTableList *vtablelist = HookVTable(pEnt, type);
+	list->vtables[type] = vtablelist;
+	list->hooks[type].push_back(callback);
+	vtablelist->hookcount++;
+
+	return HookRet_Successful;
+}
+
+EntityHookList *SDKHooks::AcquireEntityHookList(CBaseEntity *pEnt)
+{
+	cell_t ref = gamehelpers->EntityToReference(pEnt);
+	int index = gamehelpers->ReferenceToIndex(ref);
+	if (!IsEntityIndexInRange(index))
+	{
+		return NULL;
+	}
+
+	// A list left behind by an entity we never saw deleted belongs to a previous occupant
+	if (g_EntityHooks[index] != NULL && g_EntityHooks[index]->entity != ref)
+	{
+		UnhookIndex(index);
+	}
+
+	if (g_EntityHooks[index] == NULL)
+	{
+		g_EntityHooks[index] = new EntityHookList(ref);
+	}
+
+	return g_EntityHooks[index];
+}
+
+CVTableList *SDKHooks::HookVTable(CBaseEntity *pEnt, SDKHookType type)
+{
 	size_t entry;
 	CVTableHook vhook(pEnt);
 	std::vector<CVTableList *> &vtablehooklist = g_HookList[type];
@@ -671,6 +904,18 @@ HookReturn SDKHooks::Hook(int entity, SDKHookType type, IPluginFunction *callbac
 			case SDKHook_OnTakeDamage_AlivePost:
 				hookid = SH_ADD_MANUALVPHOOK(OnTakeDamage_Alive, pEnt, SH_MEMBER(&g_Interface, &SDKHooks::Hook_OnTakeDamage_AlivePost), true);
 				break;
+			case SDKHook_OnTakeDamageInfo:
+				hookid = SH_ADD_MANUALVPHOOK(OnTakeDamage, pEnt, SH_MEMBER(&g_Interface, &SDKHooks::Hook_OnTakeDamageInfo), false);
+				break;
+			case SDKHook_OnTakeDamageInfoPost:
+				hookid = SH_ADD_MANUALVPHOOK(OnTakeDamage, pEnt, SH_MEMBER(&g_Interface, &SDKHooks::Hook_OnTakeDamageInfoPost), true);
+				break;
+			case SDKHook_OnTakeDamageAliveInfo:
+				hookid = SH_ADD_MANUALVPHOOK(OnTakeDamage_Alive, pEnt, SH_MEMBER(&g_Interface, &SDKHooks::Hook_OnTakeDamageAliveInfo), false);
+				break;
+			case SDKHook_OnTakeDamageAliveInfoPost:
+				hookid = SH_ADD_MANUALVPHOOK(OnTakeDamage_Alive, pEnt, SH_MEMBER(&g_Interface, &SDKHooks::Hook_OnTakeDamageAliveInfoPost), true);
+				break;
 			case SDKHook_PreThink:
 				hookid = SH_ADD_MANUALVPHOOK(PreThink, pEnt, SH_MEMBER(&g_Interface, &SDKHooks::Hook_PreThink), false);
 				break;
@@ -784,14 +1029,8 @@ HookReturn SDKHooks::Hook(int entity, SDKHookType type, IPluginFunction *callbac
 		vtablelist->vtablehook = new CVTableHook(vhook);
 		vtablehooklist.push_back(vtablelist);
 	}
-	
-	// Add hook to hook list
-	HookList hook;
-	hook.entity = gamehelpers->EntityToBCompatRef(pEnt);
-	hook.callback = callback;
-	vtablehooklist[entry]->hooks.push_back(hook);
 
-	return HookRet_Successful;
+	return vtablehooklist[entry];
 }
 
 void SDKHooks::Unhook(CBaseEntity *pEntity)
@@ -801,64 +1040,56 @@ void SDKHooks::Unhook(CBaseEntity *pEntity)
 		return;
 	}
 
-	int entity = gamehelpers->EntityToBCompatRef(pEntity);
-	for (size_t type = 0; type < SDKHook_MAXHOOKS; ++type)
+	int index = gamehelpers->ReferenceToIndex(gamehelpers->EntityToReference(pEntity));
+	if (index < 0 || index >= NUM_ENT_ENTRIES)
 	{
-		std::vector<CVTableList *> &vtablehooklist = g_HookList[type];
-		for (size_t listentry = 0; listentry < vtablehooklist.size(); ++listentry)
-		{
-			std::vector<HookList> &pawnhooks = vtablehooklist[listentry]->hooks;
-			for (size_t entry = 0; entry < pawnhooks.size(); ++entry)
-			{
-				if (entity != pawnhooks[entry].entity)
-				{
-					continue;
-				}
+		return;
+	}
 
-				pawnhooks.erase(pawnhooks.begin() + entry);
-				entry--;
-			}
+	UnhookIndex(index);
+}
 
-#if !defined PLATFORM_LINUX
-			if (pawnhooks.size() == 0)
-			{
-				delete vtablehooklist[listentry];
-				vtablehooklist.erase(vtablehooklist.begin() + listentry);
-				listentry--;
-			}
-#endif
-		}
+void SDKHooks::UnhookIndex(int index)
+{
+	EntityHookList *list = g_EntityHooks[index];
+	if (list == NULL)
+	{
+		return;
 	}
+
+	for (size_t type = 0; type < SDKHook_MAXHOOKS; ++type)
+	{
+		RemoveEntityHooks(list, type, MatchAnyHook);
+	}
+	ClearTransmitMask(list);
+
+	delete list;
+	g_EntityHooks[index] = NULL;
 }
 
 void SDKHooks::Unhook(IPluginContext *pContext)
 {
-	for (size_t type = 0; type < SDKHook_MAXHOOKS; ++type)
+	for (int index = 0; index < NUM_ENT_ENTRIES; ++index)
 	{
-		std::vector<CVTableList *> &vtablehooklist = g_HookList[type];
-		for (size_t listentry = 0; listentry < vtablehooklist.size(); ++listentry)
+		EntityHookList *list = g_EntityHooks[index];
+		if (list == NULL)
 		{
-			std::vector<HookList> &pawnhooks = vtablehooklist[listentry]->hooks;
-			for (size_t entry = 0; entry < pawnhooks.size(); ++entry)
-			{
-				if (pContext != NULL && pContext != pawnhooks[entry].callback->GetParentRuntime()->GetDefaultContext())
-				{
-					continue;
-				}
+			continue;
+		}
 
-				pawnhooks.erase(pawnhooks.begin() + entry);
-				entry--;
-			}
+		for (size_t type = 0; type < SDKHook_MAXHOOKS; ++type)
+		{
+			RemoveEntityHooks(list, type, [pContext](IPluginFunction *callback) {
+				return pContext == NULL || pContext == callback->GetParentRuntime()->GetDefaultContext();
+			});
+		}
 
-#if !defined PLATFORM_LINUX
-			if (pawnhooks.size() == 0)
-			{
-				delete vtablehooklist[listentry];
-				vtablehooklist.erase(vtablehooklist.begin() + listentry);
-				listentry--;
-			}
-#endif
+		if (pContext == NULL || pContext == list->transmit.owner)
+		{
+			ClearTransmitMask(list);
 		}
+
+		FreeEntityHookListIfEmpty(index);
 	}
 }
 
@@ -870,40 +1101,131 @@ void SDKHooks::Unhook(int entity, SDKHookType type, IPluginFunction *pCallback)
 		return;
 	}
 
-	CVTableHook vhook(pEntity);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[type];
-	for (size_t listentry = 0; listentry < vtablehooklist.size(); ++listentry)
+	EntityHookList *list = GetEntityHookList(pEntity);
+	if (list == NULL)
+	{
+		return;
+	}
+
+	RemoveEntityHooks(list, type, [pCallback](IPluginFunction *callback) {
+		return callback == pCallback;
+	});
+
+	FreeEntityHookListIfEmpty(gamehelpers->ReferenceToIndex(list->entity));
+}
+
+HookReturn SDKHooks::SetTransmitMask(int entity, SDKTransmitMode mode, uint32_t teams, IPluginContext *pContext)
+{
+	if (!g_HookTypes[SDKHook_SetTransmit].supported)
+		return HookRet_NotSupported;
+
+	CBaseEntity *pEnt = gamehelpers->ReferenceToEntity(entity);
+	if (!pEnt)
+		return HookRet_InvalidEntity;
+
+	if (mode == SDKTransmit_Default)
 	{
-		if (vhook != vtablehooklist[listentry]->vtablehook)
+		EntityHookList *list = GetEntityHookList(pEnt);
+		if (list != NULL)
 		{
-			continue;
+			ClearTransmitMask(list);
+			FreeEntityHookListIfEmpty(gamehelpers->ReferenceToIndex(list->entity));
 		}
 
-		entity = gamehelpers->EntityToBCompatRef(pEntity);
+		return HookRet_Successful;
+	}
+
+	EntityHookList *list = AcquireEntityHookList(pEnt);
+	if (list == NULL)
+		return HookRet_InvalidEntity;
+
+	// The mask holds one reference on the SetTransmit vtable hook while it is set
+	if (list->transmit.mode == SDKTransmit_Default)
+	{
+		CVTableList *vtablelist = HookVTable(pEnt, SDKHook_SetTransmit);
+		list->vtables[SDKHook_SetTransmit] = vtablelist;
+		vtablelist->hookcount++;
+	}
+
+	list->transmit.mode = mode;
+	list->transmit.teams = teams;
+	list->transmit.clients.reset();
+	list->transmit.owner = pContext;
+
+	return HookRet_Successful;
+}
 
-		std::vector<HookList> &pawnhooks = vtablehooklist[listentry]->hooks;
-		for (size_t entry = 0; entry < pawnhooks.size(); ++entry)
+HookReturn SDKHooks::SetTransmitClient(int entity, int client, bool transmit)
+{
+	CBaseEntity *pEnt = gamehelpers->ReferenceToEntity(entity);
+	if (!pEnt)
+		return HookRet_InvalidEntity;
+
+	EntityHookList *list = GetEntityHookList(pEnt);
+	if (list == NULL || list->transmit.mode != SDKTransmit_Clients)
+		return HookRet_BadEntForHookType;
+
+	list->transmit.clients.set(client, transmit);
+
+	return HookRet_Successful;
+}
+
+SDKTransmitMode SDKHooks::GetTransmitMask(int entity, uint32_t *teams)
+{
+	*teams = 0;
+
+	CBaseEntity *pEnt = gamehelpers->ReferenceToEntity(entity);
+	if (!pEnt)
+		return SDKTransmit_Default;
+
+	EntityHookList *list = GetEntityHookList(pEnt);
+	if (list == NULL)
+		return SDKTransmit_Default;
+
+	*teams = list->transmit.teams;
+	return list->transmit.mode;
+}
+
+bool SDKHooks::IsTransmitMasked(EntityHookList *list, int client)
+{
+	const TransmitMask &mask = list->transmit;
+	if (mask.mode == SDKTransmit_Default || mask.mode == SDKTransmit_Always)
+		return false;
+
+	// Never hide a client's own player entity from them
+	if (gamehelpers->ReferenceToIndex(list->entity) == client)
+		return false;
+
+	switch (mask.mode)
+	{
+		case SDKTransmit_Never:
+			return true;
+		case SDKTransmit_Teams:
 		{
-			HookList &hookentry = pawnhooks[entry];
-			if (entity != hookentry.entity || pCallback != hookentry.callback)
-			{
-				continue;
-			}
+			IGamePlayer *pPlayer = playerhelpers->GetGamePlayer(client);
+			IPlayerInfo *pInfo = pPlayer ? pPlayer->GetPlayerInfo() : NULL;
+			if (!pInfo)
+				return false;
 
-			pawnhooks.erase(pawnhooks.begin() + entry);
-			entry--;
+			int team = pInfo->GetTeamIndex();
+			return team < 0 || team >= 32 || !(mask.teams & (1u << team));
 		}
+		case SDKTransmit_Clients:
+			return client < 0 || client > SM_MAXPLAYERS || !mask.clients.test(client);
+		default:
+			return false;
+	}
+}
 
-#if !defined PLATFORM_LINUX
-		if (pawnhooks.size() == 0)
+void SDKHooks::ClearTransmitClient(int client)
+{
+	for (int index = 0; index < NUM_ENT_ENTRIES; ++index)
+	{
+		EntityHookList *list = g_EntityHooks[index];
+		if (list != NULL && list->transmit.mode == SDKTransmit_Clients)
 		{
-			delete vtablehooklist[listentry];
-			vtablehooklist.erase(vtablehooklist.begin() + listentry);
-			listentry--;
+			list->transmit.clients.reset(client);
 		}
-#endif
-
-		break;
 	}
 }
 
@@ -973,29 +1295,21 @@ bool SDKHooks::Hook_CanBeAutobalanced()
 {
 	CBaseEntity *pPlayer = META_IFACEPTR(CBaseEntity);
 
-	CVTableHook vhook(pPlayer);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[SDKHook_CanBeAutobalanced];
-	for (size_t entry = 0; entry < vtablehooklist.size(); ++entry)
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pPlayer, SDKHook_CanBeAutobalanced, callbackList))
 	{
-		if (vhook != vtablehooklist[entry]->vtablehook)
-		{
-			continue;
-		}
-
 		int entity = gamehelpers->EntityToBCompatRef(pPlayer);
 
 		bool origRet = SH_MCALL(pPlayer, CanBeAutobalanced)();
 		bool newRet = origRet;
 
-		std::vector<IPluginFunction *> callbackList;
-		PopulateCallbackList(vtablehooklist[entry]->hooks, callbackList, entity);
-		for (entry = 0; entry < callbackList.size(); ++entry)
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
 		{
 			cell_t res = origRet;
 			IPluginFunction *callback = callbackList[entry];
 			callback->PushCell(entity);
 			callback->PushCell(origRet);
-			callback->Execute(&res);
+			ExecuteHookCallback(callback, SDKHook_CanBeAutobalanced, &res);
 
 			// Only update our new ret if different from original
 			// (so if multiple plugins returning different answers,
@@ -1006,8 +1320,6 @@ bool SDKHooks::Hook_CanBeAutobalanced()
 
 		if (newRet != origRet)
 			RETURN_META_VALUE(MRES_SUPERCEDE, newRet);
-
-		break;
 	}
 
 	RETURN_META_VALUE(MRES_IGNORED, false);
@@ -1041,29 +1353,19 @@ void SDKHooks::Hook_FireBulletsPost(const FireBulletsInfo_t &info)
 	if(!pInfo)
 		RETURN_META(MRES_IGNORED);
 
-	CVTableHook vhook(pEntity);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[SDKHook_FireBulletsPost];
-	for (size_t entry = 0; entry < vtablehooklist.size(); ++entry)
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pEntity, SDKHook_FireBulletsPost, callbackList))
 	{
-		if (vhook != vtablehooklist[entry]->vtablehook)
-		{
-			continue;
-		}
-
 		const char *weapon = pInfo->GetWeaponName();
 
-		std::vector<IPluginFunction *> callbackList;
-		PopulateCallbackList(vtablehooklist[entry]->hooks, callbackList, entity);
-		for (entry = 0; entry < callbackList.size(); ++entry)
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
 		{
 			IPluginFunction *callback = callbackList[entry];
 			callback->PushCell(entity);
 			callback->PushCell(info.m_iShots);
 			callback->PushString(weapon?weapon:"");
-			callback->Execute(NULL);
+			ExecuteHookCallback(callback, SDKHook_FireBulletsPost, NULL);
 		}
-
-		break;
 	}
 
 	RETURN_META(MRES_IGNORED);
@@ -1075,31 +1377,23 @@ int SDKHooks::Hook_GetMaxHealth()
 	CBaseEntity *pEntity = META_IFACEPTR(CBaseEntity);
 	int original_max = SH_MCALL(pEntity, GetMaxHealth)();
 
-	CVTableHook vhook(pEntity);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[SDKHook_GetMaxHealth];
-	for (size_t entry = 0; entry < vtablehooklist.size(); ++entry)
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pEntity, SDKHook_GetMaxHealth, callbackList))
 	{
-		if (vhook != vtablehooklist[entry]->vtablehook)
-		{
-			continue;
-		}
-
 		int entity = gamehelpers->EntityToBCompatRef(pEntity);
 
 		int new_max = original_max;
 
 		cell_t ret = Pl_Continue;
 
-		std::vector<IPluginFunction *> callbackList;
-		PopulateCallbackList(vtablehooklist[entry]->hooks, callbackList, entity);
-		for (entry = 0; entry < callbackList.size(); ++entry)
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
 		{
 			IPluginFunction *callback = callbackList[entry];
 			callback->PushCell(entity);
 			callback->PushCellByRef(&new_max);
 
 			cell_t res;
-			callback->Execute(&res);
+			ExecuteHookCallback(callback, SDKHook_GetMaxHealth, &res);
 
 			if (res > ret)
 			{
@@ -1112,8 +1406,6 @@ int SDKHooks::Hook_GetMaxHealth()
 
 		if (ret >= Pl_Changed)
 			RETURN_META_VALUE(MRES_SUPERCEDE, new_max);
-
-		break;
 	}
 
 	RETURN_META_VALUE(MRES_IGNORED, original_max);
@@ -1129,15 +1421,9 @@ int SDKHooks::HandleOnTakeDamageHook(CTakeDamageInfoHack &info, SDKHookType hook
 {
 	CBaseEntity *pEntity = META_IFACEPTR(CBaseEntity);
 
-	CVTableHook vhook(pEntity);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[hookType];
-	for (size_t entry = 0; entry < vtablehooklist.size(); ++entry)
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pEntity, hookType, callbackList))
 	{
-		if (vhook != vtablehooklist[entry]->vtablehook)
-		{
-			continue;
-		}
-
 		int entity = gamehelpers->EntityToBCompatRef(pEntity);
 		int attacker = info.GetAttacker();
 		int inflictor = info.GetInflictor();
@@ -1153,9 +1439,7 @@ int SDKHooks::HandleOnTakeDamageHook(CTakeDamageInfoHack &info, SDKHookType hook
 
 		cell_t res, ret = Pl_Continue;
 
-		std::vector<IPluginFunction *> callbackList;
-		PopulateCallbackList(vtablehooklist[entry]->hooks, callbackList, entity);
-		for (entry = 0; entry < callbackList.size(); ++entry)
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
 		{
 			IPluginFunction *callback = callbackList[entry];
 			callback->PushCell(entity);
@@ -1167,7 +1451,7 @@ int SDKHooks::HandleOnTakeDamageHook(CTakeDamageInfoHack &info, SDKHookType hook
 			callback->PushArray(damageForce, 3, SM_PARAM_COPYBACK);
 			callback->PushArray(damagePosition, 3, SM_PARAM_COPYBACK);
 			callback->PushCell(info.GetDamageCustom());
-			callback->Execute(&res);
+			ExecuteHookCallback(callback, hookType, &res);
 
 			if (res >= ret)
 			{
@@ -1209,8 +1493,6 @@ int SDKHooks::HandleOnTakeDamageHook(CTakeDamageInfoHack &info, SDKHookType hook
 
 		if (ret == Pl_Changed)
 			RETURN_META_VALUE(MRES_HANDLED, 1);
-
-		break;
 	}
 
 	RETURN_META_VALUE(MRES_IGNORED, 0);
@@ -1220,20 +1502,12 @@ int SDKHooks::HandleOnTakeDamageHookPost(CTakeDamageInfoHack &info, SDKHookType
 {
 	CBaseEntity *pEntity = META_IFACEPTR(CBaseEntity);
 
-	CVTableHook vhook(pEntity);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[hookType];
-	for (size_t entry = 0; entry < vtablehooklist.size(); ++entry)
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pEntity, hookType, callbackList))
 	{
-		if (vhook != vtablehooklist[entry]->vtablehook)
-		{
-			continue;
-		}
-
 		int entity = gamehelpers->EntityToBCompatRef(pEntity);
 
-		std::vector<IPluginFunction *> callbackList;
-		PopulateCallbackList(vtablehooklist[entry]->hooks, callbackList, entity);
-		for (entry = 0; entry < callbackList.size(); ++entry)
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
 		{
 			IPluginFunction *callback = callbackList[entry];
 			callback->PushCell(entity);
@@ -1253,15 +1527,65 @@ int SDKHooks::HandleOnTakeDamageHookPost(CTakeDamageInfoHack &info, SDKHookType
 
 			callback->PushCell(info.GetDamageCustom());
 
-			callback->Execute(NULL);
+			ExecuteHookCallback(callback, hookType, NULL);
+		}
+	}
+
+	RETURN_META_VALUE(MRES_IGNORED, 0);
+}
+
+/**
+ * Passes a token for the damage info instead of unpacking every field, so
+ * fields are only read or written when a plugin asks for them.
+ */
+int SDKHooks::HandleOnTakeDamageInfoHook(CTakeDamageInfoHack &info, SDKHookType hookType, bool post)
+{
+	CBaseEntity *pEntity = META_IFACEPTR(CBaseEntity);
+
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pEntity, hookType, callbackList))
+	{
+		int entity = gamehelpers->EntityToBCompatRef(pEntity);
+
+		if (++m_LastDamageToken <= 0)
+			m_LastDamageToken = 1;
+		ActiveDamageInfo active = { m_LastDamageToken, &info, post };
+		m_ActiveDamageInfo.push_back(active);
+
+		cell_t res, ret = Pl_Continue;
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
+		{
+			IPluginFunction *callback = callbackList[entry];
+			callback->PushCell(entity);
+			callback->PushCell(active.token);
+			ExecuteHookCallback(callback, hookType, &res);
+
+			if (res > ret)
+				ret = res;
 		}
 
-		break;
+		m_ActiveDamageInfo.pop_back();
+
+		if (!post && ret >= Pl_Handled)
+			RETURN_META_VALUE(MRES_SUPERCEDE, 1);
 	}
 
 	RETURN_META_VALUE(MRES_IGNORED, 0);
 }
 
+CTakeDamageInfoHack *SDKHooks::FindDamageInfo(cell_t token, bool *post)
+{
+	for (size_t i = m_ActiveDamageInfo.size(); i-- > 0; )
+	{
+		if (m_ActiveDamageInfo[i].token == token)
+		{
+			*post = m_ActiveDamageInfo[i].post;
+			return m_ActiveDamageInfo[i].info;
+		}
+	}
+	return NULL;
+}
+
 int SDKHooks::Hook_OnTakeDamage(CTakeDamageInfoHack &info)
 {
 	return HandleOnTakeDamageHook(info, SDKHook_OnTakeDamage);
@@ -1282,6 +1606,26 @@ int SDKHooks::Hook_OnTakeDamage_AlivePost(CTakeDamageInfoHack &info)
 	return HandleOnTakeDamageHookPost(info, SDKHook_OnTakeDamage_AlivePost);
 }
 
+int SDKHooks::Hook_OnTakeDamageInfo(CTakeDamageInfoHack &info)
+{
+	return HandleOnTakeDamageInfoHook(info, SDKHook_OnTakeDamageInfo, false);
+}
+
+int SDKHooks::Hook_OnTakeDamageInfoPost(CTakeDamageInfoHack &info)
+{
+	return HandleOnTakeDamageInfoHook(info, SDKHook_OnTakeDamageInfoPost, true);
+}
+
+int SDKHooks::Hook_OnTakeDamageAliveInfo(CTakeDamageInfoHack &info)
+{
+	return HandleOnTakeDamageInfoHook(info, SDKHook_OnTakeDamageAliveInfo, false);
+}
+
+int SDKHooks::Hook_OnTakeDamageAliveInfoPost(CTakeDamageInfoHack &info)
+{
+	return HandleOnTakeDamageInfoHook(info, SDKHook_OnTakeDamageAliveInfoPost, true);
+}
+
 void SDKHooks::Hook_PreThink()
 {
 	Call(META_IFACEPTR(CBaseEntity), SDKHook_PreThink);
@@ -1308,31 +1652,21 @@ bool SDKHooks::Hook_Reload()
 {
 	CBaseEntity *pEntity = META_IFACEPTR(CBaseEntity);
 
-	CVTableHook vhook(pEntity);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[SDKHook_Reload];
-	for (size_t entry = 0; entry < vtablehooklist.size(); ++entry)
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pEntity, SDKHook_Reload, callbackList))
 	{
-		if (vhook != vtablehooklist[entry]->vtablehook)
-		{
-			continue;
-		}
-
 		int entity = gamehelpers->EntityToBCompatRef(pEntity);
 		cell_t res = Pl_Continue;
 
-		std::vector<IPluginFunction *> callbackList;
-		PopulateCallbackList(vtablehooklist[entry]->hooks, callbackList, entity);
-		for (entry = 0; entry < callbackList.size(); ++entry)
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
 		{
 			IPluginFunction *callback = callbackList[entry];
 			callback->PushCell(entity);
-			callback->Execute(&res);
+			ExecuteHookCallback(callback, SDKHook_Reload, &res);
 		}
 
 		if (res >= Pl_Handled)
 			RETURN_META_VALUE(MRES_SUPERCEDE, false);
-
-		break;
 	}
 
 	RETURN_META_VALUE(MRES_IGNORED, true);
@@ -1342,29 +1676,19 @@ bool SDKHooks::Hook_ReloadPost()
 {
 	CBaseEntity *pEntity = META_IFACEPTR(CBaseEntity);
 
-	CVTableHook vhook(pEntity);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[SDKHook_ReloadPost];
-	for (size_t entry = 0; entry < vtablehooklist.size(); ++entry)
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pEntity, SDKHook_ReloadPost, callbackList))
 	{
-		if (vhook != vtablehooklist[entry]->vtablehook)
-		{
-			continue;
-		}
-
 		int entity = gamehelpers->EntityToBCompatRef(pEntity);
 		cell_t origreturn = META_RESULT_ORIG_RET(bool) ? 1 : 0;
 
-		std::vector<IPluginFunction *> callbackList;
-		PopulateCallbackList(vtablehooklist[entry]->hooks, callbackList, entity);
-		for (entry = 0; entry < callbackList.size(); ++entry)
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
 		{
 			IPluginFunction *callback = callbackList[entry];
 			callback->PushCell(entity);
 			callback->PushCell(origreturn);
-			callback->Execute(NULL);
+			ExecuteHookCallback(callback, SDKHook_ReloadPost, NULL);
 		}
-
-		break;
 	}
 
 	return true;
@@ -1372,7 +1696,21 @@ bool SDKHooks::Hook_ReloadPost()
 
 void SDKHooks::Hook_SetTransmit(CCheckTransmitInfo *pInfo, bool bAlways)
 {
-	cell_t result = Call(META_IFACEPTR(CBaseEntity), SDKHook_SetTransmit, gamehelpers->IndexOfEdict(pInfo->m_pClientEnt));
+	CBaseEntity *pEntity = META_IFACEPTR(CBaseEntity);
+	int client = gamehelpers->IndexOfEdict(pInfo->m_pClientEnt);
+
+	// Evaluate the native transmit mask first; plugin callbacks only run for clients it lets through
+	EntityHookList *list = GetEntityHookList(pEntity);
+	if (list == NULL)
+		RETURN_META(MRES_IGNORED);
+
+	if (IsTransmitMasked(list, client))
+		RETURN_META(MRES_SUPERCEDE);
+
+	if (list->hooks[SDKHook_SetTransmit].empty())
+		RETURN_META(MRES_IGNORED);
+
+	cell_t result = Call(pEntity, SDKHook_SetTransmit, client);
 
 	if(result >= Pl_Handled)
 		RETURN_META(MRES_SUPERCEDE);
@@ -1384,29 +1722,21 @@ bool SDKHooks::Hook_ShouldCollide(int collisionGroup, int contentsMask)
 {
 	CBaseEntity *pEntity = META_IFACEPTR(CBaseEntity);
 
-	CVTableHook vhook(pEntity);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[SDKHook_ShouldCollide];
-	for (size_t entry = 0; entry < vtablehooklist.size(); ++entry)
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pEntity, SDKHook_ShouldCollide, callbackList))
 	{
-		if (vhook != vtablehooklist[entry]->vtablehook)
-		{
-			continue;
-		}
-
 		int entity = gamehelpers->EntityToBCompatRef(pEntity);
 		cell_t origRet = ((META_RESULT_STATUS >= MRES_OVERRIDE)?(META_RESULT_OVERRIDE_RET(bool)):(META_RESULT_ORIG_RET(bool))) ? 1 : 0;
 		cell_t res = 0;
 
-		std::vector<IPluginFunction *> callbackList;
-		PopulateCallbackList(vtablehooklist[entry]->hooks, callbackList, entity);
-		for (entry = 0; entry < callbackList.size(); ++entry)
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
 		{
 			IPluginFunction *callback = callbackList[entry];
 			callback->PushCell(entity);
 			callback->PushCell(collisionGroup);
 			callback->PushCell(contentsMask);
 			callback->PushCell(origRet);
-			callback->Execute(&res);
+			ExecuteHookCallback(callback, SDKHook_ShouldCollide, &res);
 		}
 
 		bool ret = false;
@@ -1425,27 +1755,19 @@ void SDKHooks::Hook_Spawn()
 {
 	CBaseEntity *pEntity = META_IFACEPTR(CBaseEntity);
 
-	CVTableHook vhook(pEntity);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[SDKHook_Spawn];
-	for (size_t entry = 0; entry < vtablehooklist.size(); ++entry)
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pEntity, SDKHook_Spawn, callbackList))
 	{
-		if (vhook != vtablehooklist[entry]->vtablehook)
-		{
-			continue;
-		}
-
 		int entity = gamehelpers->EntityToBCompatRef(pEntity);
 		cell_t ret = Pl_Continue;
 
-		std::vector<IPluginFunction *> callbackList;
-		PopulateCallbackList(vtablehooklist[entry]->hooks, callbackList, entity);
-		for (entry = 0; entry < callbackList.size(); ++entry)
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
 		{
 			IPluginFunction *callback = callbackList[entry];
 			callback->PushCell(entity);
 
 			cell_t res;
-			callback->Execute(&res);
+			ExecuteHookCallback(callback, SDKHook_Spawn, &res);
 
 			if (res > ret)
 			{
@@ -1455,8 +1777,6 @@ void SDKHooks::Hook_Spawn()
 
 		if (ret >= Pl_Handled)
 			RETURN_META(MRES_SUPERCEDE);
-
-		break;
 	}
 
 	RETURN_META(MRES_IGNORED);
@@ -1522,15 +1842,9 @@ void SDKHooks::Hook_TraceAttack(CTakeDamageInfoHack &info, const Vector &vecDir,
 {
 	CBaseEntity *pEntity = META_IFACEPTR(CBaseEntity);
 
-	CVTableHook vhook(pEntity);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[SDKHook_TraceAttack];
-	for (size_t entry = 0; entry < vtablehooklist.size(); ++entry)
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pEntity, SDKHook_TraceAttack, callbackList))
 	{
-		if (vhook != vtablehooklist[entry]->vtablehook)
-		{
-			continue;
-		}
-
 		int entity = gamehelpers->EntityToBCompatRef(pEntity);
 		int attacker = info.GetAttacker();
 		int inflictor = info.GetInflictor();
@@ -1539,9 +1853,7 @@ void SDKHooks::Hook_TraceAttack(CTakeDamageInfoHack &info, const Vector &vecDir,
 		int ammotype = info.GetAmmoType();
 		cell_t res, ret = Pl_Continue;
 
-		std::vector<IPluginFunction *> callbackList;
-		PopulateCallbackList(vtablehooklist[entry]->hooks, callbackList, entity);
-		for (entry = 0; entry < callbackList.size(); ++entry)
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
 		{
 			IPluginFunction *callback = callbackList[entry];
 			callback->PushCell(entity);
@@ -1552,7 +1864,7 @@ void SDKHooks::Hook_TraceAttack(CTakeDamageInfoHack &info, const Vector &vecDir,
 			callback->PushCellByRef(&ammotype);
 			callback->PushCell(ptr->hitbox);
 			callback->PushCell(ptr->hitgroup);
-			callback->Execute(&res);
+			ExecuteHookCallback(callback, SDKHook_TraceAttack, &res);
 
 			if(res > ret)
 			{
@@ -1587,8 +1899,6 @@ void SDKHooks::Hook_TraceAttack(CTakeDamageInfoHack &info, const Vector &vecDir,
 
 		if(ret == Pl_Changed)
 			RETURN_META(MRES_HANDLED);
-
-		break;
 	}
 
 	RETURN_META(MRES_IGNORED);
@@ -1603,20 +1913,12 @@ void SDKHooks::Hook_TraceAttackPost(CTakeDamageInfoHack &info, const Vector &vec
 {
 	CBaseEntity *pEntity = META_IFACEPTR(CBaseEntity);
 
-	CVTableHook vhook(pEntity);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[SDKHook_TraceAttackPost];
-	for (size_t entry = 0; entry < vtablehooklist.size(); ++entry)
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pEntity, SDKHook_TraceAttackPost, callbackList))
 	{
-		if (vhook != vtablehooklist[entry]->vtablehook)
-		{
-			continue;
-		}
-
 		int entity = gamehelpers->EntityToBCompatRef(pEntity);
 
-		std::vector<IPluginFunction *> callbackList;
-		PopulateCallbackList(vtablehooklist[entry]->hooks, callbackList, entity);
-		for (entry = 0; entry < callbackList.size(); ++entry)
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
 		{
 			IPluginFunction *callback = callbackList[entry];
 			callback->PushCell(entity);
@@ -1627,10 +1929,8 @@ void SDKHooks::Hook_TraceAttackPost(CTakeDamageInfoHack &info, const Vector &vec
 			callback->PushCell(info.GetAmmoType());
 			callback->PushCell(ptr->hitbox);
 			callback->PushCell(ptr->hitgroup);
-			callback->Execute(NULL);
+			ExecuteHookCallback(callback, SDKHook_TraceAttackPost, NULL);
 		}
-
-		break;
 	}
 
 	RETURN_META(MRES_IGNORED);
@@ -1640,23 +1940,15 @@ void SDKHooks::Hook_Use(CBaseEntity *pActivator, CBaseEntity *pCaller, USE_TYPE
 {
 	CBaseEntity *pEntity = META_IFACEPTR(CBaseEntity);
 
-	CVTableHook vhook(pEntity);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[SDKHook_Use];
-	for (size_t entry = 0; entry < vtablehooklist.size(); ++entry)
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pEntity, SDKHook_Use, callbackList))
 	{
-		if (vhook != vtablehooklist[entry]->vtablehook)
-		{
-			continue;
-		}
-
 		int entity = gamehelpers->EntityToBCompatRef(pEntity);
 		int activator = gamehelpers->EntityToBCompatRef(pActivator);
 		int caller = gamehelpers->EntityToBCompatRef(pCaller);
 		cell_t ret = Pl_Continue;
 
-		std::vector<IPluginFunction *> callbackList;
-		PopulateCallbackList(vtablehooklist[entry]->hooks, callbackList, entity);
-		for (entry = 0; entry < callbackList.size(); ++entry)
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
 		{
 			IPluginFunction *callback = callbackList[entry];
 			callback->PushCell(entity);
@@ -1666,7 +1958,7 @@ void SDKHooks::Hook_Use(CBaseEntity *pActivator, CBaseEntity *pCaller, USE_TYPE
 			callback->PushFloat(value);
 
 			cell_t res;
-			callback->Execute(&res);
+			ExecuteHookCallback(callback, SDKHook_Use, &res);
 
 			if (res > ret)
 			{
@@ -1676,8 +1968,6 @@ void SDKHooks::Hook_Use(CBaseEntity *pActivator, CBaseEntity *pCaller, USE_TYPE
 
 		if (ret >= Pl_Handled)
 			RETURN_META(MRES_SUPERCEDE);
-
-		break;
 	}
 
 	RETURN_META(MRES_IGNORED);
@@ -1687,22 +1977,14 @@ void SDKHooks::Hook_UsePost(CBaseEntity *pActivator, CBaseEntity *pCaller, USE_T
 {
 	CBaseEntity *pEntity = META_IFACEPTR(CBaseEntity);
 
-	CVTableHook vhook(pEntity);
-	std::vector<CVTableList *> &vtablehooklist = g_HookList[SDKHook_UsePost];
-	for (size_t entry = 0; entry < vtablehooklist.size(); ++entry)
+	std::vector<IPluginFunction *> callbackList;
+	if (PopulateCallbackList(pEntity, SDKHook_UsePost, callbackList))
 	{
-		if (vhook != vtablehooklist[entry]->vtablehook)
-		{
-			continue;
-		}
-
 		int entity = gamehelpers->EntityToBCompatRef(pEntity);
 		int activator = gamehelpers->EntityToBCompatRef(pActivator);
 		int caller = gamehelpers->EntityToBCompatRef(pCaller);
 
-		std::vector<IPluginFunction *> callbackList;
-		PopulateCallbackList(vtablehooklist[entry]->hooks, callbackList, entity);
-		for (entry = 0; entry < callbackList.size(); ++entry)
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
 		{
 			IPluginFunction *callback = callbackList[entry];
 			callback->PushCell(entity);
@@ -1710,10 +1992,8 @@ void SDKHooks::Hook_UsePost(CBaseEntity *pActivator, CBaseEntity *pCaller, USE_T
 			callback->PushCell(caller);
 			callback->PushCell(useType);
 			callback->PushFloat(value);
-			callback->Execute(NULL);
+			ExecuteHookCallback(callback, SDKHook_UsePost, NULL);
 		}
-
-		break;
 	}
 
 	RETURN_META(MRES_IGNORED);
@@ -1858,7 +2138,22 @@ void SDKHooks::HandleEntityCreated(CBaseEntity *pEntity, int index, cell_t ref)
 	g_pOnEntityCreated->PushString(pName ? pName : "");
 	g_pOnEntityCreated->Execute(NULL);
 
+	// Call classname-filtered listeners
+	if (!m_EntityCreatedFilters.empty())
+	{
+		std::vector<IPluginFunction *> callbackList;
+		m_EntityCreatedFilters.Collect(pName ? pName : "", callbackList);
+		for (size_t entry = 0; entry < callbackList.size(); ++entry)
+		{
+			IPluginFunction *callback = callbackList[entry];
+			callback->PushCell(bcompatRef);
+			callback->PushString(pName ? pName : "");
+			callback->Execute(NULL);
+		}
+	}
+
 	m_EntityCache[index] = ref;
+	IndexEntityClassname(index, pName);
 }
 
 void SDKHooks::HandleEntityDeleted(CBaseEntity *pEntity)
@@ -1878,5 +2173,79 @@ void SDKHooks::HandleEntityDeleted(CBaseEntity *pEntity)
 	g_pOnEntityDestroyed->PushCell(bcompatRef);
 	g_pOnEntityDestroyed->Execute(NULL);
 
+	int index = gamehelpers->ReferenceToIndex(gamehelpers->EntityToReference(pEntity));
+	if (IsEntityIndexInRange(index))
+	{
+		UnindexEntityClassname(index);
+	}
+
 	Unhook(pEntity);
 }
+
+void SDKHooks::IndexEntityClassname(int index, const char *classname)
+{
+	UnindexEntityClassname(index);
+
+	if (!classname || !classname[0])
+		return;
+
+	std::set<int> *entities = &m_ClassnameIndex[classname];
+	entities->insert(index);
+	m_EntityClassnameSet[index] = entities;
+}
+
+void SDKHooks::UnindexEntityClassname(int index)
+{
+	if (m_EntityClassnameSet[index])
+	{
+		m_EntityClassnameSet[index]->erase(index);
+		m_EntityClassnameSet[index] = NULL;
+	}
+}
+
+int SDKHooks::FindEntityByClassname(int start, const char *classname)
+{
+	ClassnameIndex::iterator iter = m_ClassnameIndex.find(classname);
+	if (iter == m_ClassnameIndex.end())
+		return -1;
+
+	std::set<int>::iterator next = iter->second.upper_bound(start);
+	if (next == iter->second.end())
+		return -1;
+
+	return gamehelpers->ReferenceToBCompatRef(m_EntityCache[*next]);
+}
+
+int SDKHooks::GetEntitiesByClassname(const char *classname, cell_t *entities, int maxEntities)
+{
+	ClassnameIndex::iterator iter = m_ClassnameIndex.find(classname);
+	if (iter == m_ClassnameIndex.end())
+		return 0;
+
+	int count = 0;
+	for (std::set<int>::iterator index = iter->second.begin(); index != iter->second.end() && count < maxEntities; index++)
+	{
+		entities[count++] = gamehelpers->ReferenceToBCompatRef(m_EntityCache[*index]);
+	}
+
+	return count;
+}
+
+bool SDKHooks::HookEntityCreated(const char *pattern, IPluginFunction *callback)
+{
+	return m_EntityCreatedFilters.Add(pattern, callback);
+}
+
+bool SDKHooks::UnhookEntityCreated(const char *pattern, IPluginFunction *callback)
+{
+	return m_EntityCreatedFilters.Remove(pattern, callback);
+}
+
+int SDKHooks::GetClassnameCount(const char *classname)
+{
+	ClassnameIndex::iterator iter = m_ClassnameIndex.find(classname);
+	if (iter == m_ClassnameIndex.end())
+		return 0;
+
+	return (int)iter->second.size();
+}
@@ -2,6 +2,7 @@
 #define _INCLUDE_SOURCEMOD_EXTENSION_PROPER_H_
 
 #include "takedamageinfohack.h"
+#include "classnamefilter.h"
 
 #include "smsdk_ext.h"
 #include <ISDKHooks.h>
@@ -9,6 +10,10 @@
 #include <sh_list.h>
 #include <am-vector.h>
 #include <vtable_hook_helper.h>
+#include <bitset>
+#include <set>
+#include <string>
+#include <unordered_map>
 
 #include <iplayerinfo.h>
 #include <shareddefs.h>
@@ -84,9 +89,23 @@ enum SDKHookType
 	SDKHook_OnTakeDamage_Alive,
 	SDKHook_OnTakeDamage_AlivePost,
 	SDKHook_CanBeAutobalanced,
+	SDKHook_OnTakeDamageInfo,
+	SDKHook_OnTakeDamageInfoPost,
+	SDKHook_OnTakeDamageAliveInfo,
+	SDKHook_OnTakeDamageAliveInfoPost,
 	SDKHook_MAXHOOKS
 };
 
+enum SDKTransmitMode
+{
+	SDKTransmit_Default,
+	SDKTransmit_Always,
+	SDKTransmit_Never,
+	SDKTransmit_Teams,
+	SDKTransmit_Clients,
+	SDKTransmit_MAXMODES
+};
+
 enum HookReturn
 {
 	HookRet_Successful,
@@ -112,17 +131,10 @@ namespace SourceMod {
 	class IBinTools;
 }
 
-struct HookList
-{
-public:
-	int entity;
-	IPluginFunction *callback;
-};
-
 class CVTableList
 {
 public:
-	CVTableList() : vtablehook(NULL)
+	CVTableList() : vtablehook(NULL), hookcount(0)
 	{
 	};
 
@@ -132,7 +144,41 @@ public:
 	};
 public:
 	CVTableHook *vtablehook;
-	std::vector<HookList> hooks;
+	size_t hookcount;	// Callbacks registered through this vtable, across all entities
+};
+
+/**
+ * Per-entity transmit rules evaluated natively in SetTransmit, ahead of any
+ * plugin callbacks.
+ */
+struct TransmitMask
+{
+	TransmitMask() : mode(SDKTransmit_Default), teams(0), owner(NULL)
+	{
+	};
+
+	SDKTransmitMode mode;
+	uint32_t teams;							// SDKTransmit_Teams: bit per team index
+	std::bitset<SM_MAXPLAYERS + 1> clients;	// SDKTransmit_Clients: bit per client index
+	IPluginContext *owner;
+};
+
+/**
+ * Plugin callbacks of a single entity, by hook type. Dispatch looks these up
+ * by entity index rather than searching every hooked vtable and entity.
+ */
+class EntityHookList
+{
+public:
+	EntityHookList(cell_t ref) : entity(ref)
+	{
+		memset(vtables, 0, sizeof(vtables));
+	};
+public:
+	cell_t entity;
+	CVTableList *vtables[SDKHook_MAXHOOKS];
+	std::vector<IPluginFunction *> hooks[SDKHook_MAXHOOKS];
+	TransmitMask transmit;
 };
 
 class IEntityListener
@@ -157,6 +203,7 @@ class SDKHooks :
 	public IFeatureProvider,
 	public IEntityListener,
 	public IClientListener,
+	public IRootConsoleCommand,
 	public ISDKHooks
 {
 public:
@@ -255,6 +302,9 @@ public:  // IClientListener
 	virtual void OnClientPutInServer(int client);
 	virtual void OnClientDisconnecting(int client);
 
+public:  // IRootConsoleCommand
+	virtual void OnRootConsoleCommand(const char *cmdname, const ICommandArgs *args);
+
 public:  // ISDKHooks
 	virtual void AddEntityListener(ISMEntityListener *listener);
 	virtual void RemoveEntityListener(ISMEntityListener *listener);
@@ -299,6 +349,10 @@ public:
 	int Hook_OnTakeDamagePost(CTakeDamageInfoHack &info);
 	int Hook_OnTakeDamage_Alive(CTakeDamageInfoHack &info);
 	int Hook_OnTakeDamage_AlivePost(CTakeDamageInfoHack &info);
+	int Hook_OnTakeDamageInfo(CTakeDamageInfoHack &info);
+	int Hook_OnTakeDamageInfoPost(CTakeDamageInfoHack &info);
+	int Hook_OnTakeDamageAliveInfo(CTakeDamageInfoHack &info);
+	int Hook_OnTakeDamageAliveInfoPost(CTakeDamageInfoHack &info);
 	void Hook_PreThink();
 	void Hook_PreThinkPost();
 	void Hook_PostThink();
@@ -345,18 +399,74 @@ private:
 	void HandleEntityDeleted(CBaseEntity *pEntity);
 	void Unhook(CBaseEntity *pEntity);
 	void Unhook(IPluginContext *pContext);
+	void UnhookIndex(int index);
+	EntityHookList *AcquireEntityHookList(CBaseEntity *pEnt);
+	CVTableList *HookVTable(CBaseEntity *pEnt, SDKHookType type);
+	bool IsTransmitMasked(EntityHookList *list, int client);
+	void ClearTransmitClient(int client);
+
+public:
+	/**
+	 * Classname index, maintained from the entity listener so that searches do
+	 * not have to walk the whole entity list.
+	 */
+	int FindEntityByClassname(int start, const char *classname);
+	int GetEntitiesByClassname(const char *classname, cell_t *entities, int maxEntities);
+	int GetClassnameCount(const char *classname);
+
+	/**
+	 * Transmit masks, letting plugins hide entities from clients without a
+	 * SetTransmit callback per entity and client.
+	 */
+	HookReturn SetTransmitMask(int entity, SDKTransmitMode mode, uint32_t teams, IPluginContext *pContext);
+	HookReturn SetTransmitClient(int entity, int client, bool transmit);
+	SDKTransmitMode GetTransmitMask(int entity, uint32_t *teams);
+
+	/**
+	 * Classname-filtered entity creation listeners.
+	 */
+	bool HookEntityCreated(const char *pattern, IPluginFunction *callback);
+	bool UnhookEntityCreated(const char *pattern, IPluginFunction *callback);
+
+	/**
+	 * Damage info passed by token to the *Info OnTakeDamage hooks. A token is
+	 * only valid while its callbacks run; returns NULL otherwise.
+	 */
+	CTakeDamageInfoHack *FindDamageInfo(cell_t token, bool *post);
+private:
+	void IndexEntityClassname(int index, const char *classname);
+	void UnindexEntityClassname(int index);
 
 private:
 	int HandleOnTakeDamageHook(CTakeDamageInfoHack &info, SDKHookType hookType);
 	int HandleOnTakeDamageHookPost(CTakeDamageInfoHack &info, SDKHookType hookType);
+	int HandleOnTakeDamageInfoHook(CTakeDamageInfoHack &info, SDKHookType hookType, bool post);
 
 private:
 	inline bool IsEntityIndexInRange(int i) { return i >= 0 && i < NUM_ENT_ENTRIES; }
 	cell_t m_EntityCache[NUM_ENT_ENTRIES];
+
+	typedef std::unordered_map<std::string, std::set<int>> ClassnameIndex;
+	ClassnameIndex m_ClassnameIndex;
+	/* Points into m_ClassnameIndex, whose nodes are never erased. */
+	std::set<int> *m_EntityClassnameSet[NUM_ENT_ENTRIES];
+
+	ClassnameFilters m_EntityCreatedFilters;
+
+	struct ActiveDamageInfo
+	{
+		cell_t token;
+		CTakeDamageInfoHack *info;
+		bool post;
+	};
+	/* Damage can nest (a callback may deal damage), so this is a stack. */
+	std::vector<ActiveDamageInfo> m_ActiveDamageInfo;
+	cell_t m_LastDamageToken = 0;
 };
 
 extern CGlobalVars *gpGlobals;
 extern std::vector<CVTableList *> g_HookList[SDKHook_MAXHOOKS];
+extern EntityHookList *g_EntityHooks[NUM_ENT_ENTRIES];
 
 extern ICvar *icvar;
 
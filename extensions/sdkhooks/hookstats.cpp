@@ -0,0 +1,139 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * Source SDK Hooks Extension
+ * Copyright (C) 2010-2012 Nicholas Hastings
+ * Copyright (C) 2009-2010 Erik Minekus
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#include "hookstats.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+HookStats g_HookStats;
+
+static inline int64_t Now()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static inline double ToMs(int64_t ns)
+{
+	return double(ns) / 1000000.0;
+}
+
+HookStats::HookStats() : m_Enabled(false), m_StartTime(0), m_ElapsedTime(0)
+{
+}
+
+void HookStats::Start()
+{
+	if (m_Enabled)
+		return;
+
+	m_StartTime = Now();
+	m_Enabled = true;
+}
+
+void HookStats::Stop()
+{
+	if (!m_Enabled)
+		return;
+
+	m_ElapsedTime += Now() - m_StartTime;
+	m_Enabled = false;
+}
+
+void HookStats::Reset()
+{
+	for (size_t i = 0; i < SDKHook_MAXHOOKS; i++)
+		m_Types[i] = Counter();
+	m_Plugins.clear();
+
+	m_StartTime = Now();
+	m_ElapsedTime = 0;
+}
+
+void HookStats::Record(SDKHookType type, IPluginFunction *callback, int64_t ns)
+{
+	m_Types[type].Add(ns);
+	m_Plugins[callback->GetParentContext()].Add(ns);
+}
+
+void HookStats::RemovePlugin(IPluginContext *pContext)
+{
+	// The context may be reused by the next plugin.
+	m_Plugins.erase(pContext);
+}
+
+void HookStats::Print()
+{
+	int64_t elapsed = m_ElapsedTime;
+	if (m_Enabled)
+		elapsed += Now() - m_StartTime;
+
+	rootconsole->ConsolePrint("[SM] SDKHooks dispatch stats (%s, %.1f s sampled):",
+		m_Enabled ? "recording" : "stopped", double(elapsed) / 1000000000.0);
+
+	rootconsole->ConsolePrint("  %-28s %12s %12s %10s %10s", "Hook", "Calls", "Total ms", "Avg us", "Max us");
+	for (size_t i = 0; i < SDKHook_MAXHOOKS; i++)
+	{
+		const Counter &counter = m_Types[i];
+		if (!counter.calls)
+			continue;
+
+		rootconsole->ConsolePrint("  %-28s %12llu %12.3f %10.2f %10.2f",
+			g_HookTypes[i].name,
+			(unsigned long long)counter.calls,
+			ToMs(counter.total_ns),
+			double(counter.total_ns) / counter.calls / 1000.0,
+			double(counter.max_ns) / 1000.0);
+	}
+
+	std::vector<std::pair<IPluginContext *, Counter>> plugins(m_Plugins.begin(), m_Plugins.end());
+	std::sort(plugins.begin(), plugins.end(),
+		[](const std::pair<IPluginContext *, Counter> &a, const std::pair<IPluginContext *, Counter> &b) {
+			return a.second.total_ns > b.second.total_ns;
+		});
+
+	rootconsole->ConsolePrint("  %-28s %12s %12s %10s %10s", "Plugin", "Calls", "Total ms", "Avg us", "Max us");
+	for (size_t i = 0; i < plugins.size(); i++)
+	{
+		IPlugin *plugin = plsys->FindPluginByContext(plugins[i].first->GetContext());
+		const Counter &counter = plugins[i].second;
+
+		rootconsole->ConsolePrint("  %-28s %12llu %12.3f %10.2f %10.2f",
+			plugin ? plugin->GetFilename() : "<unknown>",
+			(unsigned long long)counter.calls,
+			ToMs(counter.total_ns),
+			double(counter.total_ns) / counter.calls / 1000.0,
+			double(counter.max_ns) / 1000.0);
+	}
+}
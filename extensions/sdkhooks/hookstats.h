@@ -0,0 +1,89 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * Source SDK Hooks Extension
+ * Copyright (C) 2010-2012 Nicholas Hastings
+ * Copyright (C) 2009-2010 Erik Minekus
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#ifndef _INCLUDE_SDKHOOKS_HOOKSTATS_H_
+#define _INCLUDE_SDKHOOKS_HOOKSTATS_H_
+
+#include "extension.h"
+#include <stdint.h>
+#include <unordered_map>
+
+/**
+ * Dispatch counters for hook callbacks, per hook type and per plugin.
+ * Recording is off until "sm sdkhooks stats start" so the dispatch paths
+ * only pay for a flag test.
+ */
+class HookStats
+{
+public:
+	struct Counter
+	{
+		uint64_t calls = 0;
+		int64_t total_ns = 0;
+		int64_t max_ns = 0;
+
+		void Add(int64_t ns)
+		{
+			calls++;
+			total_ns += ns;
+			if (ns > max_ns)
+				max_ns = ns;
+		}
+	};
+
+public:
+	HookStats();
+
+	bool IsEnabled() const
+	{
+		return m_Enabled;
+	}
+
+	void Start();
+	void Stop();
+	void Reset();
+	void Record(SDKHookType type, IPluginFunction *callback, int64_t ns);
+	void RemovePlugin(IPluginContext *pContext);
+	void Print();
+
+private:
+	bool m_Enabled;
+	int64_t m_StartTime;
+	int64_t m_ElapsedTime;
+	Counter m_Types[SDKHook_MAXHOOKS];
+	std::unordered_map<IPluginContext *, Counter> m_Plugins;
+};
+
+extern HookStats g_HookStats;
+
+#endif // _INCLUDE_SDKHOOKS_HOOKSTATS_H_
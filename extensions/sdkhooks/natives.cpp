@@ -318,3 +318,282 @@ cell_t Native_DropWeapon(IPluginContext *pContext, const cell_t *params)
 
 	return 0;
 }
+
+cell_t Native_FindEntityByClassname(IPluginContext *pContext, const cell_t *params)
+{
+	char *classname;
+	pContext->LocalToString(params[2], &classname);
+
+	int start = -1;
+	if (params[1] != -1)
+	{
+		start = gamehelpers->ReferenceToIndex(params[1]);
+		if (start == -1)
+			return pContext->ThrowNativeError("Invalid start entity %d", params[1]);
+	}
+
+	return g_Interface.FindEntityByClassname(start, classname);
+}
+
+cell_t Native_GetEntitiesByClassname(IPluginContext *pContext, const cell_t *params)
+{
+	char *classname;
+	pContext->LocalToString(params[1], &classname);
+
+	if (params[3] < 0)
+		return pContext->ThrowNativeError("Invalid maximum entity count %d", params[3]);
+
+	cell_t *entities;
+	pContext->LocalToPhysAddr(params[2], &entities);
+
+	return g_Interface.GetEntitiesByClassname(classname, entities, params[3]);
+}
+
+cell_t Native_GetClassnameCount(IPluginContext *pContext, const cell_t *params)
+{
+	char *classname;
+	pContext->LocalToString(params[1], &classname);
+
+	return g_Interface.GetClassnameCount(classname);
+}
+
+cell_t Native_SetTransmitMask(IPluginContext *pContext, const cell_t *params)
+{
+	SDKTransmitMode mode = (SDKTransmitMode)params[2];
+	if (mode < SDKTransmit_Default || mode >= SDKTransmit_MAXMODES)
+		return pContext->ThrowNativeError("Invalid transmit mode %d", mode);
+
+	HookReturn ret = g_Interface.SetTransmitMask(params[1], mode, (uint32_t)params[3], pContext);
+	switch (ret)
+	{
+		case HookRet_InvalidEntity:
+			return pContext->ThrowNativeError("Entity %d is invalid", params[1]);
+		case HookRet_NotSupported:
+			return pContext->ThrowNativeError("SetTransmit is not supported on this game");
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+cell_t Native_SetTransmitClient(IPluginContext *pContext, const cell_t *params)
+{
+	int client = params[2];
+	if (client < 1 || client > playerhelpers->GetMaxClients())
+		return pContext->ThrowNativeError("Invalid client index %d", client);
+
+	HookReturn ret = g_Interface.SetTransmitClient(params[1], client, params[3] != 0);
+	switch (ret)
+	{
+		case HookRet_InvalidEntity:
+			return pContext->ThrowNativeError("Entity %d is invalid", params[1]);
+		case HookRet_BadEntForHookType:
+			return pContext->ThrowNativeError("Entity %d does not use SDKTransmit_Clients", params[1]);
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+cell_t Native_GetTransmitMask(IPluginContext *pContext, const cell_t *params)
+{
+	if (!gamehelpers->ReferenceToEntity(params[1]))
+		return pContext->ThrowNativeError("Entity %d is invalid", params[1]);
+
+	uint32_t teams;
+	SDKTransmitMode mode = g_Interface.GetTransmitMask(params[1], &teams);
+
+	cell_t *addr;
+	pContext->LocalToPhysAddr(params[2], &addr);
+	*addr = (cell_t)teams;
+
+	return mode;
+}
+
+cell_t Native_HookEntityCreated(IPluginContext *pContext, const cell_t *params)
+{
+	char *pattern;
+	pContext->LocalToString(params[1], &pattern);
+
+	IPluginFunction *callback = pContext->GetFunctionById(params[2]);
+	if (!callback)
+		return pContext->ThrowNativeError("Invalid function id (%X)", params[2]);
+
+	return g_Interface.HookEntityCreated(pattern, callback);
+}
+
+cell_t Native_UnhookEntityCreated(IPluginContext *pContext, const cell_t *params)
+{
+	char *pattern;
+	pContext->LocalToString(params[1], &pattern);
+
+	IPluginFunction *callback = pContext->GetFunctionById(params[2]);
+	if (!callback)
+		return pContext->ThrowNativeError("Invalid function id (%X)", params[2]);
+
+	return g_Interface.UnhookEntityCreated(pattern, callback);
+}
+
+static CTakeDamageInfoHack *GetDamageInfo(IPluginContext *pContext, cell_t token, bool write)
+{
+	bool post;
+	CTakeDamageInfoHack *info = g_Interface.FindDamageInfo(token, &post);
+	if (!info)
+	{
+		pContext->ThrowNativeError("Damage info %d is invalid; it can only be used inside its hook callback", token);
+		return NULL;
+	}
+	if (write && post)
+	{
+		pContext->ThrowNativeError("Damage info cannot be changed in a post hook");
+		return NULL;
+	}
+	return info;
+}
+
+static bool ResolveDamageEntity(IPluginContext *pContext, cell_t ref, const char *what, CBaseEntity **pEntity)
+{
+	*pEntity = gamehelpers->ReferenceToEntity(ref);
+	if (!*pEntity && ref != -1)
+	{
+		pContext->ThrowNativeError("Entity %d for %s is invalid", ref, what);
+		return false;
+	}
+	return true;
+}
+
+cell_t Native_DamageInfo_GetAttacker(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], false);
+	return info ? info->GetAttacker() : 0;
+}
+
+cell_t Native_DamageInfo_SetAttacker(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], true);
+	CBaseEntity *pEntity;
+	if (!info || !ResolveDamageEntity(pContext, params[2], "attacker", &pEntity))
+		return 0;
+
+	info->SetAttacker(pEntity);
+	return 0;
+}
+
+cell_t Native_DamageInfo_GetInflictor(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], false);
+	return info ? info->GetInflictor() : 0;
+}
+
+cell_t Native_DamageInfo_SetInflictor(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], true);
+	CBaseEntity *pEntity;
+	if (!info || !ResolveDamageEntity(pContext, params[2], "inflictor", &pEntity))
+		return 0;
+
+	info->SetInflictor(pEntity);
+	return 0;
+}
+
+cell_t Native_DamageInfo_GetDamage(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], false);
+	return info ? sp_ftoc(info->GetDamage()) : 0;
+}
+
+cell_t Native_DamageInfo_SetDamage(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], true);
+	if (info)
+		info->SetDamage(sp_ctof(params[2]));
+	return 0;
+}
+
+cell_t Native_DamageInfo_GetDamageType(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], false);
+	return info ? info->GetDamageType() : 0;
+}
+
+cell_t Native_DamageInfo_SetDamageType(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], true);
+	if (info)
+		info->SetDamageType(params[2]);
+	return 0;
+}
+
+cell_t Native_DamageInfo_GetWeapon(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], false);
+	return info ? info->GetWeapon() : 0;
+}
+
+cell_t Native_DamageInfo_SetWeapon(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], true);
+	CBaseEntity *pEntity;
+	if (!info || !ResolveDamageEntity(pContext, params[2], "weapon", &pEntity))
+		return 0;
+
+	info->SetWeapon(pEntity);
+	return 0;
+}
+
+cell_t Native_DamageInfo_GetDamageCustom(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], false);
+	return info ? info->GetDamageCustom() : 0;
+}
+
+static void CopyVectorToPlugin(IPluginContext *pContext, cell_t addr, const Vector &vec)
+{
+	cell_t *out;
+	pContext->LocalToPhysAddr(addr, &out);
+	out[0] = sp_ftoc(vec.x);
+	out[1] = sp_ftoc(vec.y);
+	out[2] = sp_ftoc(vec.z);
+}
+
+cell_t Native_DamageInfo_GetForce(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], false);
+	if (info)
+		CopyVectorToPlugin(pContext, params[2], info->GetDamageForce());
+	return 0;
+}
+
+cell_t Native_DamageInfo_SetForce(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], true);
+	if (!info)
+		return 0;
+
+	cell_t *in;
+	pContext->LocalToPhysAddr(params[2], &in);
+	info->SetDamageForce(sp_ctof(in[0]), sp_ctof(in[1]), sp_ctof(in[2]));
+	return 0;
+}
+
+cell_t Native_DamageInfo_GetPosition(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], false);
+	if (info)
+		CopyVectorToPlugin(pContext, params[2], info->GetDamagePosition());
+	return 0;
+}
+
+cell_t Native_DamageInfo_SetPosition(IPluginContext *pContext, const cell_t *params)
+{
+	CTakeDamageInfoHack *info = GetDamageInfo(pContext, params[1], true);
+	if (!info)
+		return 0;
+
+	cell_t *in;
+	pContext->LocalToPhysAddr(params[2], &in);
+	info->SetDamagePosition(sp_ctof(in[0]), sp_ctof(in[1]), sp_ctof(in[2]));
+	return 0;
+}
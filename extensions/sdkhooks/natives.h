@@ -40,6 +40,29 @@ cell_t Native_HookEx(IPluginContext *pContext, const cell_t *params);
 cell_t Native_Unhook(IPluginContext *pContext, const cell_t *params);
 cell_t Native_TakeDamage(IPluginContext *pContext, const cell_t *params);
 cell_t Native_DropWeapon(IPluginContext *pContext, const cell_t *params);
+cell_t Native_FindEntityByClassname(IPluginContext *pContext, const cell_t *params);
+cell_t Native_GetEntitiesByClassname(IPluginContext *pContext, const cell_t *params);
+cell_t Native_GetClassnameCount(IPluginContext *pContext, const cell_t *params);
+cell_t Native_SetTransmitMask(IPluginContext *pContext, const cell_t *params);
+cell_t Native_SetTransmitClient(IPluginContext *pContext, const cell_t *params);
+cell_t Native_GetTransmitMask(IPluginContext *pContext, const cell_t *params);
+cell_t Native_HookEntityCreated(IPluginContext *pContext, const cell_t *params);
+cell_t Native_UnhookEntityCreated(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_GetAttacker(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_SetAttacker(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_GetInflictor(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_SetInflictor(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_GetDamage(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_SetDamage(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_GetDamageType(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_SetDamageType(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_GetWeapon(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_SetWeapon(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_GetDamageCustom(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_GetForce(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_SetForce(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_GetPosition(IPluginContext *pContext, const cell_t *params);
+cell_t Native_DamageInfo_SetPosition(IPluginContext *pContext, const cell_t *params);
 
 const sp_nativeinfo_t g_Natives[] = 
 {
@@ -48,6 +71,29 @@ const sp_nativeinfo_t g_Natives[] =
 	{"SDKUnhook",		Native_Unhook},
 	{"SDKHooks_TakeDamage",	Native_TakeDamage},
 	{"SDKHooks_DropWeapon",	Native_DropWeapon},
+	{"SDKHooks_FindEntityByClassname",	Native_FindEntityByClassname},
+	{"SDKHooks_GetEntitiesByClassname",	Native_GetEntitiesByClassname},
+	{"SDKHooks_GetClassnameCount",	Native_GetClassnameCount},
+	{"SDKHooks_SetTransmitMask",	Native_SetTransmitMask},
+	{"SDKHooks_SetTransmitClient",	Native_SetTransmitClient},
+	{"SDKHooks_GetTransmitMask",	Native_GetTransmitMask},
+	{"SDKHooks_HookEntityCreated",	Native_HookEntityCreated},
+	{"SDKHooks_UnhookEntityCreated",	Native_UnhookEntityCreated},
+	{"SDKDamageInfo.Attacker.get",	Native_DamageInfo_GetAttacker},
+	{"SDKDamageInfo.Attacker.set",	Native_DamageInfo_SetAttacker},
+	{"SDKDamageInfo.Inflictor.get",	Native_DamageInfo_GetInflictor},
+	{"SDKDamageInfo.Inflictor.set",	Native_DamageInfo_SetInflictor},
+	{"SDKDamageInfo.Damage.get",	Native_DamageInfo_GetDamage},
+	{"SDKDamageInfo.Damage.set",	Native_DamageInfo_SetDamage},
+	{"SDKDamageInfo.DamageType.get",	Native_DamageInfo_GetDamageType},
+	{"SDKDamageInfo.DamageType.set",	Native_DamageInfo_SetDamageType},
+	{"SDKDamageInfo.Weapon.get",	Native_DamageInfo_GetWeapon},
+	{"SDKDamageInfo.Weapon.set",	Native_DamageInfo_SetWeapon},
+	{"SDKDamageInfo.DamageCustom.get",	Native_DamageInfo_GetDamageCustom},
+	{"SDKDamageInfo.GetForce",	Native_DamageInfo_GetForce},
+	{"SDKDamageInfo.SetForce",	Native_DamageInfo_SetForce},
+	{"SDKDamageInfo.GetPosition",	Native_DamageInfo_GetPosition},
+	{"SDKDamageInfo.SetPosition",	Native_DamageInfo_SetPosition},
 	{NULL,					NULL},
 };
 
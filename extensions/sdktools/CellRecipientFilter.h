@@ -34,6 +34,7 @@
 
 #include <irecipientfilter.h>
 #include <sp_vm_types.h>
+#include <IPlayerHelpers.h>
 
 class CellRecipientFilter : public IRecipientFilter
 {
@@ -47,6 +48,8 @@ public: //IRecipientFilter
 	int GetRecipientIndex(int slot) const;
 public:
 	void Initialize(cell_t *ptr, size_t count);
+	void InitializeMatching(SourceMod::IPlayerManager *players, unsigned int flags,
+		unsigned int exclude = 0, int team = -1);
 	void SetToReliable(bool isreliable);
 	void SetToInit(bool isinitmsg);
 	void Reset();
@@ -110,4 +113,21 @@ inline void CellRecipientFilter::Initialize(cell_t *ptr, size_t count)
 	m_Size = count;
 }
 
+/**
+ * Fills the filter from PlayerManager's client state bitsets, e.g. every
+ * in-game client with ClientState_InGame, or one team's living players with
+ * ClientState_Alive and a team index.
+ */
+inline void CellRecipientFilter::InitializeMatching(SourceMod::IPlayerManager *players, unsigned int flags,
+	unsigned int exclude, int team)
+{
+	int clients[SM_MAXPLAYERS];
+	int count = players->GetClientsMatching(flags, exclude, team, clients, SM_MAXPLAYERS);
+	for (int i = 0; i < count; i++)
+	{
+		m_Players[i] = clients[i];
+	}
+	m_Size = count;
+}
+
 #endif //_INCLUDE_SOURCEMOD_CELLRECIPIENTFILTER_H_
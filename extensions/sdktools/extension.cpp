@@ -45,6 +45,7 @@
 #include <ISDKTools.h>
 #include "clientnatives.h"
 #include "teamnatives.h"
+#include "tracefilter.h"
 #include "filesystem.h"
 #include "am-string.h"
 
@@ -144,6 +145,7 @@ bool SDKTools::SDK_OnLoad(char *error, size_t maxlength, bool late)
 	sharesys->AddNatives(myself, g_EntOutputNatives);
 	sharesys->AddNatives(myself, g_GameRulesNatives);
 	sharesys->AddNatives(myself, g_ClientNatives);
+	sharesys->AddNatives(myself, g_UserCmdNatives);
 
 	SM_GET_IFACE(GAMEHELPERS, g_pGameHelpers);
 
@@ -169,6 +171,17 @@ bool SDKTools::SDK_OnLoad(char *error, size_t maxlength, bool late)
 		return false;
 	}
 
+	g_TraceFilterHandle = handlesys->CreateType("TraceFilter", this, 0, &TraceAccess, NULL, myself->GetIdentity(), &err);
+	if (g_TraceFilterHandle == 0)
+	{
+		handlesys->RemoveType(g_TraceHandle, myself->GetIdentity());
+		g_TraceHandle = 0;
+		handlesys->RemoveType(g_CallHandle, myself->GetIdentity());
+		g_CallHandle = 0;
+		ke::SafeSprintf(error, maxlength, "Could not create tracefilter handle type (err: %d)", err);
+		return false;
+	}
+
 #if SOURCE_ENGINE >= SE_ORANGEBOX
 	g_pCVar = icvar;
 #endif
@@ -230,8 +243,12 @@ void SDKTools::OnHandleDestroy(HandleType_t type, void *object)
 	}
 	else if (type == g_TraceHandle)
 	{
-		trace_t *tr = (trace_t *)object;
-		delete tr;
+		FreeTraceResult(object);
+	}
+	else if (type == g_TraceFilterHandle)
+	{
+		CSMNativeTraceFilter *filter = (CSMNativeTraceFilter *)object;
+		delete filter;
 	}
 }
 
@@ -305,6 +322,16 @@ void SDKTools::SDK_OnUnload()
 			g_pSM->LogError(myself, "Could not remove trace handle (type=%x, err=%d)", g_TraceHandle, err);
 		}
 	}
+
+	if (g_TraceFilterHandle != 0)
+	{
+		if ((err = handlesys->RemoveType(g_TraceFilterHandle, myself->GetIdentity())) != true)
+		{
+			g_pSM->LogError(myself, "Could not remove trace filter handle (type=%x, err=%d)", g_TraceFilterHandle, err);
+		}
+	}
+
+	ReleaseTraceResultPool();
 }
 
 bool SDKTools::SDK_OnMetamodLoad(ISmmAPI *ismm, char *error, size_t maxlen, bool late)
@@ -374,6 +401,8 @@ void SDKTools::OnCoreMapStart(edict_t *pEdictList, int edictCount, int clientMax
 	InitTeamNatives();
 	GetResourceEntity();
 	g_Hooks.OnMapStart();
+	InvalidatePreparedSounds();
+	GameRulesNativesMapStart();
 }
 
 bool SDKTools::QueryRunning(char *error, size_t maxlength)
@@ -453,6 +482,7 @@ bool SDKTools::LevelInit(char const *pMapName, char const *pMapEntities, char co
 void SDKTools::LevelShutdown()
 {
 	ClearValveGlobals();
+	ClearStringTableMirrors();
 }
 
 bool SDKTools::ProcessCommandTarget(cmd_target_info_t *info)
@@ -174,6 +174,11 @@ extern IGameHelpers *g_pGameHelpers;
 /* Handle types */
 extern HandleType_t g_CallHandle;
 extern HandleType_t g_TraceHandle;
+/* Trace result pool */
+void FreeTraceResult(void *object);
+void ReleaseTraceResultPool();
+/* String table mirrors */
+void ClearStringTableMirrors();
 /* Call Wrappers */
 extern ICallWrapper *g_pAcceptInput;
 /* Timers */
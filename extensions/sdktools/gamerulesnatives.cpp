@@ -73,20 +73,32 @@ static CBaseEntity *FindEntityByNetClass(int start, const char *classname)
 	return nullptr;
 }
 
+static cell_t g_GameRulesProxyRef = -1;
+static edict_t *g_pGameRulesProxyEdict = NULL;
+
 static CBaseEntity* GetGameRulesProxyEnt()
 {
-	static cell_t proxyEntRef = -1;
 	CBaseEntity *pProxy;
-	if (proxyEntRef == -1 || (pProxy = gamehelpers->ReferenceToEntity(proxyEntRef)) == NULL)
+	if (g_GameRulesProxyRef == -1 || (pProxy = gamehelpers->ReferenceToEntity(g_GameRulesProxyRef)) == NULL)
 	{
+		g_pGameRulesProxyEdict = NULL;
 		pProxy = FindEntityByNetClass(playerhelpers->GetMaxClients(), g_szGameRulesProxy);
 		if (pProxy)
-			proxyEntRef = gamehelpers->EntityToReference(pProxy);
+		{
+			g_GameRulesProxyRef = gamehelpers->EntityToReference(pProxy);
+			g_pGameRulesProxyEdict = gamehelpers->EdictOfIndex(gamehelpers->EntityToBCompatRef(pProxy));
+		}
 	}
 	
 	return pProxy;
 }
 
+static inline void GameRulesProxyStateChanged(int offset)
+{
+	if (g_pGameRulesProxyEdict != NULL)
+		gamehelpers->SetEdictStateChanged(g_pGameRulesProxyEdict, offset);
+}
+
 enum PropFieldType
 {
 	PropField_Unsupported,		/**< The type is unsupported. */
@@ -197,6 +209,64 @@ enum PropFieldType
 			type); \
 	}
 
+struct GameRulesProp
+{
+	SendProp *pProp;
+	int offset;
+	int bit_count;
+};
+
+/* Resolved props by "name:element:type", dropped on map change. */
+static StringHashMap<GameRulesProp> g_GameRulesProps;
+
+void GameRulesNativesMapStart()
+{
+	g_GameRulesProps.clear();
+	g_GameRulesProxyRef = -1;
+	g_pGameRulesProxyEdict = NULL;
+}
+
+static inline void GameRulesPropKey(char *buffer, size_t maxlength, const char *prop, int element, int type)
+{
+	ke::SafeSprintf(buffer, maxlength, "%s:%d:%d", prop, element, type);
+}
+
+#define DEFINE_FIND_GAMERULES_PROP(func, type, type_name) \
+	static bool func(IPluginContext *pContext, const char *prop, int element, SendProp **ppProp, int *pOffset, int *pBitCount) \
+	{ \
+		char key[256]; \
+		GameRulesPropKey(key, sizeof(key), prop, element, type); \
+		\
+		GameRulesProp *cached; \
+		if (g_GameRulesProps.retrieve(key, &cached)) \
+		{ \
+			*ppProp = cached->pProp; \
+			*pOffset = cached->offset; \
+			*pBitCount = cached->bit_count; \
+			return true; \
+		} \
+		\
+		int offset; \
+		int bit_count; \
+		FIND_PROP_SEND(type, type_name); \
+		\
+		GameRulesProp resolved; \
+		resolved.pProp = pProp; \
+		resolved.offset = offset; \
+		resolved.bit_count = bit_count; \
+		g_GameRulesProps.insert(key, resolved); \
+		\
+		*ppProp = pProp; \
+		*pOffset = offset; \
+		*pBitCount = bit_count; \
+		return true; \
+	}
+
+DEFINE_FIND_GAMERULES_PROP(FindGameRulesIntProp, DPT_Int, "integer")
+DEFINE_FIND_GAMERULES_PROP(FindGameRulesFloatProp, DPT_Float, "float")
+DEFINE_FIND_GAMERULES_PROP(FindGameRulesVectorProp, DPT_Vector, "vector")
+DEFINE_FIND_GAMERULES_PROP(FindGameRulesStringProp, DPT_String, "string")
+
 static cell_t GameRules_GetProp(IPluginContext *pContext, const cell_t *params)
 {
 	char *prop;
@@ -214,7 +284,9 @@ static cell_t GameRules_GetProp(IPluginContext *pContext, const cell_t *params)
 
 	int elementCount = 1;
 
-	FIND_PROP_SEND(DPT_Int, "integer");
+	SendProp *pProp;
+	if (!FindGameRulesIntProp(pContext, prop, element, &pProp, &offset, &bit_count))
+		return 0;
 	is_unsigned = ((pProp->GetFlags() & SPROP_UNSIGNED) == SPROP_UNSIGNED);
 
 	// This isn't in CS:S yet, but will be, doesn't hurt to add now, and will save us a build later
@@ -291,7 +363,9 @@ static cell_t GameRules_SetProp(IPluginContext *pContext, const cell_t *params)
 	}
 #endif
 
-	FIND_PROP_SEND(DPT_Int, "integer");
+	SendProp *pProp;
+	if (!FindGameRulesIntProp(pContext, prop, element, &pProp, &offset, &bit_count))
+		return 0;
 
 #if SOURCE_ENGINE == SE_CSS || SOURCE_ENGINE == SE_HL2DM || SOURCE_ENGINE == SE_DODS || SOURCE_ENGINE == SE_TF2 \
 	|| SOURCE_ENGINE == SE_SDK2013 || SOURCE_ENGINE == SE_BMS || SOURCE_ENGINE == SE_CSGO || SOURCE_ENGINE == SE_BLADE \
@@ -324,9 +398,7 @@ static cell_t GameRules_SetProp(IPluginContext *pContext, const cell_t *params)
 		*(bool *)((intptr_t)pGameRules + offset) = (params[2] == 0) ? false : true;
 	}
 
-	edict_t *proxyEdict = gamehelpers->EdictOfIndex(gamehelpers->EntityToBCompatRef(pProxy));
-	if (proxyEdict != NULL)
-		gamehelpers->SetEdictStateChanged(proxyEdict, offset);
+	GameRulesProxyStateChanged(offset);
 
 	return 0;
 }
@@ -345,7 +417,9 @@ static cell_t GameRules_GetPropFloat(IPluginContext *pContext, const cell_t *par
 
 	pContext->LocalToString(params[1], &prop);
 
-	FIND_PROP_SEND(DPT_Float, "float");
+	SendProp *pProp;
+	if (!FindGameRulesFloatProp(pContext, prop, element, &pProp, &offset, &bit_count))
+		return 0;
 
 	float val = *(float *)((intptr_t)pGameRules + offset);
 
@@ -377,15 +451,15 @@ static cell_t GameRules_SetPropFloat(IPluginContext *pContext, const cell_t *par
 	}
 #endif
 
-	FIND_PROP_SEND(DPT_Float, "float");
+	SendProp *pProp;
+	if (!FindGameRulesFloatProp(pContext, prop, element, &pProp, &offset, &bit_count))
+		return 0;
 
 	float newVal = sp_ctof(params[2]);
 
 	*(float *)((intptr_t)pGameRules + offset) = newVal;
 
-	edict_t *proxyEdict = gamehelpers->EdictOfIndex(gamehelpers->EntityToBCompatRef(pProxy));
-	if (proxyEdict != NULL)
-		gamehelpers->SetEdictStateChanged(proxyEdict, offset);
+	GameRulesProxyStateChanged(offset);
 
 	return 0;
 }
@@ -404,7 +478,9 @@ static cell_t GameRules_GetPropEnt(IPluginContext *pContext, const cell_t *param
 
 	pContext->LocalToString(params[1], &prop);
 
-	FIND_PROP_SEND(DPT_Int, "Integer");
+	SendProp *pProp;
+	if (!FindGameRulesIntProp(pContext, prop, element, &pProp, &offset, &bit_count))
+		return 0;
 
 	CBaseHandle &hndl = *(CBaseHandle *)((intptr_t)pGameRules + offset);
 	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(hndl.GetEntryIndex());
@@ -442,7 +518,9 @@ static cell_t GameRules_SetPropEnt(IPluginContext *pContext, const cell_t *param
 	}
 #endif
 
-	FIND_PROP_SEND(DPT_Int, "integer");
+	SendProp *pProp;
+	if (!FindGameRulesIntProp(pContext, prop, element, &pProp, &offset, &bit_count))
+		return 0;
 
 	CBaseHandle &hndl = *(CBaseHandle *)((intptr_t)pGameRules + offset);
 	CBaseEntity *pOther;
@@ -464,9 +542,7 @@ static cell_t GameRules_SetPropEnt(IPluginContext *pContext, const cell_t *param
 		hndl.Set(pHandleEnt);
 	}
 
-	edict_t *proxyEdict = gamehelpers->EdictOfIndex(gamehelpers->EntityToBCompatRef(pProxy));
-	if (proxyEdict != NULL)
-		gamehelpers->SetEdictStateChanged(proxyEdict, offset);
+	GameRulesProxyStateChanged(offset);
 
 	return 0;
 }
@@ -485,7 +561,9 @@ static cell_t GameRules_GetPropVector(IPluginContext *pContext, const cell_t *pa
 
 	pContext->LocalToString(params[1], &prop);
 
-	FIND_PROP_SEND(DPT_Vector, "vector");
+	SendProp *pProp;
+	if (!FindGameRulesVectorProp(pContext, prop, element, &pProp, &offset, &bit_count))
+		return 0;
 
 	Vector *v = (Vector *)((intptr_t)pGameRules + offset);
 
@@ -524,7 +602,9 @@ static cell_t GameRules_SetPropVector(IPluginContext *pContext, const cell_t *pa
 	}
 #endif
 
-	FIND_PROP_SEND(DPT_Vector, "vector");
+	SendProp *pProp;
+	if (!FindGameRulesVectorProp(pContext, prop, element, &pProp, &offset, &bit_count))
+		return 0;
 
 	Vector *v = (Vector *)((intptr_t)pGameRules + offset);
 
@@ -535,9 +615,7 @@ static cell_t GameRules_SetPropVector(IPluginContext *pContext, const cell_t *pa
 	v->y = sp_ctof(vec[1]);
 	v->z = sp_ctof(vec[2]);
 
-	edict_t *proxyEdict = gamehelpers->EdictOfIndex(gamehelpers->EntityToBCompatRef(pProxy));
-	if (proxyEdict != NULL)
-		gamehelpers->SetEdictStateChanged(proxyEdict, offset);
+	GameRulesProxyStateChanged(offset);
 
 	return 1;
 }
@@ -561,7 +639,9 @@ static cell_t GameRules_GetPropString(IPluginContext *pContext, const cell_t *pa
 
 	pContext->LocalToString(params[1], &prop);
 
-	FIND_PROP_SEND(DPT_String, "string");
+	SendProp *pProp;
+	if (!FindGameRulesStringProp(pContext, prop, element, &pProp, &offset, &bit_count))
+		return 0;
 
 	const char *src;
 	if (pProp->GetProxyFn())
@@ -617,7 +697,9 @@ static cell_t GameRules_SetPropString(IPluginContext *pContext, const cell_t *pa
 	}
 #endif
 
-	FIND_PROP_SEND(DPT_String, "string");
+	SendProp *pProp;
+	if (!FindGameRulesStringProp(pContext, prop, element, &pProp, &offset, &bit_count))
+		return 0;
 
 	bool bIsStringIndex = false;
 	if (pProp->GetProxyFn())
@@ -651,9 +733,7 @@ static cell_t GameRules_SetPropString(IPluginContext *pContext, const cell_t *pa
 		len = ke::SafeStrcpy(dest, maxlen, src);
 	}
 
-	edict_t *proxyEdict = gamehelpers->EdictOfIndex(gamehelpers->EntityToBCompatRef(pProxy));
-	if (proxyEdict != NULL)
-		gamehelpers->SetEdictStateChanged(proxyEdict, offset);
+	GameRulesProxyStateChanged(offset);
 
 	return len;
 }
@@ -69,9 +69,8 @@ SourceHook::CallClass<IBaseFileSystem> *basefilesystemPatch = NULL;
 
 CHookManager::CHookManager()
 {
-	m_usercmdsPreFwd = NULL;
-	m_usercmdsFwd = NULL;
-	m_usercmdsPostFwd = NULL;
+	memset(m_usercmdFwds, 0, sizeof(m_usercmdFwds));
+	memset(m_lastButtons, 0, sizeof(m_lastButtons));
 	m_netFileSendFwd = NULL;
 	m_netFileReceiveFwd = NULL;
 	m_pActiveNetChannel = NULL;
@@ -99,7 +98,8 @@ void CHookManager::Initialize()
 	plsys->AddPluginsListener(this);
 	sharesys->AddCapabilityProvider(myself, this, FEATURECAP_PLAYERRUNCMD_11PARAMS);
 	
-	m_usercmdsPreFwd = forwards->CreateForward("OnPlayerRunCmdPre", ET_Ignore, 11, NULL,
+	/* These are unmanaged so that plugins with a usercmd filter can be taken out of them */
+	m_usercmdFwds[RunCmdFwd_Pre] = forwards->CreateForwardEx("OnPlayerRunCmdPre", ET_Ignore, 11, NULL,
 		Param_Cell,			// int client
 		Param_Cell,			// int buttons
 		Param_Cell,			// int impulse
@@ -112,7 +112,7 @@ void CHookManager::Initialize()
 		Param_Cell,			// int seed
 		Param_Array);		// int mouse[2]
 
-	m_usercmdsFwd = forwards->CreateForward("OnPlayerRunCmd", ET_Event, 11, NULL,
+	m_usercmdFwds[RunCmdFwd_Main] = forwards->CreateForwardEx("OnPlayerRunCmd", ET_Event, 11, NULL,
 		Param_Cell,			// client
 		Param_CellByRef,	// buttons
 		Param_CellByRef,	// impulse
@@ -125,7 +125,7 @@ void CHookManager::Initialize()
 		Param_CellByRef,	// seed
 		Param_Array);		// mouse[2]
 
-	m_usercmdsPostFwd = forwards->CreateForward("OnPlayerRunCmdPost", ET_Ignore, 11, NULL,
+	m_usercmdFwds[RunCmdFwd_Post] = forwards->CreateForwardEx("OnPlayerRunCmdPost", ET_Ignore, 11, NULL,
 		Param_Cell,			// client
 		Param_Cell,			// buttons
 		Param_Cell,			// impulse
@@ -137,6 +137,26 @@ void CHookManager::Initialize()
 		Param_Cell,			// tickcount
 		Param_Cell,			// seed
 		Param_Array);		// mouse[2]
+
+	m_usercmdFwds[RunCmdFwd_View] = forwards->CreateForwardEx("OnPlayerRunCmdView", ET_Event, 2, NULL,
+		Param_Cell,			// client
+		Param_Cell);		// UserCmd cmd
+
+	m_usercmdFwds[RunCmdFwd_ViewPost] = forwards->CreateForwardEx("OnPlayerRunCmdViewPost", ET_Ignore, 2, NULL,
+		Param_Cell,			// client
+		Param_Cell);		// UserCmd cmd
+
+	IPluginIterator *iter = plsys->GetPluginIterator();
+	while (iter->MorePlugins())
+	{
+		IPlugin *plugin = iter->GetPlugin();
+		if (plugin->GetStatus() == Plugin_Running)
+		{
+			AddRunCmdFunctions(plugin);
+		}
+		iter->NextPlugin();
+	}
+	iter->Release();
 }
 
 void CHookManager::Shutdown()
@@ -193,9 +213,12 @@ void CHookManager::Shutdown()
 	}
 #endif
 
-	forwards->ReleaseForward(m_usercmdsPreFwd);
-	forwards->ReleaseForward(m_usercmdsFwd);
-	forwards->ReleaseForward(m_usercmdsPostFwd);
+	for (int i = 0; i < RunCmdFwd_Total; i++)
+	{
+		forwards->ReleaseForward(m_usercmdFwds[i]);
+		m_usercmdFwds[i] = NULL;
+	}
+	m_filteredPlugins.clear();
 	forwards->ReleaseForward(m_netFileSendFwd);
 	forwards->ReleaseForward(m_netFileReceiveFwd);
 
@@ -245,6 +268,9 @@ void CHookManager::OnClientConnected(int client)
 
 void CHookManager::OnClientPutInServer(int client)
 {
+	m_lastButtons[0][client] = 0;
+	m_lastButtons[1][client] = 0;
+
 	if (PRCH_used)
 		PlayerRunCmdHook(client, false);
 	if (PRCHPost_used)
@@ -291,6 +317,116 @@ void CHookManager::PlayerRunCmdHook(int client, bool post)
 	runUserCmdHookVec.push_back(new CVTableHook(hook));
 }
 
+bool RunCmdFilter::Matches(int client, bool fakeClient, int changedButtons, int impulse) const
+{
+	if ((flags & RUNCMDFILTER_CLIENTS) && !clients.test(client))
+	{
+		return false;
+	}
+
+	/* Setting both bot and human flags matches everyone */
+	int type = flags & (RUNCMDFILTER_BOTS|RUNCMDFILTER_HUMANS);
+	if ((type == RUNCMDFILTER_BOTS && !fakeClient) || (type == RUNCMDFILTER_HUMANS && fakeClient))
+	{
+		return false;
+	}
+
+	if ((flags & RUNCMDFILTER_BUTTONCHANGE) && (changedButtons & buttons) == 0)
+	{
+		return false;
+	}
+
+	if ((flags & RUNCMDFILTER_IMPULSE) && impulse == 0)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+unsigned int CHookManager::GetRunCmdFunctionCount(RunCmdForwardType type)
+{
+	unsigned int count = m_usercmdFwds[type]->GetFunctionCount();
+	for (size_t i = 0; i < m_filteredPlugins.size(); i++)
+	{
+		if (m_filteredPlugins[i].funcs[type])
+		{
+			count++;
+		}
+	}
+	return count;
+}
+
+bool CHookManager::HasRunCmdListeners(RunCmdForwardType type)
+{
+	if (m_usercmdFwds[type]->GetFunctionCount() > 0)
+	{
+		return true;
+	}
+
+	for (size_t i = 0; i < m_filteredPlugins.size(); i++)
+	{
+		if (m_filteredPlugins[i].funcs[type] && m_filteredPlugins[i].matched)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void CHookManager::UpdateRunCmdFilters(int client, CUserCmd *ucmd, bool post)
+{
+	int &lastButtons = m_lastButtons[post ? 1 : 0][client];
+	int changedButtons = ucmd->buttons ^ lastButtons;
+	lastButtons = ucmd->buttons;
+
+	if (m_filteredPlugins.empty())
+	{
+		return;
+	}
+
+	IGamePlayer *player = playerhelpers->GetGamePlayer(client);
+	bool fakeClient = player && player->IsFakeClient();
+
+	for (size_t i = 0; i < m_filteredPlugins.size(); i++)
+	{
+		FilteredPlugin &filtered = m_filteredPlugins[i];
+		filtered.matched = filtered.filter.Matches(client, fakeClient, changedButtons, ucmd->impulse);
+	}
+}
+
+template <typename PushParams>
+cell_t CHookManager::CallRunCmd(RunCmdForwardType type, PushParams push)
+{
+	cell_t result = 0;
+
+	IChangeableForward *pForward = m_usercmdFwds[type];
+	if (pForward->GetFunctionCount() > 0)
+	{
+		push(pForward);
+		pForward->Execute(&result);
+	}
+
+	for (size_t i = 0; i < m_filteredPlugins.size(); i++)
+	{
+		FilteredPlugin &filtered = m_filteredPlugins[i];
+		IPluginFunction *func = filtered.funcs[type];
+		if (!func || !filtered.matched || func->GetParentRuntime()->IsPaused())
+		{
+			continue;
+		}
+
+		cell_t cur = 0;
+		push(func);
+		if (func->Execute(&cur) == SP_ERROR_NONE && cur > result)
+		{
+			result = cur;
+		}
+	}
+
+	return result;
+}
+
 void CHookManager::PlayerRunCmd(CUserCmd *ucmd, IMoveHelper *moveHelper)
 {
 	if (!ucmd)
@@ -298,10 +434,7 @@ void CHookManager::PlayerRunCmd(CUserCmd *ucmd, IMoveHelper *moveHelper)
 		RETURN_META(MRES_IGNORED);
 	}
 
-	bool hasUsercmdsPreFwds = (m_usercmdsPreFwd->GetFunctionCount() > 0);
-	bool hasUsercmdsFwds = (m_usercmdsFwd->GetFunctionCount() > 0);
-
-	if (!hasUsercmdsPreFwds && !hasUsercmdsFwds)
+	if (!GetRunCmdFunctionCount(RunCmdFwd_Pre) && !GetRunCmdFunctionCount(RunCmdFwd_Main) && !GetRunCmdFunctionCount(RunCmdFwd_View))
 	{
 		RETURN_META(MRES_IGNORED);
 	}
@@ -322,6 +455,21 @@ void CHookManager::PlayerRunCmd(CUserCmd *ucmd, IMoveHelper *moveHelper)
 
 	int client = IndexOfEdict(pEdict);
 
+	UpdateRunCmdFilters(client, ucmd, false);
+
+	bool hasUsercmdsPreFwds = HasRunCmdListeners(RunCmdFwd_Pre);
+	bool hasUsercmdsFwds = HasRunCmdListeners(RunCmdFwd_Main);
+	bool hasUsercmdsViewFwds = HasRunCmdListeners(RunCmdFwd_View);
+
+	/* The view forward reads the live usercmd, so it needs none of the copies below */
+	if (!hasUsercmdsPreFwds && !hasUsercmdsFwds)
+	{
+		if (hasUsercmdsViewFwds && ExecuteUserCmdView(RunCmdFwd_View, client, ucmd, true) >= Pl_Handled)
+		{
+			RETURN_META(MRES_SUPERCEDE);
+		}
+		RETURN_META(MRES_IGNORED);
+	}
 
 	cell_t result = 0;
 	/* Impulse is a byte so we copy it back manually */
@@ -332,34 +480,36 @@ void CHookManager::PlayerRunCmd(CUserCmd *ucmd, IMoveHelper *moveHelper)
 	
 	if (hasUsercmdsPreFwds)
 	{
-		m_usercmdsPreFwd->PushCell(client);
-		m_usercmdsPreFwd->PushCell(ucmd->buttons);
-		m_usercmdsPreFwd->PushCell(ucmd->impulse);
-		m_usercmdsPreFwd->PushArray(vel, 3);
-		m_usercmdsPreFwd->PushArray(angles, 3);
-		m_usercmdsPreFwd->PushCell(ucmd->weaponselect);
-		m_usercmdsPreFwd->PushCell(ucmd->weaponsubtype);
-		m_usercmdsPreFwd->PushCell(ucmd->command_number);
-		m_usercmdsPreFwd->PushCell(ucmd->tick_count);
-		m_usercmdsPreFwd->PushCell(ucmd->random_seed);
-		m_usercmdsPreFwd->PushArray(mouse, 2);
-		m_usercmdsPreFwd->Execute();
+		CallRunCmd(RunCmdFwd_Pre, [&](ICallable *call) {
+			call->PushCell(client);
+			call->PushCell(ucmd->buttons);
+			call->PushCell(ucmd->impulse);
+			call->PushArray(vel, 3);
+			call->PushArray(angles, 3);
+			call->PushCell(ucmd->weaponselect);
+			call->PushCell(ucmd->weaponsubtype);
+			call->PushCell(ucmd->command_number);
+			call->PushCell(ucmd->tick_count);
+			call->PushCell(ucmd->random_seed);
+			call->PushArray(mouse, 2);
+		});
 	}
 
 	if (hasUsercmdsFwds)
 	{
-		m_usercmdsFwd->PushCell(client);
-		m_usercmdsFwd->PushCellByRef(&ucmd->buttons);
-		m_usercmdsFwd->PushCellByRef(&impulse);
-		m_usercmdsFwd->PushArray(vel, 3, SM_PARAM_COPYBACK);
-		m_usercmdsFwd->PushArray(angles, 3, SM_PARAM_COPYBACK);
-		m_usercmdsFwd->PushCellByRef(&ucmd->weaponselect);
-		m_usercmdsFwd->PushCellByRef(&ucmd->weaponsubtype);
-		m_usercmdsFwd->PushCellByRef(&ucmd->command_number);
-		m_usercmdsFwd->PushCellByRef(&ucmd->tick_count);
-		m_usercmdsFwd->PushCellByRef(&ucmd->random_seed);
-		m_usercmdsFwd->PushArray(mouse, 2, SM_PARAM_COPYBACK);
-		m_usercmdsFwd->Execute(&result);
+		result = CallRunCmd(RunCmdFwd_Main, [&](ICallable *call) {
+			call->PushCell(client);
+			call->PushCellByRef(&ucmd->buttons);
+			call->PushCellByRef(&impulse);
+			call->PushArray(vel, 3, SM_PARAM_COPYBACK);
+			call->PushArray(angles, 3, SM_PARAM_COPYBACK);
+			call->PushCellByRef(&ucmd->weaponselect);
+			call->PushCellByRef(&ucmd->weaponsubtype);
+			call->PushCellByRef(&ucmd->command_number);
+			call->PushCellByRef(&ucmd->tick_count);
+			call->PushCellByRef(&ucmd->random_seed);
+			call->PushArray(mouse, 2, SM_PARAM_COPYBACK);
+		});
 
 		ucmd->impulse = impulse;
 		ucmd->forwardmove = sp_ctof(vel[0]);
@@ -378,6 +528,11 @@ void CHookManager::PlayerRunCmd(CUserCmd *ucmd, IMoveHelper *moveHelper)
 		}
 	}
 
+	if (hasUsercmdsViewFwds && ExecuteUserCmdView(RunCmdFwd_View, client, ucmd, true) >= Pl_Handled)
+	{
+		RETURN_META(MRES_SUPERCEDE);
+	}
+
 	RETURN_META(MRES_IGNORED);
 }
 
@@ -388,7 +543,7 @@ void CHookManager::PlayerRunCmdPost(CUserCmd *ucmd, IMoveHelper *moveHelper)
 		RETURN_META(MRES_IGNORED);
 	}
 
-	if (m_usercmdsPostFwd->GetFunctionCount() == 0)
+	if (!GetRunCmdFunctionCount(RunCmdFwd_Post) && !GetRunCmdFunctionCount(RunCmdFwd_ViewPost))
 	{
 		RETURN_META(MRES_IGNORED);
 	}
@@ -408,26 +563,148 @@ void CHookManager::PlayerRunCmdPost(CUserCmd *ucmd, IMoveHelper *moveHelper)
 	}
 
 	int client = IndexOfEdict(pEdict);
+
+	UpdateRunCmdFilters(client, ucmd, true);
+
+	if (HasRunCmdListeners(RunCmdFwd_ViewPost))
+	{
+		ExecuteUserCmdView(RunCmdFwd_ViewPost, client, ucmd, false);
+	}
+
+	if (!HasRunCmdListeners(RunCmdFwd_Post))
+	{
+		RETURN_META(MRES_IGNORED);
+	}
+
 	cell_t vel[3] = { sp_ftoc(ucmd->forwardmove), sp_ftoc(ucmd->sidemove), sp_ftoc(ucmd->upmove) };
 	cell_t angles[3] = { sp_ftoc(ucmd->viewangles.x), sp_ftoc(ucmd->viewangles.y), sp_ftoc(ucmd->viewangles.z) };
 	cell_t mouse[2] = { ucmd->mousedx, ucmd->mousedy };
 
-	m_usercmdsPostFwd->PushCell(client);
-	m_usercmdsPostFwd->PushCell(ucmd->buttons);
-	m_usercmdsPostFwd->PushCell(ucmd->impulse);
-	m_usercmdsPostFwd->PushArray(vel, 3);
-	m_usercmdsPostFwd->PushArray(angles, 3);
-	m_usercmdsPostFwd->PushCell(ucmd->weaponselect);
-	m_usercmdsPostFwd->PushCell(ucmd->weaponsubtype);
-	m_usercmdsPostFwd->PushCell(ucmd->command_number);
-	m_usercmdsPostFwd->PushCell(ucmd->tick_count);
-	m_usercmdsPostFwd->PushCell(ucmd->random_seed);
-	m_usercmdsPostFwd->PushArray(mouse, 2);
-	m_usercmdsPostFwd->Execute();
+	CallRunCmd(RunCmdFwd_Post, [&](ICallable *call) {
+		call->PushCell(client);
+		call->PushCell(ucmd->buttons);
+		call->PushCell(ucmd->impulse);
+		call->PushArray(vel, 3);
+		call->PushArray(angles, 3);
+		call->PushCell(ucmd->weaponselect);
+		call->PushCell(ucmd->weaponsubtype);
+		call->PushCell(ucmd->command_number);
+		call->PushCell(ucmd->tick_count);
+		call->PushCell(ucmd->random_seed);
+		call->PushArray(mouse, 2);
+	});
 
 	RETURN_META(MRES_IGNORED);
 }
 
+cell_t CHookManager::ExecuteUserCmdView(RunCmdForwardType type, int client, CUserCmd *ucmd, bool writable)
+{
+	/* Save the outer view in case a callback runs another player's usercmd */
+	CUserCmd *pOldCmd = m_pViewCmd;
+	int oldClient = m_viewClient;
+	bool oldWritable = m_bViewWritable;
+
+	m_pViewCmd = ucmd;
+	m_viewClient = client;
+	m_bViewWritable = writable;
+
+	cell_t result = CallRunCmd(type, [client](ICallable *call) {
+		call->PushCell(client);
+		call->PushCell(client);
+	});
+
+	m_pViewCmd = pOldCmd;
+	m_viewClient = oldClient;
+	m_bViewWritable = oldWritable;
+
+	return result;
+}
+
+CUserCmd *CHookManager::GetUserCmdView(int client, bool *writable)
+{
+	if (m_pViewCmd == NULL || client != m_viewClient)
+	{
+		return NULL;
+	}
+
+	*writable = m_bViewWritable;
+	return m_pViewCmd;
+}
+
+static const char *s_RunCmdForwardNames[RunCmdFwd_Total] =
+{
+	"OnPlayerRunCmdPre",
+	"OnPlayerRunCmd",
+	"OnPlayerRunCmdPost",
+	"OnPlayerRunCmdView",
+	"OnPlayerRunCmdViewPost",
+};
+
+void CHookManager::AddRunCmdFunctions(IPlugin *plugin)
+{
+	/* Filtered plugins already hold their own functions */
+	if (GetRunCmdFilter(plugin, false))
+	{
+		return;
+	}
+
+	for (int i = 0; i < RunCmdFwd_Total; i++)
+	{
+		IPluginFunction *func = plugin->GetBaseContext()->GetFunctionByName(s_RunCmdForwardNames[i]);
+		if (func)
+		{
+			m_usercmdFwds[i]->AddFunction(func);
+		}
+	}
+}
+
+RunCmdFilter *CHookManager::GetRunCmdFilter(IPlugin *plugin, bool create)
+{
+	for (size_t i = 0; i < m_filteredPlugins.size(); i++)
+	{
+		if (m_filteredPlugins[i].plugin == plugin)
+		{
+			return &m_filteredPlugins[i].filter;
+		}
+	}
+
+	if (!create)
+	{
+		return NULL;
+	}
+
+	/* Move the plugin's functions out of the shared forwards so they are only called when the filter matches */
+	FilteredPlugin filtered;
+	filtered.plugin = plugin;
+	filtered.matched = false;
+	for (int i = 0; i < RunCmdFwd_Total; i++)
+	{
+		filtered.funcs[i] = plugin->GetBaseContext()->GetFunctionByName(s_RunCmdForwardNames[i]);
+		if (filtered.funcs[i])
+		{
+			m_usercmdFwds[i]->RemoveFunction(filtered.funcs[i]);
+		}
+	}
+
+	m_filteredPlugins.push_back(filtered);
+	return &m_filteredPlugins.back().filter;
+}
+
+void CHookManager::ClearRunCmdFilter(IPlugin *plugin)
+{
+	for (size_t i = 0; i < m_filteredPlugins.size(); i++)
+	{
+		if (m_filteredPlugins[i].plugin != plugin)
+		{
+			continue;
+		}
+
+		m_filteredPlugins.erase(m_filteredPlugins.begin() + i);
+		AddRunCmdFunctions(plugin);
+		return;
+	}
+}
+
 void CHookManager::NetChannelHook(int client)
 {
 	if (!FILE_used)
@@ -611,15 +888,17 @@ bool CHookManager::ProcessVoiceData(CLC_VoiceData *msg)
 
 void CHookManager::OnPluginLoaded(IPlugin *plugin)
 {
+	AddRunCmdFunctions(plugin);
+
 	if (PRCH_enabled)
 	{
 		bool changed = false;
-		if (!PRCH_used && ((m_usercmdsFwd->GetFunctionCount() > 0) || (m_usercmdsPreFwd->GetFunctionCount() > 0)))
+		if (!PRCH_used && (GetRunCmdFunctionCount(RunCmdFwd_Main) || GetRunCmdFunctionCount(RunCmdFwd_Pre) || GetRunCmdFunctionCount(RunCmdFwd_View)))
 		{
 			PRCH_used = true;
 			changed = true;
 		}
-		if (!PRCHPost_used && (m_usercmdsPostFwd->GetFunctionCount() > 0))
+		if (!PRCHPost_used && (GetRunCmdFunctionCount(RunCmdFwd_Post) || GetRunCmdFunctionCount(RunCmdFwd_ViewPost)))
 		{
 			PRCHPost_used = true;
 			changed = true;
@@ -672,7 +951,20 @@ void CHookManager::OnPluginLoaded(IPlugin *plugin)
 
 void CHookManager::OnPluginUnloaded(IPlugin *plugin)
 {
-	if (PRCH_used && (!m_usercmdsFwd->GetFunctionCount() && !m_usercmdsPreFwd->GetFunctionCount()))
+	for (size_t i = 0; i < m_filteredPlugins.size(); i++)
+	{
+		if (m_filteredPlugins[i].plugin == plugin)
+		{
+			m_filteredPlugins.erase(m_filteredPlugins.begin() + i);
+			break;
+		}
+	}
+	for (int i = 0; i < RunCmdFwd_Total; i++)
+	{
+		m_usercmdFwds[i]->RemoveFunctionsOfPlugin(plugin);
+	}
+
+	if (PRCH_used && (!GetRunCmdFunctionCount(RunCmdFwd_Main) && !GetRunCmdFunctionCount(RunCmdFwd_Pre) && !GetRunCmdFunctionCount(RunCmdFwd_View)))
 	{
 		for (size_t i = 0; i < m_runUserCmdHooks.size(); ++i)
 		{
@@ -683,7 +975,7 @@ void CHookManager::OnPluginUnloaded(IPlugin *plugin)
 		PRCH_used = false;
 	}
 
-	if (PRCHPost_used && !m_usercmdsPostFwd->GetFunctionCount())
+	if (PRCHPost_used && !GetRunCmdFunctionCount(RunCmdFwd_Post) && !GetRunCmdFunctionCount(RunCmdFwd_ViewPost))
 	{
 		for (size_t i = 0; i < m_runUserCmdPostHooks.size(); ++i)
 		{
@@ -723,3 +1015,163 @@ FeatureStatus CHookManager::GetFeatureStatus(FeatureType type, const char *name)
 {
 	return FeatureStatus_Available;
 }
+
+static CUserCmd *GetUserCmd(IPluginContext *pContext, cell_t client, bool write)
+{
+	bool writable;
+	CUserCmd *ucmd = g_Hooks.GetUserCmdView(client, &writable);
+	if (ucmd == NULL)
+	{
+		pContext->ReportError("UserCmd %d is not being processed", client);
+		return NULL;
+	}
+	if (write && !writable)
+	{
+		pContext->ReportError("UserCmd %d is read-only after it has been processed", client);
+		return NULL;
+	}
+	return ucmd;
+}
+
+/* Properties read and write straight through to the live CUserCmd, so only fields a plugin touches are marshalled */
+#define USERCMD_CELL_PROPERTY(name, field) \
+	static cell_t UserCmd_Get##name(IPluginContext *pContext, const cell_t *params) \
+	{ \
+		CUserCmd *ucmd = GetUserCmd(pContext, params[1], false); \
+		return ucmd ? static_cast<cell_t>(ucmd->field) : 0; \
+	} \
+	static cell_t UserCmd_Set##name(IPluginContext *pContext, const cell_t *params) \
+	{ \
+		CUserCmd *ucmd = GetUserCmd(pContext, params[1], true); \
+		if (ucmd) \
+			ucmd->field = params[2]; \
+		return 0; \
+	}
+
+#define USERCMD_FLOAT_PROPERTY(name, field) \
+	static cell_t UserCmd_Get##name(IPluginContext *pContext, const cell_t *params) \
+	{ \
+		CUserCmd *ucmd = GetUserCmd(pContext, params[1], false); \
+		return ucmd ? sp_ftoc(ucmd->field) : 0; \
+	} \
+	static cell_t UserCmd_Set##name(IPluginContext *pContext, const cell_t *params) \
+	{ \
+		CUserCmd *ucmd = GetUserCmd(pContext, params[1], true); \
+		if (ucmd) \
+			ucmd->field = sp_ctof(params[2]); \
+		return 0; \
+	}
+
+USERCMD_CELL_PROPERTY(Buttons, buttons)
+USERCMD_CELL_PROPERTY(Impulse, impulse)
+USERCMD_CELL_PROPERTY(Weapon, weaponselect)
+USERCMD_CELL_PROPERTY(Subtype, weaponsubtype)
+USERCMD_CELL_PROPERTY(CommandNumber, command_number)
+USERCMD_CELL_PROPERTY(TickCount, tick_count)
+USERCMD_CELL_PROPERTY(Seed, random_seed)
+USERCMD_CELL_PROPERTY(MouseX, mousedx)
+USERCMD_CELL_PROPERTY(MouseY, mousedy)
+USERCMD_FLOAT_PROPERTY(ForwardMove, forwardmove)
+USERCMD_FLOAT_PROPERTY(SideMove, sidemove)
+USERCMD_FLOAT_PROPERTY(UpMove, upmove)
+
+static cell_t UserCmd_GetViewAngles(IPluginContext *pContext, const cell_t *params)
+{
+	CUserCmd *ucmd = GetUserCmd(pContext, params[1], false);
+	if (!ucmd)
+	{
+		return 0;
+	}
+
+	cell_t *angles;
+	pContext->LocalToPhysAddr(params[2], &angles);
+	angles[0] = sp_ftoc(ucmd->viewangles.x);
+	angles[1] = sp_ftoc(ucmd->viewangles.y);
+	angles[2] = sp_ftoc(ucmd->viewangles.z);
+
+	return 1;
+}
+
+static cell_t UserCmd_SetViewAngles(IPluginContext *pContext, const cell_t *params)
+{
+	CUserCmd *ucmd = GetUserCmd(pContext, params[1], true);
+	if (!ucmd)
+	{
+		return 0;
+	}
+
+	cell_t *angles;
+	pContext->LocalToPhysAddr(params[2], &angles);
+	ucmd->viewangles.x = sp_ctof(angles[0]);
+	ucmd->viewangles.y = sp_ctof(angles[1]);
+	ucmd->viewangles.z = sp_ctof(angles[2]);
+
+	return 1;
+}
+
+static cell_t SetPlayerRunCmdFilter(IPluginContext *pContext, const cell_t *params)
+{
+	IPlugin *plugin = plsys->FindPluginByContext(pContext->GetContext());
+	RunCmdFilter *filter = g_Hooks.GetRunCmdFilter(plugin, true);
+	filter->flags = params[1];
+	filter->buttons = params[2];
+
+	return 1;
+}
+
+static cell_t SetPlayerRunCmdFilterClient(IPluginContext *pContext, const cell_t *params)
+{
+	int client = params[1];
+	if (client < 1 || client > SM_MAXPLAYERS)
+	{
+		return pContext->ThrowNativeError("Client index %d is invalid", client);
+	}
+
+	IPlugin *plugin = plsys->FindPluginByContext(pContext->GetContext());
+	RunCmdFilter *filter = g_Hooks.GetRunCmdFilter(plugin, true);
+	filter->clients.set(client, params[2] != 0);
+
+	return 1;
+}
+
+static cell_t ClearPlayerRunCmdFilter(IPluginContext *pContext, const cell_t *params)
+{
+	IPlugin *plugin = plsys->FindPluginByContext(pContext->GetContext());
+	g_Hooks.ClearRunCmdFilter(plugin);
+
+	return 1;
+}
+
+sp_nativeinfo_t g_UserCmdNatives[] =
+{
+	{"UserCmd.Buttons.get",			UserCmd_GetButtons},
+	{"UserCmd.Buttons.set",			UserCmd_SetButtons},
+	{"UserCmd.Impulse.get",			UserCmd_GetImpulse},
+	{"UserCmd.Impulse.set",			UserCmd_SetImpulse},
+	{"UserCmd.Weapon.get",			UserCmd_GetWeapon},
+	{"UserCmd.Weapon.set",			UserCmd_SetWeapon},
+	{"UserCmd.Subtype.get",			UserCmd_GetSubtype},
+	{"UserCmd.Subtype.set",			UserCmd_SetSubtype},
+	{"UserCmd.CommandNumber.get",	UserCmd_GetCommandNumber},
+	{"UserCmd.CommandNumber.set",	UserCmd_SetCommandNumber},
+	{"UserCmd.TickCount.get",		UserCmd_GetTickCount},
+	{"UserCmd.TickCount.set",		UserCmd_SetTickCount},
+	{"UserCmd.Seed.get",			UserCmd_GetSeed},
+	{"UserCmd.Seed.set",			UserCmd_SetSeed},
+	{"UserCmd.MouseX.get",			UserCmd_GetMouseX},
+	{"UserCmd.MouseX.set",			UserCmd_SetMouseX},
+	{"UserCmd.MouseY.get",			UserCmd_GetMouseY},
+	{"UserCmd.MouseY.set",			UserCmd_SetMouseY},
+	{"UserCmd.ForwardMove.get",		UserCmd_GetForwardMove},
+	{"UserCmd.ForwardMove.set",		UserCmd_SetForwardMove},
+	{"UserCmd.SideMove.get",		UserCmd_GetSideMove},
+	{"UserCmd.SideMove.set",		UserCmd_SetSideMove},
+	{"UserCmd.UpMove.get",			UserCmd_GetUpMove},
+	{"UserCmd.UpMove.set",			UserCmd_SetUpMove},
+	{"UserCmd.GetViewAngles",		UserCmd_GetViewAngles},
+	{"UserCmd.SetViewAngles",		UserCmd_SetViewAngles},
+	{"SetPlayerRunCmdFilter",		SetPlayerRunCmdFilter},
+	{"SetPlayerRunCmdFilterClient",	SetPlayerRunCmdFilterClient},
+	{"ClearPlayerRunCmdFilter",		ClearPlayerRunCmdFilter},
+	{NULL,							NULL},
+};
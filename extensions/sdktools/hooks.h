@@ -39,6 +39,33 @@ class CUserCmd;
 #include "inetchannel.h"
 #include "iclient.h"
 #include "vtable_hook_helper.h"
+#include <bitset>
+
+enum RunCmdForwardType
+{
+	RunCmdFwd_Pre,
+	RunCmdFwd_Main,
+	RunCmdFwd_Post,
+	RunCmdFwd_View,
+	RunCmdFwd_ViewPost,
+	RunCmdFwd_Total
+};
+
+/* Must match the RunCmdFilter_* flags in sdktools_hooks.inc */
+#define RUNCMDFILTER_CLIENTS		(1<<0)
+#define RUNCMDFILTER_BOTS			(1<<1)
+#define RUNCMDFILTER_HUMANS			(1<<2)
+#define RUNCMDFILTER_BUTTONCHANGE	(1<<3)
+#define RUNCMDFILTER_IMPULSE		(1<<4)
+
+struct RunCmdFilter
+{
+	int flags = 0;
+	int buttons = 0;
+	std::bitset<SM_MAXPLAYERS+1> clients;
+
+	bool Matches(int client, bool fakeClient, int changedButtons, int impulse) const;
+};
 
 class CHookManager : IPluginsListener, IFeatureProvider
 {
@@ -54,6 +81,11 @@ public:
 	void PlayerRunCmd(CUserCmd *ucmd, IMoveHelper *moveHelper);
 	void PlayerRunCmdPost(CUserCmd *ucmd, IMoveHelper *moveHelper);
 	void OnMapStart();
+public: /* UserCmd views */
+	CUserCmd *GetUserCmdView(int client, bool *writable);
+public: /* Per-plugin usercmd filters */
+	RunCmdFilter *GetRunCmdFilter(IPlugin *plugin, bool create);
+	void ClearRunCmdFilter(IPlugin *plugin);
 public: /* NetChannel/Related Hooks */
 	bool FileExists(const char *filename, const char *pathID);
 #if (SOURCE_ENGINE >= SE_ALIENSWARM || SOURCE_ENGINE == SE_LEFT4DEAD || SOURCE_ENGINE == SE_LEFT4DEAD2)
@@ -75,11 +107,26 @@ public: //IFeatureProvider
 private:
 	void PlayerRunCmdHook(int client, bool post);
 	void NetChannelHook(int client);
+	cell_t ExecuteUserCmdView(RunCmdForwardType type, int client, CUserCmd *ucmd, bool writable);
+	void AddRunCmdFunctions(IPlugin *plugin);
+	unsigned int GetRunCmdFunctionCount(RunCmdForwardType type);
+	bool HasRunCmdListeners(RunCmdForwardType type);
+	void UpdateRunCmdFilters(int client, CUserCmd *ucmd, bool post);
+	template <typename PushParams>
+	cell_t CallRunCmd(RunCmdForwardType type, PushParams push);
 
 private:
-	IForward *m_usercmdsPreFwd;
-	IForward *m_usercmdsFwd;
-	IForward *m_usercmdsPostFwd;
+	/* Plugins with a filter are called individually instead of through these */
+	IChangeableForward *m_usercmdFwds[RunCmdFwd_Total];
+	struct FilteredPlugin
+	{
+		IPlugin *plugin;
+		IPluginFunction *funcs[RunCmdFwd_Total];
+		RunCmdFilter filter;
+		bool matched;
+	};
+	std::vector<FilteredPlugin> m_filteredPlugins;
+	int m_lastButtons[2][SM_MAXPLAYERS+1];
 	IForward *m_netFileSendFwd;
 	IForward *m_netFileReceiveFwd;
 	std::vector<CVTableHook *> m_runUserCmdHooks;
@@ -90,8 +137,12 @@ private:
 #endif
 	INetChannel *m_pActiveNetChannel;
 	bool m_bFSTranHookWarned = false;
+	CUserCmd *m_pViewCmd = NULL;
+	int m_viewClient = 0;
+	bool m_bViewWritable = false;
 };
 
 extern CHookManager g_Hooks;
+extern sp_nativeinfo_t g_UserCmdNatives[];
 
 #endif // _INCLUDE_HOOKS_H_
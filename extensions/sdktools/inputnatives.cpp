@@ -44,14 +44,15 @@ ICallWrapper *g_pAcceptInput = NULL;
 	}
 
 
-static cell_t AcceptEntityInput(IPluginContext *pContext, const cell_t *params)
+static bool InitAcceptInput(IPluginContext *pContext)
 {
 	if (!g_pAcceptInput)
 	{
 		int offset;
 		if (!g_pGameConf->GetOffset("AcceptInput", &offset))
 		{
-			return pContext->ThrowNativeError("\"AcceptEntityInput\" not supported by this mod");
+			pContext->ThrowNativeError("\"AcceptEntityInput\" not supported by this mod");
+			return false;
 		}
 
 		PassInfo pass[6];
@@ -74,39 +75,94 @@ static cell_t AcceptEntityInput(IPluginContext *pContext, const cell_t *params)
 		if (!(g_pAcceptInput=g_pBinTools->CreateVCall(offset, 0, 0, &pass[5], pass, 5)))
 		{
 			pContext->ThrowNativeError("\"AcceptEntityInput\" wrapper failed to initialized");
+			return false;
 		}
 	}
 
+	return true;
+}
+
+/* Shared by AcceptEntityInput and its inline value variants. params[1] and params[2]
+ * are the destination and input, |first| is the index of the activator param.
+ */
+static cell_t InternalAcceptInput(IPluginContext *pContext, const cell_t *params, int first, variant_t &value)
+{
+	if (!InitAcceptInput(pContext))
+	{
+		return 0;
+	}
+
 	CBaseEntity *pActivator, *pCaller, *pDest;
 
 	char *inputname;
 	ENTINDEX_TO_CBASEENTITY(params[1], pDest);
 	pContext->LocalToString(params[2], &inputname);
-	if (params[3] == -1)
+	if (params[first] == -1)
 	{
 		pActivator = NULL;
 	} else {
-		ENTINDEX_TO_CBASEENTITY(params[3], pActivator);
+		ENTINDEX_TO_CBASEENTITY(params[first], pActivator);
 	}
-	if (params[4] == -1)
+	if (params[first + 1] == -1)
 	{
 		pCaller = NULL;
 	} else {
-		ENTINDEX_TO_CBASEENTITY(params[4], pCaller);
+		ENTINDEX_TO_CBASEENTITY(params[first + 1], pCaller);
 	}
 
-	ArgBuffer<void*, const char*, CBaseEntity*, CBaseEntity*, decltype(g_Variant_t), int> vstk(pDest, inputname, pActivator, pCaller, g_Variant_t, params[5]);
+	ArgBuffer<void*, const char*, CBaseEntity*, CBaseEntity*, variant_t, int> vstk(pDest, inputname, pActivator, pCaller, value, params[first + 2]);
 
 	bool ret = false;
 	g_pAcceptInput->Execute(vstk, &ret);
 
+	return (ret) ? 1 : 0;
+}
+
+static cell_t AcceptEntityInput(IPluginContext *pContext, const cell_t *params)
+{
+	cell_t ret = InternalAcceptInput(pContext, params, 3, g_Variant_t);
+
 	_init_variant_t();
 
-	return (ret) ? 1 : 0;
+	return ret;
+}
+
+static cell_t AcceptEntityInputInt(IPluginContext *pContext, const cell_t *params)
+{
+	variant_t value;
+	memset(&value, 0, sizeof(value));
+	value.SetInt(params[3]);
+
+	return InternalAcceptInput(pContext, params, 4, value);
+}
+
+static cell_t AcceptEntityInputFloat(IPluginContext *pContext, const cell_t *params)
+{
+	variant_t value;
+	memset(&value, 0, sizeof(value));
+	value.SetFloat(sp_ctof(params[3]));
+
+	return InternalAcceptInput(pContext, params, 4, value);
+}
+
+static cell_t AcceptEntityInputString(IPluginContext *pContext, const cell_t *params)
+{
+	char *str;
+	pContext->LocalToString(params[3], &str);
+
+	/* Inputs may keep the string_t, so this shares SetVariantString's buffer */
+	variant_t value;
+	memset(&value, 0, sizeof(value));
+	value.SetString(MAKE_STRING(SetVariantStringValue(str)));
+
+	return InternalAcceptInput(pContext, params, 4, value);
 }
 
 sp_nativeinfo_t g_EntInputNatives[] =
 {
 	{"AcceptEntityInput",			AcceptEntityInput},
+	{"AcceptEntityInputInt",		AcceptEntityInputInt},
+	{"AcceptEntityInputFloat",		AcceptEntityInputFloat},
+	{"AcceptEntityInputString",		AcceptEntityInputString},
 	{NULL,							NULL},
 };
@@ -66,6 +66,7 @@ void EntityOutputManager::Init()
 	}
 
 	ClassNames = adtfactory->CreateBasicTrie();
+	OutputFields.init();
 }
 
 bool EntityOutputManager::IsEnabled()
@@ -118,6 +119,12 @@ bool EntityOutputManager::FireEventDetour(void *pOutput, CBaseEntity *pActivator
 		return true;
 	}
 
+	// Most outputs fire on classes nobody hooks, so skip the output lookup for those
+	if (!IsClassHooked(pCaller) && (!pActivator || !IsClassHooked(pActivator)))
+	{
+		return true;
+	}
+
 	// attempt to directly lookup a hook using the pOutput pointer
 	OutputNameStruct *pOutputName = NULL;
 
@@ -341,6 +348,59 @@ OutputNameStruct *EntityOutputManager::FindOutputPointer(const char *classname,
 	return pOutputName;
 }
 
+bool EntityOutputManager::IsClassHooked(CBaseEntity *pEntity)
+{
+	const char *classname = gamehelpers->GetEntityClassname(pEntity);
+	if (!classname)
+	{
+		return false;
+	}
+
+	ClassNameStruct *pClassname;
+	return ClassNames->Retrieve(classname, (void **)&pClassname);
+}
+
+// Look for an output field on pEntity with the same address as pOutput. Hits are cached by datamap and
+// offset, which do not change for the lifetime of the server binary. Misses are not cached, since the
+// offset of an output that lives on another entity is meaningless.
+const char *EntityOutputManager::FindOutputField(CBaseEntity *pEntity, void *pOutput)
+{
+	datamap_t *pRootMap = gamehelpers->GetDataMap(pEntity);
+	if (!pRootMap)
+	{
+		return NULL;
+	}
+
+	OutputFieldKey key = { pRootMap, (intptr_t)((char *)pOutput - (char *)pEntity) };
+	OutputFieldMap::Result r = OutputFields.find(key);
+	if (r.found())
+	{
+		return r->value;
+	}
+
+	for (datamap_t *pMap = pRootMap; pMap; pMap = pMap->baseMap)
+	{
+		for (int i=0; i<pMap->dataNumFields; i++)
+		{
+			if ((pMap->dataDesc[i].flags & FTYPEDESC_OUTPUT)
+				&& GetTypeDescOffs(&pMap->dataDesc[i]) == key.offset)
+			{
+				const char *name = pMap->dataDesc[i].externalName;
+
+				OutputFieldMap::Insert ins = OutputFields.findForAdd(key);
+				if (!ins.found())
+				{
+					OutputFields.add(ins, key, name);
+				}
+
+				return name;
+			}
+		}
+	}
+
+	return NULL;
+}
+
 // Iterate the datamap of pCaller/pActivator and look for output pointers with the same address as pOutput.
 // Store the classname of the entity we found the output on in |entity_classname| if provided.
 //
@@ -351,26 +411,15 @@ OutputNameStruct *EntityOutputManager::FindOutputPointer(const char *classname,
 //       least one of the caller or activator entity.
 const char *EntityOutputManager::FindOutputName(void *pOutput, CBaseEntity *pActivator, CBaseEntity *pCaller, const char **entity_classname)
 {
-	datamap_t *pMap = gamehelpers->GetDataMap(pCaller);
-
-	while (pMap)
+	const char *name = FindOutputField(pCaller, pOutput);
+	if (name)
 	{
-		for (int i=0; i<pMap->dataNumFields; i++)
+		if (entity_classname)
 		{
-			if (pMap->dataDesc[i].flags & FTYPEDESC_OUTPUT)
-			{
-				if ((char *)pCaller + GetTypeDescOffs(&pMap->dataDesc[i]) == pOutput)
-				{
-					if (entity_classname)
-					{
-						*entity_classname = gamehelpers->GetEntityClassname(pCaller);
-					}
-
-					return pMap->dataDesc[i].externalName;
-				}
-			}
+			*entity_classname = gamehelpers->GetEntityClassname(pCaller);
 		}
-		pMap = pMap->baseMap;
+
+		return name;
 	}
 
 	// HACK: Generally, the game passes the entity that triggered the output as pCaller, but occasionally (because the
@@ -378,26 +427,15 @@ const char *EntityOutputManager::FindOutputName(void *pOutput, CBaseEntity *pAct
 	//       pActivator looking for the output if we couldn't find it on pCaller.
 	if (pActivator)
 	{
-		pMap = gamehelpers->GetDataMap(pActivator);
-
-		while (pMap)
+		name = FindOutputField(pActivator, pOutput);
+		if (name)
 		{
-			for (int i=0; i<pMap->dataNumFields; i++)
+			if (entity_classname)
 			{
-				if (pMap->dataDesc[i].flags & FTYPEDESC_OUTPUT)
-				{
-					if ((char *)pActivator + GetTypeDescOffs(&pMap->dataDesc[i]) == pOutput)
-					{
-						if (entity_classname)
-						{
-							*entity_classname = gamehelpers->GetEntityClassname(pActivator);
-						}
-
-						return pMap->dataDesc[i].externalName;
-					}
-				}
+				*entity_classname = gamehelpers->GetEntityClassname(pActivator);
 			}
-			pMap = pMap->baseMap;
+
+			return name;
 		}
 	}
 
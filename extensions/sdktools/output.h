@@ -37,6 +37,7 @@
 #include "sh_list.h"
 #include "sh_stack.h"
 #include "sm_trie_tpl.h"
+#include <am-hashmap.h>
 #include "CDetour/detours.h"
 
 extern ISourcePawnEngine *spengine;
@@ -86,6 +87,27 @@ struct ClassNameStruct
 	}
 };
 
+/**
+ * Identifies an output field by the entity's datamap and the field's offset
+ */
+struct OutputFieldKey
+{
+	datamap_t *map;
+	intptr_t offset;
+};
+
+struct OutputFieldPolicy
+{
+	static inline uint32_t hash(const OutputFieldKey &key)
+	{
+		return ke::HashPointer(key.map) ^ ke::HashInteger<sizeof(intptr_t)>(key.offset);
+	}
+	static inline bool matches(const OutputFieldKey &find, const OutputFieldKey &key)
+	{
+		return find.map == key.map && find.offset == key.offset;
+	}
+};
+
 class EntityOutputManager : public IPluginsListener
 {
 public:
@@ -120,10 +142,16 @@ private:
 	void DeleteFireEventDetour();
 
 	const char *FindOutputName(void *pOutput, CBaseEntity *pActivator, CBaseEntity *pCaller, const char **entity_classname);
+	const char *FindOutputField(CBaseEntity *pEntity, void *pOutput);
+	bool IsClassHooked(CBaseEntity *pEntity);
 
 	// Maps classname to a ClassNameStruct
 	IBasicTrie *ClassNames;
 
+	// Maps a datamap and field offset to the output's name, filled in as outputs fire
+	typedef ke::HashMap<OutputFieldKey, const char *, OutputFieldPolicy> OutputFieldMap;
+	OutputFieldMap OutputFields;
+
 	SourceHook::CStack<omg_hooks *> FreeHooks; //Stores hook pointers to avoid calls to new
 
 	int HookCount;
@@ -117,21 +117,61 @@ bool TempEntityInfo::IsValidProp(const char *name)
 
 int TempEntityInfo::_FindOffset(const char *name, int *size)
 {
-	int offset;
-
-	sm_sendprop_info_t info;
-	if (!g_pGameHelpers->FindSendPropInfo(m_Sc->GetName(), name, &info))
+	/* Props are looked up by name on every write, so remember the results. */
+	TEPropInfo prop;
+	if (!m_PropCache.retrieve(name, &prop))
 	{
-		return -1;
+		sm_sendprop_info_t info;
+		if (!g_pGameHelpers->FindSendPropInfo(m_Sc->GetName(), name, &info))
+		{
+			return -1;
+		}
+
+		prop.offset = info.actual_offset;
+		prop.bits = info.prop->m_nBits;
+		m_PropCache.insert(name, prop);
 	}
 
-	offset = info.actual_offset;
 	if (size)
 	{
-		*size = info.prop->m_nBits;
+		*size = prop.bits;
+	}
+
+	return prop.offset;
+}
+
+void TempEntityInfo::_MarkWritten(int offset, int size)
+{
+	TEPropRange range;
+	range.offset = offset;
+	range.size = size;
+	m_Written.push_back(range);
+}
+
+void TempEntityInfo::ClearWrittenProps()
+{
+	m_Written.clear();
+}
+
+void TempEntityInfo::SaveWrittenProps(std::vector<TEPropRange> &ranges, std::vector<uint8_t> &data)
+{
+	for (size_t i = 0; i < m_Written.size(); i++)
+	{
+		const TEPropRange &range = m_Written[i];
+		const uint8_t *src = (uint8_t *)m_Me + range.offset;
+
+		ranges.push_back(range);
+		data.insert(data.end(), src, src + range.size);
 	}
+}
 
-	return offset;
+void TempEntityInfo::RestoreProps(const TEPropRange *ranges, size_t numRanges, const uint8_t *data)
+{
+	for (size_t i = 0; i < numRanges; i++)
+	{
+		memcpy((uint8_t *)m_Me + ranges[i].offset, data, ranges[i].size);
+		data += ranges[i].size;
+	}
 }
 
 bool TempEntityInfo::TE_SetEntData(const char *name, int value)
@@ -148,10 +188,13 @@ bool TempEntityInfo::TE_SetEntData(const char *name, int value)
 	if (size <= 8)
 	{
 		*((uint8_t *)m_Me + offset) = value;
+		_MarkWritten(offset, sizeof(uint8_t));
 	} else if (size <= 16) {
 		*(short *)((uint8_t *)m_Me + offset) = value;
+		_MarkWritten(offset, sizeof(short));
 	} else if (size <= 32) {
 		*(int *)((uint8_t *)m_Me + offset) = value;
+		_MarkWritten(offset, sizeof(int));
 	} else {
 		return false;
 	}
@@ -196,6 +239,7 @@ bool TempEntityInfo::TE_SetEntDataEnt(const char *name, IHandleEntity *value)
 
 	auto *pHndl = (CBaseHandle *)((uint8_t *)m_Me + offset);
 	pHndl->Set(value);
+	_MarkWritten(offset, sizeof(CBaseHandle));
 
 	return true;
 }
@@ -232,6 +276,7 @@ bool TempEntityInfo::TE_SetEntDataFloat(const char *name, float value)
 	}
 
 	*(float *)((uint8_t *)m_Me + offset) = value;
+	_MarkWritten(offset, sizeof(float));
 
 	return true;
 }
@@ -265,6 +310,7 @@ bool TempEntityInfo::TE_SetEntDataVector(const char *name, float vector[3])
 	v->x = vector[0];
 	v->y = vector[1];
 	v->z = vector[2];
+	_MarkWritten(offset, sizeof(Vector));
 
 	return true;
 }
@@ -302,6 +348,7 @@ bool TempEntityInfo::TE_SetEntDataFloatArray(const char *name, cell_t *array, in
 	{
 		base[i] = sp_ctof(array[i]);
 	}
+	_MarkWritten(offset, size * sizeof(float));
 
 	return true;
 }
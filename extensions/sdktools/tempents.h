@@ -37,6 +37,19 @@
 #include <sh_list.h>
 #include <sh_string.h>
 #include <stdio.h>
+#include <vector>
+
+struct TEPropInfo
+{
+	int offset;
+	int bits;
+};
+
+struct TEPropRange
+{
+	int offset;
+	int size;
+};
 
 class TempEntityInfo
 {
@@ -56,12 +69,18 @@ public:
 	bool TE_GetEntDataFloat(const char *name, float *value);
 	bool TE_GetEntDataVector(const char *name, float vector[3]);
 	void Send(IRecipientFilter &filter, float delay);
+	void ClearWrittenProps();
+	void SaveWrittenProps(std::vector<TEPropRange> &ranges, std::vector<uint8_t> &data);
+	void RestoreProps(const TEPropRange *ranges, size_t numRanges, const uint8_t *data);
 private:
 	int _FindOffset(const char *name, int *size=NULL);
+	void _MarkWritten(int offset, int size);
 private:
 	void *m_Me;
 	ServerClass *m_Sc;
 	SourceHook::String m_Name;
+	StringHashMap<TEPropInfo> m_PropCache;
+	std::vector<TEPropRange> m_Written;
 };
 
 class TempEntityManager
@@ -40,6 +40,66 @@ TempEntityInfo *g_CurrentTE = NULL;
 int g_TEPlayers[SM_MAXPLAYERS+1];
 bool tenatives_initialized = false;
 
+struct QueuedTempEnt
+{
+	TempEntityInfo *te;
+	size_t firstRange;
+	size_t numRanges;
+	size_t dataOffset;
+	size_t firstClient;
+	size_t numClients;
+	float delay;
+};
+
+/* Queued temp entities share flat buffers so a steady stream of them does not allocate. */
+static std::vector<QueuedTempEnt> s_TEQueue;
+static std::vector<TEPropRange> s_TEQueueRanges;
+static std::vector<uint8_t> s_TEQueueData;
+static std::vector<cell_t> s_TEQueueClients;
+static bool s_TEQueueHooked = false;
+
+static void FlushTempEntQueue(bool simulating)
+{
+	cell_t clients[SM_MAXPLAYERS];
+
+	/* Sending can run temp entity hooks that queue more, so index instead of iterating. */
+	for (size_t i = 0; i < s_TEQueue.size(); i++)
+	{
+		QueuedTempEnt queued = s_TEQueue[i];
+
+		int count = 0;
+		for (size_t j = 0; j < queued.numClients; j++)
+		{
+			cell_t client = s_TEQueueClients[queued.firstClient + j];
+			if (playerhelpers->GetClientStateFlags(client) & ClientState_InGame)
+			{
+				clients[count++] = client;
+			}
+		}
+
+		if (!count)
+		{
+			continue;
+		}
+
+		queued.te->RestoreProps(s_TEQueueRanges.data() + queued.firstRange,
+			queued.numRanges,
+			s_TEQueueData.data() + queued.dataOffset);
+
+		g_TERecFilter.Reset();
+		g_TERecFilter.Initialize(clients, count);
+		queued.te->Send(g_TERecFilter, queued.delay);
+	}
+
+	s_TEQueue.clear();
+	s_TEQueueRanges.clear();
+	s_TEQueueData.clear();
+	s_TEQueueClients.clear();
+
+	g_pSM->RemoveGameFrameHook(FlushTempEntQueue);
+	s_TEQueueHooked = false;
+}
+
 /*************************
 *                        *
 * Temp Entity Hook Class *
@@ -61,6 +121,12 @@ void TempEntHooks::Shutdown()
 	}
 
 	plsys->RemovePluginsListener(this);
+	if (s_TEQueueHooked)
+	{
+		g_pSM->RemoveGameFrameHook(FlushTempEntQueue);
+		s_TEQueueHooked = false;
+	}
+	s_TEQueue.clear();
 	SourceHook::List<TEHookInfo *>::iterator iter;
 	for (iter=m_HookInfo.begin(); iter!=m_HookInfo.end(); iter++)
 	{
@@ -212,6 +278,7 @@ void TempEntHooks::OnPlaybackTempEntity(IRecipientFilter &filter, float delay, c
 
 		TempEntityInfo *oldinfo = g_CurrentTE;
 		g_CurrentTE = pInfo->te;
+		g_CurrentTE->ClearWrittenProps();
 		size = _FillInPlayers(g_TEPlayers, &filter);
 
 		for (iter=pInfo->lst.begin(); iter!=pInfo->lst.end(); iter++)
@@ -258,6 +325,7 @@ static cell_t smn_TEStart(IPluginContext *pContext, const cell_t *params)
 	{
 		return pContext->ThrowNativeError("Invalid TempEntity name: \"%s\"", name);
 	}
+	g_CurrentTE->ClearWrittenProps();
 
 	return 1;
 }
@@ -526,6 +594,63 @@ static cell_t smn_TESend(IPluginContext *pContext, const cell_t *params)
 	return 1;
 }
 
+static cell_t smn_TEQueue(IPluginContext *pContext, const cell_t *params)
+{
+	if (!g_TEManager.IsAvailable())
+	{
+		return pContext->ThrowNativeError("TempEntity System unsupported or not available, file a bug report");
+	}
+	if (!g_CurrentTE)
+	{
+		return pContext->ThrowNativeError("No TempEntity call is in progress");
+	}
+
+	cell_t *cl_array;
+	unsigned int numClients;
+	int client;
+	IGamePlayer *pPlayer = NULL;
+
+	pContext->LocalToPhysAddr(params[1], &cl_array);
+	numClients = params[2];
+
+	/* Client validation */
+	for (unsigned int i = 0; i < numClients; i++)
+	{
+		client = cl_array[i];
+		pPlayer = playerhelpers->GetGamePlayer(client);
+
+		if (!pPlayer)
+		{
+			return pContext->ThrowNativeError("Client index %d is invalid", client);
+		} else if (!pPlayer->IsInGame()) {
+			return pContext->ThrowNativeError("Client %d is not in game", client);
+		}
+	}
+
+	QueuedTempEnt queued;
+	queued.te = g_CurrentTE;
+	queued.firstRange = s_TEQueueRanges.size();
+	queued.dataOffset = s_TEQueueData.size();
+	queued.firstClient = s_TEQueueClients.size();
+	queued.numClients = numClients;
+	queued.delay = sp_ctof(params[3]);
+
+	g_CurrentTE->SaveWrittenProps(s_TEQueueRanges, s_TEQueueData);
+	queued.numRanges = s_TEQueueRanges.size() - queued.firstRange;
+	s_TEQueueClients.insert(s_TEQueueClients.end(), cl_array, cl_array + numClients);
+	s_TEQueue.push_back(queued);
+
+	if (!s_TEQueueHooked)
+	{
+		g_pSM->AddGameFrameHook(FlushTempEntQueue);
+		s_TEQueueHooked = true;
+	}
+
+	g_CurrentTE = NULL;
+
+	return 1;
+}
+
 static cell_t smn_TEIsValidProp(IPluginContext *pContext, const cell_t *params)
 {
 	if (!g_TEManager.IsAvailable())
@@ -606,6 +731,7 @@ sp_nativeinfo_t g_TENatives[] =
 	{"TE_ReadVector",			smn_TEReadVector},
 	{"TE_WriteAngles",			smn_TEWriteVector},
 	{"TE_Send",					smn_TESend},
+	{"TE_Queue",				smn_TEQueue},
 	{"TE_IsValidProp",			smn_TEIsValidProp},
 	{"TE_WriteFloatArray",		smn_TEWriteFloatArray},
 	{"AddTempEntHook",			smn_AddTempEntHook},
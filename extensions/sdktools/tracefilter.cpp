@@ -0,0 +1,179 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod SDKTools Extension
+ * Copyright (C) 2004-2010 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#include "tracefilter.h"
+
+HandleType_t g_TraceFilterHandle = 0;
+
+CBaseEntity *GetTraceEntity(IHandleEntity *pHandleEntity)
+{
+	/* Static props are handle entities too, and their handles can alias a real entity index */
+	const CBaseHandle &hndl = pHandleEntity->GetRefEHandle();
+	if (!hndl.IsValid())
+	{
+		return NULL;
+	}
+
+	CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(hndl.GetEntryIndex());
+	if (!pEntity || reinterpret_cast<IHandleEntity *>(pEntity)->GetRefEHandle() != hndl)
+	{
+		return NULL;
+	}
+
+	return pEntity;
+}
+
+/* Entity fields are CBaseEntity members, so one lookup serves every entity */
+static int GetEntityField(CBaseEntity *pEntity, const char *field, int &offset)
+{
+	if (offset == 0)
+	{
+		sm_datatable_info_t info;
+		datamap_t *pMap = gamehelpers->GetDataMap(pEntity);
+		if (pMap && gamehelpers->FindDataMapInfo(pMap, field, &info))
+		{
+			offset = info.actual_offset;
+		}
+		else
+		{
+			offset = -1;
+		}
+	}
+
+	if (offset == -1)
+	{
+		return -1;
+	}
+
+	return *(int *)((uint8_t *)pEntity + offset);
+}
+
+CSMNativeTraceFilter::CSMNativeTraceFilter() : m_TraceType(TRACE_EVERYTHING)
+{
+}
+
+void CSMNativeTraceFilter::AddRule(TraceFilterRuleType type, bool exclude, cell_t value, const char *prefix)
+{
+	Rule rule;
+	rule.type = type;
+	rule.exclude = exclude;
+	rule.value = (type == TraceFilterRule_Entity) ? gamehelpers->ReferenceToBCompatRef(value) : value;
+	rule.prefix = prefix;
+
+	m_Rules.push_back(rule);
+}
+
+void CSMNativeTraceFilter::Merge(const CSMNativeTraceFilter &other)
+{
+	m_Rules.insert(m_Rules.end(), other.m_Rules.begin(), other.m_Rules.end());
+}
+
+void CSMNativeTraceFilter::SetTraceType(TraceType_t traceType)
+{
+	m_TraceType = traceType;
+}
+
+TraceType_t CSMNativeTraceFilter::GetTraceType() const
+{
+	return m_TraceType;
+}
+
+bool CSMNativeTraceFilter::Matches(const Rule &rule, CBaseEntity *pEntity) const
+{
+	static int s_TeamOffset = 0;
+	static int s_CollisionGroupOffset = 0;
+
+	/* Nothing that isn't an entity can match a rule */
+	if (!pEntity)
+	{
+		return false;
+	}
+
+	switch (rule.type)
+	{
+	case TraceFilterRule_Entity:
+		return gamehelpers->EntityToBCompatRef(pEntity) == rule.value;
+	case TraceFilterRule_Team:
+		return GetEntityField(pEntity, "m_iTeamNum", s_TeamOffset) == rule.value;
+	case TraceFilterRule_Classname:
+		{
+			const char *classname = gamehelpers->GetEntityClassname(pEntity);
+			return classname && strncmp(classname, rule.prefix.c_str(), rule.prefix.size()) == 0;
+		}
+	case TraceFilterRule_CollisionGroup:
+		return GetEntityField(pEntity, "m_CollisionGroup", s_CollisionGroupOffset) == rule.value;
+	case TraceFilterRule_Player:
+		{
+			int index = gamehelpers->EntityToBCompatRef(pEntity);
+			return index >= 1 && index <= playerhelpers->GetMaxClients();
+		}
+	default:
+		return false;
+	}
+}
+
+bool CSMNativeTraceFilter::ShouldHitEntity(IHandleEntity *pHandleEntity, int contentsMask)
+{
+	CBaseEntity *pEntity = GetTraceEntity(pHandleEntity);
+	bool hasInclude[TraceFilterRule_MAX] = {false};
+	bool included[TraceFilterRule_MAX] = {false};
+
+	for (size_t i = 0; i < m_Rules.size(); i++)
+	{
+		const Rule &rule = m_Rules[i];
+		if (rule.exclude)
+		{
+			if (Matches(rule, pEntity))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			hasInclude[rule.type] = true;
+			if (!included[rule.type] && Matches(rule, pEntity))
+			{
+				included[rule.type] = true;
+			}
+		}
+	}
+
+	for (int type = 0; type < TraceFilterRule_MAX; type++)
+	{
+		if (hasInclude[type] && !included[type])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,88 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod SDKTools Extension
+ * Copyright (C) 2004-2010 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#ifndef _INCLUDE_SOURCEMOD_SDKTOOLS_TRACEFILTER_H_
+#define _INCLUDE_SOURCEMOD_SDKTOOLS_TRACEFILTER_H_
+
+#include "extension.h"
+#include <string>
+#include <vector>
+
+/* Must match TraceFilterRule in sdktools_trace.inc */
+enum TraceFilterRuleType
+{
+	TraceFilterRule_Entity,
+	TraceFilterRule_Team,
+	TraceFilterRule_Classname,
+	TraceFilterRule_CollisionGroup,
+	TraceFilterRule_Player,
+	TraceFilterRule_MAX
+};
+
+/**
+ * Declarative trace filter evaluated entirely in C++.
+ *
+ * Rules of the same type that include entities form an allow list: an entity
+ * must match at least one of them. An entity matching any excluding rule is
+ * never hit. Rules of different types must all be satisfied.
+ */
+class CSMNativeTraceFilter : public ITraceFilter
+{
+public:
+	CSMNativeTraceFilter();
+public:
+	void AddRule(TraceFilterRuleType type, bool exclude, cell_t value, const char *prefix = "");
+	void Merge(const CSMNativeTraceFilter &other);
+	void SetTraceType(TraceType_t traceType);
+public: // ITraceFilter
+	bool ShouldHitEntity(IHandleEntity *pHandleEntity, int contentsMask);
+	TraceType_t GetTraceType() const;
+private:
+	struct Rule
+	{
+		TraceFilterRuleType type;
+		bool exclude;
+		cell_t value;
+		std::string prefix;
+	};
+	bool Matches(const Rule &rule, CBaseEntity *pEntity) const;
+private:
+	std::vector<Rule> m_Rules;
+	TraceType_t m_TraceType;
+};
+
+extern HandleType_t g_TraceFilterHandle;
+
+/* Returns the entity behind a traced handle, or NULL for non-entities such as static props */
+CBaseEntity *GetTraceEntity(IHandleEntity *pHandleEntity);
+
+#endif // _INCLUDE_SOURCEMOD_SDKTOOLS_TRACEFILTER_H_
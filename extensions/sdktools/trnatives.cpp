@@ -30,6 +30,7 @@
  */
 
 #include "extension.h"
+#include "tracefilter.h"
 #include <worldsize.h>
 
 class sm_trace_t : public trace_t
@@ -117,6 +118,44 @@ private:
 	cell_t m_Data;
 };
 
+/* Trace result handles are recycled rather than allocated per trace */
+#define TRACE_RESULT_POOL_SIZE	64
+
+static std::vector<sm_trace_t *> s_TraceResultPool;
+
+static sm_trace_t *AllocTraceResult()
+{
+	if (s_TraceResultPool.empty())
+	{
+		return new sm_trace_t;
+	}
+
+	sm_trace_t *tr = s_TraceResultPool.back();
+	s_TraceResultPool.pop_back();
+	return tr;
+}
+
+void FreeTraceResult(void *object)
+{
+	sm_trace_t *tr = (sm_trace_t *)object;
+	if (s_TraceResultPool.size() >= TRACE_RESULT_POOL_SIZE)
+	{
+		delete tr;
+		return;
+	}
+
+	s_TraceResultPool.push_back(tr);
+}
+
+void ReleaseTraceResultPool()
+{
+	for (size_t i = 0; i < s_TraceResultPool.size(); i++)
+	{
+		delete s_TraceResultPool[i];
+	}
+	s_TraceResultPool.clear();
+}
+
 /* Used for the global trace version */
 Ray_t g_Ray;
 sm_trace_t g_Trace;
@@ -607,7 +646,7 @@ static cell_t smn_TRTraceRayEx(IPluginContext *pContext, const cell_t *params)
 		}
 	}
 
-	sm_trace_t *tr = new sm_trace_t;
+	sm_trace_t *tr = AllocTraceResult();
 	ray.Init(StartVec, EndVec);
 	enginetrace->TraceRay(ray, params[3], &g_HitAllFilter, tr);
 	tr->UpdateEntRef();
@@ -616,7 +655,7 @@ static cell_t smn_TRTraceRayEx(IPluginContext *pContext, const cell_t *params)
 	Handle_t hndl;
 	if (!(hndl=handlesys->CreateHandle(g_TraceHandle, tr, pContext->GetIdentity(), myself->GetIdentity(), &herr)))
 	{
-		delete tr;
+		FreeTraceResult(tr);
 		return pContext->ThrowNativeError("Unable to create a new trace handle (error %d)", herr);
 	}
 
@@ -641,7 +680,7 @@ static cell_t smn_TRTraceHullEx(IPluginContext *pContext, const cell_t *params)
 
 	ray.Init(StartVec, EndVec, vmins, vmaxs);
 
-	sm_trace_t *tr = new sm_trace_t;
+	sm_trace_t *tr = AllocTraceResult();
 	enginetrace->TraceRay(ray, params[5], &g_HitAllFilter, tr);
 	tr->UpdateEntRef();
 
@@ -649,7 +688,7 @@ static cell_t smn_TRTraceHullEx(IPluginContext *pContext, const cell_t *params)
 	Handle_t hndl;
 	if (!(hndl=handlesys->CreateHandle(g_TraceHandle, tr, pContext->GetIdentity(), myself->GetIdentity(), &herr)))
 	{
-		delete tr;
+		FreeTraceResult(tr);
 		return pContext->ThrowNativeError("Unable to create a new trace handle (error %d)", herr);
 	}
 
@@ -694,7 +733,7 @@ static cell_t smn_TRClipRayToEntityEx(IPluginContext *pContext, const cell_t *pa
 	}
 
 	Ray_t ray;
-	sm_trace_t *tr = new sm_trace_t;
+	sm_trace_t *tr = AllocTraceResult();
 
 	IHandleEntity *pEnt = reinterpret_cast<IHandleEntity*>(pEdict->GetUnknown()->GetBaseEntity());
 	ray.Init(StartVec, EndVec);
@@ -705,7 +744,7 @@ static cell_t smn_TRClipRayToEntityEx(IPluginContext *pContext, const cell_t *pa
 	Handle_t hndl;
 	if (!(hndl=handlesys->CreateHandle(g_TraceHandle, tr, pContext->GetIdentity(), myself->GetIdentity(), &herr)))
 	{
-		delete tr;
+		FreeTraceResult(tr);
 		return pContext->ThrowNativeError("Unable to create a new trace handle (error %d)", herr);
 	}
 
@@ -738,7 +777,7 @@ static cell_t smn_TRClipRayHullToEntityEx(IPluginContext *pContext, const cell_t
 
 	ray.Init(StartVec, EndVec, vmins, vmaxs);
 
-	sm_trace_t *tr = new sm_trace_t;
+	sm_trace_t *tr = AllocTraceResult();
 	enginetrace->ClipRayToEntity(ray, params[5], pEnt, tr);
 	tr->UpdateEntRef();
 
@@ -746,7 +785,7 @@ static cell_t smn_TRClipRayHullToEntityEx(IPluginContext *pContext, const cell_t
 	Handle_t hndl;
 	if (!(hndl=handlesys->CreateHandle(g_TraceHandle, tr, pContext->GetIdentity(), myself->GetIdentity(), &herr)))
 	{
-		delete tr;
+		FreeTraceResult(tr);
 		return pContext->ThrowNativeError("Unable to create a new trace handle (error %d)", herr);
 	}
 
@@ -761,7 +800,7 @@ static cell_t smn_TRClipCurrentRayToEntityEx(IPluginContext *pContext, const cel
 		return pContext->ThrowNativeError("Entity %d is invalid", params[2]);
 	}
 
-	sm_trace_t *tr = new sm_trace_t;
+	sm_trace_t *tr = AllocTraceResult();
 
 	IHandleEntity *pEnt = reinterpret_cast<IHandleEntity*>(pEdict->GetUnknown()->GetBaseEntity());
 	enginetrace->ClipRayToEntity(g_Ray, params[1], pEnt, tr);
@@ -771,7 +810,7 @@ static cell_t smn_TRClipCurrentRayToEntityEx(IPluginContext *pContext, const cel
 	Handle_t hndl;
 	if (!(hndl=handlesys->CreateHandle(g_TraceHandle, tr, pContext->GetIdentity(), myself->GetIdentity(), &herr)))
 	{
-		delete tr;
+		FreeTraceResult(tr);
 		return pContext->ThrowNativeError("Unable to create a new trace handle (error %d)", herr);
 	}
 
@@ -842,7 +881,7 @@ static cell_t smn_TRTraceRayFilterEx(IPluginContext *pContext, const cell_t *par
 		}
 	}
 
-	sm_trace_t *tr = new sm_trace_t;
+	sm_trace_t *tr = AllocTraceResult();
 	ray.Init(StartVec, EndVec);
 	enginetrace->TraceRay(ray, params[3], &smfilter, tr);
 	tr->UpdateEntRef();
@@ -851,7 +890,7 @@ static cell_t smn_TRTraceRayFilterEx(IPluginContext *pContext, const cell_t *par
 	Handle_t hndl;
 	if (!(hndl=handlesys->CreateHandle(g_TraceHandle, tr, pContext->GetIdentity(), myself->GetIdentity(), &herr)))
 	{
-		delete tr;
+		FreeTraceResult(tr);
 		return pContext->ThrowNativeError("Unable to create a new trace handle (error %d)", herr);
 	}
 
@@ -902,7 +941,7 @@ static cell_t smn_TRTraceHullFilterEx(IPluginContext *pContext, const cell_t *pa
 
 	ray.Init(StartVec, EndVec, vmins, vmaxs);
 
-	sm_trace_t *tr = new sm_trace_t;
+	sm_trace_t *tr = AllocTraceResult();
 	enginetrace->TraceRay(ray, params[5], &smfilter, tr);
 	tr->UpdateEntRef();
 
@@ -910,13 +949,381 @@ static cell_t smn_TRTraceHullFilterEx(IPluginContext *pContext, const cell_t *pa
 	Handle_t hndl;
 	if (!(hndl=handlesys->CreateHandle(g_TraceHandle, tr, pContext->GetIdentity(), myself->GetIdentity(), &herr)))
 	{
-		delete tr;
+		FreeTraceResult(tr);
 		return pContext->ThrowNativeError("Unable to create a new trace handle (error %d)", herr);
 	}
 
 	return hndl;
 }
 
+#define TRACE_BATCH_MAX_RAYS	1024
+#define TRACE_BATCH_MAX_IGNORE	64
+#define TRACE_BATCH_STRIDE		7	/* fraction, end position, plane normal */
+
+static void RunTraceBatch(const cell_t *starts, const cell_t *ends, const Vector *mins, const Vector *maxs,
+	int numRays, int flags, ITraceFilter *filter, cell_t *results, cell_t *entities)
+{
+	Vector StartVec, EndVec;
+	Ray_t ray;
+	trace_t tr;
+
+	for (int i = 0; i < numRays; i++)
+	{
+		const cell_t *start = &starts[i * 3];
+		const cell_t *end = &ends[i * 3];
+		StartVec.Init(sp_ctof(start[0]), sp_ctof(start[1]), sp_ctof(start[2]));
+		EndVec.Init(sp_ctof(end[0]), sp_ctof(end[1]), sp_ctof(end[2]));
+
+		if (mins)
+		{
+			ray.Init(StartVec, EndVec, *mins, *maxs);
+		}
+		else
+		{
+			ray.Init(StartVec, EndVec);
+		}
+
+		enginetrace->TraceRay(ray, flags, filter, &tr);
+
+		cell_t *result = &results[i * TRACE_BATCH_STRIDE];
+		result[0] = sp_ftoc(tr.fraction);
+		result[1] = sp_ftoc(tr.endpos.x);
+		result[2] = sp_ftoc(tr.endpos.y);
+		result[3] = sp_ftoc(tr.endpos.z);
+		result[4] = sp_ftoc(tr.plane.normal.x);
+		result[5] = sp_ftoc(tr.plane.normal.y);
+		result[6] = sp_ftoc(tr.plane.normal.z);
+
+		entities[i] = tr.m_pEnt ? gamehelpers->EntityToBCompatRef(tr.m_pEnt) : -1;
+	}
+}
+
+// Resolves a plugin cell buffer of |cells| entries, checking that all of it
+// lies inside plugin memory. Reports an error and returns NULL on failure.
+static cell_t *GetTraceBuffer(IPluginContext *pContext, cell_t addr, int cells, const char *name)
+{
+	cell_t *buffer, *last;
+	if (pContext->LocalToPhysAddr(addr, &buffer) != SP_ERROR_NONE
+		|| (cells && pContext->LocalToPhysAddr(addr + (cells - 1) * sizeof(cell_t), &last) != SP_ERROR_NONE))
+	{
+		pContext->ReportError("%s buffer is too small for %d cells", name, cells);
+		return NULL;
+	}
+	return buffer;
+}
+
+static cell_t TraceBatch(IPluginContext *pContext, const cell_t *params, bool hull)
+{
+	/* Hull batches carry mins/maxs after the start and end arrays */
+	int arg = hull ? 5 : 3;
+	int numRays = params[arg];
+	int flags = params[arg + 1];
+	int numIgnore = params[arg + 5];
+
+	if (numRays < 0 || numRays > TRACE_BATCH_MAX_RAYS)
+	{
+		return pContext->ThrowNativeError("Invalid number of rays %d (maximum %d)", numRays, TRACE_BATCH_MAX_RAYS);
+	}
+	if (numIgnore < 0 || numIgnore > TRACE_BATCH_MAX_IGNORE)
+	{
+		return pContext->ThrowNativeError("Invalid number of ignored entities %d (maximum %d)", numIgnore, TRACE_BATCH_MAX_IGNORE);
+	}
+
+	/* numRays is capped above, so none of these sizes can overflow */
+	cell_t *starts, *ends, *results, *entities, *ignore;
+	if (!(starts = GetTraceBuffer(pContext, params[1], numRays * 3, "Start"))
+		|| !(ends = GetTraceBuffer(pContext, params[2], numRays * 3, "End"))
+		|| !(results = GetTraceBuffer(pContext, params[arg + 2], numRays * TRACE_BATCH_STRIDE, "Result"))
+		|| !(entities = GetTraceBuffer(pContext, params[arg + 3], numRays, "Entity"))
+		|| !(ignore = GetTraceBuffer(pContext, params[arg + 4], numIgnore, "Ignore")))
+	{
+		return 0;
+	}
+
+	Vector vmins, vmaxs;
+	if (hull)
+	{
+		cell_t *mins, *maxs;
+		if (!(mins = GetTraceBuffer(pContext, params[3], 3, "Mins"))
+			|| !(maxs = GetTraceBuffer(pContext, params[4], 3, "Maxs")))
+		{
+			return 0;
+		}
+		vmins.Init(sp_ctof(mins[0]), sp_ctof(mins[1]), sp_ctof(mins[2]));
+		vmaxs.Init(sp_ctof(maxs[0]), sp_ctof(maxs[1]), sp_ctof(maxs[2]));
+	}
+
+	CSMNativeTraceFilter filter;
+	for (int i = 0; i < numIgnore; i++)
+	{
+		filter.AddRule(TraceFilterRule_Entity, true, ignore[i]);
+	}
+	for (int team = 0; team < 32; team++)
+	{
+		if (params[arg + 6] & (1 << team))
+		{
+			filter.AddRule(TraceFilterRule_Team, true, team);
+		}
+	}
+
+	RunTraceBatch(starts, ends, hull ? &vmins : NULL, hull ? &vmaxs : NULL, numRays, flags, &filter, results, entities);
+
+	return numRays;
+}
+
+static cell_t smn_TRTraceRayBatch(IPluginContext *pContext, const cell_t *params)
+{
+	return TraceBatch(pContext, params, false);
+}
+
+static cell_t smn_TRTraceHullBatch(IPluginContext *pContext, const cell_t *params)
+{
+	return TraceBatch(pContext, params, true);
+}
+
+static CSMNativeTraceFilter *ReadTraceFilter(IPluginContext *pContext, cell_t hndl)
+{
+	CSMNativeTraceFilter *filter;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), myself->GetIdentity());
+
+	if ((err = handlesys->ReadHandle(hndl, g_TraceFilterHandle, &sec, (void **)&filter)) != HandleError_None)
+	{
+		pContext->ReportError("Invalid TraceFilter handle %x (error %d)", hndl, err);
+		return NULL;
+	}
+
+	return filter;
+}
+
+static cell_t smn_TraceFilter(IPluginContext *pContext, const cell_t *params)
+{
+	CSMNativeTraceFilter *filter = new CSMNativeTraceFilter;
+
+	HandleError herr;
+	Handle_t hndl;
+	if (!(hndl=handlesys->CreateHandle(g_TraceFilterHandle, filter, pContext->GetIdentity(), myself->GetIdentity(), &herr)))
+	{
+		delete filter;
+		return pContext->ThrowNativeError("Unable to create a new trace filter handle (error %d)", herr);
+	}
+
+	return hndl;
+}
+
+static cell_t AddTraceFilterRule(IPluginContext *pContext, const cell_t *params, bool exclude)
+{
+	CSMNativeTraceFilter *filter = ReadTraceFilter(pContext, params[1]);
+	if (!filter)
+	{
+		return 0;
+	}
+
+	TraceFilterRuleType type = (TraceFilterRuleType)params[2];
+	if (type < 0 || type >= TraceFilterRule_MAX || type == TraceFilterRule_Classname)
+	{
+		return pContext->ThrowNativeError("Invalid trace filter rule %d", type);
+	}
+
+	filter->AddRule(type, exclude, params[3]);
+	return 1;
+}
+
+static cell_t smn_TraceFilterInclude(IPluginContext *pContext, const cell_t *params)
+{
+	return AddTraceFilterRule(pContext, params, false);
+}
+
+static cell_t smn_TraceFilterExclude(IPluginContext *pContext, const cell_t *params)
+{
+	return AddTraceFilterRule(pContext, params, true);
+}
+
+static cell_t AddTraceFilterClassname(IPluginContext *pContext, const cell_t *params, bool exclude)
+{
+	CSMNativeTraceFilter *filter = ReadTraceFilter(pContext, params[1]);
+	if (!filter)
+	{
+		return 0;
+	}
+
+	char *prefix;
+	pContext->LocalToString(params[2], &prefix);
+
+	filter->AddRule(TraceFilterRule_Classname, exclude, 0, prefix);
+	return 1;
+}
+
+static cell_t smn_TraceFilterIncludeClassname(IPluginContext *pContext, const cell_t *params)
+{
+	return AddTraceFilterClassname(pContext, params, false);
+}
+
+static cell_t smn_TraceFilterExcludeClassname(IPluginContext *pContext, const cell_t *params)
+{
+	return AddTraceFilterClassname(pContext, params, true);
+}
+
+static cell_t smn_TraceFilterMerge(IPluginContext *pContext, const cell_t *params)
+{
+	CSMNativeTraceFilter *filter, *other;
+	if (!(filter = ReadTraceFilter(pContext, params[1])) || !(other = ReadTraceFilter(pContext, params[2])))
+	{
+		return 0;
+	}
+
+	if (filter != other)
+	{
+		filter->Merge(*other);
+	}
+
+	return 1;
+}
+
+static cell_t smn_TraceFilterTraceTypeSet(IPluginContext *pContext, const cell_t *params)
+{
+	CSMNativeTraceFilter *filter = ReadTraceFilter(pContext, params[1]);
+	if (!filter)
+	{
+		return 0;
+	}
+
+	filter->SetTraceType((TraceType_t)params[2]);
+	return 1;
+}
+
+static cell_t smn_TraceFilterTraceTypeGet(IPluginContext *pContext, const cell_t *params)
+{
+	CSMNativeTraceFilter *filter = ReadTraceFilter(pContext, params[1]);
+	if (!filter)
+	{
+		return 0;
+	}
+
+	return filter->GetTraceType();
+}
+
+/* Shared by the TraceFilter trace natives; hulls pass mins/maxs */
+static bool TraceWithNativeFilter(IPluginContext *pContext, const cell_t *params, bool hull, sm_trace_t *tr)
+{
+	int arg = hull ? 5 : 4;
+	ITraceFilter *filter = &g_HitAllFilter;
+	if (params[arg + 1] != BAD_HANDLE && !(filter = ReadTraceFilter(pContext, params[arg + 1])))
+	{
+		return false;
+	}
+
+	cell_t *startaddr, *endaddr;
+	pContext->LocalToPhysAddr(params[1], &startaddr);
+	pContext->LocalToPhysAddr(params[2], &endaddr);
+
+	Vector StartVec, EndVec;
+	Ray_t ray;
+
+	StartVec.Init(sp_ctof(startaddr[0]), sp_ctof(startaddr[1]), sp_ctof(startaddr[2]));
+
+	if (!hull && params[4] == RayType_Infinite)
+	{
+		QAngle DirAngles;
+		DirAngles.Init(sp_ctof(endaddr[0]), sp_ctof(endaddr[1]), sp_ctof(endaddr[2]));
+		AngleVectors(DirAngles, &EndVec);
+
+		/* Make it unitary and get the ending point */
+		EndVec.NormalizeInPlace();
+		EndVec = StartVec + EndVec * MAX_TRACE_LENGTH;
+	}
+	else
+	{
+		EndVec.Init(sp_ctof(endaddr[0]), sp_ctof(endaddr[1]), sp_ctof(endaddr[2]));
+	}
+
+	if (hull)
+	{
+		cell_t *mins, *maxs;
+		pContext->LocalToPhysAddr(params[3], &mins);
+		pContext->LocalToPhysAddr(params[4], &maxs);
+
+		Vector vmins, vmaxs;
+		vmins.Init(sp_ctof(mins[0]), sp_ctof(mins[1]), sp_ctof(mins[2]));
+		vmaxs.Init(sp_ctof(maxs[0]), sp_ctof(maxs[1]), sp_ctof(maxs[2]));
+		ray.Init(StartVec, EndVec, vmins, vmaxs);
+	}
+	else
+	{
+		ray.Init(StartVec, EndVec);
+	}
+
+	enginetrace->TraceRay(ray, params[hull ? 5 : 3], filter, tr);
+	tr->UpdateEntRef();
+
+	return true;
+}
+
+static cell_t smn_TRTraceRayNativeFilter(IPluginContext *pContext, const cell_t *params)
+{
+	return TraceWithNativeFilter(pContext, params, false, &g_Trace);
+}
+
+static cell_t smn_TRTraceHullNativeFilter(IPluginContext *pContext, const cell_t *params)
+{
+	return TraceWithNativeFilter(pContext, params, true, &g_Trace);
+}
+
+static cell_t TraceWithNativeFilterEx(IPluginContext *pContext, const cell_t *params, bool hull)
+{
+	sm_trace_t *tr = AllocTraceResult();
+	if (!TraceWithNativeFilter(pContext, params, hull, tr))
+	{
+		FreeTraceResult(tr);
+		return 0;
+	}
+
+	HandleError herr;
+	Handle_t hndl;
+	if (!(hndl=handlesys->CreateHandle(g_TraceHandle, tr, pContext->GetIdentity(), myself->GetIdentity(), &herr)))
+	{
+		FreeTraceResult(tr);
+		return pContext->ThrowNativeError("Unable to create a new trace handle (error %d)", herr);
+	}
+
+	return hndl;
+}
+
+static cell_t smn_TRTraceRayNativeFilterEx(IPluginContext *pContext, const cell_t *params)
+{
+	return TraceWithNativeFilterEx(pContext, params, false);
+}
+
+static cell_t smn_TRTraceHullNativeFilterEx(IPluginContext *pContext, const cell_t *params)
+{
+	return TraceWithNativeFilterEx(pContext, params, true);
+}
+
+static cell_t TraceInto(IPluginContext *pContext, const cell_t *params, bool hull)
+{
+	sm_trace_t *tr;
+	HandleError err;
+	HandleSecurity sec(pContext->GetIdentity(), myself->GetIdentity());
+
+	if ((err = handlesys->ReadHandle(params[1], g_TraceHandle, &sec, (void **)&tr)) != HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error %d)", params[1], err);
+	}
+
+	/* The remaining arguments are laid out like TR_Trace*NativeFilter's, one slot later */
+	return TraceWithNativeFilter(pContext, params + 1, hull, tr);
+}
+
+static cell_t smn_TRTraceRayInto(IPluginContext *pContext, const cell_t *params)
+{
+	return TraceInto(pContext, params, false);
+}
+
+static cell_t smn_TRTraceHullInto(IPluginContext *pContext, const cell_t *params)
+{
+	return TraceInto(pContext, params, true);
+}
+
 static cell_t smn_TRGetFraction(IPluginContext *pContext, const cell_t *params)
 {
 	sm_trace_t *tr;
@@ -1303,5 +1710,21 @@ sp_nativeinfo_t g_TRNatives[] =
 	{"TR_TraceHullFilterEx",		smn_TRTraceHullFilterEx},
 	{"TR_GetPlaneNormal",			smn_TRGetPlaneNormal},
 	{"TR_PointOutsideWorld",		smn_TRPointOutsideWorld},
+	{"TR_TraceRayBatch",			smn_TRTraceRayBatch},
+	{"TR_TraceHullBatch",			smn_TRTraceHullBatch},
+	{"TR_TraceRayNativeFilter",		smn_TRTraceRayNativeFilter},
+	{"TR_TraceHullNativeFilter",	smn_TRTraceHullNativeFilter},
+	{"TR_TraceRayNativeFilterEx",	smn_TRTraceRayNativeFilterEx},
+	{"TR_TraceHullNativeFilterEx",	smn_TRTraceHullNativeFilterEx},
+	{"TR_TraceRayInto",				smn_TRTraceRayInto},
+	{"TR_TraceHullInto",			smn_TRTraceHullInto},
+	{"TraceFilter.TraceFilter",		smn_TraceFilter},
+	{"TraceFilter.Include",			smn_TraceFilterInclude},
+	{"TraceFilter.Exclude",			smn_TraceFilterExclude},
+	{"TraceFilter.IncludeClassname",	smn_TraceFilterIncludeClassname},
+	{"TraceFilter.ExcludeClassname",	smn_TraceFilterExcludeClassname},
+	{"TraceFilter.Merge",			smn_TraceFilterMerge},
+	{"TraceFilter.TraceType.get",	smn_TraceFilterTraceTypeGet},
+	{"TraceFilter.TraceType.set",	smn_TraceFilterTraceTypeSet},
 	{NULL,							NULL}
 };
@@ -56,13 +56,18 @@ static cell_t SetVariantBool(IPluginContext *pContext, const cell_t *params)
 	return 1;
 }
 
+const char *SetVariantStringValue(const char *str)
+{
+	strncpy(g_Variant_str_Value, str, sizeof(g_Variant_str_Value));
+	g_Variant_str_Value[sizeof(g_Variant_str_Value) - 1] = '\0';
+	return g_Variant_str_Value;
+}
+
 static cell_t SetVariantString(IPluginContext *pContext, const cell_t *params)
 {
 	char *str;
 	pContext->LocalToString(params[1], &str);
-	strncpy(g_Variant_str_Value, str, sizeof(g_Variant_str_Value));
-	g_Variant_str_Value[sizeof(g_Variant_str_Value) - 1] = '\0';
-	g_Variant_t.SetString(MAKE_STRING(g_Variant_str_Value));
+	g_Variant_t.SetString(MAKE_STRING(SetVariantStringValue(str)));
 	return 1;
 }
 
@@ -43,6 +43,9 @@
 
 extern variant_t g_Variant_t;
 
+/* Copies |str| into the buffer that variant strings point at */
+const char *SetVariantStringValue(const char *str);
+
 extern sp_nativeinfo_t g_VariantTNatives[];
 
 inline void _init_variant_t()
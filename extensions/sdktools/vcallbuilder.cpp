@@ -40,6 +40,7 @@ ValveCall::ValveCall()
 	retinfo = NULL;
 	thisinfo = NULL;
 	retbuf = NULL;
+	fastpath = false;
 }
 
 ValveCall::~ValveCall()
@@ -76,6 +77,38 @@ void ValveCall::stk_put(unsigned char *ptr)
 	stk.push(ptr);
 }
 
+void ValveCall::ComputeFastPath()
+{
+	/* Calls whose parameters are all by-value cells (int, float, bool) with
+	 * no copyback can be marshalled straight from the plugin's cells into
+	 * the bintools stack, without going through the generic decoder.
+	 */
+	fastpath = false;
+	if (!call)
+	{
+		return;
+	}
+
+	unsigned int numParams = call->GetParamCount();
+	for (unsigned int i=0; i<numParams; i++)
+	{
+		const ValvePassInfo *info = &vparams[i];
+		if (info->vtype != Valve_POD
+			&& info->vtype != Valve_Float
+			&& info->vtype != Valve_Bool)
+		{
+			return;
+		}
+		if ((info->flags & PASSFLAG_ASPOINTER)
+			|| (info->encflags & VENCODE_FLAG_COPYBACK))
+		{
+			return;
+		}
+	}
+
+	fastpath = true;
+}
+
 ValveCall *CreateValveCall(void *addr,
 						   ValveCallType vcalltype,
 						   const ValvePassInfo *retInfo,
@@ -52,9 +52,11 @@ struct ValveCall
 	size_t stackEnd;							/**< End of the bintools stack */
 	unsigned char *retbuf;						/**< Return buffer */
 	SourceHook::CStack<unsigned char *> stk;	/**< Parameter stack */
+	bool fastpath;								/**< All params are plain cells */
 
 	unsigned char *stk_get();
 	void stk_put(unsigned char *ptr);
+	void ComputeFastPath();
 	ValveCall();
 	~ValveCall();
 };
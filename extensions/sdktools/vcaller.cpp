@@ -293,6 +293,8 @@ static cell_t EndPrepSDKCall(IPluginContext *pContext, const cell_t *params)
 		vc->thisinfo->decflags |= VDECODE_FLAG_BYREF;
 	}
 
+	vc->ComputeFastPath();
+
 	Handle_t hndl = handlesys->CreateHandle(g_CallHandle, vc, pContext->GetIdentity(), myself->GetIdentity(), NULL);
 	if (!hndl)
 	{
@@ -474,7 +476,29 @@ static cell_t SDKCall(IPluginContext *pContext, const cell_t *params)
 
 	unsigned int callparams = vc->call->GetParamCount();
 	bool will_copyback = false;
-	for (unsigned int i=0; i<callparams; i++)
+	if (vc->fastpath)
+	{
+		if (startparam + callparams - 1 > numparams)
+		{
+			vc->stk_put(ptr);
+			return pContext->ThrowNativeError("Expected %dth parameter, found none", numparams + 1);
+		}
+		for (unsigned int i=0; i<callparams; i++)
+		{
+			//note: varargs pawn args are passed by-ref
+			cell_t *addr;
+			pContext->LocalToPhysAddr(params[startparam + i], &addr);
+
+			unsigned char *buffer = ptr + vc->vparams[i].offset;
+			if (vc->vparams[i].vtype == Valve_Bool)
+			{
+				*(bool *)buffer = *addr ? true : false;
+			} else {
+				*(cell_t *)buffer = *addr;
+			}
+		}
+	}
+	for (unsigned int i=0; !vc->fastpath && i<callparams; i++)
 	{
 		unsigned int p = startparam + i;
 		if (p > numparams)
@@ -43,6 +43,10 @@ CallHelper s_Teleport;
 CallHelper s_GetVelocity;
 CallHelper s_EyeAngles;
 
+static ClientSnapshot s_Snapshots[SM_MAXPLAYERS + 1];
+static int s_SnapshotVelocityOffs = 0;	/* 0 = not looked up yet, -1 = not found */
+static int s_SnapshotFlagsOffs = 0;
+
 class CTraceFilterSimple : public CTraceFilterEntitiesOnly
 {
 public:
@@ -269,6 +273,83 @@ bool IsEyeAnglesSupported()
 	return SetupGetEyeAngles();
 }
 
+static int FindSnapshotOffset(CBaseEntity *pEntity, const char *prop)
+{
+	sm_datatable_info_t info;
+	datamap_t *pMap = gamehelpers->GetDataMap(pEntity);
+	if (pMap == NULL || !gamehelpers->FindDataMapInfo(pMap, prop, &info))
+	{
+		return -1;
+	}
+	return info.actual_offset;
+}
+
+const ClientSnapshot *GetClientSnapshot(int client)
+{
+	if (client < 1 || client > SM_MAXPLAYERS)
+	{
+		return NULL;
+	}
+
+	IGamePlayer *player = playerhelpers->GetGamePlayer(client);
+	if (player == NULL || !player->IsInGame())
+	{
+		return NULL;
+	}
+
+	ClientSnapshot &snap = s_Snapshots[client];
+	if (snap.valid && snap.tick == gpGlobals->tickcount)
+	{
+		return &snap;
+	}
+
+	edict_t *pEdict = player->GetEdict();
+	CBaseEntity *pEntity = pEdict->GetUnknown() ? pEdict->GetUnknown()->GetBaseEntity() : NULL;
+	if (pEntity == NULL)
+	{
+		return NULL;
+	}
+
+	if (!s_SnapshotVelocityOffs)
+	{
+		s_SnapshotVelocityOffs = FindSnapshotOffset(pEntity, "m_vecAbsVelocity");
+		s_SnapshotFlagsOffs = FindSnapshotOffset(pEntity, "m_fFlags");
+	}
+
+	snap.origin = pEdict->GetCollideable()->GetCollisionOrigin();
+	serverClients->ClientEarPosition(pEdict, &snap.eye_position);
+
+	snap.has_angles = GetEyeAngles(pEntity, &snap.eye_angles);
+	if (!snap.has_angles)
+	{
+		snap.eye_angles.Init();
+	}
+
+	if (s_SnapshotVelocityOffs > 0)
+	{
+		snap.velocity = *(Vector *)((unsigned char *)pEntity + s_SnapshotVelocityOffs);
+	}
+	else
+	{
+		snap.velocity.Init();
+	}
+
+	snap.flags = (s_SnapshotFlagsOffs > 0) ? *(int *)((unsigned char *)pEntity + s_SnapshotFlagsOffs) : 0;
+
+	snap.tick = gpGlobals->tickcount;
+	snap.valid = true;
+
+	return &snap;
+}
+
+void InvalidateClientSnapshot(int client)
+{
+	if (client >= 1 && client <= SM_MAXPLAYERS)
+	{
+		s_Snapshots[client].valid = false;
+	}
+}
+
 bool GetPlayerInfo(int client, player_info_t *info)
 {
 #if SOURCE_ENGINE >= SE_ORANGEBOX
@@ -283,6 +364,8 @@ void ShutdownHelpers()
 	s_Teleport.Shutdown();
 	s_GetVelocity.Shutdown();
 	s_EyeAngles.Shutdown();
+	s_SnapshotVelocityOffs = 0;
+	s_SnapshotFlagsOffs = 0;
 }
 
 bool FindNestedDataTable(SendTable *pTable, const char *name)
@@ -68,6 +68,29 @@ bool IsEyeAnglesSupported();
 
 int GetClientAimTarget(edict_t *pEdict, bool only_players);
 
+/**
+ * Positional state of a player, read once per tick and shared by every
+ * native that asks for it during that tick.
+ */
+struct ClientSnapshot
+{
+	ClientSnapshot() : valid(false), tick(0), has_angles(false), flags(0)
+	{
+	}
+	bool valid;
+	int tick;				/* gpGlobals->tickcount it was taken on */
+	bool has_angles;		/* false if the mod has no EyeAngles offset */
+	Vector origin;
+	Vector eye_position;
+	QAngle eye_angles;
+	Vector velocity;
+	int flags;
+};
+
+/* Returns NULL if the client is not in game. */
+const ClientSnapshot *GetClientSnapshot(int client);
+void InvalidateClientSnapshot(int client);
+
 bool GetPlayerInfo(int client, player_info_t *info);
 
 void ShutdownHelpers();
@@ -546,6 +546,9 @@ static cell_t TeleportEntity(IPluginContext *pContext, const cell_t *params)
 
 	FINISH_CALL_SIMPLE(NULL);
 
+	/* The cached positional state of a teleported player is now wrong */
+	InvalidateClientSnapshot(gamehelpers->ReferenceToIndex(params[1]));
+
 	return 1;
 }
 
@@ -753,34 +756,23 @@ static cell_t SlapPlayer(IPluginContext *pContext, const cell_t *params)
 	velocity.y += ((rand() % 180) + 50) * (((rand() % 2) == 1) ?  -1 : 1);
 	velocity.z += rand() % 200 + 100;
 	Teleport(pEntity, NULL, NULL, &velocity);
+	InvalidateClientSnapshot(params[1]);
 
 	/* Play a random sound */
 	if (params[3] && s_sound_count > 0)
 	{
 		char name[48];
 		const char *sound_name;
-		cell_t player_list[SM_MAXPLAYERS], total_players = 0;
-		int maxClients = playerhelpers->GetMaxClients();
 
 		int r = (rand() % s_sound_count) + 1;
 		ke::SafeSprintf(name, sizeof(name), "SlapSound%d", r);
 
 		if ((sound_name = g_pGameConf->GetKeyValue(name)) != NULL)
 		{
-			IGamePlayer *other;
-			for (int i=1; i<=maxClients; i++)
-			{
-				other = playerhelpers->GetGamePlayer(i);
-				if (other->IsInGame())
-				{
-					player_list[total_players++] = i;
-				}
-			}
-
 			const Vector & pos = pEdict->GetCollideable()->GetCollisionOrigin();
 			CellRecipientFilter rf;
 			rf.SetToReliable(true);
-			rf.Initialize(player_list, total_players);
+			rf.InitializeMatching(playerhelpers, ClientState_InGame);
 #if SOURCE_ENGINE == SE_CSS || SOURCE_ENGINE == SE_HL2DM || SOURCE_ENGINE == SE_DODS || SOURCE_ENGINE == SE_SDK2013 \
 	|| SOURCE_ENGINE == SE_BMS || SOURCE_ENGINE == SE_TF2 || SOURCE_ENGINE == SE_PVKII
 			engsound->EmitSound(rf, params[1], CHAN_AUTO, sound_name, VOL_NORM, ATTN_NORM, 0, PITCH_NORM, 0, &pos);
@@ -843,7 +835,15 @@ static cell_t GetClientEyePosition(IPluginContext *pContext, const cell_t *param
 	}
 
 	Vector pos;
-	serverClients->ClientEarPosition(player->GetEdict(), &pos);
+	const ClientSnapshot *snap = GetClientSnapshot(params[1]);
+	if (snap != NULL)
+	{
+		pos = snap->eye_position;
+	}
+	else
+	{
+		serverClients->ClientEarPosition(player->GetEdict(), &pos);
+	}
 
 	cell_t *addr;
 	pContext->LocalToPhysAddr(params[2], &addr);
@@ -854,6 +854,51 @@ static cell_t GetClientEyePosition(IPluginContext *pContext, const cell_t *param
 	return 1;
 }
 
+static cell_t GetClientSnapshots(IPluginContext *pContext, const cell_t *params)
+{
+	cell_t *clients, *origins, *eyepos, *eyeang, *velocities, *flags;
+	pContext->LocalToPhysAddr(params[1], &clients);
+	pContext->LocalToPhysAddr(params[2], &origins);
+	pContext->LocalToPhysAddr(params[3], &eyepos);
+	pContext->LocalToPhysAddr(params[4], &eyeang);
+	pContext->LocalToPhysAddr(params[5], &velocities);
+	pContext->LocalToPhysAddr(params[6], &flags);
+	cell_t maxClients = params[7];
+
+	cell_t count = 0;
+	int max = playerhelpers->GetMaxClients();
+	for (int i = 1; i <= max && count < maxClients; i++)
+	{
+		const ClientSnapshot *snap = GetClientSnapshot(i);
+		if (snap == NULL)
+		{
+			continue;
+		}
+
+		cell_t *o = &origins[count * 3];
+		cell_t *p = &eyepos[count * 3];
+		cell_t *a = &eyeang[count * 3];
+		cell_t *v = &velocities[count * 3];
+		o[0] = sp_ftoc(snap->origin.x);
+		o[1] = sp_ftoc(snap->origin.y);
+		o[2] = sp_ftoc(snap->origin.z);
+		p[0] = sp_ftoc(snap->eye_position.x);
+		p[1] = sp_ftoc(snap->eye_position.y);
+		p[2] = sp_ftoc(snap->eye_position.z);
+		a[0] = sp_ftoc(snap->eye_angles.x);
+		a[1] = sp_ftoc(snap->eye_angles.y);
+		a[2] = sp_ftoc(snap->eye_angles.z);
+		v[0] = sp_ftoc(snap->velocity.x);
+		v[1] = sp_ftoc(snap->velocity.y);
+		v[2] = sp_ftoc(snap->velocity.z);
+		flags[count] = snap->flags;
+		clients[count] = i;
+		count++;
+	}
+
+	return count;
+}
+
 static cell_t GetClientEyeAngles(IPluginContext *pContext, const cell_t *params)
 {
 	IGamePlayer *pPlayer = playerhelpers->GetGamePlayer(params[1]);
@@ -867,18 +912,17 @@ static cell_t GetClientEyeAngles(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Client %d is not in game", params[1]);
 	}
 
-	edict_t *pEdict = pPlayer->GetEdict();
-	CBaseEntity *pEntity = pEdict->GetUnknown() ? pEdict->GetUnknown()->GetBaseEntity() : NULL;
-
 	/* We always set the angles for backwards compatibility -- 
 	 * The original function had no return value.
 	 */
 	QAngle angles;
 	bool got_angles = false;
 
-	if (pEntity != NULL)
+	const ClientSnapshot *snap = GetClientSnapshot(params[1]);
+	if (snap != NULL && snap->has_angles)
 	{
-		got_angles = GetEyeAngles(pEntity, &angles);
+		angles = snap->eye_angles;
+		got_angles = true;
 	}
 	
 	cell_t *addr;
@@ -1836,6 +1880,7 @@ sp_nativeinfo_t g_Natives[] =
 	{"SlapPlayer",				SlapPlayer},
 	{"GetClientEyePosition",	GetClientEyePosition},
 	{"GetClientEyeAngles",		GetClientEyeAngles},
+	{"GetClientSnapshots",		GetClientSnapshots},
 	{"FindEntityByClassname",	FindEntityByClassname},
 	{"CreateEntityByName",		CreateEntityByName},
 	{"DispatchSpawn",			DispatchSpawn},
@@ -31,6 +31,7 @@
 
 #include <extension.h>
 #include <hooks.h>
+#include "vhelpers.h"
 
 #define SPEAK_NORMAL		0
 #define SPEAK_MUTED			1
@@ -51,10 +52,32 @@ enum ListenOverride
 	Listen_Yes,			/**< Can hear */
 };
 
+#define VOICE_MASK_WORDS	((SM_MAXPLAYERS + 1 + 63) / 64)
+
 size_t g_VoiceFlags[SM_MAXPLAYERS+1];
 size_t g_VoiceHookCount = 0;
-ListenOverride g_VoiceMap[SM_MAXPLAYERS+1][SM_MAXPLAYERS+1];
-bool g_ClientMutes[SM_MAXPLAYERS+1][SM_MAXPLAYERS+1];
+
+/* Per-receiver sender masks, so SetClientListening only has to test bits. */
+uint64_t g_ListenNo[SM_MAXPLAYERS+1][VOICE_MASK_WORDS];
+uint64_t g_ListenYes[SM_MAXPLAYERS+1][VOICE_MASK_WORDS];
+uint64_t g_ClientMutes[SM_MAXPLAYERS+1][VOICE_MASK_WORDS];
+
+static inline bool TestVoiceBit(const uint64_t *mask, int client)
+{
+	return (mask[client >> 6] & (uint64_t(1) << (client & 63))) != 0;
+}
+
+static inline void SetVoiceBit(uint64_t *mask, int client, bool value)
+{
+	if (value)
+	{
+		mask[client >> 6] |= (uint64_t(1) << (client & 63));
+	}
+	else
+	{
+		mask[client >> 6] &= ~(uint64_t(1) << (client & 63));
+	}
+}
 
 SH_DECL_HOOK3(IVoiceServer, SetClientListening, SH_NOATTRIB, 0, bool, int, int, bool);
 
@@ -83,9 +106,46 @@ void IncHookCount()
 	}
 }
 
+static ListenOverride GetListenOverride(int r, int s)
+{
+	if (TestVoiceBit(g_ListenNo[r], s))
+	{
+		return Listen_No;
+	}
+	else if (TestVoiceBit(g_ListenYes[r], s))
+	{
+		return Listen_Yes;
+	}
+
+	return Listen_Default;
+}
+
+/* Each non-default override holds a reference on the SetClientListening hook. */
+static void SetListenOverride(int r, int s, ListenOverride override)
+{
+	ListenOverride old = GetListenOverride(r, s);
+	if (old == override)
+	{
+		return;
+	}
+
+	SetVoiceBit(g_ListenNo[r], s, override == Listen_No);
+	SetVoiceBit(g_ListenYes[r], s, override == Listen_Yes);
+
+	if (old == Listen_Default)
+	{
+		IncHookCount();
+	}
+	else if (override == Listen_Default)
+	{
+		DecHookCount();
+	}
+}
+
 void SDKTools::VoiceInit()
 {
-	memset(g_VoiceMap, 0, sizeof(g_VoiceMap));
+	memset(g_ListenNo, 0, sizeof(g_ListenNo));
+	memset(g_ListenYes, 0, sizeof(g_ListenYes));
 	memset(g_ClientMutes, 0, sizeof(g_ClientMutes));
 
 	SH_ADD_HOOK(IServerGameClients, ClientCommand, serverClients, SH_MEMBER(this, &SDKTools::OnClientCommand), true);
@@ -121,7 +181,7 @@ void SDKTools::OnClientCommand(edict_t *pEntity)
 			
 			for (int j = 0; j < 32; j++)
 			{
-				g_ClientMutes[client][1 + j + 32 * (i - 1)] = !!(mask & 1 << j);
+				SetVoiceBit(g_ClientMutes[client], 1 + j + 32 * (i - 1), !!(mask & 1 << j));
 			}
 		}
 	}
@@ -131,7 +191,7 @@ void SDKTools::OnClientCommand(edict_t *pEntity)
 
 bool SDKTools::OnSetClientListening(int iReceiver, int iSender, bool bListen)
 {
-	if (g_ClientMutes[iReceiver][iSender])
+	if (TestVoiceBit(g_ClientMutes[iReceiver], iSender))
 	{
 		RETURN_META_VALUE_NEWPARAMS(MRES_IGNORED, bListen, &IVoiceServer::SetClientListening, (iReceiver, iSender, false));
 	}
@@ -141,11 +201,11 @@ bool SDKTools::OnSetClientListening(int iReceiver, int iSender, bool bListen)
 		RETURN_META_VALUE_NEWPARAMS(MRES_IGNORED, bListen, &IVoiceServer::SetClientListening, (iReceiver, iSender, false));
 	}
 
-	if (g_VoiceMap[iReceiver][iSender] == Listen_No)
+	if (TestVoiceBit(g_ListenNo[iReceiver], iSender))
 	{
 		RETURN_META_VALUE_NEWPARAMS(MRES_IGNORED, bListen, &IVoiceServer::SetClientListening, (iReceiver, iSender, false));
 	}
-	else if (g_VoiceMap[iReceiver][iSender] == Listen_Yes)
+	else if (TestVoiceBit(g_ListenYes[iReceiver], iSender))
 	{
 		RETURN_META_VALUE_NEWPARAMS(MRES_IGNORED, bListen, &IVoiceServer::SetClientListening, (iReceiver, iSender, true));
 	}
@@ -177,6 +237,8 @@ bool SDKTools::OnSetClientListening(int iReceiver, int iSender, bool bListen)
 
 void SDKTools::OnClientDisconnecting(int client)
 {
+	InvalidateClientSnapshot(client);
+
 	if (g_hTimerSpeaking[client])
 	{
 		timersys->KillTimer(g_hTimerSpeaking[client]);
@@ -201,27 +263,14 @@ void SDKTools::OnClientDisconnecting(int client)
 			continue;
 		}
 
-		g_ClientMutes[i][client] = false;
-		g_ClientMutes[client][i] = false;
+		SetVoiceBit(g_ClientMutes[i], client, false);
 		
-		if (g_VoiceMap[i][client] != Listen_Default)
-		{
-			g_VoiceMap[i][client] = Listen_Default;
-			if (DecHookCount())
-			{
-				break;
-			}
-		}
-		if (g_VoiceMap[client][i] != Listen_Default)
-		{
-			g_VoiceMap[client][i] = Listen_Default;
-			if (DecHookCount())
-			{
-				break;
-			}
-		}
+		SetListenOverride(i, client, Listen_Default);
+		SetListenOverride(client, i, Listen_Default);
 	}
 
+	memset(g_ClientMutes[client], 0, sizeof(g_ClientMutes[client]));
+
 	if (g_VoiceFlags[client])
 	{
 		g_VoiceFlags[client] = SPEAK_NORMAL;
@@ -295,23 +344,15 @@ static cell_t SetClientListening(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Sender client %d is not connected", params[2]);
 	}
 
+	if (params[3] < Listen_Default || params[3] > Listen_Yes)
+	{
+		return pContext->ThrowNativeError("Invalid listen override %d", params[3]);
+	}
+
 	r = params[1];
 	s = params[2];
 	
-	if (g_VoiceMap[r][s] == Listen_Default && params[3] != Listen_Default)
-	{
-		g_VoiceMap[r][s] = (ListenOverride) params[3];
-		IncHookCount();
-	}
-	else if (g_VoiceMap[r][s] != Listen_Default && params[3] == Listen_Default)
-	{
-		g_VoiceMap[r][s] = (ListenOverride) params[3];
-		DecHookCount();
-	}
-	else
-	{
-		g_VoiceMap[r][s] = (ListenOverride) params[3];
-	}
+	SetListenOverride(r, s, (ListenOverride) params[3]);
 
 	return 1;
 }
@@ -340,7 +381,109 @@ static cell_t GetClientListening(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Sender client %d is not connected", params[2]);
 	}
 
-	return g_VoiceMap[params[1]][params[2]];
+	return GetListenOverride(params[1], params[2]);
+}
+
+static cell_t SetListenOverrideMany(IPluginContext *pContext, const cell_t *params)
+{
+	IGamePlayer *player = playerhelpers->GetGamePlayer(params[1]);
+	if (player == NULL)
+	{
+		return pContext->ThrowNativeError("Receiver client index %d is invalid", params[1]);
+	}
+	else if (!player->IsConnected())
+	{
+		return pContext->ThrowNativeError("Receiver client %d is not connected", params[1]);
+	}
+
+	if (params[4] < Listen_Default || params[4] > Listen_Yes)
+	{
+		return pContext->ThrowNativeError("Invalid listen override %d", params[4]);
+	}
+
+	cell_t *senders;
+	pContext->LocalToPhysAddr(params[2], &senders);
+	int numSenders = params[3];
+
+	/* Validate everything first so a bad index doesn't leave a half-applied row */
+	for (int i = 0; i < numSenders; i++)
+	{
+		player = playerhelpers->GetGamePlayer(senders[i]);
+		if (player == NULL)
+		{
+			return pContext->ThrowNativeError("Sender client index %d is invalid", senders[i]);
+		}
+		else if (!player->IsConnected())
+		{
+			return pContext->ThrowNativeError("Sender client %d is not connected", senders[i]);
+		}
+	}
+
+	for (int i = 0; i < numSenders; i++)
+	{
+		SetListenOverride(params[1], senders[i], (ListenOverride) params[4]);
+	}
+
+	return 1;
+}
+
+static cell_t SetListenOverrideTeam(IPluginContext *pContext, const cell_t *params)
+{
+	IGamePlayer *player = playerhelpers->GetGamePlayer(params[1]);
+	if (player == NULL)
+	{
+		return pContext->ThrowNativeError("Receiver client index %d is invalid", params[1]);
+	}
+	else if (!player->IsConnected())
+	{
+		return pContext->ThrowNativeError("Receiver client %d is not connected", params[1]);
+	}
+
+	if (params[3] < Listen_Default || params[3] > Listen_Yes)
+	{
+		return pContext->ThrowNativeError("Invalid listen override %d", params[3]);
+	}
+
+	int count = 0;
+	int max_clients = playerhelpers->GetMaxClients();
+	for (int i = 1; i <= max_clients; i++)
+	{
+		player = playerhelpers->GetGamePlayer(i);
+		if (!player->IsInGame())
+		{
+			continue;
+		}
+
+		IPlayerInfo *pInfo = player->GetPlayerInfo();
+		if (pInfo && pInfo->GetTeamIndex() == params[2])
+		{
+			SetListenOverride(params[1], i, (ListenOverride) params[3]);
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static cell_t ResetListenOverrides(IPluginContext *pContext, const cell_t *params)
+{
+	IGamePlayer *player = playerhelpers->GetGamePlayer(params[1]);
+	if (player == NULL)
+	{
+		return pContext->ThrowNativeError("Receiver client index %d is invalid", params[1]);
+	}
+	else if (!player->IsConnected())
+	{
+		return pContext->ThrowNativeError("Receiver client %d is not connected", params[1]);
+	}
+
+	int max_clients = playerhelpers->GetMaxClients();
+	for (int i = 1; i <= max_clients; i++)
+	{
+		SetListenOverride(params[1], i, Listen_Default);
+	}
+
+	return 1;
 }
 
 static cell_t IsClientMuted(IPluginContext *pContext, const cell_t *params)
@@ -367,7 +510,7 @@ static cell_t IsClientMuted(IPluginContext *pContext, const cell_t *params)
 		return pContext->ThrowNativeError("Mutee client %d is not connected", params[2]);
 	}
 
-	return g_ClientMutes[params[1]][params[2]];
+	return TestVoiceBit(g_ClientMutes[params[1]], params[2]);
 }
 
 /* FIXME: Presently if there's no hook present these natives will result in an invalid state.
@@ -405,6 +548,9 @@ sp_nativeinfo_t g_VoiceNatives[] =
 	{"GetClientListening",			GetClientListening},
 	{"SetListenOverride",			SetClientListening},
 	{"GetListenOverride",			GetClientListening},
+	{"SetListenOverrideMany",		SetListenOverrideMany},
+	{"SetListenOverrideTeam",		SetListenOverrideTeam},
+	{"ResetListenOverrides",		ResetListenOverrides},
 	{"IsClientMuted",				IsClientMuted},
 	{NULL,							NULL},
 };
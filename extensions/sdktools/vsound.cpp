@@ -31,6 +31,9 @@
 
 #include "vsound.h"
 #include <IForwardSys.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 SH_DECL_HOOK8_void(IVEngineServer, EmitAmbientSound, SH_NOATTRIB, 0, int, const Vector &, const char *, float, soundlevel_t, int, int, float);
 
@@ -643,26 +646,33 @@ RETURN_META_NEWPARAMS(
 #endif
 }
 
-bool GetSoundParams(CSoundParameters *soundParams, const char *soundname, cell_t entindex)
+#if SOURCE_ENGINE >= SE_PORTAL2
+typedef HSOUNDSCRIPTHASH SoundScriptIndex;
+#else
+typedef HSOUNDSCRIPTHANDLE SoundScriptIndex;
+#endif
+
+static bool LookupSoundScript(const char *soundname, SoundScriptIndex *index)
 {
 	if ( !soundname[0] )
 		return false;
 
 #if SOURCE_ENGINE == SE_CSGO || SOURCE_ENGINE == SE_BLADE || SOURCE_ENGINE == SE_MCV
-	HSOUNDSCRIPTHASH index = soundemitterbase->HashSoundName(soundname);
+	*index = soundemitterbase->HashSoundName(soundname);
 	
-	if(!soundemitterbase->IsValidHash(index))
-		return false;
+	return soundemitterbase->IsValidHash(*index);
 #else
 #if SOURCE_ENGINE >= SE_PORTAL2
-	HSOUNDSCRIPTHASH index = (HSOUNDSCRIPTHASH)soundemitterbase->GetSoundIndex(soundname);
+	*index = (HSOUNDSCRIPTHASH)soundemitterbase->GetSoundIndex(soundname);
 #else
-	HSOUNDSCRIPTHANDLE index = (HSOUNDSCRIPTHANDLE)soundemitterbase->GetSoundIndex(soundname);
+	*index = (HSOUNDSCRIPTHANDLE)soundemitterbase->GetSoundIndex(soundname);
 #endif // SOURCE_ENGINE >= SE_PORTAL2
-	if (!soundemitterbase->IsValidIndex(index))
-		return false;
+	return soundemitterbase->IsValidIndex(*index);
 #endif // SOURCE_ENGINE == SE_CSGO || SOURCE_ENGINE == SE_BLADE || SOURCE_ENGINE == SE_MCV
+}
 
+static bool GetSoundParamsForIndex(CSoundParameters *soundParams, const char *soundname, SoundScriptIndex index, cell_t entindex)
+{
 	gender_t gender = GENDER_NONE;
 
 	// I don't know if gender applies to any mutliplayer games, but just in case...
@@ -685,6 +695,15 @@ bool GetSoundParams(CSoundParameters *soundParams, const char *soundname, cell_t
 	return soundemitterbase->GetParametersForSoundEx(soundname, index, *soundParams, gender);
 }
 
+bool GetSoundParams(CSoundParameters *soundParams, const char *soundname, cell_t entindex)
+{
+	SoundScriptIndex index;
+	if (!LookupSoundScript(soundname, &index))
+		return false;
+
+	return GetSoundParamsForIndex(soundParams, soundname, index, entindex);
+}
+
 bool InternalPrecacheScriptSound(const char *soundname)
 {
 	int soundIndex = soundemitterbase->GetSoundIndex(soundname);
@@ -714,6 +733,91 @@ bool InternalPrecacheScriptSound(const char *soundname)
 	return true;
 }
 
+/**
+ * Prepared sounds are resolved once and then emitted by id, which skips the
+ * string marshalling of EmitSound and, for game sounds, the script lookup and
+ * precache that GetGameSoundParams does on every call.
+ */
+struct PreparedSound
+{
+	std::string name;
+	bool gameSound;
+	int channel;
+	int level;
+	int flags;
+	float volume;
+	int pitch;
+	SoundScriptIndex scriptIndex;
+	unsigned int serial;
+	cell_t next;
+};
+
+static std::vector<PreparedSound> s_PreparedSounds;
+static std::unordered_map<std::string, cell_t> s_PreparedSoundNames;
+static unsigned int s_PreparedSoundSerial = 1;
+
+void InvalidatePreparedSounds()
+{
+	/* Script indexes are only valid until the sound scripts are reloaded. */
+	s_PreparedSoundSerial++;
+}
+
+static cell_t AddPreparedSound(const PreparedSound &sound)
+{
+	cell_t last = 0;
+
+	auto iter = s_PreparedSoundNames.find(sound.name);
+	if (iter != s_PreparedSoundNames.end())
+	{
+		for (cell_t id = iter->second; id != 0; id = s_PreparedSounds[id - 1].next)
+		{
+			const PreparedSound &other = s_PreparedSounds[id - 1];
+			if (other.gameSound == sound.gameSound
+				&& other.channel == sound.channel
+				&& other.level == sound.level
+				&& other.flags == sound.flags
+				&& other.volume == sound.volume
+				&& other.pitch == sound.pitch)
+			{
+				return id;
+			}
+			last = id;
+		}
+	}
+
+	s_PreparedSounds.push_back(sound);
+	cell_t id = (cell_t)s_PreparedSounds.size();
+
+	if (last)
+	{
+		s_PreparedSounds[last - 1].next = id;
+	}
+	else
+	{
+		s_PreparedSoundNames[sound.name] = id;
+	}
+
+	return id;
+}
+
+static bool ResolvePreparedSound(PreparedSound &sound)
+{
+	if (sound.serial == s_PreparedSoundSerial)
+	{
+		return true;
+	}
+
+	if (!LookupSoundScript(sound.name.c_str(), &sound.scriptIndex))
+	{
+		return false;
+	}
+
+	InternalPrecacheScriptSound(sound.name.c_str());
+	sound.serial = s_PreparedSoundSerial;
+
+	return true;
+}
+
 /************************
 *                       *
 * Sound Related Natives *
@@ -817,6 +921,237 @@ static cell_t StopSound(IPluginContext *pContext, const cell_t *params)
 	return 1;
 }
 
+static void EngineEmitSound(IRecipientFilter &filter, int entity, int channel, const char *sample, float vol, int level, 
+	int flags, int pitch, const Vector *pOrigin, const Vector *pDir, CUtlVector<Vector> *pOrigVec, bool updatePos, 
+	float soundtime, int speakerentity)
+{
+#if SOURCE_ENGINE == SE_CSGO || SOURCE_ENGINE == SE_BLADE || SOURCE_ENGINE == SE_MCV
+	if (g_InSoundHook)
+	{
+		SH_CALL(enginesoundPatch, 
+			static_cast<int (IEngineSound::*)(IRecipientFilter &, int, int, const char*, unsigned int, const char*, float, 
+			soundlevel_t, int, int, int, const Vector *, const Vector *, CUtlVector<Vector> *, bool, float, int, void *)>
+			(&IEngineSound::EmitSound))
+			(filter, 
+			entity, 
+			channel, 
+			sample, 
+			-1, 
+			sample, 
+			vol, 
+			(soundlevel_t)level, 
+			0, 
+			flags, 
+			pitch, 
+			pOrigin,
+			pDir,
+			pOrigVec,
+			updatePos,
+			soundtime,
+			speakerentity,
+			nullptr);
+	}
+	else
+	{
+		engsound->EmitSound(filter, 
+			entity, 
+			channel, 
+			sample, 
+			-1, 
+			sample, 
+			vol, 
+			(soundlevel_t)level, 
+			0, 
+			flags, 
+			pitch, 
+			pOrigin,
+			pDir,
+			pOrigVec,
+			updatePos,
+			soundtime,
+			speakerentity,
+			nullptr);
+	}
+#elif SOURCE_ENGINE >= SE_PORTAL2
+	if (g_InSoundHook)
+	{
+		SH_CALL(enginesoundPatch, 
+			static_cast<int (IEngineSound::*)(IRecipientFilter &, int, int, const char*, unsigned int, const char*, float, 
+			soundlevel_t, int, int, int, const Vector *, const Vector *, CUtlVector<Vector> *, bool, float, int)>
+			(&IEngineSound::EmitSound))
+			(filter, 
+			entity, 
+			channel, 
+			sample, 
+			-1, 
+			sample, 
+			vol, 
+			(soundlevel_t)level, 
+			0, 
+			flags, 
+			pitch, 
+			pOrigin,
+			pDir,
+			pOrigVec,
+			updatePos,
+			soundtime,
+			speakerentity);
+	}
+	else
+	{
+		engsound->EmitSound(filter, 
+			entity, 
+			channel, 
+			sample, 
+			-1, 
+			sample, 
+			vol, 
+			(soundlevel_t)level, 
+			0, 
+			flags, 
+			pitch, 
+			pOrigin,
+			pDir,
+			pOrigVec,
+			updatePos,
+			soundtime,
+			speakerentity);
+	}
+#elif SOURCE_ENGINE == SE_CSS || SOURCE_ENGINE == SE_HL2DM || SOURCE_ENGINE == SE_DODS || SOURCE_ENGINE == SE_SDK2013 \
+|| SOURCE_ENGINE == SE_BMS || SOURCE_ENGINE == SE_TF2 || SOURCE_ENGINE == SE_PVKII
+	if (g_InSoundHook)
+	{
+		SH_CALL(enginesoundPatch, 
+			static_cast<void (IEngineSound::*)(IRecipientFilter &, int, int, const char*, float, 
+			soundlevel_t, int, int, int, const Vector *, const Vector *, CUtlVector<Vector> *, bool, float, int)>
+			(&IEngineSound::EmitSound))
+			(filter, 
+			entity, 
+			channel, 
+			sample, 
+			vol, 
+			(soundlevel_t)level, 
+			flags, 
+			pitch, 
+			0, 
+			pOrigin,
+			pDir,
+			pOrigVec,
+			updatePos,
+			soundtime,
+			speakerentity);
+	}
+	else
+	{
+		engsound->EmitSound(filter, 
+			entity, 
+			channel, 
+			sample, 
+			vol, 
+			(soundlevel_t)level, 
+			flags, 
+			pitch, 
+			0, 
+			pOrigin,
+			pDir,
+			pOrigVec,
+			updatePos,
+			soundtime,
+			speakerentity);
+	}
+#else
+	if (g_InSoundHook)
+	{
+		SH_CALL(enginesoundPatch, 
+			static_cast<void (IEngineSound::*)(IRecipientFilter &, int, int, const char*, float, 
+			soundlevel_t, int, int, const Vector *, const Vector *, CUtlVector<Vector> *, bool, float, int)>
+			(&IEngineSound::EmitSound))
+			(filter, 
+			entity, 
+			channel, 
+			sample, 
+			vol, 
+			(soundlevel_t)level, 
+			flags, 
+			pitch, 
+			pOrigin,
+			pDir,
+			pOrigVec,
+			updatePos,
+			soundtime,
+			speakerentity);
+	}
+	else
+	{
+		engsound->EmitSound(filter, 
+			entity, 
+			channel, 
+			sample, 
+			vol, 
+			(soundlevel_t)level, 
+			flags, 
+			pitch, 
+			pOrigin,
+			pDir,
+			pOrigVec,
+			updatePos,
+			soundtime,
+			speakerentity);
+	}
+#endif
+}
+
+static void InternalEmitSound(CellRecipientFilter &crf, int entity, int channel, const char *sample, float vol, int level, 
+	int flags, int pitch, const Vector *pOrigin, const Vector *pDir, CUtlVector<Vector> *pOrigVec, bool updatePos, 
+	float soundtime, int speakerentity)
+{
+	/* If we're going to a "local player" and this is a dedicated server,
+	 * intelligently redirect each sound.
+	 */
+
+	if (entity == -2 && engine->IsDedicatedServer())
+	{
+		int numClients = crf.GetRecipientCount();
+		for (int i = 0; i < numClients; i++)
+		{
+			cell_t player[1];
+			player[0] = crf.GetRecipientIndex(i);
+
+			CellRecipientFilter single;
+			single.Initialize(player, 1);
+			EngineEmitSound(single, 
+				player[0], 
+				channel, 
+				sample, 
+				vol, 
+				level, 
+				flags, 
+				pitch, 
+				pOrigin, 
+				pDir, 
+				pOrigVec, 
+				updatePos, 
+				soundtime, 
+				speakerentity);
+		}
+	} else {
+		EngineEmitSound(crf, 
+			entity, 
+			channel, 
+			sample, 
+			vol, 
+			level, 
+			flags, 
+			pitch, 
+			pOrigin, 
+			pDir, 
+			pOrigVec, 
+			updatePos, 
+			soundtime, 
+			speakerentity);
+	}
+}
+
 static cell_t EmitSound(IPluginContext *pContext, const cell_t *params)
 {
 	cell_t *addr, *cl_array;
@@ -895,371 +1230,20 @@ static cell_t EmitSound(IPluginContext *pContext, const cell_t *params)
 		}
 	}
 
-	/* If we're going to a "local player" and this is a dedicated server,
-	 * intelligently redirect each sound.
-	 */
-
-	if (entity == -2 && engine->IsDedicatedServer())
-	{
-		for (unsigned int i = 0; i < numClients; i++)
-		{
-			cell_t player[1];
-			player[0] = cl_array[i];
-			crf.Reset();
-			crf.Initialize(player, 1);
-#if SOURCE_ENGINE == SE_CSGO || SOURCE_ENGINE == SE_BLADE || SOURCE_ENGINE == SE_MCV
-			if (g_InSoundHook)
-			{
-				SH_CALL(enginesoundPatch, 
-					static_cast<int (IEngineSound::*)(IRecipientFilter &, int, int, const char*, unsigned int, const char*, float, 
-					soundlevel_t, int, int, int, const Vector *, const Vector *, CUtlVector<Vector> *, bool, float, int, void *)>
-
-					(&IEngineSound::EmitSound))
-					(crf, 
-					player[0], 
-					channel, 
-					sample, 
-					-1, 
-					sample, 
-					vol, 
-					(soundlevel_t)level, 
-					0, 
-					flags, 
-					pitch, 
-					pOrigin,
-					pDir,
-					pOrigVec,
-					updatePos,
-					soundtime,
-					speakerentity,
-					nullptr);
-			}
-			else
-			{
-				engsound->EmitSound(crf, 
-					player[0], 
-					channel, 
-					sample, 
-					-1, 
-					sample, 
-					vol, 
-					(soundlevel_t)level, 
-					0, 
-					flags, 
-					pitch, 
-					pOrigin,
-					pDir,
-					pOrigVec,
-					updatePos,
-					soundtime,
-					speakerentity,
-					nullptr);
-			}
-#elif SOURCE_ENGINE >= SE_PORTAL2
-			if (g_InSoundHook)
-			{
-				SH_CALL(enginesoundPatch, 
-					static_cast<int (IEngineSound::*)(IRecipientFilter &, int, int, const char*, unsigned int, const char*, float, 
-					soundlevel_t, int, int, int, const Vector *, const Vector *, CUtlVector<Vector> *, bool, float, int)>
-
-					(&IEngineSound::EmitSound))
-					(crf, 
-					player[0], 
-					channel, 
-					sample, 
-					-1, 
-					sample, 
-					vol, 
-					(soundlevel_t)level, 
-					0, 
-					flags, 
-					pitch, 
-					pOrigin,
-					pDir,
-					pOrigVec,
-					updatePos,
-					soundtime,
-					speakerentity);
-			}
-			else
-			{
-				engsound->EmitSound(crf, 
-					player[0], 
-					channel, 
-					sample, 
-					-1, 
-					sample, 
-					vol, 
-					(soundlevel_t)level, 
-					0, 
-					flags, 
-					pitch, 
-					pOrigin,
-					pDir,
-					pOrigVec,
-					updatePos,
-					soundtime,
-					speakerentity);
-			}
-#elif SOURCE_ENGINE == SE_CSS || SOURCE_ENGINE == SE_HL2DM || SOURCE_ENGINE == SE_DODS || SOURCE_ENGINE == SE_SDK2013 \
-	|| SOURCE_ENGINE == SE_BMS || SOURCE_ENGINE == SE_TF2 || SOURCE_ENGINE == SE_PVKII
-			if (g_InSoundHook)
-			{
-				SH_CALL(enginesoundPatch, 
-					static_cast<void (IEngineSound::*)(IRecipientFilter &, int, int, const char*, float, 
-					soundlevel_t, int, int, int, const Vector *, const Vector *, CUtlVector<Vector> *, bool, float, int)>
-					(&IEngineSound::EmitSound))
-					(crf, 
-					player[0], 
-					channel, 
-					sample, 
-					vol, 
-					(soundlevel_t)level, 
-					flags, 
-					pitch, 
-					0, 
-					pOrigin,
-					pDir,
-					pOrigVec,
-					updatePos,
-					soundtime,
-					speakerentity);
-			}
-			else
-			{
-				engsound->EmitSound(crf, 
-					player[0], 
-					channel, 
-					sample, 
-					vol, 
-					(soundlevel_t)level, 
-					flags, 
-					pitch, 
-					0, 
-					pOrigin,
-					pDir,
-					pOrigVec,
-					updatePos,
-					soundtime,
-					speakerentity);
-			}
-#else
-			if (g_InSoundHook)
-			{
-				SH_CALL(enginesoundPatch, 
-					static_cast<void (IEngineSound::*)(IRecipientFilter &, int, int, const char*, float, 
-					soundlevel_t, int, int, const Vector *, const Vector *, CUtlVector<Vector> *, bool, float, int)>
-					(&IEngineSound::EmitSound))
-					(crf, 
-					player[0], 
-					channel, 
-					sample, 
-					vol, 
-					(soundlevel_t)level, 
-					flags, 
-					pitch, 
-					pOrigin,
-					pDir,
-					pOrigVec,
-					updatePos,
-					soundtime,
-					speakerentity);
-			}
-			else
-			{
-				engsound->EmitSound(crf, 
-					player[0], 
-					channel, 
-					sample, 
-					vol, 
-					(soundlevel_t)level, 
-					flags, 
-					pitch, 
-					pOrigin,
-					pDir,
-					pOrigVec,
-					updatePos,
-					soundtime,
-					speakerentity);
-			}
-#endif
-		}
-	} else {
-#if SOURCE_ENGINE == SE_CSGO || SOURCE_ENGINE == SE_BLADE || SOURCE_ENGINE == SE_MCV
-		if (g_InSoundHook)
-		{
-			SH_CALL(enginesoundPatch, 
-				static_cast<int (IEngineSound::*)(IRecipientFilter &, int, int, const char*, unsigned int, const char*, float, 
-				soundlevel_t, int, int, int, const Vector *, const Vector *, CUtlVector<Vector> *, bool, float, int, void *)>
-				(&IEngineSound::EmitSound))
-				(crf, 
-				entity, 
-				channel, 
-				sample, 
-				-1, 
-				sample, 
-				vol, 
-				(soundlevel_t)level, 
-				0, 
-				flags, 
-				pitch, 
-				pOrigin,
-				pDir,
-				pOrigVec,
-				updatePos,
-				soundtime,
-				speakerentity,
-				nullptr);
-		}
-		else
-		{
-			engsound->EmitSound(crf, 
-				entity, 
-				channel, 
-				sample, 
-				-1, 
-				sample, 
-				vol, 
-				(soundlevel_t)level, 
-				0, 
-				flags, 
-				pitch, 
-				pOrigin,
-				pDir,
-				pOrigVec,
-				updatePos,
-				soundtime,
-				speakerentity,
-				nullptr);
-		}
-#elif SOURCE_ENGINE >= SE_PORTAL2
-		if (g_InSoundHook)
-		{
-			SH_CALL(enginesoundPatch, 
-				static_cast<int (IEngineSound::*)(IRecipientFilter &, int, int, const char*, unsigned int, const char*, float, 
-				soundlevel_t, int, int, int, const Vector *, const Vector *, CUtlVector<Vector> *, bool, float, int)>
-				(&IEngineSound::EmitSound))
-				(crf, 
-				entity, 
-				channel, 
-				sample, 
-				-1, 
-				sample, 
-				vol, 
-				(soundlevel_t)level, 
-				0, 
-				flags, 
-				pitch, 
-				pOrigin,
-				pDir,
-				pOrigVec,
-				updatePos,
-				soundtime,
-				speakerentity);
-		}
-		else
-		{
-			engsound->EmitSound(crf, 
-				entity, 
-				channel, 
-				sample, 
-				-1, 
-				sample, 
-				vol, 
-				(soundlevel_t)level, 
-				0, 
-				flags, 
-				pitch, 
-				pOrigin,
-				pDir,
-				pOrigVec,
-				updatePos,
-				soundtime,
-				speakerentity);
-		}
-#elif SOURCE_ENGINE == SE_CSS || SOURCE_ENGINE == SE_HL2DM || SOURCE_ENGINE == SE_DODS || SOURCE_ENGINE == SE_SDK2013 \
-	|| SOURCE_ENGINE == SE_BMS || SOURCE_ENGINE == SE_TF2 || SOURCE_ENGINE == SE_PVKII
-		if (g_InSoundHook)
-		{
-			SH_CALL(enginesoundPatch, 
-				static_cast<void (IEngineSound::*)(IRecipientFilter &, int, int, const char*, float, 
-				soundlevel_t, int, int, int, const Vector *, const Vector *, CUtlVector<Vector> *, bool, float, int)>
-				(&IEngineSound::EmitSound))
-				(crf, 
-				entity, 
-				channel, 
-				sample, 
-				vol, 
-				(soundlevel_t)level, 
-				flags, 
-				pitch, 
-				0, 
-				pOrigin,
-				pDir,
-				pOrigVec,
-				updatePos,
-				soundtime,
-				speakerentity);
-		}
-		else
-		{
-			engsound->EmitSound(crf, 
-				entity, 
-				channel, 
-				sample, 
-				vol, 
-				(soundlevel_t)level, 
-				flags, 
-				pitch, 
-				0, 
-				pOrigin,
-				pDir,
-				pOrigVec,
-				updatePos,
-				soundtime,
-				speakerentity);
-		}
-#else
-		if (g_InSoundHook)
-		{
-			SH_CALL(enginesoundPatch, 
-				static_cast<void (IEngineSound::*)(IRecipientFilter &, int, int, const char*, float, 
-				soundlevel_t, int, int, const Vector *, const Vector *, CUtlVector<Vector> *, bool, float, int)>
-				(&IEngineSound::EmitSound))
-				(crf, 
-				entity, 
-				channel, 
-				sample, 
-				vol, 
-				(soundlevel_t)level, 
-				flags, 
-				pitch, 
-				pOrigin,
-				pDir,
-				pOrigVec,
-				updatePos,
-				soundtime,
-				speakerentity);
-		}
-		else
-		{
-			engsound->EmitSound(crf, 
-				entity, 
-				channel, 
-				sample, 
-				vol, 
-				(soundlevel_t)level, 
-				flags, 
-				pitch, 
-				pOrigin,
-				pDir,
-				pOrigVec,
-				updatePos,
-				soundtime,
-				speakerentity);
-		}
-#endif
-	}
+	InternalEmitSound(crf,
+		entity,
+		channel,
+		sample,
+		vol,
+		level,
+		flags,
+		pitch,
+		pOrigin,
+		pDir,
+		pOrigVec,
+		updatePos,
+		soundtime,
+		speakerentity);
 
 	return 1;
 }
@@ -1630,6 +1614,166 @@ static cell_t smn_PrecacheScriptSound(IPluginContext *pContext, const cell_t *pa
 	return InternalPrecacheScriptSound(soundname);
 }
 
+static bool IsValidPreparedSound(cell_t id)
+{
+	return id > 0 && id <= (cell_t)s_PreparedSounds.size();
+}
+
+static void ReadSoundVector(IPluginContext *pContext, cell_t param, Vector *vec, Vector **ppVec)
+{
+	cell_t *addr;
+	pContext->LocalToPhysAddr(param, &addr);
+	if (addr == pContext->GetNullRef(SP_NULL_VECTOR))
+	{
+		*ppVec = NULL;
+		return;
+	}
+
+	vec->x = sp_ctof(addr[0]);
+	vec->y = sp_ctof(addr[1]);
+	vec->z = sp_ctof(addr[2]);
+	*ppVec = vec;
+}
+
+static bool InternalEmitPreparedSound(IPluginContext *pContext, CellRecipientFilter &crf, cell_t id, const cell_t *params)
+{
+	PreparedSound &sound = s_PreparedSounds[id - 1];
+
+	int entity = SoundReferenceToIndex(params[1]);
+	int flags = params[2];
+	int speakerentity = params[3];
+
+	Vector origin, dir;
+	Vector *pOrigin, *pDir;
+	ReadSoundVector(pContext, params[4], &origin, &pOrigin);
+	ReadSoundVector(pContext, params[5], &dir, &pDir);
+
+	bool updatePos = params[6] ? true : false;
+	float soundtime = sp_ctof(params[7]);
+
+	if (!sound.gameSound)
+	{
+		InternalEmitSound(crf, entity, sound.channel, sound.name.c_str(), sound.volume, sound.level,
+			sound.flags | flags, sound.pitch, pOrigin, pDir, NULL, updatePos, soundtime, speakerentity);
+		return true;
+	}
+
+	/* The script parameters are picked per emit so rndwave and pitch ranges still apply. */
+	CSoundParameters soundParams;
+	if (!ResolvePreparedSound(sound)
+		|| !GetSoundParamsForIndex(&soundParams, sound.name.c_str(), sound.scriptIndex, entity))
+	{
+		return false;
+	}
+
+	InternalEmitSound(crf, entity, soundParams.channel, soundParams.soundname, soundParams.volume, soundParams.soundlevel,
+		flags, soundParams.pitch, pOrigin, pDir, NULL, updatePos, soundtime, speakerentity);
+
+	return true;
+}
+
+// native int PrepareSound(const char[] sample, int channel, int level, int flags, float volume, int pitch)
+static cell_t smn_PrepareSound(IPluginContext *pContext, const cell_t *params)
+{
+	char *sample;
+	pContext->LocalToString(params[1], &sample);
+
+	if (!sample[0])
+	{
+		return pContext->ThrowNativeError("Sound sample cannot be empty");
+	}
+
+	PreparedSound sound;
+	sound.name = sample;
+	sound.gameSound = false;
+	sound.channel = params[2];
+	sound.level = params[3];
+	sound.flags = params[4];
+	sound.volume = sp_ctof(params[5]);
+	sound.pitch = params[6];
+	sound.scriptIndex = 0;
+	sound.serial = 0;
+	sound.next = 0;
+
+	return AddPreparedSound(sound);
+}
+
+// native int PrepareGameSound(const char[] gameSound)
+static cell_t smn_PrepareGameSound(IPluginContext *pContext, const cell_t *params)
+{
+	char *soundname;
+	pContext->LocalToString(params[1], &soundname);
+
+	PreparedSound sound;
+	sound.name = soundname;
+	sound.gameSound = true;
+	sound.channel = 0;
+	sound.level = 0;
+	sound.flags = 0;
+	sound.volume = 0.0f;
+	sound.pitch = 0;
+	sound.scriptIndex = 0;
+	sound.serial = 0;
+	sound.next = 0;
+
+	if (!ResolvePreparedSound(sound))
+	{
+		return 0;
+	}
+
+	return AddPreparedSound(sound);
+}
+
+// native bool EmitPreparedSound(const int[] clients, int numClients, int soundId, int entity, int flags, int speakerentity, const float origin[3], const float dir[3], bool updatePos, float soundtime)
+static cell_t smn_EmitPreparedSound(IPluginContext *pContext, const cell_t *params)
+{
+	cell_t *cl_array;
+	pContext->LocalToPhysAddr(params[1], &cl_array);
+	unsigned int numClients = params[2];
+
+	if (!IsValidPreparedSound(params[3]))
+	{
+		return pContext->ThrowNativeError("Invalid prepared sound id %d", params[3]);
+	}
+
+	/* Client validation */
+	for (unsigned int i = 0; i < numClients; i++)
+	{
+		int client = cl_array[i];
+		IGamePlayer *pPlayer = playerhelpers->GetGamePlayer(client);
+
+		if (!pPlayer)
+		{
+			return pContext->ThrowNativeError("Client index %d is invalid", client);
+		} else if (!pPlayer->IsInGame()) {
+			return pContext->ThrowNativeError("Client %d is not in game", client);
+		}
+	}
+
+	CellRecipientFilter crf;
+	crf.Initialize(cl_array, numClients);
+
+	return InternalEmitPreparedSound(pContext, crf, params[3], &params[3]);
+}
+
+// native bool EmitPreparedSoundToAll(int soundId, int entity, int flags, int speakerentity, const float origin[3], const float dir[3], bool updatePos, float soundtime)
+static cell_t smn_EmitPreparedSoundToAll(IPluginContext *pContext, const cell_t *params)
+{
+	if (!IsValidPreparedSound(params[1]))
+	{
+		return pContext->ThrowNativeError("Invalid prepared sound id %d", params[1]);
+	}
+
+	CellRecipientFilter crf;
+	crf.InitializeMatching(playerhelpers, ClientState_InGame);
+	if (!crf.GetRecipientCount())
+	{
+		return false;
+	}
+
+	return InternalEmitPreparedSound(pContext, crf, params[1], &params[1]);
+}
+
 sp_nativeinfo_t g_SoundNatives[] = 
 {
 	{"EmitAmbientSound",		EmitAmbientSound},
@@ -1647,5 +1791,9 @@ sp_nativeinfo_t g_SoundNatives[] =
 	{"GetDistGainFromSoundLevel", smn_GetDistGainFromSoundLevel},
 	{"GetGameSoundParams",		smn_GetGameSoundParams},
 	{"PrecacheScriptSound", smn_PrecacheScriptSound},
+	{"PrepareSound",			smn_PrepareSound},
+	{"PrepareGameSound",		smn_PrepareGameSound},
+	{"EmitPreparedSound",		smn_EmitPreparedSound},
+	{"EmitPreparedSoundToAll",	smn_EmitPreparedSoundToAll},
 	{NULL,						NULL},
 };
@@ -107,4 +107,6 @@ private:
 
 extern SoundHooks s_SoundHooks;
 
+void InvalidatePreparedSounds();
+
 #endif //_INCLUDE_SOURCEMOD_VSOUND_H_
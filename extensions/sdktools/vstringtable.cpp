@@ -30,6 +30,66 @@
  */
 
 #include "extension.h"
+#include <ctype.h>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Hashed mirror of a string table. Engine lookups walk the table, so we keep
+ * our own index, catching up on strings appended since the last lookup. Like
+ * the engine's dictionary, lookups are case-insensitive.
+ */
+struct StringTableMirror
+{
+	INetworkStringTable *table = NULL;
+	int mirrored = 0;
+	std::unordered_map<std::string, int> indexes;
+};
+
+static std::unordered_map<TABLEID, StringTableMirror> s_StringTableMirrors;
+
+static void LowerString(const char *str, std::string &out)
+{
+	out.assign(str);
+	for (size_t i = 0; i < out.size(); i++)
+	{
+		out[i] = (char)tolower((unsigned char)out[i]);
+	}
+}
+
+static StringTableMirror &SyncStringTableMirror(TABLEID idx, INetworkStringTable *pTable)
+{
+	StringTableMirror &mirror = s_StringTableMirrors[idx];
+	int numStrings = pTable->GetNumStrings();
+
+	/* Tables are recreated on map change; strings are otherwise only appended */
+	if (mirror.table != pTable || numStrings < mirror.mirrored)
+	{
+		mirror.table = pTable;
+		mirror.mirrored = 0;
+		mirror.indexes.clear();
+	}
+
+	std::string key;
+	for (; mirror.mirrored < numStrings; mirror.mirrored++)
+	{
+		const char *str = pTable->GetString(mirror.mirrored);
+		if (!str)
+		{
+			continue;
+		}
+
+		LowerString(str, key);
+		mirror.indexes.emplace(key, mirror.mirrored);
+	}
+
+	return mirror;
+}
+
+void ClearStringTableMirrors()
+{
+	s_StringTableMirrors.clear();
+}
 
 static cell_t LockStringTables(IPluginContext *pContext, const cell_t *params)
 {
@@ -113,15 +173,19 @@ static cell_t FindStringIndex(IPluginContext *pContext, const cell_t *params)
 
 	pContext->LocalToString(params[2], &str);
 
-	int strindex = pTable->FindStringIndex(str);
+	StringTableMirror &mirror = SyncStringTableMirror(idx, pTable);
+
+	std::string key;
+	LowerString(str, key);
 
 	// INVALID_STRING_INDEX is 65535 at time of writing, but already defined in sp inc files as -1
-	if (strindex == INVALID_STRING_INDEX)
+	auto iter = mirror.indexes.find(key);
+	if (iter == mirror.indexes.end())
 	{
 		return -1;
 	}
 
-	return strindex;
+	return iter->second;
 }
 
 static cell_t ReadStringTable(IPluginContext *pContext, const cell_t *params)
@@ -34,7 +34,7 @@
 #include "SqQuery.h"
 
 SqDatabase::SqDatabase(sqlite3 *sq3, bool persistent) : 
-	m_sq3(sq3), m_Persistent(persistent)
+	m_sq3(sq3), m_Persistent(persistent), m_SnapshotInterval(0), m_SnapshotStop(false)
 {
 	// DBI, for historical reasons, guarantees an initial refcount of 1.
 	AddRef();
@@ -44,9 +44,74 @@ SqDatabase::~SqDatabase()
 {
 	if (m_Persistent)
 		g_SqDriver.RemovePersistent(this);
+	StopSnapshots();
+	m_StmtCache.Clear();
 	sqlite3_close(m_sq3);
 }
 
+void SqDatabase::StartSnapshots(const char *path, unsigned int interval)
+{
+	m_SnapshotPath = path;
+	m_SnapshotInterval = interval;
+	if (interval)
+	{
+		m_SnapshotThread = std::thread(&SqDatabase::RunSnapshots, this);
+	}
+}
+
+void SqDatabase::StopSnapshots()
+{
+	if (m_SnapshotPath.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_SnapshotLock);
+		m_SnapshotStop = true;
+	}
+	m_SnapshotCond.notify_one();
+	if (m_SnapshotThread.joinable())
+		m_SnapshotThread.join();
+
+	/* Whatever changed since the last snapshot. */
+	if (!Snapshot())
+		smutils->LogError(myself, "Could not save in-memory database to \"%s\"", m_SnapshotPath.c_str());
+	m_SnapshotPath.clear();
+}
+
+void SqDatabase::RunSnapshots()
+{
+	std::unique_lock<std::mutex> lock(m_SnapshotLock);
+	while (!m_SnapshotStop)
+	{
+		m_SnapshotCond.wait_for(lock, std::chrono::seconds(m_SnapshotInterval));
+		if (m_SnapshotStop)
+			break;
+
+		lock.unlock();
+		Snapshot();
+		lock.lock();
+	}
+}
+
+bool SqDatabase::Snapshot()
+{
+	std::lock_guard<std::recursive_mutex> lock(m_FullLock);
+
+	/* Don't persist half of someone's transaction; try again next time. */
+	if (!sqlite3_get_autocommit(m_sq3))
+		return true;
+
+	sqlite3 *disk;
+	bool saved = false;
+	if (sqlite3_open_v2(m_SnapshotPath.c_str(), &disk, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL) == SQLITE_OK)
+	{
+		sqlite3_busy_handler(disk, busy_handler, NULL);
+		saved = SqCopyDatabase(m_sq3, disk);
+	}
+	sqlite3_close(disk);
+	return saved;
+}
+
 void SqDatabase::IncReferenceCount()
 {
 	AddRef();
@@ -80,26 +145,60 @@ IDBDriver *SqDatabase::GetDriver()
 
 bool SqDatabase::QuoteString(const char *str, char buffer[], size_t maxlen, size_t *newSize)
 {
-	unsigned long size = static_cast<unsigned long>(strlen(str));
-	unsigned long needed = size * 2 + 1;
+	return QuoteStringEx(str, strlen(str), buffer, maxlen, newSize);
+}
+
+bool SqDatabase::QuoteStringEx(const char *str, size_t len, char buffer[], size_t maxlen, size_t *newSize)
+{
+	size_t needed = len * 2 + 1;
 
 	if (maxlen < needed)
 	{
 		if (newSize != NULL)
 		{
-			*newSize = (size_t)needed;
+			*newSize = needed;
 		}
 		return false;
 	}
 
-	char *res = sqlite3_snprintf(static_cast<int>(maxlen), buffer, "%q", str);
+	/* Same as sqlite3_snprintf's %q: double every single quote. Done by hand
+	 * so the source needs no terminator and the output is not rescanned.
+	 */
+	char *out = buffer;
+	for (size_t i = 0; i < len && str[i] != '\0'; i++)
+	{
+		if (str[i] == '\'')
+		{
+			*out++ = '\'';
+		}
+		*out++ = str[i];
+	}
+	*out = '\0';
 
-	if (res != NULL && newSize != NULL)
+	if (newSize != NULL)
 	{
-		*newSize = strlen(buffer);
+		*newSize = (size_t)(out - buffer);
 	}
 
-	return (res != NULL);
+	return true;
+}
+
+size_t SqDatabase::QuoteStrings(const char * const *strs, const size_t *lengths, size_t count,
+	char buffer[], size_t maxlen, size_t *sizes)
+{
+	size_t i;
+	for (i = 0; i < count; i++)
+	{
+		size_t written;
+		if (!SqDatabase::QuoteStringEx(strs[i], lengths[i], buffer, maxlen, &written))
+		{
+			break;
+		}
+		sizes[i] = written;
+		buffer += written + 1;
+		maxlen -= written + 1;
+	}
+	return i;
 }
 
 unsigned int SqDatabase::GetInsertID()
@@ -126,7 +225,10 @@ bool SqDatabase::DoSimpleQuery(const char *query)
 /* this sounds like daiquiri.. i'm tired. */
 IQuery *SqDatabase::DoQuery(const char *query)
 {
-	IPreparedQuery *pQuery = PrepareQuery(query, NULL, 0, NULL);
+	/* One-off queries tend to have their values inlined, keep them out of 
+	 * the statement cache.
+	 */
+	IPreparedQuery *pQuery = PrepareStatement(query, strlen(query), NULL, 0, false);
 	if (!pQuery)
 	{
 		return NULL;
@@ -165,6 +267,36 @@ IQuery *SqDatabase::DoQueryEx(const char *query, size_t len)
 	return pQuery;
 }
 
+IResultStream *SqDatabase::DoQueryStream(const char *query, size_t len)
+{
+	sqlite3_stmt *stmt = NULL;
+	if ((m_LastErrorCode = sqlite3_prepare_v2(m_sq3, query, len, &stmt, NULL)) != SQLITE_OK
+		|| !stmt)
+	{
+		if (m_LastErrorCode != SQLITE_OK)
+		{
+			m_LastError.assign(sqlite3_errmsg(m_sq3));
+		} else {
+			m_LastError.assign("Invalid query string");
+			m_LastErrorCode = SQLITE_ERROR;
+		}
+		return NULL;
+	}
+
+	/* Step once up front so execution errors fail the query, as DoQuery() would */
+	int rc = sqlite3_step(stmt);
+	if (rc != SQLITE_ROW && rc != SQLITE_DONE)
+	{
+		m_LastErrorCode = rc;
+		m_LastError.assign(sqlite3_errmsg(m_sq3));
+		sqlite3_finalize(stmt);
+		return NULL;
+	}
+
+	m_LastErrorCode = SQLITE_OK;
+	return new SqResultStream(this, stmt, rc == SQLITE_ROW);
+}
+
 unsigned int SqDatabase::GetAffectedRowsForQuery(IQuery *query)
 {
 	return static_cast<SqQuery*>(query)->GetAffectedRows();
@@ -179,26 +311,7 @@ IPreparedQuery *SqDatabase::PrepareQuery(const char *query,
 										 size_t maxlength, 
 										 int *errCode/* =NULL */)
 {
-	sqlite3_stmt *stmt = NULL;
-	if ((m_LastErrorCode = sqlite3_prepare_v2(m_sq3, query, -1, &stmt, NULL)) != SQLITE_OK
-		|| !stmt)
-	{
-		const char *msg;
-		if (m_LastErrorCode != SQLITE_OK)
-		{
-			msg = sqlite3_errmsg(m_sq3);
-		} else {
-			msg = "Invalid query string";
-			m_LastErrorCode = SQLITE_ERROR;
-		}
-		if (error)
-		{
-			strncopy(error, msg, maxlength);
-		}
-		m_LastError.assign(msg);
-		return NULL;
-	}
-	return new SqQuery(this, stmt);
+	return PrepareStatement(query, strlen(query), error, maxlength, true);
 }
 
 IPreparedQuery *SqDatabase::PrepareQueryEx(const char *query, 
@@ -206,8 +319,18 @@ IPreparedQuery *SqDatabase::PrepareQueryEx(const char *query,
 										   char *error, 
 										   size_t maxlength, 
 										   int *errCode/* =NULL */)
+{
+	return PrepareStatement(query, len, error, maxlength, false);
+}
+
+IPreparedQuery *SqDatabase::PrepareStatement(const char *query, size_t len, char *error, size_t maxlength, bool cache)
 {
 	sqlite3_stmt *stmt = NULL;
+	if (cache && m_StmtCache.Take(query, len, &stmt))
+	{
+		return new SqQuery(this, stmt, query, len);
+	}
+
 	if ((m_LastErrorCode = sqlite3_prepare_v2(m_sq3, query, len, &stmt, NULL)) != SQLITE_OK
 		|| !stmt)
 	{
@@ -226,9 +349,25 @@ IPreparedQuery *SqDatabase::PrepareQueryEx(const char *query,
 		m_LastError.assign(msg);
 		return NULL;
 	}
+
+	if (cache)
+	{
+		return new SqQuery(this, stmt, query, len);
+	}
 	return new SqQuery(this, stmt);
 }
 
+void SqDatabase::ReleaseStatement(const std::string &query, sqlite3_stmt *stmt)
+{
+	m_StmtCache.Give(query.c_str(), query.size(), stmt);
+}
+
+bool SqDatabase::GetStatementCacheStats(DBStatementCacheStats *stats)
+{
+	m_StmtCache.GetStats(stats);
+	return true;
+}
+
 sqlite3 *SqDatabase::GetDb()
 {
 	return m_sq3;
@@ -33,9 +33,23 @@
 #define _INCLUDE_SQLITE_SOURCEMOD_DATABASE_H_
 
 #include <am-refcounting-threadsafe.h>
+#include <condition_variable>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <sm_stmtcache.h>
 #include "SqDriver.h"
 
+/* Seconds between snapshots of an "in_memory" database, 0 = only on close */
+#define SQLITE_DEFAULT_SNAPSHOT_INTERVAL	60
+
+bool SqCopyDatabase(sqlite3 *from, sqlite3 *to);
+
+static inline void SqFinalizeStatement(sqlite3_stmt *stmt)
+{
+	sqlite3_finalize(stmt);
+}
+
 class SqDatabase
 	: public IDatabase,
 	  public ke::RefcountedThreadsafe<SqDatabase>
@@ -62,18 +76,38 @@ public:
 	unsigned int GetAffectedRowsForQuery(IQuery *query);
 	unsigned int GetInsertIDForQuery(IQuery *query);
 	bool SetCharacterSet(const char *characterset);
+	bool GetStatementCacheStats(DBStatementCacheStats *stats);
+	IResultStream *DoQueryStream(const char *query, size_t len);
+	bool QuoteStringEx(const char *str, size_t len, char buffer[], size_t maxlen, size_t *newSize);
+	size_t QuoteStrings(const char * const *strs, const size_t *lengths, size_t count,
+		char buffer[], size_t maxlen, size_t *sizes);
 public:
 	sqlite3 *GetDb();
+	void ReleaseStatement(const std::string &query, sqlite3_stmt *stmt);
 	void PrepareForForcedShutdown()
 	{
 		m_Persistent = false;
+		StopSnapshots();
 	}
+	void StartSnapshots(const char *path, unsigned int interval);
+private:
+	IPreparedQuery *PrepareStatement(const char *query, size_t len, char *error, size_t maxlength, bool cache);
+	void StopSnapshots();
+	void RunSnapshots();
+	bool Snapshot();
 private:
 	sqlite3 *m_sq3;
+	StatementCache<sqlite3_stmt *, SqFinalizeStatement> m_StmtCache;
 	std::recursive_mutex m_FullLock;
 	bool m_Persistent;
 	String m_LastError;
 	int m_LastErrorCode;
+	std::string m_SnapshotPath;
+	unsigned int m_SnapshotInterval;
+	std::thread m_SnapshotThread;
+	std::mutex m_SnapshotLock;
+	std::condition_variable m_SnapshotCond;
+	bool m_SnapshotStop;
 };
 
 #endif //_INCLUDE_SQLITE_SOURCEMOD_DATABASE_H_
@@ -167,6 +167,124 @@ Handle_t SqDriver::GetHandle()
 	return m_Handle;
 }
 
+static const char *FindOption(const DatabaseInfo *info, const char *key)
+{
+	if (info->dbiVersion < 11 || info->options == NULL)
+	{
+		return NULL;
+	}
+
+	for (const char *const *opt = info->options; opt[0] != NULL; opt += 2)
+	{
+		if (strcmp(opt[0], key) == 0)
+		{
+			return opt[1];
+		}
+	}
+
+	return NULL;
+}
+
+static bool IsInteger(const char *value)
+{
+	if (*value == '-')
+	{
+		value++;
+	}
+	if (*value == '\0')
+	{
+		return false;
+	}
+	for (; *value != '\0'; value++)
+	{
+		if (*value < '0' || *value > '9')
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool IsOneOf(const char *value, const char *const *choices)
+{
+	for (; *choices != NULL; choices++)
+	{
+		if (strcasecmp(value, *choices) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+struct SqPragma
+{
+	const char *name;
+	const char *const *choices;	/* NULL means any integer */
+};
+
+static const char *s_JournalModes[] = {"delete", "truncate", "persist", "memory", "wal", "off", NULL};
+static const char *s_SyncModes[] = {"off", "normal", "full", "extra", "0", "1", "2", "3", NULL};
+static const char *s_TempStores[] = {"default", "file", "memory", "0", "1", "2", NULL};
+
+static const SqPragma s_Pragmas[] =
+{
+	{"journal_mode",	s_JournalModes},
+	{"synchronous",		s_SyncModes},
+	{"temp_store",		s_TempStores},
+	{"mmap_size",		NULL},
+	{"cache_size",		NULL},
+};
+
+/* Applies the databases.cfg pragmas. Values are checked, since they go straight into SQL. */
+static bool ApplyPragmas(sqlite3 *sql, const DatabaseInfo *info, char *error, size_t maxlength)
+{
+	char query[128];
+	for (size_t i = 0; i < sizeof(s_Pragmas) / sizeof(s_Pragmas[0]); i++)
+	{
+		const SqPragma &pragma = s_Pragmas[i];
+		const char *value = FindOption(info, pragma.name);
+		if (value == NULL)
+		{
+			continue;
+		}
+
+		bool valid = pragma.choices ? IsOneOf(value, pragma.choices) : IsInteger(value);
+		if (!valid || strlen(value) > 32)
+		{
+			ke::SafeSprintf(error, maxlength, "Invalid value \"%s\" for \"%s\"", value, pragma.name);
+			return false;
+		}
+
+		ke::SafeSprintf(query, sizeof(query), "PRAGMA %s=%s", pragma.name, value);
+		if (sqlite3_exec(sql, query, NULL, NULL, NULL) != SQLITE_OK)
+		{
+			ke::SafeSprintf(error, maxlength, "Could not set %s: %s", pragma.name, sqlite3_errmsg(sql));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool IsOptionEnabled(const DatabaseInfo *info, const char *key)
+{
+	const char *value = FindOption(info, key);
+	return value != NULL && (strcasecmp(value, "yes") == 0 || strcmp(value, "1") == 0);
+}
+
+/* Copies one database into another through the backup API. */
+bool SqCopyDatabase(sqlite3 *from, sqlite3 *to)
+{
+	sqlite3_backup *backup = sqlite3_backup_init(to, "main", from, "main");
+	if (backup == NULL)
+	{
+		return false;
+	}
+	sqlite3_backup_step(backup, -1);
+	return sqlite3_backup_finish(backup) == SQLITE_OK;
+}
+
 inline bool IsPathSepChar(char c)
 {
 #if defined PLATFORM_WINDOWS
@@ -182,6 +300,7 @@ IDatabase *SqDriver::Connect(const DatabaseInfo *info, bool persistent, char *er
 	
 	/* Full path to the database file */
 	char fullpath[PLATFORM_MAX_PATH];
+	bool in_memory = false;
 
 	if (strcmp(info->database, ":memory:") == 0 || strncmp(info->database, "file:", 5) == 0)
 	{
@@ -189,6 +308,15 @@ IDatabase *SqDriver::Connect(const DatabaseInfo *info, bool persistent, char *er
 	}
 	else
 	{
+		/* Work on an in-memory copy, snapshotted back to the file. Every
+		 * connection has to see the same copy, so they're all shared.
+		 */
+		if (IsOptionEnabled(info, "in_memory"))
+		{
+			in_memory = true;
+			persistent = true;
+		}
+
 		/* Format our path */
 		char path[PLATFORM_MAX_PATH];
 		size_t len = libsys->PathFormat(path, sizeof(path), "sqlite/%s", info->database);
@@ -269,9 +397,16 @@ IDatabase *SqDriver::Connect(const DatabaseInfo *info, bool persistent, char *er
 		}
 	}
 
+	int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+	const char *shared_cache = FindOption(info, "shared_cache");
+	if (shared_cache != NULL)
+	{
+		flags |= IsOptionEnabled(info, "shared_cache") ? SQLITE_OPEN_SHAREDCACHE : SQLITE_OPEN_PRIVATECACHE;
+	}
+
 	/* Try to open a new connection */
 	sqlite3 *sql;
-	int err = sqlite3_open(fullpath, &sql);
+	int err = sqlite3_open_v2(in_memory ? ":memory:" : fullpath, &sql, flags, NULL);
 	if (err != SQLITE_OK)
 	{
 		strncopy(error, sqlite3_errmsg(sql), maxlength);
@@ -281,8 +416,47 @@ IDatabase *SqDriver::Connect(const DatabaseInfo *info, bool persistent, char *er
 
 	sqlite3_busy_handler(sql, busy_handler, NULL);
 
+	if (in_memory)
+	{
+		/* Seed the in-memory copy from whatever is on disk. */
+		sqlite3 *disk;
+		bool loaded = false;
+		if (sqlite3_open_v2(fullpath, &disk, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL) == SQLITE_OK)
+		{
+			sqlite3_busy_handler(disk, busy_handler, NULL);
+			loaded = SqCopyDatabase(disk, sql);
+		}
+		if (!loaded)
+		{
+			strncopy(error, sqlite3_errmsg(disk), maxlength);
+		}
+		sqlite3_close(disk);
+		if (!loaded)
+		{
+			sqlite3_close(sql);
+			return NULL;
+		}
+	}
+
+	if (!ApplyPragmas(sql, info, error, maxlength))
+	{
+		sqlite3_close(sql);
+		return NULL;
+	}
+
 	SqDatabase *pdb = new SqDatabase(sql, persistent);
 
+	if (in_memory)
+	{
+		unsigned int interval = SQLITE_DEFAULT_SNAPSHOT_INTERVAL;
+		const char *value = FindOption(info, "snapshot_interval");
+		if (value != NULL)
+		{
+			interval = atoi(value);
+		}
+		pdb->StartSnapshots(fullpath, interval);
+	}
+
 	if (persistent)
 	{
 		SqDbInfo pinfo;
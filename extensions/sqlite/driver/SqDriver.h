@@ -81,5 +81,6 @@ private:
 extern SqDriver g_SqDriver;
 
 unsigned int strncopy(char *dest, const char *src, size_t count);
+int busy_handler(void *unused1, int unused2);
 
 #endif //_INCLUDE_SQLITE_SOURCEMOD_DRIVER_H_
@@ -32,7 +32,15 @@
 #include "SqQuery.h"
 
 SqQuery::SqQuery(SqDatabase *parent, sqlite3_stmt *stmt) : 
- m_pParent(parent), m_pStmt(stmt), m_pResults(NULL), m_AffectedRows(0), m_InsertID(0)
+ m_pParent(parent), m_pStmt(stmt), m_pResults(NULL), m_AffectedRows(0), m_InsertID(0), m_Cacheable(false)
+{
+	m_ParamCount = sqlite3_bind_parameter_count(m_pStmt);
+	m_ColCount = sqlite3_column_count(m_pStmt);
+}
+
+SqQuery::SqQuery(SqDatabase *parent, sqlite3_stmt *stmt, const char *cacheKey, size_t keyLength) : 
+ m_pParent(parent), m_pStmt(stmt), m_pResults(NULL), m_AffectedRows(0), m_InsertID(0),
+ m_CacheKey(cacheKey, keyLength), m_Cacheable(true)
 {
 	m_ParamCount = sqlite3_bind_parameter_count(m_pStmt);
 	m_ColCount = sqlite3_column_count(m_pStmt);
@@ -41,7 +49,17 @@ SqQuery::SqQuery(SqDatabase *parent, sqlite3_stmt *stmt) :
 SqQuery::~SqQuery()
 {
 	delete m_pResults;
-	sqlite3_finalize(m_pStmt);
+
+	if (m_Cacheable)
+	{
+		sqlite3_reset(m_pStmt);
+		sqlite3_clear_bindings(m_pStmt);
+		m_pParent->ReleaseStatement(m_CacheKey, m_pStmt);
+	}
+	else
+	{
+		sqlite3_finalize(m_pStmt);
+	}
 }
 
 IResultSet *SqQuery::GetResultSet()
@@ -168,6 +186,9 @@ bool SqQuery::Execute()
 		m_LastError.assign(sqlite3_errmsg(db));
 		m_AffectedRows = 0;
 		m_InsertID = 0;
+
+		/* Don't hand a statement that is known to fail to anyone else. */
+		m_Cacheable = false;
 	} else {
 		m_LastErrorCode = SQLITE_OK;
 		m_AffectedRows = (unsigned int)sqlite3_changes(db);
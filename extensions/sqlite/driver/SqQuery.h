@@ -32,6 +32,7 @@
 #ifndef _INCLUDE_SQLITE_SOURCEMOD_QUERY_H_
 #define _INCLUDE_SQLITE_SOURCEMOD_QUERY_H_
 
+#include <string>
 #include <am-refcounting.h>
 #include "SqDatabase.h"
 #include "SqResults.h"
@@ -41,6 +42,7 @@ class SqQuery :
 {
 public:
 	SqQuery(SqDatabase *parent, sqlite3_stmt *stmt);
+	SqQuery(SqDatabase *parent, sqlite3_stmt *stmt, const char *cacheKey, size_t keyLength);
 	~SqQuery();
 public: //IQuery
 	IResultSet *GetResultSet();
@@ -91,6 +93,8 @@ private:
 	unsigned int m_AffectedRows;
 	unsigned int m_InsertID;
 	unsigned int m_ColCount;
+	std::string m_CacheKey;
+	bool m_Cacheable;		/* return the statement to the parent's cache on destroy */
 };
 
 #endif //_INCLUDE_SQLITE_SOURCEMOD_QUERY_H_
@@ -34,8 +34,12 @@
 #include "SqResults.h"
 #include "SqQuery.h"
 
-SqResults::SqResults(SqQuery *query) : 
-	m_pStmt(query->GetStmt()), m_Strings(1024),
+SqResults::SqResults(SqQuery *query) : SqResults(query->GetStmt())
+{
+}
+
+SqResults::SqResults(sqlite3_stmt *stmt) : 
+	m_pStmt(stmt), m_Strings(1024),
 	m_RowCount(0), m_MaxRows(0), m_Rows(NULL),
 	m_CurRow(-1), m_NextRow(0)
 {
@@ -480,3 +484,121 @@ DBResult SqResults::CopyBlob(unsigned int columnId, void *buffer, size_t maxleng
 
 	return (field->type == SQLITE_NULL) ? DBVal_Null : DBVal_Data;
 }
+
+SqResultStream::SqResultStream(SqDatabase *parent, sqlite3_stmt *stmt, bool hasRow) :
+	SqResults(stmt), m_pParent(parent), m_Fetched(0), m_Pending(hasRow), m_Done(!hasRow),
+	m_ErrorCode(SQLITE_OK)
+{
+	sqlite3 *db = m_pParent->GetDb();
+	m_AffectedRows = (unsigned int)sqlite3_changes(db);
+	m_InsertID = (unsigned int)sqlite3_last_insert_rowid(db);
+
+	/* The first row was stepped to catch errors early; keep it for FetchRow() */
+	if (m_Pending)
+	{
+		PushResult();
+	}
+}
+
+SqResultStream::~SqResultStream()
+{
+	sqlite3_finalize(m_pStmt);
+}
+
+unsigned int SqResultStream::GetRowCount()
+{
+	return m_Fetched;
+}
+
+bool SqResultStream::MoreRows()
+{
+	return !m_Done;
+}
+
+IResultRow *SqResultStream::FetchRow()
+{
+	if (m_Pending)
+	{
+		m_Pending = false;
+	}
+	else
+	{
+		if (m_Done)
+		{
+			return NULL;
+		}
+
+		ResetResultCount();
+
+		int rc = sqlite3_step(m_pStmt);
+		if (rc != SQLITE_ROW)
+		{
+			m_Done = true;
+			if (rc != SQLITE_DONE)
+			{
+				sqlite3 *db = m_pParent->GetDb();
+				m_ErrorCode = rc;
+				m_Error.assign(sqlite3_errmsg(db));
+			}
+			return NULL;
+		}
+
+		PushResult();
+	}
+
+	/* Only ever one row is buffered */
+	m_CurRow = 0;
+	m_NextRow = 1;
+	m_Fetched++;
+	return this;
+}
+
+IResultRow *SqResultStream::CurrentRow()
+{
+	if (m_Pending)
+	{
+		return NULL;
+	}
+
+	return SqResults::CurrentRow();
+}
+
+bool SqResultStream::Rewind()
+{
+	return false;
+}
+
+IResultSet *SqResultStream::GetResultSet()
+{
+	if (!m_ColCount)
+	{
+		return NULL;
+	}
+
+	return this;
+}
+
+const char *SqResultStream::GetError(int *errCode)
+{
+	if (errCode)
+	{
+		*errCode = m_ErrorCode;
+	}
+
+	return m_Error.c_str();
+}
+
+unsigned int SqResultStream::GetAffectedRows()
+{
+	return m_AffectedRows;
+}
+
+unsigned int SqResultStream::GetInsertID()
+{
+	return m_InsertID;
+}
+
+void SqResultStream::Destroy()
+{
+	delete this;
+}
@@ -33,6 +33,7 @@
 #define _INCLUDE_SQLITE_SOURCEMOD_RESULT_SET_H_
 
 #include "SqDriver.h"
+#include "SqDatabase.h"
 #include "sm_memtable.h"
 
 class SqQuery;
@@ -55,6 +56,7 @@ class SqResults :
 	friend class SqQuery;
 public:
 	SqResults(SqQuery *query);
+	SqResults(sqlite3_stmt *stmt);
 	~SqResults();
 public: //IResultSet
 	unsigned int GetRowCount();
@@ -84,7 +86,7 @@ public:
 	void PushResult();
 private:
 	SqField *GetField(unsigned int col);
-private:
+protected:
 	sqlite3_stmt *m_pStmt;		/** DOES NOT CHANGE */
 	String *m_ColNames;			/** DOES NOT CHANGE */
 	unsigned int m_ColCount;	/** DOES NOT CHANGE */
@@ -97,4 +99,34 @@ private:
 	int m_NextRow;
 };
 
+class SqResultStream :
+	public SqResults,
+	public IResultStream
+{
+public:
+	SqResultStream(SqDatabase *parent, sqlite3_stmt *stmt, bool hasRow);
+	~SqResultStream();
+public: //IResultSet
+	unsigned int GetRowCount();
+	bool MoreRows();
+	IResultRow *FetchRow();
+	IResultRow *CurrentRow();
+	bool Rewind();
+public: //IResultStream
+	IResultSet *GetResultSet();
+	const char *GetError(int *errCode=NULL);
+	unsigned int GetAffectedRows();
+	unsigned int GetInsertID();
+	void Destroy();
+private:
+	ke::RefPtr<SqDatabase> m_pParent;
+	unsigned int m_Fetched;
+	unsigned int m_AffectedRows;
+	unsigned int m_InsertID;
+	bool m_Pending;
+	bool m_Done;
+	int m_ErrorCode;
+	String m_Error;
+};
+
 #endif //_INCLUDE_SQLITE_SOURCEMOD_RESULT_SET_H_
@@ -34,56 +34,105 @@
 
 IForward *g_addCondForward = NULL;
 IForward *g_removeCondForward = NULL;
+IForward *g_condsChangedForward = NULL;
 
-struct CondChangeData_t
+static void HandleCondChanges(void *pData)
 {
-	CBaseHandle hPlayer;
-	PlayerConditionsMgr::CondVar var;
-	int newConds;
-};
+	g_CondMgr.ProcessCondChanges();
+}
 
-static void HandleCondChange(void *pData)
+void PlayerConditionsMgr::BuildCondBits(int client, uint32_t bits[TF_COND_WORDS])
 {
-	auto *pCondData = reinterpret_cast<CondChangeData_t *>(pData);
-	g_CondMgr.ProcessCondChange(pCondData);
-	delete pCondData;
+	memset(bits, 0, sizeof(uint32_t) * TF_COND_WORDS);
+	for (size_t i = 0; i < CondVar_Count; ++i)
+	{
+		/* m_nPlayerCond and _condition_bits both hold conditions 0-31 */
+		bits[m_CondOffset[i] / 32] |= (uint32_t)m_PendingConds[client][i];
+	}
+}
+
+void PlayerConditionsMgr::ProcessCondChanges()
+{
+	m_bProcessQueued = false;
+
+	int maxClients = gpGlobals->maxClients;
+	for (int client = 1; client <= maxClients; client++)
+	{
+		if (!m_DirtyClients.test(client))
+			continue;
+		m_DirtyClients.reset(client);
+
+		auto *pPlayer = playerhelpers->GetGamePlayer(client);
+		if (!pPlayer || !pPlayer->IsInGame())
+			continue;
+
+		uint32_t newBits[TF_COND_WORDS];
+		BuildCondBits(client, newBits);
+		if (memcmp(newBits, m_CondBits[client], sizeof(newBits)) == 0)
+			continue;
+
+		uint32_t prevBits[TF_COND_WORDS];
+		memcpy(prevBits, m_CondBits[client], sizeof(prevBits));
+		memcpy(m_CondBits[client], newBits, sizeof(newBits));
+
+		FireCondChanges(client, prevBits, newBits);
+	}
 }
 
-void PlayerConditionsMgr::ProcessCondChange(CondChangeData_t *pCondData)
+void PlayerConditionsMgr::FireCondChanges(int client, const uint32_t prevBits[TF_COND_WORDS], const uint32_t newBits[TF_COND_WORDS])
 {
-	auto *pEdict = gamehelpers->GetHandleEntity(pCondData->hPlayer);
-	auto *pPlayer = playerhelpers->GetGamePlayer(pEdict);
-	if (!pPlayer || !pPlayer->IsInGame())
-		return;
+	cell_t added[TF_COND_WORDS * 32];
+	cell_t removed[TF_COND_WORDS * 32];
+	unsigned int numAdded = 0;
+	unsigned int numRemoved = 0;
 
-	int client = pCondData->hPlayer.GetEntryIndex();
-	CondVar var = pCondData->var;
-	int newConds = pCondData->newConds;
-	int prevConds = m_OldConds[client][var];
+	/* Arrays are never pushed empty; a lone 0 is passed instead */
+	added[0] = removed[0] = 0;
 
-	if (prevConds != newConds)
+	for (int word = 0; word < TF_COND_WORDS; word++)
 	{
-		int changedConds = newConds ^ prevConds;
-		int addedConds = changedConds & newConds;
-		int removedConds = changedConds & prevConds;
-		m_OldConds[client][var] = newConds;
+		uint32_t changedConds = newBits[word] ^ prevBits[word];
+		for (int i = 0; changedConds != 0; i++, changedConds >>= 1)
+		{
+			if (!(changedConds & 1))
+				continue;
+
+			if (newBits[word] & (1u << i))
+				added[numAdded++] = word * 32 + i;
+			else
+				removed[numRemoved++] = word * 32 + i;
+		}
+	}
+
+	if (g_addCondForward->GetFunctionCount())
+	{
+		for (unsigned int i = 0; i < numAdded; i++)
+		{
+			g_addCondForward->PushCell(client);
+			g_addCondForward->PushCell(added[i]);
+			g_addCondForward->Execute(NULL);
+		}
+	}
 
-		for (int i = 0; i < 32; i++)
+	if (g_removeCondForward->GetFunctionCount())
+	{
+		for (unsigned int i = 0; i < numRemoved; i++)
 		{
-			if (addedConds & (1 << i))
-			{
-				g_addCondForward->PushCell(client);
-				g_addCondForward->PushCell(i + m_CondOffset[var]);
-				g_addCondForward->Execute(NULL);
-			}
-			else if (removedConds & (1 << i))
-			{
-				g_removeCondForward->PushCell(client);
-				g_removeCondForward->PushCell(i + m_CondOffset[var]);
-				g_removeCondForward->Execute(NULL);
-			}
+			g_removeCondForward->PushCell(client);
+			g_removeCondForward->PushCell(removed[i]);
+			g_removeCondForward->Execute(NULL);
 		}
 	}
+
+	if (g_condsChangedForward->GetFunctionCount())
+	{
+		g_condsChangedForward->PushCell(client);
+		g_condsChangedForward->PushArray(added, numAdded ? numAdded : 1);
+		g_condsChangedForward->PushCell(numAdded);
+		g_condsChangedForward->PushArray(removed, numRemoved ? numRemoved : 1);
+		g_condsChangedForward->PushCell(numRemoved);
+		g_condsChangedForward->Execute(NULL);
+	}
 }
 
 template<PlayerConditionsMgr::CondVar CondVar>
@@ -94,12 +143,22 @@ static void OnPlayerCondChange(const SendProp *pProp, const void *pStructBase, c
 
 void PlayerConditionsMgr::OnConVarChange(CondVar var, const SendProp *pProp, const void *pStructBase, const void *pData, DVariant *pOut, int iElement, int objectID)
 {
-	auto pCondData = new CondChangeData_t;
-	pCondData->hPlayer = ((IHandleEntity *)((intp)pData - GetPropOffs(var)))->GetRefEHandle();
-	pCondData->var = var;
-	pCondData->newConds = *(int *)pData;
+	/* Proxies run for every networked player each tick; only record what changed
+	 * here and diff all dirty clients in one pass on the next frame.
+	 */
+	int client = ((IHandleEntity *)((intp)pData - GetPropOffs(var)))->GetRefEHandle().GetEntryIndex();
+	int newConds = *(int *)pData;
+	if (client >= 1 && client <= SM_MAXPLAYERS && m_PendingConds[client][var] != newConds)
+	{
+		m_PendingConds[client][var] = newConds;
+		m_DirtyClients.set(client);
 
-	g_pSM->AddFrameAction(&HandleCondChange, pCondData);
+		if (!m_bProcessQueued)
+		{
+			m_bProcessQueued = true;
+			g_pSM->AddFrameAction(&HandleCondChanges, NULL);
+		}
+	}
 
 	if (m_BackupProxyFns[var] != nullptr)
 		m_BackupProxyFns[var](pProp, pStructBase, pData, pOut, iElement, objectID);
@@ -128,6 +187,7 @@ PlayerConditionsMgr::PlayerConditionsMgr()
 	m_CondOffset[m_nPlayerCondEx2] = 64;
 	m_CondOffset[m_nPlayerCondEx3] = 96;
 	m_CondOffset[m_nPlayerCondEx4] = 128;
+	m_bProcessQueued = false;
 }
 
 bool PlayerConditionsMgr::Init()
@@ -156,9 +216,11 @@ bool PlayerConditionsMgr::Init()
 		CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(i);
 		for (size_t j = 0; j < CondVar_Count; ++j)
 		{
-			m_OldConds[i][j] = *(int *)((intp) pEntity + GetPropOffs((CondVar)j));
+			m_PendingConds[i][j] = *(int *)((intp) pEntity + GetPropOffs((CondVar)j));
 		}
+		BuildCondBits(i, m_CondBits[i]);
 	}
+	m_DirtyClients.reset();
 
 	return true;
 }
@@ -175,7 +237,9 @@ void PlayerConditionsMgr::Shutdown()
 
 void PlayerConditionsMgr::OnClientPutInServer(int client)
 {
-	memset(&m_OldConds[client], 0, sizeof(m_OldConds[0]));
+	memset(&m_PendingConds[client], 0, sizeof(m_PendingConds[0]));
+	memset(&m_CondBits[client], 0, sizeof(m_CondBits[0]));
+	m_DirtyClients.reset(client);
 }
 
 PlayerConditionsMgr g_CondMgr;
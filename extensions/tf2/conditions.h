@@ -33,8 +33,10 @@
 #define _INCLUDE_SOURCEMOD_CONDITIONS_H_
 
 #include "extension.h"
+#include <bitset>
 
-struct CondChangeData_t;
+/* Conditions 0-159, the highest one m_nPlayerCondEx4 can hold */
+#define TF_COND_WORDS	5
 
 class PlayerConditionsMgr : public IClientListener
 {
@@ -58,8 +60,10 @@ public:
 	};
 
 	void OnConVarChange(CondVar var, const SendProp *pProp, const void *pStructBase, const void *pData, DVariant *pOut, int iElement, int objectID);
-	void ProcessCondChange(CondChangeData_t *pCondData);
+	void ProcessCondChanges();
 private:
+	void BuildCondBits(int client, uint32_t bits[TF_COND_WORDS]);
+	void FireCondChanges(int client, const uint32_t prevBits[TF_COND_WORDS], const uint32_t newBits[TF_COND_WORDS]);
 	inline unsigned int GetPropOffs(CondVar var)
 	{
 		return m_CondVarProps[var].actual_offset;
@@ -71,7 +75,11 @@ private:
 	template<CondVar var>
 	bool SetupProp(const char *varname);
 private:
-	int m_OldConds[SM_MAXPLAYERS + 1][CondVar_Count];
+	/* Latest value seen by each proxy, diffed against m_CondBits once per tick */
+	int m_PendingConds[SM_MAXPLAYERS + 1][CondVar_Count];
+	uint32_t m_CondBits[SM_MAXPLAYERS + 1][TF_COND_WORDS];
+	std::bitset<SM_MAXPLAYERS + 1> m_DirtyClients;
+	bool m_bProcessQueued;
 	sm_sendprop_info_t m_CondVarProps[CondVar_Count];
 	int m_CondOffset[CondVar_Count];
 	SendVarProxyFn m_BackupProxyFns[CondVar_Count];
@@ -81,5 +89,6 @@ extern PlayerConditionsMgr g_CondMgr;
 
 extern IForward *g_addCondForward;
 extern IForward *g_removeCondForward;
+extern IForward *g_condsChangedForward;
 
 #endif //_INCLUDE_SOURCEMOD_CONDITIONS_H_
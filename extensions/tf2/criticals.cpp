@@ -43,7 +43,9 @@ const char TF_WEAPON_DATATABLE[] = "DT_TFWeaponBase";
 
 CritManager::CritManager() :
 	m_enabled(false),
-	m_hooksSetup(false)
+	m_hooksSetup(false),
+	m_hookAllClasses(false),
+	m_ownerOffset(-1)
 {
 	m_entsHooked.Init();
 }
@@ -73,49 +75,171 @@ bool CritManager::TryEnable()
 		m_hooksSetup = true;
 	}
 
-	for (size_t i = playerhelpers->GetMaxClients() + 1; i < MAX_EDICTS; ++i)
+	m_enabled = true;
+	RefreshHooks();
+
+	return true;
+}
+
+void CritManager::Disable()
+{
+	int i = m_entsHooked.FindNextSetBit(playerhelpers->GetMaxClients() + 1);
+	for (i; i != -1; i = m_entsHooked.FindNextSetBit(i))
 	{
-		CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(i);
-		if (pEntity == nullptr)
+		UnhookWeapon(gamehelpers->ReferenceToEntity(i), i);
+	}
+
+	m_enabled = false;
+}
+
+void CritManager::AddPluginClass(IPlugin *plugin, const char *classname)
+{
+	std::vector<std::string> &classes = m_pluginClasses[plugin];
+	for (size_t i = 0; i < classes.size(); ++i)
+	{
+		if (classes[i] == classname)
 		{
-			continue;
+			return;
 		}
+	}
 
-		ServerClass *pServerClass = gamehelpers->FindEntityServerClass(pEntity);
-		if (pServerClass == nullptr)
+	classes.push_back(classname);
+	RefreshHooks();
+}
+
+bool CritManager::RemovePluginClass(IPlugin *plugin, const char *classname)
+{
+	auto iter = m_pluginClasses.find(plugin);
+	if (iter == m_pluginClasses.end())
+	{
+		return false;
+	}
+
+	std::vector<std::string> &classes = iter->second;
+	for (size_t i = 0; i < classes.size(); ++i)
+	{
+		if (classes[i] == classname)
+		{
+			classes.erase(classes.begin() + i);
+			if (classes.empty())
+			{
+				m_pluginClasses.erase(iter);
+			}
+			RefreshHooks();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void CritManager::OnPluginUnloaded(IPlugin *plugin)
+{
+	m_pluginClasses.erase(plugin);
+
+	if (m_enabled)
+	{
+		RefreshHooks(plugin);
+	}
+}
+
+void CritManager::RefreshHooks(IPlugin *unloading)
+{
+	m_hookAllClasses = false;
+	m_hookedClasses.clear();
+
+	IPluginIterator *iter = plsys->GetPluginIterator();
+	while (iter->MorePlugins())
+	{
+		IPlugin *plugin = iter->GetPlugin();
+		iter->NextPlugin();
+
+		if (plugin == unloading || !plugin->GetBaseContext()
+			|| !plugin->GetBaseContext()->GetFunctionByName("TF2_CalcIsAttackCritical"))
 		{
 			continue;
 		}
 
-		if (!UTIL_ContainsDataTable(pServerClass->m_pTable, TF_WEAPON_DATATABLE))
+		auto classes = m_pluginClasses.find(plugin);
+		if (classes == m_pluginClasses.end())
+		{
+			m_hookAllClasses = true;
+			break;
+		}
+
+		for (size_t i = 0; i < classes->second.size(); ++i)
+		{
+			m_hookedClasses.insert(classes->second[i]);
+		}
+	}
+	iter->Release();
+
+	if (!m_enabled)
+	{
+		return;
+	}
+
+	// Bring existing weapons in line with the new set of wanted classes, so hooks
+	// come and go as plugins load and unload instead of at the next map change.
+	for (int i = playerhelpers->GetMaxClients() + 1; i < MAX_EDICTS; ++i)
+	{
+		CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(i);
+		bool hooked = m_entsHooked.IsBitSet(i);
+
+		if (pEntity == nullptr)
 		{
+			if (hooked)
+			{
+				m_entsHooked.Set(i, false);
+			}
 			continue;
 		}
 
-		SH_ADD_MANUALHOOK(CalcIsAttackCriticalHelper, pEntity, SH_MEMBER(&g_CritManager, &CritManager::Hook_CalcIsAttackCriticalHelper), false);
-		SH_ADD_MANUALHOOK(CalcIsAttackCriticalHelperNoCrits, pEntity, SH_MEMBER(&g_CritManager, &CritManager::Hook_CalcIsAttackCriticalHelperNoCrits), false);
+		bool wanted = ShouldHook(pEntity, gamehelpers->GetEntityClassname(pEntity));
+		if (wanted && !hooked)
+		{
+			HookWeapon(pEntity, i);
+		}
+		else if (!wanted && hooked)
+		{
+			UnhookWeapon(pEntity, i);
+		}
+	}
+}
 
-		m_entsHooked.Set(i);
+bool CritManager::ShouldHook(CBaseEntity *pEntity, const char *classname)
+{
+	if (!m_hookAllClasses && (classname == nullptr || m_hookedClasses.find(classname) == m_hookedClasses.end()))
+	{
+		return false;
 	}
 
-	m_enabled = true;
+	ServerClass *pServerClass = gamehelpers->FindEntityServerClass(pEntity);
+	if (pServerClass == nullptr)
+	{
+		return false;
+	}
 
-	return true;
+	return UTIL_ContainsDataTable(pServerClass->m_pTable, TF_WEAPON_DATATABLE);
 }
 
-void CritManager::Disable()
+void CritManager::HookWeapon(CBaseEntity *pEntity, int index)
 {
-	int i = m_entsHooked.FindNextSetBit(playerhelpers->GetMaxClients() + 1);
-	for (i; i != -1; i = m_entsHooked.FindNextSetBit(i))
+	SH_ADD_MANUALHOOK(CalcIsAttackCriticalHelper, pEntity, SH_MEMBER(&g_CritManager, &CritManager::Hook_CalcIsAttackCriticalHelper), false);
+	SH_ADD_MANUALHOOK(CalcIsAttackCriticalHelperNoCrits, pEntity, SH_MEMBER(&g_CritManager, &CritManager::Hook_CalcIsAttackCriticalHelperNoCrits), false);
+
+	m_entsHooked.Set(index);
+}
+
+void CritManager::UnhookWeapon(CBaseEntity *pEntity, int index)
+{
+	if (pEntity != nullptr)
 	{
-		CBaseEntity *pEntity = gamehelpers->ReferenceToEntity(i);
 		SH_REMOVE_MANUALHOOK(CalcIsAttackCriticalHelper, pEntity, SH_MEMBER(&g_CritManager, &CritManager::Hook_CalcIsAttackCriticalHelper), false);
 		SH_REMOVE_MANUALHOOK(CalcIsAttackCriticalHelperNoCrits, pEntity, SH_MEMBER(&g_CritManager, &CritManager::Hook_CalcIsAttackCriticalHelperNoCrits), false);
-
-		m_entsHooked.Set(i, false);
 	}
 
-	m_enabled = false;
+	m_entsHooked.Set(index, false);
 }
 
 void CritManager::OnEntityCreated(CBaseEntity *pEntity, const char *classname)
@@ -125,21 +249,16 @@ void CritManager::OnEntityCreated(CBaseEntity *pEntity, const char *classname)
 		return;
 	}
 
-	ServerClass *pServerClass = gamehelpers->FindEntityServerClass(pEntity);
-	if (pServerClass == nullptr)
-	{
+	int index = gamehelpers->EntityToBCompatRef(pEntity);
+	if (index < 0 || index >= MAX_EDICTS)
 		return;
-	}
 
-	if (!UTIL_ContainsDataTable(pServerClass->m_pTable, TF_WEAPON_DATATABLE))
+	if (!ShouldHook(pEntity, classname))
 	{
 		return;
 	}
 
-	SH_ADD_MANUALHOOK(CalcIsAttackCriticalHelper, pEntity, SH_MEMBER(&g_CritManager, &CritManager::Hook_CalcIsAttackCriticalHelper), false);
-	SH_ADD_MANUALHOOK(CalcIsAttackCriticalHelperNoCrits, pEntity, SH_MEMBER(&g_CritManager, &CritManager::Hook_CalcIsAttackCriticalHelperNoCrits), false);
-
-	m_entsHooked.Set(gamehelpers->EntityToBCompatRef(pEntity));
+	HookWeapon(pEntity, index);
 }
 
 void CritManager::OnEntityDestroyed(CBaseEntity *pEntity)
@@ -154,10 +273,7 @@ void CritManager::OnEntityDestroyed(CBaseEntity *pEntity)
 	if (!m_entsHooked.IsBitSet(index))
 		return;
 
-	SH_REMOVE_MANUALHOOK(CalcIsAttackCriticalHelper, pEntity, SH_MEMBER(&g_CritManager, &CritManager::Hook_CalcIsAttackCriticalHelper), false);
-	SH_REMOVE_MANUALHOOK(CalcIsAttackCriticalHelperNoCrits, pEntity, SH_MEMBER(&g_CritManager, &CritManager::Hook_CalcIsAttackCriticalHelperNoCrits), false);
-
-	m_entsHooked.Set(index, false);
+	UnhookWeapon(pEntity, index);
 }
 
 bool CritManager::Hook_CalcIsAttackCriticalHelper()
@@ -174,19 +290,25 @@ bool CritManager::Hook_CalcIsAttackCriticalHelpers(bool noCrits)
 {
 	CBaseEntity *pWeapon = META_IFACEPTR(CBaseEntity);
 	
-	// If there's an invalid ent or invalid server class here, we've got issues elsewhere.
-	ServerClass *pServerClass = gamehelpers->FindEntityServerClass(pWeapon);
-	if (pServerClass == nullptr)
+	// m_hOwnerEntity lives in DT_BaseEntity, so one lookup serves every weapon class.
+	if (m_ownerOffset < 0)
 	{
-		g_pSM->LogError(myself, "Invalid server class on weapon.");
-		RETURN_META_VALUE(MRES_IGNORED, false);
-	}
+		// If there's an invalid ent or invalid server class here, we've got issues elsewhere.
+		ServerClass *pServerClass = gamehelpers->FindEntityServerClass(pWeapon);
+		if (pServerClass == nullptr)
+		{
+			g_pSM->LogError(myself, "Invalid server class on weapon.");
+			RETURN_META_VALUE(MRES_IGNORED, false);
+		}
 
-	sm_sendprop_info_t info;
-	if (!gamehelpers->FindSendPropInfo(pServerClass->GetName(), "m_hOwnerEntity", &info))
-	{
-		g_pSM->LogError(myself, "Could not find m_hOwnerEntity on %s", pServerClass->GetName());
-		RETURN_META_VALUE(MRES_IGNORED, false);
+		sm_sendprop_info_t info;
+		if (!gamehelpers->FindSendPropInfo(pServerClass->GetName(), "m_hOwnerEntity", &info))
+		{
+			g_pSM->LogError(myself, "Could not find m_hOwnerEntity on %s", pServerClass->GetName());
+			RETURN_META_VALUE(MRES_IGNORED, false);
+		}
+
+		m_ownerOffset = info.actual_offset;
 	}
 
 	int returnValue;
@@ -201,7 +323,7 @@ bool CritManager::Hook_CalcIsAttackCriticalHelpers(bool noCrits)
 
 	int origReturnValue = returnValue;
 	int ownerIndex = -1;
-	CBaseHandle &hndl = *(CBaseHandle *) ((intptr_t)pWeapon + info.actual_offset);
+	CBaseHandle &hndl = *(CBaseHandle *) ((intptr_t)pWeapon + m_ownerOffset);
 	CBaseEntity *pHandleEntity = gamehelpers->ReferenceToEntity(hndl.GetEntryIndex());
 
 	if (pHandleEntity != NULL && hndl == reinterpret_cast<IHandleEntity *>(pHandleEntity)->GetRefEHandle())
@@ -225,3 +347,30 @@ bool CritManager::Hook_CalcIsAttackCriticalHelpers(bool noCrits)
 	
 	RETURN_META_VALUE(MRES_SUPERCEDE, origReturnValue);
 }
+
+static cell_t TF2_AddCritHookClass(IPluginContext *pContext, const cell_t *params)
+{
+	char *classname;
+	pContext->LocalToString(params[1], &classname);
+
+	IPlugin *plugin = plsys->FindPluginByContext(pContext->GetContext());
+	g_CritManager.AddPluginClass(plugin, classname);
+
+	return 1;
+}
+
+static cell_t TF2_RemoveCritHookClass(IPluginContext *pContext, const cell_t *params)
+{
+	char *classname;
+	pContext->LocalToString(params[1], &classname);
+
+	IPlugin *plugin = plsys->FindPluginByContext(pContext->GetContext());
+	return g_CritManager.RemovePluginClass(plugin, classname) ? 1 : 0;
+}
+
+sp_nativeinfo_t g_CritNatives[] = 
+{
+	{"TF2_AddCritHookClass",		TF2_AddCritHookClass},
+	{"TF2_RemoveCritHookClass",		TF2_RemoveCritHookClass},
+	{NULL,							NULL}
+};
@@ -37,6 +37,10 @@
 #include <jit/x86/x86_macros.h>
 #include "CDetour/detours.h"
 #include "ISDKHooks.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 class CritManager : public ISMEntityListener
 {
@@ -47,14 +51,22 @@ public:
 	bool TryEnable();
 	void Disable();
 
+	// Weapon classes plugins want TF2_CalcIsAttackCritical for. A listening
+	// plugin that names no classes makes every weapon class hooked.
+	void AddPluginClass(IPlugin *plugin, const char *classname);
+	bool RemovePluginClass(IPlugin *plugin, const char *classname);
+	void OnPluginUnloaded(IPlugin *plugin);
+	void RefreshHooks(IPlugin *unloading = nullptr);
+
 	// ISMEntityListener
 public:
 	virtual void OnEntityCreated(CBaseEntity *pEntity, const char *classname);
 	virtual void OnEntityDestroyed(CBaseEntity *pEntity);
 
 private:
-	void HookEntityIfWeapon(CBaseEntity *pEntity);
-	void UnhookEntityIfHooked(CBaseEntity *pEntity);
+	bool ShouldHook(CBaseEntity *pEntity, const char *classname);
+	void HookWeapon(CBaseEntity *pEntity, int index);
+	void UnhookWeapon(CBaseEntity *pEntity, int index);
 
 public:
 	// CritHook
@@ -67,9 +79,14 @@ private:
 	bool m_enabled;
 	bool m_hooksSetup;
 	CBitVec<MAX_EDICTS> m_entsHooked;	
+	std::unordered_map<IPlugin *, std::vector<std::string>> m_pluginClasses;
+	std::unordered_set<std::string> m_hookedClasses;
+	bool m_hookAllClasses;
+	int m_ownerOffset;
 };
 
 extern CritManager g_CritManager;
+extern sp_nativeinfo_t g_CritNatives[];
 
 extern IForward *g_critForward;
 
@@ -111,6 +111,7 @@ bool TF2Tools::SDK_OnLoad(char *error, size_t maxlength, bool late)
 	CDetourManager::Init(g_pSM->GetScriptingEngine(), g_pGameConf);
 
 	sharesys->AddNatives(myself, g_TFNatives);
+	sharesys->AddNatives(myself, g_CritNatives);
 	sharesys->RegisterLibrary(myself, "tf2");
 
 	plsys->AddPluginsListener(this);
@@ -120,6 +121,7 @@ bool TF2Tools::SDK_OnLoad(char *error, size_t maxlength, bool late)
 	g_critForward = forwards->CreateForward("TF2_CalcIsAttackCritical", ET_Hook, 4, NULL, Param_Cell, Param_Cell, Param_String, Param_CellByRef);
 	g_addCondForward = forwards->CreateForward("TF2_OnConditionAdded", ET_Ignore, 2, NULL, Param_Cell, Param_Cell);
 	g_removeCondForward = forwards->CreateForward("TF2_OnConditionRemoved", ET_Ignore, 2, NULL, Param_Cell, Param_Cell);
+	g_condsChangedForward = forwards->CreateForward("TF2_OnConditionsChanged", ET_Ignore, 5, NULL, Param_Cell, Param_Array, Param_Cell, Param_Array, Param_Cell);
 	g_waitingPlayersStartForward = forwards->CreateForward("TF2_OnWaitingForPlayersStart", ET_Ignore, 0, NULL);
 	g_waitingPlayersEndForward = forwards->CreateForward("TF2_OnWaitingForPlayersEnd", ET_Ignore, 0, NULL);
 	g_teleportForward = forwards->CreateForward("TF2_OnPlayerTeleport", ET_Hook, 3, NULL, Param_Cell, Param_Cell, Param_CellByRef);
@@ -199,6 +201,7 @@ void TF2Tools::SDK_OnUnload()
 	forwards->ReleaseForward(g_critForward);
 	forwards->ReleaseForward(g_addCondForward);
 	forwards->ReleaseForward(g_removeCondForward);
+	forwards->ReleaseForward(g_condsChangedForward);
 	forwards->ReleaseForward(g_waitingPlayersStartForward);
 	forwards->ReleaseForward(g_waitingPlayersEndForward);
 	forwards->ReleaseForward(g_teleportForward);
@@ -372,9 +375,13 @@ void TF2Tools::OnPluginLoaded(IPlugin *plugin)
 	{
 		m_CritDetoursEnabled = g_CritManager.TryEnable();
 	}
+	else if (m_CritDetoursEnabled && plugin->GetBaseContext()->GetFunctionByName("TF2_CalcIsAttackCritical"))
+	{
+		g_CritManager.RefreshHooks();
+	}
 
 	if (!m_CondChecksEnabled
-		&& ( g_addCondForward->GetFunctionCount() || g_removeCondForward->GetFunctionCount() )
+		&& ( g_addCondForward->GetFunctionCount() || g_removeCondForward->GetFunctionCount() || g_condsChangedForward->GetFunctionCount() )
 		)
 	{
 		m_CondChecksEnabled = g_CondMgr.Init();
@@ -400,9 +407,10 @@ void TF2Tools::OnPluginUnloaded(IPlugin *plugin)
 		g_CritManager.Disable();
 		m_CritDetoursEnabled = false;
 	}
+	g_CritManager.OnPluginUnloaded(plugin);
 	if (m_CondChecksEnabled)
 	{
-		if (!g_addCondForward->GetFunctionCount() && !g_removeCondForward->GetFunctionCount())
+		if (!g_addCondForward->GetFunctionCount() && !g_removeCondForward->GetFunctionCount() && !g_condsChangedForward->GetFunctionCount())
 		{
 			g_CondMgr.Shutdown();
 			m_CondChecksEnabled = false;
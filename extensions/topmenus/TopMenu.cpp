@@ -39,7 +39,14 @@ struct obj_by_name_t
 	char name[TOPMENU_DISPLAY_BUFFER_SIZE];
 };
 
+struct obj_by_pos_t
+{
+	unsigned int obj_index;
+	unsigned int pos;
+};
+
 int _SortObjectNamesDescending(const void *ptr1, const void *ptr2);
+int _SortObjectPositionsAscending(const void *ptr1, const void *ptr2);
 unsigned int strncopy(char *dest, const char *src, size_t count);
 size_t UTIL_Format(char *buffer, size_t maxlength, const char *fmt, ...);
 
@@ -47,6 +54,8 @@ TopMenu::TopMenu(ITopMenuObjectCallbacks *callbacks)
 {
 	m_clients = NULL;
 	m_SerialNo = 1;
+	m_CatSerialNo = 0;
+	m_DrawSerialNo = 0;
 	m_pTitle = callbacks;
 	m_max_clients = 0;
 	m_bCacheTitles = true;
@@ -97,7 +106,19 @@ unsigned int TopMenu::CalcMemUsage()
 
 	size += m_Config.strings.GetMemTable()->GetMemUsage();
 	size += (m_Config.cats.size() * sizeof(int));
+	size += m_Config.positions.mem_usage();
+	for (size_t i = 0; i < m_Config.cats.size(); i++)
+	{
+		size += m_Config.cats[i]->positions.mem_usage();
+	}
 	size += (sizeof(topmenu_player_t) * (SM_MAXPLAYERS + 1));
+	if (m_clients != NULL)
+	{
+		for (size_t i = 0; i <= (size_t)m_max_clients; i++)
+		{
+			size += m_clients[i].draw_cache_size * sizeof(topmenu_draw_cache_t);
+		}
+	}
 	size += (m_SortedCats.size() * sizeof(unsigned int));
 	size += (m_UnsortedCats.size() * sizeof(unsigned int));
 	size += (m_Categories.size() * (sizeof(topmenu_category_t *) + sizeof(topmenu_category_t)));
@@ -228,6 +249,7 @@ unsigned int TopMenu::AddToMenu2(const char *name,
 	strncopy(obj->name, name, sizeof(obj->name));
 	strncopy(obj->cmdname, cmdname ? cmdname : "", sizeof(obj->cmdname));
 	strncopy(obj->info, info_string ? info_string : "", sizeof(obj->info));
+	obj->sort_pos = -1;
 
 	if (obj->type == TopMenuObject_Category)
 	{
@@ -235,7 +257,7 @@ unsigned int TopMenu::AddToMenu2(const char *name,
 		topmenu_category_t *cat = new topmenu_category_t;
 		cat->obj = obj;
 		cat->reorder = false;
-		cat->serial = 1;
+		MarkCategoryChanged(cat);
 
 		/* Add it, then update our serial change number. */
 		obj->cat_id = m_Categories.size();
@@ -247,11 +269,16 @@ unsigned int TopMenu::AddToMenu2(const char *name,
 	}
 	else if (obj->type == TopMenuObject_Item)
 	{
-		/* Update the category, mark it as needing changes */
+		/* Update the category, mark it as needing changes.  If it is already 
+		 * sorted, slot the new item in rather than sorting everything again.
+		 */
 		obj->cat_id = 0;
 		parent_cat->obj_list.push_back(obj);
-		parent_cat->reorder = true;
-		parent_cat->serial++;
+		if (!parent_cat->reorder)
+		{
+			InsertSortedObject(parent_cat, obj);
+		}
+		MarkCategoryChanged(parent_cat);
 
 		/* If the category just went from 0 to 1 items, mark it as 
 		 * changed, so clients get the category drawn.
@@ -330,6 +357,12 @@ void TopMenu::RemoveFromMenu(unsigned int object_id)
 				/* Remove the category from the list, then delete it. */
 				m_Categories.erase(m_Categories.iterAt(i));
 				delete cat;
+
+				/* Categories after this one have moved down a slot. */
+				for (size_t j = i; j < m_Categories.size(); j++)
+				{
+					m_Categories[j]->obj->cat_id = (unsigned int)j;
+				}
 				break;
 			}
 		}
@@ -372,11 +405,17 @@ void TopMenu::RemoveFromMenu(unsigned int object_id)
 			}
 
 			/* Update the category as changed. */
-			parent_cat->reorder = true;
-			parent_cat->serial++;
+			if (!parent_cat->reorder)
+			{
+				RemoveSortedObject(parent_cat, obj);
+			}
+			MarkCategoryChanged(parent_cat);
 		}
 	}
 
+	/* The object id may be handed out again, so cached draws are stale. */
+	InvalidateDrawCache(0);
+
 	/* The callbacks pointer is still valid, so fire away! */
 	obj->callbacks->OnTopMenuObjectRemoved(this, object_id);
 
@@ -399,7 +438,9 @@ bool TopMenu::DisplayMenu(int client, unsigned int hold_time, TopMenuPosition po
 
 	UpdateClientRoot(client, pPlayer);
 
-	/* This is unfortunate but it's the best solution. */
+	/* This is unfortunate but it's the best solution.  Categories that 
+	 * have not changed since the client last saw them are skipped.
+	 */
 	for (size_t i = 0; i < m_Categories.size(); i++)
 	{
 		UpdateClientCategory(client, i, true);
@@ -411,6 +452,9 @@ bool TopMenu::DisplayMenu(int client, unsigned int hold_time, TopMenuPosition po
 		return false;
 	}
 
+	/* Draw results are reused for as long as this menu stays open. */
+	ResetClientDraws(pClient);
+
 	if (!m_bCacheTitles)
 	{
 		char renderbuf[128];
@@ -473,6 +517,8 @@ bool TopMenu::DisplayMenuAtCategory(int client, unsigned int object_id)
 		return false;
 	}
 
+	ResetClientDraws(pClient);
+
 	if (!m_bCacheTitles)
 	{
 		char renderbuf[128];
@@ -563,6 +609,87 @@ void TopMenu::SetTitleCaching(bool cache_titles)
 	m_bCacheTitles = cache_titles;
 }
 
+void TopMenu::InvalidateDrawCache(int client)
+{
+	if (m_clients == NULL)
+	{
+		return;
+	}
+
+	if (client != 0)
+	{
+		topmenu_player_t *player = &m_clients[client];
+		if (player->draw_serial != 0)
+		{
+			ResetClientDraws(player);
+		}
+		return;
+	}
+
+	/* Only clients with the menu open are caching; leave the rest alone. */
+	for (int i = 1; i <= m_max_clients; i++)
+	{
+		if (m_clients[i].draw_serial != 0)
+		{
+			ResetClientDraws(&m_clients[i]);
+		}
+	}
+}
+
+void TopMenu::ResetClientDraws(topmenu_player_t *player)
+{
+	if (++m_DrawSerialNo == 0)
+	{
+		m_DrawSerialNo = 1;
+	}
+	player->draw_serial = m_DrawSerialNo;
+}
+
+bool TopMenu::FindCachedDraw(topmenu_player_t *player, unsigned int object_id, unsigned int *style)
+{
+	if (player->draw_serial == 0 || object_id > player->draw_cache_size)
+	{
+		return false;
+	}
+
+	topmenu_draw_cache_t *entry = &player->draw_cache[object_id - 1];
+	if (entry->serial != player->draw_serial)
+	{
+		return false;
+	}
+
+	*style = entry->style;
+	return true;
+}
+
+void TopMenu::CacheDraw(topmenu_player_t *player, unsigned int object_id, unsigned int style)
+{
+	if (player->draw_serial == 0)
+	{
+		return;
+	}
+
+	if (object_id > player->draw_cache_size)
+	{
+		unsigned int new_size = (unsigned int)m_Objects.size();
+		topmenu_draw_cache_t *new_cache = 
+			(topmenu_draw_cache_t *)realloc(player->draw_cache, sizeof(topmenu_draw_cache_t) * new_size);
+		if (new_cache == NULL)
+		{
+			return;
+		}
+		memset(&new_cache[player->draw_cache_size], 
+			0, 
+			sizeof(topmenu_draw_cache_t) * (new_size - player->draw_cache_size));
+		player->draw_cache = new_cache;
+		player->draw_cache_size = new_size;
+	}
+
+	topmenu_draw_cache_t *entry = &player->draw_cache[object_id - 1];
+	entry->serial = player->draw_serial;
+	entry->style = style;
+}
+
 void TopMenu::OnMenuSelect2(IBaseMenu *menu, int client, unsigned int item, unsigned int item_on_page)
 {
 	const char *item_name = menu->GetItemInfo(item, NULL);
@@ -621,11 +748,11 @@ void TopMenu::OnMenuDrawItem(IBaseMenu *menu, int client, unsigned int item, uns
 		return;
 
 	/* If the category has nothing to display, disable it. */
+	topmenu_player_t *pClient = &m_clients[client];
 	if (obj->type == TopMenuObject_Category)
 	{
 		assert(obj->cat_id < m_Categories.size());
 		assert(m_Categories[obj->cat_id]->obj == obj);
-		topmenu_player_t *pClient = &m_clients[client];
 		if (obj->cat_id >= pClient->cat_count || pClient->cats[obj->cat_id].menu == NULL)
 		{
 			style = ITEMDRAW_IGNORE;
@@ -633,21 +760,21 @@ void TopMenu::OnMenuDrawItem(IBaseMenu *menu, int client, unsigned int item, uns
 		}
 	}
 
-	style = obj->callbacks->OnTopMenuDrawOption(this, client, obj->object_id);
-	if (style != ITEMDRAW_DEFAULT)
-	{
-		return;
-	}
-
-	if (obj->cmdname[0] == '\0')
+	/* Every page redraw walks the item list, so skip the callbacks if we can. */
+	if (FindCachedDraw(pClient, obj->object_id, &style))
 	{
 		return;
 	}
 
-	if (!adminsys->CheckAccess(client, obj->cmdname, obj->flags, false))
+	style = obj->callbacks->OnTopMenuDrawOption(this, client, obj->object_id);
+	if (style == ITEMDRAW_DEFAULT 
+		&& obj->cmdname[0] != '\0'
+		&& !adminsys->CheckAccess(client, obj->cmdname, obj->flags, false))
 	{
 		style = ITEMDRAW_IGNORE;
 	}
+
+	CacheDraw(pClient, obj->object_id, style);
 }
 
 unsigned int TopMenu::OnMenuDisplayItem(IBaseMenu *menu,
@@ -697,27 +824,53 @@ void TopMenu::UpdateClientRoot(int client, IGamePlayer *pGamePlayer)
 	topmenu_player_t *pClient = &m_clients[client];
 	IGamePlayer *pPlayer = pGamePlayer ? pGamePlayer : playerhelpers->GetGamePlayer(client);
 
-	/* Determine if an update is necessary */
-	bool is_update_needed = false;
-	if (pClient->menu_serial != m_SerialNo)
+	int user_id = pPlayer->GetUserId();
+	AdminId admin_id = pPlayer->GetAdminId();
+	unsigned int admin_serial = 0;
+	if (admin_id != INVALID_ADMIN_ID)
 	{
-		is_update_needed = true;
+		admin_serial = adminsys->GetAdminSerialChange(admin_id);
 	}
-	else if (pPlayer->GetUserId() != pClient->user_id)
+
+	/* A different player in this slot can't reuse anything. */
+	bool same_player = (pClient->root != NULL && pClient->user_id == user_id);
+	if (!same_player)
 	{
-		is_update_needed = true;
+		TearDownClient(pClient);
 	}
+	else if (pClient->admin_id != admin_id || pClient->admin_serial != admin_serial)
+	{
+		/* Category menus and draw results depend on access, so drop them. */
+		for (unsigned int i = 0; i < pClient->cat_count; i++)
+		{
+			topmenu_player_category_t *player_cat = &(pClient->cats[i]);
+			if (player_cat->menu != NULL)
+			{
+				player_cat->menu->Destroy();
+				player_cat->menu = NULL;
+			}
+			player_cat->serial = 0;
+		}
+		if (pClient->draw_serial != 0)
+		{
+			ResetClientDraws(pClient);
+		}
+	}
+	pClient->admin_id = admin_id;
+	pClient->admin_serial = admin_serial;
 
 	/* If no update is needed at the root level, just leave now */
-	if (!is_update_needed)
+	if (same_player && pClient->menu_serial == m_SerialNo)
 	{
 		return;
 	}
 
-	/* First we need to flush the cache... */
-	TearDownClient(pClient);
-
-	/* Now, rebuild the category list, but don't create menus */
+	/* Now, rebuild the category list, but don't create menus.  Category 
+	 * menus that are still current are carried over from the old list; 
+	 * serials are unique across categories, so a match can't be stale.
+	 */
+	topmenu_player_category_t *old_cats = pClient->cats;
+	unsigned int old_count = pClient->cat_count;
 	if (m_Categories.size() == 0)
 	{
 		pClient->cat_count = 0;
@@ -728,6 +881,38 @@ void TopMenu::UpdateClientRoot(int client, IGamePlayer *pGamePlayer)
 		pClient->cat_count = (unsigned int)m_Categories.size();
 		pClient->cats = new topmenu_player_category_t[pClient->cat_count];
 		memset(pClient->cats, 0, sizeof(topmenu_player_category_t) * pClient->cat_count);
+
+		for (unsigned int i = 0; i < pClient->cat_count; i++)
+		{
+			topmenu_category_t *cat = m_Categories[i];
+			for (unsigned int j = 0; j < old_count; j++)
+			{
+				if (old_cats[j].cat == cat && old_cats[j].serial == cat->serial)
+				{
+					pClient->cats[i] = old_cats[j];
+					old_cats[j].menu = NULL;
+					break;
+				}
+			}
+		}
+	}
+
+	if (old_cats != NULL)
+	{
+		for (unsigned int i = 0; i < old_count; i++)
+		{
+			if (old_cats[i].menu != NULL)
+			{
+				old_cats[i].menu->Destroy();
+			}
+		}
+		delete [] old_cats;
+	}
+
+	if (pClient->root != NULL)
+	{
+		pClient->root->Destroy();
+		pClient->root = NULL;
 	}
 
 	/* Re-sort the root categories if needed */
@@ -790,7 +975,7 @@ void TopMenu::UpdateClientRoot(int client, IGamePlayer *pGamePlayer)
 
 	/* The client is now fully updated */
 	pClient->root = root_menu;
-	pClient->user_id = pPlayer->GetUserId();
+	pClient->user_id = user_id;
 	pClient->menu_serial = m_SerialNo;
 	pClient->last_position = 0;
 	pClient->last_category = 0;
@@ -899,6 +1084,7 @@ void TopMenu::UpdateClientCategory(int client, unsigned int category, bool bSkip
 		cat_menu->Destroy();
 		player_cat->menu = NULL;
 		player_cat->serial = cat->serial;
+		player_cat->cat = cat;
 		return;
 	}
 
@@ -917,6 +1103,7 @@ void TopMenu::UpdateClientCategory(int client, unsigned int category, bool bSkip
 	/* We're done! */
 	player_cat->menu = cat_menu;
 	player_cat->serial = cat->serial;
+	player_cat->cat = cat;
 }
 
 void TopMenu::SortCategoryIfNeeded(unsigned int category)
@@ -936,50 +1123,94 @@ void TopMenu::SortCategoryIfNeeded(unsigned int category)
 		return;
 	}
 
-	CVector<unsigned int> to_sort;
+	/* Look up each item's position in the config; anything not listed 
+	 * goes onto the unsorted list in the order it was added.
+	 */
+	obj_by_pos_t *pos_list = new obj_by_pos_t[cat->obj_list.size()];
+	size_t pos_count = 0;
 	for (size_t i = 0; i < cat->obj_list.size(); i++)
 	{
-		to_sort.push_back(i);
+		topmenu_object_t *obj = cat->obj_list[i];
+		obj->sort_pos = FindConfigPosition(cat, obj->name);
+		if (obj->sort_pos < 0)
+		{
+			cat->unsorted.push_back(obj);
+			continue;
+		}
+		pos_list[pos_count].obj_index = (unsigned int)i;
+		pos_list[pos_count].pos = (unsigned int)obj->sort_pos;
+		pos_count++;
 	}
 
-	/* Find a matching category in the configs */
-	config_category_t *config_cat = NULL; 
-	for (size_t i = 0; i < m_Config.cats.size(); i++)
+	qsort(pos_list, pos_count, sizeof(obj_by_pos_t), _SortObjectPositionsAscending);
+
+	for (size_t i = 0; i < pos_count; i++)
 	{
-		if (strcmp(m_Config.strings.GetString(m_Config.cats[i]->name), cat->obj->name) == 0)
-		{
-			config_cat = m_Config.cats[i];
-			break;
-		}
+		cat->sorted.push_back(cat->obj_list[pos_list[i].obj_index]);
+	}
+
+	delete [] pos_list;
+
+	cat->reorder = false;
+}
+
+int TopMenu::FindConfigPosition(topmenu_category_t *cat, const char *name)
+{
+	unsigned int index;
+	if (!m_Config.positions.retrieve(cat->obj->name, &index))
+	{
+		return -1;
+	}
+
+	unsigned int pos;
+	if (!m_Config.cats[index]->positions.retrieve(name, &pos))
+	{
+		return -1;
+	}
+
+	return (int)pos;
+}
+
+void TopMenu::InsertSortedObject(topmenu_category_t *cat, topmenu_object_t *obj)
+{
+	obj->sort_pos = FindConfigPosition(cat, obj->name);
+	if (obj->sort_pos < 0)
+	{
+		cat->unsorted.push_back(obj);
+		return;
+	}
+
+	size_t i = 0;
+	while (i < cat->sorted.size() && cat->sorted[i]->sort_pos < obj->sort_pos)
+	{
+		i++;
 	}
+	cat->sorted.insert(cat->sorted.iterAt(i), obj);
+}
 
-	/* If there is a matching category, build a pre-sorted item list */
-	if (config_cat != NULL)
+void TopMenu::RemoveSortedObject(topmenu_category_t *cat, topmenu_object_t *obj)
+{
+	CVector<topmenu_object_t *> &list = (obj->sort_pos < 0) ? cat->unsorted : cat->sorted;
+	for (size_t i = 0; i < list.size(); i++)
 	{
-		/* Find matching objects in this category */
-		for (size_t i = 0; i < config_cat->commands.size(); i++)
+		if (list[i] == obj)
 		{
-			const char *config_name = m_Config.strings.GetString(config_cat->commands[i]);
-			for (size_t j = 0; j < to_sort.size(); j++)
-			{
-				if (strcmp(config_name, cat->obj_list[to_sort[j]]->name) == 0)
-				{
-					/* Place in the final list, then remove from the temporary list */
-					cat->sorted.push_back(cat->obj_list[to_sort[j]]);
-					to_sort.erase(to_sort.iterAt(j));
-					break;
-				}
-			}
+			list.erase(list.iterAt(i));
+			return;
 		}
 	}
+}
 
-	/* Push any remaining items onto the unsorted list */
-	for (size_t i = 0; i < to_sort.size(); i++)
+void TopMenu::MarkCategoryChanged(topmenu_category_t *cat)
+{
+	/* Serials are never shared between categories, so a client's cached 
+	 * menu can be matched to its category across root rebuilds.
+	 */
+	if (++m_CatSerialNo == 0)
 	{
-		cat->unsorted.push_back(cat->obj_list[to_sort[i]]);
+		m_CatSerialNo = 1;
 	}
-
-	cat->reorder = false;
+	cat->serial = m_CatSerialNo;
 }
 
 void TopMenu::SortCategoriesIfNeeded()
@@ -999,35 +1230,31 @@ void TopMenu::SortCategoriesIfNeeded()
 		return;
 	}
 
-	CVector<unsigned int> to_sort;
-	for (unsigned int i = 0; i < (unsigned int)m_Categories.size(); i++)
-	{
-		to_sort.push_back(i);
-	}
-
 	/* If we have any predefined categories, add them in as they appear. */
-	for (size_t i= 0; i < m_Config.cats.size(); i++)
+	obj_by_pos_t *pos_list = new obj_by_pos_t[m_Categories.size()];
+	size_t pos_count = 0;
+	for (unsigned int i = 0; i < (unsigned int)m_Categories.size(); i++)
 	{
-		/* Find this category and map it in if we can */
-		for (size_t j = 0; j < to_sort.size(); j++)
+		unsigned int pos;
+		if (!m_Config.positions.retrieve(m_Categories[i]->obj->name, &pos))
 		{
-			if (strcmp(m_Config.strings.GetString(m_Config.cats[i]->name), 
-					   m_Categories[to_sort[j]]->obj->name) == 0)
-			{
-				/* Add to the real list and remove from the temporary */
-				m_SortedCats.push_back(to_sort[j]);
-				to_sort.erase(to_sort.iterAt(j));
-				break;
-			}
+			m_UnsortedCats.push_back(i);
+			continue;
 		}
+		pos_list[pos_count].obj_index = i;
+		pos_list[pos_count].pos = pos;
+		pos_count++;
 	}
 
-	/* Push any remaining items onto the unsorted list */
-	for (size_t i = 0; i < to_sort.size(); i++)
+	qsort(pos_list, pos_count, sizeof(obj_by_pos_t), _SortObjectPositionsAscending);
+
+	for (size_t i = 0; i < pos_count; i++)
 	{
-		m_UnsortedCats.push_back(to_sort[i]);
+		m_SortedCats.push_back(pos_list[i].obj_index);
 	}
 
+	delete [] pos_list;
+
 	m_bCatsNeedResort = false;
 }
 
@@ -1058,6 +1285,8 @@ void TopMenu::TearDownClient(topmenu_player_t *player)
 		player->root->Destroy();
 	}
 
+	free(player->draw_cache);
+
 	memset(player, 0, sizeof(topmenu_player_t));
 }
 
@@ -1140,6 +1369,14 @@ void TopMenu::ReadSMC_ParseStart()
 		delete m_Config.cats[i];
 	}
 	m_Config.cats.clear();
+	m_Config.positions.clear();
+
+	/* Every category's cached order came from the old config. */
+	for (size_t i = 0; i < m_Categories.size(); i++)
+	{
+		m_Categories[i]->reorder = true;
+		MarkCategoryChanged(m_Categories[i]);
+	}
 }
 
 SMCResult TopMenu::ReadSMC_NewSection(const SMCStates *states, const char *name)
@@ -1165,23 +1402,16 @@ SMCResult TopMenu::ReadSMC_NewSection(const SMCStates *states, const char *name)
 		{
 			cur_cat = new config_category_t;
 			cur_cat->name = m_Config.strings.AddString(name);
-			m_Config.cats.push_back(cur_cat);
-			current_parse_state = PARSE_STATE_CATEGORY;
-
-			// This category needs reordering now that the sorting file is defining something new for it.
-			for (unsigned int i = 0; i < (unsigned int)m_Categories.size(); i++)
+			if (!m_Config.positions.contains(name))
 			{
-				if (strcmp(name, m_Categories[i]->obj->name) == 0)
-				{
-					m_Categories[i]->reorder = true;
-					m_Categories[i]->serial++;
-					break;
-				}
+				m_Config.positions.insert(name, (unsigned int)m_Config.cats.size());
 			}
+			m_Config.cats.push_back(cur_cat);
+			current_parse_state = PARSE_STATE_CATEGORY;
 		}
 		else if (current_parse_state == PARSE_STATE_CATEGORY)
 		{
-			cur_cat->commands.push_back(m_Config.strings.AddString(name));
+			AddConfigCommand(cur_cat, name);
 			ignore_parse_level++;
 		}
 		else
@@ -1204,7 +1434,7 @@ SMCResult TopMenu::ReadSMC_KeyValue(const SMCStates *states, const char *key, co
 
 	if (strcmp(key, "item") == 0)
 	{
-		cur_cat->commands.push_back(m_Config.strings.AddString(value));
+		AddConfigCommand(cur_cat, value);
 	}
 
 	return SMCResult_Continue;
@@ -1249,6 +1479,16 @@ void TopMenu::OnMaxPlayersChanged( int newvalue )
 	m_max_clients = newvalue;
 }
 
+void TopMenu::AddConfigCommand(config_category_t *cat, const char *name)
+{
+	/* Only the first listing of a command decides its position. */
+	if (!cat->positions.contains(name))
+	{
+		cat->positions.insert(name, (unsigned int)cat->commands.size());
+	}
+	cat->commands.push_back(m_Config.strings.AddString(name));
+}
+
 int _SortObjectNamesDescending(const void *ptr1, const void *ptr2)
 {
 	obj_by_name_t *obj1 = (obj_by_name_t *)ptr1;
@@ -1256,6 +1496,17 @@ int _SortObjectNamesDescending(const void *ptr1, const void *ptr2)
 	return strcmp(obj1->name, obj2->name);
 }
 
+int _SortObjectPositionsAscending(const void *ptr1, const void *ptr2)
+{
+	obj_by_pos_t *obj1 = (obj_by_pos_t *)ptr1;
+	obj_by_pos_t *obj2 = (obj_by_pos_t *)ptr2;
+	if (obj1->pos < obj2->pos)
+	{
+		return -1;
+	}
+	return (obj1->pos > obj2->pos) ? 1 : 0;
+}
+
 unsigned int strncopy(char *dest, const char *src, size_t count)
 {
 	if (!count)
@@ -38,6 +38,7 @@
 #include "smsdk_ext.h"
 #include "sm_memtable.h"
 #include <sm_namehashset.h>
+#include <sm_hashmap.h>
 
 using namespace SourceHook;
 using namespace SourceMod;
@@ -48,6 +49,7 @@ struct config_category_t
 {
 	int name;
 	CVector<int> commands;
+	StringHashMap<unsigned int> positions;	/** Command name -> first index in commands */
 };
 
 struct config_root_t
@@ -57,6 +59,7 @@ struct config_root_t
 	}
 	BaseStringTable strings;
 	CVector<config_category_t *> cats;
+	StringHashMap<unsigned int> positions;	/** Category name -> first index in cats */
 };
 
 struct topmenu_object_t
@@ -72,6 +75,7 @@ struct topmenu_object_t
 	bool is_free;						/** Free or not? */
 	char info[255];						/** Info string */
 	unsigned int cat_id;				/** Set if a category */
+	int sort_pos;						/** Position in the config order, or -1 */
 
 	static inline bool matches(const char *name, const topmenu_object_t *topmenu)
 	{
@@ -89,7 +93,7 @@ struct topmenu_category_t
 	CVector<topmenu_object_t *> sorted;		/** Sorted items */
 	CVector<topmenu_object_t *> unsorted;	/** Unsorted items */
 	topmenu_object_t *obj;					/** Bound object */
-	unsigned int serial;					/** Serial number */
+	unsigned int serial;					/** Serial number (unique across categories) */
 	bool reorder;							/** Whether ordering needs updating */
 };
 
@@ -97,6 +101,13 @@ struct topmenu_player_category_t
 {
 	IBaseMenu *menu;					/** menu pointer */
 	unsigned int serial;				/** last known serial */
+	topmenu_category_t *cat;			/** category the menu was built from */
+};
+
+struct topmenu_draw_cache_t
+{
+	unsigned int serial;				/** draw serial this entry belongs to */
+	unsigned int style;					/** cached ITEMDRAW style */
 };
 
 struct topmenu_player_t
@@ -109,6 +120,11 @@ struct topmenu_player_t
 	unsigned int last_category;			/** last category they selected */
 	unsigned int last_position;			/** last position in that category */
 	unsigned int last_root_pos;			/** last page in the root menu */
+	AdminId admin_id;					/** admin id the menus were built for */
+	unsigned int admin_serial;			/** admin serial the menus were built for */
+	topmenu_draw_cache_t *draw_cache;	/** cached draw results, by object id */
+	unsigned int draw_cache_size;		/** number of draw cache entries */
+	unsigned int draw_serial;			/** current draw serial, 0 if not caching */
 };
 
 class TopMenu : 
@@ -162,15 +178,24 @@ public:
 	unsigned int CalcMemUsage();
 	void SetTitleCaching(bool cache_titles);
 	bool DisplayMenuAtCategory(int client, unsigned int object_id);
+	void InvalidateDrawCache(int client);
 private:
 	void SortCategoriesIfNeeded();
 	void SortCategoryIfNeeded(unsigned int category);
+	void InsertSortedObject(topmenu_category_t *cat, topmenu_object_t *obj);
+	void RemoveSortedObject(topmenu_category_t *cat, topmenu_object_t *obj);
+	int FindConfigPosition(topmenu_category_t *cat, const char *name);
+	void MarkCategoryChanged(topmenu_category_t *cat);
+	void AddConfigCommand(config_category_t *cat, const char *name);
 private:
 	bool DisplayCategory(int client, unsigned int category, unsigned int hold_time, bool last_position);
 	void CreatePlayers(int max_clients);
 	void UpdateClientRoot(int client, IGamePlayer *pGamePlayer=NULL);
 	void UpdateClientCategory(int client, unsigned int category, bool bSkipRootCheck=false);
 	void TearDownClient(topmenu_player_t *player);
+	void ResetClientDraws(topmenu_player_t *player);
+	bool FindCachedDraw(topmenu_player_t *player, unsigned int object_id, unsigned int *style);
+	void CacheDraw(topmenu_player_t *player, unsigned int object_id, unsigned int style);
 	bool FindCategoryByObject(unsigned int obj_id, size_t *index);
 private:
 	void OnClientConnected(int client);
@@ -187,6 +212,8 @@ private:
 	CVector<topmenu_object_t *> m_Objects;	/* Object array */
 	NameHashSet<topmenu_object_t *> m_ObjLookup; /* Object lookup trie */
 	unsigned int m_SerialNo;				/* Serial number for updating */
+	unsigned int m_CatSerialNo;				/* Last serial number given to a category */
+	unsigned int m_DrawSerialNo;			/* Last serial number given to a draw cache */
 	ITopMenuObjectCallbacks *m_pTitle;		/* Title callbacks */
 	int m_max_clients;						/* Maximum number of clients */
 	bool m_bCatsNeedResort;					/* True if categories need a resort */
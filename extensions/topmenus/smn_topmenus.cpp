@@ -417,6 +417,28 @@ static cell_t SetTopMenuTitleCaching(IPluginContext *pContext, const cell_t *par
 	return 0;
 }
 
+static cell_t TopMenu_ResetDrawCache(IPluginContext *pContext, const cell_t *params)
+{
+	HandleError err;
+	TopMenu *pMenu;
+	HandleSecurity sec(pContext->GetIdentity(), myself->GetIdentity());
+
+	if ((err = handlesys->ReadHandle(params[1], hTopMenuType, &sec, (void **)&pMenu))
+		!= HandleError_None)
+	{
+		return pContext->ThrowNativeError("Invalid Handle %x (error: %d)", params[1], err);
+	}
+
+	int client = params[2];
+	if (client < 0 || client > playerhelpers->GetMaxClients())
+	{
+		return pContext->ThrowNativeError("Invalid client index %d", client);
+	}
+
+	pMenu->InvalidateDrawCache(client);
+	return 0;
+}
+
 static cell_t TopMenu_AddItem(IPluginContext *pContext, const cell_t *params)
 {
 	cell_t new_params[] = {
@@ -489,6 +511,7 @@ sp_nativeinfo_t g_TopMenuNatives[] =
 	{"TopMenu.GetInfoString",	GetTopMenuInfoString},
 	{"TopMenu.GetObjName",		GetTopMenuName},
 	{"TopMenu.CacheTitles.set",	SetTopMenuTitleCaching},
+	{"TopMenu.ResetDrawCache",	TopMenu_ResetDrawCache},
 	{"TopMenu.FromHandle",      TopMenu_FromHandle},
 
 	{NULL,					NULL},
@@ -0,0 +1,91 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod Updater Extension
+ * Copyright (C) 2004-2009 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#include "FileDownloader.h"
+
+using namespace SourceMod;
+
+FileDownloader::FileDownloader() : fp(NULL), written(0)
+{
+}
+
+FileDownloader::~FileDownloader()
+{
+	Close();
+}
+
+bool FileDownloader::Open(const char *path)
+{
+	Close();
+
+	fp = fopen(path, "wb");
+	return fp != NULL;
+}
+
+void FileDownloader::Close()
+{
+	if (fp != NULL)
+	{
+		fclose(fp);
+		fp = NULL;
+	}
+}
+
+DownloadWriteStatus FileDownloader::OnDownloadWrite(IWebTransfer *session,
+													void *userdata,
+													void *ptr,
+													size_t size,
+													size_t nmemb)
+{
+	size_t total = size * nmemb;
+
+	if (fp == NULL || fwrite(ptr, 1, total, fp) != total)
+	{
+		return DownloadWrite_Error;
+	}
+
+	md5.update((unsigned char *)ptr, (unsigned int)total);
+	written += total;
+
+	return DownloadWrite_Okay;
+}
+
+void FileDownloader::GetChecksum(char checksum[33])
+{
+	md5.finalize();
+	md5.hex_digest(checksum);
+}
+
+size_t FileDownloader::GetSize()
+{
+	return written;
+}
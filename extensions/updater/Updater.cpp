@@ -30,8 +30,11 @@
  */
 
 #include <stdlib.h>
+#include <atomic>
+#include <thread>
 #include "extension.h"
 #include "Updater.h"
+#include "FileDownloader.h"
 #include "md5.h"
 #include <sourcemod_version.h>
 
@@ -204,87 +207,163 @@ void UpdateReader::LinkPart(UpdatePart *part)
 
 void UpdateReader::HandleFile()
 {
-	MD5 md5;
-	char real_checksum[33];
+	/* Don't fetch what we already have. */
+	std::string local("gamedata/");
+	local.append(curfile.c_str());
 
-	mdl.Reset();
-	
-	if (!xfer->Download(url.c_str(), &mdl, NULL))
+	LocalChecksums::iterator iter = local_checksums.find(local);
+	if (iter != local_checksums.end() && strcasecmp(iter->second.c_str(), checksum) == 0)
 	{
-		AddUpdateError("Could not download \"%s\"", url.c_str());
-		AddUpdateError("Error: %s", xfer->LastErrorMessage());
 		return;
 	}
 
-	md5.update((unsigned char *)mdl.GetBuffer(), mdl.GetSize());
-	md5.finalize();
-	md5.hex_digest(real_checksum);
+	pending.emplace_back();
+	PendingFile &file = pending.back();
+	file.file = curfile.c_str();
+	file.url = url.c_str();
+	strcpy(file.checksum, checksum);
+}
+
+void UpdateReader::HandleFolder(const char *folder)
+{
+	UpdatePart *part = new UpdatePart;
+	part->source = NULL;
+	part->file = strdup(folder);
+	LinkPart(part);
+}
 
-	if (mdl.GetSize() == 0)
+static void DownloadWorker(std::vector<PendingFile> *files, std::atomic<size_t> *next)
+{
+	IWebTransfer *session = webternet->CreateSession();
+	if (session == NULL)
 	{
-		AddUpdateError("Zero-length file returned for \"%s\"", curfile.c_str());
 		return;
 	}
+	session->SetFailOnHTTPError(true);
 
-	if (strcasecmp(checksum, real_checksum) != 0)
+	char real_checksum[33];
+	char buffer[2048];
+
+	size_t index;
+	while ((index = next->fetch_add(1)) < files->size())
 	{
-		AddUpdateError("Checksums for file \"%s\" do not match:", curfile.c_str());
-		AddUpdateError("Expected: %s Real: %s", checksum, real_checksum);
-		return;
+		PendingFile &file = (*files)[index];
+		FileDownloader fdl;
+
+		if (!fdl.Open(file.temp.c_str()))
+		{
+			smutils->Format(buffer, sizeof(buffer), "Could not open %s for writing", file.temp.c_str());
+			file.errors.push_back(buffer);
+			continue;
+		}
+
+		if (!session->Download(file.url.c_str(), &fdl, NULL))
+		{
+			smutils->Format(buffer, sizeof(buffer), "Could not download \"%s\"", file.url.c_str());
+			file.errors.push_back(buffer);
+			smutils->Format(buffer, sizeof(buffer), "Error: %s", session->LastErrorMessage());
+			file.errors.push_back(buffer);
+			continue;
+		}
+		fdl.Close();
+
+		if (fdl.GetSize() == 0)
+		{
+			smutils->Format(buffer, sizeof(buffer), "Zero-length file returned for \"%s\"", file.file.c_str());
+			file.errors.push_back(buffer);
+			continue;
+		}
+
+		fdl.GetChecksum(real_checksum);
+		if (strcasecmp(file.checksum, real_checksum) != 0)
+		{
+			smutils->Format(buffer, sizeof(buffer), "Checksums for file \"%s\" do not match:", file.file.c_str());
+			file.errors.push_back(buffer);
+			smutils->Format(buffer, sizeof(buffer), "Expected: %s Real: %s", file.checksum, real_checksum);
+			file.errors.push_back(buffer);
+			continue;
+		}
 	}
 
-	UpdatePart *part = new UpdatePart;
-	part->data = (char*)malloc(mdl.GetSize());
-	memcpy(part->data, mdl.GetBuffer(), mdl.GetSize());
-	part->file = strdup(curfile.c_str());
-	part->length = mdl.GetSize();
-	LinkPart(part);
+	delete session;
 }
 
-void UpdateReader::HandleFolder(const char *folder)
+void UpdateReader::DownloadFiles()
 {
-	UpdatePart *part = new UpdatePart;
-	part->data = NULL;
-	part->length = 0;
-	part->file = strdup(folder);
-	LinkPart(part);
+	if (pending.empty())
+	{
+		return;
+	}
+
+	/* Each file streams to its own scratch file; PumpUpdate moves it into place. */
+	char path[PLATFORM_MAX_PATH];
+	for (size_t i = 0; i < pending.size(); i++)
+	{
+		smutils->BuildPath(Path_SM, path, sizeof(path), "data/updater_%u.part", (unsigned int)i);
+		pending[i].temp = path;
+	}
+
+	std::atomic<size_t> next(0);
+	std::vector<std::thread> workers;
+	size_t count = pending.size() < UPDATER_MAX_DOWNLOADS ? pending.size() : UPDATER_MAX_DOWNLOADS;
+	for (size_t i = 0; i < count; i++)
+	{
+		workers.emplace_back(DownloadWorker, &pending, &next);
+	}
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	for (size_t i = 0; i < pending.size(); i++)
+	{
+		PendingFile &file = pending[i];
+
+		if (i >= next)
+		{
+			/* No worker could get a session to fetch it. */
+			file.errors.push_back("Could not download \"" + file.url + "\"");
+		}
+
+		if (!file.errors.empty())
+		{
+			for (size_t j = 0; j < file.errors.size(); j++)
+			{
+				AddUpdateError("%s", file.errors[j].c_str());
+			}
+			remove(file.temp.c_str());
+			continue;
+		}
+
+		UpdatePart *part = new UpdatePart;
+		part->source = strdup(file.temp.c_str());
+		part->file = strdup(file.file.c_str());
+		LinkPart(part);
+	}
+
+	pending.clear();
 }
 
 static bool md5_file(const char *file, char checksum[33])
 {
 	MD5 md5;
 	FILE *fp;
-	long length;
-	void *fdata;
 
 	if ((fp = fopen(file, "rb")) == NULL)
 	{
 		return false;
 	}
 
-	fseek(fp, 0, SEEK_END);
-	length = ftell(fp);
-	fseek(fp, 0, SEEK_SET);
-	fdata = malloc(length);
-	if (fread(fdata, 1, length, fp) != size_t(length))
-	{
-		free(fdata);
-		fclose(fp);
-		return false;
-	}
-	fclose(fp);
-
-	md5.update((unsigned char*)fdata, length);
+	/* Reads in blocks and closes the file. */
+	md5.update(fp);
 	md5.finalize();
 	md5.hex_digest(checksum);
 
-	free(fdata);
-
 	return true;
 }
 
 /* Path should be sourcemod relative, not gamedata relative */
-static bool add_file(IWebForm *form, const char *file, unsigned int &num_files)
+static bool add_file(IWebForm *form, const char *file, unsigned int &num_files, LocalChecksums &checksums)
 {
 	char path[PLATFORM_MAX_PATH];
 
@@ -302,12 +381,13 @@ static bool add_file(IWebForm *form, const char *file, unsigned int &num_files)
 	smutils->Format(name, sizeof(name), "file_%d_md5", num_files);
 	form->AddString(name, checksum);
 
+	checksums[file] = checksum;
 	num_files++;
 
 	return true;
 }
 
-static void add_folders(IWebForm *form, const char *root, unsigned int &num_files)
+static void add_folders(IWebForm *form, const char *root, unsigned int &num_files, LocalChecksums &checksums)
 {
 	IDirectory *dir;
 	char path[PLATFORM_MAX_PATH];
@@ -332,11 +412,11 @@ static void add_folders(IWebForm *form, const char *root, unsigned int &num_file
 		smutils->Format(name, sizeof(name), "%s/%s", root, dir->GetEntryName());
 		if (dir->IsEntryDirectory())
 		{
-			add_folders(form, name, num_files);
+			add_folders(form, name, num_files, checksums);
 		}
 		else if (dir->IsEntryFile())
 		{
-			add_file(form, name, num_files);
+			add_file(form, name, num_files, checksums);
 		}
 		dir->NextEntry();
 	}
@@ -359,7 +439,7 @@ void UpdateReader::PerformUpdate(const char *url)
 	form->AddString("version", SOURCEMOD_VERSION);
 
 	unsigned int num_files = 0;
-	add_folders(form, "gamedata", num_files);
+	add_folders(form, "gamedata", num_files, local_checksums);
 
 	char temp[24];
 	smutils->Format(temp, sizeof(temp), "%d", num_files);
@@ -386,6 +466,8 @@ void UpdateReader::PerformUpdate(const char *url)
 		goto cleanup;
 	}
 
+	DownloadFiles();
+
 cleanup:
 	delete xfer;
 	delete form;
@@ -35,16 +35,33 @@
 #include <IWebternet.h>
 #include <ITextParsers.h>
 #include <sh_string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "MemoryDownloader.h"
 
+/* How many changed files are fetched at once. */
+#define UPDATER_MAX_DOWNLOADS	4
+
 using namespace SourceHook;
 
 struct UpdatePart
 {
 	UpdatePart* next;
 	char *file;
-	char *data;
-	size_t length;
+	char *source;	/* Downloaded copy to move into place, or NULL for a folder. */
+};
+
+/* md5 of each local gamedata file, keyed by its SourceMod-relative path. */
+typedef std::unordered_map<std::string, std::string> LocalChecksums;
+
+struct PendingFile
+{
+	std::string file;
+	std::string url;
+	std::string temp;
+	char checksum[33];
+	std::vector<std::string> errors;
 };
 
 namespace SourceMod
@@ -67,9 +84,11 @@ namespace SourceMod
 		void HandleFile();
 		void HandleFolder(const char *folder);
 		void LinkPart(UpdatePart *part);
+		void DownloadFiles();
 	private:
 		IWebTransfer *xfer;
-		MemoryDownloader mdl;
+		LocalChecksums local_checksums;
+		std::vector<PendingFile> pending;
 		unsigned int ustate;
 		unsigned int ignoreLevel;
 		SourceHook::String curfile;
@@ -135,7 +135,7 @@ static void PumpUpdate(void *data)
 			AddUpdateError("Detected invalid path escape (..): %s", part->file);
 			goto skip_create;
 		}
-		if (part->data == NULL)
+		if (part->source == NULL)
 		{
 			smutils->BuildPath(Path_SM, path, sizeof(path), "gamedata/%s", part->file);
 			if (libsys->IsPathDirectory(path))
@@ -154,13 +154,11 @@ static void PumpUpdate(void *data)
 		else
 		{
 			smutils->BuildPath(Path_SM, path, sizeof(path), "gamedata/%s", part->file);
-			FILE *fp = fopen(path, "wb");
-			if (fp == NULL)
-			{
-				AddUpdateError("Could not open %s for writing", path);
-				goto skip_create;
-			}
-			if (fwrite(part->data, 1, part->length, fp) != part->length)
+#if defined PLATFORM_WINDOWS
+			/* rename() won't replace an existing file here. */
+			remove(path);
+#endif
+			if (rename(part->source, path) != 0)
 			{
 				AddUpdateError("Could not write file %s", path);
 			}
@@ -171,11 +169,15 @@ static void PumpUpdate(void *data)
 					part->file);
 				new_files = true;
 			}
-			fclose(fp);
 		}
 skip_create:
 		temp = part->next;
-		free(part->data);
+		if (part->source != NULL)
+		{
+			/* Only still there if it was not moved into place. */
+			remove(part->source);
+		}
+		free(part->source);
 		free(part->file);
 		delete part;
 		part = temp;
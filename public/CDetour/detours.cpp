@@ -3,6 +3,8 @@
 
 ISourcePawnEngine *CDetourManager::spengine = NULL;
 IGameConfig *CDetourManager::gameconf = NULL;
+int CDetourManager::transactionDepth = 0;
+std::vector<CDetour *> CDetourManager::pending;
 
 void CDetourManager::Init(ISourcePawnEngine *spengine, IGameConfig *gameconf)
 {
@@ -87,6 +89,69 @@ CDetour *CDetourManager::CreateDetour(void *callbackFunction, void **trampoline,
 	return detour;
 }
 
+void CDetourManager::BeginTransaction()
+{
+	transactionDepth++;
+}
+
+bool CDetourManager::CommitTransaction()
+{
+	if (transactionDepth == 0 || --transactionDepth > 0)
+	{
+		return true;
+	}
+
+	std::vector<CDetour *> queued;
+	queued.swap(pending);
+
+	for (size_t i = 0; i < queued.size(); i++)
+	{
+		CDetour *detour = queued[i];
+		if (detour->IsEnabled())
+		{
+			continue;
+		}
+
+		detour->m_hook.enable();
+		if (detour->IsEnabled())
+		{
+			continue;
+		}
+
+		g_pSM->LogError(myself, "Failed to enable detour %p, rolling back %d queued detour(s)",
+			detour->m_hook.target_address(), (int)queued.size());
+
+		// Undo this commit only; detours enabled before the transaction stay as they were.
+		for (size_t j = 0; j < i; j++)
+		{
+			queued[j]->m_hook.disable();
+		}
+		return false;
+	}
+
+	return true;
+}
+
+void CDetourManager::AbortTransaction()
+{
+	if (transactionDepth > 0 && --transactionDepth == 0)
+	{
+		pending.clear();
+	}
+}
+
+void CDetourManager::RemovePending(CDetour *detour)
+{
+	for (size_t i = 0; i < pending.size(); i++)
+	{
+		if (pending[i] == detour)
+		{
+			pending.erase(pending.begin() + i);
+			return;
+		}
+	}
+}
+
 CDetour::CDetour(void* callbackFunction, void **trampoline, void *pAddress)
 {
 }
@@ -98,15 +163,27 @@ bool CDetour::IsEnabled()
 
 void CDetour::EnableDetour()
 {
+	if (CDetourManager::transactionDepth > 0)
+	{
+		if (!IsEnabled())
+		{
+			CDetourManager::RemovePending(this);
+			CDetourManager::pending.push_back(this);
+		}
+		return;
+	}
+
 	m_hook.enable();
 }
 
 void CDetour::DisableDetour()
 {
+	CDetourManager::RemovePending(this);
 	m_hook.disable();
 }
 
 void CDetour::Destroy()
 {
+	CDetourManager::RemovePending(this);
 	delete this;
 }
\ No newline at end of file
@@ -34,6 +34,7 @@
 
 #include "safetyhook.hpp"
 #include <smsdk_ext.h>
+#include <vector>
 
 #define DETOUR_MEMBER_CALL(name) (this->*name##_Actual)
 #define DETOUR_STATIC_CALL(name) (name##_Actual)
@@ -201,6 +202,9 @@ public:
 
 	/**
 	 * These would be somewhat self-explanatory I hope
+	 *
+	 * While a transaction is open (see CDetourManager::BeginTransaction) EnableDetour
+	 * only queues the detour; it goes live when the outermost transaction commits.
 	 */
 	void EnableDetour();
 	void DisableDetour();
@@ -263,11 +267,39 @@ public:
 	static CDetour *CreateDetour(void *callbackFunction, void **trampoline, const char *signame);
 	static CDetour *CreateDetour(void *callbackFunction, void **trampoline, void *pAddress);
 
+	/**
+	 * Opens a detour transaction. Until the matching CommitTransaction, calls to
+	 * CDetour::EnableDetour are queued instead of patching code immediately.
+	 * Transactions nest; only the outermost commit applies the queue.
+	 *
+	 * Use this when an extension installs several detours that only make sense
+	 * together, so the game never runs with half of them in place.
+	 */
+	static void BeginTransaction();
+
+	/**
+	 * Enables every queued detour. If any of them fails to go live, the ones
+	 * already enabled by this commit are disabled again and false is returned.
+	 *
+	 * @return							True if all queued detours were enabled.
+	 */
+	static bool CommitTransaction();
+
+	/**
+	 * Closes the outermost transaction without enabling anything that was queued.
+	 */
+	static void AbortTransaction();
+
 	friend class CDetour;
 
+private:
+	static void RemovePending(CDetour *detour);
+
 private:
 	static ISourcePawnEngine *spengine;
 	static IGameConfig *gameconf;
+	static int transactionDepth;
+	static std::vector<CDetour *> pending;
 };
 
 #endif // _INCLUDE_SOURCEMOD_DETOURS_H_
\ No newline at end of file
@@ -35,7 +35,7 @@
 #include <IShareSys.h>
 
 #define SMINTERFACE_ADMINSYS_NAME		"IAdminSys"
-#define SMINTERFACE_ADMINSYS_VERSION	8
+#define SMINTERFACE_ADMINSYS_VERSION	9
 
 /**
  * @file IAdminSystem.h
@@ -207,6 +207,19 @@ namespace SourceMod
 		 * @brief Called when the global override cache needs to be rebuilt.
 		 */
 		virtual void OnRebuildOverrideCache() =0;
+
+		/**
+		 * @brief Called when a single admin needs to be reloaded.  Any admin 
+		 * previously bound to the identity has already been removed.
+		 *
+		 * Only called for listeners reporting interface version 9 or later.
+		 *
+		 * @param auth			Auth method name.
+		 * @param identity		Identity string.
+		 */
+		virtual void OnRebuildAdminIdentity(const char *auth, const char *identity)
+		{
+		}
 	};
 
 	/**
@@ -744,6 +757,27 @@ namespace SourceMod
 		 * @return			True if allowed access, otherwise false;
 		 */
 		virtual bool CheckClientCommandAccess(int client, const char *cmd, FlagBits cmdflags) =0;
+
+		/**
+		 * @brief Reloads a single admin without rebuilding the rest of the cache.
+		 * The admin bound to the identity (if any) is removed, admin sources are 
+		 * notified so they can load it again, and clients without an admin are 
+		 * rechecked.
+		 *
+		 * @param auth		Auth method name.
+		 * @param ident		Identity string.
+		 */
+		virtual void ReloadAdminIdentity(const char *auth, const char *ident) =0;
+
+		/**
+		 * @brief Finds the admin bound to a Steam account, without formatting 
+		 * or parsing any identity strings.  Equivalent to looking up the 
+		 * account's "steam" identity with FindAdminByIdentity().
+		 *
+		 * @param accountId	Steam account id (the low 32 bits of a SteamID64).
+		 * @return			AdminId on success, INVALID_ADMIN_ID if not found.
+		 */
+		virtual AdminId FindAdminBySteamAccount(unsigned int accountId) =0;
 	};
 }
 
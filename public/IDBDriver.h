@@ -42,7 +42,7 @@
  */
 
 #define SMINTERFACE_DBI_NAME		"IDBI"
-#define SMINTERFACE_DBI_VERSION		9
+#define SMINTERFACE_DBI_VERSION		12
 
 namespace SourceMod
 {
@@ -327,6 +327,90 @@ namespace SourceMod
 		virtual void Destroy() =0;
 	};
 
+	/**
+	 * @brief A query whose rows are read from the server as they are fetched
+	 * instead of being buffered up front.
+	 *
+	 * The result set is forward-only: Rewind() fails, MoreRows() may return
+	 * true even though no rows remain, and GetRowCount() is the number of rows
+	 * fetched so far.  FetchRow() returns NULL both on the end of the result
+	 * set and on a read error; use GetError() to tell them apart.
+	 *
+	 * The connection is busy until the stream is destroyed, so it must stay
+	 * locked for the stream's entire lifetime.
+	 */
+	class IResultStream
+	{
+	public:
+		/**
+		 * @brief Returns the streaming result set, or NULL if the query did
+		 * not produce one.
+		 */
+		virtual IResultSet *GetResultSet() =0;
+
+		/**
+		 * @brief Returns the error which ended the stream, if any.
+		 *
+		 * @param errCode		Optional pointer to store the driver error code.
+		 * @return				Error string, or an empty string if no error
+		 *						has occurred.
+		 */
+		virtual const char *GetError(int *errCode=NULL) =0;
+
+		/**
+		 * @brief Returns the number of rows affected by the query.
+		 */
+		virtual unsigned int GetAffectedRows() =0;
+
+		/**
+		 * @brief Returns the insert id generated by the query.
+		 */
+		virtual unsigned int GetInsertID() =0;
+
+		/**
+		 * @brief Discards any unread rows and frees the stream.
+		 */
+		virtual void Destroy() =0;
+	};
+
+	class IDatabase;
+
+	/**
+	 * @brief Adapts a buffered IQuery to IResultStream, for drivers that
+	 * cannot stream rows.
+	 */
+	class BufferedResultStream : public IResultStream
+	{
+	public:
+		BufferedResultStream(IDatabase *db, IQuery *query)
+		 : m_pDatabase(db), m_pQuery(query)
+		{
+		}
+	public:
+		IResultSet *GetResultSet()
+		{
+			return m_pQuery->GetResultSet();
+		}
+		const char *GetError(int *errCode=NULL)
+		{
+			if (errCode)
+			{
+				*errCode = 0;
+			}
+			return "";
+		}
+		inline unsigned int GetAffectedRows();
+		inline unsigned int GetInsertID();
+		void Destroy()
+		{
+			m_pQuery->Destroy();
+			delete this;
+		}
+	private:
+		IDatabase *m_pDatabase;
+		IQuery *m_pQuery;
+	};
+
 	class IPreparedQuery : public IQuery
 	{
 	public:
@@ -419,6 +503,18 @@ namespace SourceMod
 
 	class IDBDriver;
 
+	/**
+	 * @brief Describes the state of a connection's prepared statement cache.
+	 */
+	struct DBStatementCacheStats
+	{
+		unsigned int cached;			/**< Idle statements currently in the cache */
+		unsigned int capacity;			/**< Maximum number of idle statements kept */
+		unsigned int hits;				/**< Prepares served from the cache */
+		unsigned int misses;			/**< Prepares that had to go to the server */
+		unsigned int evictions;			/**< Statements finalized to make room */
+	};
+
 	/**
 	 * @brief Encapsulates a database connection.
 	 */
@@ -608,6 +704,148 @@ namespace SourceMod
 		 */
 		virtual bool SetCharacterSet(const char *characterset) =0;
 
+		/**
+		 * @brief Retrieves statistics for this connection's prepared statement 
+		 * cache.  Statements returned by PrepareQuery() are kept after they are 
+		 * destroyed and handed out again, reset and unbound, the next time the 
+		 * same query text is prepared.
+		 *
+		 * Only call this if GetDriver()->GetDBIVersion() is 10 or higher.
+		 *
+		 * This function is thread safe.
+		 *
+		 * @param stats			Structure to fill.
+		 * @return				True on success, false if the driver does not 
+		 *						cache statements.
+		 */
+		virtual bool GetStatementCacheStats(DBStatementCacheStats *stats)
+		{
+			return false;
+		}
+
+		/**
+		 * @brief Executes a query and returns its rows as a stream, so large
+		 * result sets never have to be held in memory at once.  Drivers that
+		 * cannot stream fall back to a buffered query.
+		 *
+		 * Only call this if GetDriver()->GetDBIVersion() is 10 or higher.
+		 *
+		 * This function is not thread safe and must be included in any locks,
+		 * which must be held until the stream is destroyed.
+		 *
+		 * @param query			Query string.
+		 * @param len			Length of query string.
+		 * @return				IResultStream pointer on success, NULL
+		 *						otherwise.
+		 */
+		virtual IResultStream *DoQueryStream(const char *query, size_t len)
+		{
+			IQuery *pQuery = DoQueryEx(query, len);
+			if (!pQuery)
+			{
+				return NULL;
+			}
+			return new BufferedResultStream(this, pQuery);
+		}
+
+		/**
+		 * @brief Executes a list of queries in order, stopping at the first
+		 * one that fails.  Drivers that can send several statements in one
+		 * round trip do so, which is much faster over a slow link; others run
+		 * the queries one at a time.
+		 *
+		 * Each query must be a single statement.
+		 *
+		 * Only call this if GetDriver()->GetDBIVersion() is 10 or higher.
+		 *
+		 * This function is not thread safe and must be included in any locks.
+		 *
+		 * @param queries		Array of query strings.
+		 * @param lengths		Array of query string lengths.
+		 * @param count			Number of queries.
+		 * @param results		Array of count entries, receiving an IQuery
+		 *						for each query that succeeded.
+		 * @return				Number of queries that succeeded.  If this is
+		 *						less than count, the query at that index failed
+		 *						and GetError() describes why.
+		 */
+		virtual size_t DoQueryBatch(const char * const *queries, const size_t *lengths, size_t count,
+			IQuery **results)
+		{
+			size_t i;
+			for (i = 0; i < count; i++)
+			{
+				if ((results[i] = DoQueryEx(queries[i], lengths[i])) == NULL)
+				{
+					break;
+				}
+			}
+			return i;
+		}
+
+		/**
+		 * @brief Quotes a string of known length for insertion into a query.
+		 * Unlike QuoteString(), the source does not need to be null-terminated,
+		 * so a slice of a larger buffer can be escaped in place.
+		 *
+		 * Only call this if GetDriver()->GetDBIVersion() is 12 or higher.
+		 *
+		 * @param str			Source string.
+		 * @param len			Number of bytes of str to quote.
+		 * @param buffer		Buffer to store new string (should not overlap source string).
+		 * @param maxlen		Maximum length of the output buffer.
+		 * @param newSize		Pointer to store the output size.
+		 * @return				True on success, false if the output buffer is not big enough.
+		 *						If not big enough, the required buffer size is passed through
+		 *						newSize.
+		 */
+		virtual bool QuoteStringEx(const char *str, size_t len, char buffer[], size_t maxlen, size_t *newSize)
+		{
+			char *temp = new char[len + 1];
+			memcpy(temp, str, len);
+			temp[len] = '\0';
+			bool ok = QuoteString(temp, buffer, maxlen, newSize);
+			delete [] temp;
+			return ok;
+		}
+
+		/**
+		 * @brief Quotes a list of strings into one buffer, back to back, each
+		 * followed by a null terminator.  This is much cheaper than calling
+		 * QuoteString() once per value when building large batched inserts.
+		 *
+		 * Only call this if GetDriver()->GetDBIVersion() is 12 or higher.
+		 *
+		 * @param strs			Array of source strings.
+		 * @param lengths		Array of source string lengths.
+		 * @param count			Number of strings.
+		 * @param buffer		Buffer to store the quoted strings (should not overlap
+		 *						the sources).
+		 * @param maxlen		Maximum length of the output buffer.
+		 * @param sizes			Array of count entries, receiving the length of each
+		 *						quoted string, not including its null terminator.
+		 * @return				Number of strings quoted.  If this is less than count,
+		 *						the output buffer was not big enough for the string at
+		 *						that index.
+		 */
+		virtual size_t QuoteStrings(const char * const *strs, const size_t *lengths, size_t count,
+			char buffer[], size_t maxlen, size_t *sizes)
+		{
+			size_t i;
+			for (i = 0; i < count; i++)
+			{
+				size_t written;
+				if (!QuoteStringEx(strs[i], lengths[i], buffer, maxlen, &written))
+				{
+					break;
+				}
+				sizes[i] = written;
+				buffer += written + 1;
+				maxlen -= written + 1;
+			}
+			return i;
+		}
+
 #if !defined(SOURCEMOD_SQL_DRIVER_CODE)
 		/**
 		 * @brief Wrapper around IncReferenceCount(), for ke::Ref.
@@ -625,6 +863,16 @@ namespace SourceMod
 #endif
 	};
 
+	inline unsigned int BufferedResultStream::GetAffectedRows()
+	{
+		return m_pDatabase->GetAffectedRowsForQuery(m_pQuery);
+	}
+
+	inline unsigned int BufferedResultStream::GetInsertID()
+	{
+		return m_pDatabase->GetInsertIDForQuery(m_pQuery);
+	}
+
 	/** 
 	 * @brief Describes database connection info.
 	 */
@@ -635,6 +883,7 @@ namespace SourceMod
 			dbiVersion = SMINTERFACE_DBI_VERSION;
 			port = 0;
 			maxTimeout = 0;
+			options = NULL;
 		}
 		unsigned int dbiVersion;		/**< DBI Version for backwards compatibility */
 		const char *host;				/**< Host string */
@@ -644,6 +893,12 @@ namespace SourceMod
 		const char *driver;				/**< Driver to use */
 		unsigned int port;				/**< Port to use, 0=default */
 		unsigned int maxTimeout;		/**< Maximum timeout, 0=default */
+		/**
+		 * Driver-specific settings from databases.cfg, as a NULL-terminated
+		 * list of alternating keys and values, or NULL if there are none.
+		 * Only present when dbiVersion >= 11.
+		 */
+		const char *const *options;
 	};
 
 	/**
@@ -925,6 +1180,27 @@ namespace SourceMod
 		 * @param driver		Driver that is being used.
 		 */
 		virtual void AddDependency(IExtension *myself, IDBDriver *driver) =0;
+
+		/**
+		 * @brief Adds a threaded database operation to the queue of the 
+		 * worker that owns the given connection.  Operations on the same 
+		 * connection run in the order they were added, while operations on 
+		 * different connections may run in parallel.  This function is not 
+		 * thread safe.
+		 *
+		 * Operations added through AddToThreadQueue() all share a single 
+		 * worker, so they keep their relative order.  That worker cannot 
+		 * know which connection they use, so a connection must not be 
+		 * given to both functions; use this one for all of its operations.
+		 *
+		 * @param op			Instance of an IDBThreadOperation.
+		 * @param prio			Priority level to run at.
+		 * @param db			Connection the operation runs on, or NULL if 
+		 *						it is not bound to a connection yet (it may 
+		 *						then run on any worker).
+		 * @return				True on success, false on failure.
+		 */
+		virtual bool AddToConnectionQueue(IDBThreadOperation *op, PrioQueueLevel prio, IDatabase *db) =0;
 	};
 }
 
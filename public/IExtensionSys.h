@@ -137,8 +137,9 @@ namespace SourceMod
 	 * V6 - added TestFeature() to IShareSys.
 	 * V7 - added OnDependenciesDropped() to IExtensionInterface.
 	 * V8 - added OnCoreMapEnd() to IExtensionInterface.
+	 * V9 - added IsLazyLoadable() to IExtensionInterface.
 	 */
-	#define SMINTERFACE_EXTENSIONAPI_VERSION	8
+	#define SMINTERFACE_EXTENSIONAPI_VERSION	9
 
 	/**
 	 * @brief The interface an extension must expose.
@@ -336,6 +337,23 @@ namespace SourceMod
 		virtual void OnCoreMapEnd()
 		{
 		}
+
+		/**
+		 * @brief Returns whether Core may defer loading this extension until
+		 * one of its natives is first called.
+		 *
+		 * Core records the natives and libraries of a lazy-loadable extension
+		 * after it loads, and on later startups binds placeholder natives
+		 * instead of loading it. Only extensions that do nothing until a
+		 * plugin calls into them (no forwards, hooks, interfaces or timers
+		 * of their own) should return true.
+		 *
+		 * @return			True if loading may be deferred.
+		 */
+		virtual bool IsLazyLoadable()
+		{
+			return false;
+		}
 	};
 
 	/**
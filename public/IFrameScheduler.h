@@ -0,0 +1,116 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2024 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_SOURCEMOD_FRAME_SCHEDULER_H_
+#define _INCLUDE_SOURCEMOD_FRAME_SCHEDULER_H_
+
+/**
+ * @file IFrameScheduler.h
+ * @brief Runs deferred work on later frames, within a per-frame time budget.
+ */
+
+#include <IShareSys.h>
+
+#define SMINTERFACE_FRAMESCHEDULER_NAME		"IFrameScheduler"
+#define SMINTERFACE_FRAMESCHEDULER_VERSION	1
+
+namespace SourceMod
+{
+	/**
+	 * @brief Scheduling priority of a frame task.
+	 */
+	enum FrameTaskPriority
+	{
+		FrameTask_High = 0,		/**< Always runs on the next frame, regardless of the budget */
+		FrameTask_Normal,		/**< Runs as soon as the frame budget allows */
+		FrameTask_Low,			/**< Runs only when no normal priority task is waiting */
+
+		FrameTask_Priorities
+	};
+
+	/**
+	 * @brief Frame task callback.
+	 *
+	 * @param data		Private data passed to AddTask().
+	 */
+	typedef void (*FRAMETASK)(void *data);
+
+	/**
+	 * @brief Queues work to run on later frames without going over a fixed
+	 * amount of time per frame ("FrameTaskBudget" in core.cfg).
+	 *
+	 * Normal and low priority tasks run in the order they were queued until
+	 * the budget for the frame is used up; the rest wait for the next frame.
+	 * At least one of them runs every frame, so the queue always makes
+	 * progress. Time spent is accounted per owner, see "sm frametasks".
+	 */
+	class IFrameScheduler : public SMInterface
+	{
+	public:
+		const char *GetInterfaceName()
+		{
+			return SMINTERFACE_FRAMESCHEDULER_NAME;
+		}
+		unsigned int GetInterfaceVersion()
+		{
+			return SMINTERFACE_FRAMESCHEDULER_VERSION;
+		}
+	public:
+		/**
+		 * @brief Queues a task. Must be called from the main thread.
+		 *
+		 * @param owner		Identity the task's time is accounted to, such as
+		 *					myself->GetIdentity() for an extension.
+		 * @param priority	Task priority.
+		 * @param fn		Function to call.
+		 * @param data		Private data to pass to the function.
+		 */
+		virtual void AddTask(IdentityToken_t *owner, FrameTaskPriority priority, FRAMETASK fn, void *data) =0;
+
+		/**
+		 * @brief Drops every queued task of an owner without running it.
+		 * Extensions should call this when unloading.
+		 *
+		 * @param owner		Owner passed to AddTask().
+		 * @param fn		If not NULL, only tasks with this function are dropped.
+		 * @return			Number of tasks dropped.
+		 */
+		virtual unsigned int CancelTasks(IdentityToken_t *owner, FRAMETASK fn) =0;
+
+		/**
+		 * @brief Returns the time budget for normal and low priority tasks,
+		 * in microseconds per frame.
+		 */
+		virtual unsigned int GetFrameBudget() =0;
+	};
+}
+
+#endif //_INCLUDE_SOURCEMOD_FRAME_SCHEDULER_H_
@@ -36,7 +36,7 @@
 #include <IHandleSys.h>
 
 #define SMINTERFACE_MENUMANAGER_NAME		"IMenuManager"
-#define SMINTERFACE_MENUMANAGER_VERSION		17
+#define SMINTERFACE_MENUMANAGER_VERSION		19
 
 /**
  * @file IMenuManager.h
@@ -845,6 +845,42 @@ namespace SourceMod
 			unsigned int item_on_page)
 		{
 		}
+
+		/**
+		 * @brief Returns whether this handler may change how a menu is drawn 
+		 * for individual clients, through OnMenuDisplay(), OnMenuDrawItem() 
+		 * or OnMenuDisplayItem().  If not, Core may reuse a page rendered for 
+		 * one client for every other client using the same language, without 
+		 * calling those functions again.
+		 *
+		 * Note: This callback was added in v18.
+		 *
+		 * @param menu			Menu pointer.
+		 * @return				True if drawing may differ per client.
+		 */
+		virtual bool IsMenuDrawnPerClient(IBaseMenu *menu)
+		{
+			return true;
+		}
+
+		/**
+		 * @brief Called while a vote is running, after votes change, so 
+		 * live results can be shown.  Calls are throttled by the 
+		 * sm_vote_progress_interval cvar, and a call that was held back 
+		 * is made once the interval passes.
+		 *
+		 * In the results, num_clients is the number of clients in the vote 
+		 * pool and client_list is NULL.  item_list only has items with at 
+		 * least one vote, sorted by count, descending.
+		 *
+		 * Note: This callback was added in v19.
+		 *
+		 * @param menu			Menu pointer.
+		 * @param results		Current vote tally.
+		 */
+		virtual void OnMenuVoteProgress(IBaseMenu *menu, const menu_vote_result_t *results)
+		{
+		}
 	};
 
 	/**
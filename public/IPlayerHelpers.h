@@ -41,7 +41,7 @@
 #include <IAdminSystem.h>
 
 #define SMINTERFACE_PLAYERMANAGER_NAME		"IPlayerManager"
-#define SMINTERFACE_PLAYERMANAGER_VERSION	22
+#define SMINTERFACE_PLAYERMANAGER_VERSION	24
 
 struct edict_t;
 class IPlayerInfo;
@@ -53,6 +53,20 @@ class IPlayerInfo;
 
 namespace SourceMod
 {
+	/**
+	 * @brief Client state bits, see IPlayerManager::GetClientStateFlags().
+	 */
+	enum ClientStateFlags
+	{
+		ClientState_Connected = (1<<0),		/**< Client is connected */
+		ClientState_InGame = (1<<1),		/**< Client is in game */
+		ClientState_FakeClient = (1<<2),	/**< Client is a bot */
+		ClientState_Authorized = (1<<3),	/**< Client is authorized */
+		ClientState_SourceTV = (1<<4),		/**< Client is the SourceTV bot */
+		ClientState_Replay = (1<<5),		/**< Client is the Replay bot */
+		ClientState_Alive = (1<<6),			/**< Client is alive; only for GetClientsMatching() */
+	};
+
 	/**
 	 * @brief Abstracts some Half-Life 2 and SourceMod properties about clients.
 	 */
@@ -302,6 +316,15 @@ namespace SourceMod
 		 * @return		Language id.
 		 */
 		virtual unsigned int GetOriginalLanguageId() =0;
+
+		/**
+		 * @brief Returns the client's Steam ID as a decimal SteamID64 string.
+		 *
+		 * @param validated		Check backend validation status.
+		 * 
+		 * @return			SteamID64 string on success or NULL if not available.
+		 */
+		virtual const char *GetSteamId64String(bool validated = true) =0;
 	};
 
 	/**
@@ -636,6 +659,40 @@ namespace SourceMod
 		 * @brief Reruns admin checks on all players.
 		 */
 		virtual void RecheckAnyAdmins() =0;
+
+		/**
+		 * @brief Returns a client's cached ClientState_* bits. This is cheaper
+		 * than going through IGamePlayer. ClientState_Alive is never set, and
+		 * ClientState_InGame does not check that the entity still exists.
+		 *
+		 * @param client		Client index.
+		 * @return				ClientState_* flags, or 0 for an invalid index.
+		 */
+		virtual unsigned int GetClientStateFlags(int client) =0;
+
+		/**
+		 * @brief Finds every client with all of the |flags| bits and none of the
+		 * |exclude| bits set, optionally limited to one team. Filtering on
+		 * ClientState_Alive or a team only matches clients who are in game.
+		 *
+		 * @param flags			ClientState_* bits that must be set.
+		 * @param exclude		ClientState_* bits that must not be set.
+		 * @param team			Team index to match, or -1 for any team.
+		 * @param clients		Array to store client indexes in.
+		 * @param maxclients	Size of the array.
+		 * @return				Number of clients stored.
+		 */
+		virtual int GetClientsMatching(unsigned int flags, unsigned int exclude, int team,
+			int *clients, int maxclients) =0;
+
+		/**
+		 * @brief Returns the client index of a connected client by Steam ID.
+		 *
+		 * @param steamId		SteamID64 to look up.
+		 * @param validated		Only match clients whose Steam ID is validated.
+		 * @return				Client index, or 0 if no client matches.
+		 */
+		virtual int GetClientOfSteamId64(uint64_t steamId, bool validated) =0;
 	};
 }
 
@@ -42,7 +42,7 @@
 #include <time.h>
 
 #define SMINTERFACE_SOURCEMOD_NAME		"ISourceMod"
-#define SMINTERFACE_SOURCEMOD_VERSION	14
+#define SMINTERFACE_SOURCEMOD_VERSION	16
 
 /**
 * @brief Forward declaration of the KeyValues class.
@@ -331,6 +331,43 @@ namespace SourceMod
 		 * @return			Pseudo address, or 0 if memory address could not be converted.
 		 */
 		virtual uint32_t ToPseudoAddress(void *addr) = 0;
+
+		/**
+		 * @brief Posts an action to run on the game thread, usually on the next
+		 * frame. Unlike AddFrameAction(), this never takes a lock, so it is
+		 * the cheapest way to hand a result back from a background thread.
+		 *
+		 * Actions run in the order each thread posted them. Core stops
+		 * draining them once the "GameThreadPostBudget" core.cfg time is used
+		 * up, so a burst may be spread across several frames.
+		 *
+		 * This function is thread safe.
+		 *
+		 * @param fn		Function to execute.
+		 * @param data		Data to pass to function.
+		 */
+		virtual void PostToGameThread(FRAMEACTION fn, void *data) = 0;
+
+		/**
+		 * @brief Returns whether a profiling tool ("sm prof") is running.
+		 * Callers can skip building scope names when it is not.
+		 */
+		virtual bool IsProfilingActive() = 0;
+
+		/**
+		 * @brief Opens a scope in the active profiling tool, the same way
+		 * the EnterProfilingEvent native does. Does nothing if no tool is
+		 * active. Every call must be balanced by LeaveProfileScope().
+		 *
+		 * @param group		Scope group, or NULL for none.
+		 * @param name		Scope name.
+		 */
+		virtual void EnterProfileScope(const char *group, const char *name) = 0;
+
+		/**
+		 * @brief Closes the scope opened by the last EnterProfileScope().
+		 */
+		virtual void LeaveProfileScope() = 0;
 	};
 }
 
@@ -40,9 +40,10 @@
  */
 
 #include <IShareSys.h>
+#include <IHandleSys.h>
 
 #define SMINTERFACE_THREADER_NAME		"IThreader"
-#define SMINTERFACE_THREADER_VERSION	3
+#define SMINTERFACE_THREADER_VERSION	5
 
 namespace SourceMod
 {
@@ -410,6 +411,167 @@ namespace SourceMod
 		}
 	};
 
+	/**
+	 * @brief A unit of work for the shared thread pool (see IThreader::AddTask).
+	 */
+	class IThreadTask
+	{
+	public:
+		virtual ~IThreadTask()
+		{
+		};
+	public:
+		/**
+		 * @brief Returns a name used to group pool statistics ("sm threadpool").
+		 * The string must remain valid for the lifetime of the task.
+		 *
+		 * @return			Task type name.
+		 */
+		virtual const char *GetTaskType()
+		{
+			return "unnamed";
+		}
+
+		/**
+		 * @brief Runs the task on a pool thread. This must not call into the
+		 * game, SourcePawn, or any other non-thread-safe API.
+		 */
+		virtual void RunTask() =0;
+
+		/**
+		 * @brief Called on the main thread after RunTask() has returned, or
+		 * instead of RunTask() if the task was cancelled before it started.
+		 * The pool does not touch the task afterwards, so it may delete itself.
+		 *
+		 * @param cancelled	True if RunTask() was never called.
+		 */
+		virtual void OnTaskComplete(bool cancelled) =0;
+	};
+
+	/**
+	 * @brief The contents of a DataPack while it is lent to a pool task (see
+	 * IThreader::AddDataPackTask). The task has them to itself, so no locking
+	 * is needed, and nothing is copied in either direction.
+	 *
+	 * Reads start at the pack's position when it was lent. Writes insert at
+	 * the current position. The final position is kept when the contents are
+	 * returned. Pointers returned by the read functions are invalidated by
+	 * the next write.
+	 */
+	class IDataPackBuffer
+	{
+	public:
+		/**
+		 * @brief Moves the position back to the first element.
+		 */
+		virtual void Reset() =0;
+
+		/**
+		 * @brief Removes every element.
+		 */
+		virtual void Clear() =0;
+
+		/**
+		 * @brief Returns whether there is an element at the current position.
+		 */
+		virtual bool IsReadable() =0;
+
+		/**
+		 * @brief Reads a cell and advances the position.
+		 *
+		 * @param value		Pointer to store the cell.
+		 * @return			False if the current element is not a cell.
+		 */
+		virtual bool ReadCell(cell_t *value) =0;
+
+		/**
+		 * @brief Reads a float and advances the position.
+		 *
+		 * @param value		Pointer to store the float.
+		 * @return			False if the current element is not a float.
+		 */
+		virtual bool ReadFloat(float *value) =0;
+
+		/**
+		 * @brief Reads a string in place and advances the position.
+		 *
+		 * @param length	Optional pointer to store the string length.
+		 * @return			The string, or NULL if the current element is not a string.
+		 */
+		virtual const char *ReadString(size_t *length) =0;
+
+		/**
+		 * @brief Reads a cell array in place and advances the position.
+		 *
+		 * @param count		Optional pointer to store the number of cells.
+		 * @return			The cells, or NULL if the current element is not a cell array.
+		 */
+		virtual const cell_t *ReadCellArray(size_t *count) =0;
+
+		/**
+		 * @brief Writes a cell.
+		 */
+		virtual void PackCell(cell_t value) =0;
+
+		/**
+		 * @brief Writes a float.
+		 */
+		virtual void PackFloat(float value) =0;
+
+		/**
+		 * @brief Writes a string.
+		 */
+		virtual void PackString(const char *string) =0;
+
+		/**
+		 * @brief Writes a cell array.
+		 *
+		 * @param values	Cells to write.
+		 * @param count		Number of cells.
+		 */
+		virtual void PackCellArray(const cell_t *values, size_t count) =0;
+	};
+
+	/**
+	 * @brief A pool task that borrows a DataPack (see IThreader::AddDataPackTask).
+	 */
+	class IDataPackTask
+	{
+	public:
+		virtual ~IDataPackTask()
+		{
+		};
+	public:
+		/**
+		 * @brief Returns a name used to group pool statistics ("sm threadpool").
+		 * The string must remain valid for the lifetime of the task.
+		 *
+		 * @return			Task type name.
+		 */
+		virtual const char *GetTaskType()
+		{
+			return "datapack";
+		}
+
+		/**
+		 * @brief Runs the task on a pool thread with exclusive access to the
+		 * pack's contents. The same restrictions as IThreadTask::RunTask() apply.
+		 *
+		 * @param buffer	The pack's contents, valid until this returns.
+		 */
+		virtual void RunTask(IDataPackBuffer *buffer) =0;
+
+		/**
+		 * @brief Called on the main thread once the contents are back in the
+		 * pack, so its Handle can be passed straight to a plugin callback.
+		 * If the Handle was closed in the meantime, the pack is already gone.
+		 * The pool does not touch the task afterwards.
+		 *
+		 * @param cancelled	True if RunTask() was never called.
+		 */
+		virtual void OnTaskComplete(bool cancelled) =0;
+	};
+
 	/**
 	 * @brief Describes a threading system
 	 */
@@ -470,6 +632,59 @@ namespace SourceMod
 		 * @param pWorker	IThreadWorker pointer to destroy.
 		 */
 		virtual void DestroyWorker(IThreadWorker *pWorker) =0;
+	public:
+		/**
+		 * @brief Queues a task on the shared work-stealing thread pool. Pool
+		 * threads are started on first use; prefer this over creating threads.
+		 *
+		 * This may be called from any thread, including from a running task.
+		 * Completion callbacks are always delivered on the main thread, at
+		 * most one game frame after the task finishes.
+		 *
+		 * @param owner		Identity the task belongs to (usually myself->GetIdentity()).
+		 * @param task		Task to run; must stay valid until OnTaskComplete().
+		 * @return			True on success, false if the pool has shut down,
+		 *					in which case no callback will be made.
+		 */
+		virtual bool AddTask(IdentityToken_t *owner, IThreadTask *task) =0;
+
+		/**
+		 * @brief Lends a DataPack's contents to a task on the shared thread
+		 * pool. The contents are moved, not copied, so large payloads cost
+		 * nothing to hand over. Until the task completes, plugins using the
+		 * pack get an error; closing its Handle is allowed and frees the pack
+		 * once the task is done. Must be called from the main thread.
+		 *
+		 * @param owner		Identity the task belongs to (usually myself->GetIdentity()).
+		 * @param pack		DataPack Handle.
+		 * @param packOwner	Owner of the Handle (usually the plugin's identity).
+		 * @param task		Task to run; must stay valid until OnTaskComplete().
+		 * @param err		Optional pointer to store a Handle error.
+		 * @return			True on success. False if the Handle is invalid, the
+		 *					pack is already lent, or the pool has shut down, in
+		 *					which case the pack is untouched and no callback
+		 *					will be made.
+		 */
+		virtual bool AddDataPackTask(IdentityToken_t *owner, Handle_t pack, IdentityToken_t *packOwner,
+			IDataPackTask *task, HandleError *err=NULL) =0;
+
+		/**
+		 * @brief Cancels all queued tasks of an owner and waits for its running
+		 * tasks to finish. Every callback for the owner's tasks is made before
+		 * this returns. Must be called from the main thread. This is done
+		 * automatically when an extension unloads.
+		 *
+		 * @param owner		Identity passed to AddTask().
+		 * @return			Number of tasks that were cancelled before they ran.
+		 */
+		virtual unsigned int CancelTasks(IdentityToken_t *owner) =0;
+
+		/**
+		 * @brief Returns the number of threads the shared pool uses.
+		 *
+		 * @return			Number of pool threads.
+		 */
+		virtual unsigned int GetPoolThreadCount() =0;
 	};
 };
 
@@ -40,7 +40,7 @@
  */
 
 #define SMINTERFACE_WEBTERNET_NAME		"IWebternet"
-#define SMINTERFACE_WEBTERNET_VERSION	3
+#define SMINTERFACE_WEBTERNET_VERSION	4
 
 namespace SourceMod
 {
@@ -54,6 +54,7 @@ namespace SourceMod
 	};
 
 	class IWebTransfer;
+	class IWebRequest;
 	class IWebternet;
 
 	/**
@@ -201,6 +202,153 @@ namespace SourceMod
 		virtual bool SetFailOnHTTPError(bool fail) = 0;
 	};
 
+	/**
+	 * @brief Receives the results of an IWebRequest.  Every callback happens on the
+	 * game thread.
+	 */
+	class IWebRequestHandler
+	{
+	public:
+		/**
+		 * @brief Must return the interface version this listener is compatible with.
+		 *
+		 * @return					Interface version.
+		 */
+		virtual unsigned int GetURLInterfaceVersion()
+		{
+			return SMINTERFACE_WEBTERNET_VERSION;
+		}
+
+		/**
+		 * @brief Called with each block of the response body, in order, when the
+		 * request streams its body (see IWebRequest::SetStreamBody).
+		 *
+		 * @param request			Request object.
+		 * @param userdata			User data passed to IWebRequest::Start().
+		 * @param data				Block of the response body.
+		 * @param length			Length of the block, in bytes.
+		 * @return					DownloadWrite_Error to abort the transfer.
+		 */
+		virtual DownloadWriteStatus OnRequestData(IWebRequest *request,
+			void *userdata,
+			const void *data,
+			size_t length)
+		{
+			return DownloadWrite_Okay;
+		}
+
+		/**
+		 * @brief Called once the request has finished, failed, or was aborted.  The
+		 * request may be closed from within this callback.
+		 *
+		 * @param request			Request object.
+		 * @param userdata			User data passed to IWebRequest::Start().
+		 * @param success			True if the transfer completed.
+		 */
+		virtual void OnRequestComplete(IWebRequest *request, void *userdata, bool success) = 0;
+	};
+
+	/**
+	 * @brief A non-blocking HTTP request.
+	 *
+	 * Requests run on a shared transfer thread that keeps connections alive and
+	 * reuses (and, where the server allows, pipelines) them for requests to the
+	 * same host.  The request may only be configured before Start(), and only
+	 * from the game thread.
+	 */
+	class IWebRequest
+	{
+	public:
+		/**
+		 * @brief Adds a request header.
+		 *
+		 * @param header			Full header line, e.g. "Content-Type: text/plain".
+		 * @return					True on success, false on failure.
+		 */
+		virtual bool AddHeader(const char *header) = 0;
+
+		/**
+		 * @brief Sets the HTTP method.  Defaults to GET, or POST if a body is set.
+		 *
+		 * @param method			Method name.
+		 * @return					True on success, false on failure.
+		 */
+		virtual bool SetMethod(const char *method) = 0;
+
+		/**
+		 * @brief Sets the request body.  The data is copied.
+		 *
+		 * @param data				Body data.
+		 * @param length			Length of the body, in bytes.
+		 * @return					True on success, false on failure.
+		 */
+		virtual bool SetBody(const void *data, size_t length) = 0;
+
+		/**
+		 * @brief Sets the maximum time the whole transfer may take.
+		 *
+		 * @param seconds			Timeout in seconds, or 0 for none (the default).
+		 */
+		virtual void SetTimeout(unsigned int seconds) = 0;
+
+		/**
+		 * @brief Sets whether an HTTP failure (>= 400) fails the request.
+		 *
+		 * Note: defaults to false.
+		 *
+		 * @param fail				True to fail, false otherwise.
+		 */
+		virtual void SetFailOnHTTPError(bool fail) = 0;
+
+		/**
+		 * @brief Sets whether the response body is handed to OnRequestData() as it
+		 * arrives instead of being collected for GetResponseBody().
+		 *
+		 * Note: defaults to false.
+		 *
+		 * @param stream			True to stream, false to collect.
+		 */
+		virtual void SetStreamBody(bool stream) = 0;
+
+		/**
+		 * @brief Queues the request on the transfer thread.  A request can only be
+		 * started once.
+		 *
+		 * @param handler			Handler object.
+		 * @param userdata			User data pointer.
+		 * @return					True on success, false if already started.
+		 */
+		virtual bool Start(IWebRequestHandler *handler, void *userdata) = 0;
+
+		/**
+		 * @brief Returns the HTTP response code, or 0 if none was received.
+		 */
+		virtual int GetResponseCode() = 0;
+
+		/**
+		 * @brief Returns a human-readable error message from a failed transfer.
+		 */
+		virtual const char *LastErrorMessage() = 0;
+
+		/**
+		 * @brief Returns the collected response body.  Empty if the body was streamed.
+		 *
+		 * @param length			Set to the length of the body, in bytes.
+		 * @return					Body data.
+		 */
+		virtual const void *GetResponseBody(size_t *length) = 0;
+
+		/**
+		 * @brief Releases the request, aborting it if it is still running.  No
+		 * handler callbacks are made after this.  Do not use delete.
+		 */
+		virtual void Close() = 0;
+	protected:
+		virtual ~IWebRequest()
+		{
+		}
+	};
+
 	/**
 	 * @brief Interface for managing web URL sessions.
 	 */
@@ -223,6 +371,14 @@ namespace SourceMod
 		 * @return				New form, or NULL on failure.
 		 */
 		virtual IWebForm *CreateForm() = 0;
+
+		/**
+		 * @brief Creates a non-blocking HTTP request.
+		 *
+		 * @param url			URL to request.
+		 * @return				New request, or NULL on failure.  Release with Close().
+		 */
+		virtual IWebRequest *CreateRequest(const char *url) = 0;
 	};
 }
 
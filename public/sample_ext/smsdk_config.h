@@ -58,6 +58,13 @@
  */
 //#define SMEXT_CONF_METAMOD		
 
+/**
+ * @brief Lets Core defer loading this extension until one of its natives is
+ * first called. See IExtensionInterface::IsLazyLoadable().
+ * NOTE: Uncomment to enable, comment to disable.
+ */
+//#define SMEXT_CONF_LAZY
+
 /** Enable interfaces you want to use here by uncommenting lines */
 //#define SMEXT_ENABLE_FORWARDSYS
 //#define SMEXT_ENABLE_HANDLESYS
@@ -71,6 +78,7 @@
 //#define SMEXT_ENABLE_LIBSYS
 //#define SMEXT_ENABLE_MENUS
 //#define SMEXT_ENABLE_ADTFACTORY
+//#define SMEXT_ENABLE_FRAMESCHEDULER
 //#define SMEXT_ENABLE_PLUGINSYS
 //#define SMEXT_ENABLE_ADMINSYS
 //#define SMEXT_ENABLE_TEXTPARSERS
@@ -0,0 +1,440 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#ifndef _include_sourcemod_flatmap_h_
+#define _include_sourcemod_flatmap_h_
+
+/**
+ * @file sm_flatmap.h
+ *
+ * @brief String -> Value map using open addressing with grouped control
+ * bytes (the "Swiss table" layout).
+ *
+ * Every slot has one control byte: empty, deleted, or the low 7 bits of the
+ * key's hash. Lookups scan the control bytes eight at a time and only touch
+ * slots whose tag matches, so a miss usually costs a single cache line.
+ * Slots hold the full hash and the key inline (short keys never leave the
+ * slot), and the table is rebuilt at 7/8 load.
+ *
+ * The API follows KTrie (and so the sm_trie/IBasicTrie wrappers), which
+ * makes it a drop-in replacement for it.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <string>
+#include <utility>
+
+namespace SourceMod
+{
+
+namespace detail
+{
+	static const int8_t kFlatCtrlEmpty = -128;
+	static const int8_t kFlatCtrlDeleted = -2;
+
+	// A portable (no SIMD) view of eight control bytes. Each query returns a
+	// mask with the high bit set in every byte that satisfies it.
+	class FlatGroup
+	{
+	public:
+		static const size_t kWidth = 8;
+
+		explicit FlatGroup(const int8_t *ctrl)
+		{
+			ctrl_ = 0;
+			for (size_t i = 0; i < kWidth; i++)
+				ctrl_ |= uint64_t(uint8_t(ctrl[i])) << (i * 8);
+		}
+
+		// May report false positives, but only on full slots; callers always
+		// compare the key afterwards.
+		uint64_t Match(uint8_t h2) const {
+			uint64_t x = ctrl_ ^ (kLsbs * h2);
+			return (x - kLsbs) & ~x & kMsbs;
+		}
+		uint64_t MatchEmpty() const {
+			return (ctrl_ & ~(ctrl_ << 6)) & kMsbs;
+		}
+		uint64_t MatchEmptyOrDeleted() const {
+			return (ctrl_ & ~(ctrl_ << 7)) & kMsbs;
+		}
+
+		static size_t LowestByte(uint64_t mask) {
+#if defined(__GNUC__)
+			return size_t(__builtin_ctzll(mask)) >> 3;
+#else
+			size_t i = 0;
+			while (!(mask & 0x80)) {
+				mask >>= 8;
+				i++;
+			}
+			return i;
+#endif
+		}
+		static size_t HighestByte(uint64_t mask) {
+#if defined(__GNUC__)
+			return size_t(63 - __builtin_clzll(mask)) >> 3;
+#else
+			size_t i = kWidth - 1;
+			while (!(mask & (uint64_t(0x80) << (i * 8))))
+				i--;
+			return i;
+#endif
+		}
+
+	private:
+		static const uint64_t kLsbs = 0x0101010101010101ULL;
+		static const uint64_t kMsbs = 0x8080808080808080ULL;
+
+		uint64_t ctrl_;
+	};
+}
+
+template <typename T>
+class StringFlatMap
+{
+	typedef detail::FlatGroup Group;
+
+	struct Slot
+	{
+		template <typename U>
+		Slot(uint32_t hash, const char *key, size_t length, U &&value)
+		  : hash(hash),
+		    key(key, length),
+		    value(std::forward<U>(value))
+		{}
+
+		uint32_t hash;
+		std::string key;
+		T value;
+	};
+
+	static const size_t kNotFound = size_t(-1);
+	static const size_t kMinCapacity = Group::kWidth;
+
+public:
+	StringFlatMap()
+	  : ctrl_(nullptr),
+	    slots_(nullptr),
+	    capacity_(0),
+	    size_(0),
+	    growth_left_(0)
+	{
+	}
+	~StringFlatMap()
+	{
+		clear();
+		free(ctrl_);
+		free(slots_);
+	}
+
+	StringFlatMap(const StringFlatMap &other) = delete;
+	StringFlatMap &operator =(const StringFlatMap &other) = delete;
+
+	// Inserts a new key. Returns false if the key already exists or memory
+	// could not be allocated.
+	template <typename U>
+	bool insert(const char *key, U &&value)
+	{
+		size_t length;
+		uint32_t hash = Hash(key, &length);
+		if (lookup(key, length, hash) != kNotFound)
+			return false;
+		return add(key, length, hash, std::forward<U>(value)) != kNotFound;
+	}
+
+	// Inserts a key, or overwrites the value of an existing one.
+	template <typename U>
+	bool replace(const char *key, U &&value)
+	{
+		size_t length;
+		uint32_t hash = Hash(key, &length);
+		size_t index = lookup(key, length, hash);
+		if (index != kNotFound) {
+			slots_[index].value = std::forward<U>(value);
+			return true;
+		}
+		return add(key, length, hash, std::forward<U>(value)) != kNotFound;
+	}
+
+	T *retrieve(const char *key)
+	{
+		size_t length;
+		uint32_t hash = Hash(key, &length);
+		size_t index = lookup(key, length, hash);
+		if (index == kNotFound)
+			return nullptr;
+		return &slots_[index].value;
+	}
+
+	bool retrieve(const char *key, T *result)
+	{
+		T *value = retrieve(key);
+		if (!value)
+			return false;
+		if (result)
+			*result = *value;
+		return true;
+	}
+
+	bool contains(const char *key)
+	{
+		return retrieve(key) != nullptr;
+	}
+
+	bool remove(const char *key)
+	{
+		size_t length;
+		uint32_t hash = Hash(key, &length);
+		size_t index = lookup(key, length, hash);
+		if (index == kNotFound)
+			return false;
+		erase(index);
+		return true;
+	}
+
+	// Removes every key but keeps the table allocated.
+	void clear()
+	{
+		if (!capacity_)
+			return;
+		for (size_t i = 0; i < capacity_; i++) {
+			if (ctrl_[i] >= 0)
+				slots_[i].~Slot();
+		}
+		memset(ctrl_, detail::kFlatCtrlEmpty, capacity_ + Group::kWidth - 1);
+		size_ = 0;
+		growth_left_ = MaxLoad(capacity_);
+	}
+
+	size_t size() const
+	{
+		return size_;
+	}
+
+	size_t mem_usage() const
+	{
+		size_t bytes = capacity_ * sizeof(Slot);
+		if (capacity_)
+			bytes += capacity_ + Group::kWidth - 1;
+		for (size_t i = 0; i < capacity_; i++) {
+			if (ctrl_[i] >= 0)
+				bytes += slots_[i].key.size() + 1;
+		}
+		return bytes;
+	}
+
+	// Calls |fn(const char *key, T &value)| for every entry, in no
+	// particular order. The map must not be modified during the walk.
+	template <typename Func>
+	void for_each(Func &&fn)
+	{
+		for (size_t i = 0; i < capacity_; i++) {
+			if (ctrl_[i] >= 0)
+				fn(slots_[i].key.c_str(), slots_[i].value);
+		}
+	}
+
+private:
+	// FNV-1a with a murmur3 finalizer, so the low seven bits used as the tag
+	// are as well mixed as the rest. Also measures the key.
+	static uint32_t Hash(const char *key, size_t *length)
+	{
+		uint32_t hash = 2166136261u;
+		const char *p = key;
+		for (; *p; p++) {
+			hash ^= uint8_t(*p);
+			hash *= 16777619u;
+		}
+		*length = p - key;
+
+		hash ^= hash >> 16;
+		hash *= 0x85ebca6bu;
+		hash ^= hash >> 13;
+		hash *= 0xc2b2ae35u;
+		hash ^= hash >> 16;
+		return hash;
+	}
+
+	static size_t MaxLoad(size_t capacity)
+	{
+		return capacity - capacity / 8;
+	}
+
+	static uint8_t H2(uint32_t hash)
+	{
+		return uint8_t(hash & 0x7f);
+	}
+
+	size_t lookup(const char *key, size_t length, uint32_t hash) const
+	{
+		if (!capacity_)
+			return kNotFound;
+
+		size_t mask = capacity_ - 1;
+		size_t pos = (hash >> 7) & mask;
+		for (size_t step = Group::kWidth; ; step += Group::kWidth) {
+			Group group(ctrl_ + pos);
+			for (uint64_t bits = group.Match(H2(hash)); bits; bits &= bits - 1) {
+				size_t index = (pos + Group::LowestByte(bits)) & mask;
+				const Slot &slot = slots_[index];
+				if (slot.hash == hash &&
+				    slot.key.size() == length &&
+				    memcmp(slot.key.data(), key, length) == 0)
+				{
+					return index;
+				}
+			}
+			if (group.MatchEmpty())
+				return kNotFound;
+			pos = (pos + step) & mask;
+		}
+	}
+
+	// Triangular probing over groups visits every slot, and the table is
+	// never completely full, so this always finds a free slot.
+	size_t findFree(uint32_t hash) const
+	{
+		size_t mask = capacity_ - 1;
+		size_t pos = (hash >> 7) & mask;
+		for (size_t step = Group::kWidth; ; step += Group::kWidth) {
+			Group group(ctrl_ + pos);
+			if (uint64_t bits = group.MatchEmptyOrDeleted())
+				return (pos + Group::LowestByte(bits)) & mask;
+			pos = (pos + step) & mask;
+		}
+	}
+
+	// The first kWidth - 1 control bytes are mirrored past the end, so a
+	// group starting near the end of the table can be read in one piece.
+	void setCtrl(size_t index, int8_t value)
+	{
+		ctrl_[index] = value;
+		if (index < Group::kWidth - 1)
+			ctrl_[capacity_ + index] = value;
+	}
+
+	template <typename U>
+	size_t add(const char *key, size_t length, uint32_t hash, U &&value)
+	{
+		size_t index = capacity_ ? findFree(hash) : kNotFound;
+		if (index == kNotFound || (!growth_left_ && ctrl_[index] == detail::kFlatCtrlEmpty)) {
+			if (!grow())
+				return kNotFound;
+			index = findFree(hash);
+		}
+
+		if (ctrl_[index] == detail::kFlatCtrlEmpty)
+			growth_left_--;
+		new (&slots_[index]) Slot(hash, key, length, std::forward<U>(value));
+		setCtrl(index, int8_t(H2(hash)));
+		size_++;
+		return index;
+	}
+
+	void erase(size_t index)
+	{
+		slots_[index].~Slot();
+		size_--;
+
+		// If no window of kWidth slots around this one was ever entirely
+		// full, no probe can have passed over it, and it can go straight
+		// back to empty instead of leaving a tombstone.
+		size_t mask = capacity_ - 1;
+		uint64_t empty_after = Group(ctrl_ + index).MatchEmpty();
+		uint64_t empty_before = Group(ctrl_ + ((index - Group::kWidth) & mask)).MatchEmpty();
+		if (empty_after && empty_before &&
+		    Group::LowestByte(empty_after) + (Group::kWidth - 1 - Group::HighestByte(empty_before)) < Group::kWidth)
+		{
+			setCtrl(index, detail::kFlatCtrlEmpty);
+			growth_left_++;
+		} else {
+			setCtrl(index, detail::kFlatCtrlDeleted);
+		}
+	}
+
+	bool grow()
+	{
+		// Mostly tombstones: rebuild at the same size to reclaim them.
+		if (capacity_ && size_ < MaxLoad(capacity_) / 2)
+			return rehash(capacity_);
+		return rehash(capacity_ ? capacity_ * 2 : kMinCapacity);
+	}
+
+	bool rehash(size_t capacity)
+	{
+		int8_t *ctrl = (int8_t *)malloc(capacity + Group::kWidth - 1);
+		Slot *slots = (Slot *)malloc(capacity * sizeof(Slot));
+		if (!ctrl || !slots) {
+			free(ctrl);
+			free(slots);
+			return false;
+		}
+		memset(ctrl, detail::kFlatCtrlEmpty, capacity + Group::kWidth - 1);
+
+		int8_t *old_ctrl = ctrl_;
+		Slot *old_slots = slots_;
+		size_t old_capacity = capacity_;
+
+		ctrl_ = ctrl;
+		slots_ = slots;
+		capacity_ = capacity;
+		growth_left_ = MaxLoad(capacity) - size_;
+
+		for (size_t i = 0; i < old_capacity; i++) {
+			if (old_ctrl[i] < 0)
+				continue;
+			size_t index = findFree(old_slots[i].hash);
+			new (&slots_[index]) Slot(std::move(old_slots[i]));
+			old_slots[i].~Slot();
+			setCtrl(index, old_ctrl[i]);
+		}
+
+		free(old_ctrl);
+		free(old_slots);
+		return true;
+	}
+
+private:
+	int8_t *ctrl_;
+	Slot *slots_;
+	size_t capacity_;
+	size_t size_;
+	size_t growth_left_;
+};
+
+}
+
+#endif // _include_sourcemod_flatmap_h_
@@ -44,6 +44,7 @@
  * NameHashSet instead.
  */
 
+#include <ctype.h>
 #include <string.h>
 
 #include <utility>
@@ -62,7 +63,9 @@ namespace detail
 	 public:
 	  CharsAndLength(const char *str)
 		: str_(str),
-		  length_(0)
+		  length_(0),
+		  folded_hash_(0),
+		  has_folded_hash_(false)
 	  {
 		  int c;
 		  uint32_t hash = 0;
@@ -72,9 +75,34 @@ namespace detail
 		  length_ = str - str_ - 1;
 	  }
 
+	  // A key whose hashes were computed ahead of time, such as an interned
+	  // string (see sm_interned.h). |str| must outlive the lookup.
+	  CharsAndLength(const char *str, size_t length, uint32_t hash, uint32_t folded_hash)
+		: str_(str),
+		  length_(length),
+		  hash_(hash),
+		  folded_hash_(folded_hash),
+		  has_folded_hash_(true)
+	  {
+	  }
+
 	  uint32_t hash() const {
 		  return hash_;
 	  }
+	  // The same hash over the lowercased characters, for case-insensitive
+	  // policies.
+	  uint32_t foldedHash() const {
+		  if (has_folded_hash_)
+			  return folded_hash_;
+		  return FoldedHash(str_);
+	  }
+	  static uint32_t FoldedHash(const char *str) {
+		  int c;
+		  uint32_t hash = 0;
+		  while ((c = tolower((unsigned char)*str++)))
+			  hash = c + (hash << 6) + (hash << 16) - hash;
+		  return hash;
+	  }
 	  const char *c_str() const {
 		  return str_;
 	  }
@@ -86,6 +114,8 @@ namespace detail
 	  const char *str_;
 	  size_t length_;
 	  uint32_t hash_;
+	  uint32_t folded_hash_;
+	  bool has_folded_hash_;
 	};
 
 	struct StringHashMapPolicy
@@ -163,6 +193,27 @@ public:
 		return r.found();
 	}
 
+	// Lookups with a pre-hashed string key (string maps only).
+	bool retrieve(const detail::CharsAndLength &key, T *aResult = NULL)
+	{
+		Result r = internal_.find(key);
+		if (!r.found())
+			return false;
+		if (aResult)
+			*aResult = r->value;
+		return true;
+	}
+
+	Result find(const detail::CharsAndLength &key)
+	{
+		return internal_.find(key);
+	}
+
+	bool contains(const detail::CharsAndLength &key)
+	{
+		return internal_.find(key).found();
+	}
+
 	template <typename UV>
 	bool replace(const KeyLookupType &aKey, UV &&value)
 	{
@@ -0,0 +1,202 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#ifndef _include_sourcemod_interned_h_
+#define _include_sourcemod_interned_h_
+
+/**
+ * @file sm_interned.h
+ *
+ * @brief Interned strings: one stable copy of each distinct string, with a
+ * stable numeric ID and its lookup hashes computed once.
+ *
+ * Lookups that see the same names over and over (class names, netprop and
+ * datamap names, cvar names) can pass InternedString::key() to StringHashMap
+ * and NameHashSet instead of a plain string, which skips rehashing it.
+ * InternedSiteCache maps strings that live at a stable address, such as
+ * plugin string literals or engine-owned names, back to their interned form
+ * without hashing them at all.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "sm_namehashset.h"
+
+namespace SourceMod
+{
+
+class InternedString
+{
+public:
+	InternedString(uint32_t id, const char *str)
+	  : id_(id),
+	    str_(str)
+	{
+		detail::CharsAndLength key(str);
+		hash_ = key.hash();
+		folded_hash_ = detail::CharsAndLength::FoldedHash(str);
+	}
+
+	uint32_t id() const {
+		return id_;
+	}
+	const char *c_str() const {
+		return str_.c_str();
+	}
+	size_t length() const {
+		return str_.length();
+	}
+	uint32_t hash() const {
+		return hash_;
+	}
+	uint32_t foldedHash() const {
+		return folded_hash_;
+	}
+
+	// A pre-hashed lookup key, valid for as long as this string is.
+	detail::CharsAndLength key() const {
+		return detail::CharsAndLength(str_.c_str(), str_.length(), hash_, folded_hash_);
+	}
+
+	static inline bool matches(const char *key, const InternedString *str) {
+		return str->str_.compare(key) == 0;
+	}
+	static inline uint32_t hash(const detail::CharsAndLength &key) {
+		return key.hash();
+	}
+
+private:
+	uint32_t id_;
+	std::string str_;
+	uint32_t hash_;
+	uint32_t folded_hash_;
+};
+
+// Strings are never removed, so pointers and IDs stay valid for the life of
+// the interner. Only intern from bounded sets of names.
+class StringInterner
+{
+public:
+	const InternedString *Intern(const char *str)
+	{
+		NameHashSet<InternedString *>::Insert i = lookup_.findForAdd(str);
+		if (i.found())
+			return *i;
+
+		strings_.emplace_back(new InternedString(uint32_t(strings_.size()), str));
+		InternedString *interned = strings_.back().get();
+		lookup_.add(i, interned);
+		return interned;
+	}
+
+	const InternedString *Find(const char *str)
+	{
+		InternedString *interned;
+		if (!lookup_.retrieve(str, &interned))
+			return nullptr;
+		return interned;
+	}
+
+	const InternedString *Get(uint32_t id) const
+	{
+		if (id >= strings_.size())
+			return nullptr;
+		return strings_[id].get();
+	}
+
+	size_t size() const
+	{
+		return strings_.size();
+	}
+
+private:
+	NameHashSet<InternedString *> lookup_;
+	std::vector<std::unique_ptr<InternedString>> strings_;
+};
+
+// A small direct-mapped cache from string addresses to interned strings.
+// Entries are verified against the text at the address on every hit, so a
+// buffer that is reused for a different string simply misses.
+class InternedSiteCache
+{
+	static const size_t kSlots = 256;
+
+public:
+	InternedSiteCache()
+	{
+		Clear();
+	}
+
+	const InternedString *Find(const char *str) const
+	{
+		const Entry &entry = entries_[Slot(str)];
+		if (entry.site != str || !entry.interned)
+			return nullptr;
+		if (strcmp(str, entry.interned->c_str()) != 0)
+			return nullptr;
+		return entry.interned;
+	}
+
+	void Remember(const char *str, const InternedString *interned)
+	{
+		Entry &entry = entries_[Slot(str)];
+		entry.site = str;
+		entry.interned = interned;
+	}
+
+	void Clear()
+	{
+		memset(entries_, 0, sizeof(entries_));
+	}
+
+private:
+	static size_t Slot(const char *str)
+	{
+		uintptr_t addr = reinterpret_cast<uintptr_t>(str);
+		return ((addr >> 2) ^ (addr >> 10)) & (kSlots - 1);
+	}
+
+private:
+	struct Entry
+	{
+		const char *site;
+		const InternedString *interned;
+	};
+	Entry entries_[kSlots];
+};
+
+}
+
+#endif // _include_sourcemod_interned_h_
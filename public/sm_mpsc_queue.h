@@ -0,0 +1,141 @@
+/**
+ * vim: set ts=4 :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _INCLUDE_SM_MPSC_QUEUE_H
+#define _INCLUDE_SM_MPSC_QUEUE_H
+
+#include <new>
+#include <stddef.h>
+#include <atomic>
+#include <utility>
+
+/**
+ * @file sm_mpsc_queue.h
+ * @brief Lock-free multi-producer, single-consumer FIFO queue.
+ *
+ * Any number of threads may push() concurrently without taking a lock; only
+ * one thread at a time may pop(). Each push is one allocation and one atomic
+ * exchange. A pop can briefly miss an item whose producer has not finished
+ * linking it in yet; the item then shows up on the next pop, and no item is
+ * ever lost or reordered with respect to its own producer.
+ *
+ * This is the stub-node queue design by Dmitry Vyukov.
+ */
+
+namespace SourceMod
+{
+	template <typename T>
+	class MpscQueue
+	{
+		struct Node
+		{
+			Node() : next(nullptr)
+			{
+			}
+			T *value()
+			{
+				return reinterpret_cast<T *>(storage);
+			}
+			std::atomic<Node *> next;
+			alignas(T) unsigned char storage[sizeof(T)];
+		};
+	public:
+		MpscQueue() : m_Head(&m_Stub), m_Tail(&m_Stub)
+		{
+		}
+		~MpscQueue()
+		{
+			Node *node = m_Tail->next.load(std::memory_order_acquire);
+			while (node)
+			{
+				Node *next = node->next.load(std::memory_order_acquire);
+				node->value()->~T();
+				delete node;
+				node = next;
+			}
+			if (m_Tail != &m_Stub)
+				delete m_Tail;
+		}
+		MpscQueue(const MpscQueue &) = delete;
+		MpscQueue &operator =(const MpscQueue &) = delete;
+	public:
+		/**
+		 * @brief Appends an item. Safe to call from any thread.
+		 */
+		template <typename U>
+		void push(U &&item)
+		{
+			Node *node = new Node();
+			new (node->storage) T(std::forward<U>(item));
+
+			Node *prev = m_Head.exchange(node, std::memory_order_acq_rel);
+			prev->next.store(node, std::memory_order_release);
+		}
+
+		/**
+		 * @brief Removes the oldest item. Consumer thread only.
+		 *
+		 * @param out		Receives the item.
+		 * @return			True if an item was removed, false if the queue
+		 *					was empty (or a push had not completed yet).
+		 */
+		bool pop(T *out)
+		{
+			Node *tail = m_Tail;
+			Node *next = tail->next.load(std::memory_order_acquire);
+			if (!next)
+				return false;
+
+			// |next| becomes the new stub; its value is moved out and destroyed.
+			*out = std::move(*next->value());
+			next->value()->~T();
+			m_Tail = next;
+			if (tail != &m_Stub)
+				delete tail;
+			return true;
+		}
+
+		/**
+		 * @brief Returns whether the queue looks empty. This may race with
+		 * producers, so treat it only as a hint.
+		 */
+		bool empty() const
+		{
+			return m_Tail->next.load(std::memory_order_acquire) == nullptr;
+		}
+	private:
+		std::atomic<Node *> m_Head;
+		Node *m_Tail;
+		Node m_Stub;
+	};
+}
+
+#endif //_INCLUDE_SM_MPSC_QUEUE_H
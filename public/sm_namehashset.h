@@ -137,6 +137,26 @@ public:
 		return true;
 	}
 
+	// Lookups with a pre-hashed key, e.g. from InternedString::key().
+	Result find(const CharsAndLength &key)
+	{
+		return table_.find(key);
+	}
+
+	bool retrieve(const CharsAndLength &key, T *value)
+	{
+		Result r = table_.find(key);
+		if (!r.found())
+			return false;
+		*value = *r;
+		return true;
+	}
+
+	bool contains(const CharsAndLength &key)
+	{
+		return table_.find(key).found();
+	}
+
 	template <typename U>
 	bool insert(const char *aKey, U &&value)
 	{
@@ -0,0 +1,172 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+#ifndef _include_sourcemod_stmtcache_h_
+#define _include_sourcemod_stmtcache_h_
+
+/**
+ * @file sm_stmtcache.h
+ *
+ * @brief LRU cache of idle prepared statements, shared by the SQL drivers.
+ */
+
+#include <stddef.h>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <IDBDriver.h>
+
+namespace SourceMod
+{
+	/**
+	 * Holds statements which are not in use, keyed on their query text.  Only 
+	 * one idle statement is kept per query; a surplus one is finalized.  The 
+	 * cache is thread safe.
+	 *
+	 * T is the driver's native statement handle, and Finalizer is called on 
+	 * any statement leaving the cache for good.
+	 */
+	template <typename T, void (*Finalizer)(T)>
+	class StatementCache
+	{
+	public:
+		static const size_t kDefaultCapacity = 32;
+	public:
+		StatementCache() : capacity_(kDefaultCapacity), hits_(0), misses_(0), evictions_(0)
+		{
+		}
+		~StatementCache()
+		{
+			Clear();
+		}
+	public:
+		/**
+		 * Removes and returns the idle statement for a query, if there is one.
+		 */
+		bool Take(const char *query, size_t length, T *stmt)
+		{
+			std::lock_guard<std::mutex> lock(lock_);
+			auto iter = index_.find(std::string_view(query, length));
+			if (iter == index_.end())
+			{
+				misses_++;
+				return false;
+			}
+
+			typename EntryList::iterator entry = iter->second;
+			*stmt = entry->stmt;
+			index_.erase(iter);
+			lru_.erase(entry);
+			hits_++;
+			return true;
+		}
+
+		/**
+		 * Stores a statement that has been reset and is no longer in use.
+		 */
+		void Give(const char *query, size_t length, T stmt)
+		{
+			std::unique_lock<std::mutex> lock(lock_);
+			if (!capacity_ || index_.find(std::string_view(query, length)) != index_.end())
+			{
+				lock.unlock();
+				Finalizer(stmt);
+				return;
+			}
+
+			lru_.emplace_front(std::string(query, length), stmt);
+			index_.emplace(std::string_view(lru_.front().query), lru_.begin());
+
+			if (lru_.size() <= capacity_)
+			{
+				return;
+			}
+
+			Entry &oldest = lru_.back();
+			T evicted = oldest.stmt;
+			index_.erase(std::string_view(oldest.query));
+			lru_.pop_back();
+			evictions_++;
+			lock.unlock();
+
+			Finalizer(evicted);
+		}
+
+		/**
+		 * Finalizes every idle statement.
+		 */
+		void Clear()
+		{
+			EntryList list;
+			{
+				std::lock_guard<std::mutex> lock(lock_);
+				index_.clear();
+				list.swap(lru_);
+			}
+			for (auto iter = list.begin(); iter != list.end(); iter++)
+			{
+				Finalizer(iter->stmt);
+			}
+		}
+
+		void GetStats(DBStatementCacheStats *stats)
+		{
+			std::lock_guard<std::mutex> lock(lock_);
+			stats->cached = (unsigned int)lru_.size();
+			stats->capacity = (unsigned int)capacity_;
+			stats->hits = hits_;
+			stats->misses = misses_;
+			stats->evictions = evictions_;
+		}
+	private:
+		struct Entry
+		{
+			Entry(std::string &&query, T stmt) : query(std::move(query)), stmt(stmt)
+			{
+			}
+			std::string query;
+			T stmt;
+		};
+		typedef std::list<Entry> EntryList;
+
+		EntryList lru_;
+		std::unordered_map<std::string_view, typename EntryList::iterator> index_;
+		std::mutex lock_;
+		size_t capacity_;
+		unsigned int hits_;
+		unsigned int misses_;
+		unsigned int evictions_;
+	};
+}
+
+#endif //_include_sourcemod_stmtcache_h_
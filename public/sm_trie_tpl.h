@@ -48,8 +48,8 @@ enum NodeType
  * @brief DEPRECATED. This class scales extremely poorly; insertion scales
  * quadratic (O(n^2)) with respect to the number of elements in the table.
  * Only use this class if you have less than 200 elements or so. Otherwise,
- * use StringHashMap in sm_stringhashmap.h which scales linearly and has comparable
- * retrievable performance.
+ * use StringFlatMap in sm_flatmap.h (same API) or StringHashMap in sm_hashmap.h,
+ * which scale linearly and have comparable retrievable performance.
  *
  * See bug 5878 for more detail.
  *
@@ -74,6 +74,9 @@ ITimerSystem *timersys = NULL;
 #if defined SMEXT_ENABLE_ADTFACTORY
 IADTFactory *adtfactory = NULL;
 #endif
+#if defined SMEXT_ENABLE_FRAMESCHEDULER
+IFrameScheduler *framescheduler = NULL;
+#endif
 #if defined SMEXT_ENABLE_THREADER
 IThreader *threader = NULL;
 #endif
@@ -165,6 +168,9 @@ bool SDKExtension::OnExtensionLoad(IExtension *me, IShareSys *sys, char *error,
 #if defined SMEXT_ENABLE_ADTFACTORY
 	SM_GET_IFACE(ADTFACTORY, adtfactory);
 #endif
+#if defined SMEXT_ENABLE_FRAMESCHEDULER
+	SM_GET_IFACE(FRAMESCHEDULER, framescheduler);
+#endif
 #if defined SMEXT_ENABLE_THREADER
 	SM_GET_IFACE(THREADER, threader);
 #endif
@@ -213,6 +219,15 @@ bool SDKExtension::IsMetamodExtension()
 #endif
 }
 
+bool SDKExtension::IsLazyLoadable()
+{
+#if defined SMEXT_CONF_LAZY
+	return true;
+#else
+	return false;
+#endif
+}
+
 void SDKExtension::OnExtensionPauseChange(bool state)
 {
 #if defined SMEXT_CONF_METAMOD
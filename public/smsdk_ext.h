@@ -68,6 +68,9 @@
 #if defined SMEXT_ENABLE_ADTFACTORY
 #include <IADTFactory.h>
 #endif
+#if defined SMEXT_ENABLE_FRAMESCHEDULER
+#include <IFrameScheduler.h>
+#endif
 #if defined SMEXT_ENABLE_THREADER
 #include <IThreader.h>
 #endif
@@ -225,6 +228,9 @@ public: //IExtensionInterface
 
 	/** Called after OnExtensionUnload, once dependencies have been dropped. */
 	virtual void OnDependenciesDropped();
+
+	/** Returns whether Core may defer loading until a native is called */
+	virtual bool IsLazyLoadable();
 #if defined SMEXT_CONF_METAMOD
 public: //ISmmPlugin
 	/** Called when the extension is attached to Metamod. */
@@ -296,6 +302,9 @@ extern ITimerSystem *timersys;
 #if defined SMEXT_ENABLE_ADTFACTORY
 extern IADTFactory *adtfactory;
 #endif
+#if defined SMEXT_ENABLE_FRAMESCHEDULER
+extern IFrameScheduler *framescheduler;
+#endif
 #if defined SMEXT_ENABLE_THREADER
 extern IThreader *threader;
 #endif
@@ -0,0 +1,97 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#ifndef _INCLUDE_SOURCEMOD_BENCHMARKS_H_
+#define _INCLUDE_SOURCEMOD_BENCHMARKS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Out-of-game benchmarks for the data structures in public/ and core/logic/.
+ * Every case performs a fixed number of operations from a deterministic
+ * workload, so runs on different builds are directly comparable.
+ */
+
+typedef void (*BenchFunc)(size_t ops);
+
+struct BenchCase
+{
+	const char *name;
+	BenchFunc func;
+	size_t ops;
+};
+
+enum BenchOp
+{
+	BenchOp_FindHit,
+	BenchOp_FindMiss,
+	BenchOp_Insert,
+	BenchOp_Erase,
+};
+
+struct BenchStep
+{
+	BenchOp op;
+	uint32_t key;
+};
+
+/**
+ * Shared workload: a key set derived from real command and cvar names, and
+ * an operation mix of 60% hits, 20% misses, 10% inserts and 10% erases over
+ * a skewed key distribution (a few hot names, a long tail).
+ *
+ * Keys [0, kPresentKeys) are inserted before a case starts; keys
+ * [kPresentKeys, keys.size()) are only ever looked up as misses or inserted
+ * by the mix.
+ */
+struct BenchWorkload
+{
+	static const size_t kPresentKeys = 2048;
+	static const size_t kTotalKeys = 4096;
+	static const size_t kSteps = 65536;
+
+	std::vector<std::string> keys;
+	std::vector<BenchStep> steps;
+};
+
+extern BenchWorkload g_Workload;
+
+/* Written by cases so the compiler cannot drop the work being measured. */
+extern volatile size_t g_BenchSink;
+
+void BuildWorkload(BenchWorkload &workload);
+void AddStructureBenchmarks(std::vector<BenchCase> &cases);
+
+#endif //_INCLUDE_SOURCEMOD_BENCHMARKS_H_
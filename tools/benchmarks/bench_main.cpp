@@ -0,0 +1,308 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+#include "bench.h"
+
+BenchWorkload g_Workload;
+volatile size_t g_BenchSink = 0;
+
+/* Command and cvar names seen on real servers: core, the bundled plugins and
+ * the engine. Variants with plugin-style suffixes are derived from these to
+ * fill out the key set.
+ */
+static const char *kBaseNames[] =
+{
+	"sm", "sm_admin", "sm_ban", "sm_unban", "sm_kick", "sm_slay", "sm_slap",
+	"sm_map", "sm_rcon", "sm_cvar", "sm_execcfg", "sm_who", "sm_reloadadmins",
+	"sm_say", "sm_csay", "sm_hsay", "sm_tsay", "sm_chat", "sm_psay", "sm_msay",
+	"sm_vote", "sm_votemap", "sm_votekick", "sm_voteban", "sm_cancelvote",
+	"sm_mute", "sm_unmute", "sm_gag", "sm_ungag", "sm_silence", "sm_unsilence",
+	"sm_beacon", "sm_burn", "sm_freeze", "sm_timebomb", "sm_firebomb",
+	"sm_noclip", "sm_rename", "sm_play", "sm_nextmap", "sm_timeleft",
+	"sm_help", "sm_searchcmd", "sm_settings", "sm_cookies", "sm_rtv",
+	"sm_nominate", "sm_addban", "sm_banip", "sm_abortgame", "sm_resetscore",
+	"sm_show_activity", "sm_flood_time", "sm_reserve_type", "sm_reserved_slots",
+	"sm_hide_slots", "sm_vote_delay", "sm_trigger_show", "sm_timeleft_interval",
+	"sm_chat_mode", "sm_deadtalk", "sm_immunity_mode", "sm_menu_sounds",
+	"sm_datetime_format", "sm_nextmap_show", "sm_mapvote_start",
+	"sm_rtv_needed", "sm_rtv_minplayers", "sm_basecomm_persist",
+	"mp_timelimit", "mp_maxrounds", "mp_winlimit", "mp_fraglimit",
+	"mp_friendlyfire", "mp_roundtime", "mp_freezetime", "mp_startmoney",
+	"mp_autoteambalance", "mp_limitteams", "mp_restartgame", "mp_c4timer",
+	"mp_buytime", "mp_forcecamera", "mp_chattime", "mp_flashlight",
+	"mp_footsteps", "mp_allowspectators", "mp_tournament", "mp_teams_unbalance_limit",
+	"sv_cheats", "sv_gravity", "sv_airaccelerate", "sv_accelerate",
+	"sv_maxspeed", "sv_friction", "sv_stopspeed", "sv_alltalk", "sv_lan",
+	"sv_password", "sv_region", "sv_tags", "sv_visiblemaxplayers",
+	"sv_maxrate", "sv_minrate", "sv_maxupdaterate", "sv_minupdaterate",
+	"sv_maxcmdrate", "sv_mincmdrate", "sv_downloadurl", "sv_allowdownload",
+	"sv_allowupload", "sv_pure", "sv_hibernate_when_empty", "sv_voiceenable",
+	"hostname", "rcon_password", "maxplayers", "map", "changelevel",
+	"status", "say", "say_team", "kill", "explode", "jointeam", "joinclass",
+	"spectate", "buy", "buyammo1", "buyammo2", "drop", "use", "voicemenu",
+	"exec", "echo", "alias", "bind", "unbind", "cvarlist", "find",
+	"host_framerate", "host_timescale", "fps_max", "net_graph", "tv_enable",
+	"tv_name", "tv_delay", "tv_record", "tv_stoprecord", "log", "logaddress_add",
+	"meta", "meta_version", "metamod_version", "sourcemod_version",
+};
+
+static void BuildKeys(std::vector<std::string> &keys, size_t count)
+{
+	static const char *kSuffixes[] = { "", "_enabled", "_time", "_mode", "_2", "_admin", "_max", "_min" };
+	const size_t base = sizeof(kBaseNames) / sizeof(kBaseNames[0]);
+	const size_t suffixes = sizeof(kSuffixes) / sizeof(kSuffixes[0]);
+
+	keys.clear();
+	for (size_t i = 0; keys.size() < count; i++)
+	{
+		std::string key = kBaseNames[i % base];
+		key += kSuffixes[(i / base) % suffixes];
+		if (i >= base * suffixes)
+		{
+			char num[16];
+			snprintf(num, sizeof(num), "_%u", (unsigned)(i / (base * suffixes)));
+			key += num;
+		}
+		keys.push_back(key);
+	}
+
+	/* Interleave so the present and absent halves share name shapes. */
+	uint32_t state = 0x5eed1234;
+	for (size_t i = keys.size() - 1; i > 0; i--)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		std::swap(keys[i], keys[state % (i + 1)]);
+	}
+}
+
+void BuildWorkload(BenchWorkload &workload)
+{
+	BuildKeys(workload.keys, BenchWorkload::kTotalKeys);
+
+	uint32_t state = 0x2545f491;
+	auto next = [&state]() -> uint32_t {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	};
+
+	/* Squaring a uniform pick skews towards low indices: a handful of hot
+	 * names take most of the traffic, as with chat triggers and common cvars.
+	 */
+	auto skewed = [&next](size_t range) -> uint32_t {
+		uint64_t r = next() % range;
+		return (uint32_t)((r * r) / range);
+	};
+
+	workload.steps.resize(BenchWorkload::kSteps);
+	for (size_t i = 0; i < workload.steps.size(); i++)
+	{
+		BenchStep &step = workload.steps[i];
+		uint32_t roll = next() % 10;
+		if (roll < 6)
+		{
+			step.op = BenchOp_FindHit;
+			step.key = skewed(BenchWorkload::kPresentKeys);
+		}
+		else if (roll < 8)
+		{
+			step.op = BenchOp_FindMiss;
+			step.key = BenchWorkload::kPresentKeys + skewed(BenchWorkload::kTotalKeys - BenchWorkload::kPresentKeys);
+		}
+		else if (roll < 9)
+		{
+			step.op = BenchOp_Insert;
+			step.key = next() % BenchWorkload::kTotalKeys;
+		}
+		else
+		{
+			step.op = BenchOp_Erase;
+			step.key = next() % BenchWorkload::kTotalKeys;
+		}
+	}
+}
+
+struct BenchResult
+{
+	const char *name;
+	size_t ops;
+	double total;
+	double best;
+	double worst;
+};
+
+static double RunRound(const BenchCase &bench, size_t ops)
+{
+	auto start = std::chrono::steady_clock::now();
+	bench.func(ops);
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(end - start).count();
+}
+
+static void WriteXml(const char *path, const std::vector<BenchResult> &results)
+{
+	FILE *fp = fopen(path, "wt");
+	if (!fp)
+	{
+		fprintf(stderr, "Could not open \"%s\" for writing\n", path);
+		return;
+	}
+
+	/* Same layout as the in-game profiler reports; times are in seconds. */
+	fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+	fprintf(fp, "<profile time=\"%d\" uptime=\"0\">\n", (int)time(NULL));
+	fprintf(fp, " <report name=\"native\">\n");
+	for (const BenchResult &result : results)
+	{
+		fprintf(fp, "  <item name=\"%s\" numcalls=\"%u\" mintime=\"%.12f\" maxtime=\"%.12f\" totaltime=\"%.9f\"/>\n",
+			result.name,
+			(unsigned)result.ops,
+			result.best,
+			result.worst,
+			result.total);
+	}
+	fprintf(fp, " </report>\n");
+	fprintf(fp, "</profile>\n");
+	fclose(fp);
+}
+
+static void Usage(const char *self)
+{
+	fprintf(stderr, "Usage: %s [--filter <text>] [--scale <n>] [--rounds <n>] [--xml <file>] [--list]\n", self);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *filter = NULL;
+	const char *xml = NULL;
+	size_t scale = 1;
+	size_t rounds = 10;
+	bool list = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+		{
+			filter = argv[++i];
+		}
+		else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc)
+		{
+			scale = std::max(1, atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc)
+		{
+			rounds = std::max(1, atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--xml") == 0 && i + 1 < argc)
+		{
+			xml = argv[++i];
+		}
+		else if (strcmp(argv[i], "--list") == 0)
+		{
+			list = true;
+		}
+		else
+		{
+			Usage(argv[0]);
+			return 1;
+		}
+	}
+
+	std::vector<BenchCase> cases;
+	AddStructureBenchmarks(cases);
+
+	if (list)
+	{
+		for (const BenchCase &bench : cases)
+		{
+			printf("%s\n", bench.name);
+		}
+		return 0;
+	}
+
+	BuildWorkload(g_Workload);
+
+	std::vector<BenchResult> results;
+	printf("%-32s %10s %10s %10s %10s\n", "case", "ops", "ns/op", "best", "worst");
+	for (const BenchCase &bench : cases)
+	{
+		if (filter && !strstr(bench.name, filter))
+		{
+			continue;
+		}
+
+		size_t ops = bench.ops * scale;
+
+		/* Warm the allocator and caches before timing anything. */
+		RunRound(bench, ops / 10 + 1);
+
+		BenchResult result = { bench.name, ops * rounds, 0.0, 0.0, 0.0 };
+		for (size_t i = 0; i < rounds; i++)
+		{
+			double elapsed = RunRound(bench, ops);
+			double per_op = elapsed / ops;
+			result.total += elapsed;
+			if (i == 0 || per_op < result.best)
+			{
+				result.best = per_op;
+			}
+			if (i == 0 || per_op > result.worst)
+			{
+				result.worst = per_op;
+			}
+		}
+		results.push_back(result);
+
+		printf("%-32s %10u %10.1f %10.1f %10.1f\n",
+			result.name,
+			(unsigned)result.ops,
+			result.total / result.ops * 1e9,
+			result.best * 1e9,
+			result.worst * 1e9);
+	}
+
+	if (xml)
+	{
+		WriteXml(xml, results);
+	}
+
+	return 0;
+}
@@ -0,0 +1,337 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+#include <string.h>
+#include <sm_flatmap.h>
+#include <sm_hashmap.h>
+#include <sm_namehashset.h>
+#include <sm_trie_tpl.h>
+#include "CDataPack.h"
+#include "CellArray.h"
+#include "sm_simple_prioqueue.h"
+#include "bench.h"
+
+static const size_t kArrayRows = 4096;
+
+/**
+ * Runs |ops| steps of the shared workload against one container. The
+ * containers persist across rounds; inserts and erases are drawn from the
+ * same key range at the same rate, so occupancy stays near half.
+ */
+template <typename Find, typename Insert, typename Erase>
+static void RunSteps(size_t ops, Find find, Insert insert, Erase erase)
+{
+	const std::vector<BenchStep> &steps = g_Workload.steps;
+	const std::vector<std::string> &keys = g_Workload.keys;
+	size_t hits = 0;
+
+	for (size_t i = 0; i < ops; i++)
+	{
+		const BenchStep &step = steps[i % steps.size()];
+		const char *key = keys[step.key].c_str();
+
+		switch (step.op)
+		{
+		case BenchOp_FindHit:
+		case BenchOp_FindMiss:
+			if (find(key))
+			{
+				hits++;
+			}
+			break;
+		case BenchOp_Insert:
+			insert(key, step.key);
+			break;
+		case BenchOp_Erase:
+			erase(key);
+			break;
+		}
+	}
+
+	g_BenchSink += hits;
+}
+
+template <typename Insert>
+static void Populate(Insert insert)
+{
+	for (uint32_t i = 0; i < BenchWorkload::kPresentKeys; i++)
+	{
+		insert(g_Workload.keys[i].c_str(), i);
+	}
+}
+
+static void Bench_StringHashMap(size_t ops)
+{
+	static StringHashMap<uint32_t> *map = nullptr;
+	if (!map)
+	{
+		map = new StringHashMap<uint32_t>();
+		Populate([](const char *key, uint32_t value) { map->insert(key, value); });
+	}
+
+	RunSteps(ops,
+		[](const char *key) { uint32_t value; return map->retrieve(key, &value); },
+		[](const char *key, uint32_t value) { map->insert(key, value); },
+		[](const char *key) { map->remove(key); });
+}
+
+static void Bench_StringFlatMap(size_t ops)
+{
+	static StringFlatMap<uint32_t> *map = nullptr;
+	if (!map)
+	{
+		map = new StringFlatMap<uint32_t>();
+		Populate([](const char *key, uint32_t value) { map->insert(key, value); });
+	}
+
+	RunSteps(ops,
+		[](const char *key) { uint32_t value; return map->retrieve(key, &value); },
+		[](const char *key, uint32_t value) { map->insert(key, value); },
+		[](const char *key) { map->remove(key); });
+}
+
+struct BenchEntry
+{
+	std::string name;
+	uint32_t value;
+
+	static inline bool matches(const char *key, const BenchEntry *entry)
+	{
+		return entry->name.compare(key) == 0;
+	}
+	static inline uint32_t hash(const detail::CharsAndLength &key)
+	{
+		return key.hash();
+	}
+};
+
+static void Bench_NameHashSet(size_t ops)
+{
+	/* Entries outlive their set membership, as plugins and types do. */
+	static std::vector<BenchEntry> entries;
+	static NameHashSet<BenchEntry *> *set = nullptr;
+	if (!set)
+	{
+		entries.resize(BenchWorkload::kTotalKeys);
+		for (uint32_t i = 0; i < entries.size(); i++)
+		{
+			entries[i].name = g_Workload.keys[i];
+			entries[i].value = i;
+		}
+
+		set = new NameHashSet<BenchEntry *>();
+		Populate([](const char *key, uint32_t value) { set->insert(key, &entries[value]); });
+	}
+
+	RunSteps(ops,
+		[](const char *key) { BenchEntry *entry; return set->retrieve(key, &entry); },
+		[](const char *key, uint32_t value) { set->insert(key, &entries[value]); },
+		[](const char *key) { set->remove(key); });
+}
+
+static void Bench_KTrie(size_t ops)
+{
+	static KTrie<uint32_t> *trie = nullptr;
+	if (!trie)
+	{
+		trie = new KTrie<uint32_t>();
+		Populate([](const char *key, uint32_t value) { trie->insert(key, value); });
+	}
+
+	RunSteps(ops,
+		[](const char *key) { uint32_t value; return trie->retrieve(key, &value); },
+		[](const char *key, uint32_t value) { trie->insert(key, value); },
+		[](const char *key) { trie->remove(key); });
+}
+
+static void Bench_CellArrayPushAt(size_t ops)
+{
+	CellArray array(1);
+	cell_t sum = 0;
+
+	for (size_t i = 0; i < ops; i++)
+	{
+		*array.push() = (cell_t)i;
+		sum += *array.at(g_Workload.steps[i % g_Workload.steps.size()].key % array.size());
+	}
+
+	g_BenchSink += (size_t)sum;
+}
+
+static void FillArray(CellArray &array)
+{
+	for (size_t i = 0; i < kArrayRows; i++)
+	{
+		*array.push() = (cell_t)i;
+	}
+}
+
+static void Bench_CellArrayErase(size_t ops)
+{
+	CellArray array(1);
+	FillArray(array);
+
+	/* Erase from a random row and push back to keep the size stable. */
+	for (size_t i = 0; i < ops; i++)
+	{
+		array.remove(g_Workload.steps[i % g_Workload.steps.size()].key % array.size());
+		*array.push() = (cell_t)i;
+	}
+
+	g_BenchSink += array.size();
+}
+
+static void Bench_CellArrayFindLinear(size_t ops)
+{
+	static CellArray *array = nullptr;
+	if (!array)
+	{
+		array = new CellArray(1);
+		FillArray(*array);
+	}
+
+	size_t found = 0;
+	for (size_t i = 0; i < ops; i++)
+	{
+		cell_t value = (cell_t)(g_Workload.steps[i % g_Workload.steps.size()].key % (kArrayRows * 2));
+		for (size_t row = 0; row < array->size(); row++)
+		{
+			if (*array->at(row) == value)
+			{
+				found++;
+				break;
+			}
+		}
+	}
+
+	g_BenchSink += found;
+}
+
+static void Bench_CellArrayFindIndexed(size_t ops)
+{
+	static CellArray *array = nullptr;
+	if (!array)
+	{
+		array = new CellArray(1);
+		FillArray(*array);
+		array->SetIndex(0, false);
+	}
+
+	size_t found = 0;
+	for (size_t i = 0; i < ops; i++)
+	{
+		cell_t value = (cell_t)(g_Workload.steps[i % g_Workload.steps.size()].key % (kArrayRows * 2));
+		if (array->IndexFind(CellArray::IndexKey(value), -1, false) != -1)
+		{
+			found++;
+		}
+	}
+
+	g_BenchSink += found;
+}
+
+static void Bench_DataPackWriteRead(size_t ops)
+{
+	CDataPack *pack = CDataPack::New();
+	size_t total = 0;
+
+	for (size_t i = 0; i < ops; i++)
+	{
+		const BenchStep &step = g_Workload.steps[i % g_Workload.steps.size()];
+
+		pack->ResetSize();
+		pack->PackCell((cell_t)i);
+		pack->PackFloat(1.5f);
+		pack->PackString(g_Workload.keys[step.key].c_str());
+		pack->PackCell((cell_t)step.key);
+
+		pack->Reset();
+		total += pack->ReadCell();
+		total += (size_t)pack->ReadFloat();
+		pack->ReadString(NULL);
+		total += pack->ReadCell();
+	}
+
+	CDataPack::Free(pack);
+	g_BenchSink += total;
+}
+
+static void Bench_DataPackNewFree(size_t ops)
+{
+	for (size_t i = 0; i < ops; i++)
+	{
+		CDataPack *pack = CDataPack::New();
+		pack->PackCell((cell_t)i);
+		CDataPack::Free(pack);
+	}
+}
+
+static void Bench_PrioQueue(size_t ops)
+{
+	PrioQueue<uint32_t> queue;
+	size_t total = 0;
+
+	/* Two pushes for every pop, then drain, like a burst of queued queries. */
+	for (size_t i = 0; i < ops; i++)
+	{
+		const BenchStep &step = g_Workload.steps[i % g_Workload.steps.size()];
+		queue.GetQueue((PrioQueueLevel)(step.key % 3)).push(step.key);
+		if (i & 1)
+		{
+			Queue<uint32_t> &next = queue.GetLikelyQueue();
+			total += next.first();
+			next.pop();
+		}
+	}
+
+	while (!queue.GetLikelyQueue().empty())
+	{
+		queue.GetLikelyQueue().pop();
+	}
+
+	g_BenchSink += total;
+}
+
+void AddStructureBenchmarks(std::vector<BenchCase> &cases)
+{
+	cases.push_back({ "hashmap.string.mix", Bench_StringHashMap, 200000 });
+	cases.push_back({ "flatmap.string.mix", Bench_StringFlatMap, 200000 });
+	cases.push_back({ "namehashset.mix", Bench_NameHashSet, 200000 });
+	cases.push_back({ "ktrie.mix", Bench_KTrie, 200000 });
+	cases.push_back({ "cellarray.push_at", Bench_CellArrayPushAt, 200000 });
+	cases.push_back({ "cellarray.erase", Bench_CellArrayErase, 20000 });
+	cases.push_back({ "cellarray.find_linear", Bench_CellArrayFindLinear, 2000 });
+	cases.push_back({ "cellarray.find_indexed", Bench_CellArrayFindIndexed, 200000 });
+	cases.push_back({ "datapack.write_read", Bench_DataPackWriteRead, 100000 });
+	cases.push_back({ "datapack.new_free", Bench_DataPackNewFree, 100000 });
+	cases.push_back({ "prioqueue.push_pop", Bench_PrioQueue, 100000 });
+}
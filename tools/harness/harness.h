@@ -0,0 +1,162 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+
+#ifndef _INCLUDE_SOURCEMOD_HARNESS_H_
+#define _INCLUDE_SOURCEMOD_HARNESS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sp_vm_api.h>
+#include <IForwardSys.h>
+#include <IHandleSys.h>
+#include <IPlayerHelpers.h>
+#include <IRootConsoleMenu.h>
+#include <ISourceMod.h>
+#include <bridge/include/BridgeAPI.h>
+
+using namespace SourceMod;
+using namespace SourcePawn;
+
+/**
+ * Headless host for sourcemod.logic. The harness stands in for core: it
+ * implements CoreProvider against a simulated server (clock, timers, clients,
+ * game events, convars and commands), loads the plugins in <sm>/plugins, and
+ * replays a recorded stream of server activity into them. Time spent in each
+ * plugin, and the memory it allocates, are reported at the end of the run.
+ */
+
+extern sm_logic_t logicore;
+
+/* Simulated server clock. */
+struct HarnessClock
+{
+	double now;
+	float interval;
+	float frametime;
+	int tick;
+};
+
+extern HarnessClock g_Clock;
+
+/* A console command line, split the way the engine splits it. */
+class HarnessArgs : public ICommandArgs
+{
+public:
+	explicit HarnessArgs(const char *line);
+
+	const char *Arg(int n) const override;
+	int ArgC() const override;
+	const char *ArgS() const override;
+
+private:
+	std::vector<std::string> args_;
+	std::string argstring_;
+};
+
+/* mock_core.cpp */
+bool LoadLogic(const char *sm_path, const char *game, char *error, size_t maxlength);
+void ShutdownLogic();
+void SetCoreConfigValue(const char *key, const char *value);
+bool ParseCoreConfig();
+void StartMap(const char *map);
+void EndMap();
+void RunFrame();
+bool RunServerCommand(const char *line);
+const char *CurrentMap();
+bool IsMapRunning();
+ISourceMod *GetHarnessSourceMod();
+
+/* mock_players.cpp */
+struct HarnessUserCmd
+{
+	int buttons;
+	int impulse;
+	float vel[3];
+	float angles[3];
+	int weapon;
+	int subtype;
+	int cmdnum;
+	int seed;
+	int mouse[2];
+};
+
+bool ConnectClient(int client, int userid, const char *name, const char *auth, bool fake);
+void DisconnectClient(int client);
+void DisconnectAllClients();
+void SetClientTeam(int client, int team);
+void SetClientAlive(int client, bool alive);
+bool IsClientIndexConnected(int client);
+bool IsClientIndexAlive(int client);
+int ClientOfUserId(int userid);
+void NotifyServerActivated();
+void SetMaxClients(int maxClients);
+IPlayerManager *GetPlayerManager();
+IGameHelpers *GetGameHelpers();
+IPlayerInfoBridge *GetPlayerInfoBridge();
+int HarnessMaxClients();
+const int *HarnessMaxClientsPtr();
+const char *ClientName(int client);
+
+/* harness_natives.cpp */
+void RegisterHarnessNatives();
+void CreateHarnessForwards();
+void ReleaseHarnessForwards();
+void OnHarnessMapStart();
+void OnHarnessMapEnd();
+void OnHarnessConfigsExecuted();
+void OnHarnessGameFrame();
+void OnHarnessClientConnected(int client);
+void OnHarnessClientPutInServer(int client);
+void OnHarnessClientDisconnect(int client);
+void OnHarnessClientDisconnected(int client);
+void OnHarnessClientAuthorized(int client, const char *auth);
+void OnHarnessClientPostAdminCheck(int client);
+void RunUserCmd(int client, const HarnessUserCmd &cmd);
+bool FireGameEvent(const char *name, const std::vector<std::pair<std::string, std::string>> &keys);
+bool RunClientCommand(int client, const char *line);
+bool SetConVarValue(const char *name, const char *value);
+
+/* profiler.cpp */
+void RegisterHarnessProfiler();
+void StartHarnessProfiler();
+void RefreshPluginOwners();
+void WriteUsageReport(FILE *fp, bool json, double wall_ms);
+
+/* replay.cpp */
+bool RunReplay(const char *path, unsigned int iterations);
+
+#endif //_INCLUDE_SOURCEMOD_HARNESS_H_
@@ -0,0 +1,132 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include "harness.h"
+
+static void Usage(const char *self)
+{
+	fprintf(stderr, "Usage: %s --sm-path <dir> [--game <folder>] [-c <key>=<value>] [--iterations <n>] [--json <file>] <stream>\n", self);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *sm_path = NULL;
+	const char *game = "mock";
+	const char *json = NULL;
+	const char *stream = NULL;
+	unsigned int iterations = 1;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--sm-path") == 0 && i + 1 < argc)
+		{
+			sm_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--game") == 0 && i + 1 < argc)
+		{
+			game = argv[++i];
+		}
+		else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+		{
+			std::string option = argv[++i];
+			size_t eq = option.find('=');
+			if (eq == std::string::npos || eq == 0)
+			{
+				Usage(argv[0]);
+				return 1;
+			}
+			SetCoreConfigValue(option.substr(0, eq).c_str(), option.substr(eq + 1).c_str());
+		}
+		else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+		{
+			iterations = std::max(1, atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+		{
+			json = argv[++i];
+		}
+		else if (argv[i][0] != '-' && !stream)
+		{
+			stream = argv[i];
+		}
+		else
+		{
+			Usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (!sm_path || !stream)
+	{
+		Usage(argv[0]);
+		return 1;
+	}
+
+	char error[255];
+	if (!LoadLogic(sm_path, game, error, sizeof(error)))
+	{
+		fprintf(stderr, "Could not load SourceMod: %s\n", error);
+		return 1;
+	}
+
+	StartHarnessProfiler();
+
+	auto start = std::chrono::steady_clock::now();
+	bool ok = RunReplay(stream, iterations);
+	std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - start;
+
+	WriteUsageReport(stdout, false, wall.count());
+	if (json)
+	{
+		FILE *fp = fopen(json, "wt");
+		if (!fp)
+		{
+			fprintf(stderr, "Could not open %s for writing\n", json);
+			ok = false;
+		}
+		else
+		{
+			WriteUsageReport(fp, true, wall.count());
+			fclose(fp);
+		}
+	}
+
+	ShutdownLogic();
+	return ok ? 0 : 1;
+}
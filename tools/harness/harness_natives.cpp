@@ -0,0 +1,1300 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <amtl/am-string.h>
+#include <IPluginSys.h>
+#include "harness.h"
+
+/**
+ * The parts of core that plugins reach most often and that logic does not
+ * provide: the client and map forwards, game events, convars, console
+ * commands and a few halflife.inc natives. Anything else that lives in core
+ * or in an extension is missing, and plugins that need it fail to load with
+ * the name of the first unbound native.
+ */
+
+/* Must match events.inc */
+enum EventHookMode
+{
+	EventHookMode_Pre,
+	EventHookMode_Post,
+	EventHookMode_PostNoCopy,
+};
+
+struct HarnessEvent
+{
+	std::string name;
+	std::map<std::string, std::string> keys;
+	IdentityToken_t *owner;
+	bool dont_broadcast;
+
+	const char *Get(const char *key, const char *def) const
+	{
+		auto iter = keys.find(key);
+		return iter != keys.end() ? iter->second.c_str() : def;
+	}
+};
+
+struct EventHooks
+{
+	IChangeableForward *pre = NULL;
+	IChangeableForward *post = NULL;
+	unsigned int post_copy = 0;
+};
+
+struct HarnessConVar
+{
+	std::string name;
+	std::string value;
+	std::string def;
+	std::string description;
+	int flags;
+	bool has_min;
+	float min;
+	bool has_max;
+	float max;
+	Handle_t handle;
+	IChangeableForward *changed;
+};
+
+static IForward *s_OnMapStart = NULL;
+static IForward *s_OnMapEnd = NULL;
+static IForward *s_OnAutoConfigsBuffered = NULL;
+static IForward *s_OnConfigsExecuted = NULL;
+static IForward *s_OnGameFrame = NULL;
+static IForward *s_OnClientConnected = NULL;
+static IForward *s_OnClientPutInServer = NULL;
+static IForward *s_OnClientDisconnect = NULL;
+static IForward *s_OnClientDisconnect_Post = NULL;
+static IForward *s_OnClientAuthorized = NULL;
+static IForward *s_OnClientPostAdminCheck = NULL;
+static IForward *s_OnPlayerRunCmd = NULL;
+static IForward *s_OnPlayerRunCmdPost = NULL;
+
+static HandleType_t s_EventType = 0;
+static HandleType_t s_ConVarType = 0;
+static std::map<std::string, EventHooks> s_EventHooks;
+static std::map<std::string, std::unique_ptr<HarnessConVar>> s_ConVars;
+static std::map<std::string, IChangeableForward *> s_ConCommands;
+static const HarnessArgs *s_CmdArgs = NULL;
+static std::mt19937 s_Random;
+static const std::chrono::steady_clock::time_point s_EngineStart = std::chrono::steady_clock::now();
+
+class HarnessHandles : public IHandleTypeDispatch
+{
+public:
+	void OnHandleDestroy(HandleType_t type, void *object) override
+	{
+		/* Events created by plugins are owned by their handle; hook handles
+		 * and convar handles are not.
+		 */
+		if (type == s_EventType)
+		{
+			HarnessEvent *ev = (HarnessEvent *)object;
+			if (ev->owner)
+			{
+				delete ev;
+			}
+		}
+	}
+} s_HandleDispatch;
+
+static inline HandleSecurity CoreSecurity()
+{
+	return HandleSecurity(NULL, logicore.core_ident);
+}
+
+static HarnessEvent *ReadEvent(IPluginContext *pContext, cell_t hndl)
+{
+	HarnessEvent *ev;
+	HandleSecurity sec(pContext->GetIdentity(), logicore.core_ident);
+	HandleError err = logicore.handlesys->ReadHandle(hndl, s_EventType, &sec, (void **)&ev);
+	if (err != HandleError_None)
+	{
+		pContext->ReportError("Invalid game event handle %x (error %d)", hndl, err);
+		return NULL;
+	}
+	return ev;
+}
+
+static HarnessConVar *ReadConVar(IPluginContext *pContext, cell_t hndl)
+{
+	HarnessConVar *cvar;
+	HandleSecurity sec = CoreSecurity();
+	HandleError err = logicore.handlesys->ReadHandle(hndl, s_ConVarType, &sec, (void **)&cvar);
+	if (err != HandleError_None)
+	{
+		pContext->ReportError("Invalid convar handle %x (error %d)", hndl, err);
+		return NULL;
+	}
+	return cvar;
+}
+
+/**
+ * Runs the hooks for one event: pre hooks may block it, post hooks see the
+ * final values. Each stage gets a temporary, core-owned handle.
+ */
+static bool DispatchEvent(HarnessEvent *ev)
+{
+	auto iter = s_EventHooks.find(ev->name);
+	if (iter == s_EventHooks.end())
+	{
+		return true;
+	}
+
+	EventHooks &hooks = iter->second;
+	HandleSecurity sec = CoreSecurity();
+	cell_t result = Pl_Continue;
+
+	if (hooks.pre && hooks.pre->GetFunctionCount())
+	{
+		Handle_t hndl = logicore.handlesys->CreateHandle(s_EventType, ev, logicore.core_ident, logicore.core_ident, NULL);
+		hooks.pre->PushCell(hndl);
+		hooks.pre->PushString(ev->name.c_str());
+		hooks.pre->PushCell(ev->dont_broadcast);
+		hooks.pre->Execute(&result);
+		logicore.handlesys->FreeHandle(hndl, &sec);
+	}
+
+	if (result >= Pl_Handled)
+	{
+		return false;
+	}
+
+	if (hooks.post && hooks.post->GetFunctionCount())
+	{
+		Handle_t hndl = BAD_HANDLE;
+		if (hooks.post_copy)
+		{
+			hndl = logicore.handlesys->CreateHandle(s_EventType, ev, logicore.core_ident, logicore.core_ident, NULL);
+		}
+		hooks.post->PushCell(hndl);
+		hooks.post->PushString(ev->name.c_str());
+		hooks.post->PushCell(ev->dont_broadcast);
+		hooks.post->Execute(NULL);
+		if (hndl)
+		{
+			logicore.handlesys->FreeHandle(hndl, &sec);
+		}
+	}
+
+	return true;
+}
+
+bool FireGameEvent(const char *name, const std::vector<std::pair<std::string, std::string>> &keys)
+{
+	HarnessEvent ev;
+	ev.name = name;
+	ev.owner = NULL;
+	ev.dont_broadcast = false;
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		ev.keys[keys[i].first] = keys[i].second;
+	}
+	return DispatchEvent(&ev);
+}
+
+static cell_t HookEventImpl(IPluginContext *pContext, const cell_t *params)
+{
+	char *name;
+	pContext->LocalToString(params[1], &name);
+
+	IPluginFunction *pFunction = pContext->GetFunctionById(params[2]);
+	if (!pFunction)
+	{
+		return pContext->ThrowNativeError("Invalid function id (%X)", params[2]);
+	}
+
+	/* Any event name is valid; there is no resource file to check against. */
+	EventHooks &hooks = s_EventHooks[name];
+	if (params[3] == EventHookMode_Pre)
+	{
+		if (!hooks.pre)
+		{
+			hooks.pre = logicore.forwardsys->CreateForwardEx(NULL, ET_Hook, 3, NULL, Param_Cell, Param_String, Param_Cell);
+		}
+		hooks.pre->AddFunction(pFunction);
+	}
+	else
+	{
+		if (!hooks.post)
+		{
+			hooks.post = logicore.forwardsys->CreateForwardEx(NULL, ET_Ignore, 3, NULL, Param_Cell, Param_String, Param_Cell);
+		}
+		hooks.post->AddFunction(pFunction);
+		if (params[3] == EventHookMode_Post)
+		{
+			hooks.post_copy++;
+		}
+	}
+	return 1;
+}
+
+static cell_t sm_HookEvent(IPluginContext *pContext, const cell_t *params)
+{
+	return HookEventImpl(pContext, params);
+}
+
+static cell_t sm_UnhookEvent(IPluginContext *pContext, const cell_t *params)
+{
+	char *name;
+	pContext->LocalToString(params[1], &name);
+
+	IPluginFunction *pFunction = pContext->GetFunctionById(params[2]);
+	auto iter = s_EventHooks.find(name);
+	if (!pFunction || iter == s_EventHooks.end())
+	{
+		return pContext->ThrowNativeError("Game event \"%s\" has no active hook", name);
+	}
+
+	EventHooks &hooks = iter->second;
+	IChangeableForward *fwd = (params[3] == EventHookMode_Pre) ? hooks.pre : hooks.post;
+	if (!fwd || !fwd->RemoveFunction(pFunction))
+	{
+		return pContext->ThrowNativeError("Invalid hook callback specified for game event \"%s\"", name);
+	}
+	if (params[3] == EventHookMode_Post && hooks.post_copy)
+	{
+		hooks.post_copy--;
+	}
+	return 1;
+}
+
+static cell_t sm_CreateEvent(IPluginContext *pContext, const cell_t *params)
+{
+	char *name;
+	pContext->LocalToString(params[1], &name);
+
+	HarnessEvent *ev = new HarnessEvent;
+	ev->name = name;
+	ev->owner = pContext->GetIdentity();
+	ev->dont_broadcast = false;
+
+	Handle_t hndl = logicore.handlesys->CreateHandle(s_EventType, ev, pContext->GetIdentity(), logicore.core_ident, NULL);
+	if (!hndl)
+	{
+		delete ev;
+	}
+	return hndl;
+}
+
+static cell_t sm_FireEvent(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessEvent *ev = ReadEvent(pContext, params[1]);
+	if (!ev)
+	{
+		return 0;
+	}
+	if (ev->owner != pContext->GetIdentity())
+	{
+		return pContext->ThrowNativeError("Game event \"%s\" could not be fired because it was not created by this plugin", ev->name.c_str());
+	}
+
+	ev->dont_broadcast = params[2] ? true : false;
+	DispatchEvent(ev);
+
+	HandleSecurity sec(pContext->GetIdentity(), logicore.core_ident);
+	logicore.handlesys->FreeHandle(params[1], &sec);
+	return 1;
+}
+
+static cell_t sm_FireEventToClient(IPluginContext *pContext, const cell_t *params)
+{
+	/* Client-only events never reach server hooks. */
+	return ReadEvent(pContext, params[1]) ? 1 : 0;
+}
+
+static cell_t sm_CancelCreatedEvent(IPluginContext *pContext, const cell_t *params)
+{
+	if (!ReadEvent(pContext, params[1]))
+	{
+		return 0;
+	}
+
+	HandleSecurity sec(pContext->GetIdentity(), logicore.core_ident);
+	logicore.handlesys->FreeHandle(params[1], &sec);
+	return 1;
+}
+
+static cell_t sm_GetEventName(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessEvent *ev = ReadEvent(pContext, params[1]);
+	if (!ev)
+	{
+		return 0;
+	}
+	pContext->StringToLocalUTF8(params[2], params[3], ev->name.c_str(), NULL);
+	return 1;
+}
+
+static cell_t sm_GetEventBool(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessEvent *ev = ReadEvent(pContext, params[1]);
+	if (!ev)
+	{
+		return 0;
+	}
+
+	char *key;
+	pContext->LocalToString(params[2], &key);
+	const char *value = ev->Get(key, NULL);
+	if (!value)
+	{
+		return params[0] > 2 ? params[3] : 0;
+	}
+	return atoi(value) != 0;
+}
+
+static cell_t sm_GetEventInt(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessEvent *ev = ReadEvent(pContext, params[1]);
+	if (!ev)
+	{
+		return 0;
+	}
+
+	char *key;
+	pContext->LocalToString(params[2], &key);
+	const char *value = ev->Get(key, NULL);
+	if (!value)
+	{
+		return params[0] > 2 ? params[3] : 0;
+	}
+	return atoi(value);
+}
+
+static cell_t sm_GetEventFloat(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessEvent *ev = ReadEvent(pContext, params[1]);
+	if (!ev)
+	{
+		return 0;
+	}
+
+	char *key;
+	pContext->LocalToString(params[2], &key);
+	const char *value = ev->Get(key, NULL);
+	if (!value)
+	{
+		return params[0] > 2 ? params[3] : sp_ftoc(0.0f);
+	}
+	return sp_ftoc((float)atof(value));
+}
+
+static cell_t sm_GetEventString(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessEvent *ev = ReadEvent(pContext, params[1]);
+	if (!ev)
+	{
+		return 0;
+	}
+
+	char *key;
+	char *def = NULL;
+	pContext->LocalToString(params[2], &key);
+	if (params[0] > 4)
+	{
+		pContext->LocalToString(params[5], &def);
+	}
+	pContext->StringToLocalUTF8(params[3], params[4], ev->Get(key, def ? def : ""), NULL);
+	return 1;
+}
+
+static cell_t sm_SetEventInt(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessEvent *ev = ReadEvent(pContext, params[1]);
+	if (!ev)
+	{
+		return 0;
+	}
+
+	char *key;
+	char value[32];
+	pContext->LocalToString(params[2], &key);
+	ke::SafeSprintf(value, sizeof(value), "%d", params[3]);
+	ev->keys[key] = value;
+	return 1;
+}
+
+static cell_t sm_SetEventBool(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessEvent *ev = ReadEvent(pContext, params[1]);
+	if (!ev)
+	{
+		return 0;
+	}
+
+	char *key;
+	pContext->LocalToString(params[2], &key);
+	ev->keys[key] = params[3] ? "1" : "0";
+	return 1;
+}
+
+static cell_t sm_SetEventFloat(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessEvent *ev = ReadEvent(pContext, params[1]);
+	if (!ev)
+	{
+		return 0;
+	}
+
+	char *key;
+	char value[32];
+	pContext->LocalToString(params[2], &key);
+	ke::SafeSprintf(value, sizeof(value), "%f", sp_ctof(params[3]));
+	ev->keys[key] = value;
+	return 1;
+}
+
+static cell_t sm_SetEventString(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessEvent *ev = ReadEvent(pContext, params[1]);
+	if (!ev)
+	{
+		return 0;
+	}
+
+	char *key, *value;
+	pContext->LocalToString(params[2], &key);
+	pContext->LocalToString(params[3], &value);
+	ev->keys[key] = value;
+	return 1;
+}
+
+static cell_t sm_SetEventBroadcast(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessEvent *ev = ReadEvent(pContext, params[1]);
+	if (!ev)
+	{
+		return 0;
+	}
+	ev->dont_broadcast = params[2] ? true : false;
+	return 1;
+}
+
+static cell_t sm_GetEventBroadcast(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessEvent *ev = ReadEvent(pContext, params[1]);
+	if (!ev)
+	{
+		return 0;
+	}
+	return ev->dont_broadcast;
+}
+
+static void ChangeConVar(HarnessConVar *cvar, const char *value)
+{
+	std::string clamped = value;
+	if (cvar->has_min || cvar->has_max)
+	{
+		float f = (float)atof(value);
+		if ((cvar->has_min && f < cvar->min) || (cvar->has_max && f > cvar->max))
+		{
+			char buffer[32];
+			f = (cvar->has_min && f < cvar->min) ? cvar->min : cvar->max;
+			ke::SafeSprintf(buffer, sizeof(buffer), "%f", f);
+			clamped = buffer;
+		}
+	}
+
+	if (cvar->value == clamped)
+	{
+		return;
+	}
+
+	std::string old = cvar->value;
+	cvar->value = clamped;
+
+	if (cvar->changed && cvar->changed->GetFunctionCount())
+	{
+		cvar->changed->PushCell(cvar->handle);
+		cvar->changed->PushString(old.c_str());
+		cvar->changed->PushString(cvar->value.c_str());
+		cvar->changed->Execute(NULL);
+	}
+}
+
+bool SetConVarValue(const char *name, const char *value)
+{
+	auto iter = s_ConVars.find(name);
+	if (iter == s_ConVars.end())
+	{
+		return false;
+	}
+	ChangeConVar(iter->second.get(), value);
+	return true;
+}
+
+static cell_t sm_CreateConVar(IPluginContext *pContext, const cell_t *params)
+{
+	char *name, *def, *description;
+	pContext->LocalToString(params[1], &name);
+	pContext->LocalToString(params[2], &def);
+	pContext->LocalToString(params[3], &description);
+
+	if (!name[0])
+	{
+		return pContext->ThrowNativeError("Convar with blank name is not permitted");
+	}
+
+	auto iter = s_ConVars.find(name);
+	if (iter != s_ConVars.end())
+	{
+		return iter->second->handle;
+	}
+
+	HarnessConVar *cvar = new HarnessConVar;
+	cvar->name = name;
+	cvar->value = def;
+	cvar->def = def;
+	cvar->description = description;
+	cvar->flags = params[4];
+	cvar->has_min = params[5] ? true : false;
+	cvar->min = sp_ctof(params[6]);
+	cvar->has_max = params[7] ? true : false;
+	cvar->max = sp_ctof(params[8]);
+	cvar->changed = NULL;
+
+	/* Convars outlive the plugins that create them, as on a real server. */
+	cvar->handle = logicore.handlesys->CreateHandle(s_ConVarType, cvar, logicore.core_ident, logicore.core_ident, NULL);
+	s_ConVars[name].reset(cvar);
+	return cvar->handle;
+}
+
+static cell_t sm_FindConVar(IPluginContext *pContext, const cell_t *params)
+{
+	char *name;
+	pContext->LocalToString(params[1], &name);
+
+	auto iter = s_ConVars.find(name);
+	return iter != s_ConVars.end() ? iter->second->handle : BAD_HANDLE;
+}
+
+static cell_t sm_HookConVarChange(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessConVar *cvar = ReadConVar(pContext, params[1]);
+	if (!cvar)
+	{
+		return 0;
+	}
+
+	IPluginFunction *pFunction = pContext->GetFunctionById(params[2]);
+	if (!pFunction)
+	{
+		return pContext->ThrowNativeError("Invalid function id (%X)", params[2]);
+	}
+
+	if (!cvar->changed)
+	{
+		cvar->changed = logicore.forwardsys->CreateForwardEx(NULL, ET_Ignore, 3, NULL, Param_Cell, Param_String, Param_String);
+	}
+	cvar->changed->AddFunction(pFunction);
+	return 1;
+}
+
+static cell_t sm_UnhookConVarChange(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessConVar *cvar = ReadConVar(pContext, params[1]);
+	if (!cvar)
+	{
+		return 0;
+	}
+
+	IPluginFunction *pFunction = pContext->GetFunctionById(params[2]);
+	if (!pFunction || !cvar->changed || !cvar->changed->RemoveFunction(pFunction))
+	{
+		return pContext->ThrowNativeError("Invalid hook callback specified for convar \"%s\"", cvar->name.c_str());
+	}
+	return 1;
+}
+
+static cell_t sm_GetConVarBool(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessConVar *cvar = ReadConVar(pContext, params[1]);
+	return cvar ? atoi(cvar->value.c_str()) != 0 : 0;
+}
+
+static cell_t sm_GetConVarInt(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessConVar *cvar = ReadConVar(pContext, params[1]);
+	return cvar ? atoi(cvar->value.c_str()) : 0;
+}
+
+static cell_t sm_GetConVarFloat(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessConVar *cvar = ReadConVar(pContext, params[1]);
+	return sp_ftoc(cvar ? (float)atof(cvar->value.c_str()) : 0.0f);
+}
+
+static cell_t sm_GetConVarString(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessConVar *cvar = ReadConVar(pContext, params[1]);
+	if (!cvar)
+	{
+		return 0;
+	}
+	pContext->StringToLocalUTF8(params[2], params[3], cvar->value.c_str(), NULL);
+	return 1;
+}
+
+static cell_t sm_SetConVarNum(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessConVar *cvar = ReadConVar(pContext, params[1]);
+	if (!cvar)
+	{
+		return 0;
+	}
+
+	char value[32];
+	ke::SafeSprintf(value, sizeof(value), "%d", params[2]);
+	ChangeConVar(cvar, value);
+	return 1;
+}
+
+static cell_t sm_SetConVarFloat(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessConVar *cvar = ReadConVar(pContext, params[1]);
+	if (!cvar)
+	{
+		return 0;
+	}
+
+	char value[32];
+	ke::SafeSprintf(value, sizeof(value), "%f", sp_ctof(params[2]));
+	ChangeConVar(cvar, value);
+	return 1;
+}
+
+static cell_t sm_SetConVarString(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessConVar *cvar = ReadConVar(pContext, params[1]);
+	if (!cvar)
+	{
+		return 0;
+	}
+
+	char *value;
+	pContext->LocalToString(params[2], &value);
+	ChangeConVar(cvar, value);
+	return 1;
+}
+
+static cell_t sm_ResetConVar(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessConVar *cvar = ReadConVar(pContext, params[1]);
+	if (!cvar)
+	{
+		return 0;
+	}
+	ChangeConVar(cvar, cvar->def.c_str());
+	return 1;
+}
+
+static cell_t sm_GetConVarDefault(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessConVar *cvar = ReadConVar(pContext, params[1]);
+	if (!cvar)
+	{
+		return 0;
+	}
+
+	size_t bytes;
+	pContext->StringToLocalUTF8(params[2], params[3], cvar->def.c_str(), &bytes);
+	return (cell_t)bytes;
+}
+
+static cell_t sm_GetConVarName(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessConVar *cvar = ReadConVar(pContext, params[1]);
+	if (!cvar)
+	{
+		return 0;
+	}
+	pContext->StringToLocalUTF8(params[2], params[3], cvar->name.c_str(), NULL);
+	return 1;
+}
+
+static cell_t sm_GetConVarFlags(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessConVar *cvar = ReadConVar(pContext, params[1]);
+	return cvar ? cvar->flags : 0;
+}
+
+static cell_t sm_SetConVarFlags(IPluginContext *pContext, const cell_t *params)
+{
+	HarnessConVar *cvar = ReadConVar(pContext, params[1]);
+	if (cvar)
+	{
+		cvar->flags = params[2];
+	}
+	return 1;
+}
+
+static cell_t RegCommandImpl(IPluginContext *pContext, const char *name, cell_t funcid)
+{
+	IPluginFunction *pFunction = pContext->GetFunctionById(funcid);
+	if (!pFunction)
+	{
+		return pContext->ThrowNativeError("Invalid function id (%X)", funcid);
+	}
+
+	IChangeableForward *&fwd = s_ConCommands[name];
+	if (!fwd)
+	{
+		fwd = logicore.forwardsys->CreateForwardEx(NULL, ET_Hook, 2, NULL, Param_Cell, Param_Cell);
+	}
+	fwd->AddFunction(pFunction);
+	return 1;
+}
+
+static cell_t sm_RegConsoleCmd(IPluginContext *pContext, const cell_t *params)
+{
+	char *name;
+	pContext->LocalToString(params[1], &name);
+	return RegCommandImpl(pContext, name, params[2]);
+}
+
+/* Admin flags are not enforced; every client may run every command. */
+static cell_t sm_RegAdminCmd(IPluginContext *pContext, const cell_t *params)
+{
+	char *name;
+	pContext->LocalToString(params[1], &name);
+	return RegCommandImpl(pContext, name, params[2]);
+}
+
+static cell_t sm_RegServerCmd(IPluginContext *pContext, const cell_t *params)
+{
+	char *name;
+	pContext->LocalToString(params[1], &name);
+	return RegCommandImpl(pContext, name, params[2]);
+}
+
+bool RunClientCommand(int client, const char *line)
+{
+	HarnessArgs args(line);
+	if (!args.ArgC())
+	{
+		return false;
+	}
+
+	auto iter = s_ConCommands.find(args.Arg(0));
+	if (iter == s_ConCommands.end())
+	{
+		return false;
+	}
+
+	const HarnessArgs *saved = s_CmdArgs;
+	unsigned int reply = GetPlayerManager()->SetReplyTo(0);
+	s_CmdArgs = &args;
+
+	iter->second->PushCell(client);
+	iter->second->PushCell(args.ArgC() - 1);
+	iter->second->Execute(NULL);
+
+	s_CmdArgs = saved;
+	GetPlayerManager()->SetReplyTo(reply);
+	return true;
+}
+
+static cell_t sm_GetCmdArgs(IPluginContext *pContext, const cell_t *params)
+{
+	return s_CmdArgs ? s_CmdArgs->ArgC() - 1 : 0;
+}
+
+static cell_t sm_GetCmdArg(IPluginContext *pContext, const cell_t *params)
+{
+	const char *arg = s_CmdArgs ? s_CmdArgs->Arg(params[1]) : "";
+
+	size_t length;
+	pContext->StringToLocalUTF8(params[2], params[3], arg, &length);
+	return (cell_t)length;
+}
+
+static cell_t sm_GetCmdArgString(IPluginContext *pContext, const cell_t *params)
+{
+	const char *args = s_CmdArgs ? s_CmdArgs->ArgS() : "";
+
+	size_t length;
+	pContext->StringToLocalUTF8(params[1], params[2], args, &length);
+	return (cell_t)length;
+}
+
+static cell_t FormatToClient(IPluginContext *pContext, const cell_t *params)
+{
+	int client = params[1];
+	if (client && !IsClientIndexConnected(client))
+	{
+		return pContext->ThrowNativeError("Client %d is not connected", client);
+	}
+
+	/* The text goes nowhere, but translating and formatting it is real work. */
+	char buffer[254];
+	int arg = 3;
+	char *format;
+	pContext->LocalToString(params[2], &format);
+
+	ISourceMod *sm = GetHarnessSourceMod();
+	unsigned int old = sm->SetGlobalTarget(client);
+	logicore.atcprintf(buffer, sizeof(buffer), format, pContext, params, &arg);
+	sm->SetGlobalTarget(old);
+	return 1;
+}
+
+static cell_t PrintToChat(IPluginContext *pContext, const cell_t *params)
+{
+	return FormatToClient(pContext, params);
+}
+
+static cell_t PrintCenterText(IPluginContext *pContext, const cell_t *params)
+{
+	return FormatToClient(pContext, params);
+}
+
+static cell_t PrintHintText(IPluginContext *pContext, const cell_t *params)
+{
+	return FormatToClient(pContext, params);
+}
+
+static cell_t IsPlayerAlive(IPluginContext *pContext, const cell_t *params)
+{
+	int client = params[1];
+	if (!IsClientIndexConnected(client))
+	{
+		return pContext->ThrowNativeError("Client %d is not in game", client);
+	}
+	return IsClientIndexAlive(client);
+}
+
+static cell_t GetGameTime(IPluginContext *pContext, const cell_t *params)
+{
+	return sp_ftoc((float)g_Clock.now);
+}
+
+static cell_t GetEngineTime(IPluginContext *pContext, const cell_t *params)
+{
+	std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - s_EngineStart;
+	return sp_ftoc(elapsed.count());
+}
+
+static cell_t GetGameTickCount(IPluginContext *pContext, const cell_t *params)
+{
+	return g_Clock.tick;
+}
+
+static cell_t GetGameFrameTime(IPluginContext *pContext, const cell_t *params)
+{
+	return sp_ftoc(g_Clock.frametime);
+}
+
+static cell_t GetCurrentMap(IPluginContext *pContext, const cell_t *params)
+{
+	size_t bytes;
+	pContext->StringToLocalUTF8(params[1], params[2], CurrentMap(), &bytes);
+	return (cell_t)bytes;
+}
+
+static cell_t IsMapValid(IPluginContext *pContext, const cell_t *params)
+{
+	return 1;
+}
+
+static cell_t IsDedicatedServer(IPluginContext *pContext, const cell_t *params)
+{
+	return 1;
+}
+
+static cell_t GetGameFolderName(IPluginContext *pContext, const cell_t *params)
+{
+	size_t bytes;
+	pContext->StringToLocalUTF8(params[1], params[2], GetHarnessSourceMod()->GetGameFolderName(), &bytes);
+	return (cell_t)bytes;
+}
+
+static cell_t GetEngineVersion(IPluginContext *pContext, const cell_t *params)
+{
+	/* Engine_Unknown */
+	return 0;
+}
+
+static cell_t GetRandomInt(IPluginContext *pContext, const cell_t *params)
+{
+	int lo = params[1], hi = params[2];
+	if (hi < lo)
+	{
+		int t = lo; lo = hi; hi = t;
+	}
+	return std::uniform_int_distribution<int>(lo, hi)(s_Random);
+}
+
+static cell_t GetRandomFloat(IPluginContext *pContext, const cell_t *params)
+{
+	float lo = sp_ctof(params[1]), hi = sp_ctof(params[2]);
+	if (hi < lo)
+	{
+		float t = lo; lo = hi; hi = t;
+	}
+	return sp_ftoc(std::uniform_real_distribution<float>(lo, hi)(s_Random));
+}
+
+static cell_t SetRandomSeed(IPluginContext *pContext, const cell_t *params)
+{
+	s_Random.seed(params[1]);
+	return 1;
+}
+
+static cell_t Precache(IPluginContext *pContext, const cell_t *params)
+{
+	return 1;
+}
+
+static sp_nativeinfo_t s_HarnessNatives[] =
+{
+	{"HookEvent",				sm_HookEvent},
+	{"HookEventEx",				sm_HookEvent},
+	{"UnhookEvent",				sm_UnhookEvent},
+	{"CreateEvent",				sm_CreateEvent},
+	{"FireEvent",				sm_FireEvent},
+	{"CancelCreatedEvent",		sm_CancelCreatedEvent},
+	{"GetEventName",			sm_GetEventName},
+	{"GetEventBool",			sm_GetEventBool},
+	{"GetEventInt",				sm_GetEventInt},
+	{"GetEventFloat",			sm_GetEventFloat},
+	{"GetEventString",			sm_GetEventString},
+	{"SetEventBool",			sm_SetEventBool},
+	{"SetEventInt",				sm_SetEventInt},
+	{"SetEventFloat",			sm_SetEventFloat},
+	{"SetEventString",			sm_SetEventString},
+	{"SetEventBroadcast",		sm_SetEventBroadcast},
+	{"Event.Fire",				sm_FireEvent},
+	{"Event.FireToClient",		sm_FireEventToClient},
+	{"Event.Cancel",			sm_CancelCreatedEvent},
+	{"Event.GetName",			sm_GetEventName},
+	{"Event.GetBool",			sm_GetEventBool},
+	{"Event.GetInt",			sm_GetEventInt},
+	{"Event.GetFloat",			sm_GetEventFloat},
+	{"Event.GetString",			sm_GetEventString},
+	{"Event.SetBool",			sm_SetEventBool},
+	{"Event.SetInt",			sm_SetEventInt},
+	{"Event.SetFloat",			sm_SetEventFloat},
+	{"Event.SetString",			sm_SetEventString},
+	{"Event.BroadcastDisabled.set",	sm_SetEventBroadcast},
+	{"Event.BroadcastDisabled.get",	sm_GetEventBroadcast},
+
+	{"CreateConVar",			sm_CreateConVar},
+	{"FindConVar",				sm_FindConVar},
+	{"HookConVarChange",		sm_HookConVarChange},
+	{"UnhookConVarChange",		sm_UnhookConVarChange},
+	{"GetConVarBool",			sm_GetConVarBool},
+	{"SetConVarBool",			sm_SetConVarNum},
+	{"GetConVarInt",			sm_GetConVarInt},
+	{"SetConVarInt",			sm_SetConVarNum},
+	{"GetConVarFloat",			sm_GetConVarFloat},
+	{"SetConVarFloat",			sm_SetConVarFloat},
+	{"GetConVarString",			sm_GetConVarString},
+	{"SetConVarString",			sm_SetConVarString},
+	{"GetConVarFlags",			sm_GetConVarFlags},
+	{"SetConVarFlags",			sm_SetConVarFlags},
+	{"ResetConVar",				sm_ResetConVar},
+	{"GetConVarName",			sm_GetConVarName},
+	{"GetConVarDefault",		sm_GetConVarDefault},
+	{"ConVar.BoolValue.get",	sm_GetConVarBool},
+	{"ConVar.BoolValue.set",	sm_SetConVarNum},
+	{"ConVar.FloatValue.get",	sm_GetConVarFloat},
+	{"ConVar.FloatValue.set",	sm_SetConVarFloat},
+	{"ConVar.IntValue.get",		sm_GetConVarInt},
+	{"ConVar.IntValue.set",		sm_SetConVarNum},
+	{"ConVar.Flags.get",		sm_GetConVarFlags},
+	{"ConVar.Flags.set",		sm_SetConVarFlags},
+	{"ConVar.SetBool",			sm_SetConVarNum},
+	{"ConVar.SetInt",			sm_SetConVarNum},
+	{"ConVar.SetFloat",			sm_SetConVarFloat},
+	{"ConVar.GetString",		sm_GetConVarString},
+	{"ConVar.SetString",		sm_SetConVarString},
+	{"ConVar.RestoreDefault",	sm_ResetConVar},
+	{"ConVar.GetDefault",		sm_GetConVarDefault},
+	{"ConVar.GetName",			sm_GetConVarName},
+	{"ConVar.AddChangeHook",	sm_HookConVarChange},
+	{"ConVar.RemoveChangeHook",	sm_UnhookConVarChange},
+
+	{"RegConsoleCmd",			sm_RegConsoleCmd},
+	{"RegAdminCmd",				sm_RegAdminCmd},
+	{"RegServerCmd",			sm_RegServerCmd},
+	{"GetCmdArgs",				sm_GetCmdArgs},
+	{"GetCmdArg",				sm_GetCmdArg},
+	{"GetCmdArgString",			sm_GetCmdArgString},
+
+	{"PrintToChat",				PrintToChat},
+	{"PrintCenterText",			PrintCenterText},
+	{"PrintHintText",			PrintHintText},
+	{"IsPlayerAlive",			IsPlayerAlive},
+	{"GetGameTime",				GetGameTime},
+	{"GetEngineTime",			GetEngineTime},
+	{"GetGameTickCount",		GetGameTickCount},
+	{"GetGameFrameTime",		GetGameFrameTime},
+	{"GetCurrentMap",			GetCurrentMap},
+	{"IsMapValid",				IsMapValid},
+	{"IsDedicatedServer",		IsDedicatedServer},
+	{"GetGameFolderName",		GetGameFolderName},
+	{"GetEngineVersion",		GetEngineVersion},
+	{"GetRandomInt",			GetRandomInt},
+	{"GetRandomFloat",			GetRandomFloat},
+	{"SetRandomSeed",			SetRandomSeed},
+	{"PrecacheModel",			Precache},
+	{"PrecacheSound",			Precache},
+	{"PrecacheDecal",			Precache},
+	{"PrecacheGeneric",			Precache},
+	{"IsModelPrecached",		Precache},
+	{"IsSoundPrecached",		Precache},
+	{NULL,						NULL},
+};
+
+void RegisterHarnessNatives()
+{
+	s_EventType = logicore.handlesys->CreateType("GameEvent", &s_HandleDispatch, 0, NULL, NULL, logicore.core_ident, NULL);
+
+	/* Convar handles belong to the harness; plugins may not close them. */
+	HandleAccess access;
+	logicore.handlesys->InitAccessDefaults(NULL, &access);
+	access.access[HandleAccess_Delete] = HANDLE_RESTRICT_IDENTITY|HANDLE_RESTRICT_OWNER;
+	s_ConVarType = logicore.handlesys->CreateType("ConVar", &s_HandleDispatch, 0, NULL, &access, logicore.core_ident, NULL);
+
+	logicore.sharesys->AddNatives(NULL, s_HarnessNatives);
+}
+
+void CreateHarnessForwards()
+{
+	IForwardManager *forwardsys = logicore.forwardsys;
+
+	s_OnMapStart = forwardsys->CreateForward("OnMapStart", ET_Ignore, 0, NULL);
+	s_OnMapEnd = forwardsys->CreateForward("OnMapEnd", ET_Ignore, 0, NULL);
+	s_OnAutoConfigsBuffered = forwardsys->CreateForward("OnAutoConfigsBuffered", ET_Ignore, 0, NULL);
+	s_OnConfigsExecuted = forwardsys->CreateForward("OnConfigsExecuted", ET_Ignore, 0, NULL);
+	s_OnGameFrame = forwardsys->CreateForward("OnGameFrame", ET_Ignore, 0, NULL);
+	s_OnClientConnected = forwardsys->CreateForward("OnClientConnected", ET_Ignore, 1, NULL, Param_Cell);
+	s_OnClientPutInServer = forwardsys->CreateForward("OnClientPutInServer", ET_Ignore, 1, NULL, Param_Cell);
+	s_OnClientDisconnect = forwardsys->CreateForward("OnClientDisconnect", ET_Ignore, 1, NULL, Param_Cell);
+	s_OnClientDisconnect_Post = forwardsys->CreateForward("OnClientDisconnect_Post", ET_Ignore, 1, NULL, Param_Cell);
+	s_OnClientAuthorized = forwardsys->CreateForward("OnClientAuthorized", ET_Ignore, 2, NULL, Param_Cell, Param_String);
+	s_OnClientPostAdminCheck = forwardsys->CreateForward("OnClientPostAdminCheck", ET_Ignore, 1, NULL, Param_Cell);
+
+	/* Same signatures as the SDKTools forwards. */
+	s_OnPlayerRunCmd = forwardsys->CreateForward("OnPlayerRunCmd", ET_Event, 11, NULL,
+		Param_Cell, Param_CellByRef, Param_CellByRef, Param_Array, Param_Array, Param_CellByRef,
+		Param_CellByRef, Param_CellByRef, Param_CellByRef, Param_CellByRef, Param_Array);
+	s_OnPlayerRunCmdPost = forwardsys->CreateForward("OnPlayerRunCmdPost", ET_Ignore, 11, NULL,
+		Param_Cell, Param_Cell, Param_Cell, Param_Array, Param_Array, Param_Cell,
+		Param_Cell, Param_Cell, Param_Cell, Param_Cell, Param_Array);
+}
+
+void ReleaseHarnessForwards()
+{
+	IForwardManager *forwardsys = logicore.forwardsys;
+	IForward **forwards[] =
+	{
+		&s_OnMapStart, &s_OnMapEnd, &s_OnAutoConfigsBuffered, &s_OnConfigsExecuted,
+		&s_OnGameFrame, &s_OnClientConnected, &s_OnClientPutInServer, &s_OnClientDisconnect,
+		&s_OnClientDisconnect_Post, &s_OnClientAuthorized, &s_OnClientPostAdminCheck,
+		&s_OnPlayerRunCmd, &s_OnPlayerRunCmdPost,
+	};
+	for (size_t i = 0; i < sizeof(forwards) / sizeof(forwards[0]); i++)
+	{
+		if (*forwards[i])
+		{
+			forwardsys->ReleaseForward(*forwards[i]);
+			*forwards[i] = NULL;
+		}
+	}
+
+	for (auto iter = s_EventHooks.begin(); iter != s_EventHooks.end(); iter++)
+	{
+		if (iter->second.pre)
+		{
+			forwardsys->ReleaseForward(iter->second.pre);
+		}
+		if (iter->second.post)
+		{
+			forwardsys->ReleaseForward(iter->second.post);
+		}
+	}
+	s_EventHooks.clear();
+
+	for (auto iter = s_ConCommands.begin(); iter != s_ConCommands.end(); iter++)
+	{
+		forwardsys->ReleaseForward(iter->second);
+	}
+	s_ConCommands.clear();
+
+	for (auto iter = s_ConVars.begin(); iter != s_ConVars.end(); iter++)
+	{
+		if (iter->second->changed)
+		{
+			forwardsys->ReleaseForward(iter->second->changed);
+		}
+	}
+	s_ConVars.clear();
+
+	logicore.handlesys->RemoveType(s_EventType, logicore.core_ident);
+	logicore.handlesys->RemoveType(s_ConVarType, logicore.core_ident);
+}
+
+static void ExecuteClientForward(IForward *fwd, int client)
+{
+	if (fwd && fwd->GetFunctionCount())
+	{
+		fwd->PushCell(client);
+		fwd->Execute(NULL);
+	}
+}
+
+static void ExecuteForward(IForward *fwd)
+{
+	if (fwd && fwd->GetFunctionCount())
+	{
+		fwd->Execute(NULL);
+	}
+}
+
+void OnHarnessMapStart()
+{
+	ExecuteForward(s_OnMapStart);
+}
+
+void OnHarnessMapEnd()
+{
+	ExecuteForward(s_OnMapEnd);
+}
+
+void OnHarnessConfigsExecuted()
+{
+	ExecuteForward(s_OnAutoConfigsBuffered);
+	ExecuteForward(s_OnConfigsExecuted);
+}
+
+void OnHarnessGameFrame()
+{
+	ExecuteForward(s_OnGameFrame);
+}
+
+void OnHarnessClientConnected(int client)
+{
+	ExecuteClientForward(s_OnClientConnected, client);
+}
+
+void OnHarnessClientPutInServer(int client)
+{
+	ExecuteClientForward(s_OnClientPutInServer, client);
+}
+
+void OnHarnessClientDisconnect(int client)
+{
+	ExecuteClientForward(s_OnClientDisconnect, client);
+}
+
+void OnHarnessClientDisconnected(int client)
+{
+	ExecuteClientForward(s_OnClientDisconnect_Post, client);
+}
+
+void OnHarnessClientAuthorized(int client, const char *auth)
+{
+	if (s_OnClientAuthorized && s_OnClientAuthorized->GetFunctionCount())
+	{
+		s_OnClientAuthorized->PushCell(client);
+		s_OnClientAuthorized->PushString(auth);
+		s_OnClientAuthorized->Execute(NULL);
+	}
+}
+
+void OnHarnessClientPostAdminCheck(int client)
+{
+	ExecuteClientForward(s_OnClientPostAdminCheck, client);
+}
+
+void RunUserCmd(int client, const HarnessUserCmd &cmd)
+{
+	if (!IsClientIndexAlive(client))
+	{
+		return;
+	}
+
+	/* Plugins may rewrite the command; the post forward sees the result. */
+	HarnessUserCmd ucmd = cmd;
+	cell_t buttons = ucmd.buttons, impulse = ucmd.impulse, weapon = ucmd.weapon;
+	cell_t subtype = ucmd.subtype, cmdnum = ucmd.cmdnum, tickcount = g_Clock.tick, seed = ucmd.seed;
+	cell_t vel[3] = { sp_ftoc(ucmd.vel[0]), sp_ftoc(ucmd.vel[1]), sp_ftoc(ucmd.vel[2]) };
+	cell_t angles[3] = { sp_ftoc(ucmd.angles[0]), sp_ftoc(ucmd.angles[1]), sp_ftoc(ucmd.angles[2]) };
+	cell_t mouse[2] = { ucmd.mouse[0], ucmd.mouse[1] };
+	cell_t result = Pl_Continue;
+
+	if (s_OnPlayerRunCmd->GetFunctionCount())
+	{
+		s_OnPlayerRunCmd->PushCell(client);
+		s_OnPlayerRunCmd->PushCellByRef(&buttons);
+		s_OnPlayerRunCmd->PushCellByRef(&impulse);
+		s_OnPlayerRunCmd->PushArray(vel, 3, SM_PARAM_COPYBACK);
+		s_OnPlayerRunCmd->PushArray(angles, 3, SM_PARAM_COPYBACK);
+		s_OnPlayerRunCmd->PushCellByRef(&weapon);
+		s_OnPlayerRunCmd->PushCellByRef(&subtype);
+		s_OnPlayerRunCmd->PushCellByRef(&cmdnum);
+		s_OnPlayerRunCmd->PushCellByRef(&tickcount);
+		s_OnPlayerRunCmd->PushCellByRef(&seed);
+		s_OnPlayerRunCmd->PushArray(mouse, 2, SM_PARAM_COPYBACK);
+		s_OnPlayerRunCmd->Execute(&result);
+	}
+
+	if (result >= Pl_Handled || !s_OnPlayerRunCmdPost->GetFunctionCount())
+	{
+		return;
+	}
+
+	s_OnPlayerRunCmdPost->PushCell(client);
+	s_OnPlayerRunCmdPost->PushCell(buttons);
+	s_OnPlayerRunCmdPost->PushCell(impulse);
+	s_OnPlayerRunCmdPost->PushArray(vel, 3);
+	s_OnPlayerRunCmdPost->PushArray(angles, 3);
+	s_OnPlayerRunCmdPost->PushCell(weapon);
+	s_OnPlayerRunCmdPost->PushCell(subtype);
+	s_OnPlayerRunCmdPost->PushCell(cmdnum);
+	s_OnPlayerRunCmdPost->PushCell(tickcount);
+	s_OnPlayerRunCmdPost->PushCell(seed);
+	s_OnPlayerRunCmdPost->PushArray(mouse, 2);
+	s_OnPlayerRunCmdPost->Execute(NULL);
+}
@@ -0,0 +1,1453 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <amtl/am-string.h>
+#include <amtl/os/am-path.h>
+#include <amtl/os/am-shared-library.h>
+#include <ISourceMod.h>
+#include <ITimerSystem.h>
+#include <ITextParsers.h>
+#include <IMenuManager.h>
+#include <sm_globals.h>
+#include <bridge/include/IVEngineServerBridge.h>
+#include <bridge/include/IFileSystemBridge.h>
+#include <bridge/include/IProviderCallbacks.h>
+#include <bridge/include/IScriptManager.h>
+#include <bridge/include/IExtensionBridge.h>
+#include "harness.h"
+
+#if defined _WIN32
+# include <direct.h>
+#endif
+
+#if defined KE_ARCH_X86
+# define SOURCEPAWN_DLL "sourcepawn.jit.x86"
+#else
+# define SOURCEPAWN_DLL "sourcepawn.vm"
+#endif
+
+sm_logic_t logicore;
+HarnessClock g_Clock = { 0.0, 0.015f, 0.015f, 0 };
+
+static ke::RefPtr<ke::SharedLib> s_Logic;
+static ke::RefPtr<ke::SharedLib> s_JIT;
+static ISourcePawnEnvironment *s_PawnEnv = NULL;
+static ISourcePawnEngine *s_SourcePawn = NULL;
+static ISourcePawnEngine2 *s_SourcePawn2 = NULL;
+static ITextParsers *s_TextParsers = NULL;
+static LogicInitFunction s_LogicInit = NULL;
+
+static ServerGlobals s_ServerGlobals;
+static std::string s_SMPath;
+static std::string s_GamePath;
+static std::string s_SMRelPath;
+static std::string s_GameFolder;
+static std::string s_MapName;
+static bool s_MapRunning = false;
+static bool s_MapLoading = false;
+static bool s_ConfigsExecuted = false;
+static unsigned int s_GlobalTarget = 0;
+
+static std::map<std::string, std::string> s_ConfigValues;
+static std::map<std::string, std::string> s_ConfigOverrides;
+static std::map<std::string, CommandFunc> s_Commands;
+static std::vector<GAME_FRAME_HOOK> s_FrameHooks;
+static std::vector<std::pair<FRAMEACTION, void *>> s_FrameActions;
+static std::vector<std::pair<FRAMEACTION, void *>> s_PostedActions;
+static std::mutex s_PostedLock;
+static std::vector<std::string> s_ServerCommands;
+
+HarnessArgs::HarnessArgs(const char *line)
+{
+	const char *p = line;
+	while (*p)
+	{
+		while (*p == ' ' || *p == '\t')
+		{
+			p++;
+		}
+		if (!*p)
+		{
+			break;
+		}
+
+		/* Everything after the command name is the argument string. */
+		if (args_.size() == 1)
+		{
+			argstring_ = p;
+		}
+
+		std::string arg;
+		if (*p == '"')
+		{
+			p++;
+			while (*p && *p != '"')
+			{
+				arg += *p++;
+			}
+			if (*p == '"')
+			{
+				p++;
+			}
+		}
+		else
+		{
+			while (*p && *p != ' ' && *p != '\t')
+			{
+				arg += *p++;
+			}
+		}
+		args_.push_back(arg);
+	}
+}
+
+const char *HarnessArgs::Arg(int n) const
+{
+	if (n < 0 || n >= (int)args_.size())
+	{
+		return "";
+	}
+	return args_[n].c_str();
+}
+
+int HarnessArgs::ArgC() const
+{
+	return (int)args_.size();
+}
+
+const char *HarnessArgs::ArgS() const
+{
+	return argstring_.c_str();
+}
+
+static void RunFrameActions()
+{
+	{
+		std::lock_guard<std::mutex> lock(s_PostedLock);
+		s_FrameActions.insert(s_FrameActions.end(), s_PostedActions.begin(), s_PostedActions.end());
+		s_PostedActions.clear();
+	}
+
+	/* Actions queued by these run on the next frame, as in core. */
+	std::vector<std::pair<FRAMEACTION, void *>> actions;
+	actions.swap(s_FrameActions);
+	for (size_t i = 0; i < actions.size(); i++)
+	{
+		actions[i].first(actions[i].second);
+	}
+}
+
+static void ExecuteServerCommands()
+{
+	while (!s_ServerCommands.empty())
+	{
+		std::vector<std::string> commands;
+		commands.swap(s_ServerCommands);
+		for (size_t i = 0; i < commands.size(); i++)
+		{
+			RunServerCommand(commands[i].c_str());
+		}
+	}
+}
+
+static ConfigResult SetConfigOption(const char *key, const char *value, ConfigSource source,
+	char *error, size_t maxlength)
+{
+	ConfigResult result = ConfigResult_Ignore;
+
+	for (SMGlobalClass *pBase = logicore.head; pBase; pBase = pBase->m_pGlobalClassNext)
+	{
+		if ((result = pBase->OnSourceModConfigChanged(key, value, source, error, maxlength)) != ConfigResult_Ignore)
+		{
+			break;
+		}
+	}
+
+	s_ConfigValues[key] = value;
+	return result;
+}
+
+/**
+ * Simulated timers. Timers are kept in expiry order and fired from RunFrame(),
+ * with the same repeat, kill and end semantics as core's timer system, but
+ * without its wheel or idle coalescing: every frame is a full tick.
+ */
+class SourceMod::ITimer
+{
+public:
+	ITimedEvent *listener;
+	void *data;
+	float interval;
+	double to_exec;
+	uint64_t seq;
+	int flags;
+	bool in_exec;
+	bool kill_me;
+};
+
+class HarnessTimers : public ITimerSystem
+{
+	typedef std::pair<double, uint64_t> Key;
+public:
+	HarnessTimers() : next_seq_(0), map_timer_(NULL)
+	{
+	}
+
+	ITimer *CreateTimer(ITimedEvent *pCallbacks, float fInterval, void *pData, int flags) override
+	{
+		ITimer *pTimer = new ITimer;
+		pTimer->listener = pCallbacks;
+		pTimer->data = pData;
+		pTimer->interval = fInterval;
+		pTimer->flags = flags;
+		pTimer->in_exec = false;
+		pTimer->kill_me = false;
+		pTimer->to_exec = g_Clock.now + fInterval;
+		Schedule(pTimer);
+		return pTimer;
+	}
+
+	void KillTimer(ITimer *pTimer) override
+	{
+		if (pTimer->kill_me)
+		{
+			return;
+		}
+		if (pTimer->in_exec)
+		{
+			pTimer->kill_me = true;
+			return;
+		}
+
+		pTimer->in_exec = true;
+		pTimer->listener->OnTimerEnd(pTimer, pTimer->data);
+		Unschedule(pTimer);
+		delete pTimer;
+	}
+
+	void FireTimerOnce(ITimer *pTimer, bool delayExec) override
+	{
+		if (pTimer->in_exec)
+		{
+			return;
+		}
+
+		pTimer->in_exec = true;
+		ResultType res = pTimer->listener->OnTimer(pTimer, pTimer->data);
+
+		if ((pTimer->flags & TIMER_FLAG_REPEAT) && res != Pl_Stop && !pTimer->kill_me)
+		{
+			if (delayExec)
+			{
+				Unschedule(pTimer);
+				pTimer->to_exec = g_Clock.now + pTimer->interval;
+				Schedule(pTimer);
+			}
+			pTimer->in_exec = false;
+			return;
+		}
+
+		pTimer->listener->OnTimerEnd(pTimer, pTimer->data);
+		Unschedule(pTimer);
+		delete pTimer;
+	}
+
+	IMapTimer *SetMapTimer(IMapTimer *pTimer) override
+	{
+		IMapTimer *old = map_timer_;
+		map_timer_ = pTimer;
+		return old;
+	}
+
+	void MapTimeLeftChanged() override
+	{
+	}
+
+	float GetTickedTime() override
+	{
+		return (float)g_Clock.now;
+	}
+
+	void NotifyOfGameStart(float offset) override
+	{
+	}
+
+	bool GetMapTimeLeft(float *pTime) override
+	{
+		return false;
+	}
+
+	IMapTimer *GetMapTimer() override
+	{
+		return map_timer_;
+	}
+
+	void RunFrame()
+	{
+		while (!timers_.empty() && timers_.begin()->first.first <= g_Clock.now)
+		{
+			ITimer *pTimer = timers_.begin()->second;
+			timers_.erase(timers_.begin());
+
+			pTimer->in_exec = true;
+			ResultType res = pTimer->listener->OnTimer(pTimer, pTimer->data);
+
+			if (!(pTimer->flags & TIMER_FLAG_REPEAT) || pTimer->kill_me || res == Pl_Stop)
+			{
+				pTimer->listener->OnTimerEnd(pTimer, pTimer->data);
+				delete pTimer;
+				continue;
+			}
+
+			pTimer->in_exec = false;
+			pTimer->to_exec += pTimer->interval;
+			if (pTimer->to_exec <= g_Clock.now)
+			{
+				pTimer->to_exec = g_Clock.now + pTimer->interval;
+			}
+			Schedule(pTimer);
+		}
+	}
+
+	void RemoveMapChangeTimers()
+	{
+		std::vector<ITimer *> kill;
+		for (auto iter = timers_.begin(); iter != timers_.end(); iter++)
+		{
+			if (iter->second->flags & TIMER_FLAG_NO_MAPCHANGE)
+			{
+				kill.push_back(iter->second);
+			}
+		}
+		for (size_t i = 0; i < kill.size(); i++)
+		{
+			KillTimer(kill[i]);
+		}
+	}
+
+	void KillAll()
+	{
+		while (!timers_.empty())
+		{
+			KillTimer(timers_.begin()->second);
+		}
+	}
+
+	size_t GetTimerCount() const
+	{
+		return timers_.size();
+	}
+
+private:
+	void Schedule(ITimer *pTimer)
+	{
+		pTimer->seq = next_seq_++;
+		timers_[Key(pTimer->to_exec, pTimer->seq)] = pTimer;
+	}
+
+	void Unschedule(ITimer *pTimer)
+	{
+		timers_.erase(Key(pTimer->to_exec, pTimer->seq));
+	}
+
+private:
+	std::map<Key, ITimer *> timers_;
+	uint64_t next_seq_;
+	IMapTimer *map_timer_;
+} s_Timers;
+
+class HarnessSourceMod : public ISourceMod
+{
+public:
+	const char *GetGamePath() const override
+	{
+		return s_GamePath.c_str();
+	}
+
+	const char *GetSourceModPath() const override
+	{
+		return s_SMPath.c_str();
+	}
+
+	size_t BuildPath(PathType type, char *buffer, size_t maxlength, const char *format, ...) override
+	{
+		char path[PLATFORM_MAX_PATH];
+		va_list ap;
+
+		va_start(ap, format);
+		ke::SafeVsprintf(path, sizeof(path), format, ap);
+		va_end(ap);
+
+		if (type != Path_SM_Rel && strncmp(path, "file://", 7) == 0)
+		{
+			return ke::path::Format(buffer, maxlength, "%s", &path[7]);
+		}
+
+		const char *base = NULL;
+		if (type == Path_Game)
+		{
+			base = s_GamePath.c_str();
+		}
+		else if (type == Path_SM)
+		{
+			base = s_SMPath.c_str();
+		}
+		else if (type == Path_SM_Rel)
+		{
+			base = s_SMRelPath.c_str();
+		}
+
+		if (base)
+		{
+			return ke::path::Format(buffer, maxlength, "%s/%s", base, path);
+		}
+		return ke::path::Format(buffer, maxlength, "%s", path);
+	}
+
+	void LogMessage(IExtension *pExt, const char *format, ...) override
+	{
+		va_list ap;
+		va_start(ap, format);
+		vfprintf(stdout, format, ap);
+		va_end(ap);
+		fputc('\n', stdout);
+	}
+
+	void LogError(IExtension *pExt, const char *format, ...) override
+	{
+		va_list ap;
+		va_start(ap, format);
+		fputs("[error] ", stderr);
+		vfprintf(stderr, format, ap);
+		va_end(ap);
+		fputc('\n', stderr);
+	}
+
+	size_t FormatString(char *buffer, size_t maxlength, IPluginContext *pContext, const cell_t *params, unsigned int param) override
+	{
+		char *fmt;
+		int arg = param + 1;
+
+		pContext->LocalToString(params[param], &fmt);
+		return logicore.atcprintf(buffer, maxlength, fmt, pContext, params, &arg);
+	}
+
+	void *CreateDataPack() override
+	{
+		return NULL;
+	}
+
+	void FreeDataPack(void *pack) override
+	{
+	}
+
+	HandleType_t GetDataPackHandleType(bool readonly) override
+	{
+		return 0;
+	}
+
+	KeyValues *ReadKeyValuesHandle(Handle_t hndl, HandleError *err, bool root) override
+	{
+		if (err)
+		{
+			*err = HandleError_Type;
+		}
+		return NULL;
+	}
+
+	const char *GetGameFolderName() const override
+	{
+		return s_GameFolder.c_str();
+	}
+
+	ISourcePawnEngine *GetScriptingEngine() override
+	{
+		return s_SourcePawn;
+	}
+
+	IVirtualMachine *GetScriptingVM() override
+	{
+		return NULL;
+	}
+
+	time_t GetAdjustedTime() override
+	{
+		return time(NULL);
+	}
+
+	unsigned int SetGlobalTarget(unsigned int index) override
+	{
+		unsigned int old = s_GlobalTarget;
+		s_GlobalTarget = index;
+		return old;
+	}
+
+	unsigned int GetGlobalTarget() const override
+	{
+		return s_GlobalTarget;
+	}
+
+	void AddGameFrameHook(GAME_FRAME_HOOK hook) override
+	{
+		s_FrameHooks.push_back(hook);
+	}
+
+	void RemoveGameFrameHook(GAME_FRAME_HOOK hook) override
+	{
+		for (size_t i = 0; i < s_FrameHooks.size(); i++)
+		{
+			if (s_FrameHooks[i] == hook)
+			{
+				s_FrameHooks.erase(s_FrameHooks.begin() + i);
+				return;
+			}
+		}
+	}
+
+	size_t Format(char *buffer, size_t maxlength, const char *fmt, ...) override
+	{
+		va_list ap;
+		va_start(ap, fmt);
+		size_t len = ke::SafeVsprintf(buffer, maxlength, fmt, ap);
+		va_end(ap);
+		return len;
+	}
+
+	size_t FormatArgs(char *buffer, size_t maxlength, const char *fmt, va_list ap) override
+	{
+		return ke::SafeVsprintf(buffer, maxlength, fmt, ap);
+	}
+
+	void AddFrameAction(FRAMEACTION fn, void *data) override
+	{
+		s_FrameActions.push_back(std::make_pair(fn, data));
+	}
+
+	const char *GetCoreConfigValue(const char *key) override
+	{
+		auto iter = s_ConfigValues.find(key);
+		if (iter == s_ConfigValues.end())
+		{
+			return NULL;
+		}
+		return iter->second.c_str();
+	}
+
+	int GetPluginId() override
+	{
+		return 0;
+	}
+
+	int GetShApiVersion() override
+	{
+		return 0;
+	}
+
+	bool IsMapRunning() override
+	{
+		return s_MapRunning;
+	}
+
+	void *FromPseudoAddress(uint32_t pseudoAddr) override
+	{
+		return logicore.FromPseudoAddress(pseudoAddr);
+	}
+
+	uint32_t ToPseudoAddress(void *addr) override
+	{
+		return logicore.ToPseudoAddress(addr);
+	}
+
+	void PostToGameThread(FRAMEACTION fn, void *data) override
+	{
+		std::lock_guard<std::mutex> lock(s_PostedLock);
+		s_PostedActions.push_back(std::make_pair(fn, data));
+	}
+
+	bool IsProfilingActive() override
+	{
+		return logicore.IsProfilingActive();
+	}
+
+	void EnterProfileScope(const char *group, const char *name) override
+	{
+		logicore.EnterProfileScope(group, name);
+	}
+
+	void LeaveProfileScope() override
+	{
+		logicore.LeaveProfileScope();
+	}
+} s_SourceMod;
+
+ISourceMod *GetHarnessSourceMod()
+{
+	return &s_SourceMod;
+}
+
+class HarnessEngine : public IVEngineServerBridge
+{
+public:
+	bool IsDedicatedServer() override
+	{
+		return true;
+	}
+
+	void InsertServerCommand(const char *cmd) override
+	{
+		s_ServerCommands.insert(s_ServerCommands.begin(), cmd);
+	}
+
+	void ServerCommand(const char *cmd) override
+	{
+		s_ServerCommands.push_back(cmd);
+	}
+
+	void ServerExecute() override
+	{
+		ExecuteServerCommands();
+	}
+
+	const char *GetClientConVarValue(int clientIndex, const char *name) override
+	{
+		return "";
+	}
+
+	void ClientCommand(edict_t *pEdict, const char *szCommand) override
+	{
+	}
+
+	void FakeClientCommand(edict_t *pEdict, const char *szCommand) override
+	{
+		RunClientCommand(GetGameHelpers()->IndexOfEdict(pEdict), szCommand);
+	}
+} s_Engine;
+
+/**
+ * Plain stdio, rooted at the game path. There is no search path or VPK
+ * support; the Valve filesystem natives only see loose files.
+ */
+class HarnessFileSystem : public IFileSystemBridge
+{
+public:
+	const char *FindFirstEx(const char *pWildCard, const char *pPathID, FileFindHandle_t *pHandle) override
+	{
+		*pHandle = -1;
+		return NULL;
+	}
+
+	const char *FindNext(FileFindHandle_t handle) override
+	{
+		return NULL;
+	}
+
+	bool FindIsDirectory(FileFindHandle_t handle) override
+	{
+		return false;
+	}
+
+	void FindClose(FileFindHandle_t handle) override
+	{
+	}
+
+	FileHandle_t Open(const char *pFileName, const char *pOptions, const char *pathID) override
+	{
+		return fopen(Resolve(pFileName).c_str(), pOptions);
+	}
+
+	void Close(FileHandle_t file) override
+	{
+		fclose((FILE *)file);
+	}
+
+	char *ReadLine(char *pOutput, int maxChars, FileHandle_t file) override
+	{
+		return fgets(pOutput, maxChars, (FILE *)file);
+	}
+
+	bool EndOfFile(FileHandle_t file) override
+	{
+		return feof((FILE *)file) != 0;
+	}
+
+	bool FileExists(const char *pFileName, const char *pPathID) override
+	{
+		struct stat s;
+		return stat(Resolve(pFileName).c_str(), &s) == 0;
+	}
+
+	unsigned int Size(FileHandle_t file) override
+	{
+		FILE *fp = (FILE *)file;
+		long pos = ftell(fp);
+		fseek(fp, 0, SEEK_END);
+		long size = ftell(fp);
+		fseek(fp, pos, SEEK_SET);
+		return (unsigned int)size;
+	}
+
+	unsigned int Size(const char *pFileName, const char *pPathID) override
+	{
+		struct stat s;
+		if (stat(Resolve(pFileName).c_str(), &s) != 0)
+		{
+			return 0;
+		}
+		return (unsigned int)s.st_size;
+	}
+
+	int Read(void *pOutput, int size, FileHandle_t file) override
+	{
+		return (int)fread(pOutput, 1, size, (FILE *)file);
+	}
+
+	int Write(void const *pInput, int size, FileHandle_t file) override
+	{
+		return (int)fwrite(pInput, 1, size, (FILE *)file);
+	}
+
+	void Seek(FileHandle_t file, int pos, int seekType) override
+	{
+		fseek((FILE *)file, pos, seekType);
+	}
+
+	unsigned int Tell(FileHandle_t file) override
+	{
+		return (unsigned int)ftell((FILE *)file);
+	}
+
+	int FPrint(FileHandle_t file, const char *pData) override
+	{
+		return fputs(pData, (FILE *)file);
+	}
+
+	void Flush(FileHandle_t file) override
+	{
+		fflush((FILE *)file);
+	}
+
+	bool IsOk(FileHandle_t file) override
+	{
+		return file && !ferror((FILE *)file);
+	}
+
+	void RemoveFile(const char *pRelativePath, const char *pathID) override
+	{
+		remove(Resolve(pRelativePath).c_str());
+	}
+
+	void RenameFile(char const *pOldPath, char const *pNewPath, const char *pathID) override
+	{
+		rename(Resolve(pOldPath).c_str(), Resolve(pNewPath).c_str());
+	}
+
+	bool IsDirectory(const char *pFileName, const char *pathID) override
+	{
+		struct stat s;
+		if (stat(Resolve(pFileName).c_str(), &s) != 0)
+		{
+			return false;
+		}
+		return (s.st_mode & S_IFDIR) != 0;
+	}
+
+	void CreateDirHierarchy(const char *path, const char *pathID) override
+	{
+		std::string full = Resolve(path);
+		for (size_t i = s_GamePath.size() + 1; i <= full.size(); i++)
+		{
+			if (i == full.size() || full[i] == '/')
+			{
+				std::string part = full.substr(0, i);
+#if defined _WIN32
+				_mkdir(part.c_str());
+#else
+				mkdir(part.c_str(), 0775);
+#endif
+			}
+		}
+	}
+
+	int GetSearchPath(const char *pathID, bool bGetPackFiles, char *pPath, int nMaxLen) override
+	{
+		return (int)ke::SafeSprintf(pPath, nMaxLen, "%s/", s_GamePath.c_str()) + 1;
+	}
+
+	const char *GetGameBinArchSubdirectory() override
+	{
+		return "";
+	}
+
+private:
+	std::string Resolve(const char *path)
+	{
+		return s_GamePath + "/" + path;
+	}
+} s_FileSystem;
+
+/**
+ * Menus live in core and need the engine's menu and radio message support, so
+ * they are not simulated. A plugin that builds a menu during a replay stops the
+ * run here instead of crashing inside logic.
+ */
+class HarnessMenus : public IMenuManager
+{
+public:
+	IMenuStyle *FindStyleByName(const char *name) override
+	{
+		Unsupported();
+		return NULL;
+	}
+
+	IMenuStyle *GetDefaultStyle() override
+	{
+		Unsupported();
+		return NULL;
+	}
+
+	IMenuPanel *RenderMenu(int client, menu_states_t &states, ItemOrder order) override
+	{
+		Unsupported();
+		return NULL;
+	}
+
+	void CancelMenu(IBaseMenu *menu) override
+	{
+	}
+
+	bool StartVote(IBaseMenu *menu, unsigned int num_clients, int clients[], unsigned int max_time, unsigned int flags) override
+	{
+		return false;
+	}
+
+	bool IsVoteInProgress() override
+	{
+		return false;
+	}
+
+	void CancelVoting() override
+	{
+	}
+
+	unsigned int GetRemainingVoteDelay() override
+	{
+		return 0;
+	}
+
+	bool IsClientInVotePool(int client) override
+	{
+		return false;
+	}
+
+	bool RedrawClientVoteMenu(int client) override
+	{
+		return false;
+	}
+
+	bool RedrawClientVoteMenu2(int client, bool revotes) override
+	{
+		return false;
+	}
+
+private:
+	void Unsupported()
+	{
+		fprintf(stderr, "Menus are not available in the harness; remove menu use from the plugins under test.\n");
+		exit(1);
+	}
+} s_Menus;
+
+static const char *get_core_config_value(const char *key)
+{
+	return s_SourceMod.GetCoreConfigValue(key);
+}
+
+static void do_global_plugin_loads()
+{
+	char config_path[PLATFORM_MAX_PATH];
+	char plugins_path[PLATFORM_MAX_PATH];
+
+	s_SourceMod.BuildPath(Path_SM, config_path, sizeof(config_path), "configs/plugin_settings.cfg");
+	s_SourceMod.BuildPath(Path_SM, plugins_path, sizeof(plugins_path), "plugins");
+
+	logicore.scripts->LoadAll(config_path, plugins_path);
+}
+
+static bool are_configs_executed()
+{
+	return s_ConfigsExecuted;
+}
+
+static void execute_configs(IPluginContext *ctx)
+{
+	/* Plugins loaded after the map started still see OnConfigsExecuted. */
+	IPluginFunction *func;
+	if (s_ConfigsExecuted && (func = ctx->GetFunctionByName("OnConfigsExecuted")) != NULL)
+	{
+		func->CallFunction(NULL, 0, NULL);
+	}
+}
+
+static void get_db_info_from_key_values(KeyValues *kv, DatabaseInfo *info)
+{
+	/* Database configs are read through KeyValues, which needs the SDK. */
+}
+
+static int get_activity_flags()
+{
+	return 0;
+}
+
+static int get_immunity_mode()
+{
+	return 0;
+}
+
+static void update_admin_cmd_flags(const char *cmd, OverrideType type, FlagBits bits, bool remove)
+{
+}
+
+static bool look_for_cmd_admin_flags(const char *cmd, FlagBits *pFlags)
+{
+	return false;
+}
+
+static int get_global_target()
+{
+	return s_GlobalTarget;
+}
+
+static void record_startup_step(const char *name, double ms)
+{
+}
+
+static size_t get_timer_count()
+{
+	return s_Timers.GetTimerCount();
+}
+
+static void fast_con_print(const char *message)
+{
+	fputs(message, stdout);
+}
+
+static const char *fast_get_client_name(int client)
+{
+	return ClientName(client);
+}
+
+static const char *fast_get_client_convar_value(int client, const char *name)
+{
+	return "";
+}
+
+static const char *fast_get_cvar_string(ConVar *cvar)
+{
+	return "";
+}
+
+class HarnessProvider : public CoreProvider
+{
+public:
+	HarnessProvider()
+	{
+		this->sm = &s_SourceMod;
+		this->engine = &s_Engine;
+		this->filesystem = &s_FileSystem;
+		this->playerInfo = NULL;
+		this->timersys = &s_Timers;
+		this->playerhelpers = NULL;
+		this->gamehelpers = NULL;
+		this->menus = &s_Menus;
+		this->spe1 = &s_SourcePawn;
+		this->spe2 = &s_SourcePawn2;
+		this->gamesuffix = "2.mock";
+		this->serverGlobals = &s_ServerGlobals;
+		this->listeners = NULL;
+		this->GetCoreConfigValue = get_core_config_value;
+		this->DoGlobalPluginLoads = do_global_plugin_loads;
+		this->AreConfigsExecuted = are_configs_executed;
+		this->ExecuteConfigs = execute_configs;
+		this->GetDBInfoFromKeyValues = get_db_info_from_key_values;
+		this->GetActivityFlags = get_activity_flags;
+		this->GetImmunityMode = get_immunity_mode;
+		this->UpdateAdminCmdFlags = update_admin_cmd_flags;
+		this->LookForCommandAdminFlags = look_for_cmd_admin_flags;
+		this->GetGlobalTarget = get_global_target;
+		this->RecordStartupStep = record_startup_step;
+		this->GetTimerCount = get_timer_count;
+		this->maxClients = NULL;
+		this->FastConPrint = fast_con_print;
+		this->FastGetClientName = fast_get_client_name;
+		this->FastGetClientConVarValue = fast_get_client_convar_value;
+		this->FastGetCvarString = fast_get_cvar_string;
+	}
+
+	/* Engine convars are not simulated; plugin convars live in the harness natives. */
+	ConVar *FindConVar(const char *name) override
+	{
+		return NULL;
+	}
+
+	const char *GetCvarString(ConVar *cvar) override
+	{
+		return "";
+	}
+
+	bool GetCvarBool(ConVar *cvar) override
+	{
+		return false;
+	}
+
+	void DefineCommand(const char *cmd, const char *help, const CommandFunc &callback) override
+	{
+		s_Commands[cmd] = callback;
+	}
+
+	bool GetGameName(char *buffer, size_t maxlength) override
+	{
+		ke::SafeStrcpy(buffer, maxlength, s_GameFolder.c_str());
+		return true;
+	}
+
+	const char *GetGameDescription() override
+	{
+		return "SourceMod harness";
+	}
+
+	const char *GetSourceEngineName() override
+	{
+		return "mock";
+	}
+
+	bool SymbolsAreHidden() override
+	{
+		return false;
+	}
+
+	bool IsMapLoading() override
+	{
+		return s_MapLoading;
+	}
+
+	bool IsMapRunning() override
+	{
+		return s_MapRunning;
+	}
+
+	int MaxClients() override
+	{
+		return HarnessMaxClients();
+	}
+
+	bool DescribePlayer(int entRef, const char **namep, const char **authp, int *useridp) override
+	{
+		IGamePlayer *player = GetPlayerManager()->GetGamePlayer(entRef);
+		if (!player || !player->IsConnected())
+		{
+			return false;
+		}
+
+		if (namep)
+		{
+			*namep = player->GetName();
+		}
+		if (authp)
+		{
+			const char *auth = player->GetAuthString();
+			*authp = (auth && *auth) ? auth : "STEAM_ID_PENDING";
+		}
+		if (useridp)
+		{
+			*useridp = player->GetUserId();
+		}
+		return true;
+	}
+
+	void LogToGame(const char *message) override
+	{
+		fputs(message, stdout);
+	}
+
+	void ConPrint(const char *message) override
+	{
+		fputs(message, stdout);
+	}
+
+	void ConsolePrint(const char *fmt, ...) override
+	{
+		va_list ap;
+		va_start(ap, fmt);
+		ConsolePrintVa(fmt, ap);
+		va_end(ap);
+	}
+
+	void ConsolePrintVa(const char *fmt, va_list ap) override
+	{
+		char buffer[512];
+		ke::SafeVsprintf(buffer, sizeof(buffer), fmt, ap);
+		fprintf(stdout, "%s\n", buffer);
+	}
+
+	void FormatSourceBinaryName(const char *basename, char *buffer, size_t maxlength) override
+	{
+		ke::SafeSprintf(buffer, maxlength, "%s." PLATFORM_LIB_EXT, basename);
+	}
+
+	bool IsClientConVarQueryingSupported() override
+	{
+		return false;
+	}
+
+	int QueryClientConVar(int client, const char *cvar) override
+	{
+		return -1;
+	}
+
+	int LoadMMSPlugin(const char *file, bool *ok, char *error, size_t maxlength) override
+	{
+		ke::SafeStrcpy(error, maxlength, "Metamod:Source is not available in the harness");
+		*ok = false;
+		return 0;
+	}
+
+	void UnloadMMSPlugin(int id) override
+	{
+	}
+} s_Provider;
+
+bool LoadLogic(const char *sm_path, const char *game, char *error, size_t maxlength)
+{
+	char file[PLATFORM_MAX_PATH];
+	char myerror[255];
+
+	s_SMPath = sm_path;
+	s_GameFolder = game;
+
+	/* The usual install layout is <game>/addons/sourcemod. */
+	char game_path[PLATFORM_MAX_PATH];
+	ke::path::Format(game_path, sizeof(game_path), "%s/../..", sm_path);
+	s_GamePath = game_path;
+	s_SMRelPath = "addons/sourcemod";
+
+	ke::path::Format(file, sizeof(file), "%s/bin/" PLATFORM_ARCH_FOLDER "sourcemod.logic." PLATFORM_LIB_EXT, sm_path);
+	s_Logic = ke::SharedLib::Open(file, myerror, sizeof(myerror));
+	if (!s_Logic)
+	{
+		ke::SafeSprintf(error, maxlength, "failed to load %s: %s", file, myerror);
+		return false;
+	}
+
+	LogicLoadFunction llf = s_Logic->get<decltype(llf)>("logic_load");
+	GetITextParsers getitxt = s_Logic->get<decltype(getitxt)>("get_textparsers");
+	if (!llf || !getitxt)
+	{
+		ke::SafeStrcpy(error, maxlength, "could not find logic_load function");
+		return false;
+	}
+
+	s_TextParsers = getitxt();
+	s_LogicInit = llf(SM_LOGIC_MAGIC);
+	if (!s_LogicInit)
+	{
+		ke::SafeStrcpy(error, maxlength, "component version mismatch");
+		return false;
+	}
+
+	ke::path::Format(file, sizeof(file), "%s/bin/" PLATFORM_ARCH_FOLDER SOURCEPAWN_DLL "." PLATFORM_LIB_EXT, sm_path);
+	s_JIT = ke::SharedLib::Open(file, myerror, sizeof(myerror));
+	if (!s_JIT)
+	{
+		ke::SafeSprintf(error, maxlength, "failed to load %s: %s", file, myerror);
+		return false;
+	}
+
+	GetSourcePawnFactoryFn factoryFn = s_JIT->get<decltype(factoryFn)>("GetSourcePawnFactory");
+	ISourcePawnFactory *factory = factoryFn ? factoryFn(SOURCEPAWN_API_VERSION) : NULL;
+	if (!factory || (s_PawnEnv = factory->NewEnvironment()) == NULL)
+	{
+		ke::SafeStrcpy(error, maxlength, "SourcePawn library is out of date");
+		return false;
+	}
+
+	s_SourcePawn = s_PawnEnv->APIv1();
+	s_SourcePawn2 = s_PawnEnv->APIv2();
+
+	s_ServerGlobals.universalTime = &g_Clock.now;
+	s_ServerGlobals.interval_per_tick = &g_Clock.interval;
+	s_ServerGlobals.frametime = &g_Clock.frametime;
+
+	s_Provider.playerhelpers = GetPlayerManager();
+	s_Provider.gamehelpers = GetGameHelpers();
+	s_Provider.playerInfo = GetPlayerInfoBridge();
+	s_Provider.maxClients = HarnessMaxClientsPtr();
+
+	s_LogicInit(&s_Provider, &logicore);
+	s_SourcePawn2->SetDebugListener(logicore.debugger);
+
+	/* Same startup sequence as core, minus the engine hooks. Values given on
+	 * the command line win over core.cfg.
+	 */
+	ParseCoreConfig();
+	for (auto iter = s_ConfigOverrides.begin(); iter != s_ConfigOverrides.end(); iter++)
+	{
+		SetCoreConfigValue(iter->first.c_str(), iter->second.c_str());
+	}
+
+	for (SMGlobalClass *pBase = logicore.head; pBase; pBase = pBase->m_pGlobalClassNext)
+	{
+		pBase->OnSourceModStartup(false);
+	}
+	for (SMGlobalClass *pBase = logicore.head; pBase; pBase = pBase->m_pGlobalClassNext)
+	{
+		if (pBase->HasPreloadWork())
+		{
+			pBase->OnSourceModPreload();
+		}
+	}
+	for (SMGlobalClass *pBase = logicore.head; pBase; pBase = pBase->m_pGlobalClassNext)
+	{
+		pBase->OnSourceModAllInitialized();
+	}
+	for (SMGlobalClass *pBase = logicore.head; pBase; pBase = pBase->m_pGlobalClassNext)
+	{
+		pBase->OnSourceModAllInitialized_Post();
+	}
+
+	RegisterHarnessNatives();
+	CreateHarnessForwards();
+	RegisterHarnessProfiler();
+
+	const char *timeout = s_SourceMod.GetCoreConfigValue("SlowScriptTimeout");
+	if (timeout && atoi(timeout) != 0)
+	{
+		s_SourcePawn2->InstallWatchdogTimer(atoi(timeout) * 1000);
+	}
+
+	return true;
+}
+
+void ShutdownLogic()
+{
+	if (s_MapRunning)
+	{
+		EndMap();
+	}
+	DisconnectAllClients();
+
+	logicore.scripts->Shutdown();
+	logicore.extsys->Shutdown();
+	ReleaseHarnessForwards();
+
+	for (SMGlobalClass *pBase = logicore.head; pBase; pBase = pBase->m_pGlobalClassNext)
+	{
+		pBase->OnSourceModShutdown();
+	}
+	for (SMGlobalClass *pBase = logicore.head; pBase; pBase = pBase->m_pGlobalClassNext)
+	{
+		pBase->OnSourceModAllShutdown();
+	}
+
+	s_Timers.KillAll();
+
+	if (s_PawnEnv)
+	{
+		s_PawnEnv->Shutdown();
+		delete s_PawnEnv;
+		s_PawnEnv = NULL;
+		s_SourcePawn = NULL;
+		s_SourcePawn2 = NULL;
+	}
+	s_JIT = nullptr;
+	s_Logic = nullptr;
+}
+
+class CoreConfigReader : public ITextListener_SMC
+{
+public:
+	SMCResult ReadSMC_KeyValue(const SMCStates *states, const char *key, const char *value) override
+	{
+		char error[255];
+		if (SetConfigOption(key, value, ConfigSource_File, error, sizeof(error)) == ConfigResult_Reject)
+		{
+			fprintf(stderr, "Config error (key: %s) (value: %s) %s\n", key, value, error);
+		}
+		return SMCResult_Continue;
+	}
+};
+
+bool ParseCoreConfig()
+{
+	char path[PLATFORM_MAX_PATH];
+	s_SourceMod.BuildPath(Path_SM, path, sizeof(path), "configs/core.cfg");
+
+	CoreConfigReader reader;
+	SMCError err = s_TextParsers->ParseFile_SMC(path, &reader, NULL);
+	if (err != SMCError_Okay)
+	{
+		const char *msg = s_TextParsers->GetSMCErrorString(err);
+		fprintf(stderr, "Error parsing %s: %s\n", path, msg ? msg : "");
+		return false;
+	}
+	return true;
+}
+
+void SetCoreConfigValue(const char *key, const char *value)
+{
+	if (!logicore.head)
+	{
+		/* Not loaded yet; applied after core.cfg is parsed. */
+		s_ConfigOverrides[key] = value;
+		return;
+	}
+
+	char error[255];
+	if (SetConfigOption(key, value, ConfigSource_Console, error, sizeof(error)) == ConfigResult_Reject)
+	{
+		fprintf(stderr, "Config error (key: %s) (value: %s) %s\n", key, value, error);
+	}
+}
+
+const char *CurrentMap()
+{
+	return s_MapName.c_str();
+}
+
+bool IsMapRunning()
+{
+	return s_MapRunning;
+}
+
+void StartMap(const char *map)
+{
+	if (s_MapRunning)
+	{
+		EndMap();
+	}
+
+	s_MapName = map;
+	s_MapLoading = true;
+
+	for (SMGlobalClass *pBase = logicore.head; pBase; pBase = pBase->m_pGlobalClassNext)
+	{
+		pBase->OnSourceModLevelChange(map);
+	}
+
+	do_global_plugin_loads();
+	s_MapLoading = false;
+
+	for (SMGlobalClass *pBase = logicore.head; pBase; pBase = pBase->m_pGlobalClassNext)
+	{
+		pBase->OnSourceModPluginsLoaded();
+	}
+
+	NotifyServerActivated();
+	for (SMGlobalClass *pBase = logicore.head; pBase; pBase = pBase->m_pGlobalClassNext)
+	{
+		pBase->OnSourceModLevelActivated();
+	}
+
+	s_MapRunning = true;
+	OnHarnessMapStart();
+
+	s_ConfigsExecuted = true;
+	OnHarnessConfigsExecuted();
+
+	RefreshPluginOwners();
+}
+
+void EndMap()
+{
+	for (SMGlobalClass *pBase = logicore.head; pBase; pBase = pBase->m_pGlobalClassNext)
+	{
+		pBase->OnSourceModLevelEnd();
+	}
+	OnHarnessMapEnd();
+	s_Timers.RemoveMapChangeTimers();
+
+	s_MapRunning = false;
+	s_ConfigsExecuted = false;
+
+	logicore.scripts->RefreshAll();
+}
+
+void RunFrame()
+{
+	g_Clock.tick++;
+	g_Clock.now += g_Clock.interval;
+	g_Clock.frametime = g_Clock.interval;
+
+	/* Same order as a server frame: timers, frame hooks and actions, then
+	 * OnGameFrame, then logic's think.
+	 */
+	s_Timers.RunFrame();
+
+	for (size_t i = 0; i < s_FrameHooks.size(); i++)
+	{
+		s_FrameHooks[i](true);
+	}
+	RunFrameActions();
+
+	OnHarnessGameFrame();
+	logicore.callbacks->OnThink(true);
+
+	ExecuteServerCommands();
+}
+
+bool RunServerCommand(const char *line)
+{
+	HarnessArgs args(line);
+	if (!args.ArgC())
+	{
+		return true;
+	}
+
+	auto iter = s_Commands.find(args.Arg(0));
+	if (iter != s_Commands.end())
+	{
+		iter->second(0, &args);
+		return true;
+	}
+
+	return RunClientCommand(0, line);
+}
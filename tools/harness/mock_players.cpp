@@ -0,0 +1,1136 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <amtl/am-string.h>
+#include <IAdminSystem.h>
+#include <IGameHelpers.h>
+#include <IPlayerHelpers.h>
+#include <bridge/include/IPlayerInfoBridge.h>
+#include "harness.h"
+
+#define STEAMID64_BASE		76561197960265728ULL
+
+static int s_MaxClients = 32;
+static unsigned int s_SerialCount = 1;
+static unsigned int s_ReplyTo = 0;
+
+/* Stand-ins for edict_t; only their addresses are ever used. */
+static uint32_t s_Edicts[SM_MAXPLAYERS + 1];
+
+class HarnessPlayer : public IGamePlayer
+{
+public:
+	HarnessPlayer()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		index = 0;
+		userid = 0;
+		serial = 0;
+		connected = false;
+		in_game = false;
+		authorized = false;
+		fake = false;
+		alive = false;
+		kick_queued = false;
+		team = 0;
+		frags = 0;
+		deaths = 0;
+		language = 0;
+		admin = INVALID_ADMIN_ID;
+		temp_admin = false;
+		account = 0;
+		name.clear();
+		auth.clear();
+		steam3.clear();
+		steam64.clear();
+	}
+
+	void SetAuth(const char *id)
+	{
+		auth = id;
+		account = 0;
+
+		/* STEAM_X:Y:Z, where the account id is Z * 2 + Y. */
+		unsigned int universe, y, z;
+		if (sscanf(id, "STEAM_%u:%u:%u", &universe, &y, &z) == 3)
+		{
+			account = z * 2 + y;
+		}
+
+		char buffer[64];
+		ke::SafeSprintf(buffer, sizeof(buffer), "[U:1:%u]", account);
+		steam3 = buffer;
+		ke::SafeSprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)GetSteamId64(false));
+		steam64 = buffer;
+	}
+
+	const char *GetName() override
+	{
+		return name.c_str();
+	}
+
+	const char *GetIPAddress() override
+	{
+		return fake ? "" : "127.0.0.1";
+	}
+
+	const char *GetAuthString(bool validated) override
+	{
+		if (validated && !authorized)
+		{
+			return NULL;
+		}
+		return auth.c_str();
+	}
+
+	edict_t *GetEdict() override
+	{
+		return reinterpret_cast<edict_t *>(&s_Edicts[index]);
+	}
+
+	bool IsInGame() override
+	{
+		return in_game;
+	}
+
+	bool IsConnected() override
+	{
+		return connected;
+	}
+
+	bool IsFakeClient() override
+	{
+		return fake;
+	}
+
+	AdminId GetAdminId() override
+	{
+		return admin;
+	}
+
+	void SetAdminId(AdminId id, bool temp) override
+	{
+		admin = id;
+		temp_admin = temp;
+	}
+
+	int GetUserId() override
+	{
+		return userid;
+	}
+
+	unsigned int GetLanguageId() override
+	{
+		return language;
+	}
+
+	IPlayerInfo *GetPlayerInfo() override
+	{
+		return in_game ? reinterpret_cast<IPlayerInfo *>(this) : NULL;
+	}
+
+	bool RunAdminCacheChecks() override
+	{
+		if (fake || !authorized || admin != INVALID_ADMIN_ID)
+		{
+			return false;
+		}
+
+		AdminId id = logicore.adminsys->FindAdminByIdentity("steam", auth.c_str());
+		if (id == INVALID_ADMIN_ID)
+		{
+			return false;
+		}
+
+		SetAdminId(id, false);
+		return true;
+	}
+
+	void NotifyPostAdminChecks() override
+	{
+		OnHarnessClientPostAdminCheck(index);
+	}
+
+	unsigned int GetSerial() override
+	{
+		return serial;
+	}
+
+	bool IsAuthorized() override
+	{
+		return authorized;
+	}
+
+	void Kick(const char *message) override
+	{
+		DisconnectClient(index);
+	}
+
+	bool IsInKickQueue() override
+	{
+		return kick_queued;
+	}
+
+	void MarkAsBeingKicked() override
+	{
+		kick_queued = true;
+	}
+
+	void SetLanguageId(unsigned int id) override
+	{
+		language = id;
+	}
+
+	bool IsSourceTV() const override
+	{
+		return false;
+	}
+
+	bool IsReplay() const override
+	{
+		return false;
+	}
+
+	unsigned int GetSteamAccountID(bool validated) override
+	{
+		if (validated && !authorized)
+		{
+			return 0;
+		}
+		return account;
+	}
+
+	int GetIndex() const override
+	{
+		return index;
+	}
+
+	void PrintToConsole(const char *pMsg) override
+	{
+	}
+
+	void ClearAdmin() override
+	{
+		admin = INVALID_ADMIN_ID;
+		temp_admin = false;
+	}
+
+	uint64_t GetSteamId64(bool validated) override
+	{
+		if ((validated && !authorized) || !account)
+		{
+			return 0;
+		}
+		return STEAMID64_BASE + account;
+	}
+
+	const char *GetSteam2Id(bool validated) override
+	{
+		return GetAuthString(validated);
+	}
+
+	const char *GetSteam3Id(bool validated) override
+	{
+		if (validated && !authorized)
+		{
+			return NULL;
+		}
+		return steam3.c_str();
+	}
+
+	unsigned int GetOriginalLanguageId() override
+	{
+		return 0;
+	}
+
+	const char *GetSteamId64String(bool validated) override
+	{
+		if (validated && !authorized)
+		{
+			return NULL;
+		}
+		return steam64.c_str();
+	}
+
+public:
+	int index;
+	int userid;
+	unsigned int serial;
+	bool connected;
+	bool in_game;
+	bool authorized;
+	bool fake;
+	bool alive;
+	bool kick_queued;
+	int team;
+	int frags;
+	int deaths;
+	unsigned int language;
+	AdminId admin;
+	bool temp_admin;
+	unsigned int account;
+	std::string name;
+	std::string auth;
+	std::string steam3;
+	std::string steam64;
+};
+
+static HarnessPlayer s_Players[SM_MAXPLAYERS + 1];
+
+static inline HarnessPlayer *PlayerFromInfo(IPlayerInfo *pInfo)
+{
+	return reinterpret_cast<HarnessPlayer *>(pInfo);
+}
+
+class HarnessPlayerManager : public IPlayerManager
+{
+public:
+	void AddClientListener(IClientListener *listener) override
+	{
+		listeners_.push_back(listener);
+	}
+
+	void RemoveClientListener(IClientListener *listener) override
+	{
+		for (size_t i = 0; i < listeners_.size(); i++)
+		{
+			if (listeners_[i] == listener)
+			{
+				listeners_.erase(listeners_.begin() + i);
+				return;
+			}
+		}
+	}
+
+	IGamePlayer *GetGamePlayer(int client) override
+	{
+		if (client < 1 || client > s_MaxClients)
+		{
+			return NULL;
+		}
+		return &s_Players[client];
+	}
+
+	IGamePlayer *GetGamePlayer(edict_t *pEdict) override
+	{
+		return GetGamePlayer(GetGameHelpers()->IndexOfEdict(pEdict));
+	}
+
+	int GetMaxClients() override
+	{
+		return s_MaxClients;
+	}
+
+	int GetNumPlayers() override
+	{
+		int count = 0;
+		for (int i = 1; i <= s_MaxClients; i++)
+		{
+			if (s_Players[i].connected)
+			{
+				count++;
+			}
+		}
+		return count;
+	}
+
+	int GetClientOfUserId(int userid) override
+	{
+		return ClientOfUserId(userid);
+	}
+
+	bool IsServerActivated() override
+	{
+		return true;
+	}
+
+	unsigned int GetReplyTo() override
+	{
+		return s_ReplyTo;
+	}
+
+	unsigned int SetReplyTo(unsigned int reply) override
+	{
+		unsigned int old = s_ReplyTo;
+		s_ReplyTo = reply;
+		return old;
+	}
+
+	int FilterCommandTarget(IGamePlayer *pAdmin, IGamePlayer *pTarget, int flags) override
+	{
+		HarnessPlayer *target = static_cast<HarnessPlayer *>(pTarget);
+
+		if ((flags & COMMAND_FILTER_CONNECTED) != COMMAND_FILTER_CONNECTED && !target->in_game)
+		{
+			return COMMAND_TARGET_NOT_IN_GAME;
+		}
+		if ((flags & COMMAND_FILTER_NO_BOTS) == COMMAND_FILTER_NO_BOTS && target->fake)
+		{
+			return COMMAND_TARGET_NOT_HUMAN;
+		}
+		if ((flags & COMMAND_FILTER_ALIVE) == COMMAND_FILTER_ALIVE && !target->alive)
+		{
+			return COMMAND_TARGET_NOT_ALIVE;
+		}
+		if ((flags & COMMAND_FILTER_DEAD) == COMMAND_FILTER_DEAD && target->alive)
+		{
+			return COMMAND_TARGET_NOT_DEAD;
+		}
+		return COMMAND_TARGET_VALID;
+	}
+
+	void RegisterCommandTargetProcessor(ICommandTargetProcessor *pHandler) override
+	{
+		processors_.push_back(pHandler);
+	}
+
+	void UnregisterCommandTargetProcessor(ICommandTargetProcessor *pHandler) override
+	{
+		for (size_t i = 0; i < processors_.size(); i++)
+		{
+			if (processors_[i] == pHandler)
+			{
+				processors_.erase(processors_.begin() + i);
+				return;
+			}
+		}
+	}
+
+	int GetClientFromSerial(unsigned int serial) override
+	{
+		int client = serial & 0xFF;
+		if (client < 1 || client > s_MaxClients || s_Players[client].serial != serial)
+		{
+			return 0;
+		}
+		return client;
+	}
+
+	/**
+	 * The common patterns: #userid, #name, @me, @all, @bots, @humans, @alive,
+	 * @dead, and partial names. Immunity is not simulated.
+	 */
+	void ProcessCommandTarget(cmd_target_info_t *info) override
+	{
+		IGamePlayer *pAdmin = info->admin ? GetGamePlayer(info->admin) : NULL;
+
+		info->num_targets = 0;
+		info->reason = COMMAND_TARGET_NONE;
+		if (info->max_targets < 1)
+		{
+			return;
+		}
+
+		if (info->pattern[0] == '#')
+		{
+			int client = ClientOfUserId(atoi(&info->pattern[1]));
+			for (int i = 1; !client && i <= s_MaxClients; i++)
+			{
+				if (s_Players[i].connected && s_Players[i].name == &info->pattern[1])
+				{
+					client = i;
+				}
+			}
+			if (client)
+			{
+				SingleTarget(info, pAdmin, client);
+			}
+			return;
+		}
+
+		if (strcmp(info->pattern, "@me") == 0 && info->admin != 0)
+		{
+			SingleTarget(info, pAdmin, info->admin);
+			return;
+		}
+
+		if ((info->flags & COMMAND_FILTER_NO_MULTI) != COMMAND_FILTER_NO_MULTI && info->pattern[0] == '@')
+		{
+			int require = 0, exclude = 0;
+			bool alive = false, dead = false;
+			if (strcmp(info->pattern, "@bots") == 0)
+			{
+				require = 1;
+			}
+			else if (strcmp(info->pattern, "@humans") == 0)
+			{
+				exclude = 1;
+			}
+			else if (strcmp(info->pattern, "@alive") == 0)
+			{
+				alive = true;
+			}
+			else if (strcmp(info->pattern, "@dead") == 0)
+			{
+				dead = true;
+			}
+			else if (strcmp(info->pattern, "@all") != 0)
+			{
+				for (size_t i = 0; i < processors_.size(); i++)
+				{
+					if (processors_[i]->ProcessCommandTarget(info))
+					{
+						return;
+					}
+				}
+				return;
+			}
+
+			for (int i = 1; i <= s_MaxClients && info->num_targets < (unsigned int)info->max_targets; i++)
+			{
+				HarnessPlayer &player = s_Players[i];
+				if (!player.connected
+					|| (require && !player.fake)
+					|| (exclude && player.fake)
+					|| (alive && !player.alive)
+					|| (dead && player.alive))
+				{
+					continue;
+				}
+				if (FilterCommandTarget(pAdmin, &player, info->flags) == COMMAND_TARGET_VALID)
+				{
+					info->targets[info->num_targets++] = i;
+				}
+			}
+
+			info->reason = info->num_targets ? COMMAND_TARGET_VALID : COMMAND_TARGET_EMPTY_FILTER;
+			ke::SafeStrcpy(info->target_name, info->target_name_maxlength, &info->pattern[1]);
+			info->target_name_style = COMMAND_TARGETNAME_RAW;
+			return;
+		}
+
+		int found = 0;
+		for (int i = 1; i <= s_MaxClients; i++)
+		{
+			if (!s_Players[i].connected || !strstr(s_Players[i].name.c_str(), info->pattern))
+			{
+				continue;
+			}
+			if (found)
+			{
+				info->reason = COMMAND_TARGET_AMBIGUOUS;
+				return;
+			}
+			found = i;
+		}
+		if (found)
+		{
+			SingleTarget(info, pAdmin, found);
+		}
+	}
+
+	void ClearAdminId(AdminId id) override
+	{
+		for (int i = 1; i <= s_MaxClients; i++)
+		{
+			if (s_Players[i].admin == id)
+			{
+				s_Players[i].ClearAdmin();
+			}
+		}
+	}
+
+	void RecheckAnyAdmins() override
+	{
+		for (int i = 1; i <= s_MaxClients; i++)
+		{
+			if (s_Players[i].in_game && s_Players[i].RunAdminCacheChecks())
+			{
+				s_Players[i].NotifyPostAdminChecks();
+			}
+		}
+	}
+
+	unsigned int GetClientStateFlags(int client) override
+	{
+		if (client < 1 || client > s_MaxClients)
+		{
+			return 0;
+		}
+
+		HarnessPlayer &player = s_Players[client];
+		unsigned int flags = 0;
+		if (player.connected)
+		{
+			flags |= ClientState_Connected;
+		}
+		if (player.in_game)
+		{
+			flags |= ClientState_InGame;
+		}
+		if (player.fake)
+		{
+			flags |= ClientState_FakeClient;
+		}
+		if (player.authorized)
+		{
+			flags |= ClientState_Authorized;
+		}
+		return flags;
+	}
+
+	int GetClientsMatching(unsigned int flags, unsigned int exclude, int team, int *clients, int maxclients) override
+	{
+		int count = 0;
+		bool need_game = (flags & ClientState_Alive) || team >= 0;
+
+		for (int i = 1; i <= s_MaxClients && count < maxclients; i++)
+		{
+			HarnessPlayer &player = s_Players[i];
+			unsigned int state = GetClientStateFlags(i);
+			if (player.in_game && player.alive)
+			{
+				state |= ClientState_Alive;
+			}
+
+			if ((state & flags) != flags || (state & exclude))
+			{
+				continue;
+			}
+			if (need_game && !player.in_game)
+			{
+				continue;
+			}
+			if (team >= 0 && player.team != team)
+			{
+				continue;
+			}
+			clients[count++] = i;
+		}
+		return count;
+	}
+
+	int GetClientOfSteamId64(uint64_t steamId, bool validated) override
+	{
+		for (int i = 1; i <= s_MaxClients; i++)
+		{
+			if (s_Players[i].connected && steamId && s_Players[i].GetSteamId64(validated) == steamId)
+			{
+				return i;
+			}
+		}
+		return 0;
+	}
+
+	const std::vector<IClientListener *> &listeners() const
+	{
+		return listeners_;
+	}
+
+private:
+	void SingleTarget(cmd_target_info_t *info, IGamePlayer *pAdmin, int client)
+	{
+		IGamePlayer *pTarget = GetGamePlayer(client);
+		if ((info->reason = FilterCommandTarget(pAdmin, pTarget, info->flags)) != COMMAND_TARGET_VALID)
+		{
+			return;
+		}
+
+		info->targets[0] = client;
+		info->num_targets = 1;
+		ke::SafeStrcpy(info->target_name, info->target_name_maxlength, pTarget->GetName());
+		info->target_name_style = COMMAND_TARGETNAME_RAW;
+	}
+
+private:
+	std::vector<IClientListener *> listeners_;
+	std::vector<ICommandTargetProcessor *> processors_;
+} s_PlayerManager;
+
+class HarnessPlayerInfo : public IPlayerInfoBridge
+{
+public:
+	bool IsObserver(IPlayerInfo *pInfo) override
+	{
+		return PlayerFromInfo(pInfo)->team == 1;
+	}
+
+	int GetTeamIndex(IPlayerInfo *pInfo) override
+	{
+		return PlayerFromInfo(pInfo)->team;
+	}
+
+	int GetFragCount(IPlayerInfo *pInfo) override
+	{
+		return PlayerFromInfo(pInfo)->frags;
+	}
+
+	int GetDeathCount(IPlayerInfo *pInfo) override
+	{
+		return PlayerFromInfo(pInfo)->deaths;
+	}
+
+	int GetArmorValue(IPlayerInfo *pInfo) override
+	{
+		return 0;
+	}
+
+	void GetAbsOrigin(IPlayerInfo *pInfo, float *x, float *y, float *z) override
+	{
+		*x = *y = *z = 0.0f;
+	}
+
+	void GetAbsAngles(IPlayerInfo *pInfo, float *x, float *y, float *z) override
+	{
+		*x = *y = *z = 0.0f;
+	}
+
+	void GetPlayerMins(IPlayerInfo *pInfo, float *x, float *y, float *z) override
+	{
+		*x = *y = -16.0f;
+		*z = 0.0f;
+	}
+
+	void GetPlayerMaxs(IPlayerInfo *pInfo, float *x, float *y, float *z) override
+	{
+		*x = *y = 16.0f;
+		*z = 72.0f;
+	}
+
+	const char *GetWeaponName(IPlayerInfo *pInfo) override
+	{
+		return "";
+	}
+
+	const char *GetModelName(IPlayerInfo *pInfo) override
+	{
+		return "";
+	}
+
+	int GetHealth(IPlayerInfo *pInfo) override
+	{
+		return PlayerFromInfo(pInfo)->alive ? 100 : 0;
+	}
+
+	void ChangeTeam(IPlayerInfo *pInfo, int iTeamNum) override
+	{
+		PlayerFromInfo(pInfo)->team = iTeamNum;
+	}
+} s_PlayerInfo;
+
+/**
+ * There are no entities besides clients. Entity references are plain
+ * indexes, and everything that needs server classes or datamaps fails.
+ */
+class HarnessGameHelpers : public IGameHelpers
+{
+public:
+	SendProp *FindInSendTable(const char *classname, const char *offset) override
+	{
+		return NULL;
+	}
+
+	ServerClass *FindServerClass(const char *classname) override
+	{
+		return NULL;
+	}
+
+	typedescription_t *FindInDataMap(datamap_t *pMap, const char *offset) override
+	{
+		return NULL;
+	}
+
+	datamap_t *GetDataMap(CBaseEntity *pEntity) override
+	{
+		return NULL;
+	}
+
+	void SetEdictStateChanged(edict_t *pEdict, unsigned short offset) override
+	{
+	}
+
+	bool TextMsg(int client, int dest, const char *msg) override
+	{
+		return IsClientIndexConnected(client);
+	}
+
+	bool IsLANServer() override
+	{
+		return false;
+	}
+
+	bool FindSendPropInfo(const char *classname, const char *offset, sm_sendprop_info_t *info) override
+	{
+		return false;
+	}
+
+	edict_t *EdictOfIndex(int index) override
+	{
+		if (index < 0 || index > SM_MAXPLAYERS)
+		{
+			return NULL;
+		}
+		return reinterpret_cast<edict_t *>(&s_Edicts[index]);
+	}
+
+	int IndexOfEdict(edict_t *pEnt) override
+	{
+		uint32_t *slot = reinterpret_cast<uint32_t *>(pEnt);
+		if (slot < &s_Edicts[0] || slot > &s_Edicts[SM_MAXPLAYERS])
+		{
+			return -1;
+		}
+		return (int)(slot - &s_Edicts[0]);
+	}
+
+	edict_t *GetHandleEntity(CBaseHandle &hndl) override
+	{
+		return NULL;
+	}
+
+	void SetHandleEntity(CBaseHandle &hndl, edict_t *pEnt) override
+	{
+	}
+
+	const char *GetCurrentMap() override
+	{
+		return CurrentMap();
+	}
+
+	void ServerCommand(const char *buffer) override
+	{
+		RunServerCommand(buffer);
+	}
+
+	CBaseEntity *ReferenceToEntity(cell_t entRef) override
+	{
+		return NULL;
+	}
+
+	cell_t EntityToReference(CBaseEntity *pEntity) override
+	{
+		return -1;
+	}
+
+	cell_t EntityToBCompatRef(CBaseEntity *pEntity) override
+	{
+		return -1;
+	}
+
+	cell_t IndexToReference(int entIndex) override
+	{
+		return entIndex;
+	}
+
+	int ReferenceToIndex(cell_t entRef) override
+	{
+		return entRef;
+	}
+
+	cell_t ReferenceToBCompatRef(cell_t entRef) override
+	{
+		return entRef;
+	}
+
+	void *GetGlobalEntityList() override
+	{
+		return NULL;
+	}
+
+	void AddDelayedKick(int client, int userid, const char *msg) override
+	{
+		if (ClientOfUserId(userid) == client)
+		{
+			DisconnectClient(client);
+		}
+	}
+
+	int GetSendPropOffset(SendProp *prop) override
+	{
+		return -1;
+	}
+
+	bool HintTextMsg(int client, const char *msg) override
+	{
+		return IsClientIndexConnected(client);
+	}
+
+	ICommandLine *GetValveCommandLine() override
+	{
+		return NULL;
+	}
+
+	const char *GetEntityClassname(edict_t *pEdict) override
+	{
+		int index = IndexOfEdict(pEdict);
+		return IsClientIndexConnected(index) ? "player" : NULL;
+	}
+
+	const char *GetEntityClassname(CBaseEntity *pEntity) override
+	{
+		return NULL;
+	}
+
+	bool IsMapValid(const char *map) override
+	{
+		return true;
+	}
+
+	bool FindDataMapInfo(datamap_t *pMap, const char *offset, sm_datatable_info_t *pDataTable) override
+	{
+		return false;
+	}
+
+	bool GetServerSteam3Id(char *pszOut, size_t len) const override
+	{
+		return false;
+	}
+
+	uint64_t GetServerSteamId64() const override
+	{
+		return 0;
+	}
+
+	ServerClass *FindEntityServerClass(CBaseEntity *pEntity) override
+	{
+		return NULL;
+	}
+
+	void RemoveDataTableCache(datamap_t *pMap) override
+	{
+	}
+
+	bool RemoveSendPropCache(const char *classname) override
+	{
+		return false;
+	}
+} s_GameHelpers;
+
+IPlayerManager *GetPlayerManager()
+{
+	return &s_PlayerManager;
+}
+
+IGameHelpers *GetGameHelpers()
+{
+	return &s_GameHelpers;
+}
+
+IPlayerInfoBridge *GetPlayerInfoBridge()
+{
+	return &s_PlayerInfo;
+}
+
+void SetMaxClients(int maxClients)
+{
+	s_MaxClients = maxClients < 1 ? 1 : (maxClients > SM_MAXPLAYERS ? SM_MAXPLAYERS : maxClients);
+	if (logicore.scripts)
+	{
+		logicore.scripts->SyncMaxClients(s_MaxClients);
+	}
+
+	const std::vector<IClientListener *> &listeners = s_PlayerManager.listeners();
+	for (size_t i = 0; i < listeners.size(); i++)
+	{
+		listeners[i]->OnMaxPlayersChanged(s_MaxClients);
+	}
+}
+
+int HarnessMaxClients()
+{
+	return s_MaxClients;
+}
+
+const int *HarnessMaxClientsPtr()
+{
+	return &s_MaxClients;
+}
+
+bool IsClientIndexConnected(int client)
+{
+	return client >= 1 && client <= s_MaxClients && s_Players[client].connected;
+}
+
+bool IsClientIndexAlive(int client)
+{
+	return IsClientIndexConnected(client) && s_Players[client].in_game && s_Players[client].alive;
+}
+
+const char *ClientName(int client)
+{
+	if (!IsClientIndexConnected(client))
+	{
+		return NULL;
+	}
+	return s_Players[client].name.c_str();
+}
+
+int ClientOfUserId(int userid)
+{
+	for (int i = 1; i <= s_MaxClients; i++)
+	{
+		if (s_Players[i].connected && s_Players[i].userid == userid)
+		{
+			return i;
+		}
+	}
+	return 0;
+}
+
+void NotifyServerActivated()
+{
+	const std::vector<IClientListener *> &listeners = s_PlayerManager.listeners();
+	for (size_t i = 0; i < listeners.size(); i++)
+	{
+		listeners[i]->OnServerActivated(s_MaxClients);
+	}
+}
+
+/**
+ * Runs a whole connection in one go, in the same order as a real server:
+ * connect, put in server, authorize, admin checks.
+ */
+bool ConnectClient(int client, int userid, const char *name, const char *auth, bool fake)
+{
+	if (client < 1 || client > s_MaxClients || s_Players[client].connected)
+	{
+		return false;
+	}
+
+	const std::vector<IClientListener *> &listeners = s_PlayerManager.listeners();
+	char error[255];
+	for (size_t i = 0; i < listeners.size(); i++)
+	{
+		if (!listeners[i]->InterceptClientConnect(client, error, sizeof(error)))
+		{
+			return false;
+		}
+	}
+
+	HarnessPlayer &player = s_Players[client];
+	player.Reset();
+	player.index = client;
+	player.userid = userid;
+	player.serial = (s_SerialCount++ << 8) | (unsigned int)client;
+	player.name = name;
+	player.fake = fake;
+	player.connected = true;
+	player.SetAuth(fake ? "BOT" : auth);
+
+	for (size_t i = 0; i < listeners.size(); i++)
+	{
+		listeners[i]->OnClientConnected(client);
+	}
+	OnHarnessClientConnected(client);
+
+	player.in_game = true;
+	player.alive = true;
+	for (size_t i = 0; i < listeners.size(); i++)
+	{
+		listeners[i]->OnClientPutInServer(client);
+	}
+	OnHarnessClientPutInServer(client);
+
+	player.authorized = true;
+	for (size_t i = 0; i < listeners.size(); i++)
+	{
+		listeners[i]->OnClientAuthorized(client, player.auth.c_str());
+	}
+	OnHarnessClientAuthorized(client, player.auth.c_str());
+
+	player.RunAdminCacheChecks();
+	bool delay = false;
+	for (size_t i = 0; i < listeners.size(); i++)
+	{
+		if (!listeners[i]->OnClientPreAdminCheck(client))
+		{
+			delay = true;
+		}
+	}
+	if (!delay)
+	{
+		for (size_t i = 0; i < listeners.size(); i++)
+		{
+			listeners[i]->OnClientPostAdminCheck(client);
+		}
+		player.NotifyPostAdminChecks();
+	}
+
+	return true;
+}
+
+void DisconnectClient(int client)
+{
+	if (!IsClientIndexConnected(client))
+	{
+		return;
+	}
+
+	const std::vector<IClientListener *> &listeners = s_PlayerManager.listeners();
+	for (size_t i = 0; i < listeners.size(); i++)
+	{
+		listeners[i]->OnClientDisconnecting(client);
+	}
+	OnHarnessClientDisconnect(client);
+
+	s_Players[client].Reset();
+
+	for (size_t i = 0; i < listeners.size(); i++)
+	{
+		listeners[i]->OnClientDisconnected(client);
+	}
+	OnHarnessClientDisconnected(client);
+}
+
+void DisconnectAllClients()
+{
+	for (int i = 1; i <= s_MaxClients; i++)
+	{
+		DisconnectClient(i);
+	}
+}
+
+void SetClientTeam(int client, int team)
+{
+	if (IsClientIndexConnected(client))
+	{
+		s_Players[client].team = team;
+	}
+}
+
+void SetClientAlive(int client, bool alive)
+{
+	if (IsClientIndexConnected(client))
+	{
+		s_Players[client].alive = alive;
+	}
+}
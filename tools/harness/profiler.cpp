@@ -0,0 +1,448 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <IPluginSys.h>
+#include <bridge/include/IScriptManager.h>
+#include "harness.h"
+
+#if defined __linux__
+# include <pthread.h>
+#endif
+
+/**
+ * Charges time and allocations to plugins. The harness registers itself as
+ * a profiling tool, so every scope logic opens around a plugin callback
+ * (forwards, timers, frame actions) arrives here with the plugin's filename
+ * as its group. Time is exclusive: nested scopes that do not name a plugin
+ * (natives, forwards fired from inside a callback) stay with the plugin
+ * that opened them, while a nested plugin scope pauses its caller.
+ */
+
+struct UsageStats
+{
+	uint64_t calls = 0;
+	int64_t ns = 0;
+	uint64_t allocs = 0;
+	uint64_t bytes = 0;
+};
+
+struct OwnerUsage
+{
+	UsageStats total;
+	std::map<std::string, UsageStats> callbacks;
+};
+
+static inline int64_t Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* Where the allocation hooks charge to; NULL while no plugin code runs. */
+static UsageStats *s_AllocOwner = NULL;
+static UsageStats *s_AllocCallback = NULL;
+
+class HarnessProfiler : public IProfilingTool
+{
+	struct Frame
+	{
+		OwnerUsage *owner;
+		UsageStats *callback;
+	};
+
+public:
+	HarnessProfiler()
+		: active_(false),
+		  last_(0)
+	{
+	}
+
+	const char *Name() override
+	{
+		return "harness";
+	}
+
+	const char *Description() override
+	{
+		return "Per-plugin CPU and allocation totals for the offline harness.";
+	}
+
+	bool Start() override
+	{
+		stack_.clear();
+		resolved_.clear();
+		active_ = true;
+		return true;
+	}
+
+	void Stop(void (*render)(const char *fmt, ...)) override
+	{
+		active_ = false;
+		stack_.clear();
+		SetAllocTarget();
+	}
+
+	void Dump() override
+	{
+	}
+
+	bool IsActive() override
+	{
+		return active_;
+	}
+
+	bool IsAttached() override
+	{
+		return true;
+	}
+
+	void EnterScope(const char *group, const char *name) override
+	{
+		int64_t now = Now();
+		Charge(now);
+
+		Frame frame = stack_.empty() ? Frame{NULL, NULL} : stack_.back();
+		if (OwnerUsage *owner = Resolve(group))
+		{
+			UsageStats &callback = owner->callbacks[name ? name : "<unknown>"];
+			owner->total.calls++;
+			callback.calls++;
+			frame.owner = owner;
+			frame.callback = &callback;
+		}
+		stack_.push_back(frame);
+
+		SetAllocTarget();
+		last_ = Now();
+	}
+
+	void LeaveScope() override
+	{
+		int64_t now = Now();
+		Charge(now);
+
+		if (!stack_.empty())
+		{
+			stack_.pop_back();
+		}
+
+		SetAllocTarget();
+		last_ = Now();
+	}
+
+	void RenderHelp(void (*render)(const char *fmt, ...)) override
+	{
+		render("Started by sm_harness; reports per-plugin totals when the run ends.");
+	}
+
+	void SetOwners(const std::set<std::string> &owners)
+	{
+		owners_ = owners;
+		resolved_.clear();
+	}
+
+	const std::map<std::string, OwnerUsage> &usage() const
+	{
+		return usage_;
+	}
+
+private:
+	/* Bookkeeping allocates; never charge it to the plugin. */
+	void SetAllocTarget()
+	{
+		if (!active_ || stack_.empty() || !stack_.back().owner)
+		{
+			s_AllocOwner = NULL;
+			s_AllocCallback = NULL;
+			return;
+		}
+		s_AllocOwner = &stack_.back().owner->total;
+		s_AllocCallback = stack_.back().callback;
+	}
+
+	void Charge(int64_t now)
+	{
+		s_AllocOwner = NULL;
+		s_AllocCallback = NULL;
+
+		if (stack_.empty() || !stack_.back().owner)
+		{
+			return;
+		}
+		stack_.back().owner->total.ns += now - last_;
+		stack_.back().callback->ns += now - last_;
+	}
+
+	/* Groups are interned by logic, so the pointer identifies the name. */
+	OwnerUsage *Resolve(const char *group)
+	{
+		auto iter = resolved_.find(group);
+		if (iter != resolved_.end())
+		{
+			return iter->second;
+		}
+
+		OwnerUsage *owner = NULL;
+		if (group && owners_.count(group))
+		{
+			owner = &usage_[group];
+		}
+		resolved_[group] = owner;
+		return owner;
+	}
+
+private:
+	bool active_;
+	int64_t last_;
+	std::vector<Frame> stack_;
+	std::set<std::string> owners_;
+	std::unordered_map<const char *, OwnerUsage *> resolved_;
+	std::map<std::string, OwnerUsage> usage_;
+} s_Profiler;
+
+#if defined __linux__
+/**
+ * glibc exports its allocator under __libc_* names, so the harness binary can
+ * replace malloc and friends and still reach the real implementation. Only the
+ * main thread is counted; plugins never run anywhere else.
+ */
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t nmemb, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+#define HARNESS_EXPORT extern "C" __attribute__((visibility("default")))
+
+static pthread_t s_MainThread;
+
+static inline void CountAllocation(size_t bytes)
+{
+	if (s_AllocOwner && pthread_equal(pthread_self(), s_MainThread))
+	{
+		s_AllocOwner->allocs++;
+		s_AllocOwner->bytes += bytes;
+		s_AllocCallback->allocs++;
+		s_AllocCallback->bytes += bytes;
+	}
+}
+
+HARNESS_EXPORT void *malloc(size_t size)
+{
+	CountAllocation(size);
+	return __libc_malloc(size);
+}
+
+HARNESS_EXPORT void *calloc(size_t nmemb, size_t size)
+{
+	CountAllocation(nmemb * size);
+	return __libc_calloc(nmemb, size);
+}
+
+HARNESS_EXPORT void *realloc(void *ptr, size_t size)
+{
+	CountAllocation(size);
+	return __libc_realloc(ptr, size);
+}
+#endif
+
+void RegisterHarnessProfiler()
+{
+#if defined __linux__
+	s_MainThread = pthread_self();
+#endif
+	logicore.RegisterProfiler(&s_Profiler);
+}
+
+void StartHarnessProfiler()
+{
+	RefreshPluginOwners();
+	RunServerCommand("sm prof start harness");
+}
+
+void RefreshPluginOwners()
+{
+	std::set<std::string> owners;
+	owners.insert("SourceMod");
+
+	IPluginIterator *iter = logicore.scripts->GetPluginIterator();
+	while (iter->MorePlugins())
+	{
+		owners.insert(iter->GetPlugin()->GetFilename());
+		iter->NextPlugin();
+	}
+	iter->Release();
+
+	s_Profiler.SetOwners(owners);
+}
+
+static std::string JsonString(const std::string &str)
+{
+	std::string out = "\"";
+	for (size_t i = 0; i < str.size(); i++)
+	{
+		char c = str[i];
+		if (c == '"' || c == '\\')
+		{
+			out += '\\';
+			out += c;
+		}
+		else if ((unsigned char)c < 0x20)
+		{
+			char buffer[8];
+			snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+			out += buffer;
+		}
+		else
+		{
+			out += c;
+		}
+	}
+	out += '"';
+	return out;
+}
+
+static const char *StatusName(PluginStatus status)
+{
+	switch (status)
+	{
+	case Plugin_Running:
+		return "running";
+	case Plugin_Paused:
+		return "paused";
+	case Plugin_Error:
+		return "error";
+	case Plugin_Failed:
+		return "failed";
+	default:
+		return "not loaded";
+	}
+}
+
+void WriteUsageReport(FILE *fp, bool json, double wall_ms)
+{
+	typedef std::pair<std::string, const OwnerUsage *> Row;
+
+	std::vector<Row> rows;
+	const std::map<std::string, OwnerUsage> &usage = s_Profiler.usage();
+	for (auto iter = usage.begin(); iter != usage.end(); iter++)
+	{
+		rows.emplace_back(iter->first, &iter->second);
+	}
+	std::sort(rows.begin(), rows.end(), [] (const Row &a, const Row &b) {
+		return a.second->total.ns > b.second->total.ns;
+	});
+
+	std::vector<std::pair<std::string, PluginStatus>> failed;
+	IPluginIterator *iter = logicore.scripts->GetPluginIterator();
+	while (iter->MorePlugins())
+	{
+		IPlugin *plugin = iter->GetPlugin();
+		if (plugin->GetStatus() != Plugin_Running)
+		{
+			failed.emplace_back(plugin->GetFilename(), plugin->GetStatus());
+		}
+		iter->NextPlugin();
+	}
+	iter->Release();
+
+	if (json)
+	{
+		fprintf(fp, "{\n  \"wall_ms\": %.3f,\n  \"plugins\": [", wall_ms);
+		for (size_t i = 0; i < rows.size(); i++)
+		{
+			const UsageStats &total = rows[i].second->total;
+			fprintf(fp, "%s\n    {\"plugin\": %s, \"calls\": %llu, \"ms\": %.3f, \"allocs\": %llu, \"bytes\": %llu, \"callbacks\": [",
+				i ? "," : "", JsonString(rows[i].first).c_str(), (unsigned long long)total.calls,
+				total.ns / 1e6, (unsigned long long)total.allocs, (unsigned long long)total.bytes);
+
+			const std::map<std::string, UsageStats> &callbacks = rows[i].second->callbacks;
+			bool first = true;
+			for (auto cb = callbacks.begin(); cb != callbacks.end(); cb++)
+			{
+				fprintf(fp, "%s\n      {\"name\": %s, \"calls\": %llu, \"ms\": %.3f, \"allocs\": %llu, \"bytes\": %llu}",
+					first ? "" : ",", JsonString(cb->first).c_str(), (unsigned long long)cb->second.calls,
+					cb->second.ns / 1e6, (unsigned long long)cb->second.allocs, (unsigned long long)cb->second.bytes);
+				first = false;
+			}
+			fprintf(fp, "%s]}", callbacks.empty() ? "" : "\n    ");
+		}
+		fprintf(fp, "%s],\n  \"not_running\": [", rows.empty() ? "" : "\n  ");
+		for (size_t i = 0; i < failed.size(); i++)
+		{
+			fprintf(fp, "%s\n    {\"plugin\": %s, \"status\": \"%s\"}", i ? "," : "",
+				JsonString(failed[i].first).c_str(), StatusName(failed[i].second));
+		}
+		fprintf(fp, "%s]\n}\n", failed.empty() ? "" : "\n  ");
+		return;
+	}
+
+	fprintf(fp, "Wall time: %.3f ms\n\n", wall_ms);
+	fprintf(fp, "%-32s %10s %12s %7s %10s %12s\n", "plugin", "calls", "ms", "%wall", "allocs", "bytes");
+	for (size_t i = 0; i < rows.size(); i++)
+	{
+		const UsageStats &total = rows[i].second->total;
+		fprintf(fp, "%-32s %10llu %12.3f %6.2f%% %10llu %12llu\n", rows[i].first.c_str(),
+			(unsigned long long)total.calls, total.ns / 1e6,
+			wall_ms > 0 ? (total.ns / 1e6) * 100.0 / wall_ms : 0.0,
+			(unsigned long long)total.allocs, (unsigned long long)total.bytes);
+	}
+
+	for (size_t i = 0; i < rows.size(); i++)
+	{
+		fprintf(fp, "\n%s\n", rows[i].first.c_str());
+
+		const std::map<std::string, UsageStats> &callbacks = rows[i].second->callbacks;
+		for (auto cb = callbacks.begin(); cb != callbacks.end(); cb++)
+		{
+			fprintf(fp, "  %-30s %10llu %12.3f %18llu %12llu\n", cb->first.c_str(),
+				(unsigned long long)cb->second.calls, cb->second.ns / 1e6,
+				(unsigned long long)cb->second.allocs, (unsigned long long)cb->second.bytes);
+		}
+	}
+
+	if (!failed.empty())
+	{
+		fprintf(fp, "\nPlugins not running:\n");
+		for (size_t i = 0; i < failed.size(); i++)
+		{
+			fprintf(fp, "  %s (%s)\n", failed[i].first.c_str(), StatusName(failed[i].second));
+		}
+	}
+}
@@ -0,0 +1,296 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * =============================================================================
+ * SourceMod
+ * Copyright (C) 2004-2026 AlliedModders LLC.  All rights reserved.
+ * =============================================================================
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License, version 3.0, as published by the
+ * Free Software Foundation.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, AlliedModders LLC gives you permission to link the
+ * code of this program (as well as its derivative works) to "Half-Life 2," the
+ * "Source Engine," the "SourcePawn JIT," and any Game MODs that run on software
+ * by the Valve Corporation.  You must obey the GNU General Public License in
+ * all respects for all other code used.  Additionally, AlliedModders LLC grants
+ * this exception to all derivative works.  AlliedModders LLC defines further
+ * exceptions, found in LICENSE.txt (as of this writing, version JULY-31-2007),
+ * or <http://www.sourcemod.net/license.php>.
+ *
+ * Version: $Id$
+ */
+
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "harness.h"
+
+/**
+ * Replay streams are plain text, one action per line. Blank lines and lines
+ * starting with '#' are ignored. Arguments are split like console commands,
+ * so quoted strings may contain spaces.
+ *
+ *   maxplayers <count>
+ *   tickrate <ticks per second>
+ *   map <name>                      ends the current map, if any, and starts another
+ *   connect <client> <userid> <name> <steamid> [bot]
+ *   disconnect <client>
+ *   team <client> <team>
+ *   alive <client> <0|1>
+ *   event <name> [key=value ...]
+ *   usercmd <client> [buttons=N impulse=N vel=x,y,z angles=x,y,z weapon=N
+ *                     subtype=N cmdnum=N seed=N mouse=x,y]
+ *   frame [count]
+ *   cvar <name> <value>
+ *   command <client> <text>
+ *   server <text>
+ */
+
+static bool SplitKeyValue(const char *arg, std::string *key, std::string *value)
+{
+	const char *eq = strchr(arg, '=');
+	if (!eq || eq == arg)
+	{
+		return false;
+	}
+	key->assign(arg, eq - arg);
+	value->assign(eq + 1);
+	return true;
+}
+
+static void ParseFloats(const std::string &value, float *out, int count)
+{
+	const char *pos = value.c_str();
+	for (int i = 0; i < count; i++)
+	{
+		char *end;
+		out[i] = strtof(pos, &end);
+		if (*end != ',')
+		{
+			break;
+		}
+		pos = end + 1;
+	}
+}
+
+static void ParseInts(const std::string &value, int *out, int count)
+{
+	const char *pos = value.c_str();
+	for (int i = 0; i < count; i++)
+	{
+		char *end;
+		out[i] = (int)strtol(pos, &end, 10);
+		if (*end != ',')
+		{
+			break;
+		}
+		pos = end + 1;
+	}
+}
+
+static bool ParseUserCmd(const HarnessArgs &args, HarnessUserCmd *cmd)
+{
+	memset(cmd, 0, sizeof(*cmd));
+	cmd->cmdnum = g_Clock.tick;
+
+	std::string key, value;
+	for (int i = 2; i < args.ArgC(); i++)
+	{
+		if (!SplitKeyValue(args.Arg(i), &key, &value))
+		{
+			return false;
+		}
+
+		if (key == "buttons")
+			cmd->buttons = atoi(value.c_str());
+		else if (key == "impulse")
+			cmd->impulse = atoi(value.c_str());
+		else if (key == "vel")
+			ParseFloats(value, cmd->vel, 3);
+		else if (key == "angles")
+			ParseFloats(value, cmd->angles, 3);
+		else if (key == "weapon")
+			cmd->weapon = atoi(value.c_str());
+		else if (key == "subtype")
+			cmd->subtype = atoi(value.c_str());
+		else if (key == "cmdnum")
+			cmd->cmdnum = atoi(value.c_str());
+		else if (key == "seed")
+			cmd->seed = atoi(value.c_str());
+		else if (key == "mouse")
+			ParseInts(value, cmd->mouse, 2);
+		else
+			return false;
+	}
+	return true;
+}
+
+static bool RunLine(const char *line, char *error, size_t maxlength)
+{
+	HarnessArgs args(line);
+	if (!args.ArgC() || args.Arg(0)[0] == '#')
+	{
+		return true;
+	}
+
+	const char *action = args.Arg(0);
+	int argc = args.ArgC();
+
+	if (strcmp(action, "maxplayers") == 0 && argc == 2)
+	{
+		SetMaxClients(atoi(args.Arg(1)));
+	}
+	else if (strcmp(action, "tickrate") == 0 && argc == 2)
+	{
+		float rate = (float)atof(args.Arg(1));
+		if (rate <= 0.0f)
+		{
+			snprintf(error, maxlength, "invalid tickrate \"%s\"", args.Arg(1));
+			return false;
+		}
+		g_Clock.interval = 1.0f / rate;
+		g_Clock.frametime = g_Clock.interval;
+	}
+	else if (strcmp(action, "map") == 0 && argc == 2)
+	{
+		StartMap(args.Arg(1));
+	}
+	else if (strcmp(action, "connect") == 0 && (argc == 5 || argc == 6))
+	{
+		bool fake = (argc == 6 && strcmp(args.Arg(5), "bot") == 0);
+		if (!ConnectClient(atoi(args.Arg(1)), atoi(args.Arg(2)), args.Arg(3), args.Arg(4), fake))
+		{
+			snprintf(error, maxlength, "could not connect client %s", args.Arg(1));
+			return false;
+		}
+	}
+	else if (strcmp(action, "disconnect") == 0 && argc == 2)
+	{
+		DisconnectClient(atoi(args.Arg(1)));
+	}
+	else if (strcmp(action, "team") == 0 && argc == 3)
+	{
+		SetClientTeam(atoi(args.Arg(1)), atoi(args.Arg(2)));
+	}
+	else if (strcmp(action, "alive") == 0 && argc == 3)
+	{
+		SetClientAlive(atoi(args.Arg(1)), atoi(args.Arg(2)) != 0);
+	}
+	else if (strcmp(action, "event") == 0 && argc >= 2)
+	{
+		std::vector<std::pair<std::string, std::string>> keys;
+		std::string key, value;
+		for (int i = 2; i < argc; i++)
+		{
+			if (!SplitKeyValue(args.Arg(i), &key, &value))
+			{
+				snprintf(error, maxlength, "expected key=value, got \"%s\"", args.Arg(i));
+				return false;
+			}
+			keys.emplace_back(key, value);
+		}
+		FireGameEvent(args.Arg(1), keys);
+	}
+	else if (strcmp(action, "usercmd") == 0 && argc >= 2)
+	{
+		HarnessUserCmd cmd;
+		if (!ParseUserCmd(args, &cmd))
+		{
+			snprintf(error, maxlength, "malformed usercmd");
+			return false;
+		}
+		RunUserCmd(atoi(args.Arg(1)), cmd);
+	}
+	else if (strcmp(action, "frame") == 0 && argc <= 2)
+	{
+		int count = (argc == 2) ? atoi(args.Arg(1)) : 1;
+		for (int i = 0; i < count; i++)
+		{
+			RunFrame();
+		}
+	}
+	else if (strcmp(action, "cvar") == 0 && argc == 3)
+	{
+		if (!SetConVarValue(args.Arg(1), args.Arg(2)))
+		{
+			fprintf(stderr, "Warning: convar \"%s\" does not exist\n", args.Arg(1));
+		}
+	}
+	else if (strcmp(action, "command") == 0 && argc >= 3)
+	{
+		/* Everything after the client index is the command line. */
+		std::string text = args.Arg(2);
+		for (int i = 3; i < argc; i++)
+		{
+			text += " ";
+			text += args.Arg(i);
+		}
+		RunClientCommand(atoi(args.Arg(1)), text.c_str());
+	}
+	else if (strcmp(action, "server") == 0 && argc >= 2)
+	{
+		RunServerCommand(args.ArgS());
+	}
+	else
+	{
+		snprintf(error, maxlength, "unknown or malformed action \"%s\"", action);
+		return false;
+	}
+	return true;
+}
+
+bool RunReplay(const char *path, unsigned int iterations)
+{
+	FILE *fp = fopen(path, "rt");
+	if (!fp)
+	{
+		fprintf(stderr, "Could not open replay stream \"%s\"\n", path);
+		return false;
+	}
+
+	std::vector<std::string> lines;
+	char buffer[4096];
+	while (fgets(buffer, sizeof(buffer), fp))
+	{
+		size_t len = strlen(buffer);
+		while (len && (buffer[len - 1] == '\n' || buffer[len - 1] == '\r'))
+		{
+			buffer[--len] = '\0';
+		}
+		lines.push_back(buffer);
+	}
+	fclose(fp);
+
+	/* Each pass starts from an empty server so that passes are comparable. */
+	for (unsigned int pass = 0; pass < iterations; pass++)
+	{
+		for (size_t i = 0; i < lines.size(); i++)
+		{
+			char error[255];
+			if (!RunLine(lines[i].c_str(), error, sizeof(error)))
+			{
+				fprintf(stderr, "%s:%u: %s\n", path, (unsigned)(i + 1), error);
+				return false;
+			}
+		}
+
+		DisconnectAllClients();
+		if (IsMapRunning())
+		{
+			EndMap();
+		}
+	}
+	return true;
+}
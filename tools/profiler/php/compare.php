@@ -0,0 +1,78 @@
+<?php
+
+/**
+ * Compares two profiler or benchmark reports item by item.
+ *
+ * Usage: php compare.php <base.xml> <new.xml> [threshold%]
+ *
+ * Prints the per-call time of every item found in both reports and exits
+ * with status 1 if any item got slower by more than the threshold
+ * (default 10%).
+ */
+
+require_once __DIR__ . '/ProfFileParser.class.php';
+
+function LoadReport(string $file): array
+{
+	$parser = new ProfReportParser();
+	if (($report = $parser->Parse($file)) === false) {
+		fwrite(STDERR, "Could not parse $file: {$parser->last_error}\n");
+		exit(2);
+	}
+
+	$items = [];
+	foreach ($report->items as $item) {
+		$calls = (int)$item['numcalls'];
+		if ($calls <= 0) {
+			continue;
+		}
+		$items[$item['type'] . ':' . $item['name']] = [
+			'ns' => (float)$item['totaltime'] / $calls * 1e9,
+			'allocs' => isset($item['allocs']) ? (float)$item['allocs'] / $calls : null,
+		];
+	}
+	return $items;
+}
+
+if ($argc < 3) {
+	fwrite(STDERR, "Usage: php {$argv[0]} <base.xml> <new.xml> [threshold%]\n");
+	exit(2);
+}
+
+$threshold = $argc > 3 ? (float)$argv[3] : 10.0;
+$base = LoadReport($argv[1]);
+$new = LoadReport($argv[2]);
+$regressions = 0;
+
+printf("%-40s %12s %12s %9s %10s\n", 'item', 'base ns/op', 'new ns/op', 'delta', 'allocs/op');
+foreach ($new as $name => $item) {
+	if (!isset($base[$name])) {
+		printf("%-40s %12s %12.1f %9s\n", $name, '-', $item['ns'], 'new');
+		continue;
+	}
+
+	$old = $base[$name]['ns'];
+	$delta = $old > 0 ? ($item['ns'] - $old) / $old * 100.0 : 0.0;
+	$flag = '';
+	if ($delta > $threshold) {
+		$flag = ' <-- regression';
+		$regressions++;
+	}
+	printf("%-40s %12.1f %12.1f %8.1f%% %10s%s\n",
+		$name,
+		$old,
+		$item['ns'],
+		$delta,
+		$item['allocs'] === null ? '-' : sprintf('%.3f', $item['allocs']),
+		$flag);
+}
+
+foreach (array_diff_key($base, $new) as $name => $item) {
+	printf("%-40s %12.1f %12s %9s\n", $name, $item['ns'], '-', 'removed');
+}
+
+if ($regressions > 0) {
+	printf("\n%d item(s) regressed by more than %.1f%%\n", $regressions, $threshold);
+	exit(1);
+}
+exit(0);